@@ -0,0 +1,273 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "fixtures.h"
+#include "ouster/field_ops.h"
+#include "ouster/image_processing.h"
+#include "ouster/impl/profile_extension.h"
+#include "ouster/ip_reassembly.h"
+#include "ouster/lidar_scan.h"
+#include "ouster/packet_pool.h"
+
+using namespace ouster;
+using namespace ouster::benchmarks;
+
+namespace {
+
+void BM_ScanBatcher(benchmark::State& state, sensor::UDPProfileLidar profile) {
+    const auto info = synthetic_info(profile);
+    auto packets = scan_packets(info, random_scan(info));
+    sensor::impl::packet_writer pw{sensor::get_format(info)};
+    ScanBatcher batcher(info);
+    LidarScan scan(info);
+    uint32_t frame_id = 0;
+    for (auto _ : state) {
+        // every iteration batches a new frame, the batcher drops repeats
+        frame_id++;
+        for (auto& packet : packets) {
+            pw.set_frame_id(packet.buf.data(), frame_id);
+            batcher(packet, scan);
+        }
+        benchmark::DoNotOptimize(scan.frame_id);
+    }
+    state.SetItemsProcessed(state.iterations() * packets.size());
+    state.SetBytesProcessed(state.iterations() * packets.size() *
+                            packets.front().buf.size());
+}
+
+void BM_ScanToPackets(benchmark::State& state,
+                      sensor::UDPProfileLidar profile) {
+    const auto info = synthetic_info(profile);
+    const auto scan = random_scan(info);
+    sensor::impl::packet_writer pw{sensor::get_format(info)};
+    sensor::PacketPool pool;
+    std::vector<sensor::PooledPacket> packets;
+    for (auto _ : state) {
+        // packets go back to the pool as they are cleared
+        packets.clear();
+        impl::scan_to_packets(scan, pw, pool, std::back_inserter(packets), 0,
+                              0);
+        benchmark::DoNotOptimize(packets.back()->buf.data());
+    }
+    state.SetItemsProcessed(state.iterations() * packets.size());
+    state.SetBytesProcessed(state.iterations() * packets.size() *
+                            pw.lidar_packet_size);
+}
+
+// the layout of RNG19_RFL8_SIG16_NIR16_DUAL registered as a custom profile,
+// as firmware variants are
+sensor::UDPProfileLidar custom_dual_profile() {
+    static const sensor::UDPProfileLidar profile = [] {
+        using sensor::impl::FieldInfo;
+        using namespace sensor::ChanField;
+        const int profile_nr = 200;
+        // clang-format off
+        sensor::add_custom_profile(profile_nr, "BENCHMARK_DUAL_COPY", {
+            {RANGE, {sensor::ChanFieldType::UINT32, 0, 0x0007ffff, 0}},
+            {FLAGS, {sensor::ChanFieldType::UINT8, 2, 0b11111000, 3}},
+            {REFLECTIVITY, {sensor::ChanFieldType::UINT8, 3, 0, 0}},
+            {RANGE2, {sensor::ChanFieldType::UINT32, 4, 0x0007ffff, 0}},
+            {FLAGS2, {sensor::ChanFieldType::UINT8, 6, 0b11111000, 3}},
+            {REFLECTIVITY2, {sensor::ChanFieldType::UINT8, 7, 0, 0}},
+            {SIGNAL, {sensor::ChanFieldType::UINT16, 8, 0, 0}},
+            {SIGNAL2, {sensor::ChanFieldType::UINT16, 10, 0, 0}},
+            {NEAR_IR, {sensor::ChanFieldType::UINT16, 12, 0, 0}}}, 16);
+        // clang-format on
+        return static_cast<sensor::UDPProfileLidar>(profile_nr);
+    }();
+    return profile;
+}
+
+void BM_ScanBatcher_Custom(benchmark::State& state) {
+    BM_ScanBatcher(state, custom_dual_profile());
+}
+
+void BM_Cartesian(benchmark::State& state) {
+    const auto info = synthetic_info(sensor::PROFILE_RNG19_RFL8_SIG16_NIR16);
+    const auto scan = random_scan(info);
+    const auto lut = make_xyz_lut(info, true);
+    for (auto _ : state) {
+        auto points = cartesian(scan, lut);
+        benchmark::DoNotOptimize(points.data());
+    }
+    state.SetItemsProcessed(state.iterations() * scan.w * scan.h);
+}
+
+void BM_CartesianF(benchmark::State& state) {
+    const auto info = synthetic_info(sensor::PROFILE_RNG19_RFL8_SIG16_NIR16);
+    const auto scan = random_scan(info);
+    const auto lut = make_xyz_lut_f(info, true);
+    for (auto _ : state) {
+        auto points = cartesian(scan, lut);
+        benchmark::DoNotOptimize(points.data());
+    }
+    state.SetItemsProcessed(state.iterations() * scan.w * scan.h);
+}
+
+void BM_Destagger(benchmark::State& state) {
+    const auto info = synthetic_info(sensor::PROFILE_RNG19_RFL8_SIG16_NIR16);
+    const auto scan = random_scan(info);
+    img_t<uint32_t> range = scan.field<uint32_t>(sensor::ChanField::RANGE);
+    for (auto _ : state) {
+        auto destaggered =
+            destagger<uint32_t>(range, info.format.pixel_shift_by_row);
+        benchmark::DoNotOptimize(destaggered.data());
+    }
+    state.SetItemsProcessed(state.iterations() * range.size());
+}
+
+// ranges in meters, as the viz and Python code compute them
+void BM_RangeToMeters(benchmark::State& state) {
+    const auto info = synthetic_info(sensor::PROFILE_RNG19_RFL8_SIG16_NIR16);
+    const auto scan = random_scan(info);
+    const auto& range = scan.field(sensor::ChanField::RANGE);
+    img_t<float> meters(scan.h, scan.w);
+    FieldView out(meters.data(), fd_array<float>(scan.h, scan.w));
+    for (auto _ : state) {
+        field_ops::scale(range, out, 0.001);
+        benchmark::DoNotOptimize(meters.data());
+    }
+    state.SetItemsProcessed(state.iterations() * meters.size());
+}
+
+void BM_RangeToMetersEigen(benchmark::State& state) {
+    const auto info = synthetic_info(sensor::PROFILE_RNG19_RFL8_SIG16_NIR16);
+    const auto scan = random_scan(info);
+    const auto range = scan.field<uint32_t>(sensor::ChanField::RANGE);
+    img_t<float> meters(scan.h, scan.w);
+    for (auto _ : state) {
+        meters = range.cast<float>() * 0.001f;
+        benchmark::DoNotOptimize(meters.data());
+    }
+    state.SetItemsProcessed(state.iterations() * meters.size());
+}
+
+// the reflectivity of a scan as the float image the viz processes
+img_t<float> float_image() {
+    const auto info = synthetic_info(sensor::PROFILE_RNG19_RFL8_SIG16_NIR16);
+    const auto scan = random_scan(info);
+    return scan.field<uint8_t>(sensor::ChanField::REFLECTIVITY)
+        .cast<float>();
+}
+
+void BM_AutoExposure(benchmark::State& state) {
+    const img_t<float> image = float_image();
+    viz::AutoExposure ae(1);
+    img_t<float> out;
+    for (auto _ : state) {
+        out = image;
+        ae(out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * image.size());
+}
+
+void BM_BeamUniformityCorrector(benchmark::State& state) {
+    const img_t<float> image = float_image();
+    viz::BeamUniformityCorrector buc(1);
+    img_t<float> out;
+    for (auto _ : state) {
+        out = image;
+        buc(out);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(state.iterations() * image.size());
+}
+
+// the fragments of an IPv4 datagram of size bytes, in mtu sized packets
+std::vector<std::vector<uint8_t>> fragments(size_t size, size_t mtu,
+                                            uint16_t id) {
+    std::vector<std::vector<uint8_t>> result;
+    const size_t step = (mtu - 20) / 8 * 8;
+    for (size_t offset = 0; offset < size; offset += step) {
+        const size_t len = std::min(step, size - offset);
+        const bool more = offset + len < size;
+        std::vector<uint8_t> pkt(20 + len, 0xa5);
+        const size_t total = pkt.size();
+        uint16_t flags_offset = static_cast<uint16_t>(offset / 8);
+        if (more) flags_offset |= 0x2000;
+        pkt[0] = 0x45;
+        pkt[1] = 0;
+        pkt[2] = static_cast<uint8_t>(total >> 8);
+        pkt[3] = static_cast<uint8_t>(total & 0xff);
+        pkt[4] = static_cast<uint8_t>(id >> 8);
+        pkt[5] = static_cast<uint8_t>(id & 0xff);
+        pkt[6] = static_cast<uint8_t>(flags_offset >> 8);
+        pkt[7] = static_cast<uint8_t>(flags_offset & 0xff);
+        pkt[8] = 64;
+        pkt[9] = 17;
+        std::fill(pkt.begin() + 10, pkt.begin() + 20, 0);
+        pkt[12] = 10;
+        pkt[15] = 1;
+        pkt[16] = 10;
+        pkt[19] = 2;
+        result.push_back(std::move(pkt));
+    }
+    return result;
+}
+
+void BM_IpReassembly(benchmark::State& state) {
+    // the UDP datagrams of lidar packets sent over a 1500 byte MTU
+    const auto info = synthetic_info(sensor::PROFILE_RNG19_RFL8_SIG16_NIR16);
+    const size_t datagram = 8 + sensor::get_format(info).lidar_packet_size;
+    std::vector<std::vector<std::vector<uint8_t>>> datagrams;
+    for (uint16_t id = 0; id < 64; id++) {
+        datagrams.push_back(fragments(datagram, 1500, id));
+    }
+
+    sensor::IpReassembler reassembler;
+    int64_t ts = 0;
+    size_t reassembled = 0;
+    for (auto _ : state) {
+        for (const auto& frags : datagrams) {
+            for (const auto& frag : frags) {
+                const uint8_t* out = nullptr;
+                size_t out_size = 0;
+                if (reassembler.process(std::chrono::microseconds(ts++),
+                                        frag.data(), frag.size(), out,
+                                        out_size) ==
+                    sensor::IpReassembler::REASSEMBLED) {
+                    reassembled++;
+                }
+            }
+        }
+    }
+    benchmark::DoNotOptimize(reassembled);
+    state.SetItemsProcessed(state.iterations() * datagrams.size());
+    state.SetBytesProcessed(state.iterations() * datagrams.size() * datagram);
+}
+
+}  // namespace
+
+BENCHMARK_CAPTURE(BM_ScanBatcher, LEGACY, sensor::PROFILE_LIDAR_LEGACY);
+BENCHMARK_CAPTURE(BM_ScanBatcher, RNG19_RFL8_SIG16_NIR16,
+                  sensor::PROFILE_RNG19_RFL8_SIG16_NIR16);
+BENCHMARK_CAPTURE(BM_ScanBatcher, RNG19_RFL8_SIG16_NIR16_DUAL,
+                  sensor::PROFILE_RNG19_RFL8_SIG16_NIR16_DUAL);
+BENCHMARK_CAPTURE(BM_ScanBatcher, RNG15_RFL8_NIR8,
+                  sensor::PROFILE_RNG15_RFL8_NIR8);
+BENCHMARK_CAPTURE(BM_ScanBatcher, FIVE_WORD_PIXEL,
+                  sensor::PROFILE_FIVE_WORD_PIXEL);
+BENCHMARK(BM_ScanBatcher_Custom);
+BENCHMARK_CAPTURE(BM_ScanToPackets, LEGACY, sensor::PROFILE_LIDAR_LEGACY);
+BENCHMARK_CAPTURE(BM_ScanToPackets, RNG19_RFL8_SIG16_NIR16,
+                  sensor::PROFILE_RNG19_RFL8_SIG16_NIR16);
+BENCHMARK_CAPTURE(BM_ScanToPackets, RNG15_RFL8_NIR8,
+                  sensor::PROFILE_RNG15_RFL8_NIR8);
+BENCHMARK(BM_Cartesian);
+BENCHMARK(BM_CartesianF);
+BENCHMARK(BM_Destagger);
+BENCHMARK(BM_RangeToMeters);
+BENCHMARK(BM_RangeToMetersEigen);
+BENCHMARK(BM_AutoExposure);
+BENCHMARK(BM_BeamUniformityCorrector);
+BENCHMARK(BM_IpReassembly);
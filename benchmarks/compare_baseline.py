@@ -0,0 +1,195 @@
+"""
+Copyright (c) 2025, Ouster, Inc.
+All rights reserved.
+
+Compare ouster_benchmarks results against a stored baseline.
+
+Runs the benchmarks with repetitions (or reads results saved with
+--benchmark_out), compares every benchmark to the baseline and reports the
+regressions per subsystem. A benchmark regresses when its median time grew by
+more than the threshold and a Mann-Whitney U test over the repetitions finds
+the difference significant. Exits with 1 when something regressed.
+
+    # record a baseline on the machine the comparisons run on
+    python3 compare_baseline.py --benchmarks ./ouster_benchmarks \\
+        --save baseline.json
+    # after upgrading
+    python3 compare_baseline.py --benchmarks ./ouster_benchmarks \\
+        --baseline baseline.json
+"""
+import argparse
+import json
+import math
+import statistics
+import subprocess
+import sys
+import tempfile
+from collections import defaultdict
+from pathlib import Path
+from typing import Dict, List, Tuple
+
+# subsystem of every benchmark, by benchmark name prefix
+SUBSYSTEMS = [
+    ("BM_ScanBatcher", "packet parsing"),
+    ("BM_Cartesian", "point clouds"),
+    ("BM_Destagger", "image processing"),
+    ("BM_AutoExposure", "image processing"),
+    ("BM_BeamUniformityCorrector", "image processing"),
+    ("BM_IpReassembly", "networking"),
+    ("BM_Queue", "queues"),
+    ("BM_Png", "osf"),
+    ("BM_Osf", "osf"),
+    ("BM_Pcap", "pcap"),
+]
+
+# context keys that have to match for results to be comparable
+BUILD_CONTEXT = ["host_name", "num_cpus", "mhz_per_cpu", "library_build_type",
+                 "compiler", "ouster_build_type"]
+
+
+def subsystem(name: str) -> str:
+    for prefix, system in SUBSYSTEMS:
+        if name.startswith(prefix):
+            return system
+    return "other"
+
+
+def run_benchmarks(executable: str, repetitions: int, extra: List[str]) -> dict:
+    with tempfile.TemporaryDirectory() as tmp:
+        out = Path(tmp) / "results.json"
+        subprocess.run([executable, f"--benchmark_repetitions={repetitions}",
+                        f"--benchmark_out={out}", "--benchmark_out_format=json",
+                        *extra], check=True)
+        return json.loads(out.read_text())
+
+
+def samples(results: dict) -> Dict[str, List[float]]:
+    """Real time of every repetition of every benchmark, in nanoseconds."""
+    to_ns = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+    times: Dict[str, List[float]] = defaultdict(list)
+    for b in results["benchmarks"]:
+        if b.get("run_type", "iteration") != "iteration":
+            continue
+        name = b.get("run_name", b["name"])
+        times[name].append(b["real_time"] * to_ns[b.get("time_unit", "ns")])
+    return times
+
+
+def mann_whitney_p(a: List[float], b: List[float]) -> float:
+    """Two sided p-value of a Mann-Whitney U test, normal approximation."""
+    n1, n2 = len(a), len(b)
+    ranked = sorted([(v, 0) for v in a] + [(v, 1) for v in b])
+    ranks = [0.0] * len(ranked)
+    ties = 0.0
+    i = 0
+    while i < len(ranked):
+        j = i
+        while j + 1 < len(ranked) and ranked[j + 1][0] == ranked[i][0]:
+            j += 1
+        for k in range(i, j + 1):
+            ranks[k] = (i + j) / 2 + 1
+        t = j - i + 1
+        ties += t ** 3 - t
+        i = j + 1
+    r1 = sum(r for r, (_, group) in zip(ranks, ranked) if group == 0)
+    u = r1 - n1 * (n1 + 1) / 2
+    n = n1 + n2
+    var = n1 * n2 / 12 * ((n + 1) - ties / (n * (n - 1)))
+    if var <= 0:
+        return 1.0
+    z = (abs(u - n1 * n2 / 2) - 0.5) / math.sqrt(var)
+    return math.erfc(max(z, 0) / math.sqrt(2))
+
+
+def compare(baseline: dict, current: dict, threshold: float,
+            alpha: float) -> Tuple[Dict[str, List[str]], List[str]]:
+    """Regressions per subsystem and the lines of the full report."""
+    base, cur = samples(baseline), samples(current)
+    regressions: Dict[str, List[str]] = defaultdict(list)
+    report = [f"{'benchmark':<48} {'baseline':>12} {'current':>12} "
+              f"{'change':>8} {'p':>6}"]
+    for name in sorted(set(base) | set(cur)):
+        if name not in cur:
+            report.append(f"{name:<48} missing from the current results")
+            continue
+        if name not in base:
+            report.append(f"{name:<48} new, not in the baseline")
+            continue
+        b, c = statistics.median(base[name]), statistics.median(cur[name])
+        change = (c - b) / b
+        p = mann_whitney_p(base[name], cur[name])
+        if len(base[name]) < 2 or len(cur[name]) < 2:
+            # without repetitions only the threshold can be applied
+            p = 0.0
+        line = (f"{name:<48} {b:>10.0f}ns {c:>10.0f}ns {change:>+8.1%} "
+                f"{p:>6.3f}")
+        if change > threshold and p < alpha:
+            line += "  REGRESSION"
+            regressions[subsystem(name)].append(
+                f"{name}: {change:+.1%} (p={p:.3f})")
+        report.append(line)
+    return regressions, report
+
+
+def context_mismatches(baseline: dict, current: dict) -> List[str]:
+    bc, cc = baseline.get("context", {}), current.get("context", {})
+    return [f"{key}: {bc.get(key)} -> {cc.get(key)}" for key in BUILD_CONTEXT
+            if bc.get(key) != cc.get(key)]
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[1],
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--benchmarks", help="ouster_benchmarks executable to run")
+    source.add_argument("--results", help="json results of a previous run")
+    parser.add_argument("--baseline", help="baseline json to compare against")
+    parser.add_argument("--save", help="save the results to this file, e.g. as a new baseline")
+    parser.add_argument("--repetitions", type=int, default=10,
+                        help="repetitions of every benchmark (default: 10)")
+    parser.add_argument("--threshold", type=float, default=0.05,
+                        help="relative slowdown of the median to report (default: 0.05)")
+    parser.add_argument("--alpha", type=float, default=0.05,
+                        help="significance level of the U test (default: 0.05)")
+    parser.add_argument("--filter", help="run only the benchmarks matching this regex")
+    args = parser.parse_args()
+
+    if args.benchmarks:
+        extra = [f"--benchmark_filter={args.filter}"] if args.filter else []
+        current = run_benchmarks(args.benchmarks, args.repetitions, extra)
+    else:
+        current = json.loads(Path(args.results).read_text())
+
+    context = current.get("context", {})
+    print("build: " + ", ".join(f"{k}={context[k]}" for k in sorted(context)
+                                if k != "caches"))
+    if args.save:
+        Path(args.save).write_text(json.dumps(current, indent=2))
+        print(f"saved results to {args.save}")
+    if not args.baseline:
+        return 0
+
+    baseline = json.loads(Path(args.baseline).read_text())
+    mismatches = context_mismatches(baseline, current)
+    if mismatches:
+        print("warning: the baseline was recorded on a different machine or "
+              "build, differences may not be regressions:")
+        for m in mismatches:
+            print(f"  {m}")
+
+    regressions, report = compare(baseline, current, args.threshold,
+                                  args.alpha)
+    print("\n".join(report))
+    if not regressions:
+        print("\nno regressions")
+        return 0
+    print("\nregressions by subsystem:")
+    for system in sorted(regressions):
+        print(f"  {system}:")
+        for r in regressions[system]:
+            print(f"    {r}")
+    return 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,55 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * Records the build of the benchmarks in the context of their results, so
+ * compare_baseline.py can tell results of different builds apart.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include "ouster/impl/build.h"
+#include "ouster/threads.h"
+
+namespace {
+
+std::string compiler() {
+#if defined(__clang__)
+    return std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+    return std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+    return "msvc " + std::to_string(_MSC_FULL_VER);
+#else
+    return "unknown";
+#endif
+}
+
+// the vector kernels built in, of cartesian, field_decode and AutoExposure
+std::string simd() {
+#if defined(__aarch64__) && defined(__ARM_NEON)
+    return "neon";
+#elif defined(__AVX2__)
+    return "avx2";
+#elif defined(__x86_64__) || defined(__i386__)
+    return "sse";
+#else
+    return "none";
+#endif
+}
+
+const bool context_added = [] {
+    benchmark::AddCustomContext("ouster_sdk_version", ouster::SDK_VERSION_FULL);
+    benchmark::AddCustomContext("ouster_build_hash", ouster::BUILD_HASH);
+    benchmark::AddCustomContext("ouster_build_type", ouster::BUILD_TYPE);
+    benchmark::AddCustomContext("ouster_build_system", ouster::BUILD_SYSTEM);
+    benchmark::AddCustomContext("compiler", compiler());
+    benchmark::AddCustomContext("simd", simd());
+    benchmark::AddCustomContext("sdk_threads",
+                                std::to_string(ouster::sdk_thread_count()));
+    return true;
+}();
+
+}  // namespace
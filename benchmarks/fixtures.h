@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * Synthetic inputs of the benchmarks, generated rather than read from data
+ * files so that results only depend on the code being measured.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ouster/impl/lidar_scan_impl.h"
+#include "ouster/impl/packet_writer.h"
+#include "ouster/lidar_scan.h"
+#include "ouster/types.h"
+
+namespace ouster {
+namespace benchmarks {
+
+// a 1024x10, 64 beam sensor sending the given profile
+inline sensor::sensor_info synthetic_info(sensor::UDPProfileLidar profile) {
+    auto info = sensor::default_sensor_info(sensor::MODE_1024x10);
+    info.format.udp_profile_lidar = profile;
+    return info;
+}
+
+// a complete scan of the sensor, its channel fields filled with random values
+// within what their packet fields can hold
+inline LidarScan random_scan(const sensor::sensor_info& info,
+                             uint32_t seed = 0xdeadbeef) {
+    const auto& pf = sensor::get_format(info);
+    LidarScan scan(info.format.columns_per_frame,
+                   info.format.pixels_per_column, info.format.udp_profile_lidar,
+                   info.format.columns_per_packet);
+    std::iota(scan.measurement_id().data(),
+              scan.measurement_id().data() + scan.measurement_id().size(), 0);
+    std::iota(scan.packet_timestamp().data(),
+              scan.packet_timestamp().data() + scan.packet_timestamp().size(),
+              10);
+    std::iota(scan.timestamp().data(),
+              scan.timestamp().data() + scan.timestamp().size(), 1000);
+    std::fill(scan.status().data(), scan.status().data() + scan.status().size(),
+              0x1);
+    scan.frame_id = 1;
+
+    std::mt19937 gen(seed);
+    impl::foreach_channel_field(
+        scan, pf, [&](auto field, const std::string& name) {
+            using T = typename decltype(field)::Scalar;
+            std::uniform_int_distribution<uint64_t> d(
+                0, pf.field_value_mask(name));
+            for (int i = 0; i < field.size(); i++) {
+                field.data()[i] = static_cast<T>(d(gen));
+            }
+        });
+    return scan;
+}
+
+// the packets the sensor would send for scan
+inline std::vector<sensor::LidarPacket> scan_packets(
+    const sensor::sensor_info& info, const LidarScan& scan) {
+    sensor::impl::packet_writer pw{sensor::get_format(info)};
+    std::vector<sensor::LidarPacket> packets;
+    impl::scan_to_packets(scan, pw, std::back_inserter(packets), 0, 0);
+    return packets;
+}
+
+}  // namespace benchmarks
+}  // namespace ouster
@@ -0,0 +1,115 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+
+#include "fixtures.h"
+#include "ouster/field.h"
+#include "ouster/osf/png_lidarscan_encoder.h"
+#include "ouster/osf/reader.h"
+#include "ouster/osf/stream_lidar_scan.h"
+#include "ouster/osf/writer.h"
+#include "png_tools.h"
+
+using namespace ouster;
+using namespace ouster::benchmarks;
+
+namespace {
+
+const size_t scans_per_file = 10;
+
+// a 1024x128 image of random values of T, each with up to bits bits
+template <typename T>
+Field random_image(int bits) {
+    Field field{FieldDescriptor::array<T>({128, 1024})};
+    std::mt19937_64 gen(0xdeadbeef);
+    std::uniform_int_distribution<uint64_t> d(
+        0, bits == 64 ? ~uint64_t{0} : (uint64_t{1} << bits) - 1);
+    T* data = field.get<T>();
+    for (size_t i = 0; i < 128 * 1024; i++) data[i] = static_cast<T>(d(gen));
+    return field;
+}
+
+template <typename T>
+void BM_PngEncode(benchmark::State& state) {
+    const int bits = static_cast<int>(state.range(0));
+    const auto image = random_image<T>(bits);
+    osf::PngLidarScanEncoder encoder(1);
+    size_t encoded = 0;
+    for (auto _ : state) {
+        auto buf = encoder.encodeField(image);
+        encoded = buf.size();
+        benchmark::DoNotOptimize(buf.data());
+    }
+    state.counters["compressed_bytes"] = static_cast<double>(encoded);
+    state.SetBytesProcessed(state.iterations() * image.bytes());
+}
+
+template <typename T>
+void BM_PngDecode(benchmark::State& state) {
+    const int bits = static_cast<int>(state.range(0));
+    const auto image = random_image<T>(bits);
+    const auto buf = osf::PngLidarScanEncoder(1).encodeField(image);
+    Field decoded{image.desc()};
+    for (auto _ : state) {
+        osf::decodeField(decoded, buf);
+        benchmark::DoNotOptimize(decoded.get<T>());
+    }
+    state.SetBytesProcessed(state.iterations() * image.bytes());
+}
+
+const std::string osf_file = "ouster_benchmarks_tmp.osf";
+
+void write_osf(const sensor::sensor_info& info, const LidarScan& scan) {
+    osf::Writer writer(osf_file, info);
+    for (size_t i = 0; i < scans_per_file; i++) {
+        writer.save(0, scan, osf::ts_t(static_cast<int64_t>(i) * 100000000));
+    }
+    writer.close();
+}
+
+void BM_OsfWrite(benchmark::State& state) {
+    const auto info = synthetic_info(sensor::PROFILE_RNG19_RFL8_SIG16_NIR16);
+    const auto scan = random_scan(info);
+    for (auto _ : state) write_osf(info, scan);
+    std::remove(osf_file.c_str());
+    state.SetItemsProcessed(state.iterations() * scans_per_file);
+}
+
+void BM_OsfRead(benchmark::State& state) {
+    const auto info = synthetic_info(sensor::PROFILE_RNG19_RFL8_SIG16_NIR16);
+    write_osf(info, random_scan(info));
+    size_t scans = 0;
+    for (auto _ : state) {
+        osf::Reader reader(osf_file);
+        for (const auto& msg : reader.messages()) {
+            auto scan = msg.decode_msg<osf::LidarScanStream>();
+            benchmark::DoNotOptimize(scan.get());
+            scans++;
+        }
+    }
+    std::remove(osf_file.c_str());
+    state.SetItemsProcessed(static_cast<int64_t>(scans));
+}
+
+}  // namespace
+
+// bit depths of the channel fields of the lidar profiles
+BENCHMARK_TEMPLATE(BM_PngEncode, uint8_t)->Arg(8);
+BENCHMARK_TEMPLATE(BM_PngEncode, uint16_t)->Arg(16);
+BENCHMARK_TEMPLATE(BM_PngEncode, uint32_t)->Arg(19)->Arg(32);
+BENCHMARK_TEMPLATE(BM_PngEncode, uint64_t)->Arg(64);
+BENCHMARK_TEMPLATE(BM_PngDecode, uint8_t)->Arg(8);
+BENCHMARK_TEMPLATE(BM_PngDecode, uint16_t)->Arg(16);
+BENCHMARK_TEMPLATE(BM_PngDecode, uint32_t)->Arg(19)->Arg(32);
+BENCHMARK_TEMPLATE(BM_PngDecode, uint64_t)->Arg(64);
+BENCHMARK(BM_OsfWrite)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_OsfRead)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,66 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "fixtures.h"
+#include "ouster/os_pcap.h"
+#include "ouster/pcap.h"
+
+using namespace ouster;
+using namespace ouster::benchmarks;
+
+namespace {
+
+const std::string pcap_file = "ouster_benchmarks_tmp.pcap";
+const size_t scans_per_file = 10;
+
+// records scans_per_file scans, the lidar packets fragmented over frag_size
+size_t write_pcap(int frag_size) {
+    const auto info = synthetic_info(sensor::PROFILE_RNG19_RFL8_SIG16_NIR16);
+    auto packets = scan_packets(info, random_scan(info));
+    sensor::impl::packet_writer pw{sensor::get_format(info)};
+    auto handle = sensor_utils::record_initialize(pcap_file, frag_size);
+    uint64_t ts = 0;
+    size_t count = 0;
+    for (uint32_t frame_id = 0; frame_id < scans_per_file; frame_id++) {
+        for (auto& packet : packets) {
+            pw.set_frame_id(packet.buf.data(), frame_id);
+            sensor_utils::record_packet(*handle, "127.0.0.1", "127.0.0.1",
+                                        7502, 7502, packet.buf.data(),
+                                        packet.buf.size(), ts += 100);
+            count++;
+        }
+    }
+    sensor_utils::record_uninitialize(*handle);
+    return count;
+}
+
+void BM_PcapRead(benchmark::State& state) {
+    const size_t count = write_pcap(static_cast<int>(state.range(0)));
+    size_t bytes = 0;
+    {
+        sensor_utils::PcapReader reader(pcap_file);
+        for (auto _ : state) {
+            reader.reset();
+            while (size_t size = reader.next_packet()) {
+                benchmark::DoNotOptimize(reader.current_data());
+                bytes += size;
+            }
+        }
+    }
+    std::remove(pcap_file.c_str());
+    state.SetItemsProcessed(state.iterations() * count);
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+
+}  // namespace
+
+// unfragmented and reassembled from a 1500 byte MTU
+BENCHMARK(BM_PcapRead)->Arg(65535)->Arg(1500)->Unit(benchmark::kMillisecond);
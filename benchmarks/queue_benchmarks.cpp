@@ -0,0 +1,102 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+
+#include "ouster/concurrent_queue.h"
+#include "ouster/impl/threadsafe_queue.h"
+
+using namespace ouster;
+
+namespace {
+
+// elements handed from a producer thread to the benchmark thread per
+// iteration, through queues the size of a SensorClient packet ring
+const int items_per_iteration = 1024;
+const size_t queue_capacity = 128;
+
+void BM_Queue_ThreadsafeQueue(benchmark::State& state) {
+    ThreadsafeQueue<uint64_t> queue(queue_capacity);
+    std::atomic<bool> stop{false};
+    std::thread producer([&] {
+        try {
+            for (uint64_t i = 0; !stop; i++) queue.push(uint64_t{i});
+        } catch (const std::logic_error&) {
+            // shut down
+        }
+    });
+    for (auto _ : state) {
+        for (int i = 0; i < items_per_iteration; i++) {
+            benchmark::DoNotOptimize(queue.pop());
+        }
+    }
+    stop = true;
+    queue.shutdown();
+    while (queue.pop()) {
+    }
+    producer.join();
+    state.SetItemsProcessed(state.iterations() * items_per_iteration);
+}
+
+template <typename Queue>
+void BM_Queue_Blocking(benchmark::State& state) {
+    BlockingQueue<Queue> queue(queue_capacity);
+    std::thread producer([&] {
+        for (uint64_t i = 0; queue.push(i); i++) {
+        }
+    });
+    uint64_t out = 0;
+    for (auto _ : state) {
+        for (int i = 0; i < items_per_iteration; i++) {
+            queue.pop(out);
+            benchmark::DoNotOptimize(out);
+        }
+    }
+    queue.close();
+    producer.join();
+    state.SetItemsProcessed(state.iterations() * items_per_iteration);
+}
+
+// polling both ends, as the SensorClient buffer thread does when busy
+// waiting is enabled
+void BM_Queue_SpscTry(benchmark::State& state) {
+    SpscQueue<uint64_t> queue(queue_capacity);
+    std::atomic<bool> stop{false};
+    std::thread producer([&] {
+        for (uint64_t i = 0; !stop;) {
+            if (queue.try_push(i)) {
+                i++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    uint64_t out = 0;
+    for (auto _ : state) {
+        for (int i = 0; i < items_per_iteration;) {
+            if (queue.try_pop(out)) {
+                benchmark::DoNotOptimize(out);
+                i++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+    stop = true;
+    producer.join();
+    state.SetItemsProcessed(state.iterations() * items_per_iteration);
+}
+
+}  // namespace
+
+BENCHMARK(BM_Queue_ThreadsafeQueue)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Queue_Blocking, SpscQueue<uint64_t>)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Queue_Blocking, MpmcQueue<uint64_t>)->UseRealTime();
+BENCHMARK(BM_Queue_SpscTry)->UseRealTime();
@@ -0,0 +1,33 @@
+find_package(PkgConfig QUIET)
+if(PKG_CONFIG_FOUND)
+  pkg_check_modules(PC_ZSTD QUIET libzstd)
+  if(PC_ZSTD_FOUND)
+    set(ZSTD_VERSION_STRING ${PC_ZSTD_VERSION})
+  endif()
+endif()
+
+find_path(ZSTD_INCLUDE_DIR
+  NAMES zstd.h
+  HINTS ${PC_ZSTD_INCLUDE_DIRS})
+
+find_library(ZSTD_LIBRARY
+  NAMES zstd zstd_static zstdlib
+  HINTS ${PC_ZSTD_LIBRARY_DIRS})
+
+if(NOT TARGET zstd::zstd)
+  add_library(zstd::zstd UNKNOWN IMPORTED)
+  set_target_properties(zstd::zstd PROPERTIES
+    INTERFACE_INCLUDE_DIRECTORIES "${ZSTD_INCLUDE_DIR}"
+    IMPORTED_LINK_INTERFACE_LANGUAGES "C"
+    IMPORTED_LOCATION "${ZSTD_LIBRARY}")
+endif()
+
+if(NOT OUSTER_SKIP_FIND_PACKAGE_STANDARD)
+  include(FindPackageHandleStandardArgs)
+  find_package_handle_standard_args(zstd
+    REQUIRED_VARS ZSTD_LIBRARY ZSTD_INCLUDE_DIR
+    VERSION_VAR ZSTD_VERSION_STRING)
+endif()
+mark_as_advanced(
+  ZSTD_INCLUDE_DIR
+  ZSTD_LIBRARY)
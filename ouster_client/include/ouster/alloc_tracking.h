@@ -0,0 +1,96 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Allocation counting, to verify pipelines don't allocate per scan
+ *
+ * Linking the ouster_alloc_tracking library into a test or debug build
+ * replaces the allocator of the whole process with one that counts every
+ * allocation, per thread and per tagged AllocScope, before passing it on.
+ * It is not part of ouster_client since replacing malloc is not something
+ * a library should do to its users. On glibc the C allocation functions
+ * are replaced, which catches allocations of C code and Eigen as well as
+ * operator new; elsewhere only operator new and delete are.
+ *
+ * A steady-state check looks like:
+ *
+ * @code
+ * process(scan);  // warm up pools and buffers
+ * ouster::alloc::AllocScope scope("process");
+ * process(scan);
+ * assert(scope.stats().allocations == 0);
+ * @endcode
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace alloc {
+
+/// Counts of allocations
+struct OUSTER_API_CLASS AllocStats {
+    uint64_t allocations = 0;  ///< blocks allocated, including reallocations
+    uint64_t frees = 0;        ///< blocks freed
+    uint64_t bytes = 0;        ///< bytes requested by the allocations
+};
+
+/// Check whether allocations are counted, which they are once the process
+/// has allocated through the replaced allocator
+/// @return true if the allocator is replaced
+OUSTER_API_FUNCTION
+bool tracking_active();
+
+/// Get the allocations of the calling thread since it started
+/// @return the counts of the thread
+OUSTER_API_FUNCTION
+AllocStats thread_stats();
+
+/// Get the allocations of every thread since the process started
+/// @return the counts of the process
+OUSTER_API_FUNCTION
+AllocStats process_stats();
+
+/// Get the allocations of the completed scopes with a tag, over every thread
+/// @return the counts of the tag, zero for tags never used
+OUSTER_API_FUNCTION
+AllocStats tag_stats(const char* tag  ///< [in] tag of the scopes
+);
+
+/// Reset the counts of every tag
+OUSTER_API_FUNCTION
+void reset_tag_stats();
+
+/// Counts the allocations of the thread it was created on until destroyed,
+/// including those of scopes nested in it. On destruction the counts are
+/// added to those of its tag. At most 64 distinct tags are kept; scopes of
+/// further tags are still counted but not added to any tag.
+class OUSTER_API_CLASS AllocScope {
+   public:
+    /// Start counting
+    OUSTER_API_FUNCTION
+    explicit AllocScope(const char* tag = nullptr  ///< [in] tag, may be null
+    );
+
+    OUSTER_API_FUNCTION
+    ~AllocScope();
+
+    AllocScope(const AllocScope&) = delete;
+    AllocScope& operator=(const AllocScope&) = delete;
+
+    /// Get the allocations counted so far
+    /// @return the counts of the scope
+    OUSTER_API_FUNCTION
+    AllocStats stats() const;
+
+   private:
+    const char* tag_;
+    AllocStats start_;
+};
+
+}  // namespace alloc
+}  // namespace ouster
@@ -33,8 +33,27 @@ enum client_state {
     EXIT = 8           ///< Client has exited
 };
 
+/**
+ * Source of the host_timestamp set on received packets.
+ *
+ * Kernel and hardware timestamps are recorded when the datagram arrives rather
+ * than when the SDK dequeues it, so they exclude scheduling and queueing
+ * latency. They are only supported on Linux.
+ */
+enum class ReceiveTimestampMode {
+    USERSPACE,  ///< Time the packet was read by the SDK (default)
+    KERNEL,     ///< Kernel software receive time (SO_TIMESTAMPNS)
+    HARDWARE    ///< NIC receive time (SO_TIMESTAMPING). Enables receive
+                ///< timestamping on the NIC, which needs CAP_NET_ADMIN unless
+                ///< it is already on. This is the raw time of the NIC's PTP
+                ///< hardware clock, which only matches the system clock used
+                ///< by the other modes when synchronized to it, for example
+                ///< with phc2sys. Falls back to the kernel software time per
+                ///< packet when the NIC does not provide one.
+};
+
 /** Minimum supported version. */
-const util::version min_version = {1, 12, 0, "", "", "", ""};
+const ouster::util::version min_version = {1, 12, 0, "", "", "", ""};
 
 /**
  * Initializes and configures ouster_client logs. This method should be invoked
@@ -153,6 +172,27 @@ std::shared_ptr<client> mtp_init_client(
 OUSTER_API_FUNCTION
 client_state poll_client(const client& cli, int timeout_sec = 1);
 
+/**
+ * Request kernel or hardware receive timestamps on the client sockets.
+ *
+ * When enabled, read_lidar_packet() and read_imu_packet() set the packet's
+ * host_timestamp from the socket receive timestamp instead of the time of the
+ * call.
+ *
+ * @param[in] cli client returned by init_client associated with the connection.
+ * @param[in] mode source of the packet host timestamps.
+ * @param[in] interface network interface to enable NIC timestamps on for
+ * ReceiveTimestampMode::HARDWARE. Empty uses the interface of the address the
+ * client sockets are bound to, which fails if they listen on every interface.
+ *
+ * @return true if the requested mode was enabled on both sockets. On failure
+ * timestamps are left off on both sockets and the client uses userspace
+ * timestamps.
+ */
+OUSTER_API_FUNCTION
+bool enable_receive_timestamps(client& cli, ReceiveTimestampMode mode,
+                               const std::string& interface = "");
+
 /**
  * Read lidar data from the sensor. Will not block.
  *
@@ -286,6 +326,11 @@ enum config_flags : uint8_t {
 /**
  * Set sensor config on sensor.
  *
+ * The config is diffed against the active config params of the sensor, and
+ * only when some differ, ignoring numeric representation, are all params sent
+ * in one request and the sensor reinitialized. Re-asserting the running
+ * configuration thus doesn't restart the sensor.
+ *
  * @throw runtime_error on failure to communcate with the sensor.
  * @throw invalid_argument when config parameters fail validation.
  *
@@ -301,6 +346,29 @@ bool set_config(const std::string& hostname, const sensor_config& config,
                 uint8_t config_flags = 0,
                 int timeout_sec = LONG_HTTP_REQUEST_TIMEOUT_SECONDS);
 
+namespace util {
+class SensorHttp;
+}
+
+/**
+ * Set sensor config on sensor through an existing http interface, see the
+ * hostname overload.
+ *
+ * @throw runtime_error on failure to communcate with the sensor.
+ * @throw invalid_argument when config parameters fail validation.
+ *
+ * @param[in] sensor_http http interface of the sensor.
+ * @param[in] config sensor config.
+ * @param[in] config_flags flags to pass in.
+ * @param[in] timeout_sec timeout in seconds for http requests
+ *
+ * @return true if config params successfuly set on sensor.
+ */
+OUSTER_API_FUNCTION
+bool set_config(util::SensorHttp& sensor_http, const sensor_config& config,
+                uint8_t config_flags = 0,
+                int timeout_sec = LONG_HTTP_REQUEST_TIMEOUT_SECONDS);
+
 /**
  * Return the port used to listen for lidar UDP data.
  *
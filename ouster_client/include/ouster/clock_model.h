@@ -0,0 +1,133 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Mapping sensor timestamps to host time
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace sensor {
+
+/// Name of the column field of host timestamps, in ns, that
+/// SensorScanSource adds to scans with ReceiveThreadOptions::align_clocks
+static constexpr const char* HOST_TIMESTAMP_FIELD = "HOST_TIMESTAMP";
+
+/// Options of a ClockModel
+struct OUSTER_API_CLASS ClockModelOptions {
+    /// Span of sensor time in seconds the model is fit over. Longer windows
+    /// average out more jitter, shorter ones follow drifting clocks better.
+    double window_sec = 10.0;
+
+    /// Number of intervals the window is split into. The sample of least
+    /// delay in each interval is kept for the fit.
+    size_t intervals = 20;
+
+    /// Jump in seconds between the sensor time of consecutive samples, back
+    /// or forward, treated as a reset of the sensor clock, e.g. a restart
+    /// counting from zero with TIME_FROM_INTERNAL_OSC, discarding the
+    /// samples before it
+    double reset_sec = 5.0;
+};
+
+/// The fit of a ClockModel, host = sensor + offset_ns + skew * (sensor -
+/// sensor_ts)
+struct OUSTER_API_CLASS ClockEstimate {
+    bool valid = false;      ///< false until the first sample
+    uint64_t sensor_ts = 0;  ///< sensor time in ns the offset refers to
+    int64_t offset_ns = 0;   ///< host minus sensor time at sensor_ts
+    double skew_ppm = 0;     ///< rate of the host clock over the sensor one,
+                             ///< minus one, in parts per million
+    size_t intervals = 0;    ///< intervals with a sample the fit is based on
+    double residual_ns = 0;  ///< median distance of the samples to the fit
+    uint64_t resets = 0;     ///< sensor clock resets seen
+};
+
+/// Estimates the offset and skew of the clock of a sensor against the host
+/// clock from pairs of sensor timestamps and host receive timestamps, e.g.
+/// of every packet, whether the sensor counts from power on
+/// (TIME_FROM_INTERNAL_OSC), follows a sync pulse or PTP.
+///
+/// Network and scheduling delays only ever add to the receive time, so the
+/// sample of least delay in each interval of the window is the closest to
+/// the true offset, and a Theil-Sen line through those, the median of the
+/// slopes between them, ignores intervals whose samples were all held up,
+/// e.g. by a stalled consumer. The constant part of the delay, from the
+/// measurement to the receive time, is part of the offset. Kernel receive
+/// timestamps, see ReceiveTimestampMode, reduce the jitter of the fit.
+///
+/// Adding samples is cheap, the fit is redone lazily on the next
+/// conversion. Not thread safe.
+class OUSTER_API_CLASS ClockModel {
+   public:
+    /// Construct a model without samples
+    OUSTER_API_FUNCTION
+    explicit ClockModel(const ClockModelOptions& options = {}  ///< [in]
+    );
+
+    /// Add a sample
+    OUSTER_API_FUNCTION
+    void add(uint64_t sensor_ts,  ///< [in] sensor time in ns
+             uint64_t host_ts     ///< [in] host receive time in ns
+    );
+
+    /// Add a sample per packet of a scan, pairing the packet_timestamp of
+    /// each packet with the timestamp of its last valid column. Packets
+    /// without a host timestamp are skipped.
+    OUSTER_API_FUNCTION
+    void add(const LidarScan& scan  ///< [in] batched scan
+    );
+
+    /// Get the current fit
+    /// @return the estimate
+    OUSTER_API_FUNCTION
+    ClockEstimate estimate();
+
+    /// Convert a sensor time to host time
+    /// @return the host time in ns, or 0 for 0 or without samples
+    OUSTER_API_FUNCTION
+    uint64_t to_host(uint64_t sensor_ts  ///< [in] sensor time in ns
+    );
+
+    /// Convert an array of sensor times to host time, e.g. the column
+    /// timestamps of a scan. Zeros, as of missing columns, stay zero.
+    /// Without samples the output is all zeros. In and out may be the same.
+    OUSTER_API_FUNCTION
+    void to_host(const uint64_t* sensor_ts,  ///< [in] sensor times in ns
+                 size_t n,                   ///< [in] number of times
+                 uint64_t* host_ts           ///< [out] host times in ns
+    );
+
+    /// Forget every sample
+    OUSTER_API_FUNCTION
+    void reset();
+
+   private:
+    struct Interval {
+        int64_t index;       // sensor time over the interval length
+        uint64_t sensor_ts;  // sensor time of the least delayed sample
+        int64_t delay;       // host minus sensor time of that sample
+    };
+
+    /// Redo the fit if samples were added since
+    void fit();
+
+    ClockModelOptions options_;
+    int64_t interval_ns_;
+    uint64_t last_sensor_ts_{0};
+    std::deque<Interval> intervals_;
+    bool dirty_{false};
+    ClockEstimate estimate_;
+};
+
+}  // namespace sensor
+}  // namespace ouster
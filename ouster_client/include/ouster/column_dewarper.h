@@ -0,0 +1,96 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Dewarping column ranges of scans as they are batched
+ */
+
+#pragma once
+
+#include <Eigen/Core>
+#include <cstddef>
+#include <functional>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/types.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+/// Projects and dewarps the pixels of ranges of columns of scans into a
+/// persistent buffer of points, e.g. the sectors of a scan streamed by
+/// ScanBatcher::set_sector_callback, so that world frame points of the first
+/// columns are available before the scan is complete. The pose of each column
+/// comes from a pose source queried with the column timestamps, typically a
+/// predictor extrapolating the latest motion estimate forward in time.
+///
+/// Points are the same as those of pose_util::cartesian_dewarp() with the
+/// poses of the source as the column poses.
+class OUSTER_API_CLASS ColumnDewarper {
+   public:
+    /// Writes the pose of every timestamp, as flattened 4x4 matrices, to the
+    /// rows of poses
+    using PoseSource =
+        std::function<void(Eigen::Ref<pose_util::Poses> poses,
+                           const Eigen::Ref<const Eigen::ArrayXd>& ts)>;
+
+    /// @throw invalid_argument if the lut doesn't have w * h rows or the pose
+    /// source is empty
+    OUSTER_API_FUNCTION ColumnDewarper(
+        XYZLut lut,         ///< [in] lut from make_xyz_lut
+        size_t w,           ///< [in] width of the scans
+        size_t h,           ///< [in] height of the scans
+        PoseSource source,  ///< [in] poses at column timestamps in ns
+        const mat4d& extrinsic = mat4d::Identity());  ///< [in] applied after
+                                                      ///< the poses
+
+    /// Take the column poses from a trajectory whose knot timestamps are in
+    /// ns, extrapolating its last segment for columns after the last knot.
+    ///
+    /// @throw invalid_argument if the lut doesn't have w * h rows
+    OUSTER_API_FUNCTION ColumnDewarper(
+        XYZLut lut,  ///< [in] lut from make_xyz_lut
+        size_t w,    ///< [in] width of the scans
+        size_t h,    ///< [in] height of the scans
+        const pose_util::TrajectoryEvaluator& trajectory,  ///< [in] poses
+        const mat4d& extrinsic = mat4d::Identity());  ///< [in] applied after
+                                                      ///< the poses
+
+    /// Project and dewarp the pixels of a range of columns of a scan into the
+    /// buffer, leaving the rows of the other columns unchanged. Pixels with a
+    /// zero range become the origin of their column pose.
+    ///
+    /// @throw invalid_argument if the scan size doesn't match or the window
+    /// is out of the scan, or rethrow the errors of the pose source
+    OUSTER_API_FUNCTION void dewarp(
+        const LidarScan& scan,  ///< [in] scan with a RANGE field
+        sensor::ColumnWindow window);  ///< [in] first and last column,
+                                       ///< wrapping around the end of the
+                                       ///< scan if the first is greater
+
+    /// Dewarp the columns of a sector streamed by a ScanBatcher, see
+    /// dewarp(const LidarScan&, sensor::ColumnWindow).
+    OUSTER_API_FUNCTION void dewarp(
+        const ScanSector& sector);  ///< [in] sector of the scan being batched
+
+    /// @return the points of every pixel of the scans in pixel order, as
+    /// cartesian(), of shape (w * h, 3)
+    OUSTER_API_FUNCTION const pose_util::Points& points() const;
+
+    /// @return the poses of every column last dewarped, of shape (w, 16)
+    OUSTER_API_FUNCTION const pose_util::Poses& poses() const;
+
+   private:
+    XYZLut lut_;
+    size_t w_;
+    size_t h_;
+    PoseSource source_;
+    mat4d extrinsic_;
+    pose_util::Points points_;
+    pose_util::Poses poses_;
+    Eigen::ArrayXd ts_;
+    pose_util::Poses window_poses_;
+};
+
+}  // namespace ouster
@@ -0,0 +1,421 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Bounded queues for handing data between threads
+ *
+ * SpscQueue and MpmcQueue are lock free and never allocate after
+ * construction. Their indices are kept on separate cache lines, so that
+ * producers and consumers don't slow each other down by writing to the same
+ * line. BlockingQueue adds waiting to either, through a Waiter which only
+ * takes a lock once a thread actually has to sleep.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "ouster/impl/spin_wait.h"
+
+namespace ouster {
+
+/// Bounded lock free queue for one producer and one consumer thread.
+///
+/// Each side keeps a cached copy of the index of the other, so that pushing
+/// to a queue with room or popping from a queue with elements doesn't read
+/// the cache line the other side writes. Elements are stored in slots
+/// constructed up front: T must be default constructible and move
+/// assignable.
+template <typename T>
+class SpscQueue {
+   public:
+    /// Type of the elements
+    using value_type = T;
+
+    /// Construct an empty queue
+    /// @throw std::invalid_argument if capacity is zero
+    explicit SpscQueue(size_t capacity)
+        : capacity_(capacity),
+          slots_(capacity),
+          write_(0),
+          cached_read_(0),
+          read_(0),
+          cached_write_(0) {
+        if (capacity == 0) {
+            throw std::invalid_argument("SpscQueue: capacity must be > 0");
+        }
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /// Add an element, built from args, unless the queue is full. The args
+    /// are left untouched if it is. Producer thread only.
+    /// @return false if the queue was full
+    template <typename... Args>
+    bool try_emplace(Args&&... args) {
+        const size_t w = write_.load(std::memory_order_relaxed);
+        if (w - cached_read_ == capacity_) {
+            cached_read_ = read_.load(std::memory_order_acquire);
+            if (w - cached_read_ == capacity_) return false;
+        }
+        slots_[w % capacity_] = T(std::forward<Args>(args)...);
+        write_.store(w + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Add an element unless the queue is full. Producer thread only.
+    /// @return false if the queue was full
+    bool try_push(const T& value) { return try_emplace(value); }
+
+    /// Add an element unless the queue is full, leaving it untouched if so.
+    /// Producer thread only.
+    /// @return false if the queue was full
+    bool try_push(T&& value) { return try_emplace(std::move(value)); }
+
+    /// Take the oldest element unless the queue is empty. Consumer thread
+    /// only.
+    /// @return false if the queue was empty
+    bool try_pop(T& out) {
+        const size_t r = read_.load(std::memory_order_relaxed);
+        if (r == cached_write_) {
+            cached_write_ = write_.load(std::memory_order_acquire);
+            if (r == cached_write_) return false;
+        }
+        out = std::move(slots_[r % capacity_]);
+        read_.store(r + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Get the number of elements queued, only approximate while the other
+    /// thread is pushing or popping
+    /// @return the number of elements
+    size_t size() const {
+        const size_t r = read_.load(std::memory_order_acquire);
+        const size_t w = write_.load(std::memory_order_acquire);
+        return w > r ? w - r : 0;
+    }
+
+    /// Check whether the queue is empty, see size()
+    /// @return true if empty
+    bool empty() const { return size() == 0; }
+
+    /// Get the most elements the queue holds
+    /// @return the capacity
+    size_t capacity() const { return capacity_; }
+
+   private:
+    const size_t capacity_;
+    std::vector<T> slots_;
+    // written by the producer
+    char pad0_[64];
+    std::atomic<size_t> write_;
+    size_t cached_read_;
+    // written by the consumer
+    char pad1_[64];
+    std::atomic<size_t> read_;
+    size_t cached_write_;
+    char pad2_[64];
+};
+
+/// Bounded lock free queue for any number of producer and consumer threads.
+///
+/// Each slot carries a sequence number handing it from producers to
+/// consumers and back, as in the bounded MPMC queue of Dmitry Vyukov, so an
+/// operation only contends on the index of its side. The sequence counts
+/// two steps per pass over the slots, so that any capacity works. T must be
+/// default constructible and move assignable.
+template <typename T>
+class MpmcQueue {
+   public:
+    /// Type of the elements
+    using value_type = T;
+
+    /// Construct an empty queue
+    /// @throw std::invalid_argument if capacity is zero
+    explicit MpmcQueue(size_t capacity)
+        : capacity_(capacity), enqueue_(0), dequeue_(0) {
+        if (capacity == 0) {
+            throw std::invalid_argument("MpmcQueue: capacity must be > 0");
+        }
+        slots_.reset(new Slot[capacity]);
+        for (size_t i = 0; i < capacity; i++) {
+            slots_[i].seq.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    /// Add an element, built from args, unless the queue is full. The args
+    /// are left untouched if it is.
+    /// @return false if the queue was full
+    template <typename... Args>
+    bool try_emplace(Args&&... args) {
+        size_t pos = enqueue_.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots_[pos % capacity_];
+            const size_t turn = pos / capacity_;
+            const size_t seq = slot.seq.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq) -
+                              static_cast<std::ptrdiff_t>(2 * turn);
+            if (diff == 0) {
+                if (enqueue_.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.value = T(std::forward<Args>(args)...);
+                    slot.seq.store(2 * turn + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                // still holds the element of the previous turn
+                return false;
+            } else {
+                pos = enqueue_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Add an element unless the queue is full
+    /// @return false if the queue was full
+    bool try_push(const T& value) { return try_emplace(value); }
+
+    /// Add an element unless the queue is full, leaving it untouched if so
+    /// @return false if the queue was full
+    bool try_push(T&& value) { return try_emplace(std::move(value)); }
+
+    /// Take the oldest element unless the queue is empty
+    /// @return false if the queue was empty
+    bool try_pop(T& out) {
+        size_t pos = dequeue_.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots_[pos % capacity_];
+            const size_t turn = pos / capacity_;
+            const size_t seq = slot.seq.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq) -
+                              static_cast<std::ptrdiff_t>(2 * turn + 1);
+            if (diff == 0) {
+                if (dequeue_.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed)) {
+                    out = std::move(slot.value);
+                    slot.seq.store(2 * turn + 2, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                // not written yet in this turn
+                return false;
+            } else {
+                pos = dequeue_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Get the number of elements queued, only approximate while other
+    /// threads are pushing or popping
+    /// @return the number of elements
+    size_t size() const {
+        const size_t r = dequeue_.load(std::memory_order_acquire);
+        const size_t w = enqueue_.load(std::memory_order_acquire);
+        return w > r ? std::min(w - r, capacity_) : 0;
+    }
+
+    /// Check whether the queue is empty, see size()
+    /// @return true if empty
+    bool empty() const { return size() == 0; }
+
+    /// Get the most elements the queue holds
+    /// @return the capacity
+    size_t capacity() const { return capacity_; }
+
+   private:
+    struct Slot {
+        std::atomic<size_t> seq;
+        T value;
+    };
+
+    const size_t capacity_;
+    std::unique_ptr<Slot[]> slots_;
+    char pad0_[64];
+    std::atomic<size_t> enqueue_;
+    char pad1_[64];
+    std::atomic<size_t> dequeue_;
+    char pad2_[64];
+};
+
+/// Lets threads sleep until a condition on lock free data holds, as a futex
+/// would: waiting spins briefly, then sleeps on a condition variable, and
+/// notifying only takes the lock when a thread sleeps. Notifiers must make
+/// the condition true before calling notify_all.
+class Waiter {
+   public:
+    /// Wait until ready returns true
+    /// @return false if the timeout expired first
+    template <typename F>
+    bool wait(F&& ready,              ///< [in] condition to wait for
+              double timeout_sec = -1  ///< [in] timeout, negative for none
+    ) {
+        if (ready()) return true;
+        // most waits on a busy queue end sooner than a sleep would
+        sensor::impl::SpinBackoff backoff;
+        for (int i = 0; i < spins; i++) {
+            backoff.wait();
+            if (ready()) return true;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        sleepers_.fetch_add(1);
+        // pairs with the fence in notify_all: either the notifier sees the
+        // sleeper, or the sleeper sees the condition it made true
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool result = true;
+        if (timeout_sec < 0) {
+            cv_.wait(lock, ready);
+        } else {
+            result = cv_.wait_for(
+                lock, std::chrono::duration<double>(timeout_sec), ready);
+        }
+        sleepers_.fetch_sub(1, std::memory_order_relaxed);
+        return result;
+    }
+
+    /// Wake the waiting threads to check their conditions again
+    void notify_all() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers_.load(std::memory_order_relaxed) == 0) return;
+        // a sleeper holds the lock from checking its condition to sleeping
+        { std::lock_guard<std::mutex> lock(mutex_); }
+        cv_.notify_all();
+    }
+
+   private:
+    static constexpr int spins = 8;
+    std::atomic<int> sleepers_{0};
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
+
+/// Adds blocking push and pop, with timeouts and closing, to a SpscQueue or
+/// MpmcQueue. Threads only sleep when the queue is full or empty.
+template <typename Queue>
+class BlockingQueue {
+   public:
+    /// Type of the elements
+    using value_type = typename Queue::value_type;
+
+    /// Construct an empty queue
+    /// @throw std::invalid_argument if capacity is zero
+    explicit BlockingQueue(size_t capacity) : queue_(capacity) {}
+
+    BlockingQueue(const BlockingQueue&) = delete;
+    BlockingQueue& operator=(const BlockingQueue&) = delete;
+
+    /// Add an element, waiting for room while the queue is full
+    /// @return false if the queue was closed or the timeout expired, in
+    /// which case value is left untouched
+    template <typename U>
+    bool push(U&& value,               ///< [in] element to add
+              double timeout_sec = -1  ///< [in] timeout, negative for none
+    ) {
+        const auto deadline = deadline_of(timeout_sec);
+        while (!closed()) {
+            if (try_push(std::forward<U>(value))) return true;
+            if (!not_full_.wait(
+                    [this] {
+                        return closed() ||
+                               queue_.size() < queue_.capacity();
+                    },
+                    remaining(timeout_sec, deadline))) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    /// Add an element unless the queue is full or closed
+    /// @return false if the element wasn't added
+    template <typename U>
+    bool try_push(U&& value) {
+        if (closed() || !queue_.try_push(std::forward<U>(value))) {
+            return false;
+        }
+        not_empty_.notify_all();
+        return true;
+    }
+
+    /// Take the oldest element, waiting while the queue is empty. Elements
+    /// queued before the queue was closed are still handed out.
+    /// @return false if the queue is closed and empty or the timeout expired
+    bool pop(value_type& out,         ///< [out] element taken
+             double timeout_sec = -1  ///< [in] timeout, negative for none
+    ) {
+        const auto deadline = deadline_of(timeout_sec);
+        while (true) {
+            if (try_pop(out)) return true;
+            if (closed() && queue_.empty()) return false;
+            if (!not_empty_.wait(
+                    [this] { return closed() || !queue_.empty(); },
+                    remaining(timeout_sec, deadline))) {
+                return false;
+            }
+        }
+    }
+
+    /// Take the oldest element unless the queue is empty
+    /// @return false if the queue was empty
+    bool try_pop(value_type& out) {
+        if (!queue_.try_pop(out)) return false;
+        not_full_.notify_all();
+        return true;
+    }
+
+    /// Close the queue: pushes fail from now on, and pops fail once the
+    /// elements left are taken. Wakes all waiting threads.
+    void close() {
+        closed_.store(true);
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+    /// Check whether the queue was closed
+    /// @return true if closed
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+
+    /// Get the number of elements queued, see Queue::size()
+    /// @return the number of elements
+    size_t size() const { return queue_.size(); }
+
+    /// Get the most elements the queue holds
+    /// @return the capacity
+    size_t capacity() const { return queue_.capacity(); }
+
+   private:
+    using clock = std::chrono::steady_clock;
+
+    static clock::time_point deadline_of(double timeout_sec) {
+        if (timeout_sec < 0) return clock::time_point::max();
+        return clock::now() +
+               std::chrono::duration_cast<clock::duration>(
+                   std::chrono::duration<double>(timeout_sec));
+    }
+
+    static double remaining(double timeout_sec, clock::time_point deadline) {
+        if (timeout_sec < 0) return -1;
+        const std::chrono::duration<double> left = deadline - clock::now();
+        return std::max(0.0, left.count());
+    }
+
+    Queue queue_;
+    std::atomic<bool> closed_{false};
+    Waiter not_empty_;
+    Waiter not_full_;
+};
+
+}  // namespace ouster
@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Fast content hashes of fields and scans
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "ouster/field.h"
+#include "ouster/lidar_scan.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+/// Hash bytes in the style of XXH3: 64 byte stripes are accumulated into
+/// eight independent 64-bit lanes by 32 x 32 bit multiplies, which compilers
+/// vectorize, scrambled every kilobyte and folded by 128-bit multiplies at
+/// the end. The hash is the same on every platform and run, so it may be
+/// stored, e.g. to deduplicate archived recordings; it isn't cryptographic
+/// and isn't compatible with xxHash itself.
+///
+/// @return the 64-bit hash of the bytes
+OUSTER_API_FUNCTION uint64_t hash_bytes(
+    const void* data,   ///< [in] bytes to hash
+    size_t size,        ///< [in] number of bytes at data
+    uint64_t seed = 0   ///< [in] seed, e.g. to hash several buffers in turn
+);
+
+/// @return the hash of the type, shape, class and contents of a field
+OUSTER_API_FUNCTION uint64_t content_hash(
+    const Field& field  ///< [in] field to hash
+);
+
+/// Hash what LidarScan::equals() compares: the frame id, size, frame status,
+/// measurement ids, timestamps, packet timestamps, pose and every field,
+/// each by content_hash(). Equal scans have equal hashes, whatever the order
+/// of their fields.
+///
+/// Hashing reads every byte of a scan, like comparing two scans does, so it
+/// pays off when a hash is computed once per scan and compared many times,
+/// e.g. with HashedScan or a table of the hashes of the scans seen so far.
+///
+/// @return the hash of the contents of the scan
+OUSTER_API_FUNCTION uint64_t content_hash(
+    const LidarScan& scan  ///< [in] scan to hash
+);
+
+/// A read-only scan with its content_hash() computed once, for sets of
+/// distinct scans: equality compares the hashes first and the contents of
+/// the scans only if the hashes match.
+///
+///     std::unordered_set<HashedScan> seen;
+///     // for each scan
+///     if (seen.emplace(scan).second) keep(scan);
+struct OUSTER_API_CLASS HashedScan {
+    /// @throw std::invalid_argument if scan is null
+    OUSTER_API_FUNCTION explicit HashedScan(
+        std::shared_ptr<const LidarScan> scan  ///< [in] scan to hash
+    );
+
+    std::shared_ptr<const LidarScan> scan;  ///< the scan, never null
+    uint64_t hash;                          ///< content_hash() of the scan
+};
+
+/// @return true if the scans are equal, comparing their hashes first
+OUSTER_API_FUNCTION bool operator==(const HashedScan& a, const HashedScan& b);
+
+/// @return true if the scans differ, comparing their hashes first
+OUSTER_API_FUNCTION bool operator!=(const HashedScan& a, const HashedScan& b);
+
+}  // namespace ouster
+
+namespace std {
+
+/// Hash of a HashedScan, for unordered containers
+template <>
+struct hash<ouster::HashedScan> {
+    size_t operator()(const ouster::HashedScan& scan) const noexcept {
+        return static_cast<size_t>(scan.hash);
+    }
+};
+
+}  // namespace std
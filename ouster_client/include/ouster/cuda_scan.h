@@ -0,0 +1,639 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief GPU implementations of point cloud and image processing on device
+ * resident scans. Only available when built with -DBUILD_CUDA=ON, by linking
+ * OusterSDK::ouster_cuda.
+ */
+
+#pragma once
+
+#include <cuda_runtime_api.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ouster/field.h"
+#include "ouster/lidar_scan.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace cuda {
+
+namespace impl {
+
+/**
+ * Throw if a CUDA runtime call failed.
+ *
+ * @throw std::runtime_error with the CUDA error string if err isn't
+ * cudaSuccess.
+ *
+ * @param[in] err result of the CUDA runtime call.
+ * @param[in] what description of the call, used in the error message.
+ */
+OUSTER_API_FUNCTION
+void check(cudaError_t err, const char* what);
+
+/**
+ * Shift each row of a pixel field, see ouster::cuda::destagger.
+ *
+ * @param[in] img device pointer to the h x w row major field.
+ * @param[out] out device pointer to space for the shifted field.
+ * @param[in] pixel_bytes size of each pixel in bytes.
+ * @param[in] w width of the field.
+ * @param[in] h height of the field.
+ * @param[in] pixel_shift_by_row device pointer to h shifts.
+ * @param[in] inverse perform the inverse operation.
+ * @param[in] stream stream to run on.
+ */
+OUSTER_API_FUNCTION
+void destagger(const void* img, void* out, size_t pixel_bytes, size_t w,
+               size_t h, const int* pixel_shift_by_row, bool inverse,
+               cudaStream_t stream);
+
+}  // namespace impl
+
+/**
+ * Device memory for a number of elements, released on destruction. Contents
+ * are uninitialized.
+ *
+ * @tparam T the element type.
+ */
+template <typename T>
+class DeviceBuffer {
+    T* data_ = nullptr;
+    size_t size_ = 0;
+
+   public:
+    /** Construct an empty buffer. */
+    DeviceBuffer() = default;
+
+    /**
+     * Allocate device memory.
+     *
+     * @throw std::runtime_error if the allocation fails.
+     *
+     * @param[in] n number of elements.
+     */
+    explicit DeviceBuffer(size_t n) { resize(n); }
+
+    /**
+     * Allocate device memory and synchronously copy host data into it.
+     *
+     * @throw std::runtime_error if the allocation or copy fails.
+     *
+     * @param[in] host the elements to copy.
+     */
+    explicit DeviceBuffer(const std::vector<T>& host) : DeviceBuffer() {
+        resize(host.size());
+        copy_from(host.data(), host.size());
+        impl::check(cudaStreamSynchronize(0), "cudaStreamSynchronize");
+    }
+
+    ~DeviceBuffer() {
+        if (data_) cudaFree(data_);
+    }
+
+    DeviceBuffer(const DeviceBuffer&) = delete;
+    DeviceBuffer& operator=(const DeviceBuffer&) = delete;
+
+    DeviceBuffer(DeviceBuffer&& other) noexcept
+        : data_(other.data_), size_(other.size_) {
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+
+    DeviceBuffer& operator=(DeviceBuffer&& other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        return *this;
+    }
+
+    /**
+     * Reallocate the buffer if its size changes. Contents are lost.
+     *
+     * @throw std::runtime_error if the allocation fails.
+     *
+     * @param[in] n number of elements.
+     */
+    void resize(size_t n) {
+        if (n == size_) return;
+        if (data_) cudaFree(data_);
+        data_ = nullptr;
+        size_ = 0;
+        if (n == 0) return;
+        impl::check(cudaMalloc(reinterpret_cast<void**>(&data_), n * sizeof(T)),
+                    "cudaMalloc");
+        size_ = n;
+    }
+
+    /**
+     * Asynchronously copy elements from the host. For the copy to overlap
+     * with other work, host should be pinned memory, e.g. a PinnedBuffer.
+     *
+     * @throw std::invalid_argument if n exceeds the size of the buffer.
+     *
+     * @param[in] host the elements to copy.
+     * @param[in] n number of elements.
+     * @param[in] stream stream to copy on.
+     */
+    void copy_from(const T* host, size_t n, cudaStream_t stream = 0) {
+        if (n > size_)
+            throw std::invalid_argument("DeviceBuffer: copy exceeds size");
+        impl::check(cudaMemcpyAsync(data_, host, n * sizeof(T),
+                                    cudaMemcpyHostToDevice, stream),
+                    "cudaMemcpyAsync");
+    }
+
+    /**
+     * Asynchronously copy elements to the host. Synchronize the stream before
+     * reading them.
+     *
+     * @throw std::invalid_argument if n exceeds the size of the buffer.
+     *
+     * @param[out] host space for n elements.
+     * @param[in] n number of elements.
+     * @param[in] stream stream to copy on.
+     */
+    void copy_to(T* host, size_t n, cudaStream_t stream = 0) const {
+        if (n > size_)
+            throw std::invalid_argument("DeviceBuffer: copy exceeds size");
+        impl::check(cudaMemcpyAsync(host, data_, n * sizeof(T),
+                                    cudaMemcpyDeviceToHost, stream),
+                    "cudaMemcpyAsync");
+    }
+
+    /** @return device pointer to the elements. */
+    T* data() { return data_; }
+
+    /** @copydoc data() */
+    const T* data() const { return data_; }
+
+    /** @return number of elements. */
+    size_t size() const { return size_; }
+};
+
+/**
+ * Page locked host memory, which the GPU copies to and from asynchronously,
+ * released on destruction.
+ *
+ * @tparam T the element type.
+ */
+template <typename T>
+class PinnedBuffer {
+    T* data_ = nullptr;
+    size_t size_ = 0;
+
+   public:
+    /** Construct an empty buffer. */
+    PinnedBuffer() = default;
+
+    /**
+     * Allocate pinned host memory.
+     *
+     * @throw std::runtime_error if the allocation fails.
+     *
+     * @param[in] n number of elements.
+     */
+    explicit PinnedBuffer(size_t n) { resize(n); }
+
+    ~PinnedBuffer() {
+        if (data_) cudaFreeHost(data_);
+    }
+
+    PinnedBuffer(const PinnedBuffer&) = delete;
+    PinnedBuffer& operator=(const PinnedBuffer&) = delete;
+
+    PinnedBuffer(PinnedBuffer&& other) noexcept
+        : data_(other.data_), size_(other.size_) {
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+
+    PinnedBuffer& operator=(PinnedBuffer&& other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        return *this;
+    }
+
+    /**
+     * Reallocate the buffer if its size changes. Contents are lost.
+     *
+     * @throw std::runtime_error if the allocation fails.
+     *
+     * @param[in] n number of elements.
+     */
+    void resize(size_t n) {
+        if (n == size_) return;
+        if (data_) cudaFreeHost(data_);
+        data_ = nullptr;
+        size_ = 0;
+        if (n == 0) return;
+        impl::check(
+            cudaMallocHost(reinterpret_cast<void**>(&data_), n * sizeof(T)),
+            "cudaMallocHost");
+        size_ = n;
+    }
+
+    /** @return host pointer to the elements. */
+    T* data() { return data_; }
+
+    /** @copydoc data() */
+    const T* data() const { return data_; }
+
+    /** @return number of elements. */
+    size_t size() const { return size_; }
+};
+
+/**
+ * Fields and column poses of a scan in device memory, laid out back to back
+ * in a single allocation so that a scan moves with one copy.
+ */
+class OUSTER_API_CLASS DeviceScan {
+    struct entry {
+        FieldDescriptor desc;
+        size_t offset;
+    };
+
+    std::unordered_map<std::string, entry> fields_;
+    LidarScanFieldTypes field_types_;
+    size_t pose_offset_ = 0;
+    DeviceBuffer<uint8_t> arena_;
+
+    friend class ScanUploader;
+
+   public:
+    size_t w;  ///< width of the scan
+    size_t h;  ///< height of the scan
+
+    /**
+     * Allocate device memory for scans laid out like another scan.
+     *
+     * @throw std::invalid_argument if layout lacks one of the fields.
+     * @throw std::runtime_error if the allocation fails.
+     *
+     * @param[in] layout scan with the dimensions and fields to allocate.
+     * @param[in] fields names of the fields to allocate, or empty for all
+     * fields of layout.
+     */
+    OUSTER_API_FUNCTION
+    explicit DeviceScan(const LidarScan& layout,
+                        const std::vector<std::string>& fields = {});
+
+    /**
+     * Check whether the scan has a field.
+     *
+     * @param[in] name name of the field.
+     *
+     * @return true if the field was allocated.
+     */
+    OUSTER_API_FUNCTION
+    bool has_field(const std::string& name) const;
+
+    /**
+     * Get the descriptor of a field, as in LidarScan::field(name).desc().
+     *
+     * @throw std::invalid_argument if the scan lacks the field.
+     *
+     * @param[in] name name of the field.
+     *
+     * @return the descriptor.
+     */
+    OUSTER_API_FUNCTION
+    const FieldDescriptor& desc(const std::string& name) const;
+
+    /**
+     * Get the types of the fields of the scan.
+     *
+     * @return the field types.
+     */
+    OUSTER_API_FUNCTION
+    const LidarScanFieldTypes& field_types() const;
+
+    /**
+     * Get a device pointer to the data of a field.
+     *
+     * @throw std::invalid_argument if the scan lacks the field.
+     *
+     * @param[in] name name of the field.
+     *
+     * @return device pointer to the field, laid out as on the host.
+     */
+    OUSTER_API_FUNCTION
+    void* field(const std::string& name);
+
+    /** @copydoc field(const std::string&) */
+    OUSTER_API_FUNCTION
+    const void* field(const std::string& name) const;
+
+    /**
+     * Get a typed device pointer to the data of a field.
+     *
+     * @tparam T element type of the field.
+     *
+     * @throw std::invalid_argument if the scan lacks the field or its element
+     * type isn't T.
+     *
+     * @param[in] name name of the field.
+     *
+     * @return device pointer to the field, laid out as on the host.
+     */
+    template <typename T>
+    T* field(const std::string& name) {
+        if (desc(name).type != FieldDescriptor::type_hash<T>())
+            throw std::invalid_argument("DeviceScan: field '" + name +
+                                        "' type mismatch");
+        return static_cast<T*>(field(name));
+    }
+
+    /** @copydoc field(const std::string&) */
+    template <typename T>
+    const T* field(const std::string& name) const {
+        if (desc(name).type != FieldDescriptor::type_hash<T>())
+            throw std::invalid_argument("DeviceScan: field '" + name +
+                                        "' type mismatch");
+        return static_cast<const T*>(field(name));
+    }
+
+    /**
+     * Get the column poses, like LidarScan::pose().
+     *
+     * @return device pointer to w row major 4x4 matrices.
+     */
+    OUSTER_API_FUNCTION
+    double* pose();
+
+    /** @copydoc pose() */
+    OUSTER_API_FUNCTION
+    const double* pose() const;
+
+    /**
+     * Synchronously copy the fields and poses back into a host scan.
+     *
+     * @throw std::invalid_argument if the dimensions of dst differ or it
+     * lacks a field of this scan or has it with another descriptor.
+     *
+     * @param[out] dst the host scan.
+     * @param[in] stream stream to copy on.
+     */
+    OUSTER_API_FUNCTION
+    void download(LidarScan& dst, cudaStream_t stream = 0) const;
+};
+
+/**
+ * Uploads LidarScans into DeviceScans through a pinned staging buffer, so the
+ * copy to the GPU is asynchronous and runs at full bus speed.
+ *
+ * The staging buffer is reused by the next upload, which first waits for the
+ * previous copy to finish. Use one uploader per stream.
+ */
+class OUSTER_API_CLASS ScanUploader {
+    PinnedBuffer<uint8_t> staging_;
+    cudaEvent_t copied_ = nullptr;
+
+   public:
+    /**
+     * Construct an uploader.
+     *
+     * @throw std::runtime_error if the event can't be created.
+     */
+    OUSTER_API_FUNCTION
+    ScanUploader();
+
+    OUSTER_API_FUNCTION
+    ~ScanUploader();
+
+    ScanUploader(const ScanUploader&) = delete;
+    ScanUploader& operator=(const ScanUploader&) = delete;
+
+    /**
+     * Copy the fields and poses of a scan to the device. Returns once the
+     * scan is staged; the copy to the device completes in stream order.
+     *
+     * @throw std::invalid_argument if the dimensions of src differ or it lacks
+     * a field of dst or has it with another descriptor.
+     *
+     * @param[in] src the host scan.
+     * @param[out] dst the device scan.
+     * @param[in] stream stream to copy on.
+     */
+    OUSTER_API_FUNCTION
+    void upload(const LidarScan& src, DeviceScan& dst, cudaStream_t stream = 0);
+};
+
+/**
+ * Single precision lookup tables of beam directions and offsets in device
+ * memory, planar like XYZLutF.
+ */
+struct OUSTER_API_CLASS DeviceXYZLut {
+    size_t n = 0;                   ///< number of pixels
+    DeviceBuffer<float> direction;  ///< n x, then n y, then n z directions
+    DeviceBuffer<float> offset;     ///< n x, then n y, then n z offsets
+};
+
+/**
+ * Synchronously copy lookup tables to the device.
+ *
+ * @throw std::runtime_error if the allocation or copy fails.
+ *
+ * @param[in] lut lookup tables generated by make_xyz_lut_f.
+ *
+ * @return the lookup tables in device memory.
+ */
+OUSTER_API_FUNCTION
+DeviceXYZLut make_device_xyz_lut(const XYZLutF& lut);
+
+/**
+ * Project a staggered range image to Cartesian points, computing range *
+ * direction + offset for every nonzero range and a zero point for every zero
+ * range, like cartesian(range, XYZLutF).
+ *
+ * @param[in] range device pointer to lut.n ranges, e.g. the RANGE field of a
+ * DeviceScan.
+ * @param[in] lut lookup tables generated by make_device_xyz_lut.
+ * @param[out] xyz device pointer to space for 3 * lut.n floats, written as
+ * lut.n x, then y, then z values like PointsF.
+ * @param[in] stream stream to run on.
+ */
+OUSTER_API_FUNCTION
+void cartesian(const uint32_t* range, const DeviceXYZLut& lut, float* xyz,
+               cudaStream_t stream = 0);
+
+/**
+ * Project a device scan to Cartesian points, see cartesian(const uint32_t*,
+ * const DeviceXYZLut&, float*, cudaStream_t).
+ *
+ * @throw std::invalid_argument if the scan lacks a uint32_t RANGE field or
+ * its size doesn't match the lut.
+ *
+ * @param[in] scan a device scan with a RANGE field.
+ * @param[in] lut lookup tables generated by make_device_xyz_lut.
+ * @param[out] xyz device pointer to space for 3 * w * h floats.
+ * @param[in] stream stream to run on.
+ */
+OUSTER_API_FUNCTION
+void cartesian(const DeviceScan& scan, const DeviceXYZLut& lut, float* xyz,
+               cudaStream_t stream = 0);
+
+/**
+ * Project a staggered range image to Cartesian points with x, y and z of each
+ * point next to each other, like cartesian_interleaved.
+ *
+ * @param[in] range device pointer to lut.n ranges.
+ * @param[in] lut lookup tables generated by make_device_xyz_lut.
+ * @param[out] xyz device pointer to space for 3 * lut.n floats, the ith
+ * triplet is the point of the ith pixel.
+ * @param[in] stream stream to run on.
+ */
+OUSTER_API_FUNCTION
+void cartesian_interleaved(const uint32_t* range, const DeviceXYZLut& lut,
+                           float* xyz, cudaStream_t stream = 0);
+
+/**
+ * Generate a destaggered version of a pixel field in device memory, like
+ * destagger(img, pixel_shift_by_row, inverse).
+ *
+ * @tparam T the pixel type of the field.
+ *
+ * @param[in] img device pointer to the h x w row major field.
+ * @param[out] out device pointer to space for the destaggered field, not
+ * overlapping img.
+ * @param[in] w width of the field.
+ * @param[in] h height of the field.
+ * @param[in] pixel_shift_by_row device pointer to h shifts, usually queried
+ * from the sensor.
+ * @param[in] inverse perform the inverse operation.
+ * @param[in] stream stream to run on.
+ */
+template <typename T>
+void destagger(const T* img, T* out, size_t w, size_t h,
+               const int* pixel_shift_by_row, bool inverse = false,
+               cudaStream_t stream = 0) {
+    impl::destagger(img, out, sizeof(T), w, h, pixel_shift_by_row, inverse,
+                    stream);
+}
+
+/**
+ * Generate a staggered version of a pixel field in device memory.
+ *
+ * @tparam T the pixel type of the field.
+ *
+ * @param[in] img device pointer to the h x w row major field.
+ * @param[out] out device pointer to space for the staggered field, not
+ * overlapping img.
+ * @param[in] w width of the field.
+ * @param[in] h height of the field.
+ * @param[in] pixel_shift_by_row device pointer to h shifts.
+ * @param[in] stream stream to run on.
+ */
+template <typename T>
+void stagger(const T* img, T* out, size_t w, size_t h,
+             const int* pixel_shift_by_row, cudaStream_t stream = 0) {
+    impl::destagger(img, out, sizeof(T), w, h, pixel_shift_by_row, true,
+                    stream);
+}
+
+/**
+ * Destagger a pixel field of a device scan, whatever its element type and
+ * extra dimensions.
+ *
+ * @throw std::invalid_argument if the scan lacks the field or it isn't a
+ * pixel field.
+ *
+ * @param[in] scan the device scan.
+ * @param[in] name name of the field.
+ * @param[out] out device pointer to space for the destaggered field, of the
+ * same size as the field.
+ * @param[in] pixel_shift_by_row device pointer to h shifts.
+ * @param[in] inverse perform the inverse operation.
+ * @param[in] stream stream to run on.
+ */
+OUSTER_API_FUNCTION
+void destagger(const DeviceScan& scan, const std::string& name, void* out,
+               const int* pixel_shift_by_row, bool inverse = false,
+               cudaStream_t stream = 0);
+
+/**
+ * Transform points with the pose of their column, like pose_util::dewarp.
+ *
+ * @param[in] points device pointer to w * h points laid out like PointsF,
+ * e.g. written by cartesian. The ith point belongs to column i % w.
+ * @param[in] poses device pointer to w row major 4x4 pose matrices, e.g.
+ * DeviceScan::pose().
+ * @param[in] w number of columns.
+ * @param[in] h number of rows.
+ * @param[out] dewarped device pointer to space for the w * h dewarped points,
+ * laid out like points. May be the same as points.
+ * @param[in] stream stream to run on.
+ */
+OUSTER_API_FUNCTION
+void dewarp(const float* points, const double* poses, size_t w, size_t h,
+            float* dewarped, cudaStream_t stream = 0);
+
+/**
+ * Adjusts brightness of an image in device memory to between 0 and 1, like
+ * viz::AutoExposure. Percentiles are found by sorting on the device; only the
+ * two percentile values are copied back to the host.
+ */
+class OUSTER_API_CLASS AutoExposure {
+    const double lo_percentile, hi_percentile;  // percentiles used for scaling
+    const int ae_update_every;
+
+    double lo_state = -1.0;
+    double hi_state = -1.0;
+    double lo = -1.0;
+    double hi = -1.0;
+
+    bool initialized = false;
+    int counter = 0;
+
+    DeviceBuffer<float> samples_;
+    PinnedBuffer<float> percentiles_;
+
+   public:
+    /** Default constructor using default percentile and update values. */
+    OUSTER_API_FUNCTION
+    AutoExposure();
+
+    /**
+     * Constructor specifying update modulo, and using default percentiles.
+     *
+     * @param[in] update_every update every this number of frames.
+     */
+    OUSTER_API_FUNCTION
+    AutoExposure(int update_every);
+
+    /**
+     * Constructor specifying low and high percentiles, and update modulo.
+     *
+     * @param[in] lo_percentile low percentile to use for adjustment.
+     * @param[in] hi_percentile high percentile to use for adjustment.
+     * @param[in] update_every update every this number of frames.
+     */
+    OUSTER_API_FUNCTION
+    AutoExposure(double lo_percentile, double hi_percentile, int update_every);
+
+    /**
+     * Scales the image so that contrast is stretched between 0 and 1.
+     *
+     * Synchronizes the stream when percentiles are updated.
+     *
+     * @param[in] image device pointer to the image, modified in place.
+     * @param[in] n number of pixels in the image.
+     * @param[in] update_state Update lo/hi percentiles if true.
+     * @param[in] stream stream to run on.
+     */
+    OUSTER_API_FUNCTION
+    void operator()(float* image, size_t n, bool update_state = true,
+                    cudaStream_t stream = 0);
+};
+
+}  // namespace cuda
+}  // namespace ouster
@@ -0,0 +1,81 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Points and per point times of scans for deskewing registration
+ */
+
+#pragma once
+
+#include <Eigen/Core>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+/// Builds the input of deskewing point cloud registration, e.g. KISS-ICP,
+/// from a frame of scans of several sensors: the points of every pixel with a
+/// nonzero range and the time of each point, normalized to [0, 1] over the
+/// frame, plus the normalized time of every column of each scan to pose the
+/// columns with afterwards.
+///
+/// The buffers are kept across frames, so the results of a build are only
+/// valid until the next one.
+class OUSTER_API_CLASS DeskewInput {
+   public:
+    /// @throw invalid_argument if luts is empty
+    OUSTER_API_FUNCTION explicit DeskewInput(
+        std::vector<XYZLut> luts);  ///< [in] lookup tables of each sensor,
+                                    ///< generated by make_xyz_lut
+
+    /// Fill the buffers with a frame of scans.
+    ///
+    /// Column times are the column timestamps plus the offset of their sensor,
+    /// normalized between the earliest first valid column and the latest last
+    /// valid column of the frame. A scan whose valid columns aren't strictly
+    /// increasing in time gets evenly spaced times from 0 to 1 between its
+    /// first and last valid column instead. Columns outside of these have a
+    /// time of 0.
+    ///
+    /// @throw invalid_argument if there isn't a scan, possibly null, and an
+    /// offset per sensor, or if a scan doesn't match its lut
+    ///
+    /// @return the number of points
+    OUSTER_API_FUNCTION size_t
+    build(const std::vector<const LidarScan*>& scans,  ///< [in] scans of each
+                                                       ///< sensor, or null
+          const std::vector<int64_t>& ts_offsets);  ///< [in] offsets in ns
+                                                    ///< added to the column
+                                                    ///< timestamps of each
+                                                    ///< sensor
+
+    /// @return the points of the last build, one row per pixel with a nonzero
+    /// range in sensor and then pixel order
+    OUSTER_API_FUNCTION Eigen::Ref<const LidarScan::Points> points() const;
+
+    /// @return the normalized time of every point of the last build
+    OUSTER_API_FUNCTION Eigen::Ref<const Eigen::ArrayXd> times() const;
+
+    /// @return the normalized time of every column of the scan of a sensor in
+    /// the last build, empty if its scan was null
+    OUSTER_API_FUNCTION const Eigen::ArrayXd& column_times(
+        size_t sensor) const;  ///< [in] index of the sensor
+
+    /// @return the number of sensors
+    OUSTER_API_FUNCTION size_t sensors_count() const;
+
+   private:
+    std::vector<XYZLut> luts_;
+    LidarScan::Points points_;
+    Eigen::ArrayXd times_;
+    Eigen::Array<uint32_t, Eigen::Dynamic, 1> pixel_index_;
+    std::vector<Eigen::ArrayXd> column_times_;
+    size_t count_ = 0;
+};
+
+}  // namespace ouster
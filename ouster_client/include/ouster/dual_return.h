@@ -0,0 +1,89 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Selecting and merging the returns of dual return scans
+ */
+
+#pragma once
+
+#include <Eigen/Core>
+#include <cstddef>
+#include <cstdint>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/types.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+/// Which returns of a dual return scan to keep at every pixel, e.g. of the
+/// RNG19_RFL8_SIG16_NIR16_DUAL profile, whose RANGE, SIGNAL, REFLECTIVITY
+/// and FLAGS fields hold the first return and RANGE2, SIGNAL2,
+/// REFLECTIVITY2 and FLAGS2 the second. A return of zero range is missing
+/// and never selected over one with a range.
+enum class ReturnSelection : uint8_t {
+    STRONGEST = 0,  ///< the return of larger SIGNAL, the first if equal or
+                    ///< without SIGNAL fields
+    NEAREST = 1,    ///< the return of smaller range
+    FARTHEST = 2,   ///< the return of larger range, e.g. through foliage
+    BOTH = 3        ///< both returns, as two points per pixel
+};
+
+/// Fill the RANGE, SIGNAL, REFLECTIVITY and FLAGS fields of out with the
+/// selected return of every pixel of a dual return scan, in one pass per
+/// field, e.g. for consumers of single return scans. Out may be the scan
+/// itself. Fields that either the scan or out lacks are left out.
+///
+/// @throw invalid_argument if selection is BOTH, the scan has no RANGE2
+/// field, out is of another size, or a field of out has another type than
+/// the fields of its returns
+OUSTER_API_FUNCTION void select_returns(
+    const LidarScan& scan,      ///< [in] dual return scan
+    ReturnSelection selection,  ///< [in] return to keep at every pixel
+    LidarScan& out              ///< [out] scan to fill
+);
+
+/// Project the selected returns of a dual return scan to Cartesian points,
+/// writing only the points that pass the filter, like cartesian_compact(),
+/// without the intermediate range image of select_returns().
+///
+/// Points are written in pixel order, the first return of a pixel before
+/// its second for BOTH. The index of the return of each point is written to
+/// the same row of return_index: i = row * w + col for the first return of
+/// a pixel and w * h + i for its second, i.e. indices into the RANGE and
+/// RANGE2 images stacked. A single return scan, without RANGE2, yields its
+/// first returns.
+///
+/// @throw invalid_argument if the scan and lut sizes differ, points or
+/// return_index have fewer rows than the returns to select, 2 * w * h for
+/// BOTH and w * h otherwise, or filter.min_reflectivity is set and the scan
+/// lacks 8 or 16 bit REFLECTIVITY fields
+///
+/// @return the number of points written
+OUSTER_API_FUNCTION size_t cartesian_returns(
+    Eigen::Ref<LidarScan::Points> points,  ///< [out] space for the points
+    Eigen::Ref<Eigen::Array<uint32_t, Eigen::Dynamic, 1>>
+        return_index,            ///< [out] space for the return of each point
+    const LidarScan& scan,       ///< [in] scan with RANGE and RANGE2 fields
+    const XYZLut& lut,           ///< [in] lookup tables of make_xyz_lut
+    ReturnSelection selection,   ///< [in] returns to project
+    const CompactFilter& filter = {}  ///< [in] thresholds of the points
+);
+
+/// Single precision version of cartesian_returns()
+/// @throw invalid_argument as the double precision version
+/// @return the number of points written
+OUSTER_API_FUNCTION size_t cartesian_returns(
+    Eigen::Ref<Eigen::Array<float, Eigen::Dynamic, 3>>
+        points,  ///< [out] space for the points
+    Eigen::Ref<Eigen::Array<uint32_t, Eigen::Dynamic, 1>>
+        return_index,            ///< [out] space for the return of each point
+    const LidarScan& scan,       ///< [in] scan with RANGE and RANGE2 fields
+    const XYZLutF& lut,          ///< [in] lookup tables of make_xyz_lut_f
+    ReturnSelection selection,   ///< [in] returns to project
+    const CompactFilter& filter = {}  ///< [in] thresholds of the points
+);
+
+}  // namespace ouster
@@ -8,8 +8,10 @@
 #include <stdlib.h>  // for size_t since gcc-12
 
 #include <cstdint>
+#include <memory>
 #include <numeric>
 #include <stdexcept>
+#include <string>
 #include <type_traits>
 #include <typeindex>
 #include <unordered_map>
@@ -65,6 +67,12 @@ template <> OUSTER_API_FUNCTION ChanFieldType type_cft<double>();
 }  // namespace impl
 }  // namespace sensor
 
+/**
+ * Alignment in bytes of the memory of Fields owning their memory and of the
+ * fields of contiguous LidarScans; a cache line and the widest vector register.
+ */
+constexpr size_t field_alignment = 64;
+
 /**
  * Helper struct used by FieldView and Field to describe field contents.
  * Unlike FieldType this fully describes a Field's dimensions rather than
@@ -665,6 +673,22 @@ enum class FieldClass {
     SCAN_FIELD = 4,
 };
 
+/**
+ * How the memory of a new Field is initialized
+ */
+enum class FieldInit {
+    /**
+     * Filled with zeros
+     */
+    ZEROED = 0,
+
+    /**
+     * Left as allocated, for fields that are fully written before they are
+     * read, e.g. the channel fields of a scan a ScanBatcher fills in
+     */
+    UNINITIALIZED = 1,
+};
+
 /**
  * Get string representation of singular FieldClass flag
  *
@@ -684,6 +708,11 @@ std::string to_string(FieldClass f);
 class OUSTER_API_CLASS Field : public FieldView {
    protected:
     FieldClass class_;
+    // keeps the memory alive if the field doesn't own it, e.g. a field of a
+    // contiguous LidarScan, or memory shared copy-on-write by share()
+    mutable std::shared_ptr<void> owner_;
+    // whether owner_ is shared copy-on-write with other fields
+    mutable bool shared_{false};
 
    public:
     /** Default constructor, representing invalid Field */
@@ -703,6 +732,30 @@ class OUSTER_API_CLASS Field : public FieldView {
     OUSTER_API_FUNCTION
     Field(const FieldDescriptor& desc, FieldClass field_class = {});
 
+    /**
+     * Constructs Field from FieldDescriptor, choosing whether its memory is
+     * zeroed
+     *
+     * @param[in] desc FieldDescriptor
+     * @param[in] field_class FieldClass
+     * @param[in] init how the memory is initialized
+     */
+    OUSTER_API_FUNCTION
+    Field(const FieldDescriptor& desc, FieldClass field_class, FieldInit init);
+
+    /**
+     * Constructs Field over memory owned by something else, which the Field
+     * keeps alive. Copies of the Field own their memory.
+     *
+     * @param[in] desc FieldDescriptor
+     * @param[in] field_class FieldClass
+     * @param[in] ptr memory of desc.bytes() bytes
+     * @param[in] owner owner of the memory
+     */
+    OUSTER_API_FUNCTION
+    Field(const FieldDescriptor& desc, FieldClass field_class, void* ptr,
+          std::shared_ptr<void> owner);
+
     /**
      * Copy constructor
      *
@@ -712,7 +765,8 @@ class OUSTER_API_CLASS Field : public FieldView {
     Field(const Field& other);
 
     /**
-     * Copy assignment constructor
+     * Copy assignment constructor. Copies into the memory of this field
+     * without allocating when it owns memory of the same descriptor.
      *
      * @param[in] other Field to copy
      */
@@ -758,6 +812,16 @@ class OUSTER_API_CLASS Field : public FieldView {
      */
     OUSTER_API_FUNCTION
     bool operator==(const Field& other) const;
+
+   private:
+    friend class LidarScan;
+
+    // view the memory of this field copy-on-write: both fields share it until
+    // one of them calls unshare(), see LidarScan::shallow_copy
+    Field share() const;
+
+    // give this field a private copy of its memory if other fields share it
+    void unshare();
 };
 
 /**
@@ -777,6 +841,193 @@ class OUSTER_API_CLASS Field : public FieldView {
 OUSTER_API_FUNCTION
 FieldView uint_view(const FieldView& other);
 
+namespace impl {
+
+/**
+ * Tell the compiler that ptr is aligned to field_alignment bytes.
+ */
+template <typename T>
+inline T* assume_field_aligned(T* ptr) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<T*>(__builtin_assume_aligned(ptr, field_alignment));
+#else
+    return ptr;
+#endif
+}
+
+}  // namespace impl
+
+/**
+ * Non-owning view of a dense H x W row-major image of T with its shape fixed
+ * at compile time and its memory aligned to field_alignment bytes.
+ *
+ * Unlike the Eigen and ArrayView conversions of FieldView, loops over a
+ * FixedFieldView have constant trip counts and aligned bases, so that the
+ * compiler can unroll and vectorize them without runtime checks. Fields
+ * allocate aligned memory, so views of whole LidarScan fields can always be
+ * made; use visit_fixed_shape to pick the view for the shape of a scan at
+ * runtime.
+ *
+ * @tparam T element type, const for a read-only view
+ * @tparam H number of rows
+ * @tparam W number of columns
+ */
+template <typename T, size_t H, size_t W>
+class FixedFieldView {
+    static_assert(H > 0 && W > 0, "FixedFieldView: empty shape");
+
+    T* data_;
+
+   public:
+    using value_type = typename std::remove_const<T>::type;
+    static constexpr size_t rows = H;
+    static constexpr size_t cols = W;
+    static constexpr size_t size = H * W;
+
+    /**
+     * View aligned memory of H * W elements.
+     *
+     * @throw std::invalid_argument if data isn't aligned to field_alignment
+     *
+     * @param[in] data memory of the image
+     */
+    explicit FixedFieldView(T* data) : data_(data) {
+        if (reinterpret_cast<uintptr_t>(data) % field_alignment) {
+            throw std::invalid_argument(
+                "FixedFieldView: memory isn't aligned to " +
+                std::to_string(field_alignment) + " bytes");
+        }
+    }
+
+    /**
+     * View a field.
+     *
+     * @throw std::invalid_argument on type mismatch
+     * @throw std::invalid_argument if the field isn't a dense H x W image
+     * @throw std::invalid_argument if the field memory isn't aligned, e.g. for
+     *        a subview
+     *
+     * @param[in] field field to view
+     */
+    explicit FixedFieldView(FieldView& field)
+        : FixedFieldView(checked(field, field.get<value_type>())) {}
+
+    /**
+     * View a const field, only for views of const T.
+     *
+     * @copydetails FixedFieldView(FieldView&)
+     */
+    template <typename U = T,
+              typename = typename std::enable_if<std::is_const<U>::value>::type>
+    explicit FixedFieldView(const FieldView& field)
+        : FixedFieldView(checked(field, field.get<value_type>())) {}
+
+    /** Pointer to the first element, known to the compiler to be aligned */
+    T* data() const { return impl::assume_field_aligned(data_); }
+
+    /**
+     * Pointer to the first element of a row, aligned when W * sizeof(T) is a
+     * multiple of field_alignment, as for all standard sensor widths.
+     *
+     * @param[in] u row index
+     */
+    T* row(size_t u) const { return data() + u * W; }
+
+    /** Element at row u, column v */
+    T& operator()(size_t u, size_t v) const { return data()[u * W + v]; }
+
+    /** Element i of the image in row-major order */
+    T& operator[](size_t i) const { return data()[i]; }
+
+    T* begin() const { return data(); }
+    T* end() const { return data() + size; }
+
+   private:
+    template <typename P>
+    static P* checked(const FieldView& field, P* ptr) {
+        const auto& shape = field.shape();
+        if (shape.size() != 2 || shape[0] != H || shape[1] != W ||
+            field.sparse()) {
+            throw std::invalid_argument(
+                "FixedFieldView: field isn't a dense " + std::to_string(H) +
+                " x " + std::to_string(W) + " image");
+        }
+        return ptr;
+    }
+};
+
+template <typename T, size_t H, size_t W>
+constexpr size_t FixedFieldView<T, H, W>::rows;
+template <typename T, size_t H, size_t W>
+constexpr size_t FixedFieldView<T, H, W>::cols;
+template <typename T, size_t H, size_t W>
+constexpr size_t FixedFieldView<T, H, W>::size;
+
+namespace impl {
+
+template <typename T, typename F, size_t H, size_t... Ws>
+struct visit_fixed_cols;
+
+template <typename T, typename F, size_t H>
+struct visit_fixed_cols<T, F, H> {
+    template <typename V>
+    static bool visit(V&, F&) {
+        return false;
+    }
+};
+
+template <typename T, typename F, size_t H, size_t W, size_t... Ws>
+struct visit_fixed_cols<T, F, H, W, Ws...> {
+    template <typename V>
+    static bool visit(V& field, F& f) {
+        if (field.shape()[1] != W)
+            return visit_fixed_cols<T, F, H, Ws...>::visit(field, f);
+        f(FixedFieldView<T, H, W>(field));
+        return true;
+    }
+};
+
+template <typename T, typename F, size_t H>
+using visit_standard_cols = visit_fixed_cols<T, F, H, 512, 1024, 2048>;
+
+}  // namespace impl
+
+/**
+ * Call f with a FixedFieldView of field if it is a dense image of one of the
+ * standard sensor shapes, 64 or 128 rows by 512, 1024 or 2048 columns, so
+ * that generic code written against FixedFieldView is compiled for each of
+ * them. Other shapes are left to a runtime sized fallback of the caller.
+ *
+ * \code
+ * bool done = visit_fixed_shape<uint32_t>(scan.field(ChanField::RANGE),
+ *                                        [&](auto range) {
+ *     for (auto& r : range) r = std::min(r, max_range);
+ * });
+ * \endcode
+ *
+ * @throw std::invalid_argument on type mismatch or misaligned memory
+ *
+ * @tparam T element type, const for a read-only view
+ * @param[in] field field to view
+ * @param[in] f callable taking FixedFieldView<T, H, W> for each shape
+ *
+ * @return true if f was called, false if the field has another shape
+ */
+template <typename T, typename V, typename F>
+bool visit_fixed_shape(V& field, F&& f) {
+    static_assert(std::is_base_of<FieldView, V>::value,
+                  "visit_fixed_shape: field must be a FieldView");
+    if (field.shape().size() != 2 || field.sparse()) return false;
+    switch (field.shape()[0]) {
+        case 64:
+            return impl::visit_standard_cols<T, F, 64>::visit(field, f);
+        case 128:
+            return impl::visit_standard_cols<T, F, 128>::visit(field, f);
+        default:
+            return false;
+    }
+}
+
 }  // namespace ouster
 
 namespace std {
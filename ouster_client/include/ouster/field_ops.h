@@ -0,0 +1,113 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Elementwise kernels over fields of any element type
+ *
+ * Converting, scaling and filtering fields with Eigen casts or numpy makes a
+ * temporary of every intermediate result. These kernels read their source
+ * once and write their result straight to the destination, for every pair of
+ * ChanFieldTypes, with AVX2 versions picked at runtime on x86 CPUs that
+ * support it. When built with OpenMP they can also split the field across
+ * threads.
+ *
+ * Views must be dense, as fields of scans are; views taken of them may be of
+ * any shape as long as sizes match. Bounds and operands are doubles; values
+ * are compared to them exactly, but for 64 bit integers which are compared
+ * as doubles.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "ouster/field.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace field_ops {
+
+/// Comparisons of compare()
+enum class CompareOp {
+    LESS,           ///< value < operand
+    LESS_EQUAL,     ///< value <= operand
+    GREATER,        ///< value > operand
+    GREATER_EQUAL,  ///< value >= operand
+    EQUAL,          ///< value == operand
+    NOT_EQUAL       ///< value != operand
+};
+
+/// Convert the values of a field to the type of another, e.g. uint32 ranges
+/// to float. Values out of the range of the destination type saturate,
+/// floating point values are truncated towards zero and NaN becomes zero.
+/// @throw std::invalid_argument if either view is sparse or of an
+///        unregistered type, or if their sizes differ
+OUSTER_API_FUNCTION
+void convert(const FieldView& src,  ///< [in] values to convert
+             FieldView dst,         ///< [out] destination
+             bool parallel = false  ///< [in] split across OpenMP threads
+);
+
+/// Write src * factor + offset to a field, e.g. to turn millimeter ranges
+/// into meters. Computed in single precision if dst is FLOAT32 and in double
+/// precision otherwise, then converted as by convert().
+/// @throw std::invalid_argument as convert()
+OUSTER_API_FUNCTION
+void scale(const FieldView& src,  ///< [in] values to scale
+           FieldView dst,         ///< [out] destination, may be src
+           double factor,         ///< [in] factor to multiply values by
+           double offset = 0,     ///< [in] value added after multiplying
+           bool parallel = false  ///< [in] split across OpenMP threads
+);
+
+/// Clamp the values of a field to [lower, upper] in place
+/// @throw std::invalid_argument if the view is sparse or of an unregistered
+///        type, or if lower > upper or either is NaN
+OUSTER_API_FUNCTION
+void clip(FieldView field,        ///< [in,out] values to clamp
+          double lower,           ///< [in] smallest value kept
+          double upper,           ///< [in] largest value kept
+          bool parallel = false   ///< [in] split across OpenMP threads
+);
+
+/// Replace the values of a field outside of [lower, upper] with invalid in
+/// place, e.g. to zero the ranges beyond the reach of a sensor
+/// @throw std::invalid_argument if the view is sparse or of an unregistered
+///        type
+OUSTER_API_FUNCTION
+void threshold(FieldView field,        ///< [in,out] values to filter
+               double lower,           ///< [in] smallest value kept
+               double upper,           ///< [in] largest value kept
+               double invalid = 0,     ///< [in] value of the others
+               bool parallel = false   ///< [in] split across OpenMP threads
+);
+
+/// Replace the values of a field where a mask is zero with fill in place.
+/// The field may hold several values per element of the mask, e.g. a pixel
+/// field with extra dimensions masked by an h x w mask; they are masked
+/// together.
+/// @throw std::invalid_argument if either view is sparse or of an
+///        unregistered type, or if the size of the field isn't a multiple of
+///        the size of the mask
+OUSTER_API_FUNCTION
+void mask(FieldView field,        ///< [in,out] values to mask
+          const FieldView& mask,  ///< [in] mask, of any type
+          double fill = 0,        ///< [in] value of the masked values
+          bool parallel = false   ///< [in] split across OpenMP threads
+);
+
+/// Compare the values of a field to an operand, writing 1 where the
+/// comparison holds and 0 elsewhere, e.g. to build the mask of valid ranges
+/// @throw std::invalid_argument if either view is sparse or of an
+///        unregistered type, if out isn't UINT8 or if the sizes differ
+OUSTER_API_FUNCTION
+void compare(const FieldView& src,  ///< [in] values to compare
+             CompareOp op,          ///< [in] comparison
+             double operand,        ///< [in] value to compare to
+             FieldView out,         ///< [out] UINT8 result
+             bool parallel = false  ///< [in] split across OpenMP threads
+);
+
+}  // namespace field_ops
+}  // namespace ouster
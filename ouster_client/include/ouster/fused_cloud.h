@@ -0,0 +1,96 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Fusing the point clouds of the scans of several sensors
+ */
+
+#pragma once
+
+#include <Eigen/Core>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/types.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+/// The points of a frame of scans of several sensors, in one buffer
+struct OUSTER_API_CLASS FusedCloud {
+    /// the points, of which the first size rows are valid
+    pose_util::Points points;
+    /// the index of the sensor of every point, empty unless requested
+    Eigen::Array<uint8_t, Eigen::Dynamic, 1> sensor_ids;
+    /// the values of every requested field at every point
+    std::vector<Eigen::ArrayXd> fields;
+    /// the number of points
+    size_t size = 0;
+    /// the number of builds before the one that filled this cloud
+    uint64_t frame = 0;
+};
+
+/// Builds a single point cloud from one scan per sensor, projecting the scan
+/// of every sensor on its own thread directly into its part of a shared
+/// buffer, in place of calling cartesian(), transform and concatenating the
+/// points of each sensor.
+///
+/// Clouds are written in turn to the slots of a preallocated ring, so that a
+/// consumer, e.g. a viz or perception thread, can read a cloud while the next
+/// ring_size - 1 clouds are built.
+class OUSTER_API_CLASS FusedCloudBuilder {
+   public:
+    /// @throw invalid_argument if luts is empty, there are more than 256
+    /// sensors, extrinsics isn't empty and doesn't have one per lut, or
+    /// ring_size is 0
+    OUSTER_API_FUNCTION explicit FusedCloudBuilder(
+        std::vector<XYZLut> luts,  ///< [in] lookup tables of each sensor,
+                                   ///< generated by make_xyz_lut, with the
+                                   ///< extrinsics for use_extrinsics
+        std::vector<mat4d> extrinsics = {},  ///< [in] transforms applied
+                                             ///< after the luts, or empty
+        std::vector<std::string> fields = {},  ///< [in] fields carried to
+                                               ///< each point
+        bool sensor_ids = false,  ///< [in] carry the sensor of each point
+        bool compact = true,      ///< [in] leave out pixels of zero range
+        size_t ring_size = 2);    ///< [in] number of clouds in the ring
+
+    /// Fill the next cloud of the ring with a frame of scans, in sensor and
+    /// then pixel order. Without compact, every pixel of every sensor has a
+    /// point, zero for a missing scan.
+    ///
+    /// @throw invalid_argument if there isn't a scan, possibly null, per
+    /// sensor, if a scan doesn't match its lut or lacks a requested field
+    ///
+    /// @return the filled cloud, valid until ring_size more builds
+    OUSTER_API_FUNCTION const FusedCloud& build(
+        const std::vector<const LidarScan*>& scans);  ///< [in] scans of each
+                                                      ///< sensor, or null
+
+    /// @return the cloud of the last build
+    OUSTER_API_FUNCTION const FusedCloud& latest() const;
+
+    /// @return the fields carried to each point
+    OUSTER_API_FUNCTION const std::vector<std::string>& fields() const;
+
+    /// @return the number of sensors
+    OUSTER_API_FUNCTION size_t sensors_count() const;
+
+    /// @return the number of clouds in the ring
+    OUSTER_API_FUNCTION size_t ring_size() const;
+
+   private:
+    std::vector<XYZLut> luts_;
+    std::vector<std::string> fields_;
+    bool sensor_ids_;
+    bool compact_;
+    std::vector<FusedCloud> ring_;
+    size_t next_ = 0;
+    uint64_t frames_ = 0;
+};
+
+}  // namespace ouster
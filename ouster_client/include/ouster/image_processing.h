@@ -9,6 +9,8 @@
 #pragma once
 
 #include <Eigen/Core>
+#include <cstdint>
+#include <vector>
 
 #include "ouster/types.h"
 #include "ouster/visibility.h"
@@ -29,6 +31,10 @@ class OUSTER_API_CLASS AutoExposure {
     bool initialized = false;
     int counter = 0;
 
+    // reused across frames by the percentile selection
+    std::vector<uint32_t> histogram;
+    std::vector<double> lo_values, hi_values;
+
     template <typename T>
     void update(Eigen::Ref<img_t<T>> image, bool update_state);
 
@@ -87,6 +93,7 @@ class OUSTER_API_CLASS AutoExposure {
  */
 class OUSTER_API_CLASS BeamUniformityCorrector {
    private:
+    const int buc_update_every;
     int counter = 0;
     Eigen::ArrayXd dark_count;
 
@@ -94,6 +101,20 @@ class OUSTER_API_CLASS BeamUniformityCorrector {
     void update(Eigen::Ref<img_t<T>> image, bool update_state);
 
    public:
+    /** Default constructor, updating the dark counts every 8 frames. */
+    OUSTER_API_FUNCTION
+    BeamUniformityCorrector();
+
+    /**
+     * Constructor specifying update modulo. The dark counts are only
+     * recomputed every this number of frames and reused in between, trading
+     * responsiveness for cost, which grows with the image width.
+     *
+     * @param[in] update_every update every this number of frames.
+     */
+    OUSTER_API_FUNCTION
+    BeamUniformityCorrector(int update_every);
+
     /**
      * Applies dark count correction to an image, modifying it in-place to have
      * reduced horizontal line artifacts.
@@ -71,4 +71,20 @@ void cartesianT(PointsT<T>& points,
     }
 }
 
+/**
+ * Single precision overload of cartesianT, using the fastest vectorized
+ * kernel the CPU supports.
+ *
+ * @param[in, out] points The resulting point cloud, should be pre-allocated and
+ * have the same dimensions as the direction array.
+ * @param[in] range a range image in the same format as the RANGE field of a
+ * LidarScan.
+ * @param[in] direction the direction of an xyz lut.
+ * @param[in] offset the offset of an xyz lut.
+ */
+OUSTER_API_FUNCTION
+void cartesianT(PointsF& points,
+                const Eigen::Ref<const img_t<uint32_t>>& range,
+                const PointsF& direction, const PointsF& offset);
+
 }  // namespace ouster
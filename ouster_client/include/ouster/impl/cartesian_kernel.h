@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Vectorized single precision projection of ranges to points
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ouster {
+namespace impl {
+
+/// Implementations of the single precision cartesian kernel
+enum class cartesian_kernel {
+    SCALAR,  ///< portable reference implementation
+    AVX2,    ///< x86 AVX2 and FMA, 8 points at a time
+    AVX512,  ///< x86 AVX-512F, 16 points at a time
+    NEON     ///< ARM NEON, 4 points at a time
+};
+
+/// Output layouts of the cartesian kernel
+enum class xyz_layout {
+    PLANAR,      ///< column of x values, then y, then z, like PointsF
+    INTERLEAVED  ///< x, y and z of each point next to each other
+};
+
+/**
+ * Project n ranges to points, computing range * direction + offset for
+ * every nonzero range and a zero point for every zero range, like cartesianT.
+ *
+ * Direction, offset and planar points are column major n x 3 arrays like
+ * PointsF, whose columns are stride floats apart. That allows projecting part
+ * of a lookup table.
+ *
+ * @param[in] range n ranges.
+ * @param[in] direction beam directions.
+ * @param[in] offset beam offsets.
+ * @param[in] stride floats between the columns of direction, offset and
+ * planar points, at least n.
+ * @param[in] n number of points.
+ * @param[out] xyz the points, laid out as given to get_cartesian_fn.
+ */
+using cartesian_fn = void (*)(const uint32_t* range, const float* direction,
+                              const float* offset, size_t stride, size_t n,
+                              float* xyz);
+
+/**
+ * Check whether a kernel can run on this CPU.
+ *
+ * @param[in] kernel the kernel to check.
+ *
+ * @return true if the kernel was compiled in and the CPU supports it.
+ */
+bool cartesian_kernel_supported(cartesian_kernel kernel);
+
+/**
+ * Get the fastest kernel supported by this CPU, detected once on first use.
+ *
+ * @return the kernel used by the single precision cartesian overloads.
+ */
+cartesian_kernel best_cartesian_kernel();
+
+/**
+ * Get a cartesian kernel.
+ *
+ * @throw std::invalid_argument if the kernel isn't supported on this CPU.
+ *
+ * @param[in] kernel the implementation to use.
+ * @param[in] layout how the kernel lays out the points it writes.
+ *
+ * @return the kernel.
+ */
+cartesian_fn get_cartesian_fn(cartesian_kernel kernel, xyz_layout layout);
+
+}  // namespace impl
+}  // namespace ouster
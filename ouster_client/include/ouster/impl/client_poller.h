@@ -5,7 +5,10 @@
 
 #pragma once
 
+#include <memory>
+
 #include "ouster/client.h"
+#include "ouster/impl/netcompat.h"
 #include "ouster/visibility.h"
 
 namespace ouster {
@@ -18,14 +21,52 @@ namespace impl {
 struct OUSTER_API_CLASS client_poller;
 
 /**
- * produces uninitialized poller
+ * Mechanisms a client_poller can use to wait on sockets
+ */
+enum class poller_backend {
+    AUTO,    ///< use the most scalable backend available on this platform
+    SELECT,  ///< portable select(), limited to descriptors below FD_SETSIZE
+    EPOLL    ///< Linux epoll, registrations persist between polls
+};
+
+/**
+ * produces uninitialized poller using the select backend
  */
 OUSTER_API_FUNCTION
 std::shared_ptr<client_poller> make_poller();
 
+/**
+ * produces uninitialized poller using the requested backend
+ *
+ * With the EPOLL backend sockets stay registered with the kernel until they
+ * are left out after a `reset_poll`, so polling a fixed set of sockets costs a
+ * single syscall regardless of their number. A watched socket must not be
+ * closed while its descriptor may be reused by another watched socket.
+ *
+ * @param[in] backend backend to wait on sockets with
+ *
+ * @throw std::invalid_argument if the backend is not supported on this
+ *        platform
+ */
+OUSTER_API_FUNCTION
+std::shared_ptr<client_poller> make_poller(poller_backend backend);
+
+/**
+ * Retrieve the backend a poller is using
+ *
+ * @param[in] poller client_poller
+ *
+ * @return the backend, never AUTO
+ */
+OUSTER_API_FUNCTION
+poller_backend get_backend(const client_poller& poller);
+
 /**
  * Reset poller. Must be called prior to any other operations
  *
+ * The set of watched sockets survives calls to poll, so a caller with a fixed
+ * set of clients only needs to reset and set them once.
+ *
  * @param[in] poller client_poller to reset
  */
 OUSTER_API_FUNCTION
@@ -40,6 +81,15 @@ void reset_poll(client_poller& poller);
 OUSTER_API_FUNCTION
 void set_poll(client_poller& poller, const client& cli);
 
+/**
+ * Set poller to watch a raw socket on the next poll call
+ *
+ * @param[in] poller client_poller
+ * @param[in] sock socket to watch
+ */
+OUSTER_API_FUNCTION
+void set_poll_socket(client_poller& poller, SOCKET sock);
+
 /**
  * Polls clients previously set with `set_poll`
  *
@@ -51,6 +101,18 @@ void set_poll(client_poller& poller, const client& cli);
 OUSTER_API_FUNCTION
 int poll(client_poller& poller, int timeout_sec = 1);
 
+/**
+ * Polls sockets previously set with `set_poll` or `set_poll_socket` with a
+ * fractional timeout
+ *
+ * @param[in] poller client_poller
+ * @param[in] timeout_sec timeout in seconds, negative to wait forever
+ *
+ * @return -1 for error, 0 for timeout, otherwise number of ready sockets
+ */
+OUSTER_API_FUNCTION
+int poll_for(client_poller& poller, double timeout_sec);
+
 /**
  * Retrieves error state of the poller
  *
@@ -74,6 +136,17 @@ client_state get_error(const client_poller& poller);
 OUSTER_API_FUNCTION
 client_state get_poll(const client_poller& poller, const client& cli);
 
+/**
+ * Check whether a raw socket was readable in the last poll
+ *
+ * @param[in] poller client_poller
+ * @param[in] sock socket previously set with `set_poll_socket`
+ *
+ * @return true if the socket has data to read
+ */
+OUSTER_API_FUNCTION
+bool get_poll_socket(const client_poller& poller, SOCKET sock);
+
 }  // namespace impl
 }  // namespace sensor
 }  // namespace ouster
@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Vectorized decoding of channel fields from lidar packets
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ouster {
+namespace sensor {
+namespace impl {
+
+/// Implementations of the strided field decoder
+enum class decode_kernel {
+    SCALAR,  ///< portable reference implementation
+    AVX2,    ///< x86 AVX2 gathers
+    NEON     ///< ARM NEON
+};
+
+/**
+ * Decode n bit fields laid out stride bytes apart, e.g. the same pixel of
+ * consecutive columns in a lidar packet. Each value is read as a little endian
+ * 64 bit word, masked, shifted right by shift (left if negative) and truncated
+ * to the destination width, exactly like FieldInfo::get.
+ *
+ * NOTE: reads 8 bytes at every source, caution is advised near the end of a
+ *       buffer.
+ *
+ * @param[in] src first byte of the first field.
+ * @param[in] stride bytes between consecutive fields.
+ * @param[in] n number of fields.
+ * @param[in] mask bits of the word that hold the field.
+ * @param[in] shift bits to shift the masked word right, left if negative.
+ * @param[out] dst space for n contiguous values of the destination width.
+ */
+using decode_fn = void (*)(const uint8_t* src, size_t stride, int n,
+                           uint64_t mask, int shift, uint8_t* dst);
+
+/**
+ * Check whether a kernel can run on this CPU.
+ *
+ * @param[in] kernel the kernel to check.
+ *
+ * @return true if the kernel was compiled in and the CPU supports it.
+ */
+bool decode_kernel_supported(decode_kernel kernel);
+
+/**
+ * Get the fastest kernel supported by this CPU, detected once on first use.
+ *
+ * @return the kernel used by packet_format::block_field.
+ */
+decode_kernel best_decode_kernel();
+
+/**
+ * Get the decoder for a kernel and destination width.
+ *
+ * @throw invalid_argument if the kernel is unsupported or the width is not 1,
+ * 2, 4 or 8 bytes.
+ *
+ * @param[in] kernel the kernel to use.
+ * @param[in] dst_size width of each decoded value in bytes.
+ *
+ * @return the decoder.
+ */
+decode_fn get_decode_fn(decode_kernel kernel, size_t dst_size);
+
+}  // namespace impl
+}  // namespace sensor
+}  // namespace ouster
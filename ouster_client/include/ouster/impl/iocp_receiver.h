@@ -0,0 +1,111 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Receive UDP datagrams through a Windows I/O completion port
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "ouster/impl/netcompat.h"
+
+namespace ouster {
+namespace sensor {
+namespace impl {
+
+/**
+ * Receives datagrams from a set of UDP sockets through an I/O completion
+ * port, keeping several overlapped receives outstanding on every socket so
+ * the stack hands datagrams straight to buffers already posted rather than
+ * queueing them until the next select() and recvfrom() round trip.
+ * Completions are dequeued in batches. Only supported on Windows.
+ */
+class IocpReceiver {
+   public:
+    /**
+     * Associate the sockets with a new completion port and post the
+     * receives.
+     *
+     * @throw runtime_error if the port can't be set up or a receive can't
+     * be posted.
+     *
+     * @param[in] sockets UDP sockets to receive from, owned by the caller
+     * and left open until after the receiver is destroyed.
+     * @param[in] depth number of receives kept outstanding on each socket.
+     * @param[in] buffer_size size in bytes of each receive buffer, like
+     * recvfrom larger datagrams are truncated.
+     */
+    IocpReceiver(const std::vector<SOCKET>& sockets, size_t depth,
+                 size_t buffer_size = 65535);
+
+    /// Cancels the outstanding receives and waits for them to complete
+    ~IocpReceiver();
+
+    IocpReceiver(const IocpReceiver&) = delete;
+    IocpReceiver& operator=(const IocpReceiver&) = delete;
+
+    /// Check if completed receives are queued without waiting
+    /// @return true if the next call to next() may return a datagram
+    bool ready() const { return !completed_.empty(); }
+
+    /**
+     * Wait for receives to complete, dequeuing every completion that is
+     * already available in one call.
+     *
+     * @param[in] timeout_sec longest time to wait, zero to only check.
+     *
+     * @return the number of completed receives queued, zero on timeout or
+     * negative on error.
+     */
+    int wait(double timeout_sec);
+
+    /**
+     * Get the next completed datagram without blocking and post the
+     * receive again. The receive buffer is swapped with data, so buffers
+     * taken from a packet pool circulate without copies.
+     *
+     * @param[in,out] data UDP payload, resized to the number of bytes
+     * received. Its storage is reused for the next receive.
+     * @param[in] max_size largest payload to return, larger datagrams are
+     * truncated.
+     * @param[out] from sender address and port.
+     * @param[out] ts time in ns the completion was dequeued.
+     *
+     * @return the number of bytes returned, or zero if nothing completed.
+     */
+    size_t next(std::vector<uint8_t>& data, size_t max_size,
+                sockaddr_storage& from, uint64_t& ts);
+
+   private:
+    struct Slot;
+
+    /// Post the receive of a slot, returning false if the socket failed
+    bool post(Slot& slot);
+
+    /// Cancel the receives, wait for them and close the port
+    void shutdown();
+
+    struct Completion {
+        Slot* slot;
+        size_t size;
+        uint64_t ts;
+    };
+
+    void* port_{nullptr};
+    std::vector<SOCKET> sockets_;
+    std::vector<std::unique_ptr<Slot>> slots_;
+    std::deque<Completion> completed_;
+    size_t buffer_size_;
+    size_t pending_{0};  // receives posted and not yet dequeued
+};
+
+}  // namespace impl
+}  // namespace sensor
+}  // namespace ouster
@@ -0,0 +1,43 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Parsing of the IPv4 headers of raw packet captures
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ouster {
+namespace sensor {
+namespace impl {
+
+/// Minimal IPv4 header fields needed to route a datagram
+struct Ipv4Header {
+    uint32_t src;       ///< source address, network order
+    uint32_t dst;       ///< destination address, network order
+    uint16_t id;        ///< identification
+    uint8_t protocol;   ///< payload protocol, e.g. 17 for UDP
+    uint16_t offset;    ///< fragment offset in bytes
+    bool more;          ///< more fragments flag
+    size_t header_len;  ///< header length in bytes
+    size_t total_len;   ///< total length in bytes including the header
+};
+
+/**
+ * Parse an IPv4 header from a raw packet.
+ *
+ * @param[in] buf the start of the IPv4 header.
+ * @param[in] len number of bytes available at buf.
+ * @param[out] header the parsed header.
+ *
+ * @return false if buf does not hold a well formed IPv4 header.
+ */
+bool parse_ipv4_header(const uint8_t* buf, size_t len, Ipv4Header& header);
+
+}  // namespace impl
+}  // namespace sensor
+}  // namespace ouster
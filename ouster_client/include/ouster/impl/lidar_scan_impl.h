@@ -6,12 +6,17 @@
 #pragma once
 
 #include <Eigen/Core>
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <stdexcept>
+#include <vector>
 
 #include "ouster/field.h"
 #include "ouster/impl/packet_writer.h"
 #include "ouster/lidar_scan.h"
+#include "ouster/packet_pool.h"
 #include "ouster/types.h"
 #include "ouster/visibility.h"
 
@@ -314,98 +319,112 @@ void scan_to_packets(const LidarScan& ls,
 
     using ouster::sensor::LidarPacket;
 
-    // TODO: switch to strings
-    auto pack_field = [&pw](auto ref_field, const std::string& i,
-                            LidarPacket& packet) {
-        pw.set_block(ref_field, i, packet.buf.data());
-    };
-
-    auto unpack_raw_headers = [&pw](auto ref_field, LidarPacket& packet) {
-        pw.unpack_raw_headers(ref_field, packet.buf.data());
-    };
-
-    auto frame_id = ls.frame_id;
     LidarPacket packet(pw.lidar_packet_size);
     // TODO: avoid this copy if we combine packet_writer and packet_format
     packet.format = std::make_shared<ouster::sensor::packet_format>(pw);
     for (size_t p_id = 0; p_id < total_packets; ++p_id) {
-        uint8_t* lidar_buf = packet.buf.data();
-        std::memset(packet.buf.data(), 0, packet.buf.size());
         packet.host_timestamp = ls.packet_timestamp()[p_id];
+        if (!pw.write_packet(ls, p_id, packet.buf.data(), init_id, prod_sn))
+            continue;
+        *iter++ = packet;
+    }
+}
 
-        // Set alert flags, which may vary from packet to packet
-        pw.set_alert_flags(lidar_buf, ls.alert_flags()[p_id]);
-
-        // Set shot-limiting and shutdown fields, which should be the same for
-        // all packets in the scan
-        pw.set_shutdown(lidar_buf, ls.thermal_shutdown());
-        pw.set_shot_limiting(lidar_buf, ls.shot_limiting());
-        pw.set_shutdown_countdown(lidar_buf, ls.shutdown_countdown);
-        pw.set_shot_limiting_countdown(lidar_buf, ls.shot_limiting_countdown);
-
-        // Set other scan-level attributes
-
-        // TODO(dguridi): add an official PacketType enum in types.h
-        pw.set_packet_type(lidar_buf, 0x1);
-        pw.set_frame_id(lidar_buf, frame_id);
-        pw.set_init_id(lidar_buf, init_id);
-        pw.set_prod_sn(lidar_buf, prod_sn);
-
-        bool any_valid = false;
-        for (int icol = 0; icol < columns_per_packet; ++icol) {
-            uint8_t* col_buf = pw.nth_col(icol, lidar_buf);
+/**
+ * Like scan_to_packets, but encodes the packets straight into packets
+ * borrowed from a pool rather than copying them out of a buffer, e.g. to
+ * replay a recording without allocating.
+ *
+ * OutputItT - STL compatible output iterator over PooledPacket value type
+ */
+template <typename OutputItT>
+void scan_to_packets(const LidarScan& ls,
+                     const ouster::sensor::impl::packet_writer& pw,
+                     ouster::sensor::PacketPool& pool, OutputItT iter,
+                     uint32_t init_id, uint64_t prod_sn) {
+    size_t total_packets = ls.packet_timestamp().size();
 
-            auto id = p_id * columns_per_packet + icol;
+    if (ls.w / pw.columns_per_packet != total_packets) {
+        throw std::invalid_argument(
+            "Mismatch between expected number of packets and "
+            "packet_writer.columns_per_frame");
+    }
 
-            pw.set_col_status(col_buf, ls.status()[id]);
-            pw.set_col_measurement_id(col_buf, id);
-            pw.set_col_timestamp(col_buf, ls.timestamp()[id]);
+    // shared by the packets of the scan
+    auto format = std::make_shared<ouster::sensor::packet_format>(pw);
+    for (size_t p_id = 0; p_id < total_packets; ++p_id) {
+        ouster::sensor::PooledPacket packet =
+            pool.acquire(ouster::sensor::PacketType::Lidar);
+        packet->buf.resize(pw.lidar_packet_size);
+        if (!pw.write_packet(ls, p_id, packet->buf.data(), init_id, prod_sn))
+            continue;
+        packet->host_timestamp = ls.packet_timestamp()[p_id];
+        packet->format = format;
+        *iter++ = std::move(packet);
+    }
+}
 
-            any_valid |= (ls.status()[id] & 0x01);
-        }
+// columns every pixel of row u moves right when destaggering, in [0, w)
+inline size_t destagger_offset(const std::vector<int>& pixel_shift_by_row,
+                               size_t u, size_t w, bool inverse) {
+    const std::ptrdiff_t sw = static_cast<std::ptrdiff_t>(w);
+    const std::ptrdiff_t shift =
+        (inverse ? -1 : 1) * pixel_shift_by_row[u] % sw;
+    return static_cast<size_t>((shift + sw) % sw);
+}
 
-        // do not emit packet if ts == 0 and none of the columns are valid
-        if (!any_valid && !packet.host_timestamp) continue;
+}  // namespace impl
 
-        foreach_channel_field(ls, pw, pack_field, packet);
+template <typename T>
+inline void destagger_to(Eigen::Ref<img_t<T>> out,
+                         const Eigen::Ref<const img_t<T>>& img,
+                         const std::vector<int>& pixel_shift_by_row,
+                         bool inverse) {
+    const size_t h = img.rows();
+    const size_t w = img.cols();
 
-        if (raw_headers_enabled(pw, ls)) {
-            visit_field(ls, sensor::ChanField::RAW_HEADERS, unpack_raw_headers,
-                        packet);
-        } else if (pw.udp_profile_lidar !=
-                   ouster::sensor::UDPProfileLidar::PROFILE_LIDAR_LEGACY) {
-            assert(packet.buf.size() > sizeof(uint64_t));
-            uint64_t crc = pw.calculate_crc(packet.buf.data());
-            memcpy(packet.buf.data() + packet.buf.size() - sizeof(crc), &crc,
-                   sizeof(crc));
-        }
+    if (pixel_shift_by_row.size() != h)
+        throw std::invalid_argument{"image height does not match shifts size"};
+    if (static_cast<size_t>(out.rows()) != h ||
+        static_cast<size_t>(out.cols()) != w)
+        throw std::invalid_argument{"output size does not match image size"};
+    if (w == 0) return;
 
-        *iter++ = packet;
+    for (size_t u = 0; u < h; u++) {
+        const size_t offset =
+            impl::destagger_offset(pixel_shift_by_row, u, w, inverse);
+        const T* src = img.data() + u * img.outerStride();
+        T* dst = out.data() + u * out.outerStride();
+        std::memcpy(dst + offset, src, (w - offset) * sizeof(T));
+        std::memcpy(dst, src + (w - offset), offset * sizeof(T));
     }
 }
 
-}  // namespace impl
-
 template <typename T>
-inline img_t<T> destagger(const Eigen::Ref<const img_t<T>>& img,
-                          const std::vector<int>& pixel_shift_by_row,
-                          bool inverse) {
+inline void destagger_in_place(Eigen::Ref<img_t<T>> img,
+                               const std::vector<int>& pixel_shift_by_row,
+                               bool inverse) {
     const size_t h = img.rows();
     const size_t w = img.cols();
 
     if (pixel_shift_by_row.size() != h)
         throw std::invalid_argument{"image height does not match shifts size"};
+    if (w == 0) return;
 
-    img_t<T> destaggered{h, w};
     for (size_t u = 0; u < h; u++) {
-        const std::ptrdiff_t offset =
-            ((inverse ? -1 : 1) * pixel_shift_by_row[u] + w) % w;
-
-        destaggered.row(u).segment(offset, w - offset) =
-            img.row(u).segment(0, w - offset);
-        destaggered.row(u).segment(0, offset) =
-            img.row(u).segment(w - offset, offset);
+        const size_t offset =
+            impl::destagger_offset(pixel_shift_by_row, u, w, inverse);
+        T* row = img.data() + u * img.outerStride();
+        std::rotate(row, row + (w - offset), row + w);
     }
+}
+
+template <typename T>
+inline img_t<T> destagger(const Eigen::Ref<const img_t<T>>& img,
+                          const std::vector<int>& pixel_shift_by_row,
+                          bool inverse) {
+    img_t<T> destaggered{img.rows(), img.cols()};
+    destagger_to<T>(destaggered, img, pixel_shift_by_row, inverse);
     return destaggered;
 }
 
@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 #if defined _WIN32  // --------- On Windows ---------
@@ -102,6 +104,98 @@ int socket_set_reuse(SOCKET value);
  */
 int socket_set_rcvtimeout(SOCKET sock, int timeout_sec);
 
+/**
+ * Set the receive buffer size of the specified socket. On Linux, falls back to
+ * SO_RCVBUFFORCE when net.core.rmem_max caps the request, which needs
+ * CAP_NET_ADMIN.
+ * @param[in] sock The socket file descriptor
+ * @param[in] bytes The requested size in bytes
+ * @return The buffer size reported by the kernel afterwards, or SOCKET_ERROR
+ */
+int socket_set_rcvbuf(SOCKET sock, int bytes);
+
+/**
+ * Get the number of datagrams the kernel dropped on the specified UDP socket
+ * because its receive buffer was full. Only supported on Linux, where it is
+ * read from /proc/net/udp and /proc/net/udp6.
+ * @param[in] sock The socket file descriptor
+ * @return The cumulative drop count, or -1 if not available
+ */
+int64_t socket_get_drops(SOCKET sock);
+
+/**
+ * Set SO_BUSY_POLL on the specified socket, so blocking reads and polls busy
+ * wait on the device queue. Only supported on Linux.
+ * @param[in] sock The socket file descriptor
+ * @param[in] usec How long to busy wait in microseconds
+ * @return success
+ */
+int socket_set_busy_poll(SOCKET sock, int usec);
+
+/**
+ * Configure the NIC behind an interface to timestamp every received packet
+ * (SIOCSHWTSTAMP). Needs CAP_NET_ADMIN unless receive timestamping of all
+ * packets is already enabled on the interface. Only supported on Linux.
+ * @param[in] sock Any socket, used to issue the request
+ * @param[in] interface The network interface name
+ * @return success
+ */
+int interface_enable_hardware_timestamps(SOCKET sock,
+                                         const std::string& interface);
+
+/**
+ * Request kernel receive timestamps on the specified socket. Only supported on
+ * Linux.
+ *
+ * Hardware timestamps are the raw time of the NIC's PTP hardware clock, not
+ * CLOCK_REALTIME like software ones, so the two only agree when that clock is
+ * synchronized to the system clock (phc2sys, for example).
+ *
+ * @param[in] sock The socket file descriptor
+ * @param[in] hardware Request NIC timestamps with a software fallback rather
+ * than kernel software timestamps only
+ * @param[in] interface Interface to enable NIC timestamps on. Empty uses the
+ * interface of the address sock is bound to, and fails for the wildcard
+ * address
+ * @return success
+ */
+int socket_enable_timestamps(SOCKET sock, bool hardware,
+                             const std::string& interface = "");
+
+/**
+ * Stop reporting receive timestamps on the specified socket. The NIC
+ * configuration is left as is since other sockets may rely on it.
+ * @param[in] sock The socket file descriptor
+ * @return success
+ */
+int socket_disable_timestamps(SOCKET sock);
+
+/**
+ * Receive a datagram along with its kernel receive timestamp, if the socket
+ * had timestamps enabled with socket_enable_timestamps
+ * @param[in] sock The socket file descriptor
+ * @param[out] buf Buffer to receive into
+ * @param[in] len Size of buf
+ * @param[out] from Sender address, may be null
+ * @param[out] ts Receive timestamp in ns, or 0 if none was reported
+ * @return The number of bytes received, or SOCKET_ERROR
+ */
+int64_t socket_recv_timestamped(SOCKET sock, void* buf, size_t len,
+                                sockaddr_storage* from, uint64_t& ts);
+
+#ifdef __linux__
+/// Size of a control buffer large enough for any receive timestamp message
+const size_t SOCKET_TIMESTAMP_CONTROL_SIZE = 128;
+
+/**
+ * Get the receive timestamp from the control messages of a received datagram
+ * @param[in] msg The message header filled by recvmsg or recvmmsg
+ * @return The hardware timestamp if present, else the software timestamp in
+ * ns, or 0 if there is neither. See socket_enable_timestamps for their clocks
+ */
+uint64_t socket_control_timestamp(const msghdr& msg);
+#endif
+
 }  // namespace impl
 }  // namespace sensor
 }  // namespace ouster
@@ -0,0 +1,114 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Receive UDP datagrams from a memory mapped AF_PACKET ring
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "ouster/impl/ipv4_reassembler.h"
+#include "ouster/impl/netcompat.h"
+#include "ouster/ip_reassembly.h"
+
+namespace ouster {
+namespace sensor {
+namespace impl {
+
+/**
+ * Captures IPv4 UDP datagrams addressed to a set of ports from a TPACKET_V3
+ * PACKET_MMAP ring, so the kernel writes frames directly into memory shared
+ * with userspace rather than queueing them on each UDP socket. Fragmented
+ * datagrams are reassembled. Only supported on Linux and requires CAP_NET_RAW.
+ */
+class PacketMmapCapture {
+   public:
+    /**
+     * Open the capture socket and map its ring.
+     *
+     * @throw runtime_error if the capture socket can't be set up.
+     *
+     * @param[in] interface network interface to capture on, or empty for all.
+     * @param[in] ports UDP destination ports to receive.
+     * @param[in] block_size size in bytes of each ring block, must be a
+     * multiple of the page size and larger than the biggest frame.
+     * @param[in] block_count number of blocks in the ring.
+     * @param[in] block_timeout_ms how long the kernel may hold a partially
+     * filled block before handing it to userspace.
+     * @param[in] hardware_timestamps report NIC receive times when available.
+     */
+    PacketMmapCapture(const std::string& interface, const std::set<int>& ports,
+                      size_t block_size, size_t block_count,
+                      int block_timeout_ms, bool hardware_timestamps);
+
+    ~PacketMmapCapture();
+
+    PacketMmapCapture(const PacketMmapCapture&) = delete;
+    PacketMmapCapture& operator=(const PacketMmapCapture&) = delete;
+
+    /// The capture socket, readable when a block is ready
+    SOCKET socket() const { return fd_; }
+
+    /// Check if a block is ready without polling the socket
+    /// @return true if the next call to next() may return a datagram
+    bool ready() const;
+
+    /**
+     * Get the next captured datagram without blocking.
+     *
+     * @param[out] data UDP payload, resized to the number of bytes copied.
+     * @param[in] max_size largest payload to copy, like recvfrom larger
+     * datagrams are truncated.
+     * @param[out] from sender address and port.
+     * @param[out] ts kernel capture time in ns.
+     *
+     * @return the number of bytes copied, or zero if no datagram is ready.
+     */
+    size_t next(std::vector<uint8_t>& data, size_t max_size,
+                sockaddr_storage& from, uint64_t& ts);
+
+    /// Get the number of frames the kernel dropped because the ring was full
+    /// @return the cumulative drop count since the capture was opened
+    uint64_t drops();
+
+    /// Get the counters of the reassembly of fragmented datagrams
+    /// @return the counters since the capture was opened
+    IpReassemblyStats reassembly_stats() const {
+        return reassembler_.stats();
+    }
+
+   private:
+    /// Handle one frame, returning the size of the datagram it completes
+    size_t handle_frame(const uint8_t* frame, size_t len, uint64_t ts,
+                        std::vector<uint8_t>& data, size_t max_size,
+                        sockaddr_storage& from);
+
+    /// Give the current block back to the kernel and move to the next one
+    void release_block();
+
+    SOCKET fd_;
+    std::set<int> ports_;
+    uint8_t* ring_{nullptr};
+    size_t ring_size_{0};
+    size_t block_size_;
+    size_t block_count_;
+
+    size_t block_{0};                  // current block index
+    uint32_t packets_left_{0};         // unread frames in current block
+    const uint8_t* next_frame_{nullptr};  // next unread frame header
+    bool in_block_{false};
+    uint64_t drops_{0};  // the kernel resets its counters on every read
+
+    IpReassembler reassembler_;
+};
+
+}  // namespace impl
+}  // namespace sensor
+}  // namespace ouster
@@ -5,10 +5,16 @@
 
 #pragma once
 
+#include <memory>
+
+#include "ouster/impl/profile_parser.h"
 #include "ouster/types.h"
 #include "ouster/visibility.h"
 
 namespace ouster {
+
+class LidarScan;
+
 namespace sensor {
 namespace impl {
 
@@ -56,6 +62,18 @@ class OUSTER_API_CLASS packet_writer : public packet_format {
     void set_shutdown_countdown(uint8_t* lidar_buf,
                                 uint8_t shutdown_countdown) const;
 
+    // IMU packets, in the legacy IMU profile, the only one there is
+    OUSTER_API_FUNCTION
+    void set_imu_sys_ts(uint8_t* imu_buf, uint64_t ts) const;
+    OUSTER_API_FUNCTION
+    void set_imu_accel_ts(uint8_t* imu_buf, uint64_t ts) const;
+    OUSTER_API_FUNCTION
+    void set_imu_gyro_ts(uint8_t* imu_buf, uint64_t ts) const;
+    OUSTER_API_FUNCTION
+    void set_imu_la(uint8_t* imu_buf, float x, float y, float z) const;
+    OUSTER_API_FUNCTION
+    void set_imu_av(uint8_t* imu_buf, float x, float y, float z) const;
+
     template <typename T>
     void set_block(Eigen::Ref<const img_t<T>> field, const std::string& i,
                    uint8_t* lidar_buf) const;
@@ -67,6 +85,24 @@ class OUSTER_API_CLASS packet_writer : public packet_format {
     template <typename T>
     void unpack_raw_headers(Eigen::Ref<const img_t<T>> field,
                             uint8_t* lidar_buf) const;
+
+    /**
+     * Encode a packet of a scan, headers, channel fields and CRC, into a
+     * buffer of lidar_packet_size bytes, see scan_to_packets. The built-in
+     * profiles encode all fields of the packet in a single pass.
+     *
+     * @throw std::out_of_range if the scan has no such packet.
+     *
+     * @return false if no column of the packet is valid and it has no host
+     * timestamp, as the sensor doesn't send such packets.
+     */
+    OUSTER_API_FUNCTION
+    bool write_packet(const LidarScan& ls, size_t p_id, uint8_t* lidar_buf,
+                      uint32_t init_id, uint64_t prod_sn) const;
+
+   private:
+    std::shared_ptr<const profile_encoder> encoder_{
+        make_profile_encoder(*this)};
 };
 
 }  // namespace impl
@@ -0,0 +1,103 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Packet parsers specialized at compile time for built-in lidar profiles
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "ouster/types.h"
+
+namespace ouster {
+
+class LidarScan;
+
+namespace sensor {
+namespace impl {
+
+/**
+ * Parses block parsable lidar packets of one profile into a LidarScan.
+ *
+ * Implementations for the built-in profiles have the field offsets, masks and
+ * shifts baked in as constants instead of looking them up per field and
+ * applying them at runtime, and decode all fields in a single pass over the
+ * packet.
+ */
+class profile_parser {
+   public:
+    virtual ~profile_parser() = default;
+
+    /**
+     * Decode the column headers and every channel field of the profile that ls
+     * has from a packet. The caller takes care of zeroing skipped columns, as
+     * in ScanBatcher::parse_by_block.
+     *
+     * @throw invalid_argument if a field of ls is too narrow for its data.
+     *
+     * @param[in] packet_buf the lidar packet, which must be block parsable.
+     * @param[out] ls the scan to fill in.
+     */
+    virtual void parse_block(const uint8_t* packet_buf,
+                             LidarScan& ls) const = 0;
+};
+
+/**
+ * Get the specialized parser for a packet format.
+ *
+ * @param[in] pf the packet format.
+ *
+ * @return the parser, or null if the profile has none or the packets
+ * can't be parsed by blocks. Custom profiles added with add_custom_profile get
+ * a parser planned from their field table when it's created.
+ */
+std::shared_ptr<const profile_parser> make_profile_parser(
+    const packet_format& pf);
+
+/**
+ * Encodes the channel fields of a LidarScan into lidar packets of one
+ * profile, the inverse of profile_parser.
+ *
+ * Implementations for the built-in profiles have the field offsets, masks and
+ * shifts baked in as constants and write all fields of a pixel in a single
+ * pass over the packet, instead of looking up and writing every field
+ * separately as packet_writer::set_block does.
+ */
+class profile_encoder {
+   public:
+    virtual ~profile_encoder() = default;
+
+    /**
+     * Encode every channel field of the profile that ls has into the valid
+     * columns of a packet, whose column headers must already be written. The
+     * result is the same as packet_writer::set_block for each field.
+     *
+     * @param[in] ls the scan to encode.
+     * @param[in,out] packet_buf the lidar packet.
+     *
+     * @return false without writing anything if the fields of ls don't have
+     * the types of the profile, or hold raw words along with the fields they
+     * overlap, which the caller then writes field by field.
+     */
+    virtual bool encode_block(const LidarScan& ls,
+                              uint8_t* packet_buf) const = 0;
+};
+
+/**
+ * Get the specialized encoder for a packet format.
+ *
+ * @param[in] pf the packet format.
+ *
+ * @return the encoder, or null if the profile has none or the packets can't
+ * be parsed by blocks.
+ */
+std::shared_ptr<const profile_encoder> make_profile_encoder(
+    const packet_format& pf);
+
+}  // namespace impl
+}  // namespace sensor
+}  // namespace ouster
@@ -9,7 +9,9 @@
 #include <atomic>
 #include <cstdint>
 #include <numeric>
+#include <memory>
 #include <stdexcept>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -48,7 +50,12 @@ class RingBuffer {
     static_assert(std::is_copy_constructible<T>::value,
                   "must be copy constructible");
 
-    std::atomic<size_t> r_idx_, w_idx_;
+    // keep the reader and writer indices on separate cache lines
+    char pad0_[64];
+    std::atomic<size_t> r_idx_;
+    char pad1_[64];
+    std::atomic<size_t> w_idx_;
+    char pad2_[64];
     std::vector<T> bufs_;
 
     OUSTER_API_IGNORE
@@ -149,6 +156,163 @@ class RingBuffer {
     }
 };
 
+/**
+ * Fixed capacity lock-free ring buffer of reusable slots for one producer and
+ * one consumer thread.
+ *
+ * Elements are never constructed or destroyed after the ring is built: the
+ * producer writes into a free slot in place and the consumer reads (or swaps
+ * out) the contents of the oldest slot in place. When the ring is full the
+ * producer evicts the oldest element, so a slow consumer never stalls the
+ * producer.
+ *
+ * Each slot carries a sequence number which hands ownership of the slot back
+ * and forth between the threads, so no locks are taken on either side.
+ *
+ * \code
+ * auto rb = DropOldestRingBuffer<T>{size, T{...}};
+ *
+ * // producer
+ * bool dropped = rb.push([](T& element) { do_write(element); });
+ *
+ * // consumer
+ * bool got = rb.pop([](T& element) { do_read(element); });
+ * \endcode
+ */
+template <typename T>
+class DropOldestRingBuffer {
+    struct Slot {
+        std::atomic<size_t> seq;
+        T value;
+    };
+
+    size_t capacity_;
+    std::unique_ptr<Slot[]> slots_;
+    // keep the producer and consumer indices on separate cache lines
+    char pad0_[64];
+    std::atomic<size_t> w_idx_;
+    char pad1_[64];
+    std::atomic<size_t> r_idx_;
+    char pad2_[64];
+
+    // claim the oldest element, returns false if the ring is empty
+    template <typename F>
+    bool _pop(F&& read) {
+        size_t pos = r_idx_.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots_[pos % capacity_];
+            size_t seq = slot.seq.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) -
+                        static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (r_idx_.compare_exchange_weak(pos, pos + 1,
+                                                 std::memory_order_relaxed)) {
+                    read(slot.value);
+                    slot.seq.store(pos + capacity_, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = r_idx_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+   public:
+    /**
+     * Construct a ring buffer.
+     *
+     * @param[in] size number of slots, must be at least 1
+     * @param[in] value initial value of every slot
+     */
+    DropOldestRingBuffer(size_t size, const T& value = {})
+        : capacity_(std::max<size_t>(size, 1)),
+          slots_(new Slot[capacity_]),
+          w_idx_(0),
+          r_idx_(0) {
+        for (size_t i = 0; i < capacity_; i++) {
+            slots_[i].seq.store(i, std::memory_order_relaxed);
+            slots_[i].value = value;
+        }
+    }
+
+    /**
+     * Report the total capacity of allocated elements.
+     */
+    size_t capacity() const { return capacity_; }
+
+    /**
+     * Report the number of elements currently stored. Only approximate while
+     * the other thread is pushing or popping.
+     */
+    size_t size() const {
+        size_t w = w_idx_.load(std::memory_order_acquire);
+        size_t r = r_idx_.load(std::memory_order_acquire);
+        return w > r ? std::min(w - r, capacity_) : 0;
+    }
+
+    /**
+     * Check whether ring buffer is empty.
+     */
+    bool empty() const { return size() == 0; }
+
+    /**
+     * Write a new element in place, evicting the oldest one if full.
+     *
+     * Must only be called from the producer thread.
+     *
+     * @param[in] write callable invoked with a reference to the slot to fill
+     *
+     * @return the number of elements evicted to make room
+     */
+    template <typename F>
+    size_t push(F&& write) {
+        size_t dropped = 0;
+        size_t pos = w_idx_.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots_[pos % capacity_];
+            size_t seq = slot.seq.load(std::memory_order_acquire);
+            if (seq == pos) {
+                write(slot.value);
+                slot.seq.store(pos + 1, std::memory_order_release);
+                w_idx_.store(pos + 1, std::memory_order_release);
+                return dropped;
+            }
+            if (r_idx_.load(std::memory_order_acquire) + capacity_ > pos) {
+                // the consumer claimed this slot and is still reading it
+                std::this_thread::yield();
+            } else if (_pop([](T&) {})) {
+                dropped++;
+            }
+        }
+    }
+
+    /**
+     * Read the oldest element in place and release its slot.
+     *
+     * @param[in] read callable invoked with a reference to the oldest slot;
+     *            it may swap the contents out to avoid a copy
+     *
+     * @return false if the ring buffer was empty
+     */
+    template <typename F>
+    bool pop(F&& read) {
+        return _pop(std::forward<F>(read));
+    }
+
+    /**
+     * Discard all stored elements.
+     *
+     * @return the number of elements discarded
+     */
+    size_t flush() {
+        size_t count = 0;
+        while (_pop([](T&) {})) count++;
+        return count;
+    }
+};
+
 /**
  * Convenience class for working with multiple ring buffers.
  */
@@ -0,0 +1,84 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Spin waiting with backoff for busy-poll modes
+ */
+
+#pragma once
+
+#include <chrono>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || \
+    defined(_M_IX86)
+#include <immintrin.h>
+#define OUSTER_CPU_RELAX() _mm_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+#define OUSTER_CPU_RELAX() __asm__ __volatile__("yield")
+#else
+#define OUSTER_CPU_RELAX()
+#endif
+
+namespace ouster {
+namespace sensor {
+namespace impl {
+
+/**
+ * Exponential backoff for spin loops: pauses the core for a growing number of
+ * iterations, then falls back to yielding the thread so that a spinning
+ * consumer doesn't starve a producer sharing its core.
+ */
+class SpinBackoff {
+   public:
+    /// Wait a little longer than the previous call
+    void wait() {
+        if (spins_ < max_pause_spins) {
+            for (unsigned i = 0; i < (1u << spins_); i++) {
+                OUSTER_CPU_RELAX();
+            }
+            spins_++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    /// Start again from the shortest wait
+    void reset() { spins_ = 0; }
+
+   private:
+    // up to 2^(max_pause_spins - 1) pauses, roughly a microsecond on x86
+    static const unsigned max_pause_spins = 8;
+    unsigned spins_ = 0;
+};
+
+/**
+ * Spin until ready() returns true or the timeout expires.
+ *
+ * @param[in] ready predicate to poll.
+ * @param[in] timeout_sec how long to spin, negative spins forever.
+ *
+ * @return the last result of ready().
+ */
+template <typename F>
+bool spin_until(F&& ready, double timeout_sec) {
+    if (ready()) {
+        return true;
+    }
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::duration<double>(timeout_sec));
+    SpinBackoff backoff;
+    while (timeout_sec < 0 || std::chrono::steady_clock::now() < deadline) {
+        backoff.wait();
+        if (ready()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace impl
+}  // namespace sensor
+}  // namespace ouster
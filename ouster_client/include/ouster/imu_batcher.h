@@ -0,0 +1,133 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Batching of IMU packets into arrays per scan
+ */
+
+#pragma once
+
+#include <Eigen/Core>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ouster/imu_preintegrator.h"
+#include "ouster/lidar_scan.h"
+#include "ouster/packet.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+/// The IMU samples of a scan period as a structure of arrays, in SI units
+/// like ImuSample. The arrays keep their capacity as batches are refilled,
+/// so that batching allocates only while they grow.
+struct OUSTER_API_CLASS ImuBatch {
+    /// Matrix of the x, y and z of each sample
+    using Xyz = Eigen::Matrix<double, Eigen::Dynamic, 3, Eigen::RowMajor>;
+
+    std::vector<uint64_t> ts;        ///< gyroscope timestamps in ns
+    std::vector<uint64_t> accel_ts;  ///< accelerometer timestamps in ns
+    std::vector<double> accel;       ///< x, y, z specific force in m/s^2
+    std::vector<double> gyro;        ///< x, y, z angular velocity in rad/s
+
+    /// Index of the first valid column of the scan at or after each sample,
+    /// or -1 for the samples before the first valid column
+    std::vector<int32_t> column;
+
+    /// @return the number of samples
+    OUSTER_API_FUNCTION size_t size() const { return ts.size(); }
+
+    /// @return true if there are no samples
+    OUSTER_API_FUNCTION bool empty() const { return ts.empty(); }
+
+    /// Remove the samples, keeping the capacity
+    OUSTER_API_FUNCTION void clear();
+
+    /// Preallocate the arrays for samples
+    OUSTER_API_FUNCTION void reserve(size_t samples  ///< [in] capacity
+    );
+
+    /// Append a sample, with a column of -1
+    OUSTER_API_FUNCTION void push_back(
+        const ImuSample& sample,  ///< [in] the sample
+        uint64_t accel_ts         ///< [in] accelerometer timestamp in ns
+    );
+
+    /// @return the sample at an index
+    OUSTER_API_FUNCTION ImuSample sample(size_t i  ///< [in] index
+    ) const;
+
+    /// @return a view of the specific forces, a (size, 3) matrix
+    OUSTER_API_FUNCTION Eigen::Map<const Xyz> accel_xyz() const {
+        return Eigen::Map<const Xyz>(accel.data(), size(), 3);
+    }
+
+    /// @return a view of the angular velocities, a (size, 3) matrix
+    OUSTER_API_FUNCTION Eigen::Map<const Xyz> gyro_xyz() const {
+        return Eigen::Map<const Xyz>(gyro.data(), size(), 3);
+    }
+};
+
+/// Accumulates the ImuPackets of a sensor, read alongside its lidar packets
+/// by a ScanBatcher, into an ImuBatch per scan, with each sample aligned to
+/// the columns of the scan:
+///
+///     ScanBatcher batch(info);
+///     ImuBatcher imu_batch;
+///     ImuBatch imu;
+///     // for each packet
+///     if (packet.type() == PacketType::Imu) {
+///         imu_batch(packet.as<ImuPacket>());
+///     } else if (batch(packet.as<LidarPacket>(), scan)) {
+///         imu_batch.batch(scan, imu);
+///         preintegrator.add(imu);
+///     }
+///
+/// Timestamps are those of the sensor clock, like the column timestamps of
+/// the scans. Samples not after the previous one are dropped.
+class OUSTER_API_CLASS ImuBatcher {
+   public:
+    /// Create a batcher, preallocating for samples pending
+    OUSTER_API_FUNCTION explicit ImuBatcher(
+        size_t capacity = 256  ///< [in] samples preallocated
+    );
+
+    /// Add the sample of an IMU packet, converting accelerations from g and
+    /// angular velocities from deg/s, timestamped with its gyroscope
+    /// timestamp like ImuPreintegrator::add()
+    OUSTER_API_FUNCTION void operator()(const sensor::ImuPacket& packet);
+
+    /// Add a sample in SI units
+    OUSTER_API_FUNCTION void add(
+        const ImuSample& sample,  ///< [in] the sample
+        uint64_t accel_ts = 0     ///< [in] accelerometer timestamp in ns,
+                                  ///< that of sample if zero
+    );
+
+    /// Move the samples pending up to the last valid column of a scan into
+    /// a batch, replacing its samples. Samples after the scan stay pending
+    /// for the next one. Nothing is moved if the scan has no valid column.
+    ///
+    /// @return the number of samples in the batch
+    OUSTER_API_FUNCTION size_t batch(
+        const LidarScan& scan,  ///< [in] scan just batched
+        ImuBatch& out           ///< [out] samples of the scan period
+    );
+
+    /// @return the number of samples pending
+    OUSTER_API_FUNCTION size_t pending() const;
+
+    /// @return the number of samples dropped as out of order
+    OUSTER_API_FUNCTION uint64_t dropped() const;
+
+    /// Forget the samples pending
+    OUSTER_API_FUNCTION void reset();
+
+   private:
+    ImuBatch pending_;
+    uint64_t dropped_{0};
+};
+
+}  // namespace ouster
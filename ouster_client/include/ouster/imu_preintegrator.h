@@ -0,0 +1,153 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Integration of IMU packets into sensor poses for dewarping
+ */
+
+#pragma once
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/packet.h"
+#include "ouster/types.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+struct ImuBatch;
+
+/// An IMU measurement in SI units, in the IMU frame
+struct OUSTER_API_CLASS ImuSample {
+    uint64_t ts;           ///< timestamp in ns
+    Eigen::Vector3d accel;  ///< specific force in m/s^2
+    Eigen::Vector3d gyro;   ///< angular velocity in rad/s
+};
+
+/// Integrates IMU samples, e.g. the ImuPackets of a SensorClient, pcap or OSF
+/// source as they are read, into the orientation, velocity and position of
+/// the sensor in a gravity aligned frame, for cheap low latency dewarping
+/// without registration.
+///
+/// The first samples are assumed static: their mean angular velocity is the
+/// gyroscope bias and their mean specific force sets the initial roll and
+/// pitch, with a yaw of zero, as get_rot_matrix_to_align_to_gravity of the
+/// python SDK. Later samples are integrated with the biases removed.
+/// Velocity and position drift quickly without corrections, see
+/// set_velocity().
+///
+/// Poses are those of the sensor frame, in meters like the points of
+/// make_xyz_lut(), at any timestamp in the integrated history: interpolated
+/// between samples, or extrapolated with the last angular and linear velocity.
+class OUSTER_API_CLASS ImuPreintegrator {
+   public:
+    /// Standard gravity in m/s^2
+    static constexpr double gravity = 9.80665;
+
+    OUSTER_API_FUNCTION explicit ImuPreintegrator(
+        const mat4d& imu_to_sensor_transform =
+            mat4d::Identity(),      ///< [in] from sensor_info, translation in
+                                    ///< mm
+        size_t init_samples = 100,  ///< [in] number of static samples
+                                    ///< estimating the gyroscope bias and
+                                    ///< gravity
+        double history = 1.0);      ///< [in] seconds of states kept
+
+    /// Integrate an IMU packet, converting accelerations from g and angular
+    /// velocities from deg/s, timestamped with its gyroscope timestamp.
+    OUSTER_API_FUNCTION void add(const sensor::ImuPacket& packet);
+
+    /// Integrate a sample. Samples not after the last one are ignored.
+    OUSTER_API_FUNCTION void add(const ImuSample& sample);
+
+    /// Integrate the samples of a batch, see ImuBatcher.
+    OUSTER_API_FUNCTION void add(const ImuBatch& batch);
+
+    /// @return true once the static samples have been averaged
+    OUSTER_API_FUNCTION bool initialized() const;
+
+    /// Forget all samples and states, keeping the biases if keep_bias, or
+    /// estimating them again from the next static samples otherwise.
+    OUSTER_API_FUNCTION void reset(bool keep_bias = false);
+
+    /// Set the biases removed from the samples, skipping the static
+    /// initialization of the gyroscope bias if not initialized yet.
+    OUSTER_API_FUNCTION void set_bias(
+        const Eigen::Vector3d& gyro,    ///< [in] in rad/s
+        const Eigen::Vector3d& accel);  ///< [in] in m/s^2
+
+    /// @return the gyroscope bias in rad/s
+    OUSTER_API_FUNCTION const Eigen::Vector3d& gyro_bias() const;
+
+    /// @return the accelerometer bias in m/s^2
+    OUSTER_API_FUNCTION const Eigen::Vector3d& accel_bias() const;
+
+    /// Correct the velocity of the IMU in the world frame at the last state,
+    /// e.g. with zero when known to be static or with a registration estimate.
+    ///
+    /// @throw runtime_error if not initialized
+    OUSTER_API_FUNCTION void set_velocity(
+        const Eigen::Vector3d& velocity);  ///< [in] in m/s
+
+    /// @return the velocity of the IMU in the world frame at the last state,
+    /// in m/s
+    ///
+    /// @throw runtime_error if not initialized
+    OUSTER_API_FUNCTION Eigen::Vector3d velocity() const;
+
+    /// Write the poses of the sensor at timestamps.
+    ///
+    /// @throw runtime_error if not initialized
+    /// @throw invalid_argument if poses has fewer rows than ts
+    OUSTER_API_FUNCTION void poses_at(
+        Eigen::Ref<pose_util::Poses> poses,  ///< [out] flattened 4x4 poses
+        const Eigen::Ref<const Eigen::ArrayXd>& ts)
+        const;  ///< [in] timestamps in ns
+
+    /// @return the poses of the sensor at timestamps in ns, see poses_at()
+    OUSTER_API_FUNCTION pose_util::Poses poses_at(
+        const Eigen::Ref<const Eigen::ArrayXd>& ts) const;
+
+    /// Write the poses of the sensor at the timestamps of the valid columns of
+    /// a scan, i.e. with the first bit of status set, to LidarScan::pose().
+    /// The poses of the other columns are left unchanged.
+    ///
+    /// @throw runtime_error if not initialized
+    OUSTER_API_FUNCTION void pose_scan(LidarScan& scan) const;
+
+   private:
+    struct State {
+        double t;               // seconds since the origin
+        Eigen::Quaterniond q;   // orientation of the IMU in the world
+        Eigen::Vector3d p;      // position of the IMU in the world, in m
+        Eigen::Vector3d v;      // velocity of the IMU in the world, in m/s
+        Eigen::Vector3d w;      // bias corrected angular velocity, in rad/s
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    };
+
+    Eigen::Matrix4d pose_at(double t) const;
+    void check_initialized() const;
+
+    Eigen::Matrix4d imu_to_sensor_;
+    size_t init_samples_;
+    double history_;
+    bool bias_set_ = false;
+    Eigen::Vector3d gyro_bias_ = Eigen::Vector3d::Zero();
+    Eigen::Vector3d accel_bias_ = Eigen::Vector3d::Zero();
+
+    uint64_t origin_ = 0;
+    size_t init_count_ = 0;
+    Eigen::Vector3d init_gyro_ = Eigen::Vector3d::Zero();
+    Eigen::Vector3d init_accel_ = Eigen::Vector3d::Zero();
+    bool has_last_ = false;
+    ImuSample last_{};
+    std::deque<State, Eigen::aligned_allocator<State>> states_;
+};
+
+}  // namespace ouster
@@ -0,0 +1,159 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file ip_reassembly.h
+ * @brief Reassembles IPv4 fragments into datagrams in preallocated memory
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace sensor {
+
+/**
+ * How an IpReassembler bounds its memory and drops partial datagrams.
+ */
+struct OUSTER_API_CLASS IpReassemblyOptions {
+    /**
+     * The datagrams reassembled at the same time, at least 1. A fragment of
+     * another datagram when all are in use evicts the least recently
+     * updated one.
+     */
+    size_t capacity{16};
+
+    /**
+     * The largest IP packet reassembled, header included, at most 65535.
+     * Fragments reaching past it are dropped with their datagram.
+     */
+    size_t max_datagram_size{65535};
+
+    /**
+     * How long after its last fragment a partial datagram is dropped.
+     */
+    std::chrono::microseconds timeout{2000000};
+};
+
+/**
+ * The counters of an IpReassembler.
+ */
+struct OUSTER_API_CLASS IpReassemblyStats {
+    uint64_t fragments{0};    ///< fragments processed
+    uint64_t reassembled{0};  ///< datagrams completed
+    uint64_t timed_out{0};    ///< partial datagrams dropped on timeout
+    uint64_t evicted{0};      ///< partial datagrams dropped for another
+    uint64_t malformed{0};    ///< fragments dropped as invalid or too large
+    size_t in_progress{0};    ///< partial datagrams held
+    size_t capacity{0};       ///< partial datagrams that can be held
+    size_t memory{0};         ///< bytes preallocated for the datagrams
+};
+
+/**
+ * Reassembles fragmented IPv4 packets, e.g. lidar packets larger than the MTU
+ * of the network they were captured on, from raw packet bytes.
+ *
+ * All memory is allocated on construction: a fixed number of slots, each
+ * with a buffer for a whole datagram and a bitmap of the 8 byte blocks it
+ * received, so that processing fragments doesn't allocate. Fragments may
+ * arrive in any order, duplicates and overlaps replace the bytes received
+ * before. Datagrams are told apart by their id, addresses and protocol.
+ *
+ * Takes the bytes of IP packets, without their link layer headers, so that it
+ * serves pcap reading and live capture alike. Not safe to use from multiple
+ * threads.
+ */
+class OUSTER_API_CLASS IpReassembler {
+   public:
+    /**
+     * The status of each processed packet.
+     */
+    enum Status {
+        NOT_FRAGMENTED,  ///< not an IPv4 fragment, e.g. a whole packet
+        FRAGMENTED,      ///< a fragment, the datagram isn't complete yet
+        REASSEMBLED      ///< the last missing fragment of a datagram
+    };
+
+    /**
+     * @throws std::invalid_argument Exception on a capacity of 0 or a
+     *                               max_datagram_size out of range.
+     *
+     * @param[in] options How to bound memory and drop partial datagrams.
+     */
+    OUSTER_API_FUNCTION
+    explicit IpReassembler(
+        const IpReassemblyOptions& options = IpReassemblyOptions());
+
+    /**
+     * Process an IP packet.
+     *
+     * @param[in] timestamp The capture timestamp of the packet, for timeouts.
+     * @param[in] ip The bytes of the packet from its IP header on.
+     * @param[in] size The number of bytes of the packet.
+     * @param[out] datagram On REASSEMBLED, the whole IPv4 packet, with the
+     *                      header of the first fragment updated for its
+     *                      length and not fragmented. Valid until the next
+     *                      call.
+     * @param[out] datagram_size On REASSEMBLED, the size of the packet.
+     * @return What the packet was.
+     */
+    OUSTER_API_FUNCTION
+    Status process(std::chrono::microseconds timestamp, const uint8_t* ip,
+                   size_t size, const uint8_t*& datagram,
+                   size_t& datagram_size);
+
+    /**
+     * @return The counters since construction.
+     */
+    OUSTER_API_FUNCTION
+    IpReassemblyStats stats() const;
+
+    /**
+     * Drop the partial datagrams, e.g. on seeking. They aren't counted as
+     * timed out nor evicted.
+     */
+    OUSTER_API_FUNCTION
+    void clear();
+
+   private:
+    struct OUSTER_API_IGNORE Slot {
+        bool used{false};
+        uint16_t id{0};
+        uint8_t protocol{0};
+        uint32_t src{0};
+        uint32_t dst{0};
+        std::chrono::microseconds last_timestamp{0};
+        size_t header_size{0};  ///< of the first fragment, 0 until received
+        size_t total_size{0};   ///< of the payload, 0 until the last fragment
+        size_t blocks{0};       ///< 8 byte blocks of the payload received
+        size_t end{0};          ///< the end of the payload received so far
+    };
+
+    /**
+     * Find the slot of a datagram, or take a free or the least recently
+     * updated one for it.
+     */
+    size_t slot_for(std::chrono::microseconds timestamp, uint16_t id,
+                    uint8_t protocol, uint32_t src, uint32_t dst);
+
+    void release(size_t slot);
+
+    IpReassemblyOptions options_;
+    std::vector<Slot> slots_;
+    /// the datagrams of the slots, the payload of each after room for the
+    /// largest header
+    std::vector<uint8_t> buffers_;
+    /// the received blocks of the slots, a bit per 8 bytes of payload
+    std::vector<uint64_t> bitmaps_;
+    size_t bitmap_words_{0};
+    IpReassemblyStats stats_;
+};
+
+}  // namespace sensor
+}  // namespace ouster
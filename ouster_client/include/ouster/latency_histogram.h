@@ -0,0 +1,105 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Lock free latency histograms for pipeline instrumentation
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace sensor {
+
+/// Summary of the latencies recorded by a LatencyHistogram, in nanoseconds.
+/// Quantiles are exact up to the relative precision of the histogram.
+struct OUSTER_API_CLASS LatencyStats {
+    uint64_t count = 0;  ///< number of latencies recorded
+    uint64_t min = 0;    ///< smallest latency recorded
+    uint64_t max = 0;    ///< largest latency recorded
+    double mean = 0;     ///< mean of the latencies recorded
+    uint64_t p50 = 0;    ///< median
+    uint64_t p90 = 0;    ///< 90th percentile
+    uint64_t p99 = 0;    ///< 99th percentile
+    uint64_t p999 = 0;   ///< 99.9th percentile
+};
+
+/// Histogram of latencies in nanoseconds with logarithmic buckets, each
+/// power of two split in 32 linear sub buckets as in HdrHistogram, for a
+/// relative error below 3.2% over the whole 64 bit range.
+///
+/// Recording is wait free, so it can be done from a hot path. Each
+/// histogram is meant to be recorded to by a single thread, and read from
+/// any thread; pipelines keep one per thread and add them up when read.
+class OUSTER_API_CLASS LatencyHistogram {
+   public:
+    /// Number of sub buckets every power of two is split into
+    static constexpr int sub_buckets = 32;
+    /// Total number of buckets
+    static constexpr int buckets = 60 * sub_buckets;
+
+    OUSTER_API_FUNCTION
+    LatencyHistogram();
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    /// Record a latency
+    OUSTER_API_FUNCTION
+    void record(uint64_t ns  ///< [in] latency in nanoseconds
+    );
+
+    /// Add the latencies recorded by another histogram to this one. Not
+    /// atomic with respect to concurrent records of either.
+    OUSTER_API_FUNCTION
+    void add(const LatencyHistogram& other  ///< [in] histogram to add
+    );
+
+    /// Forget every latency recorded
+    OUSTER_API_FUNCTION
+    void reset();
+
+    /// Get the number of latencies recorded
+    /// @return the count
+    OUSTER_API_FUNCTION
+    uint64_t count() const;
+
+    /// Get the latency at a quantile of the latencies recorded
+    /// @return the latency in nanoseconds, or 0 if nothing was recorded
+    OUSTER_API_FUNCTION
+    uint64_t value_at_quantile(double q  ///< [in] quantile, within [0, 1]
+    ) const;
+
+    /// Summarize the latencies recorded
+    /// @return the summary
+    OUSTER_API_FUNCTION
+    LatencyStats summary() const;
+
+    /// Get the index of the bucket counting a latency
+    /// @return the bucket index
+    OUSTER_API_FUNCTION
+    static int bucket_index(uint64_t ns  ///< [in] latency in nanoseconds
+    );
+
+    /// Get the smallest latency counted in a bucket
+    /// @return the latency in nanoseconds
+    OUSTER_API_FUNCTION
+    static uint64_t bucket_lowest(int index  ///< [in] bucket index
+    );
+
+   private:
+    std::array<std::atomic<uint64_t>, buckets> counts_;
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> sum_;
+    std::atomic<uint64_t> min_;
+    std::atomic<uint64_t> max_;
+};
+
+}  // namespace sensor
+}  // namespace ouster
@@ -8,6 +8,9 @@
 #include <Eigen/Core>
 #include <chrono>
 #include <cstddef>
+#include <functional>
+#include <limits>
+#include <memory>
 #include <stdexcept>
 #include <type_traits>
 #include <unordered_map>
@@ -103,6 +106,23 @@ bool operator!=(const FieldType& a, const FieldType& b);
  */
 using LidarScanFieldTypes = std::vector<FieldType>;
 
+/**
+ * Interned name of a LidarScan field, see LidarScan::field_handle. Handles are
+ * shared by the whole process, so one works with every scan.
+ */
+struct OUSTER_API_CLASS FieldHandle {
+    uint32_t id;  ///< index of the name in the table of interned names
+};
+
+class ScanBatcher;
+class ReframingBatcher;
+class ShmScanReader;
+
+namespace impl {
+struct deferred_packets;
+struct scan_arena_access;
+}  // namespace impl
+
 /**
  * Data structure for efficient operations on aggregated lidar data.
  *
@@ -137,6 +157,58 @@ class OUSTER_API_CLASS LidarScan {
      */
     Field alert_flags_;
 
+    // channel fields left to decode from deferred_packets_ on first access,
+    // see ScanBatcher::set_deferred_decode
+    mutable std::vector<std::string> deferred_fields_;
+    std::shared_ptr<impl::deferred_packets> deferred_packets_;
+
+    // decode one deferred field, or all of them
+    void decode_deferred(const std::string& name) const;
+    void decode_deferred() const;
+
+    // fields_ by FieldHandle id, null for names the scan doesn't have; out of
+    // date after the map returned by fields() may have been modified
+    mutable std::vector<Field*> index_;
+    mutable bool index_dirty_{false};
+    void reindex() const;
+    Field* find_field(FieldHandle handle) const;
+
+    // single allocation holding every field and header of a contiguous scan,
+    // see make_contiguous
+    std::shared_ptr<uint8_t> arena_;
+    size_t arena_bytes_{0};
+
+    // copy the contents of a scan of the same layout into the fields of this
+    // one, returning false without copying if the layouts differ
+    bool assign_in_place(const LidarScan& other);
+
+    // keep the fields of types from ls_src, copying or sharing them, for
+    // LidarScan(const LidarScan&, const LidarScanFieldTypes&)
+    void select_fields(const LidarScan& ls_src,
+                       const LidarScanFieldTypes& field_types, bool share);
+
+    // give this scan private copies of the fields it shares with shallow
+    // copies, before writing to them
+    void unshare();
+
+    // point the fields and headers of this scan into a copy of the arena of
+    // a contiguous scan
+    void copy_arena(const LidarScan& other);
+
+    // make_contiguous, optionally leaving the contents of the arena as they
+    // are, e.g. to view a scan another process wrote to shared memory
+    static LidarScan layout_arena(
+        size_t w, size_t h, const LidarScanFieldTypes& field_types,
+        size_t columns_per_packet,
+        std::function<std::shared_ptr<uint8_t>(size_t)> allocator,
+        bool initialize);
+
+    friend class ScanBatcher;
+    friend class ReframingBatcher;
+    friend class ShmScanReader;
+    friend struct impl::scan_arena_access;
+    friend LidarScan reduce_by_factor(const LidarScan& scan, int factor);
+
     LidarScan(size_t w, size_t h, LidarScanFieldTypes field_types,
               size_t columns_per_packet);
 
@@ -269,6 +341,62 @@ class OUSTER_API_CLASS LidarScan {
               size_t columns_per_packet = DEFAULT_COLUMNS_PER_PACKET)
         : LidarScan(w, h, {begin, end}, columns_per_packet) {}
 
+    /**
+     * Initialize a scan with a custom set of fields, choosing whether the
+     * memory of the fields is zeroed. A ScanBatcher writes or zeroes every
+     * column of the fields it decodes, so scans it fills in can skip zeroing
+     * them; fields it doesn't decode are left uninitialized too. The headers
+     * are zeroed and the poses set to identity either way.
+     *
+     * @param[in] w horizontal resolution, i.e. the number of measurements per
+     *              scan.
+     * @param[in] h vertical resolution, i.e. the number of channels.
+     * @param[in] field_types the fields of the scan.
+     * @param[in] columns_per_packet The number of columns per packet.
+     * @param[in] init how the memory of the fields is initialized.
+     */
+    OUSTER_API_FUNCTION
+    LidarScan(size_t w, size_t h, const LidarScanFieldTypes& field_types,
+              size_t columns_per_packet, FieldInit init);
+
+    /**
+     * Allocates memory of the given size for the arena of a contiguous scan,
+     * e.g. from shared memory or huge pages. The memory should be aligned to
+     * 64 bytes and must be aligned to 8.
+     */
+    using ArenaAllocator = std::function<std::shared_ptr<uint8_t>(size_t)>;
+
+    /**
+     * Initialize a scan with a custom set of fields, like
+     * LidarScan(size_t, size_t, Iterator, Iterator, size_t), but with every
+     * field, column header, packet header and the pose in one allocation. Each
+     * field starts on a 64 byte boundary, pixel fields first. Copies of a
+     * contiguous scan are contiguous too and are made with a single memcpy.
+     * Fields added later are allocated separately and make the scan no longer
+     * contiguous.
+     *
+     * @param[in] w horizontal resolution, i.e. the number of measurements per
+     *              scan.
+     * @param[in] h vertical resolution, i.e. the number of channels.
+     * @param[in] field_types the fields of the scan.
+     * @param[in] columns_per_packet The number of columns per packet.
+     * @param[in] allocator allocates the arena, or empty for the heap.
+     * @param[in] init how the memory of the fields is initialized, see
+     *                 LidarScan(size_t, size_t, const LidarScanFieldTypes&,
+     *                 size_t, FieldInit).
+     *
+     * @throw std::invalid_argument if w, h or columns_per_packet is zero, a
+     *        field is invalid, or the allocator returns null or misaligned
+     *        memory.
+     *
+     * @return the scan, zero initialized unless init is UNINITIALIZED.
+     */
+    OUSTER_API_FUNCTION
+    static LidarScan make_contiguous(
+        size_t w, size_t h, const LidarScanFieldTypes& field_types,
+        size_t columns_per_packet = DEFAULT_COLUMNS_PER_PACKET,
+        ArenaAllocator allocator = {}, FieldInit init = FieldInit::ZEROED);
+
     /**
      * Initialize a lidar scan from another lidar scan.
      *
@@ -294,7 +422,43 @@ class OUSTER_API_CLASS LidarScan {
     LidarScan(LidarScan&& other);
 
     /**
-     * Copy.
+     * Copy the scan without copying its fields: the copy shares the memory
+     * of every field and header with this scan, copy-on-write. Writable
+     * access to a shared field through either scan, e.g. the non-const
+     * field(), fields(), timestamp() or batching into the scan, first gives
+     * that scan a private copy of the field, so copying a scan for several
+     * readers costs a reference count per field.
+     *
+     * Pointers and views into the fields of this scan taken before copying
+     * write to the shared memory, and are invalidated when this scan gets
+     * its private copy; take them again after copying. The first shallow
+     * copy of a scan must not run concurrently with other use of it, while
+     * a scan that was already shallow copied, or is a shallow copy, may be
+     * shallow copied from several threads.
+     *
+     * @return the copy
+     */
+    OUSTER_API_FUNCTION
+    LidarScan shallow_copy() const;
+
+    /**
+     * Like LidarScan(const LidarScan& other, const LidarScanFieldTypes&
+     * fields), but sharing the fields kept with the same type copy-on-write,
+     * see shallow_copy(). Fields cast or added are allocated.
+     *
+     * @throw std::invalid_argument if field dimensions are incompatible
+     *
+     * @param[in] fields Fields to have in the copy.
+     *
+     * @return the copy
+     */
+    OUSTER_API_FUNCTION
+    LidarScan shallow_copy(const LidarScanFieldTypes& fields) const;
+
+    /**
+     * Copy. Copies into the fields of this scan without allocating when it
+     * has the same dimensions and fields as the other, isn't contiguous and
+     * neither has fields left to decode, e.g. to reuse a scan as a buffer.
      *
      * @param[in] other The lidar scan to copy from.
      */
@@ -389,6 +553,79 @@ class OUSTER_API_CLASS LidarScan {
     OUSTER_API_FUNCTION
     bool has_field(const std::string& name) const;
 
+    /**
+     * Intern a field name for lookups that don't hash it, e.g. in inner loops.
+     * Interning the same name again returns the same handle.
+     *
+     * @param[in] name string key of the field
+     *
+     * @return the handle of the name
+     */
+    OUSTER_API_FUNCTION
+    static FieldHandle field_handle(const std::string& name);
+
+    /**
+     * Get the name of an interned field.
+     *
+     * @throw std::out_of_range if the handle wasn't returned by field_handle
+     *
+     * @param[in] handle the handle of the field
+     *
+     * @return the name the handle was interned from
+     */
+    OUSTER_API_FUNCTION
+    static const std::string& field_name(FieldHandle handle);
+
+    /**
+     * Access a field by its interned name, like field(const std::string&)
+     * without hashing the name.
+     *
+     * NOTE: the first lookup after the map returned by the non-const fields()
+     *       was accessed updates the index of the scan, so it must not race
+     *       with other accesses to the same scan.
+     *
+     * @throw std::out_of_range if the field doesn't exist
+     *
+     * @param[in] handle the handle of the field
+     *
+     * @return Field reference of the requested field
+     */
+    OUSTER_API_FUNCTION
+    Field& field(FieldHandle handle);
+
+    /** @copydoc field(FieldHandle) */
+    OUSTER_API_FUNCTION
+    const Field& field(FieldHandle handle) const;
+
+    /**
+     * Access a field by its interned name as an image.
+     *
+     * @throw std::invalid_argument if T does not match the runtime field type.
+     * @throw std::out_of_range if the field doesn't exist
+     *
+     * @tparam T The type parameter T must match the dynamic type of the field.
+     *
+     * @param[in] handle the handle of the field
+     *
+     * @return a view of the field data.
+     */
+    template <typename T>
+    Eigen::Ref<img_t<T>> field(FieldHandle handle);
+
+    /** @copydoc field(FieldHandle) */
+    template <typename T>
+    Eigen::Ref<const img_t<T>> field(FieldHandle handle) const;
+
+    /**
+     * Check if a field exists by its interned name
+     *
+     * @param[in] handle the handle of the field
+     *
+     * @return true if the lidar scan has the field, else false
+     */
+    OUSTER_API_FUNCTION
+    bool has_field(FieldHandle handle) const;
+
     /**
      * Add a new zero-filled field to lidar scan.
      *
@@ -412,11 +649,13 @@ class OUSTER_API_CLASS LidarScan {
      * @throw std::invalid_argument if key duplicates a preexisting field
      *
      * @param[in] type Descriptor of the field to add.
+     * @param[in] init Whether the field is zero-filled or left uninitialized.
      *
      * @return field The value of the field added.
      */
     OUSTER_API_FUNCTION
-    Field& add_field(const FieldType& type);
+    Field& add_field(const FieldType& type,
+                     FieldInit init = FieldInit::ZEROED);
 
     /**
      * Release the field and remove it from lidar scan
@@ -449,7 +688,60 @@ class OUSTER_API_CLASS LidarScan {
     LidarScanFieldTypes field_types() const;
 
     /**
-     * Reference to the internal fields map
+     * Check whether the scan has exactly the given fields, in any order,
+     * without allocating like comparing field_types() would.
+     *
+     * @param[in] field_types the fields to compare with.
+     * @return true if the scan has these fields and no others.
+     */
+    OUSTER_API_FUNCTION
+    bool has_field_types(const LidarScanFieldTypes& field_types) const;
+
+    /**
+     * Check whether a field is waiting to be decoded on first access. Scans
+     * batched with ScanBatcher::set_deferred_decode keep the packets they were
+     * batched from and decode each channel field the first time it, or the
+     * map of all fields, is accessed.
+     *
+     * NOTE: the first access mutates the scan even through a const reference,
+     *       so it must not race with other accesses to the same scan.
+     *
+     * @param[in] name the string key of the field to query.
+     *
+     * @return true if the field is not decoded yet.
+     */
+    OUSTER_API_FUNCTION
+    bool is_deferred(const std::string& name) const;
+
+    /**
+     * Check whether every field and header of the scan is in the one
+     * allocation of a scan made by make_contiguous.
+     *
+     * @return true if the scan is contiguous.
+     */
+    OUSTER_API_FUNCTION
+    bool is_contiguous() const;
+
+    /**
+     * Get the allocation holding the fields of a contiguous scan, e.g. to copy
+     * it to another process. The layout is only meaningful to a scan with the
+     * same dimensions and fields made by make_contiguous.
+     *
+     * @return the start of the arena, or null if the scan isn't contiguous.
+     */
+    OUSTER_API_FUNCTION
+    const uint8_t* arena_data() const;
+
+    /**
+     * Get the size of the allocation holding the fields of a contiguous scan.
+     *
+     * @return the size in bytes, or 0 if the scan isn't contiguous.
+     */
+    OUSTER_API_FUNCTION
+    size_t arena_size() const;
+
+    /**
+     * Reference to the internal fields map. Decodes every deferred field.
      *
      * @return The unordered map of field type and field.
      */
@@ -562,6 +854,17 @@ class OUSTER_API_CLASS LidarScan {
     OUSTER_API_FUNCTION
     const Field& pose() const;
 
+    /**
+     * Reset the scan for a ScanBatcher to batch a new frame into it, without
+     * touching its fields: zero the column and packet headers, frame_status
+     * and the countdowns and set frame_id to -1. The batcher zeroes the
+     * columns of the fields no packet writes to, so a reset scan batches to
+     * the same result as a new zeroed one, at the cost of clearing a few
+     * kilobytes instead of every field.
+     */
+    OUSTER_API_FUNCTION
+    void clear_headers();
+
     /**
      * Assess completeness of scan.
      * @param[in] window The column window to use for validity assessment
@@ -743,6 +1046,330 @@ LidarScan::Points cartesian(const LidarScan& scan, const XYZLut& lut);
 OUSTER_API_FUNCTION
 LidarScan::Points cartesian(const Eigen::Ref<const img_t<uint32_t>>& range,
                             const XYZLut& lut);
+
+/**
+ * Lookup table of beam directions and offsets in single precision, half the
+ * size of an XYZLut. Points projected with it are within a fraction of a
+ * millimeter of the double precision ones at the ranges of Ouster sensors.
+ */
+struct OUSTER_API_CLASS XYZLutF {
+    Eigen::Array<float, Eigen::Dynamic, 3>
+        direction;  ///< Lookup table of beam directions
+    Eigen::Array<float, Eigen::Dynamic, 3>
+        offset;  ///< Lookup table of beam offsets
+};
+
+/**
+ * Convert lookup tables to single precision.
+ *
+ * @param[in] lut lookup tables generated by make_xyz_lut.
+ *
+ * @return the lookup tables in single precision.
+ */
+OUSTER_API_FUNCTION
+XYZLutF make_xyz_lut_f(const XYZLut& lut);
+
+/**
+ * Single precision version of make_xyz_lut(const sensor::sensor_info&, bool).
+ *
+ * @param[in] sensor metadata returned from the client.
+ * @param[in] use_extrinsics if true, applies the ``sensor.extrinsic`` transform
+ *                           to the resulting "sensor frame" coordinates
+ *
+ * @return xyz direction and offset vectors for each point in the lidar scan.
+ */
+OUSTER_API_FUNCTION
+XYZLutF make_xyz_lut_f(const sensor::sensor_info& sensor, bool use_extrinsics);
+
+/**
+ * Lookup tables of make_xyz_lut(const sensor::sensor_info&, bool) shared by
+ * every caller asking for them with the same intrinsics, resolution and
+ * extrinsics. They are built on the first request and released with the last
+ * reference to them, so that scan sources, viz and user code working on the
+ * same sensor hold a single copy.
+ *
+ * @param[in] sensor metadata returned from the client.
+ * @param[in] use_extrinsics if true, applies the ``sensor.extrinsic`` transform
+ *                           to the resulting "sensor frame" coordinates
+ *
+ * @return xyz direction and offset vectors for each point in the lidar scan.
+ */
+OUSTER_API_FUNCTION
+std::shared_ptr<const XYZLut> shared_xyz_lut(const sensor::sensor_info& sensor,
+                                             bool use_extrinsics);
+
+/**
+ * Single precision version of shared_xyz_lut, shared separately.
+ *
+ * @param[in] sensor metadata returned from the client.
+ * @param[in] use_extrinsics if true, applies the ``sensor.extrinsic`` transform
+ *                           to the resulting "sensor frame" coordinates
+ *
+ * @return xyz direction and offset vectors for each point in the lidar scan.
+ */
+OUSTER_API_FUNCTION
+std::shared_ptr<const XYZLutF> shared_xyz_lut_f(
+    const sensor::sensor_info& sensor, bool use_extrinsics);
+
+/**
+ * Convert LidarScan to Cartesian points in single precision, with the fastest
+ * vectorized kernel the CPU supports.
+ *
+ * @param[in] scan a LidarScan.
+ * @param[in] lut lookup tables generated by make_xyz_lut_f.
+ *
+ * @return Cartesian points where ith row is a 3D point which corresponds
+ *         to ith pixel in LidarScan where i = row * w + col.
+ */
+OUSTER_API_FUNCTION
+Eigen::Array<float, Eigen::Dynamic, 3> cartesian(const LidarScan& scan,
+                                                 const XYZLutF& lut);
+
+/**
+ * Convert a staggered range image to Cartesian points in single precision,
+ * with the fastest vectorized kernel the CPU supports.
+ *
+ * @param[in] range a range image in the same format as the RANGE field of a
+ * LidarScan.
+ * @param[in] lut lookup tables generated by make_xyz_lut_f.
+ *
+ * @return Cartesian points where ith row is a 3D point which corresponds
+ *         to ith pixel in LidarScan where i = row * w + col.
+ */
+OUSTER_API_FUNCTION
+Eigen::Array<float, Eigen::Dynamic, 3> cartesian(
+    const Eigen::Ref<const img_t<uint32_t>>& range, const XYZLutF& lut);
+
+/**
+ * Convert a staggered range image to Cartesian points into a preallocated
+ * array, without allocating. Any strides are accepted, so points may also be
+ * e.g. a map of interleaved xyz triplets.
+ *
+ * @throw std::invalid_argument if the sizes of range, lut and points differ.
+ *
+ * @param[out] points space for a point per pixel, the ith row is the point of
+ * the ith pixel where i = row * w + col.
+ * @param[in] range a range image in the same format as the RANGE field of a
+ * LidarScan.
+ * @param[in] lut lookup tables generated by make_xyz_lut.
+ */
+OUSTER_API_FUNCTION
+void cartesian(Eigen::Ref<LidarScan::Points, 0,
+                          Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>>
+                   points,
+               const Eigen::Ref<const img_t<uint32_t>>& range,
+               const XYZLut& lut);
+
+/**
+ * Convert LidarScan to Cartesian points into a preallocated array, without
+ * allocating.
+ *
+ * @throw std::invalid_argument if the sizes of scan, lut and points differ.
+ *
+ * @param[out] points space for a point per pixel.
+ * @param[in] scan a LidarScan.
+ * @param[in] lut lookup tables generated by make_xyz_lut.
+ */
+OUSTER_API_FUNCTION
+void cartesian(Eigen::Ref<LidarScan::Points, 0,
+                          Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>>
+                   points,
+               const LidarScan& scan, const XYZLut& lut);
+
+/**
+ * Convert a staggered range image to single precision Cartesian points into
+ * a preallocated array, with the fastest vectorized kernel the CPU supports.
+ *
+ * @throw std::invalid_argument if the sizes of range, lut and points differ,
+ * or if the columns of points aren't contiguous.
+ *
+ * @param[out] points space for a point per pixel.
+ * @param[in] range a range image in the same format as the RANGE field of a
+ * LidarScan.
+ * @param[in] lut lookup tables generated by make_xyz_lut_f.
+ */
+OUSTER_API_FUNCTION
+void cartesian(Eigen::Ref<Eigen::Array<float, Eigen::Dynamic, 3>> points,
+               const Eigen::Ref<const img_t<uint32_t>>& range,
+               const XYZLutF& lut);
+
+/**
+ * Convert LidarScan to single precision Cartesian points into a preallocated
+ * array, with the fastest vectorized kernel the CPU supports.
+ *
+ * @throw std::invalid_argument if the sizes of scan, lut and points differ,
+ * or if the columns of points aren't contiguous.
+ *
+ * @param[out] points space for a point per pixel.
+ * @param[in] scan a LidarScan.
+ * @param[in] lut lookup tables generated by make_xyz_lut_f.
+ */
+OUSTER_API_FUNCTION
+void cartesian(Eigen::Ref<Eigen::Array<float, Eigen::Dynamic, 3>> points,
+               const LidarScan& scan, const XYZLutF& lut);
+
+/**
+ * Convert a staggered range image to Cartesian points with x, y and z of each
+ * point next to each other, e.g. straight into the buffer of a point cloud
+ * message.
+ *
+ * @throw std::invalid_argument if the range image and lut sizes differ.
+ *
+ * @param[in] range a range image in the same format as the RANGE field of a
+ * LidarScan.
+ * @param[in] lut lookup tables generated by make_xyz_lut_f.
+ * @param[out] xyz space for 3 * w * h floats, the ith triplet is the point of
+ * the ith pixel where i = row * w + col.
+ */
+OUSTER_API_FUNCTION
+void cartesian_interleaved(const Eigen::Ref<const img_t<uint32_t>>& range,
+                           const XYZLutF& lut, float* xyz);
+
+/**
+ * Convert several scans of the same dimensions to Cartesian points into
+ * consecutive slices of one array, one scan per thread when built with
+ * OpenMP.
+ *
+ * @throw std::invalid_argument if a scan is null or lacks a uint32 RANGE
+ * field, or if the sizes of the scans, lut and points differ.
+ *
+ * @param[out] points space for a point per pixel of every scan, the points of
+ * the ith scan starting at row i * w * h.
+ * @param[in] scans the scans.
+ * @param[in] lut lookup tables generated by make_xyz_lut.
+ */
+OUSTER_API_FUNCTION
+void cartesian(Eigen::Ref<LidarScan::Points, 0,
+                          Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>>
+                   points,
+               const std::vector<const LidarScan*>& scans, const XYZLut& lut);
+
+/**
+ * Convert several scans of the same dimensions to single precision Cartesian
+ * points with x, y and z of each point next to each other, one scan per
+ * thread when built with OpenMP.
+ *
+ * @throw std::invalid_argument if a scan is null or lacks a uint32 RANGE
+ * field, or if the sizes of the scans and lut differ.
+ *
+ * @param[in] scans the scans.
+ * @param[in] lut lookup tables generated by make_xyz_lut_f.
+ * @param[out] xyz space for 3 * w * h floats per scan, those of the ith scan
+ * starting at 3 * w * h * i.
+ */
+OUSTER_API_FUNCTION
+void cartesian_interleaved(const std::vector<const LidarScan*>& scans,
+                           const XYZLutF& lut, float* xyz);
+
+/**
+ * Thresholds used by cartesian_compact to decide which pixels to keep.
+ * Pixels with a zero range are always left out.
+ */
+struct OUSTER_API_CLASS CompactFilter {
+    uint32_t min_range = 0;  ///< smallest range kept, in millimeters
+    uint32_t max_range =
+        std::numeric_limits<uint32_t>::max();  ///< largest range kept
+    uint32_t min_reflectivity =
+        0;  ///< smallest REFLECTIVITY kept, ignored when zero
+};
+
+/**
+ * Convert a staggered range image to Cartesian points, writing only the
+ * points of pixels that pass the filter. Points are written to the first rows
+ * of points in pixel order, and the pixel of each, i = row * w + col, to the
+ * same row of pixel_index.
+ *
+ * @throw std::invalid_argument if the range image and lut sizes differ, if
+ * points or pixel_index have fewer rows than there are pixels, or if
+ * filter.min_reflectivity is set.
+ *
+ * @param[out] points space for a point per pixel.
+ * @param[out] pixel_index space for an index per pixel.
+ * @param[in] range a range image in the same format as the RANGE field of a
+ * LidarScan.
+ * @param[in] lut lookup tables generated by make_xyz_lut.
+ * @param[in] filter range thresholds; use the LidarScan overload to filter
+ * by reflectivity.
+ *
+ * @return the number of points written.
+ */
+OUSTER_API_FUNCTION
+size_t cartesian_compact(Eigen::Ref<LidarScan::Points> points,
+                         Eigen::Ref<Eigen::Array<uint32_t, Eigen::Dynamic, 1>>
+                             pixel_index,
+                         const Eigen::Ref<const img_t<uint32_t>>& range,
+                         const XYZLut& lut, const CompactFilter& filter = {});
+
+/**
+ * Convert LidarScan to Cartesian points, writing only the points of pixels
+ * that pass the filter. See cartesian_compact(Eigen::Ref<LidarScan::Points>,
+ * Eigen::Ref<Eigen::Array<uint32_t, Eigen::Dynamic, 1>>, const
+ * Eigen::Ref<const img_t<uint32_t>>&, const XYZLut&, const CompactFilter&).
+ *
+ * @throw std::invalid_argument if the scan and lut sizes differ, if points or
+ * pixel_index have fewer rows than there are pixels, or if
+ * filter.min_reflectivity is set and the scan lacks an 8 or 16 bit
+ * REFLECTIVITY field.
+ *
+ * @param[out] points space for a point per pixel.
+ * @param[out] pixel_index space for an index per pixel.
+ * @param[in] scan a LidarScan with a RANGE field.
+ * @param[in] lut lookup tables generated by make_xyz_lut.
+ * @param[in] filter range and reflectivity thresholds.
+ *
+ * @return the number of points written.
+ */
+OUSTER_API_FUNCTION
+size_t cartesian_compact(Eigen::Ref<LidarScan::Points> points,
+                         Eigen::Ref<Eigen::Array<uint32_t, Eigen::Dynamic, 1>>
+                             pixel_index,
+                         const LidarScan& scan, const XYZLut& lut,
+                         const CompactFilter& filter = {});
+
+/**
+ * Single precision version of cartesian_compact(Eigen::Ref<LidarScan::Points>,
+ * Eigen::Ref<Eigen::Array<uint32_t, Eigen::Dynamic, 1>>, const
+ * Eigen::Ref<const img_t<uint32_t>>&, const XYZLut&, const CompactFilter&).
+ *
+ * @throw std::invalid_argument as the double precision version.
+ *
+ * @param[out] points space for a point per pixel.
+ * @param[out] pixel_index space for an index per pixel.
+ * @param[in] range a range image in the same format as the RANGE field of a
+ * LidarScan.
+ * @param[in] lut lookup tables generated by make_xyz_lut_f.
+ * @param[in] filter range thresholds.
+ *
+ * @return the number of points written.
+ */
+OUSTER_API_FUNCTION
+size_t cartesian_compact(
+    Eigen::Ref<Eigen::Array<float, Eigen::Dynamic, 3>> points,
+    Eigen::Ref<Eigen::Array<uint32_t, Eigen::Dynamic, 1>> pixel_index,
+    const Eigen::Ref<const img_t<uint32_t>>& range, const XYZLutF& lut,
+    const CompactFilter& filter = {});
+
+/**
+ * Single precision version of cartesian_compact(Eigen::Ref<LidarScan::Points>,
+ * Eigen::Ref<Eigen::Array<uint32_t, Eigen::Dynamic, 1>>, const LidarScan&,
+ * const XYZLut&, const CompactFilter&).
+ *
+ * @throw std::invalid_argument as the double precision version.
+ *
+ * @param[out] points space for a point per pixel.
+ * @param[out] pixel_index space for an index per pixel.
+ * @param[in] scan a LidarScan with a RANGE field.
+ * @param[in] lut lookup tables generated by make_xyz_lut_f.
+ * @param[in] filter range and reflectivity thresholds.
+ *
+ * @return the number of points written.
+ */
+OUSTER_API_FUNCTION
+size_t cartesian_compact(
+    Eigen::Ref<Eigen::Array<float, Eigen::Dynamic, 3>> points,
+    Eigen::Ref<Eigen::Array<uint32_t, Eigen::Dynamic, 1>> pixel_index,
+    const LidarScan& scan, const XYZLutF& lut,
+    const CompactFilter& filter = {});
 /** @}*/
 
 /** \defgroup ouster_client_destagger Ouster Client lidar_scan.h
@@ -787,7 +1414,296 @@ inline img_t<T> stagger(const Eigen::Ref<const img_t<T>>& img,
                         const std::vector<int>& pixel_shift_by_row) {
     return destagger(img, pixel_shift_by_row, true);
 }
+
+/**
+ * Destagger a channel field into a preallocated image, copying each row as
+ * two contiguous segments.
+ *
+ * @tparam T the datatype of the channel field.
+ *
+ * @throw std::invalid_argument if the sizes of img, out and
+ * pixel_shift_by_row don't match.
+ *
+ * @param[out] out space for the destaggered image, not overlapping img.
+ * @param[in] img the channel field.
+ * @param[in] pixel_shift_by_row offsets, usually queried from the sensor.
+ * @param[in] inverse perform the inverse operation.
+ */
+template <typename T>
+inline void destagger_to(Eigen::Ref<img_t<T>> out,
+                         const Eigen::Ref<const img_t<T>>& img,
+                         const std::vector<int>& pixel_shift_by_row,
+                         bool inverse = false);
+
+/**
+ * Stagger a channel field into a preallocated image.
+ *
+ * @tparam T the datatype of the channel field.
+ *
+ * @throw std::invalid_argument if the sizes of img, out and
+ * pixel_shift_by_row don't match.
+ *
+ * @param[out] out space for the staggered image, not overlapping img.
+ * @param[in] img the channel field.
+ * @param[in] pixel_shift_by_row offsets, usually queried from the sensor.
+ */
+template <typename T>
+inline void stagger_to(Eigen::Ref<img_t<T>> out,
+                       const Eigen::Ref<const img_t<T>>& img,
+                       const std::vector<int>& pixel_shift_by_row) {
+    destagger_to<T>(out, img, pixel_shift_by_row, true);
+}
+
+/**
+ * Destagger a channel field in place, without allocating.
+ *
+ * @tparam T the datatype of the channel field.
+ *
+ * @throw std::invalid_argument if the image height does not match
+ * pixel_shift_by_row.
+ *
+ * @param[in,out] img the channel field.
+ * @param[in] pixel_shift_by_row offsets, usually queried from the sensor.
+ * @param[in] inverse perform the inverse operation.
+ */
+template <typename T>
+inline void destagger_in_place(Eigen::Ref<img_t<T>> img,
+                               const std::vector<int>& pixel_shift_by_row,
+                               bool inverse = false);
+
+/**
+ * Stagger a channel field in place, without allocating.
+ *
+ * @tparam T the datatype of the channel field.
+ *
+ * @throw std::invalid_argument if the image height does not match
+ * pixel_shift_by_row.
+ *
+ * @param[in,out] img the channel field.
+ * @param[in] pixel_shift_by_row offsets, usually queried from the sensor.
+ */
+template <typename T>
+inline void stagger_in_place(Eigen::Ref<img_t<T>> img,
+                             const std::vector<int>& pixel_shift_by_row) {
+    destagger_in_place<T>(img, pixel_shift_by_row, true);
+}
+
+/**
+ * Destagger every pixel field of a scan in place, whatever its element type
+ * and extra dimensions, in a single pass over the rows. Column, packet and
+ * scan fields are left alone.
+ *
+ * @throw std::invalid_argument if the scan height does not match
+ * pixel_shift_by_row.
+ *
+ * @param[in,out] scan the scan.
+ * @param[in] pixel_shift_by_row offsets, usually queried from the sensor.
+ * @param[in] inverse perform the inverse operation, staggering the fields.
+ */
+OUSTER_API_FUNCTION
+void destagger_in_place(LidarScan& scan,
+                        const std::vector<int>& pixel_shift_by_row,
+                        bool inverse = false);
+
+/**
+ * Copy a field of several scans of the same dimensions into consecutive
+ * slices of one buffer, e.g. an N x H x W array of a pixel field, one scan
+ * per thread when built with OpenMP.
+ *
+ * @throw std::invalid_argument if scans is empty or holds a null scan, if a
+ * scan lacks the field or its field differs from that of the first scan, or
+ * if pixel_shift_by_row isn't empty and doesn't match the scan height.
+ *
+ * @param[out] out space for scans.size() times the bytes of the field.
+ * @param[in] scans the scans.
+ * @param[in] name the field to copy.
+ * @param[in] pixel_shift_by_row offsets to destagger a pixel field by, empty
+ * to copy it staggered. Other fields are copied as they are.
+ */
+OUSTER_API_FUNCTION
+void stack_field(void* out, const std::vector<const LidarScan*>& scans,
+                 const std::string& name,
+                 const std::vector<int>& pixel_shift_by_row = {});
+
+/**
+ * Replace the values of fields that fall outside of [lower, upper] with
+ * invalid, in place, one field per thread when built with OpenMP.
+ *
+ * @param[in,out] scan the scan.
+ * @param[in] fields names of the fields to clip, empty for all of them. Names
+ * the scan lacks are skipped.
+ * @param[in] lower smallest value kept.
+ * @param[in] upper largest value kept.
+ * @param[in] invalid value written in place of the others, cast to the type
+ * of each field.
+ */
+OUSTER_API_FUNCTION
+void clip_fields(LidarScan& scan, const std::vector<std::string>& fields,
+                 double lower, double upper, double invalid = 0);
+
+/**
+ * Multiply fields by a mask in place, one field per thread when built with
+ * OpenMP. The mask is cast to the type of each field first, so a mask of
+ * zeros and ones zeroes the masked pixels of all of them.
+ *
+ * @throw std::invalid_argument if the mask isn't h x w or if one of the named
+ * fields isn't a pixel field.
+ *
+ * @param[in,out] scan the scan.
+ * @param[in] fields names of the fields to mask, empty for all pixel fields.
+ * Names the scan lacks are skipped.
+ * @param[in] mask staggered h x w mask, applied to every value of a pixel.
+ */
+OUSTER_API_FUNCTION
+void mask_fields(LidarScan& scan, const std::vector<std::string>& fields,
+                 const Eigen::Ref<const img_t<double>>& mask);
+
+/**
+ * Downsample a scan vertically, keeping every factor-th row of its pixel
+ * fields. Headers and the other fields are copied as they are; the sensor
+ * info is left unset since it no longer describes the scan.
+ *
+ * @throw std::invalid_argument if factor isn't a positive divisor of the scan
+ * height.
+ *
+ * @param[in] scan the scan.
+ * @param[in] factor the factor to divide the height by.
+ *
+ * @return the downsampled scan.
+ */
+OUSTER_API_FUNCTION
+LidarScan reduce_by_factor(const LidarScan& scan, int factor);
+
+/**
+ * Reduce the metadata of a sensor to the one describing its scans downsampled
+ * by reduce_by_factor(): the product line, beam count, pixel shifts and beam
+ * angles keep every factor-th beam.
+ *
+ * @throw std::invalid_argument if factor isn't a positive divisor of the
+ * number of beams.
+ *
+ * @param[in] info the metadata of the sensor.
+ * @param[in] factor the factor to divide the number of beams by.
+ *
+ * @return the reduced metadata.
+ */
+OUSTER_API_FUNCTION
+sensor::sensor_info reduce_by_factor(const sensor::sensor_info& info,
+                                     int factor);
 /** @}*/
+
+namespace sensor {
+namespace impl {
+class profile_parser;
+}  // namespace impl
+}  // namespace sensor
+
+/**
+ * Contiguous range of columns of a scan that a ScanBatcher has finished
+ * writing, handed out while the rest of the scan is still being batched. See
+ * ScanBatcher::set_sector_callback.
+ *
+ * The views point into the scan being batched and are only valid until the
+ * batcher is given the next packet.
+ */
+struct OUSTER_API_CLASS ScanSector {
+    const LidarScan* scan;  ///< the scan being batched
+    size_t start_col;       ///< first column of the sector
+    size_t end_col;         ///< one past the last column of the sector
+
+    /// View of the columns of a sector in a staggered field image
+    template <typename T>
+    using img_view_t =
+        Eigen::Map<const img_t<T>, Eigen::Unaligned, Eigen::OuterStride<>>;
+
+    /// View of the columns of a sector in a column header
+    template <typename T>
+    using header_view_t = Eigen::Map<const LidarScan::Header<T>>;
+
+    /**
+     * Get the number of columns in the sector.
+     *
+     * @return the width of the sector.
+     */
+    size_t width() const { return end_col - start_col; }
+
+    /**
+     * Access the sector's columns of a 2D pixel field.
+     *
+     * @tparam T The type parameter T must match the dynamic type of the field.
+     *
+     * @param[in] name the field to view.
+     *
+     * @return an h x width() view of the field data.
+     */
+    template <typename T>
+    img_view_t<T> field(const std::string& name) const {
+        Eigen::Ref<const img_t<T>> img = scan->field<T>(name);
+        return img_view_t<T>(img.data() + start_col, img.rows(), width(),
+                             Eigen::OuterStride<>(img.cols()));
+    }
+
+    /**
+     * Access the measurement timestamps of the sector's columns.
+     *
+     * @return a view of the timestamps.
+     */
+    header_view_t<uint64_t> timestamp() const {
+        return header_view_t<uint64_t>(scan->timestamp().data() + start_col,
+                                       width());
+    }
+
+    /**
+     * Access the measurement ids of the sector's columns.
+     *
+     * @return a view of the measurement ids.
+     */
+    header_view_t<uint16_t> measurement_id() const {
+        return header_view_t<uint16_t>(
+            scan->measurement_id().data() + start_col, width());
+    }
+
+    /**
+     * Access the status of the sector's columns.
+     *
+     * @return a view of the statuses.
+     */
+    header_view_t<uint32_t> status() const {
+        return header_view_t<uint32_t>(scan->status().data() + start_col,
+                                       width());
+    }
+
+    /**
+     * Copy the part of a lookup table covering the sector's columns. Sectors of
+     * the same width start at the same columns in every scan, so the slices
+     * only need to be made once.
+     *
+     * @throw std::invalid_argument if lut doesn't match the scan dimensions.
+     *
+     * @param[in] lut lookup tables of the whole scan from make_xyz_lut.
+     *
+     * @return lookup tables where the ith row corresponds to the ith pixel of
+     *         the sector, with i = row * width() + col - start_col.
+     */
+    OUSTER_API_FUNCTION
+    XYZLut lut(const XYZLut& lut) const;
+};
+
+/**
+ * Convert the ranges of a sector to Cartesian points.
+ *
+ * @throw std::invalid_argument if lut doesn't match the scan dimensions.
+ *
+ * @param[in] sector a sector of a LidarScan.
+ * @param[in] lut lookup tables of the whole scan generated by make_xyz_lut.
+ *
+ * @return Cartesian points where ith row is a 3D point which corresponds
+ *         to the ith pixel of the sector, with
+ *         i = row * sector.width() + col - sector.start_col.
+ */
+OUSTER_API_FUNCTION
+LidarScan::Points cartesian(const ScanSector& sector, const XYZLut& lut);
+
 /**
  * Parse lidar packets into a LidarScan.
  *
@@ -806,15 +1722,47 @@ class OUSTER_API_CLASS ScanBatcher {
     size_t expected_packets;
     size_t batched_packets = 0;
     std::shared_ptr<sensor::sensor_info> sensor_info;
+    // specialized parser for built-in profiles, null for custom ones
+    std::shared_ptr<const sensor::impl::profile_parser> parser;
+    // channel fields of pf with their handles, to look them up in scans
+    // without hashing their names for every column
+    std::vector<std::pair<std::string, FieldHandle>> pf_fields;
+    // streaming of finished columns, disabled without a callback
+    std::function<void(const ScanSector&)> sector_callback;
+    size_t sector_columns = 0;
+    size_t next_sector_col = 0;
+    // format to decode deferred fields with, null to decode while batching
+    std::shared_ptr<const sensor::packet_format> deferred_pf;
+    // columns [region_start, region_end) and beams of the sensor batched into
+    // a compact scan, the whole frame by default
+    size_t region_start = 0;
+    size_t region_end;
+    std::vector<size_t> region_beams;  // empty for every beam
+    size_t region_first_packet = 0;
+    size_t region_packets = 0;
+    // packets of the frame batched so far, only tracked for a region
+    std::vector<uint8_t> seen_packets;
+    size_t seen_count = 0;
+    size_t region_seen_count = 0;
+    // drop packets failing validate_lidar_packets
+    bool validate_packets = false;
+    bool validate_crc = false;
+    std::vector<uint64_t> valid_bits;
 
     void parse_by_col(const uint8_t* packet_buf, LidarScan& ls);
     void parse_by_block(const uint8_t* packet_buf, LidarScan& ls);
+    void parse_region(const uint8_t* packet_buf, LidarScan& ls);
+    bool cropped() const;
 
+    bool batch_packet(const sensor::LidarPacket& packet, LidarScan& ls);
     void cache_packet(const sensor::LidarPacket& packet);
     void batch_cached_packet(LidarScan& ls);
 
     bool check_scan_complete(const LidarScan& ls) const;
     void finalize_scan(LidarScan& ls);
+    void emit_sectors(const LidarScan& ls, size_t done_cols);
+    void start_deferred(LidarScan& ls);
+    void keep_packet(const sensor::LidarPacket& packet, LidarScan& ls);
 
    public:
     sensor::packet_format pf;  ///< The packet format object used for decoding
@@ -886,6 +1834,119 @@ class OUSTER_API_CLASS ScanBatcher {
      */
     OUSTER_API_FUNCTION
     bool operator()(const ouster::sensor::LidarPacket& packet, LidarScan& ls);
+
+    /**
+     * Stream the scan being batched as sectors of a fixed number of columns,
+     * e.g. a multiple of columns_per_packet to get one every few packets or
+     * w / n to split the scan into n azimuth sectors. The callback is called
+     * from operator() with each sector as soon as every column of it has been
+     * written or zeroed, in order, and finishes the remaining sectors when the
+     * scan is complete. The last sector is narrower if columns doesn't divide
+     * w. Columns of sectors already handed out may still be filled in by
+     * packets arriving out of order.
+     *
+     * @throw std::invalid_argument if callback is set and columns is zero.
+     *
+     * @param[in] columns number of columns in each sector.
+     * @param[in] callback called with every sector, or empty to stop
+     * streaming.
+     */
+    OUSTER_API_FUNCTION
+    void set_sector_callback(size_t columns,
+                             std::function<void(const ScanSector&)> callback);
+
+    /**
+     * Defer decoding the channel fields of scans until they are used. The
+     * batcher still fills in the column and packet headers, but keeps a copy
+     * of the packets of each scan and leaves its channel fields to be decoded
+     * on first access, see LidarScan::is_deferred. Decoded fields are kept, so
+     * consumers that only read some fields only pay for those. Takes effect
+     * from the next scan.
+     *
+     * @param[in] enable true to defer decoding, false to decode while batching.
+     */
+    OUSTER_API_FUNCTION
+    void set_deferred_decode(bool enable);
+
+    /**
+     * Drop packets that fail validation instead of batching them, see
+     * sensor::validate_lidar_packets: packets of the wrong size, packets whose
+     * init_id or prod_sn don't match the metadata the batcher was constructed
+     * with and, with check_crc, packets whose CRC doesn't match their contents.
+     * Dropped packets don't count towards completing a scan.
+     *
+     * @param[in] enable true to validate packets before batching them.
+     * @param[in] check_crc true to also check the CRC of profiles that have
+     * one.
+     */
+    OUSTER_API_FUNCTION
+    void set_packet_validation(bool enable, bool check_crc = false);
+
+    /**
+     * Finish the scan being batched without waiting for the rest of its
+     * frame, e.g. the last scan of a recording: zero the columns no packet
+     * wrote to, as for scans cut short by a packet of the next frame. Does
+     * nothing if the scan was already finished or holds no frame.
+     *
+     * @param[in] ls the scan the batcher was filling in.
+     */
+    OUSTER_API_FUNCTION
+    void finish_scan(LidarScan& ls);
+
+    /**
+     * Batch only a region of each frame into compact scans of scan_width()
+     * columns and scan_height() rows, e.g. the columns of a narrow column
+     * window or every other beam, instead of decoding the whole frame and
+     * cropping it afterwards. Column k of a scan holds column start_col + k of
+     * the frame, and measurement_id keeps the frame's column. Row i holds beam
+     * beams[i]. Packet fields hold the packets from start_col /
+     * columns_per_packet on, as many as the scans have rows for. A scan is
+     * complete once every packet overlapping the region has been batched.
+     * RAW_HEADERS is zeroed and deferred decoding is not used while a region is
+     * set. Call it before batching or between scans.
+     *
+     * @throw std::invalid_argument if the columns are empty or out of range, or
+     * a beam is out of range.
+     *
+     * @param[in] start_col first column of the frame to batch.
+     * @param[in] end_col one past the last column of the frame to batch.
+     * @param[in] beams beams to batch in the order of the rows of the scan, or
+     * empty for every beam.
+     */
+    OUSTER_API_FUNCTION
+    void set_region(size_t start_col, size_t end_col,
+                    std::vector<size_t> beams);
+
+    /**
+     * Batch only a region of each frame, keeping one beam every beam_stride,
+     * see set_region(size_t, size_t, std::vector<size_t>).
+     *
+     * @throw std::invalid_argument if the columns are empty or out of range, or
+     * beam_stride is zero.
+     *
+     * @param[in] start_col first column of the frame to batch.
+     * @param[in] end_col one past the last column of the frame to batch.
+     * @param[in] beam_stride keep beams 0, beam_stride, 2 * beam_stride and so
+     * on.
+     */
+    OUSTER_API_FUNCTION
+    void set_region(size_t start_col, size_t end_col, size_t beam_stride = 1);
+
+    /**
+     * Get the number of columns of the scans the batcher fills in.
+     *
+     * @return the width of the region, columns_per_frame by default.
+     */
+    OUSTER_API_FUNCTION
+    size_t scan_width() const;
+
+    /**
+     * Get the number of rows of the scans the batcher fills in.
+     *
+     * @return the number of beams of the region, pixels_per_column by default.
+     */
+    OUSTER_API_FUNCTION
+    size_t scan_height() const;
 };
 
 namespace pose_util {
@@ -959,6 +2020,139 @@ OUSTER_API_FUNCTION
 Points transform(const Eigen::Ref<const Points> points,
                  const Eigen::Ref<const Pose> pose);
 
+/**
+ * Project a range image to points, dewarp them with the pose of their column
+ * and transform them with an extrinsic in a single pass, without temporary
+ * point clouds. Gives the same points as
+ * transform(dewarp(cartesian(range, lut), poses), extrinsic).
+ *
+ * To apply the sensor extrinsic before the poses instead, build the lut with
+ * make_xyz_lut(info, true) and leave extrinsic as identity.
+ *
+ * @throw std::invalid_argument if the sizes of range, lut, poses and
+ * points don't match.
+ *
+ * @param[out] points A matrix with a row for each pixel of the range image.
+ * @param[in] range a range image in the same format as the RANGE field of a
+ * LidarScan.
+ * @param[in] lut lookup tables generated by make_xyz_lut.
+ * @param[in] poses A matrix of shape (W, 16) representing W 4x4 pose matrices
+ * of the columns, e.g. LidarScan::pose(). Each row is a flattened 4x4 pose
+ * matrix.
+ * @param[in] extrinsic transform applied after the poses.
+ * @param[in] compact if true, leave out pixels with a zero range and write the
+ * remaining points to the first rows in pixel order.
+ *
+ * @return the number of points written, the number of pixels unless compact.
+ */
+OUSTER_API_FUNCTION
+size_t cartesian_dewarp(Eigen::Ref<Points> points,
+                        const Eigen::Ref<const img_t<uint32_t>>& range,
+                        const XYZLut& lut, const Eigen::Ref<const Poses> poses,
+                        const mat4d& extrinsic, bool compact = false);
+
+/**
+ * Project a scan to points dewarped by its per column poses and transformed
+ * by an extrinsic, in a single pass. See cartesian_dewarp(Eigen::Ref<Points>,
+ * const Eigen::Ref<const img_t<uint32_t>>&, const XYZLut&, const
+ * Eigen::Ref<const Poses>, const mat4d&, bool).
+ *
+ * @throw std::invalid_argument if the sizes of the scan and lut don't match.
+ *
+ * @param[in] scan a LidarScan with a RANGE field.
+ * @param[in] lut lookup tables generated by make_xyz_lut.
+ * @param[in] extrinsic transform applied after the poses.
+ * @param[in] compact if true, leave out pixels with a zero range.
+ *
+ * @return the points, one per pixel in pixel order, or one per pixel with a
+ * nonzero range if compact.
+ */
+OUSTER_API_FUNCTION
+Points cartesian_dewarp(const LidarScan& scan, const XYZLut& lut,
+                        const mat4d& extrinsic = mat4d::Identity(),
+                        bool compact = false);
+
+/**
+ * Interpolates the poses of a trajectory at any timestamps from knot poses,
+ * on the SE(3) manifold: the pose at a timestamp between two knots is
+ * p0 * exp(t * log(inv(p0) * p1)), where t is the ratio of the timestamp
+ * between the two knot timestamps. Timestamps before the first or after the
+ * last knot extrapolate the first or last segment.
+ *
+ * The logarithms of the segments are computed once on construction.
+ */
+class OUSTER_API_CLASS TrajectoryEvaluator {
+   public:
+    /**
+     * @throw std::invalid_argument if there are less than two knots, if the
+     * sizes of timestamps and poses don't match or if the timestamps aren't
+     * increasing.
+     *
+     * @param[in] timestamps The increasing timestamps of the knots.
+     * @param[in] poses A matrix of shape (N, 16) of the knot poses. Each row is
+     * a flattened 4x4 pose matrix.
+     */
+    OUSTER_API_FUNCTION
+    TrajectoryEvaluator(std::vector<double> timestamps,
+                        const Eigen::Ref<const Poses> poses);
+
+    /**
+     * Interpolate the poses at timestamps. Sorted timestamps, e.g. the column
+     * timestamps of a scan, find their segments in amortized constant time.
+     *
+     * @throw std::invalid_argument if poses has fewer rows than ts.
+     *
+     * @param[out] poses A matrix with a row for each timestamp to write the
+     * flattened 4x4 poses to.
+     * @param[in] ts The timestamps, in the units of the knot timestamps.
+     */
+    OUSTER_API_FUNCTION
+    void poses_at(Eigen::Ref<Poses> poses,
+                  const Eigen::Ref<const Eigen::ArrayXd> ts) const;
+
+    /**
+     * Interpolate the poses at timestamps, see poses_at(Eigen::Ref<Poses>,
+     * const Eigen::Ref<const Eigen::ArrayXd>) const.
+     *
+     * @param[in] ts The timestamps, in the units of the knot timestamps.
+     *
+     * @return A matrix of shape (N, 16) with the flattened pose of every
+     * timestamp.
+     */
+    OUSTER_API_FUNCTION
+    Poses poses_at(const Eigen::Ref<const Eigen::ArrayXd> ts) const;
+
+    /**
+     * Write the poses at the timestamps of the valid columns of a scan, i.e.
+     * with the first bit of status set, to LidarScan::pose(). The poses of
+     * the other columns are left unchanged.
+     *
+     * @throw std::invalid_argument if col_ts isn't empty and doesn't hold a
+     * timestamp for every column.
+     *
+     * @param[in,out] scan The scan.
+     * @param[in] col_ts Timestamps to use for the columns instead of
+     * LidarScan::timestamp(), e.g. remapped to the time scale of the knots.
+     */
+    OUSTER_API_FUNCTION
+    void pose_scan(LidarScan& scan,
+                   const Eigen::Ref<const Eigen::ArrayXd> col_ts =
+                       Eigen::ArrayXd()) const;
+
+    /**
+     * @return The timestamps of the knots.
+     */
+    OUSTER_API_FUNCTION
+    const std::vector<double>& timestamps() const;
+
+   private:
+    std::vector<double> timestamps_;
+    Poses knots_;
+    // log(inv(knot[i]) * knot[i + 1]) of every segment as (rotation,
+    // translation)
+    Eigen::Matrix<double, Eigen::Dynamic, 6, Eigen::RowMajor> deltas_;
+};
+
 }  // namespace pose_util
 }  // namespace ouster
 
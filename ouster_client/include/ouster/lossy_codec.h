@@ -0,0 +1,64 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Error bounded lossy encoding of range images
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ouster/types.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+/// Largest error of the fields to encode lossily, by field name, in the
+/// units of the fields, e.g. mm for RANGE
+using LossyFields = std::map<std::string, uint32_t>;
+
+/// Encode an image of unsigned integers with every pixel off by at most
+/// max_error, e.g. a range image for a link too slow for lossless encoding.
+///
+/// Pixels are quantized to multiples of 2 * max_error + 1, except that zero
+/// pixels, i.e. missing returns, stay zero and nonzero ones stay nonzero.
+/// Rows of a range image are the measurements of a beam, so each row is
+/// predicted from its previous pixels, by the last nonzero pixel or by
+/// extrapolating the last two, whichever predicts the row better. The
+/// residuals are entropy coded with a static rANS coder over their bit
+/// lengths, followed by their low bits verbatim. The zero pixels are coded
+/// as runs. A max_error of 0 encodes the image losslessly.
+///
+/// The buffer starts with the magic "OSLQ", see is_lossy_buffer(). Decoding
+/// is a single pass over the image.
+///
+/// @return the encoded image
+template <typename T>
+OUSTER_API_FUNCTION std::vector<uint8_t> encode_lossy(
+    const Eigen::Ref<const img_t<T>>& img,  ///< [in] image to encode
+    uint32_t max_error                      ///< [in] largest error of a pixel
+);
+
+/// Decode an image encoded by encode_lossy() into an image of its shape
+/// @throw invalid_argument if the buffer isn't an encoded image of the shape
+///        and pixel type of img, or is truncated or corrupt
+template <typename T>
+OUSTER_API_FUNCTION void decode_lossy(
+    const uint8_t* data,      ///< [in] encoded image
+    size_t size,              ///< [in] bytes at data
+    Eigen::Ref<img_t<T>> img  ///< [out] decoded image
+);
+
+/// @return true if the bytes start like an image encoded by encode_lossy()
+OUSTER_API_FUNCTION bool is_lossy_buffer(
+    const uint8_t* data,  ///< [in] encoded image
+    size_t size           ///< [in] bytes at data
+);
+
+}  // namespace ouster
@@ -0,0 +1,150 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Localization of scans against a memory mapped reference map
+ */
+
+#pragma once
+
+#include <Eigen/Core>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/types.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+struct voxel_map_index_impl;
+
+/// A reference map whose points are hashed by voxel into a file, memory
+/// mapped read only so that a map is shared by processes and only the pages
+/// of the regions visited are read from disk.
+class OUSTER_API_CLASS VoxelMapIndex {
+   public:
+    /// Build the index of the points of a map and write it to a file.
+    ///
+    /// @throw invalid_argument if the voxel size isn't positive
+    /// @throw runtime_error if writing the file fails
+    OUSTER_API_FUNCTION static void build(
+        const std::string& filename,  ///< [in] the file to write
+        const Eigen::Ref<const pose_util::Points>& points,  ///< [in] (N, 3)
+        double voxel_size);  ///< [in] side of the voxels, typically the
+                             ///< largest distance of correspondences
+
+    /// Memory map an index file.
+    ///
+    /// @throw runtime_error if the file can't be mapped or isn't an index
+    OUSTER_API_FUNCTION explicit VoxelMapIndex(const std::string& filename);
+
+    OUSTER_API_FUNCTION ~VoxelMapIndex();
+
+    VoxelMapIndex(const VoxelMapIndex&) = delete;
+    VoxelMapIndex& operator=(const VoxelMapIndex&) = delete;
+
+    /// Find the nearest map point of every query point within a distance,
+    /// searching the voxels around the query point in parallel when built
+    /// with OpenMP.
+    ///
+    /// @throw invalid_argument if the outputs don't have a row per query
+    OUSTER_API_FUNCTION void nearest(
+        const Eigen::Ref<const pose_util::Points>& queries,  ///< [in] (N, 3)
+        double max_distance,  ///< [in] farthest neighbor searched
+        Eigen::Ref<pose_util::Points> neighbors,  ///< [out] (N, 3) nearest
+                                                  ///< points
+        Eigen::Ref<Eigen::ArrayXd> distances)
+        const;  ///< [out] (N,) distances, infinity without a neighbor
+
+    /// @return the side of the voxels
+    OUSTER_API_FUNCTION double voxel_size() const;
+
+    /// @return the number of points of the map
+    OUSTER_API_FUNCTION size_t size() const;
+
+   private:
+    std::unique_ptr<voxel_map_index_impl> impl;
+};
+
+/// Parameters of MapLocalizer
+struct OUSTER_API_CLASS MapLocalizerConfig {
+    /// largest distance of a point to its correspondence in the map, in the
+    /// units of the map
+    double max_correspondence_distance = 1.0;
+    /// scale of the Geman-McClure kernel weighting the correspondences
+    double kernel_scale = 0.3;
+    /// most Gauss-Newton iterations per scan
+    int max_iterations = 30;
+    /// stop once the norm of an update is below this
+    double convergence = 1e-4;
+    /// voxel size downsampling the scan points before registration, 0 to
+    /// register every point
+    double voxel_size = 0;
+};
+
+/// Tracks the pose of a sensor in a prebuilt map by registering every scan to
+/// a VoxelMapIndex with point to point ICP, starting from a motion prior: the
+/// last relative motion by default, or a relative motion given by the caller,
+/// e.g. from an ImuPreintegrator. Points can be deskewed with the same motion
+/// prior.
+class OUSTER_API_CLASS MapLocalizer {
+   public:
+    /// @throw invalid_argument if index is null
+    OUSTER_API_FUNCTION MapLocalizer(
+        std::shared_ptr<const VoxelMapIndex> index,  ///< [in] the map
+        const mat4d& initial_pose = mat4d::Identity(),  ///< [in] pose of the
+                                                        ///< first scan guess
+        const MapLocalizerConfig& config = {});  ///< [in] parameters
+
+    /// Register points predicted with the last relative motion.
+    ///
+    /// @return the registered pose, see update(const
+    /// Eigen::Ref<const pose_util::Points>&, const
+    /// Eigen::Ref<const Eigen::ArrayXd>&, const mat4d&)
+    OUSTER_API_FUNCTION mat4d
+    update(const Eigen::Ref<const pose_util::Points>& points,
+           const Eigen::Ref<const Eigen::ArrayXd>& times);
+
+    /// Register points predicted with a relative motion since the last scan.
+    ///
+    /// Points at a time t are first moved by the fraction t - 0.5 of the
+    /// motion, deskewing them to the middle of the scan as KISS-ICP does.
+    ///
+    /// @throw invalid_argument if times isn't empty and doesn't have a time
+    /// per point
+    ///
+    /// @return the registered pose of the middle of the scan
+    OUSTER_API_FUNCTION mat4d
+    update(const Eigen::Ref<const pose_util::Points>&
+               points,  ///< [in] (N, 3) in the sensor frame
+           const Eigen::Ref<const Eigen::ArrayXd>&
+               times,  ///< [in] normalized time in the scan of every point
+                       ///< from 0 to 1, or empty to skip deskewing
+           const mat4d& motion);  ///< [in] relative motion since the last
+                                  ///< pose
+
+    /// @return the last registered pose
+    OUSTER_API_FUNCTION const mat4d& pose() const;
+
+    /// Set the pose, e.g. to relocalize, and forget the last motion.
+    OUSTER_API_FUNCTION void set_pose(const mat4d& pose);
+
+    /// @return the relative motion between the last two poses
+    OUSTER_API_FUNCTION const mat4d& last_motion() const;
+
+    /// @return the number of correspondences of the last registration
+    OUSTER_API_FUNCTION size_t last_correspondences() const;
+
+   private:
+    std::shared_ptr<const VoxelMapIndex> index_;
+    MapLocalizerConfig config_;
+    mat4d pose_;
+    mat4d motion_;
+    size_t correspondences_;
+};
+
+}  // namespace ouster
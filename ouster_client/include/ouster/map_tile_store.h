@@ -0,0 +1,136 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Tiled out of core storage of large point cloud maps
+ */
+
+#pragma once
+
+#include <Eigen/Core>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+/// Integer coordinates of a tile, the point p is in the tile
+/// floor(p / tile_size)
+struct OUSTER_API_CLASS TileKey {
+    int32_t x;  ///< x coordinate
+    int32_t y;  ///< y coordinate
+    int32_t z;  ///< z coordinate
+
+    /// @return true if both keys are the same tile
+    bool operator==(const TileKey& other) const {
+        return x == other.x && y == other.y && z == other.z;
+    }
+};
+
+struct map_tile_store_impl;
+
+/// Stores a point cloud map in cubic tiles of a chunked file, so that maps
+/// larger than memory can be accumulated and read back by region.
+///
+/// Appended points are voxel downsampled into the tiles, keeping the first
+/// point of each voxel. At most max_tiles tiles are held in memory: the least
+/// recently used tile is written to the end of the file as a chunk when
+/// another one is needed, and read back when points are appended to it again.
+/// Every chunk holds a pyramid of levels of detail, level k downsampling level
+/// k - 1 with voxels twice as large, so that large regions can be read at a
+/// coarse level without reading every point.
+///
+/// The file is valid after each flush(): chunks are only appended, and the
+/// index of the latest chunk of every tile is written after them. Chunks
+/// superseded by a later one are left in place.
+class OUSTER_API_CLASS MapTileStore {
+   public:
+    /// Create a new store, truncating the file.
+    ///
+    /// @throw invalid_argument if the sizes aren't positive, a tile has more
+    /// than 2^20 voxels on a side or levels isn't positive
+    /// @throw runtime_error if the file can't be opened for writing
+    OUSTER_API_FUNCTION MapTileStore(
+        const std::string& filename,  ///< [in] the file to write
+        double tile_size,   ///< [in] side of the tiles, in the units of the
+                            ///< points
+        double voxel_size,  ///< [in] side of the voxels of level 0
+        int levels = 4,     ///< [in] number of levels of detail
+        size_t max_tiles = 256);  ///< [in] most tiles held in memory
+
+    /// Open an existing store, to read it or append to it.
+    ///
+    /// @throw runtime_error if the file can't be opened or isn't a store
+    OUSTER_API_FUNCTION explicit MapTileStore(
+        const std::string& filename,  ///< [in] the file to open
+        size_t max_tiles = 256);      ///< [in] most tiles held in memory
+
+    /// Flush the store, see flush()
+    OUSTER_API_FUNCTION ~MapTileStore();
+
+    MapTileStore(const MapTileStore&) = delete;
+    MapTileStore& operator=(const MapTileStore&) = delete;
+
+    /// Add points to the map, leaving out non finite points and the points of
+    /// voxels already occupied.
+    ///
+    /// @throw runtime_error if reading or writing a tile fails
+    OUSTER_API_FUNCTION void append(
+        const Eigen::Ref<const pose_util::Points>& points);  ///< [in] (N, 3)
+
+    /// Write the tiles modified since they were last written and the index,
+    /// making the file a valid store of every point appended so far.
+    ///
+    /// @throw runtime_error if writing fails
+    OUSTER_API_FUNCTION void flush();
+
+    /// @return the keys of every tile of the map, in no particular order
+    OUSTER_API_FUNCTION std::vector<TileKey> tiles() const;
+
+    /// @return the keys of the tiles intersecting an axis aligned box
+    OUSTER_API_FUNCTION std::vector<TileKey> tiles_in(
+        const Eigen::Vector3d& min,  ///< [in] lower corner of the box
+        const Eigen::Vector3d& max) const;  ///< [in] upper corner of the box
+
+    /// @return the points of a tile at a level of detail, none if the tile is
+    /// empty
+    ///
+    /// @throw invalid_argument if the level is out of range
+    /// @throw runtime_error if reading the tile fails
+    OUSTER_API_FUNCTION pose_util::Points tile_points(const TileKey& key,
+                                                      int level = 0);
+
+    /// @return the points of the tiles intersecting an axis aligned box at a
+    /// level of detail, including the points of these tiles out of the box.
+    /// Tiles not in memory are read at that level only, without caching them.
+    ///
+    /// @throw invalid_argument if the level is out of range
+    /// @throw runtime_error if reading a tile fails
+    OUSTER_API_FUNCTION pose_util::Points query(
+        const Eigen::Vector3d& min,  ///< [in] lower corner of the box
+        const Eigen::Vector3d& max,  ///< [in] upper corner of the box
+        int level = 0);              ///< [in] level of detail
+
+    /// @return the side of the tiles
+    OUSTER_API_FUNCTION double tile_size() const;
+
+    /// @return the side of the voxels of level 0
+    OUSTER_API_FUNCTION double voxel_size() const;
+
+    /// @return the number of levels of detail
+    OUSTER_API_FUNCTION int levels() const;
+
+    /// @return the number of tiles held in memory
+    OUSTER_API_FUNCTION size_t tiles_in_memory() const;
+
+   private:
+    std::unique_ptr<map_tile_store_impl> impl;
+};
+
+}  // namespace ouster
@@ -0,0 +1,134 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Pluggable memory for large, long lived scan buffers
+ *
+ * Buffers of many sensors can span gigabytes, where TLB misses and memory on
+ * the wrong NUMA node show up in profiles. A MemoryResource decides where the
+ * arenas of contiguous LidarScans, and so all of their fields, are placed.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+/// Source of memory blocks for scan arenas. Blocks are aligned to at least
+/// 64 bytes. Implementations must be thread-safe.
+class OUSTER_API_CLASS MemoryResource {
+   public:
+    OUSTER_API_FUNCTION
+    virtual ~MemoryResource();
+
+    /// Allocate a block
+    /// @throw std::bad_alloc if no memory is left
+    /// @return the block, aligned to at least 64 bytes
+    virtual void* allocate(size_t bytes  ///< [in] size of the block
+                           ) = 0;
+
+    /// Free a block returned by allocate()
+    virtual void deallocate(void* ptr,    ///< [in] the block
+                            size_t bytes  ///< [in] size it was allocated with
+                            ) = 0;
+};
+
+/// Get the resource allocating from the heap, the default
+/// @return the process wide heap resource
+OUSTER_API_FUNCTION
+std::shared_ptr<MemoryResource> heap_memory();
+
+/// How HugePageMemory gets its huge pages
+enum class HugePageMode {
+    /// Map regular pages and madvise(MADV_HUGEPAGE) them, letting the kernel
+    /// back them with transparent huge pages when it can
+    TRANSPARENT,
+    /// Map pages from the pool reserved in /proc/sys/vm/nr_hugepages, as
+    /// hugetlbfs does, falling back to TRANSPARENT when the pool is empty
+    RESERVED
+};
+
+/// Allocates whole huge pages, so that scans of many megabytes cost a few
+/// TLB entries rather than thousands. Blocks are rounded up to the huge page
+/// size. On platforms other than Linux, allocates from the heap.
+class OUSTER_API_CLASS HugePageMemory : public MemoryResource {
+   public:
+    /// Construct the resource
+    OUSTER_API_FUNCTION
+    explicit HugePageMemory(
+        HugePageMode mode = HugePageMode::TRANSPARENT,  ///< [in] page source
+        size_t huge_page_size = 2 << 20  ///< [in] huge page size in bytes
+    );
+
+    OUSTER_API_FUNCTION
+    void* allocate(size_t bytes) override;
+
+    OUSTER_API_FUNCTION
+    void deallocate(void* ptr, size_t bytes) override;
+
+    /// Get the number of blocks not placed as requested: RESERVED blocks
+    /// taken from transparent huge pages, or blocks the kernel refused to
+    /// back with huge pages at all
+    /// @return the number of fallbacks
+    OUSTER_API_FUNCTION
+    size_t fallbacks() const;
+
+   private:
+    HugePageMode mode_;
+    size_t huge_page_size_;
+    std::atomic<size_t> fallbacks_{0};
+};
+
+/// Allocates on one NUMA node, by default the node of the CPU the allocating
+/// thread runs on. Allocated from a thread pinned with
+/// ReceiveThreadOptions::cpu_affinity, e.g. by the ScanPool of a
+/// SensorScanSource, scans stay on the memory of the socket batching them.
+/// On platforms other than Linux, allocates from the heap.
+class OUSTER_API_CLASS NumaLocalMemory : public MemoryResource {
+   public:
+    /// Construct the resource
+    OUSTER_API_FUNCTION
+    explicit NumaLocalMemory(
+        int node = -1,           ///< [in] node to allocate on, negative for
+                                 ///< the node of the allocating thread
+        bool huge_pages = false  ///< [in] also madvise(MADV_HUGEPAGE) blocks
+    );
+
+    OUSTER_API_FUNCTION
+    void* allocate(size_t bytes) override;
+
+    OUSTER_API_FUNCTION
+    void deallocate(void* ptr, size_t bytes) override;
+
+    /// Get the number of blocks that couldn't be bound to their node, e.g.
+    /// on kernels built without NUMA support
+    /// @return the number of fallbacks
+    OUSTER_API_FUNCTION
+    size_t fallbacks() const;
+
+   private:
+    int node_;
+    bool huge_pages_;
+    std::atomic<size_t> fallbacks_{0};
+};
+
+/// Get the NUMA node of the CPU the calling thread runs on
+/// @return the node, or 0 where unknown
+OUSTER_API_FUNCTION
+int current_numa_node();
+
+/// Adapt a resource to allocate the arenas of LidarScan::make_contiguous
+/// @return the allocator, keeping the resource alive with its blocks
+OUSTER_API_FUNCTION
+LidarScan::ArenaAllocator arena_allocator(
+    std::shared_ptr<MemoryResource> memory  ///< [in] resource to allocate from
+);
+
+}  // namespace ouster
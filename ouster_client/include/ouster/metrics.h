@@ -0,0 +1,139 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Export of pipeline health metrics in the OpenMetrics text format
+ *
+ * Ingest processes build an OpenMetrics exposition from the stats of their
+ * sources and writers on every scrape, and serve it over HTTP for
+ * Prometheus or any OpenMetrics compatible collector to scrape.
+ */
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ouster/latency_histogram.h"
+#include "ouster/packet_stream_analyzer.h"
+#include "ouster/pipeline.h"
+#include "ouster/sensor_client.h"
+#include "ouster/sensor_scan_source.h"
+#include "ouster/types.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace sensor {
+
+/// Labels of a metric sample, as name and value pairs
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+/// Builds an exposition in the OpenMetrics text format. Samples of the same
+/// metric are grouped under one metric family, whatever order they are added
+/// in.
+class OUSTER_API_CLASS OpenMetrics {
+   public:
+    /// HTTP content type to serve the exposition with
+    static constexpr const char* content_type =
+        "application/openmetrics-text; version=1.0.0; charset=utf-8";
+
+    /// Add a sample of a counter, exposed as name_total
+    ///
+    /// @throw std::invalid_argument if the name is invalid or already used
+    /// by a metric of another type
+    OUSTER_API_FUNCTION
+    void counter(const std::string& name,  ///< [in] metric name
+                 const std::string& help,  ///< [in] description of the metric
+                 double value,             ///< [in] value of the sample
+                 const MetricLabels& labels = {}  ///< [in] sample labels
+    );
+
+    /// Add a sample of a gauge
+    ///
+    /// @throw std::invalid_argument if the name is invalid or already used
+    /// by a metric of another type
+    OUSTER_API_FUNCTION
+    void gauge(const std::string& name,  ///< [in] metric name
+               const std::string& help,  ///< [in] description of the metric
+               double value,             ///< [in] value of the sample
+               const MetricLabels& labels = {}  ///< [in] sample labels
+    );
+
+    /// Add a latency summary, with its quantiles in seconds
+    ///
+    /// @throw std::invalid_argument if the name is invalid or already used
+    /// by a metric of another type
+    OUSTER_API_FUNCTION
+    void summary(const std::string& name,  ///< [in] metric name
+                 const std::string& help,  ///< [in] description of the metric
+                 const LatencyStats& stats,  ///< [in] latencies to expose
+                 const MetricLabels& labels = {}  ///< [in] sample labels
+    );
+
+    /// Get the exposition
+    /// @return the OpenMetrics text, terminated by "# EOF"
+    OUSTER_API_FUNCTION
+    std::string str() const;
+
+   private:
+    struct Family {
+        std::string name;
+        std::string type;
+        std::string help;
+        std::vector<std::string> samples;
+    };
+
+    Family& family(const std::string& name, const char* type,
+                   const std::string& help);
+
+    std::vector<Family> families_;
+};
+
+/// Add the health metrics of a SensorScanSource: per sensor packet and scan
+/// rates, incomplete scans and missing frames, id errors, dropped packets and
+/// scans, buffer and queue occupancy, and the stage latencies when latency
+/// stats are enabled. Per sensor samples are labeled with the serial number
+/// of the sensor, per client samples with the index of the client.
+OUSTER_API_FUNCTION
+void add_metrics(
+    OpenMetrics& metrics,           ///< [in,out] exposition to add to
+    const ScanSourceStats& stats,   ///< [in] stats of the source
+    const std::vector<sensor_info>& infos,  ///< [in] sensors of the source
+    const MetricLabels& labels = {}  ///< [in] labels of every sample, e.g.
+                                     ///< to tell sources apart
+);
+
+/// Add the health metrics of a SensorClient: dropped packets, buffer
+/// occupancy and, when latency stats are enabled, the delivery latency
+OUSTER_API_FUNCTION
+void add_metrics(OpenMetrics& metrics,        ///< [in,out] exposition to add to
+                 const ClientStats& stats,    ///< [in] stats of the client
+                 const MetricLabels& labels = {}  ///< [in] labels of every
+                                                  ///< sample
+);
+
+/// Add the stream health metrics of a PacketStreamAnalyzer: lost frames and
+/// columns, late, reordered and duplicate data, column timestamp
+/// regressions, packet rates and the jitter of lidar and IMU packets
+OUSTER_API_FUNCTION
+void add_metrics(OpenMetrics& metrics,  ///< [in,out] exposition to add to
+                 const PacketStreamStats& stats,  ///< [in] stats of the
+                                                  ///< analyzer
+                 const MetricLabels& labels = {}  ///< [in] labels of every
+                                                  ///< sample, e.g. the sensor
+);
+
+/// Add the metrics of the stages of a Pipeline, labelled by stage: items in,
+/// out and dropped, stalls, queue depths, busy time and latencies
+OUSTER_API_FUNCTION
+void add_metrics(OpenMetrics& metrics,  ///< [in,out] exposition to add to
+                 const std::vector<StageStats>& stats,  ///< [in] stats of
+                                                        ///< the stages
+                 const MetricLabels& labels = {}  ///< [in] labels of every
+                                                  ///< sample
+);
+
+}  // namespace sensor
+}  // namespace ouster
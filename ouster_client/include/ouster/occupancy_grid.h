@@ -0,0 +1,123 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Ego-centric occupancy grids and height maps from range images
+ */
+
+#pragma once
+
+#include <Eigen/Core>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/types.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+/// What is known of a cell of an OccupancyGrid
+enum class CellState : uint8_t {
+    UNKNOWN = 0,  ///< no ray crossed or ended in the cell
+    FREE = 1,     ///< rays crossed the cell, no obstacle was seen in it
+    OCCUPIED = 2  ///< obstacles were seen in the cell
+};
+
+/// Extent, resolution and height band of an OccupancyGrid. The grid lies in
+/// the xy plane of the frame of the extrinsics, e.g. of the vehicle, centered
+/// on its origin, with z = 0 at the ground. Row i and column j of the grid
+/// cover y in [(i - rows / 2) * resolution, (i + 1 - rows / 2) * resolution)
+/// and x in [(j - cols / 2) * resolution, (j + 1 - cols / 2) * resolution).
+struct OUSTER_API_CLASS GridLayout {
+    size_t rows{200};         ///< cells along y
+    size_t cols{200};         ///< cells along x
+    double resolution{0.2};   ///< side of a cell, in the units of the luts
+    double min_z{0.3};        ///< points below are ground, crossed by rays
+    double max_z{2.0};        ///< points above are overhangs, left out
+    uint16_t min_hits{1};     ///< points in a cell marking it occupied
+};
+
+/// An occupancy grid and height map, each an image of rows x cols cells
+struct OUSTER_API_CLASS OccupancyGrid {
+    /// the CellState of every cell
+    img_t<uint8_t> state;
+    /// the highest point at or below max_z in every cell, NaN if none
+    img_t<float> height;
+    /// the number of points between min_z and max_z in every cell
+    img_t<uint16_t> hits;
+    /// the number of column rays crossing every cell
+    img_t<uint16_t> free;
+    /// the number of builds before the one that filled this grid
+    uint64_t frame = 0;
+};
+
+/// Builds an OccupancyGrid and height map from one scan per sensor, directly
+/// from the RANGE field and the lut of each sensor instead of ray casting the
+/// points of their clouds.
+///
+/// Every pixel with a range between min_z and max_z is a hit on its cell. As
+/// the beams of a column share an azimuth, free space is marched once per
+/// column rather than once per pixel: from the origin of the beams to the
+/// nearest hit of the column, or to its farthest ground return if it has no
+/// hit. Cells with at least min_hits hits are occupied, cells crossed by a
+/// ray otherwise free, whichever sensor saw them.
+///
+/// The extrinsics are folded into planar copies of the luts once, so that
+/// the points and cells of a scan are computed by vectorized array
+/// expressions. Scans are processed on a thread per sensor and the grid is
+/// refilled in place, allocating only on construction.
+class OUSTER_API_CLASS OccupancyGridBuilder {
+   public:
+    /// @throw invalid_argument if luts is empty, extrinsics isn't empty and
+    /// doesn't have one per lut, the grid is empty, its resolution isn't
+    /// positive or min_z is above max_z
+    OUSTER_API_FUNCTION explicit OccupancyGridBuilder(
+        std::vector<XYZLut> luts,  ///< [in] lookup tables of each sensor,
+                                   ///< generated by make_xyz_lut
+        std::vector<mat4d> extrinsics = {},  ///< [in] transforms of each
+                                             ///< sensor to the grid frame,
+                                             ///< applied after the luts
+        const GridLayout& layout = {});      ///< [in] extent of the grid
+
+    /// Refill the grid with a frame of scans. Missing scans add nothing.
+    ///
+    /// @throw invalid_argument if there isn't a scan, possibly null, per
+    /// sensor, or a scan doesn't match its lut or has no RANGE field
+    ///
+    /// @return the grid, overwritten by the next build
+    OUSTER_API_FUNCTION const OccupancyGrid& build(
+        const std::vector<const LidarScan*>& scans);  ///< [in] scans of each
+                                                      ///< sensor, or null
+
+    /// @return the grid of the last build
+    OUSTER_API_FUNCTION const OccupancyGrid& latest() const;
+
+    /// @return the extent of the grid
+    OUSTER_API_FUNCTION const GridLayout& layout() const;
+
+    /// @return the number of sensors
+    OUSTER_API_FUNCTION size_t sensors_count() const;
+
+   private:
+    // per sensor lut and scratch, reused across builds
+    struct Sensor {
+        Eigen::ArrayXd dx, dy, dz, ox, oy, oz;
+        Eigen::ArrayXd x, y, z;
+        Eigen::ArrayXi cell;
+        img_t<float> height;
+        img_t<uint16_t> hits;
+        img_t<uint16_t> free;
+    };
+
+    void fill(Sensor& sensor, const LidarScan& scan) const;
+
+    GridLayout layout_;
+    std::vector<Sensor> sensors_;
+    OccupancyGrid grid_;
+    uint64_t frames_ = 0;
+};
+
+}  // namespace ouster
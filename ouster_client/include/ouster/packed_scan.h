@@ -0,0 +1,127 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Scans stored at the bit widths of their lidar packets
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "ouster/field.h"
+#include "ouster/lidar_scan.h"
+#include "ouster/types.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+/// Compact copy of a LidarScan for keeping many scans in memory, e.g. the
+/// scan history of a tracker.
+///
+/// get_field_types() widens channel fields to whole ChanFieldTypes, so RANGE
+/// of RNG15_RFL8_NIR8 takes 32 bits per pixel for its 15 bits on the wire.
+/// A PackedScan stores every pixel field that a packet format decodes in the
+/// narrowest unsigned integer holding its on-wire bits, with the bits the
+/// format always leaves zero shifted out: RNG15 ranges are kept in 8 mm
+/// units in 16 bits and NIR of the same profile in 8 bits. The other fields
+/// and the headers are kept as they are. Packing is lossless; fields are
+/// unpacked on demand with loops the compiler vectorizes.
+class OUSTER_API_CLASS PackedScan {
+   public:
+    /// Construct an empty PackedScan
+    OUSTER_API_FUNCTION
+    PackedScan();
+
+    /// Pack a scan batched from packets of a format
+    ///
+    /// @throw std::invalid_argument if a field has values outside of the
+    /// bits its packets can carry, e.g. ranges that aren't a multiple of 8 mm
+    /// for RNG15 profiles
+    OUSTER_API_FUNCTION
+    PackedScan(const LidarScan& scan,          ///< [in] scan to pack
+               const sensor::packet_format& pf  ///< [in] format of its packets
+    );
+
+    /// Pack a scan with the packet format of its sensor_info
+    ///
+    /// @throw std::invalid_argument if the scan has no sensor_info, or as
+    /// PackedScan(const LidarScan&, const sensor::packet_format&)
+    OUSTER_API_FUNCTION
+    explicit PackedScan(const LidarScan& scan  ///< [in] scan to pack
+    );
+
+    /// Get the width of the packed scan
+    /// @return the number of columns
+    OUSTER_API_FUNCTION
+    size_t width() const;
+
+    /// Get the height of the packed scan
+    /// @return the number of rows
+    OUSTER_API_FUNCTION
+    size_t height() const;
+
+    /// Get the fields of the scan as they are unpacked
+    /// @return the field types, sorted as LidarScan::field_types()
+    OUSTER_API_FUNCTION
+    LidarScanFieldTypes field_types() const;
+
+    /// Check whether the scan has a field
+    /// @return true if the field is in the scan, packed or not
+    OUSTER_API_FUNCTION
+    bool has_field(const std::string& name  ///< [in] name of the field
+    ) const;
+
+    /// Check whether a field is stored narrower than it is unpacked
+    /// @return true if the field is packed
+    OUSTER_API_FUNCTION
+    bool is_packed(const std::string& name  ///< [in] name of the field
+    ) const;
+
+    /// Unpack one field
+    /// @throw std::out_of_range if the scan has no such field
+    /// @return the field, of the type it had in the packed scan
+    OUSTER_API_FUNCTION
+    Field field(const std::string& name  ///< [in] name of the field
+    ) const;
+
+    /// Unpack the scan
+    /// @return a copy of the packed scan
+    OUSTER_API_FUNCTION
+    LidarScan unpack() const;
+
+    /// Unpack the scan into a scan of the same dimensions and fields, without
+    /// allocating, e.g. a scan from a ScanPool
+    /// @throw std::invalid_argument if the fields or dimensions differ
+    OUSTER_API_FUNCTION
+    void unpack(LidarScan& dst  ///< [out] scan to unpack into
+    ) const;
+
+    /// Get the memory the scan takes, in bytes
+    /// @return the bytes of the fields and headers
+    OUSTER_API_FUNCTION
+    size_t bytes() const;
+
+    /// Get the memory the unpacked scan takes, in bytes
+    /// @return the bytes of the fields and headers of unpack()
+    OUSTER_API_FUNCTION
+    size_t unpacked_bytes() const;
+
+   private:
+    struct PackedField {
+        FieldType type;  // as unpacked
+        Field data;      // narrow values
+        int shift;       // bits to shift data left to unpack
+    };
+
+    // unpacked fields, headers and the other members of the scan
+    LidarScan rest_;
+    std::vector<PackedField> packed_;
+
+    const PackedField* find(const std::string& name) const;
+};
+
+}  // namespace ouster
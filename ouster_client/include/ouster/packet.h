@@ -267,6 +267,26 @@ struct OUSTER_API_CLASS LidarPacket : public Packet {
     }
 };
 
+/// Validate a run of lidar packets of one sensor at once, with the size,
+/// init_id and prod_sn checks of validate_packet and optionally the CRC of
+/// profiles that have one.
+///
+/// @param[in] info The sensor info to check the packets against.
+/// @param[in] format The packet format of the sensor.
+/// @param[in] packets The packets to validate.
+/// @param[in] count The number of packets.
+/// @param[out] valid Bitmap with bit i % 64 of word i / 64 set if packet i is
+///                   valid, resized to fit count bits.
+/// @param[in] check_crc If true, also check that the CRC in the packet
+///                      matches its contents.
+/// @return The number of valid packets
+OUSTER_API_FUNCTION
+size_t validate_lidar_packets(const sensor_info& info,
+                              const ouster::sensor::packet_format& format,
+                              const LidarPacket* packets, size_t count,
+                              std::vector<uint64_t>& valid,
+                              bool check_crc = false);
+
 /// Encapsulate an imu packet buffer and attributes associated with it.
 struct OUSTER_API_CLASS ImuPacket : public Packet {
     using Packet::Packet;
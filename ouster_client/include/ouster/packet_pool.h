@@ -0,0 +1,124 @@
+/**
+ * Copyright (c) 2024, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Reference counted pool of reusable packets
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "ouster/packet.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace sensor {
+
+class PacketPool;
+
+/// Shared handle to a packet borrowed from a PacketPool.
+///
+/// Handles can be copied and passed between threads freely. The packet is
+/// returned to its pool, keeping its buffer allocation, once the last handle
+/// referring to it is released. Handles remain valid after the pool that
+/// issued them is destroyed.
+class OUSTER_API_CLASS PooledPacket {
+   public:
+    /// Construct an empty handle
+    OUSTER_API_FUNCTION PooledPacket() = default;
+
+    /// Share ownership of the packet held by other
+    OUSTER_API_FUNCTION PooledPacket(const PooledPacket& other);
+
+    /// Take ownership of the packet held by other, leaving it empty
+    OUSTER_API_FUNCTION PooledPacket(PooledPacket&& other) noexcept;
+
+    /// Share ownership of the packet held by other
+    /// @return this handle
+    OUSTER_API_FUNCTION PooledPacket& operator=(const PooledPacket& other);
+
+    /// Take ownership of the packet held by other, leaving it empty
+    /// @return this handle
+    OUSTER_API_FUNCTION PooledPacket& operator=(PooledPacket&& other) noexcept;
+
+    /// Release this handle's reference to the packet
+    OUSTER_API_FUNCTION ~PooledPacket();
+
+    /// Release this handle's reference to the packet, leaving it empty
+    OUSTER_API_FUNCTION void reset();
+
+    /// Get the packet
+    /// @return pointer to the packet, or null if the handle is empty
+    OUSTER_API_FUNCTION Packet* get() const;
+
+    /// Get the number of handles referring to the packet
+    /// @return the reference count, or zero if the handle is empty
+    OUSTER_API_FUNCTION size_t use_count() const;
+
+    /// Get the packet. The handle must not be empty.
+    /// @return reference to the packet
+    OUSTER_API_FUNCTION Packet& operator*() const { return *get(); }
+
+    /// Access the packet. The handle must not be empty.
+    /// @return pointer to the packet
+    OUSTER_API_FUNCTION Packet* operator->() const { return get(); }
+
+    /// Check whether the handle refers to a packet
+    /// @return true if the handle is not empty
+    OUSTER_API_FUNCTION explicit operator bool() const {
+        return slot_ != nullptr;
+    }
+
+    struct OUSTER_API_IGNORE Slot;
+
+   private:
+    friend class PacketPool;
+    explicit PooledPacket(Slot* slot) : slot_{slot} {}
+
+    Slot* slot_{nullptr};
+};
+
+/// Pool of lidar and imu packets handed out as PooledPacket handles.
+///
+/// Packets are allocated on demand the first time the pool runs out and
+/// reused from then on, so a steady-state consumer does not allocate. The pool
+/// is thread-safe.
+class OUSTER_API_CLASS PacketPool {
+   public:
+    /// Construct an empty pool
+    OUSTER_API_FUNCTION PacketPool();
+
+    /// Destruct the pool. Packets still held by handles are freed once
+    /// released.
+    OUSTER_API_FUNCTION ~PacketPool();
+
+    PacketPool(const PacketPool&) = delete;
+    PacketPool& operator=(const PacketPool&) = delete;
+
+    /// Borrow a packet of the given type from the pool, allocating a new one
+    /// if none are free. The packet keeps the contents it had when it was last
+    /// released.
+    /// @throw invalid_argument if type is not Lidar or Imu
+    /// @return a handle holding the only reference to the packet
+    OUSTER_API_FUNCTION PooledPacket acquire(
+        PacketType type  ///< [in] type of packet to borrow
+    );
+
+    /// Get the number of packets allocated by the pool, free or in use
+    /// @return the number of allocated packets
+    OUSTER_API_FUNCTION size_t size() const;
+
+    /// Get the number of packets ready to be borrowed without allocation
+    /// @return the number of free packets
+    OUSTER_API_FUNCTION size_t available() const;
+
+    struct OUSTER_API_IGNORE State;
+
+   private:
+    State* state_;
+};
+
+}  // namespace sensor
+}  // namespace ouster
@@ -0,0 +1,141 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Republish the packets of a SensorClient to local consumers
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ouster/sensor_client.h"
+#include "ouster/types.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace sensor {
+
+/// Where a PacketRelay sends packets to
+struct OUSTER_API_CLASS RelayDestination {
+    /// Unicast or multicast address, IPv4 or IPv6, or hostname
+    std::string host;
+
+    /// Port to send lidar packets to, 0 to not send them
+    int lidar_port = 7502;
+
+    /// Port to send IMU packets to, 0 to not send them
+    int imu_port = 7503;
+
+    /// Index of the sensor whose packets are sent, -1 for every sensor. The
+    /// packets of all sensors come from the address of the relay, so a
+    /// consumer of several sensors needs a destination per sensor.
+    int source = -1;
+};
+
+/// Options of a PacketRelay
+struct OUSTER_API_CLASS PacketRelayOptions {
+    /// Most packets received from the client and sent on at once
+    size_t batch_size = 64;
+
+    /// Time to live of multicast packets, 1 keeps them on the local network
+    int multicast_ttl = 1;
+
+    /// Local IPv4 address of the interface to send IPv4 multicast from, or
+    /// empty for the default route
+    std::string multicast_interface;
+
+    /// Deliver multicast packets to consumers on this host too
+    bool multicast_loop = true;
+
+    /// Name of a shared memory channel to also publish the packets to, see
+    /// ShmPacketReader, or empty for none
+    std::string shm_name;
+
+    /// Number of packets in the shared memory ring
+    size_t shm_slots = 4096;
+};
+
+/// Packets sent to a RelayDestination
+struct OUSTER_API_CLASS RelayDestinationStats {
+    uint64_t packets = 0;  ///< packets sent
+    uint64_t bytes = 0;    ///< bytes of the packets sent
+    uint64_t errors = 0;   ///< packets the kernel refused to send
+};
+
+/// Counters of a PacketRelay
+struct OUSTER_API_CLASS PacketRelayStats {
+    uint64_t lidar_packets = 0;  ///< lidar packets received
+    uint64_t imu_packets = 0;    ///< IMU packets received
+    uint64_t batches = 0;        ///< batches of packets received
+    uint64_t shm_packets = 0;    ///< packets published to shared memory
+    /// Counters of each destination, in the order given
+    std::vector<RelayDestinationStats> destinations;
+};
+
+/// Fans out the packets of a SensorClient to several local UDP or multicast
+/// destinations and, optionally, a shared memory ring, for sensors that can
+/// only send to a few destinations but have many consumers:
+///
+///     SensorClient client({Sensor(hostname, config)});
+///     PacketRelay relay(client.get_sensor_info(),
+///                       {{"239.1.1.1"}, {"127.0.0.1", 17502, 0}});
+///     relay.start(client);
+///
+/// Packets are received in batches with SensorClient::get_packets and sent
+/// on straight from its buffers: on Linux with one sendmmsg call per batch
+/// for every destination, elsewhere with a send per packet and destination.
+/// Only publishing to shared memory copies them.
+class OUSTER_API_CLASS PacketRelay {
+   public:
+    /// Open the sockets and shared memory channel of the relay
+    /// @throw invalid_argument if a destination can't be resolved
+    /// @throw runtime_error if a socket or the channel can't be opened
+    OUSTER_API_FUNCTION PacketRelay(
+        const std::vector<sensor_info>& infos,  ///< [in] sensors of the client
+        const std::vector<RelayDestination>&
+            destinations,  ///< [in] where to send packets
+        const PacketRelayOptions& options = {}  ///< [in] options
+    );
+
+    /// Stop the relay, see stop()
+    OUSTER_API_FUNCTION ~PacketRelay();
+
+    PacketRelay(const PacketRelay&) = delete;
+    PacketRelay& operator=(const PacketRelay&) = delete;
+
+    /// Send a batch of events on, e.g. from SensorClient::get_packets in a
+    /// loop of the application. Events other than packets are ignored.
+    OUSTER_API_FUNCTION void forward(
+        std::vector<ClientEvent>& events  ///< [in] events to send
+    );
+
+    /// Receive packets from the client and forward them on a thread of the
+    /// relay, "ouster-relay", until stop() is called or the client is
+    /// closed. The client must outlive the relay and not be read from
+    /// elsewhere meanwhile.
+    /// @throw logic_error if the relay already runs
+    OUSTER_API_FUNCTION void start(SensorClient& client  ///< [in] the client
+    );
+
+    /// Stop the thread started by start(), if any
+    OUSTER_API_FUNCTION void stop();
+
+    /// @return the counters of the relay
+    OUSTER_API_FUNCTION PacketRelayStats stats() const;
+
+   private:
+    struct OUSTER_API_IGNORE Impl;
+    std::unique_ptr<Impl> impl_;
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+};
+
+}  // namespace sensor
+}  // namespace ouster
@@ -0,0 +1,209 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Continuous completeness and timing analysis of a packet stream
+ *
+ * ScanBatcher fills the columns of lost packets with zeros without saying
+ * so. A PacketStreamAnalyzer is fed the same packets, from a sensor, a pcap
+ * or an OSF file, and counts what got lost and how regularly the rest
+ * arrived, cheaply enough to run on every packet of a live sensor.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "ouster/latency_histogram.h"
+#include "ouster/packet.h"
+#include "ouster/types.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace sensor {
+
+/// Consecutive columns of the column window missing from a frame
+struct OUSTER_API_CLASS MissingColumns {
+    uint32_t frame_id = 0;  ///< frame the columns are missing from
+    uint16_t first = 0;     ///< measurement id of the first missing column
+    uint16_t last = 0;      ///< measurement id of the last missing column,
+                            ///< lower than first if the range wraps around
+};
+
+/// Counters and distributions of a PacketStreamAnalyzer. Inter-arrival
+/// times and jitter are measured on the host timestamps of the packets, in
+/// nanoseconds; jitter is the deviation of the inter-arrival time from the
+/// period the sensor sends packets at. Rates are in packets per second over
+/// windows of one second, zero until the first window completes.
+struct OUSTER_API_CLASS PacketStreamStats {
+    uint64_t lidar_packets = 0;  ///< lidar packets analyzed
+    uint64_t imu_packets = 0;    ///< IMU packets analyzed
+
+    /// Packets of the wrong size or not matching the init_id or serial
+    /// number of the sensor, ignored otherwise
+    uint64_t invalid_packets = 0;
+
+    uint64_t frames = 0;             ///< frames completed
+    uint64_t incomplete_frames = 0;  ///< frames with columns missing
+
+    /// Columns of the column window missing from completed frames
+    uint64_t missing_columns = 0;
+
+    /// Frames skipped entirely according to the frame_id of the packets
+    uint64_t missing_frames = 0;
+
+    /// Packets of a frame already completed, ignored otherwise
+    uint64_t late_packets = 0;
+
+    /// Packets arriving after a packet with later columns of their frame
+    uint64_t reordered_packets = 0;
+
+    /// Columns received more than once in a frame
+    uint64_t duplicate_columns = 0;
+
+    /// Valid columns whose timestamp isn't after the timestamp of the
+    /// previous valid column in measurement order
+    uint64_t timestamp_regressions = 0;
+
+    /// Times the sensor was reinitialized, according to the init_id
+    uint64_t reinits = 0;
+
+    /// Time between lidar packets with consecutive columns of a frame
+    LatencyStats lidar_interarrival;
+    /// Deviation of lidar_interarrival from the lidar packet period
+    LatencyStats lidar_jitter;
+    /// Time between IMU packets
+    LatencyStats imu_interarrival;
+    /// Deviation of imu_interarrival from the IMU packet period
+    LatencyStats imu_jitter;
+
+    double lidar_rate = 0;           ///< rate of the last complete window
+    double min_lidar_rate = 0;       ///< lowest rate of any window
+    double max_lidar_rate = 0;       ///< highest rate of any window
+    double expected_lidar_rate = 0;  ///< rate the sensor sends at
+    double imu_rate = 0;             ///< rate of the last complete window
+    double min_imu_rate = 0;         ///< lowest rate of any window
+    double max_imu_rate = 0;         ///< highest rate of any window
+    double expected_imu_rate = 0;    ///< rate the sensor sends at
+
+    /// The most recent ranges of missing columns, oldest first
+    std::vector<MissingColumns> missing_ranges;
+};
+
+/// Analyzes the packets of one sensor as they arrive: frame completeness,
+/// missing measurement id ranges, frame id gaps, column timestamp
+/// monotonicity, and the jitter and rate stability of lidar and IMU
+/// packets.
+///
+/// Packets are meant to be fed from a single thread; analyzing one doesn't
+/// allocate or lock unless its frame completes with columns missing. Stats
+/// can be read from any thread.
+class OUSTER_API_CLASS PacketStreamAnalyzer {
+   public:
+    /// Create an analyzer for the packets of a sensor
+    OUSTER_API_FUNCTION
+    PacketStreamAnalyzer(
+        const sensor_info& info,       ///< [in] metadata of the sensor
+        size_t max_missing_ranges = 64  ///< [in] how many of the most recent
+                                        ///< missing ranges to keep
+    );
+
+    PacketStreamAnalyzer(const PacketStreamAnalyzer&) = delete;
+    PacketStreamAnalyzer& operator=(const PacketStreamAnalyzer&) = delete;
+
+    /// Analyze a packet of the sensor. Packets of unknown type are ignored.
+    OUSTER_API_FUNCTION
+    void operator()(const Packet& packet  ///< [in] packet to analyze
+    );
+
+    /// Analyze a lidar packet of the sensor
+    OUSTER_API_FUNCTION
+    void operator()(const LidarPacket& packet  ///< [in] packet to analyze
+    );
+
+    /// Analyze an IMU packet of the sensor
+    OUSTER_API_FUNCTION
+    void operator()(const ImuPacket& packet  ///< [in] packet to analyze
+    );
+
+    /// Complete the frame in progress, e.g. at the end of a recording.
+    /// Otherwise a frame completes when a packet of a later frame arrives.
+    OUSTER_API_FUNCTION
+    void flush();
+
+    /// Forget everything analyzed so far. Not to be called while a packet
+    /// is being analyzed.
+    OUSTER_API_FUNCTION
+    void reset();
+
+    /// Get the counters and distributions analyzed so far
+    /// @return the stats
+    OUSTER_API_FUNCTION
+    PacketStreamStats stats() const;
+
+   private:
+    // timing of a kind of packet, updated by the feeding thread only
+    struct Timing {
+        uint64_t last_ts = 0;
+        uint64_t window_start = 0;
+        uint64_t window_packets = 0;
+        LatencyHistogram interarrival;
+        LatencyHistogram jitter;
+        std::atomic<double> rate{0};
+        std::atomic<double> min_rate{0};
+        std::atomic<double> max_rate{0};
+    };
+
+    void count_rate(Timing& timing, uint64_t ts);
+    void record_interarrival(Timing& timing, uint64_t ts, uint64_t period);
+    void start_frame(uint32_t frame_id);
+    void complete_frame();
+    void add_range(int first, int last);
+
+    sensor_info info_;
+    const packet_format& pf_;
+    int cols_;
+    int window_start_;
+    int window_width_;
+    uint16_t fps_;
+    uint64_t lidar_period_;
+
+    std::atomic<uint64_t> lidar_packets_{0};
+    std::atomic<uint64_t> imu_packets_{0};
+    std::atomic<uint64_t> invalid_packets_{0};
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> incomplete_frames_{0};
+    std::atomic<uint64_t> missing_columns_{0};
+    std::atomic<uint64_t> missing_frames_{0};
+    std::atomic<uint64_t> late_packets_{0};
+    std::atomic<uint64_t> reordered_packets_{0};
+    std::atomic<uint64_t> duplicate_columns_{0};
+    std::atomic<uint64_t> timestamp_regressions_{0};
+    std::atomic<uint64_t> reinits_{0};
+
+    Timing lidar_;
+    Timing imu_;
+
+    // the frame in progress, positions are in the column window
+    bool started_ = false;
+    bool in_frame_ = false;
+    uint32_t frame_id_ = 0;
+    uint32_t init_id_ = 0;
+    std::vector<uint64_t> seen_;
+    int64_t last_pos_ = -1;
+    uint64_t last_col_ts_ = 0;
+    int64_t last_packet_pos_ = -1;
+
+    // ring of the most recent missing ranges
+    mutable std::mutex ranges_mutex_;
+    std::vector<MissingColumns> ranges_;
+    size_t ranges_next_ = 0;
+    size_t ranges_count_ = 0;
+};
+
+}  // namespace sensor
+}  // namespace ouster
@@ -0,0 +1,130 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Batch recorded packets of several sensors on parallel threads
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/packet.h"
+#include "ouster/types.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+/// Batches lidar packets of several sensors into scans with one worker thread
+/// and ScanBatcher per sensor, e.g. when reprocessing a multi-sensor pcap or
+/// OSF file.
+///
+/// Packets are handed to the worker of their sensor in the order they are
+/// pushed. Completed scans go through a reorder buffer and come out in the
+/// order a single thread batching the same packets would produce them, that
+/// is ordered by the packet that completed each scan, which for a recording is
+/// capture timestamp order. A scan is only handed out once every worker has
+/// batched all packets pushed before the one that completed it.
+///
+/// NOTE: push blocks while the queue of the sensor is full. Calling push and
+///       pop from the same thread works, as workers never wait on the
+///       consumer, but completed scans then pile up until they are popped.
+class OUSTER_API_CLASS ParallelScanBatcher {
+   public:
+    /// Start one worker per sensor
+    /// @throw invalid_argument if fields is neither empty nor has an entry per
+    ///        sensor, or queue_size is zero
+    OUSTER_API_FUNCTION ParallelScanBatcher(
+        const std::vector<sensor::sensor_info>&
+            infos,  ///< [in] metadata of each sensor, indexed by sensor_idx
+        const std::vector<LidarScanFieldTypes>& fields =
+            {},  ///< [in] fields to batch per sensor, or empty for the
+                 ///< default fields of each profile
+        size_t queue_size = 256  ///< [in] packets to queue per sensor before
+                                 ///< push blocks
+    );
+
+    /// Stop the workers, discarding queued packets and scans not yet popped
+    OUSTER_API_FUNCTION ~ParallelScanBatcher();
+
+    ParallelScanBatcher(const ParallelScanBatcher&) = delete;
+    ParallelScanBatcher& operator=(const ParallelScanBatcher&) = delete;
+
+    /// Queue a lidar packet for batching. The packet is copied into a reused
+    /// buffer.
+    /// @throw invalid_argument if sensor_idx is out of range
+    /// @throw runtime_error if called after finish
+    OUSTER_API_FUNCTION void push(
+        size_t sensor_idx,  ///< [in] sensor the packet came from, e.g. as
+                            ///< given by IndexedPcapReader
+        const sensor::LidarPacket& packet  ///< [in] the packet
+    );
+
+    /// Signal that no more packets will be pushed. Workers finish their
+    /// queues; a scan left incomplete at the end is dropped, as it would be
+    /// by a ScanBatcher that batches no more packets.
+    OUSTER_API_FUNCTION void finish();
+
+    /// Wait for the next scan in order.
+    /// @return the next scan with the index of its sensor, or {-1, nullptr}
+    ///         once finish was called and every scan has been popped
+    OUSTER_API_FUNCTION std::pair<int, std::unique_ptr<LidarScan>> pop();
+
+    /// Get the next scan in order if it is ready, without waiting.
+    /// @return the next scan with the index of its sensor, or {-1, nullptr}
+    ///         if it isn't ready yet
+    OUSTER_API_FUNCTION std::pair<int, std::unique_ptr<LidarScan>> try_pop();
+
+    /// Take the scans the workers were still batching when finish was called,
+    /// the partial last scan of each sensor of a recording, ordered by first
+    /// valid packet timestamp. Only returns scans once pop has returned
+    /// {-1, nullptr}, and only the first time.
+    /// @return the unfinished scans with the index of their sensor
+    OUSTER_API_FUNCTION std::vector<std::pair<int, std::unique_ptr<LidarScan>>>
+    take_unfinished();
+
+    /// Hand back a popped scan so that it is reused for a later scan of the
+    /// same sensor rather than allocating a new one
+    /// @throw invalid_argument if sensor_idx is out of range
+    OUSTER_API_FUNCTION void recycle(
+        int sensor_idx,                  ///< [in] sensor it came from
+        std::unique_ptr<LidarScan> scan  ///< [in] scan to reuse
+    );
+
+    struct OUSTER_API_IGNORE Worker;
+
+   private:
+    std::vector<std::unique_ptr<Worker>> workers_;
+    size_t queue_size_;
+    // sequence number of the next pushed packet, taken under the lock of the
+    // worker the packet goes to
+    std::atomic<uint64_t> next_seq_{0};
+    std::atomic<bool> finishing_{false};
+
+    std::mutex out_mutex_;
+    std::condition_variable out_cv_;
+    std::atomic<int> consumers_waiting_{0};
+    // completed scans by the sequence number of the packet that completed
+    // them, guarded by out_mutex_
+    std::map<uint64_t, std::pair<int, std::unique_ptr<LidarScan>>> ready_;
+
+    void run_worker(size_t sensor_idx);
+    void wake_consumer();
+
+    // check whether every packet pushed before seq has been batched, called
+    // with out_mutex_ held
+    bool batched_before(uint64_t seq);
+    bool all_done();
+    std::pair<int, std::unique_ptr<LidarScan>> take_ready();
+};
+
+}  // namespace ouster
@@ -0,0 +1,534 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Dataflow pipelines of typed stages run on a work stealing pool
+ *
+ * A Pipeline connects sources, which produce items on threads of their own,
+ * to stages and sinks, which the pool runs whenever items are queued for
+ * them, e.g.
+ *
+ *     Pipeline pipeline;
+ *     auto packets = pipeline.source<PooledPacket>(
+ *         "receive", packet_source(client));
+ *     auto scans = pipeline.map<ScanPtr>(packets, "batch",
+ *                                        batch_stage(info));
+ *     scans = pipeline.map<ScanPtr>(scans, "clip",
+ *                                   clip_stage("RANGE", 0, 50000));
+ *     pipeline.sink(scans, "publish", scan_hub_sink(hub),
+ *                   {1, Backpressure::DROP_OLDEST});
+ *     pipeline.start();
+ *     ...
+ *     pipeline.stop();
+ *     pipeline.wait();
+ *
+ * See pipeline_stages.h for the stages built from the components of the
+ * SDK.
+ *
+ * Each stage has a bounded input queue. When it is full, the stage either
+ * holds up the stage feeding it until there is room, or drops the oldest or
+ * newest item, see Backpressure. A stage processes its items one at a time
+ * and in order, so its function needs no locking, while different stages
+ * run in parallel on the workers of the pool. The output of a stage can feed
+ * several stages, each of which gets a copy of every item: share large items
+ * like scans through shared pointers.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ouster/latency_histogram.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+/// What a stage does with an item arriving while its input queue is full
+enum class Backpressure {
+    /// Hold up the stage feeding this one until there is room, so that no
+    /// item is lost, e.g. for a recorder
+    BLOCK,
+    /// Drop the oldest queued item, so the stage always sees the latest
+    /// items, e.g. for a viz
+    DROP_OLDEST,
+    /// Drop the new item
+    DROP_NEWEST
+};
+
+/// Input queue of a stage
+struct OUSTER_API_CLASS StageOptions {
+    size_t queue_depth = 4;                           ///< most items queued
+    Backpressure backpressure = Backpressure::BLOCK;  ///< when full
+};
+
+/// Result of a call to the function of a source
+enum class SourceStatus {
+    ITEM,     ///< an item was produced
+    TIMEOUT,  ///< no item yet, the function is called again
+    END       ///< the source is exhausted
+};
+
+/// Produces an item into out, see Pipeline::source
+template <typename T>
+using SourceFn = std::function<SourceStatus(T& out)>;
+
+/// Processes an item, writing what to pass on to out
+/// @return false to pass nothing on, e.g. until a scan is complete
+template <typename In, typename Out>
+using StageFn = std::function<bool(In& in, Out& out)>;
+
+/// Consumes an item, see Pipeline::sink
+template <typename In>
+using SinkFn = std::function<void(In& in)>;
+
+/// Counters of a stage of a Pipeline
+struct OUSTER_API_CLASS StageStats {
+    std::string name;           ///< name of the stage
+    uint64_t items_in = 0;      ///< items processed, or produced by a source
+    uint64_t items_out = 0;     ///< items passed on
+    uint64_t dropped = 0;       ///< items dropped from the full input queue
+    uint64_t stalls = 0;        ///< times held up by a full queue downstream
+    size_t queue_depth = 0;     ///< items waiting in the input queue
+    size_t max_queue_depth = 0;  ///< most items waiting at once
+    double busy_seconds = 0;    ///< time spent in the function of the stage
+    /// Time the function of the stage took for each item, in nanoseconds
+    sensor::LatencyStats latency;
+};
+
+/// Options of a Pipeline
+struct OUSTER_API_CLASS PipelineOptions {
+    /// Workers running the stages, 0 for sdk_thread_count()
+    unsigned threads = 0;
+
+    /// Most items a stage processes before letting its worker run another
+    /// stage, trading throughput for fairness
+    size_t batch = 16;
+};
+
+class Pipeline;
+
+namespace impl {
+
+class PipelineCore;
+class PipelineEdge;
+
+/// Keeps the functions of stages from taking part in deducing their item
+/// types, which come from the ports alone, so lambdas can be passed
+template <typename T>
+struct NonDeduced {
+    using type = T;
+};
+
+/// A stage of a Pipeline, independent of the types of its items
+class OUSTER_API_CLASS PipelineNode {
+   public:
+    OUSTER_API_FUNCTION PipelineNode(PipelineCore& core, std::string name);
+    OUSTER_API_FUNCTION virtual ~PipelineNode();
+
+    PipelineNode(const PipelineNode&) = delete;
+    PipelineNode& operator=(const PipelineNode&) = delete;
+
+    /// Produce an item, for sources
+    virtual SourceStatus produce() { return SourceStatus::END; }
+
+    /// Process the next queued item, for stages and sinks
+    /// @return false if none was queued
+    virtual bool step() { return false; }
+
+    /// Drop the queued items, once the pipeline failed
+    virtual void discard() {}
+
+    /// Run the node on the pool, unless it is scheduled already
+    OUSTER_API_FUNCTION void activate();
+
+    /// Tell the node a full queue it feeds has room again
+    OUSTER_API_FUNCTION void room_available();
+
+    /// @return true if every queue the node feeds can take an item
+    OUSTER_API_FUNCTION bool outputs_ready() const;
+
+    /// @return the counters of the node
+    OUSTER_API_FUNCTION StageStats stats() const;
+
+    /// Name of the node
+    const std::string name;
+
+    /// Input queue, or null for sources
+    PipelineEdge* input{nullptr};
+
+    /// Queues the node feeds
+    std::vector<PipelineEdge*> outputs;
+
+    /// Items processed and passed on
+    std::atomic<uint64_t> items_in{0};
+    std::atomic<uint64_t> items_out{0};
+
+   private:
+    friend class PipelineCore;
+
+    PipelineCore& core_;
+    std::atomic<bool> scheduled_{false};
+    std::atomic<bool> stalled_{false};
+    std::atomic<bool> done_{false};
+    std::atomic<uint64_t> stalls_{0};
+    std::atomic<uint64_t> busy_ns_{0};
+    sensor::LatencyHistogram latency_;
+};
+
+/// Bounded input queue of a node, independent of the type of its items
+class OUSTER_API_CLASS PipelineEdge {
+   public:
+    OUSTER_API_FUNCTION PipelineEdge(const StageOptions& options,
+                                     PipelineNode& consumer);
+    OUSTER_API_FUNCTION virtual ~PipelineEdge();
+
+    PipelineEdge(const PipelineEdge&) = delete;
+    PipelineEdge& operator=(const PipelineEdge&) = delete;
+
+    /// @return true if the queue can take an item without blocking
+    OUSTER_API_FUNCTION bool ready() const;
+
+    /// Wait for room in the queue, for the threads of sources
+    /// @return true if the queue can take an item
+    OUSTER_API_FUNCTION bool wait_ready(double timeout_sec) const;
+
+    /// Mark the end of the items and let the consumer finish
+    OUSTER_API_FUNCTION void close();
+
+    /// @return true once closed and emptied
+    OUSTER_API_FUNCTION bool drained() const;
+
+    /// @return the number of items queued
+    OUSTER_API_FUNCTION size_t size() const;
+
+    /// Node feeding the queue
+    PipelineNode* producer{nullptr};
+
+    /// Node consuming the queue
+    PipelineNode& consumer;
+
+    /// Items dropped from the full queue
+    std::atomic<uint64_t> dropped{0};
+
+    /// Most items queued at once
+    std::atomic<size_t> max_size{0};
+
+   protected:
+    /// Account for an item queued, with the lock held
+    OUSTER_API_FUNCTION void pushed_locked();
+
+    /// Account for an item taken, after releasing the lock
+    OUSTER_API_FUNCTION void popped();
+
+    const StageOptions options_;
+    mutable std::mutex mtx_;
+    mutable std::condition_variable room_;
+    size_t size_{0};
+    bool closed_{false};
+};
+
+/// Queue of the items of type T fed to a node
+template <typename T>
+class PipelineQueue : public PipelineEdge {
+   public:
+    using PipelineEdge::PipelineEdge;
+
+    /// Queue an item, dropping one if full as the options say
+    void push(T&& item) {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (items_.size() >= options_.queue_depth) {
+                if (options_.backpressure == Backpressure::DROP_NEWEST) {
+                    dropped++;
+                    return;
+                }
+                if (options_.backpressure == Backpressure::DROP_OLDEST) {
+                    items_.pop_front();
+                    size_--;
+                    dropped++;
+                }
+                // BLOCK: the producer checked for room before
+            }
+            items_.push_back(std::move(item));
+            pushed_locked();
+        }
+        consumer.activate();
+    }
+
+    /// Take the oldest item
+    /// @return false if the queue is empty
+    bool pop(T& out) {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (items_.empty()) return false;
+            out = std::move(items_.front());
+            items_.pop_front();
+            size_--;
+        }
+        popped();
+        return true;
+    }
+
+   private:
+    std::deque<T> items_;
+};
+
+/// Queues fed by the output of a node of type T
+template <typename T>
+class PipelineOutputs {
+   public:
+    /// Pass an item on to every queue, copying it for all but the last
+    size_t emit(T&& item) {
+        if (queues_.empty()) return 0;
+        for (size_t i = 0; i + 1 < queues_.size(); i++) {
+            queues_[i]->push(copy(item, std::is_copy_constructible<T>{}));
+        }
+        queues_.back()->push(std::move(item));
+        return queues_.size();
+    }
+
+    /// Add a queue to feed
+    /// @throw std::logic_error if items of type T can't be copied to feed
+    ///        several queues
+    void add(PipelineQueue<T>* queue) {
+        if (!queues_.empty() && !std::is_copy_constructible<T>::value) {
+            throw std::logic_error(
+                "Pipeline: items that can't be copied can only feed one "
+                "stage");
+        }
+        queues_.push_back(queue);
+    }
+
+   private:
+    static T copy(const T& item, std::true_type) { return item; }
+    static T copy(const T&, std::false_type) {
+        throw std::logic_error("Pipeline: can't copy item");
+    }
+
+    std::vector<PipelineQueue<T>*> queues_;
+};
+
+template <typename T>
+class SourceNode : public PipelineNode {
+   public:
+    SourceNode(PipelineCore& core, std::string name, SourceFn<T> fn)
+        : PipelineNode(core, std::move(name)), fn_(std::move(fn)) {}
+
+    SourceStatus produce() override {
+        T item{};
+        const SourceStatus status = fn_(item);
+        if (status == SourceStatus::ITEM) {
+            items_in++;
+            if (out.emit(std::move(item))) items_out++;
+        }
+        return status;
+    }
+
+    PipelineOutputs<T> out;
+
+   private:
+    SourceFn<T> fn_;
+};
+
+template <typename In, typename Out>
+class StageNode : public PipelineNode {
+   public:
+    StageNode(PipelineCore& core, std::string name, StageFn<In, Out> fn)
+        : PipelineNode(core, std::move(name)), fn_(std::move(fn)) {}
+
+    bool step() override {
+        In item{};
+        if (!queue->pop(item)) return false;
+        items_in++;
+        Out result{};
+        if (fn_(item, result) && out.emit(std::move(result))) items_out++;
+        return true;
+    }
+
+    void discard() override {
+        In item{};
+        while (queue->pop(item)) {
+        }
+    }
+
+    PipelineQueue<In>* queue{nullptr};
+    PipelineOutputs<Out> out;
+
+   private:
+    StageFn<In, Out> fn_;
+};
+
+template <typename In>
+class SinkNode : public PipelineNode {
+   public:
+    SinkNode(PipelineCore& core, std::string name, SinkFn<In> fn)
+        : PipelineNode(core, std::move(name)), fn_(std::move(fn)) {}
+
+    bool step() override {
+        In item{};
+        if (!queue->pop(item)) return false;
+        items_in++;
+        fn_(item);
+        return true;
+    }
+
+    void discard() override {
+        In item{};
+        while (queue->pop(item)) {
+        }
+    }
+
+    PipelineQueue<In>* queue{nullptr};
+
+   private:
+    SinkFn<In> fn_;
+};
+
+}  // namespace impl
+
+/// Output of a source or stage of a Pipeline, of items of type T, to connect
+/// further stages to
+template <typename T>
+class Port {
+   public:
+    Port() = default;
+
+   private:
+    friend class Pipeline;
+    Port(impl::PipelineNode* node, impl::PipelineOutputs<T>* outputs)
+        : node_(node), outputs_(outputs) {}
+
+    impl::PipelineNode* node_{nullptr};
+    impl::PipelineOutputs<T>* outputs_{nullptr};
+};
+
+/// Runs a graph of sources, stages and sinks, see the file documentation.
+/// Build the graph, then start it once; it runs until every source is
+/// exhausted or stop() is called, and the items in flight are processed.
+class OUSTER_API_CLASS Pipeline {
+   public:
+    /// Create an empty pipeline
+    OUSTER_API_FUNCTION explicit Pipeline(
+        const PipelineOptions& options = {}  ///< [in] options
+    );
+
+    /// Stop the pipeline and wait for it, ignoring its errors
+    OUSTER_API_FUNCTION ~Pipeline();
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    /// Add a source, calling fn on a thread of its own, "ouster-src-<name>",
+    /// until it returns END or the pipeline stops. fn may block for a while,
+    /// e.g. waiting for a packet, but should time out regularly for the
+    /// pipeline to be able to stop.
+    /// @throw std::logic_error once started
+    /// @return the output of the source
+    template <typename T>
+    Port<T> source(const std::string& name,  ///< [in] name of the source
+                   SourceFn<T> fn            ///< [in] produces the items
+    ) {
+        auto node = std::make_unique<impl::SourceNode<T>>(*core_, name,
+                                                          std::move(fn));
+        Port<T> port(node.get(), &node->out);
+        add_source(std::move(node));
+        return port;
+    }
+
+    /// Add a stage processing the items of an output into items of type Out
+    /// @throw std::logic_error once started, or if the items of the output
+    ///        can't be copied and it feeds a stage already
+    /// @return the output of the stage
+    template <typename Out, typename In>
+    Port<Out> map(const Port<In>& input,    ///< [in] items to process
+                  const std::string& name,  ///< [in] name of the stage
+                  typename impl::NonDeduced<StageFn<In, Out>>::type
+                      fn,  ///< [in] processes each item
+                  const StageOptions& options = {}  ///< [in] input queue
+    ) {
+        auto node = std::make_unique<impl::StageNode<In, Out>>(*core_, name,
+                                                               std::move(fn));
+        node->queue = connect(input, *node, options);
+        Port<Out> port(node.get(), &node->out);
+        add_node(std::move(node));
+        return port;
+    }
+
+    /// Add a sink consuming the items of an output
+    /// @throw std::logic_error once started, or if the items of the output
+    ///        can't be copied and it feeds a stage already
+    template <typename In>
+    void sink(const Port<In>& input,    ///< [in] items to consume
+              const std::string& name,  ///< [in] name of the sink
+              typename impl::NonDeduced<SinkFn<In>>::type
+                  fn,  ///< [in] consumes each item
+              const StageOptions& options = {}  ///< [in] input queue
+    ) {
+        auto node =
+            std::make_unique<impl::SinkNode<In>>(*core_, name, std::move(fn));
+        node->queue = connect(input, *node, options);
+        add_node(std::move(node));
+    }
+
+    /// Start the workers and sources
+    /// @throw std::logic_error if started already
+    OUSTER_API_FUNCTION void start();
+
+    /// Ask the sources to stop. The items in flight are still processed.
+    OUSTER_API_FUNCTION void stop();
+
+    /// Wait until every stage is done
+    /// @throw the first exception thrown by a source or stage, which
+    ///        stops the pipeline and drops the items in flight
+    OUSTER_API_FUNCTION void wait();
+
+    /// Wait until every stage is done, or for the timeout
+    /// @throw see wait()
+    /// @return true if every stage is done
+    OUSTER_API_FUNCTION bool wait_for(double timeout_sec  ///< [in] timeout
+    );
+
+    /// @return the counters of every source, stage and sink, in the order
+    ///         they were added
+    OUSTER_API_FUNCTION std::vector<StageStats> stats() const;
+
+   private:
+    template <typename T>
+    impl::PipelineQueue<T>* connect(const Port<T>& input,
+                                    impl::PipelineNode& node,
+                                    const StageOptions& options) {
+        check_connect(input.node_, options);
+        auto queue = std::make_unique<impl::PipelineQueue<T>>(options, node);
+        queue->producer = input.node_;
+        input.outputs_->add(queue.get());
+        input.node_->outputs.push_back(queue.get());
+        node.input = queue.get();
+        auto res = queue.get();
+        add_edge(std::move(queue));
+        return res;
+    }
+
+    OUSTER_API_FUNCTION void check_connect(const impl::PipelineNode* node,
+                                           const StageOptions& options) const;
+    OUSTER_API_FUNCTION void add_source(
+        std::unique_ptr<impl::PipelineNode> node);
+    OUSTER_API_FUNCTION void add_node(std::unique_ptr<impl::PipelineNode> node);
+    OUSTER_API_FUNCTION void add_edge(std::unique_ptr<impl::PipelineEdge> edge);
+
+    std::unique_ptr<impl::PipelineCore> core_;
+};
+
+}  // namespace ouster
@@ -0,0 +1,126 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Sources, stages and sinks of a Pipeline made of SDK components
+ *
+ * Scans travel through a pipeline as shared pointers, so fanning them out
+ * to several stages doesn't copy them. Stages like clip_stage modify the
+ * scan in place: place them before the output feeds several stages, or the
+ * other stages see the scan change under them.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/pipeline.h"
+#include "ouster/point_cloud_writer.h"
+#include "ouster/scan_hub.h"
+#include "ouster/scan_stream.h"
+#include "ouster/sensor_client.h"
+#include "ouster/sensor_scan_source.h"
+#include "ouster/shm_scan_channel.h"
+#include "ouster/types.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+/// Scan passed between the stages of a Pipeline
+using ScanPtr = std::shared_ptr<LidarScan>;
+
+/// Serialized scan, see encode_stage
+using EncodedScan = std::shared_ptr<const std::vector<uint8_t>>;
+
+/// Source of the packets of a client, received with
+/// SensorClient::get_pooled_packet so they stay valid while queued. Ends
+/// once the client is closed.
+/// @throw runtime_error from the source if the client fails
+/// @return the source
+OUSTER_API_FUNCTION
+SourceFn<sensor::ClientEvent> packet_source(
+    sensor::SensorClient& client,  ///< [in] client, must outlive the pipeline
+    double timeout_sec = 0.1       ///< [in] longest wait for a packet
+);
+
+/// Source of the scans of a SensorScanSource, from every sensor
+/// @return the source
+OUSTER_API_FUNCTION
+SourceFn<ScanPtr> scan_source(
+    sensor::SensorScanSource& source,  ///< [in] must outlive the pipeline
+    double timeout_sec = 0.1           ///< [in] longest wait for a scan
+);
+
+/// Stage batching the lidar packets of a packet_source into scans, with a
+/// ScanBatcher per sensor. IMU packets are skipped.
+/// @return the stage
+OUSTER_API_FUNCTION
+StageFn<sensor::ClientEvent, ScanPtr> batch_stage(
+    const std::vector<sensor::sensor_info>& infos  ///< [in] the sensors
+);
+
+/// Stage clamping the values of a field of each scan, see field_ops::clip()
+/// @throw invalid_argument from the stage if a scan has no such field
+/// @return the stage
+OUSTER_API_FUNCTION
+StageFn<ScanPtr, ScanPtr> clip_stage(
+    const std::string& field,  ///< [in] field to clamp
+    double lower,              ///< [in] smallest value kept
+    double upper               ///< [in] largest value kept
+);
+
+/// Stage setting the values of a field of each scan outside of a range to
+/// invalid, see field_ops::threshold()
+/// @throw invalid_argument from the stage if a scan has no such field
+/// @return the stage
+OUSTER_API_FUNCTION
+StageFn<ScanPtr, ScanPtr> threshold_stage(
+    const std::string& field,  ///< [in] field to filter
+    double lower,              ///< [in] smallest value kept
+    double upper,              ///< [in] largest value kept
+    double invalid = 0         ///< [in] value of the others
+);
+
+/// Stage serializing each scan, see serialize_scan()
+/// @return the stage
+OUSTER_API_FUNCTION
+StageFn<ScanPtr, EncodedScan> encode_stage(
+    bool compress = true  ///< [in] compress the fields and headers
+);
+
+/// Sink publishing each scan to the subscribers of a hub
+/// @return the sink
+OUSTER_API_FUNCTION
+SinkFn<ScanPtr> scan_hub_sink(
+    ScanHub& hub  ///< [in] hub, must outlive the pipeline
+);
+
+/// Sink publishing each scan to a shared memory channel
+/// @return the sink
+OUSTER_API_FUNCTION
+SinkFn<ScanPtr> shm_scan_sink(
+    ShmScanWriter& writer  ///< [in] writer, must outlive the pipeline
+);
+
+/// Sink sending each scan to the clients of a stream server
+/// @return the sink
+OUSTER_API_FUNCTION
+SinkFn<ScanPtr> scan_stream_sink(
+    ScanStreamServer& server  ///< [in] server, must outlive the pipeline
+);
+
+/// Sink writing the points of each scan to a point cloud file, see
+/// PointCloudWriter::write(const LidarScan&, const XYZLut&, ...)
+/// @return the sink
+OUSTER_API_FUNCTION
+SinkFn<ScanPtr> point_cloud_sink(
+    PointCloudWriter& writer,  ///< [in] writer, must outlive the pipeline
+    const XYZLut& lut,         ///< [in] lut of the sensor
+    const std::string& key_field = "REFLECTIVITY"  ///< [in] keys of points
+);
+
+}  // namespace ouster
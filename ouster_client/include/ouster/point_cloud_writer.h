@@ -0,0 +1,99 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Streaming PLY, PCD and LAS point cloud export
+ */
+
+#pragma once
+
+#include <Eigen/Core>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+/// File formats of PointCloudWriter
+enum class PointCloudFormat {
+    PLY = 0,  ///< binary little endian PLY with float x, y, z and key
+    PCD = 1,  ///< binary PCD with float x, y, z and key
+    LAS = 2   ///< LAS 1.2 of point format 0, with the key as intensity
+};
+
+struct point_cloud_writer_impl;
+
+/// Streams points with a scalar key each to a point cloud file, in blocks
+/// encoded on worker threads and written sequentially in the order they were
+/// added. The point count and, for LAS, the bounds in the header are filled in
+/// when the file is closed.
+class OUSTER_API_CLASS PointCloudWriter {
+   public:
+    /// @throw runtime_error if the file can't be opened for writing
+    OUSTER_API_FUNCTION PointCloudWriter(
+        const std::string& filename,  ///< [in] the file to write
+        PointCloudFormat format,      ///< [in] the file format
+        const std::string& key_name = "intensity",  ///< [in] name of the key
+                                                    ///< property, not for LAS
+        float key_scale = 1,  ///< [in] factor applied to the keys
+        size_t threads = 0);  ///< [in] number of worker threads,
+                              ///< sdk_thread_count() if 0
+
+    /// Write the remaining blocks and close the file, see close()
+    OUSTER_API_FUNCTION ~PointCloudWriter();
+
+    PointCloudWriter(const PointCloudWriter&) = delete;
+    PointCloudWriter& operator=(const PointCloudWriter&) = delete;
+
+    /// Add points with a key each.
+    ///
+    /// @throw invalid_argument if there isn't a key per point
+    /// @throw runtime_error if the file is closed
+    OUSTER_API_FUNCTION void write(
+        const Eigen::Ref<const pose_util::Points>& points,  ///< [in] (N, 3)
+        const Eigen::Ref<const Eigen::ArrayXd>& keys);      ///< [in] (N,)
+
+    /// Add the points of the pixels of a scan with a nonzero range, dewarped
+    /// by the poses of their column, see pose_util::cartesian_dewarp(), with
+    /// the values of a field as keys. Projecting and encoding run on a worker
+    /// thread, on copies of the range, keys and poses.
+    ///
+    /// @throw invalid_argument if the scan and lut sizes differ or if the scan
+    /// has no such pixel field
+    /// @throw runtime_error if the file is closed
+    OUSTER_API_FUNCTION void write(
+        const LidarScan& scan,         ///< [in] scan with a RANGE field
+        const XYZLut& lut,             ///< [in] lut from make_xyz_lut
+        const std::string& key_field,  ///< [in] field to take the keys from
+        double min_z = -std::numeric_limits<double>::infinity(),  ///< [in]
+        ///< dewarped points below are left out
+        double max_z = std::numeric_limits<double>::infinity());  ///< [in]
+    ///< dewarped points above are left out
+
+    /// Write the pending blocks, fill in the header and close the file.
+    /// Further calls do nothing.
+    ///
+    /// @throw runtime_error if writing fails, or rethrow the error of a block
+    OUSTER_API_FUNCTION void close();
+
+    /// Wait for the pending blocks and write them.
+    OUSTER_API_FUNCTION void flush();
+
+    /// @return the number of points written to the file so far, not counting
+    /// pending blocks
+    OUSTER_API_FUNCTION size_t points_written() const;
+
+    /// @return false once closed
+    OUSTER_API_FUNCTION bool is_open() const;
+
+   private:
+    std::unique_ptr<point_cloud_writer_impl> impl;
+};
+
+}  // namespace ouster
@@ -0,0 +1,101 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Neighborhood operations on destaggered range images
+ */
+
+#pragma once
+
+#include <Eigen/Core>
+#include <cstdint>
+#include <limits>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/types.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+/// Minimum of every pixel over a window of rows x cols pixels centered on it,
+/// computed as a pass over rows and then over columns, each taking the
+/// minimum of shifted contiguous rows. The window is cut at the top and
+/// bottom rows and wraps around the columns of a full rotation if
+/// wrap_columns, or is cut at the first and last columns otherwise.
+///
+/// @throw invalid_argument if rows or cols isn't a positive odd number
+///
+/// @return the filtered image
+template <typename T>
+OUSTER_API_FUNCTION img_t<T> min_filter(
+    const Eigen::Ref<const img_t<T>>& img,  ///< [in] destaggered image
+    int rows,                               ///< [in] window height
+    int cols,                               ///< [in] window width
+    bool ignore_zeros = false,  ///< [in] leave out zero pixels, as of empty
+                                ///< returns, 0 where all of a window is zero
+    bool wrap_columns = true);  ///< [in] wrap the window around columns
+
+/// Maximum of every pixel over a window, see min_filter().
+///
+/// @throw invalid_argument if rows or cols isn't a positive odd number
+///
+/// @return the filtered image
+template <typename T>
+OUSTER_API_FUNCTION img_t<T> max_filter(
+    const Eigen::Ref<const img_t<T>>& img,  ///< [in] destaggered image
+    int rows,                               ///< [in] window height
+    int cols,                               ///< [in] window width
+    bool ignore_zeros = false,  ///< [in] leave out zero pixels, as of empty
+                                ///< returns, 0 where all of a window is zero
+    bool wrap_columns = true);  ///< [in] wrap the window around columns
+
+/// Median of every pixel over a window, with the window borders of
+/// min_filter(). The median of an even number of values is the lower one.
+///
+/// @throw invalid_argument if rows or cols isn't a positive odd number
+///
+/// @return the filtered image
+template <typename T>
+OUSTER_API_FUNCTION img_t<T> median_filter(
+    const Eigen::Ref<const img_t<T>>& img,  ///< [in] destaggered image
+    int rows,                               ///< [in] window height
+    int cols,                               ///< [in] window width
+    bool ignore_zeros = false,  ///< [in] leave out zero pixels, as of empty
+                                ///< returns, 0 where all of a window is zero
+    bool wrap_columns = true);  ///< [in] wrap the window around columns
+
+/// Estimates the surface normal at every pixel of a scan with a nonzero range
+/// from the points of its neighbors in the destaggered range image: the
+/// direction of least variance of the points of a window x window
+/// neighborhood, including the pixel itself, with a nonzero range and within
+/// max_distance of the point of the pixel. Normals face the origin of the lut
+/// frame.
+///
+/// @throw invalid_argument if window isn't an odd number of at least 3, if
+/// the sizes of the scan and lut don't match or if the scan has no sensor
+/// info to destagger with
+///
+/// @return unit normals of shape (w * h, 3) in the pixel order of the scan,
+/// as cartesian(), zero for pixels with a zero range or fewer than 3 points
+/// in their neighborhood
+OUSTER_API_FUNCTION pose_util::Points range_image_normals(
+    const LidarScan& scan,  ///< [in] scan with a RANGE field
+    const XYZLut& lut,      ///< [in] lut from make_xyz_lut
+    int window = 3,         ///< [in] width and height of the neighborhood
+    double max_distance =
+        std::numeric_limits<double>::infinity());  ///< [in] in lut units
+
+/// Labels the connected components of the pixels of a destaggered range image
+/// with a nonzero range, where pixels sharing an edge are connected when their
+/// ranges differ by at most max_step.
+///
+/// @return labels from 1 in the row major order of the first pixel of each
+/// component, 0 for zero ranges
+OUSTER_API_FUNCTION img_t<uint32_t> connected_components(
+    const Eigen::Ref<const img_t<uint32_t>>& range,  ///< [in] destaggered
+                                                     ///< range image
+    uint32_t max_step,          ///< [in] largest range step within components
+    bool wrap_columns = true);  ///< [in] connect the first and last columns
+
+}  // namespace ouster
@@ -0,0 +1,135 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Batch lidar packets into scans of arbitrary column or time windows
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/packet.h"
+#include "ouster/types.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+/// Where the scans of a ReframingBatcher start and end
+struct OUSTER_API_CLASS ReframeWindow {
+    /// Columns of each scan, columns_per_frame if zero. A multiple of
+    /// columns_per_packet.
+    size_t width{0};
+
+    /// Column of the frame the scans start at. Scans follow each other every
+    /// width columns, across frames.
+    size_t start_col{0};
+
+    /// If not zero, scans start at times rather than columns: at the first
+    /// valid column at or after each multiple of period_ns, offset by
+    /// offset_ns, so that the scans of sensors sharing a clock line up.
+    /// Columns beyond width are dropped.
+    uint64_t period_ns{0};
+
+    /// Offset of the time windows from multiples of period_ns, in ns
+    uint64_t offset_ns{0};
+};
+
+/// Batches lidar packets straight into scans of a window of columns other
+/// than the frames of the sensor, e.g. starting at another azimuth or at
+/// time boundaries aligned across sensors, instead of batching frames and
+/// stitching two of them together afterwards.
+///
+/// Every column is placed by its position in the stream of columns of the
+/// sensor, frame_id * columns_per_frame + measurement_id, so that windows
+/// span frames and may be wider or narrower than them. Column k of a scan
+/// holds the k-th column of its window, with its measurement_id, timestamp
+/// and status; packet headers are kept per columns_per_packet columns of the
+/// scan and frame_id is that of the frame the window starts in. Columns
+/// missing from a window are zeroed, columns arriving after their window was
+/// handed out are dropped. RAW_HEADERS is left zeroed.
+///
+///     ReframingBatcher batch(info, {0, 512});  // start at half a turn
+///     LidarScan scan(batch.scan_width(), info.format.pixels_per_column,
+///                    info.format.udp_profile_lidar,
+///                    info.format.columns_per_packet);
+///     // for each packet
+///     if (batch(packet, scan)) { ... }
+///
+/// Like ScanBatcher, the packet completing a window is kept and batched into
+/// the next scan on the next call.
+class OUSTER_API_CLASS ReframingBatcher {
+   public:
+    /// @throw invalid_argument if the width is not a multiple of
+    ///        columns_per_packet or start_col is out of range
+    OUSTER_API_FUNCTION ReframingBatcher(
+        const sensor::sensor_info& info,  ///< [in] metadata of the sensor
+        const ReframeWindow& window = {}  ///< [in] windows of the scans
+    );
+
+    /// Add a packet to the scan.
+    /// @throw invalid_argument if the scan doesn't have scan_width() columns
+    ///        and the rows of the sensor
+    /// @return true when the scan is complete, as a column of the next window
+    ///         arrived
+    OUSTER_API_FUNCTION bool operator()(
+        const sensor::LidarPacket& packet,  ///< [in] the packet
+        LidarScan& ls                       ///< [in,out] scan to fill in
+    );
+
+    /// Finish the scan being batched without waiting for the rest of its
+    /// window, e.g. the last scan of a recording, zeroing the columns no
+    /// packet wrote to.
+    /// @return true if a scan was being batched
+    OUSTER_API_FUNCTION bool finish_scan(LidarScan& ls  ///< [in,out] the scan
+    );
+
+    /// @return the number of columns of the scans
+    OUSTER_API_FUNCTION size_t scan_width() const;
+
+    /// @return the windows of the scans, with the width filled in
+    OUSTER_API_FUNCTION const ReframeWindow& window() const;
+
+    /// @return the number of valid columns dropped as they arrived after
+    ///         their window or beyond its width
+    OUSTER_API_FUNCTION uint64_t dropped_columns() const;
+
+   private:
+    // place the columns of a packet from the icol-th on, returning the index
+    // of the column that completed the scan or -1
+    int batch_columns(const sensor::LidarPacket& packet, int icol,
+                      LidarScan& ls, bool may_complete);
+    void start_scan(const uint8_t* packet_buf, LidarScan& ls);
+    void end_scan(LidarScan& ls);
+    int64_t unwrap_frame(uint32_t frame_id);
+
+    std::shared_ptr<sensor::sensor_info> info_;
+    sensor::packet_format pf_;
+    std::vector<std::pair<std::string, FieldHandle>> pf_fields_;
+    ReframeWindow window_;
+    size_t frame_w_;
+
+    // frames since the first packet, unwrapping the frame_id of packets
+    int64_t frame_{0};
+    int64_t last_frame_id_{-1};
+
+    // the scan being batched, by the stream index of its first column, and
+    // the window it is in
+    bool batching_{false};
+    int64_t scan_start_{0};
+    int64_t scan_window_{0};
+    size_t next_col_{0};
+
+    sensor::LidarPacket cache_;
+    int cache_col_{-1};
+    uint64_t dropped_{0};
+};
+
+}  // namespace ouster
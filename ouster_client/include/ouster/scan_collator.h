@@ -0,0 +1,73 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Group the scans of several sensors into frames by time
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+/// Collates a stream of scans of several sensors into frames holding at most
+/// one scan per sensor, the same way as collate_scans of the python SDK.
+///
+/// A frame is cut when a scan starts dt or more after the earliest scan of the
+/// frame, or more than dt before the latest one, when its sensor already has a
+/// scan in the frame, or once every sensor has one. Scans are timed by their
+/// first valid packet timestamp, so the sensors are expected to be time
+/// synchronized, e.g. by PTP.
+class OUSTER_API_CLASS ScanCollator {
+   public:
+    /// Scans of a frame indexed by sensor, null for sensors without one
+    using Frame = std::vector<std::unique_ptr<LidarScan>>;
+
+    /// @throw invalid_argument if sensors_count is zero
+    OUSTER_API_FUNCTION ScanCollator(
+        size_t sensors_count,     ///< [in] number of sensors
+        int64_t dt = 210000000);  ///< [in] max time difference in ns between
+                                  ///< the scans of a frame
+
+    /// Add the next scan of the stream, possibly finishing frames
+    /// @throw invalid_argument if sensor_idx is out of range or scan is null
+    OUSTER_API_FUNCTION void push(
+        size_t sensor_idx,                ///< [in] sensor the scan came from
+        std::unique_ptr<LidarScan> scan);  ///< [in] the scan
+
+    /// Finish the frame being collated, if it holds any scan, at the end of
+    /// the stream
+    OUSTER_API_FUNCTION void flush();
+
+    /// Check whether a finished frame is waiting to be popped
+    OUSTER_API_FUNCTION bool ready() const;
+
+    /// Take the oldest finished frame
+    /// @throw runtime_error if none is ready
+    OUSTER_API_FUNCTION Frame pop();
+
+    /// Get the number of sensors
+    OUSTER_API_FUNCTION size_t sensors_count() const;
+
+   private:
+    size_t sensors_count_;
+    int64_t dt_;
+    bool started_{false};
+    int64_t min_ts_{0};
+    int64_t max_ts_{0};
+    Frame collated_;
+    size_t collated_count_{0};
+    std::deque<Frame> frames_;
+
+    void cut();
+};
+
+}  // namespace ouster
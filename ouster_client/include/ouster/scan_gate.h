@@ -0,0 +1,117 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Motion gating of scans before recording them
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ouster/imu_batcher.h"
+#include "ouster/lidar_scan.h"
+#include "ouster/types.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+/// When a ScanGate lets scans through
+struct OUSTER_API_CLASS ScanGateOptions {
+    /// Compare every stride-th row and column of the range images
+    size_t stride{8};
+    /// A sampled pixel changed if its range moved by more, in mm
+    uint32_t min_range_change{100};
+    /// Keep a scan once this fraction of the sampled pixels with a return
+    /// in either scan changed since the last scan kept
+    double min_changed_fraction{0.02};
+    /// Keep a scan at least this often, in seconds of scan timestamps,
+    /// e.g. 1.0 to record at least a keyframe per second while idle
+    double keyframe_interval{1.0};
+    /// Keep a scan if the IMU turned faster than this, in rad/s, or with a
+    /// specific force this far from gravity, in m/s^2, during the scan
+    double min_angular_velocity{0.05};
+    double min_accel_change{0.3};  ///< see min_angular_velocity
+};
+
+/// Consecutive scans left out by a ScanGate
+struct OUSTER_API_CLASS SkippedSpan {
+    int64_t first_frame_id{0};  ///< frame_id of the first scan left out
+    int64_t last_frame_id{0};   ///< frame_id of the last scan left out
+    uint64_t first_ts{0};  ///< first valid column timestamp of the first
+                           ///< scan left out, in ns
+    uint64_t last_ts{0};   ///< same, of the last scan left out
+    uint64_t count{0};     ///< number of scans left out
+
+    /// @return true if the spans are equal
+    OUSTER_API_FUNCTION bool operator==(const SkippedSpan& other) const;
+};
+
+/// Decides which scans of a sensor are worth recording, e.g. in front of an
+/// osf::Writer, leaving out those nearly identical to the last scan kept
+/// while a vehicle is parked or a static sensor watches an empty scene:
+///
+///     ScanGate gate;
+///     // for each scan
+///     if (gate.admit(scan)) writer.save(0, scan);
+///
+/// The range image is sampled on a sparse grid and compared to the samples
+/// of the last scan kept, so that slow drift eventually keeps a scan too.
+/// Scans are kept when enough samples changed, when the IMU batch of the
+/// scan shows motion, and at least once per keyframe_interval. Scans without
+/// a RANGE field, of another size than the last one kept or going back in
+/// time are always kept.
+class OUSTER_API_CLASS ScanGate {
+   public:
+    /// @throw invalid_argument if the stride is 0 or an option is negative
+    OUSTER_API_FUNCTION explicit ScanGate(
+        const ScanGateOptions& options = {}  ///< [in] when to keep scans
+    );
+
+    /// Decide whether to keep a scan, recording it as skipped otherwise
+    /// @return true if the scan should be recorded
+    OUSTER_API_FUNCTION bool admit(
+        const LidarScan& scan,         ///< [in] next scan of the sensor
+        const ImuBatch* imu = nullptr  ///< [in] IMU samples of the scan
+    );
+
+    /// @return the fraction of samples changed at the last admit(), 1 if
+    ///         it had nothing to compare against
+    OUSTER_API_FUNCTION double last_change() const;
+
+    /// @return the number of scans kept
+    OUSTER_API_FUNCTION uint64_t kept() const;
+
+    /// @return the number of scans left out
+    OUSTER_API_FUNCTION uint64_t skipped() const;
+
+    /// @return the runs of scans left out, in order
+    OUSTER_API_FUNCTION const std::vector<SkippedSpan>& skipped_spans() const;
+
+    /// @return the options of the gate
+    OUSTER_API_FUNCTION const ScanGateOptions& options() const;
+
+    /// Forget the last scan kept and the scans left out
+    OUSTER_API_FUNCTION void reset();
+
+   private:
+    bool moving(const ImuBatch& imu) const;
+
+    ScanGateOptions options_;
+    std::vector<uint32_t> reference_;
+    std::vector<uint32_t> samples_;
+    size_t w_{0};
+    size_t h_{0};
+    uint64_t last_kept_ts_{0};
+    bool has_reference_{false};
+    bool in_span_{false};
+    double last_change_{1.0};
+    uint64_t kept_{0};
+    uint64_t skipped_{0};
+    std::vector<SkippedSpan> spans_;
+};
+
+}  // namespace ouster
@@ -0,0 +1,129 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Ring of the latest scans of a sensor, looked up by time
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/scan_pool.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+/// Fixed capacity history of the latest scans of one sensor, ordered by the
+/// timestamp of their first valid column, for trackers and accumulators
+/// that need the last N scans or the scan at some time.
+///
+/// Scans are handed out as read-only shared handles without copying them; a
+/// handle keeps its scan alive after the history drops it. Copies of pushed
+/// scans are made into scans of a ScanPool when the history has one, and
+/// scans are released to the pool once dropped by the history and all
+/// handles, so a steady stream of scans doesn't allocate.
+///
+/// All methods are thread-safe.
+class OUSTER_API_CLASS ScanHistory {
+   public:
+    /// A scan of the history
+    using Handle = std::shared_ptr<const LidarScan>;
+
+    /// Construct an empty history
+    /// @throw std::invalid_argument if capacity is zero
+    OUSTER_API_FUNCTION explicit ScanHistory(
+        size_t capacity,  ///< [in] most scans kept
+        std::shared_ptr<ScanPool> pool =
+            nullptr  ///< [in] if set, pool of the scans pushed by copy and
+                     ///< of the scans dropped by the history
+    );
+
+    ScanHistory(const ScanHistory&) = delete;
+    ScanHistory& operator=(const ScanHistory&) = delete;
+
+    /// Add a copy of a scan, dropping the oldest scan when full. The copy is
+    /// made into a scan of the pool when the scan matches it.
+    /// @return false, without adding it, if the scan has no valid column or
+    /// is older than the latest scan of the history
+    OUSTER_API_FUNCTION bool push(const LidarScan& scan  ///< [in] scan to add
+    );
+
+    /// Add a scan without copying it, dropping the oldest scan when full,
+    /// e.g. one acquired from the pool and filled by a ScanBatcher. Scans
+    /// are released to the pool once dropped.
+    /// @throw std::invalid_argument if the scan is null
+    /// @return false, dropping the scan, if it has no valid column or is
+    /// older than the latest scan of the history
+    OUSTER_API_FUNCTION bool push(
+        std::unique_ptr<LidarScan> scan  ///< [in] scan to add
+    );
+
+    /// Get the scans from the oldest to the latest
+    /// @return at most n of the latest scans, the latest one last
+    OUSTER_API_FUNCTION std::vector<Handle> latest(
+        size_t n  ///< [in] most scans to return
+    ) const;
+
+    /// Get a scan by age
+    /// @return the scan pushed i scans before the latest one, null if there
+    /// are fewer scans
+    OUSTER_API_FUNCTION Handle back(size_t i = 0  ///< [in] age of the scan
+    ) const;
+
+    /// Get the scan taken at some time: the latest scan whose first valid
+    /// column timestamp isn't after ts
+    /// @return the scan, null if all scans are after ts
+    OUSTER_API_FUNCTION Handle at_time(uint64_t ts  ///< [in] time, in ns
+    ) const;
+
+    /// Get the scan whose first valid column timestamp is closest to ts,
+    /// the earlier one on ties
+    /// @return the scan, null if the history is empty
+    OUSTER_API_FUNCTION Handle nearest(uint64_t ts  ///< [in] time, in ns
+    ) const;
+
+    /// Get the scans whose first valid column timestamp is in [begin, end]
+    /// @return the scans, from the oldest to the latest
+    OUSTER_API_FUNCTION std::vector<Handle> between(
+        uint64_t begin,  ///< [in] earliest time, in ns
+        uint64_t end     ///< [in] latest time, in ns
+    ) const;
+
+    /// Drop all scans
+    OUSTER_API_FUNCTION void clear();
+
+    /// @return the number of scans held
+    OUSTER_API_FUNCTION size_t size() const;
+
+    /// @return the most scans held
+    OUSTER_API_FUNCTION size_t capacity() const;
+
+   private:
+    struct Entry {
+        uint64_t ts;
+        Handle scan;
+    };
+
+    // whether a scan taken at ts may be added after the latest scan
+    bool accepts(uint64_t ts) const;
+    Handle share(std::unique_ptr<LidarScan> scan) const;
+    // index in ring_ of the i-th scan from the oldest
+    size_t slot(size_t i) const;
+    // number of scans from the oldest with a timestamp <= ts
+    size_t upper_bound(uint64_t ts) const;
+
+    mutable std::mutex mutex_;
+    std::shared_ptr<ScanPool> pool_;
+    std::vector<Entry> ring_;
+    size_t first_{0};
+    size_t size_{0};
+};
+
+}  // namespace ouster
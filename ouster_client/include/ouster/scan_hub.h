@@ -0,0 +1,193 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Fan-out of scans to several consumers in one process
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/scan_view.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+namespace impl {
+struct hub_subscriber;
+}  // namespace impl
+
+/// What a ScanSubscription does with a scan published while it is full
+enum class DropPolicy {
+    /// Drop the oldest queued scan to make room, so the subscriber always
+    /// sees the latest scans, e.g. for a viz
+    DROP_OLDEST,
+    /// Drop the new scan, so the subscriber sees an unbroken run of scans
+    /// once it catches up, e.g. for a recorder with a deep queue
+    DROP_NEWEST
+};
+
+/// The queue of one consumer of a ScanHub. Unsubscribes when destroyed.
+class OUSTER_API_CLASS ScanSubscription {
+   public:
+    /// Construct a subscription to nothing
+    OUSTER_API_FUNCTION ScanSubscription();
+
+    OUSTER_API_FUNCTION ~ScanSubscription();
+
+    ScanSubscription(const ScanSubscription&) = delete;
+    ScanSubscription& operator=(const ScanSubscription&) = delete;
+
+    /// Move a subscription
+    OUSTER_API_FUNCTION ScanSubscription(ScanSubscription&& other) noexcept;
+
+    /// Unsubscribe and move a subscription
+    /// @return this subscription
+    OUSTER_API_FUNCTION ScanSubscription& operator=(
+        ScanSubscription&& other) noexcept;
+
+    /// Take the oldest queued scan, waiting while there is none. Scans
+    /// queued before the hub closed or the subscription ended are still
+    /// handed out.
+    /// @return false if the hub is closed or the subscription ended and no
+    /// scans are left, or if the timeout expired
+    OUSTER_API_FUNCTION bool pop(
+        std::shared_ptr<const LidarScan>& scan,  ///< [out] scan taken
+        double timeout_sec = -1  ///< [in] timeout, negative for none
+    );
+
+    /// Take the oldest queued scan unless there is none
+    /// @return false if no scan was queued
+    OUSTER_API_FUNCTION bool try_pop(
+        std::shared_ptr<const LidarScan>& scan  ///< [out] scan taken
+    );
+
+    /// Take the oldest queued scan as a view of the region of the
+    /// subscription, see ScanHub::subscribe, waiting while there is none
+    /// @throw std::invalid_argument if the region lies outside of the scan
+    /// @return false like pop() of a scan
+    OUSTER_API_FUNCTION bool pop(
+        ScanView& view,          ///< [out] view of the scan taken
+        double timeout_sec = -1  ///< [in] timeout, negative for none
+    );
+
+    /// Take the oldest queued scan as a view unless there is none
+    /// @throw std::invalid_argument if the region lies outside of the scan
+    /// @return false if no scan was queued
+    OUSTER_API_FUNCTION bool try_pop(
+        ScanView& view  ///< [out] view of the scan taken
+    );
+
+    /// @return the region of the scans the views of this subscription show
+    OUSTER_API_FUNCTION const ScanViewSpec& view_spec() const;
+
+    /// Stop receiving scans. Pops still hand out the scans already queued.
+    OUSTER_API_FUNCTION void unsubscribe();
+
+    /// @return the number of queued scans
+    OUSTER_API_FUNCTION size_t size() const;
+
+    /// @return the most scans the subscription queues
+    OUSTER_API_FUNCTION size_t depth() const;
+
+    /// @return the number of scans queued for this subscription so far
+    OUSTER_API_FUNCTION uint64_t delivered() const;
+
+    /// @return the number of scans dropped by the policy of the subscription
+    OUSTER_API_FUNCTION uint64_t dropped() const;
+
+    /// @return true unless this is an empty or moved from subscription
+    OUSTER_API_FUNCTION explicit operator bool() const;
+
+   private:
+    friend class ScanHub;
+    struct Hub;
+
+    std::shared_ptr<impl::hub_subscriber> sub_;
+    std::weak_ptr<Hub> hub_;
+};
+
+/// Hands every published scan to all of its subscribers, e.g. a recorder, a
+/// viz and a perception pipeline fed by one sensor of a SensorScanSource:
+///
+///     ScanHub hub;
+///     auto viz = hub.subscribe(1, DropPolicy::DROP_OLDEST);
+///     auto recorder = hub.subscribe(64, DropPolicy::DROP_NEWEST);
+///     // producer thread
+///     while (running) {
+///         auto result = source.get_scan(0.1);
+///         if (result.second) hub.publish(std::move(result.second));
+///     }
+///
+/// Scans are shared, read-only, by the subscribers: publishing queues a
+/// reference for each of them without copying the scan. A scan is freed
+/// when the last subscriber lets go of it; to reuse scans from a ScanPool,
+/// publish them with a deleter that releases them to the pool.
+///
+/// Each subscriber has its own bounded lock free queue. Publishing never
+/// waits on a subscriber: a full queue drops a scan according to the
+/// policy of its subscriber. Subscribing and unsubscribing may happen from
+/// any thread at any time; the first publish after either takes a lock to
+/// pick up the new list of subscribers. Publish from one thread at a time.
+class OUSTER_API_CLASS ScanHub {
+   public:
+    /// Construct a hub without subscribers
+    OUSTER_API_FUNCTION ScanHub();
+
+    /// Close the hub, see close()
+    OUSTER_API_FUNCTION ~ScanHub();
+
+    ScanHub(const ScanHub&) = delete;
+    ScanHub& operator=(const ScanHub&) = delete;
+
+    /// Subscribe to the scans published from now on
+    /// @throw std::invalid_argument if depth is zero
+    /// @throw std::logic_error if the hub is closed
+    /// @return the subscription
+    OUSTER_API_FUNCTION ScanSubscription subscribe(
+        size_t depth,  ///< [in] most scans queued for the subscriber
+        DropPolicy policy =
+            DropPolicy::DROP_OLDEST  ///< [in] what to drop when full
+    );
+
+    /// Subscribe to views of the scans published from now on, e.g. every
+    /// 4th column for a viz or one beam for a health monitor, while other
+    /// subscribers get the whole scans. The views share the published scans
+    /// without copying them, see ScanView; pop them with
+    /// ScanSubscription::pop(ScanView&).
+    /// @throw std::invalid_argument if depth or a step of view is zero
+    /// @throw std::logic_error if the hub is closed
+    /// @return the subscription
+    OUSTER_API_FUNCTION ScanSubscription subscribe(
+        size_t depth,               ///< [in] most scans queued
+        DropPolicy policy,          ///< [in] what to drop when full
+        const ScanViewSpec& view    ///< [in] region of the scans to show
+    );
+
+    /// Queue a scan for every subscriber
+    /// @throw std::invalid_argument if the scan is null
+    /// @return the number of subscribers the scan was queued for
+    OUSTER_API_FUNCTION size_t publish(
+        std::shared_ptr<const LidarScan> scan  ///< [in] scan to share
+    );
+
+    /// End all subscriptions: they hand out the scans they have queued,
+    /// then their pops fail. Publishing queues nothing from now on.
+    OUSTER_API_FUNCTION void close();
+
+    /// @return the number of current subscriptions
+    OUSTER_API_FUNCTION size_t subscribers() const;
+
+    /// @return the number of scans published so far
+    OUSTER_API_FUNCTION uint64_t published() const;
+
+   private:
+    std::shared_ptr<ScanSubscription::Hub> hub_;
+};
+
+}  // namespace ouster
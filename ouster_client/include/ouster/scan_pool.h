@@ -0,0 +1,119 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Pool of reusable lidar scans of one shape
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ouster/concurrent_queue.h"
+#include "ouster/lidar_scan.h"
+#include "ouster/memory_resource.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+/// Pool of LidarScans that share the same dimensions and fields.
+///
+/// Scans handed back with release() keep their field storage and are handed
+/// out again by acquire() instead of allocating, so a steady-state producer
+/// like a ScanBatcher loop does not touch the allocator. New scans are zeroed
+/// and reused ones keep their field contents, except in pools made for the
+/// packets of a sensor: there the fields of the lidar profile are neither
+/// zeroed nor cleared, since ScanBatcher overwrites or zeroes every column of
+/// them, and only the remaining fields are zeroed on allocation and reuse.
+/// The pool is thread-safe and lock free.
+class OUSTER_API_CLASS ScanPool {
+   public:
+    /// Construct an empty pool
+    /// @throw invalid_argument if w, h or columns_per_packet is zero
+    OUSTER_API_FUNCTION ScanPool(
+        size_t w,                           ///< [in] columns per scan
+        size_t h,                           ///< [in] pixels per column
+        const LidarScanFieldTypes& fields,  ///< [in] fields of every scan
+        size_t columns_per_packet,          ///< [in] columns per packet
+        size_t capacity,                    ///< [in] most free scans to keep
+        std::shared_ptr<MemoryResource> memory =
+            nullptr  ///< [in] if set, allocate each scan contiguously, see
+                     ///< LidarScan::make_contiguous, from this resource
+    );
+
+    /// Construct an empty pool of scans that a ScanBatcher fills with the
+    /// packets of a sensor
+    /// @throw invalid_argument if the sensor format has a zero dimension
+    OUSTER_API_FUNCTION ScanPool(
+        const sensor::sensor_info& info,    ///< [in] sensor of the packets
+        const LidarScanFieldTypes& fields,  ///< [in] fields of every scan
+        size_t capacity,                    ///< [in] most free scans to keep
+        std::shared_ptr<MemoryResource> memory =
+            nullptr  ///< [in] if set, allocate each scan contiguously, see
+                     ///< LidarScan::make_contiguous, from this resource
+    );
+
+    ScanPool(const ScanPool&) = delete;
+    ScanPool& operator=(const ScanPool&) = delete;
+
+    /// Take a free scan from the pool, allocating a new one if none are free.
+    /// The scan keeps the field contents it had when it was released, other
+    /// than the fields a sensor pool zeroes, with its headers cleared by
+    /// LidarScan::clear_headers().
+    /// @return the scan
+    OUSTER_API_FUNCTION std::unique_ptr<LidarScan> acquire();
+
+    /// Hand a scan back to the pool. Scans of a different shape, e.g. with
+    /// fields added or removed since they were acquired, and scans beyond the
+    /// capacity are freed instead.
+    /// @return true if the scan was kept for reuse
+    OUSTER_API_FUNCTION bool release(
+        std::unique_ptr<LidarScan> scan  ///< [in] scan to reuse, may be null
+    );
+
+    /// Allocate free scans up front, e.g. at startup on devices where
+    /// allocating later would stall the pipeline, until count of them are
+    /// ready to be acquired or the pool is at capacity
+    /// @return the number of free scans
+    OUSTER_API_FUNCTION size_t reserve(size_t count  ///< [in] free scans
+    );
+
+    /// Check whether a scan has the dimensions and fields of this pool
+    /// @return true if the scan can be reused by the pool
+    OUSTER_API_FUNCTION bool matches(
+        const LidarScan& scan  ///< [in] scan to check
+    ) const;
+
+    /// Get the number of scans allocated by the pool so far
+    /// @return the number of allocations
+    OUSTER_API_FUNCTION size_t allocated() const;
+
+    /// Get the number of scans ready to be acquired without allocation
+    /// @return the number of free scans
+    OUSTER_API_FUNCTION size_t available() const;
+
+   private:
+    /// Allocate a new scan of the shape of the pool
+    std::unique_ptr<LidarScan> allocate();
+
+    /// Zero the fields no batcher writes
+    void zero_unbatched(LidarScan& scan) const;
+
+    size_t w_;
+    size_t h_;
+    LidarScanFieldTypes fields_;  // sorted like LidarScan::field_types
+    size_t columns_per_packet_;
+    size_t capacity_;
+    std::shared_ptr<MemoryResource> memory_;
+    bool batched_{false};  // ScanBatcher writes the fields not in unbatched_
+    std::vector<std::string> unbatched_;  // zeroed on allocation and reuse
+    MpmcQueue<std::unique_ptr<LidarScan>> free_;
+    std::atomic<size_t> allocated_{0};
+};
+
+}  // namespace ouster
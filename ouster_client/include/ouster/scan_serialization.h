@@ -0,0 +1,135 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Versioned binary serialization of LidarScans
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/lossy_codec.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+/// A piece of a serialized scan, e.g. for one iovec of writev or sendmsg
+struct OUSTER_API_CLASS ScanChunk {
+    const void* data;  ///< start of the bytes
+    size_t size;       ///< number of bytes
+};
+
+/// Lays out a LidarScan for sending to another process or over the network
+/// without copying its fields.
+///
+/// A serialized scan is a 64 byte header, the field table, the binary
+/// sensor_info of the scan if it has one (see sensor_info_to_binary) and the
+/// fields and headers of the scan laid out as LidarScan::make_contiguous does,
+/// starting on a 64 byte boundary. The field table has the same encoding as
+/// the one of ShmScanWriter channels. Values are in the byte order of the
+/// host.
+///
+/// The chunks of a contiguous scan are the serialized header and the arena of
+/// the scan; other scans take a chunk per field. The chunks point into the
+/// scan, which must not be modified or destroyed while they are in use.
+class OUSTER_API_CLASS ScanSerializer {
+   public:
+    /// Lay out a scan
+    OUSTER_API_FUNCTION explicit ScanSerializer(
+        const LidarScan& scan  ///< [in] scan to serialize
+    );
+
+    ScanSerializer(const ScanSerializer&) = delete;
+    ScanSerializer& operator=(const ScanSerializer&) = delete;
+    ScanSerializer(ScanSerializer&&) = default;
+    ScanSerializer& operator=(ScanSerializer&&) = default;
+
+    /// @return the size of the serialized scan, in bytes
+    OUSTER_API_FUNCTION size_t size() const;
+
+    /// @return the pieces of the serialized scan, in order
+    OUSTER_API_FUNCTION const std::vector<ScanChunk>& chunks() const;
+
+    /// Gather the chunks into a buffer
+    OUSTER_API_FUNCTION void copy_to(
+        uint8_t* out  ///< [out] buffer of at least size() bytes
+    ) const;
+
+   private:
+    std::vector<uint8_t> head_;
+    std::vector<ScanChunk> chunks_;
+    size_t size_{0};
+};
+
+/// Serialize a scan into one buffer
+///
+/// The listed pixel fields of unsigned integers are encoded by encode_lossy
+/// within their largest error, e.g. RANGE for a slow uplink, and zeroed in
+/// the arena, which is then compressed whatever compress is. Other fields
+/// and fields the scan doesn't have are left alone.
+///
+/// @return the serialized scan, with its fields and headers compressed in
+///         the LZ4 block format if compress is true
+OUSTER_API_FUNCTION std::vector<uint8_t> serialize_scan(
+    const LidarScan& scan,        ///< [in] scan to serialize
+    bool compress = false,        ///< [in] compress the fields and headers
+    const LossyFields& lossy = {}  ///< [in] largest error of lossy fields
+);
+
+/// Get the size of a serialized scan from its first 64 bytes, e.g. to know
+/// how much more to read from a stream
+/// @throw std::invalid_argument if the bytes are not the header of a
+///        serialized scan of a version this library reads
+/// @return the size of the serialized scan, header included
+OUSTER_API_FUNCTION size_t serialized_scan_size(
+    const uint8_t* data,  ///< [in] start of a serialized scan
+    size_t size           ///< [in] bytes available at data, at least 64
+);
+
+/// Deserialize a scan into a new contiguous scan, decompressing it if needed
+/// @throw std::invalid_argument if the data is not a serialized scan, is
+///        truncated or is corrupt
+/// @return the scan
+OUSTER_API_FUNCTION LidarScan deserialize_scan(
+    const uint8_t* data,  ///< [in] serialized scan
+    size_t size           ///< [in] bytes at data
+);
+
+/// Deserialize an uncompressed scan without copying: the fields and headers
+/// of the scan point into the buffer, which the scan keeps alive. Writing to
+/// the scan writes to the buffer; copies of the scan own their memory.
+/// @throw std::invalid_argument as deserialize_scan, or if the scan is
+///        compressed, including lossily, or the data isn't aligned to 8
+///        bytes
+/// @return the scan
+OUSTER_API_FUNCTION LidarScan view_serialized_scan(
+    std::shared_ptr<uint8_t> data,  ///< [in] serialized scan
+    size_t size                     ///< [in] bytes at data
+);
+
+namespace impl {
+
+/// Encode field types as the field tables of serialized scans and shared
+/// memory channels
+/// @return the encoded field types
+OUSTER_API_FUNCTION std::vector<uint8_t> field_types_to_binary(
+    const LidarScanFieldTypes& types  ///< [in] field types to encode
+);
+
+/// Decode field types encoded by field_types_to_binary
+/// @throw std::runtime_error if the table is truncated or has a field of an
+///        unknown type or class
+/// @return the field types
+OUSTER_API_FUNCTION LidarScanFieldTypes field_types_from_binary(
+    const uint8_t* data,  ///< [in] encoded field types
+    size_t size           ///< [in] bytes at data
+);
+
+}  // namespace impl
+}  // namespace ouster
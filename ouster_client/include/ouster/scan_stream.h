@@ -0,0 +1,155 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Stream LidarScans to remote consumers over TCP
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/types.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+/// What a ScanStreamClient asks the server to send it
+struct OUSTER_API_CLASS ScanStreamRequest {
+    /// Fields to send, or empty for all fields of the scans
+    std::vector<std::string> fields{};
+
+    /// Send one scan in this many, by frame_id, e.g. 2 for 5 Hz out of a
+    /// 10 Hz sensor
+    uint32_t decimation{1};
+
+    /// Compress the fields and headers of the scans, see serialize_scan
+    bool compress{true};
+
+    /// Largest error of the RANGE and RANGE2 fields, in mm, for links too
+    /// slow for lossless scans, or 0 to send them losslessly. The ranges are
+    /// encoded by encode_lossy and the scans compressed whatever compress is.
+    uint32_t max_range_error{0};
+
+    /// Most scans waiting for the link. A client falling behind skips to the
+    /// latest scans: the default of 1 only ever sends the newest scan.
+    uint32_t queue_depth{1};
+};
+
+/// Counters of a ScanStreamServer, over all clients so far
+struct OUSTER_API_CLASS ScanStreamStats {
+    uint64_t clients{0};        ///< clients accepted
+    uint64_t rejected{0};       ///< clients turned away by a bad request
+    uint64_t scans_sent{0};     ///< scans sent
+    uint64_t bytes_sent{0};     ///< bytes of the scans sent
+    uint64_t scans_dropped{0};  ///< scans skipped for clients falling behind
+};
+
+/// Serves the scans published to it to clients connecting over TCP, see
+/// ScanStreamClient, e.g. from a vehicle to a remote operator station:
+///
+///     ScanStreamServer server(info, 7510);
+///     while (running) {
+///         auto result = source.get_scan(0.1);
+///         if (result.second) server.publish(std::move(result.second));
+///     }
+///
+/// Each client asks for its own fields, decimation and compression and is
+/// sent the scans on a thread of its own, fed by a ScanHub subscription that
+/// drops the oldest scans when the client falls behind. A slow link thus
+/// gets the latest scans rather than an ever growing backlog, and never
+/// holds up publish or the other clients.
+///
+/// Scans are sent as serialize_scan lays them out, compressed in the LZ4
+/// block format and with error bounded ranges if the client asks for it.
+class OUSTER_API_CLASS ScanStreamServer {
+   public:
+    /// Listen for clients
+    /// @throw runtime_error if the port can't be bound
+    OUSTER_API_FUNCTION ScanStreamServer(
+        const sensor::sensor_info& info,  ///< [in] sensor of the scans
+        int port = 0,  ///< [in] TCP port, or 0 for an ephemeral port
+        const std::string& address =
+            ""  ///< [in] address to listen on, or empty for all
+    );
+
+    /// Close the server, see close()
+    OUSTER_API_FUNCTION ~ScanStreamServer();
+
+    ScanStreamServer(const ScanStreamServer&) = delete;
+    ScanStreamServer& operator=(const ScanStreamServer&) = delete;
+
+    /// Queue a scan for every connected client
+    /// @throw invalid_argument if the scan is null
+    /// @return the number of clients the scan was queued for
+    OUSTER_API_FUNCTION size_t publish(
+        std::shared_ptr<const LidarScan> scan  ///< [in] scan to send
+    );
+
+    /// Disconnect the clients and stop listening
+    OUSTER_API_FUNCTION void close();
+
+    /// @return the port the server listens on
+    OUSTER_API_FUNCTION int port() const;
+
+    /// @return the number of connected clients
+    OUSTER_API_FUNCTION size_t clients() const;
+
+    /// @return the counters of the server
+    OUSTER_API_FUNCTION ScanStreamStats stats() const;
+
+   private:
+    struct Impl;
+    std::shared_ptr<Impl> impl_;
+};
+
+/// Receives the scans of a ScanStreamServer
+class OUSTER_API_CLASS ScanStreamClient {
+   public:
+    /// Connect to a server and send the request
+    /// @throw runtime_error if the server can't be reached or turns down the
+    ///        request, e.g. for a field its scans don't have
+    OUSTER_API_FUNCTION ScanStreamClient(
+        const std::string& host,  ///< [in] hostname or address of the server
+        int port,                 ///< [in] TCP port of the server
+        const ScanStreamRequest& request =
+            ScanStreamRequest{},  ///< [in] what to send
+        double timeout_sec = 5    ///< [in] timeout to connect and on reads
+    );
+
+    /// Disconnect
+    OUSTER_API_FUNCTION ~ScanStreamClient();
+
+    ScanStreamClient(const ScanStreamClient&) = delete;
+    ScanStreamClient& operator=(const ScanStreamClient&) = delete;
+
+    /// @return the sensor of the scans, as sent by the server
+    OUSTER_API_FUNCTION const sensor::sensor_info& sensor_info() const;
+
+    /// Receive the next scan
+    /// @throw runtime_error if the connection fails or the server sends
+    ///        something other than a scan
+    /// @return the scan, or null on timeout or once the server closed the
+    ///         stream, see closed()
+    OUSTER_API_FUNCTION std::unique_ptr<LidarScan> get_scan(
+        double timeout_sec = -1  ///< [in] timeout, negative for none
+    );
+
+    /// @return true once the server closed the stream or close() was called
+    OUSTER_API_FUNCTION bool closed() const;
+
+    /// Disconnect
+    OUSTER_API_FUNCTION void close();
+
+   private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace ouster
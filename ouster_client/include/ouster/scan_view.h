@@ -0,0 +1,148 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Strided and cropped views of shared scans
+ */
+
+#pragma once
+
+#include <Eigen/Core>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+/// The rows and columns of a scan a ScanView shows: every row_step-th of
+/// rows rows from first_row, and every col_step-th of cols columns from
+/// first_col, e.g. {0, 0, 1, 0, 0, 4} for every 4th column or {7, 1} for
+/// the 8th beam. Rows and columns are those of the staggered fields.
+struct OUSTER_API_CLASS ScanViewSpec {
+    size_t first_row = 0;  ///< first row shown
+    size_t rows = 0;       ///< rows spanned, 0 for up to the last one
+    size_t row_step = 1;   ///< distance between the rows shown
+    size_t first_col = 0;  ///< first column shown
+    size_t cols = 0;       ///< columns spanned, 0 for up to the last one
+    size_t col_step = 1;   ///< distance between the columns shown
+};
+
+/// A read-only view of a region of a scan, every few rows and columns of
+/// it, sharing the scan rather than copying it. Fields and headers are
+/// read through strided Eigen maps into the memory of the scan, which the
+/// view keeps alive. materialize() copies the region into a compact scan
+/// when one is needed, e.g. to hand to code taking a LidarScan.
+class OUSTER_API_CLASS ScanView {
+   public:
+    /// Strides of a pixel field view, between rows and columns
+    using Stride = Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>;
+
+    /// View of a 2D pixel field
+    template <typename T>
+    using img_view_t = Eigen::Map<const img_t<T>, Eigen::Unaligned, Stride>;
+
+    /// View of a column header
+    template <typename T>
+    using header_view_t = Eigen::Map<const LidarScan::Header<T>,
+                                     Eigen::Unaligned, Eigen::InnerStride<>>;
+
+    /// Construct a view of nothing
+    OUSTER_API_FUNCTION ScanView();
+
+    /// Construct a view of a region of a scan
+    /// @throw std::invalid_argument if the scan is null, a step is zero or
+    /// the region starts or ends outside of the scan
+    OUSTER_API_FUNCTION ScanView(
+        std::shared_ptr<const LidarScan> scan,  ///< [in] scan to share
+        const ScanViewSpec& spec = {}           ///< [in] region to show
+    );
+
+    /// @return the scan viewed
+    const std::shared_ptr<const LidarScan>& scan() const { return scan_; }
+
+    /// @return the region shown, with rows and cols resolved
+    const ScanViewSpec& spec() const { return spec_; }
+
+    /// @return the number of columns shown
+    size_t w() const { return w_; }
+
+    /// @return the number of rows shown
+    size_t h() const { return h_; }
+
+    /// @return the row of the scan of a row of the view
+    size_t row(size_t i  ///< [in] row of the view
+    ) const {
+        return spec_.first_row + i * spec_.row_step;
+    }
+
+    /// @return the column of the scan of a column of the view
+    size_t col(size_t j  ///< [in] column of the view
+    ) const {
+        return spec_.first_col + j * spec_.col_step;
+    }
+
+    /**
+     * Access the shown pixels of a 2D pixel field.
+     *
+     * @tparam T The type parameter T must match the dynamic type of the field.
+     *
+     * @param[in] name the field to view.
+     *
+     * @return an h() x w() view of the field data.
+     */
+    template <typename T>
+    img_view_t<T> field(const std::string& name) const {
+        Eigen::Ref<const img_t<T>> img = scan_->field<T>(name);
+        const T* first = img.data() + spec_.first_row * img.cols() +
+                         spec_.first_col;
+        return img_view_t<T>(
+            first, h_, w_, Stride(img.cols() * spec_.row_step, spec_.col_step));
+    }
+
+    /// @return a view of the measurement timestamps of the shown columns
+    header_view_t<uint64_t> timestamp() const {
+        return header(scan_->timestamp());
+    }
+
+    /// @return a view of the measurement ids of the shown columns
+    header_view_t<uint16_t> measurement_id() const {
+        return header(scan_->measurement_id());
+    }
+
+    /// @return a view of the status of the shown columns
+    header_view_t<uint32_t> status() const { return header(scan_->status()); }
+
+    /**
+     * Copy the region into a compact scan. Pixel fields keep the shown
+     * pixels, column fields, headers and poses the shown columns, and
+     * packet fields and headers the packets of the shown columns, with
+     * columns_per_packet divided by the column step. Other fields are
+     * copied whole. The sensor info is left unset since it no longer
+     * describes the scan.
+     *
+     * @return the scan of the region
+     */
+    OUSTER_API_FUNCTION LidarScan materialize() const;
+
+    /// @return true unless this is an empty view
+    explicit operator bool() const { return scan_ != nullptr; }
+
+   private:
+    template <typename T>
+    header_view_t<T> header(Eigen::Ref<const LidarScan::Header<T>> h) const {
+        return header_view_t<T>(h.data() + spec_.first_col, w_,
+                                Eigen::InnerStride<>(spec_.col_step));
+    }
+
+    std::shared_ptr<const LidarScan> scan_;
+    ScanViewSpec spec_;
+    size_t w_{0};
+    size_t h_{0};
+};
+
+}  // namespace ouster
@@ -10,21 +10,28 @@
 
 #pragma once
 
-#include <condition_variable>
+#include <atomic>
 #include <cstdint>
 #include <deque>
+#include <functional>
 #include <memory>
-#include <mutex>
 #include <numeric>
 #include <thread>
 #include <vector>
 
 #include "ouster/client.h"
+#include "ouster/concurrent_queue.h"
+#include "ouster/impl/client_poller.h"
+#include "ouster/impl/iocp_receiver.h"
 #include "ouster/impl/netcompat.h"
+#include "ouster/impl/packet_capture.h"
 #include "ouster/impl/ring_buffer.h"
+#include "ouster/latency_histogram.h"
 #include "ouster/lidar_scan.h"
 #include "ouster/packet.h"
+#include "ouster/packet_pool.h"
 #include "ouster/sensor_http.h"
+#include "ouster/threads.h"
 #include "ouster/types.h"
 #include "ouster/visibility.h"
 
@@ -57,12 +64,24 @@ class OUSTER_API_CLASS ClientEvent {
         return *packet_;
     }
 
+    /// Handle keeping the packet alive past the next call to the client.
+    /// Only set on events returned by SensorClient::get_pooled_packet.
+    /// @return the pooled packet, or an empty handle
+    OUSTER_API_FUNCTION inline const PooledPacket& pooled_packet() const {
+        return pooled_;
+    }
+
    private:
     ouster::sensor::Packet* packet_;
+    PooledPacket pooled_;
     ClientEvent(ouster::sensor::Packet* packet, int src, EventType tpe)
         : source{src}, type{tpe}, packet_{packet} {}
 };
 
+/// Called with each event received by a SensorClient, see
+/// SensorClient::set_packet_callback
+using PacketCallback = std::function<void(ClientEvent& event)>;
+
 /// Class that indicates a sensor and its desired configuration
 class OUSTER_API_CLASS Sensor {
    public:
@@ -101,18 +120,139 @@ class OUSTER_API_CLASS Sensor {
     sensor_config config_;
 };
 
+/// Ways SensorClient can receive packets from the network
+enum class CaptureBackend {
+    UDP_SOCKET,  ///< Read from a UDP socket per port (default)
+    PACKET_MMAP  ///< Read IPv4 frames from a memory mapped TPACKET_V3 ring,
+                 ///< filtered by port. Linux only, requires CAP_NET_RAW.
+};
+
+/// Stages a sensor goes through while SensorClient starts it
+enum class StartupStage {
+    CHECKING_CACHE,     ///< Checking the cached metadata is still valid
+    FETCHING_METADATA,  ///< Querying the current metadata
+    CONFIGURING,        ///< Setting the desired config
+    REINITIALIZING,     ///< Waiting for the metadata after configuring
+    DONE,               ///< The sensor is ready
+    FAILED              ///< The sensor couldn't be started, see the message
+};
+
+/// Callback reporting the startup of a sensor, with the index of the sensor,
+/// its stage and the hostname or, on failure, the error
+using StartupProgress = std::function<void(
+    size_t sensor, StartupStage stage, const std::string& message)>;
+
+/// Options controlling how SensorClient starts sensors and receives packets
+struct OUSTER_API_CLASS CaptureOptions {
+    /// How packets are received
+    CaptureBackend backend = CaptureBackend::UDP_SOCKET;
+
+    /// Network interface to capture on with PACKET_MMAP. Empty captures on
+    /// every interface. With ReceiveTimestampMode::HARDWARE this is also the
+    /// interface whose NIC is set up to timestamp packets; when empty, UDP
+    /// sockets use the interface of their bound address.
+    std::string interface;
+
+    /// Size in bytes of each PACKET_MMAP ring block. Must be a multiple of
+    /// the page size and hold at least one full frame.
+    size_t block_size = 1 << 20;
+
+    /// Number of PACKET_MMAP ring blocks
+    size_t block_count = 64;
+
+    /// Longest time in milliseconds the kernel holds a partially filled
+    /// block before handing it over, bounding the added latency
+    int block_timeout_ms = 1;
+
+    /// Receive buffer size in bytes requested for each UDP socket. If zero
+    /// the default of 1 MiB is kept. Larger buffers absorb longer consumer
+    /// stalls, check ClientStats::kernel_dropped_packets to size them.
+    int receive_buffer_bytes = 0;
+
+    /// If greater than zero, spin rather than sleep while waiting for packets
+    /// to avoid wakeup latency, and set SO_BUSY_POLL to this many
+    /// microseconds on the sockets so the kernel busy waits on the device
+    /// queue too. Keeps a core busy and is meant for deployments that
+    /// dedicate one to ingest. SO_BUSY_POLL is Linux only and may need
+    /// CAP_NET_ADMIN, without it only the userspace spin is used.
+    int busy_poll_usec = 0;
+
+    /// Number of receives kept outstanding on each UDP socket on Windows,
+    /// where packets are received through an I/O completion port rather
+    /// than polled with select(). Zero polls the sockets instead. Unused on
+    /// other platforms.
+    size_t overlapped_receives = 64;
+
+    /// Called as each sensor moves through its startup. Sensors are started
+    /// concurrently, so it is called from several threads at once and must
+    /// be thread safe. Unused when metadata is provided.
+    StartupProgress startup_progress;
+
+    /// Directory caching the metadata of each sensor between runs, empty to
+    /// disable. On startup, the cached metadata of a sensor is used without
+    /// downloading it when the sensor reports the same serial number and
+    /// init_id, so it hasn't reinitialized since, and the desired config is
+    /// already applied. The directory must exist.
+    std::string metadata_cache_dir;
+};
+
+/// Packet loss counters of a SensorClient, to tell apart where packets were
+/// lost, and with latency stats enabled its throughput and latency
+struct OUSTER_API_CLASS ClientStats {
+    /// Packets discarded by the SDK because the internal buffer was full
+    uint64_t buffer_dropped_packets = 0;
+
+    /// Datagrams dropped by the kernel because a socket receive buffer or the
+    /// capture ring was full, or -1 where the platform doesn't report it.
+    /// Only supported on Linux.
+    int64_t kernel_dropped_packets = -1;
+
+    /// Lidar packets handed to the consumer with latency stats enabled
+    uint64_t lidar_packets = 0;
+
+    /// IMU packets handed to the consumer with latency stats enabled
+    uint64_t imu_packets = 0;
+
+    /// Packets waiting in the internal buffer when the stats were taken
+    size_t buffer_depth = 0;
+
+    /// Most packets waiting in the internal buffer at once with latency
+    /// stats enabled
+    size_t max_buffer_depth = 0;
+
+    /// Time from the host timestamp of each packet until it was handed to
+    /// the consumer: the time spent in the internal buffer, plus the time
+    /// spent in the socket with kernel receive timestamps
+    LatencyStats delivery_latency;
+
+    /// CPU time of the "ouster-buffer" thread filling the internal buffer,
+    /// or -1 without one or where not supported
+    double buffer_thread_cpu_seconds = -1;
+};
+
 /// An interface to configure and retrieve packets from one or multiple lidars
 class OUSTER_API_CLASS SensorClient {
    public:
     /// Build a sensor client to retrieve packets for the provided sensors.
     /// Configures the sensors if necessary according to their desired configs.
+    ///
+    /// Sensors are configured and their metadata fetched concurrently, all
+    /// within config_timeout_sec of the call. Every sensor is given the
+    /// chance to start before failing.
+    ///
+    /// @throw runtime_error listing every sensor that failed to start
     OUSTER_API_FUNCTION
     SensorClient(
         const std::vector<Sensor>& sensors,  ///< [in] sensors to connect to
         double config_timeout_sec = 45,      ///< [in] timeout for sensor config
         double buffer_time_sec =
-            0  ///< [in] time in seconds to buffer packets for. If zero no
-               ///< buffering is performed outside of the OS.
+            0,  ///< [in] time in seconds to buffer packets for. If zero no
+                ///< buffering is performed outside of the OS.
+        ReceiveTimestampMode timestamp_mode =
+            ReceiveTimestampMode::USERSPACE,  ///< [in] source of the packet
+                                              ///< host timestamps
+        const CaptureOptions& capture_options =
+            CaptureOptions()  ///< [in] how packets are received
     );
 
     /// Build a sensor client to retrieve packets for the provided sensors.
@@ -125,9 +265,14 @@ class OUSTER_API_CLASS SensorClient {
             infos,  ///< [in] metadata for each sensor, if present used instead
                     ///< of configuring each sensor
         double config_timeout_sec = 45,  ///< [in] timeout for sensor config
-        double buffer_time_sec = 0  ///< [in] time in seconds to buffer packets
-                                    ///< for. If zero no buffering is performed
-                                    ///< outside of the OS.
+        double buffer_time_sec = 0,  ///< [in] time in seconds to buffer
+                                     ///< packets for. If zero no buffering is
+                                     ///< performed outside of the OS.
+        ReceiveTimestampMode timestamp_mode =
+            ReceiveTimestampMode::USERSPACE,  ///< [in] source of the packet
+                                              ///< host timestamps
+        const CaptureOptions& capture_options =
+            CaptureOptions()  ///< [in] how packets are received
     );
 
     /// Destruct the sensor client
@@ -144,6 +289,55 @@ class OUSTER_API_CLASS SensorClient {
         double timeout_sec  ///< [in] timeout in seconds to wait for a packet
     );
 
+    /// Retrieve a batch of packets from the sensors with a given timeout.
+    /// Waits up to timeout_sec for the first packet, then drains any packets
+    /// already queued on the sockets without blocking. On Linux each socket is
+    /// drained with a single recvmmsg call into preallocated buffers.
+    /// If no packets are received, a single non-Packet event is returned.
+    /// Important: the packets referenced by the returned events are only valid
+    /// until the next call to get_packets or get_packet.
+    /// @return the number of events written to events
+    OUSTER_API_FUNCTION
+    size_t get_packets(
+        std::vector<ClientEvent>& events,  ///< [out] received events, cleared
+                                           ///< before being filled
+        size_t max_packets,  ///< [in] maximum number of packets to return
+        double timeout_sec   ///< [in] timeout in seconds to wait for a packet
+    );
+
+    /// Retrieve a packet like get_packet, but into a packet borrowed from the
+    /// client's packet pool rather than one reused by the next call. The
+    /// event's pooled_packet() handle can be kept or passed to other threads,
+    /// and the packet returns to the pool once every handle is released.
+    /// Buffers are swapped between the socket, the internal buffer and the
+    /// pool, so a steady-state consumer does not allocate.
+    /// @return a ClientEvent representing the result of the call
+    OUSTER_API_FUNCTION
+    ClientEvent get_pooled_packet(
+        double timeout_sec  ///< [in] timeout in seconds to wait for a packet
+    );
+
+    /// Receive packets on a thread of the client, "ouster-recv", handing
+    /// each to callback as it arrives rather than having the application
+    /// poll get_packet from a thread of its own. Packet events have
+    /// pooled_packet() set, so the packet can be kept or passed on; Error and
+    /// Exit events are handed on too, and timeouts never are. With an
+    /// executor the callback runs on the executor's tasks instead of the
+    /// receive thread. An empty callback stops the receive thread. Don't call
+    /// get_packet or the like while a callback is set, nor this from the
+    /// callback.
+    OUSTER_API_FUNCTION
+    void set_packet_callback(
+        PacketCallback callback,     ///< [in] callback, or empty to stop
+        Executor executor = nullptr  ///< [in] where to run the callback, or
+                                     ///< empty to run it on the receive thread
+    );
+
+    /// Get the pool backing get_pooled_packet
+    /// @return the packet pool
+    OUSTER_API_FUNCTION
+    inline PacketPool& packet_pool() { return packet_pool_; }
+
     /// Get the sensor_infos for each connected sensor
     /// @return the sensor_infos for each connected sensor
     OUSTER_API_FUNCTION
@@ -156,6 +350,19 @@ class OUSTER_API_CLASS SensorClient {
     OUSTER_API_FUNCTION
     uint64_t dropped_packets();
 
+    /// Get packet loss counters for the client. Reading the kernel counters
+    /// is comparatively slow, so avoid calling this for every packet.
+    /// @return the current counters
+    OUSTER_API_FUNCTION
+    ClientStats stats();
+
+    /// Start or stop counting packets and recording their latency for
+    /// stats(). Costs a clock read per packet while enabled. Starting clears
+    /// what was recorded before.
+    OUSTER_API_FUNCTION
+    void enable_latency_stats(bool enable = true  ///< [in] whether to record
+    );
+
     /// Flush the internal packet buffer (if enabled)
     OUSTER_API_FUNCTION
     void flush();
@@ -184,18 +391,44 @@ class OUSTER_API_CLASS SensorClient {
 
     std::vector<sensor_info> sensor_info_;
     std::vector<SOCKET> sockets_;
+    std::shared_ptr<impl::client_poller> poller_;
+    std::unique_ptr<impl::PacketMmapCapture> capture_;
+    std::unique_ptr<impl::IocpReceiver> iocp_;
+    bool busy_poll_{false};
     std::vector<std::shared_ptr<packet_format>> formats_;
-
-    bool do_buffer_ = false;
-    uint64_t dropped_packets_ = 0;
-    std::mutex buffer_mutex_;
-    std::condition_variable buffer_cv_;
+    ReceiveTimestampMode timestamp_mode_{ReceiveTimestampMode::USERSPACE};
+
+    std::atomic<bool> do_buffer_{false};
+    std::atomic<uint64_t> dropped_packets_{0};
+    std::atomic<bool> latency_stats_{false};
+    std::atomic<uint64_t> lidar_packets_{0};
+    std::atomic<uint64_t> imu_packets_{0};
+    std::atomic<size_t> max_buffer_depth_{0};
+    // recorded by the consumer thread
+    LatencyHistogram delivery_latency_;
+    // sleeps the consumer while the ring is empty, without taking a lock
+    // per packet on the buffer thread
+    Waiter buffer_waiter_;
     std::thread buffer_thread_;
-    std::deque<BufferEvent> buffer_;
+    // receives packets for the callback of set_packet_callback
+    std::atomic<bool> run_callback_{false};
+    std::thread callback_thread_;
+    std::unique_ptr<impl::DropOldestRingBuffer<BufferEvent>> buffer_;
 
     std::vector<uint8_t> staging_buffer;
     ImuPacket imu_packet_;
     LidarPacket lidar_packet_;
+    PacketPool packet_pool_;
+
+    // storage for get_packets, grown on demand and reused between calls
+    std::vector<std::vector<uint8_t>> batch_buffers_;
+    std::vector<InternalEvent> batch_events_;
+    std::vector<uint64_t> batch_timestamps_;
+    std::vector<size_t> batch_sizes_;
+    std::vector<ImuPacket> batch_imu_packets_;
+    std::vector<LidarPacket> batch_lidar_packets_;
+    struct OUSTER_API_IGNORE RecvBatch;
+    std::unique_ptr<RecvBatch> recv_batch_;
 
     struct OUSTER_API_IGNORE Addr {
         uint32_t ipv4;
@@ -205,11 +438,64 @@ class OUSTER_API_CLASS SensorClient {
     std::vector<Addr> addresses_;
 
     InternalEvent get_packet_internal(std::vector<uint8_t>& data, uint64_t& ts,
-                                      double timeout_sec);
+                                      double timeout_sec,
+                                      size_t max_size = 65535);
+
+    /// Wait for and receive up to max_packets datagrams into buffers, with
+    /// the host timestamp of each in timestamps and its length in sizes.
+    /// Buffers received into from the sockets stay at the maximum datagram
+    /// size, so they aren't zero filled again on every call.
+    /// @return the number of valid packets received, or a non-Packet event in
+    ///         events[0] with a return of zero on timeout/error/exit
+    size_t get_packets_internal(std::vector<InternalEvent>& events,
+                                std::vector<std::vector<uint8_t>>& buffers,
+                                std::vector<uint64_t>& timestamps,
+                                std::vector<size_t>& sizes,
+                                size_t max_packets, double timeout_sec);
+
+    /// Receive one datagram, replacing ts with its kernel receive timestamp
+    /// when enabled and available.
+    /// @return the number of bytes received, or SOCKET_ERROR
+    int64_t receive(SOCKET sock, std::vector<uint8_t>& data, size_t max_size,
+                    sockaddr_storage& from_addr, uint64_t& ts);
+
+    /// Wait on all sockets for readable data. Check poller_ for which ones.
+    /// @return an event with type Packet if any socket is readable
+    InternalEvent poll_sockets(uint64_t& ts, double timeout_sec);
+
+    /// Determine the source sensor and packet type of a received datagram.
+    InternalEvent classify_packet(const sockaddr_storage& from_addr,
+                                  size_t size) const;
+
+    /// Wait for the next packet from the internal buffer or the sockets,
+    /// swapping its contents into data.
+    /// @return false if no event was available
+    bool next_event(InternalEvent& ev, uint64_t& ts,
+                    std::vector<uint8_t>& data, double timeout_sec);
+
+    /// Fill a ClientEvent from an internal event and the packet buffer,
+    /// swapping the buffer into the packet if it holds exactly the datagram
+    /// and copying the datagram out of it otherwise.
+    ClientEvent make_event(const InternalEvent& ev, uint64_t ts,
+                           std::vector<uint8_t>& data, size_t size,
+                           ouster::sensor::LidarPacket& lidar_packet,
+                           ouster::sensor::ImuPacket& imu_packet);
+
+    /// Count a packet handed to the consumer and record its latency, if
+    /// latency stats are enabled
+    void record_delivery(const InternalEvent& ev, uint64_t ts);
+
+    /// Open the PACKET_MMAP capture ring and silence the UDP sockets
+    void start_capture(const CaptureOptions& options,
+                       ReceiveTimestampMode timestamp_mode);
 
     /// Start a background thread to do buffering if requested
     void start_buffer_thread(double buffer_time  ///< [in] time in seconds
     );
+
+    /// Block until the packet buffer is non-empty or the timeout expires.
+    /// @return true if there is a packet to dequeue
+    bool wait_for_buffer(double timeout_sec);
 };
 }  // namespace sensor
 }  // namespace ouster
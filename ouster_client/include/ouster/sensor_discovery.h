@@ -0,0 +1,84 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file sensor_discovery.h
+ * @brief Finding the Ouster sensors of a network through mDNS.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace sensor {
+
+/**
+ * A sensor that answered an mDNS query, with a summary of its sensor_info.
+ */
+struct OUSTER_API_CLASS DiscoveredSensor {
+    std::string address;    ///< IPv4 address the sensor answered from
+    std::string hostname;   ///< host name it announced, e.g. os-xxx.local
+    uint64_t sn = 0;        ///< serial number, prod_sn of its sensor_info
+    std::string prod_line;  ///< product line
+    std::string image_rev;  ///< firmware image revision
+    std::string status;     ///< sensor status, e.g. RUNNING
+    std::string sensor_info;  ///< json of api/v1/sensor/metadata/sensor_info
+    std::string error;  ///< why its sensor_info couldn't be read, or empty
+
+    /**
+     * @return true if the sensor_info of the sensor was read.
+     */
+    OUSTER_API_FUNCTION
+    bool ok() const { return error.empty(); }
+};
+
+/**
+ * Options of discover_sensors.
+ */
+struct OUSTER_API_CLASS DiscoveryOptions {
+    double timeout_sec = 5;    ///< how long to listen for answers
+    int http_timeout_sec = 1;  ///< timeout of the sensor_info request
+    std::string interface_address;  ///< IPv4 address of the interface to
+                                    ///< query on, or empty for the default
+    std::string mdns_address = "224.0.0.251";  ///< where queries are sent
+    int mdns_port = 5353;                      ///< port queries are sent to
+    int http_port = 80;  ///< port of the HTTP API of the sensors
+};
+
+/**
+ * Called with each discovered sensor as soon as it was probed.
+ */
+using DiscoveryCallback = std::function<void(const DiscoveredSensor&)>;
+
+/**
+ * Finds the sensors of the network by repeating an mDNS query for the Ouster
+ * services, then reads the sensor_info of every sensor answering, in batches
+ * probed concurrently while still listening for more answers.
+ *
+ * The query asks for unicast answers to an ephemeral port, so it doesn't need
+ * the mDNS port, which other responders on the host may hold. Only IPv4 is
+ * supported.
+ *
+ * @throw runtime_error if the query can't be sent.
+ *
+ * @param[in] options timeouts, interface and addresses to use.
+ * @param[in] on_sensor called with each sensor once probed, from a probing
+ *                      thread but never concurrently, or empty.
+ *
+ * @return every sensor found, in the order they were probed, which takes up
+ *         to http_timeout_sec longer than timeout_sec.
+ */
+OUSTER_API_FUNCTION
+std::vector<DiscoveredSensor> discover_sensors(
+    const DiscoveryOptions& options = {},
+    const DiscoveryCallback& on_sensor = {});
+
+}  // namespace sensor
+}  // namespace ouster
@@ -13,7 +13,12 @@
 #include <ouster/types.h>
 #include <ouster/version.h>
 
+#include <future>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 #include "ouster/visibility.h"
 
@@ -35,6 +40,7 @@ struct OUSTER_API_CLASS UserDataAndPolicy {
 class OUSTER_API_CLASS SensorHttp {
     ouster::util::version version_;
     std::string hostname_;
+    mutable std::mutex async_mutex_;
 
    protected:
     /**
@@ -67,6 +73,28 @@ class OUSTER_API_CLASS SensorHttp {
     OUSTER_API_FUNCTION
     inline const std::string& hostname() const { return hostname_; }
 
+    /**
+     * Runs a request on a thread of its own, e.g. to configure or poll the
+     * sensors of a fleet concurrently from a single control thread, whatever
+     * their firmware and protocol. Requests run through async() are
+     * serialized per sensor so that they can share its connection, but must
+     * not overlap with direct calls made from other threads.
+     *
+     * @param[in] request called with this sensor, e.g.
+     *                    [](const SensorHttp& s) { return s.metadata(); }
+     *
+     * @return the future result of the request, which rethrows what the
+     *         request threw. The sensor must outlive the future.
+     */
+    template <typename Request>
+    std::future<typename std::result_of<Request(const SensorHttp&)>::type>
+    async(Request request) const {
+        return std::async(std::launch::async, [this, request]() {
+            std::lock_guard<std::mutex> lock(async_mutex_);
+            return request(*this);
+        });
+    }
+
     /**
      * Queries the sensor metadata.
      *
@@ -349,6 +377,71 @@ class OUSTER_API_CLASS SensorHttp {
         int timeout_sec = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS);
 };
 
+/**
+ * Response of a sensor to a request of MultiSensorHttp
+ */
+struct OUSTER_API_CLASS HttpResponse {
+    long status = 0;    ///< HTTP status code, 0 without a response
+    std::string body;   ///< body of the response
+    std::string error;  ///< transport error, empty if there was a response
+
+    /**
+     * @return true if the sensor responded with a 2XX status
+     */
+    OUSTER_API_FUNCTION
+    bool ok() const { return error.empty() && 200 <= status && status < 300; }
+};
+
+struct multi_sensor_http_impl;
+
+/**
+ * Sends the same request to many sensors at once from a single thread, e.g.
+ * to discover or poll the health of a fleet of sensors, driving a connection
+ * per sensor with a curl multi handle. Connections are kept alive between
+ * requests, so repeated polls don't reconnect.
+ */
+class OUSTER_API_CLASS MultiSensorHttp {
+   public:
+    /**
+     * Prepares a connection per sensor, connected by the first request.
+     *
+     * @param[in] hostnames hostnames of the sensors.
+     */
+    OUSTER_API_FUNCTION
+    explicit MultiSensorHttp(const std::vector<std::string>& hostnames);
+
+    OUSTER_API_FUNCTION
+    ~MultiSensorHttp();
+
+    MultiSensorHttp(const MultiSensorHttp&) = delete;
+    MultiSensorHttp& operator=(const MultiSensorHttp&) = delete;
+
+    /**
+     * Executes a GET request towards the provided url on every sensor
+     * concurrently, returning once every sensor responded or timed out. A
+     * sensor failing doesn't fail the others.
+     *
+     * @param[in] url http request url, e.g. "api/v1/sensor/metadata".
+     * @param[in] timeout_sec The timeout for the request in seconds.
+     *
+     * @return the response of each sensor, in the order of the hostnames.
+     */
+    OUSTER_API_FUNCTION
+    std::vector<HttpResponse> get(
+        const std::string& url,
+        int timeout_sec = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS);
+
+    /**
+     * @return the hostnames of the sensors.
+     */
+    OUSTER_API_FUNCTION
+    const std::vector<std::string>& hostnames() const;
+
+   private:
+    std::vector<std::string> hostnames_;
+    std::unique_ptr<multi_sensor_http_impl> impl;
+};
+
 }  // namespace util
 }  // namespace sensor
 }  // namespace ouster
@@ -11,16 +11,176 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <thread>
+#include <utility>
 #include <vector>
 
+#include "ouster/clock_model.h"
+#include "ouster/scan_pool.h"
 #include "ouster/sensor_client.h"
+#include "ouster/threads.h"
 #include "ouster/visibility.h"
 
+#ifdef __cpp_impl_coroutine
+#include <coroutine>
+#define OUSTER_HAS_COROUTINES
+#endif
+
 namespace ouster {
 namespace sensor {
 
+/// Options controlling how SensorScanSource receives and batches packets
+struct OUSTER_API_CLASS ReceiveThreadOptions {
+    /// If true, run one receive and batch thread per sensor feeding the shared
+    /// scan queue, rather than a single thread serving every sensor. Each
+    /// sensor must then send to its own UDP ports.
+    bool thread_per_sensor = false;
+
+    /// CPU core to pin each receive thread to, indexed by sensor when
+    /// thread_per_sensor is set, otherwise only the first entry is used.
+    /// Negative or missing entries leave the thread unpinned. Only supported
+    /// on Linux.
+    std::vector<int> cpu_affinity;
+
+    /// If greater than zero, run the receive threads with the SCHED_FIFO
+    /// realtime policy at this priority. Usually requires elevated
+    /// privileges. Only supported on Linux.
+    int realtime_priority = 0;
+
+    /// Source of the packet host timestamps, and so of the LidarScan
+    /// packet_timestamp field.
+    ReceiveTimestampMode timestamp_mode = ReceiveTimestampMode::USERSPACE;
+
+    /// How the clients receive packets. With busy_poll_usec set, get_scan
+    /// also spins rather than sleeping while waiting for a scan.
+    CaptureOptions capture;
+
+    /// If set, scans are allocated contiguously from this resource, e.g. a
+    /// HugePageMemory, or a NumaLocalMemory to keep the scans of a receive
+    /// thread pinned with cpu_affinity on the memory of its socket. Scans are
+    /// allocated by the receive threads.
+    std::shared_ptr<MemoryResource> scan_memory;
+
+    /// If true, the receive threads allocate every scan the pool of each of
+    /// their sensors keeps, enough for a full scan queue, before receiving,
+    /// rather than as the queue first fills, so memory use is fixed from
+    /// the start. On by default in builds with OUSTER_EMBEDDED.
+#ifdef OUSTER_EMBEDDED
+    bool preallocate_scans = true;
+#else
+    bool preallocate_scans = false;
+#endif
+
+    /// If true, fit a ClockModel per sensor to the packet timestamps of its
+    /// scans and add a HOST_TIMESTAMP_FIELD column field to every scan with
+    /// the timestamp of each column mapped to host time, so scans of
+    /// sensors whose clocks aren't synchronized line up. Done on the
+    /// receive threads. Kernel receive timestamps, see timestamp_mode,
+    /// make the mapping more accurate.
+    bool align_clocks = false;
+
+    /// Options of the clock model of each sensor with align_clocks
+    ClockModelOptions clock_model;
+};
+
+/// Loss counters of a SensorScanSource, to tell apart whether lost data was
+/// dropped by the kernel, by the SDK or never arrived, and with latency stats
+/// enabled the latency of each stage of its pipeline
+struct OUSTER_API_CLASS ScanSourceStats {
+    /// Packets discarded because a client's internal buffer was full
+    uint64_t buffer_dropped_packets = 0;
+
+    /// Datagrams dropped by the kernel, or -1 where not reported. See
+    /// ClientStats::kernel_dropped_packets.
+    int64_t kernel_dropped_packets = -1;
+
+    /// Completed scans discarded because the scan queue was full
+    uint64_t dropped_scans = 0;
+
+    /// Lidar packets rejected for not matching the sensor metadata
+    uint64_t id_errors = 0;
+
+    /// Frames skipped according to the frame_id of consecutive scans, per
+    /// sensor. Whole frames lost before reaching the SDK show up here.
+    std::vector<uint64_t> missing_frames;
+
+    /// Lidar packets added to scans, per sensor
+    std::vector<uint64_t> batched_packets;
+
+    /// Scans completed by the ScanBatcher, per sensor, whether or not they
+    /// were then dropped
+    std::vector<uint64_t> batched_scans;
+
+    /// Scans completed with columns missing from their column window, per
+    /// sensor. See LidarScan::complete.
+    std::vector<uint64_t> incomplete_scans;
+
+    /// Scans handed to the consumer with latency stats enabled
+    uint64_t scans = 0;
+
+    /// Scans waiting in the queue when the stats were taken
+    size_t queue_depth = 0;
+
+    /// Most scans waiting in the queue at once with latency stats enabled
+    size_t max_queue_depth = 0;
+
+    /// Time from the host timestamp of the last packet of each scan until the
+    /// scan was queued, so the time spent in the client and the ScanBatcher
+    LatencyStats batch_latency;
+
+    /// Time each scan waited in the queue until get_scan or
+    /// get_synchronized_scans took it
+    LatencyStats queue_latency;
+
+    /// Time from the host timestamp of the last packet of each scan until it
+    /// was handed to the consumer, the end to end latency of the source
+    LatencyStats scan_latency;
+
+    /// Stats of each client, one per receive thread, with the latency of
+    /// packets from the socket to the ScanBatcher
+    std::vector<ClientStats> clients;
+
+    /// CPU time of each receive and batch thread, "ouster-batch-<index>",
+    /// indexed like clients, -1 where not supported. With thread_per_sensor
+    /// this is the ingest cost of each sensor.
+    std::vector<double> batch_thread_cpu_seconds;
+
+    /// Clock model fit of each sensor as of its last scan, empty unless
+    /// ReceiveThreadOptions::align_clocks is set
+    std::vector<ClockEstimate> clocks;
+};
+
+/// Scans from several sensors captured at about the same time, see
+/// SensorScanSource::get_synchronized_scans
+struct OUSTER_API_CLASS ScanSet {
+    /// One scan per sensor, indexed like SensorScanSource::get_sensor_info.
+    /// Null for sensors missing from a partial set.
+    std::vector<std::unique_ptr<LidarScan>> scans;
+
+    /// Check whether every sensor contributed a scan
+    /// @return true if no scan is missing
+    OUSTER_API_FUNCTION bool complete() const;
+
+    /// Get the number of scans in the set
+    /// @return the number of non-null scans
+    OUSTER_API_FUNCTION size_t size() const;
+};
+
+/// Called with a scan and the index of the sensor it came from, see
+/// SensorScanSource::set_scan_callback. The scan is null when the source
+/// closed before a scan arrived.
+using ScanCallback =
+    std::function<void(int sensor_idx, std::unique_ptr<LidarScan> scan)>;
+
+/// Called with each packet received by a SensorScanSource and the index of the
+/// sensor it came from, see SensorScanSource::set_packet_callback
+using SensorPacketCallback =
+    std::function<void(int sensor_idx, const Packet& packet)>;
+
 /// Provides a simple API for configuring sensors and retreiving LidarScans from
 /// them
 class OUSTER_API_CLASS SensorScanSource {
@@ -72,6 +232,28 @@ class OUSTER_API_CLASS SensorScanSource {
                    ///< sensor serial numbers and init_ids
     );
 
+    /// Construct a SensorScanSource to connect to the listed sensors, receiving
+    /// packets on the threads described by thread_options.
+    /// If infos are provided, they are used instead of configuring the sensors
+    /// and retrieving the sensor info from them.
+    OUSTER_API_FUNCTION
+    SensorScanSource(
+        const std::vector<Sensor>& sensors,  ///< [in] sensors to connect to
+        const std::vector<sensor_info>&
+            infos,  ///< [in] metadata for each sensor, if present used instead
+                    ///< of configuring each sensor
+        const std::vector<LidarScanFieldTypes>&
+            fields,  ///< [in] fields to batch into LidarScans for each lidar.
+                     ///< If empty default fields for that profile are used.
+        double config_timeout,       ///< [in] timeout for sensor config
+        unsigned int queue_size,     ///< [in] maximum number of scans to queue
+        bool soft_id_check,          ///< [in] if true, allow accepting packets
+                                     ///< with mismatched sensor serial numbers
+                                     ///< and init_ids
+        const ReceiveThreadOptions&
+            thread_options  ///< [in] receive thread layout and scheduling
+    );
+
     /// Destruct the SensorScanSource
     OUSTER_API_FUNCTION
     ~SensorScanSource();
@@ -80,7 +262,7 @@ class OUSTER_API_CLASS SensorScanSource {
     /// @return the sensor_infos for each connected sensor
     OUSTER_API_FUNCTION
     inline const std::vector<sensor_info>& get_sensor_info() {
-        return client_.get_sensor_info();
+        return sensor_info_;
     }
 
     /// Flush any buffered scans.
@@ -100,6 +282,19 @@ class OUSTER_API_CLASS SensorScanSource {
     OUSTER_API_FUNCTION
     inline uint64_t id_error_count() { return id_error_count_; }
 
+    /// Get packet and scan loss counters for all sensors.
+    /// @return the current counters
+    OUSTER_API_FUNCTION
+    ScanSourceStats stats();
+
+    /// Start or stop counting scans and recording the latency of each stage
+    /// of the pipeline for stats(), including that of the clients. Costs a
+    /// few clock reads per packet while enabled. Starting clears what was
+    /// recorded before.
+    OUSTER_API_FUNCTION
+    void enable_latency_stats(bool enable = true  ///< [in] whether to record
+    );
+
     /// Retrieves a scan from the queue or waits up to timeout_sec until one is
     /// available.
     /// Important: may return a nullptr if the underlying condition var
@@ -111,20 +306,203 @@ class OUSTER_API_CLASS SensorScanSource {
         double timeout_sec = 0.0  /// [in] timeout for retrieving a scan
     );
 
+    /// Retrieves a set of scans, one per sensor, whose timestamps are all
+    /// within tolerance_sec of each other, waiting up to timeout_sec for one
+    /// to be complete. Scans that can no longer be matched because every
+    /// other sensor has moved past them are discarded and counted in
+    /// dropped_scans. On timeout returns the best partial set available, with
+    /// null entries for the missing sensors, which is empty if nothing
+    /// arrived. Sensors are only comparable if their clocks are synchronized,
+    /// e.g. with PTP, unless host timestamps are used.
+    /// Important: shares the scan queue with get_scan, use one or the other.
+    /// @return the set of scans
+    OUSTER_API_FUNCTION
+    ScanSet get_synchronized_scans(
+        double timeout_sec,    ///< [in] timeout for a complete set
+        double tolerance_sec,  ///< [in] largest timestamp difference within
+                               ///< a set
+        bool host_timestamps =
+            false  ///< [in] compare the first valid packet host timestamps
+                   ///< rather than the first valid column timestamps
+    );
+
+    /// Hand each scan to callback as soon as it is batched, on the receive
+    /// and batch thread of its sensor, rather than queueing it for get_scan.
+    /// This saves the application a thread of its own polling get_scan, and
+    /// a hand over between threads per scan. With an executor the callback
+    /// runs on the executor's tasks instead, which keeps slow callbacks from
+    /// holding up the receive threads. The callback owns the scan and may
+    /// recycle it. Scans queued before the callback was set stay queued for
+    /// get_scan. An empty callback queues scans again. Exceptions thrown by
+    /// the callback are logged and otherwise ignored.
+    OUSTER_API_FUNCTION
+    void set_scan_callback(
+        ScanCallback callback,       ///< [in] callback, or empty to stop
+        Executor executor = nullptr  ///< [in] where to run the callback, or
+                                     ///< empty to run it on the batch threads
+    );
+
+    /// Call callback with every packet received, lidar and IMU, before it is
+    /// batched, on the receive and batch thread of its sensor. The packet is
+    /// only valid during the call. An empty callback stops the calls.
+    OUSTER_API_FUNCTION
+    void set_packet_callback(
+        SensorPacketCallback callback  ///< [in] callback, or empty to stop
+    );
+
+    /// Hand the next scan to callback once, without waiting for it: right
+    /// away on the calling thread if a scan is queued, otherwise on the batch
+    /// thread that completes the next scan, ahead of any scan callback. If
+    /// the source closes before then the callback gets a null scan. This is
+    /// the building block of awaiting next_scan() in a coroutine.
+    OUSTER_API_FUNCTION
+    void async_next_scan(ScanCallback callback  ///< [in] one shot callback
+    );
+
+#ifdef OUSTER_HAS_COROUTINES
+    /// Awaits the next scan in a C++20 coroutine, see next_scan()
+    class ScanAwaiter {
+       public:
+        explicit ScanAwaiter(SensorScanSource& source) : source_(source) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            handle_ = handle;
+            source_.async_next_scan(
+                [this](int sensor_idx, std::unique_ptr<LidarScan> scan) {
+                    result_ = {sensor_idx, std::move(scan)};
+                    // resume unless await_suspend hasn't returned yet
+                    if (ready_.exchange(true)) handle_.resume();
+                });
+            // not suspended when the scan was handed over already
+            return !ready_.exchange(true);
+        }
+
+        std::pair<int, std::unique_ptr<LidarScan>> await_resume() {
+            return std::move(result_);
+        }
+
+       private:
+        SensorScanSource& source_;
+        std::coroutine_handle<> handle_;
+        std::atomic<bool> ready_{false};
+        std::pair<int, std::unique_ptr<LidarScan>> result_;
+    };
+
+    /// Get the next scan in a C++20 coroutine, with
+    /// `auto [idx, scan] = co_await source.next_scan();`. The coroutine
+    /// resumes on the batch thread that completed the scan, or right away if
+    /// one is queued. The scan is null if the source closed.
+    /// @return the awaitable of the scan and the index of its sensor
+    ScanAwaiter next_scan() { return ScanAwaiter(*this); }
+#endif
+
+    /// Hand back a scan retrieved from this source so that it is reused for a
+    /// later scan of the same sensor rather than allocating a new one. Scans
+    /// whose fields were changed since they were retrieved are freed instead.
+    OUSTER_API_FUNCTION
+    void recycle(int sensor_idx,  ///< [in] index of the sensor it came from
+                 std::unique_ptr<LidarScan> scan  ///< [in] scan to reuse
+    );
+
+    /// Hand back every scan in a set retrieved from get_synchronized_scans
+    OUSTER_API_FUNCTION
+    void recycle(ScanSet&& set  ///< [in] scans to reuse
+    );
+
     /// Shut down the scan source, closing any sockets and threads
     OUSTER_API_FUNCTION
     void close();
 
    private:
-    SensorClient client_;
+    // one client for all sensors, or one per sensor with thread_per_sensor
+    std::vector<std::unique_ptr<SensorClient>> clients_;
+    std::vector<sensor_info> sensor_info_;
     std::mutex buffer_mutex_;
     std::condition_variable buffer_cv_;
     std::deque<std::pair<int, std::unique_ptr<LidarScan>>> buffer_;
+    // steady clock time in ns each scan in buffer_ was queued at
+    std::deque<uint64_t> queued_at_;
     uint64_t dropped_scans_ = 0;
     std::vector<LidarScanFieldTypes> fields_;
-    bool run_thread_;
-    std::thread batcher_thread_;
+    std::atomic<bool> run_thread_;
+    bool busy_poll_ = false;
+    std::vector<std::thread> batcher_threads_;
     std::atomic<uint64_t> id_error_count_;
+    unsigned int queue_size_ = 0;
+    // free scans per sensor for reuse by the batcher threads
+    std::vector<std::unique_ptr<ScanPool>> scan_pools_;
+    // guarded by buffer_mutex_: the scans waiting for a match in
+    // get_synchronized_scans
+    std::vector<std::deque<std::unique_ptr<LidarScan>>> sync_pending_;
+    // counters of each sensor, each written by the thread batching it
+    struct SensorCounters {
+        // frames missed, counted from frame_id gaps
+        std::atomic<uint64_t> missing_frames{0};
+        std::atomic<uint64_t> packets{0};
+        std::atomic<uint64_t> scans{0};
+        std::atomic<uint64_t> incomplete_scans{0};
+    };
+    std::unique_ptr<SensorCounters[]> counters_;
+    std::atomic<bool> latency_stats_{false};
+    // one per batcher thread, each recorded by its thread only
+    std::vector<std::unique_ptr<LatencyHistogram>> batch_latency_;
+    // guarded by buffer_mutex_
+    LatencyHistogram queue_latency_;
+    LatencyHistogram scan_latency_;
+    uint64_t scans_ = 0;
+    size_t max_queue_depth_ = 0;
+    // guarded by buffer_mutex_: the consumers scans are handed to rather
+    // than queued, the one shot callbacks of async_next_scan first
+    ScanCallback scan_callback_;
+    Executor scan_executor_;
+    std::deque<ScanCallback> scan_waiters_;
+    // read by the batcher threads for every packet while has_packet_callback_
+    std::atomic<bool> has_packet_callback_{false};
+    std::shared_ptr<const SensorPacketCallback> packet_callback_;
+    // per sensor with align_clocks, each used by the thread batching it
+    std::vector<ClockModel> clock_models_;
+    // guarded by buffer_mutex_
+    std::vector<ClockEstimate> clock_estimates_;
+
+    /// Take a scan for a sensor from the pool or allocate one.
+    std::unique_ptr<LidarScan> take_scan(size_t sensor_idx);
+
+    /// Return a scan to the pool.
+    void release_scan(size_t sensor_idx, std::unique_ptr<LidarScan> scan);
+
+    /// Take the oldest scan off the queue. Called with buffer_mutex_ held.
+    std::pair<int, std::unique_ptr<LidarScan>> pop_scan();
+
+    /// Count a scan handed to the consumer and record its latency, if
+    /// latency stats are enabled. Called with buffer_mutex_ held.
+    void record_delivery(const LidarScan& scan);
+
+    /// Wait until a scan is queued, the source closes or the timeout expires.
+    /// Called with lock held on buffer_mutex_.
+    void wait_for_scan(std::unique_lock<std::mutex>& lock,
+                       double timeout_sec);
+
+    /// Pick the best aligned scan from each pending queue into set. Called
+    /// with buffer_mutex_ held.
+    /// @return true if a set was assembled
+    bool assemble_set(ScanSet& set, uint64_t tolerance_ns,
+                      bool host_timestamps, bool partial);
+
+    /// Feed the packet timestamps of a batched scan to the clock model of
+    /// its sensor and fill its host timestamps.
+    /// @return the updated fit
+    ClockEstimate align_clock(size_t sensor_idx, LidarScan& scan);
+
+    /// Hand a scan to a callback, on the executor if set, logging exceptions.
+    void deliver(const ScanCallback& callback, const Executor& executor,
+                 int sensor_idx, std::unique_ptr<LidarScan> scan);
+
+    /// Receive packets from clients_[client_idx] and batch them into scans
+    /// until closed. sensor_offset maps the client's sensor indices to ours.
+    void batch_loop(size_t client_idx, size_t sensor_offset,
+                    unsigned int queue_size, bool soft_id_check);
 };
 }  // namespace sensor
 }  // namespace ouster
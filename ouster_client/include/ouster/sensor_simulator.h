@@ -0,0 +1,173 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Simulated sensors sending synthetic packets, for load testing
+ *
+ * SensorSimulator generates valid lidar and IMU packets for any sensor_info
+ * and sends them over UDP like the sensors would, at their real rate or
+ * faster, with optional packet loss and reordering. It can also serve the
+ * HTTP endpoints SensorClient uses to configure sensors and fetch their
+ * metadata, so ingest pipelines can be tested unmodified against hundreds
+ * of simulated sensors from one process.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/types.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace sensor {
+
+/// Fills the fields of a simulated scan. The frame id, column headers and
+/// timestamps of the scan are already set when it is called.
+using SceneGenerator =
+    std::function<void(LidarScan& scan, const sensor_info& info)>;
+
+/// The default scene: the sensor 1.5 m above the floor in the middle of a
+/// round room with a wavy wall, filling the range, signal, reflectivity and
+/// near ir fields the scan has.
+OUSTER_API_FUNCTION
+void room_scene(LidarScan& scan, const sensor_info& info);
+
+/// Options of a SensorSimulator
+struct OUSTER_API_CLASS SimulatorOptions {
+    /// Speed relative to the real frame rate of the sensors, e.g. 4 to send
+    /// four times as many frames per second. Zero sends as fast as possible.
+    /// Timestamps in the packets always advance at the real rate.
+    double rate = 1.0;
+
+    /// Probability of dropping each lidar packet
+    double packet_loss = 0;
+
+    /// Probability of sending each lidar packet after the one following it
+    double reorder = 0;
+
+    /// Host to send to for sensors whose config has no udp_dest
+    std::string udp_dest = "127.0.0.1";
+
+    /// Send IMU packets, 100 per second of sensor time like the sensors
+    bool imu = true;
+
+    /// Serve the HTTP configuration and metadata endpoints of each sensor,
+    /// each on its own port, see SensorSimulator::hostname
+    bool serve_http = false;
+
+    /// Address of each sensor, which its packets are sent from and its HTTP
+    /// endpoints listen on, 127.0.0.1 for sensors without one. SensorClient
+    /// tells sensors apart by the address packets come from, so several
+    /// sensors simulated for one client need one address each, e.g.
+    /// 127.0.0.2, 127.0.0.3 and so on on Linux, where all of 127.0.0.0/8 is
+    /// local.
+    std::vector<std::string> addresses;
+
+    /// Threads sending packets, the sensors are split between them
+    int threads = 1;
+
+    /// Seed of the packet loss and reordering
+    uint32_t seed = 0;
+};
+
+/// Packets sent by a SensorSimulator
+struct OUSTER_API_CLASS SimulatorStats {
+    uint64_t frames = 0;             ///< frames sent, over every sensor
+    uint64_t lidar_packets = 0;      ///< lidar packets sent
+    uint64_t imu_packets = 0;        ///< IMU packets sent
+    uint64_t dropped_packets = 0;    ///< lidar packets dropped on purpose
+    uint64_t reordered_packets = 0;  ///< lidar packets sent out of order
+    /// Packets sent over a frame period behind schedule, when the simulator
+    /// can't keep up with the requested rate
+    uint64_t late_packets = 0;
+};
+
+/// Simulates sensors sending packets, see the file documentation
+class OUSTER_API_CLASS SensorSimulator {
+   public:
+    /// Create a simulator of the given sensors. Packets are sent to the
+    /// udp_dest and ports of the config in their metadata, or
+    /// SimulatorOptions::udp_dest and ports 7502 and 7503 where not set.
+    ///
+    /// @throw std::invalid_argument if a sensor_info can't be simulated
+    /// @throw std::runtime_error if a socket can't be opened
+    OUSTER_API_FUNCTION
+    SensorSimulator(
+        const std::vector<sensor_info>& sensors,  ///< [in] sensors to simulate
+        const SimulatorOptions& options = {}      ///< [in] simulator options
+    );
+
+    OUSTER_API_FUNCTION
+    ~SensorSimulator();
+
+    SensorSimulator(const SensorSimulator&) = delete;
+    SensorSimulator& operator=(const SensorSimulator&) = delete;
+
+    /// Replace the scene of a sensor, room_scene by default. Static scenes
+    /// are generated once, and only the headers and timestamps of their
+    /// packets updated every frame, which keeps high rates cheap. Must be
+    /// called before starting.
+    OUSTER_API_FUNCTION
+    void set_scene(size_t sensor,           ///< [in] index of the sensor
+                   SceneGenerator scene,    ///< [in] scene of the sensor
+                   bool dynamic = true      ///< [in] generate every frame
+    );
+
+    /// Start sending in the background until stop() is called
+    OUSTER_API_FUNCTION
+    void start();
+
+    /// Send the next frames of every sensor, and the IMU packets over their
+    /// time, blocking until done. Paced at the rate of the options, like
+    /// start().
+    OUSTER_API_FUNCTION
+    void send_frames(size_t frames  ///< [in] frames to send per sensor
+    );
+
+    /// Stop sending, waiting for the sender threads. The HTTP endpoints keep
+    /// serving until the simulator is destroyed.
+    OUSTER_API_FUNCTION
+    void stop();
+
+    /// Get the hostname to give SensorClient for a sensor, its address and
+    /// the port of its HTTP endpoints
+    /// @throw std::logic_error if serve_http wasn't set
+    /// @return the hostname, e.g. "127.0.0.1:41234"
+    OUSTER_API_FUNCTION
+    std::string hostname(size_t sensor  ///< [in] index of the sensor
+    ) const;
+
+    /// Get the current metadata of a sensor, with the config set over HTTP
+    /// @return the metadata
+    OUSTER_API_FUNCTION
+    sensor_info get_sensor_info(size_t sensor  ///< [in] index of the sensor
+    ) const;
+
+    /// Get the counts of packets sent
+    /// @return the stats
+    OUSTER_API_FUNCTION
+    SimulatorStats stats() const;
+
+    /// Internal state of a simulated sensor
+    struct SimulatedSensor;
+
+   private:
+    void run(size_t thread, uint64_t frames);
+    void run_threads(uint64_t frames);
+
+    SimulatorOptions options_;
+    std::vector<std::unique_ptr<SimulatedSensor>> sensors_;
+    std::vector<std::thread> threads_;
+    std::atomic<bool> running_{false};
+};
+
+}  // namespace sensor
+}  // namespace ouster
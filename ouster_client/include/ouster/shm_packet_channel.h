@@ -0,0 +1,144 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Share raw sensor packets between processes through POSIX shared
+ * memory
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ouster/packet.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+/// A packet in a shared memory channel, see ShmPacketReader::next
+struct OUSTER_API_CLASS ShmPacket {
+    int source{0};  ///< index of the sensor the packet came from
+    sensor::PacketType type{sensor::PacketType::Unknown};  ///< packet type
+    uint64_t host_timestamp{0};    ///< host timestamp of the packet in ns
+    const uint8_t* data{nullptr};  ///< the packet, in the shared memory
+    size_t size{0};                ///< size of the packet in bytes
+};
+
+/// Publishes raw packets into a named POSIX shared memory segment that
+/// readers in other processes map, see ShmPacketReader.
+///
+/// Like ShmScanWriter, the segment holds a ring of slots and publishing
+/// copies a packet into the oldest slot without waiting on readers, so a
+/// reader that falls more than a ring behind loses packets rather than
+/// holding up the writer.
+///
+/// NOTE: only supported on POSIX systems. Only one writer may publish to a
+///       channel, and publish must not be called from several threads at
+///       once.
+class OUSTER_API_CLASS ShmPacketWriter {
+   public:
+    /// Create the channel, replacing an existing channel of the same name.
+    /// Readers still mapping the old segment stop receiving packets.
+    /// @throw invalid_argument if slots or max_packet_bytes is zero
+    /// @throw runtime_error if the shared memory segment can't be created
+    OUSTER_API_FUNCTION ShmPacketWriter(
+        const std::string& name,  ///< [in] name of the segment, e.g. "/pkts"
+        size_t slots,             ///< [in] number of packets in the ring
+        size_t max_packet_bytes,  ///< [in] size of the largest packet
+        const std::vector<std::string>& metadata =
+            {}  ///< [in] metadata of each sensor for readers, by source
+    );
+
+    /// Unmap and remove the segment. Readers keep their mapping.
+    OUSTER_API_FUNCTION ~ShmPacketWriter();
+
+    ShmPacketWriter(const ShmPacketWriter&) = delete;
+    ShmPacketWriter& operator=(const ShmPacketWriter&) = delete;
+
+    /// Copy a packet into the next slot and publish it to readers
+    /// @throw invalid_argument if the packet is larger than max_packet_bytes
+    OUSTER_API_FUNCTION void publish(
+        int source,                ///< [in] index of the sensor
+        sensor::PacketType type,   ///< [in] type of the packet
+        uint64_t host_timestamp,   ///< [in] host timestamp in ns
+        const uint8_t* data,       ///< [in] the packet
+        size_t size                ///< [in] size of the packet in bytes
+    );
+
+    /// @return the number of packets published so far
+    OUSTER_API_FUNCTION uint64_t published() const;
+
+    /// @return the size of the largest packet the channel holds
+    OUSTER_API_FUNCTION size_t max_packet_bytes() const;
+
+    struct OUSTER_API_IGNORE Segment;
+
+   private:
+    std::shared_ptr<Segment> segment_;
+    // name of the segment, removed on destruction
+    std::string name_;
+};
+
+/// Maps a channel created by ShmPacketWriter and reads its packets in order
+/// without copying them.
+///
+/// Packets returned by next() point into the shared memory. The writer may
+/// reuse a slot once it has gone around the ring, so a reader should check
+/// valid() after it is done with a packet, and copy packets it wants to
+/// keep.
+///
+/// NOTE: a reader object must not be shared between threads. Open one reader
+///       per thread instead, they are cheap.
+class OUSTER_API_CLASS ShmPacketReader {
+   public:
+    /// Map an existing channel. The first packet read is the oldest one still
+    /// in the ring.
+    /// @throw runtime_error if the channel doesn't exist or isn't a channel
+    ///        of packets
+    OUSTER_API_FUNCTION explicit ShmPacketReader(
+        const std::string& name  ///< [in] name given to the writer
+    );
+
+    OUSTER_API_FUNCTION ~ShmPacketReader();
+
+    ShmPacketReader(const ShmPacketReader&) = delete;
+    ShmPacketReader& operator=(const ShmPacketReader&) = delete;
+
+    /// Move on to the next published packet, without waiting. Packets
+    /// overwritten before they were read are skipped and counted by
+    /// dropped().
+    /// @return the packet, valid until the next call, or nullptr if no packet
+    ///         was published since the last one read
+    OUSTER_API_FUNCTION const ShmPacket* next();
+
+    /// Check that the packet last returned by next() hasn't been overwritten,
+    /// i.e. everything read from it so far is consistent
+    /// @return false once the writer started reusing its slot
+    OUSTER_API_FUNCTION bool valid() const;
+
+    /// @return the number of packets skipped because the writer overwrote
+    ///         them before they were read
+    OUSTER_API_FUNCTION uint64_t dropped() const;
+
+    /// @return the number of packets published so far by the writer
+    OUSTER_API_FUNCTION uint64_t published() const;
+
+    /// @return the metadata of each sensor given to the writer, by source
+    OUSTER_API_FUNCTION const std::vector<std::string>& metadata() const;
+
+   private:
+    std::shared_ptr<ShmPacketWriter::Segment> segment_;
+    std::vector<std::string> metadata_;
+    ShmPacket current_;
+    uint64_t next_{0};
+    // packet last returned by next(), or -1
+    int64_t current_n_{-1};
+    uint64_t dropped_{0};
+};
+
+}  // namespace ouster
@@ -0,0 +1,161 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Share LidarScans between processes through POSIX shared memory
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/types.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+/// Publishes scans into a named POSIX shared memory segment that readers in
+/// other processes map, see ShmScanReader.
+///
+/// The segment holds a ring of scan slots, each laid out like a scan made by
+/// LidarScan::make_contiguous. Publishing copies a scan into the oldest slot
+/// without waiting on readers, so a reader that falls more than a ring behind
+/// loses scans rather than holding up the writer.
+///
+/// The sensor metadata is shared both as json and as a binary sensor_info,
+/// see sensor_info_to_binary, so that readers don't parse the json.
+///
+/// NOTE: only supported on POSIX systems. Only one writer may publish to a
+///       channel, and publish must not be called from several threads at
+///       once.
+class OUSTER_API_CLASS ShmScanWriter {
+   public:
+    /// Create the channel, replacing an existing channel of the same name.
+    /// Readers still mapping the old segment stop receiving scans.
+    /// @throw invalid_argument if the dimensions or fields are invalid or
+    ///        slots is zero
+    /// @throw runtime_error if the shared memory segment can't be created or
+    ///        the metadata is invalid
+    OUSTER_API_FUNCTION ShmScanWriter(
+        const std::string& name,  ///< [in] name of the segment, e.g. "/lidar"
+        size_t w,                 ///< [in] width of the scans
+        size_t h,                 ///< [in] height of the scans
+        const LidarScanFieldTypes& fields,  ///< [in] fields to share
+        size_t slots = 4,  ///< [in] number of scans in the ring
+        size_t columns_per_packet =
+            DEFAULT_COLUMNS_PER_PACKET,  ///< [in] columns per packet
+        const std::string& metadata =
+            ""  ///< [in] sensor metadata for readers, or empty for none
+    );
+
+    /// Create the channel for scans of a sensor, with its metadata
+    /// @throw invalid_argument if the fields are invalid or slots is zero
+    /// @throw runtime_error if the shared memory segment can't be created
+    OUSTER_API_FUNCTION ShmScanWriter(
+        const std::string& name,  ///< [in] name of the segment, e.g. "/lidar"
+        const sensor::sensor_info& info,  ///< [in] the sensor
+        const LidarScanFieldTypes& fields =
+            {},  ///< [in] fields to share, or empty for the default fields of
+                 ///< the profile
+        size_t slots = 4  ///< [in] number of scans in the ring
+    );
+
+    /// Unmap and remove the segment. Readers keep their mapping.
+    OUSTER_API_FUNCTION ~ShmScanWriter();
+
+    ShmScanWriter(const ShmScanWriter&) = delete;
+    ShmScanWriter& operator=(const ShmScanWriter&) = delete;
+
+    /// Copy a scan into the next slot and publish it to readers
+    /// @throw invalid_argument if the scan has other dimensions or lacks a
+    ///        field of the channel. Fields the channel doesn't have are
+    ///        ignored.
+    OUSTER_API_FUNCTION void publish(const LidarScan& ls  ///< [in] the scan
+    );
+
+    /// @return the number of scans published so far
+    OUSTER_API_FUNCTION uint64_t published() const;
+
+    /// @return the fields of the channel
+    OUSTER_API_FUNCTION const LidarScanFieldTypes& field_types() const;
+
+    struct OUSTER_API_IGNORE Segment;
+
+   private:
+    std::shared_ptr<Segment> segment_;
+    // name of the segment, removed on destruction
+    std::string name_;
+    LidarScanFieldTypes field_types_;
+    // scans viewing each slot
+    std::vector<LidarScan> slots_;
+};
+
+/// Maps a channel created by ShmScanWriter and reads its scans in order
+/// without copying them.
+///
+/// Scans returned by next() view the shared memory directly and are read
+/// only. The writer may reuse a slot once it has gone around the ring, so a
+/// reader should check valid() after it is done with a scan, and copy scans
+/// it wants to keep.
+///
+/// NOTE: a reader object must not be shared between threads. Open one reader
+///       per thread instead, they are cheap.
+class OUSTER_API_CLASS ShmScanReader {
+   public:
+    /// Map an existing channel. The first scan read is the oldest one still
+    /// in the ring.
+    /// @throw runtime_error if the channel doesn't exist or isn't a channel
+    ///        of scans
+    OUSTER_API_FUNCTION explicit ShmScanReader(
+        const std::string& name  ///< [in] name given to the writer
+    );
+
+    OUSTER_API_FUNCTION ~ShmScanReader();
+
+    ShmScanReader(const ShmScanReader&) = delete;
+    ShmScanReader& operator=(const ShmScanReader&) = delete;
+
+    /// Move on to the next published scan, without waiting. Scans overwritten
+    /// before they were read are skipped and counted by dropped().
+    /// @return the scan, valid until the next call, or nullptr if no scan was
+    ///         published since the last one read
+    OUSTER_API_FUNCTION const LidarScan* next();
+
+    /// @return the scan last returned by next(), or nullptr
+    OUSTER_API_FUNCTION const LidarScan* current() const;
+
+    /// Check that the scan last returned by next() hasn't been overwritten,
+    /// i.e. everything read from it so far is consistent
+    /// @return false once the writer started reusing its slot
+    OUSTER_API_FUNCTION bool valid() const;
+
+    /// @return the number of scans skipped because the writer overwrote them
+    ///         before they were read
+    OUSTER_API_FUNCTION uint64_t dropped() const;
+
+    /// @return the number of scans published so far by the writer
+    OUSTER_API_FUNCTION uint64_t published() const;
+
+    /// @return the fields of the channel
+    OUSTER_API_FUNCTION const LidarScanFieldTypes& field_types() const;
+
+    /// @return the sensor metadata given to the writer, or an empty string
+    OUSTER_API_FUNCTION const std::string& metadata() const;
+
+   private:
+    std::shared_ptr<ShmScanWriter::Segment> segment_;
+    LidarScanFieldTypes field_types_;
+    std::string metadata_;
+    std::vector<LidarScan> slots_;
+    uint64_t next_{0};
+    // scan last returned by next(), or -1
+    int64_t current_{-1};
+    uint64_t dropped_{0};
+};
+
+}  // namespace ouster
@@ -0,0 +1,98 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Naming, placement and CPU accounting of the threads of the SDK
+ *
+ * Every long running thread the SDK starts is named after its role, e.g.
+ * "ouster-batch-0" for the receive and batch thread of the first client of a
+ * SensorScanSource, so it can be told apart in top, perf and debuggers. A
+ * thread start hook set by the application runs on each of them before they
+ * start working, to set their affinity, priority or cgroup, and the CPU time
+ * of each is available while it runs. The worker pools of the SDK size
+ * themselves by sdk_thread_count() unless told otherwise, which can be
+ * bounded for small devices.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+/// Called on every thread the SDK starts, from that thread, with its name,
+/// before it starts working. Must be thread safe.
+using ThreadStartHook = std::function<void(const std::string& name)>;
+
+/// Runs a task on behalf of the SDK, e.g. by posting it to the thread pool
+/// or event loop of the application, so that callbacks of the SDK run there
+/// rather than on its receive threads. Must be thread safe.
+using Executor = std::function<void(std::function<void()> task)>;
+
+/// A running thread of the SDK
+struct OUSTER_API_CLASS ThreadStats {
+    std::string name;         ///< name of the thread, e.g. "ouster-batch-0"
+    uint64_t os_id = 0;       ///< id of the thread in the OS, e.g. for top -H
+    double cpu_seconds = -1;  ///< CPU time used so far, or -1 if unsupported
+};
+
+/// Set the hook called on every thread the SDK starts from now on,
+/// replacing any previous one. Exceptions thrown by the hook are logged and
+/// otherwise ignored. Options of the SDK like ReceiveThreadOptions are
+/// applied after the hook, so they take precedence.
+OUSTER_API_FUNCTION
+void set_thread_start_hook(ThreadStartHook hook  ///< [in] hook, or empty
+);
+
+/// Start a thread of the SDK: it is named, counted by sdk_thread_stats and
+/// passed to the thread start hook before running the body.
+/// @return the thread
+OUSTER_API_FUNCTION
+std::thread start_thread(
+    const std::string& name,    ///< [in] name of the thread
+    std::function<void()> body  ///< [in] work of the thread
+);
+
+/// Name the calling thread in the OS. Linux keeps the first 15 characters.
+OUSTER_API_FUNCTION
+void set_current_thread_name(const std::string& name  ///< [in] thread name
+);
+
+/// Get the CPU time used by a running thread
+/// @return the CPU time in seconds, or -1 if the thread isn't running or the
+/// platform isn't supported
+OUSTER_API_FUNCTION
+double thread_cpu_seconds(
+    const std::thread& thread  ///< [in] thread to query
+);
+
+/// Bound the number of worker threads pools of the SDK start when no count
+/// is given, e.g. the OSF thread pool, Pipeline, PointCloudWriter and
+/// IndexedPcapReader::build_index_parallel, from now on. Pools already
+/// running keep their threads. The default is the OUSTER_MAX_SDK_THREADS
+/// build option, unbounded unless set.
+OUSTER_API_FUNCTION
+void set_max_sdk_threads(unsigned threads  ///< [in] most threads, 0 for no
+                                           ///< bound
+);
+
+/// Get the number of worker threads pools of the SDK start by default: the
+/// number of hardware threads, or 4 if unknown, within the bound set by
+/// set_max_sdk_threads
+/// @return the number of threads, at least 1
+OUSTER_API_FUNCTION
+unsigned sdk_thread_count();
+
+/// Get the running threads started by the SDK with start_thread
+/// @return the threads, in the order they started
+OUSTER_API_FUNCTION
+std::vector<ThreadStats> sdk_thread_stats();
+
+}  // namespace ouster
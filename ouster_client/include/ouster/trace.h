@@ -0,0 +1,122 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Trace scopes of the SDK hot paths, to find what stalls a pipeline
+ *
+ * The SDK marks its hot paths with OUSTER_TRACE_SCOPE. The scopes are only
+ * compiled in when the SDK is built with the OUSTER_TRACING cmake option,
+ * and otherwise cost nothing. When compiled in, a scope costs an atomic load
+ * until tracing is started at runtime, either to a Chrome trace JSON file
+ * that chrome://tracing and ui.perfetto.dev open, or to a callback.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace trace {
+
+/// A completed trace scope
+struct OUSTER_API_CLASS TraceEvent {
+    const char* category;  ///< module the scope is in, e.g. "osf"
+    const char* name;      ///< name of the scope
+    uint64_t start_ns;     ///< steady clock time the scope was entered at
+    uint64_t duration_ns;  ///< time spent in the scope
+    uint64_t thread_id;    ///< id of the thread the scope ran on
+};
+
+/// Called with every completed trace scope, from the thread that ran it
+using TraceCallback = std::function<void(const TraceEvent&)>;
+
+/// Check whether the SDK was built with trace scopes
+/// @return true if built with the OUSTER_TRACING option
+OUSTER_API_FUNCTION
+bool tracing_compiled();
+
+/// Check whether tracing is started
+/// @return true if trace scopes are being recorded
+OUSTER_API_FUNCTION
+bool tracing_enabled();
+
+/// Start recording trace scopes to a Chrome trace JSON file, which is
+/// complete once tracing stops. Stops any tracing already started.
+///
+/// @throw std::runtime_error if the file can't be opened
+OUSTER_API_FUNCTION
+void start_trace_file(const std::string& path  ///< [in] file to write
+);
+
+/// Start passing trace scopes to a callback. Stops any tracing already
+/// started. The callback is called from the threads of the SDK, so it must be
+/// thread safe and quick.
+OUSTER_API_FUNCTION
+void start_trace_callback(TraceCallback callback  ///< [in] callback to call
+);
+
+/// Stop tracing, closing the trace file if tracing to one. Scopes entered
+/// before stopping may still complete and be passed to the callback while
+/// this is called.
+OUSTER_API_FUNCTION
+void stop_trace();
+
+namespace impl {
+
+/// Whether tracing is started, read by every scope
+OUSTER_API_FUNCTION
+bool enabled();
+
+/// Get the steady clock time in nanoseconds
+OUSTER_API_FUNCTION
+uint64_t now_ns();
+
+/// Record a completed scope
+OUSTER_API_FUNCTION
+void record(const char* category, const char* name, uint64_t start_ns,
+            uint64_t end_ns);
+
+/// Times the enclosing scope while tracing is enabled
+class Scope {
+   public:
+    Scope(const char* category, const char* name)
+        : category_(category),
+          name_(name),
+          start_ns_(enabled() ? now_ns() : 0) {}
+
+    ~Scope() {
+        if (start_ns_) record(category_, name_, start_ns_, now_ns());
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    const char* category_;
+    const char* name_;
+    uint64_t start_ns_;
+};
+
+}  // namespace impl
+}  // namespace trace
+}  // namespace ouster
+
+#define OUSTER_TRACE_CONCAT_INNER(a, b) a##b
+#define OUSTER_TRACE_CONCAT(a, b) OUSTER_TRACE_CONCAT_INNER(a, b)
+
+/// Trace the enclosing scope under the given category and name, which must
+/// be string literals
+#ifdef OUSTER_TRACING
+#define OUSTER_TRACE_SCOPE(category, name)             \
+    ::ouster::trace::impl::Scope OUSTER_TRACE_CONCAT( \
+        ouster_trace_scope_, __LINE__)(category, name)
+#else
+#define OUSTER_TRACE_SCOPE(category, name) \
+    do {                                   \
+    } while (0)
+#endif
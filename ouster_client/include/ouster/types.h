@@ -1047,6 +1047,32 @@ std::string to_string(const sensor_info& info);
 
 // clang-format on
 
+/**
+ * Encode a sensor_info in a compact binary form which, unlike the json
+ * metadata, loads without parsing and validation. Meant for storage and
+ * transport next to the json metadata, not in place of it.
+ *
+ * @param[in] info sensor_info to encode.
+ *
+ * @return the encoded sensor_info.
+ */
+OUSTER_API_FUNCTION
+std::vector<uint8_t> sensor_info_to_binary(const sensor_info& info);
+
+/**
+ * Decode a sensor_info encoded by sensor_info_to_binary.
+ *
+ * @throw invalid_argument if the buffer is truncated or not an encoded
+ *        sensor_info of a known version.
+ *
+ * @param[in] data encoded sensor_info.
+ * @param[in] size number of bytes at data.
+ *
+ * @return the decoded sensor_info.
+ */
+OUSTER_API_FUNCTION
+sensor_info sensor_info_from_binary(const uint8_t* data, size_t size);
+
 /**
  * Parse config text blob from the sensor into a sensor_config struct.
  *
@@ -1471,6 +1497,24 @@ class OUSTER_API_CLASS packet_format {
     void col_field(const uint8_t* col_buf, const std::string& f, T* dst,
                    int dst_stride = 1) const;
 
+    /**
+     * Copy some pixels of the specified channel field out of a packet
+     * measurement block.
+     *
+     * @tparam T T should be a numeric type large enough to store
+     * values of the specified field. Otherwise, data will be truncated.
+     *
+     * @param[in] col_buf a measurement block pointer returned by `nth_col()`.
+     * @param[in] f the channel field to copy.
+     * @param[out] dst destination array of size pixels.size() * dst_stride.
+     * @param[in] dst_stride stride for writing to the destination array.
+     * @param[in] pixels the pixels to copy, in the order to write them; each
+     * must be less than pixels_per_column.
+     */
+    template <typename T>
+    void col_field(const uint8_t* col_buf, const std::string& f, T* dst,
+                   int dst_stride, const std::vector<size_t>& pixels) const;
+
     /**
      * Returns maximum available size of parsing block usable with block_field
      *
@@ -0,0 +1,112 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Voxel grid downsampling of point clouds and scans
+ */
+
+#pragma once
+
+#include <Eigen/Core>
+#include <cstddef>
+#include <cstdint>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+
+/// Which point of a voxel represents it after downsampling
+enum class VoxelPolicy {
+    FIRST = 0,     ///< the first point of the voxel, in input order
+    CENTROID = 1,  ///< the mean of the points of the voxel
+    RANDOM = 2     ///< a uniformly random point of the voxel
+};
+
+/// The points left by voxel_downsample and where they came from
+struct OUSTER_API_CLASS VoxelDownsample {
+    /// one point per voxel, in the order the voxels are first hit
+    pose_util::Points points;
+    /// per voxel, the index of the input point kept, or of the first point of
+    /// the voxel for VoxelPolicy::CENTROID
+    Eigen::ArrayXi indices;
+    /// per input point, the index of its voxel, -1 for points left out
+    Eigen::ArrayXi voxels;
+};
+
+/**
+ * Downsample points on a voxel grid of cubes of a side of voxel_size whose
+ * corner is at the origin, keeping one point per occupied voxel.
+ *
+ * Points are hashed into an open addressing table, computing the voxel keys of
+ * the points in parallel when built with OpenMP. Non finite points are left
+ * out. The result only depends on seed for VoxelPolicy::RANDOM.
+ *
+ * @throw std::invalid_argument if voxel_size isn't positive.
+ *
+ * @param[in] points A matrix of shape (N, 3) of points.
+ * @param[in] voxel_size The side of a voxel, in the units of the points.
+ * @param[in] policy Which point of a voxel to keep.
+ * @param[in] seed Seed of the random choice of VoxelPolicy::RANDOM.
+ *
+ * @return The kept points, their indices and the voxel of each point.
+ */
+OUSTER_API_FUNCTION
+VoxelDownsample voxel_downsample(
+    const Eigen::Ref<const pose_util::Points>& points, double voxel_size,
+    VoxelPolicy policy = VoxelPolicy::FIRST, uint64_t seed = 0);
+
+/**
+ * Downsample the points of the pixels of a scan with a nonzero range, see
+ * voxel_downsample(const Eigen::Ref<const pose_util::Points>&, double,
+ * VoxelPolicy, uint64_t). Input points are the pixels of the scan in row
+ * major order, so that indices and voxels are pixel indices, e.g. to look up
+ * other fields of the kept points.
+ *
+ * @throw std::invalid_argument if voxel_size isn't positive or the scan and
+ * lut sizes differ.
+ *
+ * @param[in] scan a LidarScan with a RANGE field.
+ * @param[in] lut lookup tables generated by make_xyz_lut, in meters for a
+ * voxel_size in meters.
+ * @param[in] voxel_size The side of a voxel, in the units of the lut.
+ * @param[in] policy Which point of a voxel to keep.
+ * @param[in] seed Seed of the random choice of VoxelPolicy::RANDOM.
+ *
+ * @return The kept points, their pixel indices and the voxel of each pixel.
+ */
+OUSTER_API_FUNCTION
+VoxelDownsample voxel_downsample(const LidarScan& scan, const XYZLut& lut,
+                                 double voxel_size,
+                                 VoxelPolicy policy = VoxelPolicy::FIRST,
+                                 uint64_t seed = 0);
+
+/// Sum and count of the ranges of a percentile band, see range_percentiles()
+struct OUSTER_API_CLASS RangeBand {
+    uint64_t sum = 0;  ///< sum of the ranges in the band
+    size_t count = 0;  ///< number of ranges in the band
+};
+
+/**
+ * Select the nonzero ranges between two percentiles of the nonzero ranges of
+ * a range image, inclusive, e.g. to estimate a voxel size from the far ranges
+ * of a scan. Percentiles interpolate linearly between the closest ranges, like
+ * numpy.percentile. Bands of several images add up to the band of all of
+ * their ranges by summing sums and counts.
+ *
+ * @throw std::invalid_argument unless 0 <= start_pct <= end_pct <= 1.
+ *
+ * @param[in] range a range image in the same format as the RANGE field of a
+ * LidarScan.
+ * @param[in] start_pct The lower percentile, as a ratio.
+ * @param[in] end_pct The upper percentile, as a ratio.
+ *
+ * @return The sum and count of the ranges in the band, zero if the image has
+ * no nonzero range.
+ */
+OUSTER_API_FUNCTION
+RangeBand range_percentiles(const Eigen::Ref<const img_t<uint32_t>>& range,
+                            double start_pct, double end_pct);
+
+}  // namespace ouster
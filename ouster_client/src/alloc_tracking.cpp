@@ -0,0 +1,263 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * Replaces the allocator of the process, see alloc_tracking.h. Built into
+ * its own library so that only builds asking for it get it.
+ */
+
+#include "ouster/alloc_tracking.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+// counters of the allocator can't have dynamic TLS, which may allocate on
+// first access from a shared library
+#if defined(__GNUC__)
+#define OUSTER_ALLOC_TLS \
+    thread_local __attribute__((tls_model("initial-exec")))
+#else
+#define OUSTER_ALLOC_TLS thread_local
+#endif
+
+namespace ouster {
+namespace alloc {
+
+namespace {
+
+// plain counters, constant initialized so they are usable before main
+struct Counts {
+    uint64_t allocations;
+    uint64_t frees;
+    uint64_t bytes;
+};
+
+struct Tag {
+    std::atomic<const char*> name;
+    std::atomic<uint64_t> allocations;
+    std::atomic<uint64_t> frees;
+    std::atomic<uint64_t> bytes;
+};
+
+constexpr size_t max_tags = 64;
+
+OUSTER_ALLOC_TLS Counts thread_counts;
+std::atomic<uint64_t> total_allocations;
+std::atomic<uint64_t> total_frees;
+std::atomic<uint64_t> total_bytes;
+std::atomic<bool> active;
+Tag tags[max_tags];
+
+void count_allocation(size_t bytes) {
+    thread_counts.allocations++;
+    thread_counts.bytes += bytes;
+    total_allocations.fetch_add(1, std::memory_order_relaxed);
+    total_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    if (!active.load(std::memory_order_relaxed)) {
+        active.store(true, std::memory_order_relaxed);
+    }
+}
+
+void count_free() {
+    thread_counts.frees++;
+    total_frees.fetch_add(1, std::memory_order_relaxed);
+}
+
+// find or claim the slot of a tag, null when all are taken
+Tag* find_tag(const char* name, bool claim) {
+    for (auto& tag : tags) {
+        const char* current = tag.name.load();
+        if (!current) {
+            if (!claim) return nullptr;
+            if (tag.name.compare_exchange_strong(current, name)) return &tag;
+            // another thread claimed it first, maybe for the same tag
+        }
+        if (std::strcmp(current, name) == 0) return &tag;
+    }
+    return nullptr;
+}
+
+AllocStats to_stats(const Counts& counts) {
+    AllocStats stats;
+    stats.allocations = counts.allocations;
+    stats.frees = counts.frees;
+    stats.bytes = counts.bytes;
+    return stats;
+}
+
+}  // namespace
+
+bool tracking_active() { return active.load(); }
+
+AllocStats thread_stats() { return to_stats(thread_counts); }
+
+AllocStats process_stats() {
+    AllocStats stats;
+    stats.allocations = total_allocations.load();
+    stats.frees = total_frees.load();
+    stats.bytes = total_bytes.load();
+    return stats;
+}
+
+AllocStats tag_stats(const char* tag) {
+    AllocStats stats;
+    const Tag* t = tag ? find_tag(tag, false) : nullptr;
+    if (t) {
+        stats.allocations = t->allocations.load();
+        stats.frees = t->frees.load();
+        stats.bytes = t->bytes.load();
+    }
+    return stats;
+}
+
+void reset_tag_stats() {
+    for (auto& tag : tags) {
+        tag.allocations = 0;
+        tag.frees = 0;
+        tag.bytes = 0;
+    }
+}
+
+AllocScope::AllocScope(const char* tag) : tag_(tag), start_(thread_stats()) {}
+
+AllocScope::~AllocScope() {
+    if (!tag_) return;
+    Tag* tag = find_tag(tag_, true);
+    if (!tag) return;
+    const AllocStats counted = stats();
+    tag->allocations += counted.allocations;
+    tag->frees += counted.frees;
+    tag->bytes += counted.bytes;
+}
+
+AllocStats AllocScope::stats() const {
+    const AllocStats now = thread_stats();
+    AllocStats stats;
+    stats.allocations = now.allocations - start_.allocations;
+    stats.frees = now.frees - start_.frees;
+    stats.bytes = now.bytes - start_.bytes;
+    return stats;
+}
+
+}  // namespace alloc
+}  // namespace ouster
+
+using ouster::alloc::count_allocation;
+using ouster::alloc::count_free;
+
+#if defined(__GLIBC__)
+
+// glibc supports replacing malloc and friends, and exports its own under
+// these names to forward to; operator new of libstdc++ calls malloc
+extern "C" {
+
+void* __libc_malloc(size_t size);
+void __libc_free(void* ptr);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+
+void* malloc(size_t size) {
+    void* ptr = __libc_malloc(size);
+    if (ptr) count_allocation(size);
+    return ptr;
+}
+
+void free(void* ptr) {
+    if (ptr) count_free();
+    __libc_free(ptr);
+}
+
+void* calloc(size_t n, size_t size) {
+    void* ptr = __libc_calloc(n, size);
+    if (ptr) count_allocation(n * size);
+    return ptr;
+}
+
+// counted as freeing the old block and allocating a new one
+void* realloc(void* ptr, size_t size) {
+    void* result = __libc_realloc(ptr, size);
+    if (ptr && (result || size == 0)) count_free();
+    if (result) count_allocation(size);
+    return result;
+}
+
+void* memalign(size_t alignment, size_t size) {
+    void* ptr = __libc_memalign(alignment, size);
+    if (ptr) count_allocation(size);
+    return ptr;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) {
+    if (alignment < sizeof(void*) || (alignment & (alignment - 1))) {
+        return EINVAL;
+    }
+    void* ptr = memalign(alignment, size);
+    if (!ptr) return ENOMEM;
+    *out = ptr;
+    return 0;
+}
+
+void* valloc(size_t size) { return memalign(4096, size); }
+
+void* pvalloc(size_t size) { return memalign(4096, (size + 4095) & ~4095); }
+
+}  // extern "C"
+
+#else
+
+// elsewhere only the C++ allocations can be replaced portably
+
+namespace {
+
+void* counted_new(size_t size) {
+    void* ptr = std::malloc(size ? size : 1);
+    if (ptr) count_allocation(size);
+    return ptr;
+}
+
+void counted_delete(void* ptr) {
+    if (ptr) count_free();
+    std::free(ptr);
+}
+
+}  // namespace
+
+void* operator new(size_t size) {
+    void* ptr = counted_new(size);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return counted_new(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return counted_new(size);
+}
+
+void operator delete(void* ptr) noexcept { counted_delete(ptr); }
+void operator delete[](void* ptr) noexcept { counted_delete(ptr); }
+void operator delete(void* ptr, size_t) noexcept { counted_delete(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { counted_delete(ptr); }
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    counted_delete(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    counted_delete(ptr);
+}
+
+#endif
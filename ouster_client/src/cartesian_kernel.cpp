@@ -0,0 +1,291 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/impl/cartesian_kernel.h"
+
+#include <stdexcept>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define OUSTER_CARTESIAN_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define OUSTER_CARTESIAN_NEON
+#include <arm_neon.h>
+#endif
+
+namespace ouster {
+namespace impl {
+
+template <bool Interleaved>
+static inline void store_point(float* xyz, size_t stride, size_t i, float x,
+                               float y, float z) {
+    if (Interleaved) {
+        xyz[3 * i + 0] = x;
+        xyz[3 * i + 1] = y;
+        xyz[3 * i + 2] = z;
+    } else {
+        xyz[i] = x;
+        xyz[stride + i] = y;
+        xyz[2 * stride + i] = z;
+    }
+}
+
+template <bool Interleaved>
+static inline void project_one(const uint32_t* range, const float* dir,
+                               const float* ofs, size_t stride, size_t i,
+                               float* xyz) {
+    const uint32_t r = range[i];
+    if (r == 0) {
+        store_point<Interleaved>(xyz, stride, i, 0.0f, 0.0f, 0.0f);
+        return;
+    }
+    const float fr = static_cast<float>(r);
+    store_point<Interleaved>(
+        xyz, stride, i, fr * dir[i] + ofs[i],
+        fr * dir[stride + i] + ofs[stride + i],
+        fr * dir[2 * stride + i] + ofs[2 * stride + i]);
+}
+
+template <bool Interleaved>
+static void cartesian_scalar(const uint32_t* range, const float* dir,
+                             const float* ofs, size_t stride, size_t n,
+                             float* xyz) {
+    for (size_t i = 0; i < n; i++) {
+        project_one<Interleaved>(range, dir, ofs, stride, i, xyz);
+    }
+}
+
+#ifdef OUSTER_CARTESIAN_X86
+
+// The x86 kernels are compiled for their instruction set regardless of the
+// target flags and only called after a runtime check, so the library still
+// runs on older CPUs.
+
+// Write four points of x, y and z lanes as xyz triplets. Each store writes a
+// fourth float that the next one overwrites, so the caller must leave at
+// least one point after these to be written later.
+static inline void store_interleaved4(float* out, __m128 x, __m128 y,
+                                      __m128 z) {
+    __m128 w = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    _mm_storeu_ps(out + 0, x);
+    _mm_storeu_ps(out + 3, y);
+    _mm_storeu_ps(out + 6, z);
+    _mm_storeu_ps(out + 9, w);
+}
+
+// converts like static_cast<float>, also for ranges with the top bit set
+__attribute__((target("avx2,fma"))) static inline __m256 to_float_avx2(
+    __m256i r) {
+    const __m256 hi = _mm256_cvtepi32_ps(_mm256_srli_epi32(r, 16));
+    const __m256 lo =
+        _mm256_cvtepi32_ps(_mm256_and_si256(r, _mm256_set1_epi32(0xffff)));
+    return _mm256_fmadd_ps(hi, _mm256_set1_ps(65536.0f), lo);
+}
+
+template <bool Interleaved>
+__attribute__((target("avx2,fma"))) static void cartesian_avx2(
+    const uint32_t* range, const float* dir, const float* ofs, size_t stride,
+    size_t n, float* xyz) {
+    size_t i = 0;
+    // interleaved stores spill into the next point, see store_interleaved4
+    for (; i + 8 + (Interleaved ? 1 : 0) <= n; i += 8) {
+        const __m256i r =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(range + i));
+        const __m256 fr = to_float_avx2(r);
+        const __m256 zero = _mm256_castsi256_ps(
+            _mm256_cmpeq_epi32(r, _mm256_setzero_si256()));
+
+        __m256 p[3];
+        for (size_t c = 0; c < 3; c++) {
+            const __m256 v =
+                _mm256_fmadd_ps(fr, _mm256_loadu_ps(dir + c * stride + i),
+                                _mm256_loadu_ps(ofs + c * stride + i));
+            p[c] = _mm256_andnot_ps(zero, v);
+        }
+
+        if (Interleaved) {
+            float* out = xyz + 3 * i;
+            store_interleaved4(out, _mm256_castps256_ps128(p[0]),
+                               _mm256_castps256_ps128(p[1]),
+                               _mm256_castps256_ps128(p[2]));
+            store_interleaved4(out + 12, _mm256_extractf128_ps(p[0], 1),
+                               _mm256_extractf128_ps(p[1], 1),
+                               _mm256_extractf128_ps(p[2], 1));
+        } else {
+            for (size_t c = 0; c < 3; c++) {
+                _mm256_storeu_ps(xyz + c * stride + i, p[c]);
+            }
+        }
+    }
+    for (; i < n; i++) {
+        project_one<Interleaved>(range, dir, ofs, stride, i, xyz);
+    }
+}
+
+// the AVX-512 intrinsics without an explicit source, like
+// _mm512_cvtepu32_ps and _mm512_extractf32x4_ps, pass an undefined register
+// through to their builtins, which GCC 12 reports as maybe uninitialized, so
+// the masked forms merge into zeroed registers instead
+__attribute__((target("avx512f"))) static inline __m128 extract_lane(
+    __m512 v, int lane) {
+    switch (lane) {
+        case 0:
+            return _mm512_mask_extractf32x4_ps(_mm_setzero_ps(), 0xF, v, 0);
+        case 1:
+            return _mm512_mask_extractf32x4_ps(_mm_setzero_ps(), 0xF, v, 1);
+        case 2:
+            return _mm512_mask_extractf32x4_ps(_mm_setzero_ps(), 0xF, v, 2);
+        default:
+            return _mm512_mask_extractf32x4_ps(_mm_setzero_ps(), 0xF, v, 3);
+    }
+}
+
+template <bool Interleaved>
+__attribute__((target("avx512f"))) static void cartesian_avx512(
+    const uint32_t* range, const float* dir, const float* ofs, size_t stride,
+    size_t n, float* xyz) {
+    const __m512 zeros = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 + (Interleaved ? 1 : 0) <= n; i += 16) {
+        const __m512i r = _mm512_loadu_si512(range + i);
+        const __m512 fr = _mm512_mask_cvtepu32_ps(zeros, 0xFFFF, r);
+        const __mmask16 nonzero = _mm512_test_epi32_mask(r, r);
+
+        __m512 p[3];
+        for (size_t c = 0; c < 3; c++) {
+            const __m512 v =
+                _mm512_fmadd_ps(fr, _mm512_loadu_ps(dir + c * stride + i),
+                                _mm512_loadu_ps(ofs + c * stride + i));
+            p[c] = _mm512_mask_mov_ps(zeros, nonzero, v);
+        }
+
+        if (Interleaved) {
+            float* out = xyz + 3 * i;
+            for (int lane = 0; lane < 4; lane++) {
+                store_interleaved4(out + 12 * lane, extract_lane(p[0], lane),
+                                   extract_lane(p[1], lane),
+                                   extract_lane(p[2], lane));
+            }
+        } else {
+            for (size_t c = 0; c < 3; c++) {
+                _mm512_storeu_ps(xyz + c * stride + i, p[c]);
+            }
+        }
+    }
+    for (; i < n; i++) {
+        project_one<Interleaved>(range, dir, ofs, stride, i, xyz);
+    }
+}
+
+#endif
+
+#ifdef OUSTER_CARTESIAN_NEON
+
+template <bool Interleaved>
+static void cartesian_neon(const uint32_t* range, const float* dir,
+                           const float* ofs, size_t stride, size_t n,
+                           float* xyz) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const uint32x4_t r = vld1q_u32(range + i);
+        const float32x4_t fr = vcvtq_f32_u32(r);
+        const uint32x4_t nonzero = vtstq_u32(r, r);
+
+        float32x4x3_t p;
+        for (size_t c = 0; c < 3; c++) {
+            const float32x4_t v =
+                vfmaq_f32(vld1q_f32(ofs + c * stride + i), fr,
+                          vld1q_f32(dir + c * stride + i));
+            p.val[c] = vreinterpretq_f32_u32(
+                vandq_u32(vreinterpretq_u32_f32(v), nonzero));
+        }
+
+        if (Interleaved) {
+            vst3q_f32(xyz + 3 * i, p);
+        } else {
+            for (size_t c = 0; c < 3; c++) {
+                vst1q_f32(xyz + c * stride + i, p.val[c]);
+            }
+        }
+    }
+    for (; i < n; i++) {
+        project_one<Interleaved>(range, dir, ofs, stride, i, xyz);
+    }
+}
+
+#endif
+
+bool cartesian_kernel_supported(cartesian_kernel kernel) {
+    switch (kernel) {
+        case cartesian_kernel::SCALAR:
+            return true;
+        case cartesian_kernel::AVX2:
+#ifdef OUSTER_CARTESIAN_X86
+            return __builtin_cpu_supports("avx2") &&
+                   __builtin_cpu_supports("fma");
+#else
+            return false;
+#endif
+        case cartesian_kernel::AVX512:
+#ifdef OUSTER_CARTESIAN_X86
+            return __builtin_cpu_supports("avx512f");
+#else
+            return false;
+#endif
+        case cartesian_kernel::NEON:
+#ifdef OUSTER_CARTESIAN_NEON
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+cartesian_kernel best_cartesian_kernel() {
+    static const cartesian_kernel best = [] {
+        if (cartesian_kernel_supported(cartesian_kernel::AVX512))
+            return cartesian_kernel::AVX512;
+        if (cartesian_kernel_supported(cartesian_kernel::AVX2))
+            return cartesian_kernel::AVX2;
+        if (cartesian_kernel_supported(cartesian_kernel::NEON))
+            return cartesian_kernel::NEON;
+        return cartesian_kernel::SCALAR;
+    }();
+    return best;
+}
+
+template <bool Interleaved>
+static cartesian_fn pick_kernel(cartesian_kernel kernel) {
+    switch (kernel) {
+#ifdef OUSTER_CARTESIAN_X86
+        case cartesian_kernel::AVX2:
+            return cartesian_avx2<Interleaved>;
+        case cartesian_kernel::AVX512:
+            return cartesian_avx512<Interleaved>;
+#endif
+#ifdef OUSTER_CARTESIAN_NEON
+        case cartesian_kernel::NEON:
+            return cartesian_neon<Interleaved>;
+#endif
+        default:
+            return cartesian_scalar<Interleaved>;
+    }
+}
+
+cartesian_fn get_cartesian_fn(cartesian_kernel kernel, xyz_layout layout) {
+    if (!cartesian_kernel_supported(kernel)) {
+        throw std::invalid_argument(
+            "Cartesian kernel not supported on this CPU");
+    }
+    return layout == xyz_layout::INTERLEAVED ? pick_kernel<true>(kernel)
+                                             : pick_kernel<false>(kernel);
+}
+
+}  // namespace impl
+}  // namespace ouster
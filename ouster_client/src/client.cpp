@@ -16,6 +16,7 @@
 #include <jsoncons/json.hpp>
 #include <jsoncons/json_type.hpp>
 #include <jsoncons_ext/jsonpath/json_query.hpp>
+#include <limits>
 #include <memory>
 #include <sstream>
 #include <stdexcept>
@@ -31,6 +32,11 @@
 #include "ouster/sensor_http.h"
 #include "ouster/types.h"
 
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
+
 using namespace std::chrono_literals;
 namespace chrono = std::chrono;
 using ouster::sensor::impl::Logger;
@@ -43,6 +49,7 @@ struct client {
     SOCKET lidar_fd;
     SOCKET imu_fd;
     std::string hostname;
+    bool receive_timestamps = false;
     ~client() {
         impl::socket_close(lidar_fd);
         impl::socket_close(imu_fd);
@@ -177,8 +184,23 @@ jsoncons::json collect_metadata(SensorHttp& sensor_http, int timeout_sec) {
         chrono::steady_clock::now() + chrono::seconds{timeout_sec};
 
     std::string status;
+    jsoncons::json metadata;
+    bool have_metadata = false;
+    // from FW 3.1 the consolidated metadata carries the sensor status, so a
+    // single request replaces polling sensor_info before fetching it
+    const auto& fw = sensor_http.firmware_version();
+    if (fw.major > 3 || (fw.major == 3 && fw.minor >= 1)) {
+        try {
+            metadata = jsoncons::json::parse(sensor_http.metadata(timeout_sec));
+            status = metadata["sensor_info"]["status"].as<std::string>();
+            have_metadata = status != "INITIALIZING";
+        } catch (const std::exception&) {
+            // fall back to polling the status
+        }
+    }
+
     // TODO: can remove this loop when we drop support for FW 2.4
-    while (true) {
+    while (!have_metadata) {
         if (chrono::steady_clock::now() >= timeout_time) {
             throw std::runtime_error(
                 "A timeout occurred while waiting for the sensor to "
@@ -205,8 +227,9 @@ jsoncons::json collect_metadata(SensorHttp& sensor_http, int timeout_sec) {
     }
 
     try {
-        auto metadata =
-            jsoncons::json::parse(sensor_http.metadata(timeout_sec));
+        if (!have_metadata) {
+            metadata = jsoncons::json::parse(sensor_http.metadata(timeout_sec));
+        }
 
         metadata["ouster-sdk"]["client_version"] = client_version();
         metadata["ouster-sdk"]["output_source"] = "collect_metadata";
@@ -251,6 +274,37 @@ bool get_config(SensorHttp& sensor_http, sensor_config& config,
     return true;
 }
 
+namespace {
+
+// Whether a config param differs from its active value, comparing numbers by
+// value as the sensor may report 1 for a 1.0 it was given, or the reverse
+bool config_param_changed(const jsoncons::json& active,
+                          const jsoncons::json& desired) {
+    if (active.is_number() && desired.is_number()) {
+        return active.as<double>() != desired.as<double>();
+    }
+    if (active.is_array() && desired.is_array()) {
+        if (active.size() != desired.size()) return true;
+        for (size_t i = 0; i < active.size(); i++) {
+            if (config_param_changed(active[i], desired[i])) return true;
+        }
+        return false;
+    }
+    if (active.is_object() && desired.is_object()) {
+        if (active.size() != desired.size()) return true;
+        for (const auto& it : desired.object_range()) {
+            if (!active.contains(it.key()) ||
+                config_param_changed(active[it.key()], it.value())) {
+                return true;
+            }
+        }
+        return false;
+    }
+    return active != desired;
+}
+
+}  // namespace
+
 bool get_config(const std::string& hostname, sensor_config& config, bool active,
                 int timeout_sec) {
     auto sensor_http = SensorHttp::create(hostname, timeout_sec);
@@ -316,12 +370,24 @@ bool set_config(SensorHttp& sensor_http, const sensor_config& config,
         }
     }
 
-    // if configuration didn't change then skip applying the params
-    // note: comparison will fail if config_params contains newer config params
-    // introduced after the verison of FW the sensor is on
-    if (config_flags & CONFIG_FORCE_REINIT ||
-        config_params_copy != config_params) {
-        // send full string -- depends on older FWs not rejecting a blob even
+    // diff against the active params so that re-asserting the configuration
+    // a sensor already runs costs no reinitialize. Params the sensor doesn't
+    // report were introduced after its FW, which ignores them, so they don't
+    // count as changes
+    std::string changed;
+    for (const auto& it : config_params.object_range()) {
+        if (config_params_copy.contains(it.key()) &&
+            config_param_changed(config_params_copy[it.key()], it.value())) {
+            changed += changed.empty() ? it.key() : ", " + it.key();
+        }
+    }
+
+    if (config_flags & CONFIG_FORCE_REINIT || !changed.empty()) {
+        if (!changed.empty()) {
+            logger().debug("set_config: changing {}", changed);
+        }
+        // send the full set in a single request, which also resets params
+        // staged by others -- depends on older FWs not rejecting a blob even
         // when it contains unknown keys
         std::string config_params_str;
         config_params.dump(config_params_str);
@@ -492,56 +558,217 @@ std::shared_ptr<client> mtp_init_client(const std::string& hostname,
 namespace impl {
 
 struct client_poller {
+    poller_backend backend;
+    client_state err;
+
+    // select: the watched set is kept separately from the result so that
+    // polling again does not require re-registering every socket
+    fd_set watch_fds;
     fd_set rfds;
     SOCKET max_fd;
-    client_state err;
+
+#ifdef __linux__
+    int epoll_fd = -1;
+    std::vector<SOCKET> wanted;      // sockets set since the last poll
+    std::vector<SOCKET> registered;  // sorted, currently added to epoll_fd
+    std::vector<SOCKET> ready;       // sorted, readable in the last poll
+    std::vector<epoll_event> events;
+#endif
+
+    explicit client_poller(poller_backend b = poller_backend::SELECT)
+        : backend(b), err(client_state::TIMEOUT), max_fd(0) {
+        FD_ZERO(&watch_fds);
+        FD_ZERO(&rfds);
+#ifdef __linux__
+        if (backend == poller_backend::EPOLL) {
+            epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+            if (epoll_fd < 0) {
+                logger().warn("epoll_create1: {}, falling back to select",
+                              impl::socket_get_error());
+                backend = poller_backend::SELECT;
+            }
+        }
+#endif
+    }
+
+    ~client_poller() {
+#ifdef __linux__
+        if (epoll_fd >= 0) close(epoll_fd);
+#endif
+    }
+
+    client_poller(const client_poller&) = delete;
+    client_poller& operator=(const client_poller&) = delete;
 };
 
 std::shared_ptr<client_poller> make_poller() {
-    return std::make_unique<client_poller>();
+    return make_poller(poller_backend::SELECT);
+}
+
+std::shared_ptr<client_poller> make_poller(poller_backend backend) {
+    if (backend == poller_backend::AUTO) {
+#ifdef __linux__
+        backend = poller_backend::EPOLL;
+#else
+        backend = poller_backend::SELECT;
+#endif
+    }
+#ifndef __linux__
+    if (backend == poller_backend::EPOLL) {
+        throw std::invalid_argument(
+            "epoll poller backend is only available on Linux");
+    }
+#endif
+    return std::make_shared<client_poller>(backend);
+}
+
+poller_backend get_backend(const client_poller& poller) {
+    return poller.backend;
 }
 
 void reset_poll(client_poller& poller) {
+    FD_ZERO(&poller.watch_fds);
     FD_ZERO(&poller.rfds);
     poller.max_fd = 0;
     poller.err = client_state::TIMEOUT;
+#ifdef __linux__
+    poller.wanted.clear();
+    poller.ready.clear();
+#endif
+}
+
+void set_poll_socket(client_poller& poller, SOCKET sock) {
+#ifdef __linux__
+    if (poller.backend == poller_backend::EPOLL) {
+        poller.wanted.push_back(sock);
+        return;
+    }
+#endif
+#ifndef _WIN32
+    // on windows fd_set is an array of handles, not a bitmask
+    if (sock >= FD_SETSIZE) {
+        logger().error(
+            "socket {} exceeds FD_SETSIZE and cannot be polled with select",
+            sock);
+        return;
+    }
+#endif
+    FD_SET(sock, &poller.watch_fds);
+    poller.max_fd = std::max(poller.max_fd, sock);
 }
 
 void set_poll(client_poller& poller, const client& c) {
-    FD_SET(c.lidar_fd, &poller.rfds);
-    FD_SET(c.imu_fd, &poller.rfds);
-    poller.max_fd = std::max({poller.max_fd, c.lidar_fd, c.imu_fd});
+    set_poll_socket(poller, c.lidar_fd);
+    set_poll_socket(poller, c.imu_fd);
 }
 
-int poll(client_poller& poller, int timeout_sec) {
-    timeval tv;
-    tv.tv_sec = timeout_sec;
-    tv.tv_usec = 0;
+#ifdef __linux__
+// bring the epoll registrations in line with the wanted set, only touching the
+// kernel for sockets that were added or removed since the last poll
+static bool sync_epoll(client_poller& poller) {
+    std::sort(poller.wanted.begin(), poller.wanted.end());
+    poller.wanted.erase(
+        std::unique(poller.wanted.begin(), poller.wanted.end()),
+        poller.wanted.end());
+    if (poller.wanted == poller.registered) return true;
+
+    for (auto sock : poller.registered) {
+        if (!std::binary_search(poller.wanted.begin(), poller.wanted.end(),
+                                sock)) {
+            epoll_ctl(poller.epoll_fd, EPOLL_CTL_DEL, sock, nullptr);
+        }
+    }
+    for (auto sock : poller.wanted) {
+        if (std::binary_search(poller.registered.begin(),
+                               poller.registered.end(), sock)) {
+            continue;
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = sock;
+        if (epoll_ctl(poller.epoll_fd, EPOLL_CTL_ADD, sock, &ev) != 0) {
+            logger().error("epoll_ctl: {}", impl::socket_get_error());
+            poller.registered.clear();
+            return false;
+        }
+    }
+    poller.registered = poller.wanted;
+    poller.events.resize(std::max<size_t>(poller.registered.size(), 1));
+    return true;
+}
+#endif
 
-    SOCKET retval =
-        select((int)poller.max_fd + 1, &poller.rfds, NULL, NULL, &tv);
+int poll_for(client_poller& poller, double timeout_sec) {
+    int retval;
+#ifdef __linux__
+    if (poller.backend == poller_backend::EPOLL) {
+        if (!sync_epoll(poller)) {
+            poller.err = client_state::CLIENT_ERROR;
+            return -1;
+        }
+        // round up so that sub-millisecond timeouts wait like they do with
+        // select instead of turning into a non-blocking poll
+        int timeout_ms = -1;
+        if (timeout_sec >= 0) {
+            timeout_ms = (int)std::min(std::ceil(timeout_sec * 1000.0),
+                                       (double)std::numeric_limits<int>::max());
+        }
+        retval = epoll_wait(poller.epoll_fd, poller.events.data(),
+                            (int)poller.events.size(), timeout_ms);
+        poller.ready.clear();
+        for (int i = 0; i < retval; i++) {
+            poller.ready.push_back(poller.events[i].data.fd);
+        }
+        std::sort(poller.ready.begin(), poller.ready.end());
+    } else
+#endif
+    {
+        timeval tv;
+        tv.tv_sec = (long)timeout_sec;
+        tv.tv_usec = (long)(std::fmod(timeout_sec, 1.0) * 1000000.0);
+        poller.rfds = poller.watch_fds;
+        retval = (int)select((int)poller.max_fd + 1, &poller.rfds, NULL, NULL,
+                             timeout_sec < 0 ? NULL : &tv);
+    }
 
     if (!impl::socket_valid(retval)) {
         if (impl::socket_exit()) {
             poller.err = client_state::EXIT;
         } else {
-            logger().error("select: {}", impl::socket_get_error());
+            logger().error("poll: {}", impl::socket_get_error());
             poller.err = client_state::CLIENT_ERROR;
         }
 
         return -1;
     }
 
-    return (int)retval;
+    return retval;
+}
+
+int poll(client_poller& poller, int timeout_sec) {
+    return poll_for(poller, timeout_sec);
 }
 
 client_state get_error(const client_poller& poller) { return poller.err; }
 
+bool get_poll_socket(const client_poller& poller, SOCKET sock) {
+#ifdef __linux__
+    if (poller.backend == poller_backend::EPOLL) {
+        return std::binary_search(poller.ready.begin(), poller.ready.end(),
+                                  sock);
+    }
+#endif
+#ifndef _WIN32
+    if (sock >= FD_SETSIZE) return false;
+#endif
+    return FD_ISSET(sock, &poller.rfds);
+}
+
 client_state get_poll(const client_poller& poller, const client& c) {
     client_state s = client_state(0);
 
-    if (FD_ISSET(c.lidar_fd, &poller.rfds)) s = client_state(s | LIDAR_DATA);
-    if (FD_ISSET(c.imu_fd, &poller.rfds)) s = client_state(s | IMU_DATA);
+    if (get_poll_socket(poller, c.lidar_fd)) s = client_state(s | LIDAR_DATA);
+    if (get_poll_socket(poller, c.imu_fd)) s = client_state(s | IMU_DATA);
 
     return s;
 }
@@ -549,7 +776,9 @@ client_state get_poll(const client_poller& poller, const client& c) {
 }  // namespace impl
 
 client_state poll_client(const client& c, const int timeout_sec) {
-    impl::client_poller poller;
+    // a one-shot poll is cheapest with select, epoll would need a new
+    // descriptor for every call
+    impl::client_poller poller{impl::poller_backend::SELECT};
     impl::reset_poll(poller);
     impl::set_poll(poller, c);
     int res = impl::poll(poller, timeout_sec);
@@ -561,10 +790,19 @@ client_state poll_client(const client& c, const int timeout_sec) {
     }
 }
 
-static bool recv_fixed(SOCKET fd, void* buf, int64_t len) {
+static bool recv_fixed(SOCKET fd, void* buf, int64_t len,
+                       uint64_t* ts = nullptr) {
     // Have to read longer than len because you need to know if the packet
     // is too large
-    int64_t bytes_read = recv(fd, (char*)buf, len + 1, 0);
+    int64_t bytes_read;
+    if (ts) {
+        uint64_t kernel_ts;
+        bytes_read =
+            impl::socket_recv_timestamped(fd, buf, len + 1, nullptr, kernel_ts);
+        if (kernel_ts) *ts = kernel_ts;
+    } else {
+        bytes_read = recv(fd, (char*)buf, len + 1, 0);
+    }
 
     if (bytes_read == len) {
         return true;
@@ -576,6 +814,29 @@ static bool recv_fixed(SOCKET fd, void* buf, int64_t len) {
     return false;
 }
 
+bool enable_receive_timestamps(client& cli, ReceiveTimestampMode mode,
+                               const std::string& interface) {
+    if (mode == ReceiveTimestampMode::USERSPACE) {
+        impl::socket_disable_timestamps(cli.lidar_fd);
+        impl::socket_disable_timestamps(cli.imu_fd);
+        cli.receive_timestamps = false;
+        return true;
+    }
+    bool hardware = mode == ReceiveTimestampMode::HARDWARE;
+    if (impl::socket_enable_timestamps(cli.lidar_fd, hardware, interface) ||
+        impl::socket_enable_timestamps(cli.imu_fd, hardware, interface)) {
+        logger().warn("failed to enable receive timestamps: {}",
+                      impl::socket_get_error());
+        // don't leave one of the sockets half configured
+        impl::socket_disable_timestamps(cli.lidar_fd);
+        impl::socket_disable_timestamps(cli.imu_fd);
+        cli.receive_timestamps = false;
+        return false;
+    }
+    cli.receive_timestamps = true;
+    return true;
+}
+
 bool read_lidar_packet(const client& cli, uint8_t* buf, size_t bytes) {
     return recv_fixed(cli.lidar_fd, buf, bytes);
 }
@@ -591,7 +852,9 @@ bool read_lidar_packet(const client& cli, LidarPacket& packet) {
         std::chrono::duration_cast<std::chrono::nanoseconds>(
             now.time_since_epoch())
             .count();
-    return read_lidar_packet(cli, packet.buf.data(), packet.buf.size());
+    return recv_fixed(cli.lidar_fd, packet.buf.data(), packet.buf.size(),
+                      cli.receive_timestamps ? &packet.host_timestamp
+                                             : nullptr);
 }
 
 bool read_imu_packet(const client& cli, uint8_t* buf, size_t bytes) {
@@ -608,7 +871,9 @@ bool read_imu_packet(const client& cli, ImuPacket& packet) {
         std::chrono::duration_cast<std::chrono::nanoseconds>(
             now.time_since_epoch())
             .count();
-    return read_imu_packet(cli, packet.buf.data(), packet.buf.size());
+    return recv_fixed(cli.imu_fd, packet.buf.data(), packet.buf.size(),
+                      cli.receive_timestamps ? &packet.host_timestamp
+                                             : nullptr);
 }
 
 int get_lidar_port(const client& cli) { return get_sock_port(cli.lidar_fd); }
@@ -0,0 +1,173 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/clock_model.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace ouster {
+namespace sensor {
+
+namespace {
+
+double median(std::vector<double>& v) {
+    const size_t mid = v.size() / 2;
+    std::nth_element(v.begin(), v.begin() + mid, v.end());
+    double m = v[mid];
+    if (v.size() % 2 == 0) {
+        m = (m + *std::max_element(v.begin(), v.begin() + mid)) / 2;
+    }
+    return m;
+}
+
+}  // namespace
+
+ClockModel::ClockModel(const ClockModelOptions& options) : options_(options) {
+    if (!(options_.window_sec > 0) || options_.intervals == 0) {
+        throw std::invalid_argument(
+            "ClockModel: window_sec and intervals must be positive");
+    }
+    interval_ns_ = std::max<int64_t>(
+        1, static_cast<int64_t>(options_.window_sec * 1e9 /
+                                static_cast<double>(options_.intervals)));
+}
+
+void ClockModel::add(uint64_t sensor_ts, uint64_t host_ts) {
+    if (sensor_ts == 0 || host_ts == 0) return;
+    if (last_sensor_ts_ != 0) {
+        const double jump =
+            std::fabs(static_cast<double>(
+                static_cast<int64_t>(sensor_ts - last_sensor_ts_))) *
+            1e-9;
+        if (jump > options_.reset_sec) {
+            intervals_.clear();
+            estimate_.resets++;
+        }
+    }
+    last_sensor_ts_ = sensor_ts;
+    dirty_ = true;
+
+    const int64_t delay = static_cast<int64_t>(host_ts - sensor_ts);
+    const int64_t index = static_cast<int64_t>(sensor_ts / interval_ns_);
+    if (intervals_.empty() || index > intervals_.back().index) {
+        intervals_.push_back({index, sensor_ts, delay});
+        const int64_t oldest =
+            index - static_cast<int64_t>(options_.intervals);
+        while (intervals_.front().index <= oldest) intervals_.pop_front();
+        return;
+    }
+
+    // out of order, usually within the newest interval
+    for (auto it = intervals_.rbegin(); it != intervals_.rend(); ++it) {
+        if (it->index == index) {
+            if (delay < it->delay) *it = {index, sensor_ts, delay};
+            return;
+        }
+        if (it->index < index) {
+            intervals_.insert(it.base(), {index, sensor_ts, delay});
+            return;
+        }
+    }
+    // older than the window
+}
+
+void ClockModel::add(const LidarScan& scan) {
+    const auto packet_ts = scan.packet_timestamp();
+    const auto column_ts = scan.timestamp();
+    const size_t packets = static_cast<size_t>(packet_ts.rows());
+    if (packets == 0) return;
+    const size_t per_packet = scan.w / packets;
+    for (size_t p = 0; p < packets; p++) {
+        if (packet_ts[p] == 0) continue;
+        // the packet is sent once its last column is measured
+        const size_t first = p * per_packet;
+        for (size_t col = std::min(first + per_packet, scan.w); col > first;
+             col--) {
+            if (column_ts[col - 1] != 0) {
+                add(column_ts[col - 1], packet_ts[p]);
+                break;
+            }
+        }
+    }
+}
+
+void ClockModel::fit() {
+    if (!dirty_) return;
+    dirty_ = false;
+    const size_t n = intervals_.size();
+    estimate_.valid = n > 0;
+    estimate_.intervals = n;
+    if (n == 0) return;
+
+    // relative to the newest sample, to keep the doubles exact
+    const Interval& ref = intervals_.back();
+    std::vector<double> x(n), y(n);
+    for (size_t i = 0; i < n; i++) {
+        x[i] = static_cast<double>(
+            static_cast<int64_t>(intervals_[i].sensor_ts - ref.sensor_ts));
+        y[i] = static_cast<double>(intervals_[i].delay - ref.delay);
+    }
+
+    double slope = 0;
+    std::vector<double> v;
+    v.reserve(n * (n - 1) / 2);
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = i + 1; j < n; j++) {
+            if (x[j] != x[i]) v.push_back((y[j] - y[i]) / (x[j] - x[i]));
+        }
+    }
+    if (!v.empty()) slope = median(v);
+
+    v.resize(n);
+    for (size_t i = 0; i < n; i++) v[i] = y[i] - slope * x[i];
+    const double intercept = median(v);
+    for (size_t i = 0; i < n; i++) v[i] = std::fabs(v[i] - intercept);
+
+    estimate_.sensor_ts = ref.sensor_ts;
+    estimate_.offset_ns = ref.delay + std::llround(intercept);
+    estimate_.skew_ppm = slope * 1e6;
+    estimate_.residual_ns = median(v);
+}
+
+ClockEstimate ClockModel::estimate() {
+    fit();
+    return estimate_;
+}
+
+uint64_t ClockModel::to_host(uint64_t sensor_ts) {
+    uint64_t host_ts;
+    to_host(&sensor_ts, 1, &host_ts);
+    return host_ts;
+}
+
+void ClockModel::to_host(const uint64_t* sensor_ts, size_t n,
+                         uint64_t* host_ts) {
+    fit();
+    if (!estimate_.valid) {
+        std::fill(host_ts, host_ts + n, uint64_t{0});
+        return;
+    }
+    const uint64_t ref = estimate_.sensor_ts;
+    const int64_t offset = estimate_.offset_ns;
+    const double skew = estimate_.skew_ppm * 1e-6;
+    for (size_t i = 0; i < n; i++) {
+        const uint64_t t = sensor_ts[i];
+        const double dt = static_cast<double>(static_cast<int64_t>(t - ref));
+        const int64_t correction = offset + std::llround(skew * dt);
+        host_ts[i] = t ? t + static_cast<uint64_t>(correction) : 0;
+    }
+}
+
+void ClockModel::reset() {
+    intervals_.clear();
+    last_sensor_ts_ = 0;
+    dirty_ = true;
+}
+
+}  // namespace sensor
+}  // namespace ouster
@@ -0,0 +1,116 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/column_dewarper.h"
+
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace ouster {
+
+ColumnDewarper::ColumnDewarper(XYZLut lut, size_t w, size_t h,
+                               PoseSource source, const mat4d& extrinsic)
+    : lut_(std::move(lut)),
+      w_(w),
+      h_(h),
+      source_(std::move(source)),
+      extrinsic_(extrinsic),
+      points_(pose_util::Points::Zero(w * h, 3)),
+      poses_(pose_util::Poses::Zero(w, 16)) {
+    const Eigen::Index n = static_cast<Eigen::Index>(w * h);
+    if (lut_.direction.rows() != n || lut_.offset.rows() != n) {
+        throw std::invalid_argument("unexpected lut dimensions");
+    }
+    if (!source_) {
+        throw std::invalid_argument("ColumnDewarper expects a pose source");
+    }
+    for (size_t c = 0; c < w; ++c) {
+        Eigen::Map<Eigen::Matrix<double, 4, 4, Eigen::RowMajor>>(
+            poses_.row(c).data())
+            .setIdentity();
+    }
+}
+
+ColumnDewarper::ColumnDewarper(
+    XYZLut lut, size_t w, size_t h,
+    const pose_util::TrajectoryEvaluator& trajectory, const mat4d& extrinsic)
+    : ColumnDewarper(
+          std::move(lut), w, h,
+          [trajectory](Eigen::Ref<pose_util::Poses> poses,
+                       const Eigen::Ref<const Eigen::ArrayXd>& ts) {
+              trajectory.poses_at(poses, ts);
+          },
+          extrinsic) {}
+
+void ColumnDewarper::dewarp(const LidarScan& scan,
+                            sensor::ColumnWindow window) {
+    const Eigen::Index W = static_cast<Eigen::Index>(w_);
+    const Eigen::Index H = static_cast<Eigen::Index>(h_);
+    if (scan.w != w_ || scan.h != h_) {
+        throw std::invalid_argument("scan doesn't match the lut");
+    }
+    const Eigen::Index first = window.first;
+    const Eigen::Index last = window.second;
+    if (first < 0 || first >= W || last < 0 || last >= W) {
+        throw std::invalid_argument("column window out of the scan");
+    }
+    const Eigen::Index n =
+        last >= first ? last - first + 1 : W - first + last + 1;
+
+    const auto ts = scan.timestamp();
+    ts_.resize(n);
+    for (Eigen::Index k = 0; k < n; ++k) {
+        ts_(k) = static_cast<double>(ts((first + k) % W));
+    }
+    window_poses_.resize(n, 16);
+    source_(window_poses_, ts_);
+
+    // extrinsic * pose of every column, as rotation and translation
+    using Affine = Eigen::Matrix<double, 3, 4>;
+    std::vector<Affine, Eigen::aligned_allocator<Affine>> columns(n);
+    for (Eigen::Index k = 0; k < n; ++k) {
+        poses_.row((first + k) % W) = window_poses_.row(k);
+        Eigen::Map<const Eigen::Matrix<double, 4, 4, Eigen::RowMajor>> pose(
+            window_poses_.row(k).data());
+        columns[k] = (extrinsic_ * pose).topRows<3>();
+    }
+
+    const auto range = scan.field<uint32_t>(sensor::ChanField::RANGE);
+    const Eigen::Index N = W * H;
+    const uint32_t* rng = range.data();
+    const double* dir = lut_.direction.data();
+    const double* ofs = lut_.offset.data();
+#ifdef __OUSTER_UTILIZE_OPENMP__
+#pragma omp parallel for schedule(static)
+#endif
+    for (Eigen::Index r = 0; r < H; ++r) {
+        for (Eigen::Index k = 0; k < n; ++k) {
+            const Affine& m = columns[k];
+            const Eigen::Index ix = r * W + (first + k) % W;
+            if (rng[ix] == 0) {
+                points_.row(ix) = m.col(3).transpose();
+                continue;
+            }
+            const double d = rng[ix];
+            const Eigen::Vector3d p(d * dir[ix] + ofs[ix],
+                                    d * dir[N + ix] + ofs[N + ix],
+                                    d * dir[2 * N + ix] + ofs[2 * N + ix]);
+            points_.row(ix) = (m.leftCols<3>() * p + m.col(3)).transpose();
+        }
+    }
+}
+
+void ColumnDewarper::dewarp(const ScanSector& sector) {
+    if (sector.width() == 0) return;
+    dewarp(*sector.scan, {static_cast<int>(sector.start_col),
+                          static_cast<int>(sector.end_col - 1)});
+}
+
+const pose_util::Points& ColumnDewarper::points() const { return points_; }
+
+const pose_util::Poses& ColumnDewarper::poses() const { return poses_; }
+
+}  // namespace ouster
@@ -0,0 +1,200 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/content_hash.h"
+
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ouster {
+
+namespace {
+
+constexpr uint64_t prime32_1 = 0x9E3779B1ULL;
+constexpr uint64_t prime64_1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t prime64_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t prime64_3 = 0x165667B19E3779F9ULL;
+
+constexpr size_t lanes = 8;
+constexpr size_t stripe_bytes = lanes * sizeof(uint64_t);
+constexpr size_t stripes_per_block = 16;
+
+// keys of the stripes of a block, slid by a lane per stripe like the secret
+// of XXH3, drawn from the fractional digits of pi
+constexpr std::array<uint64_t, stripes_per_block + lanes> keys{
+    {0x243F6A8885A308D3ULL, 0x13198A2E03707344ULL, 0xA4093822299F31D0ULL,
+     0x082EFA98EC4E6C89ULL, 0x452821E638D01377ULL, 0xBE5466CF34E90C6CULL,
+     0xC0AC29B7C97C50DDULL, 0x3F84D5B5B5470917ULL, 0x9216D5D98979FB1BULL,
+     0xD1310BA698DFB5ACULL, 0x2FFD72DBD01ADFB7ULL, 0xB8E1AFED6A267E96ULL,
+     0xBA7C9045F12C7F99ULL, 0x24A19947B3916CF7ULL, 0x0801F2E2858EFC16ULL,
+     0x636920D871574E69ULL, 0xA458FEA3F4933D7EULL, 0x0D95748F728EB658ULL,
+     0x718BCD5882154AEEULL, 0x7B54A41DC25A59B5ULL, 0x9C30D5392AF26013ULL,
+     0xC5D1B023286085F0ULL, 0xCA417918B8DB38EFULL, 0x8E79DCB0603A180EULL}};
+
+uint64_t read64(const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+// high and low halves of the 128-bit product folded together
+uint64_t mul_fold(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    const unsigned __int128 p = static_cast<unsigned __int128>(a) * b;
+    return static_cast<uint64_t>(p) ^ static_cast<uint64_t>(p >> 64);
+#else
+    const uint64_t lo_lo = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+    const uint64_t hi_lo = (a >> 32) * (b & 0xFFFFFFFF);
+    const uint64_t lo_hi = (a & 0xFFFFFFFF) * (b >> 32);
+    const uint64_t hi_hi = (a >> 32) * (b >> 32);
+    const uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+    const uint64_t hi = hi_hi + (hi_lo >> 32) + (cross >> 32);
+    const uint64_t lo = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+    return lo ^ hi;
+#endif
+}
+
+uint64_t avalanche(uint64_t h) {
+    h ^= h >> 37;
+    h *= 0x165667919E3779F9ULL;
+    return h ^ (h >> 32);
+}
+
+// the accumulation of XXH3: independent lanes of 32 x 32 bit multiplies
+// that the compiler turns into vector multiplies
+void accumulate(uint64_t* acc, const uint8_t* stripe, const uint64_t* key) {
+    for (size_t i = 0; i < lanes; i++) {
+        const uint64_t data = read64(stripe + i * sizeof(uint64_t));
+        const uint64_t data_key = data ^ key[i];
+        acc[i ^ 1] += data;
+        acc[i] += (data_key & 0xFFFFFFFF) * (data_key >> 32);
+    }
+}
+
+void scramble(uint64_t* acc) {
+    for (size_t i = 0; i < lanes; i++) {
+        uint64_t a = acc[i];
+        a ^= a >> 47;
+        a ^= keys[stripes_per_block + i];
+        acc[i] = a * prime32_1;
+    }
+}
+
+uint64_t hash_short(const uint8_t* p, size_t size, uint64_t seed) {
+    // up to 16 bytes, as two overlapping words or a padded one
+    uint64_t lo = 0;
+    uint64_t hi = 0;
+    if (size >= 8) {
+        lo = read64(p);
+        hi = read64(p + size - 8);
+    } else {
+        if (size) std::memcpy(&lo, p, size);
+    }
+    const uint64_t mixed = mul_fold(lo ^ (keys[0] + seed),
+                                    hi ^ (keys[1] - seed) ^ size * prime64_1);
+    return avalanche(mixed + size + rotl(seed, 17));
+}
+
+uint64_t combine_field(uint64_t acc, const std::string& name,
+                       const Field& field) {
+    // summed, so that the order of the fields doesn't matter
+    const uint64_t h = hash_bytes(name.data(), name.size(),
+                                  content_hash(field));
+    return acc + avalanche(h ^ prime64_2);
+}
+
+}  // namespace
+
+uint64_t hash_bytes(const void* data, size_t size, uint64_t seed) {
+    const auto* p = static_cast<const uint8_t*>(data);
+    if (size <= 16) return hash_short(p, size, seed);
+
+    uint64_t acc[lanes] = {prime32_1,        prime64_1 + seed, prime64_2,
+                           prime64_3 - seed, prime64_1 ^ seed, prime64_2 + seed,
+                           prime64_3,        prime32_1 - seed};
+
+    const size_t block_bytes = stripe_bytes * stripes_per_block;
+    const size_t blocks = (size - 1) / block_bytes;
+    for (size_t b = 0; b < blocks; b++) {
+        const uint8_t* block = p + b * block_bytes;
+        for (size_t s = 0; s < stripes_per_block; s++) {
+            accumulate(acc, block + s * stripe_bytes, keys.data() + s);
+        }
+        scramble(acc);
+    }
+
+    // the rest of the last block, its last stripe zero padded
+    const uint8_t* rest = p + blocks * block_bytes;
+    const size_t rest_bytes = size - blocks * block_bytes;
+    const size_t full = (rest_bytes - 1) / stripe_bytes;
+    for (size_t s = 0; s < full; s++) {
+        accumulate(acc, rest + s * stripe_bytes, keys.data() + s);
+    }
+    uint8_t last[stripe_bytes] = {};
+    std::memcpy(last, rest + full * stripe_bytes,
+                rest_bytes - full * stripe_bytes);
+    accumulate(acc, last, keys.data() + full);
+
+    uint64_t h = size * prime64_1 + seed;
+    for (size_t i = 0; i < lanes; i += 2) {
+        h += mul_fold(acc[i] ^ keys[i + 3], acc[i + 1] ^ keys[i + 4]);
+    }
+    return avalanche(h);
+}
+
+uint64_t content_hash(const Field& field) {
+    const FieldDescriptor& desc = field.desc();
+    uint64_t header[3] = {static_cast<uint64_t>(desc.tag()),
+                          static_cast<uint64_t>(desc.element_size),
+                          static_cast<uint64_t>(field.field_class())};
+    uint64_t h = hash_bytes(header, sizeof(header), desc.shape.size());
+    if (!desc.shape.empty()) {
+        std::vector<uint64_t> shape(desc.shape.begin(), desc.shape.end());
+        h = hash_bytes(shape.data(), shape.size() * sizeof(uint64_t), h);
+    }
+    return hash_bytes(field.get(), field.bytes(), h);
+}
+
+uint64_t content_hash(const LidarScan& scan) {
+    const uint64_t header[4] = {static_cast<uint64_t>(scan.frame_id),
+                                static_cast<uint64_t>(scan.w),
+                                static_cast<uint64_t>(scan.h),
+                                scan.frame_status};
+    uint64_t h = hash_bytes(header, sizeof(header));
+    const auto mid = scan.measurement_id();
+    h = hash_bytes(mid.data(), mid.size() * sizeof(uint16_t), h);
+    const auto ts = scan.timestamp();
+    h = hash_bytes(ts.data(), ts.size() * sizeof(uint64_t), h);
+    const auto pts = scan.packet_timestamp();
+    h = hash_bytes(pts.data(), pts.size() * sizeof(uint64_t), h);
+    const uint64_t pose = content_hash(scan.pose());
+    h = hash_bytes(&pose, sizeof(pose), h);
+
+    uint64_t fields = 0;
+    for (const auto& f : scan.fields()) {
+        fields = combine_field(fields, f.first, f.second);
+    }
+    return avalanche(h ^ mul_fold(fields, prime64_3));
+}
+
+HashedScan::HashedScan(std::shared_ptr<const LidarScan> s)
+    : scan(std::move(s)), hash(0) {
+    if (!scan) throw std::invalid_argument("HashedScan: scan is null");
+    hash = content_hash(*scan);
+}
+
+bool operator==(const HashedScan& a, const HashedScan& b) {
+    return a.hash == b.hash && (a.scan == b.scan || *a.scan == *b.scan);
+}
+
+bool operator!=(const HashedScan& a, const HashedScan& b) { return !(a == b); }
+
+}  // namespace ouster
@@ -0,0 +1,225 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include <thrust/copy.h>
+#include <thrust/device_ptr.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/permutation_iterator.h>
+#include <thrust/iterator/transform_iterator.h>
+#include <thrust/sort.h>
+#include <thrust/system/cuda/execution_policy.h>
+
+#include <stdexcept>
+#include <string>
+
+#include "cuda_kernels.h"
+#include "ouster/impl/cuda_macros.h"
+
+namespace ouster {
+namespace cuda {
+namespace impl {
+
+namespace {
+
+constexpr unsigned block_size = 256;
+
+unsigned blocks_for(size_t n) {
+    return static_cast<unsigned>((n + block_size - 1) / block_size);
+}
+
+void check_launch(const char* what) {
+    cudaError_t err = cudaGetLastError();
+    if (err != cudaSuccess) {
+        throw std::runtime_error(std::string(what) +
+                                 " failed: " + cudaGetErrorString(err));
+    }
+}
+
+__global__ void cartesian_kernel(const uint32_t* RESTRICT range,
+                                 const float* RESTRICT direction,
+                                 const float* RESTRICT offset, size_t n,
+                                 bool interleaved, float* RESTRICT xyz) {
+    const size_t i = blockIdx.x * static_cast<size_t>(blockDim.x) + threadIdx.x;
+    if (i >= n) return;
+
+    const uint32_t r = range[i];
+    float p[3] = {0.0f, 0.0f, 0.0f};
+    if (r != 0) {
+        const float rf = static_cast<float>(r);
+        for (int c = 0; c < 3; ++c)
+            p[c] = fmaf(rf, direction[c * n + i], offset[c * n + i]);
+    }
+    for (int c = 0; c < 3; ++c) {
+        if (interleaved)
+            xyz[3 * i + c] = p[c];
+        else
+            xyz[c * n + i] = p[c];
+    }
+}
+
+template <typename P>
+__global__ void destagger_kernel(const P* RESTRICT img, P* RESTRICT out,
+                                 size_t w, size_t h,
+                                 const int* RESTRICT pixel_shift_by_row,
+                                 bool inverse) {
+    const size_t v = blockIdx.x * static_cast<size_t>(blockDim.x) + threadIdx.x;
+    const size_t u = blockIdx.y;
+    if (v >= w || u >= h) return;
+
+    const long long sw = static_cast<long long>(w);
+    const long long shift = (inverse ? -1 : 1) * pixel_shift_by_row[u];
+    const size_t offset = static_cast<size_t>(((shift % sw) + sw) % sw);
+    out[u * w + (v + offset) % w] = img[u * w + v];
+}
+
+__global__ void destagger_bytes_kernel(const uint8_t* RESTRICT img,
+                                       uint8_t* RESTRICT out,
+                                       size_t pixel_bytes, size_t w, size_t h,
+                                       const int* RESTRICT pixel_shift_by_row,
+                                       bool inverse) {
+    const size_t v = blockIdx.x * static_cast<size_t>(blockDim.x) + threadIdx.x;
+    const size_t u = blockIdx.y;
+    if (v >= w || u >= h) return;
+
+    const long long sw = static_cast<long long>(w);
+    const long long shift = (inverse ? -1 : 1) * pixel_shift_by_row[u];
+    const size_t offset = static_cast<size_t>(((shift % sw) + sw) % sw);
+    const uint8_t* src = img + (u * w + v) * pixel_bytes;
+    uint8_t* dst = out + (u * w + (v + offset) % w) * pixel_bytes;
+    for (size_t b = 0; b < pixel_bytes; ++b) dst[b] = src[b];
+}
+
+__global__ void dewarp_kernel(const float* points, const double* RESTRICT poses,
+                              size_t w, size_t h, float* dewarped) {
+    const size_t i = blockIdx.x * static_cast<size_t>(blockDim.x) + threadIdx.x;
+    const size_t n = w * h;
+    if (i >= n) return;
+
+    const double* m = poses + 16 * (i % w);
+    const double x = points[i], y = points[n + i], z = points[2 * n + i];
+    for (int c = 0; c < 3; ++c) {
+        dewarped[c * n + i] = static_cast<float>(
+            m[4 * c] * x + m[4 * c + 1] * y + m[4 * c + 2] * z + m[4 * c + 3]);
+    }
+}
+
+__global__ void affine_clamp_kernel(float* image, size_t n, float scale,
+                                    float offset) {
+    const size_t i = blockIdx.x * static_cast<size_t>(blockDim.x) + threadIdx.x;
+    if (i >= n) return;
+    image[i] = fminf(fmaxf(fmaf(image[i], scale, offset), 0.0f), 1.0f);
+}
+
+struct strided {
+    size_t stride;
+    OSDK_FN size_t operator()(size_t i) const { return i * stride; }
+};
+
+struct positive {
+    OSDK_FN bool operator()(float x) const { return x > 0.0f; }
+};
+
+}  // namespace
+
+void launch_cartesian(const uint32_t* range, const float* direction,
+                      const float* offset, size_t n, bool interleaved,
+                      float* xyz, cudaStream_t stream) {
+    if (n == 0) return;
+    cartesian_kernel<<<blocks_for(n), block_size, 0, stream>>>(
+        range, direction, offset, n, interleaved, xyz);
+    check_launch("cartesian kernel");
+}
+
+void launch_destagger(const void* img, void* out, size_t pixel_bytes, size_t w,
+                      size_t h, const int* pixel_shift_by_row, bool inverse,
+                      cudaStream_t stream) {
+    if (w == 0 || h == 0) return;
+    const dim3 grid(blocks_for(w), static_cast<unsigned>(h));
+    switch (pixel_bytes) {
+        case 1:
+            destagger_kernel<<<grid, block_size, 0, stream>>>(
+                static_cast<const uint8_t*>(img), static_cast<uint8_t*>(out),
+                w, h, pixel_shift_by_row, inverse);
+            break;
+        case 2:
+            destagger_kernel<<<grid, block_size, 0, stream>>>(
+                static_cast<const uint16_t*>(img), static_cast<uint16_t*>(out),
+                w, h, pixel_shift_by_row, inverse);
+            break;
+        case 4:
+            destagger_kernel<<<grid, block_size, 0, stream>>>(
+                static_cast<const uint32_t*>(img), static_cast<uint32_t*>(out),
+                w, h, pixel_shift_by_row, inverse);
+            break;
+        case 8:
+            destagger_kernel<<<grid, block_size, 0, stream>>>(
+                static_cast<const uint64_t*>(img), static_cast<uint64_t*>(out),
+                w, h, pixel_shift_by_row, inverse);
+            break;
+        default:
+            destagger_bytes_kernel<<<grid, block_size, 0, stream>>>(
+                static_cast<const uint8_t*>(img), static_cast<uint8_t*>(out),
+                pixel_bytes, w, h, pixel_shift_by_row, inverse);
+            break;
+    }
+    check_launch("destagger kernel");
+}
+
+void launch_dewarp(const float* points, const double* poses, size_t w,
+                   size_t h, float* dewarped, cudaStream_t stream) {
+    const size_t n = w * h;
+    if (n == 0) return;
+    dewarp_kernel<<<blocks_for(n), block_size, 0, stream>>>(points, poses, w, h,
+                                                            dewarped);
+    check_launch("dewarp kernel");
+}
+
+size_t launch_percentiles(const float* image, size_t n, size_t stride,
+                          float* samples, double lo_percentile,
+                          double hi_percentile, size_t min_samples,
+                          float* percentiles, cudaStream_t stream) {
+    auto policy = thrust::cuda::par.on(stream);
+    auto values = thrust::make_permutation_iterator(
+        thrust::device_pointer_cast(image),
+        thrust::make_transform_iterator(
+            thrust::make_counting_iterator<size_t>(0), strided{stride}));
+    const size_t count = (n + stride - 1) / stride;
+    auto first = thrust::device_pointer_cast(samples);
+    auto last =
+        thrust::copy_if(policy, values, values + count, first, positive{});
+    const size_t m = static_cast<size_t>(last - first);
+    if (m < min_samples) return m;
+
+    // a full sort is the GPU equivalent of the two nth_elements on the CPU
+    thrust::sort(policy, first, last);
+
+    const size_t lo_kth = static_cast<size_t>(m * lo_percentile);
+    const size_t hi_kth = static_cast<size_t>(m * hi_percentile);
+    cudaError_t err = cudaMemcpyAsync(&percentiles[0], samples + lo_kth,
+                                      sizeof(float), cudaMemcpyDeviceToHost,
+                                      stream);
+    if (err == cudaSuccess) {
+        err = cudaMemcpyAsync(&percentiles[1], samples + (m - hi_kth - 1),
+                              sizeof(float), cudaMemcpyDeviceToHost, stream);
+    }
+    if (err == cudaSuccess) err = cudaStreamSynchronize(stream);
+    if (err != cudaSuccess) {
+        throw std::runtime_error(std::string("percentile copy failed: ") +
+                                 cudaGetErrorString(err));
+    }
+    return m;
+}
+
+void launch_affine_clamp(float* image, size_t n, float scale, float offset,
+                         cudaStream_t stream) {
+    if (n == 0) return;
+    affine_clamp_kernel<<<blocks_for(n), block_size, 0, stream>>>(
+        image, n, scale, offset);
+    check_launch("autoexposure kernel");
+}
+
+}  // namespace impl
+}  // namespace cuda
+}  // namespace ouster
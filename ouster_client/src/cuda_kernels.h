@@ -0,0 +1,54 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Kernel launchers of the CUDA backend. Kept free of Eigen and SDK
+ * types so that only cuda_kernels.cu goes through nvcc.
+ */
+
+#pragma once
+
+#include <cuda_runtime_api.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ouster {
+namespace cuda {
+namespace impl {
+
+/// Project n ranges through planar n x 3 direction and offset tables, writing
+/// planar or interleaved points
+void launch_cartesian(const uint32_t* range, const float* direction,
+                      const float* offset, size_t n, bool interleaved,
+                      float* xyz, cudaStream_t stream);
+
+/// Shift each row of an h x w field of pixel_bytes sized pixels
+void launch_destagger(const void* img, void* out, size_t pixel_bytes, size_t w,
+                      size_t h, const int* pixel_shift_by_row, bool inverse,
+                      cudaStream_t stream);
+
+/// Transform planar w * h points with the row major 4x4 pose of their column
+void launch_dewarp(const float* points, const double* poses, size_t w,
+                   size_t h, float* dewarped, cudaStream_t stream);
+
+/// Gather the positive values among every stride-th pixel into samples, which
+/// has room for n / stride + 1 values, sort them and copy the values at
+/// lo_percentile and 1 - hi_percentile into the two host floats of
+/// percentiles. Synchronizes the stream.
+///
+/// @return the number of positive values gathered. percentiles is only
+///         written if it's at least min_samples.
+size_t launch_percentiles(const float* image, size_t n, size_t stride,
+                          float* samples, double lo_percentile,
+                          double hi_percentile, size_t min_samples,
+                          float* percentiles, cudaStream_t stream);
+
+/// Map every pixel x to clamp(x * scale + offset, 0, 1)
+void launch_affine_clamp(float* image, size_t n, float scale, float offset,
+                         cudaStream_t stream);
+
+}  // namespace impl
+}  // namespace cuda
+}  // namespace ouster
@@ -0,0 +1,314 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/cuda_scan.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "cuda_kernels.h"
+
+namespace ouster {
+namespace cuda {
+
+namespace {
+
+// device allocations are aligned to 256 bytes, keep fields aligned the same
+const size_t field_alignment = 256;
+
+size_t align_up(size_t n) {
+    return (n + field_alignment - 1) / field_alignment * field_alignment;
+}
+
+/*
+ * AutoExposure tuning, the same as viz::AutoExposure
+ */
+const double ae_damping = 0.90;
+const int ae_default_update_every = 3;
+const size_t ae_stride = 4;
+const size_t ae_min_nonzero_points = 100;
+const double ae_default_percentile = 0.1;
+
+}  // namespace
+
+namespace impl {
+
+void check(cudaError_t err, const char* what) {
+    if (err != cudaSuccess) {
+        throw std::runtime_error(std::string(what) +
+                                 " failed: " + cudaGetErrorString(err));
+    }
+}
+
+void destagger(const void* img, void* out, size_t pixel_bytes, size_t w,
+               size_t h, const int* pixel_shift_by_row, bool inverse,
+               cudaStream_t stream) {
+    launch_destagger(img, out, pixel_bytes, w, h, pixel_shift_by_row, inverse,
+                     stream);
+}
+
+}  // namespace impl
+
+DeviceScan::DeviceScan(const LidarScan& layout,
+                       const std::vector<std::string>& fields)
+    : w(layout.w), h(layout.h) {
+    for (const auto& ft : layout.field_types()) {
+        if (fields.empty() ||
+            std::find(fields.begin(), fields.end(), ft.name) != fields.end()) {
+            field_types_.push_back(ft);
+        }
+    }
+    for (const auto& name : fields) {
+        if (!layout.has_field(name)) {
+            throw std::invalid_argument("DeviceScan: layout lacks field '" +
+                                        name + "'");
+        }
+    }
+
+    size_t bytes = 0;
+    for (const auto& ft : field_types_) {
+        const FieldDescriptor& desc = layout.field(ft.name).desc();
+        fields_.emplace(ft.name, entry{desc, bytes});
+        bytes += align_up(desc.bytes());
+    }
+    pose_offset_ = bytes;
+    bytes += layout.pose().bytes();
+    arena_.resize(bytes);
+}
+
+bool DeviceScan::has_field(const std::string& name) const {
+    return fields_.count(name) != 0;
+}
+
+const FieldDescriptor& DeviceScan::desc(const std::string& name) const {
+    auto it = fields_.find(name);
+    if (it == fields_.end()) {
+        throw std::invalid_argument("DeviceScan: no field '" + name + "'");
+    }
+    return it->second.desc;
+}
+
+const LidarScanFieldTypes& DeviceScan::field_types() const {
+    return field_types_;
+}
+
+void* DeviceScan::field(const std::string& name) {
+    auto it = fields_.find(name);
+    if (it == fields_.end()) {
+        throw std::invalid_argument("DeviceScan: no field '" + name + "'");
+    }
+    return arena_.data() + it->second.offset;
+}
+
+const void* DeviceScan::field(const std::string& name) const {
+    return const_cast<DeviceScan*>(this)->field(name);
+}
+
+double* DeviceScan::pose() {
+    return reinterpret_cast<double*>(arena_.data() + pose_offset_);
+}
+
+const double* DeviceScan::pose() const {
+    return reinterpret_cast<const double*>(arena_.data() + pose_offset_);
+}
+
+void DeviceScan::download(LidarScan& dst, cudaStream_t stream) const {
+    if (dst.w != w || dst.h != h) {
+        throw std::invalid_argument(
+            "DeviceScan: scan dimensions don't match the device scan");
+    }
+    for (const auto& kv : fields_) {
+        if (!dst.has_field(kv.first) ||
+            !(dst.field(kv.first).desc() == kv.second.desc)) {
+            throw std::invalid_argument("DeviceScan: scan field '" + kv.first +
+                                        "' doesn't match the device scan");
+        }
+    }
+
+    for (const auto& kv : fields_) {
+        impl::check(cudaMemcpyAsync(dst.field(kv.first).get(),
+                                    arena_.data() + kv.second.offset,
+                                    kv.second.desc.bytes(),
+                                    cudaMemcpyDeviceToHost, stream),
+                    "cudaMemcpyAsync");
+    }
+    impl::check(cudaMemcpyAsync(dst.pose().get(), pose(), dst.pose().bytes(),
+                                cudaMemcpyDeviceToHost, stream),
+                "cudaMemcpyAsync");
+    impl::check(cudaStreamSynchronize(stream), "cudaStreamSynchronize");
+}
+
+ScanUploader::ScanUploader() {
+    impl::check(cudaEventCreateWithFlags(&copied_, cudaEventDisableTiming),
+                "cudaEventCreate");
+}
+
+ScanUploader::~ScanUploader() {
+    if (copied_) {
+        cudaEventSynchronize(copied_);
+        cudaEventDestroy(copied_);
+    }
+}
+
+void ScanUploader::upload(const LidarScan& src, DeviceScan& dst,
+                          cudaStream_t stream) {
+    if (src.w != dst.w || src.h != dst.h) {
+        throw std::invalid_argument(
+            "ScanUploader: scan dimensions don't match the device scan");
+    }
+    for (const auto& kv : dst.fields_) {
+        if (!src.has_field(kv.first) ||
+            !(src.field(kv.first).desc() == kv.second.desc)) {
+            throw std::invalid_argument("ScanUploader: scan field '" +
+                                        kv.first +
+                                        "' doesn't match the device scan");
+        }
+    }
+
+    // the previous upload may still be reading the staging buffer
+    impl::check(cudaEventSynchronize(copied_), "cudaEventSynchronize");
+    staging_.resize(dst.arena_.size());
+
+    for (const auto& kv : dst.fields_) {
+        std::memcpy(staging_.data() + kv.second.offset,
+                    src.field(kv.first).get(), kv.second.desc.bytes());
+    }
+    std::memcpy(staging_.data() + dst.pose_offset_, src.pose().get(),
+                src.pose().bytes());
+
+    dst.arena_.copy_from(staging_.data(), staging_.size(), stream);
+    impl::check(cudaEventRecord(copied_, stream), "cudaEventRecord");
+}
+
+DeviceXYZLut make_device_xyz_lut(const XYZLutF& lut) {
+    DeviceXYZLut out;
+    out.n = lut.direction.rows();
+    out.direction.resize(3 * out.n);
+    out.offset.resize(3 * out.n);
+    out.direction.copy_from(lut.direction.data(), 3 * out.n);
+    out.offset.copy_from(lut.offset.data(), 3 * out.n);
+    impl::check(cudaStreamSynchronize(0), "cudaStreamSynchronize");
+    return out;
+}
+
+void cartesian(const uint32_t* range, const DeviceXYZLut& lut, float* xyz,
+               cudaStream_t stream) {
+    impl::launch_cartesian(range, lut.direction.data(), lut.offset.data(),
+                           lut.n, false, xyz, stream);
+}
+
+void cartesian(const DeviceScan& scan, const DeviceXYZLut& lut, float* xyz,
+               cudaStream_t stream) {
+    if (scan.w * scan.h != lut.n) {
+        throw std::invalid_argument("cartesian: scan and lut sizes differ");
+    }
+    cartesian(scan.field<uint32_t>(sensor::ChanField::RANGE), lut, xyz,
+              stream);
+}
+
+void cartesian_interleaved(const uint32_t* range, const DeviceXYZLut& lut,
+                           float* xyz, cudaStream_t stream) {
+    impl::launch_cartesian(range, lut.direction.data(), lut.offset.data(),
+                           lut.n, true, xyz, stream);
+}
+
+void destagger(const DeviceScan& scan, const std::string& name, void* out,
+               const int* pixel_shift_by_row, bool inverse,
+               cudaStream_t stream) {
+    const auto& types = scan.field_types();
+    auto ft = std::find_if(types.begin(), types.end(),
+                           [&](const FieldType& t) { return t.name == name; });
+    if (ft == types.end() || ft->field_class != FieldClass::PIXEL_FIELD) {
+        throw std::invalid_argument("destagger: no pixel field '" + name +
+                                    "'");
+    }
+    const size_t pixel_bytes = scan.desc(name).bytes() / (scan.w * scan.h);
+    impl::destagger(scan.field(name), out, pixel_bytes, scan.w, scan.h,
+                    pixel_shift_by_row, inverse, stream);
+}
+
+void dewarp(const float* points, const double* poses, size_t w, size_t h,
+            float* dewarped, cudaStream_t stream) {
+    impl::launch_dewarp(points, poses, w, h, dewarped, stream);
+}
+
+AutoExposure::AutoExposure()
+    : lo_percentile(ae_default_percentile),
+      hi_percentile(ae_default_percentile),
+      ae_update_every(ae_default_update_every),
+      percentiles_(2) {}
+
+AutoExposure::AutoExposure(int update_every)
+    : lo_percentile(ae_default_percentile),
+      hi_percentile(ae_default_percentile),
+      ae_update_every(update_every),
+      percentiles_(2) {}
+
+AutoExposure::AutoExposure(double lo_percentile, double hi_percentile,
+                           int update_every)
+    : lo_percentile(lo_percentile),
+      hi_percentile(hi_percentile),
+      ae_update_every(update_every),
+      percentiles_(2) {}
+
+void AutoExposure::operator()(float* image, size_t n, bool update_state,
+                              cudaStream_t stream) {
+    if (counter == 0 && update_state) {
+        samples_.resize(std::max(samples_.size(), n / ae_stride + 1));
+        const size_t m = impl::launch_percentiles(
+            image, n, ae_stride, samples_.data(), lo_percentile,
+            hi_percentile, ae_min_nonzero_points, percentiles_.data(), stream);
+        if (m < ae_min_nonzero_points) {
+            // too few nonzero values, nothing to do
+            return;
+        }
+        lo = percentiles_.data()[0];
+        hi = percentiles_.data()[1];
+
+        if (!initialized) {
+            initialized = true;
+            lo_state = lo;
+            hi_state = hi;
+        }
+    }
+    if (!initialized) {
+        return;
+    }
+
+    // we use the simplest form of exponential smoothing
+    if (update_state) {
+        lo_state = ae_damping * lo_state + (1.0 - ae_damping) * lo;
+        hi_state = ae_damping * hi_state + (1.0 - ae_damping) * hi;
+    }
+
+    // Same mapping as viz::AutoExposure, folded into a single scale and
+    // offset applied on the device
+    double scale, offset;
+    double lo_hi_scale =
+        (1.0 - (lo_percentile + hi_percentile)) / (hi_state - lo_state);
+
+    if (std::isinf(lo_hi_scale) || std::isnan(lo_hi_scale)) {
+        scale = 0.5 / hi_state;
+        offset = 0.0;
+    } else if (lo_hi_scale * (0.0 - lo_state) + lo_percentile <= 0.00) {
+        scale = lo_hi_scale;
+        offset = lo_percentile - lo_state * lo_hi_scale;
+    } else {
+        scale = (1.0 - hi_percentile) / hi_state;
+        offset = 0.0;
+    }
+    impl::launch_affine_clamp(image, n, static_cast<float>(scale),
+                              static_cast<float>(offset), stream);
+
+    if (update_state) {
+        counter = (counter + 1) % ae_update_every;
+    }
+}
+
+}  // namespace cuda
+}  // namespace ouster
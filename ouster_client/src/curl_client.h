@@ -20,16 +20,26 @@ class CurlClient : public ouster::util::HttpClient {
 
    public:
     CurlClient(const std::string& base_url_) : HttpClient(base_url_) {
-        curl_global_init(CURL_GLOBAL_ALL);
+        global_init();
         curl_handle = curl_easy_init();
         curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION,
                          &CurlClient::write_memory_callback);
         curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, this);
+        // the handle keeps its connection open between requests, probe it so
+        // that idle connections to the sensor aren't silently dropped
+        curl_easy_setopt(curl_handle, CURLOPT_TCP_KEEPALIVE, 1L);
     }
 
-    virtual ~CurlClient() override {
-        curl_easy_cleanup(curl_handle);
-        curl_global_cleanup();
+    virtual ~CurlClient() override { curl_easy_cleanup(curl_handle); }
+
+    /**
+     * Initializes libcurl once per process. curl_global_init isn't thread safe
+     * and cleaning up after each client would tear down the state shared by
+     * every other client, so it is never cleaned up.
+     */
+    static void global_init() {
+        static std::once_flag once;
+        std::call_once(once, [] { curl_global_init(CURL_GLOBAL_ALL); });
     }
 
    public:
@@ -69,7 +79,6 @@ class CurlClient : public ouster::util::HttpClient {
         return std::string(encoded_str.get());
     }
 
-   private:
     static std::string url_combine(const std::string& url1,
                                    const std::string& url2) {
         if (!url1.empty() && !url2.empty()) {
@@ -84,6 +93,7 @@ class CurlClient : public ouster::util::HttpClient {
         return url1 + url2;
     }
 
+   private:
     std::string execute_request(RequestType type, const std::string& url,
                                 int timeout_seconds, const char* data = 0,
                                 int attempts = 3,
@@ -0,0 +1,132 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/deskew_input.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace ouster {
+
+DeskewInput::DeskewInput(std::vector<XYZLut> luts)
+    : luts_(std::move(luts)), column_times_(luts_.size()) {
+    if (luts_.empty()) {
+        throw std::invalid_argument("DeskewInput expects at least one lut");
+    }
+}
+
+size_t DeskewInput::build(const std::vector<const LidarScan*>& scans,
+                          const std::vector<int64_t>& ts_offsets) {
+    const size_t n = luts_.size();
+    if (scans.size() != n || ts_offsets.size() != n) {
+        throw std::invalid_argument(
+            "expected a scan and a timestamp offset per sensor");
+    }
+
+    // valid column span of each scan, as first_valid_column and
+    // last_valid_column of the python SDK
+    std::vector<std::pair<Eigen::Index, Eigen::Index>> spans(n);
+    int64_t start = std::numeric_limits<int64_t>::max();
+    int64_t stop = std::numeric_limits<int64_t>::min();
+    Eigen::Index pixels = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const LidarScan* scan = scans[i];
+        if (!scan) continue;
+        const Eigen::Index w = scan->w;
+        const Eigen::Index h = scan->h;
+        if (luts_[i].direction.rows() != w * h) {
+            throw std::invalid_argument("scan doesn't match its lut");
+        }
+        const auto status = scan->status();
+        const auto ts = scan->timestamp();
+        // the whole scan when no column is valid
+        Eigen::Index first = 0, last = w - 1;
+        while (first < w && !(status(first) & 0x01)) ++first;
+        while (last >= 0 && !(status(last) & 0x01)) --last;
+        if (first == w) {
+            first = 0;
+            last = w - 1;
+        }
+        spans[i] = {first, last};
+        const int64_t offset = ts_offsets[i];
+        start = std::min(start, static_cast<int64_t>(ts(first)) + offset);
+        stop = std::max(stop, static_cast<int64_t>(ts(last)) + offset);
+        pixels += w * h;
+    }
+    const double duration = static_cast<double>(stop - start);
+
+    if (points_.rows() < pixels) {
+        points_.resize(pixels, 3);
+        times_.resize(pixels);
+        pixel_index_.resize(pixels);
+    }
+
+    count_ = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const LidarScan* scan = scans[i];
+        Eigen::ArrayXd& col_times = column_times_[i];
+        if (!scan) {
+            col_times.resize(0);
+            continue;
+        }
+        const Eigen::Index w = scan->w;
+        const Eigen::Index h = scan->h;
+        const auto status = scan->status();
+        const auto ts = scan->timestamp();
+        const Eigen::Index first = spans[i].first;
+        const Eigen::Index last = spans[i].second;
+        const int64_t offset = ts_offsets[i];
+
+        bool increasing = true;
+        bool any = false;
+        int64_t prev = 0;
+        for (Eigen::Index c = 0; c < w && increasing; ++c) {
+            if (status(c) != 1) continue;
+            const int64_t t = static_cast<int64_t>(ts(c)) + offset;
+            increasing = !any || t > prev;
+            any = true;
+            prev = t;
+        }
+
+        col_times.setZero(w);
+        const Eigen::Index span = last - first + 1;
+        for (Eigen::Index c = first; c <= last; ++c) {
+            if (!increasing) {
+                col_times(c) = span > 1 ? double(c - first) / (span - 1) : 0;
+            } else if (duration > 0) {
+                const int64_t t = static_cast<int64_t>(ts(c)) + offset;
+                col_times(c) = static_cast<double>(t - start) / duration;
+            }
+        }
+
+        const Eigen::Index size = w * h;
+        const size_t m = cartesian_compact(points_.middleRows(count_, size),
+                                           pixel_index_.segment(count_, size),
+                                           *scan, luts_[i]);
+        for (size_t j = count_; j < count_ + m; ++j) {
+            times_(j) = col_times(pixel_index_(j) % w);
+        }
+        count_ += m;
+    }
+    return count_;
+}
+
+Eigen::Ref<const LidarScan::Points> DeskewInput::points() const {
+    return points_.topRows(count_);
+}
+
+Eigen::Ref<const Eigen::ArrayXd> DeskewInput::times() const {
+    return times_.head(count_);
+}
+
+const Eigen::ArrayXd& DeskewInput::column_times(size_t sensor) const {
+    return column_times_.at(sensor);
+}
+
+size_t DeskewInput::sensors_count() const { return luts_.size(); }
+
+}  // namespace ouster
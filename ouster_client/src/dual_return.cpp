@@ -0,0 +1,267 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/dual_return.h"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ouster {
+
+namespace {
+
+using sensor::ChanFieldType;
+namespace ChanField = sensor::ChanField;
+
+using Index = Eigen::Array<uint32_t, Eigen::Dynamic, 1>;
+
+// the fields of the first and second returns
+const std::pair<const char*, const char*> return_fields[] = {
+    {ChanField::RANGE, ChanField::RANGE2},
+    {ChanField::SIGNAL, ChanField::SIGNAL2},
+    {ChanField::REFLECTIVITY, ChanField::REFLECTIVITY2},
+    {ChanField::FLAGS, ChanField::FLAGS2}};
+
+// 1 where the pixel of larger signal is the second return; branch free, so
+// that the loop is vectorized
+template <typename S>
+void pick_strongest(const uint32_t* r1, const uint32_t* r2, const S* s1,
+                    const S* s2, size_t n, uint8_t* pick) {
+    for (size_t i = 0; i < n; i++) {
+        pick[i] = (r2[i] != 0) & ((r1[i] == 0) | (s2[i] > s1[i]));
+    }
+}
+
+// 1 where the selected return of a pixel is its second one
+void pick_returns(const LidarScan& scan, ReturnSelection selection,
+                  std::vector<uint8_t>& pick) {
+    const size_t n = scan.w * scan.h;
+    pick.resize(n);
+    const uint32_t* r1 = scan.field(ChanField::RANGE).get<uint32_t>();
+    const uint32_t* r2 = scan.field(ChanField::RANGE2).get<uint32_t>();
+    uint8_t* p = pick.data();
+    switch (selection) {
+        case ReturnSelection::NEAREST:
+            for (size_t i = 0; i < n; i++) {
+                p[i] = (r2[i] != 0) & ((r1[i] == 0) | (r2[i] < r1[i]));
+            }
+            return;
+        case ReturnSelection::FARTHEST:
+            for (size_t i = 0; i < n; i++) p[i] = r2[i] > r1[i];
+            return;
+        case ReturnSelection::STRONGEST:
+            break;
+        default:
+            throw std::invalid_argument(
+                "select_returns: expected a single return");
+    }
+
+    const bool signals = scan.has_field(ChanField::SIGNAL) &&
+                         scan.has_field(ChanField::SIGNAL2) &&
+                         scan.field(ChanField::SIGNAL).tag() ==
+                             scan.field(ChanField::SIGNAL2).tag();
+    if (signals) {
+        const Field& s1 = scan.field(ChanField::SIGNAL);
+        const Field& s2 = scan.field(ChanField::SIGNAL2);
+        switch (s1.tag()) {
+            case ChanFieldType::UINT8:
+                return pick_strongest(r1, r2, s1.get<uint8_t>(),
+                                      s2.get<uint8_t>(), n, p);
+            case ChanFieldType::UINT16:
+                return pick_strongest(r1, r2, s1.get<uint16_t>(),
+                                      s2.get<uint16_t>(), n, p);
+            case ChanFieldType::UINT32:
+                return pick_strongest(r1, r2, s1.get<uint32_t>(),
+                                      s2.get<uint32_t>(), n, p);
+            default:
+                break;
+        }
+    }
+    // the first return is the strongest one of the firmware
+    for (size_t i = 0; i < n; i++) p[i] = (r1[i] == 0) & (r2[i] != 0);
+}
+
+template <typename T>
+void select_field(const T* first, const T* second, const uint8_t* pick,
+                  size_t n, T* out) {
+    for (size_t i = 0; i < n; i++) out[i] = pick[i] ? second[i] : first[i];
+}
+
+void check_dual(const LidarScan& scan) {
+    if (!scan.has_field(ChanField::RANGE) ||
+        !scan.has_field(ChanField::RANGE2)) {
+        throw std::invalid_argument(
+            "expected a dual return scan with RANGE and RANGE2 fields");
+    }
+}
+
+// the points of the selected returns, dispatched on the reflectivity type
+template <typename T, typename R>
+size_t project_returns(Eigen::Ref<PointsT<T>>& points,
+                       Eigen::Ref<Index>& return_index, const uint32_t* r1,
+                       const uint32_t* r2, const uint8_t* pick, bool both,
+                       const R* f1, const R* f2, const PointsT<T>& direction,
+                       const PointsT<T>& offset, const CompactFilter& filter) {
+    const Eigen::Index N = direction.rows();
+    const T* dir = direction.data();
+    const T* ofs = offset.data();
+    Eigen::Index n = 0;
+    auto emit = [&](Eigen::Index ix, uint32_t r, const R* refl,
+                    uint32_t second) {
+        if (r == 0 || r < filter.min_range || r > filter.max_range) return;
+        if (refl && refl[ix] < filter.min_reflectivity) return;
+        for (int c = 0; c < 3; ++c) {
+            points(n, c) = r * dir[c * N + ix] + ofs[c * N + ix];
+        }
+        return_index(n++) = static_cast<uint32_t>(ix + second * N);
+    };
+    for (Eigen::Index ix = 0; ix < N; ++ix) {
+        if (both) {
+            emit(ix, r1[ix], f1, 0);
+            emit(ix, r2[ix], f2, 1);
+        } else if (pick && pick[ix]) {
+            emit(ix, r2[ix], f2, 1);
+        } else {
+            emit(ix, r1[ix], f1, 0);
+        }
+    }
+    return n;
+}
+
+template <typename T>
+size_t cartesian_returns_impl(Eigen::Ref<PointsT<T>>& points,
+                              Eigen::Ref<Index>& return_index,
+                              const LidarScan& scan,
+                              const PointsT<T>& direction,
+                              const PointsT<T>& offset,
+                              ReturnSelection selection,
+                              const CompactFilter& filter) {
+    const Eigen::Index N = static_cast<Eigen::Index>(scan.w * scan.h);
+    if (direction.rows() != N || offset.rows() != N) {
+        throw std::invalid_argument("unexpected image dimensions");
+    }
+    const bool dual = scan.has_field(ChanField::RANGE2);
+    const bool both = dual && selection == ReturnSelection::BOTH;
+    const Eigen::Index returns = both ? 2 * N : N;
+    if (points.rows() < returns || return_index.rows() < returns) {
+        throw std::invalid_argument(
+            "expected a row of output for every return");
+    }
+
+    const uint32_t* r1 = scan.field(ChanField::RANGE).get<uint32_t>();
+    const uint32_t* r2 =
+        dual ? scan.field(ChanField::RANGE2).get<uint32_t>() : nullptr;
+    std::vector<uint8_t> pick;
+    if (dual && !both) pick_returns(scan, selection, pick);
+    const uint8_t* p = pick.empty() ? nullptr : pick.data();
+
+    if (filter.min_reflectivity == 0) {
+        return project_returns<T, uint8_t>(points, return_index, r1, r2, p,
+                                           both, nullptr, nullptr, direction,
+                                           offset, filter);
+    }
+    const bool refl = scan.has_field(ChanField::REFLECTIVITY) &&
+                      (!dual || scan.has_field(ChanField::REFLECTIVITY2));
+    if (!refl) {
+        throw std::invalid_argument(
+            "reflectivity threshold needs REFLECTIVITY fields");
+    }
+    const Field& f1 = scan.field(ChanField::REFLECTIVITY);
+    const Field& f2 =
+        scan.field(dual ? ChanField::REFLECTIVITY2 : ChanField::REFLECTIVITY);
+    if (f1.tag() != f2.tag()) {
+        throw std::invalid_argument(
+            "REFLECTIVITY fields must be of the same type");
+    }
+    switch (f1.tag()) {
+        case ChanFieldType::UINT8:
+            return project_returns(points, return_index, r1, r2, p, both,
+                                   f1.get<uint8_t>(), f2.get<uint8_t>(),
+                                   direction, offset, filter);
+        case ChanFieldType::UINT16:
+            return project_returns(points, return_index, r1, r2, p, both,
+                                   f1.get<uint16_t>(), f2.get<uint16_t>(),
+                                   direction, offset, filter);
+        default:
+            throw std::invalid_argument(
+                "REFLECTIVITY must be an 8 or 16 bit field");
+    }
+}
+
+}  // namespace
+
+void select_returns(const LidarScan& scan, ReturnSelection selection,
+                    LidarScan& out) {
+    check_dual(scan);
+    if (out.w != scan.w || out.h != scan.h) {
+        throw std::invalid_argument("select_returns: scan sizes differ");
+    }
+    const size_t n = scan.w * scan.h;
+    std::vector<uint8_t> pick;
+    pick_returns(scan, selection, pick);
+
+    for (const auto& fields : return_fields) {
+        if (!scan.has_field(fields.first) || !scan.has_field(fields.second) ||
+            !out.has_field(fields.first)) {
+            continue;
+        }
+        // the output first, which may share or unshare the memory of the
+        // fields of scan if it is out
+        Field& dst = out.field(fields.first);
+        const Field& first = scan.field(fields.first);
+        const Field& second = scan.field(fields.second);
+        if (first.tag() != second.tag() || dst.tag() != first.tag() ||
+            dst.bytes() != first.bytes() || second.bytes() != first.bytes() ||
+            first.bytes() != n * first.desc().element_size) {
+            throw std::invalid_argument(std::string("select_returns: ") +
+                                        fields.first +
+                                        " fields don't match");
+        }
+        switch (first.desc().element_size) {
+            case 1:
+                select_field(first.get<uint8_t>(), second.get<uint8_t>(),
+                             pick.data(), n, dst.get<uint8_t>());
+                break;
+            case 2:
+                select_field(first.get<uint16_t>(), second.get<uint16_t>(),
+                             pick.data(), n, dst.get<uint16_t>());
+                break;
+            case 4:
+                select_field(first.get<uint32_t>(), second.get<uint32_t>(),
+                             pick.data(), n, dst.get<uint32_t>());
+                break;
+            case 8:
+                select_field(first.get<uint64_t>(), second.get<uint64_t>(),
+                             pick.data(), n, dst.get<uint64_t>());
+                break;
+            default:
+                throw std::invalid_argument(
+                    std::string("select_returns: unexpected type of ") +
+                    fields.first);
+        }
+    }
+}
+
+size_t cartesian_returns(Eigen::Ref<LidarScan::Points> points,
+                         Eigen::Ref<Index> return_index, const LidarScan& scan,
+                         const XYZLut& lut, ReturnSelection selection,
+                         const CompactFilter& filter) {
+    return cartesian_returns_impl<double>(points, return_index, scan,
+                                          lut.direction, lut.offset,
+                                          selection, filter);
+}
+
+size_t cartesian_returns(Eigen::Ref<PointsF> points,
+                         Eigen::Ref<Index> return_index, const LidarScan& scan,
+                         const XYZLutF& lut, ReturnSelection selection,
+                         const CompactFilter& filter) {
+    return cartesian_returns_impl<float>(points, return_index, scan,
+                                         lut.direction, lut.offset,
+                                         selection, filter);
+}
+
+}  // namespace ouster
@@ -29,6 +29,41 @@ std::vector<size_t> calculate_strides(const std::vector<size_t>& shape) {
 
 }  // namespace impl
 
+namespace {
+
+/*
+ * Allocate field memory aligned to field_alignment. The block is over-allocated
+ * and the distance from its start to the aligned pointer, 1 to
+ * field_alignment, is kept in the byte before the aligned pointer.
+ */
+void* field_alloc(size_t bytes) {
+    auto* block = static_cast<uint8_t*>(malloc(bytes + field_alignment));
+    if (!block) {
+        throw std::runtime_error("Field: host allocation failed");
+    }
+    const auto addr = reinterpret_cast<uintptr_t>(block);
+    const size_t pad = field_alignment - addr % field_alignment;
+    block[pad - 1] = static_cast<uint8_t>(pad);
+    return block + pad;
+}
+
+void field_free(void* ptr) {
+    if (!ptr) return;
+    auto* aligned = static_cast<uint8_t*>(ptr);
+    free(aligned - aligned[-1]);
+}
+
+// frees memory a field owned before sharing it, unless the field takes it
+// back once the others are gone
+struct SharedFree {
+    bool released{false};
+    void operator()(void* ptr) const {
+        if (!released) field_free(ptr);
+    }
+};
+
+}  // namespace
+
 namespace sensor {
 namespace impl {
 
@@ -158,16 +193,24 @@ bool FieldView::sparse() const {
 }
 
 Field::Field() noexcept : FieldView(), class_{FieldClass::SCAN_FIELD} {}
-Field::~Field() { free(ptr_); }
+Field::~Field() {
+    if (!owner_) field_free(ptr_);
+}
 
 Field::Field(const FieldDescriptor& desc, FieldClass field_class)
+    : Field(desc, field_class, FieldInit::ZEROED) {}
+
+Field::Field(const FieldDescriptor& desc, FieldClass field_class,
+             FieldInit init)
     : FieldView(nullptr, desc), class_{field_class} {
-    ptr_ = calloc(desc.bytes(), sizeof(uint8_t));
-    if (!ptr_) {
-        throw std::runtime_error("Field: host allocation failed");
-    }
+    ptr_ = field_alloc(desc.bytes());
+    if (init == FieldInit::ZEROED) std::memset(ptr_, 0, desc.bytes());
 }
 
+Field::Field(const FieldDescriptor& desc, FieldClass field_class, void* ptr,
+             std::shared_ptr<void> owner)
+    : FieldView(ptr, desc), class_{field_class}, owner_{std::move(owner)} {}
+
 Field::Field(Field&& other) noexcept : Field() { swap(other); };
 
 Field& Field::operator=(Field&& other) noexcept {
@@ -177,14 +220,17 @@ Field& Field::operator=(Field&& other) noexcept {
 
 Field::Field(const Field& other)
     : FieldView(nullptr, other.desc()), class_{other.class_} {
-    ptr_ = malloc(desc().bytes());
-    if (!ptr_) {
-        throw std::runtime_error("Field: host allocation failed");
-    }
+    ptr_ = field_alloc(desc().bytes());
     std::memcpy(ptr_, other.ptr_, other.bytes());
 }
 
 Field& Field::operator=(const Field& other) {
+    if (this == &other) return *this;
+    if (ptr_ && !owner_ && desc() == other.desc()) {
+        std::memcpy(ptr_, other.ptr_, other.bytes());
+        class_ = other.class_;
+        return *this;
+    }
     Field new_fp(other);
     swap(new_fp);
     return (*this);
@@ -196,6 +242,46 @@ void Field::swap(Field& other) noexcept {
     std::swap(ptr_, other.ptr_);
     desc_.swap(other.desc_);
     std::swap(class_, other.class_);
+    owner_.swap(other.owner_);
+    std::swap(shared_, other.shared_);
+}
+
+Field Field::share() const {
+    if (!shared_) {
+        // the handle frees the memory, or keeps its previous owner alive,
+        // once the last field sharing it is gone
+        if (owner_) {
+            owner_ = std::make_shared<std::shared_ptr<void>>(std::move(owner_));
+        } else {
+            owner_ = std::shared_ptr<void>(ptr_, SharedFree{});
+        }
+        shared_ = true;
+    }
+    Field shared(desc(), class_, ptr_, owner_);
+    shared.shared_ = true;
+    return shared;
+}
+
+void Field::unshare() {
+    if (!shared_) return;
+    shared_ = false;
+    if (owner_.use_count() == 1) {
+        // the others are gone: take the memory back as it was owned before,
+        // so that e.g. LidarScan::operator= copies into it again
+        if (auto* free = std::get_deleter<SharedFree>(owner_)) {
+            free->released = true;
+            owner_.reset();
+        } else {
+            auto handle =
+                std::static_pointer_cast<std::shared_ptr<void>>(owner_);
+            owner_ = std::move(*handle);
+        }
+        return;
+    }
+    void* ptr = field_alloc(bytes());
+    std::memcpy(ptr, ptr_, bytes());
+    ptr_ = ptr;
+    owner_.reset();
 }
 
 bool Field::operator==(const Field& other) const {
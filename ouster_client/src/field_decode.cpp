@@ -0,0 +1,216 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/impl/field_decode.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define OUSTER_DECODE_AVX2
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define OUSTER_DECODE_NEON
+#include <arm_neon.h>
+#endif
+
+namespace ouster {
+namespace sensor {
+namespace impl {
+
+template <size_t S>
+static inline void decode_one(const uint8_t* src, uint64_t mask, int shift,
+                              uint8_t* dst) {
+    uint64_t word;
+    std::memcpy(&word, src, sizeof(word));
+    word &= mask;
+    if (shift > 0) {
+        word >>= shift;
+    } else if (shift < 0) {
+        word <<= std::abs(shift);
+    }
+    std::memcpy(dst, &word, S);
+}
+
+template <size_t S>
+static void decode_scalar(const uint8_t* src, size_t stride, int n,
+                          uint64_t mask, int shift, uint8_t* dst) {
+    for (int i = 0; i < n; i++) {
+        decode_one<S>(src + i * stride, mask, shift, dst + i * S);
+    }
+}
+
+#ifdef OUSTER_DECODE_AVX2
+
+// compiled for AVX2 regardless of the target flags and only called after a
+// runtime check, so the library still runs on older CPUs
+template <size_t S>
+__attribute__((target("avx2"))) static void decode_avx2(
+    const uint8_t* src, size_t stride, int n, uint64_t mask, int shift,
+    uint8_t* dst) {
+    const long long s = static_cast<long long>(stride);
+    const __m256i index = _mm256_setr_epi64x(0, s, 2 * s, 3 * s);
+    const __m256i vmask = _mm256_set1_epi64x(static_cast<long long>(mask));
+    const __m128i right = _mm_cvtsi32_si128(shift > 0 ? shift : 0);
+    const __m128i left = _mm_cvtsi32_si128(shift < 0 ? -shift : 0);
+    const __m256i pick32 = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+    const __m128i pick16 =
+        _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i pick8 = _mm_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1,
+                                        -1, -1, -1, -1, -1, -1);
+
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        // gather the same 64 bit word from four columns
+        __m256i w = _mm256_i64gather_epi64(
+            reinterpret_cast<const long long*>(src + i * stride), index, 1);
+        w = _mm256_and_si256(w, vmask);
+        w = _mm256_srl_epi64(w, right);
+        w = _mm256_sll_epi64(w, left);
+
+        uint8_t* out = dst + i * S;
+        if (S == 8) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), w);
+            continue;
+        }
+        // narrow by keeping the low bytes of each lane
+        __m128i lo = _mm256_castsi256_si128(
+            _mm256_permutevar8x32_epi32(w, pick32));
+        if (S == 4) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), lo);
+        } else if (S == 2) {
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out),
+                             _mm_shuffle_epi8(lo, pick16));
+        } else {
+            int32_t v = _mm_cvtsi128_si32(_mm_shuffle_epi8(lo, pick8));
+            std::memcpy(out, &v, sizeof(v));
+        }
+    }
+    for (; i < n; i++) {
+        decode_one<S>(src + i * stride, mask, shift, dst + i * S);
+    }
+}
+
+#endif
+
+#ifdef OUSTER_DECODE_NEON
+
+template <size_t S>
+static void decode_neon(const uint8_t* src, size_t stride, int n,
+                        uint64_t mask, int shift, uint8_t* dst) {
+    const uint64x2_t vmask = vdupq_n_u64(mask);
+    // vshl shifts left by positive and right by negative amounts
+    const int64x2_t vshift = vdupq_n_s64(-shift);
+
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        uint64_t words[4];
+        for (int k = 0; k < 4; k++) {
+            std::memcpy(&words[k], src + (i + k) * stride, sizeof(uint64_t));
+        }
+        uint64x2_t a = vshlq_u64(vandq_u64(vld1q_u64(words), vmask), vshift);
+        uint64x2_t b =
+            vshlq_u64(vandq_u64(vld1q_u64(words + 2), vmask), vshift);
+
+        uint8_t* out = dst + i * S;
+        if (S == 8) {
+            vst1q_u8(out, vreinterpretq_u8_u64(a));
+            vst1q_u8(out + 16, vreinterpretq_u8_u64(b));
+            continue;
+        }
+        // narrow by keeping the low half of each lane
+        uint32x4_t c = vcombine_u32(vmovn_u64(a), vmovn_u64(b));
+        if (S == 4) {
+            vst1q_u8(out, vreinterpretq_u8_u32(c));
+            continue;
+        }
+        uint16x4_t d = vmovn_u32(c);
+        if (S == 2) {
+            vst1_u8(out, vreinterpret_u8_u16(d));
+        } else {
+            uint8x8_t e = vmovn_u16(vcombine_u16(d, d));
+            uint32_t v = vget_lane_u32(vreinterpret_u32_u8(e), 0);
+            std::memcpy(out, &v, sizeof(v));
+        }
+    }
+    for (; i < n; i++) {
+        decode_one<S>(src + i * stride, mask, shift, dst + i * S);
+    }
+}
+
+#endif
+
+bool decode_kernel_supported(decode_kernel kernel) {
+    switch (kernel) {
+        case decode_kernel::SCALAR:
+            return true;
+        case decode_kernel::AVX2:
+#ifdef OUSTER_DECODE_AVX2
+            return __builtin_cpu_supports("avx2");
+#else
+            return false;
+#endif
+        case decode_kernel::NEON:
+#ifdef OUSTER_DECODE_NEON
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+decode_kernel best_decode_kernel() {
+    static const decode_kernel best = [] {
+        if (decode_kernel_supported(decode_kernel::AVX2))
+            return decode_kernel::AVX2;
+        if (decode_kernel_supported(decode_kernel::NEON))
+            return decode_kernel::NEON;
+        return decode_kernel::SCALAR;
+    }();
+    return best;
+}
+
+template <size_t S>
+static decode_fn pick_kernel(decode_kernel kernel) {
+    switch (kernel) {
+#ifdef OUSTER_DECODE_AVX2
+        case decode_kernel::AVX2:
+            return decode_avx2<S>;
+#endif
+#ifdef OUSTER_DECODE_NEON
+        case decode_kernel::NEON:
+            return decode_neon<S>;
+#endif
+        default:
+            return decode_scalar<S>;
+    }
+}
+
+decode_fn get_decode_fn(decode_kernel kernel, size_t dst_size) {
+    if (!decode_kernel_supported(kernel)) {
+        throw std::invalid_argument("Decode kernel not supported on this CPU");
+    }
+    switch (dst_size) {
+        case 1:
+            return pick_kernel<1>(kernel);
+        case 2:
+            return pick_kernel<2>(kernel);
+        case 4:
+            return pick_kernel<4>(kernel);
+        case 8:
+            return pick_kernel<8>(kernel);
+        default:
+            throw std::invalid_argument(
+                "Unsupported destination width for field decoding");
+    }
+}
+
+}  // namespace impl
+}  // namespace sensor
+}  // namespace ouster
@@ -0,0 +1,536 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/field_ops.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define OUSTER_FIELD_OPS_X86
+#endif
+
+// Kernels are plain loops left to the vectorizer, compiled once for the
+// baseline ISA and once for AVX2. GCC only vectorizes them at -O2 when asked.
+#if defined(__GNUC__) && !defined(__clang__)
+#define OUSTER_FIELD_OPS_BASE __attribute__((optimize("tree-vectorize")))
+#define OUSTER_FIELD_OPS_AVX2 \
+    __attribute__((target("avx2,fma"), optimize("tree-vectorize")))
+#else
+#define OUSTER_FIELD_OPS_BASE
+#define OUSTER_FIELD_OPS_AVX2 __attribute__((target("avx2,fma")))
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define OUSTER_FIELD_OPS_INLINE inline __attribute__((always_inline))
+#else
+#define OUSTER_FIELD_OPS_INLINE inline
+#endif
+
+namespace ouster {
+namespace field_ops {
+
+using sensor::ChanFieldType;
+
+namespace {
+
+// elements per OpenMP task, enough to amortize scheduling
+constexpr size_t parallel_block = 64 * 1024;
+
+// call f(T{}) with the element type of a tag
+template <typename F>
+void visit_type(ChanFieldType tag, F&& f) {
+    switch (tag) {
+        case ChanFieldType::UINT8:
+            return f(uint8_t{});
+        case ChanFieldType::UINT16:
+            return f(uint16_t{});
+        case ChanFieldType::UINT32:
+            return f(uint32_t{});
+        case ChanFieldType::UINT64:
+            return f(uint64_t{});
+        case ChanFieldType::INT8:
+            return f(int8_t{});
+        case ChanFieldType::INT16:
+            return f(int16_t{});
+        case ChanFieldType::INT32:
+            return f(int32_t{});
+        case ChanFieldType::INT64:
+            return f(int64_t{});
+        case ChanFieldType::FLOAT32:
+            return f(float{});
+        case ChanFieldType::FLOAT64:
+            return f(double{});
+        default:
+            throw std::invalid_argument("field_ops: unsupported field type " +
+                                        sensor::to_string(tag));
+    }
+}
+
+void check_dense(const FieldView& view) {
+    if (view.sparse()) {
+        throw std::invalid_argument("field_ops: views must be dense");
+    }
+}
+
+void check_sizes(const FieldView& a, const FieldView& b) {
+    check_dense(a);
+    check_dense(b);
+    if (a.size() != b.size()) {
+        throw std::invalid_argument("field_ops: sizes differ, " +
+                                    std::to_string(a.size()) + " and " +
+                                    std::to_string(b.size()));
+    }
+}
+
+template <typename S>
+OUSTER_FIELD_OPS_INLINE bool negative(S v, std::true_type /* signed */) {
+    return v < 0;
+}
+
+template <typename S>
+OUSTER_FIELD_OPS_INLINE bool negative(S, std::false_type /* signed */) {
+    return false;
+}
+
+// saturating conversions, see convert()
+template <typename D, typename S, bool SrcFloat, bool DstFloat>
+struct saturate_impl {
+    // integer to integer
+    static OUSTER_FIELD_OPS_INLINE D cast(S v) {
+        using lim = std::numeric_limits<D>;
+        if (negative(v, std::is_signed<S>{})) {
+            if (!std::is_signed<D>::value) return 0;
+            return static_cast<intmax_t>(v) < static_cast<intmax_t>(lim::min())
+                       ? lim::min()
+                       : static_cast<D>(v);
+        }
+        return static_cast<uintmax_t>(v) > static_cast<uintmax_t>(lim::max())
+                   ? lim::max()
+                   : static_cast<D>(v);
+    }
+};
+
+template <typename D, typename S>
+struct saturate_impl<D, S, false, true> {
+    static OUSTER_FIELD_OPS_INLINE D cast(S v) { return static_cast<D>(v); }
+};
+
+template <typename D, typename S>
+struct saturate_impl<D, S, true, true> {
+    static OUSTER_FIELD_OPS_INLINE D cast(S v) { return static_cast<D>(v); }
+};
+
+template <typename D, typename S>
+struct saturate_impl<D, S, true, false> {
+    static OUSTER_FIELD_OPS_INLINE D cast(S v) {
+        // the limits may round up to the next power of two, which is out of
+        // range: values below it are in range
+        using lim = std::numeric_limits<D>;
+        const S lo = static_cast<S>(lim::min());
+        const S hi = static_cast<S>(lim::max());
+        if (v >= hi) return lim::max();
+        if (v <= lo) return lim::min();
+        return v == v ? static_cast<D>(v) : D{0};
+    }
+};
+
+template <typename D, typename S>
+OUSTER_FIELD_OPS_INLINE D saturate(S v) {
+    return saturate_impl<D, S, std::is_floating_point<S>::value,
+                         std::is_floating_point<D>::value>::cast(v);
+}
+
+// integers of up to 32 bits and their bounds are exact in double precision,
+// so comparisons to a double operand reduce to ranges of the integer type
+template <typename T>
+using exact_int =
+    std::integral_constant<bool, std::is_integral<T>::value &&
+                                     (sizeof(T) <= sizeof(int32_t))>;
+
+// the values of T in [lo, hi], for lo and hi integral, infinite or NaN
+template <typename T>
+struct int_range {
+    T lo{0};
+    T hi{0};
+    bool empty{true};
+
+    int_range(double lo_, double hi_) {
+        using lim = std::numeric_limits<T>;
+        const double min = static_cast<double>(lim::min());
+        const double max = static_cast<double>(lim::max());
+        if (!(lo_ <= hi_) || lo_ > max || hi_ < min) return;
+        lo = lo_ <= min ? lim::min() : static_cast<T>(lo_);
+        hi = hi_ >= max ? lim::max() : static_cast<T>(hi_);
+        empty = false;
+    }
+};
+
+// the integers of [lower, upper], with NaN bounds not bounding
+template <typename T>
+int_range<T> bounds_range(double lower, double upper) {
+    if (std::isnan(lower)) lower = -std::numeric_limits<double>::infinity();
+    if (std::isnan(upper)) upper = std::numeric_limits<double>::infinity();
+    return {std::ceil(lower), std::floor(upper)};
+}
+
+// the integers for which a comparison to x holds, and whether it holds
+// outside of them rather than inside
+template <typename T>
+int_range<T> compare_range(CompareOp op, double x, bool& negate) {
+    const double inf = std::numeric_limits<double>::infinity();
+    negate = false;
+    switch (op) {
+        case CompareOp::LESS:
+            return {-inf, std::ceil(x) - 1};
+        case CompareOp::LESS_EQUAL:
+            return {-inf, std::floor(x)};
+        case CompareOp::GREATER:
+            return {std::floor(x) + 1, inf};
+        case CompareOp::GREATER_EQUAL:
+            return {std::ceil(x), inf};
+        case CompareOp::NOT_EQUAL:
+            negate = true;
+            return {std::floor(x) == x ? x : inf, x};
+        case CompareOp::EQUAL:
+            return {std::floor(x) == x ? x : inf, x};
+    }
+    throw std::invalid_argument("field_ops: unknown comparison");
+}
+
+/*
+ * Kernels, templated on their element types. Each is compiled for the
+ * baseline and for AVX2 by run(), through the function templates below.
+ */
+
+template <typename S, typename D>
+struct convert_kernel {
+    static OUSTER_FIELD_OPS_INLINE void run(const S* src, D* dst, size_t n) {
+        for (size_t i = 0; i < n; i++) dst[i] = saturate<D>(src[i]);
+    }
+};
+
+template <typename S, typename D>
+struct scale_kernel {
+    using W = typename std::conditional<std::is_same<D, float>::value, float,
+                                        double>::type;
+    static OUSTER_FIELD_OPS_INLINE void run(const S* src, D* dst, size_t n,
+                                            W factor, W offset) {
+        for (size_t i = 0; i < n; i++) {
+            dst[i] = saturate<D>(static_cast<W>(src[i]) * factor + offset);
+        }
+    }
+};
+
+template <typename T>
+struct clip_kernel {
+    static OUSTER_FIELD_OPS_INLINE void run(T* data, size_t n, T lo, T hi) {
+        for (size_t i = 0; i < n; i++) {
+            const T v = data[i];
+            data[i] = v < lo ? lo : (v > hi ? hi : v);
+        }
+    }
+};
+
+// keeps [lo, hi] in the type of the values, or in double
+template <typename T, typename B>
+struct threshold_kernel {
+    static OUSTER_FIELD_OPS_INLINE void run(T* data, size_t n, B lo, B hi,
+                                            T invalid) {
+        for (size_t i = 0; i < n; i++) {
+            const B v = static_cast<B>(data[i]);
+            data[i] = (v < lo || v > hi) ? invalid : data[i];
+        }
+    }
+};
+
+template <typename T, typename M>
+struct mask_kernel {
+    static OUSTER_FIELD_OPS_INLINE void run(T* data, const M* mask, size_t n,
+                                            size_t per_element, T fill) {
+        if (per_element == 1) {
+            for (size_t i = 0; i < n; i++) {
+                data[i] = mask[i] != M{0} ? data[i] : fill;
+            }
+            return;
+        }
+        for (size_t i = 0; i < n; i++) {
+            if (mask[i] != M{0}) continue;
+            T* values = data + i * per_element;
+            for (size_t j = 0; j < per_element; j++) values[j] = fill;
+        }
+    }
+};
+
+template <typename T>
+struct in_range_kernel {
+    static OUSTER_FIELD_OPS_INLINE void run(const T* src, uint8_t* out,
+                                            size_t n, T lo, T hi,
+                                            uint8_t inside) {
+        for (size_t i = 0; i < n; i++) {
+            const T v = src[i];
+            out[i] = (v >= lo && v <= hi) ? inside : uint8_t(inside ^ 1);
+        }
+    }
+};
+
+template <typename T, typename Op>
+struct compare_kernel {
+    static OUSTER_FIELD_OPS_INLINE void run(const T* src, uint8_t* out,
+                                            size_t n, double x) {
+        for (size_t i = 0; i < n; i++) {
+            out[i] = Op{}(static_cast<double>(src[i]), x) ? 1 : 0;
+        }
+    }
+};
+
+template <typename K, typename... Args>
+OUSTER_FIELD_OPS_BASE void run_base(Args... args) {
+    K::run(args...);
+}
+
+#ifdef OUSTER_FIELD_OPS_X86
+template <typename K, typename... Args>
+OUSTER_FIELD_OPS_AVX2 void run_avx2(Args... args) {
+    K::run(args...);
+}
+
+bool has_avx2() {
+    static const bool avx2 =
+        __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return avx2;
+}
+#endif
+
+template <typename K, typename... Args>
+void run(Args... args) {
+#ifdef OUSTER_FIELD_OPS_X86
+    if (has_avx2()) return run_avx2<K>(args...);
+#endif
+    run_base<K>(args...);
+}
+
+// call f(begin, end) on blocks of [0, n), from several threads if parallel
+template <typename F>
+void for_blocks(size_t n, bool parallel, F&& f) {
+#ifdef __OUSTER_UTILIZE_OPENMP__
+    if (parallel && n > parallel_block) {
+        const int64_t blocks =
+            static_cast<int64_t>((n + parallel_block - 1) / parallel_block);
+#pragma omp parallel for schedule(static)
+        for (int64_t b = 0; b < blocks; b++) {
+            const size_t begin = static_cast<size_t>(b) * parallel_block;
+            f(begin, std::min(n, begin + parallel_block));
+        }
+        return;
+    }
+#endif
+    (void)parallel;
+    if (n) f(size_t{0}, n);
+}
+
+template <typename T>
+void clip_values(T* data, size_t n, double lower, double upper,
+                 bool parallel, std::true_type /* integral */) {
+    const T lo = saturate<T>(std::ceil(lower));
+    const T hi = std::max(lo, saturate<T>(std::floor(upper)));
+    for_blocks(n, parallel, [&](size_t begin, size_t end) {
+        run<clip_kernel<T>>(data + begin, end - begin, lo, hi);
+    });
+}
+
+template <typename T>
+void clip_values(T* data, size_t n, double lower, double upper,
+                 bool parallel, std::false_type /* integral */) {
+    const T lo = static_cast<T>(lower);
+    const T hi = static_cast<T>(upper);
+    for_blocks(n, parallel, [&](size_t begin, size_t end) {
+        run<clip_kernel<T>>(data + begin, end - begin, lo, hi);
+    });
+}
+
+template <typename T>
+void threshold_values(T* data, size_t n, double lower, double upper,
+                      T invalid, bool parallel, std::true_type /* exact */) {
+    const auto range = bounds_range<T>(lower, upper);
+    if (range.empty) {
+        std::fill(data, data + n, invalid);
+        return;
+    }
+    for_blocks(n, parallel, [&](size_t begin, size_t end) {
+        run<threshold_kernel<T, T>>(data + begin, end - begin, range.lo,
+                                    range.hi, invalid);
+    });
+}
+
+template <typename T>
+void threshold_values(T* data, size_t n, double lower, double upper,
+                      T invalid, bool parallel, std::false_type /* exact */) {
+    for_blocks(n, parallel, [&](size_t begin, size_t end) {
+        run<threshold_kernel<T, double>>(data + begin, end - begin, lower,
+                                         upper, invalid);
+    });
+}
+
+template <typename T>
+void compare_values(const T* src, CompareOp op, double x, uint8_t* out,
+                    size_t n, bool parallel, std::true_type /* exact */) {
+    bool negate = false;
+    const auto range = compare_range<T>(op, x, negate);
+    const uint8_t inside = negate ? 0 : 1;
+    if (range.empty) {
+        std::fill(out, out + n, uint8_t(inside ^ 1));
+        return;
+    }
+    for_blocks(n, parallel, [&](size_t begin, size_t end) {
+        run<in_range_kernel<T>>(src + begin, out + begin, end - begin,
+                                range.lo, range.hi, inside);
+    });
+}
+
+template <typename T, typename Op>
+void compare_with(const T* src, double x, uint8_t* out, size_t n,
+                  bool parallel) {
+    for_blocks(n, parallel, [&](size_t begin, size_t end) {
+        run<compare_kernel<T, Op>>(src + begin, out + begin, end - begin, x);
+    });
+}
+
+template <typename T>
+void compare_values(const T* src, CompareOp op, double x, uint8_t* out,
+                    size_t n, bool parallel, std::false_type /* exact */) {
+    switch (op) {
+        case CompareOp::LESS:
+            return compare_with<T, std::less<double>>(src, x, out, n,
+                                                      parallel);
+        case CompareOp::LESS_EQUAL:
+            return compare_with<T, std::less_equal<double>>(src, x, out, n,
+                                                            parallel);
+        case CompareOp::GREATER:
+            return compare_with<T, std::greater<double>>(src, x, out, n,
+                                                         parallel);
+        case CompareOp::GREATER_EQUAL:
+            return compare_with<T, std::greater_equal<double>>(src, x, out, n,
+                                                               parallel);
+        case CompareOp::EQUAL:
+            return compare_with<T, std::equal_to<double>>(src, x, out, n,
+                                                          parallel);
+        case CompareOp::NOT_EQUAL:
+            return compare_with<T, std::not_equal_to<double>>(src, x, out, n,
+                                                              parallel);
+    }
+    throw std::invalid_argument("field_ops: unknown comparison");
+}
+
+}  // namespace
+
+void convert(const FieldView& src, FieldView dst, bool parallel) {
+    check_sizes(src, dst);
+    const size_t n = src.size();
+    visit_type(src.tag(), [&](auto s) {
+        using S = decltype(s);
+        visit_type(dst.tag(), [&](auto d) {
+            using D = decltype(d);
+            const S* in = src.get<S>();
+            D* out = dst.get<D>();
+            for_blocks(n, parallel, [&](size_t begin, size_t end) {
+                run<convert_kernel<S, D>>(in + begin, out + begin,
+                                          end - begin);
+            });
+        });
+    });
+}
+
+void scale(const FieldView& src, FieldView dst, double factor, double offset,
+           bool parallel) {
+    check_sizes(src, dst);
+    const size_t n = src.size();
+    visit_type(src.tag(), [&](auto s) {
+        using S = decltype(s);
+        visit_type(dst.tag(), [&](auto d) {
+            using D = decltype(d);
+            using K = scale_kernel<S, D>;
+            using W = typename K::W;
+            const S* in = src.get<S>();
+            D* out = dst.get<D>();
+            for_blocks(n, parallel, [&](size_t begin, size_t end) {
+                run<K>(in + begin, out + begin, end - begin,
+                       static_cast<W>(factor), static_cast<W>(offset));
+            });
+        });
+    });
+}
+
+void clip(FieldView field, double lower, double upper, bool parallel) {
+    check_dense(field);
+    if (!(lower <= upper)) {
+        throw std::invalid_argument(
+            "field_ops: clip bounds must be ordered and not NaN");
+    }
+    visit_type(field.tag(), [&](auto t) {
+        using T = decltype(t);
+        clip_values(field.get<T>(), field.size(), lower, upper, parallel,
+                    std::is_integral<T>{});
+    });
+}
+
+void threshold(FieldView field, double lower, double upper, double invalid,
+               bool parallel) {
+    check_dense(field);
+    visit_type(field.tag(), [&](auto t) {
+        using T = decltype(t);
+        threshold_values(field.get<T>(), field.size(), lower, upper,
+                         saturate<T>(invalid), parallel, exact_int<T>{});
+    });
+}
+
+void mask(FieldView field, const FieldView& mask, double fill,
+          bool parallel) {
+    check_dense(field);
+    check_dense(mask);
+    const size_t n = mask.size();
+    if (n == 0 || field.size() % n != 0) {
+        throw std::invalid_argument(
+            "field_ops: field size " + std::to_string(field.size()) +
+            " isn't a multiple of mask size " + std::to_string(n));
+    }
+    const size_t per_element = field.size() / n;
+    visit_type(field.tag(), [&](auto t) {
+        using T = decltype(t);
+        visit_type(mask.tag(), [&](auto m) {
+            using M = decltype(m);
+            T* data = field.get<T>();
+            const M* flags = mask.get<M>();
+            const T value = saturate<T>(fill);
+            for_blocks(n, parallel, [&](size_t begin, size_t end) {
+                run<mask_kernel<T, M>>(data + begin * per_element,
+                                       flags + begin, end - begin,
+                                       per_element, value);
+            });
+        });
+    });
+}
+
+void compare(const FieldView& src, CompareOp op, double operand,
+             FieldView out, bool parallel) {
+    check_sizes(src, out);
+    if (out.tag() != ChanFieldType::UINT8) {
+        throw std::invalid_argument("field_ops: compare writes to UINT8");
+    }
+    visit_type(src.tag(), [&](auto t) {
+        using T = decltype(t);
+        compare_values(src.get<T>(), op, operand, out.get<uint8_t>(),
+                       src.size(), parallel, exact_int<T>{});
+    });
+}
+
+}  // namespace field_ops
+}  // namespace ouster
@@ -0,0 +1,178 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/fused_cloud.h"
+
+#include <future>
+#include <stdexcept>
+#include <utility>
+
+#include "ouster/impl/lidar_scan_impl.h"
+
+namespace ouster {
+
+namespace {
+
+// writes the values of a field at the pixels with a point
+struct copy_field {
+    template <typename T>
+    void operator()(Eigen::Ref<const img_t<T>> field,
+                    const Eigen::Ref<const img_t<uint32_t>>& range,
+                    bool compact, double* out) const {
+        for (Eigen::Index r = 0; r < field.rows(); ++r) {
+            for (Eigen::Index c = 0; c < field.cols(); ++c) {
+                if (compact && range(r, c) == 0) continue;
+                *out++ = static_cast<double>(field(r, c));
+            }
+        }
+    }
+};
+
+}  // namespace
+
+FusedCloudBuilder::FusedCloudBuilder(std::vector<XYZLut> luts,
+                                     std::vector<mat4d> extrinsics,
+                                     std::vector<std::string> fields,
+                                     bool sensor_ids, bool compact,
+                                     size_t ring_size)
+    : luts_(std::move(luts)),
+      fields_(std::move(fields)),
+      sensor_ids_(sensor_ids),
+      compact_(compact) {
+    if (luts_.empty()) {
+        throw std::invalid_argument("expected a lut per sensor");
+    }
+    if (luts_.size() > 256) {
+        throw std::invalid_argument("sensor ids are limited to 256 sensors");
+    }
+    if (!extrinsics.empty() && extrinsics.size() != luts_.size()) {
+        throw std::invalid_argument("expected an extrinsic per sensor");
+    }
+    if (ring_size == 0) {
+        throw std::invalid_argument("ring size must be positive");
+    }
+
+    // the extrinsics are folded into the luts once
+    Eigen::Index capacity = 0;
+    for (size_t i = 0; i < luts_.size(); ++i) {
+        auto& lut = luts_[i];
+        if (!extrinsics.empty()) {
+            const Eigen::Matrix3d rot = extrinsics[i].topLeftCorner<3, 3>();
+            const Eigen::RowVector3d trans =
+                extrinsics[i].topRightCorner<3, 1>().transpose();
+            lut.direction = (lut.direction.matrix() * rot.transpose()).array();
+            lut.offset = ((lut.offset.matrix() * rot.transpose()).rowwise() +
+                          trans)
+                             .array();
+        }
+        capacity += lut.direction.rows();
+    }
+
+    ring_.resize(ring_size);
+    for (auto& cloud : ring_) {
+        cloud.points.resize(capacity, 3);
+        if (sensor_ids_) cloud.sensor_ids.resize(capacity);
+        cloud.fields.assign(fields_.size(), Eigen::ArrayXd(capacity));
+    }
+}
+
+const FusedCloud& FusedCloudBuilder::build(
+    const std::vector<const LidarScan*>& scans) {
+    const size_t n = luts_.size();
+    if (scans.size() != n) {
+        throw std::invalid_argument("expected a scan, or null, per sensor");
+    }
+
+    // check everything and place the points of each sensor before writing
+    std::vector<Eigen::Index> offsets(n + 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+        const LidarScan* scan = scans[i];
+        const Eigen::Index pixels = luts_[i].direction.rows();
+        Eigen::Index count = compact_ ? 0 : pixels;
+        if (scan) {
+            if (static_cast<Eigen::Index>(scan->w * scan->h) != pixels) {
+                throw std::invalid_argument("scan doesn't match its lut");
+            }
+            for (const auto& name : fields_) {
+                if (!scan->has_field(name) ||
+                    scan->field(name).field_class() !=
+                        FieldClass::PIXEL_FIELD) {
+                    throw std::invalid_argument("scan has no pixel field " +
+                                                name);
+                }
+            }
+            if (compact_) {
+                count = (scan->field<uint32_t>(sensor::ChanField::RANGE) != 0)
+                            .count();
+            }
+        }
+        offsets[i + 1] = offsets[i] + count;
+    }
+
+    FusedCloud& cloud = ring_[next_];
+    auto fill = [&](size_t i) {
+        const LidarScan* scan = scans[i];
+        const Eigen::Index begin = offsets[i];
+        const Eigen::Index count = offsets[i + 1] - begin;
+        if (sensor_ids_) {
+            cloud.sensor_ids.segment(begin, count) = static_cast<uint8_t>(i);
+        }
+        if (!scan) {
+            cloud.points.middleRows(begin, count).setZero();
+            for (auto& field : cloud.fields) {
+                field.segment(begin, count).setZero();
+            }
+            return;
+        }
+
+        const auto range = scan->field<uint32_t>(sensor::ChanField::RANGE);
+        const XYZLut& lut = luts_[i];
+        Eigen::Index row = begin;
+        for (Eigen::Index r = 0; r < range.rows(); ++r) {
+            for (Eigen::Index c = 0; c < range.cols(); ++c) {
+                const uint32_t value = range(r, c);
+                if (value == 0) {
+                    if (!compact_) cloud.points.row(row++).setZero();
+                    continue;
+                }
+                const Eigen::Index px = r * range.cols() + c;
+                cloud.points.row(row++) =
+                    lut.direction.row(px).matrix() * value +
+                    lut.offset.row(px).matrix();
+            }
+        }
+        for (size_t f = 0; f < fields_.size(); ++f) {
+            impl::visit_field_2d(scan->field(fields_[f]), copy_field{}, range,
+                                 compact_, cloud.fields[f].data() + begin);
+        }
+    };
+
+    // one thread per sensor, the first one being the calling thread
+    std::vector<std::future<void>> workers;
+    for (size_t i = 1; i < n; ++i) {
+        workers.push_back(std::async(std::launch::async, fill, i));
+    }
+    fill(0);
+    for (auto& worker : workers) worker.get();
+
+    cloud.size = static_cast<size_t>(offsets[n]);
+    cloud.frame = frames_++;
+    next_ = (next_ + 1) % ring_.size();
+    return cloud;
+}
+
+const FusedCloud& FusedCloudBuilder::latest() const {
+    return ring_[(next_ + ring_.size() - 1) % ring_.size()];
+}
+
+const std::vector<std::string>& FusedCloudBuilder::fields() const {
+    return fields_;
+}
+
+size_t FusedCloudBuilder::sensors_count() const { return luts_.size(); }
+
+size_t FusedCloudBuilder::ring_size() const { return ring_.size(); }
+
+}  // namespace ouster
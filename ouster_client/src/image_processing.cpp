@@ -8,8 +8,14 @@
 #include <Eigen/Core>
 #include <Eigen/LU>
 #include <algorithm>
+#include <cstring>
 #include <vector>
 
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define OUSTER_AE_NEON
+#include <arm_neon.h>
+#endif
+
 namespace ouster {
 namespace viz {
 
@@ -38,6 +44,79 @@ const size_t ae_min_nonzero_points = 100;
 /* default percentile for scaling in autoexposure */
 const double ae_default_percentile = 0.1;
 
+/*
+ * Percentiles are selected with a histogram over buckets of ~1/16 of an
+ * octave: positive floats are ordered like their bit patterns, so the top
+ * bits, exponent and leading mantissa bits, bucket them in order
+ */
+const int ae_bucket_shift = 19;
+const size_t ae_buckets = size_t{1} << (31 - ae_bucket_shift);
+
+template <typename T>
+inline uint32_t ae_bucket(T x) {
+    // the conversion of doubles to float is monotonic, which is all the
+    // bucketing needs
+    const float f = static_cast<float>(x);
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    return bits >> ae_bucket_shift;
+}
+
+/*
+ * Find the bucket holding the kth smallest value given the histogram, and the
+ * number of values in lower buckets
+ */
+inline size_t ae_find_bucket(const std::vector<uint32_t>& histogram, size_t k,
+                             size_t& below) {
+    size_t b = 0;
+    below = 0;
+    while (below + histogram[b] <= k) below += histogram[b++];
+    return b;
+}
+
+/*
+ * Histogram every ae_stride-th value of data that is positive
+ * @return the number of values counted
+ */
+template <typename T>
+inline size_t ae_histogram(const T* data, size_t n, size_t first,
+                           std::vector<uint32_t>& histogram) {
+    size_t m = 0;
+    for (size_t i = first; i < n; i += ae_stride) {
+        if (data[i] > 0) {
+            histogram[ae_bucket(data[i])]++;
+            m++;
+        }
+    }
+    return m;
+}
+
+#ifdef OUSTER_AE_NEON
+// the buckets of four values at once: the deinterleaving load of 16 floats
+// puts every ae_stride-th of them in its first register
+static_assert(ae_stride == 4, "the NEON histogram loads every 4th value");
+
+inline size_t ae_histogram(const float* data, size_t n, size_t first,
+                           std::vector<uint32_t>& histogram) {
+    size_t m = 0;
+    size_t i = first;
+    uint32_t buckets[4], positive[4];
+    for (; i + 16 <= n; i += 16) {
+        const float32x4_t v = vld4q_f32(data + i).val[0];
+        vst1q_u32(positive, vcgtq_f32(v, vdupq_n_f32(0)));
+        vst1q_u32(buckets,
+                  vshrq_n_u32(vreinterpretq_u32_f32(v), ae_bucket_shift));
+        for (int k = 0; k < 4; k++) {
+            if (positive[k]) {
+                histogram[buckets[k]]++;
+                m++;
+            }
+        }
+    }
+    return m + ae_histogram<float>(data, n, i, histogram);
+}
+#endif
+
 }  // namespace
 
 AutoExposure::AutoExposure()
@@ -60,37 +139,47 @@ template <typename T>
 void AutoExposure::update(Eigen::Ref<img_t<T>> image, bool update_state) {
     Eigen::Map<Eigen::Array<T, -1, 1>> key_eigen(image.data(), image.size());
 
-    // int a;
     if (counter == 0 && update_state) {
+        // select the percentiles of the nonzero values, ignoring 0 values
+        // which are often due to dropped packets etc, in O(n): histogram the
+        // values, then select within the two buckets holding the percentiles
         const size_t n = key_eigen.rows();
-        std::vector<size_t> indices;
-        indices.reserve(n);
-        for (size_t i = 0; i < n; i += ae_stride) {
-            // ignore 0 values, which are often due to dropped packets etc
-            if (key_eigen[i] > 0) {
-                indices.push_back(i);
-            }
-        }
-        if (indices.size() < ae_min_nonzero_points) {
+        const T* data = key_eigen.data();
+        histogram.assign(ae_buckets, 0);
+        const size_t m = ae_histogram(data, n, 0, histogram);
+        if (m < ae_min_nonzero_points) {
             // too few nonzero values, nothing to do
             return;
         }
-        auto cmp = [&](const size_t a, const size_t b) {
-            return key_eigen(a) < key_eigen(b);
-        };
-
-        const size_t lo_kth_extreme =
-            static_cast<size_t>(indices.size() * lo_percentile);
-        std::nth_element(indices.begin(), indices.begin() + lo_kth_extreme,
-                         indices.end(), cmp);
-        lo = key_eigen[*(indices.begin() + lo_kth_extreme)];
-
-        const size_t hi_kth_extreme =
-            static_cast<size_t>(indices.size() * hi_percentile);
-        std::nth_element(indices.begin() + lo_kth_extreme,
-                         indices.end() - hi_kth_extreme - 1, indices.end(),
-                         cmp);
-        hi = key_eigen[*(indices.end() - hi_kth_extreme - 1)];
+
+        const size_t lo_k = static_cast<size_t>(m * lo_percentile);
+        const size_t hi_k = m - static_cast<size_t>(m * hi_percentile) - 1;
+        size_t lo_below, hi_below;
+        const size_t lo_bucket = ae_find_bucket(histogram, lo_k, lo_below);
+        const size_t hi_bucket = ae_find_bucket(histogram, hi_k, hi_below);
+
+        // kept across frames so a steady state doesn't allocate
+        lo_values.clear();
+        hi_values.clear();
+        lo_values.reserve(histogram[lo_bucket]);
+        if (hi_bucket != lo_bucket) hi_values.reserve(histogram[hi_bucket]);
+        for (size_t i = 0; i < n; i += ae_stride) {
+            if (data[i] > 0) {
+                const uint32_t b = ae_bucket(data[i]);
+                if (b == lo_bucket)
+                    lo_values.push_back(data[i]);
+                else if (b == hi_bucket)
+                    hi_values.push_back(data[i]);
+            }
+        }
+        if (hi_bucket == lo_bucket) hi_values = lo_values;
+
+        auto lo_kth = lo_values.begin() + (lo_k - lo_below);
+        std::nth_element(lo_values.begin(), lo_kth, lo_values.end());
+        lo = *lo_kth;
+        auto hi_kth = hi_values.begin() + (hi_k - hi_below);
+        std::nth_element(hi_values.begin(), hi_kth, hi_values.end());
+        hi = *hi_kth;
 
         if (!initialized) {
             initialized = true;
@@ -114,24 +203,24 @@ void AutoExposure::update(Eigen::Ref<img_t<T>> image, bool update_state) {
     double lo_hi_scale =
         (1.0 - (lo_percentile + hi_percentile)) / (hi_state - lo_state);
 
+    // the scaling and clamping are evaluated in a single pass over the image
     if (std::isinf(lo_hi_scale) || std::isnan(lo_hi_scale)) {
         // map everything relative to hi_state being 0.5 due to small spread or
         // nan
-        key_eigen *= 0.5 / hi_state;
+        key_eigen = (key_eigen * (0.5 / hi_state)).max(0.0).min(1.0);
     } else if (lo_hi_scale * (0.0 - lo_state) + lo_percentile <= 0.00) {
         // apply affine transformation
-        key_eigen -= lo_state;
-        key_eigen *= lo_hi_scale;
-        key_eigen += lo_percentile;
+        key_eigen = ((key_eigen - lo_state) * lo_hi_scale + lo_percentile)
+                        .max(0.0)
+                        .min(1.0);
     } else {
         // lo_hi_state transformation would map 0 to positive number
         // instead, map using only hi_state
-        key_eigen *= (1.0 - hi_percentile) / (hi_state);
+        key_eigen = (key_eigen * ((1.0 - hi_percentile) / (hi_state)))
+                        .max(0.0)
+                        .min(1.0);
     }
 
-    // clamp
-    key_eigen = key_eigen.max(0.0).min(1.0);
-
     if (update_state) {
         counter = (counter + 1) % ae_update_every;
     }
@@ -162,7 +251,7 @@ const double buc_damping = 0.92;
  * for performance reasons, we may not want to update every frame
  * but rather every 8 or so frames.
  */
-const int buc_update_every = 8;
+const int buc_default_update_every = 8;
 
 }  // namespace
 
@@ -176,13 +265,9 @@ static Eigen::Array<T, -1, 1> compute_dark_count(
     const size_t image_h = image.rows();
     const size_t image_w = image.cols();
 
-    Eigen::Array<T, -1, 1> tmp = Eigen::Array<T, -1, 1>::Zero(image_w);
     Eigen::Array<T, -1, 1> new_dark_count =
         Eigen::Array<T, -1, 1>::Zero(image_h);
 
-    // probably computed lazily when used below?
-    auto row_diffs = image.bottomRows(image_h - 1) - image.topRows(image_h - 1);
-
     // to handle azimuth-masked data, only consider columns with nonzero values
     Eigen::Array<bool, -1, 1> col_mask =
         image.template cast<bool>().colwise().any();
@@ -192,20 +277,39 @@ static Eigen::Array<T, -1, 1> compute_dark_count(
         return new_dark_count;
     }
 
-    img_t<T> row_diffs_nonzero{image_h - 1, n_cols};
-    for (size_t i = 0, j = 0; i < image_w && j < n_cols; i++) {
-        if (col_mask[i]) {
-            row_diffs_nonzero.col(j) = row_diffs.col(i);
-            j++;
+    // differences between rows, one row at a time over contiguous memory
+    // since the image is row-major; without masked columns, as is usual, this
+    // is a plain vectorized subtraction
+    img_t<T> row_diffs{image_h - 1, n_cols};
+    std::vector<Eigen::Index> cols;
+    if (n_cols < image_w) {
+        cols.reserve(n_cols);
+        for (size_t i = 0; i < image_w; i++) {
+            if (col_mask[i]) cols.push_back(i);
         }
     }
-
-    // compute the median of differences between rows
+    Eigen::Array<T, -1, 1> row_median(image_h);
+    row_median[0] = 0;
+
+    // compute the median of differences between rows, rows are independent
+#ifdef __OUSTER_UTILIZE_OPENMP__
+#pragma omp parallel for schedule(static)
+#endif
+    for (Eigen::Index i = 1; i < static_cast<Eigen::Index>(image_h); i++) {
+        auto diff = row_diffs.row(i - 1);
+        if (cols.empty()) {
+            diff = image.row(i) - image.row(i - 1);
+        } else {
+            for (size_t j = 0; j < n_cols; j++) {
+                diff[j] = image(i, cols[j]) - image(i - 1, cols[j]);
+            }
+        }
+        T* first = row_diffs.data() + (i - 1) * n_cols;
+        std::nth_element(first, first + n_cols / 2, first + n_cols);
+        row_median[i] = first[n_cols / 2];
+    }
     for (size_t i = 1; i < image_h; i++) {
-        tmp = row_diffs_nonzero.row(i - 1);
-        std::nth_element(tmp.data(), tmp.data() + n_cols / 2,
-                         tmp.data() + n_cols);
-        new_dark_count[i] = new_dark_count[i - 1] + tmp[n_cols / 2];
+        new_dark_count[i] = new_dark_count[i - 1] + row_median[i];
     }
 
     // remove gradients in the entire height of image by doing linear fit
@@ -222,6 +326,12 @@ static Eigen::Array<T, -1, 1> compute_dark_count(
     return new_dark_count;
 }
 
+BeamUniformityCorrector::BeamUniformityCorrector()
+    : buc_update_every(buc_default_update_every) {}
+
+BeamUniformityCorrector::BeamUniformityCorrector(int update_every)
+    : buc_update_every(update_every) {}
+
 template <typename T>
 void BeamUniformityCorrector::update(Eigen::Ref<img_t<T>> image,
                                      bool update_state) {
@@ -239,11 +349,15 @@ void BeamUniformityCorrector::update(Eigen::Ref<img_t<T>> image,
     }
     counter = (counter + 1) % buc_update_every;
 
-    // apply the dark count correction
-    image.colwise() -= dark_count.cast<T>();
-
-    // clamp any negative values
-    image = image.cwiseMax(0.0);
+    // apply the dark count correction and clamp any negative values, in one
+    // pass over each row
+#ifdef __OUSTER_UTILIZE_OPENMP__
+#pragma omp parallel for schedule(static)
+#endif
+    for (Eigen::Index i = 0; i < image_h; i++) {
+        image.row(i) =
+            (image.row(i) - static_cast<T>(dark_count[i])).cwiseMax(T{0});
+    }
 }
 
 void BeamUniformityCorrector::operator()(Eigen::Ref<img_t<float>> image,
@@ -0,0 +1,127 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/imu_batcher.h"
+
+#include <algorithm>
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace ouster {
+
+namespace {
+
+constexpr double deg_to_rad = M_PI / 180.0;
+
+}  // namespace
+
+void ImuBatch::clear() {
+    ts.clear();
+    accel_ts.clear();
+    accel.clear();
+    gyro.clear();
+    column.clear();
+}
+
+void ImuBatch::reserve(size_t samples) {
+    ts.reserve(samples);
+    accel_ts.reserve(samples);
+    accel.reserve(3 * samples);
+    gyro.reserve(3 * samples);
+    column.reserve(samples);
+}
+
+void ImuBatch::push_back(const ImuSample& sample, uint64_t accel_ts) {
+    ts.push_back(sample.ts);
+    this->accel_ts.push_back(accel_ts);
+    accel.insert(accel.end(), sample.accel.data(), sample.accel.data() + 3);
+    gyro.insert(gyro.end(), sample.gyro.data(), sample.gyro.data() + 3);
+    column.push_back(-1);
+}
+
+ImuSample ImuBatch::sample(size_t i) const {
+    return ImuSample{ts[i], Eigen::Vector3d(accel.data() + 3 * i),
+                     Eigen::Vector3d(gyro.data() + 3 * i)};
+}
+
+ImuBatcher::ImuBatcher(size_t capacity) { pending_.reserve(capacity); }
+
+void ImuBatcher::operator()(const sensor::ImuPacket& packet) {
+    ImuSample sample;
+    sample.ts = packet.gyro_ts();
+    sample.accel =
+        Eigen::Vector3d(packet.la_x(), packet.la_y(), packet.la_z()) *
+        ImuPreintegrator::gravity;
+    sample.gyro =
+        Eigen::Vector3d(packet.av_x(), packet.av_y(), packet.av_z()) *
+        deg_to_rad;
+    add(sample, packet.accel_ts());
+}
+
+void ImuBatcher::add(const ImuSample& sample, uint64_t accel_ts) {
+    if (!pending_.empty() && sample.ts <= pending_.ts.back()) {
+        dropped_++;
+        return;
+    }
+    pending_.push_back(sample, accel_ts != 0 ? accel_ts : sample.ts);
+}
+
+size_t ImuBatcher::batch(const LidarScan& scan, ImuBatch& out) {
+    const auto ts = scan.timestamp();
+    const auto status = scan.status();
+
+    // the first and last valid columns, whose timestamps increase through
+    // the scan
+    int32_t first = -1;
+    int32_t last = -1;
+    for (int32_t v = 0; v < static_cast<int32_t>(scan.w); v++) {
+        if (!(status[v] & 0x01)) continue;
+        if (first < 0) first = v;
+        last = v;
+    }
+    out.clear();
+    if (last < 0) return 0;
+
+    const auto end =
+        std::upper_bound(pending_.ts.begin(), pending_.ts.end(), ts[last]);
+    const size_t n = end - pending_.ts.begin();
+    out.reserve(n);
+    out.ts.assign(pending_.ts.begin(), end);
+    out.accel_ts.assign(pending_.accel_ts.begin(),
+                        pending_.accel_ts.begin() + n);
+    out.accel.assign(pending_.accel.begin(), pending_.accel.begin() + 3 * n);
+    out.gyro.assign(pending_.gyro.begin(), pending_.gyro.begin() + 3 * n);
+    out.column.assign(n, -1);
+
+    // align each sample after the start of the scan with the first valid
+    // column at or after it
+    int32_t v = first;
+    for (size_t i = 0; i < n; i++) {
+        if (out.ts[i] < ts[first]) continue;
+        while (!(status[v] & 0x01) || ts[v] < out.ts[i]) v++;
+        out.column[i] = v;
+    }
+
+    pending_.ts.erase(pending_.ts.begin(), pending_.ts.begin() + n);
+    pending_.accel_ts.erase(pending_.accel_ts.begin(),
+                            pending_.accel_ts.begin() + n);
+    pending_.accel.erase(pending_.accel.begin(),
+                         pending_.accel.begin() + 3 * n);
+    pending_.gyro.erase(pending_.gyro.begin(), pending_.gyro.begin() + 3 * n);
+    pending_.column.erase(pending_.column.begin(),
+                          pending_.column.begin() + n);
+    return n;
+}
+
+size_t ImuBatcher::pending() const { return pending_.size(); }
+
+uint64_t ImuBatcher::dropped() const { return dropped_; }
+
+void ImuBatcher::reset() { pending_.clear(); }
+
+}  // namespace ouster
@@ -0,0 +1,226 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/imu_preintegrator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "ouster/imu_batcher.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace ouster {
+
+namespace {
+
+constexpr double deg_to_rad = M_PI / 180.0;
+
+Eigen::Quaterniond exp_rotation(const Eigen::Vector3d& v) {
+    const double angle = v.norm();
+    if (angle < 1e-12) return Eigen::Quaterniond::Identity();
+    return Eigen::Quaterniond(Eigen::AngleAxisd(angle, v / angle));
+}
+
+}  // namespace
+
+constexpr double ImuPreintegrator::gravity;
+
+ImuPreintegrator::ImuPreintegrator(const mat4d& imu_to_sensor_transform,
+                                   size_t init_samples, double history)
+    : imu_to_sensor_(imu_to_sensor_transform),
+      init_samples_(std::max<size_t>(init_samples, 1)),
+      history_(history) {
+    // the sensor frame is in mm, poses are in m
+    imu_to_sensor_.topRightCorner<3, 1>() *= sensor::range_unit;
+}
+
+void ImuPreintegrator::add(const sensor::ImuPacket& packet) {
+    ImuSample sample;
+    sample.ts = packet.gyro_ts();
+    sample.accel = Eigen::Vector3d(packet.la_x(), packet.la_y(),
+                                   packet.la_z()) *
+                   gravity;
+    sample.gyro = Eigen::Vector3d(packet.av_x(), packet.av_y(),
+                                  packet.av_z()) *
+                  deg_to_rad;
+    add(sample);
+}
+
+void ImuPreintegrator::add(const ImuBatch& batch) {
+    for (size_t i = 0; i < batch.size(); i++) add(batch.sample(i));
+}
+
+void ImuPreintegrator::add(const ImuSample& sample) {
+    if (has_last_ && sample.ts <= last_.ts) return;
+
+    if (states_.empty()) {
+        init_gyro_ += sample.gyro;
+        init_accel_ += sample.accel;
+        last_ = sample;
+        has_last_ = true;
+        if (++init_count_ < init_samples_) return;
+
+        if (!bias_set_) gyro_bias_ = init_gyro_ / init_count_;
+        // the static specific force points up
+        const Eigen::Vector3d up = init_accel_ / init_count_ - accel_bias_;
+        State state;
+        state.t = 0;
+        state.q = Eigen::Quaterniond::FromTwoVectors(up,
+                                                     Eigen::Vector3d::UnitZ());
+        state.p.setZero();
+        state.v.setZero();
+        state.w = sample.gyro - gyro_bias_;
+        origin_ = sample.ts;
+        states_.push_back(state);
+        return;
+    }
+
+    // midpoint integration between the last sample and this one
+    const State& prev = states_.back();
+    const double dt = static_cast<double>(sample.ts - last_.ts) * 1e-9;
+    const Eigen::Vector3d w = 0.5 * (last_.gyro + sample.gyro) - gyro_bias_;
+
+    State state;
+    state.t = static_cast<double>(sample.ts - origin_) * 1e-9;
+    state.q = (prev.q * exp_rotation(w * dt)).normalized();
+    const Eigen::Vector3d a =
+        0.5 * (prev.q * (last_.accel - accel_bias_) +
+               state.q * (sample.accel - accel_bias_)) -
+        Eigen::Vector3d(0, 0, gravity);
+    state.v = prev.v + a * dt;
+    state.p = prev.p + prev.v * dt + 0.5 * a * dt * dt;
+    state.w = sample.gyro - gyro_bias_;
+    states_.push_back(state);
+    last_ = sample;
+
+    while (states_.size() > 2 && states_[1].t < state.t - history_) {
+        states_.pop_front();
+    }
+}
+
+bool ImuPreintegrator::initialized() const { return !states_.empty(); }
+
+void ImuPreintegrator::reset(bool keep_bias) {
+    states_.clear();
+    has_last_ = false;
+    init_count_ = 0;
+    init_gyro_.setZero();
+    init_accel_.setZero();
+    if (!keep_bias) {
+        bias_set_ = false;
+        gyro_bias_.setZero();
+        accel_bias_.setZero();
+    } else {
+        bias_set_ = true;
+    }
+}
+
+void ImuPreintegrator::set_bias(const Eigen::Vector3d& gyro,
+                                const Eigen::Vector3d& accel) {
+    gyro_bias_ = gyro;
+    accel_bias_ = accel;
+    bias_set_ = true;
+}
+
+const Eigen::Vector3d& ImuPreintegrator::gyro_bias() const {
+    return gyro_bias_;
+}
+
+const Eigen::Vector3d& ImuPreintegrator::accel_bias() const {
+    return accel_bias_;
+}
+
+void ImuPreintegrator::check_initialized() const {
+    if (states_.empty()) {
+        throw std::runtime_error("ImuPreintegrator is not initialized");
+    }
+}
+
+void ImuPreintegrator::set_velocity(const Eigen::Vector3d& velocity) {
+    check_initialized();
+    states_.back().v = velocity;
+}
+
+Eigen::Vector3d ImuPreintegrator::velocity() const {
+    check_initialized();
+    return states_.back().v;
+}
+
+Eigen::Matrix4d ImuPreintegrator::pose_at(double t) const {
+    Eigen::Quaterniond q;
+    Eigen::Vector3d p;
+    const State& front = states_.front();
+    const State& back = states_.back();
+    if (t <= front.t || t >= back.t) {
+        // constant angular and linear velocity out of the history
+        const State& s = t <= front.t ? front : back;
+        const double dt = t - s.t;
+        q = s.q * exp_rotation(s.w * dt);
+        p = s.p + s.v * dt;
+    } else {
+        auto next = std::upper_bound(
+            states_.begin(), states_.end(), t,
+            [](double value, const State& s) { return value < s.t; });
+        const State& a = *(next - 1);
+        const State& b = *next;
+        const double ratio = (t - a.t) / (b.t - a.t);
+        q = a.q.slerp(ratio, b.q);
+        p = a.p + ratio * (b.p - a.p);
+    }
+    Eigen::Matrix4d imu = Eigen::Matrix4d::Identity();
+    imu.topLeftCorner<3, 3>() = q.toRotationMatrix();
+    imu.topRightCorner<3, 1>() = p;
+    // pose of the sensor frame from the pose of the imu frame
+    Eigen::Matrix4d sensor_to_imu = Eigen::Matrix4d::Identity();
+    sensor_to_imu.topLeftCorner<3, 3>() =
+        imu_to_sensor_.topLeftCorner<3, 3>().transpose();
+    sensor_to_imu.topRightCorner<3, 1>() =
+        -sensor_to_imu.topLeftCorner<3, 3>() *
+        imu_to_sensor_.topRightCorner<3, 1>();
+    return imu * sensor_to_imu;
+}
+
+void ImuPreintegrator::poses_at(
+    Eigen::Ref<pose_util::Poses> poses,
+    const Eigen::Ref<const Eigen::ArrayXd>& ts) const {
+    check_initialized();
+    if (poses.rows() < ts.size()) {
+        throw std::invalid_argument("expected a row of poses per timestamp");
+    }
+    const double origin = static_cast<double>(origin_);
+    for (Eigen::Index i = 0; i < ts.size(); ++i) {
+        const Eigen::Matrix<double, 4, 4, Eigen::RowMajor> pose =
+            pose_at((ts(i) - origin) * 1e-9);
+        poses.row(i) = Eigen::Map<const pose_util::Pose>(pose.data());
+    }
+}
+
+pose_util::Poses ImuPreintegrator::poses_at(
+    const Eigen::Ref<const Eigen::ArrayXd>& ts) const {
+    pose_util::Poses poses(ts.size(), 16);
+    poses_at(poses, ts);
+    return poses;
+}
+
+void ImuPreintegrator::pose_scan(LidarScan& scan) const {
+    check_initialized();
+    const auto ts = scan.timestamp();
+    const auto status = scan.status();
+    Eigen::Map<pose_util::Poses> poses(scan.pose().get<double>(), scan.w, 16);
+    for (Eigen::Index c = 0; c < ts.size(); ++c) {
+        if (!(status(c) & 0x01)) continue;
+        // exact differences of the integer timestamps
+        const double t =
+            static_cast<double>(static_cast<int64_t>(ts(c) - origin_)) * 1e-9;
+        const Eigen::Matrix<double, 4, 4, Eigen::RowMajor> pose = pose_at(t);
+        poses.row(c) = Eigen::Map<const pose_util::Pose>(pose.data());
+    }
+}
+
+}  // namespace ouster
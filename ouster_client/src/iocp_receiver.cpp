@@ -0,0 +1,192 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/impl/iocp_receiver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace ouster {
+namespace sensor {
+namespace impl {
+
+#ifdef _WIN32
+
+struct IocpReceiver::Slot {
+    OVERLAPPED overlapped;  // first, so completions map back to the slot
+    SOCKET sock;
+    std::vector<uint8_t> buf;
+    sockaddr_storage from;
+    INT from_len;
+    DWORD flags;
+};
+
+static uint64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+IocpReceiver::IocpReceiver(const std::vector<SOCKET>& sockets, size_t depth,
+                           size_t buffer_size)
+    : sockets_(sockets), buffer_size_(buffer_size) {
+    HANDLE port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+    if (!port) {
+        throw std::runtime_error("failed to create I/O completion port: " +
+                                 socket_get_error());
+    }
+    port_ = port;
+
+    auto fail = [this](const std::string& what) {
+        std::string msg = what + ": " + socket_get_error();
+        shutdown();
+        throw std::runtime_error(msg);
+    };
+
+    for (auto sock : sockets_) {
+        if (!CreateIoCompletionPort(reinterpret_cast<HANDLE>(sock), port, 0,
+                                    0)) {
+            fail("failed to associate socket with completion port");
+        }
+        for (size_t i = 0; i < depth; i++) {
+            slots_.push_back(std::make_unique<Slot>());
+            Slot& slot = *slots_.back();
+            slot.sock = sock;
+            slot.buf.resize(buffer_size_);
+            if (!post(slot)) fail("failed to post UDP receive");
+        }
+    }
+}
+
+IocpReceiver::~IocpReceiver() { shutdown(); }
+
+void IocpReceiver::shutdown() {
+    if (!port_) return;
+    HANDLE port = static_cast<HANDLE>(port_);
+    // the buffers must outlive every receive the stack may still write to
+    for (auto sock : sockets_) {
+        CancelIoEx(reinterpret_cast<HANDLE>(sock), nullptr);
+    }
+    OVERLAPPED_ENTRY entries[64];
+    while (pending_ > 0) {
+        ULONG n = 0;
+        if (!GetQueuedCompletionStatusEx(port, entries, 64, &n, 1000,
+                                         FALSE)) {
+            break;  // nothing left to complete
+        }
+        pending_ -= std::min<size_t>(pending_, n);
+    }
+    CloseHandle(port);
+    port_ = nullptr;
+}
+
+bool IocpReceiver::post(Slot& slot) {
+    for (;;) {
+        memset(&slot.overlapped, 0, sizeof(slot.overlapped));
+        WSABUF wsabuf;
+        wsabuf.buf = reinterpret_cast<char*>(slot.buf.data());
+        wsabuf.len = static_cast<ULONG>(slot.buf.size());
+        slot.from_len = sizeof(slot.from);
+        slot.flags = 0;
+        int ret = WSARecvFrom(slot.sock, &wsabuf, 1, nullptr, &slot.flags,
+                              reinterpret_cast<sockaddr*>(&slot.from),
+                              &slot.from_len, &slot.overlapped, nullptr);
+        if (ret == 0 || WSAGetLastError() == WSA_IO_PENDING) {
+            // completions are queued on the port even on immediate success
+            pending_++;
+            return true;
+        }
+        // an ICMP port unreachable for an earlier send, not fatal for UDP
+        if (WSAGetLastError() == WSAECONNRESET) continue;
+        return false;
+    }
+}
+
+int IocpReceiver::wait(double timeout_sec) {
+    if (ready()) return static_cast<int>(completed_.size());
+
+    DWORD timeout_ms =
+        timeout_sec < 0 ? INFINITE
+                        : static_cast<DWORD>(std::ceil(timeout_sec * 1000));
+    OVERLAPPED_ENTRY entries[64];
+    ULONG n = 0;
+    if (!GetQueuedCompletionStatusEx(static_cast<HANDLE>(port_), entries, 64,
+                                     &n, timeout_ms, FALSE)) {
+        return GetLastError() == WAIT_TIMEOUT ? 0 : -1;
+    }
+
+    const uint64_t ts = now_ns();
+    for (ULONG i = 0; i < n; i++) {
+        Slot* slot = reinterpret_cast<Slot*>(entries[i].lpOverlapped);
+        pending_--;
+        // Internal holds the status of the receive, e.g. a truncated
+        // datagram or a reset, which are dropped like recvfrom errors
+        if (entries[i].Internal != 0 ||
+            entries[i].dwNumberOfBytesTransferred == 0) {
+            post(*slot);
+            continue;
+        }
+        completed_.push_back(
+            {slot, entries[i].dwNumberOfBytesTransferred, ts});
+    }
+    return static_cast<int>(completed_.size());
+}
+
+size_t IocpReceiver::next(std::vector<uint8_t>& data, size_t max_size,
+                          sockaddr_storage& from, uint64_t& ts) {
+    if (completed_.empty()) return 0;
+    Completion c = completed_.front();
+    completed_.pop_front();
+
+    Slot& slot = *c.slot;
+    std::swap(data, slot.buf);
+    const size_t size = std::min(c.size, max_size);
+    data.resize(size);
+    memcpy(&from, &slot.from, sizeof(from));
+    ts = c.ts;
+
+    // the buffer swapped in keeps its capacity, so after the first round
+    // trip through a packet pool this doesn't allocate
+    slot.buf.resize(buffer_size_);
+    post(slot);
+    return size;
+}
+
+#else
+
+struct IocpReceiver::Slot {};
+
+IocpReceiver::IocpReceiver(const std::vector<SOCKET>&, size_t, size_t)
+    : buffer_size_(0) {
+    throw std::runtime_error(
+        "I/O completion port receive is only supported on Windows");
+}
+
+IocpReceiver::~IocpReceiver() {}
+
+void IocpReceiver::shutdown() {}
+
+bool IocpReceiver::post(Slot&) { return false; }
+
+int IocpReceiver::wait(double) { return -1; }
+
+size_t IocpReceiver::next(std::vector<uint8_t>&, size_t, sockaddr_storage&,
+                          uint64_t&) {
+    return 0;
+}
+
+#endif
+
+}  // namespace impl
+}  // namespace sensor
+}  // namespace ouster
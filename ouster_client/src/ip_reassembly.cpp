@@ -0,0 +1,204 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/ip_reassembly.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace ouster {
+namespace sensor {
+
+namespace {
+
+constexpr size_t MIN_HEADER_SIZE = 20;
+constexpr size_t MAX_HEADER_SIZE = 60;
+constexpr size_t MAX_IP_SIZE = 65535;
+constexpr uint16_t MORE_FRAGMENTS = 0x2000;
+constexpr uint16_t FRAGMENT_OFFSET = 0x1fff;
+
+uint16_t be16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+uint32_t be32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) |
+           (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+void put_be16(uint8_t* p, uint16_t value) {
+    p[0] = static_cast<uint8_t>(value >> 8);
+    p[1] = static_cast<uint8_t>(value & 0xff);
+}
+
+uint16_t header_checksum(const uint8_t* header, size_t size) {
+    uint32_t sum = 0;
+    for (size_t i = 0; i + 1 < size; i += 2) sum += be16(header + i);
+    while (sum >> 16) sum = (sum & 0xffff) + (sum >> 16);
+    return static_cast<uint16_t>(~sum);
+}
+
+}  // namespace
+
+IpReassembler::IpReassembler(const IpReassemblyOptions& options)
+    : options_(options) {
+    if (options_.capacity == 0) {
+        throw std::invalid_argument(
+            "IpReassembler needs a capacity of at least 1");
+    }
+    if (options_.max_datagram_size <= MIN_HEADER_SIZE ||
+        options_.max_datagram_size > MAX_IP_SIZE) {
+        throw std::invalid_argument(
+            "IpReassembler max_datagram_size must be in (20, 65535]");
+    }
+    const size_t max_payload = options_.max_datagram_size - MIN_HEADER_SIZE;
+    bitmap_words_ = (max_payload + 8 * 64 - 1) / (8 * 64);
+    slots_.resize(options_.capacity);
+    buffers_.resize(options_.capacity * (MAX_HEADER_SIZE + max_payload));
+    bitmaps_.resize(options_.capacity * bitmap_words_);
+    stats_.capacity = options_.capacity;
+    stats_.memory = buffers_.size() + bitmaps_.size() * sizeof(uint64_t);
+}
+
+IpReassembler::Status IpReassembler::process(
+    std::chrono::microseconds timestamp, const uint8_t* ip, size_t size,
+    const uint8_t*& datagram, size_t& datagram_size) {
+    if (size < MIN_HEADER_SIZE || (ip[0] >> 4) != 4) return NOT_FRAGMENTED;
+    const size_t header_size = (ip[0] & 0x0f) * 4u;
+    const uint16_t fragment = be16(ip + 6);
+    const bool more = (fragment & MORE_FRAGMENTS) != 0;
+    const size_t offset = (fragment & FRAGMENT_OFFSET) * 8u;
+    if (!more && offset == 0) return NOT_FRAGMENTED;
+
+    stats_.fragments++;
+    const size_t ip_size = be16(ip + 2);
+    const size_t max_payload = options_.max_datagram_size - MIN_HEADER_SIZE;
+    // a fragment cut short by the capture can't be reassembled either, and
+    // only the last one may end between blocks
+    if (header_size < MIN_HEADER_SIZE || ip_size < header_size ||
+        ip_size > size || (more && (ip_size - header_size) % 8 != 0)) {
+        stats_.malformed++;
+        return FRAGMENTED;
+    }
+    const size_t length = ip_size - header_size;
+    const size_t end = offset + length;
+
+    const size_t s = slot_for(timestamp, be16(ip + 4), ip[9], be32(ip + 12),
+                              be32(ip + 16));
+    Slot& slot = slots_[s];
+    if (end > max_payload || (slot.total_size && end > slot.total_size) ||
+        (!more && (end < slot.end ||
+                   (slot.total_size && end != slot.total_size)))) {
+        stats_.malformed++;
+        release(s);
+        return FRAGMENTED;
+    }
+
+    uint8_t* buffer =
+        buffers_.data() + s * (MAX_HEADER_SIZE + max_payload);
+    uint8_t* payload = buffer + MAX_HEADER_SIZE;
+    std::memcpy(payload + offset, ip + header_size, length);
+    uint64_t* bitmap = bitmaps_.data() + s * bitmap_words_;
+    for (size_t block = offset / 8; block < (end + 7) / 8; ++block) {
+        const uint64_t bit = uint64_t{1} << (block % 64);
+        if (!(bitmap[block / 64] & bit)) {
+            bitmap[block / 64] |= bit;
+            slot.blocks++;
+        }
+    }
+    slot.end = std::max(slot.end, end);
+    if (!more) slot.total_size = end;
+    if (offset == 0) {
+        // kept right before the payload, so that the datagram is contiguous
+        slot.header_size = header_size;
+        std::memcpy(payload - header_size, ip, header_size);
+    }
+
+    if (!slot.total_size || !slot.header_size ||
+        slot.blocks != (slot.total_size + 7) / 8) {
+        return FRAGMENTED;
+    }
+    if (slot.header_size + slot.total_size > options_.max_datagram_size) {
+        stats_.malformed++;
+        release(s);
+        return FRAGMENTED;
+    }
+
+    uint8_t* header = payload - slot.header_size;
+    put_be16(header + 2,
+             static_cast<uint16_t>(slot.header_size + slot.total_size));
+    put_be16(header + 6, 0);
+    put_be16(header + 10, 0);
+    put_be16(header + 10, header_checksum(header, slot.header_size));
+    datagram = header;
+    datagram_size = slot.header_size + slot.total_size;
+    stats_.reassembled++;
+    // the buffer is left as is until the slot is taken again
+    release(s);
+    return REASSEMBLED;
+}
+
+IpReassemblyStats IpReassembler::stats() const { return stats_; }
+
+void IpReassembler::clear() {
+    for (size_t s = 0; s < slots_.size(); ++s) {
+        if (slots_[s].used) release(s);
+    }
+}
+
+size_t IpReassembler::slot_for(std::chrono::microseconds timestamp,
+                               uint16_t id, uint8_t protocol, uint32_t src,
+                               uint32_t dst) {
+    size_t found = slots_.size();
+    size_t free = slots_.size();
+    size_t oldest = slots_.size();
+    for (size_t s = 0; s < slots_.size(); ++s) {
+        Slot& slot = slots_[s];
+        if (slot.used && timestamp - slot.last_timestamp > options_.timeout) {
+            stats_.timed_out++;
+            release(s);
+        }
+        if (!slot.used) {
+            if (free == slots_.size()) free = s;
+            continue;
+        }
+        if (slot.id == id && slot.protocol == protocol && slot.src == src &&
+            slot.dst == dst) {
+            found = s;
+        } else if (oldest == slots_.size() ||
+                   slot.last_timestamp < slots_[oldest].last_timestamp) {
+            oldest = s;
+        }
+    }
+    if (found == slots_.size()) {
+        if (free == slots_.size()) {
+            stats_.evicted++;
+            release(oldest);
+            free = oldest;
+        }
+        found = free;
+        Slot& slot = slots_[found];
+        slot.used = true;
+        slot.id = id;
+        slot.protocol = protocol;
+        slot.src = src;
+        slot.dst = dst;
+        stats_.in_progress++;
+    }
+    slots_[found].last_timestamp = timestamp;
+    return found;
+}
+
+void IpReassembler::release(size_t slot) {
+    Slot& released = slots_[slot];
+    released = Slot();
+    std::fill_n(bitmaps_.begin() + slot * bitmap_words_, bitmap_words_, 0);
+    stats_.in_progress--;
+}
+
+}  // namespace sensor
+}  // namespace ouster
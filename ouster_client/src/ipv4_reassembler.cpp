@@ -0,0 +1,40 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/impl/ipv4_reassembler.h"
+
+#include <cstring>
+
+namespace ouster {
+namespace sensor {
+namespace impl {
+
+static uint16_t read_be16(const uint8_t* buf) {
+    return static_cast<uint16_t>((buf[0] << 8) | buf[1]);
+}
+
+bool parse_ipv4_header(const uint8_t* buf, size_t len, Ipv4Header& header) {
+    if (len < 20 || (buf[0] >> 4) != 4) {
+        return false;
+    }
+    header.header_len = (buf[0] & 0x0F) * 4;
+    header.total_len = read_be16(buf + 2);
+    if (header.header_len < 20 || header.total_len < header.header_len ||
+        header.total_len > len) {
+        return false;
+    }
+    header.id = read_be16(buf + 4);
+    uint16_t flags_offset = read_be16(buf + 6);
+    header.more = (flags_offset & 0x2000) != 0;
+    header.offset = static_cast<uint16_t>((flags_offset & 0x1FFF) * 8);
+    header.protocol = buf[9];
+    memcpy(&header.src, buf + 12, 4);
+    memcpy(&header.dst, buf + 16, 4);
+    return true;
+}
+
+}  // namespace impl
+}  // namespace sensor
+}  // namespace ouster
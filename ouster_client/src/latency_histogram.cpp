@@ -0,0 +1,130 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace ouster {
+namespace sensor {
+
+namespace {
+
+// index of the most significant bit set in v, which is non zero
+int msb(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(v);
+#else
+    int result = 0;
+    while (v >>= 1) result++;
+    return result;
+#endif
+}
+
+constexpr int sub_bucket_bits = 5;
+
+}  // namespace
+
+constexpr int LatencyHistogram::sub_buckets;
+constexpr int LatencyHistogram::buckets;
+
+LatencyHistogram::LatencyHistogram() { reset(); }
+
+int LatencyHistogram::bucket_index(uint64_t ns) {
+    // values below 2 * sub_buckets get a bucket each, above that every power
+    // of two gets sub_buckets buckets
+    if (ns < 2 * sub_buckets) return static_cast<int>(ns);
+    const int shift = msb(ns) - sub_bucket_bits;
+    return shift * sub_buckets + static_cast<int>(ns >> shift);
+}
+
+uint64_t LatencyHistogram::bucket_lowest(int index) {
+    if (index < 2 * sub_buckets) return static_cast<uint64_t>(index);
+    const int shift = index / sub_buckets - 1;
+    return static_cast<uint64_t>(index - shift * sub_buckets) << shift;
+}
+
+void LatencyHistogram::record(uint64_t ns) {
+    counts_[bucket_index(ns)].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(ns, std::memory_order_relaxed);
+    uint64_t prev = min_.load(std::memory_order_relaxed);
+    while (ns < prev &&
+           !min_.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) {
+    }
+    prev = max_.load(std::memory_order_relaxed);
+    while (ns > prev &&
+           !max_.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) {
+    }
+    // counted last, so readers seeing the count see the bucket too
+    count_.fetch_add(1, std::memory_order_release);
+}
+
+void LatencyHistogram::add(const LatencyHistogram& other) {
+    if (other.count() == 0) return;
+    for (int i = 0; i < buckets; i++) {
+        auto n = other.counts_[i].load(std::memory_order_relaxed);
+        if (n) counts_[i].fetch_add(n, std::memory_order_relaxed);
+    }
+    sum_.fetch_add(other.sum_.load(std::memory_order_relaxed),
+                   std::memory_order_relaxed);
+    min_.store(std::min(min_.load(), other.min_.load()));
+    max_.store(std::max(max_.load(), other.max_.load()));
+    count_.fetch_add(other.count(), std::memory_order_release);
+}
+
+void LatencyHistogram::reset() {
+    for (auto& c : counts_) c.store(0, std::memory_order_relaxed);
+    sum_ = 0;
+    min_ = std::numeric_limits<uint64_t>::max();
+    max_ = 0;
+    count_ = 0;
+}
+
+uint64_t LatencyHistogram::count() const {
+    return count_.load(std::memory_order_acquire);
+}
+
+uint64_t LatencyHistogram::value_at_quantile(double q) const {
+    // the buckets may be ahead of the count under concurrent records, so rank
+    // against what the buckets hold
+    uint64_t total = 0;
+    for (const auto& c : counts_) total += c.load(std::memory_order_relaxed);
+    if (total == 0) return 0;
+    q = std::min(std::max(q, 0.0), 1.0);
+    const uint64_t rank =
+        std::max<uint64_t>(static_cast<uint64_t>(std::ceil(q * total)), 1);
+    uint64_t seen = 0;
+    for (int i = 0; i < buckets; i++) {
+        seen += counts_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            // the middle of the bucket, within the values actually seen
+            const uint64_t lo = bucket_lowest(i);
+            const uint64_t hi =
+                i + 1 < buckets ? bucket_lowest(i + 1) - 1 : lo;
+            const uint64_t mid = lo + (hi - lo) / 2;
+            return std::min(std::max(mid, min_.load()), max_.load());
+        }
+    }
+    return max_.load();
+}
+
+LatencyStats LatencyHistogram::summary() const {
+    LatencyStats stats;
+    stats.count = count();
+    if (stats.count == 0) return stats;
+    stats.min = min_.load();
+    stats.max = max_.load();
+    stats.mean = static_cast<double>(sum_.load()) / stats.count;
+    stats.p50 = value_at_quantile(0.5);
+    stats.p90 = value_at_quantile(0.9);
+    stats.p99 = value_at_quantile(0.99);
+    stats.p999 = value_at_quantile(0.999);
+    return stats;
+}
+
+}  // namespace sensor
+}  // namespace ouster
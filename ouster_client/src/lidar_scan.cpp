@@ -6,16 +6,30 @@
 #include "ouster/lidar_scan.h"
 
 #include <Eigen/Core>
+#include <Eigen/Geometry>
 #include <algorithm>
+#include <cassert>
+#include <cctype>
 #include <cmath>
 #include <cstddef>
 #include <cstring>
+#include <deque>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "ouster/field_ops.h"
+#include "ouster/impl/cartesian_kernel.h"
 #include "ouster/impl/lidar_scan_impl.h"
 #include "ouster/impl/logging.h"
+#include "ouster/impl/profile_parser.h"
 #include "ouster/strings.h"
+#include "ouster/trace.h"
 #include "ouster/types.h"
 #include "ouster/visibility.h"
 
@@ -48,9 +62,80 @@ using sensor::ChanFieldType;
 using sensor::UDPProfileLidar;
 
 LidarScan::LidarScan() = default;
-LidarScan::LidarScan(const LidarScan&) = default;
+LidarScan::LidarScan(const LidarScan& other)
+    : deferred_fields_(other.deferred_fields_),
+      deferred_packets_(other.deferred_packets_),
+      packet_count_(other.packet_count_),
+      w(other.w),
+      h(other.h),
+      columns_per_packet_(other.columns_per_packet_),
+      frame_status(other.frame_status),
+      shutdown_countdown(other.shutdown_countdown),
+      shot_limiting_countdown(other.shot_limiting_countdown),
+      frame_id(other.frame_id),
+      sensor_info(other.sensor_info) {
+    if (other.is_contiguous()) {
+        copy_arena(other);
+        return;
+    }
+    fields_ = other.fields_;
+    timestamp_ = other.timestamp_;
+    measurement_id_ = other.measurement_id_;
+    status_ = other.status_;
+    packet_timestamp_ = other.packet_timestamp_;
+    pose_ = other.pose_;
+    alert_flags_ = other.alert_flags_;
+    reindex();
+}
 LidarScan::LidarScan(LidarScan&&) = default;
-LidarScan& LidarScan::operator=(const LidarScan&) = default;
+LidarScan& LidarScan::operator=(const LidarScan& other) {
+    if (this == &other || assign_in_place(other)) return *this;
+    LidarScan copy(other);
+    return *this = std::move(copy);
+}
+
+bool LidarScan::assign_in_place(const LidarScan& other) {
+    // fields in an arena are views, which Field can't copy into
+    if (arena_ || w != other.w || h != other.h ||
+        fields_.size() != other.fields_.size() || !deferred_fields_.empty() ||
+        !other.deferred_fields_.empty()) {
+        return false;
+    }
+    auto same = [](const Field& a, const Field& b) {
+        return a.desc() == b.desc() && a.field_class() == b.field_class();
+    };
+    for (const auto& kv : other.fields_) {
+        auto it = fields_.find(kv.first);
+        if (it == fields_.end() || !same(it->second, kv.second)) return false;
+    }
+    if (!same(timestamp_, other.timestamp_) ||
+        !same(measurement_id_, other.measurement_id_) ||
+        !same(status_, other.status_) ||
+        !same(packet_timestamp_, other.packet_timestamp_) ||
+        !same(pose_, other.pose_) ||
+        !same(alert_flags_, other.alert_flags_)) {
+        return false;
+    }
+
+    for (const auto& kv : other.fields_) {
+        fields_.find(kv.first)->second = kv.second;
+    }
+    timestamp_ = other.timestamp_;
+    measurement_id_ = other.measurement_id_;
+    status_ = other.status_;
+    packet_timestamp_ = other.packet_timestamp_;
+    pose_ = other.pose_;
+    alert_flags_ = other.alert_flags_;
+    deferred_packets_ = other.deferred_packets_;
+    packet_count_ = other.packet_count_;
+    columns_per_packet_ = other.columns_per_packet_;
+    frame_status = other.frame_status;
+    shutdown_countdown = other.shutdown_countdown;
+    shot_limiting_countdown = other.shot_limiting_countdown;
+    frame_id = other.frame_id;
+    sensor_info = other.sensor_info;
+    return true;
+}
 LidarScan& LidarScan::operator=(LidarScan&&) = default;
 LidarScan::~LidarScan() = default;
 namespace impl {
@@ -215,6 +300,11 @@ LidarScan::LidarScan(std::shared_ptr<sensor::sensor_info> info)
 // specify sensor:: namespace for doxygen matching
 LidarScan::LidarScan(size_t w, size_t h, LidarScanFieldTypes field_types,
                      size_t columns_per_packet)
+    : LidarScan{w, h, field_types, columns_per_packet, FieldInit::ZEROED} {}
+
+LidarScan::LidarScan(size_t w, size_t h,
+                     const LidarScanFieldTypes& field_types,
+                     size_t columns_per_packet, FieldInit init)
     : packet_count_{(w + columns_per_packet - 1) /
                     columns_per_packet},  // equivalent to
                                           // int(ceil(w/columns_per_packet))
@@ -228,7 +318,7 @@ LidarScan::LidarScan(size_t w, size_t h, LidarScanFieldTypes field_types,
     }
 
     for (const auto& ft : field_types) {
-        add_field(ft);
+        add_field(ft, init);
     }
 
     timestamp_ = Field{fd_array<uint64_t>(w), FieldClass::COLUMN_FIELD};
@@ -249,6 +339,181 @@ LidarScan::LidarScan(size_t w, size_t h, LidarScanFieldTypes field_types,
     }
 }
 
+namespace {
+
+constexpr size_t arena_alignment = field_alignment;
+
+size_t align_arena(size_t bytes) {
+    return (bytes + arena_alignment - 1) / arena_alignment * arena_alignment;
+}
+
+std::shared_ptr<uint8_t> heap_arena(size_t bytes) {
+    std::shared_ptr<uint8_t> block(new uint8_t[bytes + arena_alignment],
+                                   std::default_delete<uint8_t[]>());
+    const auto addr = reinterpret_cast<uintptr_t>(block.get());
+    const size_t pad =
+        (arena_alignment - addr % arena_alignment) % arena_alignment;
+    // shares ownership of the whole block but points at the aligned start
+    return std::shared_ptr<uint8_t>(block, block.get() + pad);
+}
+
+}  // namespace
+
+LidarScan LidarScan::make_contiguous(size_t w, size_t h,
+                                     const LidarScanFieldTypes& field_types,
+                                     size_t columns_per_packet,
+                                     ArenaAllocator allocator,
+                                     FieldInit init) {
+    if (init == FieldInit::ZEROED) {
+        return layout_arena(w, h, field_types, columns_per_packet,
+                            std::move(allocator), true);
+    }
+    LidarScan ls = layout_arena(w, h, field_types, columns_per_packet,
+                                std::move(allocator), false);
+    ls.clear_headers();
+    for (size_t i = 0; i < w; ++i) {
+        Eigen::Ref<img_t<double>> pose = ls.pose_.subview(i);
+        pose = mat4d::Identity();
+    }
+    return ls;
+}
+
+LidarScan LidarScan::layout_arena(size_t w, size_t h,
+                                  const LidarScanFieldTypes& field_types,
+                                  size_t columns_per_packet,
+                                  ArenaAllocator allocator, bool initialize) {
+    if (w * h == 0) {
+        throw std::invalid_argument(
+            "Cannot construct non-empty LidarScan with "
+            "zero width or height");
+    }
+    if (columns_per_packet == 0) {
+        throw std::invalid_argument("unexpected columns_per_packet: 0");
+    }
+
+    LidarScan ls;
+    ls.w = w;
+    ls.h = h;
+    ls.columns_per_packet_ = columns_per_packet;
+    ls.packet_count_ = (w + columns_per_packet - 1) / columns_per_packet;
+
+    // pixel fields first, so that iterating over several of them stays in
+    // one region of memory
+    auto types = field_types;
+    std::stable_sort(types.begin(), types.end(),
+                     [](const FieldType& a, const FieldType& b) {
+                         return (a.field_class == FieldClass::PIXEL_FIELD) >
+                                (b.field_class == FieldClass::PIXEL_FIELD);
+                     });
+
+    struct slot {
+        Field* field;
+        FieldDescriptor desc;
+        FieldClass field_class;
+        size_t offset;
+    };
+    std::vector<slot> slots;
+    size_t bytes = 0;
+    auto reserve = [&](Field& field, FieldDescriptor desc,
+                       FieldClass field_class) {
+        const size_t offset = bytes;
+        bytes = align_arena(bytes + desc.bytes());
+        slots.push_back({&field, std::move(desc), field_class, offset});
+    };
+
+    for (const auto& ft : types) {
+        if (ls.fields_.count(ft.name)) {
+            throw std::invalid_argument("Duplicated field '" + ft.name + "'");
+        }
+        if (ft.field_class == FieldClass::PIXEL_FIELD) {
+            for (const auto& dim : ft.extra_dims) {
+                if (dim == 0) {
+                    throw std::invalid_argument(
+                        "Cannot add pixel field with 0 elements.");
+                }
+            }
+        }
+        // the map doesn't move its elements on insertion
+        reserve(ls.fields_[ft.name], get_field_type_descriptor(ls, ft),
+                ft.field_class);
+    }
+    reserve(ls.timestamp_, fd_array<uint64_t>(w), FieldClass::COLUMN_FIELD);
+    reserve(ls.measurement_id_, fd_array<uint16_t>(w),
+            FieldClass::COLUMN_FIELD);
+    reserve(ls.status_, fd_array<uint32_t>(w), FieldClass::COLUMN_FIELD);
+    reserve(ls.packet_timestamp_, fd_array<uint64_t>(ls.packet_count_),
+            FieldClass::PACKET_FIELD);
+    reserve(ls.alert_flags_, fd_array<uint8_t>(ls.packet_count_),
+            FieldClass::PACKET_FIELD);
+    reserve(ls.pose_, fd_array<double>(w, 4, 4), {});
+
+    ls.arena_ = allocator ? allocator(bytes) : heap_arena(bytes);
+    if (!ls.arena_ ||
+        reinterpret_cast<uintptr_t>(ls.arena_.get()) % alignof(uint64_t)) {
+        throw std::invalid_argument(
+            "LidarScan arena allocation failed or is misaligned");
+    }
+    ls.arena_bytes_ = bytes;
+    if (initialize) std::memset(ls.arena_.get(), 0, bytes);
+    for (auto& sl : slots) {
+        *sl.field = Field(sl.desc, sl.field_class, ls.arena_.get() + sl.offset,
+                          ls.arena_);
+    }
+
+    for (size_t i = 0; initialize && i < w; ++i) {
+        Eigen::Ref<img_t<double>> pose = ls.pose_.subview(i);
+        pose = mat4d::Identity();
+    }
+    ls.reindex();
+    return ls;
+}
+
+void LidarScan::copy_arena(const LidarScan& other) {
+    arena_ = heap_arena(other.arena_bytes_);
+    arena_bytes_ = other.arena_bytes_;
+    std::memcpy(arena_.get(), other.arena_.get(), arena_bytes_);
+
+    // same offsets into the copy
+    auto rebind = [&](const Field& f) {
+        const auto offset = static_cast<const uint8_t*>(f.get()) -
+                            other.arena_.get();
+        return Field(f.desc(), f.field_class(), arena_.get() + offset, arena_);
+    };
+    for (const auto& kv : other.fields_) {
+        fields_.emplace(kv.first, rebind(kv.second));
+    }
+    timestamp_ = rebind(other.timestamp_);
+    measurement_id_ = rebind(other.measurement_id_);
+    status_ = rebind(other.status_);
+    packet_timestamp_ = rebind(other.packet_timestamp_);
+    pose_ = rebind(other.pose_);
+    alert_flags_ = rebind(other.alert_flags_);
+    reindex();
+}
+
+bool LidarScan::is_contiguous() const {
+    if (!arena_) return false;
+    const auto begin = reinterpret_cast<uintptr_t>(arena_.get());
+    const auto end = begin + arena_bytes_;
+    auto inside = [&](const Field& f) {
+        const auto ptr = reinterpret_cast<uintptr_t>(f.get());
+        return ptr >= begin && ptr + f.bytes() <= end;
+    };
+    for (const auto& kv : fields_) {
+        if (!inside(kv.second)) return false;
+    }
+    return inside(timestamp_) && inside(measurement_id_) && inside(status_) &&
+           inside(packet_timestamp_) && inside(pose_) && inside(alert_flags_);
+}
+
+const uint8_t* LidarScan::arena_data() const {
+    return is_contiguous() ? arena_.get() : nullptr;
+}
+
+size_t LidarScan::arena_size() const {
+    return is_contiguous() ? arena_bytes_ : 0;
+}
+
 LidarScan::LidarScan(const LidarScan& ls_src,
                      const LidarScanFieldTypes& field_types)
     : packet_count_(ls_src.packet_count_),
@@ -258,6 +523,12 @@ LidarScan::LidarScan(const LidarScan& ls_src,
       frame_status(ls_src.frame_status),
       frame_id(ls_src.frame_id),
       sensor_info(ls_src.sensor_info) {
+    select_fields(ls_src, field_types, false);
+}
+
+void LidarScan::select_fields(const LidarScan& ls_src,
+                              const LidarScanFieldTypes& field_types,
+                              bool share) {
     for (const auto& ft : field_types) {
         const std::string& name = ft.name;
         FieldDescriptor dst_desc = get_field_type_descriptor(*this, ft);
@@ -266,7 +537,11 @@ LidarScan::LidarScan(const LidarScan& ls_src,
             const auto& src_field = ls_src.field(name);
             const auto& src_desc = src_field.desc();
             if (src_desc == dst_desc) {
-                fields()[name] = ls_src.field(name);
+                if (share) {
+                    fields_[name] = src_field.share();
+                } else {
+                    fields()[name] = src_field;
+                }
             } else {
                 // cast if the dimensions match
                 if (dst_desc.shape != src_desc.shape) {
@@ -284,11 +559,75 @@ LidarScan::LidarScan(const LidarScan& ls_src,
         }
     }
 
-    timestamp_ = ls_src.timestamp_;
-    measurement_id_ = ls_src.measurement_id_;
-    status_ = ls_src.status_;
-    packet_timestamp_ = ls_src.packet_timestamp_;
-    pose_ = ls_src.pose_;
+    if (share) {
+        timestamp_ = ls_src.timestamp_.share();
+        measurement_id_ = ls_src.measurement_id_.share();
+        status_ = ls_src.status_.share();
+        packet_timestamp_ = ls_src.packet_timestamp_.share();
+        pose_ = ls_src.pose_.share();
+        alert_flags_ = ls_src.alert_flags_.share();
+    } else {
+        timestamp_ = ls_src.timestamp_;
+        measurement_id_ = ls_src.measurement_id_;
+        status_ = ls_src.status_;
+        packet_timestamp_ = ls_src.packet_timestamp_;
+        pose_ = ls_src.pose_;
+        alert_flags_ = ls_src.alert_flags_;
+    }
+    reindex();
+}
+
+LidarScan LidarScan::shallow_copy() const {
+    // decoding writes to the fields, which must be done before sharing them
+    decode_deferred();
+    LidarScan ls;
+    ls.packet_count_ = packet_count_;
+    ls.w = w;
+    ls.h = h;
+    ls.columns_per_packet_ = columns_per_packet_;
+    ls.frame_status = frame_status;
+    ls.shutdown_countdown = shutdown_countdown;
+    ls.shot_limiting_countdown = shot_limiting_countdown;
+    ls.frame_id = frame_id;
+    ls.sensor_info = sensor_info;
+    ls.arena_ = arena_;
+    ls.arena_bytes_ = arena_bytes_;
+    for (const auto& kv : fields_) {
+        ls.fields_.emplace(kv.first, kv.second.share());
+    }
+    ls.timestamp_ = timestamp_.share();
+    ls.measurement_id_ = measurement_id_.share();
+    ls.status_ = status_.share();
+    ls.packet_timestamp_ = packet_timestamp_.share();
+    ls.pose_ = pose_.share();
+    ls.alert_flags_ = alert_flags_.share();
+    ls.reindex();
+    return ls;
+}
+
+LidarScan LidarScan::shallow_copy(
+    const LidarScanFieldTypes& field_types) const {
+    decode_deferred();
+    LidarScan ls;
+    ls.packet_count_ = packet_count_;
+    ls.w = w;
+    ls.h = h;
+    ls.columns_per_packet_ = columns_per_packet_;
+    ls.frame_status = frame_status;
+    ls.frame_id = frame_id;
+    ls.sensor_info = sensor_info;
+    ls.select_fields(*this, field_types, true);
+    return ls;
+}
+
+void LidarScan::unshare() {
+    for (auto& kv : fields_) kv.second.unshare();
+    timestamp_.unshare();
+    measurement_id_.unshare();
+    status_.unshare();
+    packet_timestamp_.unshare();
+    pose_.unshare();
+    alert_flags_.unshare();
 }
 
 LidarScan::LidarScan(size_t w, size_t h, sensor::UDPProfileLidar profile,
@@ -313,26 +652,103 @@ sensor::ThermalShutdownStatus LidarScan::thermal_shutdown() const {
 }
 
 Field& LidarScan::field(const std::string& name) {
+    if (!deferred_fields_.empty()) decode_deferred(name);
     try {
-        return fields().at(name);
+        Field& f = fields_.at(name);
+        f.unshare();
+        return f;
     } catch (std::out_of_range& e) {
         throw std::out_of_range("Field '" + name + "' not found in LidarScan.");
     }
 }
 
 const Field& LidarScan::field(const std::string& name) const {
+    if (!deferred_fields_.empty()) decode_deferred(name);
     try {
-        return fields().at(name);
+        return fields_.at(name);
     } catch (std::out_of_range& e) {
         throw std::out_of_range("Field '" + name + "' not found in LidarScan.");
     }
 }
 
 bool LidarScan::has_field(const std::string& name) const {
-    return fields().count(name) > 0;
+    return fields_.count(name) > 0;
+}
+
+namespace {
+
+// process wide table of interned field names
+struct interned_names {
+    std::mutex mutex;
+    std::unordered_map<std::string, uint32_t> ids;
+    std::deque<std::string> names;  // doesn't move names as it grows
+};
+
+interned_names& field_names() {
+    static interned_names names;
+    return names;
+}
+
+}  // namespace
+
+FieldHandle LidarScan::field_handle(const std::string& name) {
+    auto& table = field_names();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    auto it = table.ids.find(name);
+    if (it != table.ids.end()) return {it->second};
+    const auto id = static_cast<uint32_t>(table.names.size());
+    table.names.push_back(name);
+    table.ids.emplace(name, id);
+    return {id};
+}
+
+const std::string& LidarScan::field_name(FieldHandle handle) {
+    auto& table = field_names();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    if (handle.id >= table.names.size()) {
+        throw std::out_of_range("Unknown field handle " +
+                                std::to_string(handle.id));
+    }
+    return table.names[handle.id];
 }
 
-Field& LidarScan::add_field(const FieldType& type) {
+void LidarScan::reindex() const {
+    index_.clear();
+    for (const auto& kv : fields_) {
+        const auto id = field_handle(kv.first).id;
+        if (id >= index_.size()) index_.resize(id + 1, nullptr);
+        index_[id] = const_cast<Field*>(&kv.second);
+    }
+    index_dirty_ = false;
+}
+
+Field* LidarScan::find_field(FieldHandle handle) const {
+    if (index_dirty_) reindex();
+    return handle.id < index_.size() ? index_[handle.id] : nullptr;
+}
+
+Field& LidarScan::field(FieldHandle handle) {
+    auto& f = const_cast<Field&>(
+        static_cast<const LidarScan&>(*this).field(handle));
+    f.unshare();
+    return f;
+}
+
+const Field& LidarScan::field(FieldHandle handle) const {
+    if (!deferred_fields_.empty()) decode_deferred(field_name(handle));
+    const Field* f = find_field(handle);
+    if (!f) {
+        throw std::out_of_range("Field '" + field_name(handle) +
+                                "' not found in LidarScan.");
+    }
+    return *f;
+}
+
+bool LidarScan::has_field(FieldHandle handle) const {
+    return find_field(handle) != nullptr;
+}
+
+Field& LidarScan::add_field(const FieldType& type, FieldInit init) {
     if (has_field(type.name)) {
         throw std::invalid_argument("Duplicated field '" + type.name + "'");
     }
@@ -349,10 +765,15 @@ Field& LidarScan::add_field(const FieldType& type) {
     }
 
     // no other checking is necessary
-    fields()[type.name] =
-        Field(get_field_type_descriptor(*this, type), type.field_class);
-
-    return fields()[type.name];
+    // inserting doesn't move the other fields, so only the new one needs to
+    // be indexed
+    Field& f = fields_[type.name];
+    f = Field(get_field_type_descriptor(*this, type), type.field_class, init);
+    const auto id = field_handle(type.name).id;
+    if (id >= index_.size()) index_.resize(id + 1, nullptr);
+    index_[id] = &f;
+
+    return f;
 }
 
 Field& LidarScan::add_field(const std::string& name, FieldDescriptor desc,
@@ -398,9 +819,13 @@ Field& LidarScan::add_field(const std::string& name, FieldDescriptor desc,
                 std::to_string(packet_count_));
     }
 
-    fields()[name] = Field{desc, field_class};
+    Field& f = fields_[name];
+    f = Field{desc, field_class};
+    const auto id = field_handle(name).id;
+    if (id >= index_.size()) index_.resize(id + 1, nullptr);
+    index_[id] = &f;
 
-    return fields()[name];
+    return f;
 }
 
 // TODO: verify this is sane with python bindings, might be hard to keep alive
@@ -409,9 +834,12 @@ Field LidarScan::del_field(const std::string& name) {
         throw std::invalid_argument("Attempted deleting non existing field '" +
                                     name + "'");
 
+    // a field deleted before it was decoded is returned decoded
     Field ptr;
     field(name).swap(ptr);
-    fields().erase(name);
+    fields_.erase(name);
+    const auto id = field_handle(name).id;
+    if (id < index_.size()) index_[id] = nullptr;
     return ptr;
 }
 
@@ -425,6 +853,16 @@ Eigen::Ref<const img_t<T>> LidarScan::field(const std::string& name) const {
     return field(name);
 }
 
+template <typename T>
+Eigen::Ref<img_t<T>> LidarScan::field(FieldHandle handle) {
+    return field(handle);
+}
+
+template <typename T>
+Eigen::Ref<const img_t<T>> LidarScan::field(FieldHandle handle) const {
+    return field(handle);
+}
+
 // explicitly instantiate for each supported field type
 
 // clang-format off
@@ -448,6 +886,26 @@ template Eigen::Ref<const img_t<int32_t>> LidarScan::field(const std::string& f)
 template Eigen::Ref<const img_t<int64_t>> LidarScan::field(const std::string& f) const;
 template Eigen::Ref<const img_t<float>> LidarScan::field(const std::string& f) const;
 template Eigen::Ref<const img_t<double>> LidarScan::field(const std::string& f) const;
+template Eigen::Ref<img_t<uint8_t>> LidarScan::field(FieldHandle h);
+template Eigen::Ref<img_t<uint16_t>> LidarScan::field(FieldHandle h);
+template Eigen::Ref<img_t<uint32_t>> LidarScan::field(FieldHandle h);
+template Eigen::Ref<img_t<uint64_t>> LidarScan::field(FieldHandle h);
+template Eigen::Ref<img_t<int8_t>> LidarScan::field(FieldHandle h);
+template Eigen::Ref<img_t<int16_t>> LidarScan::field(FieldHandle h);
+template Eigen::Ref<img_t<int32_t>> LidarScan::field(FieldHandle h);
+template Eigen::Ref<img_t<int64_t>> LidarScan::field(FieldHandle h);
+template Eigen::Ref<img_t<float>> LidarScan::field(FieldHandle h);
+template Eigen::Ref<img_t<double>> LidarScan::field(FieldHandle h);
+template Eigen::Ref<const img_t<uint8_t>> LidarScan::field(FieldHandle h) const;
+template Eigen::Ref<const img_t<uint16_t>> LidarScan::field(FieldHandle h) const;
+template Eigen::Ref<const img_t<uint32_t>> LidarScan::field(FieldHandle h) const;
+template Eigen::Ref<const img_t<uint64_t>> LidarScan::field(FieldHandle h) const;
+template Eigen::Ref<const img_t<int8_t>> LidarScan::field(FieldHandle h) const;
+template Eigen::Ref<const img_t<int16_t>> LidarScan::field(FieldHandle h) const;
+template Eigen::Ref<const img_t<int32_t>> LidarScan::field(FieldHandle h) const;
+template Eigen::Ref<const img_t<int64_t>> LidarScan::field(FieldHandle h) const;
+template Eigen::Ref<const img_t<float>> LidarScan::field(FieldHandle h) const;
+template Eigen::Ref<const img_t<double>> LidarScan::field(FieldHandle h) const;
 // clang-format on
 
 static FieldType get_field_type(const std::string& name, const Field& field) {
@@ -464,17 +922,60 @@ static FieldType get_field_type(const std::string& name, const Field& field) {
     return FieldType(name, field.tag(), extra_dims, field.field_class());
 }
 
+bool LidarScan::has_field_types(const LidarScanFieldTypes& field_types) const {
+    if (field_types.size() != fields_.size()) return false;
+    for (const auto& ft : field_types) {
+        auto it = fields_.find(ft.name);
+        if (it == fields_.end()) return false;
+        const Field& field = it->second;
+        // same offset of the extra dimensions as get_field_type
+        size_t offset = 0;
+        if (field.field_class() == FieldClass::PIXEL_FIELD) {
+            offset = 2;
+        } else if ((field.field_class() == FieldClass::COLUMN_FIELD) ||
+                   (field.field_class() == FieldClass::PACKET_FIELD)) {
+            offset = 1;
+        }
+        const auto& shape = field.shape();
+        if (field.tag() != ft.element_type ||
+            field.field_class() != ft.field_class ||
+            shape.size() != offset + ft.extra_dims.size() ||
+            !std::equal(ft.extra_dims.begin(), ft.extra_dims.end(),
+                        shape.begin() + offset)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 FieldType LidarScan::field_type(const std::string& name) const {
-    return get_field_type(name, field(name));
+    try {
+        return get_field_type(name, fields_.at(name));
+    } catch (std::out_of_range& e) {
+        throw std::out_of_range("Field '" + name + "' not found in LidarScan.");
+    }
 }
 
-std::unordered_map<std::string, Field>& LidarScan::fields() { return fields_; }
+std::unordered_map<std::string, Field>& LidarScan::fields() {
+    decode_deferred();
+    for (auto& kv : fields_) kv.second.unshare();
+    // the caller may add or remove fields
+    index_dirty_ = true;
+    return fields_;
+}
 
 const std::unordered_map<std::string, Field>& LidarScan::fields() const {
+    decode_deferred();
     return fields_;
 }
 
+bool LidarScan::is_deferred(const std::string& name) const {
+    return std::find(deferred_fields_.begin(), deferred_fields_.end(), name) !=
+           deferred_fields_.end();
+}
+
 Eigen::Ref<LidarScan::Header<uint64_t>> LidarScan::timestamp() {
+    timestamp_.unshare();
     return timestamp_;
 }
 
@@ -483,6 +984,7 @@ Eigen::Ref<const LidarScan::Header<uint64_t>> LidarScan::timestamp() const {
 }
 
 Eigen::Ref<LidarScan::Header<uint64_t>> LidarScan::packet_timestamp() {
+    packet_timestamp_.unshare();
     return packet_timestamp_;
 }
 
@@ -492,6 +994,7 @@ Eigen::Ref<const LidarScan::Header<uint64_t>> LidarScan::packet_timestamp()
 }
 
 Eigen::Ref<LidarScan::Header<uint8_t>> LidarScan::alert_flags() {
+    alert_flags_.unshare();
     return alert_flags_;
 }
 
@@ -525,6 +1028,7 @@ uint64_t LidarScan::get_first_valid_column_timestamp() const {
 }
 
 Eigen::Ref<LidarScan::Header<uint16_t>> LidarScan::measurement_id() {
+    measurement_id_.unshare();
     return measurement_id_;
 }
 
@@ -533,16 +1037,34 @@ Eigen::Ref<const LidarScan::Header<uint16_t>> LidarScan::measurement_id()
     return measurement_id_;
 }
 
-Eigen::Ref<LidarScan::Header<uint32_t>> LidarScan::status() { return status_; }
+Eigen::Ref<LidarScan::Header<uint32_t>> LidarScan::status() {
+    status_.unshare();
+    return status_;
+}
 
 Eigen::Ref<const LidarScan::Header<uint32_t>> LidarScan::status() const {
     return status_;
 }
 
-Field& LidarScan::pose() { return pose_; }
+Field& LidarScan::pose() {
+    pose_.unshare();
+    return pose_;
+}
 
 const Field& LidarScan::pose() const { return pose_; }
 
+void LidarScan::clear_headers() {
+    timestamp().setZero();
+    measurement_id().setZero();
+    status().setZero();
+    packet_timestamp().setZero();
+    alert_flags().setZero();
+    frame_id = -1;
+    frame_status = 0;
+    shutdown_countdown = 0;
+    shot_limiting_countdown = 0;
+}
+
 bool LidarScan::complete(sensor::ColumnWindow window) const {
     const auto& status = this->status();
     auto start = window.first;
@@ -579,7 +1101,7 @@ bool operator!=(const LidarScan& a, const LidarScan& b) { return !(a == b); }
 
 LidarScanFieldTypes LidarScan::field_types() const {
     LidarScanFieldTypes ft;
-    for (const auto& kv : fields()) {
+    for (const auto& kv : fields_) {
         ft.push_back(get_field_type(kv.first, kv.second));
     }
 
@@ -780,14 +1302,685 @@ LidarScan::Points cartesian(const LidarScan& scan, const XYZLut& lut) {
 
 LidarScan::Points cartesian(const Eigen::Ref<const img_t<uint32_t>>& range,
                             const XYZLut& lut) {
+    LidarScan::Points points(range.size(), 3);
+    cartesian(points, range, lut);
+    return points;
+}
+
+void cartesian(Eigen::Ref<LidarScan::Points, 0,
+                          Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>>
+                   points,
+               const Eigen::Ref<const img_t<uint32_t>>& range,
+               const XYZLut& lut) {
     if (range.cols() * range.rows() != lut.direction.rows())
         throw std::invalid_argument("unexpected image dimensions");
+    if (points.rows() != lut.direction.rows())
+        throw std::invalid_argument("expected a row of points for every pixel");
     auto reshaped = Eigen::Map<const Eigen::Array<uint32_t, -1, 1>>(
         range.data(), range.cols() * range.rows());
     auto nooffset = lut.direction.colwise() * reshaped.cast<double>();
-    return (reshaped == 0)
-        .replicate<1, 3>()
-        .select(nooffset, nooffset + lut.offset);
+    points = (reshaped == 0)
+                 .replicate<1, 3>()
+                 .select(nooffset, nooffset + lut.offset);
+}
+
+void cartesian(Eigen::Ref<LidarScan::Points, 0,
+                          Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>>
+                   points,
+               const LidarScan& scan, const XYZLut& lut) {
+    cartesian(points, scan.field(sensor::ChanField::RANGE), lut);
+}
+
+XYZLutF make_xyz_lut_f(const XYZLut& lut) {
+    return {lut.direction.cast<float>(), lut.offset.cast<float>()};
+}
+
+XYZLutF make_xyz_lut_f(const sensor::sensor_info& sensor,
+                       bool use_extrinsics) {
+    return make_xyz_lut_f(make_xyz_lut(sensor, use_extrinsics));
+}
+
+namespace {
+
+// The inputs of make_xyz_lut(sensor_info, bool) as bytes, so that only
+// identical lookup tables are shared
+std::string xyz_lut_key(const sensor::sensor_info& sensor,
+                        bool use_extrinsics) {
+    std::string key;
+    auto put = [&key](const void* data, size_t size) {
+        key.append(static_cast<const char*>(data), size);
+    };
+    const uint32_t dims[] = {sensor.format.columns_per_frame,
+                             sensor.format.pixels_per_column,
+                             static_cast<uint32_t>(use_extrinsics),
+                             static_cast<uint32_t>(
+                                 sensor.beam_azimuth_angles.size())};
+    put(dims, sizeof(dims));
+    put(sensor.beam_to_lidar_transform.data(), sizeof(mat4d));
+    put(sensor.lidar_to_sensor_transform.data(), sizeof(mat4d));
+    if (use_extrinsics) put(sensor.extrinsic.data(), sizeof(mat4d));
+    put(sensor.beam_azimuth_angles.data(),
+        sensor.beam_azimuth_angles.size() * sizeof(double));
+    put(sensor.beam_altitude_angles.data(),
+        sensor.beam_altitude_angles.size() * sizeof(double));
+    return key;
+}
+
+// Lookup tables of one precision, held only by their users
+template <typename Lut>
+class xyz_lut_cache {
+   public:
+    template <typename Make>
+    std::shared_ptr<const Lut> get(const std::string& key, Make make) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = luts_.find(key);
+        if (it != luts_.end()) {
+            if (auto lut = it->second.lock()) return lut;
+        }
+        // drop the entries of released tables while at it
+        for (auto e = luts_.begin(); e != luts_.end();) {
+            e = e->second.expired() ? luts_.erase(e) : std::next(e);
+        }
+        std::shared_ptr<const Lut> lut = std::make_shared<Lut>(make());
+        luts_[key] = lut;
+        return lut;
+    }
+
+   private:
+    std::mutex mutex_;
+    std::map<std::string, std::weak_ptr<const Lut>> luts_;
+};
+
+}  // namespace
+
+std::shared_ptr<const XYZLut> shared_xyz_lut(const sensor::sensor_info& sensor,
+                                             bool use_extrinsics) {
+    static xyz_lut_cache<XYZLut> cache;
+    return cache.get(xyz_lut_key(sensor, use_extrinsics),
+                     [&] { return make_xyz_lut(sensor, use_extrinsics); });
+}
+
+std::shared_ptr<const XYZLutF> shared_xyz_lut_f(
+    const sensor::sensor_info& sensor, bool use_extrinsics) {
+    static xyz_lut_cache<XYZLutF> cache;
+    return cache.get(xyz_lut_key(sensor, use_extrinsics), [&] {
+        return make_xyz_lut_f(*shared_xyz_lut(sensor, use_extrinsics));
+    });
+}
+
+namespace {
+
+// points per kernel call, small enough to spread a scan over threads
+constexpr Eigen::Index cartesian_chunk = 4096;
+
+void project_f(const uint32_t* range, const float* direction,
+               const float* offset, Eigen::Index n, float* xyz,
+               impl::xyz_layout layout) {
+    const auto fn =
+        impl::get_cartesian_fn(impl::best_cartesian_kernel(), layout);
+    const Eigen::Index chunks = (n + cartesian_chunk - 1) / cartesian_chunk;
+#ifdef __OUSTER_UTILIZE_OPENMP__
+#pragma omp parallel for schedule(static)
+#endif
+    for (Eigen::Index c = 0; c < chunks; c++) {
+        const Eigen::Index start = c * cartesian_chunk;
+        const Eigen::Index count = std::min(cartesian_chunk, n - start);
+        float* out = layout == impl::xyz_layout::INTERLEAVED ? xyz + 3 * start
+                                                             : xyz + start;
+        fn(range + start, direction + start, offset + start, n, count, out);
+    }
+}
+
+}  // namespace
+
+void cartesianT(PointsF& points,
+                const Eigen::Ref<const img_t<uint32_t>>& range,
+                const PointsF& direction, const PointsF& offset) {
+    assert(points.rows() == direction.rows() &&
+           "points & direction row count mismatch");
+    assert(points.rows() == offset.rows() &&
+           "points & offset row count mismatch");
+    assert(points.rows() == range.size() &&
+           "points and range image size mismatch");
+    project_f(range.data(), direction.data(), offset.data(), range.size(),
+              points.data(), impl::xyz_layout::PLANAR);
+}
+
+PointsF cartesian(const LidarScan& scan, const XYZLutF& lut) {
+    return cartesian(scan.field(sensor::ChanField::RANGE), lut);
+}
+
+PointsF cartesian(const Eigen::Ref<const img_t<uint32_t>>& range,
+                  const XYZLutF& lut) {
+    if (range.size() != lut.direction.rows() ||
+        range.size() != lut.offset.rows())
+        throw std::invalid_argument("unexpected image dimensions");
+    PointsF points(range.size(), 3);
+    project_f(range.data(), lut.direction.data(), lut.offset.data(),
+              range.size(), points.data(), impl::xyz_layout::PLANAR);
+    return points;
+}
+
+void cartesian(Eigen::Ref<PointsF> points,
+               const Eigen::Ref<const img_t<uint32_t>>& range,
+               const XYZLutF& lut) {
+    if (range.size() != lut.direction.rows() ||
+        range.size() != lut.offset.rows())
+        throw std::invalid_argument("unexpected image dimensions");
+    if (points.rows() != range.size())
+        throw std::invalid_argument("expected a row of points for every pixel");
+    if (points.outerStride() != points.rows())
+        throw std::invalid_argument("expected contiguous columns of points");
+    project_f(range.data(), lut.direction.data(), lut.offset.data(),
+              range.size(), points.data(), impl::xyz_layout::PLANAR);
+}
+
+void cartesian(Eigen::Ref<PointsF> points, const LidarScan& scan,
+               const XYZLutF& lut) {
+    cartesian(points, scan.field(sensor::ChanField::RANGE), lut);
+}
+
+void cartesian_interleaved(const Eigen::Ref<const img_t<uint32_t>>& range,
+                           const XYZLutF& lut, float* xyz) {
+    if (range.size() != lut.direction.rows() ||
+        range.size() != lut.offset.rows())
+        throw std::invalid_argument("unexpected image dimensions");
+    project_f(range.data(), lut.direction.data(), lut.offset.data(),
+              range.size(), xyz, impl::xyz_layout::INTERLEAVED);
+}
+
+namespace {
+
+// check that the scans can be projected with a lut of n pixels, up front as
+// nothing may throw out of a parallel loop
+void check_range_fields(const std::vector<const LidarScan*>& scans,
+                        Eigen::Index n) {
+    for (const LidarScan* scan : scans) {
+        if (!scan) throw std::invalid_argument("null scan");
+        if (!scan->has_field(sensor::ChanField::RANGE) ||
+            scan->field(sensor::ChanField::RANGE).tag() !=
+                sensor::ChanFieldType::UINT32)
+            throw std::invalid_argument("expected a uint32 RANGE field");
+        if (static_cast<Eigen::Index>(scan->w * scan->h) != n)
+            throw std::invalid_argument("unexpected image dimensions");
+    }
+}
+
+}  // namespace
+
+void cartesian(Eigen::Ref<LidarScan::Points, 0,
+                          Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>>
+                   points,
+               const std::vector<const LidarScan*>& scans, const XYZLut& lut) {
+    const Eigen::Index n = lut.direction.rows();
+    check_range_fields(scans, n);
+    if (points.rows() != n * static_cast<Eigen::Index>(scans.size()))
+        throw std::invalid_argument("expected a row of points for every pixel");
+
+    const int count = static_cast<int>(scans.size());
+#ifdef __OUSTER_UTILIZE_OPENMP__
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int i = 0; i < count; i++) {
+        cartesian(points.middleRows(i * n, n), *scans[i], lut);
+    }
+}
+
+void cartesian_interleaved(const std::vector<const LidarScan*>& scans,
+                           const XYZLutF& lut, float* xyz) {
+    const Eigen::Index n = lut.direction.rows();
+    if (lut.offset.rows() != n)
+        throw std::invalid_argument("unexpected lut dimensions");
+    check_range_fields(scans, n);
+
+    const int count = static_cast<int>(scans.size());
+#ifdef __OUSTER_UTILIZE_OPENMP__
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int i = 0; i < count; i++) {
+        const uint32_t* range = static_cast<const uint32_t*>(
+            scans[i]->field(sensor::ChanField::RANGE).get());
+        project_f(range, lut.direction.data(), lut.offset.data(), n,
+                  xyz + 3 * n * i, impl::xyz_layout::INTERLEAVED);
+    }
+}
+
+namespace {
+
+template <typename T, typename R>
+size_t compact_points(
+    Eigen::Ref<PointsT<T>>& points,
+    Eigen::Ref<Eigen::Array<uint32_t, Eigen::Dynamic, 1>>& pixel_index,
+    const Eigen::Ref<const img_t<uint32_t>>& range, const PointsT<T>& direction,
+    const PointsT<T>& offset, const CompactFilter& filter,
+    const R* reflectivity) {
+    const Eigen::Index N = range.size();
+    if (direction.rows() != N || offset.rows() != N)
+        throw std::invalid_argument("unexpected image dimensions");
+    if (points.rows() < N || pixel_index.rows() < N)
+        throw std::invalid_argument("expected a row of output for every pixel");
+
+    const uint32_t* rng = range.data();
+    const T* dir = direction.data();
+    const T* ofs = offset.data();
+    Eigen::Index n = 0;
+    for (Eigen::Index ix = 0; ix < N; ++ix) {
+        const uint32_t r = rng[ix];
+        if (r == 0 || r < filter.min_range || r > filter.max_range) continue;
+        if (reflectivity && reflectivity[ix] < filter.min_reflectivity)
+            continue;
+        for (int c = 0; c < 3; ++c) {
+            points(n, c) = r * dir[c * N + ix] + ofs[c * N + ix];
+        }
+        pixel_index(n++) = static_cast<uint32_t>(ix);
+    }
+    return n;
+}
+
+// the reflectivity threshold of a filter, dispatched on the field type
+template <typename T>
+size_t compact_scan(
+    Eigen::Ref<PointsT<T>>& points,
+    Eigen::Ref<Eigen::Array<uint32_t, Eigen::Dynamic, 1>>& pixel_index,
+    const LidarScan& scan, const PointsT<T>& direction,
+    const PointsT<T>& offset, const CompactFilter& filter) {
+    const auto range = scan.field<uint32_t>(sensor::ChanField::RANGE);
+    if (filter.min_reflectivity == 0) {
+        return compact_points<T, uint8_t>(points, pixel_index, range,
+                                          direction, offset, filter, nullptr);
+    }
+    if (!scan.has_field(sensor::ChanField::REFLECTIVITY)) {
+        throw std::invalid_argument(
+            "reflectivity threshold needs a REFLECTIVITY field");
+    }
+    const Field& refl = scan.field(sensor::ChanField::REFLECTIVITY);
+    switch (refl.tag()) {
+        case sensor::ChanFieldType::UINT8:
+            return compact_points(points, pixel_index, range, direction,
+                                  offset, filter, refl.get<uint8_t>());
+        case sensor::ChanFieldType::UINT16:
+            return compact_points(points, pixel_index, range, direction,
+                                  offset, filter, refl.get<uint16_t>());
+        default:
+            throw std::invalid_argument(
+                "REFLECTIVITY must be an 8 or 16 bit field");
+    }
+}
+
+void check_range_filter(const CompactFilter& filter) {
+    if (filter.min_reflectivity != 0) {
+        throw std::invalid_argument(
+            "reflectivity threshold needs the LidarScan overload");
+    }
+}
+
+}  // namespace
+
+size_t cartesian_compact(
+    Eigen::Ref<LidarScan::Points> points,
+    Eigen::Ref<Eigen::Array<uint32_t, Eigen::Dynamic, 1>> pixel_index,
+    const Eigen::Ref<const img_t<uint32_t>>& range, const XYZLut& lut,
+    const CompactFilter& filter) {
+    check_range_filter(filter);
+    return compact_points<double, uint8_t>(points, pixel_index, range,
+                                           lut.direction, lut.offset, filter,
+                                           nullptr);
+}
+
+size_t cartesian_compact(
+    Eigen::Ref<LidarScan::Points> points,
+    Eigen::Ref<Eigen::Array<uint32_t, Eigen::Dynamic, 1>> pixel_index,
+    const LidarScan& scan, const XYZLut& lut, const CompactFilter& filter) {
+    return compact_scan<double>(points, pixel_index, scan, lut.direction,
+                                lut.offset, filter);
+}
+
+size_t cartesian_compact(
+    Eigen::Ref<PointsF> points,
+    Eigen::Ref<Eigen::Array<uint32_t, Eigen::Dynamic, 1>> pixel_index,
+    const Eigen::Ref<const img_t<uint32_t>>& range, const XYZLutF& lut,
+    const CompactFilter& filter) {
+    check_range_filter(filter);
+    return compact_points<float, uint8_t>(points, pixel_index, range,
+                                          lut.direction, lut.offset, filter,
+                                          nullptr);
+}
+
+size_t cartesian_compact(
+    Eigen::Ref<PointsF> points,
+    Eigen::Ref<Eigen::Array<uint32_t, Eigen::Dynamic, 1>> pixel_index,
+    const LidarScan& scan, const XYZLutF& lut, const CompactFilter& filter) {
+    return compact_scan<float>(points, pixel_index, scan, lut.direction,
+                               lut.offset, filter);
+}
+
+void destagger_in_place(LidarScan& scan,
+                        const std::vector<int>& pixel_shift_by_row,
+                        bool inverse) {
+    const size_t w = scan.w;
+    const size_t h = scan.h;
+    if (pixel_shift_by_row.size() != h)
+        throw std::invalid_argument{"image height does not match shifts size"};
+    if (w == 0 || h == 0) return;
+
+    struct pixel_field {
+        uint8_t* data;
+        size_t pixel_bytes;
+    };
+    std::vector<pixel_field> fields;
+    size_t row_bytes = 0;
+    for (const auto& ft : scan.field_types()) {
+        if (ft.field_class != FieldClass::PIXEL_FIELD) continue;
+        Field& f = scan.field(ft.name);
+        const size_t pixel_bytes = f.bytes() / (w * h);
+        fields.push_back({static_cast<uint8_t*>(f.get()), pixel_bytes});
+        row_bytes = std::max(row_bytes, w * pixel_bytes);
+    }
+
+    // rotate the same row of every field before moving on, with the shift
+    // of the row computed once
+    std::vector<uint8_t> tail(row_bytes);
+    for (size_t u = 0; u < h; u++) {
+        const size_t offset =
+            impl::destagger_offset(pixel_shift_by_row, u, w, inverse);
+        if (offset == 0) continue;
+        for (const auto& f : fields) {
+            uint8_t* row = f.data + u * w * f.pixel_bytes;
+            const size_t tail_bytes = offset * f.pixel_bytes;
+            const size_t head_bytes = (w - offset) * f.pixel_bytes;
+            std::memcpy(tail.data(), row + head_bytes, tail_bytes);
+            std::memmove(row + tail_bytes, row, head_bytes);
+            std::memcpy(row, tail.data(), tail_bytes);
+        }
+    }
+}
+
+void stack_field(void* out, const std::vector<const LidarScan*>& scans,
+                 const std::string& name,
+                 const std::vector<int>& pixel_shift_by_row) {
+    if (scans.empty()) throw std::invalid_argument("no scans to stack");
+    for (const LidarScan* scan : scans) {
+        if (!scan) throw std::invalid_argument("null scan");
+        if (!scan->has_field(name))
+            throw std::invalid_argument("a scan has no field " + name);
+    }
+    const LidarScan& first = *scans.front();
+    const Field& field = first.field(name);
+    for (const LidarScan* scan : scans) {
+        if (scan->w != first.w || scan->h != first.h ||
+            !(scan->field(name).desc() == field.desc()))
+            throw std::invalid_argument("field " + name +
+                                        " differs between the scans");
+    }
+
+    const size_t w = first.w;
+    const size_t h = first.h;
+    const size_t bytes = field.bytes();
+    const bool destagger = !pixel_shift_by_row.empty() &&
+                           field.field_class() == FieldClass::PIXEL_FIELD &&
+                           w * h > 0;
+    if (destagger && pixel_shift_by_row.size() != h)
+        throw std::invalid_argument{"image height does not match shifts size"};
+    const size_t pixel_bytes = destagger ? bytes / (w * h) : 0;
+
+    const int count = static_cast<int>(scans.size());
+#ifdef __OUSTER_UTILIZE_OPENMP__
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int i = 0; i < count; i++) {
+        const uint8_t* src =
+            static_cast<const uint8_t*>(scans[i]->field(name).get());
+        uint8_t* dst = static_cast<uint8_t*>(out) + i * bytes;
+        if (!destagger) {
+            std::memcpy(dst, src, bytes);
+            continue;
+        }
+        for (size_t u = 0; u < h; u++) {
+            const size_t offset =
+                impl::destagger_offset(pixel_shift_by_row, u, w, false);
+            const uint8_t* row = src + u * w * pixel_bytes;
+            uint8_t* out_row = dst + u * w * pixel_bytes;
+            std::memcpy(out_row + offset * pixel_bytes, row,
+                        (w - offset) * pixel_bytes);
+            std::memcpy(out_row, row + (w - offset) * pixel_bytes,
+                        offset * pixel_bytes);
+        }
+    }
+}
+
+namespace {
+
+// names of the fields a scan operation applies to: the given ones the scan
+// has, or all the fields passing the filter when none are given
+template <typename F>
+std::vector<std::string> op_fields(const LidarScan& scan,
+                                   const std::vector<std::string>& fields,
+                                   F&& filter) {
+    std::vector<std::string> names;
+    if (fields.empty()) {
+        for (const auto& ft : scan.field_types())
+            if (filter(ft.field_class)) names.push_back(ft.name);
+        return names;
+    }
+    for (const auto& name : fields)
+        if (scan.has_field(name)) names.push_back(name);
+    return names;
+}
+
+struct mask_values {
+    template <typename T>
+    void operator()(T* data, size_t n,
+                    const Eigen::Ref<const img_t<double>>& mask) const {
+        const img_t<T> m = mask.cast<T>();
+        const size_t pixels = static_cast<size_t>(m.size());
+        const size_t per_pixel = n / pixels;
+        for (size_t i = 0; i < pixels; i++) {
+            const T factor = m.data()[i];
+            T* values = data + i * per_pixel;
+            for (size_t j = 0; j < per_pixel; j++)
+                values[j] = static_cast<T>(values[j] * factor);
+        }
+    }
+};
+
+// call op<T>(data, size, args...) with the element type of the field
+template <typename OP, typename... Args>
+void visit_values(Field& field, OP&& op, Args&&... args) {
+    const size_t n = field.size();
+    switch (field.tag()) {
+        case ChanFieldType::UINT8:
+            return op(field.get<uint8_t>(), n, std::forward<Args>(args)...);
+        case ChanFieldType::UINT16:
+            return op(field.get<uint16_t>(), n, std::forward<Args>(args)...);
+        case ChanFieldType::UINT32:
+            return op(field.get<uint32_t>(), n, std::forward<Args>(args)...);
+        case ChanFieldType::UINT64:
+            return op(field.get<uint64_t>(), n, std::forward<Args>(args)...);
+        case ChanFieldType::INT8:
+            return op(field.get<int8_t>(), n, std::forward<Args>(args)...);
+        case ChanFieldType::INT16:
+            return op(field.get<int16_t>(), n, std::forward<Args>(args)...);
+        case ChanFieldType::INT32:
+            return op(field.get<int32_t>(), n, std::forward<Args>(args)...);
+        case ChanFieldType::INT64:
+            return op(field.get<int64_t>(), n, std::forward<Args>(args)...);
+        case ChanFieldType::FLOAT32:
+            return op(field.get<float>(), n, std::forward<Args>(args)...);
+        case ChanFieldType::FLOAT64:
+            return op(field.get<double>(), n, std::forward<Args>(args)...);
+        default:
+            throw std::invalid_argument("unsupported field type");
+    }
+}
+
+}  // namespace
+
+void clip_fields(LidarScan& scan, const std::vector<std::string>& fields,
+                 double lower, double upper, double invalid) {
+    const auto names = op_fields(scan, fields, [](FieldClass) { return true; });
+    // look the fields up first: the first access may decode deferred ones
+    std::vector<Field*> targets;
+    for (const auto& name : names) targets.push_back(&scan.field(name));
+
+    const int count = static_cast<int>(targets.size());
+#ifdef __OUSTER_UTILIZE_OPENMP__
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int i = 0; i < count; i++) {
+        field_ops::threshold(*targets[i], lower, upper, invalid);
+    }
+}
+
+void mask_fields(LidarScan& scan, const std::vector<std::string>& fields,
+                 const Eigen::Ref<const img_t<double>>& mask) {
+    if (static_cast<size_t>(mask.rows()) != scan.h ||
+        static_cast<size_t>(mask.cols()) != scan.w)
+        throw std::invalid_argument("mask size doesn't match scan size");
+    const auto names = op_fields(scan, fields, [](FieldClass c) {
+        return c == FieldClass::PIXEL_FIELD;
+    });
+    std::vector<Field*> targets;
+    for (const auto& name : names) {
+        Field& f = scan.field(name);
+        if (f.field_class() != FieldClass::PIXEL_FIELD)
+            throw std::invalid_argument("can't mask non-pixel field " + name);
+        targets.push_back(&f);
+    }
+
+    const int count = static_cast<int>(targets.size());
+#ifdef __OUSTER_UTILIZE_OPENMP__
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int i = 0; i < count; i++) {
+        visit_values(*targets[i], mask_values{}, mask);
+    }
+}
+
+sensor::sensor_info reduce_by_factor(const sensor::sensor_info& info,
+                                     int factor) {
+    const size_t h = info.format.pixels_per_column;
+    if (factor <= 0 || h % factor != 0)
+        throw std::invalid_argument(
+            "factor must be a positive divisor of the number of beams");
+    const size_t step = static_cast<size_t>(factor);
+
+    sensor::sensor_info result = info;
+    // e.g. an OS-1-128, of form factor OS1, reduced by 4 becomes an OS-1-32
+    std::string form_factor = info.get_product_info().form_factor;
+    if (!form_factor.empty() &&
+        std::isdigit(static_cast<unsigned char>(form_factor.back()))) {
+        form_factor.insert(form_factor.size() - 1, "-");
+    }
+    result.prod_line = form_factor + "-" + std::to_string(h / step);
+    result.format.pixels_per_column = static_cast<uint32_t>(h / step);
+
+    auto every_step = [step](auto& values) {
+        size_t kept = 0;
+        for (size_t i = 0; i < values.size(); i += step)
+            values[kept++] = values[i];
+        values.resize(kept);
+    };
+    every_step(result.format.pixel_shift_by_row);
+    every_step(result.beam_azimuth_angles);
+    every_step(result.beam_altitude_angles);
+    return result;
+}
+
+LidarScan reduce_by_factor(const LidarScan& scan, int factor) {
+    if (factor <= 0 || scan.h % factor != 0)
+        throw std::invalid_argument(
+            "factor must be a positive divisor of the scan height");
+    const size_t step = static_cast<size_t>(factor);
+
+    LidarScanFieldTypes pixel_types;
+    LidarScanFieldTypes other_types;
+    for (const auto& ft : scan.field_types()) {
+        (ft.field_class == FieldClass::PIXEL_FIELD ? pixel_types
+                                                   : other_types)
+            .push_back(ft);
+    }
+    LidarScan result(scan.w, scan.h / step, pixel_types,
+                     scan.columns_per_packet_);
+    result.frame_status = scan.frame_status;
+    result.shutdown_countdown = scan.shutdown_countdown;
+    result.shot_limiting_countdown = scan.shot_limiting_countdown;
+    result.frame_id = scan.frame_id;
+    result.timestamp() = scan.timestamp();
+    result.packet_timestamp() = scan.packet_timestamp();
+    result.measurement_id() = scan.measurement_id();
+    result.status() = scan.status();
+    result.alert_flags() = scan.alert_flags();
+    std::memcpy(result.pose().get(), scan.pose().get(), scan.pose().bytes());
+
+    for (const auto& ft : other_types) {
+        const Field& src = scan.field(ft.name);
+        Field& dst = result.add_field(ft.name, src.desc(), ft.field_class);
+        std::memcpy(dst.get(), src.get(), src.bytes());
+    }
+
+    // rows of the result are every step-th row of the source
+    std::vector<std::pair<const Field*, Field*>> pairs;
+    for (const auto& ft : pixel_types)
+        pairs.emplace_back(&scan.field(ft.name), &result.field(ft.name));
+
+    const size_t h = result.h;
+    const int count = static_cast<int>(pairs.size());
+#ifdef __OUSTER_UTILIZE_OPENMP__
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int i = 0; i < count; i++) {
+        const Field& src = *pairs[i].first;
+        Field& dst = *pairs[i].second;
+        const size_t row_bytes = dst.bytes() / h;
+        const uint8_t* from = static_cast<const uint8_t*>(src.get());
+        uint8_t* to = static_cast<uint8_t*>(dst.get());
+        for (size_t u = 0; u < h; u++) {
+            std::memcpy(to + u * row_bytes, from + u * step * row_bytes,
+                        row_bytes);
+        }
+    }
+    return result;
+}
+
+XYZLut ScanSector::lut(const XYZLut& lut) const {
+    const Eigen::Index w = scan->w;
+    const Eigen::Index h = scan->h;
+    const Eigen::Index n = width();
+    if (lut.direction.rows() != w * h || lut.offset.rows() != w * h)
+        throw std::invalid_argument("unexpected lut dimensions");
+    XYZLut slice;
+    slice.direction.resize(h * n, 3);
+    slice.offset.resize(h * n, 3);
+    for (Eigen::Index row = 0; row < h; row++) {
+        slice.direction.middleRows(row * n, n) =
+            lut.direction.middleRows(row * w + start_col, n);
+        slice.offset.middleRows(row * n, n) =
+            lut.offset.middleRows(row * w + start_col, n);
+    }
+    return slice;
+}
+
+LidarScan::Points cartesian(const ScanSector& sector, const XYZLut& lut) {
+    const Eigen::Index w = sector.scan->w;
+    const Eigen::Index h = sector.scan->h;
+    const Eigen::Index n = sector.width();
+    if (lut.direction.rows() != w * h || lut.offset.rows() != w * h)
+        throw std::invalid_argument("unexpected lut dimensions");
+    const auto range = sector.field<uint32_t>(sensor::ChanField::RANGE);
+    LidarScan::Points points(h * n, 3);
+    for (Eigen::Index row = 0; row < h; row++) {
+        for (Eigen::Index col = 0; col < n; col++) {
+            const Eigen::Index src = row * w + sector.start_col + col;
+            const uint32_t r = range(row, col);
+            if (r == 0) {
+                points.row(row * n + col).setZero();
+            } else {
+                points.row(row * n + col) =
+                    lut.direction.row(src) * r + lut.offset.row(src);
+            }
+        }
+    }
+    return points;
 }
 
 ScanBatcher::ScanBatcher(size_t w, const sensor::packet_format& pf)
@@ -796,6 +1989,8 @@ ScanBatcher::ScanBatcher(size_t w, const sensor::packet_format& pf)
       next_valid_m_id(0),
       next_headers_m_id(0),
       cache(0),
+      parser(sensor::impl::make_profile_parser(pf)),
+      region_end(w),
       pf(pf) {
     if (pf.columns_per_packet == 0)
         throw std::invalid_argument("unexpected columns_per_packet: 0");
@@ -803,6 +1998,8 @@ ScanBatcher::ScanBatcher(size_t w, const sensor::packet_format& pf)
     const size_t desired_w =
         w / pf.columns_per_packet + (w % pf.columns_per_packet ? 1 : 0);
     expected_packets = desired_w;
+    for (const auto& ft : this->pf)
+        pf_fields.emplace_back(ft.first, LidarScan::field_handle(ft.first));
 }
 
 ScanBatcher::ScanBatcher(const sensor::sensor_info& info)
@@ -933,6 +2130,37 @@ struct pack_raw_headers_col {
     }
 };
 
+/*
+ * Like foreach_channel_field, but skips the fields left for deferred decoding
+ */
+template <typename OP, typename... Args>
+void foreach_batched_field(
+    LidarScan& ls,
+    const std::vector<std::pair<std::string, FieldHandle>>& fields, OP&& op,
+    Args&&... args) {
+    for (const auto& f : fields) {
+        if (!ls.has_field(f.second) || ls.is_deferred(f.first)) continue;
+        ouster::impl::visit_field_2d(ls.field(f.second), std::forward<OP>(op),
+                                     f.first, std::forward<Args>(args)...);
+    }
+}
+
+/*
+ * Check whether every column of a packet is valid and within the scan
+ */
+bool all_cols_valid(const sensor::packet_format& pf, const uint8_t* packet_buf,
+                    size_t w) {
+    for (int icol = 0; icol < pf.columns_per_packet; icol++) {
+        const uint8_t* col_buf = pf.nth_col(icol, packet_buf);
+        const uint16_t m_id = pf.col_measurement_id(col_buf);
+        const uint32_t status = pf.col_status(col_buf);
+        const bool valid = (status & 0x01);
+
+        if (!valid || m_id >= w) return false;
+    }
+    return true;
+}
+
 }  // namespace
 
 void ScanBatcher::parse_by_col(const uint8_t* packet_buf, LidarScan& ls) {
@@ -966,8 +2194,8 @@ void ScanBatcher::parse_by_col(const uint8_t* packet_buf, LidarScan& ls) {
 
         // zero out missing columns if we jumped forward
         if (m_id >= next_valid_m_id) {
-            impl::foreach_channel_field(ls, pf, zero_field_cols{},
-                                        next_valid_m_id, m_id);
+            foreach_batched_field(ls, pf_fields, zero_field_cols{},
+                                  next_valid_m_id, m_id);
             zero_header_cols(ls, next_valid_m_id, m_id);
             next_valid_m_id = m_id + 1;
         }
@@ -977,8 +2205,8 @@ void ScanBatcher::parse_by_col(const uint8_t* packet_buf, LidarScan& ls) {
         ls.measurement_id()[m_id] = m_id;
         ls.status()[m_id] = status;
 
-        impl::foreach_channel_field(ls, pf, parse_field_col{}, m_id, pf,
-                                    col_buf);
+        foreach_batched_field(ls, pf_fields, parse_field_col{}, m_id, pf,
+                              col_buf);
     }
 }
 
@@ -1001,12 +2229,18 @@ void ScanBatcher::parse_by_block(const uint8_t* packet_buf, LidarScan& ls) {
     const uint16_t first_m_id =
         pf.col_measurement_id(pf.nth_col(0, packet_buf));
     if (first_m_id >= next_valid_m_id) {
-        impl::foreach_channel_field(ls, pf, zero_field_cols{}, next_valid_m_id,
-                                    first_m_id);
+        foreach_batched_field(ls, pf_fields, zero_field_cols{},
+                              next_valid_m_id, first_m_id);
         zero_header_cols(ls, next_valid_m_id, first_m_id);
         next_valid_m_id = first_m_id + pf.columns_per_packet;
     }
 
+    // decode headers and fields in a single pass over the packet
+    if (parser && ls.deferred_fields_.empty()) {
+        parser->parse_block(packet_buf, ls);
+        return;
+    }
+
     // write new header values
     for (int icol = 0; icol < pf.columns_per_packet; icol++) {
         const uint8_t* col_buf = pf.nth_col(icol, packet_buf);
@@ -1021,28 +2255,216 @@ void ScanBatcher::parse_by_block(const uint8_t* packet_buf, LidarScan& ls) {
 
     switch (pf.block_parsable()) {
         case 16:
-            impl::foreach_channel_field(ls, pf, parse_field_block<16>{}, pf,
-                                        packet_buf);
+            foreach_batched_field(ls, pf_fields, parse_field_block<16>{}, pf,
+                                  packet_buf);
             break;
         case 8:
-            impl::foreach_channel_field(ls, pf, parse_field_block<8>{}, pf,
-                                        packet_buf);
+            foreach_batched_field(ls, pf_fields, parse_field_block<8>{}, pf,
+                                  packet_buf);
             break;
         case 4:
-            impl::foreach_channel_field(ls, pf, parse_field_block<4>{}, pf,
-                                        packet_buf);
+            foreach_batched_field(ls, pf_fields, parse_field_block<4>{}, pf,
+                                  packet_buf);
             break;
         default:
             throw std::invalid_argument("Invalid block dim for packet format");
     }
 }
 
+/*
+ * Like parse_field_col, but reads only the beams of a region, or every beam if
+ * there are none
+ */
+struct parse_field_region {
+    template <typename T>
+    void operator()(Eigen::Ref<img_t<T>> field, const std::string& f,
+                    size_t col, const sensor::packet_format& pf,
+                    const uint8_t* col_buf,
+                    const std::vector<size_t>& beams) const {
+        if (f == sensor::ChanField::RAW_HEADERS) return;
+
+        if (beams.empty()) {
+            pf.col_field(col_buf, f, field.col(col).data(), field.cols());
+        } else {
+            pf.col_field(col_buf, f, field.col(col).data(), field.cols(),
+                         beams);
+        }
+    }
+};
+
+void ScanBatcher::parse_region(const uint8_t* packet_buf, LidarScan& ls) {
+    // next_valid_m_id counts columns of the region rather than the frame
+    for (int icol = 0; icol < pf.columns_per_packet; icol++) {
+        const uint8_t* col_buf = pf.nth_col(icol, packet_buf);
+        const uint16_t m_id = pf.col_measurement_id(col_buf);
+        const uint32_t status = pf.col_status(col_buf);
+        const bool valid = (status & 0x01);
+
+        // drop invalid and columns outside of the region
+        if (!valid || m_id < region_start || m_id >= region_end) continue;
+        const uint16_t col = m_id - region_start;
+
+        // zero out missing columns if we jumped forward
+        if (col >= next_valid_m_id) {
+            foreach_batched_field(ls, pf_fields, zero_field_cols{},
+                                  next_valid_m_id, col);
+            zero_header_cols(ls, next_valid_m_id, col);
+            next_valid_m_id = col + 1;
+        }
+
+        ls.timestamp()[col] = pf.col_timestamp(col_buf);
+        ls.measurement_id()[col] = m_id;
+        ls.status()[col] = status;
+
+        foreach_batched_field(ls, pf_fields, parse_field_region{}, col, pf,
+                              col_buf, region_beams);
+    }
+}
+
+bool ScanBatcher::cropped() const {
+    return region_start != 0 || region_end != w || !region_beams.empty();
+}
+
+namespace impl {
+
+/*
+ * The packets a scan was batched from with deferred decoding. Shared between
+ * copies of the scan and copied before the batcher adds to a shared one.
+ */
+struct deferred_packets {
+    std::shared_ptr<const sensor::packet_format> pf;
+    std::vector<std::vector<uint8_t>> bufs;  // buffers are reused across scans
+    size_t count{0};
+};
+
+}  // namespace impl
+
+namespace {
+
+/*
+ * Decode a channel field from the packets of a scan, with the same result as
+ * batching them with the field present
+ */
+struct decode_deferred_field {
+    template <typename T>
+    void operator()(Eigen::Ref<img_t<T>> field, const std::string& f,
+                    const impl::deferred_packets& packets) const {
+        const sensor::packet_format& pf = *packets.pf;
+        const size_t w = field.cols();
+        // columns no packet wrote to are zero, as the batcher leaves them
+        field.setZero();
+        for (size_t i = 0; i < packets.count; i++) {
+            const uint8_t* packet_buf = packets.bufs[i].data();
+            if (pf.block_parsable() && all_cols_valid(pf, packet_buf, w)) {
+                switch (pf.block_parsable()) {
+                    case 16:
+                        parse_field_block<16>{}(field, f, pf, packet_buf);
+                        break;
+                    case 8:
+                        parse_field_block<8>{}(field, f, pf, packet_buf);
+                        break;
+                    case 4:
+                        parse_field_block<4>{}(field, f, pf, packet_buf);
+                        break;
+                    default:
+                        throw std::invalid_argument(
+                            "Invalid block dim for packet format");
+                }
+                continue;
+            }
+            for (int icol = 0; icol < pf.columns_per_packet; icol++) {
+                const uint8_t* col_buf = pf.nth_col(icol, packet_buf);
+                const uint16_t m_id = pf.col_measurement_id(col_buf);
+                const bool valid = pf.col_status(col_buf) & 0x01;
+                if (!valid || m_id >= w) continue;
+                parse_field_col{}(field, f, m_id, pf, col_buf);
+            }
+        }
+    }
+};
+
+}  // namespace
+
+void LidarScan::decode_deferred(const std::string& name) const {
+    auto it = std::find(deferred_fields_.begin(), deferred_fields_.end(), name);
+    if (it == deferred_fields_.end()) return;
+    deferred_fields_.erase(it);
+    // the field already exists and only gets its contents, so decoding it is
+    // logically const
+    auto& self = const_cast<LidarScan&>(*this);
+    ouster::impl::visit_field(self, name, decode_deferred_field{}, name,
+                              *deferred_packets_);
+}
+
+void LidarScan::decode_deferred() const {
+    while (!deferred_fields_.empty()) {
+        const std::string name = deferred_fields_.back();
+        decode_deferred(name);
+    }
+}
+
+void ScanBatcher::start_deferred(LidarScan& ls) {
+    ls.deferred_fields_.clear();
+    if (!deferred_pf || cropped()) {
+        ls.deferred_packets_.reset();
+        return;
+    }
+    for (const auto& ft : pf) {
+        if (ls.has_field(ft.first)) ls.deferred_fields_.push_back(ft.first);
+    }
+    auto& packets = ls.deferred_packets_;
+    if (!packets || packets.use_count() > 1) {
+        packets = std::make_shared<impl::deferred_packets>();
+    }
+    packets->pf = deferred_pf;
+    packets->count = 0;
+}
+
+void ScanBatcher::keep_packet(const sensor::LidarPacket& packet,
+                              LidarScan& ls) {
+    auto& packets = ls.deferred_packets_;
+    // copy on write, so that copies of the scan keep the packets they had
+    if (packets.use_count() > 1) {
+        auto copy = std::make_shared<impl::deferred_packets>();
+        copy->pf = packets->pf;
+        copy->bufs.assign(packets->bufs.begin(),
+                          packets->bufs.begin() + packets->count);
+        copy->count = packets->count;
+        packets = std::move(copy);
+    }
+    if (packets->count == packets->bufs.size()) packets->bufs.emplace_back();
+    packets->bufs[packets->count++] = packet.buf;
+}
+
+void ScanBatcher::set_deferred_decode(bool enable) {
+    deferred_pf =
+        enable ? std::make_shared<sensor::packet_format>(pf) : nullptr;
+}
+
 bool ScanBatcher::operator()(const ouster::sensor::LidarPacket& packet,
                              LidarScan& ls) {
-    if (ls.w != w || ls.h != h)
+    OUSTER_TRACE_SCOPE("client", "ScanBatcher::batch");
+    if (validate_packets) {
+        // without metadata there are no ids to check against
+        static const sensor::sensor_info no_ids{};
+        if (!sensor::validate_lidar_packets(sensor_info ? *sensor_info : no_ids,
+                                            pf, &packet, 1, valid_bits,
+                                            validate_crc))
+            return false;
+    }
+    return batch_packet(packet, ls);
+}
+
+bool ScanBatcher::batch_packet(const sensor::LidarPacket& packet,
+                               LidarScan& ls) {
+    if (ls.w != scan_width() || ls.h != scan_height())
         throw std::invalid_argument("unexpected scan dimensions");
-    if (static_cast<size_t>(ls.packet_timestamp().rows()) !=
-        ls.w / pf.columns_per_packet)
+    // the batcher writes through pointers it keeps across packets
+    ls.unshare();
+    const size_t expected_rows =
+        cropped() ? (ls.w + pf.columns_per_packet - 1) / pf.columns_per_packet
+                  : ls.w / pf.columns_per_packet;
+    if (static_cast<size_t>(ls.packet_timestamp().rows()) != expected_rows)
         throw std::invalid_argument("unexpected scan columns_per_packet: " +
                                     std::to_string(pf.columns_per_packet));
 
@@ -1073,8 +2495,16 @@ bool ScanBatcher::operator()(const ouster::sensor::LidarPacket& packet,
         next_headers_m_id = 0;
         batched_packets = 0;
         ls.frame_id = f_id;
-        zero_header_cols(ls, 0, w);
+        zero_header_cols(ls, 0, ls.w);
+        next_sector_col = 0;
+        if (cropped()) {
+            std::fill(seen_packets.begin(), seen_packets.end(), 0);
+            seen_count = 0;
+            region_seen_count = 0;
+        }
+        start_deferred(ls);
         ls.packet_timestamp().setZero();
+        ls.alert_flags().setZero();
         const uint8_t f_thermal_shutdown = pf.thermal_shutdown(packet_buf);
         const uint8_t f_shot_limiting = pf.shot_limiting(packet_buf);
         ls.frame_status = frame_status(f_thermal_shutdown, f_shot_limiting);
@@ -1103,24 +2533,40 @@ bool ScanBatcher::operator()(const ouster::sensor::LidarPacket& packet,
     const uint8_t* col0_buf = pf.nth_col(0, packet_buf);
     const uint16_t packet_id =
         pf.col_measurement_id(col0_buf) / pf.columns_per_packet;
+    if (cropped()) {
+        if (packet_id >= region_first_packet &&
+            packet_id - region_first_packet <
+                static_cast<size_t>(ls.packet_timestamp().rows())) {
+            const size_t row = packet_id - region_first_packet;
+            ls.packet_timestamp()[row] = packet.host_timestamp;
+            ls.alert_flags()[row] = pf.alert_flags(packet_buf);
+        }
+        if (packet_id < seen_packets.size() && !seen_packets[packet_id]) {
+            seen_packets[packet_id] = 1;
+            seen_count++;
+            if (packet_id >= region_first_packet &&
+                packet_id < region_first_packet + region_packets)
+                region_seen_count++;
+        }
+        parse_region(packet_buf, ls);
+        emit_sectors(ls, next_valid_m_id);
+        if (check_scan_complete(ls)) {
+            finalize_scan(ls);
+            return true;
+        }
+        return false;
+    }
+
     if (packet_id < ls.packet_timestamp().rows()) {
         ls.packet_timestamp()[packet_id] = packet.host_timestamp;
         ls.alert_flags()[packet_id] = pf.alert_flags(packet_buf);
     }
 
-    // handling column and pixel level data
-    bool happy_packet = true;
-    for (int icol = 0; icol < pf.columns_per_packet; icol++) {
-        const uint8_t* col_buf = pf.nth_col(icol, packet_buf);
-        const uint16_t m_id = pf.col_measurement_id(col_buf);
-        const uint32_t status = pf.col_status(col_buf);
-        const bool valid = (status & 0x01);
+    // keep the packet to decode the deferred fields from later
+    if (!ls.deferred_fields_.empty()) keep_packet(packet, ls);
 
-        if (!valid || m_id >= w) {
-            happy_packet = false;
-            break;
-        }
-    }
+    // handling column and pixel level data
+    const bool happy_packet = all_cols_valid(pf, packet_buf, w);
 
     if (pf.block_parsable() && happy_packet && !raw_headers) {
         parse_by_block(packet_buf, ls);
@@ -1128,6 +2574,8 @@ bool ScanBatcher::operator()(const ouster::sensor::LidarPacket& packet,
         parse_by_col(packet_buf, ls);
     }
 
+    emit_sectors(ls, next_valid_m_id);
+
     // if we have enough packets and are packet-complete release the scan
     if (check_scan_complete(ls)) {
         finalize_scan(ls);
@@ -1145,27 +2593,112 @@ void ScanBatcher::cache_packet(const sensor::LidarPacket& packet) {
 void ScanBatcher::batch_cached_packet(LidarScan& ls) {
     if (cached_packet) {
         cached_packet = false;
-        this->operator()(cache.as<sensor::LidarPacket>(), ls);
+        // already validated when it was cached
+        batch_packet(cache.as<sensor::LidarPacket>(), ls);
     }
 }
 
 bool ScanBatcher::check_scan_complete(const LidarScan& ls) const {
+    if (cropped()) {
+        // all of the region, or everything the column window sends
+        return region_seen_count == region_packets ||
+               seen_count >= expected_packets;
+    }
     return batched_packets >= expected_packets &&
            static_cast<size_t>(ls.packet_timestamp().count()) ==
                expected_packets;
 }
 
 void ScanBatcher::finalize_scan(LidarScan& ls) {
-    impl::foreach_channel_field(ls, pf, zero_field_cols{}, next_valid_m_id, w);
+    foreach_batched_field(ls, pf_fields, zero_field_cols{}, next_valid_m_id,
+                          ls.w);
 
     if (impl::raw_headers_enabled(pf, ls)) {
+        // never written to for a region
+        const size_t start = cropped() ? 0 : next_headers_m_id;
         impl::visit_field(ls, sensor::ChanField::RAW_HEADERS, zero_field_cols{},
-                          "", next_headers_m_id, w);
+                          "", start, ls.w);
     }
 
+    emit_sectors(ls, w);
     finished_scan_id = ls.frame_id;
 }
 
+void ScanBatcher::finish_scan(LidarScan& ls) {
+    if (ls.frame_id == -1 || finished_scan_id == ls.frame_id) return;
+    finalize_scan(ls);
+}
+
+void ScanBatcher::emit_sectors(const LidarScan& ls, size_t done_cols) {
+    if (!sector_callback) return;
+    while (next_sector_col < done_cols) {
+        const size_t end = std::min(next_sector_col + sector_columns, ls.w);
+        if (end > done_cols) break;
+        const ScanSector sector{&ls, next_sector_col, end};
+        next_sector_col = end;
+        sector_callback(sector);
+    }
+}
+
+void ScanBatcher::set_sector_callback(
+    size_t columns, std::function<void(const ScanSector&)> callback) {
+    if (callback && columns == 0)
+        throw std::invalid_argument("sector columns must be greater than zero");
+    sector_columns = columns;
+    sector_callback = std::move(callback);
+}
+
+void ScanBatcher::set_packet_validation(bool enable, bool check_crc) {
+    validate_packets = enable;
+    validate_crc = check_crc;
+}
+
+void ScanBatcher::set_region(size_t start_col, size_t end_col,
+                             std::vector<size_t> beams) {
+    if (start_col >= end_col || end_col > w)
+        throw std::invalid_argument("invalid region columns: [" +
+                                    std::to_string(start_col) + ", " +
+                                    std::to_string(end_col) + ")");
+    for (size_t beam : beams) {
+        if (beam >= h)
+            throw std::invalid_argument("invalid region beam: " +
+                                        std::to_string(beam));
+    }
+    region_start = start_col;
+    region_end = end_col;
+    region_beams = std::move(beams);
+    // every beam in order is the same as none
+    bool all_beams = region_beams.size() == h;
+    for (size_t i = 0; all_beams && i < h; i++)
+        all_beams = region_beams[i] == i;
+    if (all_beams) region_beams.clear();
+
+    const size_t cpp = pf.columns_per_packet;
+    region_first_packet = start_col / cpp;
+    region_packets = (end_col - 1) / cpp - region_first_packet + 1;
+    seen_packets.assign((w + cpp - 1) / cpp, 0);
+    seen_count = 0;
+    region_seen_count = 0;
+}
+
+void ScanBatcher::set_region(size_t start_col, size_t end_col,
+                             size_t beam_stride) {
+    if (beam_stride == 0)
+        throw std::invalid_argument("beam stride must be greater than zero");
+    std::vector<size_t> beams;
+    if (beam_stride > 1) {
+        for (size_t beam = 0; beam < h; beam += beam_stride)
+            beams.push_back(beam);
+    }
+    set_region(start_col, end_col, std::move(beams));
+}
+
+size_t ScanBatcher::scan_width() const { return region_end - region_start; }
+
+size_t ScanBatcher::scan_height() const {
+    return region_beams.empty() ? h : region_beams.size();
+}
+
 bool ScanBatcher::operator()(const uint8_t* packet_buf, LidarScan& ls) {
     return this->operator()(packet_buf, 0, ls);
 }
@@ -1251,5 +2784,226 @@ Points transform(const Eigen::Ref<const Points> points,
     transform(transformed, points, pose);
     return transformed;
 }
+
+size_t cartesian_dewarp(Eigen::Ref<Points> points,
+                        const Eigen::Ref<const img_t<uint32_t>>& range,
+                        const XYZLut& lut, const Eigen::Ref<const Poses> poses,
+                        const mat4d& extrinsic, bool compact) {
+    const Eigen::Index W = range.cols();
+    const Eigen::Index H = range.rows();
+    const Eigen::Index N = W * H;
+    if (lut.direction.rows() != N || lut.offset.rows() != N) {
+        throw std::invalid_argument("unexpected lut dimensions");
+    }
+    if (poses.rows() != W) {
+        throw std::invalid_argument("expected a pose for every column");
+    }
+    if (points.rows() < N) {
+        throw std::invalid_argument("expected a row of points for every pixel");
+    }
+
+    // extrinsic * pose of every column, as rotation and translation
+    using Affine = Eigen::Matrix<double, 3, 4>;
+    std::vector<Affine, Eigen::aligned_allocator<Affine>> columns(W);
+    for (Eigen::Index w = 0; w < W; ++w) {
+        Eigen::Map<const Eigen::Matrix<double, 4, 4, Eigen::RowMajor>> pose(
+            poses.row(w).data());
+        columns[w] = (extrinsic * pose).topRows<3>();
+    }
+
+    const uint32_t* rng = range.data();
+    const double* dir = lut.direction.data();
+    const double* ofs = lut.offset.data();
+    auto project = [&](Eigen::Index ix, Eigen::Index out) {
+        const Affine& m = columns[ix % W];
+        const double r = rng[ix];
+        const Eigen::Vector3d p(r * dir[ix] + ofs[ix],
+                                r * dir[N + ix] + ofs[N + ix],
+                                r * dir[2 * N + ix] + ofs[2 * N + ix]);
+        points.row(out) = (m.leftCols<3>() * p + m.col(3)).transpose();
+    };
+
+    if (compact) {
+        Eigen::Index n = 0;
+        for (Eigen::Index ix = 0; ix < N; ++ix) {
+            if (rng[ix] != 0) project(ix, n++);
+        }
+        return n;
+    }
+
+    // zero ranges become the origin of their column, like dewarping the zero
+    // points from cartesian
+#ifdef __OUSTER_UTILIZE_OPENMP__
+#pragma omp parallel for schedule(static)
+#endif
+    for (Eigen::Index h = 0; h < H; ++h) {
+        for (Eigen::Index ix = h * W; ix < (h + 1) * W; ++ix) {
+            if (rng[ix] != 0) {
+                project(ix, ix);
+            } else {
+                points.row(ix) = columns[ix % W].col(3).transpose();
+            }
+        }
+    }
+    return N;
+}
+
+Points cartesian_dewarp(const LidarScan& scan, const XYZLut& lut,
+                        const mat4d& extrinsic, bool compact) {
+    const auto range = scan.field<uint32_t>(sensor::ChanField::RANGE);
+    Eigen::Map<const Poses> poses(scan.pose().get<double>(), scan.w, 16);
+    Points points(range.size(), 3);
+    const size_t n =
+        cartesian_dewarp(points, range, lut, poses, extrinsic, compact);
+    points.conservativeResize(n, 3);
+    return points;
+}
+
+namespace {
+
+using Mat4 = Eigen::Matrix<double, 4, 4, Eigen::RowMajor>;
+using Vec6 = Eigen::Matrix<double, 6, 1>;
+
+Eigen::Matrix3d skew(const Eigen::Vector3d& v) {
+    Eigen::Matrix3d m;
+    m << 0, -v(2), v(1), v(2), 0, -v(0), -v(1), v(0), 0;
+    return m;
+}
+
+// exp of (rotation vector, translation) as in pose_util.exp_pose6
+Mat4 exp_pose6(const Vec6& v) {
+    Mat4 m = Mat4::Identity();
+    const Eigen::Vector3d w = v.head<3>();
+    const double theta = w.norm();
+    if (theta < 1e-9) {
+        m.topRightCorner<3, 1>() = v.tail<3>();
+        return m;
+    }
+    const Eigen::Matrix3d k = skew(w / theta);
+    const Eigen::Matrix3d k2 = k * k;
+    const double s = std::sin(theta);
+    const double c = 1 - std::cos(theta);
+    m.topLeftCorner<3, 3>() = Eigen::Matrix3d::Identity() + s * k + c * k2;
+    m.topRightCorner<3, 1>() = (Eigen::Matrix3d::Identity() + c / theta * k +
+                                (theta - s) / theta * k2) *
+                               v.tail<3>();
+    return m;
+}
+
+// log of a pose as (rotation vector, translation) as in pose_util.log_pose
+Vec6 log_pose(const Mat4& m) {
+    Vec6 v;
+    const Eigen::AngleAxisd aa(Eigen::Matrix3d(m.topLeftCorner<3, 3>()));
+    const double theta = aa.angle();
+    const Eigen::Vector3d t = m.topRightCorner<3, 1>();
+    if (theta < 1e-9) {
+        v << 0, 0, 0, t;
+        return v;
+    }
+    const Eigen::Matrix3d k = skew(aa.axis());
+    const Eigen::Matrix3d v_inv =
+        Eigen::Matrix3d::Identity() - 0.5 * theta * k +
+        (1 - 0.5 * theta / std::tan(theta / 2)) * k * k;
+    v << theta * aa.axis(), v_inv * t;
+    return v;
+}
+
+}  // namespace
+
+TrajectoryEvaluator::TrajectoryEvaluator(std::vector<double> timestamps,
+                                         const Eigen::Ref<const Poses> poses)
+    : timestamps_(std::move(timestamps)), knots_(poses) {
+    const size_t n = timestamps_.size();
+    if (n < 2) {
+        throw std::invalid_argument(
+            "TrajectoryEvaluator expects at least 2 poses.");
+    }
+    if (static_cast<size_t>(knots_.rows()) != n) {
+        throw std::invalid_argument("expected a pose for every timestamp");
+    }
+    deltas_.resize(n - 1, 6);
+    for (size_t i = 0; i + 1 < n; ++i) {
+        if (!(timestamps_[i + 1] > timestamps_[i])) {
+            throw std::invalid_argument(
+                "expected increasing trajectory timestamps");
+        }
+        Eigen::Map<const Mat4> p0(knots_.row(i).data());
+        Eigen::Map<const Mat4> p1(knots_.row(i + 1).data());
+        deltas_.row(i) = log_pose(Mat4(p0.inverse() * p1)).transpose();
+    }
+}
+
+void TrajectoryEvaluator::poses_at(
+    Eigen::Ref<Poses> poses, const Eigen::Ref<const Eigen::ArrayXd> ts) const {
+    if (poses.rows() < ts.size()) {
+        throw std::invalid_argument("expected a row of poses for every ts");
+    }
+    const auto begin = timestamps_.begin();
+    const size_t last = timestamps_.size() - 2;
+    // the segment of the previous timestamp, usually also the one of the next
+    size_t seg = 0;
+    for (Eigen::Index i = 0; i < ts.size(); ++i) {
+        const double t = ts(i);
+        if (t < timestamps_[seg] ||
+            (seg < last && t >= timestamps_[seg + 1])) {
+            if (seg < last && t < timestamps_[seg + 2] &&
+                t >= timestamps_[seg + 1]) {
+                ++seg;
+            } else {
+                // timestamps out of the knots extrapolate the edge segments
+                const size_t ub =
+                    std::upper_bound(begin, timestamps_.end(), t) - begin;
+                seg = std::min(last, ub == 0 ? 0 : ub - 1);
+            }
+        }
+        const double dt = (t - timestamps_[seg]) /
+                          (timestamps_[seg + 1] - timestamps_[seg]);
+        Eigen::Map<const Mat4> base(knots_.row(seg).data());
+        const Vec6 delta = deltas_.row(seg).transpose() * dt;
+        Eigen::Map<Mat4>(poses.row(i).data()) = base * exp_pose6(delta);
+    }
+}
+
+Poses TrajectoryEvaluator::poses_at(
+    const Eigen::Ref<const Eigen::ArrayXd> ts) const {
+    Poses poses(ts.size(), 16);
+    poses_at(poses, ts);
+    return poses;
+}
+
+void TrajectoryEvaluator::pose_scan(
+    LidarScan& scan, const Eigen::Ref<const Eigen::ArrayXd> col_ts) const {
+    const Eigen::Index w = scan.w;
+    if (col_ts.size() != 0 && col_ts.size() != w) {
+        throw std::invalid_argument("expected a timestamp for every column");
+    }
+    const auto status = scan.status();
+    const auto timestamp = scan.timestamp();
+
+    std::vector<Eigen::Index> cols;
+    cols.reserve(w);
+    for (Eigen::Index c = 0; c < w; ++c) {
+        if (status(c) & 0x01) cols.push_back(c);
+    }
+    Eigen::ArrayXd ts(cols.size());
+    for (size_t i = 0; i < cols.size(); ++i) {
+        ts(i) = col_ts.size() != 0 ? col_ts(cols[i])
+                                   : static_cast<double>(timestamp(cols[i]));
+    }
+
+    Eigen::Map<Poses> scan_poses(scan.pose().get<double>(), w, 16);
+    if (cols.size() == static_cast<size_t>(w)) {
+        poses_at(scan_poses, ts);
+        return;
+    }
+    const Poses poses = poses_at(ts);
+    for (size_t i = 0; i < cols.size(); ++i) {
+        scan_poses.row(cols[i]) = poses.row(i);
+    }
+}
+
+const std::vector<double>& TrajectoryEvaluator::timestamps() const {
+    return timestamps_;
+}
 }  // namespace pose_util
 }  // namespace ouster
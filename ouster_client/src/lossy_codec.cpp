@@ -0,0 +1,473 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/lossy_codec.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace ouster {
+
+namespace {
+
+// An encoded image is
+//
+//     magic "OSLQ" | uint8 version | uint8 bytes per pixel | uint16 reserved
+//     | uint32 rows | uint32 columns | uint32 max error | uint32 size of the
+//     runs | runs | a bit per row, set if the row is extrapolated | uint8
+//     symbols | uint16 frequency of each symbol | uint32 size of the rANS
+//     stream | rANS stream | low bits of the residuals
+//
+// with little endian integers. Runs are the lengths of the alternating runs
+// of zero and nonzero pixels in row major order, starting with zero pixels,
+// as LEB128 varints. Symbols are the bit lengths of the zigzagged residuals
+// of the nonzero pixels, bits are packed least significant bit first.
+constexpr uint8_t lossy_magic[4] = {'O', 'S', 'L', 'Q'};
+constexpr uint8_t lossy_version = 1;
+constexpr size_t lossy_header_size = 20;
+
+// bit lengths of 64 bit residuals
+constexpr size_t max_symbols = 65;
+// frequencies of the rANS coder add up to prob_scale
+constexpr uint32_t prob_bits = 12;
+constexpr uint32_t prob_scale = 1u << prob_bits;
+// lower bound of the rANS state, renormalized a byte at a time
+constexpr uint32_t rans_low = 1u << 23;
+
+int bit_length(uint64_t v) {
+    if (!v) return 0;
+#if defined(__GNUC__) || defined(__clang__)
+    return 64 - __builtin_clzll(v);
+#else
+    int result = 1;
+    while (v >>= 1) result++;
+    return result;
+#endif
+}
+
+uint64_t zigzag(uint64_t d) {
+    return (d << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(d) >> 63);
+}
+
+uint64_t unzigzag(uint64_t z) { return (z >> 1) ^ (0 - (z & 1)); }
+
+void put_u16(std::vector<uint8_t>& out, uint16_t v) {
+    out.push_back(static_cast<uint8_t>(v));
+    out.push_back(static_cast<uint8_t>(v >> 8));
+}
+
+void put_u32(std::vector<uint8_t>& out, uint32_t v) {
+    for (int i = 0; i < 4; i++) out.push_back(static_cast<uint8_t>(v >> 8 * i));
+}
+
+void put_varint(std::vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+[[noreturn]] void corrupt() {
+    throw std::invalid_argument("decode_lossy: truncated or corrupt image");
+}
+
+// reads the sections of an encoded image, checking that it stays within them
+class byte_reader {
+   public:
+    byte_reader(const uint8_t* data, size_t size)
+        : p_(data), end_(data + size) {}
+
+    const uint8_t* take(size_t n) {
+        if (n > static_cast<size_t>(end_ - p_)) corrupt();
+        const uint8_t* p = p_;
+        p_ += n;
+        return p;
+    }
+
+    uint8_t u8() { return *take(1); }
+
+    uint16_t u16() {
+        const uint8_t* p = take(2);
+        return static_cast<uint16_t>(p[0] | p[1] << 8);
+    }
+
+    uint32_t u32() {
+        const uint8_t* p = take(4);
+        return uint32_t{p[0]} | uint32_t{p[1]} << 8 | uint32_t{p[2]} << 16 |
+               uint32_t{p[3]} << 24;
+    }
+
+    uint64_t varint() {
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            const uint8_t b = u8();
+            v |= uint64_t{b & 0x7fu} << shift;
+            if (!(b & 0x80)) return v;
+        }
+        corrupt();
+    }
+
+    const uint8_t* pos() const { return p_; }
+    const uint8_t* end() const { return end_; }
+
+   private:
+    const uint8_t* p_;
+    const uint8_t* end_;
+};
+
+class bit_writer {
+   public:
+    explicit bit_writer(std::vector<uint8_t>& out) : out_(out) {}
+
+    // append the low count bits of bits
+    void put(uint64_t bits, int count) {
+        while (count > 0) {
+            const int take = std::min(count, 32);
+            acc_ |= (bits & ((uint64_t{1} << take) - 1)) << n_;
+            n_ += take;
+            bits >>= take;
+            count -= take;
+            while (n_ >= 8) {
+                out_.push_back(static_cast<uint8_t>(acc_));
+                acc_ >>= 8;
+                n_ -= 8;
+            }
+        }
+    }
+
+    void flush() {
+        if (n_ > 0) out_.push_back(static_cast<uint8_t>(acc_));
+        acc_ = 0;
+        n_ = 0;
+    }
+
+   private:
+    std::vector<uint8_t>& out_;
+    uint64_t acc_{0};
+    int n_{0};
+};
+
+class bit_reader {
+   public:
+    bit_reader(const uint8_t* p, const uint8_t* end) : p_(p), end_(end) {}
+
+    uint64_t get(int count) {
+        uint64_t bits = 0;
+        int shift = 0;
+        while (count > 0) {
+            const int take = std::min(count, 32);
+            while (n_ < take) {
+                if (p_ == end_) corrupt();
+                acc_ |= uint64_t{*p_++} << n_;
+                n_ += 8;
+            }
+            bits |= (acc_ & ((uint64_t{1} << take) - 1)) << shift;
+            acc_ >>= take;
+            n_ -= take;
+            shift += take;
+            count -= take;
+        }
+        return bits;
+    }
+
+   private:
+    const uint8_t* p_;
+    const uint8_t* end_;
+    uint64_t acc_{0};
+    int n_{0};
+};
+
+// frequencies of the symbols scaled to add up to prob_scale, every symbol
+// that occurs keeping at least 1
+std::vector<uint16_t> normalize(const std::array<uint64_t, max_symbols>& counts,
+                                uint64_t total) {
+    size_t n = max_symbols;
+    while (n > 0 && counts[n - 1] == 0) n--;
+    std::vector<uint16_t> freq(n, 0);
+    if (n == 0) return freq;
+    uint32_t sum = 0;
+    for (size_t s = 0; s < n; s++) {
+        if (!counts[s]) continue;
+        freq[s] = static_cast<uint16_t>(
+            std::max<uint64_t>(1, counts[s] * prob_scale / total));
+        sum += freq[s];
+    }
+    // settle the rounding on the most frequent symbols
+    while (sum != prob_scale) {
+        size_t top = 0;
+        for (size_t s = 1; s < n; s++) {
+            if (freq[s] > freq[top]) top = s;
+        }
+        if (sum < prob_scale) {
+            const uint32_t add = prob_scale - sum;
+            freq[top] = static_cast<uint16_t>(freq[top] + add);
+            sum += add;
+        } else {
+            const uint32_t sub = std::min<uint32_t>(sum - prob_scale,
+                                                    freq[top] - 1u);
+            freq[top] = static_cast<uint16_t>(freq[top] - sub);
+            sum -= sub;
+            if (sub == 0) break;
+        }
+    }
+    return freq;
+}
+
+template <typename T>
+uint64_t quantize(T v, uint64_t e, uint64_t step) {
+    const uint64_t u = v;
+    return u / step + (u % step > e ? 1 : 0);
+}
+
+template <typename T>
+T dequantize(uint64_t k, uint64_t step) {
+    // nonzero pixels stay nonzero, within max_error of 1
+    if (k == 0) return 1;
+    const uint64_t max = std::numeric_limits<T>::max();
+    if (k > max / step) return std::numeric_limits<T>::max();
+    return static_cast<T>(k * step);
+}
+
+// the prediction of the i-th nonzero pixel of a row from the ones before it
+// and the first nonzero pixel of the rows above
+uint64_t predict(bool extrapolate, uint64_t i, uint64_t above, uint64_t a,
+                 uint64_t b) {
+    if (i == 0) return above;
+    if (!extrapolate || i == 1) return a;
+    return 2 * a - b;
+}
+
+}  // namespace
+
+template <typename T>
+std::vector<uint8_t> encode_lossy(const Eigen::Ref<const img_t<T>>& img,
+                                  uint32_t max_error) {
+    const Eigen::Index rows = img.rows();
+    const Eigen::Index cols = img.cols();
+    const uint64_t e = max_error;
+    const uint64_t step = 2 * e + 1;
+
+    std::vector<uint8_t> out;
+    out.insert(out.end(), lossy_magic, lossy_magic + 4);
+    out.push_back(lossy_version);
+    out.push_back(static_cast<uint8_t>(sizeof(T)));
+    put_u16(out, 0);
+    put_u32(out, static_cast<uint32_t>(rows));
+    put_u32(out, static_cast<uint32_t>(cols));
+    put_u32(out, max_error);
+
+    // runs of zero and nonzero pixels
+    std::vector<uint8_t> runs;
+    bool nonzero = false;
+    uint64_t run = 0;
+    for (Eigen::Index r = 0; r < rows; r++) {
+        for (Eigen::Index c = 0; c < cols; c++) {
+            if ((img(r, c) != 0) != nonzero) {
+                put_varint(runs, run);
+                nonzero = !nonzero;
+                run = 0;
+            }
+            run++;
+        }
+    }
+    put_varint(runs, run);
+    put_u32(out, static_cast<uint32_t>(runs.size()));
+    out.insert(out.end(), runs.begin(), runs.end());
+
+    // residuals of each row, by the better of the predictors
+    std::vector<uint8_t> extrapolated((rows + 7) / 8, 0);
+    std::vector<uint64_t> residuals;
+    residuals.reserve(static_cast<size_t>(rows * cols));
+    std::vector<uint64_t> k;
+    k.reserve(static_cast<size_t>(cols));
+    std::array<uint64_t, max_symbols> counts{};
+    uint64_t above = 0;
+    for (Eigen::Index r = 0; r < rows; r++) {
+        k.clear();
+        for (Eigen::Index c = 0; c < cols; c++) {
+            if (img(r, c) != 0) k.push_back(quantize<T>(img(r, c), e, step));
+        }
+        if (k.empty()) continue;
+        uint64_t cost[2] = {0, 0};
+        for (int p = 0; p < 2; p++) {
+            for (size_t i = 0; i < k.size(); i++) {
+                const uint64_t pred = predict(p, i, above, i ? k[i - 1] : 0,
+                                              i > 1 ? k[i - 2] : 0);
+                cost[p] += bit_length(zigzag(k[i] - pred));
+            }
+        }
+        const bool extrapolate = cost[1] < cost[0];
+        if (extrapolate) extrapolated[r / 8] |= 1 << (r % 8);
+        for (size_t i = 0; i < k.size(); i++) {
+            const uint64_t pred = predict(extrapolate, i, above,
+                                          i ? k[i - 1] : 0,
+                                          i > 1 ? k[i - 2] : 0);
+            const uint64_t z = zigzag(k[i] - pred);
+            residuals.push_back(z);
+            counts[bit_length(z)]++;
+        }
+        above = k[0];
+    }
+    out.insert(out.end(), extrapolated.begin(), extrapolated.end());
+
+    // bit lengths of the residuals, rANS coded in reverse so that they
+    // decode forwards
+    const auto freq = normalize(counts, residuals.size());
+    std::vector<uint32_t> start(freq.size() + 1, 0);
+    for (size_t s = 0; s < freq.size(); s++) start[s + 1] = start[s] + freq[s];
+    out.push_back(static_cast<uint8_t>(freq.size()));
+    for (auto f : freq) put_u16(out, f);
+
+    std::vector<uint8_t> rans;
+    if (!residuals.empty()) {
+        rans.reserve(residuals.size() / 2 + 4);
+        uint32_t x = rans_low;
+        for (auto it = residuals.rbegin(); it != residuals.rend(); ++it) {
+            const int s = bit_length(*it);
+            const uint32_t f = freq[s];
+            const uint32_t x_max = ((rans_low >> prob_bits) << 8) * f;
+            while (x >= x_max) {
+                rans.push_back(static_cast<uint8_t>(x));
+                x >>= 8;
+            }
+            x = ((x / f) << prob_bits) + (x % f) + start[s];
+        }
+        for (int i = 3; i >= 0; i--) {
+            rans.push_back(static_cast<uint8_t>(x >> 8 * i));
+        }
+        std::reverse(rans.begin(), rans.end());
+    }
+    put_u32(out, static_cast<uint32_t>(rans.size()));
+    out.insert(out.end(), rans.begin(), rans.end());
+
+    // low bits of the residuals, below their leading one
+    bit_writer bits(out);
+    for (auto z : residuals) {
+        const int n = bit_length(z);
+        if (n > 1) bits.put(z, n - 1);
+    }
+    bits.flush();
+    return out;
+}
+
+template <typename T>
+void decode_lossy(const uint8_t* data, size_t size, Eigen::Ref<img_t<T>> img) {
+    if (!is_lossy_buffer(data, size)) {
+        throw std::invalid_argument("decode_lossy: not a lossy image");
+    }
+    byte_reader in(data, size);
+    in.take(4);
+    if (in.u8() != lossy_version) {
+        throw std::invalid_argument("decode_lossy: unsupported version");
+    }
+    const uint8_t pixel_bytes = in.u8();
+    in.u16();
+    const uint32_t rows = in.u32();
+    const uint32_t cols = in.u32();
+    if (pixel_bytes != sizeof(T) || rows != static_cast<size_t>(img.rows()) ||
+        cols != static_cast<size_t>(img.cols())) {
+        throw std::invalid_argument(
+            "decode_lossy: image doesn't match the encoded one");
+    }
+    const uint64_t step = 2 * uint64_t{in.u32()} + 1;
+
+    const uint32_t runs_size = in.u32();
+    byte_reader runs(in.take(runs_size), runs_size);
+    const uint8_t* extrapolated = in.take((rows + 7) / 8);
+
+    const uint8_t n_symbols = in.u8();
+    if (n_symbols > max_symbols) corrupt();
+    uint32_t freq[max_symbols] = {0};
+    uint32_t start[max_symbols] = {0};
+    uint32_t total = 0;
+    for (uint8_t s = 0; s < n_symbols; s++) {
+        freq[s] = in.u16();
+        start[s] = total;
+        total += freq[s];
+    }
+    std::array<uint8_t, prob_scale> slot_symbol;
+    if (n_symbols) {
+        if (total != prob_scale) corrupt();
+        for (uint8_t s = 0; s < n_symbols; s++) {
+            std::fill_n(slot_symbol.begin() + start[s], freq[s], s);
+        }
+    }
+
+    const uint32_t rans_size = in.u32();
+    const uint8_t* rp = in.take(rans_size);
+    const uint8_t* rend = rp + rans_size;
+    uint32_t x = 0;
+    if (rans_size) {
+        if (rans_size < 4) corrupt();
+        x = uint32_t{rp[0]} | uint32_t{rp[1]} << 8 | uint32_t{rp[2]} << 16 |
+            uint32_t{rp[3]} << 24;
+        rp += 4;
+    }
+    bit_reader bits(in.pos(), in.end());
+
+    bool nonzero = false;
+    uint64_t run_left = runs.varint();
+    uint64_t above = 0;
+    for (uint32_t r = 0; r < rows; r++) {
+        const bool extrapolate = extrapolated[r / 8] & (1 << (r % 8));
+        uint64_t i = 0;
+        uint64_t a = 0;
+        uint64_t b = 0;
+        for (uint32_t c = 0; c < cols; c++) {
+            while (run_left == 0) {
+                nonzero = !nonzero;
+                run_left = runs.varint();
+            }
+            run_left--;
+            if (!nonzero) {
+                img(r, c) = 0;
+                continue;
+            }
+
+            if (!n_symbols) corrupt();
+            const uint32_t slot = x & (prob_scale - 1);
+            const uint8_t s = slot_symbol[slot];
+            x = freq[s] * (x >> prob_bits) + slot - start[s];
+            while (x < rans_low) {
+                if (rp == rend) corrupt();
+                x = (x << 8) | *rp++;
+            }
+            const uint64_t z =
+                s > 1 ? (uint64_t{1} << (s - 1)) | bits.get(s - 1) : s;
+
+            const uint64_t k = predict(extrapolate, i, above, a, b) +
+                               unzigzag(z);
+            if (i == 0) above = k;
+            b = a;
+            a = k;
+            i++;
+            img(r, c) = dequantize<T>(k, step);
+        }
+    }
+}
+
+bool is_lossy_buffer(const uint8_t* data, size_t size) {
+    return data && size >= lossy_header_size &&
+           std::memcmp(data, lossy_magic, sizeof(lossy_magic)) == 0;
+}
+
+#define OUSTER_LOSSY_CODEC(T)                                             \
+    template std::vector<uint8_t> encode_lossy<T>(                        \
+        const Eigen::Ref<const img_t<T>>&, uint32_t);                     \
+    template void decode_lossy<T>(const uint8_t*, size_t,                 \
+                                  Eigen::Ref<img_t<T>>);
+
+OUSTER_LOSSY_CODEC(uint8_t)
+OUSTER_LOSSY_CODEC(uint16_t)
+OUSTER_LOSSY_CODEC(uint32_t)
+OUSTER_LOSSY_CODEC(uint64_t)
+
+#undef OUSTER_LOSSY_CODEC
+
+}  // namespace ouster
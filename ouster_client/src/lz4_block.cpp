@@ -0,0 +1,152 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "lz4_block.h"
+
+#include <cstring>
+#include <vector>
+
+namespace ouster {
+namespace impl {
+
+namespace {
+
+// constraints of the format: matches are at least 4 bytes, the last 5 bytes
+// are always literals and the last match starts 12 bytes before the end
+constexpr size_t min_match = 4;
+constexpr size_t last_literals = 5;
+constexpr size_t match_limit = 12;
+constexpr size_t max_offset = 65535;
+constexpr int hash_bits = 14;
+
+uint32_t read32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+uint32_t hash(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - hash_bits);
+}
+
+// lengths of 15 and more continue in bytes of up to 255
+uint8_t* put_length(uint8_t* out, size_t len) {
+    while (len >= 255) {
+        *out++ = 255;
+        len -= 255;
+    }
+    *out++ = static_cast<uint8_t>(len);
+    return out;
+}
+
+uint8_t* put_sequence(uint8_t* out, const uint8_t* literals, size_t n_literals,
+                      size_t offset, size_t match_len) {
+    uint8_t* token = out++;
+    *token = static_cast<uint8_t>((n_literals < 15 ? n_literals : 15) << 4);
+    if (n_literals >= 15) out = put_length(out, n_literals - 15);
+    if (n_literals) std::memcpy(out, literals, n_literals);
+    out += n_literals;
+    if (match_len == 0) return out;
+
+    *out++ = static_cast<uint8_t>(offset);
+    *out++ = static_cast<uint8_t>(offset >> 8);
+    const size_t len = match_len - min_match;
+    *token |= static_cast<uint8_t>(len < 15 ? len : 15);
+    if (len >= 15) out = put_length(out, len - 15);
+    return out;
+}
+
+// reads a length continued in bytes of 255, returning false past the end
+bool get_length(const uint8_t*& in, const uint8_t* end, size_t& len) {
+    uint8_t b;
+    do {
+        if (in == end) return false;
+        b = *in++;
+        len += b;
+    } while (b == 255);
+    return true;
+}
+
+}  // namespace
+
+size_t lz4_bound(size_t n) { return n + n / 255 + 16; }
+
+size_t lz4_compress(const uint8_t* src, size_t n, uint8_t* dst) {
+    uint8_t* out = dst;
+    size_t anchor = 0;
+    if (n > match_limit) {
+        // positions + 1 of the last occurrence of each hashed 4 bytes
+        std::vector<uint32_t> table(size_t{1} << hash_bits, 0);
+        const size_t limit = n - match_limit;
+        size_t ip = 0;
+        while (ip < limit) {
+            const uint32_t sequence = read32(src + ip);
+            uint32_t& slot = table[hash(sequence)];
+            const size_t ref = slot;
+            slot = static_cast<uint32_t>(ip + 1);
+            if (ref == 0 || ip - (ref - 1) > max_offset ||
+                read32(src + ref - 1) != sequence) {
+                // skip faster through data that doesn't compress
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+            const size_t match = ref - 1;
+            size_t len = min_match;
+            while (ip + len < n - last_literals &&
+                   src[match + len] == src[ip + len]) {
+                len++;
+            }
+            out = put_sequence(out, src + anchor, ip - anchor, ip - match,
+                               len);
+            ip += len;
+            anchor = ip;
+        }
+    }
+    out = put_sequence(out, src + anchor, n - anchor, 0, 0);
+    return static_cast<size_t>(out - dst);
+}
+
+bool lz4_decompress(const uint8_t* src, size_t n, uint8_t* dst,
+                    size_t dst_size) {
+    const uint8_t* in = src;
+    const uint8_t* const end = src + n;
+    size_t op = 0;
+    while (in < end) {
+        const uint8_t token = *in++;
+        size_t n_literals = token >> 4;
+        if (n_literals == 15 && !get_length(in, end, n_literals)) return false;
+        if (n_literals > static_cast<size_t>(end - in) ||
+            n_literals > dst_size - op) {
+            return false;
+        }
+        if (n_literals) std::memcpy(dst + op, in, n_literals);
+        in += n_literals;
+        op += n_literals;
+        // the last sequence has no match
+        if (in == end) break;
+
+        if (end - in < 2) return false;
+        const size_t offset = in[0] | static_cast<size_t>(in[1]) << 8;
+        in += 2;
+        size_t len = token & 15;
+        if (len == 15 && !get_length(in, end, len)) return false;
+        len += min_match;
+        if (offset == 0 || offset > op || len > dst_size - op) return false;
+
+        // matches may overlap the bytes they produce
+        uint8_t* out = dst + op;
+        const uint8_t* from = out - offset;
+        if (offset >= len) {
+            std::memcpy(out, from, len);
+        } else {
+            for (size_t i = 0; i < len; i++) out[i] = from[i];
+        }
+        op += len;
+    }
+    return op == dst_size;
+}
+
+}  // namespace impl
+}  // namespace ouster
@@ -0,0 +1,32 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Compression in the LZ4 block format, without depending on liblz4.
+ * Blocks are readable by LZ4_decompress_safe and vice versa.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ouster {
+namespace impl {
+
+/// Largest compressed size of n bytes
+size_t lz4_bound(size_t n);
+
+/// Compress n bytes into dst, which must hold lz4_bound(n) bytes
+/// @return the size of the compressed block
+size_t lz4_compress(const uint8_t* src, size_t n, uint8_t* dst);
+
+/// Decompress a block of n bytes that decompresses to exactly dst_size bytes
+/// @return false if the block is malformed or of another size, without
+///         reading or writing out of bounds
+bool lz4_decompress(const uint8_t* src, size_t n, uint8_t* dst,
+                    size_t dst_size);
+
+}  // namespace impl
+}  // namespace ouster
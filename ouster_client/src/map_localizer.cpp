@@ -0,0 +1,448 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/map_localizer.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <Eigen/Cholesky>
+#include <Eigen/Geometry>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include "ouster/voxel_grid.h"
+
+namespace ouster {
+
+namespace {
+
+// header: magic, version, reserved, voxel size, table size, point count and
+// offset of the points, followed by the table and the points
+constexpr char magic[8] = {'O', 'U', 'S', 'T', 'V', 'I', 'D', 'X'};
+constexpr uint32_t format_version = 1;
+constexpr uint64_t header_size = 64;
+
+// a voxel and the range of its points in the points of the file, a slot of
+// the open addressing table if count is not zero
+struct Slot {
+    int32_t x;
+    int32_t y;
+    int32_t z;
+    uint32_t count;
+    uint64_t start;
+};
+static_assert(sizeof(Slot) == 24, "unexpected padding of index slots");
+
+struct Voxel {
+    int32_t x;
+    int32_t y;
+    int32_t z;
+};
+
+uint64_t hash(int32_t x, int32_t y, int32_t z) {
+    uint64_t h = static_cast<uint32_t>(x);
+    h = h * 0x9E3779B97F4A7C15ULL ^ static_cast<uint32_t>(y);
+    h = h * 0x9E3779B97F4A7C15ULL ^ static_cast<uint32_t>(z);
+    return h ^ (h >> 29);
+}
+
+Voxel voxel_of(const double* p, double voxel_size) {
+    const double limit = std::numeric_limits<int32_t>::max();
+    Voxel v;
+    int32_t* c[3] = {&v.x, &v.y, &v.z};
+    for (int j = 0; j < 3; ++j) {
+        const double f = std::floor(p[j] / voxel_size);
+        if (!(std::abs(f) < limit)) {
+            throw std::invalid_argument("point too far for the voxel size");
+        }
+        *c[j] = static_cast<int32_t>(f);
+    }
+    return v;
+}
+
+template <typename T>
+void put(std::string& bytes, size_t at, const T& value) {
+    std::memcpy(&bytes[at], &value, sizeof(T));
+}
+
+template <typename T>
+T get(const uint8_t* bytes, size_t at) {
+    T value;
+    std::memcpy(&value, bytes + at, sizeof(T));
+    return value;
+}
+
+Eigen::Matrix3d skew(const Eigen::Vector3d& v) {
+    Eigen::Matrix3d m;
+    m << 0, -v(2), v(1), v(2), 0, -v(0), -v(1), v(0), 0;
+    return m;
+}
+
+// the fraction s of a relative motion, scaling its rotation angle and its
+// translation
+Eigen::Matrix4d scale_motion(const Eigen::Matrix4d& motion, double s) {
+    const Eigen::AngleAxisd aa(Eigen::Matrix3d(motion.topLeftCorner<3, 3>()));
+    Eigen::Matrix4d result = Eigen::Matrix4d::Identity();
+    result.topLeftCorner<3, 3>() =
+        Eigen::AngleAxisd(aa.angle() * s, aa.axis()).toRotationMatrix();
+    result.topRightCorner<3, 1>() = s * motion.topRightCorner<3, 1>();
+    return result;
+}
+
+}  // namespace
+
+struct voxel_map_index_impl {
+    uint8_t* buf = nullptr;
+    uint64_t size = 0;
+    double voxel_size = 0;
+    uint64_t table_size = 0;
+    uint64_t count = 0;
+    const Slot* table = nullptr;
+    const float* points = nullptr;
+
+    ~voxel_map_index_impl() {
+        if (buf == nullptr) return;
+#ifdef _WIN32
+        UnmapViewOfFile(buf);
+#else
+        munmap(buf, static_cast<size_t>(size));
+#endif
+    }
+
+    const Slot* find(int32_t x, int32_t y, int32_t z) const {
+        const uint64_t mask = table_size - 1;
+        for (uint64_t i = hash(x, y, z) & mask;; i = (i + 1) & mask) {
+            const Slot& slot = table[i];
+            if (slot.count == 0) return nullptr;
+            if (slot.x == x && slot.y == y && slot.z == z) return &slot;
+        }
+    }
+};
+
+void VoxelMapIndex::build(const std::string& filename,
+                          const Eigen::Ref<const pose_util::Points>& points,
+                          double voxel_size) {
+    if (!(voxel_size > 0)) {
+        throw std::invalid_argument("voxel size must be positive");
+    }
+    // the finite points and their voxels
+    std::vector<Eigen::Index> rows;
+    std::vector<Voxel> voxels;
+    rows.reserve(points.rows());
+    voxels.reserve(points.rows());
+    for (Eigen::Index i = 0; i < points.rows(); ++i) {
+        if (!points.row(i).allFinite()) continue;
+        rows.push_back(i);
+        voxels.push_back(voxel_of(points.row(i).data(), voxel_size));
+    }
+    std::vector<size_t> order(voxels.size());
+    std::iota(order.begin(), order.end(), 0);
+    auto less = [&voxels](size_t a, size_t b) {
+        const Voxel& u = voxels[a];
+        const Voxel& v = voxels[b];
+        return std::tie(u.x, u.y, u.z) < std::tie(v.x, v.y, v.z);
+    };
+    std::sort(order.begin(), order.end(), less);
+
+    // groups of points of the same voxel, in a table at most half full
+    size_t groups = 0;
+    for (size_t i = 0; i < order.size(); ++i) {
+        if (i == 0 || less(order[i - 1], order[i])) ++groups;
+    }
+    uint64_t table_size = 16;
+    while (table_size < 2 * groups) table_size *= 2;
+    std::vector<Slot> table(table_size, Slot{0, 0, 0, 0, 0});
+    std::vector<float> xyz;
+    xyz.reserve(order.size() * 3);
+    for (size_t i = 0; i < order.size();) {
+        size_t j = i + 1;
+        while (j < order.size() && !less(order[i], order[j])) ++j;
+        const Voxel& v = voxels[order[i]];
+        uint64_t at = hash(v.x, v.y, v.z) & (table_size - 1);
+        while (table[at].count != 0) at = (at + 1) & (table_size - 1);
+        table[at] = Slot{v.x, v.y, v.z, static_cast<uint32_t>(j - i),
+                         static_cast<uint64_t>(i)};
+        for (size_t k = i; k < j; ++k) {
+            const auto p = points.row(rows[order[k]]);
+            xyz.push_back(static_cast<float>(p(0)));
+            xyz.push_back(static_cast<float>(p(1)));
+            xyz.push_back(static_cast<float>(p(2)));
+        }
+        i = j;
+    }
+
+    std::string header(header_size, '\0');
+    std::memcpy(&header[0], magic, sizeof(magic));
+    put(header, 8, format_version);
+    put(header, 16, voxel_size);
+    put(header, 24, table_size);
+    put(header, 32, static_cast<uint64_t>(order.size()));
+    put(header, 40, header_size + table_size * sizeof(Slot));
+
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        throw std::runtime_error("failed to open " + filename);
+    }
+    out.write(header.data(), header.size());
+    out.write(reinterpret_cast<const char*>(table.data()),
+              table.size() * sizeof(Slot));
+    out.write(reinterpret_cast<const char*>(xyz.data()),
+              xyz.size() * sizeof(float));
+    out.close();
+    if (out.fail()) {
+        throw std::runtime_error("failed writing voxel map index");
+    }
+}
+
+VoxelMapIndex::VoxelMapIndex(const std::string& filename)
+    : impl(new voxel_map_index_impl) {
+    auto& s = *impl;
+#ifdef _WIN32
+    HANDLE file =
+        CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("failed to open " + filename);
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        throw std::runtime_error("not a voxel map index: " + filename);
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (mapping == NULL) {
+        throw std::runtime_error("failed to map " + filename);
+    }
+    void* buf = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (buf == NULL) {
+        throw std::runtime_error("failed to map " + filename);
+    }
+    s.buf = static_cast<uint8_t*>(buf);
+    s.size = static_cast<uint64_t>(size.QuadPart);
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("failed to open " + filename);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        ::close(fd);
+        throw std::runtime_error("not a voxel map index: " + filename);
+    }
+    void* buf = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ,
+                     MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (buf == MAP_FAILED) {
+        throw std::runtime_error("failed to map " + filename);
+    }
+    s.buf = static_cast<uint8_t*>(buf);
+    s.size = static_cast<uint64_t>(st.st_size);
+#endif
+
+    bool valid = s.size >= header_size &&
+                 std::memcmp(s.buf, magic, sizeof(magic)) == 0 &&
+                 get<uint32_t>(s.buf, 8) == format_version;
+    if (valid) {
+        s.voxel_size = get<double>(s.buf, 16);
+        s.table_size = get<uint64_t>(s.buf, 24);
+        s.count = get<uint64_t>(s.buf, 32);
+        const auto points_offset = get<uint64_t>(s.buf, 40);
+        valid = s.voxel_size > 0 && s.table_size > 0 &&
+                (s.table_size & (s.table_size - 1)) == 0 &&
+                points_offset == header_size + s.table_size * sizeof(Slot) &&
+                s.size >= points_offset + s.count * 3 * sizeof(float);
+        s.table = reinterpret_cast<const Slot*>(s.buf + header_size);
+        s.points = reinterpret_cast<const float*>(s.buf + points_offset);
+    }
+    if (!valid) {
+        throw std::runtime_error("not a voxel map index: " + filename);
+    }
+}
+
+VoxelMapIndex::~VoxelMapIndex() = default;
+
+void VoxelMapIndex::nearest(const Eigen::Ref<const pose_util::Points>& queries,
+                            double max_distance,
+                            Eigen::Ref<pose_util::Points> neighbors,
+                            Eigen::Ref<Eigen::ArrayXd> distances) const {
+    const Eigen::Index n = queries.rows();
+    if (neighbors.rows() != n || distances.size() != n) {
+        throw std::invalid_argument("expected an output row per query");
+    }
+    const auto& s = *impl;
+    const double max_sq = max_distance * max_distance;
+    const auto reach = static_cast<int32_t>(
+        std::max(1.0, std::ceil(max_distance / s.voxel_size)));
+    const double limit = std::numeric_limits<int32_t>::max() - reach;
+
+#ifdef __OUSTER_UTILIZE_OPENMP__
+#pragma omp parallel for schedule(static)
+#endif
+    for (Eigen::Index i = 0; i < n; ++i) {
+        const double* q = queries.row(i).data();
+        double best = std::numeric_limits<double>::infinity();
+        const float* nearest = nullptr;
+        double f[3];
+        for (int j = 0; j < 3; ++j) f[j] = std::floor(q[j] / s.voxel_size);
+        if (!(std::abs(f[0]) < limit && std::abs(f[1]) < limit &&
+              std::abs(f[2]) < limit)) {
+            distances(i) = best;
+            continue;
+        }
+        const auto vx = static_cast<int32_t>(f[0]);
+        const auto vy = static_cast<int32_t>(f[1]);
+        const auto vz = static_cast<int32_t>(f[2]);
+        for (int32_t dx = -reach; dx <= reach; ++dx) {
+            for (int32_t dy = -reach; dy <= reach; ++dy) {
+                for (int32_t dz = -reach; dz <= reach; ++dz) {
+                    const Slot* slot = s.find(vx + dx, vy + dy, vz + dz);
+                    if (!slot) continue;
+                    const float* p = s.points + 3 * slot->start;
+                    for (uint32_t k = 0; k < slot->count; ++k, p += 3) {
+                        const double ex = p[0] - q[0];
+                        const double ey = p[1] - q[1];
+                        const double ez = p[2] - q[2];
+                        const double d = ex * ex + ey * ey + ez * ez;
+                        if (d < best && d <= max_sq) {
+                            best = d;
+                            nearest = p;
+                        }
+                    }
+                }
+            }
+        }
+        if (nearest) {
+            neighbors(i, 0) = nearest[0];
+            neighbors(i, 1) = nearest[1];
+            neighbors(i, 2) = nearest[2];
+            distances(i) = std::sqrt(best);
+        } else {
+            distances(i) = best;
+        }
+    }
+}
+
+double VoxelMapIndex::voxel_size() const { return impl->voxel_size; }
+
+size_t VoxelMapIndex::size() const { return impl->count; }
+
+MapLocalizer::MapLocalizer(std::shared_ptr<const VoxelMapIndex> index,
+                           const mat4d& initial_pose,
+                           const MapLocalizerConfig& config)
+    : index_(std::move(index)),
+      config_(config),
+      pose_(initial_pose),
+      motion_(mat4d::Identity()),
+      correspondences_(0) {
+    if (!index_) throw std::invalid_argument("index must not be null");
+}
+
+mat4d MapLocalizer::update(const Eigen::Ref<const pose_util::Points>& points,
+                           const Eigen::Ref<const Eigen::ArrayXd>& times) {
+    return update(points, times, motion_);
+}
+
+mat4d MapLocalizer::update(const Eigen::Ref<const pose_util::Points>& points,
+                           const Eigen::Ref<const Eigen::ArrayXd>& times,
+                           const mat4d& motion) {
+    if (times.size() != 0 && times.size() != points.rows()) {
+        throw std::invalid_argument("expected a time per point");
+    }
+
+    // deskew to the middle of the scan with the motion prior
+    pose_util::Points source = points;
+    if (times.size() != 0) {
+        for (Eigen::Index i = 0; i < source.rows(); ++i) {
+            const Eigen::Matrix4d m = scale_motion(motion, times(i) - 0.5);
+            source.row(i) = (m.topLeftCorner<3, 3>() *
+                                 points.row(i).transpose() +
+                             m.topRightCorner<3, 1>())
+                                .transpose();
+        }
+    }
+    if (config_.voxel_size > 0) {
+        source = voxel_downsample(source, config_.voxel_size).points;
+    }
+
+    // point to point Gauss-Newton with a Geman-McClure kernel, updating the
+    // pose by a left perturbation
+    Eigen::Matrix4d pose = pose_ * motion;
+    const Eigen::Index n = source.rows();
+    pose_util::Points moved(n, 3);
+    pose_util::Points nearest(n, 3);
+    Eigen::ArrayXd distances(n);
+    const double kernel = config_.kernel_scale;
+    size_t count = 0;
+    for (int it = 0; it < config_.max_iterations; ++it) {
+        moved = (source * pose.topLeftCorner<3, 3>().transpose()).rowwise() +
+                pose.topRightCorner<3, 1>().transpose();
+        index_->nearest(moved, config_.max_correspondence_distance, nearest,
+                        distances);
+
+        Eigen::Matrix<double, 6, 6> jtj = Eigen::Matrix<double, 6, 6>::Zero();
+        Eigen::Matrix<double, 6, 1> jtr = Eigen::Matrix<double, 6, 1>::Zero();
+        count = 0;
+        for (Eigen::Index i = 0; i < n; ++i) {
+            if (!std::isfinite(distances(i))) continue;
+            const Eigen::Vector3d q = moved.row(i).transpose();
+            const Eigen::Vector3d r = q - nearest.row(i).transpose();
+            Eigen::Matrix<double, 3, 6> j;
+            j.leftCols<3>() = -skew(q);
+            j.rightCols<3>().setIdentity();
+            const double d = kernel + r.squaredNorm();
+            const double w = kernel * kernel / (d * d);
+            jtj.noalias() += w * j.transpose() * j;
+            jtr.noalias() += w * j.transpose() * r;
+            ++count;
+        }
+        if (count < 6) break;
+
+        const Eigen::Matrix<double, 6, 1> dx = jtj.ldlt().solve(-jtr);
+        Eigen::Matrix4d step = Eigen::Matrix4d::Identity();
+        const double angle = dx.head<3>().norm();
+        if (angle > 0) {
+            step.topLeftCorner<3, 3>() =
+                Eigen::AngleAxisd(angle, dx.head<3>() / angle)
+                    .toRotationMatrix();
+        }
+        step.topRightCorner<3, 1>() = dx.tail<3>();
+        pose = step * pose;
+        if (dx.norm() < config_.convergence) break;
+    }
+
+    motion_ = pose_.inverse() * pose;
+    pose_ = pose;
+    correspondences_ = count;
+    return pose_;
+}
+
+const mat4d& MapLocalizer::pose() const { return pose_; }
+
+void MapLocalizer::set_pose(const mat4d& pose) {
+    pose_ = pose;
+    motion_ = mat4d::Identity();
+}
+
+const mat4d& MapLocalizer::last_motion() const { return motion_; }
+
+size_t MapLocalizer::last_correspondences() const { return correspondences_; }
+
+}  // namespace ouster
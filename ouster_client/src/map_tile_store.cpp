@@ -0,0 +1,447 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/map_tile_store.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <list>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace ouster {
+
+namespace {
+
+// header: magic, version, levels, tile size, voxel size, index offset and
+// index count
+constexpr char magic[8] = {'O', 'U', 'S', 'T', 'M', 'A', 'P', 'S'};
+constexpr uint32_t format_version = 1;
+constexpr std::streamoff index_offset_pos = 32;
+constexpr uint64_t header_size = 48;
+constexpr double max_voxels_per_tile = 1 << 20;
+
+struct TileKeyHash {
+    size_t operator()(const TileKey& k) const {
+        uint64_t h = static_cast<uint32_t>(k.x);
+        h = h * 0x9E3779B97F4A7C15ULL ^ static_cast<uint32_t>(k.y);
+        h = h * 0x9E3779B97F4A7C15ULL ^ static_cast<uint32_t>(k.z);
+        return static_cast<size_t>(h ^ (h >> 29));
+    }
+};
+
+// voxel of a point, unique within a tile of at most 2^20 voxels on a side
+uint64_t voxel_key(const float* p, double voxel_size) {
+    uint64_t key = 0;
+    for (int j = 0; j < 3; ++j) {
+        const auto v = static_cast<int64_t>(std::floor(p[j] / voxel_size));
+        key = (key << 21) | (static_cast<uint64_t>(v) & 0x1FFFFF);
+    }
+    return key;
+}
+
+struct Tile {
+    // xyz of the points of each level of detail
+    std::vector<std::vector<float>> levels;
+    // occupied voxels of level 0
+    std::unordered_set<uint64_t> voxels;
+    // modified since last written
+    bool dirty = false;
+    // levels above 0 are up to date
+    bool pyramid = false;
+};
+
+template <typename T>
+void write_value(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+T read_value(std::istream& in) {
+    T value{};
+    in.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return value;
+}
+
+}  // namespace
+
+struct map_tile_store_impl {
+    using Cache = std::unordered_map<
+        TileKey, std::pair<Tile, std::list<TileKey>::iterator>, TileKeyHash>;
+
+    std::fstream file;
+    double tile_size = 0;
+    double voxel_size = 0;
+    int levels = 0;
+    size_t max_tiles = 0;
+
+    // where the next chunk goes
+    uint64_t end = header_size;
+    // offset of the latest chunk of every tile written
+    std::unordered_map<TileKey, uint64_t, TileKeyHash> index;
+    bool changed = false;
+
+    // tiles in memory, the most recently used first
+    std::list<TileKey> lru;
+    Cache cache;
+
+    void check(const char* what) {
+        if (file.fail()) throw std::runtime_error(what);
+    }
+
+    TileKey key_of(const float* p) const {
+        return {static_cast<int32_t>(std::floor(p[0] / tile_size)),
+                static_cast<int32_t>(std::floor(p[1] / tile_size)),
+                static_cast<int32_t>(std::floor(p[2] / tile_size))};
+    }
+
+    void build_pyramid(Tile& tile) const {
+        tile.levels.resize(levels);
+        double size = voxel_size;
+        for (int l = 1; l < levels; ++l) {
+            size *= 2;
+            const auto& src = tile.levels[l - 1];
+            auto& dst = tile.levels[l];
+            dst.clear();
+            std::unordered_set<uint64_t> seen;
+            for (size_t i = 0; i < src.size(); i += 3) {
+                if (seen.insert(voxel_key(&src[i], size)).second) {
+                    dst.insert(dst.end(), &src[i], &src[i] + 3);
+                }
+            }
+        }
+        tile.pyramid = true;
+    }
+
+    void write_chunk(const TileKey& key, Tile& tile) {
+        if (!tile.pyramid) build_pyramid(tile);
+        file.clear();
+        file.seekp(end);
+        write_value(file, key.x);
+        write_value(file, key.y);
+        write_value(file, key.z);
+        write_value(file, static_cast<uint32_t>(levels));
+        for (const auto& level : tile.levels) {
+            write_value(file, static_cast<uint64_t>(level.size() / 3));
+        }
+        uint64_t size = 16 + 8 * static_cast<uint64_t>(levels);
+        for (const auto& level : tile.levels) {
+            file.write(reinterpret_cast<const char*>(level.data()),
+                       level.size() * sizeof(float));
+            size += level.size() * sizeof(float);
+        }
+        check("failed writing map tile");
+        index[key] = end;
+        end += size;
+        tile.dirty = false;
+        changed = true;
+    }
+
+    // read the points of one level of a chunk, or of all levels
+    std::vector<std::vector<float>> read_chunk(uint64_t offset, int level) {
+        file.clear();
+        file.seekg(offset + 12);
+        const auto n = read_value<uint32_t>(file);
+        check("failed reading map tile");
+        if (static_cast<int>(n) != levels) {
+            throw std::runtime_error("corrupt map tile");
+        }
+        std::vector<uint64_t> counts(n);
+        for (auto& c : counts) c = read_value<uint64_t>(file);
+        check("failed reading map tile");
+
+        std::vector<std::vector<float>> result;
+        uint64_t skip = 0;
+        for (int l = 0; l < levels; ++l) {
+            if (level >= 0 && l != level) {
+                if (l < level) skip += counts[l] * 3 * sizeof(float);
+                continue;
+            }
+            if (skip) file.seekg(skip, std::ios::cur);
+            skip = 0;
+            result.emplace_back(counts[l] * 3);
+            file.read(reinterpret_cast<char*>(result.back().data()),
+                      result.back().size() * sizeof(float));
+        }
+        check("failed reading map tile");
+        return result;
+    }
+
+    // the tile of a key in memory, read or created if needed, or nullptr if
+    // the tile doesn't exist and create is false
+    Tile* get(const TileKey& key, bool create) {
+        auto it = cache.find(key);
+        if (it != cache.end()) {
+            lru.splice(lru.begin(), lru, it->second.second);
+            return &it->second.first;
+        }
+        Tile tile;
+        auto chunk = index.find(key);
+        if (chunk != index.end()) {
+            tile.levels = read_chunk(chunk->second, -1);
+            tile.pyramid = true;
+            const auto& points = tile.levels[0];
+            tile.voxels.reserve(points.size() / 3);
+            for (size_t i = 0; i < points.size(); i += 3) {
+                tile.voxels.insert(voxel_key(&points[i], voxel_size));
+            }
+        } else if (create) {
+            tile.levels.resize(1);
+        } else {
+            return nullptr;
+        }
+        lru.push_front(key);
+        auto& entry = cache[key];
+        entry = {std::move(tile), lru.begin()};
+
+        // write back the least recently used tiles, never the new one
+        while (cache.size() > max_tiles) {
+            const TileKey old = lru.back();
+            auto evicted = cache.find(old);
+            if (evicted->second.first.dirty) {
+                write_chunk(old, evicted->second.first);
+            }
+            cache.erase(evicted);
+            lru.pop_back();
+        }
+        return &entry.first;
+    }
+
+    void write_header() {
+        file.clear();
+        file.seekp(0);
+        file.write(magic, sizeof(magic));
+        write_value(file, format_version);
+        write_value(file, static_cast<uint32_t>(levels));
+        write_value(file, tile_size);
+        write_value(file, voxel_size);
+        write_value(file, static_cast<uint64_t>(0));
+        write_value(file, static_cast<uint64_t>(0));
+        check("failed writing map header");
+    }
+
+    void read_header() {
+        char m[sizeof(magic)];
+        file.read(m, sizeof(m));
+        const auto version = read_value<uint32_t>(file);
+        levels = static_cast<int>(read_value<uint32_t>(file));
+        tile_size = read_value<double>(file);
+        voxel_size = read_value<double>(file);
+        const auto index_offset = read_value<uint64_t>(file);
+        const auto index_count = read_value<uint64_t>(file);
+        if (file.fail() || std::memcmp(m, magic, sizeof(m)) != 0 ||
+            version != format_version || levels < 1 || !(tile_size > 0) ||
+            !(voxel_size > 0)) {
+            throw std::runtime_error("not a map tile store");
+        }
+        if (index_offset) {
+            file.seekg(index_offset);
+            for (uint64_t i = 0; i < index_count; ++i) {
+                TileKey key;
+                key.x = read_value<int32_t>(file);
+                key.y = read_value<int32_t>(file);
+                key.z = read_value<int32_t>(file);
+                read_value<uint32_t>(file);
+                index[key] = read_value<uint64_t>(file);
+            }
+            check("failed reading map index");
+        }
+        file.seekg(0, std::ios::end);
+        end = static_cast<uint64_t>(file.tellg());
+    }
+};
+
+MapTileStore::MapTileStore(const std::string& filename, double tile_size,
+                           double voxel_size, int levels, size_t max_tiles)
+    : impl(new map_tile_store_impl) {
+    if (!(tile_size > 0) || !(voxel_size > 0)) {
+        throw std::invalid_argument("tile and voxel sizes must be positive");
+    }
+    if (tile_size / voxel_size > max_voxels_per_tile) {
+        throw std::invalid_argument("too many voxels per tile");
+    }
+    if (levels < 1) {
+        throw std::invalid_argument("levels must be positive");
+    }
+    impl->tile_size = tile_size;
+    impl->voxel_size = voxel_size;
+    impl->levels = levels;
+    impl->max_tiles = std::max<size_t>(max_tiles, 1);
+    impl->file.open(filename, std::ios::in | std::ios::out |
+                                  std::ios::binary | std::ios::trunc);
+    if (!impl->file.is_open()) {
+        throw std::runtime_error("failed to open " + filename);
+    }
+    impl->write_header();
+}
+
+MapTileStore::MapTileStore(const std::string& filename, size_t max_tiles)
+    : impl(new map_tile_store_impl) {
+    impl->max_tiles = std::max<size_t>(max_tiles, 1);
+    impl->file.open(filename,
+                    std::ios::in | std::ios::out | std::ios::binary);
+    if (!impl->file.is_open()) {
+        throw std::runtime_error("failed to open " + filename);
+    }
+    impl->read_header();
+}
+
+MapTileStore::~MapTileStore() {
+    try {
+        flush();
+    } catch (...) {
+    }
+}
+
+void MapTileStore::append(const Eigen::Ref<const pose_util::Points>& points) {
+    Tile* tile = nullptr;
+    TileKey last{};
+    for (Eigen::Index i = 0; i < points.rows(); ++i) {
+        if (!points.row(i).allFinite()) continue;
+        // keys are computed from the stored precision
+        const float p[3] = {static_cast<float>(points(i, 0)),
+                            static_cast<float>(points(i, 1)),
+                            static_cast<float>(points(i, 2))};
+        const TileKey key = impl->key_of(p);
+        if (!tile || !(key == last)) {
+            tile = impl->get(key, true);
+            last = key;
+        }
+        if (tile->voxels.insert(voxel_key(p, impl->voxel_size)).second) {
+            tile->levels[0].insert(tile->levels[0].end(), p, p + 3);
+            tile->dirty = true;
+            tile->pyramid = false;
+        }
+    }
+}
+
+void MapTileStore::flush() {
+    auto& s = *impl;
+    if (!s.file.is_open()) return;
+    for (auto& entry : s.cache) {
+        if (entry.second.first.dirty) {
+            s.write_chunk(entry.first, entry.second.first);
+        }
+    }
+    if (!s.changed) return;
+
+    // the index goes after the chunks, and the header points to it last
+    const uint64_t index_offset = s.end;
+    s.file.clear();
+    s.file.seekp(index_offset);
+    for (const auto& chunk : s.index) {
+        write_value(s.file, chunk.first.x);
+        write_value(s.file, chunk.first.y);
+        write_value(s.file, chunk.first.z);
+        write_value(s.file, static_cast<uint32_t>(0));
+        write_value(s.file, chunk.second);
+    }
+    s.file.flush();
+    s.check("failed writing map index");
+    s.end += 24 * s.index.size();
+
+    s.file.seekp(index_offset_pos);
+    write_value(s.file, index_offset);
+    write_value(s.file, static_cast<uint64_t>(s.index.size()));
+    s.file.flush();
+    s.check("failed writing map header");
+    s.changed = false;
+}
+
+std::vector<TileKey> MapTileStore::tiles() const {
+    std::vector<TileKey> keys;
+    keys.reserve(impl->index.size() + impl->cache.size());
+    for (const auto& chunk : impl->index) keys.push_back(chunk.first);
+    for (const auto& entry : impl->cache) {
+        if (!impl->index.count(entry.first) &&
+            !entry.second.first.levels[0].empty()) {
+            keys.push_back(entry.first);
+        }
+    }
+    return keys;
+}
+
+std::vector<TileKey> MapTileStore::tiles_in(const Eigen::Vector3d& min,
+                                            const Eigen::Vector3d& max) const {
+    const Eigen::Vector3d lo = (min / impl->tile_size).array().floor();
+    const Eigen::Vector3d hi = (max / impl->tile_size).array().floor();
+    std::vector<TileKey> keys;
+    for (const auto& key : tiles()) {
+        if (key.x >= lo(0) && key.x <= hi(0) && key.y >= lo(1) &&
+            key.y <= hi(1) && key.z >= lo(2) && key.z <= hi(2)) {
+            keys.push_back(key);
+        }
+    }
+    return keys;
+}
+
+namespace {
+
+pose_util::Points to_points(const std::vector<const std::vector<float>*>& xyz) {
+    size_t n = 0;
+    for (const auto* v : xyz) n += v->size() / 3;
+    pose_util::Points points(n, 3);
+    size_t row = 0;
+    for (const auto* v : xyz) {
+        const size_t m = v->size() / 3;
+        points.middleRows(row, m) =
+            Eigen::Map<const Eigen::Matrix<float, Eigen::Dynamic, 3,
+                                           Eigen::RowMajor>>(v->data(), m, 3)
+                .cast<double>();
+        row += m;
+    }
+    return points;
+}
+
+}  // namespace
+
+pose_util::Points MapTileStore::tile_points(const TileKey& key, int level) {
+    if (level < 0 || level >= impl->levels) {
+        throw std::invalid_argument("level out of range");
+    }
+    Tile* tile = impl->get(key, false);
+    if (!tile) return pose_util::Points(0, 3);
+    if (level > 0 && !tile->pyramid) impl->build_pyramid(*tile);
+    return to_points({&tile->levels[level]});
+}
+
+pose_util::Points MapTileStore::query(const Eigen::Vector3d& min,
+                                      const Eigen::Vector3d& max, int level) {
+    if (level < 0 || level >= impl->levels) {
+        throw std::invalid_argument("level out of range");
+    }
+    // keeps the tiles read from the file alive until copied
+    std::vector<std::vector<float>> read;
+    std::vector<const std::vector<float>*> xyz;
+    const auto keys = tiles_in(min, max);
+    read.reserve(keys.size());
+    for (const auto& key : keys) {
+        auto it = impl->cache.find(key);
+        if (it != impl->cache.end()) {
+            Tile& tile = it->second.first;
+            if (level > 0 && !tile.pyramid) impl->build_pyramid(tile);
+            xyz.push_back(&tile.levels[level]);
+        } else {
+            read.push_back(
+                std::move(impl->read_chunk(impl->index.at(key), level)[0]));
+            xyz.push_back(&read.back());
+        }
+    }
+    return to_points(xyz);
+}
+
+double MapTileStore::tile_size() const { return impl->tile_size; }
+
+double MapTileStore::voxel_size() const { return impl->voxel_size; }
+
+int MapTileStore::levels() const { return impl->levels; }
+
+size_t MapTileStore::tiles_in_memory() const { return impl->cache.size(); }
+
+}  // namespace ouster
@@ -0,0 +1,204 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/memory_resource.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace ouster {
+
+namespace {
+
+constexpr size_t block_alignment = 64;
+
+class HeapMemory : public MemoryResource {
+   public:
+    void* allocate(size_t bytes) override {
+        void* ptr = nullptr;
+#ifdef _WIN32
+        ptr = _aligned_malloc(bytes ? bytes : 1, block_alignment);
+#else
+        if (posix_memalign(&ptr, block_alignment, bytes ? bytes : 1) != 0) {
+            ptr = nullptr;
+        }
+#endif
+        if (!ptr) throw std::bad_alloc();
+        return ptr;
+    }
+
+    void deallocate(void* ptr, size_t) override {
+#ifdef _WIN32
+        _aligned_free(ptr);
+#else
+        free(ptr);
+#endif
+    }
+};
+
+size_t round_up(size_t bytes, size_t multiple) {
+    return (std::max<size_t>(bytes, 1) + multiple - 1) / multiple * multiple;
+}
+
+#ifdef __linux__
+
+// from linux/mempolicy.h and linux/mman.h, which aren't always installed
+constexpr int mpol_preferred = 1;
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+size_t page_size() {
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+void* map_anonymous(size_t bytes, int extra_flags) {
+    void* ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | extra_flags, -1, 0);
+    return ptr == MAP_FAILED ? nullptr : ptr;
+}
+
+int log2_of(size_t value) {
+    int log = 0;
+    while (value > 1) {
+        value >>= 1;
+        log++;
+    }
+    return log;
+}
+
+#endif
+
+}  // namespace
+
+MemoryResource::~MemoryResource() = default;
+
+std::shared_ptr<MemoryResource> heap_memory() {
+    static const auto heap = std::make_shared<HeapMemory>();
+    return heap;
+}
+
+HugePageMemory::HugePageMemory(HugePageMode mode, size_t huge_page_size)
+    : mode_(mode), huge_page_size_(huge_page_size) {
+    if (huge_page_size == 0 || (huge_page_size & (huge_page_size - 1))) {
+        throw std::invalid_argument(
+            "HugePageMemory: huge page size must be a power of two");
+    }
+}
+
+void* HugePageMemory::allocate(size_t bytes) {
+#ifdef __linux__
+    const size_t size = round_up(bytes, huge_page_size_);
+    if (mode_ == HugePageMode::RESERVED) {
+        void* ptr = map_anonymous(
+            size, MAP_HUGETLB | (log2_of(huge_page_size_) << MAP_HUGE_SHIFT));
+        if (ptr) return ptr;
+        fallbacks_++;
+    }
+    void* ptr = map_anonymous(size, 0);
+    if (!ptr) throw std::bad_alloc();
+    // e.g. EINVAL when transparent huge pages are disabled; the memory is
+    // still usable with regular pages
+    if (madvise(ptr, size, MADV_HUGEPAGE) != 0 &&
+        mode_ == HugePageMode::TRANSPARENT) {
+        fallbacks_++;
+    }
+    return ptr;
+#else
+    fallbacks_++;
+    return heap_memory()->allocate(bytes);
+#endif
+}
+
+void HugePageMemory::deallocate(void* ptr, size_t bytes) {
+    if (!ptr) return;
+#ifdef __linux__
+    munmap(ptr, round_up(bytes, huge_page_size_));
+#else
+    heap_memory()->deallocate(ptr, bytes);
+#endif
+}
+
+size_t HugePageMemory::fallbacks() const { return fallbacks_; }
+
+NumaLocalMemory::NumaLocalMemory(int node, bool huge_pages)
+    : node_(node), huge_pages_(huge_pages) {}
+
+void* NumaLocalMemory::allocate(size_t bytes) {
+#ifdef __linux__
+    const size_t size =
+        round_up(bytes, huge_pages_ ? size_t{2} << 20 : page_size());
+    void* ptr = map_anonymous(size, 0);
+    if (!ptr) throw std::bad_alloc();
+    if (huge_pages_) madvise(ptr, size, MADV_HUGEPAGE);
+
+    // binding before the pages are touched places them on the node as they
+    // are first written; preferred rather than bound so that a full node
+    // falls back to the others instead of failing
+    const int node = node_ < 0 ? current_numa_node() : node_;
+    unsigned long mask[16] = {0};
+    const size_t bits_per_word = sizeof(mask[0]) * 8;
+    const size_t bits = sizeof(mask) * 8;
+    if (static_cast<size_t>(node) >= bits) {
+        fallbacks_++;
+        return ptr;
+    }
+    mask[node / bits_per_word] |= 1UL << (node % bits_per_word);
+    if (syscall(SYS_mbind, ptr, size, mpol_preferred, mask, bits, 0) != 0) {
+        fallbacks_++;
+    }
+    return ptr;
+#else
+    fallbacks_++;
+    return heap_memory()->allocate(bytes);
+#endif
+}
+
+void NumaLocalMemory::deallocate(void* ptr, size_t bytes) {
+    if (!ptr) return;
+#ifdef __linux__
+    munmap(ptr, round_up(bytes, huge_pages_ ? size_t{2} << 20 : page_size()));
+#else
+    heap_memory()->deallocate(ptr, bytes);
+#endif
+}
+
+size_t NumaLocalMemory::fallbacks() const { return fallbacks_; }
+
+int current_numa_node() {
+#ifdef __linux__
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+        return static_cast<int>(node);
+    }
+#endif
+    return 0;
+}
+
+LidarScan::ArenaAllocator arena_allocator(
+    std::shared_ptr<MemoryResource> memory) {
+    if (!memory) memory = heap_memory();
+    return [memory](size_t bytes) {
+        auto* ptr = static_cast<uint8_t*>(memory->allocate(bytes));
+        return std::shared_ptr<uint8_t>(
+            ptr, [memory, bytes](uint8_t* p) { memory->deallocate(p, bytes); });
+    };
+}
+
+}  // namespace ouster
@@ -195,6 +195,136 @@ class MetadataImpl {
         severity.push_back(entry);
     }
 
+    /**
+     * Finds the values at a json path like jsoncons::jsonpath::json_query,
+     * walking the document directly for the simple paths used to parse
+     * metadata: names, quoted names, indices and a trailing wildcard, e.g.
+     * $.a.'b-c'.d, $['a'][0] or $.a.*. Compiling and evaluating every path
+     * as jsonpath dominated the time to parse metadata.
+     *
+     * @param[in] path The path to query.
+     * @param[in] callback Called with the normalized path and the value of
+     *     each match, like json_query.
+     *
+     * @return false if the path isn't a simple path, without any match.
+     */
+    template <typename F>
+    bool walk_path(const std::string& path, F&& callback) const {
+        if (path.empty() || path[0] != '$') return false;
+        const jsoncons::json* node = &root;
+        std::string normalized = "$";
+        size_t i = 1;
+        bool found = true;
+        while (i < path.size()) {
+            std::string name;
+            bool is_index = false;
+            bool is_wildcard = false;
+            if (path[i] == '.') {
+                i++;
+                if (i < path.size() && path[i] == '*') {
+                    is_wildcard = true;
+                    i++;
+                } else if (i < path.size() && path[i] == '\'') {
+                    auto end = path.find('\'', i + 1);
+                    if (end == std::string::npos) return false;
+                    name = path.substr(i + 1, end - i - 1);
+                    i = end + 1;
+                } else {
+                    auto end = path.find_first_of(".[", i);
+                    if (end == std::string::npos) end = path.size();
+                    name = path.substr(i, end - i);
+                    i = end;
+                }
+            } else if (path[i] == '[') {
+                auto end = path.find(']', i);
+                if (end == std::string::npos) return false;
+                auto token = path.substr(i + 1, end - i - 1);
+                i = end + 1;
+                if (token == "*") {
+                    is_wildcard = true;
+                } else if (token.size() >= 2 && token.front() == '\'' &&
+                           token.back() == '\'') {
+                    name = token.substr(1, token.size() - 2);
+                } else if (!token.empty() &&
+                           token.find_first_not_of("0123456789") ==
+                               std::string::npos) {
+                    name = token;
+                    is_index = true;
+                } else {
+                    return false;
+                }
+            } else {
+                return false;
+            }
+
+            if (is_wildcard) {
+                if (i != path.size()) return false;
+                if (!found) return true;
+                if (node->is_array()) {
+                    for (size_t k = 0; k < node->size(); k++) {
+                        callback(normalized + "[" + std::to_string(k) + "]",
+                                 (*node)[k]);
+                    }
+                } else if (node->is_object()) {
+                    for (const auto& member : node->object_range()) {
+                        callback(normalized + "['" + member.key() + "']",
+                                 member.value());
+                    }
+                }
+                return true;
+            }
+            if (!is_index && name.empty()) return false;
+            if (!found) continue;  // keep checking the rest is simple
+
+            if (is_index) {
+                size_t index = std::stoul(name);
+                if (node->is_array() && index < node->size()) {
+                    node = &node->at(index);
+                    normalized += "[" + name + "]";
+                } else {
+                    found = false;
+                }
+            } else if (node->is_object() && node->contains(name)) {
+                node = &node->at(name);
+                normalized += "['" + name + "']";
+            } else {
+                found = false;
+            }
+        }
+        if (found) callback(normalized, *node);
+        return true;
+    }
+
+    /**
+     * Finds the values at a json path, see walk_path().
+     *
+     * @param[in] path The path to query.
+     * @param[in] callback Called with the normalized path and the value of
+     *     each match.
+     */
+    template <typename F>
+    void query(const std::string& path, F&& callback) const {
+        if (!walk_path(path, callback)) {
+            jsoncons::jsonpath::json_query(root, path, callback);
+        }
+    }
+
+    /**
+     * Finds the values at a json path, see walk_path().
+     *
+     * @param[in] path The path to query.
+     *
+     * @return An array of the matched values.
+     */
+    jsoncons::json query(const std::string& path) const {
+        jsoncons::json matches(jsoncons::json_array_arg);
+        bool simple = walk_path(
+            path, [&](const std::string&, const jsoncons::json& value) {
+                matches.push_back(value);
+            });
+        return simple ? matches : jsoncons::jsonpath::json_query(root, path);
+    }
+
     /**
      * Utility function to test if a json path exists in the json data.
      *
@@ -203,7 +333,7 @@ class MetadataImpl {
      * @return If the json path exists in the json data.
      */
     bool path_exists(const std::string& path) {
-        return (jsoncons::jsonpath::json_query(root, path).size() > 0);
+        return query(path).size() > 0;
     }
 
     /**
@@ -375,7 +505,7 @@ class MetadataImpl {
                                  const std::string& path, T& output,
                                  F verification_callback,
                                  bool relaxed_number_verification = false) {
-        jsoncons::json value_array = jsoncons::jsonpath::json_query(root, path);
+        jsoncons::json value_array = query(path);
         if (value_array.size() == 1) {
             jsoncons::json value = value_array[0];
             if (value.is<T>() ||
@@ -532,7 +662,7 @@ class MetadataImpl {
             shadow_output.push_back(data);
             index++;
         };
-        jsoncons::jsonpath::json_query(root, path, parse_callback);
+        query(path, parse_callback);
         bool result = (index == matches && matches > 0);
         if (verify_count > 0 && matches != verify_count) {
             std::stringstream errorMessage;
@@ -589,7 +719,7 @@ class MetadataImpl {
             shadow_output.push_back(data);
             index++;
         };
-        jsoncons::jsonpath::json_query(root, path, parse_callback);
+        query(path, parse_callback);
         bool result = (index == matches && matches > 0);
         if (verify_count > 0 && matches != verify_count) {
             std::stringstream errorMessage;
@@ -1189,7 +1319,7 @@ class MetadataImpl {
     void parse_and_validate_angles(const std::string& path,
                                    std::vector<double>& output, size_t width,
                                    size_t height) {
-        jsoncons::json value_array = jsoncons::jsonpath::json_query(root, path);
+        jsoncons::json value_array = query(path);
         jsoncons::json angles;
         if (value_array.size() > 0) {
             angles = value_array[0];
@@ -0,0 +1,347 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace ouster {
+namespace sensor {
+
+namespace {
+
+bool valid_name(const std::string& name) {
+    if (name.empty()) return false;
+    for (size_t i = 0; i < name.size(); i++) {
+        const char c = name[i];
+        const bool alpha =
+            (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+        if (!alpha && c != ':' && !(i > 0 && c >= '0' && c <= '9')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string escape(const std::string& s, bool quotes) {
+    std::string out;
+    out.reserve(s.size());
+    for (char c : s) {
+        if (c == '\\') {
+            out += "\\\\";
+        } else if (c == '\n') {
+            out += "\\n";
+        } else if (c == '"' && quotes) {
+            out += "\\\"";
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+// counts are written exactly, other values in the shortest of 15 or 17
+// digits that reads back the same
+std::string format_value(double value) {
+    if (std::isnan(value)) return "NaN";
+    if (std::isinf(value)) return value > 0 ? "+Inf" : "-Inf";
+    char buf[32];
+    if (value == std::floor(value) && std::fabs(value) < 9007199254740992.0) {
+        std::snprintf(buf, sizeof(buf), "%.0f", value);
+        return buf;
+    }
+    std::snprintf(buf, sizeof(buf), "%.15g", value);
+    if (std::strtod(buf, nullptr) != value) {
+        std::snprintf(buf, sizeof(buf), "%.17g", value);
+    }
+    return buf;
+}
+
+std::string sample(const std::string& name, const MetricLabels& labels,
+                   double value) {
+    std::string out = name;
+    if (!labels.empty()) {
+        out += '{';
+        for (size_t i = 0; i < labels.size(); i++) {
+            if (!valid_name(labels[i].first)) {
+                throw std::invalid_argument("Invalid metric label name: " +
+                                            labels[i].first);
+            }
+            if (i) out += ',';
+            out += labels[i].first + "=\"" + escape(labels[i].second, true) +
+                   '"';
+        }
+        out += '}';
+    }
+    return out + ' ' + format_value(value);
+}
+
+MetricLabels with(const MetricLabels& labels, const std::string& name,
+                  const std::string& value) {
+    MetricLabels out = labels;
+    out.emplace_back(name, value);
+    return out;
+}
+
+// per sensor counters of stats built by hand may be short
+double count_at(const std::vector<uint64_t>& counts, size_t i) {
+    return i < counts.size() ? static_cast<double>(counts[i]) : 0;
+}
+
+constexpr double ns_per_s = 1e9;
+
+}  // namespace
+
+constexpr const char* OpenMetrics::content_type;
+
+OpenMetrics::Family& OpenMetrics::family(const std::string& name,
+                                         const char* type,
+                                         const std::string& help) {
+    if (!valid_name(name)) {
+        throw std::invalid_argument("Invalid metric name: " + name);
+    }
+    for (auto& f : families_) {
+        if (f.name != name) continue;
+        if (f.type != type) {
+            throw std::invalid_argument("Metric " + name + " is a " + f.type +
+                                        ", not a " + type);
+        }
+        return f;
+    }
+    families_.push_back({name, type, help, {}});
+    return families_.back();
+}
+
+void OpenMetrics::counter(const std::string& name, const std::string& help,
+                          double value, const MetricLabels& labels) {
+    family(name, "counter", help)
+        .samples.push_back(sample(name + "_total", labels, value));
+}
+
+void OpenMetrics::gauge(const std::string& name, const std::string& help,
+                        double value, const MetricLabels& labels) {
+    family(name, "gauge", help).samples.push_back(sample(name, labels, value));
+}
+
+void OpenMetrics::summary(const std::string& name, const std::string& help,
+                          const LatencyStats& stats,
+                          const MetricLabels& labels) {
+    auto& f = family(name, "summary", help);
+    const std::pair<const char*, uint64_t> quantiles[] = {
+        {"0.5", stats.p50},
+        {"0.9", stats.p90},
+        {"0.99", stats.p99},
+        {"0.999", stats.p999}};
+    for (const auto& q : quantiles) {
+        f.samples.push_back(sample(name, with(labels, "quantile", q.first),
+                                   q.second / ns_per_s));
+    }
+    f.samples.push_back(sample(name + "_sum", labels,
+                               stats.mean * stats.count / ns_per_s));
+    f.samples.push_back(
+        sample(name + "_count", labels, static_cast<double>(stats.count)));
+}
+
+std::string OpenMetrics::str() const {
+    std::string out;
+    for (const auto& f : families_) {
+        out += "# TYPE " + f.name + ' ' + f.type + '\n';
+        if (!f.help.empty()) {
+            out += "# HELP " + f.name + ' ' + escape(f.help, false) + '\n';
+        }
+        for (const auto& s : f.samples) {
+            out += s + '\n';
+        }
+    }
+    return out + "# EOF\n";
+}
+
+void add_metrics(OpenMetrics& metrics, const ScanSourceStats& stats,
+                 const std::vector<sensor_info>& infos,
+                 const MetricLabels& labels) {
+    const size_t sensors =
+        std::max(stats.batched_packets.size(), stats.missing_frames.size());
+    for (size_t i = 0; i < sensors; i++) {
+        // fall back to the index for sensors without a serial number
+        const std::string sn = i < infos.size() && infos[i].sn
+                                   ? std::to_string(infos[i].sn)
+                                   : std::to_string(i);
+        const auto sensor = with(labels, "sensor", sn);
+        metrics.counter("ouster_lidar_packets", "Lidar packets batched",
+                        count_at(stats.batched_packets, i), sensor);
+        metrics.counter("ouster_scans", "Scans batched",
+                        count_at(stats.batched_scans, i), sensor);
+        metrics.counter(
+            "ouster_incomplete_scans",
+            "Scans batched with columns missing from their column window",
+            count_at(stats.incomplete_scans, i), sensor);
+        metrics.counter("ouster_missing_frames",
+                        "Frames skipped according to the scan frame ids",
+                        count_at(stats.missing_frames, i), sensor);
+    }
+    metrics.counter("ouster_id_errors",
+                    "Lidar packets not matching the sensor metadata",
+                    static_cast<double>(stats.id_errors), labels);
+    metrics.counter("ouster_dropped_scans",
+                    "Scans dropped because the scan queue was full",
+                    static_cast<double>(stats.dropped_scans), labels);
+    metrics.gauge("ouster_scan_queue_depth", "Scans waiting in the queue",
+                  static_cast<double>(stats.queue_depth), labels);
+    metrics.gauge("ouster_scan_queue_max_depth",
+                  "Most scans waiting in the queue at once",
+                  static_cast<double>(stats.max_queue_depth), labels);
+    if (stats.batch_latency.count) {
+        metrics.summary("ouster_scan_batch_latency_seconds",
+                        "Time from the last packet of a scan until queued",
+                        stats.batch_latency, labels);
+    }
+    if (stats.queue_latency.count) {
+        metrics.summary("ouster_scan_queue_latency_seconds",
+                        "Time scans waited in the queue", stats.queue_latency,
+                        labels);
+    }
+    if (stats.scan_latency.count) {
+        metrics.summary(
+            "ouster_scan_latency_seconds",
+            "Time from the last packet of a scan until handed to the consumer",
+            stats.scan_latency, labels);
+    }
+    for (size_t i = 0; i < stats.clients.size(); i++) {
+        const auto client = with(labels, "client", std::to_string(i));
+        add_metrics(metrics, stats.clients[i], client);
+        if (i < stats.batch_thread_cpu_seconds.size() &&
+            stats.batch_thread_cpu_seconds[i] >= 0) {
+            metrics.counter("ouster_batch_thread_cpu_seconds",
+                            "CPU time of the receive and batch thread",
+                            stats.batch_thread_cpu_seconds[i], client);
+        }
+    }
+}
+
+void add_metrics(OpenMetrics& metrics, const ClientStats& stats,
+                 const MetricLabels& labels) {
+    metrics.counter("ouster_buffer_dropped_packets",
+                    "Packets dropped because the packet buffer was full",
+                    static_cast<double>(stats.buffer_dropped_packets), labels);
+    if (stats.kernel_dropped_packets >= 0) {
+        metrics.counter("ouster_kernel_dropped_packets",
+                        "Datagrams dropped by the kernel",
+                        static_cast<double>(stats.kernel_dropped_packets),
+                        labels);
+    }
+    metrics.gauge("ouster_packet_buffer_depth",
+                  "Packets waiting in the packet buffer",
+                  static_cast<double>(stats.buffer_depth), labels);
+    metrics.gauge("ouster_packet_buffer_max_depth",
+                  "Most packets waiting in the packet buffer at once",
+                  static_cast<double>(stats.max_buffer_depth), labels);
+    if (stats.delivery_latency.count) {
+        metrics.summary(
+            "ouster_packet_delivery_latency_seconds",
+            "Time from the host timestamp of a packet until handed over",
+            stats.delivery_latency, labels);
+    }
+    if (stats.buffer_thread_cpu_seconds >= 0) {
+        metrics.counter("ouster_buffer_thread_cpu_seconds",
+                        "CPU time of the packet buffering thread",
+                        stats.buffer_thread_cpu_seconds, labels);
+    }
+}
+
+void add_metrics(OpenMetrics& metrics, const PacketStreamStats& stats,
+                 const MetricLabels& labels) {
+    auto count = [&](const char* name, const char* help, uint64_t value) {
+        metrics.counter(name, help, static_cast<double>(value), labels);
+    };
+    count("ouster_stream_lidar_packets", "Lidar packets analyzed",
+          stats.lidar_packets);
+    count("ouster_stream_imu_packets", "IMU packets analyzed",
+          stats.imu_packets);
+    count("ouster_stream_invalid_packets",
+          "Packets not matching the sensor metadata", stats.invalid_packets);
+    count("ouster_stream_frames", "Frames completed", stats.frames);
+    count("ouster_stream_incomplete_frames", "Frames with columns missing",
+          stats.incomplete_frames);
+    count("ouster_stream_missing_columns",
+          "Columns of the column window missing from frames",
+          stats.missing_columns);
+    count("ouster_stream_missing_frames",
+          "Frames skipped according to the packet frame ids",
+          stats.missing_frames);
+    count("ouster_stream_late_packets",
+          "Packets of frames already completed", stats.late_packets);
+    count("ouster_stream_reordered_packets",
+          "Packets arriving after later columns of their frame",
+          stats.reordered_packets);
+    count("ouster_stream_duplicate_columns",
+          "Columns received more than once in a frame",
+          stats.duplicate_columns);
+    count("ouster_stream_timestamp_regressions",
+          "Columns not timestamped after the previous column",
+          stats.timestamp_regressions);
+    count("ouster_stream_reinits", "Reinitializations of the sensor",
+          stats.reinits);
+    metrics.gauge("ouster_stream_lidar_packet_rate",
+                  "Lidar packets per second over the last second",
+                  stats.lidar_rate, labels);
+    metrics.gauge("ouster_stream_expected_lidar_packet_rate",
+                  "Lidar packets per second the sensor sends",
+                  stats.expected_lidar_rate, labels);
+    metrics.gauge("ouster_stream_imu_packet_rate",
+                  "IMU packets per second over the last second",
+                  stats.imu_rate, labels);
+    if (stats.lidar_jitter.count) {
+        metrics.summary("ouster_stream_lidar_jitter_seconds",
+                        "Deviation of lidar packet arrivals from their period",
+                        stats.lidar_jitter, labels);
+    }
+    if (stats.imu_jitter.count) {
+        metrics.summary("ouster_stream_imu_jitter_seconds",
+                        "Deviation of IMU packet arrivals from their period",
+                        stats.imu_jitter, labels);
+    }
+}
+
+void add_metrics(OpenMetrics& metrics, const std::vector<StageStats>& stats,
+                 const MetricLabels& labels) {
+    for (const auto& s : stats) {
+        const auto stage = with(labels, "stage", s.name);
+        auto count = [&](const char* name, const char* help, uint64_t value) {
+            metrics.counter(name, help, static_cast<double>(value), stage);
+        };
+        count("ouster_pipeline_items_in",
+              "Items processed by the stage, or produced by the source",
+              s.items_in);
+        count("ouster_pipeline_items_out", "Items passed on by the stage",
+              s.items_out);
+        count("ouster_pipeline_dropped",
+              "Items dropped from the full input queue of the stage",
+              s.dropped);
+        count("ouster_pipeline_stalls",
+              "Times the stage was held up by a full queue downstream",
+              s.stalls);
+        metrics.gauge("ouster_pipeline_queue_depth",
+                      "Items waiting in the input queue of the stage",
+                      static_cast<double>(s.queue_depth), stage);
+        metrics.gauge("ouster_pipeline_max_queue_depth",
+                      "Most items waiting in the input queue of the stage",
+                      static_cast<double>(s.max_queue_depth), stage);
+        metrics.counter("ouster_pipeline_busy_seconds",
+                        "Time spent in the function of the stage",
+                        s.busy_seconds, stage);
+        if (s.latency.count) {
+            metrics.summary("ouster_pipeline_latency_seconds",
+                            "Time the stage took for each item", s.latency,
+                            stage);
+        }
+    }
+}
+
+}  // namespace sensor
+}  // namespace ouster
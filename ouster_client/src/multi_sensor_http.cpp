@@ -0,0 +1,132 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include <curl/curl.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "curl_client.h"
+#include "ouster/sensor_http.h"
+
+namespace ouster {
+namespace sensor {
+namespace util {
+
+struct multi_sensor_http_impl {
+    CURLM* multi = nullptr;
+    std::vector<CURL*> handles;
+    std::vector<std::string> base_urls;
+    std::vector<std::string> buffers;
+
+    ~multi_sensor_http_impl() {
+        for (auto handle : handles) curl_easy_cleanup(handle);
+        if (multi) curl_multi_cleanup(multi);
+    }
+
+    static size_t write_callback(void* contents, size_t element_size,
+                                 size_t elements_count, void* user_pointer) {
+        size_t size = element_size * elements_count;
+        static_cast<std::string*>(user_pointer)
+            ->append(static_cast<const char*>(contents), size);
+        return size;
+    }
+};
+
+MultiSensorHttp::MultiSensorHttp(const std::vector<std::string>& hostnames)
+    : hostnames_(hostnames), impl(new multi_sensor_http_impl) {
+    CurlClient::global_init();
+    impl->multi = curl_multi_init();
+    if (!impl->multi) {
+        throw std::runtime_error("MultiSensorHttp: curl_multi_init failed");
+    }
+    // sensors serve HTTP/1.1, so keep exactly one connection to each open
+    curl_multi_setopt(impl->multi, CURLMOPT_MAX_HOST_CONNECTIONS, 1L);
+    curl_multi_setopt(impl->multi, CURLMOPT_MAXCONNECTS,
+                      static_cast<long>(hostnames.size()));
+
+    // the buffers are sized first so that their addresses don't change
+    impl->buffers.resize(hostnames.size());
+    for (size_t i = 0; i < hostnames.size(); i++) {
+        const auto& hostname = hostnames[i];
+        // Properly escape URLs that look like IPv6 addresses (2 or more :'s)
+        impl->base_urls.push_back(
+            std::count(hostname.begin(), hostname.end(), ':') >= 2
+                ? "[" + hostname + "]"
+                : hostname);
+
+        CURL* handle = curl_easy_init();
+        if (!handle) {
+            throw std::runtime_error("MultiSensorHttp: curl_easy_init failed");
+        }
+        impl->handles.push_back(handle);
+        curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION,
+                         &multi_sensor_http_impl::write_callback);
+        curl_easy_setopt(handle, CURLOPT_WRITEDATA, &impl->buffers[i]);
+        curl_easy_setopt(handle, CURLOPT_PRIVATE, &impl->buffers[i]);
+        curl_easy_setopt(handle, CURLOPT_DEFAULT_PROTOCOL, "http");
+        curl_easy_setopt(handle, CURLOPT_HTTPGET, 1L);
+        curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+    }
+}
+
+MultiSensorHttp::~MultiSensorHttp() = default;
+
+std::vector<HttpResponse> MultiSensorHttp::get(const std::string& url,
+                                               int timeout_sec) {
+    const size_t n = impl->handles.size();
+    for (size_t i = 0; i < n; i++) {
+        impl->buffers[i].clear();
+        const auto full_url = CurlClient::url_combine(impl->base_urls[i], url);
+        curl_easy_setopt(impl->handles[i], CURLOPT_URL, full_url.c_str());
+        curl_easy_setopt(impl->handles[i], CURLOPT_TIMEOUT,
+                         static_cast<long>(timeout_sec));
+        curl_multi_add_handle(impl->multi, impl->handles[i]);
+    }
+
+    // drive every transfer from this thread until all of them are done
+    int running = 0;
+    CURLMcode code = curl_multi_perform(impl->multi, &running);
+    while (code == CURLM_OK && running) {
+        code = curl_multi_wait(impl->multi, nullptr, 0, 100, nullptr);
+        if (code == CURLM_OK) code = curl_multi_perform(impl->multi, &running);
+    }
+
+    std::vector<HttpResponse> responses(n);
+    int pending = 0;
+    while (CURLMsg* msg = curl_multi_info_read(impl->multi, &pending)) {
+        if (msg->msg != CURLMSG_DONE) continue;
+        std::string* buffer = nullptr;
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &buffer);
+        auto& response = responses[buffer - impl->buffers.data()];
+        if (msg->data.result != CURLE_OK) {
+            response.error = curl_easy_strerror(msg->data.result);
+            continue;
+        }
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_RESPONSE_CODE,
+                          &response.status);
+        response.body = std::move(*buffer);
+    }
+
+    // removed handles leave their connections in the cache of the multi
+    // handle, to be reused by the next request
+    for (auto handle : impl->handles) {
+        curl_multi_remove_handle(impl->multi, handle);
+    }
+
+    if (code != CURLM_OK) {
+        throw std::runtime_error(std::string("MultiSensorHttp::get failed: ") +
+                                 curl_multi_strerror(code));
+    }
+    return responses;
+}
+
+const std::vector<std::string>& MultiSensorHttp::hostnames() const {
+    return hostnames_;
+}
+
+}  // namespace util
+}  // namespace sensor
+}  // namespace ouster
@@ -22,6 +22,21 @@
 
 #endif
 
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <ifaddrs.h>
+#include <linux/net_tstamp.h>
+#include <linux/sockios.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include <fstream>
+#include <sstream>
+#endif
+
 namespace ouster {
 namespace sensor {
 namespace impl {
@@ -113,6 +128,249 @@ int socket_set_rcvtimeout(SOCKET sock, int timeout_sec) {
 #endif
 }
 
+int socket_set_rcvbuf(SOCKET sock, int bytes) {
+    if (setsockopt(sock, SOL_SOCKET, SO_RCVBUF, (const char*)&bytes,
+                   sizeof(bytes))) {
+        return SOCKET_ERROR;
+    }
+    int actual = 0;
+    socklen_t len = sizeof(actual);
+    if (getsockopt(sock, SOL_SOCKET, SO_RCVBUF, (char*)&actual, &len)) {
+        return SOCKET_ERROR;
+    }
+#ifdef __linux__
+    // the kernel doubles the requested size for bookkeeping, anything less
+    // means it was capped by rmem_max
+    if (actual < 2 * bytes &&
+        setsockopt(sock, SOL_SOCKET, SO_RCVBUFFORCE, &bytes, sizeof(bytes)) ==
+            0) {
+        getsockopt(sock, SOL_SOCKET, SO_RCVBUF, &actual, &len);
+    }
+#endif
+    return actual;
+}
+
+int64_t socket_get_drops(SOCKET sock) {
+#ifdef __linux__
+    struct stat st;
+    if (fstat(sock, &st)) {
+        return -1;
+    }
+    // columns: sl local rem st tx:rx tr:when retrnsmt uid timeout inode ref
+    // pointer drops
+    for (const char* path : {"/proc/net/udp", "/proc/net/udp6"}) {
+        std::ifstream file(path);
+        std::string line;
+        std::getline(file, line);  // header
+        while (std::getline(file, line)) {
+            std::istringstream fields(line);
+            std::string skip;
+            unsigned long inode = 0;
+            int64_t drops = 0;
+            for (int i = 0; i < 9; i++) fields >> skip;
+            fields >> inode >> skip >> skip >> drops;
+            if (fields && inode == st.st_ino) {
+                return drops;
+            }
+        }
+    }
+    return -1;
+#else
+    (void)sock;
+    return -1;
+#endif
+}
+
+int socket_set_busy_poll(SOCKET sock, int usec) {
+#ifdef __linux__
+    return setsockopt(sock, SOL_SOCKET, SO_BUSY_POLL, &usec, sizeof(usec));
+#else
+    (void)sock;
+    (void)usec;
+    return SOCKET_ERROR;
+#endif
+}
+
+#ifdef __linux__
+// name of the interface owning the address sock is bound to, or empty if it is
+// bound to the wildcard address
+static std::string socket_interface(SOCKET sock) {
+    sockaddr_storage ss;
+    socklen_t len = sizeof(ss);
+    if (getsockname(sock, (sockaddr*)&ss, &len)) return "";
+
+    in_addr v4{};
+    in6_addr v6{};
+    bool is_v4 = ss.ss_family == AF_INET;
+    if (is_v4) {
+        v4 = ((sockaddr_in*)&ss)->sin_addr;
+        if (v4.s_addr == htonl(INADDR_ANY)) return "";
+    } else if (ss.ss_family == AF_INET6) {
+        v6 = ((sockaddr_in6*)&ss)->sin6_addr;
+        if (IN6_IS_ADDR_UNSPECIFIED(&v6)) return "";
+        if (IN6_IS_ADDR_V4MAPPED(&v6)) {
+            is_v4 = true;
+            memcpy(&v4, &v6.s6_addr[12], sizeof(v4));
+        }
+    } else {
+        return "";
+    }
+
+    ifaddrs* addrs = nullptr;
+    if (getifaddrs(&addrs)) return "";
+    std::string name;
+    for (ifaddrs* ifa = addrs; ifa != nullptr; ifa = ifa->ifa_next) {
+        if (ifa->ifa_addr == nullptr) continue;
+        if (is_v4 && ifa->ifa_addr->sa_family == AF_INET &&
+            ((sockaddr_in*)ifa->ifa_addr)->sin_addr.s_addr == v4.s_addr) {
+            name = ifa->ifa_name;
+            break;
+        }
+        if (!is_v4 && ifa->ifa_addr->sa_family == AF_INET6 &&
+            IN6_ARE_ADDR_EQUAL(&((sockaddr_in6*)ifa->ifa_addr)->sin6_addr,
+                               &v6)) {
+            name = ifa->ifa_name;
+            break;
+        }
+    }
+    freeifaddrs(addrs);
+    return name;
+}
+#endif
+
+int interface_enable_hardware_timestamps(SOCKET sock,
+                                         const std::string& interface) {
+#ifdef __linux__
+    if (interface.empty() || interface.size() >= IFNAMSIZ) {
+        errno = ENODEV;
+        return SOCKET_ERROR;
+    }
+    ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    memcpy(ifr.ifr_name, interface.c_str(), interface.size());
+    hwtstamp_config config;
+    memset(&config, 0, sizeof(config));
+    ifr.ifr_data = (char*)&config;
+
+    // leave the NIC alone if it already stamps everything, which doesn't need
+    // CAP_NET_ADMIN, and otherwise keep the transmit setting of whatever else
+    // (ptp4l, for example) configured it
+    if (ioctl(sock, SIOCGHWTSTAMP, &ifr) == 0) {
+        if (config.rx_filter == HWTSTAMP_FILTER_ALL) return 0;
+    } else {
+        config.tx_type = HWTSTAMP_TX_OFF;
+    }
+    config.flags = 0;
+    config.rx_filter = HWTSTAMP_FILTER_ALL;
+    if (ioctl(sock, SIOCSHWTSTAMP, &ifr)) return SOCKET_ERROR;
+    if (config.rx_filter == HWTSTAMP_FILTER_NONE) {
+        errno = EOPNOTSUPP;
+        return SOCKET_ERROR;
+    }
+    return 0;
+#else
+    (void)sock;
+    (void)interface;
+    return SOCKET_ERROR;
+#endif
+}
+
+int socket_enable_timestamps(SOCKET sock, bool hardware,
+                             const std::string& interface) {
+#ifdef __linux__
+    if (hardware) {
+        // the NIC only stamps packets once it is told to
+        std::string name = interface.empty() ? socket_interface(sock)
+                                             : interface;
+        if (interface_enable_hardware_timestamps(sock, name)) {
+            return SOCKET_ERROR;
+        }
+        // report raw NIC timestamps, with software ones for packets that
+        // don't have them
+        int flags = SOF_TIMESTAMPING_RX_HARDWARE |
+                    SOF_TIMESTAMPING_RAW_HARDWARE |
+                    SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+        return setsockopt(sock, SOL_SOCKET, SO_TIMESTAMPING, &flags,
+                          sizeof(flags));
+    }
+    int option = 1;
+    return setsockopt(sock, SOL_SOCKET, SO_TIMESTAMPNS, &option,
+                      sizeof(option));
+#else
+    (void)sock;
+    (void)hardware;
+    (void)interface;
+    return SOCKET_ERROR;
+#endif
+}
+
+int socket_disable_timestamps(SOCKET sock) {
+#ifdef __linux__
+    int option = 0;
+    if (setsockopt(sock, SOL_SOCKET, SO_TIMESTAMPING, &option,
+                   sizeof(option))) {
+        return SOCKET_ERROR;
+    }
+    return setsockopt(sock, SOL_SOCKET, SO_TIMESTAMPNS, &option,
+                      sizeof(option));
+#else
+    (void)sock;
+    return SOCKET_ERROR;
+#endif
+}
+
+#ifdef __linux__
+static uint64_t timespec_ns(const timespec& ts) {
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+uint64_t socket_control_timestamp(const msghdr& msg) {
+    uint64_t ts = 0;
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr;
+         cmsg = CMSG_NXTHDR(const_cast<msghdr*>(&msg), cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET) continue;
+        if (cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+            timespec stamp;
+            memcpy(&stamp, CMSG_DATA(cmsg), sizeof(stamp));
+            ts = timespec_ns(stamp);
+        } else if (cmsg->cmsg_type == SCM_TIMESTAMPING) {
+            // ts[0] is the software timestamp, ts[2] the raw hardware one
+            timespec stamps[3];
+            memcpy(stamps, CMSG_DATA(cmsg), sizeof(stamps));
+            ts = timespec_ns(stamps[2]);
+            if (ts == 0) ts = timespec_ns(stamps[0]);
+        }
+    }
+    return ts;
+}
+#endif
+
+int64_t socket_recv_timestamped(SOCKET sock, void* buf, size_t len,
+                                sockaddr_storage* from, uint64_t& ts) {
+    ts = 0;
+#ifdef __linux__
+    alignas(cmsghdr) char control[SOCKET_TIMESTAMP_CONTROL_SIZE];
+    iovec iov;
+    iov.iov_base = buf;
+    iov.iov_len = len;
+    msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_name = from;
+    msg.msg_namelen = from ? sizeof(*from) : 0;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    auto size = recvmsg(sock, &msg, 0);
+    if (size >= 0) ts = socket_control_timestamp(msg);
+    return size;
+#else
+    socklen_t addr_len = sizeof(sockaddr_storage);
+    return recvfrom(sock, (char*)buf, static_cast<int>(len), 0,
+                    (struct sockaddr*)from, from ? &addr_len : nullptr);
+#endif
+}
+
 }  // namespace impl
 }  // namespace sensor
 }  // namespace ouster
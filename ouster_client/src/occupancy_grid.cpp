@@ -0,0 +1,291 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/occupancy_grid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace ouster {
+
+namespace {
+
+constexpr float nan_height = std::numeric_limits<float>::quiet_NaN();
+
+void add_saturated(uint16_t& count) {
+    if (count != std::numeric_limits<uint16_t>::max()) ++count;
+}
+
+// clip the segment from (u0, v0) to (u1, v1) to the box [0, w] x [0, h],
+// Liang-Barsky style, returning false if it misses the box
+bool clip(double& u0, double& v0, double& u1, double& v1, double w, double h,
+          bool& clipped_end) {
+    const double du = u1 - u0;
+    const double dv = v1 - v0;
+    const double p[4] = {-du, du, -dv, dv};
+    const double q[4] = {u0, w - u0, v0, h - v0};
+    double t0 = 0.0;
+    double t1 = 1.0;
+    for (int i = 0; i < 4; ++i) {
+        if (p[i] == 0.0) {
+            if (q[i] < 0.0) return false;
+            continue;
+        }
+        const double t = q[i] / p[i];
+        if (p[i] < 0.0) {
+            if (t > t1) return false;
+            t0 = std::max(t0, t);
+        } else {
+            if (t < t0) return false;
+            t1 = std::min(t1, t);
+        }
+    }
+    clipped_end = t1 < 1.0;
+    u1 = u0 + t1 * du;
+    v1 = v0 + t1 * dv;
+    u0 = u0 + t0 * du;
+    v0 = v0 + t0 * dv;
+    return true;
+}
+
+// count a ray through the cells from (u0, v0) to (u1, v1), in cells, stepping
+// from cell to cell like Amanatides and Woo, leaving out the last cell if it
+// holds the obstacle ending the ray
+void march(img_t<uint16_t>& free, double u0, double v0, double u1, double v1,
+           bool obstacle_end) {
+    const double w = static_cast<double>(free.cols());
+    const double h = static_cast<double>(free.rows());
+    bool clipped_end = false;
+    if (!clip(u0, v0, u1, v1, w, h, clipped_end)) return;
+    obstacle_end = obstacle_end && !clipped_end;
+
+    const Eigen::Index max_col = free.cols() - 1;
+    const Eigen::Index max_row = free.rows() - 1;
+    auto to_cell = [](double u, Eigen::Index max) {
+        return std::min(std::max(static_cast<Eigen::Index>(std::floor(u)),
+                                 Eigen::Index{0}),
+                        max);
+    };
+    Eigen::Index col = to_cell(u0, max_col);
+    Eigen::Index row = to_cell(v0, max_row);
+    const Eigen::Index end_col = to_cell(u1, max_col);
+    const Eigen::Index end_row = to_cell(v1, max_row);
+
+    const double inf = std::numeric_limits<double>::infinity();
+    const double du = u1 - u0;
+    const double dv = v1 - v0;
+    const Eigen::Index step_col = du > 0 ? 1 : -1;
+    const Eigen::Index step_row = dv > 0 ? 1 : -1;
+    const double delta_u = du != 0 ? 1.0 / std::abs(du) : inf;
+    const double delta_v = dv != 0 ? 1.0 / std::abs(dv) : inf;
+    double t_u = du != 0 ? (du > 0 ? col + 1 - u0 : u0 - col) * delta_u : inf;
+    double t_v = dv != 0 ? (dv > 0 ? row + 1 - v0 : v0 - row) * delta_v : inf;
+
+    Eigen::Index steps = std::abs(end_col - col) + std::abs(end_row - row);
+    for (; steps > 0; --steps) {
+        add_saturated(free(row, col));
+        if (t_u < t_v) {
+            col = std::min(std::max(col + step_col, Eigen::Index{0}), max_col);
+            t_u += delta_u;
+        } else {
+            row = std::min(std::max(row + step_row, Eigen::Index{0}), max_row);
+            t_v += delta_v;
+        }
+    }
+    if (!obstacle_end) add_saturated(free(row, col));
+}
+
+}  // namespace
+
+OccupancyGridBuilder::OccupancyGridBuilder(std::vector<XYZLut> luts,
+                                           std::vector<mat4d> extrinsics,
+                                           const GridLayout& layout)
+    : layout_(layout) {
+    if (luts.empty()) {
+        throw std::invalid_argument("expected a lut per sensor");
+    }
+    if (!extrinsics.empty() && extrinsics.size() != luts.size()) {
+        throw std::invalid_argument("expected an extrinsic per sensor");
+    }
+    if (layout_.rows == 0 || layout_.cols == 0) {
+        throw std::invalid_argument("grid must have cells");
+    }
+    if (!(layout_.resolution > 0)) {
+        throw std::invalid_argument("grid resolution must be positive");
+    }
+    if (layout_.min_z > layout_.max_z) {
+        throw std::invalid_argument("grid min_z is above max_z");
+    }
+
+    const Eigen::Index rows = layout_.rows;
+    const Eigen::Index cols = layout_.cols;
+    sensors_.resize(luts.size());
+    for (size_t i = 0; i < luts.size(); ++i) {
+        // the extrinsics are folded into planar copies of the luts once
+        XYZLut& lut = luts[i];
+        if (!extrinsics.empty()) {
+            const Eigen::Matrix3d rot = extrinsics[i].topLeftCorner<3, 3>();
+            const Eigen::RowVector3d trans =
+                extrinsics[i].topRightCorner<3, 1>().transpose();
+            lut.direction = (lut.direction.matrix() * rot.transpose()).array();
+            lut.offset = ((lut.offset.matrix() * rot.transpose()).rowwise() +
+                          trans)
+                             .array();
+        }
+        Sensor& s = sensors_[i];
+        s.dx = lut.direction.col(0);
+        s.dy = lut.direction.col(1);
+        s.dz = lut.direction.col(2);
+        s.ox = lut.offset.col(0);
+        s.oy = lut.offset.col(1);
+        s.oz = lut.offset.col(2);
+        const Eigen::Index pixels = lut.direction.rows();
+        s.x.resize(pixels);
+        s.y.resize(pixels);
+        s.z.resize(pixels);
+        s.height.resize(rows, cols);
+        s.hits.resize(rows, cols);
+        s.free.resize(rows, cols);
+    }
+
+    grid_.state = img_t<uint8_t>::Constant(
+        rows, cols, static_cast<uint8_t>(CellState::UNKNOWN));
+    grid_.height = img_t<float>::Constant(rows, cols, nan_height);
+    grid_.hits = img_t<uint16_t>::Zero(rows, cols);
+    grid_.free = img_t<uint16_t>::Zero(rows, cols);
+}
+
+void OccupancyGridBuilder::fill(Sensor& s, const LidarScan& scan) const {
+    s.height.setConstant(nan_height);
+    s.hits.setZero();
+    s.free.setZero();
+
+    const auto range = scan.field<uint32_t>(sensor::ChanField::RANGE);
+    const Eigen::Index n = range.size();
+    const Eigen::Map<const Eigen::Array<uint32_t, Eigen::Dynamic, 1>> r(
+        range.data(), n);
+
+    // points of every pixel in the grid frame, in cells for x and y
+    const double inv_res = 1.0 / layout_.resolution;
+    const double half_cols = 0.5 * static_cast<double>(layout_.cols);
+    const double half_rows = 0.5 * static_cast<double>(layout_.rows);
+    s.x = (s.dx * r.cast<double>() + s.ox) * inv_res + half_cols;
+    s.y = (s.dy * r.cast<double>() + s.oy) * inv_res + half_rows;
+    s.z = s.dz * r.cast<double>() + s.oz;
+
+    const double max_u = static_cast<double>(layout_.cols);
+    const double max_v = static_cast<double>(layout_.rows);
+    for (Eigen::Index px = 0; px < n; ++px) {
+        const double z = s.z[px];
+        if (r[px] == 0 || z > layout_.max_z) continue;
+        const double u = s.x[px];
+        const double v = s.y[px];
+        if (!(u >= 0 && u < max_u && v >= 0 && v < max_v)) continue;
+        const auto row = static_cast<Eigen::Index>(v);
+        const auto col = static_cast<Eigen::Index>(u);
+        float& height = s.height(row, col);
+        if (!(height >= z)) height = static_cast<float>(z);
+        if (z >= layout_.min_z) add_saturated(s.hits(row, col));
+    }
+
+    // one ray per column, to its nearest hit or its farthest ground return
+    const Eigen::Index w = range.cols();
+    const Eigen::Index h = range.rows();
+    for (Eigen::Index c = 0; c < w; ++c) {
+        Eigen::Index hit = -1;
+        Eigen::Index ground = -1;
+        double hit_d2 = std::numeric_limits<double>::infinity();
+        double ground_d2 = -1.0;
+        for (Eigen::Index row = 0; row < h; ++row) {
+            const Eigen::Index px = row * w + c;
+            const double z = s.z[px];
+            if (r[px] == 0 || z > layout_.max_z) continue;
+            const double du = s.x[px] - (s.ox[px] * inv_res + half_cols);
+            const double dv = s.y[px] - (s.oy[px] * inv_res + half_rows);
+            const double d2 = du * du + dv * dv;
+            if (z >= layout_.min_z) {
+                if (d2 < hit_d2) {
+                    hit = px;
+                    hit_d2 = d2;
+                }
+            } else if (d2 > ground_d2) {
+                ground = px;
+                ground_d2 = d2;
+            }
+        }
+        const Eigen::Index end = hit >= 0 ? hit : ground;
+        if (end < 0) continue;
+        march(s.free, s.ox[end] * inv_res + half_cols,
+              s.oy[end] * inv_res + half_rows, s.x[end], s.y[end], hit >= 0);
+    }
+}
+
+const OccupancyGrid& OccupancyGridBuilder::build(
+    const std::vector<const LidarScan*>& scans) {
+    const size_t n = sensors_.size();
+    if (scans.size() != n) {
+        throw std::invalid_argument("expected a scan, or null, per sensor");
+    }
+    for (size_t i = 0; i < n; ++i) {
+        const LidarScan* scan = scans[i];
+        if (!scan) continue;
+        if (static_cast<Eigen::Index>(scan->w * scan->h) !=
+            sensors_[i].dx.size()) {
+            throw std::invalid_argument("scan doesn't match its lut");
+        }
+        if (!scan->has_field(sensor::ChanField::RANGE)) {
+            throw std::invalid_argument("scan has no RANGE field");
+        }
+    }
+
+    // one thread per sensor, the first one being the calling thread
+    std::vector<std::future<void>> workers;
+    for (size_t i = 1; i < n; ++i) {
+        if (!scans[i]) continue;
+        workers.push_back(std::async(std::launch::async, [this, &scans, i] {
+            fill(sensors_[i], *scans[i]);
+        }));
+    }
+    if (scans[0]) fill(sensors_[0], *scans[0]);
+    for (auto& worker : workers) worker.get();
+
+    const Eigen::Index cells = grid_.state.size();
+    const uint32_t max_count = std::numeric_limits<uint16_t>::max();
+    for (Eigen::Index i = 0; i < cells; ++i) {
+        uint32_t hits = 0;
+        uint32_t free = 0;
+        float height = nan_height;
+        for (size_t k = 0; k < n; ++k) {
+            if (!scans[k]) continue;
+            const Sensor& s = sensors_[k];
+            hits += s.hits.data()[i];
+            free += s.free.data()[i];
+            const float z = s.height.data()[i];
+            if (std::isnan(height) || z > height) height = z;
+        }
+        grid_.hits.data()[i] = static_cast<uint16_t>(std::min(hits, max_count));
+        grid_.free.data()[i] = static_cast<uint16_t>(std::min(free, max_count));
+        grid_.height.data()[i] = height;
+        const CellState state = hits && hits >= layout_.min_hits
+                                    ? CellState::OCCUPIED
+                                    : (free ? CellState::FREE
+                                            : CellState::UNKNOWN);
+        grid_.state.data()[i] = static_cast<uint8_t>(state);
+    }
+    grid_.frame = frames_++;
+    return grid_;
+}
+
+const OccupancyGrid& OccupancyGridBuilder::latest() const { return grid_; }
+
+const GridLayout& OccupancyGridBuilder::layout() const { return layout_; }
+
+size_t OccupancyGridBuilder::sensors_count() const { return sensors_.size(); }
+
+}  // namespace ouster
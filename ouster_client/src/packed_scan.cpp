@@ -0,0 +1,254 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/packed_scan.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace ouster {
+
+using sensor::ChanFieldType;
+
+namespace {
+
+// narrow src into dst, returning false if a value has bits outside of mask.
+// Plain loops over contiguous arrays, which the compiler vectorizes
+template <typename S, typename D>
+bool pack_values(const S* src, D* dst, size_t n, int shift, uint64_t mask) {
+    const S outside = static_cast<S>(~mask);
+    S lost = 0;
+    for (size_t i = 0; i < n; i++) {
+        lost |= src[i] & outside;
+        dst[i] = static_cast<D>(src[i] >> shift);
+    }
+    return lost == 0;
+}
+
+template <typename D, typename S>
+void unpack_values(const D* src, S* dst, size_t n, int shift) {
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = static_cast<S>(static_cast<S>(src[i]) << shift);
+    }
+}
+
+template <typename S>
+bool pack_from(const S* src, Field& dst, size_t n, int shift, uint64_t mask) {
+    switch (dst.tag()) {
+        case ChanFieldType::UINT8:
+            return pack_values(src, dst.get<uint8_t>(), n, shift, mask);
+        case ChanFieldType::UINT16:
+            return pack_values(src, dst.get<uint16_t>(), n, shift, mask);
+        default:
+            return pack_values(src, dst.get<uint32_t>(), n, shift, mask);
+    }
+}
+
+template <typename D>
+void unpack_to(const D* src, Field& dst, size_t n, int shift) {
+    switch (dst.tag()) {
+        case ChanFieldType::UINT16:
+            return unpack_values(src, dst.get<uint16_t>(), n, shift);
+        case ChanFieldType::UINT32:
+            return unpack_values(src, dst.get<uint32_t>(), n, shift);
+        default:
+            return unpack_values(src, dst.get<uint64_t>(), n, shift);
+    }
+}
+
+void unpack_field(const Field& packed, int shift, Field& dst) {
+    const size_t n = dst.size();
+    switch (packed.tag()) {
+        case ChanFieldType::UINT8:
+            return unpack_to(packed.get<uint8_t>(), dst, n, shift);
+        case ChanFieldType::UINT16:
+            return unpack_to(packed.get<uint16_t>(), dst, n, shift);
+        default:
+            return unpack_to(packed.get<uint32_t>(), dst, n, shift);
+    }
+}
+
+bool is_unsigned(ChanFieldType tag) {
+    return tag == ChanFieldType::UINT8 || tag == ChanFieldType::UINT16 ||
+           tag == ChanFieldType::UINT32 || tag == ChanFieldType::UINT64;
+}
+
+void copy_bytes(const Field& src, Field& dst) {
+    std::memcpy(dst.get(), src.get(), src.bytes());
+}
+
+}  // namespace
+
+PackedScan::PackedScan() = default;
+
+PackedScan::PackedScan(const LidarScan& scan,
+                       const sensor::packet_format& pf) {
+    LidarScanFieldTypes rest_types;
+    for (const auto& ft : scan.field_types()) {
+        const Field& src = scan.field(ft.name);
+        const bool pixels = ft.field_class == FieldClass::PIXEL_FIELD &&
+                            ft.extra_dims.empty() &&
+                            is_unsigned(ft.element_type);
+        if (!pixels || pf.field_type(ft.name) == ChanFieldType::VOID) {
+            rest_types.push_back(ft);
+            continue;
+        }
+
+        // the bits the packets can set, e.g. 3 to 17 for RNG15 ranges
+        const uint64_t mask = pf.field_value_mask(ft.name);
+        int shift = 0;
+        int top = 0;
+        for (int bit = 0; bit < 64; bit++) {
+            if (!(mask >> bit & 1)) continue;
+            if (!top) shift = bit;
+            top = bit + 1;
+        }
+        const int bits = top - shift;
+        const ChanFieldType narrow = bits <= 8    ? ChanFieldType::UINT8
+                                     : bits <= 16 ? ChanFieldType::UINT16
+                                                  : ChanFieldType::UINT32;
+        const size_t src_size = sensor::field_type_size(ft.element_type);
+        if (!mask || bits > 32 || sensor::field_type_size(narrow) >= src_size ||
+            static_cast<size_t>(top) > src_size * 8) {
+            rest_types.push_back(ft);
+            continue;
+        }
+
+        PackedField packed{
+            ft, Field(FieldDescriptor::array(narrow, {scan.h, scan.w}),
+                      FieldClass::PIXEL_FIELD),
+            shift};
+        const size_t n = scan.w * scan.h;
+        bool lossless = false;
+        switch (ft.element_type) {
+            case ChanFieldType::UINT16:
+                lossless = pack_from(src.get<uint16_t>(), packed.data, n,
+                                     shift, mask);
+                break;
+            case ChanFieldType::UINT32:
+                lossless = pack_from(src.get<uint32_t>(), packed.data, n,
+                                     shift, mask);
+                break;
+            default:
+                lossless = pack_from(src.get<uint64_t>(), packed.data, n,
+                                     shift, mask);
+                break;
+        }
+        if (!lossless) {
+            throw std::invalid_argument(
+                "PackedScan: field '" + ft.name +
+                "' has values outside of the bits of its packets");
+        }
+        packed_.push_back(std::move(packed));
+    }
+
+    rest_ = LidarScan(scan, rest_types);
+    rest_.shutdown_countdown = scan.shutdown_countdown;
+    rest_.shot_limiting_countdown = scan.shot_limiting_countdown;
+}
+
+PackedScan::PackedScan(const LidarScan& scan)
+    : PackedScan(scan, scan.sensor_info
+                           ? sensor::get_format(*scan.sensor_info)
+                           : throw std::invalid_argument(
+                                 "PackedScan: scan has no sensor_info")) {}
+
+size_t PackedScan::width() const { return rest_.w; }
+
+size_t PackedScan::height() const { return rest_.h; }
+
+LidarScanFieldTypes PackedScan::field_types() const {
+    LidarScanFieldTypes types = rest_.field_types();
+    for (const auto& p : packed_) types.push_back(p.type);
+    std::sort(types.begin(), types.end());
+    return types;
+}
+
+bool PackedScan::has_field(const std::string& name) const {
+    return find(name) || rest_.has_field(name);
+}
+
+bool PackedScan::is_packed(const std::string& name) const {
+    return find(name) != nullptr;
+}
+
+const PackedScan::PackedField* PackedScan::find(
+    const std::string& name) const {
+    for (const auto& p : packed_) {
+        if (p.type.name == name) return &p;
+    }
+    return nullptr;
+}
+
+Field PackedScan::field(const std::string& name) const {
+    const PackedField* p = find(name);
+    if (!p) return rest_.field(name);
+    Field out(FieldDescriptor::array(p->type.element_type,
+                                     {rest_.h, rest_.w}),
+              FieldClass::PIXEL_FIELD);
+    unpack_field(p->data, p->shift, out);
+    return out;
+}
+
+LidarScan PackedScan::unpack() const {
+    LidarScan out = rest_;
+    for (const auto& p : packed_) {
+        unpack_field(p.data, p.shift, out.add_field(p.type));
+    }
+    return out;
+}
+
+void PackedScan::unpack(LidarScan& dst) const {
+    if (dst.w != rest_.w || dst.h != rest_.h ||
+        dst.packet_timestamp().size() != rest_.packet_timestamp().size() ||
+        !dst.has_field_types(field_types())) {
+        throw std::invalid_argument(
+            "PackedScan: scan to unpack into has other dimensions or fields");
+    }
+    for (const auto& p : packed_) {
+        unpack_field(p.data, p.shift, dst.field(p.type.name));
+    }
+    // copied byte for byte: fields of contiguous scans can't be assigned to
+    // without allocating
+    for (const auto& kv : rest_.fields()) {
+        copy_bytes(kv.second, dst.field(kv.first));
+    }
+    dst.timestamp() = rest_.timestamp();
+    dst.packet_timestamp() = rest_.packet_timestamp();
+    dst.alert_flags() = rest_.alert_flags();
+    dst.measurement_id() = rest_.measurement_id();
+    dst.status() = rest_.status();
+    copy_bytes(rest_.pose(), dst.pose());
+    dst.frame_id = rest_.frame_id;
+    dst.frame_status = rest_.frame_status;
+    dst.shutdown_countdown = rest_.shutdown_countdown;
+    dst.shot_limiting_countdown = rest_.shot_limiting_countdown;
+    dst.sensor_info = rest_.sensor_info;
+}
+
+size_t PackedScan::bytes() const {
+    size_t total = 0;
+    for (const auto& kv : rest_.fields()) total += kv.second.bytes();
+    for (const auto& p : packed_) total += p.data.bytes();
+    total += rest_.timestamp().size() * sizeof(uint64_t) +
+             rest_.packet_timestamp().size() * sizeof(uint64_t) +
+             rest_.alert_flags().size() * sizeof(uint8_t) +
+             rest_.measurement_id().size() * sizeof(uint16_t) +
+             rest_.status().size() * sizeof(uint32_t) + rest_.pose().bytes();
+    return total;
+}
+
+size_t PackedScan::unpacked_bytes() const {
+    size_t total = bytes();
+    for (const auto& p : packed_) {
+        total += rest_.w * rest_.h *
+                     sensor::field_type_size(p.type.element_type) -
+                 p.data.bytes();
+    }
+    return total;
+}
+
+}  // namespace ouster
@@ -49,6 +49,36 @@ PacketValidationFailure validate_packet(
     return PacketValidationFailure::NONE;
 };
 
+size_t validate_lidar_packets(const sensor_info& info,
+                              const ouster::sensor::packet_format& format,
+                              const LidarPacket* packets, size_t count,
+                              std::vector<uint64_t>& valid, bool check_crc) {
+    valid.assign((count + 63) / 64, 0);
+    const uint32_t expected_init_id = info.init_id;
+    const uint64_t expected_sn = info.sn;
+    size_t n_valid = 0;
+    for (size_t i = 0; i < count; i++) {
+        const auto& buf = packets[i].buf;
+        // headers can only be read from a packet of the right size
+        bool ok = buf.size() == format.lidar_packet_size;
+        if (ok) {
+            const uint32_t init_id = format.init_id(buf.data());
+            const uint64_t sn = format.prod_sn(buf.data());
+            // zero in either the metadata or the packet matches anything
+            ok = (expected_init_id == 0 || init_id == 0 ||
+                  init_id == expected_init_id) &
+                 (expected_sn == 0 || sn == 0 || sn == expected_sn);
+        }
+        if (ok && check_crc) {
+            const auto crc = format.crc(buf.data());
+            ok = !crc || *crc == format.calculate_crc(buf.data());
+        }
+        valid[i / 64] |= static_cast<uint64_t>(ok) << (i % 64);
+        n_valid += ok;
+    }
+    return n_valid;
+}
+
 LidarPacket::LidarPacket() : Packet{MyType} {}
 
 LidarPacket::LidarPacket(int size) : Packet{MyType, size} {}
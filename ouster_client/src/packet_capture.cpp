@@ -0,0 +1,263 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/impl/packet_capture.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <linux/if_packet.h>
+#include <linux/net_tstamp.h>
+#include <net/ethernet.h>
+#include <net/if.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace ouster {
+namespace sensor {
+namespace impl {
+
+#ifdef __linux__
+
+static const uint8_t ipproto_udp = 17;
+static const size_t udp_header_len = 8;
+
+PacketMmapCapture::PacketMmapCapture(const std::string& interface,
+                                     const std::set<int>& ports,
+                                     size_t block_size, size_t block_count,
+                                     int block_timeout_ms,
+                                     bool hardware_timestamps)
+    : ports_(ports), block_size_(block_size), block_count_(block_count) {
+    // cooked mode sockets deliver frames starting at the network header,
+    // which copes with any link layer or VLAN tagging
+    fd_ = ::socket(AF_PACKET, SOCK_DGRAM, htons(ETH_P_IP));
+    if (!socket_valid(fd_)) {
+        throw std::runtime_error("failed to open packet capture socket: " +
+                                 socket_get_error());
+    }
+
+    auto fail = [this](const std::string& what) {
+        std::string msg = what + ": " + socket_get_error();
+        if (ring_) munmap(ring_, ring_size_);
+        socket_close(fd_);
+        throw std::runtime_error(msg);
+    };
+
+    int version = TPACKET_V3;
+    if (setsockopt(fd_, SOL_PACKET, PACKET_VERSION, &version,
+                   sizeof(version))) {
+        fail("failed to select TPACKET_V3");
+    }
+
+    if (hardware_timestamps) {
+        if (!interface.empty() &&
+            interface_enable_hardware_timestamps(fd_, interface)) {
+            fail("failed to enable hardware timestamps on '" + interface +
+                 "'");
+        }
+        int flags = SOF_TIMESTAMPING_RAW_HARDWARE;
+        if (setsockopt(fd_, SOL_PACKET, PACKET_TIMESTAMP, &flags,
+                       sizeof(flags))) {
+            fail("failed to enable hardware capture timestamps");
+        }
+    }
+
+    const size_t frame_size = TPACKET_ALIGNMENT << 7;
+    tpacket_req3 req;
+    memset(&req, 0, sizeof(req));
+    req.tp_block_size = block_size_;
+    req.tp_block_nr = block_count_;
+    req.tp_frame_size = frame_size;
+    req.tp_frame_nr = (block_size_ * block_count_) / frame_size;
+    req.tp_retire_blk_tov = block_timeout_ms;
+    if (setsockopt(fd_, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req))) {
+        fail("failed to set up packet ring");
+    }
+
+    ring_size_ = block_size_ * block_count_;
+    void* ring = mmap(nullptr, ring_size_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_LOCKED, fd_, 0);
+    if (ring == MAP_FAILED) {
+        // locking the ring is only an optimization
+        ring = mmap(nullptr, ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED,
+                    fd_, 0);
+    }
+    if (ring == MAP_FAILED) {
+        fail("failed to map packet ring");
+    }
+    ring_ = static_cast<uint8_t*>(ring);
+
+    sockaddr_ll addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sll_family = AF_PACKET;
+    addr.sll_protocol = htons(ETH_P_IP);
+    if (!interface.empty()) {
+        addr.sll_ifindex = if_nametoindex(interface.c_str());
+        if (addr.sll_ifindex == 0) {
+            fail("unknown capture interface '" + interface + "'");
+        }
+    }
+    if (::bind(fd_, (sockaddr*)&addr, sizeof(addr))) {
+        fail("failed to bind packet capture socket");
+    }
+}
+
+PacketMmapCapture::~PacketMmapCapture() {
+    munmap(ring_, ring_size_);
+    socket_close(fd_);
+}
+
+bool PacketMmapCapture::ready() const {
+    auto desc = reinterpret_cast<const tpacket_block_desc*>(
+        ring_ + block_ * block_size_);
+    return (__atomic_load_n(&desc->hdr.bh1.block_status, __ATOMIC_ACQUIRE) &
+            TP_STATUS_USER) != 0;
+}
+
+void PacketMmapCapture::release_block() {
+    auto desc =
+        reinterpret_cast<tpacket_block_desc*>(ring_ + block_ * block_size_);
+    __atomic_store_n(&desc->hdr.bh1.block_status, TP_STATUS_KERNEL,
+                     __ATOMIC_RELEASE);
+    block_ = (block_ + 1) % block_count_;
+    in_block_ = false;
+}
+
+size_t PacketMmapCapture::handle_frame(const uint8_t* frame, size_t len,
+                                       uint64_t ts,
+                                       std::vector<uint8_t>& data,
+                                       size_t max_size,
+                                       sockaddr_storage& from) {
+    Ipv4Header ip;
+    if (!parse_ipv4_header(frame, len, ip) || ip.protocol != ipproto_udp) {
+        return 0;
+    }
+
+    const uint8_t* udp = frame + ip.header_len;
+    size_t udp_len = ip.total_len - ip.header_len;
+    if (ip.more || ip.offset) {
+        const uint8_t* datagram = nullptr;
+        size_t datagram_size = 0;
+        if (reassembler_.process(std::chrono::microseconds(ts / 1000), frame,
+                                 len, datagram, datagram_size) !=
+            IpReassembler::REASSEMBLED) {
+            return 0;
+        }
+        // the reassembled datagram keeps the header of the first fragment
+        const size_t header_len = (datagram[0] & 0x0F) * 4u;
+        udp = datagram + header_len;
+        udp_len = datagram_size - header_len;
+    }
+    if (udp_len < udp_header_len) {
+        return 0;
+    }
+
+    uint16_t src_port = static_cast<uint16_t>((udp[0] << 8) | udp[1]);
+    uint16_t dst_port = static_cast<uint16_t>((udp[2] << 8) | udp[3]);
+    if (ports_.count(dst_port) == 0) {
+        return 0;
+    }
+
+    size_t size = std::min(udp_len - udp_header_len, max_size);
+    data.resize(size);
+    memcpy(data.data(), udp + udp_header_len, size);
+
+    memset(&from, 0, sizeof(from));
+    auto addr4 = reinterpret_cast<sockaddr_in*>(&from);
+    addr4->sin_family = AF_INET;
+    addr4->sin_addr.s_addr = ip.src;
+    addr4->sin_port = htons(src_port);
+    return size;
+}
+
+size_t PacketMmapCapture::next(std::vector<uint8_t>& data, size_t max_size,
+                               sockaddr_storage& from, uint64_t& ts) {
+    while (true) {
+        auto desc = reinterpret_cast<tpacket_block_desc*>(
+            ring_ + block_ * block_size_);
+        if (!in_block_) {
+            if (!(__atomic_load_n(&desc->hdr.bh1.block_status,
+                                  __ATOMIC_ACQUIRE) &
+                  TP_STATUS_USER)) {
+                return 0;
+            }
+            in_block_ = true;
+            packets_left_ = desc->hdr.bh1.num_pkts;
+            next_frame_ = reinterpret_cast<const uint8_t*>(desc) +
+                          desc->hdr.bh1.offset_to_first_pkt;
+        }
+
+        while (packets_left_ > 0) {
+            auto hdr = reinterpret_cast<const tpacket3_hdr*>(next_frame_);
+            const uint8_t* frame = next_frame_ + hdr->tp_net;
+            auto sll = reinterpret_cast<const sockaddr_ll*>(
+                next_frame_ + TPACKET_ALIGN(sizeof(tpacket3_hdr)));
+            uint64_t frame_ts =
+                static_cast<uint64_t>(hdr->tp_sec) * 1000000000ULL +
+                hdr->tp_nsec;
+            size_t len = hdr->tp_snaplen;
+            next_frame_ += hdr->tp_next_offset;
+            packets_left_--;
+
+            // on loopback every datagram is also seen on its way out
+            if (sll->sll_pkttype == PACKET_OUTGOING) continue;
+
+            size_t size =
+                handle_frame(frame, len, frame_ts, data, max_size, from);
+            if (size > 0) {
+                ts = frame_ts;
+                if (packets_left_ == 0) release_block();
+                return size;
+            }
+        }
+        release_block();
+    }
+}
+
+uint64_t PacketMmapCapture::drops() {
+    tpacket_stats_v3 stats;
+    socklen_t len = sizeof(stats);
+    if (getsockopt(fd_, SOL_PACKET, PACKET_STATISTICS, &stats, &len) == 0) {
+        drops_ += stats.tp_drops;
+    }
+    return drops_;
+}
+
+#else
+
+PacketMmapCapture::PacketMmapCapture(const std::string&, const std::set<int>&,
+                                     size_t, size_t, int, bool)
+    : fd_(SOCKET_ERROR), block_size_(0), block_count_(0) {
+    throw std::runtime_error(
+        "PACKET_MMAP capture is only supported on Linux");
+}
+
+PacketMmapCapture::~PacketMmapCapture() {}
+
+bool PacketMmapCapture::ready() const { return false; }
+
+void PacketMmapCapture::release_block() {}
+
+size_t PacketMmapCapture::handle_frame(const uint8_t*, size_t, uint64_t,
+                                       std::vector<uint8_t>&, size_t,
+                                       sockaddr_storage&) {
+    return 0;
+}
+
+size_t PacketMmapCapture::next(std::vector<uint8_t>&, size_t,
+                               sockaddr_storage&, uint64_t&) {
+    return 0;
+}
+
+uint64_t PacketMmapCapture::drops() { return 0; }
+
+#endif
+
+}  // namespace impl
+}  // namespace sensor
+}  // namespace ouster
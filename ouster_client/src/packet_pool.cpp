@@ -0,0 +1,156 @@
+/**
+ * Copyright (c) 2024, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/packet_pool.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace ouster {
+namespace sensor {
+
+struct PooledPacket::Slot {
+    std::unique_ptr<Packet> packet;
+    std::atomic<size_t> refs{0};
+    PacketPool::State* owner;
+};
+
+/// Shared by the pool and its outstanding packets, so that handles can outlive
+/// the pool. Deleted once the pool is gone and every packet has come back.
+struct PacketPool::State {
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<PooledPacket::Slot>> slots;
+    std::vector<PooledPacket::Slot*> free_lidar;
+    std::vector<PooledPacket::Slot*> free_imu;
+    size_t outstanding{0};
+    bool pool_alive{true};
+
+    // called with the mutex held, returns true if the state should be deleted
+    bool finished() const { return !pool_alive && outstanding == 0; }
+
+    void release(PooledPacket::Slot* slot) {
+        bool done;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (slot->packet->type() == PacketType::Lidar) {
+                free_lidar.push_back(slot);
+            } else {
+                free_imu.push_back(slot);
+            }
+            outstanding--;
+            done = finished();
+        }
+        if (done) {
+            delete this;
+        }
+    }
+};
+
+PooledPacket::PooledPacket(const PooledPacket& other) : slot_{other.slot_} {
+    if (slot_) {
+        slot_->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+PooledPacket::PooledPacket(PooledPacket&& other) noexcept
+    : slot_{other.slot_} {
+    other.slot_ = nullptr;
+}
+
+PooledPacket& PooledPacket::operator=(const PooledPacket& other) {
+    if (this != &other) {
+        PooledPacket copy(other);
+        std::swap(slot_, copy.slot_);
+    }
+    return *this;
+}
+
+PooledPacket& PooledPacket::operator=(PooledPacket&& other) noexcept {
+    if (this != &other) {
+        reset();
+        slot_ = other.slot_;
+        other.slot_ = nullptr;
+    }
+    return *this;
+}
+
+PooledPacket::~PooledPacket() { reset(); }
+
+void PooledPacket::reset() {
+    if (!slot_) {
+        return;
+    }
+    if (slot_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        slot_->owner->release(slot_);
+    }
+    slot_ = nullptr;
+}
+
+Packet* PooledPacket::get() const {
+    return slot_ ? slot_->packet.get() : nullptr;
+}
+
+size_t PooledPacket::use_count() const {
+    return slot_ ? slot_->refs.load(std::memory_order_relaxed) : 0;
+}
+
+PacketPool::PacketPool() : state_{new State()} {}
+
+PacketPool::~PacketPool() {
+    bool done;
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->pool_alive = false;
+        done = state_->finished();
+    }
+    if (done) {
+        delete state_;
+    }
+}
+
+PooledPacket PacketPool::acquire(PacketType type) {
+    if (type != PacketType::Lidar && type != PacketType::Imu) {
+        throw std::invalid_argument(
+            "PacketPool can only provide lidar or imu packets");
+    }
+    auto& free_list =
+        type == PacketType::Lidar ? state_->free_lidar : state_->free_imu;
+
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    PooledPacket::Slot* slot;
+    if (free_list.empty()) {
+        auto new_slot = std::make_unique<PooledPacket::Slot>();
+        if (type == PacketType::Lidar) {
+            new_slot->packet = std::make_unique<LidarPacket>();
+        } else {
+            new_slot->packet = std::make_unique<ImuPacket>();
+        }
+        new_slot->owner = state_;
+        slot = new_slot.get();
+        state_->slots.push_back(std::move(new_slot));
+    } else {
+        slot = free_list.back();
+        free_list.pop_back();
+    }
+    state_->outstanding++;
+    slot->refs.store(1, std::memory_order_relaxed);
+    return PooledPacket(slot);
+}
+
+size_t PacketPool::size() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->slots.size();
+}
+
+size_t PacketPool::available() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->free_lidar.size() + state_->free_imu.size();
+}
+
+}  // namespace sensor
+}  // namespace ouster
@@ -0,0 +1,335 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/packet_relay.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+#include "ouster/impl/logging.h"
+#include "ouster/impl/netcompat.h"
+#include "ouster/shm_packet_channel.h"
+#include "ouster/threads.h"
+
+#ifdef __linux__
+#include <sys/uio.h>
+#endif
+
+using ouster::sensor::impl::socket_close;
+using ouster::sensor::impl::socket_get_error;
+using ouster::sensor::impl::socket_valid;
+
+namespace ouster {
+namespace sensor {
+
+namespace {
+
+struct Target {
+    sockaddr_storage addr;
+    socklen_t len{0};
+};
+
+bool is_multicast(const sockaddr_storage& addr) {
+    if (addr.ss_family == AF_INET) {
+        const auto& in = reinterpret_cast<const sockaddr_in&>(addr);
+        return IN_MULTICAST(ntohl(in.sin_addr.s_addr));
+    }
+    const auto& in6 = reinterpret_cast<const sockaddr_in6&>(addr);
+    return IN6_IS_ADDR_MULTICAST(&in6.sin6_addr);
+}
+
+Target resolve(const std::string& host, int port) {
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* result = nullptr;
+    const auto service = std::to_string(port);
+    if (getaddrinfo(host.c_str(), service.c_str(), &hints, &result) != 0 ||
+        result == nullptr) {
+        throw std::invalid_argument("PacketRelay: can't resolve '" + host +
+                                    "'");
+    }
+    Target target;
+    memset(&target.addr, 0, sizeof(target.addr));
+    memcpy(&target.addr, result->ai_addr, result->ai_addrlen);
+    target.len = static_cast<socklen_t>(result->ai_addrlen);
+    freeaddrinfo(result);
+    return target;
+}
+
+}  // namespace
+
+struct PacketRelay::Impl {
+    struct Destination {
+        int source;
+        SOCKET sock;
+        bool lidar{false};
+        bool imu{false};
+        Target lidar_target;
+        Target imu_target;
+#ifdef __linux__
+        std::vector<mmsghdr> msgs;
+        std::vector<iovec> iovecs;
+#endif
+    };
+
+    PacketRelayOptions options;
+    std::vector<Destination> destinations;
+    // one socket per address family, created when a destination needs it
+    SOCKET sock4{SOCKET_ERROR};
+    SOCKET sock6{SOCKET_ERROR};
+    std::unique_ptr<ShmPacketWriter> shm;
+
+    mutable std::mutex stats_mtx;
+    PacketRelayStats stats;
+
+    ~Impl() {
+        if (socket_valid(sock4)) socket_close(sock4);
+        if (socket_valid(sock6)) socket_close(sock6);
+    }
+
+    SOCKET socket_for(int family) {
+        SOCKET& sock = family == AF_INET ? sock4 : sock6;
+        if (socket_valid(sock)) return sock;
+        sock = socket(family, SOCK_DGRAM, 0);
+        if (!socket_valid(sock)) {
+            throw std::runtime_error("PacketRelay: socket(): " +
+                                     socket_get_error());
+        }
+        const int ttl = options.multicast_ttl;
+        const int loop = options.multicast_loop ? 1 : 0;
+        int res = 0;
+        if (family == AF_INET) {
+            const unsigned char ttl4 = static_cast<unsigned char>(ttl);
+            const unsigned char loop4 = static_cast<unsigned char>(loop);
+            res |= setsockopt(sock, IPPROTO_IP, IP_MULTICAST_TTL,
+                              (const char*)&ttl4, sizeof(ttl4));
+            res |= setsockopt(sock, IPPROTO_IP, IP_MULTICAST_LOOP,
+                              (const char*)&loop4, sizeof(loop4));
+            if (!options.multicast_interface.empty()) {
+                in_addr iface;
+                if (inet_pton(AF_INET, options.multicast_interface.c_str(),
+                              &iface) != 1) {
+                    throw std::invalid_argument(
+                        "PacketRelay: multicast interface must be an IPv4 "
+                        "address, got '" +
+                        options.multicast_interface + "'");
+                }
+                res |= setsockopt(sock, IPPROTO_IP, IP_MULTICAST_IF,
+                                  (const char*)&iface, sizeof(iface));
+            }
+        } else {
+            res |= setsockopt(sock, IPPROTO_IPV6, IPV6_MULTICAST_HOPS,
+                              (const char*)&ttl, sizeof(ttl));
+            res |= setsockopt(sock, IPPROTO_IPV6, IPV6_MULTICAST_LOOP,
+                              (const char*)&loop, sizeof(loop));
+        }
+        if (res != 0) {
+            logger().warn("PacketRelay: setting multicast options: {}",
+                          socket_get_error());
+        }
+        return sock;
+    }
+
+    void send(Destination& dest, RelayDestinationStats& stats,
+              const std::vector<ClientEvent*>& packets) {
+#ifdef __linux__
+        dest.msgs.resize(packets.size());
+        dest.iovecs.resize(packets.size());
+        size_t n = 0;
+        for (auto ev : packets) {
+            if (dest.source >= 0 && ev->source != dest.source) continue;
+            const bool lidar = ev->packet().type() == PacketType::Lidar;
+            if (lidar ? !dest.lidar : !dest.imu) continue;
+            Target& target = lidar ? dest.lidar_target : dest.imu_target;
+            auto& buf = ev->packet().buf;
+            dest.iovecs[n].iov_base = buf.data();
+            dest.iovecs[n].iov_len = buf.size();
+            msghdr& hdr = dest.msgs[n].msg_hdr;
+            memset(&hdr, 0, sizeof(hdr));
+            hdr.msg_name = &target.addr;
+            hdr.msg_namelen = target.len;
+            hdr.msg_iov = &dest.iovecs[n];
+            hdr.msg_iovlen = 1;
+            n++;
+        }
+        size_t done = 0;
+        while (done < n) {
+            const int sent = sendmmsg(dest.sock, dest.msgs.data() + done,
+                                      static_cast<unsigned>(n - done), 0);
+            if (sent < 0) {
+                if (errno == EINTR) continue;
+                // only the first message failed, move past it
+                stats.errors++;
+                done++;
+                continue;
+            }
+            for (size_t i = done; i < done + sent; i++) {
+                stats.bytes += dest.msgs[i].msg_len;
+            }
+            stats.packets += sent;
+            done += sent;
+        }
+#else
+        for (auto ev : packets) {
+            if (dest.source >= 0 && ev->source != dest.source) continue;
+            const bool lidar = ev->packet().type() == PacketType::Lidar;
+            if (lidar ? !dest.lidar : !dest.imu) continue;
+            const Target& target = lidar ? dest.lidar_target : dest.imu_target;
+            const auto& buf = ev->packet().buf;
+            const auto sent = sendto(dest.sock, (const char*)buf.data(),
+                                     static_cast<int>(buf.size()), 0,
+                                     (const sockaddr*)&target.addr, target.len);
+            if (sent < 0) {
+                stats.errors++;
+            } else {
+                stats.packets++;
+                stats.bytes += sent;
+            }
+        }
+#endif
+    }
+};
+
+PacketRelay::PacketRelay(const std::vector<sensor_info>& infos,
+                         const std::vector<RelayDestination>& destinations,
+                         const PacketRelayOptions& options)
+    : impl_(std::make_unique<Impl>()) {
+    impl_->options = options;
+    if (impl_->options.batch_size == 0) impl_->options.batch_size = 1;
+    for (const auto& d : destinations) {
+        Impl::Destination dest;
+        dest.source = d.source;
+        int family = AF_UNSPEC;
+        if (d.lidar_port > 0) {
+            dest.lidar = true;
+            dest.lidar_target = resolve(d.host, d.lidar_port);
+            family = dest.lidar_target.addr.ss_family;
+        }
+        if (d.imu_port > 0) {
+            dest.imu = true;
+            dest.imu_target = resolve(d.host, d.imu_port);
+            family = dest.imu_target.addr.ss_family;
+        }
+        if (family == AF_UNSPEC) {
+            throw std::invalid_argument("PacketRelay: destination '" + d.host +
+                                        "' has neither a lidar nor IMU port");
+        }
+        const Target& target = dest.lidar ? dest.lidar_target : dest.imu_target;
+        if (is_multicast(target.addr)) {
+            logger().info("PacketRelay: sending to multicast group {}",
+                          d.host);
+        }
+        dest.sock = impl_->socket_for(family);
+        impl_->destinations.push_back(std::move(dest));
+    }
+    impl_->stats.destinations.resize(destinations.size());
+
+    if (!options.shm_name.empty()) {
+        size_t max_bytes = 0;
+        std::vector<std::string> metadata;
+        for (const auto& info : infos) {
+            packet_format pf(info);
+            max_bytes = std::max({max_bytes, pf.lidar_packet_size,
+                                  pf.imu_packet_size});
+            metadata.push_back(info.to_json_string());
+        }
+        if (max_bytes == 0) max_bytes = 65535;
+        impl_->shm = std::make_unique<ShmPacketWriter>(
+            options.shm_name, options.shm_slots, max_bytes, metadata);
+    }
+}
+
+PacketRelay::~PacketRelay() { stop(); }
+
+void PacketRelay::forward(std::vector<ClientEvent>& events) {
+    // packets are sent straight from the buffers of the events
+    std::vector<ClientEvent*> packets;
+    packets.reserve(events.size());
+    uint64_t lidar = 0;
+    uint64_t imu = 0;
+    for (auto& ev : events) {
+        if (ev.type != ClientEvent::Packet) continue;
+        const PacketType type = ev.packet().type();
+        if (type == PacketType::Lidar) {
+            lidar++;
+        } else if (type == PacketType::Imu) {
+            imu++;
+        } else {
+            continue;
+        }
+        packets.push_back(&ev);
+    }
+    if (packets.empty()) return;
+
+    std::vector<RelayDestinationStats> sent(impl_->destinations.size());
+    for (size_t i = 0; i < impl_->destinations.size(); i++) {
+        impl_->send(impl_->destinations[i], sent[i], packets);
+    }
+
+    uint64_t shm_packets = 0;
+    if (impl_->shm) {
+        const size_t max_bytes = impl_->shm->max_packet_bytes();
+        for (auto ev : packets) {
+            const Packet& p = ev->packet();
+            if (p.buf.size() > max_bytes) continue;
+            impl_->shm->publish(ev->source, p.type(), p.host_timestamp,
+                                p.buf.data(), p.buf.size());
+            shm_packets++;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(impl_->stats_mtx);
+    auto& stats = impl_->stats;
+    stats.lidar_packets += lidar;
+    stats.imu_packets += imu;
+    stats.batches++;
+    stats.shm_packets += shm_packets;
+    for (size_t i = 0; i < sent.size(); i++) {
+        stats.destinations[i].packets += sent[i].packets;
+        stats.destinations[i].bytes += sent[i].bytes;
+        stats.destinations[i].errors += sent[i].errors;
+    }
+}
+
+void PacketRelay::start(SensorClient& client) {
+    if (running_.exchange(true)) {
+        throw std::logic_error("PacketRelay: already started");
+    }
+    thread_ = start_thread("ouster-relay", [this, &client]() {
+        std::vector<ClientEvent> events;
+        const size_t batch_size = impl_->options.batch_size;
+        while (running_) {
+            client.get_packets(events, batch_size, 0.1);
+            if (events.size() == 1 &&
+                (events[0].type == ClientEvent::Exit ||
+                 events[0].type == ClientEvent::Error)) {
+                if (events[0].type == ClientEvent::Error) {
+                    logger().error("PacketRelay: the client failed");
+                }
+                break;
+            }
+            forward(events);
+        }
+    });
+}
+
+void PacketRelay::stop() {
+    running_ = false;
+    if (thread_.joinable()) thread_.join();
+}
+
+PacketRelayStats PacketRelay::stats() const {
+    std::lock_guard<std::mutex> lock(impl_->stats_mtx);
+    return impl_->stats;
+}
+
+}  // namespace sensor
+}  // namespace ouster
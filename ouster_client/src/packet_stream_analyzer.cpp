@@ -0,0 +1,291 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/packet_stream_analyzer.h"
+
+#include <algorithm>
+
+namespace ouster {
+namespace sensor {
+
+namespace {
+
+// frame ids wrap around at 16 bits
+constexpr uint32_t frame_id_mask = 0xFFFF;
+
+// legacy IMU packets are sent at 100 Hz
+constexpr uint64_t imu_period_ns = 10000000;
+
+constexpr uint64_t rate_window_ns = 1000000000;
+
+}  // namespace
+
+PacketStreamAnalyzer::PacketStreamAnalyzer(const sensor_info& info,
+                                           size_t max_missing_ranges)
+    : info_(info),
+      pf_(get_format(info)),
+      cols_(static_cast<int>(info.format.columns_per_frame)),
+      window_start_(info.format.column_window.first),
+      seen_((info.format.columns_per_frame + 63) / 64, 0),
+      ranges_(max_missing_ranges) {
+    const int end = info.format.column_window.second;
+    window_width_ = cols_ ? (end - window_start_ + cols_) % cols_ + 1 : 0;
+    fps_ = info.format.fps ? info.format.fps : 10;
+    const uint64_t columns_per_second =
+        static_cast<uint64_t>(fps_) * std::max(cols_, 1);
+    lidar_period_ = pf_.columns_per_packet * 1000000000ull / columns_per_second;
+}
+
+void PacketStreamAnalyzer::operator()(const Packet& packet) {
+    switch (packet.type()) {
+        case PacketType::Lidar:
+            (*this)(static_cast<const LidarPacket&>(packet));
+            break;
+        case PacketType::Imu:
+            (*this)(static_cast<const ImuPacket&>(packet));
+            break;
+        default:
+            break;
+    }
+}
+
+void PacketStreamAnalyzer::operator()(const LidarPacket& packet) {
+    const uint8_t* buf = packet.buf.data();
+    if (validate_packet(info_, pf_, buf, packet.buf.size(),
+                        PacketType::Lidar) != PacketValidationFailure::NONE) {
+        invalid_packets_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    lidar_packets_.fetch_add(1, std::memory_order_relaxed);
+    const uint64_t ts = packet.host_timestamp;
+    count_rate(lidar_, ts);
+
+    const uint32_t init_id = pf_.init_id(buf);
+    if (started_ && init_id != init_id_) {
+        if (in_frame_) complete_frame();
+        started_ = false;
+        last_col_ts_ = 0;
+        reinits_.fetch_add(1, std::memory_order_relaxed);
+    }
+    init_id_ = init_id;
+
+    const uint32_t frame_id = pf_.frame_id(buf) & frame_id_mask;
+    if (!started_) {
+        start_frame(frame_id);
+    } else if (frame_id != frame_id_ || !in_frame_) {
+        const uint32_t ahead = (frame_id - frame_id_) & frame_id_mask;
+        if (ahead == 0 || ahead > frame_id_mask / 2) {
+            late_packets_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (in_frame_) complete_frame();
+        missing_frames_.fetch_add(ahead - 1, std::memory_order_relaxed);
+        start_frame(frame_id);
+    }
+
+    // columns are ordered by their position in the column window, which may
+    // wrap around measurement id 0
+    const int64_t last_pos = last_pos_;
+    int64_t first_pos = -1;
+    for (int icol = 0; icol < pf_.columns_per_packet; icol++) {
+        const uint8_t* col = pf_.nth_col(icol, buf);
+        if (!(pf_.col_status(col) & 0x01)) continue;
+        const uint16_t mid = pf_.col_measurement_id(col);
+        if (mid >= cols_) continue;
+        uint64_t& word = seen_[mid / 64];
+        const uint64_t bit = uint64_t{1} << (mid % 64);
+        if (word & bit) {
+            duplicate_columns_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        word |= bit;
+        const int64_t pos = (mid - window_start_ + cols_) % cols_;
+        if (first_pos < 0) first_pos = pos;
+        if (pos > last_pos_) {
+            const uint64_t col_ts = pf_.col_timestamp(col);
+            if (last_col_ts_ && col_ts <= last_col_ts_) {
+                timestamp_regressions_.fetch_add(1, std::memory_order_relaxed);
+            }
+            last_pos_ = pos;
+            last_col_ts_ = col_ts;
+        }
+    }
+
+    if (first_pos >= 0 && first_pos < last_pos) {
+        reordered_packets_.fetch_add(1, std::memory_order_relaxed);
+    } else if (first_pos >= 0 && last_packet_pos_ >= 0 &&
+               first_pos == last_packet_pos_ + pf_.columns_per_packet) {
+        // only packets sent one period apart tell the jitter
+        record_interarrival(lidar_, ts, lidar_period_);
+    }
+    if (first_pos >= 0) last_packet_pos_ = first_pos;
+    if (ts) lidar_.last_ts = ts;
+}
+
+void PacketStreamAnalyzer::operator()(const ImuPacket& packet) {
+    if (validate_packet(info_, pf_, packet.buf.data(), packet.buf.size(),
+                        PacketType::Imu) != PacketValidationFailure::NONE) {
+        invalid_packets_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    imu_packets_.fetch_add(1, std::memory_order_relaxed);
+    const uint64_t ts = packet.host_timestamp;
+    count_rate(imu_, ts);
+    record_interarrival(imu_, ts, imu_period_ns);
+    if (ts) imu_.last_ts = ts;
+}
+
+void PacketStreamAnalyzer::count_rate(Timing& timing, uint64_t ts) {
+    // packets without host timestamps can't be timed
+    if (!ts) return;
+    if (!timing.window_start || ts < timing.window_start) {
+        timing.window_start = ts;
+        timing.window_packets = 0;
+        return;
+    }
+    timing.window_packets++;
+    const uint64_t elapsed = ts - timing.window_start;
+    if (elapsed < rate_window_ns) return;
+    const double rate = timing.window_packets * 1e9 / elapsed;
+    const double min_rate = timing.min_rate.load(std::memory_order_relaxed);
+    const double max_rate = timing.max_rate.load(std::memory_order_relaxed);
+    timing.rate.store(rate, std::memory_order_relaxed);
+    if (min_rate == 0 || rate < min_rate) {
+        timing.min_rate.store(rate, std::memory_order_relaxed);
+    }
+    if (rate > max_rate) timing.max_rate.store(rate, std::memory_order_relaxed);
+    timing.window_start = ts;
+    timing.window_packets = 0;
+}
+
+void PacketStreamAnalyzer::record_interarrival(Timing& timing, uint64_t ts,
+                                               uint64_t period) {
+    if (!ts || !timing.last_ts || ts < timing.last_ts) return;
+    const uint64_t interarrival = ts - timing.last_ts;
+    timing.interarrival.record(interarrival);
+    timing.jitter.record(interarrival > period ? interarrival - period
+                                               : period - interarrival);
+}
+
+void PacketStreamAnalyzer::start_frame(uint32_t frame_id) {
+    started_ = true;
+    in_frame_ = true;
+    frame_id_ = frame_id;
+    last_pos_ = -1;
+    last_packet_pos_ = -1;
+}
+
+void PacketStreamAnalyzer::complete_frame() {
+    in_frame_ = false;
+    frames_.fetch_add(1, std::memory_order_relaxed);
+    uint64_t missing = 0;
+    int run_first = -1;
+    int previous = -1;
+    for (int pos = 0; pos < window_width_; pos++) {
+        const int mid = (window_start_ + pos) % cols_;
+        const bool seen = (seen_[mid / 64] >> (mid % 64)) & 1;
+        if (!seen) {
+            missing++;
+            if (run_first < 0) run_first = mid;
+        } else if (run_first >= 0) {
+            add_range(run_first, previous);
+            run_first = -1;
+        }
+        previous = mid;
+    }
+    if (run_first >= 0) add_range(run_first, previous);
+    if (missing) {
+        incomplete_frames_.fetch_add(1, std::memory_order_relaxed);
+        missing_columns_.fetch_add(missing, std::memory_order_relaxed);
+    }
+    std::fill(seen_.begin(), seen_.end(), 0);
+}
+
+void PacketStreamAnalyzer::add_range(int first, int last) {
+    if (ranges_.empty()) return;
+    MissingColumns range;
+    range.frame_id = frame_id_;
+    range.first = static_cast<uint16_t>(first);
+    range.last = static_cast<uint16_t>(last);
+    std::lock_guard<std::mutex> lock(ranges_mutex_);
+    ranges_[ranges_next_] = range;
+    ranges_next_ = (ranges_next_ + 1) % ranges_.size();
+    ranges_count_ = std::min(ranges_count_ + 1, ranges_.size());
+}
+
+void PacketStreamAnalyzer::flush() {
+    if (in_frame_) complete_frame();
+}
+
+void PacketStreamAnalyzer::reset() {
+    for (auto* counter :
+         {&lidar_packets_, &imu_packets_, &invalid_packets_, &frames_,
+          &incomplete_frames_, &missing_columns_, &missing_frames_,
+          &late_packets_, &reordered_packets_, &duplicate_columns_,
+          &timestamp_regressions_, &reinits_}) {
+        counter->store(0);
+    }
+    for (auto* timing : {&lidar_, &imu_}) {
+        timing->last_ts = 0;
+        timing->window_start = 0;
+        timing->window_packets = 0;
+        timing->interarrival.reset();
+        timing->jitter.reset();
+        timing->rate = 0;
+        timing->min_rate = 0;
+        timing->max_rate = 0;
+    }
+    started_ = false;
+    in_frame_ = false;
+    last_col_ts_ = 0;
+    std::fill(seen_.begin(), seen_.end(), 0);
+    std::lock_guard<std::mutex> lock(ranges_mutex_);
+    ranges_next_ = 0;
+    ranges_count_ = 0;
+}
+
+PacketStreamStats PacketStreamAnalyzer::stats() const {
+    PacketStreamStats stats;
+    stats.lidar_packets = lidar_packets_.load();
+    stats.imu_packets = imu_packets_.load();
+    stats.invalid_packets = invalid_packets_.load();
+    stats.frames = frames_.load();
+    stats.incomplete_frames = incomplete_frames_.load();
+    stats.missing_columns = missing_columns_.load();
+    stats.missing_frames = missing_frames_.load();
+    stats.late_packets = late_packets_.load();
+    stats.reordered_packets = reordered_packets_.load();
+    stats.duplicate_columns = duplicate_columns_.load();
+    stats.timestamp_regressions = timestamp_regressions_.load();
+    stats.reinits = reinits_.load();
+    stats.lidar_interarrival = lidar_.interarrival.summary();
+    stats.lidar_jitter = lidar_.jitter.summary();
+    stats.imu_interarrival = imu_.interarrival.summary();
+    stats.imu_jitter = imu_.jitter.summary();
+    stats.lidar_rate = lidar_.rate.load();
+    stats.min_lidar_rate = lidar_.min_rate.load();
+    stats.max_lidar_rate = lidar_.max_rate.load();
+    stats.imu_rate = imu_.rate.load();
+    stats.min_imu_rate = imu_.min_rate.load();
+    stats.max_imu_rate = imu_.max_rate.load();
+    // a column window narrower than the frame is sent in fewer packets
+    const int cpp = pf_.columns_per_packet;
+    stats.expected_lidar_rate =
+        static_cast<double>(fps_) * ((window_width_ + cpp - 1) / cpp);
+    stats.expected_imu_rate = 1e9 / imu_period_ns;
+
+    std::lock_guard<std::mutex> lock(ranges_mutex_);
+    stats.missing_ranges.reserve(ranges_count_);
+    const size_t oldest =
+        ranges_count_ < ranges_.size() ? 0 : ranges_next_;
+    for (size_t i = 0; i < ranges_count_; i++) {
+        stats.missing_ranges.push_back(
+            ranges_[(oldest + i) % ranges_.size()]);
+    }
+    return stats;
+}
+
+}  // namespace sensor
+}  // namespace ouster
@@ -0,0 +1,253 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/parallel_scan_batcher.h"
+
+#include <algorithm>
+#include <deque>
+#include <stdexcept>
+#include <thread>
+
+#include "ouster/scan_pool.h"
+#include "ouster/threads.h"
+
+namespace ouster {
+
+namespace {
+// recycled scans to keep per sensor
+constexpr size_t pooled_scans = 4;
+}  // namespace
+
+struct ParallelScanBatcher::Worker {
+    Worker(const sensor::sensor_info& info, const LidarScanFieldTypes& fields)
+        : batcher(info),
+          pool(info, fields, pooled_scans),
+          scan(pool.acquire()) {}
+
+    ScanBatcher batcher;
+    ScanPool pool;
+    std::unique_ptr<LidarScan> scan;  // being batched, only used by thread
+    // whether a packet went into scan since it was acquired, and the frame id
+    // of the last scan handed out
+    bool dirty{false};
+    int64_t last_frame_id{-1};
+
+    // guarded by mutex
+    std::mutex mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    std::deque<std::pair<uint64_t, sensor::LidarPacket>> queue;
+    std::vector<sensor::LidarPacket> spare;
+    bool busy{false};       // batching the packet busy_seq
+    uint64_t busy_seq{0};
+    bool stop{false};
+    bool exited{false};
+
+    std::thread thread;
+};
+
+ParallelScanBatcher::ParallelScanBatcher(
+    const std::vector<sensor::sensor_info>& infos,
+    const std::vector<LidarScanFieldTypes>& fields, size_t queue_size)
+    : queue_size_{queue_size} {
+    if (!fields.empty() && fields.size() != infos.size()) {
+        throw std::invalid_argument(
+            "ParallelScanBatcher: expected field types for every sensor");
+    }
+    if (queue_size == 0) {
+        throw std::invalid_argument(
+            "ParallelScanBatcher: queue size must be greater than zero");
+    }
+    for (size_t i = 0; i < infos.size(); i++) {
+        const auto& ft = fields.empty() ? get_field_types(infos[i]) : fields[i];
+        workers_.push_back(std::make_unique<Worker>(infos[i], ft));
+    }
+    for (size_t i = 0; i < workers_.size(); i++) {
+        workers_[i]->thread = start_thread("ouster-pbatch-" + std::to_string(i),
+                                           [this, i] { run_worker(i); });
+    }
+}
+
+ParallelScanBatcher::~ParallelScanBatcher() {
+    for (auto& w : workers_) {
+        {
+            std::lock_guard<std::mutex> lock(w->mutex);
+            w->queue.clear();
+        }
+    }
+    finish();
+    for (auto& w : workers_) {
+        if (w->thread.joinable()) w->thread.join();
+    }
+}
+
+void ParallelScanBatcher::push(size_t sensor_idx,
+                               const sensor::LidarPacket& packet) {
+    if (sensor_idx >= workers_.size()) {
+        throw std::invalid_argument("Sensor index out of range.");
+    }
+    if (finishing_) {
+        throw std::runtime_error("ParallelScanBatcher: push after finish");
+    }
+    auto& w = *workers_[sensor_idx];
+    std::unique_lock<std::mutex> lock(w.mutex);
+    w.not_full.wait(lock, [&] { return w.queue.size() < queue_size_; });
+
+    sensor::LidarPacket copy;
+    if (!w.spare.empty()) {
+        copy = std::move(w.spare.back());
+        w.spare.pop_back();
+    }
+    copy = packet;
+    // taken under the worker's lock so that a worker with an empty queue can
+    // tell which of its packets it has batched, see batched_before
+    const uint64_t seq = next_seq_++;
+    w.queue.emplace_back(seq, std::move(copy));
+    lock.unlock();
+    w.not_empty.notify_one();
+}
+
+void ParallelScanBatcher::finish() {
+    finishing_ = true;
+    for (auto& w : workers_) {
+        {
+            std::lock_guard<std::mutex> lock(w->mutex);
+            w->stop = true;
+        }
+        w->not_empty.notify_one();
+    }
+}
+
+void ParallelScanBatcher::run_worker(size_t sensor_idx) {
+    auto& w = *workers_[sensor_idx];
+    std::unique_lock<std::mutex> lock(w.mutex);
+    while (true) {
+        w.not_empty.wait(lock, [&] { return !w.queue.empty() || w.stop; });
+        if (w.queue.empty()) break;
+
+        auto item = std::move(w.queue.front());
+        w.queue.pop_front();
+        w.busy = true;
+        w.busy_seq = item.first;
+        lock.unlock();
+        w.not_full.notify_one();
+
+        if (w.batcher(item.second, *w.scan)) {
+            w.last_frame_id = w.scan->frame_id;
+            {
+                std::lock_guard<std::mutex> out_lock(out_mutex_);
+                ready_.emplace(item.first,
+                               std::make_pair(static_cast<int>(sensor_idx),
+                                              std::move(w.scan)));
+            }
+            // the packet that cut the scan is cached by the batcher and only
+            // written to the next scan along with the following packet
+            w.scan = w.pool.acquire();
+            w.dirty = false;
+        } else {
+            w.dirty = true;
+        }
+
+        lock.lock();
+        w.busy = false;
+        w.spare.push_back(std::move(item.second));
+        lock.unlock();
+        wake_consumer();
+        lock.lock();
+    }
+    w.exited = true;
+    lock.unlock();
+    wake_consumer();
+}
+
+void ParallelScanBatcher::wake_consumer() {
+    // consumers register before checking, so either they see this worker's
+    // progress or this sees them
+    if (consumers_waiting_ > 0) {
+        std::lock_guard<std::mutex> lock(out_mutex_);
+        out_cv_.notify_all();
+    }
+}
+
+bool ParallelScanBatcher::batched_before(uint64_t seq) {
+    for (auto& w : workers_) {
+        std::lock_guard<std::mutex> lock(w->mutex);
+        if (w->busy && w->busy_seq <= seq) return false;
+        if (!w->queue.empty() && w->queue.front().first < seq) return false;
+    }
+    return true;
+}
+
+bool ParallelScanBatcher::all_done() {
+    if (!finishing_ || !ready_.empty()) return false;
+    for (auto& w : workers_) {
+        std::lock_guard<std::mutex> lock(w->mutex);
+        if (!w->exited) return false;
+    }
+    return true;
+}
+
+std::pair<int, std::unique_ptr<LidarScan>> ParallelScanBatcher::take_ready() {
+    if (ready_.empty() || !batched_before(ready_.begin()->first)) {
+        return {-1, nullptr};
+    }
+    auto result = std::move(ready_.begin()->second);
+    ready_.erase(ready_.begin());
+    return result;
+}
+
+std::pair<int, std::unique_ptr<LidarScan>> ParallelScanBatcher::pop() {
+    std::unique_lock<std::mutex> lock(out_mutex_);
+    consumers_waiting_++;
+    while (true) {
+        auto result = take_ready();
+        if (result.second || all_done()) {
+            consumers_waiting_--;
+            return result;
+        }
+        out_cv_.wait(lock);
+    }
+}
+
+std::pair<int, std::unique_ptr<LidarScan>> ParallelScanBatcher::try_pop() {
+    std::lock_guard<std::mutex> lock(out_mutex_);
+    return take_ready();
+}
+
+std::vector<std::pair<int, std::unique_ptr<LidarScan>>>
+ParallelScanBatcher::take_unfinished() {
+    std::vector<std::pair<int, std::unique_ptr<LidarScan>>> result;
+    {
+        std::lock_guard<std::mutex> lock(out_mutex_);
+        if (!all_done()) return result;
+    }
+    for (size_t i = 0; i < workers_.size(); i++) {
+        auto& w = *workers_[i];
+        std::lock_guard<std::mutex> lock(w.mutex);
+        if (!w.dirty || !w.scan || w.scan->frame_id == -1 ||
+            w.scan->frame_id == w.last_frame_id)
+            continue;
+        w.dirty = false;
+        // pool scans aren't zeroed, clear the columns of the missing packets
+        w.batcher.finish_scan(*w.scan);
+        result.emplace_back(static_cast<int>(i), std::move(w.scan));
+    }
+    std::stable_sort(result.begin(), result.end(),
+                     [](const auto& a, const auto& b) {
+                         return a.second->get_first_valid_packet_timestamp() <
+                                b.second->get_first_valid_packet_timestamp();
+                     });
+    return result;
+}
+
+void ParallelScanBatcher::recycle(int sensor_idx,
+                                  std::unique_ptr<LidarScan> scan) {
+    if (sensor_idx < 0 || sensor_idx >= static_cast<int>(workers_.size())) {
+        throw std::invalid_argument("Sensor index out of range.");
+    }
+    workers_[sensor_idx]->pool.release(std::move(scan));
+}
+
+}  // namespace ouster
@@ -5,6 +5,7 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cmath>
 #include <cstdint>
 #include <cstring>
@@ -14,8 +15,12 @@
 #include <stdexcept>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
+#include "ouster/impl/field_decode.h"
+#include "ouster/impl/lidar_scan_impl.h"
 #include "ouster/impl/packet_writer.h"
+#include "ouster/lidar_scan.h"
 #include "ouster/types.h"
 
 namespace ouster {
@@ -472,22 +477,20 @@ void packet_format::block_field(Eigen::Ref<img_t<T>> field,
     int cols = field.cols();
 
     T* data = field.data();
-    std::array<const uint8_t*, BlockDim> col_buf;
+    // columns of a packet are laid out col_size apart, so each pixel row of a
+    // block is one strided decode
+    static const impl::decode_fn decode =
+        impl::get_decode_fn(impl::best_decode_kernel(), sizeof(T));
 
     for (int icol = 0; icol < columns_per_packet; icol += BlockDim) {
-        for (int i = 0; i < BlockDim; ++i) {
-            col_buf[i] = nth_col(icol + i, packet_buf);
-        }
-
-        uint16_t m_id = col_measurement_id(col_buf[0]);
+        const uint8_t* col_buf = nth_col(icol, packet_buf);
+        uint16_t m_id = col_measurement_id(col_buf);
+        const uint8_t* px_src = col_buf + col_header_size + f.offset;
 
         for (int px = 0; px < pixels_per_column; ++px) {
             std::ptrdiff_t f_offset = cols * px + m_id;
-            for (int x = 0; x < BlockDim; ++x) {
-                auto px_src =
-                    col_buf[x] + col_header_size + (px * channel_data_size);
-                *(data + f_offset + x) = f.get<T>(px_src);
-            }
+            decode(px_src + px * channel_data_size, col_size, BlockDim, f.mask,
+                   f.shift, reinterpret_cast<uint8_t*>(data + f_offset));
         }
     }
 }
@@ -509,6 +512,25 @@ void packet_format::col_field(const uint8_t* col_buf, const std::string& i,
     }
 }
 
+template <typename T>
+void packet_format::col_field(const uint8_t* col_buf, const std::string& i,
+                              T* dst, int dst_stride,
+                              const std::vector<size_t>& pixels) const {
+    impl::FieldInfo f = impl_->fields.at(i);
+
+    if (sizeof(T) < field_type_size(f.ty_tag))
+        throw std::invalid_argument("Dest type too small for specified field");
+
+    size_t channel_data_size = impl_->channel_data_size;
+
+    for (size_t j = 0; j < pixels.size(); j++) {
+        auto px_src =
+            col_buf + col_header_size + (pixels[j] * channel_data_size);
+        T* px_dst = dst + j * dst_stride;
+        *px_dst = f.get<T>(px_src);
+    }
+}
+
 // explicitly instantiate for each field type / block dim
 template void packet_format::block_field<uint8_t, 4>(
     Eigen::Ref<img_t<uint8_t>> field, const std::string& chan,
@@ -622,6 +644,36 @@ template void packet_format::col_field(const uint8_t*, const std::string&,
                                        float*, int) const;
 template void packet_format::col_field(const uint8_t*, const std::string&,
                                        double*, int) const;
+template void packet_format::col_field(const uint8_t*, const std::string&,
+                                       uint8_t*, int,
+                                       const std::vector<size_t>&) const;
+template void packet_format::col_field(const uint8_t*, const std::string&,
+                                       uint16_t*, int,
+                                       const std::vector<size_t>&) const;
+template void packet_format::col_field(const uint8_t*, const std::string&,
+                                       uint32_t*, int,
+                                       const std::vector<size_t>&) const;
+template void packet_format::col_field(const uint8_t*, const std::string&,
+                                       uint64_t*, int,
+                                       const std::vector<size_t>&) const;
+template void packet_format::col_field(const uint8_t*, const std::string&,
+                                       int8_t*, int,
+                                       const std::vector<size_t>&) const;
+template void packet_format::col_field(const uint8_t*, const std::string&,
+                                       int16_t*, int,
+                                       const std::vector<size_t>&) const;
+template void packet_format::col_field(const uint8_t*, const std::string&,
+                                       int32_t*, int,
+                                       const std::vector<size_t>&) const;
+template void packet_format::col_field(const uint8_t*, const std::string&,
+                                       int64_t*, int,
+                                       const std::vector<size_t>&) const;
+template void packet_format::col_field(const uint8_t*, const std::string&,
+                                       float*, int,
+                                       const std::vector<size_t>&) const;
+template void packet_format::col_field(const uint8_t*, const std::string&,
+                                       double*, int,
+                                       const std::vector<size_t>&) const;
 
 ChanFieldType packet_format::field_type(const std::string& f) const {
     return impl_->fields.count(f) ? impl_->fields.at(f).ty_tag
@@ -801,18 +853,43 @@ const packet_format& get_format(UDPProfileLidar udp_profile_lidar,
                                 size_t pixels_per_column,
                                 size_t columns_per_packet) {
     using key = std::tuple<size_t, size_t, UDPProfileLidar>;
-    static std::map<key, std::unique_ptr<packet_format>> cache{};
-    static std::mutex cache_mx{};
+    using format_map = std::map<key, const packet_format*>;
+
+    // Lookups read an immutable snapshot of the cache without locking, adding
+    // a format publishes a new snapshot under the mutex. Old snapshots are
+    // kept, like the formats, since other threads may still be reading them.
+    struct format_cache {
+        std::mutex mx;
+        std::vector<std::unique_ptr<packet_format>> formats;
+        std::vector<std::unique_ptr<format_map>> snapshots;
+        std::atomic<const format_map*> current;
+
+        format_cache() {
+            snapshots.push_back(std::make_unique<format_map>());
+            current = snapshots.back().get();
+        }
+    };
+    static format_cache cache{};
 
     key k{pixels_per_column, columns_per_packet, udp_profile_lidar};
 
-    std::lock_guard<std::mutex> lk{cache_mx};
-    if (!cache.count(k)) {
-        cache[k] = std::make_unique<packet_format>(
-            udp_profile_lidar, pixels_per_column, columns_per_packet);
-    }
-
-    return *cache.at(k);
+    const format_map* snapshot = cache.current.load(std::memory_order_acquire);
+    auto it = snapshot->find(k);
+    if (it != snapshot->end()) return *it->second;
+
+    std::lock_guard<std::mutex> lk{cache.mx};
+    snapshot = cache.current.load(std::memory_order_relaxed);
+    it = snapshot->find(k);
+    if (it != snapshot->end()) return *it->second;
+
+    cache.formats.push_back(std::make_unique<packet_format>(
+        udp_profile_lidar, pixels_per_column, columns_per_packet));
+    auto updated = std::make_unique<format_map>(*snapshot);
+    (*updated)[k] = cache.formats.back().get();
+    cache.snapshots.push_back(std::move(updated));
+    cache.current.store(cache.snapshots.back().get(),
+                        std::memory_order_release);
+    return *cache.formats.back();
 }
 
 uint64_t packet_format::field_value_mask(const std::string& i) const {
@@ -895,6 +972,31 @@ void packet_writer::set_shot_limiting_countdown(
     impl_->countdown_shot_limiting_info.set(lidar_buf, shot_limiting_countdown);
 }
 
+// offsets as read by packet_format::imu_sys_ts and friends
+void packet_writer::set_imu_sys_ts(uint8_t* imu_buf, uint64_t ts) const {
+    std::memcpy(imu_buf, &ts, sizeof(uint64_t));
+}
+
+void packet_writer::set_imu_accel_ts(uint8_t* imu_buf, uint64_t ts) const {
+    std::memcpy(imu_buf + 8, &ts, sizeof(uint64_t));
+}
+
+void packet_writer::set_imu_gyro_ts(uint8_t* imu_buf, uint64_t ts) const {
+    std::memcpy(imu_buf + 16, &ts, sizeof(uint64_t));
+}
+
+void packet_writer::set_imu_la(uint8_t* imu_buf, float x, float y,
+                               float z) const {
+    const float la[3] = {x, y, z};
+    std::memcpy(imu_buf + 24, la, sizeof(la));
+}
+
+void packet_writer::set_imu_av(uint8_t* imu_buf, float x, float y,
+                               float z) const {
+    const float av[3] = {x, y, z};
+    std::memcpy(imu_buf + 36, av, sizeof(av));
+}
+
 template <typename T>
 void packet_writer::set_block(Eigen::Ref<const img_t<T>> field,
                               const std::string& chan,
@@ -1025,29 +1127,115 @@ template void packet_writer::unpack_raw_headers(
 template void packet_writer::unpack_raw_headers(
     Eigen::Ref<const img_t<double>> field, uint8_t* lidar_buf) const;
 
-static std::array<uint64_t, 256> crc64_init(void) {
+bool packet_writer::write_packet(const LidarScan& ls, size_t p_id,
+                                 uint8_t* lidar_buf, uint32_t init_id,
+                                 uint64_t prod_sn) const {
+    if (p_id >= static_cast<size_t>(ls.packet_timestamp().size()))
+        throw std::out_of_range("write_packet: no packet " +
+                                std::to_string(p_id) + " in scan");
+
+    std::memset(lidar_buf, 0, lidar_packet_size);
+
+    // Set alert flags, which may vary from packet to packet
+    set_alert_flags(lidar_buf, ls.alert_flags()[p_id]);
+
+    // Set shot-limiting and shutdown fields, which should be the same for
+    // all packets in the scan
+    set_shutdown(lidar_buf, ls.thermal_shutdown());
+    set_shot_limiting(lidar_buf, ls.shot_limiting());
+    set_shutdown_countdown(lidar_buf, ls.shutdown_countdown);
+    set_shot_limiting_countdown(lidar_buf, ls.shot_limiting_countdown);
+
+    // Set other scan-level attributes
+    set_packet_type(lidar_buf, 0x1);
+    set_frame_id(lidar_buf, ls.frame_id);
+    set_init_id(lidar_buf, init_id);
+    set_prod_sn(lidar_buf, prod_sn);
+
+    bool any_valid = false;
+    for (int icol = 0; icol < columns_per_packet; ++icol) {
+        uint8_t* col_buf = nth_col(icol, lidar_buf);
+        const size_t id = p_id * columns_per_packet + icol;
+
+        set_col_status(col_buf, ls.status()[id]);
+        set_col_measurement_id(col_buf, id);
+        set_col_timestamp(col_buf, ls.timestamp()[id]);
+
+        any_valid |= (ls.status()[id] & 0x01);
+    }
+
+    // do not emit packet if ts == 0 and none of the columns are valid
+    if (!any_valid && !ls.packet_timestamp()[p_id]) return false;
+
+    if (!encoder_ || !encoder_->encode_block(ls, lidar_buf)) {
+        ouster::impl::foreach_channel_field(
+            ls, *this, [this, lidar_buf](auto ref_field, const std::string& i) {
+                set_block(ref_field, i, lidar_buf);
+            });
+    }
+
+    if (ouster::impl::raw_headers_enabled(*this, ls)) {
+        ouster::impl::visit_field(ls, ChanField::RAW_HEADERS,
+                                  [this, lidar_buf](auto ref_field) {
+                                      unpack_raw_headers(ref_field, lidar_buf);
+                                  });
+    } else if (udp_profile_lidar != UDPProfileLidar::PROFILE_LIDAR_LEGACY) {
+        const uint64_t crc = calculate_crc(lidar_buf);
+        std::memcpy(lidar_buf + lidar_packet_size - sizeof(crc), &crc,
+                    sizeof(crc));
+    }
+    return true;
+}
+
+using crc64_tables = std::array<std::array<uint64_t, 256>, 8>;
+
+static crc64_tables crc64_init(void) {
     // Generate LUT of all possible 8-bit CRCs to speed up CRC calculation
     // This is for the ECMA-182 CRC64 implementation used on the sensor.
     constexpr uint64_t poly = 0xC96C5795D7870F42;
-    std::array<uint64_t, 256> arr = {0};
+    crc64_tables arr = {};
     for (uint32_t i = 0; i < 256; ++i) {
         uint64_t r = i;
         for (uint32_t j = 0; j < 8; ++j) {
             r = (r >> 1) ^ (poly & ~((r & 1) - 1));
         }
-        arr[i] = r;
+        arr[0][i] = r;
+    }
+    // table k advances the CRC of a byte by k more zero bytes, so that eight
+    // bytes can be folded in at once
+    for (size_t k = 1; k < arr.size(); ++k) {
+        for (uint32_t i = 0; i < 256; ++i) {
+            const uint64_t r = arr[k - 1][i];
+            arr[k][i] = arr[0][r & 0xFF] ^ (r >> 8);
+        }
     }
 
     return arr;
 }
 
-static std::array<uint64_t, 256> crc64_table = crc64_init();
+static const crc64_tables crc64_table = crc64_init();
 
 uint64_t crc64_compute(const uint8_t* buf, size_t len) {
     uint64_t crc = ~0;
-    // Use Sarwate algorithm LSB-first to calculate the CRC using the LUT.
+    // Slicing-by-8: fold in eight bytes per step with one lookup per byte
+    // into the tables, which carries no dependency between the lookups. Like
+    // the rest of the parsing code this assumes a little endian host.
+    while (len >= 8) {
+        uint64_t word;
+        std::memcpy(&word, buf, sizeof(word));
+        crc ^= word;
+        crc = crc64_table[7][crc & 0xFF] ^ crc64_table[6][(crc >> 8) & 0xFF] ^
+              crc64_table[5][(crc >> 16) & 0xFF] ^
+              crc64_table[4][(crc >> 24) & 0xFF] ^
+              crc64_table[3][(crc >> 32) & 0xFF] ^
+              crc64_table[2][(crc >> 40) & 0xFF] ^
+              crc64_table[1][(crc >> 48) & 0xFF] ^ crc64_table[0][crc >> 56];
+        buf += 8;
+        len -= 8;
+    }
+    // Use Sarwate algorithm LSB-first for the remaining bytes.
     while (len != 0) {
-        crc = crc64_table[*buf++ ^ (crc & 0xFF)] ^ (crc >> 8);
+        crc = crc64_table[0][*buf++ ^ (crc & 0xFF)] ^ (crc >> 8);
         --len;
     }
 
@@ -0,0 +1,446 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/pipeline.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <thread>
+
+#include "ouster/threads.h"
+
+namespace ouster {
+namespace impl {
+
+namespace {
+
+uint64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+}  // namespace
+
+// Runs the nodes of a pipeline. Every worker has a deque of the nodes
+// scheduled from it: it runs the newest of them first, as the node that was
+// just fed, then the nodes scheduled from other threads, then steals the
+// oldest node of another worker.
+class PipelineCore {
+   public:
+    explicit PipelineCore(const PipelineOptions& options) : options_(options) {
+        if (options_.threads == 0) {
+            options_.threads = sdk_thread_count();
+        }
+        if (options_.batch == 0) options_.batch = 1;
+    }
+
+    ~PipelineCore() { shutdown(); }
+
+    void schedule(PipelineNode* node) {
+        if (current_core == this) {
+            auto& worker = *workers_[current_worker];
+            std::lock_guard<std::mutex> lock(worker.mtx);
+            worker.nodes.push_back(node);
+        } else {
+            std::lock_guard<std::mutex> lock(inject_mtx_);
+            inject_.push_back(node);
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleep_mtx_);
+            pending_++;
+        }
+        sleep_cv_.notify_one();
+    }
+
+    void start() {
+        live_ = nodes_.size();
+        for (size_t i = 0; i < options_.threads; i++) {
+            workers_.push_back(std::make_unique<Worker>());
+        }
+        for (size_t i = 0; i < options_.threads; i++) {
+            workers_[i]->thread = start_thread(
+                "ouster-pipe-" + std::to_string(i), [this, i]() { work(i); });
+        }
+        for (auto source : sources_) {
+            source_threads_.push_back(
+                start_thread("ouster-src-" + source->name,
+                             [this, source]() { run_source(*source); }));
+        }
+    }
+
+    void shutdown() {
+        stopping_ = true;
+        for (auto& t : source_threads_) {
+            if (t.joinable()) t.join();
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleep_mtx_);
+            shutdown_ = true;
+        }
+        sleep_cv_.notify_all();
+        for (auto& w : workers_) {
+            if (w->thread.joinable()) w->thread.join();
+        }
+    }
+
+    bool wait_for(double timeout_sec) {
+        std::unique_lock<std::mutex> lock(done_mtx_);
+        auto done = [this]() { return live_ == 0; };
+        if (timeout_sec < 0) {
+            done_cv_.wait(lock, done);
+        } else if (!done_cv_.wait_for(
+                       lock, std::chrono::duration<double>(timeout_sec),
+                       done)) {
+            return false;
+        }
+        if (error_) std::rethrow_exception(error_);
+        return true;
+    }
+
+    void finish(PipelineNode& node) {
+        if (node.done_.exchange(true)) return;
+        for (auto out : node.outputs) out->close();
+        std::lock_guard<std::mutex> lock(done_mtx_);
+        live_--;
+        done_cv_.notify_all();
+    }
+
+    void fail(std::exception_ptr error) {
+        {
+            std::lock_guard<std::mutex> lock(done_mtx_);
+            if (!error_) error_ = error;
+        }
+        aborting_ = true;
+        stopping_ = true;
+    }
+
+    PipelineOptions options_;
+    std::vector<std::unique_ptr<PipelineNode>> nodes_;
+    std::vector<PipelineNode*> sources_;
+    std::vector<std::unique_ptr<PipelineEdge>> edges_;
+    bool started_{false};
+    std::atomic<bool> stopping_{false};
+    std::atomic<bool> aborting_{false};
+
+   private:
+    struct Worker {
+        std::mutex mtx;
+        std::deque<PipelineNode*> nodes;
+        std::thread thread;
+    };
+
+    static thread_local PipelineCore* current_core;
+    static thread_local size_t current_worker;
+
+    PipelineNode* find(size_t index) {
+        {
+            auto& own = *workers_[index];
+            std::lock_guard<std::mutex> lock(own.mtx);
+            if (!own.nodes.empty()) {
+                auto node = own.nodes.back();
+                own.nodes.pop_back();
+                return node;
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(inject_mtx_);
+            if (!inject_.empty()) {
+                auto node = inject_.front();
+                inject_.pop_front();
+                return node;
+            }
+        }
+        for (size_t i = 1; i < workers_.size(); i++) {
+            auto& other = *workers_[(index + i) % workers_.size()];
+            std::lock_guard<std::mutex> lock(other.mtx);
+            if (!other.nodes.empty()) {
+                auto node = other.nodes.front();
+                other.nodes.pop_front();
+                return node;
+            }
+        }
+        return nullptr;
+    }
+
+    void work(size_t index) {
+        current_core = this;
+        current_worker = index;
+        while (true) {
+            if (auto node = find(index)) {
+                pending_--;
+                run(*node);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mtx_);
+            sleep_cv_.wait(lock,
+                           [this]() { return shutdown_ || pending_ > 0; });
+            if (shutdown_) return;
+        }
+    }
+
+    void run(PipelineNode& node) {
+        size_t n = 0;
+        while (n < options_.batch) {
+            if (aborting_) {
+                node.discard();
+                break;
+            }
+            if (!node.outputs_ready()) {
+                // the consumer making room activates the node again, see
+                // PipelineNode::room_available
+                node.stalled_ = true;
+                if (!node.outputs_ready()) {
+                    node.stalls_++;
+                    break;
+                }
+                node.stalled_ = false;
+            }
+            const uint64_t t0 = now_ns();
+            bool stepped = false;
+            try {
+                stepped = node.step();
+            } catch (...) {
+                fail(std::current_exception());
+                continue;
+            }
+            if (!stepped) break;
+            const uint64_t t = now_ns() - t0;
+            node.latency_.record(t);
+            node.busy_ns_ += t;
+            n++;
+        }
+
+        node.scheduled_ = false;
+        if (node.done_) return;
+        if (node.input->drained()) {
+            finish(node);
+        } else if (node.input->size() > 0 &&
+                   (aborting_ || node.outputs_ready())) {
+            node.activate();
+        }
+    }
+
+    void run_source(PipelineNode& node) {
+        while (!stopping_) {
+            bool stalled = false;
+            bool ready = true;
+            for (auto out : node.outputs) {
+                if (out->ready()) continue;
+                stalled = true;
+                while (!stopping_ && !out->wait_ready(0.1)) {
+                }
+                ready = ready && !stopping_;
+            }
+            if (stalled) node.stalls_++;
+            if (!ready) break;
+            try {
+                const uint64_t t0 = now_ns();
+                const SourceStatus status = node.produce();
+                node.busy_ns_ += now_ns() - t0;
+                if (status == SourceStatus::END) break;
+            } catch (...) {
+                fail(std::current_exception());
+                break;
+            }
+        }
+        finish(node);
+    }
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> source_threads_;
+
+    std::mutex inject_mtx_;
+    std::deque<PipelineNode*> inject_;
+
+    // nodes scheduled but not picked up by a worker yet; may go below zero
+    // briefly as a node can be found before it is counted
+    std::mutex sleep_mtx_;
+    std::condition_variable sleep_cv_;
+    std::atomic<long> pending_{0};
+    bool shutdown_{false};
+
+    std::mutex done_mtx_;
+    std::condition_variable done_cv_;
+    size_t live_{0};
+    std::exception_ptr error_;
+};
+
+thread_local PipelineCore* PipelineCore::current_core = nullptr;
+thread_local size_t PipelineCore::current_worker = 0;
+
+PipelineNode::PipelineNode(PipelineCore& core, std::string name)
+    : name(std::move(name)), core_(core) {}
+
+PipelineNode::~PipelineNode() {}
+
+void PipelineNode::activate() {
+    if (input == nullptr || done_) return;
+    if (scheduled_.exchange(true)) return;
+    core_.schedule(this);
+}
+
+void PipelineNode::room_available() {
+    if (stalled_.exchange(false)) activate();
+}
+
+bool PipelineNode::outputs_ready() const {
+    for (auto out : outputs) {
+        if (!out->ready()) return false;
+    }
+    return true;
+}
+
+StageStats PipelineNode::stats() const {
+    StageStats res;
+    res.name = name;
+    res.items_in = items_in;
+    res.items_out = items_out;
+    res.stalls = stalls_;
+    res.busy_seconds = busy_ns_ * 1e-9;
+    res.latency = latency_.summary();
+    if (input) {
+        res.dropped = input->dropped;
+        res.queue_depth = input->size();
+        res.max_queue_depth = input->max_size;
+    }
+    return res;
+}
+
+PipelineEdge::PipelineEdge(const StageOptions& options, PipelineNode& consumer)
+    : consumer(consumer), options_(options) {}
+
+PipelineEdge::~PipelineEdge() {}
+
+bool PipelineEdge::ready() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return options_.backpressure != Backpressure::BLOCK ||
+           size_ < options_.queue_depth;
+}
+
+bool PipelineEdge::wait_ready(double timeout_sec) const {
+    std::unique_lock<std::mutex> lock(mtx_);
+    return room_.wait_for(lock, std::chrono::duration<double>(timeout_sec),
+                          [this]() {
+                              return options_.backpressure !=
+                                         Backpressure::BLOCK ||
+                                     size_ < options_.queue_depth;
+                          });
+}
+
+void PipelineEdge::close() {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        closed_ = true;
+    }
+    consumer.activate();
+}
+
+bool PipelineEdge::drained() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return closed_ && size_ == 0;
+}
+
+size_t PipelineEdge::size() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return size_;
+}
+
+void PipelineEdge::pushed_locked() {
+    size_++;
+    if (size_ > max_size) max_size = size_;
+}
+
+void PipelineEdge::popped() {
+    room_.notify_all();
+    if (producer) producer->room_available();
+}
+
+}  // namespace impl
+
+Pipeline::Pipeline(const PipelineOptions& options)
+    : core_(std::make_unique<impl::PipelineCore>(options)) {}
+
+Pipeline::~Pipeline() {
+    if (core_->started_) {
+        stop();
+        try {
+            wait();
+        } catch (...) {
+            // errors are reported by wait()
+        }
+    }
+}
+
+void Pipeline::start() {
+    if (core_->started_) throw std::logic_error("Pipeline: already started");
+    core_->started_ = true;
+    core_->start();
+}
+
+void Pipeline::stop() { core_->stopping_ = true; }
+
+void Pipeline::wait() {
+    if (!core_->started_) return;
+    try {
+        core_->wait_for(-1);
+    } catch (...) {
+        core_->shutdown();
+        throw;
+    }
+    core_->shutdown();
+}
+
+bool Pipeline::wait_for(double timeout_sec) {
+    if (!core_->started_) return true;
+    bool done = false;
+    try {
+        done = core_->wait_for(timeout_sec);
+    } catch (...) {
+        core_->shutdown();
+        throw;
+    }
+    if (done) core_->shutdown();
+    return done;
+}
+
+std::vector<StageStats> Pipeline::stats() const {
+    std::vector<StageStats> res;
+    for (const auto& node : core_->nodes_) res.push_back(node->stats());
+    return res;
+}
+
+void Pipeline::check_connect(const impl::PipelineNode* node,
+                             const StageOptions& options) const {
+    if (core_->started_) {
+        throw std::logic_error("Pipeline: can't add stages once started");
+    }
+    if (node == nullptr) {
+        throw std::invalid_argument("Pipeline: port is not connected");
+    }
+    if (options.queue_depth == 0) {
+        throw std::invalid_argument(
+            "Pipeline: queue depth must be greater than zero");
+    }
+}
+
+void Pipeline::add_source(std::unique_ptr<impl::PipelineNode> node) {
+    if (core_->started_) {
+        throw std::logic_error("Pipeline: can't add sources once started");
+    }
+    core_->sources_.push_back(node.get());
+    core_->nodes_.push_back(std::move(node));
+}
+
+void Pipeline::add_node(std::unique_ptr<impl::PipelineNode> node) {
+    core_->nodes_.push_back(std::move(node));
+}
+
+void Pipeline::add_edge(std::unique_ptr<impl::PipelineEdge> edge) {
+    core_->edges_.push_back(std::move(edge));
+}
+
+}  // namespace ouster
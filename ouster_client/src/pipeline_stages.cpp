@@ -0,0 +1,134 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/pipeline_stages.h"
+
+#include <stdexcept>
+
+#include "ouster/field_ops.h"
+#include "ouster/scan_serialization.h"
+
+using ouster::sensor::ClientEvent;
+using ouster::sensor::LidarPacket;
+using ouster::sensor::PacketType;
+
+namespace ouster {
+
+namespace {
+
+Field& checked_field(LidarScan& scan, const std::string& name,
+                     const std::string& stage) {
+    if (!scan.has_field(name)) {
+        throw std::invalid_argument(stage + ": scan has no field " + name);
+    }
+    return scan.field(name);
+}
+
+}  // namespace
+
+SourceFn<ClientEvent> packet_source(sensor::SensorClient& client,
+                                    double timeout_sec) {
+    return [&client, timeout_sec](ClientEvent& out) {
+        out = client.get_pooled_packet(timeout_sec);
+        switch (out.type) {
+            case ClientEvent::Packet:
+                return SourceStatus::ITEM;
+            case ClientEvent::PollTimeout:
+                return SourceStatus::TIMEOUT;
+            case ClientEvent::Exit:
+                return SourceStatus::END;
+            default:
+                throw std::runtime_error("packet_source: the client failed");
+        }
+    };
+}
+
+SourceFn<ScanPtr> scan_source(sensor::SensorScanSource& source,
+                              double timeout_sec) {
+    return [&source, timeout_sec](ScanPtr& out) {
+        auto result = source.get_scan(timeout_sec);
+        if (!result.second) return SourceStatus::TIMEOUT;
+        out = std::move(result.second);
+        return SourceStatus::ITEM;
+    };
+}
+
+StageFn<ClientEvent, ScanPtr> batch_stage(
+    const std::vector<sensor::sensor_info>& infos) {
+    // state of the stage, which runs on one worker at a time
+    struct Batching {
+        std::vector<sensor::sensor_info> infos;
+        std::vector<ScanBatcher> batchers;
+        std::vector<ScanPtr> scans;
+    };
+    auto state = std::make_shared<Batching>();
+    state->infos = infos;
+    for (const auto& info : infos) {
+        state->batchers.emplace_back(info);
+        state->scans.push_back(std::make_shared<LidarScan>(info));
+    }
+    return [state](ClientEvent& ev, ScanPtr& out) {
+        if (ev.source < 0 ||
+            static_cast<size_t>(ev.source) >= state->batchers.size() ||
+            ev.packet().type() != PacketType::Lidar) {
+            return false;
+        }
+        auto& scan = state->scans[ev.source];
+        const auto& lp = static_cast<LidarPacket&>(ev.packet());
+        if (!state->batchers[ev.source](lp, *scan)) return false;
+        out = std::move(scan);
+        scan = std::make_shared<LidarScan>(state->infos[ev.source]);
+        return true;
+    };
+}
+
+StageFn<ScanPtr, ScanPtr> clip_stage(const std::string& field, double lower,
+                                     double upper) {
+    return [field, lower, upper](ScanPtr& in, ScanPtr& out) {
+        field_ops::clip(checked_field(*in, field, "clip_stage"), lower, upper);
+        out = std::move(in);
+        return true;
+    };
+}
+
+StageFn<ScanPtr, ScanPtr> threshold_stage(const std::string& field,
+                                          double lower, double upper,
+                                          double invalid) {
+    return [field, lower, upper, invalid](ScanPtr& in, ScanPtr& out) {
+        field_ops::threshold(checked_field(*in, field, "threshold_stage"),
+                             lower, upper, invalid);
+        out = std::move(in);
+        return true;
+    };
+}
+
+StageFn<ScanPtr, EncodedScan> encode_stage(bool compress) {
+    return [compress](ScanPtr& in, EncodedScan& out) {
+        out = std::make_shared<const std::vector<uint8_t>>(
+            serialize_scan(*in, compress));
+        return true;
+    };
+}
+
+SinkFn<ScanPtr> scan_hub_sink(ScanHub& hub) {
+    return [&hub](ScanPtr& scan) { hub.publish(std::move(scan)); };
+}
+
+SinkFn<ScanPtr> shm_scan_sink(ShmScanWriter& writer) {
+    return [&writer](ScanPtr& scan) { writer.publish(*scan); };
+}
+
+SinkFn<ScanPtr> scan_stream_sink(ScanStreamServer& server) {
+    return [&server](ScanPtr& scan) { server.publish(std::move(scan)); };
+}
+
+SinkFn<ScanPtr> point_cloud_sink(PointCloudWriter& writer, const XYZLut& lut,
+                                 const std::string& key_field) {
+    return [&writer, lut, key_field](ScanPtr& scan) {
+        writer.write(*scan, lut, key_field);
+    };
+}
+
+}  // namespace ouster
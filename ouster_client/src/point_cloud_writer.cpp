@@ -0,0 +1,334 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/point_cloud_writer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ouster/impl/lidar_scan_impl.h"
+#include "ouster/threads.h"
+
+namespace ouster {
+
+namespace {
+
+// LAS coordinates are stored as integer millimeters
+constexpr double las_scale = 0.001;
+constexpr size_t las_header_size = 227;
+constexpr size_t las_record_size = 20;
+// offsets of the fields filled in on close in the LAS 1.2 header
+constexpr size_t las_count_offset = 107;
+constexpr size_t las_bounds_offset = 179;
+
+// width of the zero padded point counts of the PLY and PCD headers
+constexpr int count_digits = 10;
+
+struct Block {
+    std::string bytes;
+    size_t count = 0;
+    Eigen::Vector3d min = Eigen::Vector3d::Constant(
+        std::numeric_limits<double>::infinity());
+    Eigen::Vector3d max = -min;
+};
+
+template <typename T>
+void put(std::string& out, size_t at, T value) {
+    std::memcpy(&out[at], &value, sizeof(T));
+}
+
+std::string padded(size_t count) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%0*zu", count_digits, count);
+    return buf;
+}
+
+std::string make_header(PointCloudFormat format, const std::string& key,
+                        size_t count) {
+    switch (format) {
+        case PointCloudFormat::PLY:
+            return "ply\nformat binary_little_endian 1.0\nelement vertex " +
+                   padded(count) +
+                   "\nproperty float x\nproperty float y\n"
+                   "property float z\nproperty float " +
+                   key + "\nend_header\n";
+        case PointCloudFormat::PCD:
+            return "# .PCD v0.7 - Point Cloud Data file format\n"
+                   "VERSION 0.7\nFIELDS x y z " +
+                   key +
+                   "\nSIZE 4 4 4 4\nTYPE F F F F\nCOUNT 1 1 1 1\nWIDTH " +
+                   padded(count) +
+                   "\nHEIGHT 1\nVIEWPOINT 0 0 0 1 0 0 0\nPOINTS " +
+                   padded(count) + "\nDATA binary\n";
+        case PointCloudFormat::LAS: {
+            std::string h(las_header_size, '\0');
+            h.replace(0, 4, "LASF");
+            h[24] = 1;  // version 1.2
+            h[25] = 2;
+            const std::string software = "ouster-sdk";
+            h.replace(58, software.size(), software);
+            put<uint16_t>(h, 94, las_header_size);
+            put<uint32_t>(h, 96, las_header_size);  // offset to points
+            h[104] = 0;                             // point format 0
+            put<uint16_t>(h, 105, las_record_size);
+            for (size_t i = 0; i < 3; ++i) {
+                put<double>(h, 131 + 8 * i, las_scale);
+            }
+            return h;
+        }
+    }
+    throw std::invalid_argument("unknown point cloud format");
+}
+
+// encode the points accepted by keep as file records
+template <typename Point, typename Key, typename Keep>
+Block encode(PointCloudFormat format, Eigen::Index n, Point&& point,
+             Key&& key, Keep&& keep, float key_scale) {
+    Block block;
+    const size_t record =
+        format == PointCloudFormat::LAS ? las_record_size : 4 * sizeof(float);
+    block.bytes.resize(n * record);
+    char* out = &block.bytes[0];
+    for (Eigen::Index i = 0; i < n; ++i) {
+        if (!keep(i)) continue;
+        const Eigen::Vector3d p = point(i);
+        const float k = static_cast<float>(key(i)) * key_scale;
+        if (format == PointCloudFormat::LAS) {
+            int32_t xyz[3];
+            for (int j = 0; j < 3; ++j) {
+                xyz[j] = static_cast<int32_t>(std::lround(p(j) / las_scale));
+            }
+            const uint16_t intensity = static_cast<uint16_t>(
+                std::min(65535.0f, std::max(0.0f, std::round(k))));
+            std::memcpy(out, xyz, sizeof(xyz));
+            std::memcpy(out + 12, &intensity, sizeof(intensity));
+            out[14] = 0x09;  // return 1 of 1
+            std::memset(out + 15, 0, 5);
+            block.min = block.min.cwiseMin(p);
+            block.max = block.max.cwiseMax(p);
+        } else {
+            const float v[4] = {static_cast<float>(p(0)),
+                                static_cast<float>(p(1)),
+                                static_cast<float>(p(2)), k};
+            std::memcpy(out, v, sizeof(v));
+        }
+        out += record;
+        ++block.count;
+    }
+    block.bytes.resize(block.count * record);
+    return block;
+}
+
+bool same(const LidarScan::Points& a, const LidarScan::Points& b) {
+    return a.rows() == b.rows() && (a.array() == b.array()).all();
+}
+
+struct to_double {
+    template <typename T>
+    void operator()(Eigen::Ref<const img_t<T>> field,
+                    img_t<double>& out) const {
+        out = field.template cast<double>();
+    }
+};
+
+}  // namespace
+
+struct point_cloud_writer_impl {
+    std::ofstream out;
+    PointCloudFormat format;
+    std::string key_name;
+    float key_scale;
+    size_t threads;
+    std::deque<std::future<Block>> pending;
+    std::shared_ptr<const XYZLut> lut;
+    size_t written = 0;
+    Eigen::Vector3d min = Eigen::Vector3d::Constant(
+        std::numeric_limits<double>::infinity());
+    Eigen::Vector3d max = -min;
+
+    void check_open() const {
+        if (!out.is_open()) {
+            throw std::runtime_error("point cloud file is closed");
+        }
+    }
+
+    void write_block(Block block) {
+        out.write(block.bytes.data(), block.bytes.size());
+        if (!out) throw std::runtime_error("failed writing point cloud");
+        written += block.count;
+        if (block.count) {
+            min = min.cwiseMin(block.min);
+            max = max.cwiseMax(block.max);
+        }
+    }
+
+    // keep at most a block per worker thread in flight
+    void enqueue(std::future<Block> block) {
+        pending.push_back(std::move(block));
+        while (pending.size() > threads) pop();
+    }
+
+    void pop() {
+        std::future<Block> block = std::move(pending.front());
+        pending.pop_front();
+        write_block(block.get());
+    }
+};
+
+PointCloudWriter::PointCloudWriter(const std::string& filename,
+                                   PointCloudFormat format,
+                                   const std::string& key_name,
+                                   float key_scale, size_t threads)
+    : impl(new point_cloud_writer_impl) {
+    impl->format = format;
+    impl->key_name = key_name;
+    impl->key_scale = key_scale;
+    impl->threads = threads ? threads : sdk_thread_count();
+    const std::string header = make_header(format, key_name, 0);
+    impl->out.open(filename, std::ios::binary | std::ios::trunc);
+    if (!impl->out) {
+        throw std::runtime_error("failed to open " + filename);
+    }
+    impl->out.write(header.data(), header.size());
+}
+
+PointCloudWriter::~PointCloudWriter() {
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+void PointCloudWriter::write(const Eigen::Ref<const pose_util::Points>& points,
+                             const Eigen::Ref<const Eigen::ArrayXd>& keys) {
+    impl->check_open();
+    if (keys.size() != points.rows()) {
+        throw std::invalid_argument("expected a key per point");
+    }
+    pose_util::Points p = points;
+    Eigen::ArrayXd k = keys;
+    const PointCloudFormat format = impl->format;
+    const float scale = impl->key_scale;
+    impl->enqueue(std::async(
+        std::launch::async,
+        [format, scale](pose_util::Points p, Eigen::ArrayXd k) {
+            return encode(
+                format, p.rows(),
+                [&p](Eigen::Index i) -> Eigen::Vector3d {
+                    return p.row(i).transpose();
+                },
+                [&k](Eigen::Index i) { return k(i); },
+                [](Eigen::Index) { return true; }, scale);
+        },
+        std::move(p), std::move(k)));
+}
+
+void PointCloudWriter::write(const LidarScan& scan, const XYZLut& lut,
+                             const std::string& key_field, double min_z,
+                             double max_z) {
+    impl->check_open();
+    const Eigen::Index w = scan.w;
+    const Eigen::Index h = scan.h;
+    if (lut.direction.rows() != w * h) {
+        throw std::invalid_argument("scan doesn't match the lut");
+    }
+    if (!scan.has_field(key_field) ||
+        scan.field(key_field).field_class() != FieldClass::PIXEL_FIELD) {
+        throw std::invalid_argument("scan has no pixel field " + key_field);
+    }
+    img_t<uint32_t> range = scan.field<uint32_t>(sensor::ChanField::RANGE);
+    img_t<double> keys;
+    impl::visit_field_2d(scan.field(key_field), to_double{}, keys);
+    pose_util::Poses poses =
+        Eigen::Map<const pose_util::Poses>(scan.pose().get<double>(), w, 16);
+
+    // blocks may outlive the lut of the caller
+    if (!impl->lut || !same(impl->lut->direction, lut.direction) ||
+        !same(impl->lut->offset, lut.offset)) {
+        impl->lut = std::make_shared<const XYZLut>(lut);
+    }
+
+    const PointCloudFormat format = impl->format;
+    const float scale = impl->key_scale;
+    std::shared_ptr<const XYZLut> shared_lut = impl->lut;
+    impl->enqueue(std::async(
+        std::launch::async,
+        [format, scale, shared_lut, min_z, max_z](img_t<uint32_t> range,
+                                                  img_t<double> keys,
+                                                  pose_util::Poses poses) {
+            pose_util::Points points(range.size(), 3);
+            pose_util::cartesian_dewarp(points, range, *shared_lut, poses,
+                                        mat4d::Identity());
+            const uint32_t* r = range.data();
+            return encode(
+                format, points.rows(),
+                [&points](Eigen::Index i) -> Eigen::Vector3d {
+                    return points.row(i).transpose();
+                },
+                [&keys](Eigen::Index i) { return keys.data()[i]; },
+                [&](Eigen::Index i) {
+                    const double z = points(i, 2);
+                    return r[i] != 0 && z >= min_z && z <= max_z;
+                },
+                scale);
+        },
+        std::move(range), std::move(keys), std::move(poses)));
+}
+
+void PointCloudWriter::flush() {
+    while (!impl->pending.empty()) impl->pop();
+    impl->out.flush();
+}
+
+void PointCloudWriter::close() {
+    if (!impl->out.is_open()) return;
+    // write everything, or at least wait for the workers before giving up
+    try {
+        flush();
+    } catch (...) {
+        for (auto& block : impl->pending) block.wait();
+        impl->pending.clear();
+        impl->out.close();
+        throw;
+    }
+
+    std::string header = make_header(impl->format, impl->key_name,
+                                      impl->written);
+    if (impl->format == PointCloudFormat::LAS) {
+        put<uint32_t>(header, las_count_offset,
+                      static_cast<uint32_t>(impl->written));
+        put<uint32_t>(header, las_count_offset + 4,
+                      static_cast<uint32_t>(impl->written));
+        if (impl->written) {
+            for (int j = 0; j < 3; ++j) {
+                put<double>(header, las_bounds_offset + 16 * j,
+                            impl->max(j));
+                put<double>(header, las_bounds_offset + 16 * j + 8,
+                            impl->min(j));
+            }
+        }
+    }
+    impl->out.seekp(0);
+    impl->out.write(header.data(), header.size());
+    impl->out.close();
+    if (impl->out.fail()) {
+        throw std::runtime_error("failed writing point cloud header");
+    }
+}
+
+size_t PointCloudWriter::points_written() const { return impl->written; }
+
+bool PointCloudWriter::is_open() const { return impl->out.is_open(); }
+
+}  // namespace ouster
@@ -0,0 +1,785 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/impl/profile_parser.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+
+namespace ouster {
+namespace sensor {
+namespace impl {
+
+// definitions copied from parsing.cpp
+struct FieldInfo {
+    ChanFieldType ty_tag;
+    size_t offset;
+    uint64_t mask;
+    int shift;
+};
+
+struct ProfileEntry {
+    const std::pair<std::string, FieldInfo>* fields;
+    size_t n_fields;
+    size_t chan_data_size;
+};
+
+template <typename K, typename V, size_t N>
+using Table = std::array<std::pair<K, V>, N>;
+
+// parsing.cpp
+extern Table<UDPProfileLidar, ProfileEntry, MAX_NUM_PROFILES> profiles;
+
+namespace {
+
+/**
+ * Compile time equivalent of field_info() in parsing.cpp: a field of BitSize
+ * bits starting at bit BitStart of the channel data, shifted up by Upshift.
+ */
+template <size_t BitStart, size_t BitSize, size_t Upshift = 0>
+struct field_bits {
+    static_assert(BitSize > 0 && BitSize + Upshift < 64,
+                  "field does not fit a 64 bit word");
+
+    static constexpr size_t offset = BitStart / 8;
+    static constexpr uint64_t mask = ((uint64_t{1} << BitSize) - 1)
+                                     << (BitStart % 8);
+    static constexpr int shift =
+        static_cast<int>(BitStart % 8) - static_cast<int>(Upshift);
+    static constexpr size_t size_bytes = (BitSize + Upshift + 7) / 8;
+    static constexpr ChanFieldType ty_tag =
+        size_bytes == 1   ? ChanFieldType::UINT8
+        : size_bytes == 2 ? ChanFieldType::UINT16
+        : size_bytes <= 4 ? ChanFieldType::UINT32
+                          : ChanFieldType::UINT64;
+
+    template <typename T>
+    static T get(const uint8_t* buffer) {
+        uint64_t word;
+        std::memcpy(&word, buffer + offset, sizeof(word));
+        word &= mask;
+        word >>= (shift > 0 ? shift : 0);
+        word <<= (shift < 0 ? -shift : 0);
+
+        T out{};
+        std::memcpy(&out, &word, sizeof(out));
+        return out;
+    }
+
+    /// Inverse of get, as FieldInfo::set in parsing.cpp
+    template <typename T>
+    static void set(uint8_t* buffer, T value) {
+        uint64_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(value));
+        bits <<= (shift > 0 ? shift : 0);
+        bits >>= (shift < 0 ? -shift : 0);
+        uint64_t word;
+        std::memcpy(&word, buffer + offset, sizeof(word));
+        word = (word & ~mask) | (bits & mask);
+        std::memcpy(buffer + offset, &word, sizeof(word));
+    }
+};
+
+// Field layouts of the built-in profiles, these must match the tables in
+// parsing.cpp and are checked against them in make_profile_parser
+
+struct legacy_profile {
+    static constexpr UDPProfileLidar profile = PROFILE_LIDAR_LEGACY;
+    template <typename F>
+    static void for_each_field(F&& f) {
+        f(ChanField::RANGE, field_bits<0, 20>{});
+        f(ChanField::FLAGS, field_bits<28, 4>{});
+        f(ChanField::REFLECTIVITY, field_bits<32, 8>{});
+        f(ChanField::SIGNAL, field_bits<48, 16>{});
+        f(ChanField::NEAR_IR, field_bits<64, 16>{});
+        f(ChanField::RAW32_WORD1, field_bits<0, 32>{});
+        f(ChanField::RAW32_WORD2, field_bits<32, 32>{});
+        f(ChanField::RAW32_WORD3, field_bits<64, 32>{});
+    }
+};
+
+struct lb_profile {
+    static constexpr UDPProfileLidar profile = PROFILE_RNG15_RFL8_NIR8;
+    template <typename F>
+    static void for_each_field(F&& f) {
+        f(ChanField::RANGE, field_bits<0, 15, 3>{});
+        f(ChanField::FLAGS, field_bits<15, 1>{});
+        f(ChanField::REFLECTIVITY, field_bits<16, 8>{});
+        f(ChanField::NEAR_IR, field_bits<24, 8, 4>{});
+        f(ChanField::RAW32_WORD1, field_bits<0, 32>{});
+    }
+};
+
+struct dual_profile {
+    static constexpr UDPProfileLidar profile =
+        PROFILE_RNG19_RFL8_SIG16_NIR16_DUAL;
+    template <typename F>
+    static void for_each_field(F&& f) {
+        f(ChanField::RANGE, field_bits<0, 19>{});
+        f(ChanField::FLAGS, field_bits<19, 5>{});
+        f(ChanField::REFLECTIVITY, field_bits<24, 8>{});
+        f(ChanField::RANGE2, field_bits<32, 19>{});
+        f(ChanField::FLAGS2, field_bits<51, 5>{});
+        f(ChanField::REFLECTIVITY2, field_bits<56, 8>{});
+        f(ChanField::SIGNAL, field_bits<64, 16>{});
+        f(ChanField::SIGNAL2, field_bits<80, 16>{});
+        f(ChanField::NEAR_IR, field_bits<96, 16>{});
+        f(ChanField::RAW32_WORD1, field_bits<0, 32>{});
+        f(ChanField::RAW32_WORD2, field_bits<32, 32>{});
+        f(ChanField::RAW32_WORD3, field_bits<64, 32>{});
+        f(ChanField::RAW32_WORD4, field_bits<96, 32>{});
+    }
+};
+
+struct single_profile {
+    static constexpr UDPProfileLidar profile = PROFILE_RNG19_RFL8_SIG16_NIR16;
+    template <typename F>
+    static void for_each_field(F&& f) {
+        f(ChanField::RANGE, field_bits<0, 19>{});
+        f(ChanField::FLAGS, field_bits<19, 5>{});
+        f(ChanField::REFLECTIVITY, field_bits<32, 8>{});
+        f(ChanField::SIGNAL, field_bits<48, 16>{});
+        f(ChanField::NEAR_IR, field_bits<64, 16>{});
+        f(ChanField::RAW32_WORD1, field_bits<0, 32>{});
+        f(ChanField::RAW32_WORD2, field_bits<32, 32>{});
+        f(ChanField::RAW32_WORD3, field_bits<64, 32>{});
+    }
+};
+
+struct five_word_profile {
+    static constexpr UDPProfileLidar profile = PROFILE_FIVE_WORD_PIXEL;
+    template <typename F>
+    static void for_each_field(F&& f) {
+        f(ChanField::RANGE, field_bits<0, 19>{});
+        f(ChanField::FLAGS, field_bits<19, 5>{});
+        f(ChanField::REFLECTIVITY, field_bits<24, 8>{});
+        f(ChanField::RANGE2, field_bits<32, 19>{});
+        f(ChanField::FLAGS2, field_bits<51, 5>{});
+        f(ChanField::REFLECTIVITY2, field_bits<56, 8>{});
+        f(ChanField::SIGNAL, field_bits<64, 16>{});
+        f(ChanField::SIGNAL2, field_bits<80, 16>{});
+        f(ChanField::NEAR_IR, field_bits<96, 16>{});
+        f(ChanField::RAW32_WORD1, field_bits<0, 32>{});
+        f(ChanField::RAW32_WORD2, field_bits<32, 32>{});
+        f(ChanField::RAW32_WORD3, field_bits<64, 32>{});
+        f(ChanField::RAW32_WORD4, field_bits<96, 32>{});
+        f(ChanField::RAW32_WORD5, field_bits<128, 32>{});
+    }
+};
+
+struct fusa_profile {
+    static constexpr UDPProfileLidar profile =
+        PROFILE_FUSA_RNG15_RFL8_NIR8_DUAL;
+    template <typename F>
+    static void for_each_field(F&& f) {
+        f(ChanField::RANGE, field_bits<0, 15, 3>{});
+        f(ChanField::FLAGS, field_bits<15, 1>{});
+        f(ChanField::REFLECTIVITY, field_bits<16, 8>{});
+        f(ChanField::NEAR_IR, field_bits<24, 8, 4>{});
+        f(ChanField::RANGE2, field_bits<32, 15, 3>{});
+        f(ChanField::FLAGS2, field_bits<47, 1>{});
+        f(ChanField::REFLECTIVITY2, field_bits<48, 8>{});
+        f(ChanField::RAW32_WORD1, field_bits<0, 32>{});
+        f(ChanField::RAW32_WORD2, field_bits<32, 32>{});
+    }
+};
+
+// most fields of any built-in profile
+constexpr size_t max_fields = 16;
+
+/// Where one channel field of the scan is written, null if not in the scan
+struct field_dst {
+    uint8_t* data{nullptr};
+    size_t elem_size{0};
+};
+
+/// Narrowest unsigned type that holds a field
+template <typename Spec>
+using field_uint = typename std::conditional<
+    Spec::ty_tag == ChanFieldType::UINT8, uint8_t,
+    typename std::conditional<
+        Spec::ty_tag == ChanFieldType::UINT16, uint16_t,
+        typename std::conditional<Spec::ty_tag == ChanFieldType::UINT32,
+                                  uint32_t, uint64_t>::type>::type>::type;
+
+/// Decode a field from one pixel of each column of a block into a destination
+/// of the field's own width
+template <typename Spec, int BlockDim>
+inline void store(const field_dst& dst, const uint8_t* px_src,
+                  size_t col_size, std::ptrdiff_t index) {
+    using T = field_uint<Spec>;
+    if (!dst.data) return;
+    T* out = reinterpret_cast<T*>(dst.data) + index;
+    for (int x = 0; x < BlockDim; ++x) {
+        out[x] = Spec::template get<T>(px_src + x * col_size);
+    }
+}
+
+/// Decode one field for every pixel of the packet, with any destination type
+template <typename Spec, int BlockDim>
+struct decode_block {
+    template <typename T>
+    void operator()(Eigen::Ref<img_t<T>> field, const packet_format& pf,
+                    size_t channel_data_size,
+                    const uint8_t* packet_buf) const {
+        if (sizeof(T) < field_type_size(Spec::ty_tag))
+            throw std::invalid_argument(
+                "Dest type too small for specified field");
+
+        const std::ptrdiff_t cols = field.cols();
+        T* data = field.data();
+        for (int icol = 0; icol < pf.columns_per_packet; icol += BlockDim) {
+            const uint8_t* block = pf.nth_col(icol, packet_buf);
+            const uint16_t m_id = pf.col_measurement_id(block);
+            const uint8_t* px_src = block + pf.col_header_size;
+            for (int px = 0; px < pf.pixels_per_column; ++px) {
+                T* dst = data + cols * px + m_id;
+                const uint8_t* src = px_src + px * channel_data_size;
+                for (int x = 0; x < BlockDim; ++x) {
+                    dst[x] = Spec::template get<T>(src + x * pf.col_size);
+                }
+            }
+        }
+    }
+};
+
+template <typename Profile>
+class builtin_parser : public profile_parser {
+   public:
+    explicit builtin_parser(const packet_format& pf)
+        : pf_(pf),
+          channel_data_size_(
+              (pf.col_size - pf.col_header_size - pf.col_footer_size) /
+              pf.pixels_per_column),
+          block_dim_(pf.block_parsable()) {}
+
+    void parse_block(const uint8_t* packet_buf, LidarScan& ls) const override {
+        switch (block_dim_) {
+            case 16:
+                return parse<16>(packet_buf, ls);
+            case 8:
+                return parse<8>(packet_buf, ls);
+            default:
+                return parse<4>(packet_buf, ls);
+        }
+    }
+
+    /// Check that the compiled in layout matches the runtime profile table
+    static bool matches(const packet_format& pf) {
+        auto it = std::find_if(
+            profiles.begin(), profiles.end(),
+            [](const auto& kv) { return kv.first == Profile::profile; });
+        if (it == profiles.end() || pf.udp_profile_lidar != Profile::profile)
+            return false;
+        const ProfileEntry& entry = it->second;
+
+        bool ok = true;
+        size_t n_fields = 0;
+        Profile::for_each_field([&](const char* name, auto spec) {
+            using Spec = decltype(spec);
+            n_fields++;
+            auto f = std::find_if(
+                entry.fields, entry.fields + entry.n_fields,
+                [name](const auto& kv) { return kv.first == name; });
+            ok = ok && f != entry.fields + entry.n_fields &&
+                 f->second.offset == Spec::offset &&
+                 f->second.mask == Spec::mask &&
+                 f->second.shift == Spec::shift &&
+                 f->second.ty_tag == Spec::ty_tag;
+        });
+        return ok && n_fields == entry.n_fields && n_fields <= max_fields;
+    }
+
+   private:
+    /**
+     * Resolve where every profile field goes in the scan.
+     *
+     * @return false if a field has a different type than the profile's
+     * default, which the fused decoder doesn't handle.
+     */
+    bool bind(LidarScan& ls, std::array<field_dst, max_fields>& dst) const {
+        bool native = true;
+        size_t i = 0;
+        Profile::for_each_field([&](const char* name, auto spec) {
+            using Spec = decltype(spec);
+            field_dst& d = dst[i++];
+            if (!ls.has_field(name)) return;
+
+            Field& field = ls.field(name);
+            const auto& shape = field.shape();
+            if (field.tag() != Spec::ty_tag || shape.size() != 2 ||
+                shape[0] != ls.h || shape[1] != ls.w || field.sparse()) {
+                native = false;
+                return;
+            }
+            d.data = static_cast<uint8_t*>(field.get());
+        });
+        return native;
+    }
+
+    template <int BlockDim>
+    void parse(const uint8_t* packet_buf, LidarScan& ls) const {
+        std::array<field_dst, max_fields> dst{};
+        const bool fused = bind(ls, dst);
+        uint64_t* timestamp = ls.timestamp().data();
+        uint16_t* measurement_id = ls.measurement_id().data();
+        uint32_t* status = ls.status().data();
+        const std::ptrdiff_t cols = ls.w;
+        const size_t col_size = pf_.col_size;
+
+        for (int icol = 0; icol < pf_.columns_per_packet; icol += BlockDim) {
+            const uint8_t* block = pf_.nth_col(icol, packet_buf);
+            for (int x = 0; x < BlockDim; ++x) {
+                const uint8_t* col_buf = block + x * col_size;
+                const uint16_t m_id = pf_.col_measurement_id(col_buf);
+                timestamp[m_id] = pf_.col_timestamp(col_buf);
+                measurement_id[m_id] = m_id;
+                status[m_id] = pf_.col_status(col_buf);
+            }
+
+            if (!fused) continue;
+
+            // read each pixel once and scatter all of its fields, measurement
+            // ids are contiguous within a block
+            const uint16_t m_id = pf_.col_measurement_id(block);
+            const uint8_t* px_src = block + pf_.col_header_size;
+            for (int px = 0; px < pf_.pixels_per_column; ++px) {
+                const uint8_t* row = px_src + px * channel_data_size_;
+                const std::ptrdiff_t index = cols * px + m_id;
+                size_t i = 0;
+                Profile::for_each_field([&](const char*, auto spec) {
+                    store<decltype(spec), BlockDim>(dst[i++], row, col_size,
+                                                    index);
+                });
+            }
+        }
+
+        if (!fused) {
+            // scans with custom field types take one pass per field
+            Profile::for_each_field([&](const char* name, auto spec) {
+                if (!ls.has_field(name)) return;
+                ouster::impl::visit_field(
+                    ls, name, decode_block<decltype(spec), BlockDim>{}, pf_,
+                    channel_data_size_, packet_buf);
+            });
+        }
+    }
+
+    packet_format pf_;
+    size_t channel_data_size_;
+    int block_dim_;
+};
+
+/// Where one channel field of the scan is read from, null if not in the scan
+struct field_src {
+    const uint8_t* data{nullptr};
+};
+
+/// Encode a field into one pixel of each valid column of a block from a
+/// source of the field's own width
+template <typename Spec, int BlockDim>
+inline void load(const field_src& src, uint8_t* px_dst, size_t col_size,
+                 std::ptrdiff_t index, const bool* valid) {
+    using T = field_uint<Spec>;
+    if (!src.data) return;
+    const T* in = reinterpret_cast<const T*>(src.data) + index;
+    for (int x = 0; x < BlockDim; ++x) {
+        if (valid[x]) Spec::set(px_dst + x * col_size, in[x]);
+    }
+}
+
+template <typename Profile>
+class builtin_encoder : public profile_encoder {
+   public:
+    explicit builtin_encoder(const packet_format& pf)
+        : pf_(pf),
+          channel_data_size_(
+              (pf.col_size - pf.col_header_size - pf.col_footer_size) /
+              pf.pixels_per_column),
+          block_dim_(pf.block_parsable()) {}
+
+    bool encode_block(const LidarScan& ls,
+                      uint8_t* packet_buf) const override {
+        switch (block_dim_) {
+            case 16:
+                return encode<16>(ls, packet_buf);
+            case 8:
+                return encode<8>(ls, packet_buf);
+            default:
+                return encode<4>(ls, packet_buf);
+        }
+    }
+
+   private:
+    /**
+     * Resolve where every profile field comes from in the scan.
+     *
+     * @return false if a field has a different type than the profile's
+     * default, or the scan has raw words along with other fields: set_block
+     * writes fields in the order of their names, so that which of the two
+     * overlapping ones wins would depend on it.
+     */
+    bool bind(const LidarScan& ls,
+              std::array<field_src, max_fields>& src) const {
+        bool native = true;
+        bool raw = false;
+        bool named = false;
+        size_t i = 0;
+        Profile::for_each_field([&](const char* name, auto spec) {
+            using Spec = decltype(spec);
+            field_src& s = src[i++];
+            if (!ls.has_field(name)) return;
+
+            const Field& field = ls.field(name);
+            const auto& shape = field.shape();
+            if (field.tag() != Spec::ty_tag || shape.size() != 2 ||
+                shape[0] != ls.h || shape[1] != ls.w || field.sparse()) {
+                native = false;
+                return;
+            }
+            const bool is_raw = std::strncmp(name, "RAW32_WORD", 10) == 0;
+            raw = raw || is_raw;
+            named = named || !is_raw;
+            s.data = static_cast<const uint8_t*>(field.get());
+        });
+        return native && !(raw && named);
+    }
+
+    template <int BlockDim>
+    bool encode(const LidarScan& ls, uint8_t* packet_buf) const {
+        std::array<field_src, max_fields> src{};
+        if (!bind(ls, src)) return false;
+        const std::ptrdiff_t cols = ls.w;
+        const size_t col_size = pf_.col_size;
+
+        for (int icol = 0; icol < pf_.columns_per_packet; icol += BlockDim) {
+            uint8_t* block =
+                const_cast<uint8_t*>(pf_.nth_col(icol, packet_buf));
+            bool valid[BlockDim];
+            bool any = false;
+            for (int x = 0; x < BlockDim; ++x) {
+                valid[x] = pf_.col_status(block + x * col_size) & 0x01;
+                any = any || valid[x];
+            }
+            if (!any) continue;
+
+            // write all fields of each pixel at once, measurement ids are
+            // contiguous within a block
+            const uint16_t m_id = pf_.col_measurement_id(block);
+            uint8_t* px_dst = block + pf_.col_header_size;
+            for (int px = 0; px < pf_.pixels_per_column; ++px) {
+                uint8_t* row = px_dst + px * channel_data_size_;
+                const std::ptrdiff_t index = cols * px + m_id;
+                size_t i = 0;
+                Profile::for_each_field([&](const char*, auto spec) {
+                    load<decltype(spec), BlockDim>(src[i++], row, col_size,
+                                                   index, valid);
+                });
+            }
+        }
+        return true;
+    }
+
+    packet_format pf_;
+    size_t channel_data_size_;
+    int block_dim_;
+};
+
+// most fields of a profile parsed with a plan, more take the generic path
+constexpr size_t max_plan_fields = 64;
+
+// shifts of plan fields decoded by kernels with the shift compiled in
+constexpr int min_plan_shift = -8;
+constexpr int num_plan_shifts = 16;
+
+/**
+ * Decodes one field of all rows of a block of columns into dst, whose rows are
+ * row_stride elements apart.
+ */
+using plan_kernel = void (*)(const uint8_t* src, size_t col_size,
+                             size_t channel_data_size, int rows, uint64_t mask,
+                             int shift, uint8_t* dst,
+                             std::ptrdiff_t row_stride);
+
+// Shift of the kernel taking its shift at runtime
+constexpr int any_plan_shift = 64;
+
+/**
+ * Kernel with its shift known at compile time unless it's any_plan_shift.
+ * Shifts by a variable count are several times slower than by an immediate on
+ * x86, which made the custom profiles decoded field by field twice as slow as
+ * the builtin parsers.
+ */
+template <typename T, int BlockDim, int Shift>
+void plan_decode(const uint8_t* src, size_t col_size, size_t channel_data_size,
+                 int rows, uint64_t mask, int shift, uint8_t* dst,
+                 std::ptrdiff_t row_stride) {
+    const int s = Shift == any_plan_shift ? shift : Shift;
+    const int right = s > 0 ? s : 0;
+    const int left = s < 0 ? -s : 0;
+    T* out = reinterpret_cast<T*>(dst);
+    for (int px = 0; px < rows; ++px) {
+        const uint8_t* row = src + px * channel_data_size;
+        T* row_out = out + px * row_stride;
+        for (int x = 0; x < BlockDim; ++x) {
+            uint64_t word;
+            std::memcpy(&word, row + x * col_size, sizeof(uint64_t));
+            row_out[x] = static_cast<T>(((word & mask) >> right) << left);
+        }
+    }
+}
+
+template <typename T, int BlockDim, int... I>
+plan_kernel plan_kernel_for(int shift, std::integer_sequence<int, I...>) {
+    static constexpr plan_kernel kernels[] = {
+        &plan_decode<T, BlockDim, I + min_plan_shift>...};
+    const int i = shift - min_plan_shift;
+    if (i < 0 || i >= num_plan_shifts) {
+        return &plan_decode<T, BlockDim, any_plan_shift>;
+    }
+    return kernels[i];
+}
+
+template <int BlockDim>
+plan_kernel plan_kernel_for(size_t size, int shift) {
+    using shifts = std::make_integer_sequence<int, num_plan_shifts>;
+    switch (size) {
+        case 1:
+            return plan_kernel_for<uint8_t, BlockDim>(shift, shifts{});
+        case 2:
+            return plan_kernel_for<uint16_t, BlockDim>(shift, shifts{});
+        case 4:
+            return plan_kernel_for<uint32_t, BlockDim>(shift, shifts{});
+        default:
+            return plan_kernel_for<uint64_t, BlockDim>(shift, shifts{});
+    }
+}
+
+/// A field of the profile table with the kernel decoding it
+struct plan_op {
+    size_t offset;
+    uint64_t mask;
+    int shift;
+    size_t size;
+    plan_kernel kernel;
+};
+
+/**
+ * Parser for profiles without a compiled in layout, e.g. those registered with
+ * add_custom_profile, which would otherwise look up and decode every field
+ * separately per packet with shifts by a variable count. The field table is
+ * compiled once into a plan: whole bytes of the shift of each field are moved
+ * into its offset, leaving a shift within a byte that picks a kernel with it
+ * compiled in.
+ */
+class plan_parser : public profile_parser {
+   public:
+    plan_parser(const packet_format& pf, const ProfileEntry& entry)
+        : pf_(pf),
+          channel_data_size_(entry.chan_data_size),
+          block_dim_(pf.block_parsable()),
+          fields_(entry.fields, entry.fields + entry.n_fields) {
+        for (const auto& kv : fields_) {
+            const FieldInfo& f = kv.second;
+            plan_op op{f.offset, f.mask, f.shift, field_type_size(f.ty_tag),
+                       nullptr};
+            // without reading past the word of the table or the channel data
+            const size_t end = std::max(
+                f.offset, std::max<size_t>(channel_data_size_, 8) - 8);
+            while (op.shift >= 8 && (op.mask & 0xff) == 0 && op.offset < end) {
+                op.offset++;
+                op.mask >>= 8;
+                op.shift -= 8;
+            }
+            switch (block_dim_) {
+                case 16:
+                    op.kernel = plan_kernel_for<16>(op.size, op.shift);
+                    break;
+                case 8:
+                    op.kernel = plan_kernel_for<8>(op.size, op.shift);
+                    break;
+                default:
+                    op.kernel = plan_kernel_for<4>(op.size, op.shift);
+                    break;
+            }
+            ops_.push_back(op);
+        }
+    }
+
+    void parse_block(const uint8_t* packet_buf, LidarScan& ls) const override {
+        switch (block_dim_) {
+            case 16:
+                return parse<16>(packet_buf, ls);
+            case 8:
+                return parse<8>(packet_buf, ls);
+            default:
+                return parse<4>(packet_buf, ls);
+        }
+    }
+
+   private:
+    // as builtin_parser::bind, for the fields of the table
+    bool bind(LidarScan& ls, std::array<uint8_t*, max_plan_fields>& dst) const {
+        bool native = true;
+        for (size_t i = 0; i < fields_.size(); i++) {
+            const std::string& name = fields_[i].first;
+            if (!ls.has_field(name)) continue;
+            Field& field = ls.field(name);
+            const auto& shape = field.shape();
+            if (field.tag() != fields_[i].second.ty_tag || shape.size() != 2 ||
+                shape[0] != ls.h || shape[1] != ls.w || field.sparse()) {
+                native = false;
+                continue;
+            }
+            dst[i] = static_cast<uint8_t*>(field.get());
+        }
+        return native;
+    }
+
+    template <int BlockDim>
+    void parse(const uint8_t* packet_buf, LidarScan& ls) const {
+        std::array<uint8_t*, max_plan_fields> dst{};
+        const bool fused = bind(ls, dst);
+        uint64_t* timestamp = ls.timestamp().data();
+        uint16_t* measurement_id = ls.measurement_id().data();
+        uint32_t* status = ls.status().data();
+        const std::ptrdiff_t cols = ls.w;
+        const size_t col_size = pf_.col_size;
+
+        for (int icol = 0; icol < pf_.columns_per_packet; icol += BlockDim) {
+            const uint8_t* block = pf_.nth_col(icol, packet_buf);
+            for (int x = 0; x < BlockDim; ++x) {
+                const uint8_t* col_buf = block + x * col_size;
+                const uint16_t m_id = pf_.col_measurement_id(col_buf);
+                timestamp[m_id] = pf_.col_timestamp(col_buf);
+                measurement_id[m_id] = m_id;
+                status[m_id] = pf_.col_status(col_buf);
+            }
+
+            if (!fused) continue;
+
+            // one kernel call per field, measurement ids are contiguous
+            // within a block
+            const uint16_t m_id = pf_.col_measurement_id(block);
+            const uint8_t* px_src = block + pf_.col_header_size;
+            for (size_t i = 0; i < ops_.size(); i++) {
+                if (!dst[i]) continue;
+                const plan_op& op = ops_[i];
+                op.kernel(px_src + op.offset, col_size, channel_data_size_,
+                          pf_.pixels_per_column, op.mask, op.shift,
+                          dst[i] + m_id * op.size, cols);
+            }
+        }
+
+        if (!fused) {
+            // scans with custom field types take one pass per field
+            for (const auto& f : fields_) {
+                if (!ls.has_field(f.first)) continue;
+                ouster::impl::visit_field(ls, f.first,
+                                          block_field_of<BlockDim>{}, f.first,
+                                          pf_, packet_buf);
+            }
+        }
+    }
+
+    template <int BlockDim>
+    struct block_field_of {
+        template <typename T>
+        void operator()(Eigen::Ref<img_t<T>> field, const std::string& name,
+                        const packet_format& pf,
+                        const uint8_t* packet_buf) const {
+            pf.block_field<T, BlockDim>(field, name, packet_buf);
+        }
+    };
+
+    packet_format pf_;
+    size_t channel_data_size_;
+    int block_dim_;
+    std::vector<std::pair<std::string, FieldInfo>> fields_;
+    std::vector<plan_op> ops_;
+};
+
+template <typename Profile>
+std::shared_ptr<const profile_parser> make_builtin(const packet_format& pf) {
+    if (!builtin_parser<Profile>::matches(pf)) return nullptr;
+    return std::make_shared<builtin_parser<Profile>>(pf);
+}
+
+template <typename Profile>
+std::shared_ptr<const profile_encoder> make_builtin_encoder(
+    const packet_format& pf) {
+    if (!builtin_parser<Profile>::matches(pf)) return nullptr;
+    return std::make_shared<builtin_encoder<Profile>>(pf);
+}
+
+}  // namespace
+
+std::shared_ptr<const profile_parser> make_profile_parser(
+    const packet_format& pf) {
+    if (pf.block_parsable() == 0) return nullptr;
+
+    switch (pf.udp_profile_lidar) {
+        case PROFILE_LIDAR_LEGACY:
+            return make_builtin<legacy_profile>(pf);
+        case PROFILE_RNG19_RFL8_SIG16_NIR16_DUAL:
+            return make_builtin<dual_profile>(pf);
+        case PROFILE_RNG19_RFL8_SIG16_NIR16:
+            return make_builtin<single_profile>(pf);
+        case PROFILE_RNG15_RFL8_NIR8:
+            return make_builtin<lb_profile>(pf);
+        case PROFILE_FIVE_WORD_PIXEL:
+            return make_builtin<five_word_profile>(pf);
+        case PROFILE_FUSA_RNG15_RFL8_NIR8_DUAL:
+            return make_builtin<fusa_profile>(pf);
+        default: {
+            // custom profiles
+            auto it = std::find_if(
+                profiles.begin(), profiles.end(), [&pf](const auto& kv) {
+                    return kv.first == pf.udp_profile_lidar;
+                });
+            if (it == profiles.end() || it->first == 0 ||
+                it->second.n_fields == 0 ||
+                it->second.n_fields > max_plan_fields) {
+                return nullptr;
+            }
+            return std::make_shared<plan_parser>(pf, it->second);
+        }
+    }
+}
+
+std::shared_ptr<const profile_encoder> make_profile_encoder(
+    const packet_format& pf) {
+    if (pf.block_parsable() == 0) return nullptr;
+
+    switch (pf.udp_profile_lidar) {
+        case PROFILE_LIDAR_LEGACY:
+            return make_builtin_encoder<legacy_profile>(pf);
+        case PROFILE_RNG19_RFL8_SIG16_NIR16_DUAL:
+            return make_builtin_encoder<dual_profile>(pf);
+        case PROFILE_RNG19_RFL8_SIG16_NIR16:
+            return make_builtin_encoder<single_profile>(pf);
+        case PROFILE_RNG15_RFL8_NIR8:
+            return make_builtin_encoder<lb_profile>(pf);
+        case PROFILE_FIVE_WORD_PIXEL:
+            return make_builtin_encoder<five_word_profile>(pf);
+        case PROFILE_FUSA_RNG15_RFL8_NIR8_DUAL:
+            return make_builtin_encoder<fusa_profile>(pf);
+        default:
+            // custom profiles are written field by field
+            return nullptr;
+    }
+}
+
+}  // namespace impl
+}  // namespace sensor
+}  // namespace ouster
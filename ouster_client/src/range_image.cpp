@@ -0,0 +1,309 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/range_image.h"
+
+#include <Eigen/Eigenvalues>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "ouster/impl/lidar_scan_impl.h"
+
+namespace ouster {
+
+namespace {
+
+void check_window(int rows, int cols) {
+    if (rows < 1 || cols < 1 || rows % 2 == 0 || cols % 2 == 0) {
+        throw std::invalid_argument("window sizes must be positive and odd");
+    }
+}
+
+template <typename T>
+struct MinOp {
+    static T identity() {
+        return std::numeric_limits<T>::has_infinity
+                   ? std::numeric_limits<T>::infinity()
+                   : std::numeric_limits<T>::max();
+    }
+    template <typename A, typename B>
+    static auto apply(const A& a, const B& b) -> decltype(a.min(b)) {
+        return a.min(b);
+    }
+};
+
+template <typename T>
+struct MaxOp {
+    static T identity() {
+        return std::numeric_limits<T>::has_infinity
+                   ? -std::numeric_limits<T>::infinity()
+                   : std::numeric_limits<T>::lowest();
+    }
+    template <typename A, typename B>
+    static auto apply(const A& a, const B& b) -> decltype(a.max(b)) {
+        return a.max(b);
+    }
+};
+
+// Both passes combine whole shifted rows, which Eigen vectorizes, rather than
+// windows of single pixels. Rows are independent within each pass.
+template <typename T, typename Op>
+img_t<T> extremum_filter(const Eigen::Ref<const img_t<T>>& img, int rows,
+                         int cols, bool ignore_zeros, bool wrap_columns) {
+    check_window(rows, cols);
+    using Row = Eigen::Array<T, 1, Eigen::Dynamic>;
+    const Eigen::Index h = img.rows();
+    const Eigen::Index w = img.cols();
+    const Eigen::Index a = cols / 2;
+    const Eigen::Index b = rows / 2;
+    const T identity = Op::identity();
+
+    // horizontal pass, over each row padded by the window half width
+    img_t<T> tmp(h, w);
+#ifdef __OUSTER_UTILIZE_OPENMP__
+#pragma omp parallel for schedule(static)
+#endif
+    for (Eigen::Index r = 0; r < h; ++r) {
+        Row padded = Row::Constant(w + 2 * a, identity);
+        for (Eigen::Index c = -a; c < w + a; ++c) {
+            if (!wrap_columns && (c < 0 || c >= w)) continue;
+            const T v = img(r, ((c % w) + w) % w);
+            padded(c + a) = (ignore_zeros && v == T(0)) ? identity : v;
+        }
+        Row out = padded.segment(0, w);
+        for (Eigen::Index d = 1; d < cols; ++d) {
+            out = Op::apply(out, padded.segment(d, w));
+        }
+        tmp.row(r) = out;
+    }
+
+    // vertical pass, cut at the first and last rows
+    img_t<T> result(h, w);
+#ifdef __OUSTER_UTILIZE_OPENMP__
+#pragma omp parallel for schedule(static)
+#endif
+    for (Eigen::Index r = 0; r < h; ++r) {
+        const Eigen::Index lo = std::max<Eigen::Index>(0, r - b);
+        const Eigen::Index hi = std::min<Eigen::Index>(h - 1, r + b);
+        Row out = tmp.row(lo);
+        for (Eigen::Index s = lo + 1; s <= hi; ++s) {
+            out = Op::apply(out, tmp.row(s));
+        }
+        if (ignore_zeros) out = (out == identity).select(T(0), out);
+        result.row(r) = out;
+    }
+    return result;
+}
+
+}  // namespace
+
+template <typename T>
+img_t<T> min_filter(const Eigen::Ref<const img_t<T>>& img, int rows, int cols,
+                    bool ignore_zeros, bool wrap_columns) {
+    return extremum_filter<T, MinOp<T>>(img, rows, cols, ignore_zeros,
+                                        wrap_columns);
+}
+
+template <typename T>
+img_t<T> max_filter(const Eigen::Ref<const img_t<T>>& img, int rows, int cols,
+                    bool ignore_zeros, bool wrap_columns) {
+    return extremum_filter<T, MaxOp<T>>(img, rows, cols, ignore_zeros,
+                                        wrap_columns);
+}
+
+template <typename T>
+img_t<T> median_filter(const Eigen::Ref<const img_t<T>>& img, int rows,
+                       int cols, bool ignore_zeros, bool wrap_columns) {
+    check_window(rows, cols);
+    const Eigen::Index h = img.rows();
+    const Eigen::Index w = img.cols();
+    const Eigen::Index a = cols / 2;
+    const Eigen::Index b = rows / 2;
+
+    img_t<T> result(h, w);
+#ifdef __OUSTER_UTILIZE_OPENMP__
+#pragma omp parallel for schedule(static)
+#endif
+    for (Eigen::Index r = 0; r < h; ++r) {
+        const Eigen::Index lo = std::max<Eigen::Index>(0, r - b);
+        const Eigen::Index hi = std::min<Eigen::Index>(h - 1, r + b);
+        std::vector<T> values;
+        values.reserve(rows * cols);
+        for (Eigen::Index c = 0; c < w; ++c) {
+            values.clear();
+            for (Eigen::Index s = lo; s <= hi; ++s) {
+                for (Eigen::Index d = c - a; d <= c + a; ++d) {
+                    if (!wrap_columns && (d < 0 || d >= w)) continue;
+                    const T v = img(s, ((d % w) + w) % w);
+                    if (ignore_zeros && v == T(0)) continue;
+                    values.push_back(v);
+                }
+            }
+            if (values.empty()) {
+                result(r, c) = T(0);
+                continue;
+            }
+            auto mid = values.begin() + (values.size() - 1) / 2;
+            std::nth_element(values.begin(), mid, values.end());
+            result(r, c) = *mid;
+        }
+    }
+    return result;
+}
+
+pose_util::Points range_image_normals(const LidarScan& scan,
+                                      const XYZLut& lut, int window,
+                                      double max_distance) {
+    if (window < 3 || window % 2 == 0) {
+        throw std::invalid_argument("window must be odd and at least 3");
+    }
+    if (!scan.sensor_info) {
+        throw std::invalid_argument("scan has no sensor info to destagger");
+    }
+    const Eigen::Index w = scan.w;
+    const Eigen::Index h = scan.h;
+    const auto& shifts = scan.sensor_info->format.pixel_shift_by_row;
+    if (static_cast<Eigen::Index>(shifts.size()) != h) {
+        throw std::invalid_argument("pixel shifts don't match the scan");
+    }
+    const LidarScan::Points points = cartesian(scan, lut);
+    const auto range = scan.field<uint32_t>(sensor::ChanField::RANGE);
+
+    // pixel of the scan at each pixel of the destaggered image
+    Eigen::Array<Eigen::Index, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+        pixel(h, w);
+    for (Eigen::Index r = 0; r < h; ++r) {
+        const Eigen::Index offset =
+            impl::destagger_offset(shifts, r, w, false);
+        for (Eigen::Index c = 0; c < w; ++c) {
+            pixel(r, (c + offset) % w) = r * w + c;
+        }
+    }
+
+    const double max_sq = max_distance * max_distance;
+    const Eigen::Index half = window / 2;
+    pose_util::Points normals = pose_util::Points::Zero(w * h, 3);
+#ifdef __OUSTER_UTILIZE_OPENMP__
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (Eigen::Index r = 0; r < h; ++r) {
+        for (Eigen::Index c = 0; c < w; ++c) {
+            const Eigen::Index i = pixel(r, c);
+            if (range.data()[i] == 0) continue;
+            const Eigen::Vector3d p = points.row(i).matrix().transpose();
+
+            Eigen::Vector3d sum = Eigen::Vector3d::Zero();
+            Eigen::Matrix3d sum_sq = Eigen::Matrix3d::Zero();
+            int count = 0;
+            for (Eigen::Index s = std::max<Eigen::Index>(0, r - half);
+                 s <= std::min<Eigen::Index>(h - 1, r + half); ++s) {
+                for (Eigen::Index d = c - half; d <= c + half; ++d) {
+                    const Eigen::Index j = pixel(s, ((d % w) + w) % w);
+                    if (range.data()[j] == 0) continue;
+                    // relative to the center for numerical stability
+                    const Eigen::Vector3d q =
+                        points.row(j).matrix().transpose() - p;
+                    if (q.squaredNorm() > max_sq) continue;
+                    sum += q;
+                    sum_sq += q * q.transpose();
+                    ++count;
+                }
+            }
+            if (count < 3) continue;
+
+            const Eigen::Vector3d mean = sum / count;
+            const Eigen::Matrix3d cov =
+                sum_sq / count - mean * mean.transpose();
+            Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver;
+            solver.computeDirect(cov);
+            Eigen::Vector3d n = solver.eigenvectors().col(0);
+            if (n.dot(p) > 0) n = -n;
+            normals.row(i) = n.transpose();
+        }
+    }
+    return normals;
+}
+
+img_t<uint32_t> connected_components(
+    const Eigen::Ref<const img_t<uint32_t>>& range, uint32_t max_step,
+    bool wrap_columns) {
+    const Eigen::Index h = range.rows();
+    const Eigen::Index w = range.cols();
+    const Eigen::Index n = h * w;
+
+    // union find over pixels, with path halving
+    std::vector<Eigen::Index> parent(n);
+    for (Eigen::Index i = 0; i < n; ++i) parent[i] = i;
+    auto find = [&parent](Eigen::Index i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    };
+    // the root of a component is always its first pixel in row major order
+    auto unite = [&find, &parent](Eigen::Index i, Eigen::Index j) {
+        i = find(i);
+        j = find(j);
+        if (i < j) {
+            parent[j] = i;
+        } else if (j < i) {
+            parent[i] = j;
+        }
+    };
+    auto connected = [max_step](uint32_t a, uint32_t b) {
+        return a != 0 && b != 0 && (a > b ? a - b : b - a) <= max_step;
+    };
+
+    for (Eigen::Index r = 0; r < h; ++r) {
+        for (Eigen::Index c = 0; c < w; ++c) {
+            const uint32_t v = range(r, c);
+            if (v == 0) continue;
+            if (c + 1 < w && connected(v, range(r, c + 1))) {
+                unite(r * w + c, r * w + c + 1);
+            }
+            if (r + 1 < h && connected(v, range(r + 1, c))) {
+                unite(r * w + c, (r + 1) * w + c);
+            }
+        }
+        if (wrap_columns && w > 2 && connected(range(r, w - 1), range(r, 0))) {
+            unite(r * w, r * w + w - 1);
+        }
+    }
+
+    img_t<uint32_t> labels = img_t<uint32_t>::Zero(h, w);
+    std::vector<uint32_t> root_label(n, 0);
+    uint32_t next = 0;
+    for (Eigen::Index i = 0; i < n; ++i) {
+        const Eigen::Index r = i / w;
+        const Eigen::Index c = i % w;
+        if (range(r, c) == 0) continue;
+        const Eigen::Index root = find(i);
+        if (root_label[root] == 0) root_label[root] = ++next;
+        labels(r, c) = root_label[root];
+    }
+    return labels;
+}
+
+#define OUSTER_RANGE_IMAGE_FILTERS(T)                                  \
+    template img_t<T> min_filter<T>(const Eigen::Ref<const img_t<T>>&, \
+                                    int, int, bool, bool);             \
+    template img_t<T> max_filter<T>(const Eigen::Ref<const img_t<T>>&, \
+                                    int, int, bool, bool);             \
+    template img_t<T> median_filter<T>(                                \
+        const Eigen::Ref<const img_t<T>>&, int, int, bool, bool);
+
+OUSTER_RANGE_IMAGE_FILTERS(uint8_t)
+OUSTER_RANGE_IMAGE_FILTERS(uint16_t)
+OUSTER_RANGE_IMAGE_FILTERS(uint32_t)
+OUSTER_RANGE_IMAGE_FILTERS(uint64_t)
+OUSTER_RANGE_IMAGE_FILTERS(float)
+OUSTER_RANGE_IMAGE_FILTERS(double)
+
+#undef OUSTER_RANGE_IMAGE_FILTERS
+
+}  // namespace ouster
@@ -0,0 +1,208 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/reframing_batcher.h"
+
+#include <stdexcept>
+
+#include "ouster/impl/lidar_scan_impl.h"
+
+namespace ouster {
+
+namespace {
+
+// floor of a / b for b > 0
+int64_t floor_div(int64_t a, int64_t b) {
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+struct zero_cols {
+    template <typename T>
+    void operator()(Eigen::Ref<img_t<T>> field, const std::string&,
+                    size_t start, size_t end) const {
+        field.block(0, start, field.rows(), end - start).setZero();
+    }
+};
+
+struct parse_col {
+    template <typename T>
+    void operator()(Eigen::Ref<img_t<T>> field, const std::string& f,
+                    size_t col, const sensor::packet_format& pf,
+                    const uint8_t* col_buf) const {
+        if (f == sensor::ChanField::RAW_HEADERS) return;
+        pf.col_field(col_buf, f, field.col(col).data(), field.cols());
+    }
+};
+
+template <typename OP, typename... Args>
+void foreach_packet_field(
+    LidarScan& ls,
+    const std::vector<std::pair<std::string, FieldHandle>>& fields, OP&& op,
+    Args&&... args) {
+    for (const auto& f : fields) {
+        if (!ls.has_field(f.second) || ls.is_deferred(f.first)) continue;
+        impl::visit_field_2d(ls.field(f.second), std::forward<OP>(op), f.first,
+                             std::forward<Args>(args)...);
+    }
+}
+
+}  // namespace
+
+ReframingBatcher::ReframingBatcher(const sensor::sensor_info& info,
+                                   const ReframeWindow& window)
+    : info_(std::make_shared<sensor::sensor_info>(info)),
+      pf_(sensor::get_format(info)),
+      window_(window),
+      frame_w_(info.format.columns_per_frame),
+      cache_(0) {
+    if (window_.width == 0) window_.width = frame_w_;
+    if (pf_.columns_per_packet == 0 ||
+        window_.width % pf_.columns_per_packet != 0) {
+        throw std::invalid_argument(
+            "ReframingBatcher: width must be a multiple of "
+            "columns_per_packet");
+    }
+    if (window_.period_ns == 0 && window_.start_col >= frame_w_) {
+        throw std::invalid_argument(
+            "ReframingBatcher: start_col out of range");
+    }
+    for (const auto& ft : pf_)
+        pf_fields_.emplace_back(ft.first, LidarScan::field_handle(ft.first));
+}
+
+int64_t ReframingBatcher::unwrap_frame(uint32_t frame_id) {
+    if (last_frame_id_ >= 0) {
+        const int64_t range = static_cast<int64_t>(pf_.max_frame_id) + 1;
+        int64_t d = (static_cast<int64_t>(frame_id) - last_frame_id_) % range;
+        if (d < 0) d += range;
+        // a packet from an earlier frame arriving late
+        if (d > range / 2) d -= range;
+        frame_ += d;
+    }
+    last_frame_id_ = frame_id;
+    return frame_;
+}
+
+void ReframingBatcher::start_scan(const uint8_t* packet_buf, LidarScan& ls) {
+    batching_ = true;
+    next_col_ = 0;
+    ls.frame_id = pf_.frame_id(packet_buf);
+    ls.timestamp().setZero();
+    ls.measurement_id().setZero();
+    ls.status().setZero();
+    ls.packet_timestamp().setZero();
+    ls.alert_flags().setZero();
+    ls.frame_status = (pf_.thermal_shutdown(packet_buf) & 0x0f) |
+                      (pf_.shot_limiting(packet_buf) & 0x0f) << 4;
+    ls.shutdown_countdown = pf_.countdown_thermal_shutdown(packet_buf);
+    ls.shot_limiting_countdown = pf_.countdown_shot_limiting(packet_buf);
+    ls.sensor_info = info_;
+}
+
+void ReframingBatcher::end_scan(LidarScan& ls) {
+    foreach_packet_field(ls, pf_fields_, zero_cols{}, next_col_, ls.w);
+    batching_ = false;
+}
+
+int ReframingBatcher::batch_columns(const sensor::LidarPacket& packet,
+                                    int icol, LidarScan& ls,
+                                    bool may_complete) {
+    const uint8_t* packet_buf = packet.buf.data();
+    const int64_t frame = unwrap_frame(pf_.frame_id(packet_buf));
+    const bool by_time = window_.period_ns != 0;
+    const int64_t width = window_.width;
+    const int64_t start = window_.start_col;
+
+    for (; icol < pf_.columns_per_packet; icol++) {
+        const uint8_t* col_buf = pf_.nth_col(icol, packet_buf);
+        const uint16_t m_id = pf_.col_measurement_id(col_buf);
+        const uint32_t status = pf_.col_status(col_buf);
+        if (!(status & 0x01) || m_id >= frame_w_) continue;
+
+        const uint64_t ts = pf_.col_timestamp(col_buf);
+        const int64_t col = frame * static_cast<int64_t>(frame_w_) + m_id;
+        const int64_t win =
+            by_time ? floor_div(static_cast<int64_t>(ts - window_.offset_ns),
+                                window_.period_ns)
+                    : floor_div(col - start, width);
+
+        if (!batching_) {
+            start_scan(packet_buf, ls);
+            scan_window_ = win;
+            scan_start_ = by_time ? col : start + win * width;
+        } else if (win > scan_window_ && may_complete) {
+            end_scan(ls);
+            return icol;
+        } else if (win != scan_window_) {
+            dropped_++;
+            continue;
+        }
+
+        const int64_t out = col - scan_start_;
+        if (out < 0 || out >= width) {
+            dropped_++;
+            continue;
+        }
+
+        // zero out missing columns if we jumped forward
+        if (static_cast<size_t>(out) >= next_col_) {
+            foreach_packet_field(ls, pf_fields_, zero_cols{}, next_col_,
+                                 static_cast<size_t>(out));
+            next_col_ = out + 1;
+        }
+
+        ls.timestamp()[out] = ts;
+        ls.measurement_id()[out] = m_id;
+        ls.status()[out] = status;
+        foreach_packet_field(ls, pf_fields_, parse_col{},
+                             static_cast<size_t>(out), pf_, col_buf);
+
+        const size_t row = out / pf_.columns_per_packet;
+        ls.packet_timestamp()[row] = packet.host_timestamp;
+        ls.alert_flags()[row] = pf_.alert_flags(packet_buf);
+    }
+    return -1;
+}
+
+bool ReframingBatcher::operator()(const sensor::LidarPacket& packet,
+                                  LidarScan& ls) {
+    if (ls.w != window_.width ||
+        ls.h != static_cast<size_t>(pf_.pixels_per_column) ||
+        static_cast<size_t>(ls.packet_timestamp().rows()) !=
+            window_.width / pf_.columns_per_packet) {
+        throw std::invalid_argument(
+            "ReframingBatcher: unexpected scan dimensions");
+    }
+    // the batcher writes to the scan over several calls
+    ls.unshare();
+
+    // the rest of the packet that completed the last scan, which fits in the
+    // new one unless its windows are shorter than a packet
+    if (cache_col_ >= 0) {
+        const int icol = cache_col_;
+        cache_col_ = -1;
+        batch_columns(cache_, icol, ls, false);
+    }
+
+    const int icol = batch_columns(packet, 0, ls, true);
+    if (icol < 0) return false;
+    cache_ = packet;
+    cache_col_ = icol;
+    return true;
+}
+
+bool ReframingBatcher::finish_scan(LidarScan& ls) {
+    if (!batching_) return false;
+    end_scan(ls);
+    return true;
+}
+
+size_t ReframingBatcher::scan_width() const { return window_.width; }
+
+const ReframeWindow& ReframingBatcher::window() const { return window_; }
+
+uint64_t ReframingBatcher::dropped_columns() const { return dropped_; }
+
+}  // namespace ouster
@@ -0,0 +1,74 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/scan_collator.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace ouster {
+
+ScanCollator::ScanCollator(size_t sensors_count, int64_t dt)
+    : sensors_count_{sensors_count}, dt_{dt}, collated_(sensors_count) {
+    if (sensors_count == 0) {
+        throw std::invalid_argument("ScanCollator: no sensors to collate");
+    }
+}
+
+void ScanCollator::push(size_t sensor_idx, std::unique_ptr<LidarScan> scan) {
+    if (sensor_idx >= sensors_count_) {
+        throw std::invalid_argument("Sensor index out of range.");
+    }
+    if (!scan) throw std::invalid_argument("ScanCollator: null scan");
+
+    const auto ts =
+        static_cast<int64_t>(scan->get_first_valid_packet_timestamp());
+    if (!started_ || ts >= min_ts_ + dt_ || ts < max_ts_ - dt_) {
+        // reached the dt boundary
+        cut();
+        started_ = true;
+        min_ts_ = max_ts_ = ts;
+    }
+    if (collated_[sensor_idx]) {
+        // reached a scan of a sensor already in the frame
+        cut();
+        min_ts_ = max_ts_ = ts;
+    }
+
+    collated_[sensor_idx] = std::move(scan);
+    collated_count_++;
+    if (collated_count_ == sensors_count_) {
+        // got a scan of every sensor
+        cut();
+        min_ts_ = max_ts_ = ts;
+    }
+    min_ts_ = std::min(min_ts_, ts);
+    max_ts_ = std::max(max_ts_, ts);
+}
+
+void ScanCollator::flush() { cut(); }
+
+bool ScanCollator::ready() const { return !frames_.empty(); }
+
+ScanCollator::Frame ScanCollator::pop() {
+    if (frames_.empty()) {
+        throw std::runtime_error("ScanCollator: no frame is ready");
+    }
+    Frame frame = std::move(frames_.front());
+    frames_.pop_front();
+    return frame;
+}
+
+size_t ScanCollator::sensors_count() const { return sensors_count_; }
+
+void ScanCollator::cut() {
+    if (collated_count_ == 0) return;
+    frames_.push_back(std::move(collated_));
+    collated_ = Frame(sensors_count_);
+    collated_count_ = 0;
+}
+
+}  // namespace ouster
@@ -0,0 +1,138 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/scan_gate.h"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace ouster {
+
+namespace {
+
+constexpr double gravity = 9.80665;
+
+}  // namespace
+
+bool SkippedSpan::operator==(const SkippedSpan& other) const {
+    return first_frame_id == other.first_frame_id &&
+           last_frame_id == other.last_frame_id &&
+           first_ts == other.first_ts && last_ts == other.last_ts &&
+           count == other.count;
+}
+
+ScanGate::ScanGate(const ScanGateOptions& options) : options_(options) {
+    if (options_.stride == 0) {
+        throw std::invalid_argument("ScanGate: stride must be at least 1");
+    }
+    if (options_.min_changed_fraction < 0 || options_.keyframe_interval < 0 ||
+        options_.min_angular_velocity < 0 || options_.min_accel_change < 0) {
+        throw std::invalid_argument("ScanGate: options must not be negative");
+    }
+}
+
+bool ScanGate::moving(const ImuBatch& imu) const {
+    const auto gyro = imu.gyro_xyz();
+    const auto accel = imu.accel_xyz();
+    for (size_t i = 0; i < imu.size(); i++) {
+        if (gyro.row(i).norm() > options_.min_angular_velocity ||
+            std::abs(accel.row(i).norm() - gravity) >
+                options_.min_accel_change) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ScanGate::admit(const LidarScan& scan, const ImuBatch* imu) {
+    const uint64_t ts = scan.get_first_valid_column_timestamp();
+    const bool comparable = has_reference_ && scan.w == w_ && scan.h == h_ &&
+                            scan.has_field(sensor::ChanField::RANGE) &&
+                            ts >= last_kept_ts_;
+
+    // sample the range image, the same way as the reference
+    const size_t stride = options_.stride;
+    samples_.clear();
+    if (scan.has_field(sensor::ChanField::RANGE)) {
+        const auto range = scan.field<uint32_t>(sensor::ChanField::RANGE);
+        for (size_t r = 0; r < scan.h; r += stride) {
+            for (size_t c = 0; c < scan.w; c += stride) {
+                samples_.push_back(range(r, c));
+            }
+        }
+    }
+
+    bool keep = !comparable;
+    last_change_ = 1.0;
+    if (comparable) {
+        size_t valid = 0;
+        size_t changed = 0;
+        for (size_t i = 0; i < samples_.size(); i++) {
+            const uint32_t a = samples_[i];
+            const uint32_t b = reference_[i];
+            if (a == 0 && b == 0) continue;
+            valid++;
+            const uint32_t d = a > b ? a - b : b - a;
+            if (a == 0 || b == 0 || d > options_.min_range_change) changed++;
+        }
+        last_change_ = valid ? static_cast<double>(changed) / valid : 0.0;
+        keep = (valid && last_change_ >= options_.min_changed_fraction) ||
+               (imu && moving(*imu)) ||
+               static_cast<double>(ts - last_kept_ts_) >=
+                   options_.keyframe_interval * 1e9;
+    }
+
+    if (keep) {
+        reference_.swap(samples_);
+        w_ = scan.w;
+        h_ = scan.h;
+        last_kept_ts_ = ts;
+        has_reference_ = scan.has_field(sensor::ChanField::RANGE);
+        in_span_ = false;
+        kept_++;
+        return true;
+    }
+
+    if (!in_span_) {
+        SkippedSpan span;
+        span.first_frame_id = scan.frame_id;
+        span.first_ts = ts;
+        spans_.push_back(span);
+        in_span_ = true;
+    }
+    SkippedSpan& span = spans_.back();
+    span.last_frame_id = scan.frame_id;
+    span.last_ts = ts;
+    span.count++;
+    skipped_++;
+    return false;
+}
+
+double ScanGate::last_change() const { return last_change_; }
+
+uint64_t ScanGate::kept() const { return kept_; }
+
+uint64_t ScanGate::skipped() const { return skipped_; }
+
+const std::vector<SkippedSpan>& ScanGate::skipped_spans() const {
+    return spans_;
+}
+
+const ScanGateOptions& ScanGate::options() const { return options_; }
+
+void ScanGate::reset() {
+    reference_.clear();
+    w_ = 0;
+    h_ = 0;
+    last_kept_ts_ = 0;
+    has_reference_ = false;
+    in_span_ = false;
+    last_change_ = 1.0;
+    kept_ = 0;
+    skipped_ = 0;
+    spans_.clear();
+}
+
+}  // namespace ouster
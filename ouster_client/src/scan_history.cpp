@@ -0,0 +1,160 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/scan_history.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace ouster {
+
+ScanHistory::ScanHistory(size_t capacity, std::shared_ptr<ScanPool> pool)
+    : pool_(std::move(pool)) {
+    if (capacity == 0) {
+        throw std::invalid_argument("ScanHistory: capacity must be > 0");
+    }
+    ring_.resize(capacity);
+}
+
+bool ScanHistory::push(const LidarScan& scan) {
+    const uint64_t ts = scan.get_first_valid_column_timestamp();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!accepts(ts)) return false;
+    }
+    // copy without holding the lock, readers go on meanwhile
+    std::unique_ptr<LidarScan> copy;
+    if (pool_ && pool_->matches(scan)) {
+        copy = pool_->acquire();
+        *copy = scan;
+    } else {
+        copy.reset(new LidarScan(scan));
+    }
+    return push(std::move(copy));
+}
+
+bool ScanHistory::push(std::unique_ptr<LidarScan> scan) {
+    if (!scan) throw std::invalid_argument("ScanHistory: null scan");
+    const uint64_t ts = scan->get_first_valid_column_timestamp();
+    // the dropped scan is released to the pool after unlocking
+    Handle dropped;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (accepts(ts)) {
+            if (size_ == ring_.size()) {
+                dropped = std::move(ring_[first_].scan);
+                first_ = (first_ + 1) % ring_.size();
+                size_--;
+            }
+            ring_[slot(size_)] = Entry{ts, share(std::move(scan))};
+            size_++;
+            return true;
+        }
+    }
+    if (pool_) pool_->release(std::move(scan));
+    return false;
+}
+
+std::vector<ScanHistory::Handle> ScanHistory::latest(size_t n) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t count = std::min(n, size_);
+    std::vector<Handle> result;
+    result.reserve(count);
+    for (size_t i = size_ - count; i < size_; i++) {
+        result.push_back(ring_[slot(i)].scan);
+    }
+    return result;
+}
+
+ScanHistory::Handle ScanHistory::back(size_t i) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (i >= size_) return nullptr;
+    return ring_[slot(size_ - 1 - i)].scan;
+}
+
+ScanHistory::Handle ScanHistory::at_time(uint64_t ts) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t i = upper_bound(ts);
+    if (i == 0) return nullptr;
+    return ring_[slot(i - 1)].scan;
+}
+
+ScanHistory::Handle ScanHistory::nearest(uint64_t ts) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (size_ == 0) return nullptr;
+    const size_t i = upper_bound(ts);
+    if (i == 0) return ring_[slot(0)].scan;
+    if (i == size_) return ring_[slot(size_ - 1)].scan;
+    const Entry& before = ring_[slot(i - 1)];
+    const Entry& after = ring_[slot(i)];
+    return after.ts - ts < ts - before.ts ? after.scan : before.scan;
+}
+
+std::vector<ScanHistory::Handle> ScanHistory::between(uint64_t begin,
+                                                      uint64_t end) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<Handle> result;
+    if (begin > end) return result;
+    // the first scan at or after begin follows the scans before it
+    const size_t first = begin == 0 ? 0 : upper_bound(begin - 1);
+    const size_t last = upper_bound(end);
+    result.reserve(last - first);
+    for (size_t i = first; i < last; i++) {
+        result.push_back(ring_[slot(i)].scan);
+    }
+    return result;
+}
+
+void ScanHistory::clear() {
+    // the dropped scans are released to the pool after unlocking
+    std::vector<Handle> dropped;
+    std::lock_guard<std::mutex> lock(mutex_);
+    dropped.reserve(size_);
+    for (size_t i = 0; i < size_; i++) {
+        dropped.push_back(std::move(ring_[slot(i)].scan));
+    }
+    first_ = 0;
+    size_ = 0;
+}
+
+size_t ScanHistory::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return size_;
+}
+
+size_t ScanHistory::capacity() const { return ring_.size(); }
+
+bool ScanHistory::accepts(uint64_t ts) const {
+    return ts != 0 && (size_ == 0 || ts >= ring_[slot(size_ - 1)].ts);
+}
+
+ScanHistory::Handle ScanHistory::share(std::unique_ptr<LidarScan> scan) const {
+    auto pool = pool_;
+    return Handle(scan.release(), [pool](const LidarScan* released) {
+        std::unique_ptr<LidarScan> owned(const_cast<LidarScan*>(released));
+        if (pool) pool->release(std::move(owned));
+    });
+}
+
+size_t ScanHistory::slot(size_t i) const {
+    return (first_ + i) % ring_.size();
+}
+
+size_t ScanHistory::upper_bound(uint64_t ts) const {
+    size_t lo = 0;
+    size_t hi = size_;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (ring_[slot(mid)].ts <= ts) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+}  // namespace ouster
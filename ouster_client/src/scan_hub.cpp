@@ -0,0 +1,210 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/scan_hub.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "ouster/concurrent_queue.h"
+
+namespace ouster {
+
+namespace impl {
+
+// queue of a subscriber; the producer pops from it too to drop the oldest
+// scan, hence the multi consumer queue
+struct hub_subscriber {
+    hub_subscriber(size_t depth, DropPolicy policy, const ScanViewSpec& view)
+        : queue(depth), policy(policy), view(view) {}
+
+    BlockingQueue<MpmcQueue<std::shared_ptr<const LidarScan>>> queue;
+    const DropPolicy policy;
+    const ScanViewSpec view;
+    std::atomic<uint64_t> delivered{0};
+    std::atomic<uint64_t> dropped{0};
+};
+
+}  // namespace impl
+
+using impl::hub_subscriber;
+
+struct ScanSubscription::Hub {
+    // guards subscribers, taken to change them and by the producer to copy
+    // them after they changed
+    mutable std::mutex mutex;
+    std::vector<std::shared_ptr<hub_subscriber>> subscribers;
+    std::atomic<uint64_t> version{0};
+    std::atomic<bool> closed{false};
+    std::atomic<uint64_t> published{0};
+
+    // the producer's copy of subscribers, as of version seen
+    std::vector<std::shared_ptr<hub_subscriber>> snapshot;
+    uint64_t seen{0};
+
+    void unsubscribe(const std::shared_ptr<hub_subscriber>& sub) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = std::find(subscribers.begin(), subscribers.end(), sub);
+        if (it == subscribers.end()) return;
+        subscribers.erase(it);
+        version.fetch_add(1, std::memory_order_release);
+    }
+};
+
+ScanSubscription::ScanSubscription() = default;
+
+ScanSubscription::~ScanSubscription() { unsubscribe(); }
+
+ScanSubscription::ScanSubscription(ScanSubscription&& other) noexcept
+    : sub_(std::move(other.sub_)), hub_(std::move(other.hub_)) {}
+
+ScanSubscription& ScanSubscription::operator=(
+    ScanSubscription&& other) noexcept {
+    if (this != &other) {
+        unsubscribe();
+        sub_ = std::move(other.sub_);
+        hub_ = std::move(other.hub_);
+    }
+    return *this;
+}
+
+bool ScanSubscription::pop(std::shared_ptr<const LidarScan>& scan,
+                           double timeout_sec) {
+    return sub_ && sub_->queue.pop(scan, timeout_sec);
+}
+
+bool ScanSubscription::try_pop(std::shared_ptr<const LidarScan>& scan) {
+    return sub_ && sub_->queue.try_pop(scan);
+}
+
+bool ScanSubscription::pop(ScanView& view, double timeout_sec) {
+    std::shared_ptr<const LidarScan> scan;
+    if (!pop(scan, timeout_sec)) return false;
+    view = ScanView(std::move(scan), sub_->view);
+    return true;
+}
+
+bool ScanSubscription::try_pop(ScanView& view) {
+    std::shared_ptr<const LidarScan> scan;
+    if (!try_pop(scan)) return false;
+    view = ScanView(std::move(scan), sub_->view);
+    return true;
+}
+
+const ScanViewSpec& ScanSubscription::view_spec() const {
+    static const ScanViewSpec whole;
+    return sub_ ? sub_->view : whole;
+}
+
+void ScanSubscription::unsubscribe() {
+    if (!sub_) return;
+    sub_->queue.close();
+    if (auto hub = hub_.lock()) hub->unsubscribe(sub_);
+    hub_.reset();
+}
+
+size_t ScanSubscription::size() const { return sub_ ? sub_->queue.size() : 0; }
+
+size_t ScanSubscription::depth() const {
+    return sub_ ? sub_->queue.capacity() : 0;
+}
+
+uint64_t ScanSubscription::delivered() const {
+    return sub_ ? sub_->delivered.load(std::memory_order_relaxed) : 0;
+}
+
+uint64_t ScanSubscription::dropped() const {
+    return sub_ ? sub_->dropped.load(std::memory_order_relaxed) : 0;
+}
+
+ScanSubscription::operator bool() const { return sub_ != nullptr; }
+
+ScanHub::ScanHub() : hub_(std::make_shared<ScanSubscription::Hub>()) {}
+
+ScanHub::~ScanHub() { close(); }
+
+ScanSubscription ScanHub::subscribe(size_t depth, DropPolicy policy) {
+    return subscribe(depth, policy, ScanViewSpec{});
+}
+
+ScanSubscription ScanHub::subscribe(size_t depth, DropPolicy policy,
+                                    const ScanViewSpec& view) {
+    if (depth == 0) {
+        throw std::invalid_argument("ScanHub: depth must be > 0");
+    }
+    if (view.row_step == 0 || view.col_step == 0) {
+        throw std::invalid_argument("ScanHub: view steps must be > 0");
+    }
+    auto sub = std::make_shared<hub_subscriber>(depth, policy, view);
+    {
+        std::lock_guard<std::mutex> lock(hub_->mutex);
+        if (hub_->closed.load()) {
+            throw std::logic_error("ScanHub: subscribe after close");
+        }
+        hub_->subscribers.push_back(sub);
+        hub_->version.fetch_add(1, std::memory_order_release);
+    }
+    ScanSubscription result;
+    result.sub_ = std::move(sub);
+    result.hub_ = hub_;
+    return result;
+}
+
+size_t ScanHub::publish(std::shared_ptr<const LidarScan> scan) {
+    if (!scan) throw std::invalid_argument("ScanHub: null scan");
+    auto& hub = *hub_;
+    if (hub.closed.load(std::memory_order_acquire)) return 0;
+    hub.published.fetch_add(1, std::memory_order_relaxed);
+
+    const uint64_t version = hub.version.load(std::memory_order_acquire);
+    if (version != hub.seen) {
+        std::lock_guard<std::mutex> lock(hub.mutex);
+        hub.snapshot = hub.subscribers;
+        hub.seen = hub.version.load(std::memory_order_relaxed);
+    }
+
+    size_t queued = 0;
+    for (const auto& sub : hub.snapshot) {
+        auto& queue = sub->queue;
+        bool pushed = queue.try_push(scan);
+        if (!pushed && sub->policy == DropPolicy::DROP_OLDEST) {
+            // make room; the subscriber may take the scans first
+            std::shared_ptr<const LidarScan> oldest;
+            while (!pushed && !queue.closed()) {
+                if (queue.try_pop(oldest)) {
+                    sub->dropped.fetch_add(1, std::memory_order_relaxed);
+                }
+                pushed = queue.try_push(scan);
+            }
+        } else if (!pushed && !queue.closed()) {
+            sub->dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (pushed) {
+            sub->delivered.fetch_add(1, std::memory_order_relaxed);
+            queued++;
+        }
+    }
+    return queued;
+}
+
+void ScanHub::close() {
+    std::lock_guard<std::mutex> lock(hub_->mutex);
+    hub_->closed.store(true);
+    for (const auto& sub : hub_->subscribers) sub->queue.close();
+}
+
+size_t ScanHub::subscribers() const {
+    std::lock_guard<std::mutex> lock(hub_->mutex);
+    return hub_->subscribers.size();
+}
+
+uint64_t ScanHub::published() const {
+    return hub_->published.load(std::memory_order_relaxed);
+}
+
+}  // namespace ouster
@@ -0,0 +1,108 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/scan_pool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace ouster {
+
+ScanPool::ScanPool(size_t w, size_t h, const LidarScanFieldTypes& fields,
+                   size_t columns_per_packet, size_t capacity,
+                   std::shared_ptr<MemoryResource> memory)
+    : w_{w},
+      h_{h},
+      fields_{fields},
+      columns_per_packet_{columns_per_packet},
+      capacity_{capacity},
+      memory_{std::move(memory)},
+      free_{std::max<size_t>(capacity, 1)} {
+    if (w == 0 || h == 0 || columns_per_packet == 0) {
+        throw std::invalid_argument(
+            "ScanPool: scan dimensions must be greater than zero");
+    }
+    std::sort(fields_.begin(), fields_.end());
+}
+
+ScanPool::ScanPool(const sensor::sensor_info& info,
+                   const LidarScanFieldTypes& fields, size_t capacity,
+                   std::shared_ptr<MemoryResource> memory)
+    : ScanPool(info.format.columns_per_frame, info.format.pixels_per_column,
+               fields, info.format.columns_per_packet, capacity,
+               std::move(memory)) {
+    batched_ = true;
+    const auto profile = get_field_types(info);
+    for (const auto& f : fields_) {
+        auto it = std::find_if(
+            profile.begin(), profile.end(),
+            [&](const FieldType& p) { return p.name == f.name; });
+        if (it == profile.end()) unbatched_.push_back(f.name);
+    }
+}
+
+std::unique_ptr<LidarScan> ScanPool::acquire() {
+    std::unique_ptr<LidarScan> scan;
+    if (free_.try_pop(scan)) {
+        // so that a ScanBatcher starts a new frame in it
+        scan->clear_headers();
+        zero_unbatched(*scan);
+        return scan;
+    }
+    return allocate();
+}
+
+std::unique_ptr<LidarScan> ScanPool::allocate() {
+    allocated_++;
+    // the batcher writes or zeroes every column of the profile fields, so
+    // only the others need clearing
+    const auto init = batched_ ? FieldInit::UNINITIALIZED : FieldInit::ZEROED;
+    std::unique_ptr<LidarScan> scan;
+    if (memory_) {
+        scan = std::make_unique<LidarScan>(LidarScan::make_contiguous(
+            w_, h_, fields_, columns_per_packet_, arena_allocator(memory_),
+            init));
+    } else {
+        scan = std::make_unique<LidarScan>(w_, h_, fields_,
+                                           columns_per_packet_, init);
+    }
+    zero_unbatched(*scan);
+    return scan;
+}
+
+void ScanPool::zero_unbatched(LidarScan& scan) const {
+    for (const auto& name : unbatched_) {
+        auto& f = scan.field(name);
+        std::memset(f.get(), 0, f.bytes());
+    }
+}
+
+bool ScanPool::release(std::unique_ptr<LidarScan> scan) {
+    if (!scan || capacity_ == 0 || !matches(*scan)) return false;
+    // freed on return when the pool is full
+    return free_.try_push(std::move(scan));
+}
+
+size_t ScanPool::reserve(size_t count) {
+    count = std::min(count, capacity_);
+    while (free_.size() < count) {
+        if (!free_.try_push(allocate())) break;
+    }
+    return free_.size();
+}
+
+bool ScanPool::matches(const LidarScan& scan) const {
+    return scan.w == w_ && scan.h == h_ &&
+           static_cast<size_t>(scan.packet_timestamp().rows()) ==
+               w_ / columns_per_packet_ &&
+           scan.has_field_types(fields_);
+}
+
+size_t ScanPool::allocated() const { return allocated_; }
+
+size_t ScanPool::available() const { return free_.size(); }
+
+}  // namespace ouster
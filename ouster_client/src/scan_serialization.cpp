@@ -0,0 +1,568 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/scan_serialization.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "lz4_block.h"
+#include "ouster/memory_resource.h"
+#include "ouster/types.h"
+
+namespace ouster {
+namespace impl {
+
+// layout of contiguous scans for ScanSerializer and deserialize_scan
+struct scan_arena_access {
+    // column and packet headers and the pose, in the order of the arena
+    static std::vector<const Field*> headers(const LidarScan& ls) {
+        return {&ls.timestamp_,        &ls.measurement_id_,
+                &ls.status_,           &ls.packet_timestamp_,
+                &ls.alert_flags_,      &ls.pose_};
+    }
+
+    static LidarScan layout(size_t w, size_t h,
+                            const LidarScanFieldTypes& field_types,
+                            size_t columns_per_packet,
+                            LidarScan::ArenaAllocator allocator) {
+        return LidarScan::layout_arena(w, h, field_types, columns_per_packet,
+                                       std::move(allocator), false);
+    }
+
+    static size_t columns_per_packet(const LidarScan& ls) {
+        return ls.columns_per_packet_;
+    }
+
+    static uint8_t* arena(LidarScan& ls) { return ls.arena_.get(); }
+};
+
+namespace {
+
+template <typename T>
+void put(std::vector<uint8_t>& out, T value) {
+    const auto* p = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), p, p + sizeof(T));
+}
+
+// reads the field table, checking that it stays within its bytes
+class table_reader {
+   public:
+    table_reader(const uint8_t* data, size_t size)
+        : data_(data), left_(size) {}
+
+    template <typename T>
+    T get() {
+        T value;
+        std::memcpy(&value, take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    std::string get_string(size_t n) {
+        const auto* p = reinterpret_cast<const char*>(take(n));
+        return {p, n};
+    }
+
+   private:
+    const uint8_t* take(size_t n) {
+        if (n > left_) throw std::runtime_error("corrupt field table");
+        const uint8_t* p = data_;
+        data_ += n;
+        left_ -= n;
+        return p;
+    }
+
+    const uint8_t* data_;
+    size_t left_;
+};
+
+}  // namespace
+
+std::vector<uint8_t> field_types_to_binary(const LidarScanFieldTypes& types) {
+    std::vector<uint8_t> out;
+    put<uint32_t>(out, types.size());
+    for (const auto& ft : types) {
+        put<uint32_t>(out, ft.name.size());
+        out.insert(out.end(), ft.name.begin(), ft.name.end());
+        put<uint8_t>(out, static_cast<uint8_t>(ft.element_type));
+        put<uint8_t>(out, static_cast<uint8_t>(ft.field_class));
+        put<uint32_t>(out, ft.extra_dims.size());
+        for (auto dim : ft.extra_dims) put<uint64_t>(out, dim);
+    }
+    return out;
+}
+
+LidarScanFieldTypes field_types_from_binary(const uint8_t* data, size_t size) {
+    table_reader in(data, size);
+    LidarScanFieldTypes types;
+    const auto n = in.get<uint32_t>();
+    for (uint32_t i = 0; i < n; i++) {
+        FieldType ft;
+        ft.name = in.get_string(in.get<uint32_t>());
+        const auto element_type = in.get<uint8_t>();
+        const auto field_class = in.get<uint8_t>();
+        if (element_type < sensor::ChanFieldType::UINT8 ||
+            element_type > sensor::ChanFieldType::FLOAT64 ||
+            field_class < static_cast<uint8_t>(FieldClass::PIXEL_FIELD) ||
+            field_class > static_cast<uint8_t>(FieldClass::SCAN_FIELD)) {
+            throw std::runtime_error("corrupt field table");
+        }
+        ft.element_type = static_cast<sensor::ChanFieldType>(element_type);
+        ft.field_class = static_cast<FieldClass>(field_class);
+        const auto ndims = in.get<uint32_t>();
+        for (uint32_t d = 0; d < ndims; d++) {
+            ft.extra_dims.push_back(in.get<uint64_t>());
+        }
+        types.push_back(std::move(ft));
+    }
+    return types;
+}
+
+}  // namespace impl
+
+namespace {
+
+constexpr uint64_t blob_magic = 0x424e43535453554f;  // "OUSTSCNB"
+constexpr uint32_t blob_version = 1;
+constexpr uint32_t flag_lz4 = 1;
+constexpr uint32_t flag_lossy = 2;
+constexpr size_t blob_align = field_alignment;
+
+// Start of a serialized scan. The payload, the arena of the scan or its LZ4
+// block, starts at the first 64 byte boundary after the sensor_info. Lossy
+// payloads start with the lossy fields instead: a uint64 size of the
+// section, then per field a uint32 index in the field table, a uint32 zero
+// and a uint64 size of its encode_lossy buffer, followed by the buffer
+// padded to 8 bytes. The LZ4 block of the arena, with these fields zeroed,
+// comes after the section.
+struct blob_header {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t flags;
+    uint32_t w;
+    uint32_t h;
+    uint32_t columns_per_packet;
+    uint8_t shutdown_countdown;
+    uint8_t shot_limiting_countdown;
+    uint16_t reserved;
+    int64_t frame_id;
+    uint64_t frame_status;
+    uint32_t table_bytes;
+    uint32_t info_bytes;
+    uint64_t payload_bytes;
+};
+
+static_assert(sizeof(blob_header) == 64, "unexpected serialized header size");
+
+const uint8_t zeros[blob_align] = {0};
+
+size_t align_up(size_t n) {
+    return (n + blob_align - 1) / blob_align * blob_align;
+}
+
+// fields in the order of the arena of the scan, or of the one
+// LidarScan::make_contiguous would lay out
+LidarScanFieldTypes arena_order(const LidarScan& scan) {
+    auto types = scan.field_types();
+    std::stable_sort(types.begin(), types.end(),
+                     [](const FieldType& a, const FieldType& b) {
+                         return (a.field_class == FieldClass::PIXEL_FIELD) >
+                                (b.field_class == FieldClass::PIXEL_FIELD);
+                     });
+    if (scan.is_contiguous()) {
+        std::sort(types.begin(), types.end(),
+                  [&](const FieldType& a, const FieldType& b) {
+                      return scan.field(a.name).get() <
+                             scan.field(b.name).get();
+                  });
+    }
+    return types;
+}
+
+std::vector<uint8_t> make_head(const LidarScan& scan,
+                               const LidarScanFieldTypes& types,
+                               size_t payload_bytes) {
+    const auto table = impl::field_types_to_binary(types);
+    const auto info = scan.sensor_info
+                          ? sensor::sensor_info_to_binary(*scan.sensor_info)
+                          : std::vector<uint8_t>{};
+    blob_header hdr{};
+    hdr.magic = blob_magic;
+    hdr.version = blob_version;
+    hdr.w = static_cast<uint32_t>(scan.w);
+    hdr.h = static_cast<uint32_t>(scan.h);
+    hdr.columns_per_packet = static_cast<uint32_t>(
+        impl::scan_arena_access::columns_per_packet(scan));
+    hdr.shutdown_countdown = scan.shutdown_countdown;
+    hdr.shot_limiting_countdown = scan.shot_limiting_countdown;
+    hdr.frame_id = scan.frame_id;
+    hdr.frame_status = scan.frame_status;
+    hdr.table_bytes = static_cast<uint32_t>(table.size());
+    hdr.info_bytes = static_cast<uint32_t>(info.size());
+    hdr.payload_bytes = payload_bytes;
+
+    std::vector<uint8_t> head(
+        align_up(sizeof(blob_header) + table.size() + info.size()), 0);
+    std::memcpy(head.data(), &hdr, sizeof(hdr));
+    std::copy(table.begin(), table.end(), head.begin() + sizeof(hdr));
+    std::copy(info.begin(), info.end(),
+              head.begin() + sizeof(hdr) + table.size());
+    return head;
+}
+
+blob_header read_header(const uint8_t* data, size_t size) {
+    blob_header hdr;
+    if (!data || size < sizeof(hdr)) {
+        throw std::invalid_argument("serialized scan: truncated header");
+    }
+    std::memcpy(&hdr, data, sizeof(hdr));
+    if (hdr.magic != blob_magic) {
+        throw std::invalid_argument("serialized scan: not a serialized scan");
+    }
+    if (hdr.version != blob_version || (hdr.flags & ~(flag_lz4 | flag_lossy))) {
+        throw std::invalid_argument(
+            "serialized scan: unsupported version " +
+            std::to_string(hdr.version));
+    }
+    if ((hdr.flags & flag_lossy) && !(hdr.flags & flag_lz4)) {
+        throw std::invalid_argument("serialized scan: invalid flags");
+    }
+    if (hdr.w == 0 || hdr.h == 0 || hdr.columns_per_packet == 0) {
+        throw std::invalid_argument("serialized scan: invalid dimensions");
+    }
+    return hdr;
+}
+
+size_t payload_offset(const blob_header& hdr) {
+    return align_up(sizeof(blob_header) + size_t{hdr.table_bytes} +
+                    hdr.info_bytes);
+}
+
+// the scan of a serialized one, with its arena from the allocator
+LidarScan layout_blob(const uint8_t* data, size_t size,
+                      const blob_header& hdr,
+                      LidarScan::ArenaAllocator allocator) {
+    if (size < payload_offset(hdr) ||
+        size - payload_offset(hdr) < hdr.payload_bytes) {
+        throw std::invalid_argument("serialized scan: truncated");
+    }
+    LidarScanFieldTypes types;
+    std::shared_ptr<sensor::sensor_info> info;
+    try {
+        types = impl::field_types_from_binary(data + sizeof(blob_header),
+                                              hdr.table_bytes);
+        if (hdr.info_bytes) {
+            info = std::make_shared<sensor::sensor_info>(
+                sensor::sensor_info_from_binary(
+                    data + sizeof(blob_header) + hdr.table_bytes,
+                    hdr.info_bytes));
+        }
+    } catch (const std::exception& e) {
+        throw std::invalid_argument(std::string("serialized scan: ") +
+                                    e.what());
+    }
+
+    LidarScan ls = impl::scan_arena_access::layout(
+        hdr.w, hdr.h, types, hdr.columns_per_packet, std::move(allocator));
+    ls.frame_id = hdr.frame_id;
+    ls.frame_status = hdr.frame_status;
+    ls.shutdown_countdown = hdr.shutdown_countdown;
+    ls.shot_limiting_countdown = hdr.shot_limiting_countdown;
+    ls.sensor_info = std::move(info);
+    return ls;
+}
+
+// LZ4 blocks expand at most 255 times
+constexpr size_t max_lz4_ratio = 255;
+
+bool is_lossy_type(const FieldType& ft) {
+    return ft.field_class == FieldClass::PIXEL_FIELD && ft.extra_dims.empty() &&
+           ft.element_type >= sensor::ChanFieldType::UINT8 &&
+           ft.element_type <= sensor::ChanFieldType::UINT64;
+}
+
+// the lossy section of a serialized scan, zeroing the fields in the arena
+std::vector<uint8_t> encode_lossy_fields(const LidarScan& scan,
+                                         const LidarScanFieldTypes& types,
+                                         const LossyFields& lossy,
+                                         uint8_t* arena) {
+    std::vector<uint8_t> out(sizeof(uint64_t), 0);
+    size_t offset = 0;
+    for (size_t i = 0; i < types.size(); i++) {
+        const FieldType& ft = types[i];
+        const Field& f = scan.field(ft.name);
+        const size_t at = offset;
+        offset = align_up(offset + f.bytes());
+        const auto it = lossy.find(ft.name);
+        if (it == lossy.end() || !is_lossy_type(ft)) continue;
+
+        std::vector<uint8_t> buf;
+        switch (ft.element_type) {
+            case sensor::ChanFieldType::UINT8:
+                buf = encode_lossy<uint8_t>(scan.field<uint8_t>(ft.name),
+                                            it->second);
+                break;
+            case sensor::ChanFieldType::UINT16:
+                buf = encode_lossy<uint16_t>(scan.field<uint16_t>(ft.name),
+                                             it->second);
+                break;
+            case sensor::ChanFieldType::UINT32:
+                buf = encode_lossy<uint32_t>(scan.field<uint32_t>(ft.name),
+                                             it->second);
+                break;
+            default:
+                buf = encode_lossy<uint64_t>(scan.field<uint64_t>(ft.name),
+                                             it->second);
+                break;
+        }
+        std::memset(arena + at, 0, f.bytes());
+        impl::put<uint32_t>(out, static_cast<uint32_t>(i));
+        impl::put<uint32_t>(out, 0);
+        impl::put<uint64_t>(out, buf.size());
+        out.insert(out.end(), buf.begin(), buf.end());
+        out.resize((out.size() + 7) / 8 * 8, 0);
+    }
+    if (out.size() == sizeof(uint64_t)) return {};
+    const uint64_t section_bytes = out.size();
+    std::memcpy(out.data(), &section_bytes, sizeof(section_bytes));
+    return out;
+}
+
+// decode the lossy section of a serialized scan into its fields
+void decode_lossy_fields(const uint8_t* section, size_t size,
+                         const LidarScanFieldTypes& types, LidarScan& ls) {
+    size_t at = sizeof(uint64_t);
+    while (at < size) {
+        if (size - at < 16) {
+            throw std::invalid_argument("serialized scan: corrupt lossy field");
+        }
+        uint32_t index;
+        uint64_t bytes;
+        std::memcpy(&index, section + at, sizeof(index));
+        std::memcpy(&bytes, section + at + 8, sizeof(bytes));
+        at += 16;
+        if (index >= types.size() || !is_lossy_type(types[index]) ||
+            bytes > size - at) {
+            throw std::invalid_argument("serialized scan: corrupt lossy field");
+        }
+        const uint8_t* buf = section + at;
+        const FieldType& ft = types[index];
+        switch (ft.element_type) {
+            case sensor::ChanFieldType::UINT8:
+                decode_lossy<uint8_t>(buf, bytes, ls.field<uint8_t>(ft.name));
+                break;
+            case sensor::ChanFieldType::UINT16:
+                decode_lossy<uint16_t>(buf, bytes,
+                                       ls.field<uint16_t>(ft.name));
+                break;
+            case sensor::ChanFieldType::UINT32:
+                decode_lossy<uint32_t>(buf, bytes,
+                                       ls.field<uint32_t>(ft.name));
+                break;
+            default:
+                decode_lossy<uint64_t>(buf, bytes,
+                                       ls.field<uint64_t>(ft.name));
+                break;
+        }
+        at += (bytes + 7) / 8 * 8;
+    }
+}
+
+}  // namespace
+
+ScanSerializer::ScanSerializer(const LidarScan& scan) {
+    const auto types = arena_order(scan);
+
+    // the blocks of the arena and their offsets
+    std::vector<const Field*> blocks;
+    for (const auto& ft : types) blocks.push_back(&scan.field(ft.name));
+    for (const Field* f : impl::scan_arena_access::headers(scan)) {
+        blocks.push_back(f);
+    }
+    std::vector<size_t> offsets;
+    size_t arena_bytes = 0;
+    for (const Field* f : blocks) {
+        offsets.push_back(arena_bytes);
+        arena_bytes = align_up(arena_bytes + f->bytes());
+    }
+
+    head_ = make_head(scan, types, arena_bytes);
+    chunks_.push_back({head_.data(), head_.size()});
+
+    const uint8_t* arena = scan.arena_data();
+    bool in_place = arena && scan.arena_size() == arena_bytes;
+    for (size_t i = 0; in_place && i < blocks.size(); i++) {
+        in_place = static_cast<const uint8_t*>(blocks[i]->get()) ==
+                   arena + offsets[i];
+    }
+    if (in_place) {
+        chunks_.push_back({arena, arena_bytes});
+    } else {
+        for (const Field* f : blocks) {
+            chunks_.push_back({f->get(), f->bytes()});
+            const size_t pad = align_up(f->bytes()) - f->bytes();
+            if (pad) chunks_.push_back({zeros, pad});
+        }
+    }
+    size_ = head_.size() + arena_bytes;
+}
+
+size_t ScanSerializer::size() const { return size_; }
+
+const std::vector<ScanChunk>& ScanSerializer::chunks() const {
+    return chunks_;
+}
+
+void ScanSerializer::copy_to(uint8_t* out) const {
+    for (const auto& c : chunks_) {
+        if (c.size) std::memcpy(out, c.data, c.size);
+        out += c.size;
+    }
+}
+
+std::vector<uint8_t> serialize_scan(const LidarScan& scan, bool compress,
+                                    const LossyFields& lossy) {
+    ScanSerializer serializer(scan);
+    if (!lossy.empty()) {
+        // the lossy fields are taken out of a copy of the arena
+        const auto& chunks = serializer.chunks();
+        const size_t offset = chunks.front().size;
+        const size_t arena_bytes = serializer.size() - offset;
+        std::vector<uint8_t> gathered(serializer.size());
+        serializer.copy_to(gathered.data());
+        const auto section = encode_lossy_fields(
+            scan, arena_order(scan), lossy, gathered.data() + offset);
+        if (!section.empty()) {
+            std::vector<uint8_t> out(offset + section.size() +
+                                     impl::lz4_bound(arena_bytes));
+            std::memcpy(out.data(), gathered.data(), offset);
+            std::memcpy(out.data() + offset, section.data(), section.size());
+            const size_t block_bytes = impl::lz4_compress(
+                gathered.data() + offset, arena_bytes,
+                out.data() + offset + section.size());
+            out.resize(offset + section.size() + block_bytes);
+
+            blob_header hdr;
+            std::memcpy(&hdr, out.data(), sizeof(hdr));
+            hdr.flags |= flag_lz4 | flag_lossy;
+            hdr.payload_bytes = section.size() + block_bytes;
+            std::memcpy(out.data(), &hdr, sizeof(hdr));
+            return out;
+        }
+    }
+    if (!compress) {
+        std::vector<uint8_t> out(serializer.size());
+        serializer.copy_to(out.data());
+        return out;
+    }
+
+    // the header and tables stay readable, only the arena is compressed,
+    // straight from the scan if it is contiguous
+    const auto& chunks = serializer.chunks();
+    const size_t offset = chunks.front().size;
+    const size_t arena_bytes = serializer.size() - offset;
+    std::vector<uint8_t> gathered;
+    const uint8_t* arena = static_cast<const uint8_t*>(chunks.back().data);
+    if (chunks.size() > 2) {
+        gathered.resize(serializer.size());
+        serializer.copy_to(gathered.data());
+        arena = gathered.data() + offset;
+    }
+
+    std::vector<uint8_t> out(offset + impl::lz4_bound(arena_bytes));
+    std::memcpy(out.data(), chunks.front().data, offset);
+    const size_t block_bytes =
+        impl::lz4_compress(arena, arena_bytes, out.data() + offset);
+    out.resize(offset + block_bytes);
+
+    blob_header hdr;
+    std::memcpy(&hdr, out.data(), sizeof(hdr));
+    hdr.flags |= flag_lz4;
+    hdr.payload_bytes = block_bytes;
+    std::memcpy(out.data(), &hdr, sizeof(hdr));
+    return out;
+}
+
+size_t serialized_scan_size(const uint8_t* data, size_t size) {
+    const blob_header hdr = read_header(data, size);
+    return payload_offset(hdr) + hdr.payload_bytes;
+}
+
+LidarScan deserialize_scan(const uint8_t* data, size_t size) {
+    const blob_header hdr = read_header(data, size);
+    const bool compressed = hdr.flags & flag_lz4;
+    auto heap = arena_allocator(heap_memory());
+    size_t arena_bytes = 0;
+    auto allocator = [&](size_t bytes) {
+        // before allocating what a corrupt table asks for
+        if (compressed ? bytes / max_lz4_ratio > hdr.payload_bytes
+                       : bytes != hdr.payload_bytes) {
+            throw std::invalid_argument(
+                "serialized scan: fields don't match the payload");
+        }
+        arena_bytes = bytes;
+        return heap(bytes);
+    };
+    LidarScan ls = layout_blob(data, size, hdr, allocator);
+
+    const uint8_t* payload = data + payload_offset(hdr);
+    size_t payload_bytes = hdr.payload_bytes;
+    uint64_t section_bytes = 0;
+    if (hdr.flags & flag_lossy) {
+        if (payload_bytes >= sizeof(section_bytes)) {
+            std::memcpy(&section_bytes, payload, sizeof(section_bytes));
+        }
+        if (section_bytes < sizeof(section_bytes) ||
+            section_bytes > payload_bytes) {
+            throw std::invalid_argument(
+                "serialized scan: corrupt lossy fields");
+        }
+        payload += section_bytes;
+        payload_bytes -= section_bytes;
+    }
+    uint8_t* arena = impl::scan_arena_access::arena(ls);
+    if (!compressed) {
+        std::memcpy(arena, payload, arena_bytes);
+    } else if (!impl::lz4_decompress(payload, payload_bytes, arena,
+                                     arena_bytes)) {
+        throw std::invalid_argument("serialized scan: corrupt LZ4 block");
+    }
+    if (section_bytes) {
+        try {
+            decode_lossy_fields(
+                payload - section_bytes, section_bytes,
+                impl::field_types_from_binary(data + sizeof(blob_header),
+                                              hdr.table_bytes),
+                ls);
+        } catch (const std::invalid_argument&) {
+            throw;
+        } catch (const std::exception& e) {
+            throw std::invalid_argument(std::string("serialized scan: ") +
+                                        e.what());
+        }
+    }
+    return ls;
+}
+
+LidarScan view_serialized_scan(std::shared_ptr<uint8_t> data, size_t size) {
+    const blob_header hdr = read_header(data.get(), size);
+    if (hdr.flags & flag_lz4) {
+        throw std::invalid_argument(
+            "serialized scan: compressed scans can't be viewed in place");
+    }
+    const size_t offset = payload_offset(hdr);
+    auto view = [&](size_t bytes) {
+        if (bytes != hdr.payload_bytes) {
+            throw std::invalid_argument(
+                "serialized scan: fields don't match the payload");
+        }
+        return std::shared_ptr<uint8_t>(data, data.get() + offset);
+    };
+    return layout_blob(data.get(), size, hdr, view);
+}
+
+}  // namespace ouster
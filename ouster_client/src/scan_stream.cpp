@@ -0,0 +1,578 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/scan_stream.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include "ouster/impl/logging.h"
+#include "ouster/impl/netcompat.h"
+#include "ouster/scan_hub.h"
+#include "ouster/scan_serialization.h"
+#include "ouster/threads.h"
+
+using ouster::sensor::logger;
+using namespace ouster::sensor::impl;
+
+namespace ouster {
+
+namespace {
+
+// The client sends a request, the server replies with the metadata of the
+// sensor or why it turned the request down, then streams serialized scans.
+// Values are in the byte order of the host, as in serialized scans.
+constexpr uint32_t request_magic = 0x5153534f;  // "OSSQ"
+constexpr uint32_t reply_magic = 0x5253534f;    // "OSSR"
+constexpr uint32_t stream_version = 2;
+constexpr uint32_t flag_compress = 1;
+
+struct request_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t flags;
+    uint32_t decimation;
+    uint32_t queue_depth;
+    uint32_t max_range_error;  // 0 to send the range fields losslessly
+    uint32_t fields_bytes;     // names of the fields, separated by '\n'
+};
+
+struct reply_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t status;  // 0 if accepted, the reply is the metadata of the sensor
+    uint32_t bytes;   // bytes of the reply that follows
+};
+
+constexpr uint32_t max_fields_bytes = 64 * 1024;
+constexpr uint32_t max_reply_bytes = 64 * 1024 * 1024;
+constexpr size_t max_scan_bytes = size_t{1} << 32;
+constexpr size_t scan_header_bytes = 64;
+constexpr int request_timeout_sec = 5;
+constexpr double poll_sec = 0.1;
+
+#ifdef MSG_NOSIGNAL
+constexpr int send_flags = MSG_NOSIGNAL;
+#else
+constexpr int send_flags = 0;
+#endif
+
+#ifdef _WIN32
+constexpr int shutdown_both = SD_BOTH;
+#else
+constexpr int shutdown_both = SHUT_RDWR;
+#endif
+
+bool send_all(SOCKET sock, const void* data, size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        const int chunk = static_cast<int>(std::min<size_t>(size, 1 << 30));
+        const auto sent = ::send(sock, p, chunk, send_flags);
+        if (sent <= 0) return false;
+        p += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+// @return the bytes received, fewer than size if the peer closed the
+// connection, or -1 on error or timeout
+int64_t recv_all(SOCKET sock, void* data, size_t size) {
+    char* p = static_cast<char*>(data);
+    size_t received = 0;
+    while (received < size) {
+        const int chunk =
+            static_cast<int>(std::min<size_t>(size - received, 1 << 30));
+        const auto len = ::recv(sock, p + received, chunk, 0);
+        if (len == 0) break;
+        if (len < 0) return -1;
+        received += static_cast<size_t>(len);
+    }
+    return static_cast<int64_t>(received);
+}
+
+// @return 1 if the socket is readable, 0 on timeout, -1 on error
+int wait_readable(SOCKET sock, double timeout_sec) {
+    fd_set fds;
+    FD_ZERO(&fds);
+    FD_SET(sock, &fds);
+    timeval tv;
+    timeval* ptv = nullptr;
+    if (timeout_sec >= 0) {
+        tv.tv_sec = static_cast<long>(timeout_sec);
+        tv.tv_usec = static_cast<long>((timeout_sec - tv.tv_sec) * 1e6);
+        ptv = &tv;
+    }
+    const int ret = ::select(static_cast<int>(sock) + 1, &fds, nullptr,
+                             nullptr, ptv);
+    return ret < 0 ? -1 : (ret > 0 ? 1 : 0);
+}
+
+std::vector<std::string> split_fields(const std::string& names) {
+    std::vector<std::string> fields;
+    std::stringstream ss(names);
+    std::string name;
+    while (std::getline(ss, name)) {
+        if (!name.empty()) fields.push_back(name);
+    }
+    return fields;
+}
+
+SOCKET listen_socket(const std::string& address, int port) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    addrinfo* info_start = nullptr;
+    const std::string service = std::to_string(port);
+    const int ret = getaddrinfo(address.empty() ? nullptr : address.c_str(),
+                                service.c_str(), &hints, &info_start);
+    if (ret != 0) {
+        throw std::runtime_error("ScanStreamServer: getaddrinfo(): " +
+                                 std::string(gai_strerror(ret)));
+    }
+    // prefer IPv6, which also accepts IPv4 clients unless the OS says not
+    std::vector<addrinfo*> candidates;
+    for (addrinfo* ai = info_start; ai != nullptr; ai = ai->ai_next) {
+        candidates.push_back(ai);
+    }
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const addrinfo* a, const addrinfo* b) {
+                         return a->ai_family == AF_INET6 &&
+                                b->ai_family != AF_INET6;
+                     });
+    SOCKET sock = SOCKET_ERROR;
+    std::string error;
+    for (addrinfo* ai : candidates) {
+        sock = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (!socket_valid(sock)) {
+            error = socket_get_error();
+            continue;
+        }
+        if (ai->ai_family == AF_INET6) {
+            int off = 0;
+            setsockopt(sock, IPPROTO_IPV6, IPV6_V6ONLY,
+                       reinterpret_cast<const char*>(&off), sizeof(off));
+        }
+        socket_set_reuse(sock);
+        if (::bind(sock, ai->ai_addr, static_cast<socklen_t>(ai->ai_addrlen)) ||
+            ::listen(sock, SOMAXCONN)) {
+            error = socket_get_error();
+            socket_close(sock);
+            sock = SOCKET_ERROR;
+            continue;
+        }
+        break;
+    }
+    freeaddrinfo(info_start);
+    if (!socket_valid(sock)) {
+        throw std::runtime_error("ScanStreamServer: can't listen on port " +
+                                 service + ": " + error);
+    }
+    return sock;
+}
+
+int bound_port(SOCKET sock) {
+    sockaddr_storage addr{};
+    socklen_t len = sizeof(addr);
+    if (getsockname(sock, reinterpret_cast<sockaddr*>(&addr), &len)) {
+        return 0;
+    }
+    if (addr.ss_family == AF_INET6) {
+        return ntohs(reinterpret_cast<sockaddr_in6*>(&addr)->sin6_port);
+    }
+    return ntohs(reinterpret_cast<sockaddr_in*>(&addr)->sin_port);
+}
+
+SOCKET connect_socket(const std::string& host, int port) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* info_start = nullptr;
+    const std::string service = std::to_string(port);
+    const int ret =
+        getaddrinfo(host.c_str(), service.c_str(), &hints, &info_start);
+    if (ret != 0) {
+        throw std::runtime_error("ScanStreamClient: getaddrinfo(): " +
+                                 std::string(gai_strerror(ret)));
+    }
+    SOCKET sock = SOCKET_ERROR;
+    std::string error = "no address";
+    for (addrinfo* ai = info_start; ai != nullptr; ai = ai->ai_next) {
+        sock = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (!socket_valid(sock)) {
+            error = socket_get_error();
+            continue;
+        }
+        if (::connect(sock, ai->ai_addr,
+                      static_cast<socklen_t>(ai->ai_addrlen)) < 0) {
+            error = socket_get_error();
+            socket_close(sock);
+            sock = SOCKET_ERROR;
+            continue;
+        }
+        break;
+    }
+    freeaddrinfo(info_start);
+    if (!socket_valid(sock)) {
+        throw std::runtime_error("ScanStreamClient: can't connect to " +
+                                 host + ":" + service + ": " + error);
+    }
+    return sock;
+}
+
+}  // namespace
+
+// ========================== ScanStreamServer =============================
+
+struct ScanStreamServer::Impl {
+    struct Connection {
+        SOCKET sock;
+        std::thread thread;
+        std::atomic<bool> done{false};
+        std::atomic<uint64_t> dropped{0};
+    };
+
+    std::string metadata;
+    SOCKET listen_sock{SOCKET_ERROR};
+    int port{0};
+    ScanHub hub;
+    std::atomic<bool> running{true};
+    std::thread accept_thread;
+
+    // guards connections, last and dropped_closed
+    mutable std::mutex mutex;
+    std::vector<std::shared_ptr<Connection>> connections;
+    std::shared_ptr<const LidarScan> last;
+    uint64_t dropped_closed{0};
+
+    std::atomic<uint64_t> accepted{0};
+    std::atomic<uint64_t> rejected{0};
+    std::atomic<uint64_t> scans_sent{0};
+    std::atomic<uint64_t> bytes_sent{0};
+
+    void accept_loop() {
+        while (running) {
+            reap(false);
+            if (wait_readable(listen_sock, poll_sec) <= 0) continue;
+            const SOCKET sock = ::accept(listen_sock, nullptr, nullptr);
+            if (!socket_valid(sock)) continue;
+            auto conn = std::make_shared<Connection>();
+            conn->sock = sock;
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!running) {
+                socket_close(sock);
+                break;
+            }
+            conn->thread =
+                start_thread("ouster-stream", [this, conn] { serve(*conn); });
+            connections.push_back(conn);
+        }
+    }
+
+    // Join the connections that are done, or all of them
+    void reap(bool all) {
+        std::vector<std::shared_ptr<Connection>> finished;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = std::partition(
+                connections.begin(), connections.end(),
+                [all](const std::shared_ptr<Connection>& conn) {
+                    return !all && !conn->done;
+                });
+            finished.assign(it, connections.end());
+            connections.erase(it, connections.end());
+            for (const auto& conn : finished) {
+                // wakes a connection blocked sending to a stalled client
+                if (all) ::shutdown(conn->sock, shutdown_both);
+            }
+        }
+        for (const auto& conn : finished) {
+            if (conn->thread.joinable()) conn->thread.join();
+            socket_close(conn->sock);
+            std::lock_guard<std::mutex> lock(mutex);
+            dropped_closed += conn->dropped;
+        }
+    }
+
+    // @return an empty string if the request can be served, why not otherwise
+    std::string check_request(const request_header& req,
+                              const std::vector<std::string>& fields) {
+        if (req.decimation == 0) return "decimation must be at least 1";
+        if (req.queue_depth == 0) return "queue depth must be at least 1";
+        LidarScanFieldTypes types;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (last) types = last->field_types();
+        }
+        if (types.empty()) return "";
+        for (const auto& name : fields) {
+            auto found = std::find_if(
+                types.begin(), types.end(),
+                [&name](const FieldType& type) { return type.name == name; });
+            if (found == types.end()) {
+                return "the scans have no field '" + name + "'";
+            }
+        }
+        return "";
+    }
+
+    bool reply(SOCKET sock, uint32_t status, const std::string& body) {
+        const reply_header rep{reply_magic, stream_version, status,
+                               static_cast<uint32_t>(body.size())};
+        return send_all(sock, &rep, sizeof(rep)) &&
+               send_all(sock, body.data(), body.size());
+    }
+
+    void serve(Connection& conn) {
+        struct finish {
+            Connection& conn;
+            ~finish() { conn.done = true; }
+        } done{conn};
+
+        request_header req{};
+        socket_set_rcvtimeout(conn.sock, request_timeout_sec);
+        if (recv_all(conn.sock, &req, sizeof(req)) !=
+                static_cast<int64_t>(sizeof(req)) ||
+            req.magic != request_magic || req.fields_bytes > max_fields_bytes) {
+            ++rejected;
+            return;
+        }
+        std::string names(req.fields_bytes, '\0');
+        if (recv_all(conn.sock, &names[0], names.size()) !=
+            static_cast<int64_t>(names.size())) {
+            ++rejected;
+            return;
+        }
+        const std::vector<std::string> fields = split_fields(names);
+        std::string error =
+            req.version != stream_version
+                ? "unsupported version " + std::to_string(req.version)
+                : check_request(req, fields);
+        if (!error.empty()) {
+            ++rejected;
+            reply(conn.sock, 1, error);
+            return;
+        }
+
+        auto sub = hub.subscribe(req.queue_depth, DropPolicy::DROP_OLDEST);
+        if (!reply(conn.sock, 0, metadata)) return;
+        ++accepted;
+
+        const bool compress = req.flags & flag_compress;
+        LossyFields lossy;
+        if (req.max_range_error) {
+            lossy = {{sensor::ChanField::RANGE, req.max_range_error},
+                     {sensor::ChanField::RANGE2, req.max_range_error}};
+        }
+        LidarScanFieldTypes types;
+        std::shared_ptr<const LidarScan> scan;
+        while (running) {
+            if (!sub.pop(scan, poll_sec)) continue;
+            conn.dropped = sub.dropped();
+            if (req.decimation > 1 && scan->frame_id % req.decimation != 0) {
+                continue;
+            }
+            std::vector<uint8_t> buf;
+            if (fields.empty()) {
+                buf = serialize_scan(*scan, compress, lossy);
+            } else {
+                types.clear();
+                for (const auto& name : fields) {
+                    if (scan->has_field(name)) {
+                        types.push_back(scan->field_type(name));
+                    }
+                }
+                buf = serialize_scan(LidarScan(*scan, types), compress,
+                                     lossy);
+            }
+            if (!send_all(conn.sock, buf.data(), buf.size())) break;
+            ++scans_sent;
+            bytes_sent += buf.size();
+        }
+        conn.dropped = sub.dropped();
+    }
+};
+
+ScanStreamServer::ScanStreamServer(const sensor::sensor_info& info, int port,
+                                   const std::string& address)
+    : impl_(std::make_shared<Impl>()) {
+    impl_->metadata = info.to_json_string();
+    impl_->listen_sock = listen_socket(address, port);
+    impl_->port = bound_port(impl_->listen_sock);
+    Impl* impl = impl_.get();
+    impl_->accept_thread =
+        start_thread("ouster-accept", [impl] { impl->accept_loop(); });
+}
+
+ScanStreamServer::~ScanStreamServer() { close(); }
+
+size_t ScanStreamServer::publish(std::shared_ptr<const LidarScan> scan) {
+    if (!scan) {
+        throw std::invalid_argument("ScanStreamServer: null scan");
+    }
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        impl_->last = scan;
+    }
+    return impl_->hub.publish(std::move(scan));
+}
+
+void ScanStreamServer::close() {
+    if (!impl_->running.exchange(false)) return;
+    impl_->hub.close();
+    if (impl_->accept_thread.joinable()) impl_->accept_thread.join();
+    impl_->reap(true);
+    socket_close(impl_->listen_sock);
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->last.reset();
+}
+
+int ScanStreamServer::port() const { return impl_->port; }
+
+size_t ScanStreamServer::clients() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return static_cast<size_t>(
+        std::count_if(impl_->connections.begin(), impl_->connections.end(),
+                      [](const std::shared_ptr<Impl::Connection>& conn) {
+                          return !conn->done;
+                      }));
+}
+
+ScanStreamStats ScanStreamServer::stats() const {
+    ScanStreamStats stats;
+    stats.clients = impl_->accepted;
+    stats.rejected = impl_->rejected;
+    stats.scans_sent = impl_->scans_sent;
+    stats.bytes_sent = impl_->bytes_sent;
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    stats.scans_dropped = impl_->dropped_closed;
+    for (const auto& conn : impl_->connections) {
+        stats.scans_dropped += conn->dropped;
+    }
+    return stats;
+}
+
+// ========================== ScanStreamClient =============================
+
+struct ScanStreamClient::Impl {
+    SOCKET sock{SOCKET_ERROR};
+    std::shared_ptr<sensor::sensor_info> info;
+    std::vector<uint8_t> buf;
+    bool closed{false};
+};
+
+ScanStreamClient::ScanStreamClient(const std::string& host, int port,
+                                   const ScanStreamRequest& request,
+                                   double timeout_sec)
+    : impl_(new Impl) {
+    if (request.decimation == 0 || request.queue_depth == 0) {
+        throw std::invalid_argument(
+            "ScanStreamClient: decimation and queue_depth must be at least 1");
+    }
+    std::string names;
+    for (const auto& field : request.fields) {
+        if (field.empty() || field.find('\n') != std::string::npos) {
+            throw std::invalid_argument("ScanStreamClient: bad field name '" +
+                                        field + "'");
+        }
+        names += field + "\n";
+    }
+
+    impl_->sock = connect_socket(host, port);
+    try {
+        socket_set_rcvtimeout(
+            impl_->sock, std::max(1, static_cast<int>(timeout_sec + 0.5)));
+        const request_header req{request_magic,
+                                 stream_version,
+                                 request.compress ? flag_compress : 0,
+                                 request.decimation,
+                                 request.queue_depth,
+                                 request.max_range_error,
+                                 static_cast<uint32_t>(names.size())};
+        if (!send_all(impl_->sock, &req, sizeof(req)) ||
+            !send_all(impl_->sock, names.data(), names.size())) {
+            throw std::runtime_error("ScanStreamClient: send(): " +
+                                     socket_get_error());
+        }
+        reply_header rep{};
+        if (recv_all(impl_->sock, &rep, sizeof(rep)) !=
+                static_cast<int64_t>(sizeof(rep)) ||
+            rep.magic != reply_magic || rep.bytes > max_reply_bytes) {
+            throw std::runtime_error(
+                "ScanStreamClient: no reply from the server");
+        }
+        std::string body(rep.bytes, '\0');
+        if (recv_all(impl_->sock, &body[0], body.size()) !=
+            static_cast<int64_t>(body.size())) {
+            throw std::runtime_error("ScanStreamClient: truncated reply");
+        }
+        if (rep.status != 0) {
+            throw std::runtime_error(
+                "ScanStreamClient: the server turned down the request: " +
+                body);
+        }
+        impl_->info = std::make_shared<sensor::sensor_info>(body);
+    } catch (...) {
+        socket_close(impl_->sock);
+        throw;
+    }
+}
+
+ScanStreamClient::~ScanStreamClient() { close(); }
+
+const sensor::sensor_info& ScanStreamClient::sensor_info() const {
+    return *impl_->info;
+}
+
+std::unique_ptr<LidarScan> ScanStreamClient::get_scan(double timeout_sec) {
+    if (impl_->closed) return nullptr;
+    const int ready = wait_readable(impl_->sock, timeout_sec);
+    if (ready == 0) return nullptr;
+    if (ready < 0) {
+        throw std::runtime_error("ScanStreamClient: select(): " +
+                                 socket_get_error());
+    }
+
+    auto& buf = impl_->buf;
+    buf.resize(scan_header_bytes);
+    const int64_t got = recv_all(impl_->sock, buf.data(), buf.size());
+    if (got == 0) {
+        close();
+        return nullptr;
+    }
+    if (got != static_cast<int64_t>(buf.size())) {
+        throw std::runtime_error("ScanStreamClient: connection lost");
+    }
+    const size_t size = serialized_scan_size(buf.data(), buf.size());
+    if (size < scan_header_bytes || size > max_scan_bytes) {
+        throw std::runtime_error("ScanStreamClient: bad scan size");
+    }
+    buf.resize(size);
+    const size_t rest = size - scan_header_bytes;
+    if (recv_all(impl_->sock, buf.data() + scan_header_bytes, rest) !=
+        static_cast<int64_t>(rest)) {
+        throw std::runtime_error("ScanStreamClient: connection lost");
+    }
+    auto scan =
+        std::make_unique<LidarScan>(deserialize_scan(buf.data(), buf.size()));
+    if (!scan->sensor_info) scan->sensor_info = impl_->info;
+    return scan;
+}
+
+bool ScanStreamClient::closed() const { return impl_->closed; }
+
+void ScanStreamClient::close() {
+    if (impl_->closed) return;
+    impl_->closed = true;
+    socket_close(impl_->sock);
+}
+
+}  // namespace ouster
@@ -0,0 +1,144 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/scan_view.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace ouster {
+
+namespace {
+
+// fill dst with count equal blocks, the i-th copied from index(i) units of
+// unit bytes into src
+template <typename Index>
+void gather(const Field& src, Field& dst, size_t count, size_t unit,
+            Index index) {
+    if (count == 0) return;
+    const size_t size = dst.bytes() / count;
+    const auto* from = static_cast<const uint8_t*>(src.get());
+    auto* to = static_cast<uint8_t*>(dst.get());
+    for (size_t i = 0; i < count; i++) {
+        std::memcpy(to + i * size, from + index(i) * unit, size);
+    }
+}
+
+// fill dst with count blocks, the i-th copied from block index(i) of src
+template <typename Index>
+void gather(const Field& src, Field& dst, size_t count, Index index) {
+    if (count == 0) return;
+    gather(src, dst, count, dst.bytes() / count, index);
+}
+
+// the descriptor of a field with its first dimensions replaced
+FieldDescriptor resized(const FieldDescriptor& desc,
+                        std::initializer_list<size_t> dims) {
+    std::vector<size_t> shape(dims);
+    shape.insert(shape.end(), desc.shape.begin() + dims.size(),
+                 desc.shape.end());
+    FieldDescriptor out = desc;
+    out.shape = shape;
+    out.strides = impl::calculate_strides(shape);
+    return out;
+}
+
+}  // namespace
+
+ScanView::ScanView() = default;
+
+ScanView::ScanView(std::shared_ptr<const LidarScan> scan,
+                   const ScanViewSpec& spec)
+    : scan_(std::move(scan)), spec_(spec) {
+    if (!scan_) throw std::invalid_argument("ScanView: null scan");
+    if (spec_.row_step == 0 || spec_.col_step == 0) {
+        throw std::invalid_argument("ScanView: steps must be > 0");
+    }
+    const size_t w = scan_->w;
+    const size_t h = scan_->h;
+    if (spec_.first_row >= h || spec_.first_col >= w) {
+        throw std::invalid_argument("ScanView: region starts outside scan");
+    }
+    if (spec_.rows == 0) spec_.rows = h - spec_.first_row;
+    if (spec_.cols == 0) spec_.cols = w - spec_.first_col;
+    if (spec_.first_row + spec_.rows > h || spec_.first_col + spec_.cols > w) {
+        throw std::invalid_argument("ScanView: region ends outside scan");
+    }
+    h_ = (spec_.rows + spec_.row_step - 1) / spec_.row_step;
+    w_ = (spec_.cols + spec_.col_step - 1) / spec_.col_step;
+}
+
+LidarScan ScanView::materialize() const {
+    if (!scan_) throw std::invalid_argument("ScanView: empty view");
+    const LidarScan& src = *scan_;
+    const size_t src_packets = std::max<size_t>(src.packet_count(), 1);
+    const size_t src_cpp = (src.w + src_packets - 1) / src_packets;
+    const size_t cpp = std::max<size_t>(src_cpp / spec_.col_step, 1);
+
+    LidarScan result(w_, h_, LidarScanFieldTypes{}, cpp, FieldInit::ZEROED);
+    result.frame_status = src.frame_status;
+    result.shutdown_countdown = src.shutdown_countdown;
+    result.shot_limiting_countdown = src.shot_limiting_countdown;
+    result.frame_id = src.frame_id;
+
+    const size_t packets = result.packet_count();
+    auto col = [this](size_t j) { return this->col(j); };
+    // the packet of the first column of each packet of the result
+    auto packet = [&](size_t p) { return col(p * cpp) / src_cpp; };
+
+    result.timestamp() = timestamp();
+    result.measurement_id() = measurement_id();
+    result.status() = status();
+    for (size_t p = 0; p < packets; p++) {
+        result.packet_timestamp()[p] = src.packet_timestamp()[packet(p)];
+        result.alert_flags()[p] = src.alert_flags()[packet(p)];
+    }
+    gather(src.pose(), result.pose(), w_, col);
+
+    for (const auto& kv : src.fields()) {
+        const std::string& name = kv.first;
+        const Field& f = kv.second;
+        const FieldDescriptor& desc = f.desc();
+        switch (f.field_class()) {
+            case FieldClass::PIXEL_FIELD: {
+                Field& dst = result.add_field(
+                    name, resized(desc, {h_, w_}), FieldClass::PIXEL_FIELD);
+                if (spec_.col_step == 1) {
+                    // a run of columns of each row at once
+                    const size_t pixel = dst.bytes() / (h_ * w_);
+                    gather(f, dst, h_, pixel, [&](size_t i) {
+                        return row(i) * src.w + spec_.first_col;
+                    });
+                } else {
+                    gather(f, dst, h_ * w_, [&](size_t i) {
+                        return row(i / w_) * src.w + col(i % w_);
+                    });
+                }
+                break;
+            }
+            case FieldClass::COLUMN_FIELD: {
+                Field& dst = result.add_field(name, resized(desc, {w_}),
+                                              FieldClass::COLUMN_FIELD);
+                gather(f, dst, w_, col);
+                break;
+            }
+            case FieldClass::PACKET_FIELD: {
+                Field& dst = result.add_field(name, resized(desc, {packets}),
+                                              FieldClass::PACKET_FIELD);
+                gather(f, dst, packets, packet);
+                break;
+            }
+            default: {
+                Field& dst = result.add_field(name, desc, f.field_class());
+                std::memcpy(dst.get(), f.get(), f.bytes());
+            }
+        }
+    }
+    return result;
+}
+
+}  // namespace ouster
@@ -5,11 +5,27 @@
 
 #include "ouster/sensor_client.h"
 
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <future>
 #include <jsoncons/json.hpp>
+#include <sstream>
 
 #include "ouster/defaults.h"
 #include "ouster/impl/logging.h"
+#include "ouster/impl/spin_wait.h"
 #include "ouster/metadata.h"
+#include "ouster/threads.h"
+#include "ouster/trace.h"
+
+#ifdef __linux__
+#include <linux/filter.h>
+#endif
 
 using ouster::sensor::impl::Logger;
 using ouster::sensor::util::SensorHttp;
@@ -27,8 +43,7 @@ jsoncons::json collect_metadata(SensorHttp& sensor_http, int timeout_sec);
 
 SOCKET mtp_data_socket(int port, const std::vector<std::string>& udp_dest_hosts,
                        const std::string& mtp_dest_host = "");
-bool set_config(SensorHttp& sensor_http, const sensor_config& config,
-                uint8_t config_flags, int timeout_sec);
+jsoncons::json config_to_json(const sensor_config& config);
 
 void add_socket_to_groups(SOCKET sock_fd,
                           const std::vector<std::string>& udp_dest_hosts,
@@ -75,15 +90,194 @@ std::shared_ptr<ouster::sensor::util::SensorHttp> Sensor::http_client() const {
     return http_client_;
 }
 
+namespace {
+
+// whole seconds left before a deadline, rounded up
+int seconds_left(std::chrono::steady_clock::time_point deadline) {
+    auto left = std::chrono::duration<double>(
+                    deadline - std::chrono::steady_clock::now())
+                    .count();
+    if (left <= 0) {
+        throw std::runtime_error("startup timeout exceeded");
+    }
+    return static_cast<int>(std::ceil(left));
+}
+
+// file caching the metadata of a sensor
+std::string metadata_cache_path(const std::string& dir,
+                                const std::string& hostname) {
+    std::string name = hostname;
+    for (auto& c : name) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' &&
+            c != '.')
+            c = '_';
+    }
+    return dir + "/" + name + ".json";
+}
+
+bool read_metadata_cache(const std::string& path, sensor_info& info) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::stringstream buf;
+    buf << in.rdbuf();
+    try {
+        info = sensor_info(buf.str());
+    } catch (const std::exception& e) {
+        logger().warn("Ignoring metadata cache {}: {}", path, e.what());
+        return false;
+    }
+    return true;
+}
+
+// written next to the cache and renamed so readers never see a partial file
+void write_metadata_cache(const std::string& path, const sensor_info& info) {
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp);
+        out << info.to_json_string();
+        if (!out) {
+            logger().warn("Failed to write metadata cache {}", path);
+            return;
+        }
+    }
+    std::remove(path.c_str());
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        logger().warn("Failed to write metadata cache {}", path);
+    }
+}
+
+// whether every setting of the desired config is already applied
+bool config_applied(const sensor_config& active,
+                    const sensor_config& desired) {
+    auto active_json = config_to_json(active);
+    auto desired_json = config_to_json(desired);
+    for (const auto& it : desired_json.object_range()) {
+        if (!active_json.contains(it.key()) ||
+            active_json[it.key()] != it.value()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// fill the desired ports left to the sensor or to the ephemeral port
+sensor_config resolve_ports(const Sensor& sensor, const sensor_info& metadata,
+                            int ephemeral_port) {
+    auto desired_config = sensor.desired_config();
+    if (desired_config.udp_port_lidar == 0)
+        desired_config.udp_port_lidar = ephemeral_port;
+    else if (!desired_config.udp_port_lidar)
+        desired_config.udp_port_lidar = metadata.config.udp_port_lidar;
+    if (desired_config.udp_port_imu == 0)
+        desired_config.udp_port_imu = ephemeral_port;
+    else if (!desired_config.udp_port_imu)
+        desired_config.udp_port_imu = metadata.config.udp_port_imu;
+    return desired_config;
+}
+
+// fetch the metadata of a sensor, configuring it first if requested
+sensor_info start_sensor(const Sensor& sensor, size_t index,
+                         int ephemeral_port,
+                         std::chrono::steady_clock::time_point deadline,
+                         const CaptureOptions& options) {
+    auto report = [&](StartupStage stage, const std::string& message) {
+        if (options.startup_progress) {
+            options.startup_progress(index, stage, message);
+        }
+    };
+    try {
+        // a sensor keeps its init_id until it reinitializes, which applying
+        // a new config does, so a cache matching it is still current
+        std::string cache;
+        if (!options.metadata_cache_dir.empty()) {
+            cache = metadata_cache_path(options.metadata_cache_dir,
+                                        sensor.hostname());
+            sensor_info cached;
+            if (read_metadata_cache(cache, cached) &&
+                config_applied(
+                    cached.config,
+                    resolve_ports(sensor, cached, ephemeral_port))) {
+                report(StartupStage::CHECKING_CACHE, sensor.hostname());
+                try {
+                    auto status = jsoncons::json::parse(
+                        sensor.http_client()->sensor_info(
+                            seconds_left(deadline)));
+                    if (status["prod_sn"].as<std::string>() ==
+                            std::to_string(cached.sn) &&
+                        status["initialization_id"].as<uint64_t>() ==
+                            cached.init_id &&
+                        status["status"].as<std::string>() == "RUNNING") {
+                        report(StartupStage::DONE, sensor.hostname());
+                        return cached;
+                    }
+                } catch (const std::exception& e) {
+                    logger().warn("Failed to check metadata cache {}: {}",
+                                  cache, e.what());
+                }
+            }
+        }
+
+        report(StartupStage::FETCHING_METADATA, sensor.hostname());
+        auto metadata = sensor.fetch_metadata(seconds_left(deadline));
+        auto desired_config = resolve_ports(sensor, metadata, ephemeral_port);
+
+        // Don't do anything no configuration is requested
+        if (!(desired_config == sensor_config{})) {
+            report(StartupStage::CONFIGURING, sensor.hostname());
+            set_config(*sensor.http_client(), desired_config, 0 /*flags*/,
+                       seconds_left(deadline));
+            report(StartupStage::REINITIALIZING, sensor.hostname());
+            metadata = sensor.fetch_metadata(seconds_left(deadline));
+        }
+
+        if (!cache.empty()) write_metadata_cache(cache, metadata);
+        report(StartupStage::DONE, sensor.hostname());
+        return metadata;
+    } catch (const std::exception& e) {
+        report(StartupStage::FAILED, e.what());
+        throw;
+    }
+}
+
+}  // namespace
+
+/// Scratch arrays for recvmmsg, kept between calls to avoid reallocation
+struct SensorClient::RecvBatch {
+#ifdef __linux__
+    std::vector<mmsghdr> msgs;
+    std::vector<iovec> iovecs;
+    std::vector<sockaddr_storage> addrs;
+    // control message space for receive timestamps, only used when enabled
+    struct alignas(cmsghdr) Control {
+        char buf[impl::SOCKET_TIMESTAMP_CONTROL_SIZE];
+    };
+    std::vector<Control> controls;
+
+    void resize(size_t size) {
+        if (msgs.size() < size) {
+            msgs.resize(size);
+            iovecs.resize(size);
+            addrs.resize(size);
+            controls.resize(size);
+        }
+    }
+#endif
+};
+
 SensorClient::~SensorClient() { close(); }
 
 SensorClient::SensorClient(const std::vector<Sensor>& sensors, double timeout,
-                           double buffer_time)
-    : SensorClient(sensors, {}, timeout, buffer_time) {}
+                           double buffer_time,
+                           ReceiveTimestampMode timestamp_mode,
+                           const CaptureOptions& capture_options)
+    : SensorClient(sensors, {}, timeout, buffer_time, timestamp_mode,
+                   capture_options) {}
 
 SensorClient::SensorClient(const std::vector<Sensor>& sensors,
                            const std::vector<sensor_info>& infos,
-                           double config_timeout, double buffer_time) {
+                           double config_timeout, double buffer_time,
+                           ReceiveTimestampMode timestamp_mode,
+                           const CaptureOptions& capture_options) {
     // if we need an ephemeral port, create it now
     int ephemeral_port = -1;
     for (const auto& sensor : sensors) {
@@ -131,45 +325,32 @@ SensorClient::SensorClient(const std::vector<Sensor>& sensors,
             }
         }
     } else {
-        // configure sensors if necessary for the new ports
-        std::map<int, sensor_info> fetched;
-        sensor_config empty_config;
+        // configure the sensors and fetch their metadata concurrently so
+        // startup does not take N times the reinit time
+        const auto deadline =
+            std::chrono::steady_clock::now() +
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(config_timeout));
+        std::vector<std::future<sensor_info>> futures;
         for (size_t i = 0; i < sensors.size(); i++) {
-            const auto& sensor = sensors[i];
-            auto desired_config = sensors[i].desired_config();
-            auto metadata = sensor.fetch_metadata(config_timeout);
-
-            if (desired_config.udp_port_lidar == 0)
-                desired_config.udp_port_lidar = ephemeral_port;
-            else if (!desired_config.udp_port_lidar)
-                desired_config.udp_port_lidar = metadata.config.udp_port_lidar;
-            if (desired_config.udp_port_imu == 0)
-                desired_config.udp_port_imu = ephemeral_port;
-            else if (!desired_config.udp_port_imu)
-                desired_config.udp_port_imu = metadata.config.udp_port_imu;
-
-            // Don't do anything no configuration is requested
-            if (desired_config == empty_config) {
-                fetched[i] = metadata;
-                continue;
-            }
-
-            set_config(*sensor.http_client(), desired_config, 0 /*flags*/,
-                       config_timeout);
+            futures.push_back(std::async(
+                std::launch::async, start_sensor, std::cref(sensors[i]), i,
+                ephemeral_port, deadline, std::cref(capture_options)));
         }
 
-        // if we need to, try and fetch missing configs
-        // do this last so we dont wait N*reinit time to reconfigure lidars
+        // wait for every sensor so that all failures are reported at once
+        std::string failures;
         for (size_t i = 0; i < sensors.size(); i++) {
-            // fetch any missing metadata
-            auto res = fetched.find(i);
-            if (res != fetched.end()) {
-                sensor_info_.push_back(res->second);
-            } else {
-                sensor_info_.push_back(
-                    sensors[i].fetch_metadata(config_timeout));
+            try {
+                sensor_info_.push_back(futures[i].get());
+            } catch (const std::exception& e) {
+                failures += "\n  '" + sensors[i].hostname() + "': " + e.what();
             }
         }
+        if (!failures.empty()) {
+            close();
+            throw std::runtime_error("Failed to start sensors:" + failures);
+        }
     }
 
     // build a list of any multicast addresses we need to listen to
@@ -193,9 +374,15 @@ SensorClient::SensorClient(const std::vector<Sensor>& sensors,
         hints.ai_family = AF_UNSPEC;      // IPv4, todo dont care
         hints.ai_socktype = SOCK_STREAM;  // TCP socket
 
+        // Drop the port of "host:port" hostnames, e.g. of simulated sensors
+        // serving HTTP on other ports, packets come from the host
+        std::string host = sensor.hostname();
+        if (std::count(host.begin(), host.end(), ':') == 1) {
+            host.erase(host.find(':'));
+        }
+
         // Use getaddrinfo to resolve the address.
-        if (getaddrinfo(sensor.hostname().c_str(), NULL, &hints, &result) !=
-            0) {
+        if (getaddrinfo(host.c_str(), NULL, &hints, &result) != 0) {
             throw std::runtime_error("Could not resolve address '" +
                                      sensor.hostname() + "' for sensor.");
         }
@@ -264,62 +451,257 @@ SensorClient::SensorClient(const std::vector<Sensor>& sensors,
         add_socket_to_groups(sockets_[0], multicast_addrs);
     }
 
+    if (capture_options.receive_buffer_bytes > 0) {
+        for (auto sock : sockets_) {
+            int actual = impl::socket_set_rcvbuf(
+                sock, capture_options.receive_buffer_bytes);
+            if (actual == SOCKET_ERROR) {
+                logger().warn("udp setsockopt(SO_RCVBUF): {}",
+                              impl::socket_get_error());
+            } else if (actual < capture_options.receive_buffer_bytes) {
+                logger().warn(
+                    "Requested a {} byte receive buffer but the kernel "
+                    "capped it to {} bytes",
+                    capture_options.receive_buffer_bytes, actual);
+            }
+        }
+    }
+
+    if (capture_options.backend == CaptureBackend::PACKET_MMAP) {
+        start_capture(capture_options, timestamp_mode);
+    } else if (timestamp_mode != ReceiveTimestampMode::USERSPACE) {
+        // request kernel receive timestamps, falling back to userspace ones
+        // if the platform doesn't support them
+        bool hardware = timestamp_mode == ReceiveTimestampMode::HARDWARE;
+        timestamp_mode_ = timestamp_mode;
+        for (auto sock : sockets_) {
+            if (impl::socket_enable_timestamps(sock, hardware,
+                                               capture_options.interface)) {
+                logger().warn(
+                    "Failed to enable receive timestamps, using userspace "
+                    "timestamps: {}",
+                    impl::socket_get_error());
+                timestamp_mode_ = ReceiveTimestampMode::USERSPACE;
+                for (auto s : sockets_) impl::socket_disable_timestamps(s);
+                break;
+            }
+        }
+    }
+
+    if (capture_options.busy_poll_usec > 0) {
+        busy_poll_ = true;
+        std::vector<SOCKET> busy_sockets = sockets_;
+        if (capture_) busy_sockets = {capture_->socket()};
+        for (auto sock : busy_sockets) {
+            if (impl::socket_set_busy_poll(sock,
+                                           capture_options.busy_poll_usec)) {
+                logger().warn(
+                    "Failed to set SO_BUSY_POLL, only spinning in userspace: "
+                    "{}",
+                    impl::socket_get_error());
+                break;
+            }
+        }
+    }
+
+#ifdef _WIN32
+    // select() can't keep up with several high resolution sensors, so keep
+    // receives posted on a completion port instead
+    if (!capture_ && capture_options.overlapped_receives > 0) {
+        try {
+            iocp_ = std::make_unique<impl::IocpReceiver>(
+                sockets_, capture_options.overlapped_receives);
+        } catch (const std::exception& e) {
+            logger().warn("Failed to set up I/O completion port, polling "
+                          "the sockets instead: {}",
+                          e.what());
+        }
+    }
+#endif
+
+    // watch every socket with a poller that scales with the number of sensors
+    poller_ = impl::make_poller(impl::poller_backend::AUTO);
+    impl::reset_poll(*poller_);
+    if (capture_) {
+        impl::set_poll_socket(*poller_, capture_->socket());
+    } else if (!iocp_) {
+        for (auto sock : sockets_) {
+            impl::set_poll_socket(*poller_, sock);
+        }
+    }
+
     // finally create our buffer thread if requested
     if (buffer_time > 0) {
         start_buffer_thread(buffer_time);
     }
 }
 
+void SensorClient::start_capture(const CaptureOptions& options,
+                                 ReceiveTimestampMode timestamp_mode) {
+    std::set<int> ports;
+    for (const auto& info : sensor_info_) {
+        ports.insert(info.config.udp_port_lidar.value());
+        ports.insert(info.config.udp_port_imu.value());
+    }
+    try {
+        capture_ = std::make_unique<impl::PacketMmapCapture>(
+            options.interface, ports, options.block_size, options.block_count,
+            options.block_timeout_ms,
+            timestamp_mode == ReceiveTimestampMode::HARDWARE);
+    } catch (...) {
+        close();
+        throw;
+    }
+    // capture frames carry their own kernel timestamp
+    timestamp_mode_ = timestamp_mode;
+
+#ifdef __linux__
+    // The UDP sockets stay open to keep multicast memberships and avoid ICMP
+    // port unreachable replies, but everything they would queue is already
+    // read from the ring, so have the kernel discard it.
+    sock_filter drop_all = BPF_STMT(BPF_RET | BPF_K, 0);
+    sock_fprog prog;
+    prog.len = 1;
+    prog.filter = &drop_all;
+    for (auto sock : sockets_) {
+        if (setsockopt(sock, SOL_SOCKET, SO_ATTACH_FILTER, &prog,
+                       sizeof(prog))) {
+            logger().warn("Failed to attach socket filter: {}",
+                          impl::socket_get_error());
+        }
+    }
+#endif
+    logger().info("Capturing packets on {} with PACKET_MMAP",
+                  options.interface.empty() ? "all interfaces"
+                                            : options.interface);
+}
+
 void SensorClient::start_buffer_thread(double buffer_time) {
+    // size the ring from the expected packet rate of all sensors so that it
+    // holds roughly buffer_time seconds worth of packets
+    const double imu_packets_per_sec = 100;
+    double packets_per_sec = 0;
+    size_t max_size = 0;
+    for (size_t i = 0; i < sensor_info_.size(); i++) {
+        const auto& df = sensor_info_[i].format;
+        double fps = df.fps ? df.fps : 20;
+        size_t per_packet = std::max<size_t>(df.columns_per_packet, 1);
+        double lidar_packets_per_frame = std::ceil(
+            df.columns_per_frame / static_cast<double>(per_packet));
+        packets_per_sec += lidar_packets_per_frame * fps + imu_packets_per_sec;
+        max_size = std::max({max_size, formats_[i]->lidar_packet_size,
+                             formats_[i]->imu_packet_size});
+    }
+    // one extra byte so that oversized packets can be told apart
+    max_size += 1;
+    size_t capacity =
+        std::max<size_t>(std::ceil(buffer_time * packets_per_sec), 1);
+    logger().info("Buffering up to {} packets", capacity);
+
+    BufferEvent prototype{};
+    prototype.data.reserve(max_size);
+    buffer_ = std::make_unique<impl::DropOldestRingBuffer<BufferEvent>>(
+        capacity, prototype);
+
     do_buffer_ = true;
-    buffer_thread_ = std::thread([this, buffer_time]() {
+    buffer_thread_ = start_thread("ouster-buffer", [this, max_size]() {
         std::vector<uint8_t> data;
-        const uint64_t buffer_ns = buffer_time * 1000000000.0;
+        data.reserve(max_size);
         while (do_buffer_) {
             uint64_t ts;
-            InternalEvent ev = get_packet_internal(data, ts, 0.01);
+            InternalEvent ev = get_packet_internal(data, ts, 0.01, max_size);
             if (ev.event_type == ClientEvent::PollTimeout) {
                 continue;
             }
-            // Enqueue received packets
-            {
-                std::unique_lock<std::mutex> lock(buffer_mutex_);
-                BufferEvent be;
+            // Enqueue received packets, discarding old buffered packets if our
+            // consumer couldn't keep up. Buffers are swapped rather than
+            // copied, so they are reused once the ring has cycled.
+            dropped_packets_ += buffer_->push([&](BufferEvent& be) {
                 be.event = ev;
                 be.timestamp = ts;
                 std::swap(be.data, data);
-                be.data.shrink_to_fit();  // can save a lot of memory, though
-                                          // does force a copy
-                buffer_.push_back(std::move(be));
-
-                // Discard old buffered packets if our consumer couldn't keep up
-                uint64_t expiry_time = ts - buffer_ns;
-                while (buffer_.size() &&
-                       (buffer_.front().timestamp < expiry_time)) {
-                    buffer_.pop_front();
-                    dropped_packets_++;
+            });
+            if (latency_stats_.load(std::memory_order_relaxed)) {
+                size_t depth = buffer_->size();
+                if (depth > max_buffer_depth_.load(std::memory_order_relaxed)) {
+                    max_buffer_depth_.store(depth, std::memory_order_relaxed);
                 }
             }
-            buffer_cv_.notify_one();
+            // the fence in notify_all, after the push, pairs with the one
+            // in wait after the consumer registers as a sleeper, so either
+            // we see the sleeper or it sees the packet: no lost wakeup
+            buffer_waiter_.notify_all();
         }
     });
 }
 
+bool SensorClient::wait_for_buffer(double timeout_sec) {
+    if (!buffer_->empty()) {
+        return true;
+    }
+    if (busy_poll_) {
+        return impl::spin_until([this] { return !buffer_->empty(); },
+                                timeout_sec);
+    }
+    return buffer_waiter_.wait([this] { return !buffer_->empty(); },
+                               timeout_sec);
+}
+
 void SensorClient::flush() {
     if (!do_buffer_) {
         return;
     }
-    std::unique_lock<std::mutex> lock(buffer_mutex_);
-    buffer_.clear();
+    buffer_->flush();
+}
+
+void SensorClient::set_packet_callback(PacketCallback callback,
+                                       Executor executor) {
+    if (callback_thread_.joinable()) {
+        run_callback_ = false;
+        callback_thread_.join();
+    }
+    if (!callback) {
+        return;
+    }
+    run_callback_ = true;
+    callback_thread_ =
+        start_thread("ouster-recv", [this, callback, executor]() {
+            while (run_callback_) {
+                // short timeouts so stopping doesn't wait on a quiet sensor
+                ClientEvent ev = get_pooled_packet(0.05);
+                if (ev.type == ClientEvent::PollTimeout) {
+                    continue;
+                }
+                if (executor) {
+                    // the pooled packet keeps the packet alive for the task
+                    executor([callback, ev]() mutable { callback(ev); });
+                } else {
+                    callback(ev);
+                }
+                if (ev.type == ClientEvent::Exit) {
+                    break;
+                }
+            }
+        });
 }
 
 void SensorClient::close() {
+    if (callback_thread_.joinable()) {
+        run_callback_ = false;
+        callback_thread_.join();
+    }
     // signal our thread to exit and join if joinable
     if (buffer_thread_.joinable()) {
         do_buffer_ = false;
         buffer_thread_.join();
     }
     // close all our sockets
+    if (poller_) {
+        impl::reset_poll(*poller_);
+    }
+    capture_.reset();
+    // before the sockets, so no receive is left writing to its buffers
+    iocp_.reset();
     for (auto socket : sockets_) {
         impl::socket_close(socket);
     }
@@ -328,14 +710,13 @@ void SensorClient::close() {
 
 size_t SensorClient::buffer_size() {
     if (do_buffer_) {
-        std::unique_lock<std::mutex> lock(buffer_mutex_);
-        return buffer_.size();
+        return buffer_->size();
     }
     return 0;
 }
 
-SensorClient::InternalEvent SensorClient::get_packet_internal(
-    std::vector<uint8_t>& data, uint64_t& ts, double timeout_sec) {
+SensorClient::InternalEvent SensorClient::poll_sockets(uint64_t& ts,
+                                                      double timeout_sec) {
     if (sockets_.size() == 0) {
         auto now = std::chrono::system_clock::now();
         auto now_ts = std::chrono::duration_cast<std::chrono::nanoseconds>(
@@ -345,22 +726,38 @@ SensorClient::InternalEvent SensorClient::get_packet_internal(
         return {-1, PacketType::Unknown,
                 ClientEvent::Exit};  // someone called us while shut down
     }
-    // setup poll
-    SOCKET max_fd = 0;
-    fd_set fds;
-    FD_ZERO(&fds);
-    for (auto sock : sockets_) {
-        FD_SET(sock, &fds);
-        max_fd = std::max(max_fd, sock);
-    }
 
-    // poll up to timeout for a new packet
-    timeval tv;
-    tv.tv_sec = timeout_sec;
-    tv.tv_usec = fmod(timeout_sec, 1.0) * 1000000.0;
+    // frames left in a ring block that was already handed over don't make
+    // the capture socket readable again
+    if (capture_ && capture_->ready()) {
+        auto now = std::chrono::system_clock::now();
+        ts = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                 now.time_since_epoch())
+                 .count();
+        return {-1, PacketType::Unknown, ClientEvent::Packet};
+    }
 
-    int ret =
-        select(max_fd + 1, &fds, NULL, NULL, timeout_sec < 0 ? NULL : &tv);
+    // poll up to timeout for a new packet, the sockets were registered with
+    // the poller when they were opened
+    int ret;
+    if (iocp_) {
+        if (busy_poll_) {
+            impl::spin_until([&] { return (ret = iocp_->wait(0)) != 0; },
+                             timeout_sec);
+        } else {
+            ret = iocp_->wait(timeout_sec);
+        }
+    } else if (busy_poll_) {
+        impl::spin_until(
+            [&] {
+                ret = impl::poll_for(*poller_, 0);
+                return ret != 0 || (capture_ && capture_->ready());
+            },
+            timeout_sec);
+        if (ret == 0 && capture_ && capture_->ready()) ret = 1;
+    } else {
+        ret = impl::poll_for(*poller_, timeout_sec);
+    }
     auto now = std::chrono::system_clock::now();
     ts = std::chrono::duration_cast<std::chrono::nanoseconds>(
              now.time_since_epoch())
@@ -370,109 +767,447 @@ SensorClient::InternalEvent SensorClient::get_packet_internal(
     } else if (ret < 0) {
         return {-1, PacketType::Unknown, ClientEvent::Error};
     }
-    struct sockaddr_storage from_addr;
-    socklen_t addr_len = sizeof(from_addr);
+    return {-1, PacketType::Unknown, ClientEvent::Packet};
+}
 
-    data.resize(65535);  // need enough room for maximum possible packet size
-    for (auto sock : sockets_) {
-        if (!FD_ISSET(sock, &fds)) continue;
+SensorClient::InternalEvent SensorClient::classify_packet(
+    const sockaddr_storage& from_addr, size_t size) const {
+    const sockaddr_in6* addr6 = (const sockaddr_in6*)&from_addr;
+    const sockaddr_in* addr4 = (const sockaddr_in*)&from_addr;
+    int source = -1;
+    for (size_t i = 0; i < addresses_.size(); i++) {
+        if (from_addr.ss_family == AF_INET6 &&
+            memcmp(addr6->sin6_addr.s6_addr, addresses_[i].ipv6, 16) == 0) {
+            source = i;
+            break;
+        }
+        if (from_addr.ss_family == AF_INET6 &&
+            memcmp(addr6->sin6_addr.s6_addr, addresses_[i].ipv6_4, 16) == 0) {
+            source = i;
+            break;
+        } else if (from_addr.ss_family == AF_INET &&
+                   addr4->sin_addr.s_addr == addresses_[i].ipv4) {
+            source = i;
+            break;
+        }
+    }
+    if (source == -1) {
+        // if we got a random packet, just say we got nothing
+        return {-1, PacketType::Unknown, ClientEvent::PollTimeout};
+    }
 
-        auto size = recvfrom(sock, (char*)data.data(), 65535, 0,
-                             (struct sockaddr*)&from_addr, &addr_len);
-        if (size <= 0) continue;  // this is unexpected
+    // detect packet type by size
+    const size_t imu_size = formats_[source]->imu_packet_size;
+    if (size > imu_size) {
+        return {source, PacketType::Lidar, ClientEvent::Packet};
+    } else if (size == imu_size) {
+        return {source, PacketType::Imu, ClientEvent::Packet};
+    }
+    // The sensor returned an invalid packet size, say we got nothing
+    return {-1, PacketType::Unknown, ClientEvent::PollTimeout};
+}
 
-        sockaddr_in6* addr6 = (sockaddr_in6*)&from_addr;
-        sockaddr_in* addr4 = (sockaddr_in*)&from_addr;
-        int source = -1;
-        for (size_t i = 0; i < addresses_.size(); i++) {
-            if (from_addr.ss_family == AF_INET6 &&
-                memcmp(addr6->sin6_addr.s6_addr, addresses_[i].ipv6, 16) == 0) {
-                source = i;
-                break;
-            }
-            if (from_addr.ss_family == AF_INET6 &&
-                memcmp(addr6->sin6_addr.s6_addr, addresses_[i].ipv6_4, 16) ==
-                    0) {
-                source = i;
-                break;
-            } else if (from_addr.ss_family == AF_INET &&
-                       addr4->sin_addr.s_addr == addresses_[i].ipv4) {
-                source = i;
-                break;
-            }
+int64_t SensorClient::receive(SOCKET sock, std::vector<uint8_t>& data,
+                              size_t max_size, sockaddr_storage& from_addr,
+                              uint64_t& ts) {
+    if (timestamp_mode_ == ReceiveTimestampMode::USERSPACE) {
+        socklen_t addr_len = sizeof(from_addr);
+        return recvfrom(sock, (char*)data.data(), max_size, 0,
+                        (struct sockaddr*)&from_addr, &addr_len);
+    }
+    uint64_t kernel_ts;
+    auto size = impl::socket_recv_timestamped(sock, data.data(), max_size,
+                                              &from_addr, kernel_ts);
+    if (kernel_ts) ts = kernel_ts;
+    return size;
+}
+
+SensorClient::InternalEvent SensorClient::get_packet_internal(
+    std::vector<uint8_t>& data, uint64_t& ts, double timeout_sec,
+    size_t max_size) {
+    OUSTER_TRACE_SCOPE("client", "SensorClient::get_packet");
+    InternalEvent res = poll_sockets(ts, timeout_sec);
+    if (res.event_type != ClientEvent::Packet) {
+        return res;
+    }
+    struct sockaddr_storage from_addr;
+
+    if (capture_) {
+        uint64_t capture_ts;
+        size_t size = capture_->next(data, max_size, from_addr, capture_ts);
+        if (size == 0) {
+            return {-1, PacketType::Unknown, ClientEvent::PollTimeout};
+        }
+        if (timestamp_mode_ != ReceiveTimestampMode::USERSPACE) {
+            ts = capture_ts;
         }
-        if (source == -1) {
-            // if we got a random packet, just say we got nothing
+        return classify_packet(from_addr, size);
+    }
+
+    if (iocp_) {
+        size_t size = iocp_->next(data, max_size, from_addr, ts);
+        if (size == 0) {
             return {-1, PacketType::Unknown, ClientEvent::PollTimeout};
         }
+        return classify_packet(from_addr, size);
+    }
 
-        // detect packet type by size
-        const int imu_size = formats_[source]->imu_packet_size;
-        if (size > imu_size) {
-            data.resize(size);
-            return {source, PacketType::Lidar, ClientEvent::Packet};
-        } else if (size == imu_size) {
+    data.resize(max_size);  // need enough room for maximum possible packet size
+    for (auto sock : sockets_) {
+        if (!impl::get_poll_socket(*poller_, sock)) continue;
+
+        auto size = receive(sock, data, max_size, from_addr, ts);
+        if (size <= 0) continue;  // this is unexpected
+
+        InternalEvent ev = classify_packet(from_addr, size);
+        if (ev.event_type == ClientEvent::Packet) {
             data.resize(size);
-            return {source, PacketType::Imu, ClientEvent::Packet};
-        } else {
-            // The sensor returned an invalid packet size, say we got nothing
-            return {-1, PacketType::Unknown, ClientEvent::PollTimeout};
         }
+        return ev;
     }
     return {-1, PacketType::Unknown,
             ClientEvent::Error};  // this shouldnt happen
 }
 
-ClientEvent SensorClient::get_packet(double timeout_sec) {
-    // poll on all our sockets
-    InternalEvent ev;
+size_t SensorClient::get_packets_internal(
+    std::vector<InternalEvent>& events,
+    std::vector<std::vector<uint8_t>>& buffers,
+    std::vector<uint64_t>& timestamps, std::vector<size_t>& sizes,
+    size_t max_packets, double timeout_sec) {
+    OUSTER_TRACE_SCOPE("client", "SensorClient::get_packets");
+    events.clear();
+    timestamps.clear();
+    sizes.clear();
     uint64_t ts;
-    if (do_buffer_) {
-        std::unique_lock<std::mutex> lock(buffer_mutex_);
-        // if the buffer if empty, wait for a new event
-        if (!buffer_.size()) {
-            auto duration = std::chrono::duration<double>(timeout_sec);
-            auto res = buffer_cv_.wait_for(lock, duration);
-            // check for timeout or for spurious wakeup of "wait_for"
-            // by checking whether the buffer is empty
-            if (res == std::cv_status::timeout || buffer_.empty()) {
-                return ClientEvent(0, -1, ClientEvent::PollTimeout);
+    InternalEvent res = poll_sockets(ts, timeout_sec);
+    if (res.event_type != ClientEvent::Packet) {
+        events.push_back(res);
+        return 0;
+    }
+
+    if (buffers.size() < max_packets) {
+        buffers.resize(max_packets);
+    }
+
+    size_t count = 0;
+    if (capture_) {
+        while (count < max_packets) {
+            struct sockaddr_storage from_addr;
+            auto& buf = buffers[count];
+            uint64_t capture_ts;
+            size_t size = capture_->next(buf, 65535, from_addr, capture_ts);
+            if (size == 0) break;
+
+            InternalEvent ev = classify_packet(from_addr, size);
+            if (ev.event_type != ClientEvent::Packet) continue;
+            events.push_back(ev);
+            timestamps.push_back(
+                timestamp_mode_ != ReceiveTimestampMode::USERSPACE ? capture_ts
+                                                                   : ts);
+            sizes.push_back(size);
+            count++;
+        }
+        if (count == 0) {
+            events.push_back(
+                {-1, PacketType::Unknown, ClientEvent::PollTimeout});
+        }
+        return count;
+    }
+    if (iocp_) {
+        // every completion dequeued by the poll, without another syscall
+        while (count < max_packets) {
+            struct sockaddr_storage from_addr;
+            auto& buf = buffers[count];
+            uint64_t completion_ts;
+            size_t size = iocp_->next(buf, 65535, from_addr, completion_ts);
+            if (size == 0) break;
+
+            InternalEvent ev = classify_packet(from_addr, size);
+            if (ev.event_type != ClientEvent::Packet) continue;
+            events.push_back(ev);
+            timestamps.push_back(completion_ts);
+            sizes.push_back(size);
+            count++;
+        }
+        if (count == 0) {
+            events.push_back(
+                {-1, PacketType::Unknown, ClientEvent::PollTimeout});
+        }
+        return count;
+    }
+#ifdef __linux__
+    if (!recv_batch_) {
+        recv_batch_ = std::make_unique<RecvBatch>();
+    }
+    recv_batch_->resize(max_packets);
+    auto& msgs = recv_batch_->msgs;
+    auto& iovecs = recv_batch_->iovecs;
+    auto& addrs = recv_batch_->addrs;
+    auto& controls = recv_batch_->controls;
+    const bool want_timestamps =
+        timestamp_mode_ != ReceiveTimestampMode::USERSPACE;
+#endif
+    for (auto sock : sockets_) {
+        if (count >= max_packets) break;
+        if (!impl::get_poll_socket(*poller_, sock)) continue;
+#ifdef __linux__
+        // receive everything already queued on this socket in one syscall
+        const size_t remaining = max_packets - count;
+        for (size_t i = 0; i < remaining; i++) {
+            auto& buf = buffers[count + i];
+            // grown once, then kept at full size
+            if (buf.size() < 65535) buf.resize(65535);
+            iovecs[i].iov_base = buf.data();
+            iovecs[i].iov_len = buf.size();
+            memset(&msgs[i].msg_hdr, 0, sizeof(msgs[i].msg_hdr));
+            msgs[i].msg_hdr.msg_iov = &iovecs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_name = &addrs[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+            if (want_timestamps) {
+                msgs[i].msg_hdr.msg_control = controls[i].buf;
+                msgs[i].msg_hdr.msg_controllen = sizeof(controls[i].buf);
             }
+            msgs[i].msg_len = 0;
         }
-        // dequeue
-        auto& buf = buffer_.front();
-        ev = buf.event;
-        ts = buf.timestamp;
-        std::swap(staging_buffer, buf.data);
-        buffer_.pop_front();
-        lock.unlock();  // unlock asap
-    } else {
-        ev = get_packet_internal(staging_buffer, ts, timeout_sec);
+        int received =
+            recvmmsg(sock, msgs.data(), remaining, MSG_DONTWAIT, nullptr);
+        if (received <= 0) continue;  // this is unexpected
+
+        size_t next = count;
+        for (int i = 0; i < received; i++) {
+            size_t size = msgs[i].msg_len;
+            if (size == 0) continue;
+            InternalEvent ev = classify_packet(addrs[i], size);
+            if (ev.event_type != ClientEvent::Packet) continue;
+            // compact valid packets to the front of the batch
+            if (count + i != next) {
+                std::swap(buffers[next], buffers[count + i]);
+            }
+            events.push_back(ev);
+            sizes.push_back(size);
+            uint64_t kernel_ts =
+                want_timestamps
+                    ? impl::socket_control_timestamp(msgs[i].msg_hdr)
+                    : 0;
+            timestamps.push_back(kernel_ts ? kernel_ts : ts);
+            next++;
+        }
+        count = next;
+#else
+        // sockets are non-blocking, so drain until there is nothing left
+        while (count < max_packets) {
+            struct sockaddr_storage from_addr;
+            auto& buf = buffers[count];
+            if (buf.size() < 65535) buf.resize(65535);
+            uint64_t packet_ts = ts;
+            auto size = receive(sock, buf, 65535, from_addr, packet_ts);
+            if (size <= 0) break;
+
+            InternalEvent ev = classify_packet(from_addr, size);
+            if (ev.event_type != ClientEvent::Packet) continue;
+            events.push_back(ev);
+            timestamps.push_back(packet_ts);
+            sizes.push_back(static_cast<size_t>(size));
+            count++;
+        }
+#endif
+    }
+
+    if (count == 0) {
+        // only got stray or invalid packets, say we got nothing
+        events.push_back({-1, PacketType::Unknown, ClientEvent::PollTimeout});
+    }
+    return count;
+}
+
+void SensorClient::record_delivery(const InternalEvent& ev, uint64_t ts) {
+    if (!latency_stats_.load(std::memory_order_relaxed) ||
+        ev.event_type != ClientEvent::Packet) {
+        return;
     }
+    auto& packets =
+        ev.packet_type == PacketType::Imu ? imu_packets_ : lidar_packets_;
+    packets.fetch_add(1, std::memory_order_relaxed);
+    const uint64_t now =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    delivery_latency_.record(now > ts ? now - ts : 0);
+}
 
+ClientEvent SensorClient::make_event(const InternalEvent& ev, uint64_t ts,
+                                     std::vector<uint8_t>& data, size_t size,
+                                     LidarPacket& lidar_packet,
+                                     ImuPacket& imu_packet) {
     ClientEvent rev;
     rev.source = ev.source;
     rev.type = ev.event_type;
     if (ev.event_type == ClientEvent::Packet) {
         if (ev.packet_type == PacketType::Imu) {
-            rev.packet_ = &imu_packet_;
+            rev.packet_ = &imu_packet;
         } else if (ev.packet_type == PacketType::Lidar) {
-            rev.packet_ = &lidar_packet_;
+            rev.packet_ = &lidar_packet;
         } else {
             throw;  // Should never happen, but who knows
         }
         rev.packet_->host_timestamp = ts;
         rev.packet_->format = formats_[ev.source];
-        std::swap(rev.packet_->buf, staging_buffer);
+        if (data.size() == size) {
+            std::swap(rev.packet_->buf, data);
+        } else {
+            // a full size receive buffer, kept for the next call; the packet
+            // keeps its capacity so this doesn't allocate either
+            rev.packet_->buf.assign(data.begin(), data.begin() + size);
+        }
+        record_delivery(ev, ts);
     } else {
         rev.packet_ = 0;
     }
     return rev;
 }
 
-uint64_t SensorClient::dropped_packets() {
-    std::unique_lock<std::mutex> lock(buffer_mutex_);
-    return dropped_packets_;
+bool SensorClient::next_event(InternalEvent& ev, uint64_t& ts,
+                              std::vector<uint8_t>& data, double timeout_sec) {
+    if (do_buffer_) {
+        // if the buffer if empty, wait for a new event, then dequeue. The
+        // pop can still fail if the buffer was flushed in the meantime
+        return wait_for_buffer(timeout_sec) &&
+               buffer_->pop([&](BufferEvent& buf) {
+                   ev = buf.event;
+                   ts = buf.timestamp;
+                   std::swap(data, buf.data);
+               });
+    }
+    ev = get_packet_internal(data, ts, timeout_sec);
+    return true;
+}
+
+ClientEvent SensorClient::get_packet(double timeout_sec) {
+    // poll on all our sockets
+    InternalEvent ev;
+    uint64_t ts;
+    if (!next_event(ev, ts, staging_buffer, timeout_sec)) {
+        return ClientEvent(0, -1, ClientEvent::PollTimeout);
+    }
+
+    return make_event(ev, ts, staging_buffer, staging_buffer.size(),
+                      lidar_packet_, imu_packet_);
+}
+
+ClientEvent SensorClient::get_pooled_packet(double timeout_sec) {
+    InternalEvent ev;
+    uint64_t ts;
+    if (!next_event(ev, ts, staging_buffer, timeout_sec)) {
+        return ClientEvent(0, -1, ClientEvent::PollTimeout);
+    }
+    if (ev.event_type != ClientEvent::Packet) {
+        return ClientEvent(0, ev.source, ev.event_type);
+    }
+
+    ClientEvent rev(nullptr, ev.source, ev.event_type);
+    rev.pooled_ = packet_pool_.acquire(ev.packet_type);
+    rev.packet_ = rev.pooled_.get();
+    rev.packet_->host_timestamp = ts;
+    rev.packet_->format = formats_[ev.source];
+    // the staging buffer takes over the pooled packet's old allocation
+    std::swap(rev.packet_->buf, staging_buffer);
+    record_delivery(ev, ts);
+    return rev;
+}
+
+size_t SensorClient::get_packets(std::vector<ClientEvent>& events,
+                                 size_t max_packets, double timeout_sec) {
+    events.clear();
+    if (max_packets == 0) {
+        return 0;
+    }
+    if (batch_lidar_packets_.size() < max_packets) {
+        batch_lidar_packets_.resize(max_packets);
+        batch_imu_packets_.resize(max_packets);
+    }
+    if (batch_buffers_.size() < max_packets) {
+        batch_buffers_.resize(max_packets);
+    }
+
+    auto& timestamps = batch_timestamps_;
+    auto& sizes = batch_sizes_;
+    timestamps.clear();
+    sizes.clear();
+    if (do_buffer_) {
+        batch_events_.clear();
+        // if the buffer if empty, wait for a new event
+        if (!wait_for_buffer(timeout_sec)) {
+            events.push_back(ClientEvent(0, -1, ClientEvent::PollTimeout));
+            return events.size();
+        }
+        // dequeue as many as are available
+        while (batch_events_.size() < max_packets &&
+               buffer_->pop([&](BufferEvent& buf) {
+                   batch_events_.push_back(buf.event);
+                   timestamps.push_back(buf.timestamp);
+                   sizes.push_back(buf.data.size());
+                   std::swap(batch_buffers_[batch_events_.size() - 1],
+                             buf.data);
+               })) {
+        }
+        if (batch_events_.empty()) {
+            // the buffer was flushed while we waited
+            events.push_back(ClientEvent(0, -1, ClientEvent::PollTimeout));
+            return events.size();
+        }
+    } else {
+        get_packets_internal(batch_events_, batch_buffers_, timestamps, sizes,
+                             max_packets, timeout_sec);
+        // non-Packet events carry no timestamp or data
+        timestamps.resize(batch_events_.size(), 0);
+        sizes.resize(batch_events_.size(), 0);
+    }
+
+    for (size_t i = 0; i < batch_events_.size(); i++) {
+        events.push_back(make_event(batch_events_[i], timestamps[i],
+                                    batch_buffers_[i], sizes[i],
+                                    batch_lidar_packets_[i],
+                                    batch_imu_packets_[i]));
+    }
+    return events.size();
+}
+
+uint64_t SensorClient::dropped_packets() { return dropped_packets_; }
+
+ClientStats SensorClient::stats() {
+    ClientStats stats;
+    stats.buffer_dropped_packets = dropped_packets_;
+    stats.lidar_packets = lidar_packets_;
+    stats.imu_packets = imu_packets_;
+    stats.buffer_depth = buffer_size();
+    stats.max_buffer_depth = max_buffer_depth_;
+    stats.delivery_latency = delivery_latency_.summary();
+    stats.buffer_thread_cpu_seconds = thread_cpu_seconds(buffer_thread_);
+    if (capture_) {
+        stats.kernel_dropped_packets = capture_->drops();
+        return stats;
+    }
+    for (auto sock : sockets_) {
+        int64_t drops = impl::socket_get_drops(sock);
+        if (drops < 0) {
+            stats.kernel_dropped_packets = -1;
+            break;
+        }
+        stats.kernel_dropped_packets =
+            std::max<int64_t>(stats.kernel_dropped_packets, 0) + drops;
+    }
+    return stats;
+}
+
+void SensorClient::enable_latency_stats(bool enable) {
+    if (enable) {
+        lidar_packets_ = 0;
+        imu_packets_ = 0;
+        max_buffer_depth_ = 0;
+        delivery_latency_.reset();
+    }
+    latency_stats_ = enable;
 }
 
 ClientEvent::ClientEvent() {}
@@ -0,0 +1,343 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/sensor_discovery.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <jsoncons/json.hpp>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <utility>
+
+#include "ouster/impl/netcompat.h"
+#include "ouster/sensor_http.h"
+
+namespace ouster {
+namespace sensor {
+
+namespace {
+
+using clock = std::chrono::steady_clock;
+
+const std::vector<std::string> service_names = {"_ouster-lidar._tcp.local",
+                                                "_roger._tcp.local"};
+
+constexpr uint16_t dns_type_a = 1;
+constexpr uint16_t dns_type_ptr = 12;
+constexpr uint16_t dns_type_srv = 33;
+constexpr uint16_t dns_class_in = 1;
+// asks responders to answer the querier directly, RFC 6762 5.4
+constexpr uint16_t dns_unicast_response = 0x8000;
+
+void put16(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value & 0xff));
+}
+
+uint16_t get16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] << 8 | p[1]);
+}
+
+std::vector<uint8_t> make_query() {
+    std::vector<uint8_t> query;
+    put16(query, 0);  // id
+    put16(query, 0);  // flags, a standard query
+    put16(query, static_cast<uint16_t>(service_names.size()));
+    put16(query, 0);
+    put16(query, 0);
+    put16(query, 0);
+    for (const auto& name : service_names) {
+        size_t start = 0;
+        while (start < name.size()) {
+            size_t end = name.find('.', start);
+            if (end == std::string::npos) end = name.size();
+            query.push_back(static_cast<uint8_t>(end - start));
+            query.insert(query.end(), name.begin() + start, name.begin() + end);
+            start = end + 1;
+        }
+        query.push_back(0);
+        put16(query, dns_type_ptr);
+        put16(query, dns_class_in | dns_unicast_response);
+    }
+    return query;
+}
+
+// Reads a possibly compressed name at offset, moving offset past it
+bool read_name(const uint8_t* msg, size_t size, size_t& offset,
+               std::string& name) {
+    name.clear();
+    size_t pos = offset;
+    bool jumped = false;
+    for (int hops = 0; hops < 32; hops++) {
+        if (pos >= size) return false;
+        const uint8_t len = msg[pos];
+        if (len == 0) {
+            if (!jumped) offset = pos + 1;
+            return true;
+        }
+        if ((len & 0xc0) == 0xc0) {
+            if (pos + 1 >= size) return false;
+            if (!jumped) offset = pos + 2;
+            jumped = true;
+            pos = static_cast<size_t>(len & 0x3f) << 8 | msg[pos + 1];
+            continue;
+        }
+        if (pos + 1 + len > size) return false;
+        if (!name.empty()) name += '.';
+        name.append(reinterpret_cast<const char*>(msg + pos + 1), len);
+        pos += 1 + len;
+    }
+    return false;
+}
+
+bool iequals(const std::string& a, const std::string& b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return std::tolower(static_cast<unsigned char>(x)) ==
+                      std::tolower(static_cast<unsigned char>(y));
+           });
+}
+
+bool is_service(const std::string& name) {
+    return std::any_of(
+        service_names.begin(), service_names.end(),
+        [&name](const std::string& service) { return iequals(name, service); });
+}
+
+bool is_service_instance(const std::string& name) {
+    return std::any_of(service_names.begin(), service_names.end(),
+                       [&name](const std::string& service) {
+                           return name.size() > service.size() &&
+                                  name[name.size() - service.size() - 1] ==
+                                      '.' &&
+                                  iequals(name.substr(name.size() -
+                                                      service.size()),
+                                          service);
+                       });
+}
+
+// Whether an mDNS response announces an Ouster service, and the host name of
+// the service if it has one
+bool parse_response(const uint8_t* msg, size_t size, std::string& hostname) {
+    if (size < 12 || !(msg[2] & 0x80)) return false;  // not a response
+    const size_t questions = get16(msg + 4);
+    const size_t records = get16(msg + 6) + get16(msg + 8) + get16(msg + 10);
+
+    size_t offset = 12;
+    std::string name;
+    for (size_t i = 0; i < questions; i++) {
+        if (!read_name(msg, size, offset, name) || offset + 4 > size) {
+            return false;
+        }
+        offset += 4;
+    }
+
+    bool ouster = false;
+    std::string a_name;
+    for (size_t i = 0; i < records; i++) {
+        if (!read_name(msg, size, offset, name) || offset + 10 > size) break;
+        const uint16_t type = get16(msg + offset);
+        const size_t length = get16(msg + offset + 8);
+        const size_t rdata = offset + 10;
+        offset = rdata + length;
+        if (offset > size) break;
+
+        if (type == dns_type_ptr && is_service(name)) {
+            ouster = true;
+        } else if (type == dns_type_srv && is_service_instance(name) &&
+                   length > 6) {
+            size_t target = rdata + 6;
+            std::string srv_target;
+            if (read_name(msg, size, target, srv_target)) {
+                hostname = srv_target;
+            }
+            ouster = true;
+        } else if (type == dns_type_a && a_name.empty()) {
+            a_name = name;
+        }
+    }
+    if (ouster && hostname.empty()) hostname = a_name;
+    return ouster;
+}
+
+// Reads the sensor_info of sensors over one multi connection
+std::vector<DiscoveredSensor> probe(std::vector<DiscoveredSensor> sensors,
+                                    const DiscoveryOptions& options) {
+    std::vector<std::string> hostnames;
+    for (const auto& sensor : sensors) {
+        hostnames.push_back(options.http_port == 80
+                                ? sensor.address
+                                : sensor.address + ":" +
+                                      std::to_string(options.http_port));
+    }
+    util::MultiSensorHttp http(hostnames);
+    const auto responses = http.get("api/v1/sensor/metadata/sensor_info",
+                                    options.http_timeout_sec);
+    for (size_t i = 0; i < sensors.size(); i++) {
+        auto& sensor = sensors[i];
+        const auto& response = responses[i];
+        if (!response.ok()) {
+            sensor.error = response.error.empty()
+                               ? "HTTP status " +
+                                     std::to_string(response.status)
+                               : response.error;
+            continue;
+        }
+        sensor.sensor_info = response.body;
+        try {
+            const auto info = jsoncons::json::parse(response.body);
+            auto text = [&info](const char* key) {
+                return info.contains(key) ? info[key].as<std::string>()
+                                          : std::string();
+            };
+            // prod_sn is a string, but a number on some firmwares
+            const auto sn = text("prod_sn");
+            sensor.sn = sn.empty() ? 0 : std::stoull(sn);
+            sensor.prod_line = text("prod_line");
+            sensor.image_rev = text("image_rev");
+            sensor.status = text("status");
+        } catch (const std::exception& e) {
+            sensor.error = std::string("invalid sensor_info: ") + e.what();
+        }
+    }
+    return sensors;
+}
+
+}  // namespace
+
+std::vector<DiscoveredSensor> discover_sensors(
+    const DiscoveryOptions& options, const DiscoveryCallback& on_sensor) {
+    SOCKET sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (!impl::socket_valid(sock)) {
+        throw std::runtime_error("discover_sensors: failed to create socket: " +
+                                 impl::socket_get_error());
+    }
+    struct socket_guard {
+        SOCKET sock;
+        ~socket_guard() { impl::socket_close(sock); }
+    } guard{sock};
+
+    sockaddr_in local;
+    std::memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = 0;
+    if (!options.interface_address.empty()) {
+        in_addr iface;
+        if (inet_pton(AF_INET, options.interface_address.c_str(), &iface) !=
+            1) {
+            throw std::invalid_argument(
+                "discover_sensors: invalid interface address " +
+                options.interface_address);
+        }
+        setsockopt(sock, IPPROTO_IP, IP_MULTICAST_IF,
+                   reinterpret_cast<const char*>(&iface), sizeof(iface));
+    }
+    if (bind(sock, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0 ||
+        impl::socket_set_non_blocking(sock) != 0) {
+        throw std::runtime_error("discover_sensors: failed to bind socket: " +
+                                 impl::socket_get_error());
+    }
+    const unsigned char ttl = 255;
+    setsockopt(sock, IPPROTO_IP, IP_MULTICAST_TTL,
+               reinterpret_cast<const char*>(&ttl), sizeof(ttl));
+
+    sockaddr_in group;
+    std::memset(&group, 0, sizeof(group));
+    group.sin_family = AF_INET;
+    group.sin_port = htons(static_cast<uint16_t>(options.mdns_port));
+    if (inet_pton(AF_INET, options.mdns_address.c_str(), &group.sin_addr) !=
+        1) {
+        throw std::invalid_argument("discover_sensors: invalid mDNS address " +
+                                    options.mdns_address);
+    }
+
+    std::mutex mutex;
+    std::vector<DiscoveredSensor> found;
+    auto probe_batch = [&](std::vector<DiscoveredSensor> batch) {
+        auto probed = probe(std::move(batch), options);
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& sensor : probed) {
+            found.push_back(sensor);
+            if (on_sensor) on_sensor(found.back());
+        }
+    };
+
+    // queries are repeated as either queries or answers may get lost
+    const auto query = make_query();
+    const auto deadline =
+        clock::now() + std::chrono::duration_cast<clock::duration>(
+                           std::chrono::duration<double>(options.timeout_sec));
+    auto next_query = clock::now();
+    std::set<std::string> seen;
+    std::vector<std::future<void>> probes;
+    std::vector<uint8_t> buf(9000);
+    while (clock::now() < deadline) {
+        if (clock::now() >= next_query) {
+            if (sendto(sock, reinterpret_cast<const char*>(query.data()),
+                       static_cast<int>(query.size()), 0,
+                       reinterpret_cast<sockaddr*>(&group),
+                       sizeof(group)) < 0 &&
+                probes.empty() && seen.empty()) {
+                throw std::runtime_error(
+                    "discover_sensors: failed to send query: " +
+                    impl::socket_get_error());
+            }
+            next_query += std::chrono::seconds(1);
+        }
+
+        // answers are gathered in batches of up to 100 ms
+        const auto wait_until =
+            std::min({deadline, next_query,
+                      clock::now() + std::chrono::milliseconds(100)});
+        const auto wait = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::max(wait_until - clock::now(), clock::duration::zero()));
+        fd_set rfds;
+        FD_ZERO(&rfds);
+        FD_SET(sock, &rfds);
+        timeval tv;
+        tv.tv_sec = static_cast<long>(wait.count() / 1000000);
+        tv.tv_usec = static_cast<long>(wait.count() % 1000000);
+        select(static_cast<int>(sock) + 1, &rfds, nullptr, nullptr, &tv);
+
+        std::vector<DiscoveredSensor> batch;
+        while (true) {
+            sockaddr_in from;
+            socklen_t from_len = sizeof(from);
+            const auto n = recvfrom(sock, reinterpret_cast<char*>(buf.data()),
+                                    static_cast<int>(buf.size()), 0,
+                                    reinterpret_cast<sockaddr*>(&from),
+                                    &from_len);
+            if (n <= 0) break;
+            std::string hostname;
+            if (!parse_response(buf.data(), static_cast<size_t>(n),
+                                hostname)) {
+                continue;
+            }
+            char address[INET_ADDRSTRLEN] = {};
+            inet_ntop(AF_INET, &from.sin_addr, address, sizeof(address));
+            if (!seen.insert(address).second) continue;
+            DiscoveredSensor sensor;
+            sensor.address = address;
+            sensor.hostname = hostname;
+            batch.push_back(std::move(sensor));
+        }
+        if (!batch.empty()) {
+            probes.push_back(
+                std::async(std::launch::async, probe_batch, std::move(batch)));
+        }
+    }
+
+    for (auto& p : probes) p.get();
+    return found;
+}
+
+}  // namespace sensor
+}  // namespace ouster
@@ -12,15 +12,23 @@ using namespace ouster::sensor;
 using namespace ouster::sensor::util;
 using namespace ouster::sensor::impl;
 
-std::string SensorHttp::firmware_version_string(const std::string& hostname,
-                                                int timeout_sec) {
-    auto http_client = std::make_unique<CurlClient>(hostname);
-    auto fwjson = http_client->get("api/v1/system/firmware", timeout_sec);
+namespace {
+
+std::string firmware_version_string(const HttpClient& http_client,
+                                    int timeout_sec) {
+    auto fwjson = http_client.get("api/v1/system/firmware", timeout_sec);
 
     // This will exception out on bad parse
     return jsoncons::json::parse(fwjson)["fw"].as<std::string>();
 }
 
+}  // namespace
+
+std::string SensorHttp::firmware_version_string(const std::string& hostname,
+                                                int timeout_sec) {
+    return ::firmware_version_string(CurlClient(hostname), timeout_sec);
+}
+
 version SensorHttp::firmware_version(const std::string& hostname,
                                      int timeout_sec) {
     auto result = firmware_version_string(hostname, timeout_sec);
@@ -29,7 +37,11 @@ version SensorHttp::firmware_version(const std::string& hostname,
 
 std::unique_ptr<SensorHttp> SensorHttp::create(const std::string& hostname,
                                                int timeout_sec) {
-    auto fw = firmware_version(hostname, timeout_sec);
+    // the client probing the firmware is handed over to the sensor interface
+    // so that its connection is reused by the requests that follow
+    auto http_client = std::make_unique<CurlClient>(hostname);
+    auto fw = ouster::util::version_from_string(
+        ::firmware_version_string(*http_client, timeout_sec));
 
     if (fw == invalid_version || fw.major < 2) {
         throw std::runtime_error(
@@ -48,13 +60,15 @@ std::unique_ptr<SensorHttp> SensorHttp::create(const std::string& hostname,
                 return instance;
             }
             case 1: {
-                auto instance = std::make_unique<SensorHttpImp_2_1>(hostname);
+                auto instance = std::make_unique<SensorHttpImp_2_1>(
+                    hostname, std::move(http_client));
                 instance->version_ = fw;
                 instance->hostname_ = hostname;
                 return instance;
             }
             case 2: {
-                auto instance = std::make_unique<SensorHttpImp_2_2>(hostname);
+                auto instance = std::make_unique<SensorHttpImp_2_2>(
+                    hostname, std::move(http_client));
                 instance->version_ = fw;
                 instance->hostname_ = hostname;
                 return instance;
@@ -63,13 +77,15 @@ std::unique_ptr<SensorHttp> SensorHttp::create(const std::string& hostname,
     }
     if ((fw.major == 2 && (fw.minor == 4 || fw.minor == 3)) ||
         (fw.major == 3 && fw.minor == 0)) {
-        auto instance = std::make_unique<SensorHttpImp_2_4_or_3>(hostname);
+        auto instance = std::make_unique<SensorHttpImp_2_4_or_3>(
+            hostname, std::move(http_client));
         instance->version_ = fw;
         instance->hostname_ = hostname;
         return instance;
     }
 
-    auto instance = std::make_unique<SensorHttpImp>(hostname);
+    auto instance =
+        std::make_unique<SensorHttpImp>(hostname, std::move(http_client));
     instance->version_ = fw;
     instance->hostname_ = hostname;
     return instance;
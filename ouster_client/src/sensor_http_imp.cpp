@@ -7,11 +7,15 @@
 #include "ouster/types.h"
 
 using ouster::sensor::util::UserDataAndPolicy;
+using ouster::util::HttpClient;
 
 using namespace ouster::sensor::impl;
 
-SensorHttpImp::SensorHttpImp(const std::string& hostname)
-    : http_client(std::make_unique<CurlClient>(hostname)) {}
+SensorHttpImp::SensorHttpImp(const std::string& hostname,
+                             std::unique_ptr<HttpClient> client)
+    : http_client(std::move(client)) {
+    if (!http_client) http_client = std::make_unique<CurlClient>(hostname);
+}
 
 SensorHttpImp::~SensorHttpImp() = default;
 
@@ -155,16 +159,18 @@ std::vector<uint8_t> SensorHttpImp::diagnostics_dump(int timeout_sec) const {
     return std::vector<uint8_t>(str.begin(), str.end());
 }
 
-SensorHttpImp_2_2::SensorHttpImp_2_2(const std::string& hostname)
-    : SensorHttpImp_2_4_or_3(hostname) {}
+SensorHttpImp_2_2::SensorHttpImp_2_2(const std::string& hostname,
+                                     std::unique_ptr<HttpClient> client)
+    : SensorHttpImp_2_4_or_3(hostname, std::move(client)) {}
 
 void SensorHttpImp_2_2::set_udp_dest_auto(int timeout_sec) const {
     return execute("api/v1/sensor/cmd/set_udp_dest_auto",
                    "\"set_config_param\"", timeout_sec);
 }
 
-SensorHttpImp_2_1::SensorHttpImp_2_1(const std::string& hostname)
-    : SensorHttpImp_2_2(hostname) {}
+SensorHttpImp_2_1::SensorHttpImp_2_1(const std::string& hostname,
+                                     std::unique_ptr<HttpClient> client)
+    : SensorHttpImp_2_2(hostname, std::move(client)) {}
 
 std::string SensorHttpImp_2_1::metadata(int timeout_sec) const {
     jsoncons::json root;
@@ -215,8 +221,9 @@ std::string SensorHttpImp_2_1::calibration_status(int timeout_sec) const {
     return get("api/v1/sensor/cmd/get_calibration_status", timeout_sec);
 }
 
-SensorHttpImp_2_4_or_3::SensorHttpImp_2_4_or_3(const std::string& hostname)
-    : SensorHttpImp(hostname) {}
+SensorHttpImp_2_4_or_3::SensorHttpImp_2_4_or_3(
+    const std::string& hostname, std::unique_ptr<HttpClient> client)
+    : SensorHttpImp(hostname, std::move(client)) {}
 
 std::string SensorHttpImp_2_4_or_3::get_user_data(int /*timeout_sec*/) const {
     throw std::runtime_error("user data API not supported on this FW version");
@@ -9,6 +9,8 @@
 
 #pragma once
 
+#include <memory>
+
 #include "http_client.h"
 #include "ouster/sensor_http.h"
 #include "ouster/types.h"
@@ -26,8 +28,11 @@ class SensorHttpImp : public util::SensorHttp {
      * Constructs an http interface to communicate with the sensor.
      *
      * @param[in] hostname Hostname of the sensor to communicate with.
+     * @param[in] client Client to send the requests with, keeping its open
+     * connection, or null to create one.
      */
-    SensorHttpImp(const std::string& hostname);
+    SensorHttpImp(const std::string& hostname,
+                  std::unique_ptr<ouster::util::HttpClient> client = nullptr);
 
     /**
      * Deconstruct the sensor http interface.
@@ -192,7 +197,9 @@ class SensorHttpImp : public util::SensorHttp {
 
 class SensorHttpImp_2_4_or_3 : public SensorHttpImp {
    public:
-    SensorHttpImp_2_4_or_3(const std::string& hostname);
+    SensorHttpImp_2_4_or_3(
+        const std::string& hostname,
+        std::unique_ptr<ouster::util::HttpClient> client = nullptr);
 
     /**
      * Gets the user data stored on the sensor.
@@ -223,7 +230,9 @@ class SensorHttpImp_2_4_or_3 : public SensorHttpImp {
 // TODO: remove when firmware 2.2 has been fully phased out
 class SensorHttpImp_2_2 : public SensorHttpImp_2_4_or_3 {
    public:
-    SensorHttpImp_2_2(const std::string& hostname);
+    SensorHttpImp_2_2(
+        const std::string& hostname,
+        std::unique_ptr<ouster::util::HttpClient> client = nullptr);
 
     void set_udp_dest_auto(
         int timeout_sec = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS) const override;
@@ -238,8 +247,12 @@ class SensorHttpImp_2_1 : public SensorHttpImp_2_2 {
      * Constructs an http interface to communicate with the sensor.
      *
      * @param[in] hostname hostname of the sensor to communicate with.
+     * @param[in] client Client to send the requests with, or null to create
+     * one.
      */
-    SensorHttpImp_2_1(const std::string& hostname);
+    SensorHttpImp_2_1(
+        const std::string& hostname,
+        std::unique_ptr<ouster::util::HttpClient> client = nullptr);
 
     /**
      * Queries the sensor metadata.
@@ -6,10 +6,10 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstring>
 #include <fstream>
 #include <jsoncons/json.hpp>
 #include <jsoncons/json_type.hpp>
-#include <jsoncons_ext/jsonpath/json_query.hpp>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -356,11 +356,12 @@ ouster::util::version firmware_version_from_metadata(
             "firmware_version_from_metadata metadata empty!");
     }
 
-    jsoncons::json value_array = jsoncons::jsonpath::json_query(
-        jsoncons::json::parse(metadata), "$.sensor_info.image_rev");
-    if (value_array.size() == 1) {
+    const jsoncons::json root = jsoncons::json::parse(metadata);
+    if (root.is_object() && root.contains("sensor_info") &&
+        root["sensor_info"].is_object() &&
+        root["sensor_info"].contains("image_rev")) {
         return ouster::util::version_from_string(
-            value_array[0].as<std::string>());
+            root["sensor_info"]["image_rev"].as<std::string>());
     } else {
         throw std::invalid_argument(
             "firmware_version_from_metadata failed to deduce version info from "
@@ -368,5 +369,186 @@ ouster::util::version firmware_version_from_metadata(
     }
 }
 
+namespace {
+
+// "oSI" and the version of the binary sensor_info layout
+constexpr uint8_t binary_magic[4] = {'o', 'S', 'I', 1};
+
+// Appends plain values in host byte order
+struct binary_writer {
+    std::vector<uint8_t> out;
+
+    template <typename T>
+    void put(T value) {
+        const auto* p = reinterpret_cast<const uint8_t*>(&value);
+        out.insert(out.end(), p, p + sizeof(T));
+    }
+
+    template <typename T>
+    void put_array(const T* values, size_t n) {
+        put<uint32_t>(static_cast<uint32_t>(n));
+        const auto* p = reinterpret_cast<const uint8_t*>(values);
+        out.insert(out.end(), p, p + n * sizeof(T));
+    }
+
+    void put(const std::string& s) { put_array(s.data(), s.size()); }
+
+    void put(const mat4d& m) {
+        const auto* p = reinterpret_cast<const uint8_t*>(m.data());
+        out.insert(out.end(), p, p + sizeof(double) * 16);
+    }
+};
+
+// Reads back what binary_writer appended, checking every read
+struct binary_reader {
+    const uint8_t* data;
+    size_t size;
+
+    const uint8_t* take(size_t n) {
+        if (n > size) {
+            throw std::invalid_argument("truncated binary sensor_info");
+        }
+        const uint8_t* p = data;
+        data += n;
+        size -= n;
+        return p;
+    }
+
+    template <typename T>
+    T get() {
+        T value;
+        std::memcpy(&value, take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    std::vector<T> get_array() {
+        const auto n = get<uint32_t>();
+        if (n > size / sizeof(T)) {
+            throw std::invalid_argument("truncated binary sensor_info");
+        }
+        std::vector<T> values(n);
+        std::memcpy(values.data(), take(n * sizeof(T)), n * sizeof(T));
+        return values;
+    }
+
+    std::string get_string() {
+        const auto n = get<uint32_t>();
+        const auto* p = reinterpret_cast<const char*>(take(n));
+        return std::string(p, n);
+    }
+
+    mat4d get_mat4d() {
+        mat4d m;
+        std::memcpy(m.data(), take(sizeof(double) * 16), sizeof(double) * 16);
+        return m;
+    }
+};
+
+}  // namespace
+
+std::vector<uint8_t> sensor_info_to_binary(const sensor_info& info) {
+    binary_writer w;
+    w.out.assign(binary_magic, binary_magic + sizeof(binary_magic));
+    w.put<uint64_t>(info.sn);
+    w.put(info.fw_rev);
+    w.put(info.prod_line);
+
+    const auto& f = info.format;
+    w.put<uint32_t>(f.pixels_per_column);
+    w.put<uint32_t>(f.columns_per_packet);
+    w.put<uint32_t>(f.columns_per_frame);
+    w.put_array(f.pixel_shift_by_row.data(), f.pixel_shift_by_row.size());
+    w.put<int32_t>(f.column_window.first);
+    w.put<int32_t>(f.column_window.second);
+    w.put<int32_t>(f.udp_profile_lidar);
+    w.put<int32_t>(f.udp_profile_imu);
+    w.put<uint16_t>(f.fps);
+
+    w.put_array(info.beam_azimuth_angles.data(),
+                info.beam_azimuth_angles.size());
+    w.put_array(info.beam_altitude_angles.data(),
+                info.beam_altitude_angles.size());
+    w.put<double>(info.lidar_origin_to_beam_origin_mm);
+    w.put(info.beam_to_lidar_transform);
+    w.put(info.imu_to_sensor_transform);
+    w.put(info.lidar_to_sensor_transform);
+    w.put(info.extrinsic);
+
+    w.put<uint32_t>(info.init_id);
+    w.put(info.build_date);
+    w.put(info.image_rev);
+    w.put(info.prod_pn);
+    w.put(info.status);
+
+    // bit 0: has status, bit 1: status, bit 2: has timestamp
+    const auto& cal = info.cal;
+    w.put<uint8_t>((cal.reflectivity_status ? 1 : 0) |
+                   (cal.reflectivity_status.value_or(false) ? 2 : 0) |
+                   (cal.reflectivity_timestamp ? 4 : 0));
+    w.put(cal.reflectivity_timestamp.value_or(""));
+
+    // the config has too many optional fields to be worth a binary form
+    w.put(to_string(info.config));
+    w.put(info.user_data);
+    return std::move(w.out);
+}
+
+sensor_info sensor_info_from_binary(const uint8_t* data, size_t size) {
+    binary_reader r{data, size};
+    if (size < sizeof(binary_magic) ||
+        std::memcmp(r.take(sizeof(binary_magic)), binary_magic,
+                    sizeof(binary_magic)) != 0) {
+        throw std::invalid_argument(
+            "not a binary sensor_info of a known version");
+    }
+
+    sensor_info info;
+    info.sn = r.get<uint64_t>();
+    info.fw_rev = r.get_string();
+    info.prod_line = r.get_string();
+
+    auto& f = info.format;
+    f.pixels_per_column = r.get<uint32_t>();
+    f.columns_per_packet = r.get<uint32_t>();
+    f.columns_per_frame = r.get<uint32_t>();
+    f.pixel_shift_by_row = r.get_array<int>();
+    f.column_window.first = r.get<int32_t>();
+    f.column_window.second = r.get<int32_t>();
+    f.udp_profile_lidar = static_cast<UDPProfileLidar>(r.get<int32_t>());
+    f.udp_profile_imu = static_cast<UDPProfileIMU>(r.get<int32_t>());
+    f.fps = r.get<uint16_t>();
+
+    info.beam_azimuth_angles = r.get_array<double>();
+    info.beam_altitude_angles = r.get_array<double>();
+    info.lidar_origin_to_beam_origin_mm = r.get<double>();
+    info.beam_to_lidar_transform = r.get_mat4d();
+    info.imu_to_sensor_transform = r.get_mat4d();
+    info.lidar_to_sensor_transform = r.get_mat4d();
+    info.extrinsic = r.get_mat4d();
+
+    info.init_id = r.get<uint32_t>();
+    info.build_date = r.get_string();
+    info.image_rev = r.get_string();
+    info.prod_pn = r.get_string();
+    info.status = r.get_string();
+
+    const auto cal_flags = r.get<uint8_t>();
+    auto timestamp = r.get_string();
+    info.cal = calibration_status{};
+    if (cal_flags & 1) info.cal.reflectivity_status = (cal_flags & 2) != 0;
+    if (cal_flags & 4) info.cal.reflectivity_timestamp = std::move(timestamp);
+
+    const auto config = r.get_string();
+    info.config = sensor_config{};
+    ValidatorIssues issues;
+    if (!parse_and_validate_config(config, info.config, issues)) {
+        throw std::invalid_argument("invalid config in binary sensor_info: " +
+                                    issues.to_string());
+    }
+    info.user_data = r.get_string();
+    return info;
+}
+
 }  // namespace sensor
 }  // namespace ouster
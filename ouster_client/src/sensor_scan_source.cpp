@@ -5,7 +5,21 @@
 
 #include "ouster/sensor_scan_source.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <map>
+#include <string>
+
 #include "ouster/impl/logging.h"
+#include "ouster/impl/spin_wait.h"
+#include "ouster/threads.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 using ouster::sensor::impl::Logger;
 
@@ -29,7 +43,67 @@ SensorScanSource::SensorScanSource(
     const std::vector<Sensor>& sensors, const std::vector<sensor_info>& infos,
     const std::vector<LidarScanFieldTypes>& fields, double config_timeout,
     unsigned int queue_size, bool soft_id_check)
-    : client_(sensors, infos, config_timeout) {
+    : SensorScanSource(sensors, infos, fields, config_timeout, queue_size,
+                       soft_id_check, ReceiveThreadOptions{}) {}
+
+namespace {
+
+// Apply the requested affinity and scheduling policy to the calling thread
+void configure_receive_thread(int cpu, int realtime_priority) {
+#ifdef __linux__
+    if (cpu >= 0) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(cpu, &cpuset);
+        int res =
+            pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+        if (res != 0) {
+            logger().warn("Failed to pin receive thread to CPU {}: {}", cpu,
+                          std::strerror(res));
+        }
+    }
+    if (realtime_priority > 0) {
+        sched_param param;
+        param.sched_priority = realtime_priority;
+        int res = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (res != 0) {
+            logger().warn(
+                "Failed to set realtime priority {} on receive thread: {}",
+                realtime_priority, std::strerror(res));
+        }
+    }
+#else
+    if (cpu >= 0 || realtime_priority > 0) {
+        logger().warn(
+            "Receive thread affinity and priority are only supported on "
+            "Linux");
+    }
+#endif
+}
+
+uint64_t steady_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// time since the host timestamp of the last packet of a scan
+uint64_t since_last_packet(const LidarScan& scan) {
+    const uint64_t last = scan.packet_timestamp().maxCoeff();
+    const uint64_t now =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    return now > last ? now - last : 0;
+}
+
+}  // namespace
+
+SensorScanSource::SensorScanSource(
+    const std::vector<Sensor>& sensors, const std::vector<sensor_info>& infos,
+    const std::vector<LidarScanFieldTypes>& fields, double config_timeout,
+    unsigned int queue_size, bool soft_id_check,
+    const ReceiveThreadOptions& thread_options) {
     id_error_count_ = 0;
     if (queue_size == 0) {
         throw std::invalid_argument("The queue_size cannot be less than 1.");
@@ -45,86 +119,345 @@ SensorScanSource::SensorScanSource(
             "If fields are provided, must provide one for each sensor.");
     }
 
+    busy_poll_ = thread_options.capture.busy_poll_usec > 0;
+
+    if (thread_options.thread_per_sensor && sensors.size() > 1) {
+        // configure the sensors concurrently so startup does not take N
+        // times the reinit time
+        std::vector<std::future<std::unique_ptr<SensorClient>>> futures;
+        for (size_t i = 0; i < sensors.size(); i++) {
+            futures.push_back(std::async(std::launch::async, [&, i]() {
+                std::vector<sensor_info> info;
+                if (infos.size()) info.push_back(infos[i]);
+                return std::make_unique<SensorClient>(
+                    std::vector<Sensor>{sensors[i]}, info, config_timeout, 0,
+                    thread_options.timestamp_mode, thread_options.capture);
+            }));
+        }
+        for (auto& f : futures) {
+            clients_.push_back(f.get());
+        }
+
+        // sockets bound with SO_REUSEPORT to one port would load balance
+        // packets between clients, so every sensor needs its own ports
+        std::map<int, size_t> port_owner;
+        for (size_t i = 0; i < clients_.size(); i++) {
+            const auto& config = clients_[i]->get_sensor_info()[0].config;
+            for (auto port : {config.udp_port_lidar.value_or(0),
+                              config.udp_port_imu.value_or(0)}) {
+                auto it = port_owner.find(port);
+                if (it != port_owner.end() && it->second != i) {
+                    throw std::invalid_argument(
+                        "thread_per_sensor requires each sensor to send to "
+                        "its own UDP ports, but port " +
+                        std::to_string(port) + " is shared by sensors '" +
+                        sensors[it->second].hostname() + "' and '" +
+                        sensors[i].hostname() + "'");
+                }
+                port_owner[port] = i;
+            }
+            sensor_info_.push_back(clients_[i]->get_sensor_info()[0]);
+        }
+    } else {
+        clients_.push_back(std::make_unique<SensorClient>(
+            sensors, infos, config_timeout, 0, thread_options.timestamp_mode,
+            thread_options.capture));
+        sensor_info_ = clients_[0]->get_sensor_info();
+    }
+
+    queue_size_ = queue_size;
+    // deque isn't nothrow movable, so build it at size rather than resize
+    sync_pending_ = std::vector<std::deque<std::unique_ptr<LidarScan>>>(
+        sensor_info_.size());
+    counters_.reset(new SensorCounters[sensor_info_.size()]);
+
     fields_ = fields;
     if (fields_.size() == 0) {
-        for (const auto& meta : client_.get_sensor_info()) {
+        for (const auto& meta : sensor_info_) {
             fields_.push_back(get_field_types(meta.format.udp_profile_lidar));
         }
     }
 
+    if (thread_options.align_clocks) {
+        const FieldType host_ts(HOST_TIMESTAMP_FIELD, ChanFieldType::UINT64,
+                                {}, FieldClass::COLUMN_FIELD);
+        for (auto& types : fields_) {
+            auto it = std::find_if(types.begin(), types.end(),
+                                   [](const FieldType& t) {
+                                       return t.name == HOST_TIMESTAMP_FIELD;
+                                   });
+            if (it == types.end()) types.push_back(host_ts);
+        }
+        clock_models_.assign(sensor_info_.size(),
+                             ClockModel(thread_options.clock_model));
+        clock_estimates_.resize(sensor_info_.size());
+    }
+
+    // keep enough for a full queue plus the scans being batched and read
+    for (size_t i = 0; i < sensor_info_.size(); i++) {
+        scan_pools_.push_back(std::make_unique<ScanPool>(
+            sensor_info_[i], fields_[i], queue_size + 2,
+            thread_options.scan_memory));
+    }
+
+    for (size_t i = 0; i < clients_.size(); i++) {
+        batch_latency_.push_back(std::make_unique<LatencyHistogram>());
+    }
+
     run_thread_ = true;
-    batcher_thread_ = std::thread([this, queue_size, soft_id_check]() {
-        std::vector<std::unique_ptr<LidarScan>> scans;
-        std::vector<ScanBatcher> batchers;
-        auto infos = get_sensor_info();
-        for (size_t i = 0; i < infos.size(); i++) {
-            const auto& info = infos[i];
-            batchers.push_back(ScanBatcher(info));
-            size_t w = info.format.columns_per_frame;
-            size_t h = info.format.pixels_per_column;
-            scans.push_back(std::make_unique<LidarScan>(
-                w, h, fields_[i].begin(), fields_[i].end(),
-                info.format.columns_per_packet));
-        }
-        while (run_thread_) {
-            auto p = client_.get_packet(0.05);
-            if (p.type == ClientEvent::Packet &&
-                p.packet().type() == PacketType::Lidar) {
-                const auto& info = infos[p.source];
-                const auto& lp = static_cast<LidarPacket&>(p.packet());
-                auto result = lp.validate(info);
-                if (result == PacketValidationFailure::ID) {
-                    id_error_count_++;
-                    if (!soft_id_check) {
-                        logger().warn(
-                            "Metadata init_id/sn does not match: expected by "
-                            "metadata - {}/{}, but got from packet buffer - "
-                            "{}/{}",
-                            info.init_id, info.sn, lp.init_id(), lp.prod_sn());
-                        continue;
+    const auto& cpus = thread_options.cpu_affinity;
+    for (size_t i = 0; i < clients_.size(); i++) {
+        int cpu = i < cpus.size() ? cpus[i] : -1;
+        size_t offset = clients_.size() == 1 ? 0 : i;
+        int priority = thread_options.realtime_priority;
+        bool preallocate = thread_options.preallocate_scans;
+        batcher_threads_.push_back(start_thread(
+            "ouster-batch-" + std::to_string(i),
+            [this, i, offset, cpu, priority, preallocate, queue_size,
+             soft_id_check]() {
+                configure_receive_thread(cpu, priority);
+                if (preallocate) {
+                    // after pinning, so the scans are local to the thread
+                    const size_t n = clients_[i]->get_sensor_info().size();
+                    for (size_t s = 0; s < n; s++) {
+                        scan_pools_[offset + s]->reserve(queue_size + 2);
                     }
                 }
+                batch_loop(i, offset, queue_size, soft_id_check);
+            }));
+    }
+}
+
+void SensorScanSource::batch_loop(size_t client_idx, size_t sensor_offset,
+                                  unsigned int queue_size,
+                                  bool soft_id_check) {
+    auto& client = *clients_[client_idx];
+    std::vector<std::unique_ptr<LidarScan>> scans;
+    std::vector<ScanBatcher> batchers;
+    std::vector<int64_t> last_frame_ids;
+    const auto& infos = client.get_sensor_info();
+    for (size_t i = 0; i < infos.size(); i++) {
+        const auto& info = infos[i];
+        batchers.push_back(ScanBatcher(info));
+        last_frame_ids.push_back(-1);
+        scans.push_back(take_scan(sensor_offset + i));
+    }
+    while (run_thread_) {
+        auto p = client.get_packet(0.05);
+        if (p.type == ClientEvent::Packet &&
+            has_packet_callback_.load(std::memory_order_relaxed)) {
+            auto callback = std::atomic_load(&packet_callback_);
+            if (callback) {
+                try {
+                    (*callback)((int)(sensor_offset + p.source), p.packet());
+                } catch (const std::exception& e) {
+                    logger().error("Exception in packet callback: {}",
+                                   e.what());
+                }
+            }
+        }
+        if (p.type == ClientEvent::Packet &&
+            p.packet().type() == PacketType::Lidar) {
+            const auto& info = infos[p.source];
+            const auto& lp = static_cast<LidarPacket&>(p.packet());
+            auto result = lp.validate(info);
+            if (result == PacketValidationFailure::ID) {
+                id_error_count_++;
+                if (!soft_id_check) {
+                    logger().warn(
+                        "Metadata init_id/sn does not match: expected by "
+                        "metadata - {}/{}, but got from packet buffer - "
+                        "{}/{}",
+                        info.init_id, info.sn, lp.init_id(), lp.prod_sn());
+                    continue;
+                }
+            }
 
-                // Add the packet to the batch
-                if (batchers[p.source](lp, *scans[p.source])) {
-                    {
-                        std::unique_lock<std::mutex> lock(buffer_mutex_);
-                        buffer_.push_back(
-                            {p.source, std::move(scans[p.source])});
-                        while (buffer_.size() > queue_size) {
-                            buffer_.pop_front();
-                            dropped_scans_++;
-                        }
-                        buffer_cv_.notify_one();
+            // Add the packet to the batch
+            auto& counters = counters_[sensor_offset + p.source];
+            counters.packets.fetch_add(1, std::memory_order_relaxed);
+            if (batchers[p.source](lp, *scans[p.source])) {
+                counters.scans.fetch_add(1, std::memory_order_relaxed);
+                if (!scans[p.source]->complete(info.format.column_window)) {
+                    counters.incomplete_scans.fetch_add(
+                        1, std::memory_order_relaxed);
+                }
+                // frame ids are 16 bits on the wire, so count gaps modulo
+                // 2^16 and treat large jumps back as a sensor restart
+                int64_t frame_id = scans[p.source]->frame_id;
+                int64_t& last = last_frame_ids[p.source];
+                if (last >= 0) {
+                    int64_t gap = (frame_id - last - 1) & 0xFFFF;
+                    if (gap < 0x8000) {
+                        counters.missing_frames += gap;
                     }
-                    size_t w = info.format.columns_per_frame;
-                    size_t h = info.format.pixels_per_column;
-                    scans[p.source] = std::make_unique<LidarScan>(
-                        w, h, fields_[p.source].begin(),
-                        fields_[p.source].end(),
-                        info.format.columns_per_packet);
                 }
+                last = frame_id;
+                ClockEstimate clock;
+                if (!clock_models_.empty()) {
+                    clock = align_clock(sensor_offset + p.source,
+                                        *scans[p.source]);
+                }
+                const bool timed =
+                    latency_stats_.load(std::memory_order_relaxed);
+                if (timed) {
+                    batch_latency_[client_idx]->record(
+                        since_last_packet(*scans[p.source]));
+                }
+                const int sensor_idx = (int)(sensor_offset + p.source);
+                std::unique_lock<std::mutex> lock(buffer_mutex_);
+                if (clock.valid) clock_estimates_[sensor_idx] = clock;
+                if (!scan_waiters_.empty() || scan_callback_) {
+                    // handed over rather than queued
+                    ScanCallback callback;
+                    Executor executor;
+                    if (!scan_waiters_.empty()) {
+                        callback = std::move(scan_waiters_.front());
+                        scan_waiters_.pop_front();
+                    } else {
+                        callback = scan_callback_;
+                        executor = scan_executor_;
+                    }
+                    record_delivery(*scans[p.source]);
+                    lock.unlock();
+                    deliver(callback, executor, sensor_idx,
+                            std::move(scans[p.source]));
+                    scans[p.source] = take_scan(sensor_idx);
+                    continue;
+                }
+                buffer_.push_back({sensor_idx, std::move(scans[p.source])});
+                queued_at_.push_back(steady_ns());
+                if (timed) {
+                    max_queue_depth_ =
+                        std::max(max_queue_depth_, buffer_.size());
+                }
+                while (buffer_.size() > queue_size) {
+                    release_scan(buffer_.front().first,
+                                 std::move(buffer_.front().second));
+                    buffer_.pop_front();
+                    queued_at_.pop_front();
+                    dropped_scans_++;
+                }
+                buffer_cv_.notify_one();
+                lock.unlock();
+                scans[p.source] = take_scan(sensor_offset + p.source);
             }
         }
-    });
+    }
 }
 
 SensorScanSource::~SensorScanSource() { close(); }
 
+ScanSourceStats SensorScanSource::stats() {
+    ScanSourceStats stats;
+    for (auto& client : clients_) {
+        auto client_stats = client->stats();
+        stats.buffer_dropped_packets += client_stats.buffer_dropped_packets;
+        if (client_stats.kernel_dropped_packets >= 0) {
+            stats.kernel_dropped_packets =
+                std::max<int64_t>(stats.kernel_dropped_packets, 0) +
+                client_stats.kernel_dropped_packets;
+        }
+        stats.clients.push_back(client_stats);
+    }
+    for (const auto& thread : batcher_threads_) {
+        stats.batch_thread_cpu_seconds.push_back(thread_cpu_seconds(thread));
+    }
+    LatencyHistogram batch_latency;
+    for (const auto& h : batch_latency_) {
+        batch_latency.add(*h);
+    }
+    stats.batch_latency = batch_latency.summary();
+    {
+        std::unique_lock<std::mutex> lock(buffer_mutex_);
+        stats.dropped_scans = dropped_scans_;
+        stats.scans = scans_;
+        stats.queue_depth = buffer_.size();
+        stats.max_queue_depth = max_queue_depth_;
+        stats.queue_latency = queue_latency_.summary();
+        stats.scan_latency = scan_latency_.summary();
+        stats.clocks = clock_estimates_;
+    }
+    stats.id_errors = id_error_count_;
+    for (size_t i = 0; i < sensor_info_.size(); i++) {
+        const auto& counters = counters_[i];
+        stats.missing_frames.push_back(counters.missing_frames);
+        stats.batched_packets.push_back(counters.packets);
+        stats.batched_scans.push_back(counters.scans);
+        stats.incomplete_scans.push_back(counters.incomplete_scans);
+    }
+    return stats;
+}
+
+void SensorScanSource::enable_latency_stats(bool enable) {
+    for (auto& client : clients_) {
+        client->enable_latency_stats(enable);
+    }
+    if (enable) {
+        for (auto& h : batch_latency_) {
+            h->reset();
+        }
+        std::unique_lock<std::mutex> lock(buffer_mutex_);
+        queue_latency_.reset();
+        scan_latency_.reset();
+        scans_ = 0;
+        max_queue_depth_ = 0;
+    }
+    latency_stats_ = enable;
+}
+
+std::pair<int, std::unique_ptr<LidarScan>> SensorScanSource::pop_scan() {
+    auto result = std::move(buffer_.front());
+    buffer_.pop_front();
+    const uint64_t queued = queued_at_.front();
+    queued_at_.pop_front();
+    if (latency_stats_.load(std::memory_order_relaxed)) {
+        const uint64_t now = steady_ns();
+        queue_latency_.record(now > queued ? now - queued : 0);
+    }
+    return result;
+}
+
+void SensorScanSource::record_delivery(const LidarScan& scan) {
+    if (!latency_stats_.load(std::memory_order_relaxed)) return;
+    scans_++;
+    scan_latency_.record(since_last_packet(scan));
+}
+
+void SensorScanSource::wait_for_scan(std::unique_lock<std::mutex>& lock,
+                                     double timeout_sec) {
+    if (busy_poll_) {
+        // spin with the lock released so the batcher threads can push
+        lock.unlock();
+        impl::spin_until(
+            [&] {
+                lock.lock();
+                if (!buffer_.empty() || !run_thread_) return true;
+                lock.unlock();
+                return false;
+            },
+            timeout_sec);
+        if (!lock.owns_lock()) lock.lock();
+    } else {
+        auto duration = std::chrono::duration<double>(timeout_sec);
+        buffer_cv_.wait_for(
+            lock, duration,
+            [this] { return !buffer_.empty() || !run_thread_; });
+    }
+}
+
 std::pair<int, std::unique_ptr<LidarScan>> SensorScanSource::get_scan(
     double timeout_sec) {
     std::unique_lock<std::mutex> lock(buffer_mutex_);
     // if theres anything in the queue, just pop it and leave
     if (buffer_.size()) {
-        auto result = std::move(buffer_.front());
-        buffer_.pop_front();
+        auto result = pop_scan();
+        record_delivery(*result.second);
         return result;
     }
 
     // otherwise we have to wait
-    auto duration = std::chrono::duration<double>(timeout_sec);
-    buffer_cv_.wait_for(lock, duration,
-                        [this] { return !buffer_.empty() || !run_thread_; });
+    wait_for_scan(lock, timeout_sec);
     // check for timeout or for spurious wakeup of "wait_for"
     // by checking whether the buffer is empty
     if (buffer_.empty()) {
@@ -132,23 +465,235 @@ std::pair<int, std::unique_ptr<LidarScan>> SensorScanSource::get_scan(
     }
 
     // return the result
-    auto result = std::move(buffer_.front());
-    buffer_.pop_front();
+    auto result = pop_scan();
+    record_delivery(*result.second);
     return result;
 }
 
+bool ScanSet::complete() const {
+    return !scans.empty() &&
+           std::all_of(scans.begin(), scans.end(),
+                       [](const std::unique_ptr<LidarScan>& ls) {
+                           return ls != nullptr;
+                       });
+}
+
+size_t ScanSet::size() const {
+    return std::count_if(
+        scans.begin(), scans.end(),
+        [](const std::unique_ptr<LidarScan>& ls) { return ls != nullptr; });
+}
+
+bool SensorScanSource::assemble_set(ScanSet& set, uint64_t tolerance_ns,
+                                    bool host_timestamps, bool partial) {
+    auto timestamp = [host_timestamps](const LidarScan& ls) {
+        return host_timestamps ? ls.get_first_valid_packet_timestamp()
+                               : ls.get_first_valid_column_timestamp();
+    };
+
+    // Align every queue to the newest of their oldest scans, discarding any
+    // scans too old to match it. That can expose a newer scan in turn, so
+    // repeat until nothing is discarded.
+    while (true) {
+        bool any = false;
+        uint64_t ref = 0;
+        for (const auto& q : sync_pending_) {
+            if (q.empty()) {
+                if (!partial) return false;
+                continue;
+            }
+            ref = std::max(ref, timestamp(*q.front()));
+            any = true;
+        }
+        if (!any) return false;
+
+        bool dropped = false;
+        for (size_t i = 0; i < sync_pending_.size(); i++) {
+            auto& q = sync_pending_[i];
+            while (!q.empty() && timestamp(*q.front()) + tolerance_ns < ref) {
+                release_scan(i, std::move(q.front()));
+                q.pop_front();
+                dropped_scans_++;
+                dropped = true;
+            }
+        }
+        if (!dropped) break;
+    }
+
+    set.scans.clear();
+    set.scans.resize(sync_pending_.size());
+    for (size_t i = 0; i < sync_pending_.size(); i++) {
+        auto& q = sync_pending_[i];
+        if (q.empty()) continue;
+        set.scans[i] = std::move(q.front());
+        q.pop_front();
+    }
+    return true;
+}
+
+ScanSet SensorScanSource::get_synchronized_scans(double timeout_sec,
+                                                 double tolerance_sec,
+                                                 bool host_timestamps) {
+    const uint64_t tolerance_ns =
+        static_cast<uint64_t>(std::max(tolerance_sec, 0.0) * 1e9);
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::duration<double>(timeout_sec));
+
+    ScanSet set;
+    std::unique_lock<std::mutex> lock(buffer_mutex_);
+    while (true) {
+        // sort completed scans into their sensor's queue
+        while (!buffer_.empty()) {
+            auto front = pop_scan();
+            auto& q = sync_pending_[front.first];
+            q.push_back(std::move(front.second));
+            if (q.size() > queue_size_) {
+                release_scan(front.first, std::move(q.front()));
+                q.pop_front();
+                dropped_scans_++;
+            }
+        }
+
+        if (assemble_set(set, tolerance_ns, host_timestamps, false)) {
+            for (const auto& scan : set.scans) {
+                if (scan) record_delivery(*scan);
+            }
+            return set;
+        }
+
+        auto remaining = std::chrono::duration<double>(
+                             deadline - std::chrono::steady_clock::now())
+                             .count();
+        if (remaining <= 0 || !run_thread_) break;
+        wait_for_scan(lock, remaining);
+    }
+
+    if (!assemble_set(set, tolerance_ns, host_timestamps, true)) {
+        set.scans.clear();
+        set.scans.resize(sync_pending_.size());
+    }
+    for (const auto& scan : set.scans) {
+        if (scan) record_delivery(*scan);
+    }
+    return set;
+}
+
+void SensorScanSource::deliver(const ScanCallback& callback,
+                               const Executor& executor, int sensor_idx,
+                               std::unique_ptr<LidarScan> scan) {
+    auto call = [callback, sensor_idx](std::unique_ptr<LidarScan> scan) {
+        try {
+            callback(sensor_idx, std::move(scan));
+        } catch (const std::exception& e) {
+            logger().error("Exception in scan callback: {}", e.what());
+        }
+    };
+    if (executor) {
+        // tasks are copyable, so the scan is held by a shared pointer
+        auto held = std::make_shared<std::unique_ptr<LidarScan>>(
+            std::move(scan));
+        executor([call, held]() { call(std::move(*held)); });
+    } else {
+        call(std::move(scan));
+    }
+}
+
+void SensorScanSource::set_scan_callback(ScanCallback callback,
+                                         Executor executor) {
+    std::lock_guard<std::mutex> lock(buffer_mutex_);
+    scan_callback_ = std::move(callback);
+    scan_executor_ = scan_callback_ ? std::move(executor) : nullptr;
+}
+
+void SensorScanSource::set_packet_callback(SensorPacketCallback callback) {
+    std::shared_ptr<const SensorPacketCallback> held;
+    if (callback) {
+        held = std::make_shared<const SensorPacketCallback>(
+            std::move(callback));
+    }
+    std::atomic_store(&packet_callback_, held);
+    has_packet_callback_ = held != nullptr;
+}
+
+void SensorScanSource::async_next_scan(ScanCallback callback) {
+    std::unique_lock<std::mutex> lock(buffer_mutex_);
+    if (buffer_.empty() && run_thread_) {
+        scan_waiters_.push_back(std::move(callback));
+        return;
+    }
+    std::pair<int, std::unique_ptr<LidarScan>> result{0, nullptr};
+    if (!buffer_.empty()) {
+        result = pop_scan();
+        record_delivery(*result.second);
+    }
+    lock.unlock();
+    deliver(callback, nullptr, result.first, std::move(result.second));
+}
+
+ClockEstimate SensorScanSource::align_clock(size_t sensor_idx,
+                                            LidarScan& scan) {
+    ClockModel& model = clock_models_[sensor_idx];
+    model.add(scan);
+    const auto ts = scan.timestamp();
+    model.to_host(ts.data(), scan.w,
+                  scan.field(HOST_TIMESTAMP_FIELD).get<uint64_t>());
+    return model.estimate();
+}
+
+std::unique_ptr<LidarScan> SensorScanSource::take_scan(size_t sensor_idx) {
+    return scan_pools_[sensor_idx]->acquire();
+}
+
+void SensorScanSource::release_scan(size_t sensor_idx,
+                                    std::unique_ptr<LidarScan> scan) {
+    scan_pools_[sensor_idx]->release(std::move(scan));
+}
+
+void SensorScanSource::recycle(int sensor_idx,
+                               std::unique_ptr<LidarScan> scan) {
+    if (sensor_idx < 0 || sensor_idx >= (int)sensor_info_.size()) {
+        throw std::invalid_argument("Sensor index out of range.");
+    }
+    release_scan(sensor_idx, std::move(scan));
+}
+
+void SensorScanSource::recycle(ScanSet&& set) {
+    for (size_t i = 0; i < set.scans.size() && i < scan_pools_.size(); i++) {
+        release_scan(i, std::move(set.scans[i]));
+    }
+    set.scans.clear();
+}
+
 void SensorScanSource::flush() {
     std::unique_lock<std::mutex> lock(buffer_mutex_);
     buffer_.clear();
+    queued_at_.clear();
+    for (auto& q : sync_pending_) {
+        q.clear();
+    }
 }
 
 void SensorScanSource::close() {
     run_thread_ = false;
     buffer_cv_.notify_all();
-    if (batcher_thread_.joinable()) {
-        batcher_thread_.join();
+    for (auto& thread : batcher_threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    for (auto& client : clients_) {
+        client->close();
+    }
+    // no scan is coming for the callbacks still waiting
+    std::deque<ScanCallback> waiters;
+    {
+        std::lock_guard<std::mutex> lock(buffer_mutex_);
+        std::swap(waiters, scan_waiters_);
+    }
+    for (auto& callback : waiters) {
+        deliver(callback, nullptr, 0, nullptr);
     }
-    client_.close();
 }
 
 }  // namespace sensor
@@ -0,0 +1,679 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/sensor_simulator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <jsoncons/json.hpp>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+#include "ouster/impl/lidar_scan_impl.h"
+#include "ouster/impl/logging.h"
+#include "ouster/impl/netcompat.h"
+#include "ouster/impl/packet_writer.h"
+#include "ouster/metadata.h"
+#include "ouster/threads.h"
+
+using ouster::sensor::logger;
+
+namespace ouster {
+namespace sensor {
+
+namespace {
+
+constexpr double pi = 3.14159265358979323846;
+// sensor time of the first frame, so that no timestamp is zero
+constexpr uint64_t sensor_epoch_ns = 1000000000;
+constexpr uint64_t imu_period_ns = 10000000;
+constexpr uint64_t never = std::numeric_limits<uint64_t>::max();
+
+uint64_t steady_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// converts every value to the type of the field it is assigned to
+struct assign_field {
+    template <typename T>
+    void operator()(Eigen::Ref<img_t<T>> field, const img_t<uint32_t>& values) {
+        field = values.cast<T>();
+    }
+};
+
+bool resolve_ipv4(const std::string& host, int port, sockaddr_in& addr) {
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) == 1) return true;
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    addrinfo* result = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0) {
+        return false;
+    }
+    addr.sin_addr = ((sockaddr_in*)result->ai_addr)->sin_addr;
+    freeaddrinfo(result);
+    return true;
+}
+
+std::string url_decode(const std::string& s) {
+    std::string out;
+    for (size_t i = 0; i < s.size(); i++) {
+        if (s[i] == '%' && i + 2 < s.size()) {
+            out += static_cast<char>(
+                std::stoi(s.substr(i + 1, 2), nullptr, 16));
+            i += 2;
+        } else {
+            out += s[i];
+        }
+    }
+    return out;
+}
+
+// Minimal HTTP/1.1 server answering GET requests with a handler, one thread
+// per keep-alive connection
+class HttpServer {
+   public:
+    using Handler = std::function<std::string(
+        const std::string& path, const std::string& peer, int& status)>;
+
+    HttpServer(const std::string& address, Handler handler)
+        : handler_(std::move(handler)) {
+        sockaddr_in addr;
+        if (!resolve_ipv4(address, 0, addr)) {
+            throw std::invalid_argument("Can't resolve simulated sensor "
+                                        "address " +
+                                        address);
+        }
+        sock_ = socket(AF_INET, SOCK_STREAM, 0);
+        if (!impl::socket_valid(sock_) ||
+            bind(sock_, (sockaddr*)&addr, sizeof(addr)) ||
+            listen(sock_, 16)) {
+            auto error = impl::socket_get_error();
+            impl::socket_close(sock_);
+            throw std::runtime_error("Failed to listen on " + address + ": " +
+                                     error);
+        }
+        socklen_t len = sizeof(addr);
+        getsockname(sock_, (sockaddr*)&addr, &len);
+        port_ = ntohs(addr.sin_port);
+        thread_ = start_thread("ouster-sim-http", [this] { serve(); });
+    }
+
+    ~HttpServer() {
+        stop_ = true;
+        thread_.join();
+        for (auto& t : connections_) t.join();
+        impl::socket_close(sock_);
+    }
+
+    int port() const { return port_; }
+
+   private:
+    // waits up to 100 ms for a socket to be readable, so that stopping
+    // doesn't wait on blocking calls
+    static bool readable(SOCKET sock) {
+        fd_set fds;
+        FD_ZERO(&fds);
+        FD_SET(sock, &fds);
+        timeval tv{0, 100000};
+        return select((int)sock + 1, &fds, nullptr, nullptr, &tv) > 0;
+    }
+
+    void serve() {
+        while (!stop_) {
+            if (!readable(sock_)) continue;
+            SOCKET conn = accept(sock_, nullptr, nullptr);
+            if (!impl::socket_valid(conn)) continue;
+            connections_.emplace_back([this, conn] { respond(conn); });
+        }
+    }
+
+    void respond(SOCKET conn) {
+        sockaddr_in peer_addr;
+        socklen_t len = sizeof(peer_addr);
+        char peer[INET_ADDRSTRLEN] = "";
+        if (!getpeername(conn, (sockaddr*)&peer_addr, &len)) {
+            inet_ntop(AF_INET, &peer_addr.sin_addr, peer, sizeof(peer));
+        }
+        std::string request;
+        char buf[4096];
+        while (!stop_) {
+            if (!readable(conn)) continue;
+            auto n = recv(conn, buf, sizeof(buf), 0);
+            if (n <= 0) break;
+            request.append(buf, n);
+            auto end = request.find("\r\n\r\n");
+            if (end == std::string::npos) continue;
+            // requests have no body, take the path of the request line
+            auto start = request.find(' ') + 1;
+            auto path = request.substr(start, request.find(' ', start) - start);
+            request.erase(0, end + 4);
+            if (!path.empty() && path[0] == '/') path.erase(0, 1);
+
+            int status = 200;
+            std::string body;
+            try {
+                body = handler_(path, peer, status);
+            } catch (const std::exception& e) {
+                status = 400;
+                body = e.what();
+            }
+            const char* reason = status == 200   ? "OK"
+                                 : status == 404 ? "Not Found"
+                                                 : "Bad Request";
+            std::string response = "HTTP/1.1 " + std::to_string(status) +
+                                   " " + reason +
+                                   "\r\nContent-Type: application/json"
+                                   "\r\nContent-Length: " +
+                                   std::to_string(body.size()) + "\r\n\r\n" +
+                                   body;
+            send(conn, response.data(), response.size(), 0);
+        }
+        impl::socket_close(conn);
+    }
+
+    Handler handler_;
+    SOCKET sock_;
+    int port_ = 0;
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+    std::vector<std::thread> connections_;
+};
+
+}  // namespace
+
+void room_scene(LidarScan& scan, const sensor_info& info) {
+    const size_t h = scan.h;
+    const size_t w = scan.w;
+    img_t<uint32_t> range(h, w), signal(h, w), reflectivity(h, w),
+        near_ir(h, w);
+    for (size_t u = 0; u < h; u++) {
+        const double altitude =
+            u < info.beam_altitude_angles.size()
+                ? info.beam_altitude_angles[u] * pi / 180
+                : 0;
+        for (size_t v = 0; v < w; v++) {
+            const double azimuth = 2 * pi * v / w;
+            // a wall 6 to 10 m away and the floor 1.5 m below
+            const double wall = 8 + 2 * std::sin(3 * azimuth);
+            double r = wall / std::cos(altitude);
+            if (altitude < 0) r = std::min(r, -1.5 / std::sin(altitude));
+            const bool stripe = static_cast<int>(azimuth * 36 / pi) % 2 == 0;
+            range(u, v) = static_cast<uint32_t>(r * 1000);
+            reflectivity(u, v) = stripe ? 200 : 40;
+            signal(u, v) = static_cast<uint32_t>(
+                std::min(65535.0, reflectivity(u, v) * 400 / (r * r)));
+            near_ir(u, v) = 100 + 20 * (v % 16);
+        }
+    }
+    const std::pair<const char*, const img_t<uint32_t>*> fields[] = {
+        {ChanField::RANGE, &range},
+        {ChanField::RANGE2, &range},
+        {ChanField::SIGNAL, &signal},
+        {ChanField::SIGNAL2, &signal},
+        {ChanField::REFLECTIVITY, &reflectivity},
+        {ChanField::REFLECTIVITY2, &reflectivity},
+        {ChanField::NEAR_IR, &near_ir}};
+    for (const auto& f : fields) {
+        if (scan.has_field(f.first)) {
+            ouster::impl::visit_field(scan, f.first, assign_field{},
+                                      *f.second);
+        }
+    }
+}
+
+struct SensorSimulator::SimulatedSensor {
+    SimulatedSensor(const sensor_info& info, const std::string& address)
+        : base_info(info),
+          address(address),
+          pw(packet_format(info)),
+          info(info),
+          scan(info) {}
+
+    // the metadata the packets are generated from, as given
+    const sensor_info base_info;
+    const std::string address;
+    const impl::packet_writer pw;
+    SceneGenerator scene = room_scene;
+    bool dynamic = false;
+    uint64_t frame_period_ns = 0;
+
+    // guards the metadata and config served over HTTP
+    std::mutex mutex;
+    sensor_info info;
+    std::string staged_udp_dest;
+    std::atomic<bool> config_changed{true};
+
+    LidarScan scan;
+    std::vector<LidarPacket> packets;
+    bool generated = false;
+    std::vector<uint8_t> imu;
+    // next frame and IMU packet in sensor time, kept across runs
+    uint64_t frame = 0;
+    uint64_t imu_index = 0;
+    // progress of the current run
+    uint64_t run_frames = 0;
+    uint64_t run_imu = 0;
+    size_t next_packet = 0;
+    std::vector<uint8_t> held;
+
+    SOCKET sock = SOCKET_ERROR;
+    sockaddr_in lidar_addr;
+    sockaddr_in imu_addr;
+    std::unique_ptr<HttpServer> http;
+
+    std::atomic<uint64_t> frames_sent{0};
+    std::atomic<uint64_t> lidar_packets{0};
+    std::atomic<uint64_t> imu_packets{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> reordered{0};
+    std::atomic<uint64_t> late{0};
+
+    ~SimulatedSensor() {
+        http.reset();
+        if (impl::socket_valid(sock)) impl::socket_close(sock);
+    }
+
+    // pick up the destination set over HTTP, false if it can't be resolved
+    bool update_destination(const std::string& default_dest) {
+        if (!config_changed.exchange(false)) return true;
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto& config = info.config;
+        const auto dest = config.udp_dest.value_or(default_dest);
+        sockaddr_in lidar, imu;
+        if (!resolve_ipv4(dest, config.udp_port_lidar.value_or(7502), lidar) ||
+            !resolve_ipv4(dest, config.udp_port_imu.value_or(7503), imu)) {
+            logger().warn("Simulated sensor {}: can't resolve udp_dest {}",
+                          base_info.sn, dest);
+            return false;
+        }
+        lidar_addr = lidar;
+        imu_addr = imu;
+        return true;
+    }
+
+    void generate_frame() {
+        const auto& format = base_info.format;
+        const uint64_t frame_ts = sensor_epoch_ns + frame * frame_period_ns;
+        const uint64_t w = format.columns_per_frame;
+        const uint32_t frame_id = frame & 0xFFFF;
+        if (dynamic || !generated) {
+            scan.frame_id = frame_id;
+            const auto& window = format.column_window;
+            for (uint64_t m = 0; m < w; m++) {
+                const bool in_window =
+                    window.first <= window.second
+                        ? (int)m >= window.first && (int)m <= window.second
+                        : (int)m >= window.first || (int)m <= window.second;
+                scan.timestamp()[m] = frame_ts + m * frame_period_ns / w;
+                scan.measurement_id()[m] = static_cast<uint16_t>(m);
+                scan.status()[m] = in_window ? 1 : 0;
+            }
+            // packets without valid columns are then not sent, like the
+            // sensors do outside of their azimuth window
+            scan.packet_timestamp().setZero();
+            scene(scan, base_info);
+            packets.clear();
+            ouster::impl::scan_to_packets(scan, pw,
+                                          std::back_inserter(packets),
+                                          base_info.init_id, base_info.sn);
+            generated = true;
+            return;
+        }
+        // static scene: only the frame id and timestamps change
+        for (auto& packet : packets) {
+            uint8_t* buf = packet.buf.data();
+            pw.set_frame_id(buf, frame_id);
+            for (int c = 0; c < pw.columns_per_packet; c++) {
+                uint8_t* col = pw.nth_col(c, buf);
+                const uint64_t m = pw.col_measurement_id(col);
+                pw.set_col_timestamp(col, frame_ts + m * frame_period_ns / w);
+            }
+            if (pw.udp_profile_lidar != PROFILE_LIDAR_LEGACY) {
+                uint64_t crc = pw.calculate_crc(buf);
+                std::memcpy(buf + packet.buf.size() - sizeof(crc), &crc,
+                            sizeof(crc));
+            }
+        }
+    }
+
+    void send_to(const uint8_t* buf, size_t size, const sockaddr_in& addr) {
+        sendto(sock, (const char*)buf, size, 0, (const sockaddr*)&addr,
+               sizeof(addr));
+    }
+
+    std::string handle(const std::string& path, const std::string& peer,
+                       int& status);
+};
+
+std::string SensorSimulator::SimulatedSensor::handle(const std::string& path,
+                                                     const std::string& peer,
+                                                     int& status) {
+    const std::string cmd = "api/v1/sensor/cmd/";
+    std::lock_guard<std::mutex> lock(mutex);
+    if (path == "api/v1/system/firmware") {
+        // from 3.1 the metadata is fetched in a single request
+        return "{\"fw\": \"ousteros-image-prod-aries-v3.1.0\"}";
+    }
+    if (path == "api/v1/sensor/metadata" ||
+        path == "api/v1/sensor/metadata/sensor_info") {
+        sensor_info current = info;
+        current.status = "RUNNING";
+        auto metadata = current.to_json_string();
+        if (path == "api/v1/sensor/metadata") return metadata;
+        std::string out;
+        jsoncons::json::parse(metadata)["sensor_info"].dump(out);
+        return out;
+    }
+    if (path == cmd + "get_config_param?args=active") {
+        return to_string(info.config);
+    }
+    if (path == cmd + "get_config_param?args=staged") {
+        sensor_config staged = info.config;
+        if (!staged_udp_dest.empty()) staged.udp_dest = staged_udp_dest;
+        return to_string(staged);
+    }
+    const std::string set_param = cmd + "set_config_param?args=";
+    if (path.compare(0, set_param.size(), set_param) == 0) {
+        const auto args = path.substr(set_param.size());
+        const auto key = args.substr(0, args.find('+'));
+        const auto value = url_decode(args.substr(key.size() + 1));
+        auto params = jsoncons::json::parse(to_string(info.config));
+        auto values = jsoncons::json::parse(value);
+        if (key == ".") {
+            for (const auto& it : values.object_range()) {
+                params[it.key()] = it.value();
+            }
+        } else {
+            params[key] = values;
+        }
+        std::string params_str;
+        params.dump(params_str);
+        sensor_config config;
+        if (!parse_and_validate_config(params_str, config)) {
+            throw std::invalid_argument("invalid config");
+        }
+        // the data format stays the one the simulator was given, only the
+        // destination of the packets follows the config
+        info.config = config;
+        staged_udp_dest.clear();
+        config_changed = true;
+        return "\"set_config_param\"";
+    }
+    if (path == cmd + "set_udp_dest_auto") {
+        staged_udp_dest = peer;
+        return "{}";
+    }
+    if (path == cmd + "reinitialize" || path == cmd + "save_config_params") {
+        return "{}";
+    }
+    if (path == "api/v1/user/data") return "\"\"";
+    status = 404;
+    return "";
+}
+
+SensorSimulator::SensorSimulator(const std::vector<sensor_info>& sensors,
+                                 const SimulatorOptions& options)
+    : options_(options) {
+    if (options_.threads < 1) {
+        throw std::invalid_argument("SensorSimulator needs a thread");
+    }
+    for (size_t i = 0; i < sensors.size(); i++) {
+        const auto& info = sensors[i];
+        const auto& format = info.format;
+        if (!format.columns_per_frame || !format.columns_per_packet ||
+            !format.pixels_per_column ||
+            format.columns_per_frame % format.columns_per_packet) {
+            throw std::invalid_argument(
+                "SensorSimulator: invalid data format of sensor " +
+                std::to_string(i));
+        }
+        const std::string address = i < options_.addresses.size()
+                                        ? options_.addresses[i]
+                                        : "127.0.0.1";
+        auto sensor = std::make_unique<SimulatedSensor>(info, address);
+        int fps = format.fps;
+        if (!fps && info.config.lidar_mode) {
+            fps = frequency_of_lidar_mode(info.config.lidar_mode.value());
+        }
+        sensor->frame_period_ns = 1000000000 / (fps ? fps : 10);
+        sensor->imu.resize(sensor->pw.imu_packet_size);
+
+        sockaddr_in source;
+        if (!resolve_ipv4(address, 0, source)) {
+            throw std::invalid_argument(
+                "SensorSimulator: can't resolve address " + address);
+        }
+        sensor->sock = socket(AF_INET, SOCK_DGRAM, 0);
+        if (!impl::socket_valid(sensor->sock) ||
+            bind(sensor->sock, (sockaddr*)&source, sizeof(source))) {
+            throw std::runtime_error(
+                "SensorSimulator: failed to open a UDP socket on " + address +
+                ": " + impl::socket_get_error());
+        }
+        if (!sensor->update_destination(options_.udp_dest)) {
+            throw std::invalid_argument("SensorSimulator: can't resolve the "
+                                        "udp_dest of sensor " +
+                                        std::to_string(i));
+        }
+        if (options_.serve_http) {
+            auto* s = sensor.get();
+            sensor->http = std::make_unique<HttpServer>(
+                address, [s](const std::string& path, const std::string& peer,
+                             int& status) {
+                    return s->handle(path, peer, status);
+                });
+        }
+        sensors_.push_back(std::move(sensor));
+    }
+}
+
+SensorSimulator::~SensorSimulator() { stop(); }
+
+void SensorSimulator::set_scene(size_t sensor, SceneGenerator scene,
+                                bool dynamic) {
+    if (running_) {
+        throw std::logic_error("SensorSimulator: set_scene while running");
+    }
+    auto& s = *sensors_.at(sensor);
+    s.scene = std::move(scene);
+    s.dynamic = dynamic;
+    s.generated = false;
+}
+
+void SensorSimulator::start() {
+    if (running_.exchange(true)) return;
+    for (int t = 0; t < options_.threads; t++) {
+        threads_.push_back(start_thread("ouster-sim-" + std::to_string(t),
+                                        [this, t] { run(t, 0); }));
+    }
+}
+
+void SensorSimulator::send_frames(size_t frames) {
+    if (!frames) return;
+    if (running_.exchange(true)) {
+        throw std::logic_error("SensorSimulator: already running");
+    }
+    run_threads(frames);
+    running_ = false;
+}
+
+void SensorSimulator::run_threads(uint64_t frames) {
+    std::vector<std::thread> threads;
+    for (int t = 1; t < options_.threads; t++) {
+        threads.push_back(start_thread("ouster-sim-" + std::to_string(t),
+                                       [this, t, frames] { run(t, frames); }));
+    }
+    run(0, frames);
+    for (auto& t : threads) t.join();
+}
+
+void SensorSimulator::stop() {
+    running_ = false;
+    for (auto& t : threads_) t.join();
+    threads_.clear();
+}
+
+void SensorSimulator::run(size_t thread, uint64_t frames) {
+    std::vector<SimulatedSensor*> sensors;
+    for (size_t i = thread; i < sensors_.size(); i += options_.threads) {
+        sensors.push_back(sensors_[i].get());
+    }
+    std::mt19937 rng(options_.seed + static_cast<uint32_t>(thread));
+    std::uniform_real_distribution<double> chance(0, 1);
+    const double rate = options_.rate;
+
+    for (auto* s : sensors) {
+        s->run_frames = 0;
+        s->run_imu = 0;
+        s->update_destination(options_.udp_dest);
+        s->generate_frame();
+        s->next_packet = 0;
+    }
+
+    // due times are relative to the start of the run, in steady ns
+    auto lidar_due = [&](const SimulatedSensor& s) -> uint64_t {
+        if (frames && s.run_frames >= frames) return never;
+        if (rate <= 0) return 0;
+        const double packets = std::max<size_t>(s.packets.size(), 1);
+        return static_cast<uint64_t>(
+            (s.run_frames + s.next_packet / packets) * s.frame_period_ns /
+            rate);
+    };
+    auto imu_due = [&](const SimulatedSensor& s) -> uint64_t {
+        if (!options_.imu) return never;
+        if (frames && s.run_imu * imu_period_ns >= frames * s.frame_period_ns) {
+            return never;
+        }
+        if (rate <= 0) return 0;
+        return static_cast<uint64_t>(s.run_imu * imu_period_ns / rate);
+    };
+
+    const uint64_t start = steady_ns();
+    while (running_) {
+        const uint64_t now = steady_ns() - start;
+        uint64_t next = never;
+        for (auto* s : sensors) {
+            // bursts keep one sensor from starving the others when behind
+            int burst = 0;
+            for (; burst < 64; burst++) {
+                const uint64_t lidar = lidar_due(*s);
+                const uint64_t imu = imu_due(*s);
+                const uint64_t due = std::min(lidar, imu);
+                if (due > now) {
+                    next = std::min(next, due);
+                    break;
+                }
+                const uint64_t period_ns =
+                    rate > 0 ? static_cast<uint64_t>(s->frame_period_ns / rate)
+                             : 0;
+                if (rate > 0 && now - due > period_ns) s->late++;
+                if (imu < lidar) {
+                    const uint64_t ts =
+                        sensor_epoch_ns + s->imu_index * imu_period_ns;
+                    uint8_t* buf = s->imu.data();
+                    s->pw.set_imu_sys_ts(buf, ts);
+                    s->pw.set_imu_accel_ts(buf, ts);
+                    s->pw.set_imu_gyro_ts(buf, ts);
+                    // at rest, feeling gravity only
+                    s->pw.set_imu_la(buf, 0, 0, 1);
+                    s->pw.set_imu_av(buf, 0, 0, 0);
+                    s->send_to(buf, s->imu.size(), s->imu_addr);
+                    s->imu_index++;
+                    s->run_imu++;
+                    s->imu_packets++;
+                    continue;
+                }
+                if (s->next_packet < s->packets.size()) {
+                    const auto& buf = s->packets[s->next_packet].buf;
+                    if (options_.packet_loss > 0 &&
+                        chance(rng) < options_.packet_loss) {
+                        s->dropped++;
+                    } else if (s->held.empty() && options_.reorder > 0 &&
+                               chance(rng) < options_.reorder) {
+                        s->held = buf;
+                        s->reordered++;
+                    } else {
+                        s->send_to(buf.data(), buf.size(), s->lidar_addr);
+                        s->lidar_packets++;
+                        if (!s->held.empty()) {
+                            s->send_to(s->held.data(), s->held.size(),
+                                       s->lidar_addr);
+                            s->lidar_packets++;
+                            s->held.clear();
+                        }
+                    }
+                    s->next_packet++;
+                }
+                if (s->next_packet >= s->packets.size()) {
+                    s->frame++;
+                    s->run_frames++;
+                    s->frames_sent++;
+                    s->next_packet = 0;
+                    s->update_destination(options_.udp_dest);
+                    s->generate_frame();
+                }
+            }
+            if (burst == 64) next = now;
+        }
+        if (next == never) break;
+        const uint64_t after = steady_ns() - start;
+        // sleep coarsely, then spin for the last bit
+        if (next > after + 200000) {
+            std::this_thread::sleep_for(
+                std::chrono::nanoseconds(next - after - 100000));
+        } else if (next > after) {
+            std::this_thread::yield();
+        }
+    }
+    for (auto* s : sensors) {
+        if (!s->held.empty()) {
+            s->send_to(s->held.data(), s->held.size(), s->lidar_addr);
+            s->lidar_packets++;
+            s->held.clear();
+        }
+    }
+}
+
+std::string SensorSimulator::hostname(size_t sensor) const {
+    const auto& s = *sensors_.at(sensor);
+    if (!s.http) {
+        throw std::logic_error("SensorSimulator: serve_http is not set");
+    }
+    return s.address + ":" + std::to_string(s.http->port());
+}
+
+sensor_info SensorSimulator::get_sensor_info(size_t sensor) const {
+    auto& s = *sensors_.at(sensor);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return s.info;
+}
+
+SimulatorStats SensorSimulator::stats() const {
+    SimulatorStats stats;
+    for (const auto& s : sensors_) {
+        stats.frames += s->frames_sent;
+        stats.lidar_packets += s->lidar_packets;
+        stats.imu_packets += s->imu_packets;
+        stats.dropped_packets += s->dropped;
+        stats.reordered_packets += s->reordered;
+        stats.late_packets += s->late;
+    }
+    return stats;
+}
+
+}  // namespace sensor
+}  // namespace ouster
@@ -22,28 +22,30 @@ SensorTcpImp::SensorTcpImp(const std::string& hostname)
 
 SensorTcpImp::~SensorTcpImp() { socket_close(socket_handle); }
 
-std::string SensorTcpImp::metadata(int timeout_sec) const {
-    auto res = get_config_params(true, timeout_sec);
+std::string SensorTcpImp::metadata(int /*timeout_sec*/) const {
+    auto res = tcp_cmds({{"get_config_param", "active"},
+                         {"get_sensor_info"},
+                         {"get_beam_intrinsics"},
+                         {"get_imu_intrinsics"},
+                         {"get_lidar_intrinsics"},
+                         {"get_lidar_data_format"},
+                         {"get_calibration_status"}});
     jsoncons::json config_params;
     bool parse_success = false;
     try {
-        config_params = jsoncons::json::parse(res);
+        config_params = jsoncons::json::parse(res[0]);
         parse_success = true;
     } catch (jsoncons::ser_error&) {
     }
 
     jsoncons::json root;
-    root["sensor_info"] = jsoncons::json::parse(sensor_info(timeout_sec));
-    root["beam_intrinsics"] =
-        jsoncons::json::parse(beam_intrinsics(timeout_sec));
-    root["imu_intrinsics"] = jsoncons::json::parse(imu_intrinsics(timeout_sec));
-    root["lidar_intrinsics"] =
-        jsoncons::json::parse(lidar_intrinsics(timeout_sec));
-    root["lidar_data_format"] =
-        jsoncons::json::parse(lidar_data_format(timeout_sec));
-    root["calibration_status"] =
-        jsoncons::json::parse(calibration_status(timeout_sec));
-    root["config_params"] = (parse_success) ? config_params : res;
+    root["sensor_info"] = jsoncons::json::parse(res[1]);
+    root["beam_intrinsics"] = jsoncons::json::parse(res[2]);
+    root["imu_intrinsics"] = jsoncons::json::parse(res[3]);
+    root["lidar_intrinsics"] = jsoncons::json::parse(res[4]);
+    root["lidar_data_format"] = jsoncons::json::parse(res[5]);
+    root["calibration_status"] = jsoncons::json::parse(res[6]);
+    root["config_params"] = (parse_success) ? config_params : res[0];
     std::string result;
     root.dump(result);
     return result;
@@ -215,9 +217,16 @@ SOCKET SensorTcpImp::cfg_socket(const char* addr) {
 
 std::string SensorTcpImp::tcp_cmd(
     const std::vector<std::string>& cmd_tokens) const {
+    return tcp_cmds({cmd_tokens})[0];
+}
+
+std::vector<std::string> SensorTcpImp::tcp_cmds(
+    const std::vector<std::vector<std::string>>& cmds) const {
     std::stringstream ss;
-    for (const auto& token : cmd_tokens) ss << token << " ";
-    ss << "\n";
+    for (const auto& cmd_tokens : cmds) {
+        for (const auto& token : cmd_tokens) ss << token << " ";
+        ss << "\n";
+    }
     std::string cmd = ss.str();
 
     ssize_t len = send(socket_handle, cmd.c_str(), cmd.length(), 0);
@@ -225,21 +234,31 @@ std::string SensorTcpImp::tcp_cmd(
         throw std::runtime_error("tcp_cmd socket::send failed");
     }
 
-    // need to synchronize with server by reading response
-    std::stringstream read_ss;
-    do {
-        len = recv(socket_handle, read_buf.get(), MAX_RESULT_LENGTH, 0);
-        if (len < 0) {
-            throw std::runtime_error("tcp_cmd recv(): " + socket_get_error());
+    // need to synchronize with server by reading a response per command
+    std::vector<std::string> results;
+    while (results.size() < cmds.size()) {
+        auto end = pending.find('\n');
+        if (end == std::string::npos) {
+            len = recv(socket_handle, read_buf.get(), MAX_RESULT_LENGTH, 0);
+            if (len < 0) {
+                throw std::runtime_error("tcp_cmd recv(): " +
+                                         socket_get_error());
+            }
+            if (len == 0) {
+                // the sensor closed the connection, the rest is all there is
+                end = pending.size();
+                pending += '\n';
+            } else {
+                pending.append(read_buf.get(), len);
+                continue;
+            }
         }
-
-        read_buf.get()[len] = '\0';
-        read_ss << read_buf.get();
-    } while (len > 0 && read_buf.get()[len - 1] != '\n');
-
-    auto res = read_ss.str();
-    res.erase(res.find_last_not_of(" \r\n\t") + 1);
-    return res;
+        auto res = pending.substr(0, end);
+        pending.erase(0, end + 1);
+        res.erase(res.find_last_not_of(" \r\n\t") + 1);
+        results.push_back(std::move(res));
+    }
+    return results;
 }
 
 void SensorTcpImp::tcp_cmd_with_validation(
@@ -216,12 +216,19 @@ class SensorTcpImp : public util::SensorHttp {
 
     std::string tcp_cmd(const std::vector<std::string>& cmd_tokens) const;
 
+    // sends all commands at once and then reads their responses, one line
+    // each in order, so that they cost a single round trip
+    std::vector<std::string> tcp_cmds(
+        const std::vector<std::vector<std::string>>& cmds) const;
+
     void tcp_cmd_with_validation(const std::vector<std::string>& cmd_tokens,
                                  const std::string& validation) const;
 
    private:
     SOCKET socket_handle;
     std::unique_ptr<char[]> read_buf;
+    // bytes received past the end of the last response read
+    mutable std::string pending;
 };
 
 }  // namespace impl
@@ -0,0 +1,331 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/shm_packet_channel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ouster {
+
+namespace {
+
+constexpr uint64_t shm_magic = 0x53544b50544f5553;  // "OUSTPKTS"
+constexpr uint32_t shm_version = 1;
+constexpr size_t shm_align = 64;
+
+size_t align_up(size_t n) { return (n + shm_align - 1) & ~(shm_align - 1); }
+
+// Start of the segment. The writer sets magic last, once the rest of the
+// segment is laid out.
+struct shm_header {
+    std::atomic<uint64_t> magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint64_t max_packet_bytes;
+    uint64_t slot_stride;
+    uint64_t metadata_offset;  // u32 count, then u64 size and bytes of each
+    uint64_t metadata_bytes;
+    uint64_t slots_offset;
+    std::atomic<uint64_t> published;  // packets published so far
+};
+
+// Precedes the packet of each slot. seq is 2 * n + 1 while the writer copies
+// packet n into the slot and 2 * n + 2 once packet n is published.
+struct shm_slot {
+    std::atomic<uint64_t> seq;
+    uint64_t host_timestamp;
+    uint32_t size;
+    int32_t source;
+    uint8_t type;
+};
+
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t),
+              "shared memory atomics must not carry a lock");
+
+const size_t slot_header_bytes = align_up(sizeof(shm_slot));
+
+std::string shm_path(const std::string& name) {
+    return !name.empty() && name[0] == '/' ? name : "/" + name;
+}
+
+std::string errno_message() { return std::strerror(errno); }
+
+std::vector<uint8_t> metadata_to_binary(
+    const std::vector<std::string>& metadata) {
+    std::vector<uint8_t> res(sizeof(uint32_t));
+    const uint32_t count = metadata.size();
+    std::memcpy(res.data(), &count, sizeof(count));
+    for (const auto& m : metadata) {
+        const uint64_t size = m.size();
+        const size_t at = res.size();
+        res.resize(at + sizeof(size) + m.size());
+        std::memcpy(res.data() + at, &size, sizeof(size));
+        std::memcpy(res.data() + at + sizeof(size), m.data(), m.size());
+    }
+    return res;
+}
+
+// @return false if buf doesn't hold a valid metadata table
+bool metadata_from_binary(const uint8_t* buf, size_t bytes,
+                          std::vector<std::string>& metadata) {
+    uint32_t count = 0;
+    if (bytes < sizeof(count)) return false;
+    std::memcpy(&count, buf, sizeof(count));
+    size_t at = sizeof(count);
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t size = 0;
+        if (bytes - at < sizeof(size)) return false;
+        std::memcpy(&size, buf + at, sizeof(size));
+        at += sizeof(size);
+        if (bytes - at < size) return false;
+        metadata.emplace_back(reinterpret_cast<const char*>(buf + at), size);
+        at += size;
+    }
+    return true;
+}
+
+}  // namespace
+
+struct ShmPacketWriter::Segment {
+    uint8_t* base{nullptr};
+    size_t size{0};
+
+    ~Segment() {
+#ifndef _WIN32
+        if (base) munmap(base, size);
+#endif
+    }
+
+    shm_header& header() { return *reinterpret_cast<shm_header*>(base); }
+
+    shm_slot& slot(uint64_t n) {
+        return *reinterpret_cast<shm_slot*>(
+            base + header().slots_offset +
+            (n % header().slot_count) * header().slot_stride);
+    }
+
+    uint8_t* data(uint64_t n) {
+        return reinterpret_cast<uint8_t*>(&slot(n)) + slot_header_bytes;
+    }
+};
+
+#ifndef _WIN32
+
+ShmPacketWriter::ShmPacketWriter(const std::string& name, size_t slots,
+                                 size_t max_packet_bytes,
+                                 const std::vector<std::string>& metadata)
+    : segment_(std::make_shared<Segment>()) {
+    if (slots == 0 || max_packet_bytes == 0) {
+        throw std::invalid_argument(
+            "ShmPacketWriter: slot count and packet size must be greater "
+            "than zero");
+    }
+    const auto table = metadata_to_binary(metadata);
+    const auto path = shm_path(name);
+    const size_t metadata_offset = align_up(sizeof(shm_header));
+    const size_t slots_offset = align_up(metadata_offset + table.size());
+    const size_t stride = slot_header_bytes + align_up(max_packet_bytes);
+    const size_t size = slots_offset + slots * stride;
+
+    shm_unlink(path.c_str());
+    int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("ShmPacketWriter: failed to create '" +
+                                 path + "': " + errno_message());
+    }
+    if (ftruncate(fd, size) != 0) {
+        const auto msg = errno_message();
+        close(fd);
+        shm_unlink(path.c_str());
+        throw std::runtime_error("ShmPacketWriter: failed to size '" + path +
+                                 "': " + msg);
+    }
+    void* base =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        shm_unlink(path.c_str());
+        throw std::runtime_error("ShmPacketWriter: failed to map '" + path +
+                                 "': " + errno_message());
+    }
+    segment_->base = static_cast<uint8_t*>(base);
+    segment_->size = size;
+
+    // ftruncate zero fills, so the magic is not set yet
+    auto& hdr = segment_->header();
+    hdr.version = shm_version;
+    hdr.slot_count = slots;
+    hdr.max_packet_bytes = max_packet_bytes;
+    hdr.slot_stride = stride;
+    hdr.metadata_offset = metadata_offset;
+    hdr.metadata_bytes = table.size();
+    hdr.slots_offset = slots_offset;
+    std::memcpy(segment_->base + metadata_offset, table.data(), table.size());
+    hdr.magic.store(shm_magic, std::memory_order_release);
+    name_ = path;
+}
+
+ShmPacketWriter::~ShmPacketWriter() {
+    if (!name_.empty()) shm_unlink(name_.c_str());
+}
+
+ShmPacketReader::ShmPacketReader(const std::string& name)
+    : segment_(std::make_shared<ShmPacketWriter::Segment>()) {
+    const auto path = shm_path(name);
+    int fd = shm_open(path.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        throw std::runtime_error("ShmPacketReader: failed to open '" + path +
+                                 "': " + errno_message());
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        static_cast<size_t>(st.st_size) < sizeof(shm_header)) {
+        close(fd);
+        throw std::runtime_error("ShmPacketReader: '" + path +
+                                 "' is not a packet channel");
+    }
+    const size_t size = st.st_size;
+    void* base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        throw std::runtime_error("ShmPacketReader: failed to map '" + path +
+                                 "': " + errno_message());
+    }
+    segment_->base = static_cast<uint8_t*>(base);
+    segment_->size = size;
+
+    auto& hdr = segment_->header();
+    if (hdr.magic.load(std::memory_order_acquire) != shm_magic ||
+        hdr.version != shm_version || hdr.slot_count == 0 ||
+        hdr.slot_stride < slot_header_bytes + hdr.max_packet_bytes ||
+        hdr.metadata_offset + hdr.metadata_bytes > size ||
+        hdr.slots_offset + hdr.slot_count * hdr.slot_stride > size ||
+        !metadata_from_binary(segment_->base + hdr.metadata_offset,
+                              hdr.metadata_bytes, metadata_)) {
+        throw std::runtime_error("ShmPacketReader: '" + path +
+                                 "' is not a packet channel or not ready");
+    }
+
+    // start at the oldest packet still in the ring
+    const uint64_t published = this->published();
+    next_ = published > hdr.slot_count ? published - hdr.slot_count : 0;
+}
+
+#else
+
+ShmPacketWriter::ShmPacketWriter(const std::string&, size_t, size_t,
+                                 const std::vector<std::string>&) {
+    throw std::runtime_error(
+        "shared memory packet channels are not supported on Windows");
+}
+
+ShmPacketWriter::~ShmPacketWriter() {}
+
+ShmPacketReader::ShmPacketReader(const std::string&) {
+    throw std::runtime_error(
+        "shared memory packet channels are not supported on Windows");
+}
+
+#endif
+
+void ShmPacketWriter::publish(int source, sensor::PacketType type,
+                              uint64_t host_timestamp, const uint8_t* data,
+                              size_t size) {
+    auto& hdr = segment_->header();
+    if (size > hdr.max_packet_bytes) {
+        throw std::invalid_argument(
+            "ShmPacketWriter: packet of " + std::to_string(size) +
+            " bytes is larger than the channel holds");
+    }
+    const uint64_t n = hdr.published.load(std::memory_order_relaxed);
+    shm_slot& slot = segment_->slot(n);
+    slot.seq.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::memcpy(segment_->data(n), data, size);
+    slot.host_timestamp = host_timestamp;
+    slot.size = static_cast<uint32_t>(size);
+    slot.source = source;
+    slot.type = static_cast<uint8_t>(type);
+
+    slot.seq.store(2 * n + 2, std::memory_order_release);
+    hdr.published.store(n + 1, std::memory_order_release);
+}
+
+uint64_t ShmPacketWriter::published() const {
+    return segment_->header().published.load(std::memory_order_acquire);
+}
+
+size_t ShmPacketWriter::max_packet_bytes() const {
+    return segment_->header().max_packet_bytes;
+}
+
+ShmPacketReader::~ShmPacketReader() {}
+
+const ShmPacket* ShmPacketReader::next() {
+    const uint64_t published = this->published();
+    const uint64_t slots = segment_->header().slot_count;
+    if (published > next_ + slots) {
+        // gone around the ring since the last call
+        dropped_ += published - slots - next_;
+        next_ = published - slots;
+    }
+
+    const uint64_t max_bytes = segment_->header().max_packet_bytes;
+    while (next_ < published) {
+        const uint64_t n = next_++;
+        shm_slot& slot = segment_->slot(n);
+        if (slot.seq.load(std::memory_order_acquire) != 2 * n + 2) {
+            // overwritten already
+            dropped_++;
+            continue;
+        }
+        current_.source = slot.source;
+        current_.type = static_cast<sensor::PacketType>(slot.type);
+        current_.host_timestamp = slot.host_timestamp;
+        current_.size = std::min<uint64_t>(slot.size, max_bytes);
+        current_.data = segment_->data(n);
+        current_n_ = n;
+        if (!valid()) {
+            // overwritten while reading the packet info
+            dropped_++;
+            continue;
+        }
+        return &current_;
+    }
+    current_n_ = -1;
+    return nullptr;
+}
+
+bool ShmPacketReader::valid() const {
+    if (current_n_ < 0) return false;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t n = current_n_;
+    return segment_->slot(n).seq.load(std::memory_order_relaxed) == 2 * n + 2;
+}
+
+uint64_t ShmPacketReader::dropped() const { return dropped_; }
+
+uint64_t ShmPacketReader::published() const {
+    return segment_->header().published.load(std::memory_order_acquire);
+}
+
+const std::vector<std::string>& ShmPacketReader::metadata() const {
+    return metadata_;
+}
+
+}  // namespace ouster
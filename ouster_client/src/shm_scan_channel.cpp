@@ -0,0 +1,401 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/shm_scan_channel.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "ouster/scan_serialization.h"
+
+namespace ouster {
+
+namespace {
+
+constexpr uint64_t shm_magic = 0x4e414353544f5553;  // "OUSTSCAN"
+constexpr uint32_t shm_version = 2;
+constexpr size_t shm_align = 64;
+
+size_t align_up(size_t n) { return (n + shm_align - 1) & ~(shm_align - 1); }
+
+// Start of the segment. The writer sets magic last, once the rest of the
+// segment is laid out.
+struct shm_header {
+    std::atomic<uint64_t> magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint64_t w;
+    uint64_t h;
+    uint64_t columns_per_packet;
+    uint64_t scan_bytes;  // bytes of the arena of one scan
+    uint64_t slot_stride;
+    uint64_t fields_offset;
+    uint64_t fields_bytes;
+    uint64_t metadata_offset;
+    uint64_t metadata_bytes;
+    uint64_t info_offset;  // binary sensor_info, loaded in place of metadata
+    uint64_t info_bytes;
+    uint64_t slots_offset;
+    std::atomic<uint64_t> published;  // scans published so far
+};
+
+// Precedes the arena of each slot. seq is 2 * n + 1 while the writer copies
+// scan n into the slot and 2 * n + 2 once scan n is published.
+struct shm_slot {
+    std::atomic<uint64_t> seq;
+    int64_t frame_id;
+    uint64_t frame_status;
+    uint8_t shutdown_countdown;
+    uint8_t shot_limiting_countdown;
+};
+
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t),
+              "shared memory atomics must not carry a lock");
+
+const size_t slot_header_bytes = align_up(sizeof(shm_slot));
+
+std::string shm_path(const std::string& name) {
+    return !name.empty() && name[0] == '/' ? name : "/" + name;
+}
+
+std::string errno_message() { return std::strerror(errno); }
+
+}  // namespace
+
+struct ShmScanWriter::Segment {
+    uint8_t* base{nullptr};
+    size_t size{0};
+
+    ~Segment() {
+#ifndef _WIN32
+        if (base) munmap(base, size);
+#endif
+    }
+
+    shm_header& header() { return *reinterpret_cast<shm_header*>(base); }
+
+    shm_slot& slot(size_t i) {
+        return *reinterpret_cast<shm_slot*>(
+            base + header().slots_offset + i * header().slot_stride);
+    }
+
+    // view of the arena of a slot that keeps the mapping alive
+    static std::shared_ptr<uint8_t> arena(std::shared_ptr<Segment> segment,
+                                          size_t i) {
+        uint8_t* p =
+            reinterpret_cast<uint8_t*>(&segment->slot(i)) + slot_header_bytes;
+        return std::shared_ptr<uint8_t>(std::move(segment), p);
+    }
+};
+
+#ifndef _WIN32
+
+ShmScanWriter::ShmScanWriter(const std::string& name, size_t w, size_t h,
+                             const LidarScanFieldTypes& fields, size_t slots,
+                             size_t columns_per_packet,
+                             const std::string& metadata)
+    : segment_(std::make_shared<Segment>()), field_types_(fields) {
+    if (slots == 0) {
+        throw std::invalid_argument(
+            "ShmScanWriter: slot count must be greater than zero");
+    }
+    const auto table = impl::field_types_to_binary(fields);
+    const auto info =
+        metadata.empty()
+            ? std::vector<uint8_t>{}
+            : sensor::sensor_info_to_binary(sensor::sensor_info(metadata));
+    const auto path = shm_path(name);
+
+    // the segment is sized by the layout of the first slot
+    auto create = [&](size_t scan_bytes) {
+        const size_t fields_offset = align_up(sizeof(shm_header));
+        const size_t metadata_offset = fields_offset + table.size();
+        const size_t info_offset = metadata_offset + metadata.size();
+        const size_t slots_offset = align_up(info_offset + info.size());
+        const size_t stride = slot_header_bytes + align_up(scan_bytes);
+        const size_t size = slots_offset + slots * stride;
+
+        shm_unlink(path.c_str());
+        int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("ShmScanWriter: failed to create '" +
+                                     path + "': " + errno_message());
+        }
+        if (ftruncate(fd, size) != 0) {
+            const auto msg = errno_message();
+            close(fd);
+            shm_unlink(path.c_str());
+            throw std::runtime_error("ShmScanWriter: failed to size '" +
+                                     path + "': " + msg);
+        }
+        void* base =
+            mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED) {
+            shm_unlink(path.c_str());
+            throw std::runtime_error("ShmScanWriter: failed to map '" + path +
+                                     "': " + errno_message());
+        }
+        segment_->base = static_cast<uint8_t*>(base);
+        segment_->size = size;
+
+        // ftruncate zero fills, so the magic is not set yet
+        auto& hdr = segment_->header();
+        hdr.version = shm_version;
+        hdr.slot_count = slots;
+        hdr.w = w;
+        hdr.h = h;
+        hdr.columns_per_packet = columns_per_packet;
+        hdr.scan_bytes = scan_bytes;
+        hdr.slot_stride = stride;
+        hdr.fields_offset = fields_offset;
+        hdr.fields_bytes = table.size();
+        hdr.metadata_offset = metadata_offset;
+        hdr.metadata_bytes = metadata.size();
+        hdr.info_offset = info_offset;
+        hdr.info_bytes = info.size();
+        hdr.slots_offset = slots_offset;
+        std::memcpy(segment_->base + fields_offset, table.data(),
+                    table.size());
+        std::memcpy(segment_->base + metadata_offset, metadata.data(),
+                    metadata.size());
+        std::memcpy(segment_->base + info_offset, info.data(), info.size());
+        return Segment::arena(segment_, 0);
+    };
+
+    slots_.reserve(slots);
+    slots_.push_back(LidarScan::make_contiguous(w, h, fields,
+                                                columns_per_packet, create));
+    for (size_t i = 1; i < slots; i++) {
+        slots_.push_back(LidarScan::make_contiguous(
+            w, h, fields, columns_per_packet,
+            [&](size_t) { return Segment::arena(segment_, i); }));
+    }
+    segment_->header().magic.store(shm_magic, std::memory_order_release);
+    name_ = path;
+}
+
+ShmScanWriter::~ShmScanWriter() {
+    if (!name_.empty()) shm_unlink(name_.c_str());
+}
+
+ShmScanReader::ShmScanReader(const std::string& name)
+    : segment_(std::make_shared<ShmScanWriter::Segment>()) {
+    const auto path = shm_path(name);
+    int fd = shm_open(path.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        throw std::runtime_error("ShmScanReader: failed to open '" + path +
+                                 "': " + errno_message());
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        static_cast<size_t>(st.st_size) < sizeof(shm_header)) {
+        close(fd);
+        throw std::runtime_error("ShmScanReader: '" + path +
+                                 "' is not a scan channel");
+    }
+    const size_t size = st.st_size;
+    void* base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        throw std::runtime_error("ShmScanReader: failed to map '" + path +
+                                 "': " + errno_message());
+    }
+    segment_->base = static_cast<uint8_t*>(base);
+    segment_->size = size;
+
+    auto& hdr = segment_->header();
+    if (hdr.magic.load(std::memory_order_acquire) != shm_magic ||
+        hdr.version != shm_version || hdr.slot_count == 0 ||
+        hdr.fields_offset + hdr.fields_bytes > size ||
+        hdr.metadata_offset + hdr.metadata_bytes > size ||
+        hdr.info_offset + hdr.info_bytes > size ||
+        hdr.slots_offset + hdr.slot_count * hdr.slot_stride > size) {
+        throw std::runtime_error("ShmScanReader: '" + path +
+                                 "' is not a scan channel or not ready");
+    }
+    try {
+        field_types_ = impl::field_types_from_binary(
+            segment_->base + hdr.fields_offset, hdr.fields_bytes);
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error(std::string("ShmScanReader: ") + e.what());
+    }
+    metadata_.assign(
+        reinterpret_cast<const char*>(segment_->base + hdr.metadata_offset),
+        hdr.metadata_bytes);
+    std::shared_ptr<sensor::sensor_info> info;
+    if (hdr.info_bytes > 0) {
+        info = std::make_shared<sensor::sensor_info>(
+            sensor::sensor_info_from_binary(segment_->base + hdr.info_offset,
+                                            hdr.info_bytes));
+    }
+
+    slots_.reserve(hdr.slot_count);
+    for (size_t i = 0; i < hdr.slot_count; i++) {
+        auto view = [&](size_t bytes) {
+            if (bytes != hdr.scan_bytes) {
+                throw std::runtime_error(
+                    "ShmScanReader: unexpected layout of '" + path + "'");
+            }
+            return ShmScanWriter::Segment::arena(segment_, i);
+        };
+        slots_.push_back(LidarScan::layout_arena(
+            hdr.w, hdr.h, field_types_, hdr.columns_per_packet, view, false));
+        slots_.back().sensor_info = info;
+    }
+
+    // start at the oldest scan still in the ring
+    const uint64_t published = hdr.published.load(std::memory_order_acquire);
+    next_ = published > slots_.size() ? published - slots_.size() : 0;
+}
+
+#else
+
+ShmScanWriter::ShmScanWriter(const std::string&, size_t, size_t,
+                             const LidarScanFieldTypes&, size_t, size_t,
+                             const std::string&) {
+    throw std::runtime_error(
+        "shared memory scan channels are not supported on Windows");
+}
+
+ShmScanWriter::~ShmScanWriter() {}
+
+ShmScanReader::ShmScanReader(const std::string&) {
+    throw std::runtime_error(
+        "shared memory scan channels are not supported on Windows");
+}
+
+#endif
+
+ShmScanWriter::ShmScanWriter(const std::string& name,
+                             const sensor::sensor_info& info,
+                             const LidarScanFieldTypes& fields, size_t slots)
+    : ShmScanWriter(name, info.format.columns_per_frame,
+                    info.format.pixels_per_column,
+                    fields.empty() ? get_field_types(info) : fields, slots,
+                    info.format.columns_per_packet, info.to_json_string()) {}
+
+void ShmScanWriter::publish(const LidarScan& ls) {
+    auto& hdr = segment_->header();
+    const uint64_t n = hdr.published.load(std::memory_order_relaxed);
+    LidarScan& dst = slots_[n % slots_.size()];
+
+    if (ls.w != dst.w || ls.h != dst.h ||
+        ls.packet_count() != dst.packet_count()) {
+        throw std::invalid_argument(
+            "ShmScanWriter: scan dimensions don't match the channel");
+    }
+    for (const auto& ft : field_types_) {
+        if (!ls.has_field(ft.name) ||
+            !(ls.field(ft.name).desc() == dst.field(ft.name).desc())) {
+            throw std::invalid_argument("ShmScanWriter: scan field '" +
+                                        ft.name +
+                                        "' doesn't match the channel");
+        }
+    }
+
+    shm_slot& slot = segment_->slot(n % slots_.size());
+    slot.seq.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (const auto& ft : field_types_) {
+        const Field& src = ls.field(ft.name);
+        std::memcpy(dst.field(ft.name).get(), src.get(), src.bytes());
+    }
+    dst.timestamp() = ls.timestamp();
+    dst.measurement_id() = ls.measurement_id();
+    dst.status() = ls.status();
+    dst.packet_timestamp() = ls.packet_timestamp();
+    dst.alert_flags() = ls.alert_flags();
+    std::memcpy(dst.pose().get(), ls.pose().get(), ls.pose().bytes());
+    slot.frame_id = ls.frame_id;
+    slot.frame_status = ls.frame_status;
+    slot.shutdown_countdown = ls.shutdown_countdown;
+    slot.shot_limiting_countdown = ls.shot_limiting_countdown;
+
+    slot.seq.store(2 * n + 2, std::memory_order_release);
+    hdr.published.store(n + 1, std::memory_order_release);
+}
+
+uint64_t ShmScanWriter::published() const {
+    return segment_->header().published.load(std::memory_order_acquire);
+}
+
+const LidarScanFieldTypes& ShmScanWriter::field_types() const {
+    return field_types_;
+}
+
+ShmScanReader::~ShmScanReader() {}
+
+const LidarScan* ShmScanReader::next() {
+    const uint64_t published = this->published();
+    const uint64_t slots = slots_.size();
+    if (published > next_ + slots) {
+        // gone around the ring since the last call
+        dropped_ += published - slots - next_;
+        next_ = published - slots;
+    }
+
+    while (next_ < published) {
+        const uint64_t n = next_++;
+        shm_slot& slot = segment_->slot(n % slots);
+        if (slot.seq.load(std::memory_order_acquire) != 2 * n + 2) {
+            // overwritten already
+            dropped_++;
+            continue;
+        }
+        LidarScan& view = slots_[n % slots];
+        view.frame_id = slot.frame_id;
+        view.frame_status = slot.frame_status;
+        view.shutdown_countdown = slot.shutdown_countdown;
+        view.shot_limiting_countdown = slot.shot_limiting_countdown;
+        current_ = n;
+        if (!valid()) {
+            // overwritten while reading the frame info
+            dropped_++;
+            continue;
+        }
+        return &view;
+    }
+    current_ = -1;
+    return nullptr;
+}
+
+const LidarScan* ShmScanReader::current() const {
+    if (current_ < 0) return nullptr;
+    return &slots_[current_ % slots_.size()];
+}
+
+bool ShmScanReader::valid() const {
+    if (current_ < 0) return false;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t n = current_;
+    return segment_->slot(n % slots_.size())
+               .seq.load(std::memory_order_relaxed) == 2 * n + 2;
+}
+
+uint64_t ShmScanReader::dropped() const { return dropped_; }
+
+uint64_t ShmScanReader::published() const {
+    return segment_->header().published.load(std::memory_order_acquire);
+}
+
+const LidarScanFieldTypes& ShmScanReader::field_types() const {
+    return field_types_;
+}
+
+const std::string& ShmScanReader::metadata() const { return metadata_; }
+
+}  // namespace ouster
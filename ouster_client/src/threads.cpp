@@ -0,0 +1,233 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/threads.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#endif
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "ouster/impl/logging.h"
+
+using ouster::sensor::logger;
+
+namespace ouster {
+
+namespace {
+
+// a running thread started by start_thread, with what's needed to read its
+// CPU time from other threads
+struct Registered {
+    std::string name;
+    uint64_t os_id;
+#if defined(__linux__)
+    clockid_t clock;
+#elif defined(_WIN32)
+    HANDLE handle;
+#endif
+};
+
+std::mutex hook_mutex;
+std::shared_ptr<ThreadStartHook> start_hook;
+
+#ifndef OUSTER_MAX_SDK_THREADS
+#define OUSTER_MAX_SDK_THREADS 0
+#endif
+
+std::atomic<unsigned> max_sdk_threads{OUSTER_MAX_SDK_THREADS};
+
+std::mutex registry_mutex;
+std::list<Registered> registry;
+
+uint64_t current_os_id() {
+#if defined(__linux__)
+    return static_cast<uint64_t>(syscall(SYS_gettid));
+#elif defined(_WIN32)
+    return GetCurrentThreadId();
+#elif defined(__APPLE__)
+    uint64_t id = 0;
+    pthread_threadid_np(nullptr, &id);
+    return id;
+#else
+    return std::hash<std::thread::id>()(std::this_thread::get_id());
+#endif
+}
+
+#ifndef _WIN32
+double clock_seconds(clockid_t clock) {
+    timespec ts;
+    if (clock_gettime(clock, &ts) != 0) return -1;
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+#else
+double handle_seconds(HANDLE handle) {
+    FILETIME creation, exit, kernel, user;
+    if (!GetThreadTimes(handle, &creation, &exit, &kernel, &user)) return -1;
+    auto ticks = [](const FILETIME& t) {
+        return (static_cast<uint64_t>(t.dwHighDateTime) << 32) |
+               t.dwLowDateTime;
+    };
+    // in units of 100 ns
+    return (ticks(kernel) + ticks(user)) * 1e-7;
+}
+#endif
+
+double cpu_seconds(const Registered& thread) {
+#if defined(__linux__)
+    return clock_seconds(thread.clock);
+#elif defined(_WIN32)
+    return handle_seconds(thread.handle);
+#else
+    (void)thread;
+    return -1;
+#endif
+}
+
+// adds the calling thread to the registry until destroyed
+class Registration {
+   public:
+    explicit Registration(const std::string& name) {
+        Registered entry;
+        entry.name = name;
+        entry.os_id = current_os_id();
+#if defined(__linux__)
+        if (pthread_getcpuclockid(pthread_self(), &entry.clock) != 0) {
+            entry.clock = -1;
+        }
+#elif defined(_WIN32)
+        entry.handle =
+            OpenThread(THREAD_QUERY_LIMITED_INFORMATION, FALSE,
+                       GetCurrentThreadId());
+#endif
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        it_ = registry.insert(registry.end(), entry);
+    }
+
+    ~Registration() {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+#ifdef _WIN32
+        if (it_->handle) CloseHandle(it_->handle);
+#endif
+        registry.erase(it_);
+    }
+
+    Registration(const Registration&) = delete;
+    Registration& operator=(const Registration&) = delete;
+
+   private:
+    std::list<Registered>::iterator it_;
+};
+
+}  // namespace
+
+void set_thread_start_hook(ThreadStartHook hook) {
+    auto shared =
+        hook ? std::make_shared<ThreadStartHook>(std::move(hook)) : nullptr;
+    std::lock_guard<std::mutex> lock(hook_mutex);
+    start_hook = std::move(shared);
+}
+
+std::thread start_thread(const std::string& name, std::function<void()> body) {
+    return std::thread([name, body]() {
+        set_current_thread_name(name);
+        Registration registration(name);
+        std::shared_ptr<ThreadStartHook> hook;
+        {
+            std::lock_guard<std::mutex> lock(hook_mutex);
+            hook = start_hook;
+        }
+        if (hook) {
+            try {
+                (*hook)(name);
+            } catch (const std::exception& e) {
+                logger().warn("Thread start hook failed on {}: {}", name,
+                              e.what());
+            }
+        }
+        body();
+    });
+}
+
+void set_current_thread_name(const std::string& name) {
+#if defined(__linux__)
+    // longer names are rejected rather than truncated
+    pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+#elif defined(__APPLE__)
+    pthread_setname_np(name.c_str());
+#elif defined(_WIN32)
+    // SetThreadDescription is only there from Windows 10 1607
+    using SetDescription = HRESULT(WINAPI*)(HANDLE, PCWSTR);
+    auto set_description = reinterpret_cast<SetDescription>(GetProcAddress(
+        GetModuleHandleW(L"kernel32.dll"), "SetThreadDescription"));
+    if (set_description) {
+        std::wstring wide(name.begin(), name.end());
+        set_description(GetCurrentThread(), wide.c_str());
+    }
+#else
+    (void)name;
+#endif
+}
+
+void set_max_sdk_threads(unsigned threads) { max_sdk_threads = threads; }
+
+unsigned sdk_thread_count() {
+    unsigned threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 4;
+    const unsigned bound = max_sdk_threads;
+    if (bound != 0) threads = std::min(threads, bound);
+    return threads;
+}
+
+double thread_cpu_seconds(const std::thread& thread) {
+    if (!thread.joinable()) return -1;
+#if defined(__linux__) || defined(_WIN32)
+    // native_handle() isn't const, though it doesn't modify the thread
+    auto handle = const_cast<std::thread&>(thread).native_handle();
+#endif
+#if defined(__linux__)
+    clockid_t clock;
+    if (pthread_getcpuclockid(handle, &clock) != 0) {
+        return -1;
+    }
+    return clock_seconds(clock);
+#elif defined(_WIN32)
+    return handle_seconds(static_cast<HANDLE>(handle));
+#else
+    return -1;
+#endif
+}
+
+std::vector<ThreadStats> sdk_thread_stats() {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    std::vector<ThreadStats> out;
+    out.reserve(registry.size());
+    for (const auto& thread : registry) {
+        ThreadStats stats;
+        stats.name = thread.name;
+        stats.os_id = thread.os_id;
+        stats.cpu_seconds = cpu_seconds(thread);
+        out.push_back(stats);
+    }
+    return out;
+}
+
+}  // namespace ouster
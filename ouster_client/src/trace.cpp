@@ -0,0 +1,132 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/trace.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+namespace ouster {
+namespace trace {
+
+namespace {
+
+std::atomic<bool> g_enabled{false};
+
+// guards the sinks below
+std::mutex g_mutex;
+std::unique_ptr<std::ofstream> g_file;
+bool g_first_event = true;
+std::shared_ptr<TraceCallback> g_callback;
+
+// small sequential ids read better in trace viewers than native ids
+uint64_t thread_id() {
+    static std::atomic<uint64_t> next{1};
+    thread_local uint64_t id = next++;
+    return id;
+}
+
+// names are literals of the SDK, escape anyway to always write valid json
+void write_string(std::ostream& out, const char* s) {
+    out << '"';
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') out << '\\';
+        out << *s;
+    }
+    out << '"';
+}
+
+// called with g_mutex held
+void close_file() {
+    if (!g_file) return;
+    *g_file << "\n]}\n";
+    g_file.reset();
+}
+
+}  // namespace
+
+bool tracing_compiled() {
+#ifdef OUSTER_TRACING
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool tracing_enabled() { return g_enabled; }
+
+void start_trace_file(const std::string& path) {
+    auto file = std::make_unique<std::ofstream>(path);
+    if (!*file) {
+        throw std::runtime_error("Failed to open trace file " + path);
+    }
+    *file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    std::lock_guard<std::mutex> lock(g_mutex);
+    close_file();
+    g_callback.reset();
+    g_file = std::move(file);
+    g_first_event = true;
+    g_enabled = true;
+}
+
+void start_trace_callback(TraceCallback callback) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    close_file();
+    g_callback = std::make_shared<TraceCallback>(std::move(callback));
+    g_enabled = true;
+}
+
+void stop_trace() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_enabled = false;
+    close_file();
+    g_callback.reset();
+}
+
+namespace impl {
+
+bool enabled() { return g_enabled.load(std::memory_order_relaxed); }
+
+uint64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void record(const char* category, const char* name, uint64_t start_ns,
+            uint64_t end_ns) {
+    TraceEvent event{category, name, start_ns, end_ns - start_ns,
+                     thread_id()};
+    std::shared_ptr<TraceCallback> callback;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        if (g_file) {
+            auto& out = *g_file;
+            out << (g_first_event ? "\n" : ",\n") << "{\"name\":";
+            write_string(out, event.name);
+            out << ",\"cat\":";
+            write_string(out, event.category);
+            // complete events, in microseconds
+            out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread_id
+                << ",\"ts\":" << event.start_ns / 1000 << '.'
+                << event.start_ns % 1000 / 100
+                << ",\"dur\":" << event.duration_ns / 1000 << '.'
+                << event.duration_ns % 1000 / 100 << '}';
+            g_first_event = false;
+            return;
+        }
+        callback = g_callback;
+    }
+    // called without the lock so the callback may stop tracing
+    if (callback && *callback) (*callback)(event);
+}
+
+}  // namespace impl
+}  // namespace trace
+}  // namespace ouster
@@ -0,0 +1,197 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/voxel_grid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace ouster {
+
+namespace {
+
+struct VoxelKey {
+    int64_t x, y, z;
+    bool operator==(const VoxelKey& o) const {
+        return x == o.x && y == o.y && z == o.z;
+    }
+};
+
+uint64_t hash_key(const VoxelKey& k) {
+    uint64_t h = static_cast<uint64_t>(k.x) * 0x9E3779B97F4A7C15ull ^
+                 static_cast<uint64_t>(k.y) * 0xC2B2AE3D27D4EB4Full ^
+                 static_cast<uint64_t>(k.z) * 0x165667B19E3779F9ull;
+    return h ^ (h >> 29);
+}
+
+// voxel coordinates beyond this are left out like non finite points
+constexpr double max_coordinate = 4.0e18;
+
+// Points is any Eigen expression of shape (N, 3)
+template <typename Points>
+VoxelDownsample downsample(const Points& points, double voxel_size,
+                           VoxelPolicy policy, uint64_t seed) {
+    if (!(voxel_size > 0)) {
+        throw std::invalid_argument("voxel_size must be positive");
+    }
+    if (policy != VoxelPolicy::FIRST && policy != VoxelPolicy::CENTROID &&
+        policy != VoxelPolicy::RANDOM) {
+        throw std::invalid_argument("unknown voxel policy");
+    }
+    const Eigen::Index n = points.rows();
+    const double inv_size = 1.0 / voxel_size;
+
+    // the voxel keys and hashes are independent per point
+    std::vector<VoxelKey> keys(n);
+    std::vector<uint64_t> hashes(n);
+    std::vector<char> valid(n);
+#ifdef __OUSTER_UTILIZE_OPENMP__
+#pragma omp parallel for schedule(static)
+#endif
+    for (Eigen::Index i = 0; i < n; ++i) {
+        const double x = std::floor(points(i, 0) * inv_size);
+        const double y = std::floor(points(i, 1) * inv_size);
+        const double z = std::floor(points(i, 2) * inv_size);
+        valid[i] = std::abs(x) < max_coordinate &&
+                   std::abs(y) < max_coordinate &&
+                   std::abs(z) < max_coordinate;
+        if (!valid[i]) continue;
+        keys[i] = {static_cast<int64_t>(x), static_cast<int64_t>(y),
+                   static_cast<int64_t>(z)};
+        hashes[i] = hash_key(keys[i]);
+    }
+
+    // open addressing with linear probing, at most half full
+    size_t capacity = 16;
+    while (capacity < 2 * static_cast<size_t>(n)) capacity *= 2;
+    const size_t mask = capacity - 1;
+    std::vector<int32_t> slots(capacity, -1);
+    std::vector<VoxelKey> voxel_keys;
+
+    VoxelDownsample result;
+    result.voxels.resize(n);
+    std::vector<int32_t> first;
+    for (Eigen::Index i = 0; i < n; ++i) {
+        if (!valid[i]) {
+            result.voxels(i) = -1;
+            continue;
+        }
+        size_t slot = hashes[i] & mask;
+        while (slots[slot] != -1 && !(voxel_keys[slots[slot]] == keys[i])) {
+            slot = (slot + 1) & mask;
+        }
+        if (slots[slot] == -1) {
+            slots[slot] = static_cast<int32_t>(voxel_keys.size());
+            voxel_keys.push_back(keys[i]);
+            first.push_back(static_cast<int32_t>(i));
+        }
+        result.voxels(i) = slots[slot];
+    }
+
+    const size_t m = voxel_keys.size();
+    result.indices = Eigen::Map<Eigen::ArrayXi>(first.data(), m);
+    result.points.resize(m, 3);
+    if (policy == VoxelPolicy::CENTROID) {
+        result.points.setZero();
+        Eigen::ArrayXd counts = Eigen::ArrayXd::Zero(m);
+        for (Eigen::Index i = 0; i < n; ++i) {
+            const int32_t v = result.voxels(i);
+            if (v < 0) continue;
+            for (int j = 0; j < 3; ++j) result.points(v, j) += points(i, j);
+            counts(v) += 1;
+        }
+        result.points.array().colwise() /= counts;
+        return result;
+    }
+    if (policy == VoxelPolicy::RANDOM) {
+        // reservoir sampling of one point per voxel, in input order
+        std::mt19937_64 rng(seed);
+        std::vector<uint32_t> counts(m, 0);
+        for (Eigen::Index i = 0; i < n; ++i) {
+            const int32_t v = result.voxels(i);
+            if (v < 0) continue;
+            if (rng() % ++counts[v] == 0) result.indices(v) = i;
+        }
+    }
+    for (size_t v = 0; v < m; ++v) {
+        for (int j = 0; j < 3; ++j) {
+            result.points(v, j) = points(result.indices(v), j);
+        }
+    }
+    return result;
+}
+
+}  // namespace
+
+VoxelDownsample voxel_downsample(
+    const Eigen::Ref<const pose_util::Points>& points, double voxel_size,
+    VoxelPolicy policy, uint64_t seed) {
+    return downsample(points, voxel_size, policy, seed);
+}
+
+VoxelDownsample voxel_downsample(const LidarScan& scan, const XYZLut& lut,
+                                 double voxel_size, VoxelPolicy policy,
+                                 uint64_t seed) {
+    const Eigen::Index pixels = scan.w * scan.h;
+    LidarScan::Points points(pixels, 3);
+    Eigen::Array<uint32_t, Eigen::Dynamic, 1> pixel_index(pixels);
+    const size_t count = cartesian_compact(points, pixel_index, scan, lut);
+
+    VoxelDownsample result = downsample(points.topRows(count), voxel_size,
+                                        policy, seed);
+    // from compacted points back to pixels
+    for (Eigen::Index v = 0; v < result.indices.size(); ++v) {
+        result.indices(v) = pixel_index(result.indices(v));
+    }
+    Eigen::ArrayXi voxels = Eigen::ArrayXi::Constant(pixels, -1);
+    for (size_t i = 0; i < count; ++i) {
+        voxels(pixel_index(i)) = result.voxels(i);
+    }
+    result.voxels = std::move(voxels);
+    return result;
+}
+
+RangeBand range_percentiles(const Eigen::Ref<const img_t<uint32_t>>& range,
+                            double start_pct, double end_pct) {
+    if (!(start_pct >= 0 && start_pct <= end_pct && end_pct <= 1)) {
+        throw std::invalid_argument(
+            "expected 0 <= start_pct <= end_pct <= 1");
+    }
+    std::vector<uint32_t> values;
+    values.reserve(range.size());
+    for (Eigen::Index i = 0; i < range.size(); ++i) {
+        if (range.data()[i] != 0) values.push_back(range.data()[i]);
+    }
+    RangeBand band;
+    if (values.empty()) return band;
+
+    // linear interpolation between the closest ranges, as numpy.percentile
+    auto percentile = [&values](double pct) {
+        const double pos = pct * (values.size() - 1);
+        const size_t lo = static_cast<size_t>(std::floor(pos));
+        std::nth_element(values.begin(), values.begin() + lo, values.end());
+        const double a = values[lo];
+        if (lo + 1 >= values.size()) return a;
+        const double b =
+            *std::min_element(values.begin() + lo + 1, values.end());
+        const double t = pos - lo;
+        return t >= 0.5 ? b - (b - a) * (1 - t) : a + (b - a) * t;
+    };
+    const double start = percentile(start_pct);
+    const double end = percentile(end_pct);
+    for (uint32_t r : values) {
+        if (r >= start && r <= end) {
+            band.sum += r;
+            ++band.count;
+        }
+    }
+    return band;
+}
+
+}  // namespace ouster
@@ -4,13 +4,21 @@
  */
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
 #include <future>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <vector>
 
-#include "ouster/impl/threadsafe_queue.h"
+#include "ouster/concurrent_queue.h"
+#include "ouster/latency_histogram.h"
+#include "ouster/metrics.h"
+#include "ouster/osf/meta_streaming_info.h"
 #include "ouster/osf/osf_encoder.h"
 #include "ouster/osf/writer.h"
 
@@ -18,12 +26,74 @@ namespace ouster {
 namespace osf {
 
 /**
- * %OSF AsyncWriter wraps osf::Writer so that saving occurs in a background
- * thread. Calls to save() return a std::future<void> instead of void to enable
- * propagating exceptions from the save thread.
+ * Throughput and latency of an AsyncWriter, see AsyncWriter::stats().
+ * Latencies are in nanoseconds.
+ */
+struct OUSTER_API_CLASS AsyncWriterStats {
+    uint64_t written = 0;      ///< scans written with latency stats enabled
+    size_t dropped = 0;        ///< scans dropped, see AsyncWriter::dropped()
+    size_t spilled = 0;  ///< scans spilled, see AsyncWriter::spilled()
+    size_t spill_backlog = 0;  ///< scans in the spill file when the stats
+                               ///< were taken
+    size_t in_flight_bytes = 0;  ///< bytes of the copies of the scans in
+                                 ///< flight when the stats were taken
+    size_t in_flight = 0;      ///< scans in flight when the stats were taken
+    size_t max_in_flight = 0;  ///< most scans in flight at once with latency
+                               ///< stats enabled
+    ouster::sensor::LatencyStats
+        encode_latency;  ///< from save() until the scan was encoded
+    ouster::sensor::LatencyStats
+        write_latency;  ///< from encoding until written, waiting for the
+                        ///< scans saved before it and then writing it
+    ouster::sensor::LatencyStats
+        save_latency;  ///< from save() until the scan was written
+    double save_thread_cpu_seconds = -1;  ///< CPU time of the save thread,
+                                          ///< -1 where not supported
+};
+
+/**
+ * Add the health metrics of an AsyncWriter to an OpenMetrics exposition:
+ * dropped scans, the encode backlog and, when latency stats are enabled,
+ * the scans written and the latency of each stage.
+ *
+ * @param[in,out] metrics exposition to add to
+ * @param[in] stats stats of the writer
+ * @param[in] labels labels of every sample, e.g. to tell writers apart
+ */
+OUSTER_API_FUNCTION
+void add_metrics(ouster::sensor::OpenMetrics& metrics,
+                 const AsyncWriterStats& stats,
+                 const ouster::sensor::MetricLabels& labels = {});
+
+/**
+ * %OSF AsyncWriter wraps osf::Writer so that saving occurs in the background.
+ * Calls to save() return a std::future<void> instead of void to enable
+ * propagating exceptions from the background.
+ *
+ * Saved scans go through a pipeline: several scans are encoded concurrently
+ * on the thread pool of the Encoder, then a single save thread writes them
+ * in the order save() was called, which keeps the messages of each stream
+ * in timestamp order when scans are saved in order. The number of scans
+ * copied but not yet written is bounded by max_in_flight, and optionally by
+ * the memory of their copies, and the OverflowPolicy decides what save()
+ * does when that many are in flight. OverflowPolicy::SPILL rides out bursts
+ * without blocking or dropping, by writing the raw scans to a scratch file
+ * to encode them once the burst is over.
+ * Written scans keep their copy as a buffer for the next scans saved, so
+ * saving scans of the same fields doesn't allocate a copy each time.
  */
 class OUSTER_API_CLASS AsyncWriter {
    public:
+    /**
+     * What save() does when max_in_flight scans are already in flight.
+     */
+    enum class OverflowPolicy {
+        BLOCK,  ///< wait for the oldest scan to be written
+        DROP,   ///< drop the scan; its future holds a std::overflow_error
+        SPILL   ///< write the scan to the spill file, to be encoded once the
+                ///< scans in flight are written, see set_spill_file()
+    };
+
     /**
      * @param[in] filename The filename to output to.
      * @param[in] info The sensor info vector to use for a multi stream OSF
@@ -36,6 +106,12 @@ class OUSTER_API_CLASS AsyncWriter {
      *                       parameter is optional.
      * @param[in] encoder An optional Encoder instance for configuring how the
      *                            Writer should encode the OSF.
+     * @param[in] max_in_flight The maximum number of scans being encoded or
+     *                          waiting to be written, at least 1.
+     * @param[in] overflow What save() does when max_in_flight scans are in
+     *                     flight.
+     *
+     * @throws std::invalid_argument if max_in_flight is 0.
      */
     OUSTER_API_FUNCTION
     AsyncWriter(const std::string& filename,
@@ -43,7 +119,18 @@ class OUSTER_API_CLASS AsyncWriter {
                 const std::vector<std::string>& fields_to_write =
                     std::vector<std::string>(),
                 uint32_t chunk_size = 0,
-                std::shared_ptr<Encoder> encoder = nullptr);
+                std::shared_ptr<Encoder> encoder = nullptr,
+                size_t max_in_flight = 10,
+                OverflowPolicy overflow = OverflowPolicy::BLOCK);
+
+    /**
+     * Closes the file if close() wasn't called.
+     */
+    OUSTER_API_FUNCTION
+    ~AsyncWriter();
+
+    AsyncWriter(const AsyncWriter&) = delete;
+    AsyncWriter& operator=(const AsyncWriter&) = delete;
 
     /**
      * Save a single scan to the specified stream_index in an OSF
@@ -144,51 +231,288 @@ class OUSTER_API_CLASS AsyncWriter {
     OUSTER_API_FUNCTION
     void close();
 
-   private:
     /**
-     * Encapsulates everything that's needed to encode and save the provided
-     * lidar scan into the OSF.
+     * Get the number of scans dropped because max_in_flight scans were in
+     * flight, with OverflowPolicy::DROP.
+     *
+     * @return the number of dropped scans.
+     */
+    OUSTER_API_FUNCTION
+    size_t dropped() const;
+
+    /**
+     * Get the number of scans written to the spill file because the scans in
+     * flight were at max_in_flight or the memory limit, with
+     * OverflowPolicy::SPILL.
+     *
+     * @return the number of spilled scans.
+     */
+    OUSTER_API_FUNCTION
+    size_t spilled() const;
+
+    /**
+     * Limit the memory of the scans in flight, in bytes of their copies.
+     * save() acts on the OverflowPolicy when a scan would take the scans in
+     * flight past the limit, as when max_in_flight scans are in flight; a
+     * single scan is always let through.
+     *
+     * @param[in] bytes the limit, 0 for none, the default.
+     */
+    OUSTER_API_FUNCTION
+    void set_memory_limit(size_t bytes);
+
+    /**
+     * Set the scratch file that OverflowPolicy::SPILL writes scans to, in
+     * the binary layout of serialize_scan(), e.g. on a fast local disk.
+     * Spilled scans are read back, encoded and written in the order they
+     * were saved, after the scans in flight. The file is removed by close().
+     *
+     * @throws std::logic_error if scans were already spilled.
+     *
+     * @param[in] path the spill file, the output file with a ".spill"
+     *                 suffix by default.
+     */
+    OUSTER_API_FUNCTION
+    void set_spill_file(const std::string& path);
+
+    /**
+     * Start or stop counting scans and recording their latency through the
+     * pipeline for stats(). Starting clears what was recorded before.
+     *
+     * @param[in] enable whether to record.
+     */
+    OUSTER_API_FUNCTION
+    void enable_latency_stats(bool enable = true);
+
+    /**
+     * Get the throughput and latency of the writer.
+     *
+     * @return the current stats.
+     */
+    OUSTER_API_FUNCTION
+    AsyncWriterStats stats() const;
+
+    /**
+     * Set how chunks are written to the file, see Writer::set_chunk_io().
+     *
+     * @throws std::logic_error if a chunk was already written.
+     * @throws std::invalid_argument if direct I/O is requested on a platform
+     *                               other than Linux.
+     *
+     * @param[in] options the chunk I/O options.
+     */
+    OUSTER_API_FUNCTION
+    void set_chunk_io(const ChunkIoOptions& options);
+
+    /**
+     * Set the number of chunks between checkpoints of the metadata, see
+     * Writer::set_checkpoint_interval().
+     *
+     * @param[in] chunks the number of chunks, 0 to not write checkpoints.
+     */
+    OUSTER_API_FUNCTION
+    void set_checkpoint_interval(uint32_t chunks);
+
+    /**
+     * Set the chunk policy of the streams without one of their own, see
+     * Writer::set_chunk_policy().
+     *
+     * @param[in] policy the chunk policy.
+     */
+    OUSTER_API_FUNCTION
+    void set_chunk_policy(const ChunkPolicy& policy);
+
+    /**
+     * Set the chunk policy of the scans of a sensor, see
+     * Writer::set_sensor_chunk_policy().
+     *
+     * @throws std::logic_error if the stream_index is out of bounds.
+     *
+     * @param[in] stream_index the index of the sensor_info of the sensor.
+     * @param[in] policy the chunk policy.
+     */
+    OUSTER_API_FUNCTION
+    void set_sensor_chunk_policy(uint32_t stream_index,
+                                 const ChunkPolicy& policy);
+
+    /**
+     * Give the streams created from now on ids from next_id up, see
+     * Writer::set_next_metadata_id().
+     *
+     * @throws std::invalid_argument if next_id isn't above the ids in use.
+     *
+     * @param[in] next_id the id of the next stream.
+     */
+    OUSTER_API_FUNCTION
+    void set_next_metadata_id(uint32_t next_id);
+
+    /**
+     * Summarize the scans of every chunk, see Writer::set_chunk_summaries().
+     * The scans are summarized on the encoding threads.
+     *
+     * @param[in] enable whether to summarize the chunks.
+     */
+    OUSTER_API_FUNCTION
+    void set_chunk_summaries(bool enable = true);
+
+    /**
+     * Leave out the scans of every sensor nearly identical to the last one
+     * saved, see Writer::set_scan_gate(). Scans are gated in save(), before
+     * they are copied or encoded, and their futures are ready at once.
      *
+     * @param[in] options when the gates keep scans.
+     */
+    OUSTER_API_FUNCTION
+    void set_scan_gate(const ScanGateOptions& options);
+
+   private:
+    /**
+     * A scan on its way through the pipeline, from save() to the file.
      */
-    struct OUSTER_API_IGNORE LidarScanMessage {
-        int stream_index_;
-        ouster::osf::ts_t timestamp_;
+    struct OUSTER_API_IGNORE InFlight {
+        LidarScanStream* stream_;
+        ouster::osf::ts_t receive_ts_;
+        ouster::osf::ts_t sensor_ts_;
+        // Note - the scan is deliberately copied because it could be modified
+        // in a different thread; the copy is kept to copy the next scan into.
         ouster::LidarScan lidar_scan_;
+        std::vector<uint8_t> msg_;
+        ChunkSummary summary_;
+        std::exception_ptr error_;
         std::promise<void> promise_;
-
-        // Note - this constructor deliberately copies the LidarScan because it
-        // could be modified in a different thread.
-        OUSTER_API_IGNORE
-        LidarScanMessage(int stream_index, const ouster::osf::ts_t& timestamp,
-                         const ouster::LidarScan& lidar_scan,
-                         std::promise<void>& promise)
-            : stream_index_(stream_index),
-              timestamp_(timestamp),
-              lidar_scan_(lidar_scan),
-              promise_(std::move(promise)) {}
-        LidarScanMessage(const LidarScanMessage&) = delete;
-        OUSTER_API_IGNORE
-        LidarScanMessage(LidarScanMessage&&) = default;
+        bool delta_frame_{false};
+        bool summarize_{false};
+        bool encoded_{false};
+        // size of the copy of the scan, counted in 'in_flight_bytes_'
+        size_t bytes_{0};
+        // steady clock times in ns, with latency stats enabled
+        uint64_t saved_at_{0};
+        uint64_t encoded_at_{0};
     };
 
     Writer writer_;
     /**
-     * Internal job queue, used to keep the save function from blocking the
-     * calling thread for the duration of encoding.
+     * Pool encoding the scans, held so it outlives the tasks queued on it.
      */
-    ThreadsafeQueue<LidarScanMessage> save_queue_;
+    std::shared_ptr<ThreadPool> thread_pool_;
+    const size_t max_in_flight_;
+    const OverflowPolicy overflow_;
+
+    /**
+     * Scans in the order save() was called, encoded out of order on the
+     * thread pool and written from the front by 'save_thread_'.
+     */
+    std::deque<std::shared_ptr<InFlight>> in_flight_;
+    /**
+     * Written scans, reused by save() with their buffers, at most
+     * 'max_in_flight_'. Handed over without taking 'in_flight_mutex_'.
+     */
+    ouster::MpmcQueue<std::shared_ptr<InFlight>> free_items_;
+    mutable std::mutex in_flight_mutex_;
+    std::condition_variable in_flight_changed_;
+    bool shutdown_{false};
+    size_t dropped_{0};
     std::thread save_thread_;
+
+    /**
+     * Memory limit of the scans in flight and the bytes they take, guarded
+     * by 'in_flight_mutex_'.
+     */
+    size_t memory_limit_{0};
+    size_t in_flight_bytes_{0};
+
+    /**
+     * A scan in the spill file, waiting for room in flight.
+     */
+    struct OUSTER_API_IGNORE Spilled {
+        std::shared_ptr<InFlight> item;
+        uint64_t offset;
+        size_t size;
+        size_t bytes;
+    };
+
+    /**
+     * Spilled scans in the order save() was called, guarded by
+     * 'in_flight_mutex_' and moved in flight by 'spill_thread_' before any
+     * scan saved after them.
+     */
+    std::deque<Spilled> spilled_;
+    size_t spilled_count_{0};
+    std::thread spill_thread_;
+
+    /**
+     * The spill file, guarded by 'spill_mutex_'. Written from the start
+     * again whenever all spilled scans are read back.
+     */
+    std::string spill_path_;
+    std::fstream spill_file_;
+    uint64_t spill_end_{0};
+    std::mutex spill_mutex_;
+
+    std::atomic<bool> latency_stats_{false};
+    /**
+     * Guarded by 'in_flight_mutex_', the histograms are recorded by
+     * 'save_thread_' only.
+     */
+    uint64_t written_{0};
+    size_t max_in_flight_seen_{0};
+    ouster::sensor::LatencyHistogram encode_latency_;
+    ouster::sensor::LatencyHistogram write_latency_;
+    ouster::sensor::LatencyHistogram save_latency_;
+
+    /**
+     * Guards the Writer, which creates streams on save() and writes messages
+     * on 'save_thread_'.
+     */
     std::mutex stream_mutex_;
 
+    /**
+     * Serializes save() calls, so that scans are queued in the order their
+     * streams decided between keyframes and delta frames.
+     */
+    std::mutex enqueue_mutex_;
+
+    /**
+     * Queue the scan for encoding and writing.
+     */
+    std::future<void> enqueue(uint32_t stream_index, const LidarScan& scan,
+                              ouster::osf::ts_t timestamp);
+
+    /**
+     * Whether a scan of the bytes fits in flight, under 'in_flight_mutex_'.
+     */
+    bool room_for(size_t bytes) const;
+
+    /**
+     * Put the scan in flight and queue it for encoding, under
+     * 'enqueue_mutex_', once there is room for it.
+     *
+     * @param[in] item The scan's item, with its stream and timestamps set.
+     * @param[in] scan The scan to copy.
+     * @param[in] bytes The size of the copy.
+     * @param[in] from_spill Whether the scan is the first spilled one, taken
+     *                       off 'spilled_' along with being put in flight,
+     *                       also after close().
+     */
+    void start_encoding(const std::shared_ptr<InFlight>& item,
+                        const LidarScan& scan, size_t bytes, bool from_spill);
+
+    /**
+     * Write the scan to the spill file, under 'enqueue_mutex_'.
+     */
+    void spill(const std::shared_ptr<InFlight>& item, const LidarScan& scan,
+               size_t bytes);
+
     /**
      * A runnable used to handle writes in the thread 'save_thread_'.
      */
     void save_thread_method();
 
     /**
-     * Exception propagated from the save thread.
+     * A runnable moving spilled scans in flight in the thread
+     * 'spill_thread_'.
      */
-    std::exception_ptr save_exception_;
+    void spill_thread_method();
 };
 
 }  // namespace osf
@@ -0,0 +1,65 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+#pragma once
+
+#include <memory>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/osf/lidarscan_encoder.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace osf {
+
+/**
+ * Default number of rows per band of BandedLidarScanEncoder.
+ */
+static constexpr size_t DEFAULT_OSF_BAND_ROWS = 32;
+
+/**
+ * Encodes the fields of scans as independent bands of rows, each encoded by
+ * another encoder, so that a single field is encoded and decoded by several
+ * threads of the default thread pool at once. Fields no taller than a band
+ * are stored exactly as the other encoder stores them.
+ *
+ * Readers recognize banded fields by their header and decode them alongside
+ * PNG and zstd encoded ones.
+ */
+class OUSTER_API_CLASS BandedLidarScanEncoder
+    : public ouster::osf::LidarScanEncoder {
+   public:
+    /**
+     * @param[in] encoder The encoder of each band, e.g. a
+     *                    PngLidarScanEncoder.
+     * @param[in] band_rows The number of rows per band.
+     *
+     * @throws std::invalid_argument if encoder is null or band_rows is 0.
+     */
+    OUSTER_API_FUNCTION
+    BandedLidarScanEncoder(std::shared_ptr<LidarScanEncoder> encoder,
+                           size_t band_rows = DEFAULT_OSF_BAND_ROWS);
+
+    // This method is for standard destaggered fields.
+    OUSTER_API_IGNORE
+    bool fieldEncode(const LidarScan& lidar_scan,
+                     const ouster::FieldType& field_type,
+                     const std::vector<int>& px_offset, ScanData& scan_data,
+                     size_t scan_idx) const override;
+
+    // This method is for custom fields.
+    OUSTER_API_IGNORE
+    ScanChannelData encodeField(const ouster::Field& field) const override;
+
+   private:
+    template <typename T>
+    bool encodeBandedImage(ScanChannelData& res_buf,
+                           const Eigen::Ref<const img_t<T>>& img) const;
+
+    std::shared_ptr<LidarScanEncoder> encoder_;
+    size_t band_rows_{DEFAULT_OSF_BAND_ROWS};
+};
+
+}  // namespace osf
+}  // namespace ouster
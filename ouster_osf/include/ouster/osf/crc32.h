@@ -25,7 +25,8 @@ const uint32_t CRC_BYTES_SIZE = 4;
 /** @defgroup OsfCRCFunctions Osf CRC Functions. */
 
 /**
- * Caclulate CRC value for the buffer of given size. (ZLIB version)
+ * Caclulate CRC value for the buffer of given size. (ZLIB compatible, with
+ * PCLMULQDQ or ARMv8 CRC instructions where available)
  *
  * @ingroup OsfCRCFunctions
  *
@@ -38,7 +39,7 @@ uint32_t crc32(const uint8_t* buf, uint32_t size);
 
 /**
  * Caclulate and append CRC value for the buffer of given size and append
- * it to the initial crc value. (ZLIB version)
+ * it to the initial crc value. (ZLIB compatible)
  *
  * @ingroup OsfCRCFunctions
  *
@@ -9,6 +9,7 @@
 #pragma once
 
 #include <fstream>
+#include <memory>
 #include <string>
 
 #include "ouster/osf/basics.h"
@@ -38,6 +39,71 @@ enum class FileState : uint8_t {
  */
 using ChunkBuffer = std::vector<uint8_t>;
 
+/**
+ * Enum representing the ways an OsfFile can read the file.
+ */
+enum class FileBackend : uint8_t {
+    DEFAULT = 0,  ///< HTTP for http(s):// URLs, otherwise MMAP, or STREAM
+                  ///< when built with OUSTER_OSF_NO_MMAP.
+    MMAP = 1,     ///< Map the whole file into memory.
+    STREAM = 2,   ///< Read through a std::ifstream.
+    PREAD = 3,    ///< Positioned reads through a read ahead buffer.
+    HTTP = 4      ///< HTTP range requests through a read ahead buffer.
+};
+
+/**
+ * How an OsfFile reads the file.
+ *
+ * PREAD suits files on network or FUSE file systems, where page faults on a
+ * mapping are slow and unpredictable, and files larger than the address space
+ * of 32 bit targets, which can't be mapped.
+ *
+ * HTTP reads a file served over HTTP(S), e.g. an object in S3 compatible
+ * storage through a presigned URL, without copying it locally. Only the
+ * header, the metadata and the chunks read are fetched, and the next
+ * read_ahead bytes are fetched in the background while the current ones are
+ * used. Reader::set_cache() keeps the chunks read for repeated access.
+ */
+struct OUSTER_API_CLASS FileOptions {
+    /**
+     * The way to read the file.
+     */
+    FileBackend backend{FileBackend::DEFAULT};
+
+    /**
+     * Bytes read at once by PREAD and HTTP, rounded up to whole 4 KiB blocks.
+     * Smaller reads are served from the buffer holding them and larger ones
+     * bypass it.
+     */
+    uint64_t read_ahead{4 << 20};
+
+    /**
+     * Whether the file is mostly read from start to end, in which case PREAD
+     * has the OS read the next read_ahead bytes into the page cache while the
+     * current ones are used. Otherwise the OS is told that reads are random
+     * and doesn't read ahead on its own. HTTP fetches the next read_ahead
+     * bytes only when sequential, and the chunks a ScanReadAhead prefetches
+     * either way.
+     */
+    bool sequential{true};
+
+    /**
+     * Timeout of each HTTP request in seconds.
+     */
+    int timeout_seconds{30};
+
+    /**
+     * Whether a Reader opens the file reading only its header and metadata,
+     * and indexes the chunks, i.e. their states, the chunk infos and message
+     * timestamps of the StreamingInfo, on the first read of messages or
+     * chunks, for a fast open of large files. Chunks are verified on their
+     * first read and the result kept either way.
+     */
+    bool lazy_open{false};
+};
+
+class HttpFile;
+
 /**
  * Interface to abstract the way of how we handle file system read/write
  * operations.
@@ -61,6 +127,15 @@ class OUSTER_API_CLASS OsfFile {
     explicit OsfFile(const std::string& filename,
                      OpenMode mode = OpenMode::READ);
 
+    /**
+     * Opens the OSF file for reading.
+     *
+     * @param[in] filename The OSF file to open
+     * @param[in] options How to read the file.
+     */
+    OUSTER_API_FUNCTION
+    OsfFile(const std::string& filename, const FileOptions& options);
+
     /**
      * Cleans up any filebuffers/memory mapping.
      */
@@ -183,6 +258,7 @@ class OUSTER_API_CLASS OsfFile {
      *
      * @throws std::logic_error Exception on bad osf file.
      * @throws std::out_of_range Exception on out of range read.
+     * @throws std::runtime_error Exception on a failed PREAD read.
      *
      * @param[out] buf The buffer to write to.
      * @param[in] count The number of bytes to write to buf.
@@ -199,6 +275,15 @@ class OUSTER_API_CLASS OsfFile {
     OUSTER_API_FUNCTION
     bool is_memory_mapped() const;
 
+    /**
+     * Returns how the file is read, with the backend never
+     * FileBackend::DEFAULT once opened.
+     *
+     * @return How the file is read.
+     */
+    OUSTER_API_FUNCTION
+    const FileOptions& options() const;
+
     /**
      * Mmap access to the file content with the specified offset from the
      * beginning of the file.
@@ -272,6 +357,17 @@ class OUSTER_API_CLASS OsfFile {
     OUSTER_API_FUNCTION
     std::shared_ptr<ChunkBuffer> read_chunk(uint64_t offset);
 
+    /**
+     * Ask the OS to read the chunk at offset into memory ahead of its use.
+     * Memory mapped files are prefetched by chunk and PREAD files by
+     * read_ahead bytes from the chunk on, which HTTP files fetch in the
+     * background. The hint may be ignored.
+     *
+     * @param[in] offset The offset of the chunk.
+     */
+    OUSTER_API_FUNCTION
+    void prefetch_chunk(uint64_t offset) const;
+
     /**
      * Get a pointer to the start of the header chunk.
      *
@@ -299,6 +395,38 @@ class OUSTER_API_CLASS OsfFile {
      */
     void error(const std::string& msg = std::string());
 
+    /**
+     * Open the file for reading with the backend of options_.
+     */
+    void open_read();
+
+    /**
+     * Read from offset_ through the read ahead buffer of PREAD.
+     *
+     * @param[out] buf The buffer to write to.
+     * @param[in] count The number of bytes to read.
+     */
+    void pread_buffered(uint8_t* buf, uint64_t count);
+
+    /**
+     * Read exactly count bytes at offset with PREAD or HTTP.
+     *
+     * @throws std::runtime_error Exception on a failed or short read.
+     *
+     * @param[out] buf The buffer to write to.
+     * @param[in] count The number of bytes to read.
+     * @param[in] offset The offset to read from.
+     */
+    void pread_exact(uint8_t* buf, uint64_t count, uint64_t offset);
+
+    /**
+     * Hint that a range will be read soon, to PREAD or HTTP.
+     *
+     * @param[in] offset The offset of the range.
+     * @param[in] count The size of the range.
+     */
+    void will_need(uint64_t offset, uint64_t count) const;
+
     /**
      * Opened filename as it was passed in contructor.
      */
@@ -326,6 +454,28 @@ class OUSTER_API_CLASS OsfFile {
      */
     std::ifstream file_stream_;
 
+    /**
+     * How the file is read.
+     */
+    FileOptions options_;
+
+    /**
+     * File descriptor of PREAD.
+     */
+    int fd_{-1};
+
+    /**
+     * Range requests of HTTP.
+     */
+    std::unique_ptr<HttpFile> http_;
+
+    /**
+     * Read ahead buffer of PREAD and HTTP, holding the file from
+     * read_buf_offset_ on.
+     */
+    std::vector<uint8_t> read_buf_;
+    uint64_t read_buf_offset_{0};
+
     /**
      * Pointer for the osf file header chunk.
      */
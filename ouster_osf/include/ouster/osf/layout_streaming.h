@@ -38,7 +38,11 @@ constexpr uint32_t STREAMING_DEFAULT_CHUNK_SIZE =
  * RFC0018 compliant, see TODO below), with every chunk holding messages
  * exclusively of a single stream_id. Tries not to exceede `chunk_size` (if
  * possible). However if a single message size is bigger than specified
- * `chunk_size` it's still recorded.
+ * `chunk_size` it's still recorded. Delta frames always go into the chunk of
+ * the messages preceding them, so only keyframes start new chunks.
+ *
+ * The `chunk_size` limit can be replaced with a ChunkPolicy for all streams
+ * or per stream, limiting chunks by size, message count and duration.
  */
 class OUSTER_API_CLASS StreamingLayoutCW : public ChunksWriter {
    public:
@@ -60,19 +64,91 @@ class OUSTER_API_CLASS StreamingLayoutCW : public ChunksWriter {
                       const ts_t sensor_ts,
                       const std::vector<uint8_t>& buf) override;
 
+    /**
+     * @copydoc ChunksWriter::save_delta_message
+     *
+     * @throws std::logic_error Exception on inconsistent timestamps.
+     */
+    OUSTER_API_FUNCTION
+    void save_delta_message(const uint32_t stream_id, const ts_t receive_ts,
+                            const ts_t sensor_ts,
+                            const std::vector<uint8_t>& buf) override;
+
+    /**
+     * @copydoc ChunksWriter::save_chunk
+     *
+     * @throws std::logic_error Exception on inconsistent timestamps.
+     */
+    OUSTER_API_FUNCTION
+    void save_chunk(const uint32_t stream_id,
+                    const std::vector<uint8_t>& chunk_buf,
+                    const std::vector<ts_t>& sensor_ts) override;
+
+    /**
+     * @copydoc ChunksWriter::finish_stream
+     */
+    OUSTER_API_FUNCTION
+    void finish_stream(const uint32_t stream_id) override;
+
+    /**
+     * @copydoc ChunksWriter::summarize_message
+     */
+    OUSTER_API_FUNCTION
+    void summarize_message(const uint32_t stream_id,
+                           const ChunkSummary& summary) override;
+
     /**
      * @copydoc ChunksWriter::finish
      */
     OUSTER_API_FUNCTION
     void finish() override;
 
+    /**
+     * @copydoc ChunksWriter::checkpoint_metadata
+     */
+    OUSTER_API_FUNCTION
+    void checkpoint_metadata(MetadataStore& store) const override;
+
     /**
      * @copydoc ChunksWriter::chunk_size
      */
     OUSTER_API_FUNCTION
     uint32_t chunk_size() const override;
 
+    /**
+     * @copydoc ChunksWriter::set_chunk_policy(const ChunkPolicy&)
+     */
+    OUSTER_API_FUNCTION
+    void set_chunk_policy(const ChunkPolicy& policy) override;
+
+    /**
+     * @copydoc ChunksWriter::set_chunk_policy(uint32_t, const ChunkPolicy&)
+     */
+    OUSTER_API_FUNCTION
+    void set_chunk_policy(uint32_t stream_id,
+                          const ChunkPolicy& policy) override;
+
+    /**
+     * @copydoc ChunksWriter::chunk_policy
+     */
+    OUSTER_API_FUNCTION
+    ChunkPolicy chunk_policy(uint32_t stream_id) const override;
+
    private:
+    /**
+     * Save a message to the chunk of its stream.
+     *
+     * @param[in] stream_id The stream id to associate with the message.
+     * @param[in] receive_ts The receive timestamp for the messages.
+     * @param[in] sensor_ts The sensor timestamp for the messages.
+     * @param[in] msg_buf The message buffer to record.
+     * @param[in] may_finish_chunk Whether the chunk of the stream may be
+     *                             finished first if the message doesn't fit.
+     */
+    void save(const uint32_t stream_id, const ts_t receive_ts,
+              const ts_t sensor_ts, const std::vector<uint8_t>& msg_buf,
+              bool may_finish_chunk);
+
     /**
      * Internal method to calculate and append the stats
      * for a specific set of new messages.
@@ -80,11 +156,10 @@ class OUSTER_API_CLASS StreamingLayoutCW : public ChunksWriter {
      * @param[in] stream_id The stream id to associate with the message.
      * @param[in] receive_ts The receive timestamp for the messages.
      * @param[in] sensor_ts The sensor timestamp for the messages.
-     * @param[in] msg_buf A vector of message buffers to gather stats about.
+     * @param[in] msg_size The size of the message buffer.
      */
     void stats_message(const uint32_t stream_id, const ts_t receive_ts,
-                       const ts_t sensor_ts,
-                       const std::vector<uint8_t>& msg_buf);
+                       const ts_t sensor_ts, uint32_t msg_size);
 
     /**
      *  Finish out a chunk and write the chunk to the writer.
@@ -101,6 +176,17 @@ class OUSTER_API_CLASS StreamingLayoutCW : public ChunksWriter {
      */
     const uint32_t chunk_size_;
 
+    /**
+     * Chunk policy of the streams without one in stream_policies_.
+     */
+    ChunkPolicy default_policy_;
+
+    /**
+     * Per stream_id chunk policies.
+     * Map Format: <stream_id, chunk policy>
+     */
+    std::map<uint32_t, ChunkPolicy> stream_policies_{};
+
     /**
      * Per stream_id chunk builders.
      * Map Format: <stream_id, chunk builder>
@@ -119,6 +205,28 @@ class OUSTER_API_CLASS StreamingLayoutCW : public ChunksWriter {
      */
     std::map<uint32_t, StreamStats> stream_stats_{};
 
+    /**
+     * Stats of a message in a chunk that isn't written yet.
+     */
+    struct OUSTER_API_IGNORE MessageStats {
+        ts_t receive_ts;
+        ts_t sensor_ts;
+        uint32_t size;
+    };
+
+    /**
+     * Per stream_id messages counted in stream_stats_ once their chunk is
+     * written, so that the stats only ever describe the chunks in the file.
+     * Map Format: <stream_id, message stats>
+     */
+    std::map<uint32_t, std::vector<MessageStats>> unwritten_stats_{};
+
+    /**
+     * Per stream_id summaries of the chunks that aren't written yet.
+     * Map Format: <stream_id, chunk summary>
+     */
+    std::map<uint32_t, ChunkSummary> unwritten_summaries_{};
+
     /**
      * Internal writer object to use for writing.
      */
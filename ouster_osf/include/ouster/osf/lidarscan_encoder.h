@@ -38,6 +38,9 @@ class OUSTER_API_CLASS LidarScanEncoder {
     // This method is for custom fields.
     virtual ScanChannelData encodeField(const ouster::Field& field) const = 0;
     friend class LidarScanStream;
+    friend class BandedLidarScanEncoder;
+    friend class SparseLidarScanEncoder;
+    friend class LossyLidarScanEncoder;
 };
 
 }  // namespace osf
@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/lossy_codec.h"
+#include "ouster/osf/lidarscan_encoder.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace osf {
+
+/**
+ * Default largest error of the range fields encoded by a
+ * LossyLidarScanEncoder, in mm.
+ */
+constexpr uint32_t DEFAULT_LOSSY_RANGE_ERROR = 5;
+
+/**
+ * Encodes the listed fields of scans with an error bounded lossy codec, see
+ * ouster::encode_lossy(), and every other field with another encoder. Every
+ * pixel of a lossy field decodes within its largest error of the original,
+ * zero pixels stay zero, and a largest error of 0 stores the field
+ * losslessly.
+ *
+ * Readers recognize lossy fields by their header and decode them alongside
+ * PNG, zstd, banded and sparse ones. Only unsigned integer fields are
+ * encoded lossily, other listed fields go to the other encoder.
+ */
+class OUSTER_API_CLASS LossyLidarScanEncoder
+    : public ouster::osf::LidarScanEncoder {
+   public:
+    /**
+     * @param[in] encoder The encoder of the other fields, e.g. a
+     *                    PngLidarScanEncoder.
+     * @param[in] max_errors The largest error of each lossy field, in the
+     *                       units of the field.
+     *
+     * @throws std::invalid_argument if encoder is null.
+     */
+    OUSTER_API_FUNCTION
+    explicit LossyLidarScanEncoder(
+        std::shared_ptr<LidarScanEncoder> encoder,
+        LossyFields max_errors = {
+            {sensor::ChanField::RANGE, DEFAULT_LOSSY_RANGE_ERROR},
+            {sensor::ChanField::RANGE2, DEFAULT_LOSSY_RANGE_ERROR}});
+
+    // This method is for standard destaggered fields.
+    OUSTER_API_IGNORE
+    bool fieldEncode(const LidarScan& lidar_scan,
+                     const ouster::FieldType& field_type,
+                     const std::vector<int>& px_offset, ScanData& scan_data,
+                     size_t scan_idx) const override;
+
+    // This method is for custom fields.
+    OUSTER_API_IGNORE
+    ScanChannelData encodeField(const ouster::Field& field) const override;
+
+   private:
+    template <typename T>
+    bool encodeLossyImage(ScanChannelData& res_buf,
+                          const Eigen::Ref<const img_t<T>>& img,
+                          uint32_t max_error) const;
+
+    std::shared_ptr<LidarScanEncoder> encoder_;
+    LossyFields max_errors_;
+};
+
+}  // namespace osf
+}  // namespace ouster
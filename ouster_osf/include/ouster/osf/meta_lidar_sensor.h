@@ -44,6 +44,14 @@ class OUSTER_API_CLASS LidarSensor : public MetadataEntryHelper<LidarSensor> {
     OUSTER_API_FUNCTION
     explicit LidarSensor(const std::string& sensor_metadata);
 
+    /**
+     * @param[in] si Initialize the LidarSensor with a sensor_info object.
+     * @param[in] sensor_metadata The json string representation of the same
+     *                            sensor_info, kept as is and not parsed.
+     */
+    OUSTER_API_FUNCTION
+    LidarSensor(const sensor_info& si, const std::string& sensor_metadata);
+
     /**
      * Returns the sensor_info associated with the LidarSensor.
      *
@@ -0,0 +1,152 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file meta_recording_gaps.h
+ * @brief Metadata entry RecordingGaps
+ *
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ouster/osf/metadata.h"
+#include "ouster/scan_gate.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace osf {
+
+/**
+ * Metadata entry to store the scans of a sensor left out of the recording
+ * by a ScanGate, see Writer::set_scan_gate().
+ *
+ * OSF type:
+ *   ouster/v1/os_sensor/RecordingGaps
+ *
+ * Flat Buffer Reference:
+ *   fb/os_sensor/recording_gaps.fbs
+ */
+class OUSTER_API_CLASS RecordingGaps
+    : public MetadataEntryHelper<RecordingGaps> {
+   public:
+    /**
+     * @param[in] spans The runs of scans left out, in order.
+     * @param[in] kept The number of scans recorded.
+     * @param[in] ref_meta_id The metadata id of the LidarSensor of the scans.
+     */
+    OUSTER_API_FUNCTION
+    explicit RecordingGaps(std::vector<SkippedSpan> spans, uint64_t kept = 0,
+                           uint32_t ref_meta_id = 0);
+
+    /**
+     * Get the runs of scans left out.
+     *
+     * @return The runs of scans left out, in order.
+     */
+    OUSTER_API_FUNCTION
+    const std::vector<SkippedSpan>& spans() const;
+
+    /**
+     * Get the number of scans recorded.
+     *
+     * @return The number of scans recorded.
+     */
+    OUSTER_API_FUNCTION
+    uint64_t kept() const;
+
+    /**
+     * Get the number of scans left out.
+     *
+     * @return The number of scans left out over all the runs.
+     */
+    OUSTER_API_FUNCTION
+    uint64_t skipped() const;
+
+    /**
+     * Get the reference metadata id.
+     *
+     * @return The metadata id of the LidarSensor.
+     */
+    OUSTER_API_FUNCTION
+    uint32_t ref_meta_id() const;
+
+    /**
+     * @copydoc MetadataEntry::buffer
+     */
+    OUSTER_API_FUNCTION
+    std::vector<uint8_t> buffer() const final;
+
+    /**
+     * Create a RecordingGaps object from a byte array.
+     *
+     * @relates MetadataEntry::from_buffer
+     *
+     * @param[in] buf The byte vector to construct a RecordingGaps object from.
+     * @return The new RecordingGaps cast as a MetadataEntry
+     */
+    OUSTER_API_FUNCTION
+    static std::unique_ptr<MetadataEntry> from_buffer(
+        const std::vector<uint8_t>& buf);
+
+    /**
+     * Get the string representation for the RecordingGaps object.
+     *
+     * @relates MetadataEntry::repr
+     *
+     * @return The string representation for the RecordingGaps object.
+     */
+    OUSTER_API_FUNCTION
+    std::string repr() const override;
+
+   private:
+    /**
+     * The runs of scans left out.
+     *
+     * Flat Buffer Reference:
+     *   fb/os_sensor/recording_gaps.fbs :: RecordingGaps :: first_frame_id,
+     *   last_frame_id, first_ts, last_ts and count
+     */
+    std::vector<SkippedSpan> spans_;
+
+    /**
+     * The number of scans recorded.
+     *
+     * Flat Buffer Reference:
+     *   fb/os_sensor/recording_gaps.fbs :: RecordingGaps :: kept
+     */
+    uint64_t kept_;
+
+    /**
+     * The internal flatbuffer metadata reference id.
+     *
+     * Flat Buffer Reference:
+     *   fb/os_sensor/recording_gaps.fbs :: RecordingGaps :: ref_id
+     */
+    uint32_t ref_meta_id_;
+};
+
+/** @defgroup OSFTraitsRecordingGaps OSF Templated traits struct. */
+
+/**
+ * Templated struct for returning the OSF type string.
+ *
+ * @ingroup OSFTraitsRecordingGaps
+ */
+template <>
+struct OUSTER_API_CLASS MetadataTraits<RecordingGaps> {
+    /**
+     * Return the OSF type string.
+     *
+     * @return The OSF type string "ouster/v1/os_sensor/RecordingGaps".
+     */
+    OUSTER_API_FUNCTION
+    static const std::string type() {
+        return "ouster/v1/os_sensor/RecordingGaps";
+    }
+};
+
+}  // namespace osf
+}  // namespace ouster
@@ -8,6 +8,7 @@
  */
 #pragma once
 
+#include <array>
 #include <iostream>
 #include <memory>
 
@@ -18,6 +19,70 @@
 namespace ouster {
 namespace osf {
 
+/**
+ * Lowest and highest value of a quantity over the messages of a chunk.
+ *
+ * Flat Buffer Reference:
+ *   fb/streaming/streaming_info.fbs :: ValueBounds
+ */
+struct OUSTER_API_CLASS ValueBounds {
+    double min;  ///< lowest value
+    double max;  ///< highest value
+};
+
+/**
+ * Summary of the lidar scans of a chunk, so that readers skip chunks that
+ * can't hold the scans they look for without decoding them, see
+ * Writer::set_chunk_summaries() and Reader::messages() with a ChunkFilter.
+ * Bounds of values the scans don't hold are left empty.
+ *
+ * Flat Buffer Reference:
+ *   fb/streaming/streaming_info.fbs :: ChunkSummary
+ */
+struct OUSTER_API_CLASS ChunkSummary {
+    /**
+     * Lowest and highest nonzero RANGE, in mm.
+     */
+    nonstd::optional<ValueBounds> range;
+
+    /**
+     * Lowest and highest mean REFLECTIVITY of the valid columns of a scan.
+     */
+    nonstd::optional<ValueBounds> reflectivity;
+
+    /**
+     * Union of the alert flags of the packets of the scans.
+     */
+    uint64_t alert_flags{0};
+
+    /**
+     * Bounds of the x, y and z translations of the poses of the valid
+     * columns.
+     */
+    nonstd::optional<std::array<ValueBounds, 3>> pose;
+
+    /**
+     * Lowest and highest ratio of valid columns of a scan.
+     */
+    nonstd::optional<ValueBounds> completeness;
+
+    /**
+     * @return Whether nothing was summarized, e.g. for chunks written
+     *         without summaries.
+     */
+    OUSTER_API_FUNCTION
+    bool empty() const;
+
+    /**
+     * Extend the bounds to the ones of another summary, e.g. of the next
+     * message of the chunk.
+     *
+     * @param[in] other The summary to merge.
+     */
+    OUSTER_API_FUNCTION
+    void merge(const ChunkSummary& other);
+};
+
 /**
  * Class for keeping track of OSF chunks.
  *
@@ -49,6 +114,15 @@ struct OUSTER_API_CLASS ChunkInfo {
      *   fb/streaming/streaming_info.fbs :: ChunkInfo :: message_count
      */
     uint32_t message_count;
+
+    /**
+     * The summary of the messages in the chunk, empty if the writer didn't
+     * compute one.
+     *
+     * Flat Buffer Reference:
+     *   fb/streaming/streaming_info.fbs :: ChunkInfo :: summary
+     */
+    ChunkSummary summary{};
 };
 
 /**
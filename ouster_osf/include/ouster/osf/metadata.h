@@ -572,6 +572,17 @@ class OUSTER_API_CLASS MetadataStore {
     OUSTER_API_FUNCTION
     uint32_t add(MetadataEntry& entry);
 
+    /**
+     * Assign the ids of the entries added from now on from next_id up, e.g.
+     * to keep the ids of files written side by side apart.
+     *
+     * @throws std::invalid_argument if next_id isn't above the ids in use.
+     *
+     * @param[in] next_id The id of the next entry added without an id.
+     */
+    OUSTER_API_FUNCTION
+    void set_next_id(uint32_t next_id);
+
     /**
      * Get the first specified MetadataEntry associated to the
      * template parameter.
@@ -0,0 +1,484 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file multi_reader.h
+ * @brief Reads a recording split into several OSF files as one
+ */
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ouster/osf/basics.h"
+#include "ouster/osf/file.h"
+#include "ouster/osf/reader.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace osf {
+
+class MultiReader;
+
+/**
+ * The shards of a recording written side by side by a ShardedWriter, each
+ * shard an OSF file with the scans of some of the sensors.
+ */
+struct OUSTER_API_CLASS ShardManifest {
+    /**
+     * The files of the shards.
+     */
+    std::vector<std::string> files;
+
+    /**
+     * The sensors of each shard, as indices of the sensor_info of the
+     * recording.
+     */
+    std::vector<std::vector<uint32_t>> sensors;
+};
+
+/**
+ * Read a shard manifest, see ShardedWriter.
+ *
+ * @throws std::runtime_error Exception on a file that can't be read or isn't
+ *                            a shard manifest.
+ *
+ * @param[in] path The manifest file.
+ * @return The manifest, with the files of the shards stored relative to the
+ *         manifest resolved against its directory.
+ */
+OUSTER_API_FUNCTION
+ShardManifest load_shard_manifest(const std::string& path);
+
+/**
+ * Write a shard manifest as JSON, the files of the shards stored as given.
+ *
+ * @throws std::runtime_error Exception on a file that can't be written.
+ *
+ * @param[in] path The manifest file.
+ * @param[in] manifest The shards of the recording.
+ */
+OUSTER_API_FUNCTION
+void save_shard_manifest(const std::string& path,
+                         const ShardManifest& manifest);
+
+/**
+ * Message forward iterator over the files of a MultiReader, in timestamp
+ * order within each file and file after file, or across all files for the
+ * shards of a recording.
+ */
+struct OUSTER_API_CLASS MultiMessagesIter {
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = const MessageRef;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const std::unique_ptr<MessageRef>;
+    using reference = const MessageRef&;
+
+    /**
+     * Default construction of an end iterator of no reader.
+     */
+    OUSTER_API_FUNCTION
+    MultiMessagesIter();
+
+    /**
+     * @return The current message.
+     */
+    OUSTER_API_FUNCTION
+    const MessageRef operator*() const;
+
+    /**
+     * @return The current message.
+     */
+    OUSTER_API_FUNCTION
+    std::unique_ptr<const MessageRef> operator->() const;
+
+    /**
+     * Move to the next message, opening the next file when the current one
+     * has no more, or moving to the shard with the next message.
+     *
+     * @return The current MultiMessagesIter object.
+     */
+    OUSTER_API_FUNCTION
+    MultiMessagesIter& operator++();
+
+    /**
+     * @param[in] other The other object to compare.
+     * @return Whether the two iterators are at the same message.
+     */
+    OUSTER_API_FUNCTION
+    bool operator==(const MultiMessagesIter& other) const;
+
+    /**
+     * @param[in] other The other object to compare.
+     * @return Whether the two iterators are not at the same message.
+     */
+    OUSTER_API_FUNCTION
+    bool operator!=(const MultiMessagesIter& other) const;
+
+    /**
+     * @return The index of the file of the current message in the
+     *         MultiReader.
+     */
+    OUSTER_API_FUNCTION
+    size_t file_idx() const;
+
+   private:
+    MultiMessagesIter(MultiReader* reader, size_t file_idx,
+                      const std::vector<uint32_t>& stream_ids,
+                      const ts_t start_ts, const ts_t end_ts);
+
+    /**
+     * Open the messages of the files from file_idx_ on, until one has any,
+     * or of all shards.
+     */
+    void open();
+
+    /**
+     * Point file_idx_ at the shard with the earliest next message.
+     */
+    void next_shard();
+
+    MultiReader* reader_;
+    size_t file_idx_;
+    std::vector<uint32_t> stream_ids_;
+    ts_t start_ts_;
+    ts_t end_ts_;
+    MessagesStreamingIter it_;
+    MessagesStreamingIter end_;
+    /**
+     * The next message of each shard and the ends of their messages, empty
+     * for files read one after another.
+     */
+    std::vector<MessagesStreamingIter> shard_its_;
+    std::vector<MessagesStreamingIter> shard_ends_;
+
+    friend class MultiMessagesRange;
+};
+
+/**
+ * std iterator class for iterating through the messages of a MultiReader.
+ */
+class OUSTER_API_CLASS MultiMessagesRange {
+   public:
+    /**
+     * @return A MultiMessagesIter at the first message.
+     */
+    OUSTER_API_FUNCTION
+    MultiMessagesIter begin() const;
+
+    /**
+     * @return A MultiMessagesIter signifying the end of iteration.
+     */
+    OUSTER_API_FUNCTION
+    MultiMessagesIter end() const;
+
+   private:
+    MultiMessagesRange(MultiReader* reader,
+                       const std::vector<uint32_t>& stream_ids,
+                       const ts_t start_ts, const ts_t end_ts);
+
+    MultiReader* reader_;
+    std::vector<uint32_t> stream_ids_;
+    ts_t start_ts_;
+    ts_t end_ts_;
+
+    friend class MultiReader;
+};
+
+/**
+ * Chunk forward iterator over the files of a MultiReader, in order of offset
+ * within each file and file after file.
+ */
+struct OUSTER_API_CLASS MultiChunksIter {
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = const ChunkRef;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const std::unique_ptr<ChunkRef>;
+    using reference = const ChunkRef&;
+
+    /**
+     * Default construction of an end iterator of no reader.
+     */
+    OUSTER_API_FUNCTION
+    MultiChunksIter();
+
+    /**
+     * @return The current chunk.
+     */
+    OUSTER_API_FUNCTION
+    const ChunkRef operator*() const;
+
+    /**
+     * @return The current chunk.
+     */
+    OUSTER_API_FUNCTION
+    const std::unique_ptr<ChunkRef> operator->() const;
+
+    /**
+     * Move to the next chunk, opening the next file when the current one has
+     * no more.
+     *
+     * @return The current MultiChunksIter object.
+     */
+    OUSTER_API_FUNCTION
+    MultiChunksIter& operator++();
+
+    /**
+     * @param[in] other The other object to compare.
+     * @return Whether the two iterators are at the same chunk.
+     */
+    OUSTER_API_FUNCTION
+    bool operator==(const MultiChunksIter& other) const;
+
+    /**
+     * @param[in] other The other object to compare.
+     * @return Whether the two iterators are not at the same chunk.
+     */
+    OUSTER_API_FUNCTION
+    bool operator!=(const MultiChunksIter& other) const;
+
+    /**
+     * @return The index of the file of the current chunk in the MultiReader.
+     */
+    OUSTER_API_FUNCTION
+    size_t file_idx() const;
+
+   private:
+    MultiChunksIter(MultiReader* reader, size_t file_idx);
+
+    /**
+     * Open the chunks of the files from file_idx_ on, until one has any.
+     */
+    void open();
+
+    MultiReader* reader_;
+    size_t file_idx_;
+    ChunksIter it_;
+    ChunksIter end_;
+
+    friend class MultiChunksRange;
+};
+
+/**
+ * std iterator class for iterating through the chunks of a MultiReader.
+ */
+class OUSTER_API_CLASS MultiChunksRange {
+   public:
+    /**
+     * @return A MultiChunksIter at the first chunk.
+     */
+    OUSTER_API_FUNCTION
+    MultiChunksIter begin() const;
+
+    /**
+     * @return A MultiChunksIter signifying the end of iteration.
+     */
+    OUSTER_API_FUNCTION
+    MultiChunksIter end() const;
+
+   private:
+    explicit MultiChunksRange(MultiReader* reader);
+
+    MultiReader* reader_;
+
+    friend class MultiReader;
+};
+
+/**
+ * Reads a recording split into several OSF files, e.g. hourly files, as one.
+ *
+ * Only the header and the metadata block of each file are read up front, for
+ * the time range of the file, so that opening takes time proportional to the
+ * number of files. The Reader of a file, which indexes its chunks, is opened
+ * the first time its messages or chunks are read.
+ *
+ * The files must be written with the same streams, e.g. by the same
+ * recorder, so that a stream id stands for the same stream in all of them,
+ * and cover time ranges that don't overlap. Not safe to use from multiple
+ * threads.
+ *
+ * The shards of a recording written by a ShardedWriter cover the same time
+ * range instead, with the streams of different sensors under different ids,
+ * and their messages are merged in timestamp order, which keeps the Readers
+ * of all shards open while reading.
+ */
+class OUSTER_API_CLASS MultiReader {
+   public:
+    /**
+     * @throws std::invalid_argument Exception on no files or on files with
+     *                               overlapping time ranges.
+     * @throws std::logic_error Exception on a file that isn't a valid OSF
+     *                          file.
+     *
+     * @param[in] files The files of the recording, in any order.
+     * @param[in] options How to read the files.
+     */
+    OUSTER_API_FUNCTION
+    explicit MultiReader(const std::vector<std::string>& files,
+                         const FileOptions& options = FileOptions());
+
+    /**
+     * Read the shards of a recording written by a ShardedWriter as one.
+     *
+     * @throws std::invalid_argument Exception on a manifest without shards.
+     * @throws std::logic_error Exception on a shard that isn't a valid OSF
+     *                          file.
+     *
+     * @param[in] manifest The shards of the recording, see
+     *                     load_shard_manifest().
+     * @param[in] options How to read the files.
+     */
+    OUSTER_API_FUNCTION
+    explicit MultiReader(const ShardManifest& manifest,
+                         const FileOptions& options = FileOptions());
+
+    /**
+     * @return Whether the files are shards read side by side.
+     */
+    OUSTER_API_FUNCTION
+    bool sharded() const;
+
+    /**
+     * @return The number of files.
+     */
+    OUSTER_API_FUNCTION
+    size_t size() const;
+
+    /**
+     * @param[in] file_idx The index of the file, in order of time.
+     * @return The name of the file.
+     */
+    OUSTER_API_FUNCTION
+    const std::string& filename(size_t file_idx) const;
+
+    /**
+     * Get the Reader of a file, opening it on first use.
+     *
+     * @throws std::out_of_range Exception on a file index past the files.
+     *
+     * @param[in] file_idx The index of the file, in order of time.
+     * @return The Reader of the file.
+     */
+    OUSTER_API_FUNCTION
+    Reader& reader(size_t file_idx);
+
+    /**
+     * @return The lowest timestamp of the files.
+     */
+    OUSTER_API_FUNCTION
+    ts_t start_ts() const;
+
+    /**
+     * @return The highest timestamp of the files.
+     */
+    OUSTER_API_FUNCTION
+    ts_t end_ts() const;
+
+    /**
+     * Read all messages of all files in timestamp order.
+     *
+     * @return The range of messages.
+     */
+    OUSTER_API_FUNCTION
+    MultiMessagesRange messages();
+
+    /**
+     * Read the messages in the [start_ts, end_ts] range (inclusive).
+     *
+     * @param[in] start_ts The lowest timestamp to read.
+     * @param[in] end_ts The highest timestamp to read.
+     * @return The range of messages.
+     */
+    OUSTER_API_FUNCTION
+    MultiMessagesRange messages(const ts_t start_ts, const ts_t end_ts);
+
+    /**
+     * Read the messages of the streams, all if empty.
+     *
+     * @param[in] stream_ids The streams to read.
+     * @return The range of messages.
+     */
+    OUSTER_API_FUNCTION
+    MultiMessagesRange messages(const std::vector<uint32_t>& stream_ids);
+
+    /**
+     * Read the messages of the streams, all if empty, in the
+     * [start_ts, end_ts] range (inclusive).
+     *
+     * @param[in] stream_ids The streams to read.
+     * @param[in] start_ts The lowest timestamp to read.
+     * @param[in] end_ts The highest timestamp to read.
+     * @return The range of messages.
+     */
+    OUSTER_API_FUNCTION
+    MultiMessagesRange messages(const std::vector<uint32_t>& stream_ids,
+                                const ts_t start_ts, const ts_t end_ts);
+
+    /**
+     * Read the chunks of all files, file after file.
+     *
+     * @return The range of chunks.
+     */
+    OUSTER_API_FUNCTION
+    MultiChunksRange chunks();
+
+    /**
+     * The number of messages of a stream in all files. Opens the Readers of
+     * all files.
+     *
+     * @param[in] stream_id The stream.
+     * @return The number of messages.
+     */
+    OUSTER_API_FUNCTION
+    uint64_t message_count(uint32_t stream_id);
+
+    /**
+     * Find the timestamp of a message by its index in the stream across all
+     * files. Opens the Readers of the files up to the one holding it.
+     *
+     * Requires the files to have message_counts inside, i.e.
+     * Reader::has_message_idx(), otherwise the return value is always empty.
+     *
+     * @param[in] stream_id The stream of the message.
+     * @param[in] message_idx The index of the message in the stream.
+     * @return The timestamp of the message, or empty if not found.
+     */
+    OUSTER_API_FUNCTION
+    nonstd::optional<ts_t> ts_by_message_idx(uint32_t stream_id,
+                                             uint64_t message_idx);
+
+   private:
+    /**
+     * Read the time range of the files and sort them by it, files without
+     * messages last.
+     */
+    void add_files(const std::vector<std::string>& files);
+
+    /**
+     * The number of messages of a stream in a file.
+     */
+    uint64_t file_message_count(size_t file_idx, uint32_t stream_id);
+
+    struct OUSTER_API_IGNORE FileEntry {
+        std::string filename;
+        ts_t start_ts;
+        ts_t end_ts;
+        /** Without chunks, and so without a time range. */
+        bool empty{false};
+        std::unique_ptr<Reader> reader;
+        /** Messages per stream, filled from the reader on first use. */
+        std::map<uint32_t, uint64_t> message_counts;
+        bool counted{false};
+    };
+
+    FileOptions options_;
+    std::vector<FileEntry> files_;
+    bool sharded_{false};
+
+    friend struct MultiMessagesIter;
+};
+
+}  // namespace osf
+}  // namespace ouster
@@ -8,10 +8,14 @@
  */
 #pragma once
 
+#include <limits>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "ouster/osf/basics.h"
 #include "ouster/osf/metadata.h"
+#include "ouster/osf/osf_encoder.h"
 #include "ouster/types.h"
 #include "ouster/visibility.h"
 
@@ -63,7 +67,8 @@ int64_t restore_osf_file_metablob(const std::string& osf_file_name,
                                   const std::string& backup_file_name);
 
 /**
- * Modify an OSF files sensor_info metadata.
+ * Modify an OSF files sensor_info metadata. Only the metadata block is
+ * rewritten, the chunks are left as they are.
  *
  * @param[in] file_name The OSF file to modify.
  * @param[out] new_metadata The new metadata for the OSF file
@@ -74,5 +79,411 @@ int64_t osf_file_modify_metadata(
     const std::string& file_name,
     const std::vector<ouster::sensor::sensor_info>& new_metadata);
 
+/**
+ * Finish an OSF file that was never closed, e.g. after a crash or power
+ * loss, from the last metadata checkpoint its Writer wrote, see
+ * Writer::set_checkpoint_interval(). Only the chunks written after that
+ * checkpoint are read and indexed; the file is cut after the last intact
+ * chunk and gets a new metadata block and header. Files that were closed
+ * are left as they are.
+ *
+ * @param[in] file_name The OSF file to recover.
+ * @return The size of the recovered OSF file, -1 if it has no intact
+ *         checkpoint.
+ */
+OUSTER_API_FUNCTION
+int64_t recover_osf_file(const std::string& file_name);
+
+/**
+ * Copy the messages of an OSF file in the [start_ts, end_ts] range
+ * (inclusive) of a set of streams to a new OSF file with the same metadata.
+ *
+ * The chunks with all their messages in the selection are copied as they
+ * are, without decoding or re-encoding them, so that slicing costs about as
+ * much as copying the bytes. The selected messages of the chunks at the
+ * boundaries of the range are copied one by one, still encoded. A selected
+ * delta frame whose keyframe is out of the range is copied along with the
+ * messages of its stream back to the keyframe, for it to be decodable.
+ *
+ * @throws std::logic_error Exception on a file that isn't a valid OSF file.
+ *
+ * @param[in] file_name The OSF file to slice.
+ * @param[in] output_file_name The OSF file to write, overwritten if exists.
+ * @param[in] start_ts The lowest timestamp to copy.
+ * @param[in] end_ts The highest timestamp to copy.
+ * @param[in] stream_ids The streams to copy, all if empty.
+ * @return The size of the written OSF file.
+ */
+OUSTER_API_FUNCTION
+int64_t slice_osf_file(const std::string& file_name,
+                       const std::string& output_file_name, ts_t start_ts,
+                       ts_t end_ts,
+                       const std::vector<uint32_t>& stream_ids = {});
+
+/**
+ * Merge a recording split into several OSF files, e.g. hourly files, into a
+ * single OSF file, copying all their chunks as they are. The files must be
+ * of the same streams and cover time ranges that don't overlap, as read by
+ * MultiReader; the metadata is the one of the earliest file.
+ *
+ * @throws std::invalid_argument Exception on no files or on files with
+ *                               overlapping time ranges.
+ * @throws std::logic_error Exception on a file that isn't a valid OSF file.
+ *
+ * @param[in] file_names The OSF files to merge, in any order.
+ * @param[in] output_file_name The OSF file to write, overwritten if exists.
+ * @return The size of the written OSF file.
+ */
+OUSTER_API_FUNCTION
+int64_t merge_osf_files(const std::vector<std::string>& file_names,
+                        const std::string& output_file_name);
+
+/**
+ * Default chunk size of compact_osf_file(), large enough for a stream to be
+ * read in few sequential reads.
+ */
+constexpr uint32_t COMPACT_DEFAULT_CHUNK_SIZE = 16 * 1024 * 1024;
+
+/**
+ * How compact_osf_file() rewrites an OSF file.
+ */
+struct OUSTER_API_CLASS CompactOptions {
+    /**
+     * The chunk size of the compacted file.
+     */
+    uint32_t chunk_size{COMPACT_DEFAULT_CHUNK_SIZE};
+
+    /**
+     * Whether the chunks of each stream are written one after another, for
+     * per stream reads to be sequential, rather than interleaved by time.
+     */
+    bool group_streams{true};
+
+    /**
+     * How to re-encode the scans, e.g. with a higher compression level;
+     * scans are copied still encoded if not provided.
+     */
+    std::shared_ptr<Encoder> encoder{};
+};
+
+/**
+ * Rewrite an OSF file for reading, e.g. a live recording written in small
+ * chunks, into larger chunks of a single stream each, grouped by stream,
+ * with the timestamp of every message in the StreamingInfo, the index
+ * that Reader seeks with.
+ *
+ * The messages are copied still encoded, without decoding them, unless an
+ * encoder is given, in which case the scans are first re-encoded as by
+ * transcode_osf_file(), through a temporary file next to the output, and
+ * only the LidarScan streams are kept. Files without a StreamingInfo are
+ * copied in the order of their chunks, without grouping the streams.
+ *
+ * @throws std::logic_error Exception on a file that isn't a valid OSF file.
+ *
+ * @param[in] file_name The OSF file to compact.
+ * @param[in] output_file_name The OSF file to write, overwritten if exists.
+ * @param[in] options How to rewrite the file.
+ * @return The size of the written OSF file.
+ */
+OUSTER_API_FUNCTION
+int64_t compact_osf_file(const std::string& file_name,
+                         const std::string& output_file_name,
+                         const CompactOptions& options = CompactOptions());
+
+/**
+ * Built-in operations applied natively to the scans of each sensor before
+ * they are saved by transcode_osf_file() and pcap_to_osf(), like the `slice`,
+ * `reduce` and `clip` commands of ouster-cli, in that order.
+ */
+struct OUSTER_API_CLASS ScanOps {
+    /**
+     * Index of the first scan of each sensor to save.
+     */
+    size_t start{0};
+
+    /**
+     * Index of the scan of each sensor to stop before, no limit if 0.
+     */
+    size_t stop{0};
+
+    /**
+     * Save every step-th scan from start, at least 1.
+     */
+    size_t step{1};
+
+    /**
+     * Beams to reduce the scans and the metadata of each sensor to with
+     * reduce_by_factor(), a divisor of their beams, or 0 to keep them all.
+     */
+    size_t beams{0};
+
+    /**
+     * The fields to clip with clip_fields(), none if empty.
+     */
+    std::vector<std::string> clip_fields{};
+
+    /**
+     * The lowest value of the clipped fields to keep.
+     */
+    double clip_lower{0};
+
+    /**
+     * The highest value of the clipped fields to keep.
+     */
+    double clip_upper{std::numeric_limits<double>::infinity()};
+
+    /**
+     * The value replacing the clipped values.
+     */
+    double clip_invalid{0};
+};
+
+/**
+ * How transcode_osf_file() writes the scans of the transcoded file.
+ */
+struct OUSTER_API_CLASS TranscodeOptions {
+    /**
+     * The fields of the scans to keep, all if empty.
+     */
+    std::vector<std::string> fields{};
+
+    /**
+     * How to encode the scans, e.g. with another LidarScanEncoder or
+     * compression level, the default of Writer if not provided. Scans are
+     * decoded and encoded on its thread pool.
+     */
+    std::shared_ptr<Encoder> encoder{};
+
+    /**
+     * The chunk size of the transcoded file, the default of Writer if 0.
+     */
+    uint32_t chunk_size{0};
+
+    /**
+     * Scans being encoded or waiting to be written, at least 1.
+     */
+    size_t max_in_flight{10};
+
+    /**
+     * Operations applied to the scans before they are encoded.
+     */
+    ScanOps ops{};
+};
+
+/**
+ * Transcode the LidarScans of an OSF file to a new OSF file, e.g. to drop
+ * fields or to change how they are compressed. Scans are decoded ahead with
+ * ScanReadAhead and encoded with AsyncWriter, both on the thread pool of the
+ * encoder, and written in the order of the messages of the file, so that
+ * transcoding scales with the threads of the pool.
+ *
+ * The sensors of the file become the sensors of the new one, in order of
+ * their metadata ids. Messages of other streams than LidarScanStream are not
+ * copied.
+ *
+ * @throws std::logic_error Exception on a file that isn't a valid OSF file.
+ * @throws std::invalid_argument Exception on ops that don't fit the sensors.
+ * @throws std::runtime_error Exception on a scan that can't be decoded or a
+ *                            requested field missing from a scan.
+ *
+ * @param[in] file_name The OSF file to transcode.
+ * @param[in] output_file_name The OSF file to write, overwritten if exists.
+ * @param[in] options How to write the scans.
+ * @return The size of the written OSF file.
+ */
+OUSTER_API_FUNCTION
+int64_t transcode_osf_file(
+    const std::string& file_name, const std::string& output_file_name,
+    const TranscodeOptions& options = TranscodeOptions());
+
+/**
+ * How pcap_to_osf() writes the scans of the pcap file.
+ */
+struct OUSTER_API_CLASS PcapToOsfOptions {
+    /**
+     * The fields of the scans to keep, all if empty.
+     */
+    std::vector<std::string> fields{};
+
+    /**
+     * How to encode the scans, the default of Writer if not provided. Scans
+     * are encoded on its thread pool.
+     */
+    std::shared_ptr<Encoder> encoder{};
+
+    /**
+     * The chunk size of the OSF file, the default of Writer if 0.
+     */
+    uint32_t chunk_size{0};
+
+    /**
+     * Scans being encoded or waiting to be written, at least 1.
+     */
+    size_t max_in_flight{10};
+
+    /**
+     * Lidar packets queued per sensor before reading the pcap file waits on
+     * batching, at least 1.
+     */
+    size_t queue_size{256};
+
+    /**
+     * Operations applied to the scans before they are encoded.
+     */
+    ScanOps ops{};
+
+    /**
+     * Stop converting at the first scan timestamped before an earlier scan
+     * of its sensor, as `ouster-cli ... save` does without `-c`, instead of
+     * dropping it.
+     */
+    bool stop_on_backwards_ts{false};
+};
+
+/**
+ * Convert the lidar packets of a pcap file to the LidarScans of a new OSF
+ * file without going through Python.
+ *
+ * The pcap file is read through a file mapping by IndexedPcapReader, the
+ * packets of each sensor are batched into scans on a thread of their own by
+ * ParallelScanBatcher, and the scans are encoded with AsyncWriter on the
+ * thread pool of the encoder while earlier ones are written, so that the
+ * stages overlap and encoding scales with the threads of the pool.
+ *
+ * Scans are timestamped with the capture timestamp of their first valid
+ * packet, as `ouster-cli source PCAP save OSF` does by default. Scans
+ * timestamped before an earlier scan of the same sensor, which OSF doesn't
+ * support, unless stop_on_backwards_ts is set, and incomplete scans at the
+ * end of the file are dropped. The ops see the scans of each sensor in the
+ * order they were batched, before their timestamps are checked.
+ *
+ * @throws std::invalid_argument Exception on no sensors or on ops that don't
+ *                               fit them.
+ * @throws std::runtime_error Exception on a pcap file that can't be read or
+ *                            a requested field missing from the scans.
+ *
+ * @param[in] pcap_file The pcap file to convert.
+ * @param[in] infos The metadata of the sensors in the pcap file, with the
+ *                  ports of their lidar packets, which become the sensors of
+ *                  the OSF file in the same order.
+ * @param[in] output_file_name The OSF file to write, overwritten if exists.
+ * @param[in] options How to write the scans.
+ * @return The size of the written OSF file.
+ */
+OUSTER_API_FUNCTION
+int64_t pcap_to_osf(const std::string& pcap_file,
+                    const std::vector<ouster::sensor::sensor_info>& infos,
+                    const std::string& output_file_name,
+                    const PcapToOsfOptions& options = PcapToOsfOptions());
+
+/**
+ * A candidate encoding of the fields of scans measured by bench_osf_file().
+ */
+struct OUSTER_API_CLASS BenchEncoder {
+    /**
+     * The encoder, "png" for PngLidarScanEncoder or "zstd" for
+     * ZstdLidarScanEncoder.
+     */
+    std::string codec{"png"};
+    /**
+     * The compression level of the encoder.
+     */
+    int level{1};
+};
+
+/**
+ * What bench_osf_file() measures.
+ */
+struct OUSTER_API_CLASS BenchOptions {
+    /**
+     * The first scans of the file to measure the decoding of each field and
+     * the candidate encoders on, all if 0.
+     */
+    size_t scans{100};
+    /**
+     * The fields to measure, all if empty.
+     */
+    std::vector<std::string> fields{};
+    /**
+     * The candidate encoders to measure on each field.
+     */
+    std::vector<BenchEncoder> encoders{
+        {"png", 1}, {"png", 6}, {"zstd", 1}, {"zstd", 3}, {"zstd", 9}};
+    /**
+     * The pool decoding scans ahead in the parallel pass, the default pool if
+     * not provided.
+     */
+    std::shared_ptr<ThreadPool> thread_pool{};
+};
+
+/**
+ * The decoding cost of a field of the scans of an OSF file.
+ */
+struct OUSTER_API_CLASS FieldDecodeBench {
+    std::string field{};   ///< The name of the field.
+    size_t scans{0};       ///< The scans it was decoded from.
+    uint64_t bytes{0};     ///< The decoded bytes.
+    double seconds{0};     ///< The time spent decoding.
+};
+
+/**
+ * The encoding cost and compression of a field by a candidate encoder.
+ */
+struct OUSTER_API_CLASS FieldEncodeBench {
+    std::string field{};         ///< The name of the field.
+    BenchEncoder encoder{};      ///< The encoder measured.
+    size_t scans{0};             ///< The scans it was encoded from.
+    uint64_t raw_bytes{0};       ///< The bytes of the field in the scans.
+    uint64_t encoded_bytes{0};   ///< The bytes once encoded.
+    double seconds{0};           ///< The time spent encoding.
+};
+
+/**
+ * The measurements of bench_osf_file(). Bandwidths and rates are the bytes
+ * or scans over the seconds.
+ */
+struct OUSTER_API_CLASS OsfBench {
+    size_t chunks{0};             ///< The chunks of the file.
+    uint64_t chunk_bytes{0};      ///< The bytes of the chunks.
+    double read_seconds{0};       ///< The time spent reading the chunks.
+    double crc_seconds{0};        ///< The time spent checking their CRCs.
+    size_t invalid_chunks{0};     ///< The chunks failing their CRC check.
+    std::vector<FieldDecodeBench> decode{};  ///< Per field decoding.
+    std::vector<FieldEncodeBench> encode{};  ///< Per field and encoder.
+    size_t scans{0};  ///< The scans decoded end to end, in each pass.
+    /**
+     * The time reading and decoding every scan one after the other, as
+     * iterating Reader::messages() does.
+     */
+    double sequential_seconds{0};
+    /**
+     * The time reading and decoding every scan with ScanReadAhead, on the
+     * thread pool of the options.
+     */
+    double parallel_seconds{0};
+};
+
+/**
+ * Measure the I/O and codec costs of an OSF file, to pick its compression
+ * settings on data rather than by trial and error on whole recordings:
+ * - the bandwidth of reading its chunks and the cost of checking their CRCs,
+ *   over every chunk, through the default file backend, so from the page
+ *   cache when the file was read recently;
+ * - the time decoding each field, and the size and encoding time of each
+ *   field with each candidate encoder, over the first scans;
+ * - the scans per second decoded end to end, one after the other and with
+ *   parallel decoding, over every scan.
+ *
+ * @throws std::logic_error Exception on a file that isn't a valid OSF file.
+ * @throws std::invalid_argument Exception on an unknown encoder.
+ *
+ * @param[in] file_name The OSF file to measure.
+ * @param[in] options What to measure.
+ * @return The measurements.
+ */
+OUSTER_API_FUNCTION
+OsfBench bench_osf_file(const std::string& file_name,
+                        const BenchOptions& options = BenchOptions());
+
 }  // namespace osf
 }  // namespace ouster
@@ -4,7 +4,11 @@
  */
 #pragma once
 
+#include <map>
+#include <memory>
+
 #include "ouster/osf/lidarscan_encoder.h"
+#include "ouster/osf/thread_pool.h"
 #include "ouster/visibility.h"
 
 namespace ouster {
@@ -13,23 +17,98 @@ namespace osf {
 /**
  * @brief used to configure the osf::Writer class.
  *
- * Right now it only contains a shared ptr to a LidarScanEncoder,
- * but in the future it may contain other items to allow parts of the OSF
- * encoding to vary independently.
+ * It contains a shared ptr to a LidarScanEncoder, optionally overridden per
+ * stream, and optionally the ThreadPool to encode the fields of scans on, to
+ * allow parts of the OSF encoding to vary independently.
  */
 class OUSTER_API_CLASS Encoder {
    public:
+    /**
+     * @param[in] lidar_scan_encoder The encoder of the fields of scans.
+     * @param[in] thread_pool The pool to encode fields on, shared with other
+     *                        Writers and Readers as desired. Uses
+     *                        default_thread_pool() if not provided.
+     */
     OUSTER_API_FUNCTION
-    Encoder(const std::shared_ptr<LidarScanEncoder>& lidar_scan_encoder)
-        : lidar_scan_encoder_{lidar_scan_encoder} {}
+    Encoder(const std::shared_ptr<LidarScanEncoder>& lidar_scan_encoder,
+            std::shared_ptr<ThreadPool> thread_pool = nullptr)
+        : lidar_scan_encoder_{lidar_scan_encoder},
+          thread_pool_{std::move(thread_pool)} {}
 
     OUSTER_API_FUNCTION
     LidarScanEncoder& lidar_scan_encoder() const {
         return *lidar_scan_encoder_;
     }
 
+    /**
+     * Encode the scans of one stream with another encoder, e.g. a fast
+     * ZstdLidarScanEncoder for a high rate sensor. Only affects streams
+     * created after the call, i.e. call it before saving the first scan of
+     * the stream.
+     *
+     * @param[in] stream_index The index of the sensor_info of the stream in
+     *                         the Writer.
+     * @param[in] lidar_scan_encoder The encoder of the fields of its scans.
+     */
+    OUSTER_API_FUNCTION
+    void set_lidar_scan_encoder(
+        uint32_t stream_index,
+        const std::shared_ptr<LidarScanEncoder>& lidar_scan_encoder) {
+        stream_encoders_[stream_index] = lidar_scan_encoder;
+    }
+
+    /**
+     * Get the encoder of the scans of a stream.
+     *
+     * @param[in] stream_index The index of the sensor_info of the stream in
+     *                         the Writer.
+     * @return the encoder set for the stream, or the default one.
+     */
+    OUSTER_API_FUNCTION
+    LidarScanEncoder& lidar_scan_encoder(uint32_t stream_index) const {
+        auto it = stream_encoders_.find(stream_index);
+        return it != stream_encoders_.end() ? *it->second
+                                            : *lidar_scan_encoder_;
+    }
+
+    /**
+     * Store scans as groups of a full keyframe followed by delta frames that
+     * only hold the difference of the standard integer fields from the
+     * keyframe, which compresses much better for a static or slow moving
+     * sensor. Groups are never split across chunks, so each can be decoded
+     * on its own. Only affects streams created after the call.
+     *
+     * @param[in] keyframe_interval The number of scans in a group, 0 or 1 to
+     *                              store every scan as a keyframe.
+     */
+    OUSTER_API_FUNCTION
+    void set_keyframe_interval(uint32_t keyframe_interval) {
+        keyframe_interval_ = keyframe_interval;
+    }
+
+    /**
+     * Get the number of scans in a group of a keyframe and delta frames.
+     *
+     * @return the keyframe interval, 0 if every scan is a keyframe.
+     */
+    OUSTER_API_FUNCTION
+    uint32_t keyframe_interval() const { return keyframe_interval_; }
+
+    /**
+     * Get the pool to encode fields on.
+     *
+     * @return the pool given at construction, or default_thread_pool()
+     */
+    OUSTER_API_FUNCTION
+    std::shared_ptr<ThreadPool> thread_pool() const {
+        return thread_pool_ ? thread_pool_ : default_thread_pool();
+    }
+
    private:
     std::shared_ptr<LidarScanEncoder> lidar_scan_encoder_;
+    std::map<uint32_t, std::shared_ptr<LidarScanEncoder>> stream_encoders_;
+    std::shared_ptr<ThreadPool> thread_pool_;
+    uint32_t keyframe_interval_{0};
 };
 
 }  // namespace osf
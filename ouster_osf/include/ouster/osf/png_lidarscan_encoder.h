@@ -26,12 +26,45 @@ namespace osf {
  */
 static constexpr int DEFAULT_PNG_OSF_ZLIB_COMPRESSION_LEVEL = 1;
 
+/**
+ * PNG row filter applied to the images before compression.
+ */
+enum class PngFilter {
+    DEFAULT,  ///< libpng picks the best of all filters for each row
+    NONE,     ///< no filter, the fastest
+    SUB,      ///< difference from the pixel to the left
+    UP,       ///< difference from the pixel above
+    AVG,      ///< difference from the average of the left and above pixels
+    PAETH     ///< difference from the Paeth predictor
+};
+
+/**
+ * zlib strategy compressing the filtered images.
+ */
+enum class PngStrategy {
+    DEFAULT,       ///< libpng's choice, Z_FILTERED for filtered images
+    FILTERED,      ///< Z_FILTERED
+    HUFFMAN_ONLY,  ///< Z_HUFFMAN_ONLY, no string matching
+    RLE            ///< Z_RLE, runs only, much faster than string matching
+};
+
 class OUSTER_API_CLASS PngLidarScanEncoder
     : public ouster::osf::LidarScanEncoder {
    public:
+    /**
+     * @param[in] compression_amount The zlib compression level, 0 to 9.
+     * @param[in] filter The row filter, e.g. PngFilter::UP with
+     *                   PngStrategy::RLE encodes smooth range images over
+     *                   twice as fast as the defaults at a similar size.
+     * @param[in] strategy The zlib strategy.
+     */
     OUSTER_API_FUNCTION
-    PngLidarScanEncoder(int compression_amount)
-        : compression_amount_{compression_amount} {}
+    PngLidarScanEncoder(int compression_amount,
+                        PngFilter filter = PngFilter::DEFAULT,
+                        PngStrategy strategy = PngStrategy::DEFAULT)
+        : compression_amount_{compression_amount},
+          filter_{filter},
+          strategy_{strategy} {}
 
     // TODO these methods do essentially the same thing and should be
     // deduplicated. Standard fields are stored in destaggered form, but this
@@ -54,6 +87,8 @@ class OUSTER_API_CLASS PngLidarScanEncoder
 
    private:
     int compression_amount_{DEFAULT_PNG_OSF_ZLIB_COMPRESSION_LEVEL};
+    PngFilter filter_{PngFilter::DEFAULT};
+    PngStrategy strategy_{PngStrategy::DEFAULT};
 
     /**
      * @defgroup OSFPngEncode8 Encoding Functionality.
@@ -0,0 +1,217 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file read_ahead.h
+ * @brief Decodes the LidarScans of an OSF file ahead of the consumer
+ */
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/osf/basics.h"
+#include "ouster/osf/reader.h"
+#include "ouster/osf/thread_pool.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace osf {
+
+/**
+ * How far ScanReadAhead reads ahead of the consumer.
+ */
+struct OUSTER_API_CLASS ReadAheadOptions {
+    /**
+     * Scans decoded ahead of the consumer, 0 for one more than the threads of
+     * the pool so that all of them are kept busy. Each holds a decoded scan
+     * in memory.
+     */
+    size_t scans{0};
+
+    /**
+     * Chunks of each stream, past the one holding the last scan decoded, that
+     * the OS is asked to read into the page cache, 0 to not prefetch. Files
+     * read with FileBackend::HTTP fetch them in the background instead, and
+     * STREAM files aren't prefetched.
+     */
+    size_t chunks{2};
+
+    /**
+     * Pool to decode on, default_thread_pool() if not provided.
+     */
+    std::shared_ptr<ThreadPool> thread_pool{};
+};
+
+/**
+ * A scan decoded by ScanReadAhead.
+ */
+struct OUSTER_API_CLASS DecodedScan {
+    uint32_t stream_id{0};  ///< stream id of the message
+    ts_t ts{0};             ///< receive timestamp of the message
+    /** The scan, nullptr if the message couldn't be decoded. */
+    std::unique_ptr<LidarScan> scan{};
+};
+
+/**
+ * Reads the LidarScans of a range of messages, in the order of
+ * Reader::messages(), decoding the next scans on a thread pool while the
+ * consumer works on the current one.
+ *
+ * Messages are iterated and their chunks verified on the calling thread,
+ * which asks the OS to read the chunks ahead with madvise(MADV_WILLNEED),
+ * so that neither waits on the disk. Messages of other than LidarScanStream
+ * streams are skipped. The Reader must outlive the ScanReadAhead and not be
+ * used from other threads while it reads, other than by the ranges of
+ * Reader::stream_messages() and ScanReadAheads of other single streams.
+ *
+ * The messages at the same timestamp of the streams of a sensor with several
+ * streams, written by Writer::set_columnar(), are merged into a single scan
+ * with the stream id of the first of them. Streams of such a sensor holding
+ * none of the fields to decode aren't read.
+ */
+class OUSTER_API_CLASS ScanReadAhead {
+   public:
+    /**
+     * @param[in] reader The reader of the file.
+     * @param[in] stream_ids The streams to read, all if empty.
+     * @param[in] start_ts The lowest timestamp to read.
+     * @param[in] end_ts The highest timestamp to read.
+     * @param[in] fields The fields to decode, all if empty.
+     * @param[in] options How far to read ahead.
+     */
+    OUSTER_API_FUNCTION
+    ScanReadAhead(Reader& reader, const std::vector<uint32_t>& stream_ids,
+                  ts_t start_ts, ts_t end_ts,
+                  const std::vector<std::string>& fields = {},
+                  const ReadAheadOptions& options = ReadAheadOptions());
+
+    /**
+     * Waits for the scans being decoded.
+     */
+    OUSTER_API_FUNCTION
+    ~ScanReadAhead();
+
+    ScanReadAhead(const ScanReadAhead&) = delete;
+    ScanReadAhead& operator=(const ScanReadAhead&) = delete;
+
+    /**
+     * Get the next scan, waiting for it to be decoded.
+     *
+     * @throws the exception thrown decoding the scan.
+     *
+     * @param[out] scan The next scan.
+     * @return false if there are no more scans.
+     */
+    OUSTER_API_FUNCTION
+    bool next(DecodedScan& scan);
+
+   private:
+    /**
+     * A message of a stream of a columnar sensor.
+     */
+    struct OUSTER_API_IGNORE Part {
+        MessageRef msg;
+        uint64_t chunk_offset;
+        size_t msg_idx;
+    };
+
+    /**
+     * A scan queued for decoding.
+     */
+    struct OUSTER_API_IGNORE Pending {
+        DecodedScan result;
+        std::exception_ptr error;
+        bool decoded{false};
+        /** The messages merged into the scan of a columnar sensor. */
+        std::vector<Part> parts;
+    };
+
+    /**
+     * Queue messages for decoding until options_.scans are pending.
+     */
+    void fill();
+
+    /**
+     * Add a message to the scan of its columnar sensor at its timestamp,
+     * queueing the scans of the sensor that are complete.
+     *
+     * @param[in] first The first stream of the sensor.
+     * @param[in] part The message.
+     * @return true if a scan was queued for decoding.
+     */
+    bool add_part(uint32_t first, Part part);
+
+    /**
+     * Queue the scan of a columnar sensor for decoding.
+     *
+     * @param[in] item The scan.
+     */
+    void submit(const std::shared_ptr<Pending>& item);
+
+    /**
+     * Prefetch the chunks of the streams following the timestamp.
+     *
+     * @param[in] ts The timestamp of the last queued message.
+     */
+    void prefetch(ts_t ts);
+
+    Reader& reader_;
+    std::vector<uint32_t> stream_ids_;
+    ts_t end_ts_;
+    std::vector<std::string> fields_;
+    ReadAheadOptions options_;
+
+    MessagesStreamingRange range_;
+    MessagesStreamingIter it_;
+    MessagesStreamingIter end_;
+
+    /**
+     * Scans in message order, decoded out of order on the pool. Only touched
+     * by the calling thread, the decoded flags are guarded by mutex_.
+     */
+    std::deque<std::shared_ptr<Pending>> pending_;
+    std::mutex mutex_;
+    std::condition_variable decoded_;
+    size_t in_flight_{0};
+
+    /**
+     * Offsets of the chunks already prefetched.
+     */
+    std::set<uint64_t> prefetched_;
+
+    /**
+     * The first stream of its sensor of every stream of a columnar sensor.
+     */
+    std::map<uint32_t, uint32_t> column_of_;
+
+    /**
+     * The number of streams read of each columnar sensor, by its first
+     * stream.
+     */
+    std::map<uint32_t, size_t> columns_;
+
+    /**
+     * The fields to decode of the streams of columnar sensors, all if empty.
+     */
+    std::map<uint32_t, std::vector<std::string>> column_fields_;
+
+    /**
+     * Scans of columnar sensors still missing some of their streams, by
+     * first stream and timestamp.
+     */
+    std::map<std::pair<uint32_t, ts_t>, std::shared_ptr<Pending>> open_;
+};
+
+}  // namespace osf
+}  // namespace ouster
@@ -8,10 +8,15 @@
  */
 #pragma once
 
+#include <functional>
+#include <mutex>
 #include <queue>
 #include <unordered_map>
+#include <vector>
 
+#include "ouster/array_view.h"
 #include "ouster/osf/file.h"
+#include "ouster/osf/meta_streaming_info.h"
 #include "ouster/osf/metadata.h"
 #include "ouster/types.h"
 #include "ouster/visibility.h"
@@ -130,6 +135,15 @@ struct OUSTER_API_CLASS ChunkInfoNode {
      *   fb/metadata.fbs :: ChunkOffset :: message_count
      */
     uint32_t message_start_idx;
+
+    /**
+     * The summary of the messages of the chunk, empty if the chunk was
+     * written without one.
+     *
+     * Flat Buffer Reference:
+     *   fb/streaming/streaming_info.fbs :: ChunkInfo :: summary
+     */
+    ChunkSummary summary;
 };
 
 /**
@@ -174,9 +188,11 @@ class OUSTER_API_CLASS ChunksPile {
      * @param[in] offset The offset for the chunk.
      * @param[in] stream_id The stream_id associated.
      * @param[in] message_count The number of messages.
+     * @param[in] summary The summary of the messages.
      */
     OUSTER_API_FUNCTION
-    void add_info(uint64_t offset, uint32_t stream_id, uint32_t message_count);
+    void add_info(uint64_t offset, uint32_t stream_id, uint32_t message_count,
+                  const ChunkSummary& summary = ChunkSummary());
 
     /**
      * Return the streaming info associated with an offset.
@@ -208,6 +224,30 @@ class OUSTER_API_CLASS ChunksPile {
     OUSTER_API_FUNCTION
     ChunkState* get_by_lower_bound_ts(uint32_t stream_id, const ts_t ts);
 
+    /**
+     * Add the receive timestamps of all the messages of a stream, in message
+     * order, to seek to a timestamp within the chunks of the stream.
+     *
+     * @param[in] stream_id The stream of the messages.
+     * @param[in] timestamps The receive timestamps of its messages.
+     */
+    OUSTER_API_FUNCTION
+    void add_timestamps(uint32_t stream_id,
+                        const std::vector<uint64_t>& timestamps);
+
+    /**
+     * Return the index of the first message of a stream with a timestamp not
+     * lower than ts, binary searched in the timestamps of add_timestamps().
+     *
+     * @param[in] stream_id The stream to look for messages in.
+     * @param[in] ts The lower bound for the message timestamp.
+     * @return The message index, or nullopt if the stream has no timestamps
+     *         or all of its messages are before ts.
+     */
+    OUSTER_API_FUNCTION
+    nonstd::optional<uint32_t> message_idx_by_lower_bound_ts(
+        uint32_t stream_id, const ts_t ts) const;
+
     /**
      * Return the next chunk identified by the offset.
      *
@@ -283,6 +323,12 @@ class OUSTER_API_CLASS ChunksPile {
      * is present).
      */
     StreamChunksMap stream_chunks_{};
+
+    /**
+     * Receive timestamps of the messages per stream id (only when the
+     * StreamStats hold them for every message).
+     */
+    std::unordered_map<uint32_t, std::vector<uint64_t>> stream_timestamps_{};
 };
 
 /**
@@ -303,6 +349,13 @@ std::string to_string(const ChunkState& chunk_state);
 OUSTER_API_FUNCTION
 std::string to_string(const ChunkInfoNode& chunk_info);
 
+/**
+ * Predicate on the summary of a chunk, deciding whether the messages of the
+ * chunk are read, see Reader::messages(). Returning false skips the chunk
+ * without reading or decoding it.
+ */
+using ChunkFilter = std::function<bool(const ChunkSummary&)>;
+
 // Forward Decls
 class Reader;
 class MessageRef;
@@ -312,6 +365,8 @@ class ChunksRange;
 struct MessagesStreamingIter;
 struct MessagesChunkIter;
 class MessagesStreamingRange;
+class ScanReadAhead;
+struct ReaderCache;
 
 /**
  * Chunk forward iterator in order of offset.
@@ -501,9 +556,71 @@ class OUSTER_API_CLASS ChunksRange {
     friend class Reader;
 };  // ChunksRange
 
+/**
+ * Memory bounds of the caches of a Reader, shared by all of its iterators and
+ * ScanReadAheads, e.g. for random access to the same scans.
+ */
+struct OUSTER_API_CLASS ReaderCacheOptions {
+    /**
+     * Bytes of verified chunks kept in memory, 0 to not cache them. Only the
+     * chunks of files that aren't memory mapped are read into buffers and
+     * cached, mapped ones are left to the page cache.
+     */
+    uint64_t chunk_bytes{0};
+
+    /**
+     * Bytes of LidarScans decoded by ScanReadAhead kept in memory, 0 to not
+     * cache them. A scan is cached per message and set of fields decoded.
+     */
+    uint64_t scan_bytes{0};
+};
+
+/**
+ * The index of the messages of a stream, gathered from the StreamStats and the
+ * chunk infos of the StreamingInfo without reading any chunk, e.g. to count,
+ * seek in or draw a timeline of the messages of a large file.
+ */
+struct OUSTER_API_CLASS StreamIndex {
+    uint32_t stream_id{0};      ///< The stream.
+    uint64_t message_count{0};  ///< The number of messages of the stream.
+
+    /**
+     * The receive timestamp of every message, empty unless the StreamStats
+     * hold one per message, see Reader::has_timestamp_idx().
+     */
+    std::vector<uint64_t> timestamps;
+
+    /**
+     * The offsets of the chunks of the stream in order, empty unless the
+     * chunk infos have message counts, see Reader::has_message_idx().
+     */
+    std::vector<uint64_t> chunk_offsets;
+
+    /**
+     * The index of the first message of the stream in each chunk of
+     * chunk_offsets.
+     */
+    std::vector<uint32_t> chunk_message_starts;
+
+    /**
+     * Find the chunk holding a message by binary search.
+     *
+     * @throws std::out_of_range if the message isn't in chunk_offsets.
+     *
+     * @param[in] message_idx The index of the message in the stream.
+     * @return The offset of its chunk.
+     */
+    OUSTER_API_FUNCTION
+    uint64_t chunk_offset(uint32_t message_idx) const;
+};
+
 /**
  * %OSF Reader that simply reads sequentially messages from the OSF file.
  *
+ * A Reader is used from one thread at a time, except for the ranges of
+ * stream_messages(), which can be iterated, and their messages decoded, on
+ * separate threads.
+ *
  * @todo Add filtered reads, and other nice things...
  */
 class OUSTER_API_CLASS Reader {
@@ -524,6 +641,16 @@ class OUSTER_API_CLASS Reader {
     OUSTER_API_FUNCTION
     Reader(const std::string& file);
 
+    /**
+     * Creates reader from %OSF file name, reading it as set by the options,
+     * e.g. with FileBackend::PREAD for files on network file systems.
+     *
+     * @param[in] file The OSF file path to read from.
+     * @param[in] options How to read the file.
+     */
+    OUSTER_API_FUNCTION
+    Reader(const std::string& file, const FileOptions& options);
+
     /**
      * Reads the messages from the first OSF chunk in sequental order
      * till the end. Doesn't support RandomAccess.
@@ -561,6 +688,52 @@ class OUSTER_API_CLASS Reader {
     MessagesStreamingRange messages(const std::vector<uint32_t>& stream_ids,
                                     const ts_t start_ts, const ts_t end_ts);
 
+    /**
+     * @copydoc messages(const std::vector<uint32_t>& stream_ids,
+     *          const ts_t start_ts, const ts_t end_ts)
+     * @param[in] filter Skips the chunks whose summaries it rejects, e.g.
+     *                   the chunks of scans out of a region:
+     * @code{.cpp}
+     * reader.messages({}, reader.start_ts(), reader.end_ts(),
+     *                 [](const ChunkSummary& s) {
+     *                     return !s.pose || (*s.pose)[0].max > 100.0;
+     *                 });
+     * @endcode
+     * Chunks written without summaries are always read, see
+     * Writer::set_chunk_summaries().
+     */
+    OUSTER_API_FUNCTION
+    MessagesStreamingRange messages(const std::vector<uint32_t>& stream_ids,
+                                    const ts_t start_ts, const ts_t end_ts,
+                                    ChunkFilter filter);
+
+    /**
+     * Reads the messages of each stream through a range of its own, e.g. to
+     * process the streams independently when their global order isn't
+     * needed. The ranges of different streams can be iterated on separate
+     * threads, each with its own ScanReadAhead or decoding.
+     *
+     * @throws std::logic_error Exception on not having sensor_info.
+     *
+     * @param[in] stream_ids The streams to read, all if empty.
+     * @param[in] start_ts The lowest timestamp to read.
+     * @param[in] end_ts The highest timestamp to read.
+     * @return One range per stream, in the order of stream_ids or of the
+     *         stream ids if empty.
+     */
+    OUSTER_API_FUNCTION
+    std::vector<MessagesStreamingRange> stream_messages(
+        const std::vector<uint32_t>& stream_ids, const ts_t start_ts,
+        const ts_t end_ts);
+
+    /**
+     * @copydoc stream_messages(const std::vector<uint32_t>& stream_ids,
+     *          const ts_t start_ts, const ts_t end_ts)
+     */
+    OUSTER_API_FUNCTION
+    std::vector<MessagesStreamingRange> stream_messages(
+        const std::vector<uint32_t>& stream_ids = {});
+
     /**
      * Find the timestamp of the message by its index and stream_id.
      *
@@ -579,6 +752,39 @@ class OUSTER_API_CLASS Reader {
     nonstd::optional<ts_t> ts_by_message_idx(uint32_t stream_id,
                                              uint32_t message_idx);
 
+    /**
+     * Get the index of the messages of a stream in one call, from the
+     * metadata only.
+     *
+     * @throws std::logic_error Exception on not having sensor_info.
+     *
+     * @param[in] stream_id The stream.
+     * @return The index, empty for a stream without messages.
+     */
+    OUSTER_API_FUNCTION
+    StreamIndex stream_index(uint32_t stream_id) const;
+
+    /**
+     * Collate the messages of several streams into frames holding at most
+     * one message per stream by their receive timestamps, from the metadata
+     * only, the same way as ScanCollator collates their scans. The frames of
+     * a file can then be counted and seeked to without reading it.
+     *
+     * @throws std::logic_error Exception on not having sensor_info or if a
+     *                          stream has no timestamp index.
+     *
+     * @param[in] stream_ids The streams, in the order of the frame slots.
+     * @param[in] dt The max time difference in ns between the messages of a
+     *               frame.
+     * @return For every frame in order, the index of the message of each
+     *         stream in it, -1 if it has none, i.e. stream_ids.size() values
+     *         per frame.
+     */
+    OUSTER_API_FUNCTION
+    std::vector<int64_t> collate_messages(
+        const std::vector<uint32_t>& stream_ids,
+        int64_t dt = 210000000) const;
+
     /**
      * Whether OSF contains the message counts that are needed for
      * ``ts_by_message_idx()``
@@ -652,6 +858,23 @@ class OUSTER_API_CLASS Reader {
     OUSTER_API_FUNCTION
     bool has_stream_info() const;
 
+    /**
+     * Set the memory bounds of the caches, evicting the least recently used
+     * chunks and scans past them. Nothing is cached by default.
+     *
+     * @param[in] options The bounds of the caches.
+     */
+    OUSTER_API_FUNCTION
+    void set_cache(const ReaderCacheOptions& options);
+
+    /**
+     * Get the memory bounds of the caches.
+     *
+     * @return The bounds of the caches.
+     */
+    OUSTER_API_FUNCTION
+    ReaderCacheOptions cache_options() const;
+
    private:
     /**
      * Read, parse and store all of the flatbuffer related metadata.
@@ -660,13 +883,29 @@ class OUSTER_API_CLASS Reader {
      */
     void read_metadata();
 
+    /**
+     * Store the chunk states of the metadata chunks[] and link them by
+     * offset.
+     */
+    void read_chunks_states() const;
+
     /**
      * Verify, store and link all streaming info indicies
      * i.e. StreamingInfo.chunks[] information
      *
      * @throws std::logic_error Exception on invalid chunk size.
      */
-    void read_chunks_info();
+    void read_chunks_info() const;
+
+    /**
+     * Get the chunks, indexing them on first use when opened with
+     * FileOptions::lazy_open.
+     *
+     * @throws std::logic_error Exception on invalid chunks info.
+     *
+     * @return The chunks of the file.
+     */
+    ChunksPile& chunks_pile() const;
 
     /**
      * Checks the flatbuffers validity of a chunk by chunk offset.
@@ -676,6 +915,15 @@ class OUSTER_API_CLASS Reader {
      */
     bool verify_chunk(uint64_t chunk_offset);
 
+    /**
+     * Read a chunk through the chunk cache.
+     *
+     * @param[in] chunk_offset The offset of the chunk from the beginning of
+     *                         the chunks.
+     * @return The chunk, nullptr if the file is bad.
+     */
+    std::shared_ptr<ChunkBuffer> read_chunk(uint64_t chunk_offset);
+
     /**
      * Internal OsfFile object used to read the OSF file.
      */
@@ -689,9 +937,14 @@ class OUSTER_API_CLASS Reader {
 
     /**
      * Internal ChunksPile object to hold all of the
-     * chunks.
+     * chunks, only accessed through chunks_pile().
      */
-    ChunksPile chunks_{};
+    mutable ChunksPile chunks_{};
+
+    /**
+     * Set once chunks_ is indexed.
+     */
+    mutable std::once_flag chunks_indexed_;
 
     /**
      * Internal indicator of if this file has streaming info
@@ -709,10 +962,22 @@ class OUSTER_API_CLASS Reader {
      */
     std::vector<uint8_t> metadata_buf_{};
 
-    // NOTE: These classes need an access to private member `chunks_` ...
+    /**
+     * Caches of chunks and decoded scans.
+     */
+    std::shared_ptr<ReaderCache> cache_;
+
+    /**
+     * Guards the reads of file_ and the validity of the chunks, for the
+     * ranges of stream_messages() iterated on separate threads.
+     */
+    std::mutex file_mutex_;
+
+    // NOTE: These classes need an access to private member `chunks_pile()`
     friend class ChunkRef;
     friend struct ChunksIter;
     friend struct MessagesStreamingIter;
+    friend class ScanReadAhead;
 };  // Reader
 
 /**
@@ -748,6 +1013,22 @@ class OUSTER_API_CLASS MessageRef {
     MessageRef(const uint8_t* buf, const MetadataStore& meta_provider,
                std::shared_ptr<std::vector<uint8_t>> chunk_buf);
 
+    /**
+     * Create the MessageRef of a message of a chunk, which can also reach the
+     * messages preceding it in the chunk.
+     *
+     * @param[in] buf The buffer to use to make a MessageRef object.
+     * @param[in] meta_provider The metadata store that is used in types
+     *                          reconstruction
+     * @param[in,out] chunk_buf The pre-existing chunk buffer to use.
+     * @param[in] chunk_ptr The size prefixed chunk holding the message.
+     * @param[in] msg_idx The index of the message in the chunk.
+     */
+    OUSTER_API_FUNCTION
+    MessageRef(const uint8_t* buf, const MetadataStore& meta_provider,
+               std::shared_ptr<std::vector<uint8_t>> chunk_buf,
+               const uint8_t* chunk_ptr, size_t msg_idx);
+
     /**
      * Get the message stream id.
      *
@@ -819,7 +1100,7 @@ class OUSTER_API_CLASS MessageRef {
             return nullptr;
         }
 
-        return Stream::decode_msg(buffer(), *meta, meta_provider_);
+        return decode_stream_msg<Stream>(0, *this, *meta, meta_provider_);
     }
 
     template <typename Stream, typename T>
@@ -831,7 +1112,32 @@ class OUSTER_API_CLASS MessageRef {
             return nullptr;
         }
 
-        return Stream::decode_msg(buffer(), *meta, meta_provider_, t);
+        return decode_stream_msg<Stream>(0, *this, *meta, meta_provider_, t);
+    }
+
+    /**
+     * Reconstructs the underlying data into an existing object, e.g. a
+     * LidarScan reused from message to message, whose storage is reused when
+     * it already has the shape of the message.
+     *
+     * @tparam Stream The type of the target data.
+     * @param[in,out] obj The object to decode into, left partially decoded
+     *                    on failure.
+     * @param[in] fields The fields to decode, all if empty.
+     * @return Whether the message was decoded.
+     */
+    template <typename Stream>
+    bool decode_msg_into(typename Stream::obj_type& obj,
+                         const std::vector<std::string>& fields = {}) const {
+        auto meta = meta_provider_.get<typename Stream::meta_type>(id());
+
+        if (meta == nullptr) {
+            // Stream and metadata entry id is inconsistent
+            return false;
+        }
+
+        return Stream::decode_msg_into(*this, *meta, meta_provider_, obj,
+                                       fields);
     }
 
     /**
@@ -842,6 +1148,26 @@ class OUSTER_API_CLASS MessageRef {
     OUSTER_API_FUNCTION
     std::vector<uint8_t> buffer() const;
 
+    /**
+     * Get a view of the underlying raw message bytes in the chunk, without
+     * copying them as buffer() does. Valid while the chunk is, i.e. as long
+     * as this MessageRef or a copy of it.
+     *
+     * @return The view of the message bytes, empty if there are none.
+     */
+    OUSTER_API_FUNCTION
+    ConstArrayView1<uint8_t> view() const;
+
+    /**
+     * Get the closest preceding message of the same stream in the chunk, e.g.
+     * to find the keyframe of a delta frame.
+     *
+     * @return The preceding message, nullptr if there is none or the
+     *         MessageRef wasn't created from a chunk.
+     */
+    OUSTER_API_FUNCTION
+    std::unique_ptr<const MessageRef> previous() const;
+
     /**
      * Check if two MessageRefs are equal.
      *
@@ -861,6 +1187,26 @@ class OUSTER_API_CLASS MessageRef {
     bool operator!=(const MessageRef& other) const;
 
    private:
+    /**
+     * Decode with the Stream::decode_msg taking the MessageRef if there is
+     * one, for streams that need the other messages of the chunk, e.g. the
+     * keyframe of a delta frame.
+     */
+    template <typename Stream, typename... Args>
+    static auto decode_stream_msg(int, const MessageRef& msg, Args&... args)
+        -> decltype(Stream::decode_msg(msg, args...)) {
+        return Stream::decode_msg(msg, args...);
+    }
+
+    /**
+     * Decode with the Stream::decode_msg taking the message buffer.
+     */
+    template <typename Stream, typename... Args>
+    static std::unique_ptr<typename Stream::obj_type> decode_stream_msg(
+        long, const MessageRef& msg, Args&... args) {
+        return Stream::decode_msg(msg.buffer(), args...);
+    }
+
     /**
      * The internal raw byte array.
      */
@@ -875,6 +1221,16 @@ class OUSTER_API_CLASS MessageRef {
      * The internal chunk buffer to use.
      */
     std::shared_ptr<ChunkBuffer> chunk_buf_;
+
+    /**
+     * The chunk holding the message, if known.
+     */
+    const uint8_t* chunk_ptr_{nullptr};
+
+    /**
+     * The index of the message in the chunk.
+     */
+    size_t msg_idx_{0};
 };  // MessageRef
 
 /**
@@ -1242,10 +1598,11 @@ class OUSTER_API_CLASS MessagesStreamingRange {
      * @param[in] stream_ids The stream indicies to use with the streaming
      *                       range.
      * @param[in] reader The reader object to use for reading the OSF file.
+     * @param[in] filter The chunks to read by their summaries, all if empty.
      */
     MessagesStreamingRange(const ts_t start_ts, const ts_t end_ts,
                            const std::vector<uint32_t>& stream_ids,
-                           Reader* reader);
+                           Reader* reader, ChunkFilter filter = nullptr);
 
     /**
      * The lowest timestamp for the range.
@@ -1266,6 +1623,11 @@ class OUSTER_API_CLASS MessagesStreamingRange {
      * The reader object to use to read the OSF file.
      */
     Reader* reader_;
+
+    /**
+     * The chunks to read by their summaries, all if empty.
+     */
+    ChunkFilter filter_;
     friend class Reader;
 };  // MessagesStreamingRange
 
@@ -1389,16 +1751,24 @@ struct OUSTER_API_CLASS MessagesStreamingIter {
      * @param[in] stream_ids The stream indicies to use with the streaming
      *                       range.
      * @param[in] reader The reader object to use for reading the OSF file.
+     * @param[in] filter The chunks to read by their summaries, all if empty.
      */
     MessagesStreamingIter(const ts_t start_ts, const ts_t end_ts,
                           const std::vector<uint32_t>& stream_ids,
-                          Reader* reader);
+                          Reader* reader, ChunkFilter filter = nullptr);
 
     /**
      * Advance to the next message.
      */
     void next();
 
+    /**
+     * @param[in] offset The offset of a chunk.
+     * @return Whether the filter reads the chunk, always for chunks without
+     *         a summary.
+     */
+    bool accepts(uint64_t offset) const;
+
     /**
      * The current timestamp.
      */
@@ -1426,6 +1796,11 @@ struct OUSTER_API_CLASS MessagesStreamingIter {
      */
     Reader* reader_;
 
+    /**
+     * The chunks to read by their summaries, all if empty.
+     */
+    ChunkFilter filter_;
+
     /**
      * Priority queue used to hold the chunks in timestamp order.
      *
@@ -1436,6 +1811,7 @@ struct OUSTER_API_CLASS MessagesStreamingIter {
         curr_chunks_{};
     friend class Reader;
     friend class MessagesStreamingRange;
+    friend class ScanReadAhead;
 };  // MessagesStreamingIter
 
 }  // namespace osf
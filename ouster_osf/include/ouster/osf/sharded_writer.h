@@ -0,0 +1,173 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file sharded_writer.h
+ * @brief Writes the sensors of a recording into several OSF files at once
+ */
+#pragma once
+
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/osf/async_writer.h"
+#include "ouster/osf/multi_reader.h"
+#include "ouster/types.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace osf {
+
+/**
+ * How a ShardedWriter splits a recording into shards.
+ */
+struct OUSTER_API_CLASS ShardOptions {
+    /**
+     * The number of shards, 0 for a shard per sensor. Sensors are dealt to
+     * the shards in turn, and there are never more shards than sensors.
+     */
+    size_t shards{0};
+
+    /**
+     * The directories the shards are spread over in turn, e.g. one per disk.
+     * When empty the shards are written next to the manifest.
+     */
+    std::vector<std::string> dirs;
+};
+
+/**
+ * Writes the sensors of a recording into several OSF files, the shards, so
+ * that a recording of many sensors isn't limited by a single file and the
+ * thread writing it. Each shard is an AsyncWriter with a save thread of its
+ * own, and a shard manifest written up front lists the shards and their
+ * sensors.
+ *
+ * Every shard holds the metadata of all sensors, under the same ids, and the
+ * streams of its own sensors, under ids that no other shard uses, so that
+ * MultiReader reads the shards of the manifest as one recording:
+ * @code{.cpp}
+ * MultiReader reader(load_shard_manifest("recording.json"));
+ * @endcode
+ */
+class OUSTER_API_CLASS ShardedWriter {
+   public:
+    /**
+     * @param[in] manifest The shard manifest to write. The shards are named
+     *                     after it, e.g. recording.shard0.osf for
+     *                     recording.json.
+     * @param[in] info The sensor info vector of the recording.
+     * @param[in] options How to split the recording into shards.
+     * @param[in] fields_to_write The fields from scans to actually save, see
+     *                            AsyncWriter.
+     * @param[in] chunk_size The chunk size of the shards.
+     * @param[in] encoder An optional Encoder of all shards.
+     * @param[in] max_in_flight The maximum number of scans in flight in
+     *                          each shard, see AsyncWriter.
+     * @param[in] overflow What save() does when max_in_flight scans are in
+     *                     flight in the shard of the scan.
+     *
+     * @throws std::invalid_argument if info is empty.
+     * @throws std::runtime_error if a shard or the manifest can't be written.
+     */
+    OUSTER_API_FUNCTION
+    ShardedWriter(const std::string& manifest,
+                  const std::vector<ouster::sensor::sensor_info>& info,
+                  const ShardOptions& options = ShardOptions(),
+                  const std::vector<std::string>& fields_to_write =
+                      std::vector<std::string>(),
+                  uint32_t chunk_size = 0,
+                  std::shared_ptr<Encoder> encoder = nullptr,
+                  size_t max_in_flight = 10,
+                  AsyncWriter::OverflowPolicy overflow =
+                      AsyncWriter::OverflowPolicy::BLOCK);
+
+    /**
+     * Closes the shards if close() wasn't called.
+     */
+    OUSTER_API_FUNCTION
+    ~ShardedWriter();
+
+    ShardedWriter(const ShardedWriter&) = delete;
+    ShardedWriter& operator=(const ShardedWriter&) = delete;
+
+    /**
+     * Save a scan of a sensor into its shard, see AsyncWriter::save().
+     *
+     * @throws std::logic_error if the stream_index is out of bounds.
+     *
+     * @param[in] stream_index The index of the sensor_info of the sensor.
+     * @param[in] scan The scan to save.
+     * @return A future that resolves once the scan is written.
+     */
+    OUSTER_API_FUNCTION
+    std::future<void> save(uint32_t stream_index, const LidarScan& scan);
+
+    /**
+     * @copydoc save(uint32_t stream_index, const LidarScan& scan)
+     * @param[in] timestamp The receive timestamp of the scan.
+     */
+    OUSTER_API_FUNCTION
+    std::future<void> save(uint32_t stream_index, const LidarScan& scan,
+                           ouster::osf::ts_t timestamp);
+
+    /**
+     * Save a scan of each sensor, in the order of the sensor infos.
+     *
+     * @throws std::logic_error if there isn't a scan per sensor.
+     *
+     * @param[in] scans The scans to save.
+     * @return The futures of the scans.
+     */
+    OUSTER_API_FUNCTION
+    std::vector<std::future<void>> save(const std::vector<LidarScan>& scans);
+
+    /**
+     * Finish writing all shards.
+     */
+    OUSTER_API_FUNCTION
+    void close();
+
+    /**
+     * @return The shards and their sensors, as written to the manifest.
+     */
+    OUSTER_API_FUNCTION
+    const ShardManifest& manifest() const;
+
+    /**
+     * @return The number of shards.
+     */
+    OUSTER_API_FUNCTION
+    size_t shards() const;
+
+    /**
+     * @throws std::out_of_range if the stream_index is out of bounds.
+     *
+     * @param[in] stream_index The index of the sensor_info of a sensor.
+     * @return The shard of the sensor.
+     */
+    OUSTER_API_FUNCTION
+    size_t shard_of(uint32_t stream_index) const;
+
+    /**
+     * Get the writer of a shard, e.g. to set its chunk I/O or to read its
+     * stats.
+     *
+     * @throws std::out_of_range if the shard is out of bounds.
+     *
+     * @param[in] shard The index of the shard.
+     * @return The writer of the shard.
+     */
+    OUSTER_API_FUNCTION
+    AsyncWriter& shard(size_t shard);
+
+   private:
+    ShardManifest manifest_;
+    std::vector<size_t> shard_of_;
+    std::vector<std::unique_ptr<AsyncWriter>> shards_;
+};
+
+}  // namespace osf
+}  // namespace ouster
@@ -0,0 +1,61 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+#pragma once
+
+#include <memory>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/osf/lidarscan_encoder.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace osf {
+
+/**
+ * Encodes only the nonzero pixels of the fields of scans, such as the ones
+ * left by masking, clipping or cropping to a column window, with another
+ * encoder. Each field stores the bounding box of its nonzero pixels and,
+ * when most of the box is zero, a bitmap of the nonzero pixels and the
+ * pixels themselves instead of the box. Fields with nonzero pixels reaching
+ * every edge of the image and no more zeros than that are stored exactly as
+ * the other encoder stores them.
+ *
+ * Readers recognize sparse fields by their header and decode them alongside
+ * PNG, zstd and banded ones. The other encoder may be a
+ * BandedLidarScanEncoder, but not the other way around.
+ */
+class OUSTER_API_CLASS SparseLidarScanEncoder
+    : public ouster::osf::LidarScanEncoder {
+   public:
+    /**
+     * @param[in] encoder The encoder of the stored images, e.g. a
+     *                    PngLidarScanEncoder.
+     *
+     * @throws std::invalid_argument if encoder is null.
+     */
+    OUSTER_API_FUNCTION
+    explicit SparseLidarScanEncoder(std::shared_ptr<LidarScanEncoder> encoder);
+
+    // This method is for standard destaggered fields.
+    OUSTER_API_IGNORE
+    bool fieldEncode(const LidarScan& lidar_scan,
+                     const ouster::FieldType& field_type,
+                     const std::vector<int>& px_offset, ScanData& scan_data,
+                     size_t scan_idx) const override;
+
+    // This method is for custom fields.
+    OUSTER_API_IGNORE
+    ScanChannelData encodeField(const ouster::Field& field) const override;
+
+   private:
+    template <typename T>
+    bool encodeSparseImage(ScanChannelData& res_buf,
+                           const Eigen::Ref<const img_t<T>>& img) const;
+
+    std::shared_ptr<LidarScanEncoder> encoder_;
+};
+
+}  // namespace osf
+}  // namespace ouster
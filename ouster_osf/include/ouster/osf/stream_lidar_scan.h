@@ -8,8 +8,11 @@
  */
 #pragma once
 
+#include <memory>
+
 #include "ouster/osf/basics.h"
 #include "ouster/osf/meta_lidar_sensor.h"
+#include "ouster/osf/meta_streaming_info.h"
 #include "ouster/osf/metadata.h"
 #include "ouster/osf/writer.h"
 #include "ouster/visibility.h"
@@ -17,6 +20,8 @@
 namespace ouster {
 namespace osf {
 
+class MessageRef;
+
 /**
  * Cast `ls_src` LidarScan to a subset of fields with possible different
  * underlying ChanFieldTypes.
@@ -32,6 +37,18 @@ OUSTER_API_FUNCTION
 LidarScan slice_with_cast(const LidarScan& ls_src,
                           const ouster::LidarScanFieldTypes& field_types);
 
+/**
+ * Summarize a scan for the summary of its chunk, see ChunkSummary. Only the
+ * RANGE and REFLECTIVITY fields among the field types are summarized.
+ *
+ * @param[in] ls The LidarScan to summarize.
+ * @param[in] field_types The field types of the stream of the scan.
+ * @return The summary of the scan.
+ */
+OUSTER_API_FUNCTION
+ChunkSummary summarize_scan(const LidarScan& ls,
+                            const ouster::LidarScanFieldTypes& field_types);
+
 /**
  * Metadata entry for LidarScanStream to store reference to a sensor and
  * field_types
@@ -62,6 +79,15 @@ class OUSTER_API_CLASS LidarScanStreamMeta
     OUSTER_API_FUNCTION
     uint32_t sensor_meta_id() const;
 
+    /**
+     * Return the field types of the stream. Read from a file these are only
+     * its standard fields, custom fields aren't recorded in the metadata.
+     *
+     * @return The field types.
+     */
+    OUSTER_API_FUNCTION
+    const ouster::LidarScanFieldTypes& field_types() const;
+
     /**
      * @copydoc MetadataEntry::buffer
      */
@@ -143,6 +169,7 @@ class OUSTER_API_CLASS LidarScanStream
     : public MessageStream<LidarScanStreamMeta, LidarScan> {
    protected:
     friend class Writer;
+    friend class AsyncWriter;
     friend class MessageRef;
 
     // Access key pattern used to only allow friends to call our constructor
@@ -171,13 +198,8 @@ class OUSTER_API_CLASS LidarScanStream
     flatbuffers::Offset<gen::LidarScanMsg> create_lidar_scan_msg(
         flatbuffers::FlatBufferBuilder& fbb, const LidarScan& lidar_scan,
         const ouster::sensor::sensor_info& info,
-        const ouster::LidarScanFieldTypes meta_field_types) const;
-
-    void fieldEncodeMulti(const LidarScan& lidar_scan,
-                          const LidarScanFieldTypes& field_types,
-                          const std::vector<int>& px_offset,
-                          ScanData& scan_data,
-                          const std::vector<size_t>& scan_idxs) const;
+        const ouster::LidarScanFieldTypes meta_field_types,
+        bool delta_frame = false) const;
 
     ScanData scanEncodeFieldsSingleThread(
         const LidarScan& lidar_scan, const std::vector<int>& px_offset,
@@ -198,6 +220,38 @@ class OUSTER_API_CLASS LidarScanStream
      */
     std::vector<uint8_t> make_msg(const obj_type& lidar_scan);
 
+    /**
+     * Encode/serialize the object to the buffer of bytes.
+     *
+     * @param[in] lidar_scan The lidar scan to turn into a vector of bytes.
+     * @param[in] delta_frame Whether lidar_scan is the residual returned by
+     *                        delta_frame().
+     * @return The byte vector representation of lidar_scan.
+     */
+    std::vector<uint8_t> make_msg(const obj_type& lidar_scan,
+                                  bool delta_frame);
+
+    /**
+     * Encode/serialize the object into msg_buf, reusing its capacity.
+     *
+     * @param[in] lidar_scan The lidar scan to turn into a vector of bytes.
+     * @param[in] delta_frame Whether lidar_scan is the residual returned by
+     *                        delta_frame().
+     * @param[out] msg_buf The byte vector representation of lidar_scan.
+     */
+    void make_msg(const obj_type& lidar_scan, bool delta_frame,
+                  std::vector<uint8_t>& msg_buf);
+
+    /**
+     * Advance the group of keyframe and delta frames by one scan, which has
+     * to be saved next.
+     *
+     * @param[in] lidar_scan The lidar scan to save next.
+     * @return The residual of lidar_scan from the keyframe to save as a delta
+     *         frame, or nullptr if lidar_scan has to be saved as a keyframe.
+     */
+    std::unique_ptr<obj_type> delta_frame(const obj_type& lidar_scan);
+
     /**
      * Decode/deserialize the object from bytes buffer using the concrete
      * metadata type for the stream.
@@ -216,6 +270,46 @@ class OUSTER_API_CLASS LidarScanStream
         const MetadataStore& meta_provider,
         const std::vector<std::string>& fields = {});
 
+    /**
+     * Decode/deserialize the object from a message, which may be a delta
+     * frame that also needs the keyframe preceding it in the chunk.
+     *
+     * @param[in] msg The message to decode into an object.
+     * @param[in] meta The concrete metadata type to use for decoding.
+     * @param[in] meta_provider Used to reconstruct any references to other
+     *                          metadata entries dependencies
+     *                          (like sensor_meta_id)
+     * @param[in] fields List of fields to decode. All are decoded if none
+     *                   provided.
+     * @return Pointer to the decoded object.
+     */
+    static std::unique_ptr<obj_type> decode_msg(
+        const MessageRef& msg, const meta_type& meta,
+        const MetadataStore& meta_provider,
+        const std::vector<std::string>& fields = {});
+
+    /**
+     * Decode/deserialize a message into an existing object, like
+     * decode_msg(const MessageRef&, ...), reusing its fields when it already
+     * has the size and fields of the message so that decoding a sequence of
+     * messages into the same object allocates no scan storage.
+     *
+     * @param[in] msg The message to decode into an object.
+     * @param[in] meta The concrete metadata type to use for decoding.
+     * @param[in] meta_provider Used to reconstruct any references to other
+     *                          metadata entries dependencies
+     *                          (like sensor_meta_id)
+     * @param[in,out] lidar_scan The object to decode into, left partially
+     *                           decoded on failure.
+     * @param[in] fields List of fields to decode. All are decoded if none
+     *                   provided.
+     * @return Whether the message was decoded.
+     */
+    static bool decode_msg_into(const MessageRef& msg, const meta_type& meta,
+                                const MetadataStore& meta_provider,
+                                obj_type& lidar_scan,
+                                const std::vector<std::string>& fields = {});
+
    public:
     /**
      * @param[in] key Private class used to prevent non-friends from calling
@@ -223,10 +317,14 @@ class OUSTER_API_CLASS LidarScanStream
      * @param[in] writer The writer object to use to write messages out.
      * @param[in] sensor_meta_id The sensor to use.
      * @param[in] field_types LidarScan fields specs, this argument is optional.
+     * @param[in] lidar_scan_encoder The encoder of the fields of scans, the
+     *                               one of the writer's Encoder if not
+     *                               provided.
      */
     OUSTER_API_FUNCTION
     LidarScanStream(Token key, Writer& writer, const uint32_t sensor_meta_id,
-                    const ouster::LidarScanFieldTypes& field_types = {});
+                    const ouster::LidarScanFieldTypes& field_types = {},
+                    const LidarScanEncoder* lidar_scan_encoder = nullptr);
 
     /**
      * Return the concrete metadata type.
@@ -237,6 +335,14 @@ class OUSTER_API_CLASS LidarScanStream
     OUSTER_API_FUNCTION
     const meta_type& meta() const { return meta_; };
 
+    /**
+     * Return the id of the stream, to which its messages are saved.
+     *
+     * @return The stream id.
+     */
+    OUSTER_API_FUNCTION
+    uint32_t stream_id() const { return stream_meta_id_; }
+
    private:
     /**
      * The internal writer object to use to write messages out.
@@ -267,6 +373,32 @@ class OUSTER_API_CLASS LidarScanStream
      * The internal field_types data.
      */
     ouster::LidarScanFieldTypes field_types_;
+
+    /**
+     * The encoder of the fields of scans.
+     */
+    const LidarScanEncoder* lidar_scan_encoder_;
+
+    /**
+     * The number of scans in a group of a keyframe and delta frames, 0 if
+     * every scan is a keyframe.
+     */
+    uint32_t keyframe_interval_;
+
+    /**
+     * The number of scans saved since the last keyframe.
+     */
+    uint32_t frames_since_keyframe_{0};
+
+    /**
+     * The message of the last scan saved, kept for its capacity.
+     */
+    std::vector<uint8_t> msg_buf_;
+
+    /**
+     * The last keyframe, the reference of the delta frames following it.
+     */
+    std::unique_ptr<obj_type> keyframe_;
 };
 
 }  // namespace osf
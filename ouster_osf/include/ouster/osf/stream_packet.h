@@ -0,0 +1,290 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file stream_packet.h
+ * @brief Stream of raw lidar and IMU packets, batched into scans on read
+ *
+ */
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/osf/basics.h"
+#include "ouster/osf/metadata.h"
+#include "ouster/osf/read_ahead.h"
+#include "ouster/osf/reader.h"
+#include "ouster/osf/writer.h"
+#include "ouster/packet.h"
+#include "ouster/types.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace osf {
+
+/**
+ * A packet of a PacketStream as it was received.
+ */
+struct OUSTER_API_CLASS RawPacket {
+    /// The type of the packet, lidar or IMU
+    ouster::sensor::PacketType type{ouster::sensor::PacketType::Unknown};
+    /// The receive timestamp of the packet, in ns
+    uint64_t host_timestamp{0};
+    /// The packet
+    std::vector<uint8_t> buf;
+};
+
+/**
+ * Metadata entry for a stream of the raw packets of a sensor.
+ *
+ * OSF type:
+ *   ouster/v1/os_sensor/PacketStream
+ *
+ * Flat Buffer Reference:
+ *   fb/os_sensor/packet_stream.fbs
+ */
+class OUSTER_API_CLASS PacketStreamMeta
+    : public MetadataEntryHelper<PacketStreamMeta> {
+   public:
+    /**
+     * @param[in] sensor_meta_id Reference to LidarSensor metadata of the
+     *                           sensor the packets came from.
+     * @param[in] compression_level The zstd level the packets are compressed
+     *                              with, 0 if they aren't.
+     */
+    OUSTER_API_FUNCTION
+    PacketStreamMeta(uint32_t sensor_meta_id, int compression_level = 0);
+
+    /**
+     * Return the sensor meta id.
+     *
+     * @return The sensor meta id.
+     */
+    OUSTER_API_FUNCTION
+    uint32_t sensor_meta_id() const;
+
+    /**
+     * Return the zstd level the packets are compressed with.
+     *
+     * @return The compression level, 0 if the packets aren't compressed.
+     */
+    OUSTER_API_FUNCTION
+    int compression_level() const;
+
+    /**
+     * @copydoc MetadataEntry::buffer
+     */
+    OUSTER_API_FUNCTION
+    std::vector<uint8_t> buffer() const final;
+
+    /**
+     * Create a PacketStreamMeta object from a byte array.
+     *
+     * @relates MetadataEntry::from_buffer
+     *
+     * @param[in] buf The raw flatbuffer byte vector to initialize from.
+     * @return The new PacketStreamMeta cast as a MetadataEntry
+     */
+    OUSTER_API_FUNCTION
+    static std::unique_ptr<MetadataEntry> from_buffer(
+        const std::vector<uint8_t>& buf);
+
+    /**
+     * Get the string representation for the PacketStreamMeta object.
+     *
+     * @relates MetadataEntry::repr
+     *
+     * @return The string representation for the PacketStreamMeta object.
+     */
+    OUSTER_API_FUNCTION
+    std::string repr() const override;
+
+   private:
+    /**
+     * Flat Buffer Reference:
+     *   fb/os_sensor/packet_stream.fbs :: PacketStream :: sensor_id
+     */
+    uint32_t sensor_meta_id_{0};
+
+    /**
+     * Flat Buffer Reference:
+     *   fb/os_sensor/packet_stream.fbs :: PacketStream :: compression_level
+     */
+    int compression_level_{0};
+};
+
+/** @defgroup OSFTraitsPacketStreamMeta Templated struct for traits */
+
+/**
+ * Templated struct for returning the OSF type string.
+ *
+ * @ingroup OSFTraitsPacketStreamMeta
+ */
+template <>
+struct OUSTER_API_CLASS MetadataTraits<PacketStreamMeta> {
+    /**
+     * Return the OSF type string.
+     *
+     * @return The OSF type string "ouster/v1/os_sensor/PacketStream".
+     */
+    OUSTER_API_FUNCTION
+    static const std::string type() {
+        return "ouster/v1/os_sensor/PacketStream";
+    }
+};
+
+/**
+ * Stream of the raw lidar and IMU packets of a sensor, recorded as they are
+ * received, like a pcap but chunked and indexed with the OSF metadata of the
+ * sensor. Saving a packet costs a copy and optionally a fast zstd pass,
+ * rather than batching and encoding scans while recording; PacketScanReader
+ * batches the packets into scans when reading.
+ */
+class OUSTER_API_CLASS PacketStream
+    : public MessageStream<PacketStreamMeta, RawPacket> {
+   protected:
+    friend class Writer;
+    friend class MessageRef;
+
+    // Access key pattern used to only allow friends to call our constructor
+    struct Token {};
+
+   public:
+    /**
+     * @param[in] key Private class used to only allow friends to construct.
+     * @param[in] writer The writer object to use to write packets out.
+     * @param[in] sensor_meta_id The sensor the packets came from.
+     * @param[in] compression_level The zstd level to compress the packets
+     *                              with, 0 to store them as they are.
+     */
+    OUSTER_API_FUNCTION
+    PacketStream(Token key, Writer& writer, uint32_t sensor_meta_id,
+                 int compression_level = 0);
+
+    /**
+     * Save a packet, indexed with its host timestamp.
+     *
+     * @throws std::invalid_argument if the packet type is unknown.
+     *
+     * @param[in] packet The packet to save.
+     */
+    OUSTER_API_FUNCTION
+    void save(const ouster::sensor::Packet& packet);
+
+    /**
+     * Encode a packet into the message buffer, reusing its capacity.
+     *
+     * @param[in] type The type of the packet.
+     * @param[in] buf The packet.
+     * @param[out] msg_buf The message.
+     */
+    OUSTER_API_FUNCTION
+    void make_msg(ouster::sensor::PacketType type,
+                  const std::vector<uint8_t>& buf,
+                  std::vector<uint8_t>& msg_buf);
+
+    /**
+     * Decode a message of the stream.
+     *
+     * @param[in] buf The message.
+     * @param[in] meta The metadata of the stream.
+     * @param[in] meta_provider The metadata store of the file.
+     * @return The packet, with a host timestamp of 0 since that is the
+     *         timestamp of the message, or nullptr if it can't be decoded.
+     */
+    OUSTER_API_FUNCTION
+    static std::unique_ptr<obj_type> decode_msg(
+        const std::vector<uint8_t>& buf, const meta_type& meta,
+        const MetadataStore& meta_provider);
+
+    /**
+     * Return the metadata of the stream.
+     *
+     * @return The metadata of the stream.
+     */
+    OUSTER_API_FUNCTION
+    const meta_type& meta() const { return meta_; }
+
+    /**
+     * Return the id of the stream.
+     *
+     * @return The id of the stream.
+     */
+    OUSTER_API_FUNCTION
+    uint32_t stream_id() const { return stream_meta_id_; }
+
+   private:
+    Writer& writer_;
+    meta_type meta_;
+    uint32_t stream_meta_id_{0};
+    // reused from packet to packet
+    std::vector<uint8_t> compressed_;
+    std::vector<uint8_t> msg_buf_;
+};
+
+/**
+ * Batches the packets of the PacketStreams of a file into scans, in the
+ * order of the messages of the file. A scan is complete once its last
+ * column or a packet of the next frame arrives; the partial scan at the end
+ * of a stream is dropped.
+ */
+class OUSTER_API_CLASS PacketScanReader {
+   public:
+    /**
+     * @throws std::invalid_argument if a stream isn't a PacketStream or its
+     *         sensor is missing.
+     *
+     * @param[in] reader The reader of the file, outliving this.
+     * @param[in] stream_ids The packet streams to batch, all of them if
+     *                       empty.
+     * @param[in] start_ts The start of the time range.
+     * @param[in] end_ts The end of the time range.
+     * @param[in] fields The fields to batch, those of the lidar profile of
+     *                   each sensor if empty.
+     */
+    OUSTER_API_FUNCTION
+    PacketScanReader(Reader& reader,
+                     const std::vector<uint32_t>& stream_ids = {},
+                     ts_t start_ts = ts_t::min(), ts_t end_ts = ts_t::max(),
+                     const std::vector<std::string>& fields = {});
+
+    /**
+     * Get the next scan.
+     *
+     * @param[out] scan The scan, with the id of its packet stream and the
+     *                  receive timestamp of its first packet.
+     * @return false once the packets of the time range are exhausted.
+     */
+    OUSTER_API_FUNCTION
+    bool next(DecodedScan& scan);
+
+    /**
+     * Return the ids of the streams being batched.
+     *
+     * @return The stream ids.
+     */
+    OUSTER_API_FUNCTION
+    const std::vector<uint32_t>& stream_ids() const;
+
+   private:
+    struct OUSTER_API_IGNORE Batch {
+        ouster::sensor::sensor_info info;
+        std::unique_ptr<ScanBatcher> batcher;
+        ouster::LidarScanFieldTypes field_types;
+        std::unique_ptr<LidarScan> scan;
+    };
+
+    std::vector<uint32_t> stream_ids_;
+    std::map<uint32_t, Batch> batches_;
+    MessagesStreamingRange range_;
+    MessagesStreamingIter it_;
+    MessagesStreamingIter end_;
+    ouster::sensor::LidarPacket packet_;
+};
+
+}  // namespace osf
+}  // namespace ouster
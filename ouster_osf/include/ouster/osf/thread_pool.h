@@ -0,0 +1,118 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file thread_pool.h
+ * @brief Persistent worker threads for encoding and decoding OSF scans
+ */
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace osf {
+
+/**
+ * Pool of persistent threads that run the encoding and decoding of the fields
+ * of scans, shared by any number of Writers and Readers.
+ *
+ * Work is submitted as a parallel_for over task indices. Threads, including
+ * the calling thread, claim one index at a time from the oldest unfinished
+ * call, so that a heavy task, e.g. the RANGE field, doesn't hold up the
+ * tasks statically assigned behind it, and concurrent callers share the
+ * threads instead of oversubscribing the CPU.
+ */
+class OUSTER_API_CLASS ThreadPool {
+   public:
+    /**
+     * @param[in] threads number of worker threads, 0 to use one less than
+     *                    sdk_thread_count() since the calling thread
+     *                    also runs tasks. With OSF built without threading
+     *                    support, all tasks run on the calling thread.
+     */
+    OUSTER_API_FUNCTION
+    explicit ThreadPool(unsigned threads = 0);
+
+    /** Stops the worker threads after running all submitted tasks. */
+    OUSTER_API_FUNCTION
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * Get the number of worker threads.
+     *
+     * @return the number of worker threads, not counting callers.
+     */
+    OUSTER_API_FUNCTION
+    size_t size() const;
+
+    /**
+     * Run f(0) ... f(n - 1) on the pool and the calling thread, returning
+     * once all have finished. Safe to call from several threads at once, and
+     * from within a task.
+     *
+     * @throw the first exception thrown by f, after all tasks have finished
+     *
+     * @param[in] n number of tasks
+     * @param[in] f task to run for each index
+     */
+    OUSTER_API_FUNCTION
+    void parallel_for(size_t n, const std::function<void(size_t)>& f);
+
+    /**
+     * Queue a task to run on a worker thread without waiting for it. Tasks
+     * may call parallel_for. With no worker threads the task runs on the
+     * calling thread before returning.
+     *
+     * @param[in] task the task, which must handle its own exceptions since
+     *                 there is no caller left to rethrow them to
+     */
+    OUSTER_API_FUNCTION
+    void submit(std::function<void()> task);
+
+   private:
+    struct Job;
+
+    void worker();
+    static bool run_one(Job& job);
+
+    std::vector<std::thread> threads_;
+    std::deque<std::shared_ptr<Job>> jobs_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_{false};
+};
+
+/**
+ * Get the pool used by Writers and Readers that weren't given one, created
+ * with default size on first use.
+ *
+ * @return the default pool
+ */
+OUSTER_API_FUNCTION
+std::shared_ptr<ThreadPool> default_thread_pool();
+
+/**
+ * Replace the pool used by Writers and Readers that weren't given one, e.g.
+ * to size it explicitly. Scans already being encoded or decoded finish on the
+ * previous pool.
+ *
+ * @param[in] pool the new default pool, nullptr to restore a default sized
+ *                 pool on next use
+ */
+OUSTER_API_FUNCTION
+void set_default_thread_pool(std::shared_ptr<ThreadPool> pool);
+
+}  // namespace osf
+}  // namespace ouster
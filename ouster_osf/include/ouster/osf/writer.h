@@ -7,18 +7,88 @@
  */
 #pragma once
 
+#include <memory>
+#include <set>
 #include <string>
 
 #include "ouster/lidar_scan.h"
 #include "ouster/osf/basics.h"
 #include "ouster/osf/metadata.h"
 #include "ouster/osf/osf_encoder.h"
+#include "ouster/scan_gate.h"
 #include "ouster/visibility.h"
 
 namespace ouster {
 namespace osf {
 
 class LidarScanStream;
+class PacketStream;
+class ChunkFile;
+struct ChunkSummary;
+
+/**
+ * How the Writer writes chunks to the file.
+ *
+ * The default writes each chunk through the page cache on the thread that
+ * finished it.
+ */
+struct OUSTER_API_CLASS ChunkIoOptions {
+    /**
+     * Write with O_DIRECT from block aligned buffers, bypassing the page
+     * cache, so that recording doesn't evict the pages of other processes.
+     * The end of the last chunk that doesn't fill a block is written with
+     * the next chunk or on close. Linux only, falls back to writing through
+     * the page cache with a warning on file systems without direct I/O.
+     */
+    bool direct{false};
+
+    /**
+     * Write chunks on a dedicated thread, so that saving a scan doesn't wait
+     * for the disk. Up to 4 chunks are queued before saving blocks. A failed
+     * write fails the following chunks and close().
+     */
+    bool background{false};
+
+    /**
+     * Reserve file space with fallocate this many bytes at a time ahead of
+     * the writes, 0 to not preallocate. The space left over is released on
+     * close. Linux only, ignored elsewhere.
+     */
+    uint64_t preallocate_bytes{0};
+
+    /**
+     * Flush each chunk to the disk with fdatasync before the next one.
+     */
+    bool sync_every_chunk{false};
+};
+
+/**
+ * When the chunk of a stream is finished, before a message that would take
+ * it past any of the limits. A message is always written, even if it alone
+ * exceeds a limit, and delta frames stay in the chunk of their keyframe.
+ *
+ * Smaller chunks make seeking finer and cost more index entries, larger ones
+ * write fewer and bigger blocks. Limiting only the duration, with max_size
+ * set to 0, sizes the chunks of each stream after its data rate, so that
+ * looking up a timestamp reads about the same span of data from a stream
+ * recording dual return scans as from one recording IMU packets.
+ */
+struct OUSTER_API_CLASS ChunkPolicy {
+    /**
+     * Largest chunk size in bytes, 0 for no limit.
+     */
+    uint32_t max_size{0};
+
+    /**
+     * Largest number of messages in a chunk, 0 for no limit.
+     */
+    uint32_t max_messages{0};
+
+    /**
+     * Longest span of receive timestamps in a chunk, 0 for no limit.
+     */
+    ts_t max_duration{0};
+};
 
 /**
  * Chunks writing strategy that decides when and how exactly write chunks
@@ -39,12 +109,83 @@ class OUSTER_API_CLASS ChunksWriter {
                               const ts_t sensor_ts,
                               const std::vector<uint8_t>& buf) = 0;
 
+    /**
+     * Save a delta frame, a message that can only be decoded together with
+     * the preceding messages of its stream since the last save_message(),
+     * which must thus stay in the same chunk. Saved with save_message() if
+     * not overridden, which is enough for layouts that never split a stream
+     * across chunks.
+     *
+     * @param[in] stream_id The stream id to associate with the message.
+     * @param[in] receive_ts The receive timestamp for the messages.
+     * @param[in] sensor_ts The sensor timestamp for the messages.
+     * @param[in] buf A vector of message buffers to record.
+     */
+    OUSTER_API_FUNCTION
+    virtual void save_delta_message(const uint32_t stream_id,
+                                    const ts_t receive_ts,
+                                    const ts_t sensor_ts,
+                                    const std::vector<uint8_t>& buf) {
+        save_message(stream_id, receive_ts, sensor_ts, buf);
+    }
+
+    /**
+     * Save a chunk of messages of one stream as it is, e.g. a chunk copied
+     * from another OSF file, after the messages of the stream saved before.
+     * Its messages are saved one by one with save_message() if not
+     * overridden.
+     *
+     * @param[in] stream_id The stream of the messages of the chunk.
+     * @param[in] chunk_buf The chunk, size prefixed, without its CRC.
+     * @param[in] sensor_ts The sensor timestamps of the messages of the
+     *                      chunk.
+     */
+    OUSTER_API_FUNCTION
+    virtual void save_chunk(const uint32_t stream_id,
+                            const std::vector<uint8_t>& chunk_buf,
+                            const std::vector<ts_t>& sensor_ts);
+
     /**
      * Finish the process of saving messages and write out the stream stats.
      */
     OUSTER_API_FUNCTION
     virtual void finish() = 0;
 
+    /**
+     * Write out the chunk of a stream being built, e.g. once no more
+     * messages of the stream follow for a while. Ignored if not overridden.
+     *
+     * @param[in] stream_id The stream to finish the chunk of.
+     */
+    OUSTER_API_FUNCTION
+    virtual void finish_stream(const uint32_t stream_id) { (void)stream_id; }
+
+    /**
+     * Add the summary of the message saved last to the summary of its chunk.
+     * Ignored if not overridden.
+     *
+     * @param[in] stream_id The stream of the message.
+     * @param[in] summary The summary of the message.
+     */
+    OUSTER_API_FUNCTION
+    virtual void summarize_message(const uint32_t stream_id,
+                                   const ChunkSummary& summary) {
+        (void)stream_id;
+        (void)summary;
+    }
+
+    /**
+     * Add the metadata describing the chunks written so far, e.g. the stream
+     * stats, to a checkpoint of the metadata. Nothing is added if not
+     * overridden.
+     *
+     * @param[in,out] store The copy of the metadata store to checkpoint.
+     */
+    OUSTER_API_FUNCTION
+    virtual void checkpoint_metadata(MetadataStore& store) const {
+        (void)store;
+    }
+
     /**
      * Get the chunksize
      *
@@ -53,6 +194,41 @@ class OUSTER_API_CLASS ChunksWriter {
     OUSTER_API_FUNCTION
     virtual uint32_t chunk_size() const = 0;
 
+    /**
+     * Set the chunk policy of the streams without one of their own. Ignored
+     * if not overridden.
+     *
+     * @param[in] policy the chunk policy.
+     */
+    OUSTER_API_FUNCTION
+    virtual void set_chunk_policy(const ChunkPolicy& policy) { (void)policy; }
+
+    /**
+     * Set the chunk policy of a stream, applied from its next message on.
+     * Ignored if not overridden.
+     *
+     * @param[in] stream_id the stream id.
+     * @param[in] policy the chunk policy.
+     */
+    OUSTER_API_FUNCTION
+    virtual void set_chunk_policy(uint32_t stream_id,
+                                  const ChunkPolicy& policy) {
+        (void)stream_id;
+        (void)policy;
+    }
+
+    /**
+     * Get the chunk policy of a stream.
+     *
+     * @param[in] stream_id the stream id.
+     * @return the chunk policy, limited to chunk_size() if not overridden.
+     */
+    OUSTER_API_FUNCTION
+    virtual ChunkPolicy chunk_policy(uint32_t stream_id) const {
+        (void)stream_id;
+        return ChunkPolicy{chunk_size(), 0, ts_t{0}};
+    }
+
     /**
      * Default deconstructor.
      */
@@ -215,10 +391,41 @@ class OUSTER_API_CLASS Writer {
      * @param[in] receive_ts The receive timestamp to use for the message.
      * @param[in] sensor_ts The sensor timestamp to use for the message.
      * @param[in] buf The message to save in the form of a byte vector.
+     * @param[in] delta_frame Whether the message depends on the preceding
+     *                        messages of the stream, see
+     *                        ChunksWriter::save_delta_message.
+     * @param[in] summary The summary of the message for the summary of its
+     *                    chunk, or nullptr.
      */
     OUSTER_API_FUNCTION
     void save_message(const uint32_t stream_id, const ts_t receive_ts,
-                      const ts_t sensor_ts, const std::vector<uint8_t>& buf);
+                      const ts_t sensor_ts, const std::vector<uint8_t>& buf,
+                      bool delta_frame = false,
+                      const ChunkSummary* summary = nullptr);
+
+    /**
+     * Save a chunk of another OSF file as it is, without decoding or
+     * re-encoding its messages, e.g. to copy the chunks of a recording into
+     * a slice of it. The messages of the chunk must be of a single stream of
+     * this file, the metadata of which keeps the stream id of the other file,
+     * and follow the messages of the stream saved before.
+     *
+     * @throws std::logic_error Exception on an invalid chunk, or on messages
+     *                          of more than one or a non existent stream.
+     *
+     * @param[in] chunk_buf The chunk, size prefixed, without its CRC.
+     */
+    OUSTER_API_FUNCTION
+    void save_chunk(const std::vector<uint8_t>& chunk_buf);
+
+    /**
+     * Write out the chunk being built of a stream, so that the chunks of
+     * streams saved one after another are grouped by stream in the file.
+     *
+     * @param[in] stream_id The stream to finish the chunk of.
+     */
+    OUSTER_API_FUNCTION
+    void finish_stream(uint32_t stream_id);
 
     /**
      * Adds info about a sensor to the OSF and returns the stream index to
@@ -322,6 +529,37 @@ class OUSTER_API_CLASS Writer {
     OUSTER_API_FUNCTION
     void save(const std::vector<LidarScan>& scans);
 
+    /**
+     * Save a raw lidar or IMU packet of a sensor as it was received, to a
+     * PacketStream of the sensor added with its first packet. Recording
+     * packets skips batching and encoding scans, so it keeps up with sensors
+     * that saving scans can't; PacketScanReader batches them into scans when
+     * the file is read. The packet is indexed with its host_timestamp.
+     *
+     * @throws std::logic_error Will throw exception on writer being closed.
+     * @throws std::logic_error ///< Will throw exception on
+     *                          ///< out of bound stream_index.
+     * @throws std::invalid_argument if the packet type is unknown.
+     *
+     * @param[in] stream_index The index of the corrosponding sensor_info to
+     *                         use.
+     * @param[in] packet The packet to save.
+     */
+    OUSTER_API_FUNCTION
+    void save_packet(uint32_t stream_index,
+                     const ouster::sensor::Packet& packet);
+
+    /**
+     * Set the zstd level the packets of the PacketStreams added from now on
+     * are compressed with. Fast levels, e.g. 1 or negative ones, shrink
+     * packets at a fraction of the cost of encoding scans.
+     *
+     * @param[in] level The zstd compression level, 0 to store the packets as
+     *                  they are, the default.
+     */
+    OUSTER_API_FUNCTION
+    void set_packet_compression(int level);
+
     /**
      * Returns the metadata store. This is used for getting the entire
      * set of flatbuffer metadata entries.
@@ -446,6 +684,172 @@ class OUSTER_API_CLASS Writer {
     OUSTER_API_FUNCTION
     Encoder& encoder() const { return *encoder_; }
 
+    /**
+     * Set how chunks are written to the file.
+     *
+     * @throws std::logic_error if a chunk was already written.
+     * @throws std::invalid_argument if direct I/O is requested on a platform
+     *                               other than Linux.
+     *
+     * @param[in] options the chunk I/O options.
+     */
+    OUSTER_API_FUNCTION
+    void set_chunk_io(const ChunkIoOptions& options);
+
+    /**
+     * Get how chunks are written to the file.
+     *
+     * @return the chunk I/O options.
+     */
+    OUSTER_API_FUNCTION
+    const ChunkIoOptions& chunk_io() const;
+
+    /**
+     * Write a checkpoint of the metadata, with the chunk index and stream
+     * stats, after every `chunks` chunks and before the first message after
+     * metadata entries or streams were added. recover_osf_file() finishes a
+     * file that was never closed, e.g. after a power loss, from its last
+     * checkpoint. Checkpoints are skipped by readers of finished files.
+     *
+     * @param[in] chunks the number of chunks between checkpoints, 0 to not
+     *                   write checkpoints, the default.
+     */
+    OUSTER_API_FUNCTION
+    void set_checkpoint_interval(uint32_t chunks);
+
+    /**
+     * Get the number of chunks between checkpoints of the metadata.
+     *
+     * @return the number of chunks, 0 if checkpoints are not written.
+     */
+    OUSTER_API_FUNCTION
+    uint32_t checkpoint_interval() const;
+
+    /**
+     * Set when the chunks of the streams without a policy of their own are
+     * finished, replacing the chunk_size given to the constructor.
+     *
+     * @param[in] policy the chunk policy.
+     */
+    OUSTER_API_FUNCTION
+    void set_chunk_policy(const ChunkPolicy& policy);
+
+    /**
+     * Set when the chunks of a stream are finished, e.g. larger chunks for
+     * dual return scans and a duration limit for a low rate IMU stream.
+     *
+     * @param[in] stream_id the stream id.
+     * @param[in] policy the chunk policy.
+     */
+    OUSTER_API_FUNCTION
+    void set_chunk_policy(uint32_t stream_id, const ChunkPolicy& policy);
+
+    /**
+     * Set when the chunks of the scans of a sensor are finished, also before
+     * its first scan is saved and its stream added.
+     *
+     * @throws std::logic_error if the stream_index is out of bounds.
+     *
+     * @param[in] stream_index the index of the sensor_info of the sensor.
+     * @param[in] policy the chunk policy.
+     */
+    OUSTER_API_FUNCTION
+    void set_sensor_chunk_policy(uint32_t stream_index,
+                                 const ChunkPolicy& policy);
+
+    /**
+     * Store the scans of a sensor in columnar form, as one LidarScanStream
+     * per field, so that each chunk holds a single field of consecutive scans
+     * and reading some fields of a recording only reads the chunks of their
+     * streams, found in the StreamingInfo by the field types of the streams.
+     * Every stream repeats the column headers of the scans.
+     *
+     * ScanReadAhead, and so the OSF scan source, merges the streams of a
+     * sensor back into whole scans, while Reader::messages() yields each
+     * stream with its own field. The fields are encoded one stream at a time,
+     * a BandedLidarScanEncoder still encodes each of them on several threads.
+     * AsyncWriter doesn't support columnar sensors.
+     *
+     * @throws std::logic_error if the stream_index is out of bounds or the
+     *                          first scan of the sensor was saved already.
+     *
+     * @param[in] stream_index the index of the sensor_info of the sensor.
+     * @param[in] columnar whether to store the scans in columnar form.
+     */
+    OUSTER_API_FUNCTION
+    void set_columnar(uint32_t stream_index, bool columnar = true);
+
+    /**
+     * Whether the scans of a sensor are stored in columnar form.
+     *
+     * @param[in] stream_index the index of the sensor_info of the sensor.
+     * @return true if set_columnar() was set for the sensor.
+     */
+    OUSTER_API_FUNCTION
+    bool columnar(uint32_t stream_index) const;
+
+    /**
+     * Summarize the scans of every chunk in the StreamingInfo: the bounds
+     * of their ranges, mean reflectivities, pose translations and ratios of
+     * valid columns, and the union of their alert flags, see ChunkSummary.
+     * Readers skip chunks by their summaries with a ChunkFilter passed to
+     * Reader::messages(), without decoding them. Costs a pass over the
+     * RANGE and REFLECTIVITY fields of each scan. Set before saving scans.
+     *
+     * @param[in] enable whether to summarize the chunks, off by default.
+     */
+    OUSTER_API_FUNCTION
+    void set_chunk_summaries(bool enable = true);
+
+    /**
+     * @return whether the chunks are summarized, see set_chunk_summaries().
+     */
+    OUSTER_API_FUNCTION
+    bool chunk_summaries() const;
+
+    /**
+     * Leave out the scans of every sensor nearly identical to the last one
+     * saved, e.g. while a vehicle is parked, with a ScanGate per sensor, so
+     * that they are neither encoded nor stored. The runs of scans left out
+     * of each sensor are stored as RecordingGaps metadata on close(). Set
+     * before saving scans.
+     *
+     * @param[in] options when the gates keep scans.
+     */
+    OUSTER_API_FUNCTION
+    void set_scan_gate(const ScanGateOptions& options);
+
+    /**
+     * Get the gate of a sensor, see set_scan_gate().
+     *
+     * @param[in] stream_index the index of the sensor_info of the sensor.
+     * @return the gate, or null if the scans of the sensor aren't gated or
+     *         none was saved yet.
+     */
+    OUSTER_API_FUNCTION
+    const ScanGate* scan_gate(uint32_t stream_index) const;
+
+    /**
+     * Give the streams and metadata entries added from now on ids from
+     * next_id up, e.g. so that the files of a ShardedWriter don't reuse the
+     * stream ids of each other.
+     *
+     * @throws std::invalid_argument if next_id isn't above the ids in use.
+     *
+     * @param[in] next_id the id of the next stream or metadata entry.
+     */
+    OUSTER_API_FUNCTION
+    void set_next_metadata_id(uint32_t next_id);
+
+    /**
+     * Get when the chunks of a stream are finished.
+     *
+     * @param[in] stream_id the stream id.
+     * @return the chunk policy of the stream.
+     */
+    OUSTER_API_FUNCTION
+    ChunkPolicy chunk_policy(uint32_t stream_id) const;
+
     /**
      * @relates close
      */
@@ -486,10 +890,19 @@ class OUSTER_API_CLASS Writer {
      * This function takes the metadata entries from the metadata store
      * and generates a raw flatbuffer blob for writing to file.
      *
+     * @param[in] store The metadata entries to write.
      * @return The completed raw flatbuffer byte vector for
      *         the metadata section.
      */
-    std::vector<uint8_t> make_metadata() const;
+    std::vector<uint8_t> make_metadata(const MetadataStore& store) const;
+
+    /**
+     * Append a checkpoint of the metadata, describing the chunks written so
+     * far, after making sure those chunks reach the disk first.
+     *
+     * @throws std::logic_error Exception on a size mismatch
+     */
+    void checkpoint();
 
     /**
      * Internal method used to save a scan to a specified stream_index
@@ -503,6 +916,28 @@ class OUSTER_API_CLASS Writer {
      */
     void _save(uint32_t stream_index, const LidarScan& scan, const ts_t time);
 
+    /**
+     * Get the stream for stream_index, creating it on the first scan, after
+     * checking that the scan has the fields and dimensions of the stream.
+     *
+     * @throws std::invalid_argument if the scan doesn't match the stream.
+     * @throws std::logic_error on out of bound stream_index.
+     *
+     * @param[in] stream_index The stream the scan is saved to.
+     * @param[in] scan The scan to check.
+     * @return the stream.
+     */
+    LidarScanStream& _stream_for(uint32_t stream_index, const LidarScan& scan);
+
+    /**
+     * Pass a scan through the gate of its sensor, see set_scan_gate().
+     *
+     * @param[in] stream_index The stream the scan is saved to.
+     * @param[in] scan The scan to save.
+     * @return true if the scan should be saved.
+     */
+    bool admit(uint32_t stream_index, const LidarScan& scan);
+
     /**
      * Writes buf to the file with CRC32 appended and return the number of
      * bytes writen to the file
@@ -512,9 +947,11 @@ class OUSTER_API_CLASS Writer {
      *
      * @param[in] buf The buffer to append.
      * @param[in] size The size of the buffer to append.
+     * @param[in] barrier Whether the data appended before must be on the disk
+     *                    before buf is written.
      * @return The number of bytes writen to the OSF file.
      */
-    uint64_t append(const uint8_t* buf, uint64_t size);
+    uint64_t append(const uint8_t* buf, uint64_t size, bool barrier = false);
 
     /**
      * Save a specified chunk to the OSF file.
@@ -529,6 +966,14 @@ class OUSTER_API_CLASS Writer {
     uint64_t emit_chunk(ts_t start_ts, ts_t end_ts,
                         const std::vector<uint8_t>& chunk_buf);
 
+    /**
+     * @copydoc emit_chunk(ts_t, ts_t, const std::vector<uint8_t>&)
+     *
+     * @param[in] size The size of the chunk at chunk_buf.
+     */
+    uint64_t emit_chunk(ts_t start_ts, ts_t end_ts, const uint8_t* chunk_buf,
+                        uint64_t size);
+
     /**
      * Internal filename of the OSF file.
      */
@@ -544,6 +989,32 @@ class OUSTER_API_CLASS Writer {
      */
     int64_t pos_{-1};
 
+    /**
+     * How chunks are written.
+     */
+    ChunkIoOptions chunk_io_{};
+
+    /**
+     * The file chunks are appended to, opened with the first chunk.
+     */
+    std::unique_ptr<ChunkFile> chunk_file_;
+
+    /**
+     * Chunks between checkpoints of the metadata, 0 for none.
+     */
+    uint32_t checkpoint_interval_{0};
+
+    /**
+     * Whether the scans of chunks are summarized.
+     */
+    bool chunk_summaries_{false};
+
+    /**
+     * The number of chunks and metadata entries at the last checkpoint.
+     */
+    size_t checkpoint_chunks_{0};
+    size_t checkpoint_entries_{0};
+
     /**
      * Internal status flag for whether we have started writing or not.
      */
@@ -617,6 +1088,46 @@ class OUSTER_API_CLASS Writer {
     std::map<uint32_t, std::unique_ptr<ouster::osf::LidarScanStream>>
         lidar_streams_;
 
+    /**
+     * Internal stream index to the streams of the fields after the first one
+     * of columnar sensors, the first one being in lidar_streams_.
+     */
+    std::map<uint32_t,
+             std::vector<std::unique_ptr<ouster::osf::LidarScanStream>>>
+        column_streams_;
+
+    /**
+     * Stream indices of the columnar sensors.
+     */
+    std::set<uint32_t> columnar_;
+
+    /**
+     * When scans are left out, null if they are all saved.
+     */
+    std::unique_ptr<ScanGateOptions> gate_options_;
+
+    /**
+     * Internal stream index to the gate of the sensor.
+     */
+    std::map<uint32_t, ScanGate> gates_;
+
+    /**
+     * Internal stream index to chunk policy map, applied to the stream of
+     * the sensor once it's added.
+     */
+    std::map<uint32_t, ChunkPolicy> sensor_chunk_policies_;
+
+    /**
+     * Internal stream index to PacketStream map.
+     */
+    std::map<uint32_t, std::unique_ptr<ouster::osf::PacketStream>>
+        packet_streams_;
+
+    /**
+     * The zstd level of the packet streams added, 0 for none.
+     */
+    int packet_compression_{0};
+
     /**
      * The internal sensor_info store ordered by stream_index.
      */
@@ -634,6 +1145,14 @@ class OUSTER_API_CLASS ChunkBuilder {
     OUSTER_API_FUNCTION
     ChunkBuilder(){};
 
+    /**
+     * @param[in] capacity The bytes to allocate for the serialized chunk up
+     *                     front, the buffer growing past them only for
+     *                     larger chunks.
+     */
+    OUSTER_API_FUNCTION
+    explicit ChunkBuilder(uint32_t capacity);
+
     /**
      * Save messages to the serialized chunks.
      *
@@ -650,7 +1169,8 @@ class OUSTER_API_CLASS ChunkBuilder {
                       const std::vector<uint8_t>& msg_buf);
 
     /**
-     * Completely wipe all data and start the chunk anew.
+     * Completely wipe all data and start the chunk anew, keeping the
+     * allocated buffer for the next chunk.
      */
     OUSTER_API_FUNCTION
     void reset();
@@ -664,6 +1184,23 @@ class OUSTER_API_CLASS ChunkBuilder {
     OUSTER_API_FUNCTION
     std::vector<uint8_t> finish();
 
+    /**
+     * Finish out the serialization of the chunk like finish(), leaving it in
+     * the buffer of the builder, at data(), instead of copying it out.
+     *
+     * @return The size of the serialized chunk, 0 if it has no messages.
+     */
+    OUSTER_API_FUNCTION
+    uint32_t finish_in_place();
+
+    /**
+     * The serialized chunk after finish_in_place(), valid until reset().
+     *
+     * @return The serialized chunk.
+     */
+    OUSTER_API_FUNCTION
+    const uint8_t* data() const;
+
     /**
      * Returns the flatbufferbuilder size.
      *
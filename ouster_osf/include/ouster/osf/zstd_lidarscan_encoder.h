@@ -0,0 +1,53 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+#pragma once
+
+#include "ouster/lidar_scan.h"
+#include "ouster/osf/lidarscan_encoder.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace osf {
+
+/**
+ * Fastest of the regular zstd levels; higher levels trade encoding speed for
+ * size and negative levels trade size for speed.
+ */
+static constexpr int DEFAULT_ZSTD_OSF_COMPRESSION_LEVEL = 1;
+
+/**
+ * Encodes the fields of scans with zstd after delta filtering the rows and
+ * splitting pixels into byte planes, which is much faster to encode than PNG.
+ * Readers recognize these fields by the zstd frame header and decode them
+ * alongside PNG encoded ones.
+ */
+class OUSTER_API_CLASS ZstdLidarScanEncoder
+    : public ouster::osf::LidarScanEncoder {
+   public:
+    /**
+     * @param[in] compression_level The zstd compression level.
+     */
+    OUSTER_API_FUNCTION
+    ZstdLidarScanEncoder(
+        int compression_level = DEFAULT_ZSTD_OSF_COMPRESSION_LEVEL)
+        : compression_level_{compression_level} {}
+
+    // This method is for standard destaggered fields.
+    OUSTER_API_IGNORE
+    bool fieldEncode(const LidarScan& lidar_scan,
+                     const ouster::FieldType& field_type,
+                     const std::vector<int>& px_offset, ScanData& scan_data,
+                     size_t scan_idx) const override;
+
+    // This method is for custom fields.
+    OUSTER_API_IGNORE
+    ScanChannelData encodeField(const ouster::Field& field) const override;
+
+   private:
+    int compression_level_{DEFAULT_ZSTD_OSF_COMPRESSION_LEVEL};
+};
+
+}  // namespace osf
+}  // namespace ouster
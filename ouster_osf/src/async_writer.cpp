@@ -1,44 +1,391 @@
 #include "ouster/osf/async_writer.h"
 
+#include <algorithm>
+#include <chrono>
+#include <set>
+#include <stdexcept>
+
+#include "compat_ops.h"
 #include "ouster/impl/logging.h"
 #include "ouster/osf/stream_lidar_scan.h"
+#include "ouster/osf/thread_pool.h"
+#include "ouster/scan_serialization.h"
+#include "ouster/threads.h"
 
 using ouster::sensor::logger;
 
 namespace ouster {
 namespace osf {
 
+namespace {
+
+uint64_t steady_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// the memory of a copy of the scan
+size_t scan_bytes(const LidarScan& scan) {
+    size_t bytes = scan.pose().bytes();
+    for (const auto& f : scan.fields()) bytes += f.second.bytes();
+    // timestamp, measurement id and status of each column
+    bytes += scan.w * (sizeof(uint64_t) + sizeof(uint16_t) + sizeof(uint32_t));
+    // timestamp and alert flags of each packet
+    bytes += scan.packet_count() * (sizeof(uint64_t) + sizeof(uint8_t));
+    return bytes;
+}
+
+}  // namespace
+
 AsyncWriter::AsyncWriter(const std::string& filename,
                          const std::vector<ouster::sensor::sensor_info>& info,
                          const std::vector<std::string>& fields_to_write,
-                         uint32_t chunk_size, std::shared_ptr<Encoder> encoder)
+                         uint32_t chunk_size, std::shared_ptr<Encoder> encoder,
+                         size_t max_in_flight, OverflowPolicy overflow)
     : writer_(filename, info, fields_to_write, chunk_size, encoder),
-      save_queue_{10} {
-    save_thread_ = std::thread([this] { save_thread_method(); });
+      thread_pool_(writer_.encoder().thread_pool()),
+      max_in_flight_(max_in_flight),
+      overflow_(overflow),
+      free_items_(std::max<size_t>(max_in_flight, 1)),
+      spill_path_(filename + ".spill") {
+    if (max_in_flight_ == 0) {
+        throw std::invalid_argument(
+            "ERROR: AsyncWriter max_in_flight must be at least 1");
+    }
+    save_thread_ =
+        start_thread("ouster-osf-save", [this] { save_thread_method(); });
+    if (overflow_ == OverflowPolicy::SPILL) {
+        spill_thread_ =
+            start_thread("ouster-osf-spill", [this] { spill_thread_method(); });
+    }
 }
 
+AsyncWriter::~AsyncWriter() { close(); }
+
 void AsyncWriter::save_thread_method() {
+    // streams whose last keyframe failed, so their delta frames can't be read
+    std::set<const LidarScanStream*> failed_keyframes;
     while (true) {
-        nonstd::optional<LidarScanMessage> msg = save_queue_.pop();
-        if (msg == nonstd::nullopt) {
-            break;
+        std::shared_ptr<InFlight> item;
+        {
+            // wait for the oldest scan, as scans finish encoding out of order
+            std::unique_lock<std::mutex> lock(in_flight_mutex_);
+            in_flight_changed_.wait(lock, [this] {
+                return (!in_flight_.empty() && in_flight_.front()->encoded_) ||
+                       (shutdown_ && in_flight_.empty() && spilled_.empty());
+            });
+            if (in_flight_.empty()) {
+                break;
+            }
+            item = in_flight_.front();
+        }
+
+        if (!item->error_ && item->delta_frame_ &&
+            failed_keyframes.count(item->stream_)) {
+            item->error_ = std::make_exception_ptr(std::runtime_error(
+                "ERROR: The keyframe of a delta frame failed to save"));
+        }
+        if (!item->error_) {
+            try {
+                std::lock_guard<std::mutex> lock(stream_mutex_);
+                writer_.save_message(
+                    item->stream_->meta().id(), item->receive_ts_,
+                    item->sensor_ts_, item->msg_, item->delta_frame_,
+                    item->summarize_ ? &item->summary_ : nullptr);
+            } catch (...) {
+                item->error_ = std::current_exception();
+            }
+        }
+        if (!item->delta_frame_) {
+            if (item->error_) {
+                failed_keyframes.insert(item->stream_);
+            } else {
+                failed_keyframes.erase(item->stream_);
+            }
         }
-        auto& msg_value = msg.value();
+
+        // the scan counts as in flight until it's written
+        {
+            std::lock_guard<std::mutex> lock(in_flight_mutex_);
+            in_flight_.pop_front();
+            in_flight_bytes_ -= item->bytes_;
+            if (latency_stats_ && item->saved_at_ && item->encoded_at_) {
+                const uint64_t now = steady_ns();
+                written_++;
+                encode_latency_.record(item->encoded_at_ - item->saved_at_);
+                write_latency_.record(now - item->encoded_at_);
+                save_latency_.record(now - item->saved_at_);
+            }
+        }
+        in_flight_changed_.notify_all();
+
+        // reset the item for reuse before fulfilling its promise, so that a
+        // caller waiting on the future finds it free; the shared state of
+        // the new promise is allocated here rather than in save()
+        std::promise<void> promise = std::move(item->promise_);
+        const std::exception_ptr error = item->error_;
+        item->promise_ = std::promise<void>();
+        item->error_ = nullptr;
+        item->msg_.clear();
+        item->delta_frame_ = false;
+        item->summarize_ = false;
+        item->encoded_ = false;
+        item->bytes_ = 0;
+        item->saved_at_ = 0;
+        item->encoded_at_ = 0;
+        // dropped here when 'max_in_flight_' items are free already
+        free_items_.try_push(std::move(item));
+
+        if (error) {
+            try {
+                std::rethrow_exception(error);
+            } catch (const std::exception& ex) {
+                logger().error("Exception when saving LidarScan as OSF: {}",
+                               ex.what());
+            }
+            promise.set_exception(error);
+        } else {
+            promise.set_value();
+        }
+    }
+}
+
+std::future<void> AsyncWriter::enqueue(uint32_t stream_index,
+                                       const LidarScan& scan,
+                                       const ouster::osf::ts_t timestamp) {
+    {
         std::lock_guard<std::mutex> lock(stream_mutex_);
+        if (!writer_.admit(stream_index, scan)) {
+            std::promise<void> skipped;
+            skipped.set_value();
+            return skipped.get_future();
+        }
+    }
+    std::shared_ptr<InFlight> item;
+    if (!free_items_.try_pop(item)) item = std::make_shared<InFlight>();
+    if (latency_stats_) item->saved_at_ = steady_ns();
+    std::future<void> result = item->promise_.get_future();
+    std::lock_guard<std::mutex> enqueue_lock(enqueue_mutex_);
+    try {
+        std::lock_guard<std::mutex> lock(stream_mutex_);
+        // the scans of columnar sensors are saved to several streams
+        if (writer_.columnar(stream_index)) {
+            throw std::logic_error(
+                "ERROR: AsyncWriter doesn't support columnar sensors");
+        }
+        item->stream_ = &writer_._stream_for(stream_index, scan);
+        item->summarize_ = writer_.chunk_summaries();
+    } catch (const std::exception& ex) {
+        logger().error("Exception when saving LidarScan as OSF: {}",
+                       ex.what());
+        item->promise_.set_exception(std::current_exception());
+        return result;
+    }
+    item->receive_ts_ = timestamp;
+    item->sensor_ts_ = ts_t(scan.get_first_valid_column_timestamp());
+
+    const size_t bytes = scan_bytes(scan);
+    {
+        std::unique_lock<std::mutex> lock(in_flight_mutex_);
+        if (shutdown_) {
+            throw std::logic_error("ERROR: Writer is closed");
+        }
+        // once a scan is spilled the scans after it are spilled too, so that
+        // they are still written in the order they were saved
+        if (overflow_ == OverflowPolicy::SPILL &&
+            (!spilled_.empty() || !room_for(bytes))) {
+            lock.unlock();
+            spill(item, scan, bytes);
+            return result;
+        }
+        if (!room_for(bytes) && overflow_ == OverflowPolicy::DROP) {
+            dropped_++;
+            lock.unlock();
+            item->promise_.set_exception(std::make_exception_ptr(
+                std::overflow_error("ERROR: AsyncWriter dropped a scan with "
+                                    "max_in_flight scans in flight")));
+            return result;
+        }
+        in_flight_changed_.wait(
+            lock, [this, bytes] { return room_for(bytes) || shutdown_; });
+        if (shutdown_) {
+            throw std::logic_error("ERROR: Writer is closed");
+        }
+    }
+    start_encoding(item, scan, bytes, false);
+    return result;
+}
+
+bool AsyncWriter::room_for(size_t bytes) const {
+    return in_flight_.size() < max_in_flight_ &&
+           (memory_limit_ == 0 || in_flight_.empty() ||
+            in_flight_bytes_ + bytes <= memory_limit_);
+}
+
+void AsyncWriter::start_encoding(const std::shared_ptr<InFlight>& item,
+                                 const LidarScan& scan, size_t bytes,
+                                 bool from_spill) {
+    // the keyframe state of the stream is only touched here, under
+    // enqueue_mutex_
+    std::unique_ptr<LidarScan> residual = item->stream_->delta_frame(scan);
+    item->delta_frame_ = residual != nullptr;
+    if (residual) {
+        // the residual doesn't hold the values of the scan to summarize
+        if (item->summarize_) {
+            item->summary_ =
+                summarize_scan(scan, item->stream_->meta().field_types());
+        }
+        item->lidar_scan_ = std::move(*residual);
+    } else {
+        // copies into the fields of a reused item when they match
+        item->lidar_scan_ = scan;
+    }
+    {
+        std::lock_guard<std::mutex> lock(in_flight_mutex_);
+        if (from_spill) {
+            // in flight as it leaves the spill file, so the save thread
+            // doesn't see both empty in between
+            spilled_.pop_front();
+        } else if (shutdown_) {
+            throw std::logic_error("ERROR: Writer is closed");
+        }
+        item->bytes_ = bytes;
+        in_flight_bytes_ += bytes;
+        in_flight_.push_back(item);
+        if (latency_stats_) {
+            max_in_flight_seen_ =
+                std::max(max_in_flight_seen_, in_flight_.size());
+        }
+    }
+
+    thread_pool_->submit([this, item] {
+        try {
+            // into the buffer of the reused item, keeping its capacity
+            item->stream_->make_msg(item->lidar_scan_, item->delta_frame_,
+                                    item->msg_);
+            if (item->summarize_ && !item->delta_frame_) {
+                item->summary_ = summarize_scan(
+                    item->lidar_scan_, item->stream_->meta().field_types());
+            }
+        } catch (...) {
+            item->error_ = std::current_exception();
+        }
+        if (item->saved_at_) item->encoded_at_ = steady_ns();
+        // notified under the lock since the writer may be gone once the
+        // save thread sees the last scan encoded
+        std::lock_guard<std::mutex> lock(in_flight_mutex_);
+        item->encoded_ = true;
+        in_flight_changed_.notify_all();
+    });
+}
+
+void AsyncWriter::spill(const std::shared_ptr<InFlight>& item,
+                        const LidarScan& scan, size_t bytes) {
+    Spilled spilled{item, 0, 0, bytes};
+    try {
+        // the fields and headers are written as they are laid out in memory
+        ScanSerializer serializer(scan);
+        std::lock_guard<std::mutex> lock(spill_mutex_);
+        if (!spill_file_.is_open()) {
+            spill_file_.open(spill_path_, std::ios::in | std::ios::out |
+                                              std::ios::binary |
+                                              std::ios::trunc);
+            if (!spill_file_) {
+                throw std::runtime_error("ERROR: Can't open the spill file " +
+                                         spill_path_);
+            }
+        }
+        spill_file_.seekp(spill_end_);
+        for (const auto& chunk : serializer.chunks()) {
+            spill_file_.write(reinterpret_cast<const char*>(chunk.data),
+                              chunk.size);
+        }
+        if (!spill_file_.flush()) {
+            spill_file_.clear();
+            throw std::runtime_error("ERROR: Can't write the spill file " +
+                                     spill_path_);
+        }
+        spilled.offset = spill_end_;
+        spilled.size = serializer.size();
+        spill_end_ += spilled.size;
+    } catch (const std::exception& ex) {
+        logger().error("Exception when saving LidarScan as OSF: {}",
+                       ex.what());
+        item->promise_.set_exception(std::current_exception());
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(in_flight_mutex_);
+        // the spill thread may be gone already
+        if (shutdown_) {
+            throw std::logic_error("ERROR: Writer is closed");
+        }
+        spilled_.push_back(std::move(spilled));
+        spilled_count_++;
+    }
+    in_flight_changed_.notify_all();
+}
+
+void AsyncWriter::spill_thread_method() {
+    std::vector<uint8_t> buf;
+    while (true) {
+        Spilled spilled;
+        {
+            // spilled scans are encoded once they fit, also after close()
+            std::unique_lock<std::mutex> lock(in_flight_mutex_);
+            in_flight_changed_.wait(lock, [this] {
+                return (!spilled_.empty() &&
+                        room_for(spilled_.front().bytes)) ||
+                       (shutdown_ && spilled_.empty());
+            });
+            if (spilled_.empty()) {
+                break;
+            }
+            spilled = spilled_.front();
+        }
+
+        std::lock_guard<std::mutex> enqueue_lock(enqueue_mutex_);
+        LidarScan scan;
+        std::exception_ptr error;
         try {
-            writer_._save(msg_value.stream_index_, msg_value.lidar_scan_,
-                          msg_value.timestamp_);
-            msg_value.promise_.set_value();
-        } catch (const std::exception& ex) {
-            logger().error("Exception when saving LidarScan as OSF: {}",
-                           ex.what());
+            std::lock_guard<std::mutex> lock(spill_mutex_);
+            buf.resize(spilled.size);
+            spill_file_.seekg(spilled.offset);
+            if (!spill_file_.read(reinterpret_cast<char*>(buf.data()),
+                                  buf.size())) {
+                spill_file_.clear();
+                throw std::runtime_error("ERROR: Can't read the spill file " +
+                                         spill_path_);
+            }
+            scan = deserialize_scan(buf.data(), buf.size());
+        } catch (...) {
+            error = std::current_exception();
+        }
+        if (!error) {
             try {
-                msg_value.promise_.set_exception(std::current_exception());
+                start_encoding(spilled.item, scan, spilled.bytes, true);
             } catch (...) {
-                logger().error(
-                    "An exception occurred during std::promise set_exception.");
+                error = std::current_exception();
             }
         }
+
+        if (error) {
+            // handed to the save thread to fail in order
+            std::lock_guard<std::mutex> lock(in_flight_mutex_);
+            spilled_.pop_front();
+            spilled.item->error_ = error;
+            spilled.item->encoded_ = true;
+            in_flight_.push_back(spilled.item);
+        }
+        in_flight_changed_.notify_all();
+
+        // the file is written from the start again once it's read back
+        std::lock_guard<std::mutex> lock(in_flight_mutex_);
+        if (spilled_.empty()) {
+            std::lock_guard<std::mutex> spill_lock(spill_mutex_);
+            spill_end_ = 0;
+        }
     }
 }
 
@@ -47,11 +394,8 @@ std::future<void> AsyncWriter::save(uint32_t stream_index,
     if (writer_.is_closed()) {
         throw std::logic_error("ERROR: Writer is closed");
     }
-    std::promise<void> promise;
-    std::future<void> result = promise.get_future();
     ts_t time = ts_t(scan.get_first_valid_packet_timestamp());
-    save_queue_.push(LidarScanMessage(stream_index, time, scan, promise));
-    return result;
+    return enqueue(stream_index, scan, time);
 }
 
 std::future<void> AsyncWriter::save(uint32_t stream_index,
@@ -60,10 +404,7 @@ std::future<void> AsyncWriter::save(uint32_t stream_index,
     if (writer_.is_closed()) {
         throw std::logic_error("ERROR: Writer is closed");
     }
-    std::promise<void> promise;
-    std::future<void> result = promise.get_future();
-    save_queue_.push(LidarScanMessage(stream_index, timestamp, scan, promise));
-    return result;
+    return enqueue(stream_index, scan, timestamp);
 }
 
 std::vector<std::future<void>> AsyncWriter::save(
@@ -79,21 +420,168 @@ std::vector<std::future<void>> AsyncWriter::save(
         std::vector<std::future<void>> results;
         for (uint32_t i = 0; i < scans.size(); i++) {
             ts_t time = ts_t(scans[i].get_first_valid_packet_timestamp());
-            std::promise<void> promise;
-            std::future<void> result = promise.get_future();
-            save_queue_.push(LidarScanMessage(i, time, scans[i], promise));
-            results.push_back(std::move(result));
+            results.push_back(enqueue(i, scans[i], time));
         }
         return results;
     }
 }
 
+size_t AsyncWriter::dropped() const {
+    std::lock_guard<std::mutex> lock(in_flight_mutex_);
+    return dropped_;
+}
+
+size_t AsyncWriter::spilled() const {
+    std::lock_guard<std::mutex> lock(in_flight_mutex_);
+    return spilled_count_;
+}
+
+void AsyncWriter::set_memory_limit(size_t bytes) {
+    {
+        std::lock_guard<std::mutex> lock(in_flight_mutex_);
+        memory_limit_ = bytes;
+    }
+    in_flight_changed_.notify_all();
+}
+
+void AsyncWriter::set_spill_file(const std::string& path) {
+    std::lock_guard<std::mutex> enqueue_lock(enqueue_mutex_);
+    std::lock_guard<std::mutex> lock(spill_mutex_);
+    if (spill_file_.is_open()) {
+        throw std::logic_error(
+            "ERROR: AsyncWriter spill file set after scans were spilled");
+    }
+    spill_path_ = path;
+}
+
+void AsyncWriter::enable_latency_stats(bool enable) {
+    std::lock_guard<std::mutex> lock(in_flight_mutex_);
+    if (enable) {
+        written_ = 0;
+        max_in_flight_seen_ = 0;
+        encode_latency_.reset();
+        write_latency_.reset();
+        save_latency_.reset();
+    }
+    latency_stats_ = enable;
+}
+
+AsyncWriterStats AsyncWriter::stats() const {
+    std::lock_guard<std::mutex> lock(in_flight_mutex_);
+    AsyncWriterStats stats;
+    stats.written = written_;
+    stats.dropped = dropped_;
+    stats.spilled = spilled_count_;
+    stats.spill_backlog = spilled_.size();
+    stats.in_flight_bytes = in_flight_bytes_;
+    stats.in_flight = in_flight_.size();
+    stats.max_in_flight = max_in_flight_seen_;
+    stats.encode_latency = encode_latency_.summary();
+    stats.write_latency = write_latency_.summary();
+    stats.save_latency = save_latency_.summary();
+    stats.save_thread_cpu_seconds = thread_cpu_seconds(save_thread_);
+    return stats;
+}
+
+void add_metrics(ouster::sensor::OpenMetrics& metrics,
+                 const AsyncWriterStats& stats,
+                 const ouster::sensor::MetricLabels& labels) {
+    metrics.counter("ouster_osf_written_scans", "Scans written to OSF",
+                    static_cast<double>(stats.written), labels);
+    metrics.counter("ouster_osf_dropped_scans",
+                    "Scans dropped because too many were in flight",
+                    static_cast<double>(stats.dropped), labels);
+    metrics.counter("ouster_osf_spilled_scans",
+                    "Scans spilled to disk because too many were in flight",
+                    static_cast<double>(stats.spilled), labels);
+    metrics.gauge("ouster_osf_spill_backlog",
+                  "Scans in the spill file waiting to be encoded",
+                  static_cast<double>(stats.spill_backlog), labels);
+    metrics.gauge("ouster_osf_encode_backlog_bytes",
+                  "Bytes of the copies of the scans saved but not yet written",
+                  static_cast<double>(stats.in_flight_bytes), labels);
+    metrics.gauge("ouster_osf_encode_backlog",
+                  "Scans saved but not yet written",
+                  static_cast<double>(stats.in_flight), labels);
+    metrics.gauge("ouster_osf_encode_max_backlog",
+                  "Most scans saved but not yet written at once",
+                  static_cast<double>(stats.max_in_flight), labels);
+    if (stats.encode_latency.count) {
+        metrics.summary("ouster_osf_encode_latency_seconds",
+                        "Time from save until the scan was encoded",
+                        stats.encode_latency, labels);
+    }
+    if (stats.write_latency.count) {
+        metrics.summary("ouster_osf_write_latency_seconds",
+                        "Time from encoding until the scan was written",
+                        stats.write_latency, labels);
+    }
+    if (stats.save_latency.count) {
+        metrics.summary("ouster_osf_save_latency_seconds",
+                        "Time from save until the scan was written",
+                        stats.save_latency, labels);
+    }
+    if (stats.save_thread_cpu_seconds >= 0) {
+        metrics.counter("ouster_osf_save_thread_cpu_seconds",
+                        "CPU time of the thread writing scans",
+                        stats.save_thread_cpu_seconds, labels);
+    }
+}
+
+void AsyncWriter::set_chunk_io(const ChunkIoOptions& options) {
+    std::lock_guard<std::mutex> lock(stream_mutex_);
+    writer_.set_chunk_io(options);
+}
+
+void AsyncWriter::set_checkpoint_interval(uint32_t chunks) {
+    std::lock_guard<std::mutex> lock(stream_mutex_);
+    writer_.set_checkpoint_interval(chunks);
+}
+
+void AsyncWriter::set_chunk_policy(const ChunkPolicy& policy) {
+    std::lock_guard<std::mutex> lock(stream_mutex_);
+    writer_.set_chunk_policy(policy);
+}
+
+void AsyncWriter::set_sensor_chunk_policy(uint32_t stream_index,
+                                          const ChunkPolicy& policy) {
+    std::lock_guard<std::mutex> lock(stream_mutex_);
+    writer_.set_sensor_chunk_policy(stream_index, policy);
+}
+
+void AsyncWriter::set_chunk_summaries(bool enable) {
+    std::lock_guard<std::mutex> lock(stream_mutex_);
+    writer_.set_chunk_summaries(enable);
+}
+
+void AsyncWriter::set_scan_gate(const ScanGateOptions& options) {
+    std::lock_guard<std::mutex> lock(stream_mutex_);
+    writer_.set_scan_gate(options);
+}
+
+void AsyncWriter::set_next_metadata_id(uint32_t next_id) {
+    std::lock_guard<std::mutex> lock(stream_mutex_);
+    writer_.set_next_metadata_id(next_id);
+}
+
 void AsyncWriter::close() {
-    save_queue_.shutdown();
+    {
+        std::lock_guard<std::mutex> lock(in_flight_mutex_);
+        shutdown_ = true;
+    }
+    in_flight_changed_.notify_all();
+    if (spill_thread_.joinable()) {
+        spill_thread_.join();
+    }
     if (save_thread_.joinable()) {
         save_thread_.join();
     }
     writer_.close();
+    std::lock_guard<std::mutex> lock(spill_mutex_);
+    if (spill_file_.is_open()) {
+        spill_file_.close();
+        unlink_path(spill_path_);
+    }
 }
 
 }  // namespace osf
@@ -0,0 +1,214 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "band_tools.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#include "ouster/impl/logging.h"
+#include "ouster/osf/thread_pool.h"
+#include "png_tools.h"
+#include "zstd_tools.h"
+
+using namespace ouster::sensor;
+
+namespace ouster {
+namespace osf {
+
+namespace {
+
+constexpr uint8_t band_magic[4] = {'O', 'S', 'F', 'B'};
+
+// magic, rows per band and band count
+constexpr size_t band_header_size = sizeof(band_magic) + 2 * sizeof(uint32_t);
+
+void put_u32(uint8_t* dst, uint32_t value) {
+    for (size_t b = 0; b < 4; b++) {
+        dst[b] = static_cast<uint8_t>(value >> (8 * b));
+    }
+}
+
+uint32_t get_u32(const uint8_t* src) {
+    uint32_t value = 0;
+    for (size_t b = 0; b < 4; b++) {
+        value |= static_cast<uint32_t>(src[b]) << (8 * b);
+    }
+    return value;
+}
+
+// The bands being decoded by each thread, copied out of the channel buffer
+// since the image decoders read from vectors
+ScanChannelData& band_buffer() {
+    thread_local ScanChannelData band;
+    return band;
+}
+
+std::vector<int>& band_px_offset() {
+    thread_local std::vector<int> px_offset;
+    return px_offset;
+}
+
+/**
+ * Decode a band encoded as a PNG image or a zstd frame, PNG images of T being
+ * of the depth the PNG encoder uses for a field of T.
+ */
+template <typename T>
+bool decodeBand(Eigen::Ref<img_t<T>> img, const ScanChannelData& band,
+                const std::vector<int>* px_offset) {
+    if (is_zstd_buffer(band)) {
+        return px_offset ? decodeZstdImage<T>(img, band, *px_offset)
+                         : decodeZstdImage<T>(img, band);
+    }
+    switch (sizeof(T)) {
+        case 1:
+            return px_offset ? decode8bitImage<T>(img, band, *px_offset)
+                             : decode8bitImage<T>(img, band);
+        case 2:
+            return px_offset ? decode16bitImage<T>(img, band, *px_offset)
+                             : decode16bitImage<T>(img, band);
+        case 4:
+            return px_offset ? decode32bitImage<T>(img, band, *px_offset)
+                             : decode32bitImage<T>(img, band);
+        default:
+            return px_offset ? decode64bitImage<T>(img, band, *px_offset)
+                             : decode64bitImage<T>(img, band);
+    }
+}
+
+}  // namespace
+
+bool is_banded_buffer(const ScanChannelData& channel_buf) {
+    return channel_buf.size() >= sizeof(band_magic) &&
+           std::memcmp(channel_buf.data(), band_magic, sizeof(band_magic)) ==
+               0;
+}
+
+void encodeBands(ScanChannelData& res_buf,
+                 const std::vector<ScanChannelData>& bands,
+                 uint32_t band_rows) {
+    size_t size = band_header_size + bands.size() * sizeof(uint32_t);
+    for (const auto& band : bands) size += band.size();
+    res_buf.resize(size);
+
+    uint8_t* dst = res_buf.data();
+    std::memcpy(dst, band_magic, sizeof(band_magic));
+    put_u32(dst + 4, band_rows);
+    put_u32(dst + 8, static_cast<uint32_t>(bands.size()));
+    dst += band_header_size;
+    for (const auto& band : bands) {
+        put_u32(dst, static_cast<uint32_t>(band.size()));
+        dst += sizeof(uint32_t);
+    }
+    for (const auto& band : bands) {
+        if (band.empty()) continue;
+        std::memcpy(dst, band.data(), band.size());
+        dst += band.size();
+    }
+}
+
+template <typename T>
+bool decodeBandedImage(Eigen::Ref<img_t<T>> img,
+                       const ScanChannelData& channel_buf,
+                       const std::vector<int>* px_offset) {
+    const size_t h = img.rows();
+    if (px_offset && px_offset->size() != h) {
+        logger().error("ERROR: decodeBandedImage: image height {} does not "
+                       "match shifts size {}",
+                       h, px_offset->size());
+        return true;
+    }
+    if (channel_buf.size() < band_header_size) {
+        logger().error("ERROR: decodeBandedImage: truncated buffer");
+        return true;
+    }
+    const size_t band_rows = get_u32(channel_buf.data() + 4);
+    const size_t n = get_u32(channel_buf.data() + 8);
+    if (band_rows == 0 || n != (h + band_rows - 1) / band_rows ||
+        channel_buf.size() < band_header_size + n * sizeof(uint32_t)) {
+        logger().error(
+            "ERROR: decodeBandedImage: bands don't match the image");
+        return true;
+    }
+
+    // offset of each band in the buffer
+    std::vector<size_t> offsets(n + 1);
+    offsets[0] = band_header_size + n * sizeof(uint32_t);
+    for (size_t k = 0; k < n; k++) {
+        offsets[k + 1] =
+            offsets[k] + get_u32(channel_buf.data() + band_header_size +
+                                 k * sizeof(uint32_t));
+    }
+    if (offsets[n] != channel_buf.size()) {
+        logger().error("ERROR: decodeBandedImage: truncated buffer");
+        return true;
+    }
+
+    std::atomic<bool> failed{false};
+    default_thread_pool()->parallel_for(n, [&](size_t k) {
+        const size_t r0 = k * band_rows;
+        const size_t rows = std::min(band_rows, h - r0);
+        auto& band = band_buffer();
+        band.assign(channel_buf.begin() + offsets[k],
+                    channel_buf.begin() + offsets[k + 1]);
+        Eigen::Ref<img_t<T>> rows_img = img.middleRows(r0, rows);
+        const std::vector<int>* band_offset = nullptr;
+        if (px_offset) {
+            auto& offset = band_px_offset();
+            offset.assign(px_offset->begin() + r0,
+                          px_offset->begin() + r0 + rows);
+            band_offset = &offset;
+        }
+        if (decodeBand<T>(rows_img, band, band_offset)) failed = true;
+    });
+    return failed;
+}
+
+bool bandedFieldDecode(LidarScan& lidar_scan,
+                       const ScanChannelData& channel_buf,
+                       const ouster::FieldType& field_type,
+                       const std::vector<int>& px_offset) {
+    switch (field_type.element_type) {
+        case sensor::ChanFieldType::UINT8:
+            return decodeBandedImage<uint8_t>(
+                lidar_scan.field<uint8_t>(field_type.name), channel_buf,
+                &px_offset);
+        case sensor::ChanFieldType::UINT16:
+            return decodeBandedImage<uint16_t>(
+                lidar_scan.field<uint16_t>(field_type.name), channel_buf,
+                &px_offset);
+        case sensor::ChanFieldType::UINT32:
+            return decodeBandedImage<uint32_t>(
+                lidar_scan.field<uint32_t>(field_type.name), channel_buf,
+                &px_offset);
+        case sensor::ChanFieldType::UINT64:
+            return decodeBandedImage<uint64_t>(
+                lidar_scan.field<uint64_t>(field_type.name), channel_buf,
+                &px_offset);
+        default:
+            logger().error(
+                "ERROR: bandedFieldDecode: UNKNOWN:"
+                "ChanFieldType not yet "
+                "implemented");
+            return true;
+    }
+}
+
+template bool decodeBandedImage<uint8_t>(Eigen::Ref<img_t<uint8_t>>,
+                                         const ScanChannelData&,
+                                         const std::vector<int>*);
+template bool decodeBandedImage<uint16_t>(Eigen::Ref<img_t<uint16_t>>,
+                                          const ScanChannelData&,
+                                          const std::vector<int>*);
+template bool decodeBandedImage<uint32_t>(Eigen::Ref<img_t<uint32_t>>,
+                                          const ScanChannelData&,
+                                          const std::vector<int>*);
+template bool decodeBandedImage<uint64_t>(Eigen::Ref<img_t<uint64_t>>,
+                                          const ScanChannelData&,
+                                          const std::vector<int>*);
+
+}  // namespace osf
+}  // namespace ouster
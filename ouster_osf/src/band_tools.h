@@ -0,0 +1,90 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace osf {
+
+// Encoded single field buffer
+using ScanChannelData = std::vector<uint8_t>;
+
+/**
+ * Row band encoding of 2D images, used by BandedLidarScanEncoder.
+ *
+ * The image is split into horizontal bands of a fixed number of rows, the
+ * last one possibly shorter, each encoded on its own as a PNG image or a zstd
+ * frame so that bands are encoded and decoded in parallel. The buffer is
+ *
+ *     magic "OSFB" | uint32 rows per band | uint32 bands | uint32 size of
+ *     each band | the encoded bands, one after another
+ *
+ * with little endian integers. Decoders tell it from PNG and zstd buffers by
+ * the magic. Standard fields are banded after destaggering, so each band
+ * decodes and staggers its rows independently.
+ */
+
+/**
+ * Check whether the buffer holds row bands.
+ *
+ * @param[in] channel_buf The encoded buffer.
+ * @return true if the buffer starts with the band magic.
+ */
+bool is_banded_buffer(const ScanChannelData& channel_buf);
+
+/**
+ * Assemble encoded bands into a single buffer.
+ *
+ * @param[out] res_buf The output buffer.
+ * @param[in] bands The encoded bands, from the top of the image.
+ * @param[in] band_rows Rows per band.
+ */
+void encodeBands(ScanChannelData& res_buf,
+                 const std::vector<ScanChannelData>& bands,
+                 uint32_t band_rows);
+
+/**
+ * Decode row bands into img, which must have the shape of the encoded image,
+ * decoding the bands in parallel on the default thread pool.
+ *
+ * @tparam T The type of the image pixels.
+ *
+ * @param[out] img The output image.
+ * @param[in] channel_buf The encoded buffer.
+ * @param[in] px_offset Pixel shift per row used to reconstruct staggered
+ *                      range image form, nullptr for images stored as they
+ *                      are.
+ * @return false (0) if operation is successful, true (1) if error occured
+ */
+template <typename T>
+bool decodeBandedImage(Eigen::Ref<img_t<T>> img,
+                       const ScanChannelData& channel_buf,
+                       const std::vector<int>* px_offset);
+
+/**
+ * Decode a single row banded standard field to lidar_scan.
+ *
+ * @param[out] lidar_scan The output object that will be filled as a result of
+ *                        decoding.
+ * @param[in] channel_buf The encoded buffer.
+ * @param[in] field_type The field of `lidar_scan` to fill in with the decoded
+ *                       result.
+ * @param[in] px_offset Pixel shift per row used to reconstruct staggered range
+ *                      image form.
+ * @return false (0) if operation is successful true (1) if error occured
+ */
+bool bandedFieldDecode(LidarScan& lidar_scan,
+                       const ScanChannelData& channel_buf,
+                       const ouster::FieldType& field_type,
+                       const std::vector<int>& px_offset);
+
+}  // namespace osf
+}  // namespace ouster
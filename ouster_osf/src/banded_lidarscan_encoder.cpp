@@ -0,0 +1,161 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/osf/banded_lidarscan_encoder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+
+#include "band_tools.h"
+#include "ouster/impl/logging.h"
+#include "ouster/osf/thread_pool.h"
+
+using namespace ouster::sensor;
+
+namespace ouster {
+namespace osf {
+
+BandedLidarScanEncoder::BandedLidarScanEncoder(
+    std::shared_ptr<LidarScanEncoder> encoder, size_t band_rows)
+    : encoder_{std::move(encoder)}, band_rows_{band_rows} {
+    if (!encoder_) {
+        throw std::invalid_argument(
+            "BandedLidarScanEncoder: encoder must not be null");
+    }
+    if (band_rows_ == 0) {
+        throw std::invalid_argument(
+            "BandedLidarScanEncoder: band_rows must be > 0");
+    }
+}
+
+template <typename T>
+bool BandedLidarScanEncoder::encodeBandedImage(
+    ScanChannelData& res_buf, const Eigen::Ref<const img_t<T>>& img) const {
+    const size_t h = img.rows();
+    const size_t w = img.cols();
+    const size_t n = (h + band_rows_ - 1) / band_rows_;
+    std::vector<ScanChannelData> bands(n);
+    std::atomic<bool> failed{false};
+    default_thread_pool()->parallel_for(n, [&](size_t k) {
+        const size_t r0 = k * band_rows_;
+        const size_t rows = std::min(band_rows_, h - r0);
+        // rows of a row major image are contiguous, the band is a view
+        void* ptr = const_cast<T*>(img.data() + r0 * w);
+        const Field band(fd_array<T>(rows, w), {}, ptr,
+                         std::shared_ptr<void>(ptr, [](void*) {}));
+        try {
+            bands[k] = encoder_->encodeField(band);
+        } catch (const std::exception& e) {
+            logger().error("ERROR: encodeBandedImage: {}", e.what());
+            failed = true;
+        }
+    });
+    if (failed) return true;
+    encodeBands(res_buf, bands, static_cast<uint32_t>(band_rows_));
+    return false;
+}
+
+bool BandedLidarScanEncoder::fieldEncode(const LidarScan& lidar_scan,
+                                         const ouster::FieldType& field_type,
+                                         const std::vector<int>& px_offset,
+                                         ScanData& scan_data,
+                                         size_t scan_idx) const {
+    if (scan_idx >= scan_data.size()) {
+        throw std::invalid_argument(
+            "ERROR: scan_data size is not sufficient to hold idx: " +
+            std::to_string(scan_idx));
+    }
+    // a single band is stored as the encoder stores it, readable by readers
+    // unaware of bands
+    if (lidar_scan.h <= band_rows_) {
+        return encoder_->fieldEncode(lidar_scan, field_type, px_offset,
+                                     scan_data, scan_idx);
+    }
+    bool res = true;
+    switch (field_type.element_type) {
+        case sensor::ChanFieldType::UINT8:
+            res = encodeBandedImage<uint8_t>(
+                scan_data[scan_idx],
+                destagger<uint8_t>(lidar_scan.field<uint8_t>(field_type.name),
+                                   px_offset));
+            break;
+        case sensor::ChanFieldType::UINT16:
+            res = encodeBandedImage<uint16_t>(
+                scan_data[scan_idx],
+                destagger<uint16_t>(
+                    lidar_scan.field<uint16_t>(field_type.name), px_offset));
+            break;
+        case sensor::ChanFieldType::UINT32:
+            res = encodeBandedImage<uint32_t>(
+                scan_data[scan_idx],
+                destagger<uint32_t>(
+                    lidar_scan.field<uint32_t>(field_type.name), px_offset));
+            break;
+        case sensor::ChanFieldType::UINT64:
+            res = encodeBandedImage<uint64_t>(
+                scan_data[scan_idx],
+                destagger<uint64_t>(
+                    lidar_scan.field<uint64_t>(field_type.name), px_offset));
+            break;
+        default:
+            logger().error(
+                "ERROR: fieldEncode: UNKNOWN:"
+                "ChanFieldType not yet "
+                "implemented");
+            break;
+    }
+    if (res) {
+        logger().error("ERROR: fieldEncode: Can't encode field {}",
+                       field_type.name);
+    }
+    return res;
+}
+
+ScanChannelData BandedLidarScanEncoder::encodeField(
+    const ouster::Field& field) const {
+    // 1d, empty and single band fields are stored as the encoder stores them
+    if (field.shape().size() == 1 || field.bytes() == 0 ||
+        field.shape()[0] <= band_rows_) {
+        return encoder_->encodeField(field);
+    }
+
+    FieldView view = uint_view(field);
+    // collapse shape
+    if (view.shape().size() > 2) {
+        size_t rows = view.shape()[0];
+        size_t cols = view.size() / rows;
+        view = view.reshape(rows, cols);
+    }
+
+    ScanChannelData buffer;
+    bool res = true;
+    switch (view.tag()) {
+        case sensor::ChanFieldType::UINT8:
+            res = encodeBandedImage<uint8_t>(buffer, view);
+            break;
+        case sensor::ChanFieldType::UINT16:
+            res = encodeBandedImage<uint16_t>(buffer, view);
+            break;
+        case sensor::ChanFieldType::UINT32:
+            res = encodeBandedImage<uint32_t>(buffer, view);
+            break;
+        case sensor::ChanFieldType::UINT64:
+            res = encodeBandedImage<uint64_t>(buffer, view);
+            break;
+        default:
+            break;
+    }
+
+    if (res) {
+        throw std::runtime_error("encodeField: could not encode field");
+    }
+
+    return buffer;
+}
+
+}  // namespace osf
+}  // namespace ouster
@@ -0,0 +1,328 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "chunk_file.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include "ouster/impl/logging.h"
+#include "ouster/osf/crc32.h"
+#include "ouster/threads.h"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <share.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace ouster::sensor;
+
+namespace ouster {
+namespace osf {
+
+namespace {
+
+// a multiple of the logical block size of the devices we record to
+constexpr uint64_t DIRECT_IO_ALIGNMENT = 4096;
+
+// chunks queued for the write thread before append() blocks
+constexpr size_t MAX_QUEUED_CHUNKS = 4;
+
+// largest single write, which Linux caps slightly below 2 GiB anyway
+constexpr uint64_t MAX_WRITE_SIZE = 1 << 30;
+
+uint64_t align_down(uint64_t n) {
+    return n / DIRECT_IO_ALIGNMENT * DIRECT_IO_ALIGNMENT;
+}
+
+uint64_t align_up(uint64_t n) {
+    return align_down(n + DIRECT_IO_ALIGNMENT - 1);
+}
+
+std::runtime_error io_error(const std::string& what,
+                            const std::string& filename) {
+    return std::runtime_error(what + " " + filename + ": " +
+                              std::strerror(errno));
+}
+
+}  // namespace
+
+ChunkFile::ChunkFile(const std::string& filename, uint64_t offset,
+                     const ChunkIoOptions& options)
+    : options_(options),
+      filename_(filename),
+      end_(offset),
+      allocated_(offset),
+      block_offset_(align_down(offset)) {
+#ifdef _WIN32
+    if (options_.direct) {
+        throw std::invalid_argument("Direct I/O is only supported on Linux");
+    }
+    if (_sopen_s(&fd_, filename.c_str(), _O_WRONLY | _O_BINARY, _SH_DENYNO,
+                 _S_IREAD | _S_IWRITE) != 0) {
+        fd_ = -1;
+    }
+#else
+#ifdef __linux__
+    if (options_.direct) {
+        // read access to pick up the header in the first partial block
+        fd_ = ::open(filename.c_str(), O_RDWR | O_DIRECT | O_CLOEXEC);
+        direct_ = fd_ >= 0;
+        if (!direct_ && errno == EINVAL) {
+            logger().warn(
+                "The file system of {} doesn't support direct I/O, writing "
+                "through the page cache",
+                filename);
+        }
+    }
+#else
+    if (options_.direct) {
+        throw std::invalid_argument("Direct I/O is only supported on Linux");
+    }
+#endif
+    if (fd_ < 0) fd_ = ::open(filename.c_str(), O_WRONLY | O_CLOEXEC);
+#endif
+    if (fd_ < 0) throw io_error("Failed to open", filename);
+
+#ifdef __linux__
+    if (direct_) {
+        block_buf_capacity_ = DIRECT_IO_ALIGNMENT;
+        if (posix_memalign(reinterpret_cast<void**>(&block_buf_),
+                           DIRECT_IO_ALIGNMENT, block_buf_capacity_) != 0) {
+            ::close(fd_);
+            throw std::bad_alloc();
+        }
+        block_buf_size_ = end_ - block_offset_;
+        if (block_buf_size_ > 0 &&
+            ::pread(fd_, block_buf_, DIRECT_IO_ALIGNMENT,
+                    static_cast<off_t>(block_offset_)) <
+                static_cast<ssize_t>(block_buf_size_)) {
+            auto error = io_error("Failed to read", filename);
+            std::free(block_buf_);
+            ::close(fd_);
+            throw error;
+        }
+    }
+#endif
+
+    if (options_.background) {
+        write_thread_ =
+            start_thread("ouster-osf-io", [this] { write_thread_method(); });
+    }
+}
+
+ChunkFile::~ChunkFile() { close(); }
+
+uint64_t ChunkFile::append(const uint8_t* buf, uint64_t size,
+                          bool barrier) {
+    if (failed_ || closed_) return 0;
+    if (!write_thread_.joinable()) {
+        try {
+            write_chunk(buf, size, barrier);
+        } catch (const std::exception& e) {
+            logger().error("ERROR: {}", e.what());
+            failed_ = true;
+            return 0;
+        }
+        return size + CRC_BYTES_SIZE;
+    }
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        queue_changed_.wait(
+            lock, [this] { return queue_.size() < MAX_QUEUED_CHUNKS; });
+        queue_.push_back({{buf, buf + size}, barrier});
+    }
+    queue_changed_.notify_all();
+    return size + CRC_BYTES_SIZE;
+}
+
+void ChunkFile::write_thread_method() {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    while (true) {
+        queue_changed_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+        // queued chunks are written before stopping
+        if (queue_.empty()) return;
+        // the chunk stays queued while it's written, so that it counts
+        // towards MAX_QUEUED_CHUNKS
+        const Queued& chunk = queue_.front();
+        lock.unlock();
+        if (!failed_) {
+            try {
+                write_chunk(chunk.buf.data(), chunk.buf.size(), chunk.barrier);
+            } catch (const std::exception& e) {
+                logger().error("ERROR: {}", e.what());
+                failed_ = true;
+            }
+        }
+        lock.lock();
+        queue_.pop_front();
+        queue_changed_.notify_all();
+    }
+}
+
+void ChunkFile::write_chunk(const uint8_t* buf, uint64_t size,
+                            bool barrier) {
+    const uint32_t crc_res = osf::crc32(buf, size);
+    if (barrier && !options_.sync_every_chunk) sync();
+    write(buf, size);
+    write(reinterpret_cast<const uint8_t*>(&crc_res), sizeof(crc_res));
+    if (options_.sync_every_chunk) sync();
+}
+
+void ChunkFile::write(const uint8_t* buf, uint64_t size) {
+    preallocate(end_ + size);
+    if (!direct_) {
+        write_at(buf, size, end_);
+        end_ += size;
+        return;
+    }
+
+#ifdef __linux__
+    const uint64_t needed = block_buf_size_ + size;
+    if (needed > block_buf_capacity_) {
+        uint8_t* grown = nullptr;
+        if (posix_memalign(reinterpret_cast<void**>(&grown),
+                           DIRECT_IO_ALIGNMENT, align_up(needed)) != 0) {
+            throw std::bad_alloc();
+        }
+        std::memcpy(grown, block_buf_, block_buf_size_);
+        std::free(block_buf_);
+        block_buf_ = grown;
+        block_buf_capacity_ = align_up(needed);
+    }
+    std::memcpy(block_buf_ + block_buf_size_, buf, size);
+    block_buf_size_ += size;
+    end_ += size;
+
+    // whole blocks go to the file, the partial one waits for more data
+    const uint64_t whole = align_down(block_buf_size_);
+    if (whole == 0) return;
+    write_at(block_buf_, whole, block_offset_);
+    block_offset_ += whole;
+    block_buf_size_ -= whole;
+    std::memmove(block_buf_, block_buf_ + whole, block_buf_size_);
+#endif
+}
+
+void ChunkFile::write_at(const uint8_t* buf, uint64_t size, uint64_t offset) {
+    while (size > 0) {
+        const uint64_t n = std::min(size, MAX_WRITE_SIZE);
+#ifdef _WIN32
+        if (_lseeki64(fd_, static_cast<__int64>(offset), SEEK_SET) < 0) {
+            throw io_error("Failed to seek in", filename_);
+        }
+        const int written = _write(fd_, buf, static_cast<unsigned>(n));
+#else
+        const ssize_t written =
+            ::pwrite(fd_, buf, n, static_cast<off_t>(offset));
+#endif
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            throw io_error("Failed to write to", filename_);
+        }
+        buf += written;
+        size -= static_cast<uint64_t>(written);
+        offset += static_cast<uint64_t>(written);
+    }
+}
+
+void ChunkFile::preallocate(uint64_t end) {
+#ifdef __linux__
+    if (options_.preallocate_bytes == 0 || end <= allocated_) return;
+    const uint64_t len = std::max(end - allocated_, options_.preallocate_bytes);
+    // the reserved space stays past the end of the file until it's written
+    if (::fallocate(fd_, FALLOC_FL_KEEP_SIZE, static_cast<off_t>(allocated_),
+                    static_cast<off_t>(len)) == 0) {
+        allocated_ += len;
+        return;
+    }
+    if (errno == EOPNOTSUPP) {
+        logger().warn(
+            "The file system of {} doesn't support preallocation, writing "
+            "without it",
+            filename_);
+        options_.preallocate_bytes = 0;
+        return;
+    }
+    throw io_error("Failed to preallocate space for", filename_);
+#else
+    (void)end;
+#endif
+}
+
+void ChunkFile::sync() {
+#ifdef _WIN32
+    if (_commit(fd_) != 0) throw io_error("Failed to sync", filename_);
+#elif defined(__linux__)
+    if (::fdatasync(fd_) != 0) throw io_error("Failed to sync", filename_);
+#else
+    if (::fsync(fd_) != 0) throw io_error("Failed to sync", filename_);
+#endif
+}
+
+void ChunkFile::finish() {
+#ifndef _WIN32
+    if (direct_ && block_buf_size_ > 0) {
+        const uint64_t padded = align_up(block_buf_size_);
+        std::memset(block_buf_ + block_buf_size_, 0, padded - block_buf_size_);
+        write_at(block_buf_, padded, block_offset_);
+    }
+    if (allocated_ > end_) {
+        // truncating to the current size may keep the blocks reserved past
+        // it, shrinking the file always releases them
+        if (::ftruncate(fd_, static_cast<off_t>(end_ + 1)) != 0) {
+            throw io_error("Failed to truncate", filename_);
+        }
+    }
+    if (direct_ || allocated_ > end_) {
+        // back to the end of the data, dropping the padding of the last block
+        if (::ftruncate(fd_, static_cast<off_t>(end_)) != 0) {
+            throw io_error("Failed to truncate", filename_);
+        }
+    }
+#endif
+    if (options_.sync_every_chunk) sync();
+}
+
+bool ChunkFile::close() {
+    if (closed_) return !failed_;
+    closed_ = true;
+    if (write_thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            stop_ = true;
+        }
+        queue_changed_.notify_all();
+        write_thread_.join();
+    }
+    if (!failed_) {
+        try {
+            finish();
+        } catch (const std::exception& e) {
+            logger().error("ERROR: {}", e.what());
+            failed_ = true;
+        }
+    }
+#ifdef _WIN32
+    _close(fd_);
+#else
+    ::close(fd_);
+#endif
+    std::free(block_buf_);
+    block_buf_ = nullptr;
+    return !failed_;
+}
+
+}  // namespace osf
+}  // namespace ouster
@@ -0,0 +1,119 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file chunk_file.h
+ * @brief Appends chunks to an OSF file through a persistent file descriptor
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ouster/osf/writer.h"
+
+namespace ouster {
+namespace osf {
+
+/**
+ * Appends CRC32 terminated buffers to a file that already holds the OSF
+ * header, following the ChunkIoOptions of the Writer.
+ *
+ * With direct I/O only whole blocks are written while recording and the
+ * partial block at the end of the data stays in memory until more data
+ * completes it or the file is closed.
+ */
+class ChunkFile {
+   public:
+    /**
+     * @throws std::runtime_error if the file can't be opened.
+     * @throws std::invalid_argument if direct I/O is requested on a platform
+     *                               that doesn't support it.
+     *
+     * @param[in] filename the file to append to.
+     * @param[in] offset the end of the data already in the file.
+     * @param[in] options how to write.
+     */
+    ChunkFile(const std::string& filename, uint64_t offset,
+              const ChunkIoOptions& options);
+
+    /** Closes the file if close() wasn't called. */
+    ~ChunkFile();
+
+    ChunkFile(const ChunkFile&) = delete;
+    ChunkFile& operator=(const ChunkFile&) = delete;
+
+    /**
+     * Append buf followed by its CRC32. With background writes this returns
+     * once the buffer is queued, and a failed write makes the following
+     * appends and close() fail.
+     *
+     * @param[in] buf the buffer to append.
+     * @param[in] size the size of the buffer.
+     * @param[in] barrier sync the data appended before, so that it reaches
+     *                    the disk ahead of buf. With direct I/O its last
+     *                    partial block is written together with buf.
+     * @return the number of bytes appended, 0 on error.
+     */
+    uint64_t append(const uint8_t* buf, uint64_t size, bool barrier = false);
+
+    /**
+     * Write everything queued, drop any space preallocated past the end of
+     * the data and close the file.
+     *
+     * @return false if any write failed.
+     */
+    bool close();
+
+   private:
+    void write_chunk(const uint8_t* buf, uint64_t size, bool barrier);
+    void write(const uint8_t* buf, uint64_t size);
+    void write_at(const uint8_t* buf, uint64_t size, uint64_t offset);
+    void preallocate(uint64_t end);
+    void sync();
+    void finish();
+    void write_thread_method();
+
+    ChunkIoOptions options_;
+    std::string filename_;
+    int fd_{-1};
+    bool direct_{false};
+
+    /** End of the data handed to write(). */
+    uint64_t end_{0};
+    /** End of the space reserved with fallocate. */
+    uint64_t allocated_{0};
+
+    /**
+     * Block aligned staging buffer for direct I/O, holding the data from
+     * block_offset_ on that isn't written yet.
+     */
+    uint8_t* block_buf_{nullptr};
+    uint64_t block_buf_capacity_{0};
+    uint64_t block_buf_size_{0};
+    uint64_t block_offset_{0};
+
+    /** Set on the first failed write, after which nothing more is written. */
+    std::atomic<bool> failed_{false};
+    bool closed_{false};
+
+    struct Queued {
+        std::vector<uint8_t> buf;
+        bool barrier;
+    };
+
+    std::deque<Queued> queue_;
+    std::mutex queue_mutex_;
+    std::condition_variable queue_changed_;
+    bool stop_{false};
+    std::thread write_thread_;
+};
+
+}  // namespace osf
+}  // namespace ouster
@@ -5,6 +5,8 @@
 
 #include "compat_ops.h"
 
+#include <algorithm>
+#include <cerrno>
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -17,6 +19,7 @@
 #include <io.h>
 #include <share.h>
 #include <shlwapi.h>
+#include <sys/stat.h>
 #include <tchar.h>
 #include <windows.h>
 #else
@@ -312,6 +315,87 @@ bool mmap_close(uint8_t* file_buf, const uint64_t file_size) {
 #endif
 }
 
+bool mmap_will_need(const uint8_t* file_buf, uint64_t offset, uint64_t size) {
+    if (file_buf == nullptr || size == 0) return false;
+#ifdef _WIN32
+    (void)offset;
+    return false;
+#else
+    // the advised range has to start on a page, the mapping itself does
+    const uint64_t page = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    const uint64_t start = offset / page * page;
+    return posix_madvise(const_cast<uint8_t*>(file_buf) + start,
+                         offset + size - start, POSIX_MADV_WILLNEED) == 0;
+#endif
+}
+
+int pread_open(const std::string& path, bool sequential) {
+#ifdef _WIN32
+    (void)sequential;
+    int fd = -1;
+    if (_sopen_s(&fd, path.c_str(), _O_RDONLY | _O_BINARY, _SH_DENYNO,
+                 _S_IREAD) != 0) {
+        return -1;
+    }
+    return fd;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+#ifdef POSIX_FADV_SEQUENTIAL
+    // only a hint, reading works the same if it's ignored
+    posix_fadvise(fd, 0, 0,
+                  sequential ? POSIX_FADV_SEQUENTIAL : POSIX_FADV_RANDOM);
+#else
+    (void)sequential;
+#endif
+    return fd;
+#endif
+}
+
+int64_t pread_at(int fd, uint8_t* buf, uint64_t count, uint64_t offset) {
+    uint64_t done = 0;
+    while (done < count) {
+        // single reads are capped slightly below 2 GiB on Linux anyway
+        const uint64_t n = std::min<uint64_t>(count - done, 1 << 30);
+#ifdef _WIN32
+        if (_lseeki64(fd, static_cast<__int64>(offset + done), SEEK_SET) < 0) {
+            return -1;
+        }
+        const int res = _read(fd, buf + done, static_cast<unsigned>(n));
+#else
+        const ssize_t res =
+            ::pread(fd, buf + done, n, static_cast<off_t>(offset + done));
+#endif
+        if (res < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (res == 0) break;
+        done += static_cast<uint64_t>(res);
+    }
+    return static_cast<int64_t>(done);
+}
+
+bool pread_will_need(int fd, uint64_t offset, uint64_t size) {
+    if (fd < 0 || size == 0) return false;
+#ifdef POSIX_FADV_WILLNEED
+    return posix_fadvise(fd, static_cast<off_t>(offset),
+                         static_cast<off_t>(size), POSIX_FADV_WILLNEED) == 0;
+#else
+    (void)offset;
+    return false;
+#endif
+}
+
+bool pread_close(int fd) {
+    if (fd < 0) return false;
+#ifdef _WIN32
+    return _close(fd) == 0;
+#else
+    return ::close(fd) == 0;
+#endif
+}
+
 int64_t truncate_file(const std::string& path, uint64_t filesize) {
     int64_t actual_file_size = file_size(path);
     if (actual_file_size < (int64_t)filesize) {
@@ -75,6 +75,30 @@ uint8_t* mmap_open(const std::string& path);
 OUSTER_API_FUNCTION
 bool mmap_close(uint8_t* file_buf, uint64_t file_size);
 
+/// Ask the OS to read a range of a file mapping into memory ahead of its use,
+/// returns false if the hint wasn't given, e.g. on Windows
+OUSTER_API_FUNCTION
+bool mmap_will_need(const uint8_t* file_buf, uint64_t offset, uint64_t size);
+
+/// Open a file for positioned reads, hinting the OS whether it's read
+/// sequentially or at random, returns -1 on error
+OUSTER_API_FUNCTION
+int pread_open(const std::string& path, bool sequential);
+
+/// Read count bytes at offset, retrying short reads, returns the bytes read,
+/// fewer than count at the end of the file, or -1 on error
+OUSTER_API_FUNCTION
+int64_t pread_at(int fd, uint8_t* buf, uint64_t count, uint64_t offset);
+
+/// Ask the OS to read a range of a file opened with pread_open into the page
+/// cache ahead of its use, returns false if the hint wasn't given
+OUSTER_API_FUNCTION
+bool pread_will_need(int fd, uint64_t offset, uint64_t size);
+
+/// Close a file opened with pread_open
+OUSTER_API_FUNCTION
+bool pread_close(int fd);
+
 /// Get the last system error and return it in a string (not wide string)
 /// @TODO Change up tests to not use this stuff
 OUSTER_API_FUNCTION
@@ -13,20 +13,152 @@
 #include <cstring>
 #include <iostream>
 
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define OUSTER_CRC32_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#define OUSTER_CRC32_ARM
+#include <arm_acle.h>
+#endif
+
 namespace ouster {
 namespace osf {
 
 const uint32_t CRC_INITIAL_VALUE = 0L;
 
-// =============== ZLIB functions wrappers ====================
+namespace {
+
+#ifdef OUSTER_CRC32_X86
+
+// Folding with carry-less multiplication, after "Fast CRC Computation for
+// Generic Polynomials Using PCLMULQDQ Instruction" (Intel, 2009), for the
+// bit-reflected CRC-32 polynomial that zlib uses. The kernel is compiled for
+// its instruction set regardless of the target flags and only called after a
+// runtime check, so the library still runs on older CPUs.
+
+// x^(4*128+32) mod P and x^(4*128-32) mod P, folding 4 lanes 64 bytes ahead
+alignas(16) const uint64_t k1k2[2] = {0x0154442bd4, 0x01c6e41596};
+// x^(128+32) mod P and x^(128-32) mod P, folding one lane 16 bytes ahead
+alignas(16) const uint64_t k3k4[2] = {0x01751997d0, 0x00ccaa009e};
+// x^64 mod P, folding 96 bits to 64
+alignas(16) const uint64_t k5k0[2] = {0x0163cd6124, 0x0000000000};
+// P and its Barrett constant floor(x^64 / P)
+alignas(16) const uint64_t poly[2] = {0x01db710641, 0x01f7011641};
+
+inline __m128i load(const uint8_t* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+// fold a lane forward by the distance of k onto the next data
+__attribute__((target("pclmul"))) inline __m128i fold(__m128i x, __m128i k,
+                                                      __m128i next) {
+    const __m128i lo = _mm_clmulepi64_si128(x, k, 0x00);
+    const __m128i hi = _mm_clmulepi64_si128(x, k, 0x11);
+    return _mm_xor_si128(_mm_xor_si128(hi, lo), next);
+}
+
+/**
+ * Update the running (inverted) crc with len bytes, len being a multiple of
+ * 16 of at least 64.
+ */
+__attribute__((target("pclmul,sse4.1"))) uint32_t crc32_pclmul(
+    uint32_t crc, const uint8_t* buf, size_t len) {
+    __m128i x1 = _mm_xor_si128(load(buf), _mm_cvtsi32_si128(crc));
+    __m128i x2 = load(buf + 16);
+    __m128i x3 = load(buf + 32);
+    __m128i x4 = load(buf + 48);
+    buf += 64;
+    len -= 64;
+
+    __m128i k = _mm_load_si128(reinterpret_cast<const __m128i*>(k1k2));
+    for (; len >= 64; buf += 64, len -= 64) {
+        x1 = fold(x1, k, load(buf));
+        x2 = fold(x2, k, load(buf + 16));
+        x3 = fold(x3, k, load(buf + 32));
+        x4 = fold(x4, k, load(buf + 48));
+    }
+
+    k = _mm_load_si128(reinterpret_cast<const __m128i*>(k3k4));
+    x1 = fold(x1, k, x2);
+    x1 = fold(x1, k, x3);
+    x1 = fold(x1, k, x4);
+    for (; len >= 16; buf += 16, len -= 16) {
+        x1 = fold(x1, k, load(buf));
+    }
+
+    // 128 bits to 64
+    const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+    __m128i t = _mm_clmulepi64_si128(x1, k, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), t);
+    k = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(k5k0));
+    t = _mm_srli_si128(x1, 4);
+    x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k, 0x00);
+    x1 = _mm_xor_si128(x1, t);
+
+    // Barrett reduction to 32 bits
+    k = _mm_load_si128(reinterpret_cast<const __m128i*>(poly));
+    t = _mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k, 0x10);
+    t = _mm_clmulepi64_si128(_mm_and_si128(t, mask32), k, 0x00);
+    x1 = _mm_xor_si128(x1, t);
+    return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+bool has_pclmul() {
+    static const bool supported = __builtin_cpu_supports("pclmul") &&
+                                  __builtin_cpu_supports("sse4.1");
+    return supported;
+}
+
+#endif
+
+#ifdef OUSTER_CRC32_ARM
+
+// ARMv8 CRC32 instructions compute the same polynomial one word at a time
+uint32_t crc32_arm(uint32_t crc, const uint8_t* buf, size_t len) {
+    crc = ~crc;
+    for (; len >= 8; buf += 8, len -= 8) {
+        uint64_t word;
+        std::memcpy(&word, buf, sizeof(word));
+        crc = __crc32d(crc, word);
+    }
+    for (; len > 0; buf++, len--) crc = __crc32b(crc, *buf);
+    return ~crc;
+}
+
+#endif
+
+// Below this size the setup of the folding kernel isn't worth it
+constexpr size_t CRC_FOLD_MIN_SIZE = 256;
+
+uint32_t crc32_update(uint32_t crc, const uint8_t* buf, size_t size) {
+#ifdef OUSTER_CRC32_ARM
+    return crc32_arm(crc, buf, size);
+#else
+#ifdef OUSTER_CRC32_X86
+    if (size >= CRC_FOLD_MIN_SIZE && has_pclmul()) {
+        const size_t folded = size & ~static_cast<size_t>(15);
+        crc = ~crc32_pclmul(~crc, buf, folded);
+        buf += folded;
+        size -= folded;
+    }
+#endif
+    return crc32_z(crc, buf, size);
+#endif
+}
+
+}  // namespace
+
+// =============== ZLIB compatible functions ====================
 
 uint32_t crc32(const uint8_t* buf, uint32_t size) {
-    return crc32_z(CRC_INITIAL_VALUE, buf, size);
+    return crc32_update(CRC_INITIAL_VALUE, buf, size);
 }
 
 uint32_t crc32(uint32_t initial_crc, const uint8_t* buf, uint32_t size) {
-    return crc32_z(initial_crc, buf, size);
+    return crc32_update(initial_crc, buf, size);
 }
 
 }  // namespace osf
-}  // namespace ouster
\ No newline at end of file
+}  // namespace ouster
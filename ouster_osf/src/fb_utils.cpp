@@ -33,6 +33,19 @@ bool check_osf_chunk_buf(const uint8_t* buf, const uint32_t buf_size) {
            gen::VerifySizePrefixedChunkBuffer(verifier);
 }
 
+ts_t lidar_scan_msg_sensor_ts(const uint8_t* msg_buf) {
+    auto ls_msg = flatbuffers::GetSizePrefixedRoot<gen::LidarScanMsg>(msg_buf);
+    auto timestamps = ls_msg->header_timestamp();
+    auto status = ls_msg->header_status();
+    if (timestamps && status) {
+        for (uint32_t i = 0; i < timestamps->size() && i < status->size();
+             ++i) {
+            if (status->Get(i) & 1) return ts_t{timestamps->Get(i)};
+        }
+    }
+    return ts_t{0};
+}
+
 template <typename T>
 std::vector<T> vector_from_fb_vector(const flatbuffers::Vector<T>* fb_vec) {
     if (fb_vec == nullptr) return {};
@@ -69,6 +69,16 @@ bool check_osf_metadata_buf(const uint8_t* buf, uint32_t buf_size);
 OUSTER_API_FUNCTION
 bool check_osf_chunk_buf(const uint8_t* buf, uint32_t buf_size);
 
+/**
+ * The sensor timestamp Writer::save() records for a lidar scan, the
+ * timestamp of its first valid column.
+ *
+ * @param[in] msg_buf LidarScanMsg buffer, size prefixed
+ * @return the sensor timestamp, 0 if no column is valid
+ */
+OUSTER_API_FUNCTION
+ts_t lidar_scan_msg_sensor_ts(const uint8_t* msg_buf);
+
 /**
  * Transforms Flatbuffers vector to a std::vector.
  * @TODO Change up tests to not use this stuff
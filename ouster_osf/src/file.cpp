@@ -5,15 +5,18 @@
 
 #include "ouster/osf/file.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
 #include <cstring>
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 
 #include "compat_ops.h"
 #include "fb_utils.h"
+#include "http_file.h"
 #include "ouster/impl/logging.h"
 #include "ouster/osf/crc32.h"
 
@@ -33,6 +36,15 @@ inline void print_error(const std::string& filename, const std::string& msg) {
 #define print_error(a, b) ((void)0)
 #endif
 
+// PREAD reads whole blocks of the file system, as it would from the disk
+constexpr uint64_t READ_ALIGNMENT = 4096;
+
+uint64_t align_read_ahead(uint64_t read_ahead) {
+    return std::max((read_ahead + READ_ALIGNMENT - 1) / READ_ALIGNMENT *
+                        READ_ALIGNMENT,
+                    READ_ALIGNMENT);
+}
+
 }  // namespace
 
 // ======== Construction ============
@@ -54,53 +66,99 @@ OsfFile::OsfFile(const std::string& filename, OpenMode mode) : OsfFile() {
 
     // TODO[pb]: Extract to open function
     if (mode == OpenMode::READ) {
-        if (is_dir(filename_)) {
-            error("got a dir, but expected a file");
-            return;
-        }
+        open_read();
+    } else {
+        // Write is not yet implemented within this class. And other modes
+        // too.
+        error("write mode not implemented");
+        return;
+    }
+}
 
-        int64_t sz = file_size(filename_);
-        if (sz <= 0) {
-            error();
+OsfFile::OsfFile(const std::string& filename, const FileOptions& options)
+    : OsfFile() {
+    filename_ = filename;
+    options_ = options;
+    open_read();
+}
+
+void OsfFile::open_read() {
+    if (options_.backend == FileBackend::DEFAULT && is_http_url(filename_)) {
+        options_.backend = FileBackend::HTTP;
+    }
+    if (options_.backend == FileBackend::HTTP) {
+        options_.read_ahead = align_read_ahead(options_.read_ahead);
+        try {
+            http_ = std::make_unique<HttpFile>(filename_,
+                                               options_.timeout_seconds);
+        } catch (const std::exception& e) {
+            error(e.what());
             return;
         }
-        // TODO[pb]: This leads to incorrect file size for 4Gb+ files on the
-        //           32 bit systems like Emscripten/WASM. We need to check
-        //           size_t everywhere and replace it so it can hold file
-        //           sizes and file offsets bigger than 4Gb in 32 bit systems.
-        size_ = static_cast<uint64_t>(sz);
+        size_ = http_->size();
+        state_ = FileState::GOOD;
+        return;
+    }
+
+    if (is_dir(filename_)) {
+        error("got a dir, but expected a file");
+        return;
+    }
+
+    int64_t sz = file_size(filename_);
+    if (sz <= 0) {
+        error();
+        return;
+    }
+    // TODO[pb]: This leads to incorrect file size for 4Gb+ files on the
+    //           32 bit systems like Emscripten/WASM. We need to check
+    //           size_t everywhere and replace it so it can hold file
+    //           sizes and file offsets bigger than 4Gb in 32 bit systems.
+    size_ = static_cast<uint64_t>(sz);
 
+    if (options_.backend == FileBackend::DEFAULT) {
 #ifdef OUSTER_OSF_NO_MMAP
-        // TODO[pb]: Maybe consider adding a runtime parameter to open file
-        // with mmap or open/read? Also better handling/removing of class
-        // members for OsfFile can be done so we are not copying empty
-        // values when NO_MMAP is absent... But I can't make my mind
-        // about RUNTIME/COMPILATION time parametrization and for now
-        // will leave it in a half backed state: COMPILE time directive
-        // but some fields will be left empty and copied/check during runtime
-        // there is no hit in performance/memory due to this leftovers
-        // that I could spot.
-        file_stream_ =
-            std::ifstream(filename_, std::ios::in | std::ios::binary);
-        if (!file_stream_.good()) {
-            error();
-            return;
-        }
+        options_.backend = FileBackend::STREAM;
 #else
-        file_buf_ = mmap_open(filename_);
-        if (!file_buf_) {
-            error();
-            return;
-        }
+        options_.backend = FileBackend::MMAP;
 #endif
+    }
 
-        state_ = FileState::GOOD;
-    } else {
-        // Write is not yet implemented within this class. And other modes
-        // too.
-        error("write mode not implemented");
-        return;
+    switch (options_.backend) {
+        case FileBackend::MMAP:
+#ifdef OUSTER_OSF_NO_MMAP
+            error("mmap is not available in this build");
+            return;
+#else
+            file_buf_ = mmap_open(filename_);
+            if (!file_buf_) {
+                error();
+                return;
+            }
+            break;
+#endif
+        case FileBackend::STREAM:
+            file_stream_ =
+                std::ifstream(filename_, std::ios::in | std::ios::binary);
+            if (!file_stream_.good()) {
+                error();
+                return;
+            }
+            break;
+        case FileBackend::PREAD:
+            options_.read_ahead = align_read_ahead(options_.read_ahead);
+            fd_ = pread_open(filename_, options_.sequential);
+            if (fd_ < 0) {
+                error();
+                return;
+            }
+            break;
+        default:
+            error("unknown file backend");
+            return;
     }
+
+    state_ = FileState::GOOD;
 }
 
 uint64_t OsfFile::size() const { return size_; };
@@ -227,10 +285,70 @@ OsfFile& OsfFile::read(uint8_t* buf, const uint64_t count) {
     } else if (file_buf_ != nullptr) {
         std::memcpy(buf, file_buf_ + offset_, count);
         offset_ += count;
+    } else if (fd_ >= 0 || http_) {
+        pread_buffered(buf, count);
     }
     return *this;
 }
 
+void OsfFile::pread_buffered(uint8_t* buf, uint64_t count) {
+    while (count > 0) {
+        const uint64_t buf_end = read_buf_offset_ + read_buf_.size();
+        if (offset_ >= read_buf_offset_ && offset_ < buf_end) {
+            const uint64_t n = std::min(count, buf_end - offset_);
+            std::memcpy(buf, read_buf_.data() + (offset_ - read_buf_offset_),
+                        n);
+            buf += n;
+            count -= n;
+            offset_ += n;
+            continue;
+        }
+        if (count >= options_.read_ahead) {
+            // large reads go straight to the destination
+            pread_exact(buf, count, offset_);
+            offset_ += count;
+            return;
+        }
+        // refill the buffer with the blocks from offset_ on
+        const uint64_t start = offset_ / READ_ALIGNMENT * READ_ALIGNMENT;
+        const uint64_t len = std::min(options_.read_ahead, size_ - start);
+        read_buf_.resize(len);
+        read_buf_offset_ = start;
+        try {
+            pread_exact(read_buf_.data(), len, start);
+        } catch (...) {
+            read_buf_.clear();
+            throw;
+        }
+        if (options_.sequential && start + len < size_) {
+            will_need(start + len,
+                      std::min(options_.read_ahead, size_ - start - len));
+        }
+    }
+}
+
+void OsfFile::pread_exact(uint8_t* buf, uint64_t count, uint64_t offset) {
+    if (http_) {
+        http_->read(buf, count, offset);
+        return;
+    }
+    const int64_t res = pread_at(fd_, buf, count, offset);
+    if (res < 0 || static_cast<uint64_t>(res) != count) {
+        std::stringstream ss;
+        ss << "failed to read " << count << " bytes at " << offset << " from "
+           << filename_ << ": " << (res < 0 ? get_last_error() : "short read");
+        throw std::runtime_error(ss.str());
+    }
+}
+
+void OsfFile::will_need(uint64_t offset, uint64_t count) const {
+    if (http_) {
+        http_->prefetch(offset, count);
+    } else if (fd_ >= 0) {
+        pread_will_need(fd_, offset, count);
+    }
+}
+
 // ===== Mmapped access to the file content memory =====
 
 const uint8_t* OsfFile::buf(const uint64_t offset) const {
@@ -243,6 +361,8 @@ const uint8_t* OsfFile::buf(const uint64_t offset) const {
 
 bool OsfFile::is_memory_mapped() const { return file_buf_ != nullptr; }
 
+const FileOptions& OsfFile::options() const { return options_; }
+
 // ======= Helpers =============
 
 void OsfFile::error(const std::string& msg) {
@@ -278,10 +398,16 @@ OsfFile::OsfFile(OsfFile&& other)
       size_(other.size_),
       file_buf_(other.file_buf_),
       file_stream_(std::move(other.file_stream_)),
+      options_(other.options_),
+      fd_(other.fd_),
+      http_(std::move(other.http_)),
+      read_buf_(std::move(other.read_buf_)),
+      read_buf_offset_(other.read_buf_offset_),
       header_chunk_(std::move(other.header_chunk_)),
       metadata_chunk_(std::move(other.metadata_chunk_)),
       state_(other.state_) {
     other.file_buf_ = nullptr;
+    other.fd_ = -1;
     other.state_ = FileState::BAD;
 }
 
@@ -293,10 +419,16 @@ OsfFile& OsfFile::operator=(OsfFile&& other) {
         size_ = other.size_;
         file_buf_ = other.file_buf_;
         file_stream_ = std::move(other.file_stream_);
+        options_ = other.options_;
+        fd_ = other.fd_;
+        http_ = std::move(other.http_);
+        read_buf_ = std::move(other.read_buf_);
+        read_buf_offset_ = other.read_buf_offset_;
         header_chunk_ = std::move(other.header_chunk_);
         metadata_chunk_ = std::move(other.metadata_chunk_);
         state_ = other.state_;
         other.file_buf_ = nullptr;
+        other.fd_ = -1;
         other.state_ = FileState::BAD;
     }
     return *this;
@@ -321,6 +453,21 @@ void OsfFile::close() {
         }
         state_ = FileState::BAD;
     }
+    if (fd_ >= 0) {
+        const bool closed = pread_close(fd_);
+        fd_ = -1;
+        read_buf_ = {};
+        if (!closed) {
+            error();
+            return;
+        }
+        state_ = FileState::BAD;
+    }
+    if (http_) {
+        http_.reset();
+        read_buf_ = {};
+        state_ = FileState::BAD;
+    }
 }
 
 OsfFile::~OsfFile() {
@@ -362,6 +509,25 @@ std::shared_ptr<ChunkBuffer> OsfFile::read_chunk(const uint64_t offset) {
     return chunk_cache_;
 }
 
+void OsfFile::prefetch_chunk(const uint64_t offset) const {
+    if (!good() || offset >= size_) return;
+    if (fd_ >= 0 || http_) {
+        // the size of the chunk would take a read, which is what's avoided,
+        // and the range is the one the read ahead buffer is refilled with
+        const uint64_t start = offset / READ_ALIGNMENT * READ_ALIGNMENT;
+        will_need(start, std::min(options_.read_ahead, size_ - start));
+        return;
+    }
+    if (!is_memory_mapped() || offset + FLATBUFFERS_PREFIX_LENGTH > size_) {
+        return;
+    }
+    const uint64_t full_chunk_size =
+        static_cast<uint64_t>(get_prefixed_size(file_buf_ + offset)) +
+        FLATBUFFERS_PREFIX_LENGTH + CRC_BYTES_SIZE;
+    mmap_will_need(file_buf_, offset,
+                   std::min(full_chunk_size, size_ - offset));
+}
+
 uint8_t* OsfFile::get_header_chunk_ptr() {
     if (!file_stream_.good()) {
         if (header_chunk_) header_chunk_.reset();
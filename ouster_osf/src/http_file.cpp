@@ -0,0 +1,235 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "http_file.h"
+
+#include <curl/curl.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include "ouster/impl/logging.h"
+
+using namespace ouster::sensor;
+
+namespace ouster {
+namespace osf {
+
+namespace {
+
+// ranges held for reads, beyond which no more are prefetched
+constexpr size_t MAX_PREFETCHED = 8;
+
+// attempts of a request failing with a server error or a network error
+constexpr int ATTEMPTS = 3;
+constexpr int RETRY_DELAY_MS = 500;
+
+struct RangeResponse {
+    uint8_t* buf;
+    uint64_t count;
+    uint64_t received;
+    /** The size of the file from the Content-Range, 0 if missing. */
+    uint64_t total;
+};
+
+size_t write_callback(char* data, size_t size, size_t nmemb, void* user) {
+    auto* response = static_cast<RangeResponse*>(user);
+    const uint64_t n = static_cast<uint64_t>(size) * nmemb;
+    // more than requested, the server ignored the range
+    if (response->received + n > response->count) return 0;
+    std::memcpy(response->buf + response->received, data, n);
+    response->received += n;
+    return n;
+}
+
+size_t header_callback(char* data, size_t size, size_t nmemb, void* user) {
+    auto* response = static_cast<RangeResponse*>(user);
+    const size_t n = size * nmemb;
+    // Content-Range: bytes <first>-<last>/<size>
+    static const std::string name = "content-range:";
+    if (n > name.size()) {
+        std::string line(data, n);
+        std::transform(line.begin(), line.begin() + name.size(), line.begin(),
+                       [](unsigned char c) { return std::tolower(c); });
+        const auto slash = line.find('/');
+        if (line.compare(0, name.size(), name) == 0 &&
+            slash != std::string::npos) {
+            response->total = std::strtoull(line.c_str() + slash + 1,
+                                            nullptr, 10);
+        }
+    }
+    return n;
+}
+
+using CurlHandle = std::unique_ptr<CURL, decltype(&curl_easy_cleanup)>;
+
+}  // namespace
+
+HttpFile::HttpFile(const std::string& url, int timeout_seconds)
+    : url_(url),
+      // presigned URLs carry credentials in the query, kept out of messages
+      name_(url.substr(0, url.find('?'))),
+      timeout_seconds_(timeout_seconds) {
+    curl_global_init(CURL_GLOBAL_ALL);
+    try {
+        uint8_t first_byte = 0;
+        size_ = fetch(&first_byte, 1, 0);
+    } catch (...) {
+        curl_global_cleanup();
+        throw;
+    }
+    if (size_ == 0) {
+        curl_global_cleanup();
+        throw std::runtime_error("HttpFile: no size of " + name_ +
+                                 " in the Content-Range of the response");
+    }
+}
+
+HttpFile::~HttpFile() {
+    // the futures of std::async wait for their fetch when released
+    prefetched_.clear();
+    curl_global_cleanup();
+}
+
+uint64_t HttpFile::size() const { return size_; }
+
+void HttpFile::read(uint8_t* buf, uint64_t count, uint64_t offset) {
+    if (count == 0) return;
+    std::shared_future<std::vector<uint8_t>> data;
+    uint64_t data_offset = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = prefetched_.upper_bound(offset);
+        if (it != prefetched_.begin()) {
+            --it;
+            if (offset + count <= it->first + it->second.count) {
+                data = it->second.data;
+                data_offset = it->first;
+            }
+        }
+    }
+    if (data.valid()) {
+        try {
+            const std::vector<uint8_t>& bytes = data.get();
+            std::memcpy(buf, bytes.data() + (offset - data_offset), count);
+            return;
+        } catch (const std::exception&) {
+            // a failed prefetch is retried by the read
+            std::lock_guard<std::mutex> lock(mutex_);
+            prefetched_.erase(data_offset);
+        }
+    }
+    fetch(buf, count, offset);
+}
+
+void HttpFile::prefetch(uint64_t offset, uint64_t count) {
+#ifdef OUSTER_OSF_NO_THREADING
+    (void)offset;
+    (void)count;
+#else
+    if (offset >= size_) return;
+    count = std::min(count, size_ - offset);
+    if (count == 0) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = prefetched_.upper_bound(offset);
+    if (it != prefetched_.begin() &&
+        offset + count <= std::prev(it)->first + std::prev(it)->second.count) {
+        return;
+    }
+    // make room by dropping the fetched ranges with the lowest offsets first,
+    // which a sequential read is done with
+    for (auto p = prefetched_.begin();
+         p != prefetched_.end() && prefetched_.size() >= MAX_PREFETCHED;) {
+        if (p->second.data.wait_for(std::chrono::seconds(0)) ==
+            std::future_status::ready) {
+            p = prefetched_.erase(p);
+        } else {
+            ++p;
+        }
+    }
+    if (prefetched_.size() >= MAX_PREFETCHED) return;
+
+    prefetched_[offset] = Prefetched{
+        count, std::async(std::launch::async, [this, offset, count] {
+                   std::vector<uint8_t> data(count);
+                   fetch(data.data(), count, offset);
+                   return data;
+               }).share()};
+#endif
+}
+
+uint64_t HttpFile::fetch(uint8_t* buf, uint64_t count, uint64_t offset) const {
+    CurlHandle curl(curl_easy_init(), &curl_easy_cleanup);
+    if (!curl) throw std::runtime_error("HttpFile: failed to init curl");
+
+    const std::string range =
+        std::to_string(offset) + "-" + std::to_string(offset + count - 1);
+    RangeResponse response{buf, count, 0, 0};
+    CURL* h = curl.get();
+    curl_easy_setopt(h, CURLOPT_URL, url_.c_str());
+    curl_easy_setopt(h, CURLOPT_RANGE, range.c_str());
+    curl_easy_setopt(h, CURLOPT_FOLLOWLOCATION, 1L);
+    // timeouts without signals, which can't be used from multiple threads
+    curl_easy_setopt(h, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(h, CURLOPT_TIMEOUT, static_cast<long>(timeout_seconds_));
+    curl_easy_setopt(h, CURLOPT_WRITEFUNCTION, &write_callback);
+    curl_easy_setopt(h, CURLOPT_WRITEDATA, &response);
+    curl_easy_setopt(h, CURLOPT_HEADERFUNCTION, &header_callback);
+    curl_easy_setopt(h, CURLOPT_HEADERDATA, &response);
+
+    for (int attempt = 1;; ++attempt) {
+        response.received = 0;
+        response.total = 0;
+        const CURLcode res = curl_easy_perform(h);
+        long http_code = 0;
+        curl_easy_getinfo(h, CURLINFO_RESPONSE_CODE, &http_code);
+        if (res == CURLE_OK && http_code == 206) break;
+
+        // the whole file instead of the range
+        if (res == CURLE_WRITE_ERROR || (res == CURLE_OK && http_code == 200)) {
+            throw std::runtime_error("HttpFile: " + name_ +
+                                     " doesn't support range requests");
+        }
+        const bool server_error = res == CURLE_OK && http_code >= 500;
+        if (attempt >= ATTEMPTS || (res == CURLE_OK && !server_error)) {
+            std::stringstream ss;
+            ss << "HttpFile: failed to read " << count << " bytes at "
+               << offset << " from " << name_ << ": ";
+            if (res != CURLE_OK) {
+                ss << curl_easy_strerror(res);
+            } else {
+                ss << "HTTP " << http_code;
+            }
+            throw std::runtime_error(ss.str());
+        }
+        logger().warn("Re-attempting the read of {} bytes at {} from {}",
+                      count, offset, name_);
+        std::this_thread::sleep_for(std::chrono::milliseconds(RETRY_DELAY_MS));
+    }
+
+    if (response.received != count) {
+        std::stringstream ss;
+        ss << "HttpFile: short read of " << response.received << " of "
+           << count << " bytes at " << offset << " from " << name_;
+        throw std::runtime_error(ss.str());
+    }
+    return response.total;
+}
+
+bool is_http_url(const std::string& filename) {
+    return filename.compare(0, 7, "http://") == 0 ||
+           filename.compare(0, 8, "https://") == 0;
+}
+
+}  // namespace osf
+}  // namespace ouster
@@ -0,0 +1,110 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file http_file.h
+ * @brief Reads byte ranges of a file served over HTTP with libcurl
+ */
+#pragma once
+
+#include <cstdint>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ouster {
+namespace osf {
+
+/**
+ * Reads byte ranges of a file served over HTTP(S), e.g. an object in S3
+ * compatible storage through a presigned URL, with HTTP range requests.
+ *
+ * Ranges can be prefetched, which fetches them concurrently in the
+ * background until a read needs them. Safe to use from multiple threads,
+ * each request uses a curl handle of its own.
+ */
+class HttpFile {
+   public:
+    /**
+     * Get the size of the file with a request of its first byte.
+     *
+     * @throws std::runtime_error if the request fails or the server doesn't
+     *                            support range requests.
+     *
+     * @param[in] url the URL of the file.
+     * @param[in] timeout_seconds the timeout of each request.
+     */
+    HttpFile(const std::string& url, int timeout_seconds);
+
+    /** Waits for the prefetches in flight. */
+    ~HttpFile();
+
+    HttpFile(const HttpFile&) = delete;
+    HttpFile& operator=(const HttpFile&) = delete;
+
+    /**
+     * @return the size of the file in bytes.
+     */
+    uint64_t size() const;
+
+    /**
+     * Read exactly count bytes at offset, from a prefetched range holding
+     * them or with a request of their own.
+     *
+     * @throws std::runtime_error if the request fails.
+     *
+     * @param[out] buf the buffer to write to.
+     * @param[in] count the number of bytes to read.
+     * @param[in] offset the offset to read from.
+     */
+    void read(uint8_t* buf, uint64_t count, uint64_t offset);
+
+    /**
+     * Start fetching a range in the background, unless a prefetched range
+     * already holds it or too many are held. Errors are left to the read.
+     *
+     * @param[in] offset the offset of the range.
+     * @param[in] count the size of the range.
+     */
+    void prefetch(uint64_t offset, uint64_t count);
+
+   private:
+    /**
+     * Fetch a range with a request of its own, retrying server errors.
+     *
+     * @throws std::runtime_error if the request fails.
+     *
+     * @param[out] buf the buffer to write to.
+     * @param[in] count the number of bytes to read.
+     * @param[in] offset the offset to read from.
+     * @return the size of the file from the Content-Range of the response,
+     *         0 if missing.
+     */
+    uint64_t fetch(uint8_t* buf, uint64_t count, uint64_t offset) const;
+
+    std::string url_;
+    /** The URL without its query, for messages. */
+    std::string name_;
+    int timeout_seconds_;
+    uint64_t size_{0};
+
+    struct Prefetched {
+        uint64_t count;
+        std::shared_future<std::vector<uint8_t>> data;
+    };
+
+    /** Prefetched ranges by offset, guarded by mutex_. */
+    std::map<uint64_t, Prefetched> prefetched_;
+    std::mutex mutex_;
+};
+
+/**
+ * @param[in] filename the name to check.
+ * @return whether the name is an http:// or https:// URL.
+ */
+bool is_http_url(const std::string& filename);
+
+}  // namespace osf
+}  // namespace ouster
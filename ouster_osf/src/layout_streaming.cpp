@@ -5,24 +5,59 @@
 
 #include "ouster/osf/layout_streaming.h"
 
+#include <algorithm>
 #include <vector>
 
+#include "chunk_generated.h"
 #include "ouster/osf/meta_streaming_info.h"
 #include "ouster/osf/writer.h"
 
 namespace ouster {
 namespace osf {
 
+namespace {
+
+// Chunks are allocated up front at the size their policy finishes them at,
+// up to this size, and grow past it as needed
+constexpr uint32_t MAX_PREALLOCATED_CHUNK_SIZE = 64 * 1024 * 1024;
+
+// room for the vector of messages and the header of a finished chunk
+constexpr uint32_t CHUNK_OVERHEAD_SIZE = 4096;
+
+uint32_t chunk_capacity(const ChunkPolicy& policy) {
+    if (policy.max_size == 0) return STREAMING_DEFAULT_CHUNK_SIZE;
+    return std::min(policy.max_size, MAX_PREALLOCATED_CHUNK_SIZE) +
+           CHUNK_OVERHEAD_SIZE;
+}
+
+}  // namespace
+
 StreamingLayoutCW::StreamingLayoutCW(Writer& writer, uint32_t chunk_size)
     : chunk_size_{chunk_size ? chunk_size : STREAMING_DEFAULT_CHUNK_SIZE},
+      default_policy_{chunk_size_, 0, ts_t{0}},
       writer_{writer} {}
 
 void StreamingLayoutCW::save_message(const uint32_t stream_id,
                                      const ts_t receive_ts,
                                      const ts_t sensor_ts,
                                      const std::vector<uint8_t>& msg_buf) {
+    save(stream_id, receive_ts, sensor_ts, msg_buf, true);
+}
+
+void StreamingLayoutCW::save_delta_message(
+    const uint32_t stream_id, const ts_t receive_ts, const ts_t sensor_ts,
+    const std::vector<uint8_t>& msg_buf) {
+    save(stream_id, receive_ts, sensor_ts, msg_buf, false);
+}
+
+void StreamingLayoutCW::save(const uint32_t stream_id, const ts_t receive_ts,
+                             const ts_t sensor_ts,
+                             const std::vector<uint8_t>& msg_buf,
+                             bool may_finish_chunk) {
     if (!chunk_builders_.count(stream_id)) {
-        chunk_builders_.insert({stream_id, std::make_shared<ChunkBuilder>()});
+        chunk_builders_.insert(
+            {stream_id, std::make_shared<ChunkBuilder>(
+                            chunk_capacity(chunk_policy(stream_id)))});
     }
 
     auto chunk_builder = chunk_builders_[stream_id];
@@ -37,14 +72,75 @@ void StreamingLayoutCW::save_message(const uint32_t stream_id,
         throw std::logic_error(err.str());
     }
 
-    if (chunk_builder->size() + msg_buf.size() > chunk_size_) {
-        finish_chunk(stream_id, chunk_builder);
+    // delta frames stay with their keyframe even if the chunk grows past
+    // the limits of the policy
+    if (may_finish_chunk && chunk_builder->messages_count() > 0) {
+        const ChunkPolicy policy = chunk_policy(stream_id);
+        if ((policy.max_size &&
+             chunk_builder->size() + msg_buf.size() > policy.max_size) ||
+            (policy.max_messages &&
+             chunk_builder->messages_count() >= policy.max_messages) ||
+            (policy.max_duration.count() &&
+             receive_ts - chunk_builder->start_ts() > policy.max_duration)) {
+            finish_chunk(stream_id, chunk_builder);
+        }
     }
 
     chunk_builder->save_message(stream_id, receive_ts, sensor_ts, msg_buf);
 
-    // update running statistics per stream
-    stats_message(stream_id, receive_ts, sensor_ts, msg_buf);
+    // counted in the running statistics per stream with its chunk
+    unwritten_stats_[stream_id].push_back(
+        {receive_ts, sensor_ts, static_cast<uint32_t>(msg_buf.size())});
+}
+
+void StreamingLayoutCW::save_chunk(const uint32_t stream_id,
+                                   const std::vector<uint8_t>& chunk_buf,
+                                   const std::vector<ts_t>& sensor_ts) {
+    auto messages = gen::GetSizePrefixedChunk(chunk_buf.data())->messages();
+    if (!messages || messages->size() == 0) return;
+    ts_t start_ts = ts_t::max();
+    ts_t end_ts = ts_t::min();
+    for (uint32_t i = 0; i < messages->size(); ++i) {
+        const ts_t receive_ts{messages->Get(i)->ts()};
+        start_ts = std::min(start_ts, receive_ts);
+        end_ts = std::max(end_ts, receive_ts);
+    }
+
+    // the messages of the stream saved before go to a chunk of their own,
+    // written ahead of this one
+    auto cb_it = chunk_builders_.find(stream_id);
+    if (cb_it != chunk_builders_.end()) {
+        if (cb_it->second->end_ts() > start_ts) {
+            std::stringstream err;
+            err << "ERROR: Can't write with a decreasing timestamp: "
+                << start_ts.count() << " for stream_id: " << stream_id
+                << " ( previous recorded timestamp: "
+                << cb_it->second->end_ts().count() << ")";
+            throw std::logic_error(err.str());
+        }
+        finish_chunk(stream_id, cb_it->second);
+    }
+
+    uint64_t chunk_offset = writer_.emit_chunk(start_ts, end_ts, chunk_buf);
+    chunk_stream_id_.emplace_back(
+        chunk_offset, ChunkInfo{chunk_offset, stream_id, messages->size()});
+    for (uint32_t i = 0; i < messages->size(); ++i) {
+        auto msg = messages->Get(i);
+        stats_message(stream_id, ts_t{msg->ts()}, sensor_ts.at(i),
+                      msg->buffer() ? msg->buffer()->size() : 0);
+    }
+}
+
+void StreamingLayoutCW::finish_stream(const uint32_t stream_id) {
+    auto cb_it = chunk_builders_.find(stream_id);
+    if (cb_it != chunk_builders_.end()) {
+        finish_chunk(stream_id, cb_it->second);
+    }
+}
+
+void StreamingLayoutCW::summarize_message(const uint32_t stream_id,
+                                          const ChunkSummary& summary) {
+    unwritten_summaries_[stream_id].merge(summary);
 }
 
 void StreamingLayoutCW::finish() {
@@ -58,11 +154,29 @@ void StreamingLayoutCW::finish() {
 
 uint32_t StreamingLayoutCW::chunk_size() const { return chunk_size_; }
 
+void StreamingLayoutCW::set_chunk_policy(const ChunkPolicy& policy) {
+    default_policy_ = policy;
+}
+
+void StreamingLayoutCW::set_chunk_policy(uint32_t stream_id,
+                                         const ChunkPolicy& policy) {
+    stream_policies_[stream_id] = policy;
+}
+
+ChunkPolicy StreamingLayoutCW::chunk_policy(uint32_t stream_id) const {
+    auto it = stream_policies_.find(stream_id);
+    return it != stream_policies_.end() ? it->second : default_policy_;
+}
+
+void StreamingLayoutCW::checkpoint_metadata(MetadataStore& store) const {
+    store.add(StreamingInfo{chunk_stream_id_,
+                            {stream_stats_.begin(), stream_stats_.end()}});
+}
+
 void StreamingLayoutCW::stats_message(const uint32_t stream_id,
                                       const ts_t receive_ts,
                                       const ts_t sensor_ts,
-                                      const std::vector<uint8_t>& msg_buf) {
-    auto msg_size = static_cast<uint32_t>(msg_buf.size());
+                                      uint32_t msg_size) {
     auto stats_it = stream_stats_.find(stream_id);
     if (stats_it == stream_stats_.end()) {
         stream_stats_.insert({stream_id, StreamStats(stream_id, receive_ts,
@@ -74,13 +188,27 @@ void StreamingLayoutCW::stats_message(const uint32_t stream_id,
 
 void StreamingLayoutCW::finish_chunk(
     uint32_t stream_id, const std::shared_ptr<ChunkBuilder>& chunk_builder) {
-    std::vector<uint8_t> bb = chunk_builder->finish();
-    if (!bb.empty()) {
-        uint64_t chunk_offset = writer_.emit_chunk(chunk_builder->start_ts(),
-                                                   chunk_builder->end_ts(), bb);
+    // written straight from the buffer of the builder
+    const uint32_t size = chunk_builder->finish_in_place();
+    if (size != 0) {
+        uint64_t chunk_offset =
+            writer_.emit_chunk(chunk_builder->start_ts(),
+                               chunk_builder->end_ts(), chunk_builder->data(),
+                               size);
+        ChunkSummary summary{};
+        auto summary_it = unwritten_summaries_.find(stream_id);
+        if (summary_it != unwritten_summaries_.end()) {
+            summary = summary_it->second;
+            unwritten_summaries_.erase(summary_it);
+        }
         chunk_stream_id_.emplace_back(
-            chunk_offset, ChunkInfo{chunk_offset, stream_id,
-                                    chunk_builder->messages_count()});
+            chunk_offset,
+            ChunkInfo{chunk_offset, stream_id,
+                      chunk_builder->messages_count(), summary});
+        for (const auto& msg : unwritten_stats_[stream_id]) {
+            stats_message(stream_id, msg.receive_ts, msg.sensor_ts, msg.size);
+        }
+        unwritten_stats_[stream_id].clear();
     }
 
     // Prepare for the new chunk messages
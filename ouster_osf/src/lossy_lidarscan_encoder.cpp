@@ -0,0 +1,105 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/osf/lossy_lidarscan_encoder.h"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "ouster/impl/logging.h"
+
+using namespace ouster::sensor;
+
+namespace ouster {
+namespace osf {
+
+LossyLidarScanEncoder::LossyLidarScanEncoder(
+    std::shared_ptr<LidarScanEncoder> encoder, LossyFields max_errors)
+    : encoder_{std::move(encoder)}, max_errors_{std::move(max_errors)} {
+    if (!encoder_) {
+        throw std::invalid_argument(
+            "LossyLidarScanEncoder: encoder must not be null");
+    }
+}
+
+template <typename T>
+bool LossyLidarScanEncoder::encodeLossyImage(
+    ScanChannelData& res_buf, const Eigen::Ref<const img_t<T>>& img,
+    uint32_t max_error) const {
+    try {
+        res_buf = encode_lossy<T>(img, max_error);
+    } catch (const std::exception& e) {
+        logger().error("ERROR: encodeLossyImage: {}", e.what());
+        return true;
+    }
+    return false;
+}
+
+bool LossyLidarScanEncoder::fieldEncode(const LidarScan& lidar_scan,
+                                        const ouster::FieldType& field_type,
+                                        const std::vector<int>& px_offset,
+                                        ScanData& scan_data,
+                                        size_t scan_idx) const {
+    auto it = max_errors_.find(field_type.name);
+    if (it == max_errors_.end()) {
+        return encoder_->fieldEncode(lidar_scan, field_type, px_offset,
+                                     scan_data, scan_idx);
+    }
+    if (scan_idx >= scan_data.size()) {
+        throw std::invalid_argument(
+            "ERROR: scan_data size is not sufficient to hold idx: " +
+            std::to_string(scan_idx));
+    }
+    const uint32_t max_error = it->second;
+    bool res = true;
+    switch (field_type.element_type) {
+        case sensor::ChanFieldType::UINT8:
+            res = encodeLossyImage<uint8_t>(
+                scan_data[scan_idx],
+                destagger<uint8_t>(lidar_scan.field<uint8_t>(field_type.name),
+                                   px_offset),
+                max_error);
+            break;
+        case sensor::ChanFieldType::UINT16:
+            res = encodeLossyImage<uint16_t>(
+                scan_data[scan_idx],
+                destagger<uint16_t>(
+                    lidar_scan.field<uint16_t>(field_type.name), px_offset),
+                max_error);
+            break;
+        case sensor::ChanFieldType::UINT32:
+            res = encodeLossyImage<uint32_t>(
+                scan_data[scan_idx],
+                destagger<uint32_t>(
+                    lidar_scan.field<uint32_t>(field_type.name), px_offset),
+                max_error);
+            break;
+        case sensor::ChanFieldType::UINT64:
+            res = encodeLossyImage<uint64_t>(
+                scan_data[scan_idx],
+                destagger<uint64_t>(
+                    lidar_scan.field<uint64_t>(field_type.name), px_offset),
+                max_error);
+            break;
+        default:
+            return encoder_->fieldEncode(lidar_scan, field_type, px_offset,
+                                         scan_data, scan_idx);
+    }
+    if (res) {
+        logger().error("ERROR: fieldEncode: Can't encode field {}",
+                       field_type.name);
+    }
+    return res;
+}
+
+ScanChannelData LossyLidarScanEncoder::encodeField(
+    const ouster::Field& field) const {
+    // custom fields have no names here, so they keep the other encoding
+    return encoder_->encodeField(field);
+}
+
+}  // namespace osf
+}  // namespace ouster
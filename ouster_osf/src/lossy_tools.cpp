@@ -0,0 +1,92 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "lossy_tools.h"
+
+#include <exception>
+
+#include "ouster/impl/logging.h"
+#include "ouster/lossy_codec.h"
+
+using namespace ouster::sensor;
+
+namespace ouster {
+namespace osf {
+
+bool is_lossy_buffer(const ScanChannelData& channel_buf) {
+    return ouster::is_lossy_buffer(channel_buf.data(), channel_buf.size());
+}
+
+template <typename T>
+bool decodeLossyImage(Eigen::Ref<img_t<T>> img,
+                      const ScanChannelData& channel_buf,
+                      const std::vector<int>* px_offset) {
+    if (px_offset && px_offset->size() != static_cast<size_t>(img.rows())) {
+        logger().error("ERROR: decodeLossyImage: image height {} does not "
+                       "match shifts size {}",
+                       img.rows(), px_offset->size());
+        return true;
+    }
+    try {
+        if (!px_offset) {
+            decode_lossy<T>(channel_buf.data(), channel_buf.size(), img);
+            return false;
+        }
+        // standard fields are stored destaggered
+        img_t<T> destaggered(img.rows(), img.cols());
+        decode_lossy<T>(channel_buf.data(), channel_buf.size(), destaggered);
+        img = stagger<T>(destaggered, *px_offset);
+    } catch (const std::exception& e) {
+        logger().error("ERROR: decodeLossyImage: {}", e.what());
+        return true;
+    }
+    return false;
+}
+
+bool lossyFieldDecode(LidarScan& lidar_scan,
+                      const ScanChannelData& channel_buf,
+                      const ouster::FieldType& field_type,
+                      const std::vector<int>& px_offset) {
+    switch (field_type.element_type) {
+        case sensor::ChanFieldType::UINT8:
+            return decodeLossyImage<uint8_t>(
+                lidar_scan.field<uint8_t>(field_type.name), channel_buf,
+                &px_offset);
+        case sensor::ChanFieldType::UINT16:
+            return decodeLossyImage<uint16_t>(
+                lidar_scan.field<uint16_t>(field_type.name), channel_buf,
+                &px_offset);
+        case sensor::ChanFieldType::UINT32:
+            return decodeLossyImage<uint32_t>(
+                lidar_scan.field<uint32_t>(field_type.name), channel_buf,
+                &px_offset);
+        case sensor::ChanFieldType::UINT64:
+            return decodeLossyImage<uint64_t>(
+                lidar_scan.field<uint64_t>(field_type.name), channel_buf,
+                &px_offset);
+        default:
+            logger().error(
+                "ERROR: lossyFieldDecode: UNKNOWN:"
+                "ChanFieldType not yet "
+                "implemented");
+            return true;
+    }
+}
+
+template bool decodeLossyImage<uint8_t>(Eigen::Ref<img_t<uint8_t>>,
+                                        const ScanChannelData&,
+                                        const std::vector<int>*);
+template bool decodeLossyImage<uint16_t>(Eigen::Ref<img_t<uint16_t>>,
+                                         const ScanChannelData&,
+                                         const std::vector<int>*);
+template bool decodeLossyImage<uint32_t>(Eigen::Ref<img_t<uint32_t>>,
+                                         const ScanChannelData&,
+                                         const std::vector<int>*);
+template bool decodeLossyImage<uint64_t>(Eigen::Ref<img_t<uint64_t>>,
+                                         const ScanChannelData&,
+                                         const std::vector<int>*);
+
+}  // namespace osf
+}  // namespace ouster
@@ -0,0 +1,72 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace osf {
+
+// Encoded single field buffer
+using ScanChannelData = std::vector<uint8_t>;
+
+/**
+ * Error bounded lossy images, written by LossyLidarScanEncoder.
+ *
+ * The buffer is an image encoded by ouster::encode_lossy(), starting with
+ * the magic "OSLQ" that decoders tell it from PNG, zstd, banded and sparse
+ * buffers by. Standard fields are stored after destaggering.
+ */
+
+/**
+ * Check whether the buffer holds a lossy image.
+ *
+ * @param[in] channel_buf The encoded buffer.
+ * @return true if the buffer starts with the lossy magic.
+ */
+bool is_lossy_buffer(const ScanChannelData& channel_buf);
+
+/**
+ * Decode a lossy image into img, which must have the shape and pixel type
+ * of the encoded image.
+ *
+ * @tparam T The type of the image pixels.
+ *
+ * @param[out] img The output image.
+ * @param[in] channel_buf The encoded buffer.
+ * @param[in] px_offset Pixel shift per row used to reconstruct staggered
+ *                      range image form, nullptr for images stored as they
+ *                      are.
+ * @return false (0) if operation is successful, true (1) if error occured
+ */
+template <typename T>
+bool decodeLossyImage(Eigen::Ref<img_t<T>> img,
+                      const ScanChannelData& channel_buf,
+                      const std::vector<int>* px_offset);
+
+/**
+ * Decode a single lossy standard field to lidar_scan.
+ *
+ * @param[out] lidar_scan The output object that will be filled as a result of
+ *                        decoding.
+ * @param[in] channel_buf The encoded buffer.
+ * @param[in] field_type The field of `lidar_scan` to fill in with the decoded
+ *                       result.
+ * @param[in] px_offset Pixel shift per row used to reconstruct staggered range
+ *                      image form.
+ * @return false (0) if operation is successful true (1) if error occured
+ */
+bool lossyFieldDecode(LidarScan& lidar_scan,
+                      const ScanChannelData& channel_buf,
+                      const ouster::FieldType& field_type,
+                      const std::vector<int>& px_offset);
+
+}  // namespace osf
+}  // namespace ouster
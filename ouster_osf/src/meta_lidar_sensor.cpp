@@ -26,12 +26,14 @@ namespace osf {
  * @param[in] sensor_metadata ///< The json string representation of the
  *                            ///< sensor_info to use when creating
  *                            ///< the flatbuffer blob.
+ * @param[in] info The binary encoding of the same sensor_info.
  * @return The offset pointer inside the flatbufferbuilder to the new section.
  */
 flatbuffers::Offset<ouster::osf::gen::LidarSensor> create_lidar_sensor(
-    flatbuffers::FlatBufferBuilder& fbb, const std::string& sensor_metadata) {
-    auto ls_offset =
-        ouster::osf::gen::CreateLidarSensorDirect(fbb, sensor_metadata.c_str());
+    flatbuffers::FlatBufferBuilder& fbb, const std::string& sensor_metadata,
+    const std::vector<uint8_t>& info) {
+    auto ls_offset = ouster::osf::gen::CreateLidarSensorDirect(
+        fbb, sensor_metadata.c_str(), &info);
     return ls_offset;
 }
 
@@ -55,19 +57,46 @@ std::unique_ptr<std::string> restore_lidar_sensor(
     return std::make_unique<std::string>(sensor_metadata);
 }
 
+/**
+ * Internal helper function for restoring the sensor_info of a LidarSensor
+ * from its binary encoding, written by newer versions next to the json.
+ *
+ * @param[in] buf The flatbuffer byte vector.
+ * @return The sensor_info, or nullptr if the blob has no usable binary
+ *         encoding.
+ */
+std::unique_ptr<sensor_info> restore_lidar_sensor_info(
+    const std::vector<uint8_t>& buf) {
+    auto lidar_sensor = v2::GetSizePrefixedLidarSensor(buf.data());
+    const auto* info = lidar_sensor->info();
+    if (!info || info->size() == 0) return nullptr;
+    try {
+        return std::make_unique<sensor_info>(
+            sensor::sensor_info_from_binary(info->data(), info->size()));
+    } catch (const std::invalid_argument&) {
+        // e.g. an encoding of a later version, the json still works
+        return nullptr;
+    }
+}
+
 LidarSensor::LidarSensor(const sensor_info& si)
     : sensor_info_(si), metadata_(si.to_json_string()) {}
 
 LidarSensor::LidarSensor(const std::string& sensor_metadata)
     : sensor_info_(sensor_metadata), metadata_(sensor_metadata) {}
 
+LidarSensor::LidarSensor(const sensor_info& si,
+                         const std::string& sensor_metadata)
+    : sensor_info_(si), metadata_(sensor_metadata) {}
+
 const sensor_info& LidarSensor::info() const { return sensor_info_; }
 
 const std::string& LidarSensor::metadata() const { return metadata_; }
 
 std::vector<uint8_t> LidarSensor::buffer() const {
     flatbuffers::FlatBufferBuilder fbb = flatbuffers::FlatBufferBuilder(32768);
-    auto ls_offset = create_lidar_sensor(fbb, metadata_);
+    auto ls_offset = create_lidar_sensor(
+        fbb, metadata_, sensor::sensor_info_to_binary(sensor_info_));
     fbb.FinishSizePrefixed(ls_offset,
                            ouster::osf::gen::LidarSensorIdentifier());
     const uint8_t* buf = fbb.GetBufferPointer();
@@ -79,6 +108,9 @@ std::unique_ptr<MetadataEntry> LidarSensor::from_buffer(
     const std::vector<uint8_t>& buf) {
     auto sensor_metadata = restore_lidar_sensor(buf);
     if (sensor_metadata) {
+        if (auto info = restore_lidar_sensor_info(buf)) {
+            return std::make_unique<LidarSensor>(*info, *sensor_metadata);
+        }
         return std::make_unique<LidarSensor>(*sensor_metadata);
     }
     return nullptr;
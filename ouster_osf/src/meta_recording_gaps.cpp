@@ -0,0 +1,95 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/osf/meta_recording_gaps.h"
+
+#include <sstream>
+#include <utility>
+
+#include "flatbuffers/flatbuffers.h"
+#include "os_sensor/recording_gaps_generated.h"
+
+namespace ouster {
+namespace osf {
+
+RecordingGaps::RecordingGaps(std::vector<SkippedSpan> spans, uint64_t kept,
+                             uint32_t ref_meta_id)
+    : spans_(std::move(spans)), kept_{kept}, ref_meta_id_{ref_meta_id} {}
+
+const std::vector<SkippedSpan>& RecordingGaps::spans() const { return spans_; }
+
+uint64_t RecordingGaps::kept() const { return kept_; }
+
+uint64_t RecordingGaps::skipped() const {
+    uint64_t skipped = 0;
+    for (const auto& span : spans_) skipped += span.count;
+    return skipped;
+}
+
+uint32_t RecordingGaps::ref_meta_id() const { return ref_meta_id_; }
+
+std::vector<uint8_t> RecordingGaps::buffer() const {
+    flatbuffers::FlatBufferBuilder fbb = flatbuffers::FlatBufferBuilder(256);
+    std::vector<int64_t> first_frame_id, last_frame_id;
+    std::vector<uint64_t> first_ts, last_ts, count;
+    for (const auto& span : spans_) {
+        first_frame_id.push_back(span.first_frame_id);
+        last_frame_id.push_back(span.last_frame_id);
+        first_ts.push_back(span.first_ts);
+        last_ts.push_back(span.last_ts);
+        count.push_back(span.count);
+    }
+    auto gaps_offset = osf::gen::CreateRecordingGapsDirect(
+        fbb, ref_meta_id_, kept_, &first_frame_id, &last_frame_id, &first_ts,
+        &last_ts, &count);
+    osf::gen::FinishSizePrefixedRecordingGapsBuffer(fbb, gaps_offset);
+    const uint8_t* buf = fbb.GetBufferPointer();
+    const uint32_t size = fbb.GetSize();
+    return {buf, buf + size};
+}
+
+std::unique_ptr<MetadataEntry> RecordingGaps::from_buffer(
+    const std::vector<uint8_t>& buf) {
+    auto gaps_fb = gen::GetSizePrefixedRecordingGaps(buf.data());
+    if (!gaps_fb) return nullptr;
+    std::vector<SkippedSpan> spans;
+    const auto* first_frame_id = gaps_fb->first_frame_id();
+    const auto* last_frame_id = gaps_fb->last_frame_id();
+    const auto* first_ts = gaps_fb->first_ts();
+    const auto* last_ts = gaps_fb->last_ts();
+    const auto* count = gaps_fb->count();
+    if (first_frame_id && last_frame_id && first_ts && last_ts && count) {
+        const uint32_t n = first_frame_id->size();
+        if (last_frame_id->size() == n && first_ts->size() == n &&
+            last_ts->size() == n && count->size() == n) {
+            for (uint32_t i = 0; i < n; ++i) {
+                SkippedSpan span;
+                span.first_frame_id = first_frame_id->Get(i);
+                span.last_frame_id = last_frame_id->Get(i);
+                span.first_ts = first_ts->Get(i);
+                span.last_ts = last_ts->Get(i);
+                span.count = count->Get(i);
+                spans.push_back(span);
+            }
+        }
+    }
+    return std::make_unique<osf::RecordingGaps>(
+        std::move(spans), gaps_fb->kept(), gaps_fb->ref_id());
+}
+
+std::string RecordingGaps::repr() const {
+    std::stringstream ss;
+    ss << "RecordingGapsMeta: ref_id = " << ref_meta_id_
+       << ", kept = " << kept_ << ", skipped = " << skipped()
+       << ", spans =";
+    for (const auto& span : spans_) {
+        ss << " [" << span.first_frame_id << ", " << span.last_frame_id
+           << "]";
+    }
+    return ss.str();
+}
+
+}  // namespace osf
+}  // namespace ouster
@@ -5,6 +5,7 @@
 
 #include "ouster/osf/meta_streaming_info.h"
 
+#include <algorithm>
 #include <jsoncons/json.hpp>
 #include <map>
 #include <sstream>
@@ -15,11 +16,118 @@
 namespace ouster {
 namespace osf {
 
+namespace {
+
+void merge_bounds(nonstd::optional<ValueBounds>& bounds,
+                  const nonstd::optional<ValueBounds>& other) {
+    if (!other) return;
+    if (!bounds) {
+        bounds = other;
+        return;
+    }
+    bounds->min = std::min(bounds->min, other->min);
+    bounds->max = std::max(bounds->max, other->max);
+}
+
+const gen::ValueBounds* to_fb(const nonstd::optional<ValueBounds>& bounds,
+                              gen::ValueBounds& fb) {
+    if (!bounds) return nullptr;
+    fb = gen::ValueBounds(bounds->min, bounds->max);
+    return &fb;
+}
+
+nonstd::optional<ValueBounds> from_fb(const gen::ValueBounds* fb) {
+    if (!fb) return nonstd::nullopt;
+    return ValueBounds{fb->min(), fb->max()};
+}
+
+flatbuffers::Offset<gen::ChunkSummary> create_chunk_summary(
+    flatbuffers::FlatBufferBuilder& fbb, const ChunkSummary& summary) {
+    gen::ValueBounds range, reflectivity, completeness;
+    gen::BoxBounds pose;
+    const gen::BoxBounds* pose_ptr = nullptr;
+    if (summary.pose) {
+        const auto& p = *summary.pose;
+        pose = gen::BoxBounds(p[0].min, p[1].min, p[2].min, p[0].max,
+                              p[1].max, p[2].max);
+        pose_ptr = &pose;
+    }
+    return gen::CreateChunkSummary(
+        fbb, to_fb(summary.range, range),
+        to_fb(summary.reflectivity, reflectivity), summary.alert_flags,
+        pose_ptr, to_fb(summary.completeness, completeness));
+}
+
+ChunkSummary chunk_summary(const gen::ChunkSummary* fb) {
+    ChunkSummary summary{};
+    if (!fb) return summary;
+    summary.range = from_fb(fb->range());
+    summary.reflectivity = from_fb(fb->reflectivity());
+    summary.alert_flags = fb->alert_flags();
+    if (const auto* p = fb->pose()) {
+        summary.pose = std::array<ValueBounds, 3>{
+            {{p->min_x(), p->max_x()},
+             {p->min_y(), p->max_y()},
+             {p->min_z(), p->max_z()}}};
+    }
+    summary.completeness = from_fb(fb->completeness());
+    return summary;
+}
+
+jsoncons::json bounds_json(const ValueBounds& bounds) {
+    jsoncons::json json(jsoncons::json_array_arg);
+    json.emplace_back(bounds.min);
+    json.emplace_back(bounds.max);
+    return json;
+}
+
+}  // namespace
+
+bool ChunkSummary::empty() const {
+    return !range && !reflectivity && alert_flags == 0 && !pose &&
+           !completeness;
+}
+
+void ChunkSummary::merge(const ChunkSummary& other) {
+    merge_bounds(range, other.range);
+    merge_bounds(reflectivity, other.reflectivity);
+    alert_flags |= other.alert_flags;
+    if (other.pose) {
+        if (!pose) {
+            pose = other.pose;
+        } else {
+            for (size_t i = 0; i < 3; i++) {
+                (*pose)[i].min = std::min((*pose)[i].min, (*other.pose)[i].min);
+                (*pose)[i].max = std::max((*pose)[i].max, (*other.pose)[i].max);
+            }
+        }
+    }
+    merge_bounds(completeness, other.completeness);
+}
+
 std::string to_string(const ChunkInfo& chunk_info) {
     std::stringstream ss;
     ss << "{offset = " << chunk_info.offset
        << ", stream_id = " << chunk_info.stream_id
-       << ", message_count = " << chunk_info.message_count << "}";
+       << ", message_count = " << chunk_info.message_count;
+    const ChunkSummary& summary = chunk_info.summary;
+    if (!summary.empty()) {
+        ss << ", summary = {";
+        if (summary.range) {
+            ss << "range = [" << summary.range->min << ", "
+               << summary.range->max << "], ";
+        }
+        if (summary.reflectivity) {
+            ss << "reflectivity = [" << summary.reflectivity->min << ", "
+               << summary.reflectivity->max << "], ";
+        }
+        if (summary.completeness) {
+            ss << "completeness = [" << summary.completeness->min << ", "
+               << summary.completeness->max << "], ";
+        }
+        ss << "alert_flags = " << summary.alert_flags << "}";
+    }
+    ss << "}";
     return ss.str();
 }
 
@@ -73,8 +181,11 @@ flatbuffers::Offset<ouster::osf::gen::StreamingInfo> create_streaming_info(
     std::vector<flatbuffers::Offset<gen::ChunkInfo>> chunks_info_vec;
     for (const auto& chunk_info : chunks_info) {
         const auto& ci = chunk_info.second;
+        auto summary = ci.summary.empty()
+                           ? flatbuffers::Offset<gen::ChunkSummary>()
+                           : create_chunk_summary(fbb, ci.summary);
         auto ci_offset = gen::CreateChunkInfo(fbb, ci.offset, ci.stream_id,
-                                              ci.message_count);
+                                              ci.message_count, summary);
         chunks_info_vec.push_back(ci_offset);
     }
 
@@ -135,9 +246,11 @@ std::unique_ptr<MetadataEntry> StreamingInfo::from_buffer(
             streaming_info->chunks()->begin(), streaming_info->chunks()->end(),
             std::inserter(chunks_info, chunks_info.end()),
             [](const gen::ChunkInfo* ci) {
-                return std::make_pair(ci->offset(),
-                                      ChunkInfo{ci->offset(), ci->stream_id(),
-                                                ci->message_count()});
+                return std::make_pair(
+                    ci->offset(),
+                    ChunkInfo{ci->offset(), ci->stream_id(),
+                              ci->message_count(),
+                              chunk_summary(ci->summary())});
             });
     }
 
@@ -180,6 +293,26 @@ std::string StreamingInfo::repr() const {
         chunk_info["offset"] = static_cast<uint64_t>(ci.second.offset);
         chunk_info["stream_id"] = ci.second.stream_id;
         chunk_info["message_count"] = ci.second.message_count;
+        const ChunkSummary& summary = ci.second.summary;
+        if (!summary.empty()) {
+            jsoncons::json sj{};
+            if (summary.range) sj["range"] = bounds_json(*summary.range);
+            if (summary.reflectivity) {
+                sj["reflectivity"] = bounds_json(*summary.reflectivity);
+            }
+            sj["alert_flags"] = summary.alert_flags;
+            if (summary.pose) {
+                jsoncons::json pose(jsoncons::json_array_arg);
+                for (const auto& b : *summary.pose) {
+                    pose.emplace_back(bounds_json(b));
+                }
+                sj["pose"] = pose;
+            }
+            if (summary.completeness) {
+                sj["completeness"] = bounds_json(*summary.completeness);
+            }
+            chunk_info["summary"] = sj;
+        }
         chunks.emplace_back(chunk_info);
     }
     si_obj["chunks"] = chunks;
@@ -5,6 +5,9 @@
 
 #include "ouster/osf/metadata.h"
 
+#include <stdexcept>
+#include <string>
+
 #include "fb_utils.h"
 #include "ouster/impl/logging.h"
 
@@ -145,6 +148,17 @@ uint32_t MetadataStore::add(MetadataEntry& entry) {
     return entry.id();
 }
 
+void MetadataStore::set_next_id(uint32_t next_id) {
+    const bool in_use = !metadata_entries_.empty() &&
+                        next_id <= metadata_entries_.rbegin()->first;
+    if (next_id < next_meta_id_ || in_use) {
+        throw std::invalid_argument(
+            "ERROR: MetadataStore: next id " + std::to_string(next_id) +
+            " is not above the ids in use");
+    }
+    next_meta_id_ = next_id;
+}
+
 size_t MetadataStore::size() const { return metadata_entries_.size(); }
 
 const MetadataStore::MetadataEntriesMap& MetadataStore::entries() const {
@@ -0,0 +1,412 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/osf/multi_reader.h"
+
+#include <algorithm>
+#include <fstream>
+#include <jsoncons/json.hpp>
+#include <stdexcept>
+#include <tuple>
+
+#include "compat_ops.h"
+#include "fb_utils.h"
+#include "ouster/osf/meta_streaming_info.h"
+
+namespace ouster {
+namespace osf {
+
+namespace {
+
+constexpr int SHARD_MANIFEST_VERSION = 1;
+
+bool is_absolute_path(const std::string& path) {
+#ifdef _WIN32
+    if (path.size() > 1 && path[1] == ':') return true;
+#endif
+    return !path.empty() && (path[0] == '/' || path[0] == FILE_SEP);
+}
+
+std::string parent_dir(const std::string& path) {
+    const auto sep = path.find_last_of(std::string("/") + FILE_SEP);
+    return sep == std::string::npos ? std::string() : path.substr(0, sep);
+}
+
+}  // namespace
+
+// ======== Shard manifest ============
+
+ShardManifest load_shard_manifest(const std::string& path) {
+    std::ifstream ifs(path);
+    if (!ifs) {
+        throw std::runtime_error("ERROR: can't read shard manifest " + path);
+    }
+    ShardManifest manifest;
+    try {
+        const jsoncons::json root = jsoncons::json::parse(ifs);
+        if (root.at("version").as<int>() > SHARD_MANIFEST_VERSION) {
+            throw std::runtime_error("unsupported version");
+        }
+        const std::string dir = parent_dir(path);
+        for (const auto& shard : root.at("shards").array_range()) {
+            std::string file = shard.at("file").as<std::string>();
+            if (!dir.empty() && !is_absolute_path(file)) {
+                file = path_concat(dir, file);
+            }
+            manifest.files.push_back(file);
+            manifest.sensors.push_back(
+                shard.at("sensors").as<std::vector<uint32_t>>());
+        }
+    } catch (const std::exception& e) {
+        throw std::runtime_error("ERROR: " + path +
+                                 " is not a shard manifest: " + e.what());
+    }
+    return manifest;
+}
+
+void save_shard_manifest(const std::string& path,
+                         const ShardManifest& manifest) {
+    jsoncons::json shards(jsoncons::json_array_arg);
+    for (size_t i = 0; i < manifest.files.size(); ++i) {
+        jsoncons::json shard;
+        shard["file"] = manifest.files[i];
+        shard["sensors"] = i < manifest.sensors.size()
+                               ? manifest.sensors[i]
+                               : std::vector<uint32_t>();
+        shards.push_back(std::move(shard));
+    }
+    jsoncons::json root;
+    root["version"] = SHARD_MANIFEST_VERSION;
+    root["shards"] = std::move(shards);
+
+    std::ofstream ofs(path);
+    root.dump_pretty(ofs);
+    ofs << std::endl;
+    if (!ofs) {
+        throw std::runtime_error("ERROR: can't write shard manifest " + path);
+    }
+}
+
+// ======== MultiReader ============
+
+MultiReader::MultiReader(const std::vector<std::string>& files,
+                         const FileOptions& options)
+    : options_(options) {
+    if (files.empty()) {
+        throw std::invalid_argument("ERROR: MultiReader needs OSF files.");
+    }
+    add_files(files);
+    for (size_t i = 1; i < files_.size() && !files_[i].empty; ++i) {
+        if (files_[i].start_ts < files_[i - 1].end_ts) {
+            throw std::invalid_argument(
+                "ERROR: OSF files " + files_[i - 1].filename + " and " +
+                files_[i].filename + " have overlapping time ranges.");
+        }
+    }
+}
+
+MultiReader::MultiReader(const ShardManifest& manifest,
+                         const FileOptions& options)
+    : options_(options), sharded_(true) {
+    if (manifest.files.empty()) {
+        throw std::invalid_argument("ERROR: shard manifest has no shards.");
+    }
+    add_files(manifest.files);
+}
+
+void MultiReader::add_files(const std::vector<std::string>& files) {
+    for (const auto& filename : files) {
+        // only the header and the metadata, the chunks are indexed later
+        OsfFile osf_file(filename, options_);
+        if (!osf_file.valid()) {
+            throw std::logic_error("provided OSF file " + filename +
+                                   " is not a valid OSF file.");
+        }
+        auto metadata =
+            get_osf_metadata_from_buf(osf_file.get_metadata_chunk_ptr());
+        FileEntry entry{};
+        entry.filename = filename;
+        entry.start_ts = ts_t{metadata->start_ts()};
+        entry.end_ts = ts_t{metadata->end_ts()};
+        entry.empty = !metadata->chunks() || metadata->chunks()->size() == 0;
+        files_.push_back(std::move(entry));
+    }
+    std::stable_sort(files_.begin(), files_.end(),
+                     [](const FileEntry& a, const FileEntry& b) {
+                         return std::tie(a.empty, a.start_ts) <
+                                std::tie(b.empty, b.start_ts);
+                     });
+}
+
+size_t MultiReader::size() const { return files_.size(); }
+
+bool MultiReader::sharded() const { return sharded_; }
+
+const std::string& MultiReader::filename(size_t file_idx) const {
+    return files_.at(file_idx).filename;
+}
+
+Reader& MultiReader::reader(size_t file_idx) {
+    FileEntry& entry = files_.at(file_idx);
+    if (!entry.reader) {
+        entry.reader = std::make_unique<Reader>(entry.filename, options_);
+    }
+    return *entry.reader;
+}
+
+ts_t MultiReader::start_ts() const { return files_.front().start_ts; }
+
+ts_t MultiReader::end_ts() const {
+    ts_t end_ts = files_.front().end_ts;
+    for (const auto& entry : files_) end_ts = std::max(end_ts, entry.end_ts);
+    return end_ts;
+}
+
+MultiMessagesRange MultiReader::messages() {
+    return MultiMessagesRange(this, {}, start_ts(), end_ts());
+}
+
+MultiMessagesRange MultiReader::messages(const ts_t start_ts,
+                                         const ts_t end_ts) {
+    return MultiMessagesRange(this, {}, start_ts, end_ts);
+}
+
+MultiMessagesRange MultiReader::messages(
+    const std::vector<uint32_t>& stream_ids) {
+    return MultiMessagesRange(this, stream_ids, start_ts(), end_ts());
+}
+
+MultiMessagesRange MultiReader::messages(
+    const std::vector<uint32_t>& stream_ids, const ts_t start_ts,
+    const ts_t end_ts) {
+    return MultiMessagesRange(this, stream_ids, start_ts, end_ts);
+}
+
+MultiChunksRange MultiReader::chunks() { return MultiChunksRange(this); }
+
+uint64_t MultiReader::file_message_count(size_t file_idx, uint32_t stream_id) {
+    FileEntry& entry = files_.at(file_idx);
+    if (!entry.counted) {
+        for (auto& item : reader(file_idx).meta_store().find<StreamingInfo>()) {
+            for (const auto& stats : item.second->stream_stats()) {
+                entry.message_counts[stats.first] += stats.second.message_count;
+            }
+        }
+        entry.counted = true;
+    }
+    auto count = entry.message_counts.find(stream_id);
+    return count != entry.message_counts.end() ? count->second : 0;
+}
+
+uint64_t MultiReader::message_count(uint32_t stream_id) {
+    uint64_t count = 0;
+    for (size_t i = 0; i < files_.size(); ++i) {
+        count += file_message_count(i, stream_id);
+    }
+    return count;
+}
+
+nonstd::optional<ts_t> MultiReader::ts_by_message_idx(uint32_t stream_id,
+                                                      uint64_t message_idx) {
+    for (size_t i = 0; i < files_.size(); ++i) {
+        const uint64_t count = file_message_count(i, stream_id);
+        if (message_idx < count) {
+            return reader(i).ts_by_message_idx(
+                stream_id, static_cast<uint32_t>(message_idx));
+        }
+        message_idx -= count;
+    }
+    return nonstd::nullopt;
+}
+
+// ======== MultiMessagesRange ============
+
+MultiMessagesRange::MultiMessagesRange(MultiReader* reader,
+                                       const std::vector<uint32_t>& stream_ids,
+                                       const ts_t start_ts, const ts_t end_ts)
+    : reader_(reader),
+      stream_ids_(stream_ids),
+      start_ts_(start_ts),
+      end_ts_(end_ts) {}
+
+MultiMessagesIter MultiMessagesRange::begin() const {
+    return MultiMessagesIter(reader_, 0, stream_ids_, start_ts_, end_ts_);
+}
+
+MultiMessagesIter MultiMessagesRange::end() const {
+    return MultiMessagesIter(reader_, reader_->size(), stream_ids_, start_ts_,
+                             end_ts_);
+}
+
+// ======== MultiMessagesIter ============
+
+MultiMessagesIter::MultiMessagesIter()
+    : reader_(nullptr), file_idx_(0), start_ts_{}, end_ts_{} {}
+
+MultiMessagesIter::MultiMessagesIter(MultiReader* reader, size_t file_idx,
+                                     const std::vector<uint32_t>& stream_ids,
+                                     const ts_t start_ts, const ts_t end_ts)
+    : reader_(reader),
+      file_idx_(file_idx),
+      stream_ids_(stream_ids),
+      start_ts_(start_ts),
+      end_ts_(end_ts) {
+    open();
+}
+
+void MultiMessagesIter::open() {
+    const size_t files = reader_ ? reader_->size() : 0;
+    if (reader_ && reader_->sharded_ && file_idx_ < files) {
+        shard_its_.resize(files);
+        shard_ends_.resize(files);
+        for (size_t i = 0; i < files; ++i) {
+            const auto& entry = reader_->files_[i];
+            if (entry.empty || entry.start_ts > end_ts_ ||
+                entry.end_ts < start_ts_) {
+                continue;
+            }
+            auto range =
+                reader_->reader(i).messages(stream_ids_, start_ts_, end_ts_);
+            shard_its_[i] = range.begin();
+            shard_ends_[i] = range.end();
+        }
+        next_shard();
+        return;
+    }
+    for (; file_idx_ < files; ++file_idx_) {
+        // the files are in order of time, the later ones start even later,
+        // and the Readers of the files out of the range aren't opened
+        const auto& entry = reader_->files_[file_idx_];
+        if (entry.empty) break;
+        if (entry.start_ts > end_ts_) break;
+        if (entry.end_ts < start_ts_) continue;
+        auto range = reader_->reader(file_idx_).messages(stream_ids_,
+                                                         start_ts_, end_ts_);
+        it_ = range.begin();
+        end_ = range.end();
+        if (it_ != end_) return;
+    }
+    file_idx_ = files;
+    it_ = end_ = MessagesStreamingIter();
+}
+
+void MultiMessagesIter::next_shard() {
+    // a linear scan, the shards are few, the earlier file on equal times
+    file_idx_ = shard_its_.size();
+    ts_t next_ts{};
+    for (size_t i = 0; i < shard_its_.size(); ++i) {
+        if (shard_its_[i] == shard_ends_[i]) continue;
+        const ts_t ts = (*shard_its_[i]).ts();
+        if (file_idx_ == shard_its_.size() || ts < next_ts) {
+            file_idx_ = i;
+            next_ts = ts;
+        }
+    }
+}
+
+const MessageRef MultiMessagesIter::operator*() const {
+    return shard_its_.empty() ? *it_ : *shard_its_[file_idx_];
+}
+
+std::unique_ptr<const MessageRef> MultiMessagesIter::operator->() const {
+    return shard_its_.empty() ? it_.operator->()
+                              : shard_its_[file_idx_].operator->();
+}
+
+MultiMessagesIter& MultiMessagesIter::operator++() {
+    if (!shard_its_.empty()) {
+        ++shard_its_[file_idx_];
+        next_shard();
+        return *this;
+    }
+    ++it_;
+    if (it_ == end_) {
+        ++file_idx_;
+        open();
+    }
+    return *this;
+}
+
+bool MultiMessagesIter::operator==(const MultiMessagesIter& other) const {
+    if (reader_ != other.reader_ || file_idx_ != other.file_idx_) {
+        return false;
+    }
+    if (shard_its_.empty() && other.shard_its_.empty()) {
+        return it_ == other.it_;
+    }
+    // the end of the messages of shards holds no iterators
+    if (file_idx_ == reader_->size()) return true;
+    return file_idx_ < shard_its_.size() &&
+           file_idx_ < other.shard_its_.size() &&
+           shard_its_[file_idx_] == other.shard_its_[file_idx_];
+}
+
+bool MultiMessagesIter::operator!=(const MultiMessagesIter& other) const {
+    return !this->operator==(other);
+}
+
+size_t MultiMessagesIter::file_idx() const { return file_idx_; }
+
+// ======== MultiChunksRange ============
+
+MultiChunksRange::MultiChunksRange(MultiReader* reader) : reader_(reader) {}
+
+MultiChunksIter MultiChunksRange::begin() const {
+    return MultiChunksIter(reader_, 0);
+}
+
+MultiChunksIter MultiChunksRange::end() const {
+    return MultiChunksIter(reader_, reader_->size());
+}
+
+// ======== MultiChunksIter ============
+
+MultiChunksIter::MultiChunksIter() : reader_(nullptr), file_idx_(0) {}
+
+MultiChunksIter::MultiChunksIter(MultiReader* reader, size_t file_idx)
+    : reader_(reader), file_idx_(file_idx) {
+    open();
+}
+
+void MultiChunksIter::open() {
+    const size_t files = reader_ ? reader_->size() : 0;
+    for (; file_idx_ < files; ++file_idx_) {
+        auto range = reader_->reader(file_idx_).chunks();
+        it_ = range.begin();
+        end_ = range.end();
+        if (it_ != end_) return;
+    }
+    file_idx_ = files;
+    it_ = end_ = ChunksIter();
+}
+
+const ChunkRef MultiChunksIter::operator*() const { return *it_; }
+
+const std::unique_ptr<ChunkRef> MultiChunksIter::operator->() const {
+    return std::make_unique<ChunkRef>(*it_);
+}
+
+MultiChunksIter& MultiChunksIter::operator++() {
+    ++it_;
+    if (it_ == end_) {
+        ++file_idx_;
+        open();
+    }
+    return *this;
+}
+
+bool MultiChunksIter::operator==(const MultiChunksIter& other) const {
+    return reader_ == other.reader_ && file_idx_ == other.file_idx_ &&
+           it_ == other.it_;
+}
+
+bool MultiChunksIter::operator!=(const MultiChunksIter& other) const {
+    return !this->operator==(other);
+}
+
+size_t MultiChunksIter::file_idx() const { return file_idx_; }
+
+}  // namespace osf
+}  // namespace ouster
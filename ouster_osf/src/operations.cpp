@@ -5,22 +5,39 @@
 
 #include "ouster/osf/operations.h"
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <csignal>
+#include <deque>
+#include <functional>
+#include <future>
 #include <iostream>
 #include <jsoncons/json.hpp>
 #include <jsoncons/json_parser.hpp>
+#include <map>
+#include <memory>
+#include <set>
+#include <stdexcept>
 
 #include "compat_ops.h"
 #include "fb_utils.h"
 #include "ouster/impl/logging.h"
+#include "ouster/indexed_pcap_reader.h"
 #include "ouster/lidar_scan.h"
+#include "ouster/osf/async_writer.h"
 #include "ouster/osf/file.h"
 #include "ouster/osf/meta_extrinsics.h"
 #include "ouster/osf/meta_lidar_sensor.h"
+#include "ouster/osf/meta_streaming_info.h"
+#include "ouster/osf/multi_reader.h"
+#include "ouster/osf/png_lidarscan_encoder.h"
+#include "ouster/osf/read_ahead.h"
 #include "ouster/osf/reader.h"
 #include "ouster/osf/stream_lidar_scan.h"
 #include "ouster/osf/writer.h"
+#include "ouster/osf/zstd_lidarscan_encoder.h"
+#include "ouster/parallel_scan_batcher.h"
 
 using namespace ouster::sensor;
 
@@ -265,5 +282,787 @@ int64_t osf_file_modify_metadata(
     return saved_bytes;
 }
 
+int64_t recover_osf_file(const std::string& file_name) {
+    uint64_t recovered_end = 0;
+    auto metadata_fbb = flatbuffers::FlatBufferBuilder(32768);
+
+    // Scope the reading portion so that we dont run into read write file
+    // locks
+    {
+        OsfFile osf_file{file_name};
+        if (!osf_file.good()) {
+            logger().error("ERROR: Can't open OSF file {}", file_name);
+            return -1;
+        }
+        if (osf_file.valid()) return static_cast<int64_t>(osf_file.size());
+        const uint64_t chunks_offset = osf_file.chunks_offset();
+
+        // Walk the blocks by their size prefixes, reading only the prefix
+        // and file identifier of each
+        constexpr uint32_t head_size = FLATBUFFERS_PREFIX_LENGTH +
+                                       sizeof(flatbuffers::uoffset_t) +
+                                       flatbuffers::kFileIdentifierLength;
+        uint8_t head[head_size];
+        std::vector<uint64_t> blocks;
+        std::vector<size_t> checkpoints;
+        uint64_t pos = chunks_offset;
+        while (pos + head_size <= osf_file.size()) {
+            osf_file.seek(pos).read(head, head_size);
+            const uint64_t block_size = get_prefixed_size(head) +
+                                        FLATBUFFERS_PREFIX_LENGTH +
+                                        CRC_BYTES_SIZE;
+            // zeroes or a torn write end the blocks
+            if (block_size < head_size + CRC_BYTES_SIZE ||
+                pos + block_size > osf_file.size()) {
+                break;
+            }
+            if (flatbuffers::BufferHasIdentifier(
+                    head, gen::MetadataIdentifier(), true)) {
+                checkpoints.push_back(blocks.size());
+            }
+            blocks.push_back(pos);
+            pos += block_size;
+        }
+
+        std::shared_ptr<ChunkBuffer> checkpoint_buf;
+        size_t next_block = 0;
+        for (auto it = checkpoints.rbegin(); it != checkpoints.rend(); ++it) {
+            auto buf = osf_file.read_chunk(blocks[*it]);
+            if (buf && check_osf_metadata_buf(
+                           buf->data(), static_cast<uint32_t>(buf->size()))) {
+                checkpoint_buf = buf;
+                next_block = *it + 1;
+                recovered_end = blocks[*it] + buf->size();
+                break;
+            }
+        }
+        if (!checkpoint_buf) {
+            logger().error(
+                "ERROR: OSF file {} has no intact metadata checkpoint to "
+                "recover from",
+                file_name);
+            return -1;
+        }
+
+        auto checkpoint = get_osf_metadata_from_buf(checkpoint_buf->data());
+        MetadataStore store;
+        if (checkpoint->entries()) {
+            for (uint32_t i = 0; i < checkpoint->entries()->size(); ++i) {
+                MetadataEntryRef meta_ref(reinterpret_cast<const uint8_t*>(
+                    checkpoint->entries()->Get(i)));
+                auto meta_obj = meta_ref.as_type();
+                if (meta_obj) {
+                    store.add(*meta_obj);
+                } else {
+                    store.add(meta_ref);
+                }
+            }
+        }
+        std::vector<ouster::osf::gen::ChunkOffset> chunks{};
+        if (checkpoint->chunks()) {
+            for (uint32_t i = 0; i < checkpoint->chunks()->size(); ++i) {
+                auto co = checkpoint->chunks()->Get(i);
+                chunks.emplace_back(co->start_ts(), co->end_ts(),
+                                    co->offset());
+            }
+        }
+        ts_t start_ts =
+            chunks.empty() ? ts_t::max() : ts_t{checkpoint->start_ts()};
+        ts_t end_ts = chunks.empty() ? ts_t::min() : ts_t{checkpoint->end_ts()};
+        auto streaming_info = store.get<StreamingInfo>();
+
+        // Index the intact chunks written after the checkpoint
+        for (size_t b = next_block; b < blocks.size(); ++b) {
+            auto chunk_buf = osf_file.read_chunk(blocks[b]);
+            if (!chunk_buf ||
+                !check_osf_chunk_buf(
+                    chunk_buf->data(),
+                    static_cast<uint32_t>(chunk_buf->size()))) {
+                break;
+            }
+            auto messages =
+                ouster::osf::gen::GetSizePrefixedChunk(chunk_buf->data())
+                    ->messages();
+            if (!messages || messages->size() == 0) break;
+
+            const uint64_t offset = blocks[b] - chunks_offset;
+            ts_t chunk_start_ts = ts_t::max();
+            ts_t chunk_end_ts = ts_t::min();
+            for (uint32_t i = 0; i < messages->size(); ++i) {
+                auto msg = messages->Get(i);
+                const ts_t receive_ts{msg->ts()};
+                chunk_start_ts = std::min(chunk_start_ts, receive_ts);
+                chunk_end_ts = std::max(chunk_end_ts, receive_ts);
+                if (!streaming_info) continue;
+
+                // other streams don't keep a sensor timestamp in their
+                // messages, the receive timestamp stands in for it
+                ts_t sensor_ts = receive_ts;
+                uint32_t msg_size = 0;
+                if (msg->buffer()) {
+                    msg_size = msg->buffer()->size();
+                    if (store.get<LidarScanStreamMeta>(msg->id())) {
+                        sensor_ts =
+                            lidar_scan_msg_sensor_ts(msg->buffer()->data());
+                    }
+                }
+                auto& stream_stats = streaming_info->stream_stats();
+                auto stats_it = stream_stats.find(msg->id());
+                if (stats_it == stream_stats.end()) {
+                    stream_stats.insert(
+                        {msg->id(), StreamStats(msg->id(), receive_ts,
+                                                sensor_ts, msg_size)});
+                } else {
+                    stats_it->second.update(receive_ts, sensor_ts, msg_size);
+                }
+            }
+            if (streaming_info) {
+                streaming_info->chunks_info().insert(
+                    {offset, ChunkInfo{offset, messages->Get(0)->id(),
+                                       messages->size()}});
+            }
+            chunks.emplace_back(chunk_start_ts.count(), chunk_end_ts.count(),
+                                offset);
+            start_ts = std::min(start_ts, chunk_start_ts);
+            end_ts = std::max(end_ts, chunk_end_ts);
+            recovered_end = blocks[b] + chunk_buf->size();
+        }
+        logger().info("Recovered {} chunks of {}, {} after the checkpoint",
+                      chunks.size(), file_name,
+                      chunks.size() - (checkpoint->chunks()
+                                           ? checkpoint->chunks()->size()
+                                           : 0));
+
+        std::vector<flatbuffers::Offset<ouster::osf::gen::MetadataEntry>>
+            entries = store.make_entries(metadata_fbb);
+        std::string metadata_id =
+            checkpoint->id() ? checkpoint->id()->str() : std::string{};
+        auto metadata = ouster::osf::gen::CreateMetadataDirect(
+            metadata_fbb, metadata_id.c_str(),
+            !chunks.empty() ? start_ts.count() : 0,
+            !chunks.empty() ? end_ts.count() : 0, &chunks, &entries);
+        metadata_fbb.FinishSizePrefixed(metadata,
+                                        ouster::osf::gen::MetadataIdentifier());
+    }
+
+    truncate_file(file_name, recovered_end);
+    uint64_t saved_bytes = builder_to_file(metadata_fbb, file_name, true);
+    if (!saved_bytes) return -1;
+    finish_osf_file(file_name, recovered_end, saved_bytes);
+    return static_cast<int64_t>(recovered_end + saved_bytes);
+}
+
+namespace {
+
+/**
+ * Whether a lidar scan message is a delta frame of the preceding messages of
+ * its stream.
+ */
+bool lidar_scan_msg_delta_frame(const MessageRef& msg) {
+    auto view = msg.view();
+    return view.data() &&
+           flatbuffers::GetSizePrefixedRoot<gen::LidarScanMsg>(view.data())
+               ->delta_frame();
+}
+
+/**
+ * Copy the messages of the files in the [start_ts, end_ts] range of the
+ * streams to the writer: the chunks of a selected stream within the range
+ * as they are, and the selected messages of the other chunks one by one.
+ */
+void copy_osf_messages(MultiReader& multi_reader, Writer& writer,
+                       const ts_t start_ts, const ts_t end_ts,
+                       const std::vector<uint32_t>& stream_ids) {
+    auto selected_stream = [&stream_ids](uint32_t stream_id) {
+        return stream_ids.empty() ||
+               std::find(stream_ids.begin(), stream_ids.end(), stream_id) !=
+                   stream_ids.end();
+    };
+    uint64_t copied_chunks = 0;
+    uint64_t split_chunks = 0;
+    for (size_t f = 0; f < multi_reader.size(); ++f) {
+        Reader& reader = multi_reader.reader(f);
+        if (reader.start_ts() > end_ts || reader.end_ts() < start_ts) continue;
+        OsfFile osf_file(multi_reader.filename(f));
+        const MetadataStore& meta_store = reader.meta_store();
+        for (const auto& chunk : reader.chunks()) {
+            if (chunk.start_ts() > end_ts || chunk.end_ts() < start_ts) {
+                continue;
+            }
+
+            // only the chunks of the streaming layout are of a single stream
+            const ChunkInfoNode* info = chunk.info();
+            if (info && chunk.start_ts() >= start_ts &&
+                chunk.end_ts() <= end_ts) {
+                if (!selected_stream(info->stream_id)) continue;
+                auto chunk_buf = osf_file.read_chunk(osf_file.chunks_offset() +
+                                                     chunk.offset());
+                if (!chunk_buf || chunk_buf->size() < CRC_BYTES_SIZE) {
+                    throw std::runtime_error(
+                        "ERROR: Can't read the chunk at offset " +
+                        std::to_string(chunk.offset()) + " of " +
+                        multi_reader.filename(f));
+                }
+                writer.save_chunk(
+                    {chunk_buf->begin(), chunk_buf->end() - CRC_BYTES_SIZE});
+                ++copied_chunks;
+                continue;
+            }
+
+            // the streams with a keyframe copied from this chunk, which the
+            // following delta frames of the chunk depend on
+            std::set<uint32_t> keyed_streams;
+            for (const auto msg : chunk) {
+                if (msg.ts() < start_ts || msg.ts() > end_ts ||
+                    !selected_stream(msg.id())) {
+                    continue;
+                }
+                const bool lidar_scans =
+                    meta_store.get<LidarScanStreamMeta>(msg.id()) != nullptr;
+                const bool delta_frame =
+                    lidar_scans && lidar_scan_msg_delta_frame(msg);
+                if (delta_frame && !keyed_streams.count(msg.id())) {
+                    // the keyframe and the delta frames up to this one are
+                    // always in the same chunk
+                    std::vector<std::unique_ptr<const MessageRef>> group;
+                    auto prev = msg.previous();
+                    while (prev) {
+                        const bool keyframe =
+                            !lidar_scan_msg_delta_frame(*prev);
+                        group.push_back(std::move(prev));
+                        if (keyframe) break;
+                        prev = group.back()->previous();
+                    }
+                    for (auto it = group.rbegin(); it != group.rend(); ++it) {
+                        const auto& m = **it;
+                        writer.save_message(
+                            m.id(), m.ts(),
+                            lidar_scan_msg_sensor_ts(m.view().data()),
+                            m.buffer(), it != group.rbegin());
+                    }
+                }
+                if (!delta_frame) keyed_streams.insert(msg.id());
+                const ts_t sensor_ts =
+                    lidar_scans ? lidar_scan_msg_sensor_ts(msg.view().data())
+                                : msg.ts();
+                writer.save_message(msg.id(), msg.ts(), sensor_ts,
+                                    msg.buffer(), delta_frame);
+            }
+            ++split_chunks;
+        }
+    }
+    logger().info("Copied {} chunks as they are and split {}", copied_chunks,
+                  split_chunks);
+}
+
+/**
+ * Open the writer of a copy of the files with the metadata of the first
+ * one, keeping the ids of its entries for the copied messages. The
+ * StreamingInfo is left to the writer, which indexes the copied chunks.
+ */
+std::unique_ptr<Writer> copy_osf_metadata(MultiReader& multi_reader,
+                                          const std::string& file_name) {
+    auto writer = std::make_unique<Writer>(file_name);
+    Reader& reader = multi_reader.reader(0);
+    writer->set_metadata_id(reader.metadata_id());
+    for (const auto& entry : reader.meta_store().entries()) {
+        if (entry.second->type() == metadata_type<StreamingInfo>()) continue;
+        writer->add_metadata(*entry.second);
+    }
+    return writer;
+}
+
+// applies ScanOps to the scans of each sensor, in the order of the scans
+class ScanOpsApplier {
+   public:
+    ScanOpsApplier(const ScanOps& ops, const std::vector<sensor_info>& infos)
+        : ops_(ops), counts_(infos.size(), 0) {
+        if (ops.step == 0) {
+            throw std::invalid_argument("ERROR: ScanOps step must be >= 1.");
+        }
+        for (const auto& info : infos) {
+            const size_t h = info.format.pixels_per_column;
+            if (ops.beams && (ops.beams > h || h % ops.beams != 0)) {
+                throw std::invalid_argument(
+                    "ERROR: Can't reduce " + std::to_string(h) +
+                    " beams to " + std::to_string(ops.beams) + ".");
+            }
+            const int factor = ops.beams ? static_cast<int>(h / ops.beams) : 1;
+            factors_.push_back(factor);
+            infos_.push_back(factor > 1 ? reduce_by_factor(info, factor)
+                                        : info);
+        }
+    }
+
+    // the metadata of the scans the ops give
+    const std::vector<sensor_info>& infos() const { return infos_; }
+
+    // whether every sensor is past the stop of the slice
+    bool done() const {
+        if (!ops_.stop) return false;
+        return std::all_of(counts_.begin(), counts_.end(),
+                           [this](size_t count) { return count >= ops_.stop; });
+    }
+
+    // apply the ops to the next scan of a sensor, in place or into a scan of
+    // the applier valid until the next call, null if sliced out
+    const LidarScan* operator()(size_t sensor, LidarScan& scan) {
+        const size_t index = counts_[sensor]++;
+        if (index < ops_.start || (ops_.stop && index >= ops_.stop) ||
+            (index - ops_.start) % ops_.step != 0) {
+            return nullptr;
+        }
+        LidarScan* result = &scan;
+        if (factors_[sensor] > 1) {
+            reduced_ = reduce_by_factor(scan, factors_[sensor]);
+            result = &reduced_;
+        }
+        if (!ops_.clip_fields.empty()) {
+            clip_fields(*result, ops_.clip_fields, ops_.clip_lower,
+                        ops_.clip_upper, ops_.clip_invalid);
+        }
+        return result;
+    }
+
+   private:
+    ScanOps ops_;
+    std::vector<size_t> counts_;
+    std::vector<int> factors_;
+    std::vector<sensor_info> infos_;
+    LidarScan reduced_;
+};
+
+}  // namespace
+
+int64_t slice_osf_file(const std::string& file_name,
+                       const std::string& output_file_name,
+                       const ts_t start_ts, const ts_t end_ts,
+                       const std::vector<uint32_t>& stream_ids) {
+    MultiReader multi_reader(std::vector<std::string>{file_name});
+    auto writer = copy_osf_metadata(multi_reader, output_file_name);
+    copy_osf_messages(multi_reader, *writer, start_ts, end_ts, stream_ids);
+    writer->close();
+    return file_size(output_file_name);
+}
+
+int64_t merge_osf_files(const std::vector<std::string>& file_names,
+                        const std::string& output_file_name) {
+    MultiReader multi_reader(file_names);
+    auto writer = copy_osf_metadata(multi_reader, output_file_name);
+    copy_osf_messages(multi_reader, *writer, multi_reader.start_ts(),
+                      multi_reader.end_ts(), {});
+    writer->close();
+    return file_size(output_file_name);
+}
+
+int64_t transcode_osf_file(const std::string& file_name,
+                           const std::string& output_file_name,
+                           const TranscodeOptions& options) {
+    Reader reader(file_name);
+
+    // the sensors in order of their ids are the stream indices of the writer
+    std::vector<sensor_info> infos;
+    std::map<uint32_t, uint32_t> sensor_index;
+    for (const auto& sensor : reader.meta_store().find<LidarSensor>()) {
+        sensor_index[sensor.first] = static_cast<uint32_t>(infos.size());
+        infos.push_back(sensor.second->info());
+    }
+    std::map<uint32_t, uint32_t> stream_index;
+    std::vector<uint32_t> stream_ids;
+    for (const auto& stream :
+         reader.meta_store().find<LidarScanStreamMeta>()) {
+        auto it = sensor_index.find(stream.second->sensor_meta_id());
+        if (it == sensor_index.end()) continue;
+        stream_index[stream.first] = it->second;
+        stream_ids.push_back(stream.first);
+    }
+
+    ScanOpsApplier apply_ops(options.ops, infos);
+    AsyncWriter writer(output_file_name, apply_ops.infos(), options.fields,
+                       options.chunk_size, options.encoder,
+                       options.max_in_flight);
+    if (!stream_ids.empty()) {
+        ReadAheadOptions read_ahead_options;
+        if (options.encoder) {
+            read_ahead_options.thread_pool = options.encoder->thread_pool();
+        }
+        ScanReadAhead read_ahead(reader, stream_ids, reader.start_ts(),
+                                 reader.end_ts(), options.fields,
+                                 read_ahead_options);
+
+        // the scans on their way to the file, waited on in order once
+        // written so that the errors of the writer surface here
+        std::deque<std::future<void>> saving;
+        DecodedScan decoded;
+        while (!apply_ops.done() && read_ahead.next(decoded)) {
+            if (!decoded.scan) {
+                throw std::runtime_error(
+                    "ERROR: Can't decode the scan of stream " +
+                    std::to_string(decoded.stream_id) + " at " +
+                    std::to_string(decoded.ts.count()) + " of " + file_name);
+            }
+            const uint32_t index = stream_index.at(decoded.stream_id);
+            const LidarScan* scan = apply_ops(index, *decoded.scan);
+            if (!scan) continue;
+            saving.push_back(writer.save(index, *scan, decoded.ts));
+            while (!saving.empty() &&
+                   saving.front().wait_for(std::chrono::seconds(0)) ==
+                       std::future_status::ready) {
+                saving.front().get();
+                saving.pop_front();
+            }
+        }
+        for (auto& saved : saving) saved.get();
+    }
+    writer.close();
+    return file_size(output_file_name);
+}
+
+int64_t compact_osf_file(const std::string& file_name,
+                         const std::string& output_file_name,
+                         const CompactOptions& options) {
+    if (options.encoder) {
+        // the scans are re-encoded first and then compacted as they are
+        const std::string transcoded = output_file_name + ".transcode.tmp";
+        TranscodeOptions transcode_options;
+        transcode_options.encoder = options.encoder;
+        transcode_options.chunk_size = options.chunk_size;
+        CompactOptions copy_options = options;
+        copy_options.encoder = nullptr;
+        try {
+            transcode_osf_file(file_name, transcoded, transcode_options);
+            const int64_t size =
+                compact_osf_file(transcoded, output_file_name, copy_options);
+            unlink_path(transcoded);
+            return size;
+        } catch (...) {
+            unlink_path(transcoded);
+            throw;
+        }
+    }
+
+    MultiReader multi_reader(std::vector<std::string>{file_name});
+    Reader& reader = multi_reader.reader(0);
+    const MetadataStore& meta_store = reader.meta_store();
+    auto writer = copy_osf_metadata(multi_reader, output_file_name);
+    writer->set_chunk_policy(ChunkPolicy{options.chunk_size, 0, ts_t{0}});
+
+    uint64_t copied = 0;
+    auto copy_message = [&](const MessageRef& msg) {
+        const bool lidar_scans =
+            meta_store.get<LidarScanStreamMeta>(msg.id()) != nullptr;
+        const bool delta_frame = lidar_scans && lidar_scan_msg_delta_frame(msg);
+        const ts_t sensor_ts = lidar_scans
+                                   ? lidar_scan_msg_sensor_ts(msg.view().data())
+                                   : msg.ts();
+        writer->save_message(msg.id(), msg.ts(), sensor_ts, msg.buffer(),
+                             delta_frame);
+        ++copied;
+    };
+
+    auto streaming_info = meta_store.get<StreamingInfo>();
+    if (!streaming_info) {
+        for (const auto& chunk : reader.chunks()) {
+            for (const auto msg : chunk) copy_message(msg);
+        }
+    } else if (options.group_streams) {
+        for (const auto& stats : streaming_info->stream_stats()) {
+            const uint32_t stream_id = stats.first;
+            for (const auto msg : reader.messages(
+                     {stream_id}, reader.start_ts(), reader.end_ts())) {
+                copy_message(msg);
+            }
+            // before the chunks of the next stream
+            writer->finish_stream(stream_id);
+        }
+    } else {
+        for (const auto msg : reader.messages()) copy_message(msg);
+    }
+    writer->close();
+    logger().info("Compacted {} messages of {} into {}", copied, file_name,
+                  output_file_name);
+    return file_size(output_file_name);
+}
+
+int64_t pcap_to_osf(const std::string& pcap_file,
+                    const std::vector<sensor_info>& infos,
+                    const std::string& output_file_name,
+                    const PcapToOsfOptions& options) {
+    if (infos.empty()) {
+        throw std::invalid_argument("ERROR: pcap_to_osf needs sensors.");
+    }
+
+    // only the requested fields are batched
+    std::vector<LidarScanFieldTypes> field_types;
+    for (const auto& info : infos) {
+        LidarScanFieldTypes types;
+        for (const auto& type : get_field_types(info)) {
+            if (options.fields.empty() ||
+                std::find(options.fields.begin(), options.fields.end(),
+                          type.name) != options.fields.end()) {
+                types.push_back(type);
+            }
+        }
+        for (const auto& field : options.fields) {
+            auto found = std::find_if(
+                types.begin(), types.end(),
+                [&field](const FieldType& type) { return type.name == field; });
+            if (found == types.end()) {
+                throw std::runtime_error("Requested field '" + field +
+                                         "' does not exist in the scans of " +
+                                         pcap_file + ".");
+            }
+        }
+        field_types.push_back(std::move(types));
+    }
+
+    ScanOpsApplier apply_ops(options.ops, infos);
+    ouster::sensor_utils::IndexedPcapReader reader(pcap_file, infos);
+    AsyncWriter writer(output_file_name, apply_ops.infos(), options.fields,
+                       options.chunk_size, options.encoder,
+                       options.max_in_flight);
+    ParallelScanBatcher batcher(infos, field_types,
+                                std::max<size_t>(options.queue_size, 1));
+    // set once no more scans are saved, for reading to stop early
+    std::atomic<bool> stopped{false};
+
+    // scans are saved while the pcap file is read, so that reading, batching
+    // and encoding overlap
+    auto saving = std::async(std::launch::async, [&] {
+        std::vector<uint64_t> last_ts(infos.size(), 0);
+        std::deque<std::future<void>> saved;
+        while (true) {
+            auto scan = batcher.pop();
+            if (!scan.second) break;
+            // scans are still popped once stopped for batching to finish
+            const LidarScan* out =
+                stopped ? nullptr : apply_ops(scan.first, *scan.second);
+            const uint64_t ts = scan.second->get_first_valid_packet_timestamp();
+            if (out && ts < last_ts[scan.first] &&
+                options.stop_on_backwards_ts) {
+                logger().warn(
+                    "Stopped converting {} at a scan timestamped before an "
+                    "earlier one, which OSF doesn't support",
+                    pcap_file);
+                stopped = true;
+            } else if (out && ts >= last_ts[scan.first]) {
+                last_ts[scan.first] = ts;
+                saved.push_back(writer.save(static_cast<uint32_t>(scan.first),
+                                            *out, ts_t{ts}));
+            }
+            if (apply_ops.done()) stopped = true;
+            batcher.recycle(scan.first, std::move(scan.second));
+            while (!saved.empty() &&
+                   saved.front().wait_for(std::chrono::seconds(0)) ==
+                       std::future_status::ready) {
+                saved.front().get();
+                saved.pop_front();
+            }
+        }
+        for (auto& save : saved) save.get();
+    });
+
+    try {
+        LidarPacket packet;
+        while (reader.next_packet()) {
+            // stop reading once saving failed, its error is thrown below
+            if (stopped || saving.wait_for(std::chrono::seconds(0)) ==
+                               std::future_status::ready) {
+                break;
+            }
+            auto sensor_idx = reader.sensor_idx_for_current_packet();
+            if (!sensor_idx) continue;
+            const auto& info = reader.current_info();
+            packet.buf.assign(reader.current_data(),
+                              reader.current_data() + info.payload_size);
+            // the capture timestamp becomes the packet timestamp of the scan
+            packet.host_timestamp = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    info.timestamp)
+                    .count());
+            batcher.push(*sensor_idx, packet);
+        }
+    } catch (...) {
+        batcher.finish();
+        saving.wait();
+        throw;
+    }
+    batcher.finish();
+    saving.get();
+    writer.close();
+    return file_size(output_file_name);
+}
+
+namespace {
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start)
+        .count();
+}
+
+// encodes one field of a scan into the first buffer of the scan data
+using FieldEncodeFn = std::function<void(
+    const LidarScan&, const FieldType&, const std::vector<int>&, ScanData&)>;
+
+FieldEncodeFn bench_field_encoder(const BenchEncoder& encoder) {
+    // through the concrete encoders, whose fieldEncode() is public
+    if (encoder.codec == "png") {
+        auto png = std::make_shared<PngLidarScanEncoder>(encoder.level);
+        return [png](const LidarScan& scan, const FieldType& field_type,
+                     const std::vector<int>& px_offset, ScanData& data) {
+            png->fieldEncode(scan, field_type, px_offset, data, 0);
+        };
+    }
+    if (encoder.codec == "zstd") {
+        auto zstd = std::make_shared<ZstdLidarScanEncoder>(encoder.level);
+        return [zstd](const LidarScan& scan, const FieldType& field_type,
+                      const std::vector<int>& px_offset, ScanData& data) {
+            zstd->fieldEncode(scan, field_type, px_offset, data, 0);
+        };
+    }
+    throw std::invalid_argument("ERROR: Unknown encoder " + encoder.codec +
+                                ", expected png or zstd.");
+}
+
+}  // namespace
+
+OsfBench bench_osf_file(const std::string& file_name,
+                        const BenchOptions& options) {
+    std::vector<FieldEncodeFn> encoders;
+    for (const auto& encoder : options.encoders) {
+        encoders.push_back(bench_field_encoder(encoder));
+    }
+
+    OsfBench bench;
+    {
+        OsfFile osf_file{file_name};
+        if (!osf_file.valid()) {
+            throw std::logic_error(
+                "provided OSF file is not a valid OSF file.");
+        }
+        auto metadata =
+            get_osf_metadata_from_buf(osf_file.get_metadata_chunk_ptr());
+        const uint64_t chunks_offset = osf_file.chunks_offset();
+        const auto* chunks = metadata->chunks();
+        for (uint32_t i = 0; chunks && i < chunks->size(); ++i) {
+            auto start = std::chrono::steady_clock::now();
+            auto chunk_buf =
+                osf_file.read_chunk(chunks_offset + chunks->Get(i)->offset());
+            bench.read_seconds += seconds_since(start);
+            if (!chunk_buf) continue;
+            start = std::chrono::steady_clock::now();
+            const bool valid = check_osf_chunk_buf(
+                chunk_buf->data(), static_cast<uint32_t>(chunk_buf->size()));
+            bench.crc_seconds += seconds_since(start);
+            bench.chunks++;
+            bench.chunk_bytes += chunk_buf->size();
+            if (!valid) bench.invalid_chunks++;
+        }
+    }
+
+    Reader reader(file_name);
+    std::map<uint32_t, std::vector<int>> px_offsets;
+    std::map<uint32_t, sensor_info> sensors;
+    for (const auto& sensor : reader.meta_store().find<LidarSensor>()) {
+        sensors[sensor.first] = sensor.second->info();
+    }
+    std::vector<uint32_t> stream_ids;
+    for (const auto& stream :
+         reader.meta_store().find<LidarScanStreamMeta>()) {
+        auto it = sensors.find(stream.second->sensor_meta_id());
+        if (it == sensors.end()) continue;
+        px_offsets[stream.first] = it->second.format.pixel_shift_by_row;
+        stream_ids.push_back(stream.first);
+    }
+    if (stream_ids.empty()) return bench;
+
+    auto wanted = [&](const std::string& field) {
+        return options.fields.empty() ||
+               std::find(options.fields.begin(), options.fields.end(),
+                         field) != options.fields.end();
+    };
+    auto decode_bench = [&](const std::string& field) -> FieldDecodeBench& {
+        for (auto& d : bench.decode) {
+            if (d.field == field) return d;
+        }
+        bench.decode.push_back(FieldDecodeBench{field, 0, 0, 0});
+        return bench.decode.back();
+    };
+    auto encode_bench = [&](const std::string& field,
+                            const BenchEncoder& encoder) -> FieldEncodeBench& {
+        for (auto& e : bench.encode) {
+            if (e.field == field && e.encoder.codec == encoder.codec &&
+                e.encoder.level == encoder.level) {
+                return e;
+            }
+        }
+        bench.encode.push_back(FieldEncodeBench{field, encoder, 0, 0, 0, 0});
+        return bench.encode.back();
+    };
+
+    // each field is decoded on its own into a scan of its own, reused from
+    // message to message like readers do, then the whole scan to encode it
+    std::map<std::string, LidarScan> field_scans;
+    LidarScan scan;
+    size_t measured = 0;
+    for (const auto& msg : reader.messages(stream_ids)) {
+        if (options.scans && measured >= options.scans) break;
+        if (!msg.decode_msg_into<LidarScanStream>(scan)) continue;
+        measured++;
+        const auto& px_offset = px_offsets.at(msg.id());
+        for (const auto& field_type : scan.field_types()) {
+            const auto& name = field_type.name;
+            if (!wanted(name)) continue;
+
+            auto& decoded = decode_bench(name);
+            auto start = std::chrono::steady_clock::now();
+            const bool ok = msg.decode_msg_into<LidarScanStream>(
+                field_scans[name], {name});
+            decoded.seconds += seconds_since(start);
+            if (!ok) continue;
+            decoded.scans++;
+            decoded.bytes += scan.field(name).bytes();
+
+            for (size_t i = 0; i < encoders.size(); i++) {
+                const auto& encoder = options.encoders[i];
+                ScanData data(1);
+                start = std::chrono::steady_clock::now();
+                encoders[i](scan, field_type, px_offset, data);
+                auto& encoded = encode_bench(name, encoder);
+                encoded.seconds += seconds_since(start);
+                encoded.scans++;
+                encoded.raw_bytes += scan.field(name).bytes();
+                encoded.encoded_bytes += data[0].size();
+            }
+        }
+    }
+
+    {
+        Reader sequential(file_name);
+        std::map<uint32_t, LidarScan> scans;
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& msg : sequential.messages(stream_ids)) {
+            if (msg.decode_msg_into<LidarScanStream>(scans[msg.id()])) {
+                bench.scans++;
+            }
+        }
+        bench.sequential_seconds = seconds_since(start);
+    }
+    {
+        Reader parallel(file_name);
+        ReadAheadOptions read_ahead_options;
+        read_ahead_options.thread_pool = options.thread_pool;
+        auto start = std::chrono::steady_clock::now();
+        ScanReadAhead read_ahead(parallel, stream_ids, parallel.start_ts(),
+                                 parallel.end_ts(), {}, read_ahead_options);
+        DecodedScan decoded;
+        while (read_ahead.next(decoded)) {
+        }
+        bench.parallel_seconds = seconds_since(start);
+    }
+    return bench;
+}
+
 }  // namespace osf
 }  // namespace ouster
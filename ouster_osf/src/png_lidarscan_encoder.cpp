@@ -10,6 +10,7 @@
 #include "ouster/osf/png_lidarscan_encoder.h"
 
 #include <png.h>
+#include <zlib.h>
 
 #include "ouster/impl/logging.h"
 #include "png_tools.h"
@@ -19,6 +20,40 @@ using namespace ouster::sensor;
 namespace ouster {
 namespace osf {
 
+namespace {
+
+int to_png_filter(PngFilter filter) {
+    switch (filter) {
+        case PngFilter::NONE:
+            return PNG_FILTER_NONE;
+        case PngFilter::SUB:
+            return PNG_FILTER_SUB;
+        case PngFilter::UP:
+            return PNG_FILTER_UP;
+        case PngFilter::AVG:
+            return PNG_FILTER_AVG;
+        case PngFilter::PAETH:
+            return PNG_FILTER_PAETH;
+        default:
+            return -1;
+    }
+}
+
+int to_zlib_strategy(PngStrategy strategy) {
+    switch (strategy) {
+        case PngStrategy::FILTERED:
+            return Z_FILTERED;
+        case PngStrategy::HUFFMAN_ONLY:
+            return Z_HUFFMAN_ONLY;
+        case PngStrategy::RLE:
+            return Z_RLE;
+        default:
+            return -1;
+    }
+}
+
+}  // namespace
+
 bool PngLidarScanEncoder::fieldEncode(const LidarScan& lidar_scan,
                                       const ouster::FieldType& field_type,
                                       const std::vector<int>& px_offset,
@@ -149,7 +184,8 @@ bool PngLidarScanEncoder::encode8bitImage(
     }
 
     png_osf_write_start(png_ptr, png_info_ptr, res_buf, width, height,
-                        sample_depth, color_type, compression_amount_);
+                        sample_depth, color_type, compression_amount_,
+                        to_png_filter(filter_), to_zlib_strategy(strategy_));
 
     for (size_t u = 0; u < height; ++u) {
         for (size_t v = 0; v < width; ++v) {
@@ -161,7 +197,7 @@ bool PngLidarScanEncoder::encode8bitImage(
                       reinterpret_cast<png_const_bytep>(row_data.data()));
     }
 
-    png_write_end(png_ptr, nullptr);
+    png_osf_write_end(png_ptr, res_buf);
 
     png_destroy_write_struct(&png_ptr, &png_info_ptr);
 
@@ -195,7 +231,8 @@ bool PngLidarScanEncoder::encode16bitImage(
     }
 
     png_osf_write_start(png_ptr, png_info_ptr, res_buf, width, height,
-                        sample_depth, color_type, compression_amount_);
+                        sample_depth, color_type, compression_amount_,
+                        to_png_filter(filter_), to_zlib_strategy(strategy_));
 
     // Needed to transform provided little-endian samples to internal
     // PNG big endian format
@@ -214,7 +251,7 @@ bool PngLidarScanEncoder::encode16bitImage(
                       reinterpret_cast<png_const_bytep>(row_data.data()));
     }
 
-    png_write_end(png_ptr, nullptr);
+    png_osf_write_end(png_ptr, res_buf);
 
     png_destroy_write_struct(&png_ptr, &png_info_ptr);
 
@@ -262,7 +299,8 @@ bool PngLidarScanEncoder::encode24bitImage(
     }
 
     png_osf_write_start(png_ptr, png_info_ptr, res_buf, width, height,
-                        sample_depth, color_type, compression_amount_);
+                        sample_depth, color_type, compression_amount_,
+                        to_png_filter(filter_), to_zlib_strategy(strategy_));
 
     for (size_t u = 0; u < height; ++u) {
         for (size_t v = 0; v < width; ++v) {
@@ -278,7 +316,7 @@ bool PngLidarScanEncoder::encode24bitImage(
                       reinterpret_cast<png_const_bytep>(row_data.data()));
     }
 
-    png_write_end(png_ptr, nullptr);
+    png_osf_write_end(png_ptr, res_buf);
 
     png_destroy_write_struct(&png_ptr, &png_info_ptr);
 
@@ -319,7 +357,8 @@ bool PngLidarScanEncoder::encode32bitImage(
     }
 
     png_osf_write_start(png_ptr, png_info_ptr, res_buf, width, height,
-                        sample_depth, color_type, compression_amount_);
+                        sample_depth, color_type, compression_amount_,
+                        to_png_filter(filter_), to_zlib_strategy(strategy_));
 
     for (size_t u = 0; u < height; ++u) {
         for (size_t v = 0; v < width; ++v) {
@@ -336,7 +375,7 @@ bool PngLidarScanEncoder::encode32bitImage(
                       reinterpret_cast<png_const_bytep>(row_data.data()));
     }
 
-    png_write_end(png_ptr, nullptr);
+    png_osf_write_end(png_ptr, res_buf);
 
     png_destroy_write_struct(&png_ptr, &png_info_ptr);
 
@@ -377,7 +416,8 @@ bool PngLidarScanEncoder::encode64bitImage(
     }
 
     png_osf_write_start(png_ptr, png_info_ptr, res_buf, width, height,
-                        sample_depth, color_type, compression_amount_);
+                        sample_depth, color_type, compression_amount_,
+                        to_png_filter(filter_), to_zlib_strategy(strategy_));
 
     // Needed to transform provided little-endian samples to internal
     // PNG big endian format
@@ -402,7 +442,7 @@ bool PngLidarScanEncoder::encode64bitImage(
                       reinterpret_cast<png_const_bytep>(row_data.data()));
     }
 
-    png_write_end(png_ptr, nullptr);
+    png_osf_write_end(png_ptr, res_buf);
 
     png_destroy_write_struct(&png_ptr, &png_info_ptr);
 
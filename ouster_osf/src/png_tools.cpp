@@ -6,13 +6,23 @@
 #include "png_tools.h"
 
 #include <Eigen/Eigen>
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <fstream>
 #include <future>
 #include <iostream>
 #include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
 
+#include "band_tools.h"
 #include "ouster/impl/logging.h"
 #include "ouster/lidar_scan.h"
+#include "lossy_tools.h"
+#include "sparse_tools.h"
+#include "zstd_tools.h"
 
 using namespace ouster::sensor;
 
@@ -112,6 +122,29 @@ void png_osf_read_data(png_structp png_ptr, png_bytep bytes,
 OUSTER_API_FUNCTION
 void png_osf_flush_data(png_structp){};
 
+namespace {
+
+/**
+ * Running estimates of the encoded size per raw image byte, per bytes per
+ * pixel, to reserve the output buffer before encoding.
+ */
+thread_local std::array<double, 9> png_osf_encoded_ratio{
+    {0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5}};
+
+/**
+ * The image being written on this thread, between png_osf_write_start() and
+ * png_osf_write_end().
+ */
+struct PngWriting {
+    size_t bytes_per_pixel{0};
+    size_t raw_bytes{0};
+    size_t start_size{0};
+};
+
+thread_local PngWriting png_osf_writing;
+
+}  // namespace
+
 /**
  * Common png WRITE init routine, creates and setups png_ptr and png_info_ptr
  */
@@ -161,11 +194,34 @@ bool png_osf_read_init(png_structpp png_ptrp, png_infopp png_info_ptrp) {
 void png_osf_write_start(png_structp png_ptr, png_infop png_info_ptr,
                          ScanChannelData& res_buf, uint32_t width,
                          uint32_t height, int sample_depth, int color_type,
-                         int compression_amount) {
+                         int compression_amount, int filter, int strategy) {
     // Use setjmp() on upper level for errors catching
     png_set_write_fn(png_ptr, &res_buf, png_osf_write_data, png_osf_flush_data);
 
     png_set_compression_level(png_ptr, compression_amount);
+    if (filter >= 0) {
+        png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, filter);
+    }
+    if (strategy >= 0) {
+        png_set_compression_strategy(png_ptr, strategy);
+    }
+
+    // reserve the output for the whole image, rather than growing it as
+    // libpng writes
+    const size_t channels = color_type == PNG_COLOR_TYPE_RGB_ALPHA ? 4
+                            : color_type == PNG_COLOR_TYPE_RGB     ? 3
+                                                                   : 1;
+    png_osf_writing.bytes_per_pixel =
+        std::min<size_t>(channels * static_cast<size_t>(sample_depth) / 8,
+                         png_osf_encoded_ratio.size() - 1);
+    png_osf_writing.raw_bytes = size_t{width} * height *
+                                png_osf_writing.bytes_per_pixel;
+    png_osf_writing.start_size = res_buf.size();
+    const double ratio =
+        png_osf_encoded_ratio[png_osf_writing.bytes_per_pixel];
+    res_buf.reserve(res_buf.size() + 1024 +
+                    static_cast<size_t>(1.1 * ratio *
+                                        png_osf_writing.raw_bytes));
 
     png_set_IHDR(png_ptr, png_info_ptr, width, height, sample_depth, color_type,
                  PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT,
@@ -174,11 +230,42 @@ void png_osf_write_start(png_structp png_ptr, png_infop png_info_ptr,
     png_write_info(png_ptr, png_info_ptr);
 }
 
+/**
+ * Common png write finish routine, updating the estimate of the encoded size.
+ */
+void png_osf_write_end(png_structp png_ptr, const ScanChannelData& res_buf) {
+    // Use setjmp() on upper level for errors catching
+    png_write_end(png_ptr, nullptr);
+
+    if (png_osf_writing.raw_bytes == 0) return;
+    const double ratio =
+        static_cast<double>(res_buf.size() - png_osf_writing.start_size) /
+        static_cast<double>(png_osf_writing.raw_bytes);
+    auto& estimate = png_osf_encoded_ratio[png_osf_writing.bytes_per_pixel];
+    estimate = 0.75 * estimate + 0.25 * ratio;
+}
+
 // ========== Decode Functions ===================================
 
 bool fieldDecode(LidarScan& lidar_scan, const ScanData& scan_data,
                  size_t start_idx, const ouster::FieldType& field_type,
                  const std::vector<int>& px_offset) {
+    if (is_zstd_buffer(scan_data[start_idx])) {
+        return zstdFieldDecode(lidar_scan, scan_data[start_idx], field_type,
+                               px_offset);
+    }
+    if (is_banded_buffer(scan_data[start_idx])) {
+        return bandedFieldDecode(lidar_scan, scan_data[start_idx], field_type,
+                                 px_offset);
+    }
+    if (is_sparse_buffer(scan_data[start_idx])) {
+        return sparseFieldDecode(lidar_scan, scan_data[start_idx], field_type,
+                                 px_offset);
+    }
+    if (is_lossy_buffer(scan_data[start_idx])) {
+        return lossyFieldDecode(lidar_scan, scan_data[start_idx], field_type,
+                                px_offset);
+    }
     switch (field_type.element_type) {
         case sensor::ChanFieldType::UINT8:
             return decode8bitImage(lidar_scan.field<uint8_t>(field_type.name),
@@ -202,33 +289,65 @@ bool fieldDecode(LidarScan& lidar_scan, const ScanData& scan_data,
     return true;  // ERROR
 }
 
-template <typename T>
-bool decode24bitImage(Eigen::Ref<img_t<T>> img,
-                      const ScanChannelData& channel_buf,
-                      const std::vector<int>& px_offset) {
-    if (!decode24bitImage<T>(img, channel_buf)) {
-        img = stagger<T>(img, px_offset);
-        return false;  // SUCCESS
+namespace {
+
+/**
+ * Row, or rows of an interlaced image, being decoded on this thread, reused
+ * across images. Kept out of the stack frame of libpng's setjmp().
+ */
+thread_local std::vector<uint8_t> png_osf_decode_row;
+thread_local std::vector<png_bytep> png_osf_decode_rows;
+
+/**
+ * Unpack n little-endian pixels of BPP bytes into dst, copying them when
+ * they are of the size of T on a little endian host, which the rest of the
+ * parsing code assumes too.
+ */
+template <size_t BPP, typename T>
+inline void unpack_pixels(const uint8_t* src, T* dst, size_t n) {
+    if (BPP == sizeof(T)) {
+        std::memcpy(dst, src, n * BPP);
+        return;
+    }
+    using W = typename std::conditional<(BPP > 4 || sizeof(T) > 4), uint64_t,
+                                        uint32_t>::type;
+    for (size_t i = 0; i < n; i++) {
+        W value = 0;
+        for (size_t k = 0; k < BPP; k++) {
+            value |= static_cast<W>(src[i * BPP + k]) << (8u * k);
+        }
+        dst[i] = static_cast<T>(value);
     }
-    return true;  // ERROR
 }
 
-template bool decode24bitImage<uint8_t>(Eigen::Ref<img_t<uint8_t>>,
-                                        const ScanChannelData&,
-                                        const std::vector<int>&);
-template bool decode24bitImage<uint16_t>(Eigen::Ref<img_t<uint16_t>>,
-                                         const ScanChannelData&,
-                                         const std::vector<int>&);
-template bool decode24bitImage<uint32_t>(Eigen::Ref<img_t<uint32_t>>,
-                                         const ScanChannelData&,
-                                         const std::vector<int>&);
-template bool decode24bitImage<uint64_t>(Eigen::Ref<img_t<uint64_t>>,
-                                         const ScanChannelData&,
-                                         const std::vector<int>&);
+/**
+ * Unpack a decoded row into row u of img, staggering it by px_offset unless
+ * null.
+ */
+template <size_t BPP, typename T>
+inline void unpack_row(Eigen::Ref<img_t<T>>& img, size_t u,
+                       const uint8_t* row, const std::vector<int>* px_offset) {
+    const size_t w = img.cols();
+    if (w == 0) return;
+    T* dst = img.data() + u * img.outerStride();
+    const size_t offset =
+        px_offset ? impl::destagger_offset(*px_offset, u, w, true) : 0;
+    // pixel v goes to column (v + offset) % w, as by stagger_in_place()
+    unpack_pixels<BPP>(row, dst + offset, w - offset);
+    unpack_pixels<BPP>(row + (w - offset) * BPP, dst, offset);
+}
 
-template <typename T>
-bool decode24bitImage(Eigen::Ref<img_t<T>> img,
-                      const ScanChannelData& channel_buf) {
+/**
+ * Decode a PNG buffer of the given sample depth and color type into img,
+ * streaming it row by row: each row is unpacked, and staggered by px_offset
+ * unless null, straight into img as libpng inflates it, without an
+ * intermediate image.
+ */
+template <size_t BPP, typename T>
+bool decode_png_rows(Eigen::Ref<img_t<T>> img,
+                     const ScanChannelData& channel_buf,
+                     int expected_sample_depth, int expected_color_type,
+                     const std::vector<int>* px_offset) {
     // libpng main structs
     png_structp png_ptr;
     png_infop png_info_ptr;
@@ -244,11 +363,7 @@ bool decode24bitImage(Eigen::Ref<img_t<T>> img,
 
     VectorReader channel_reader(channel_buf);
     png_set_read_fn(png_ptr, &channel_reader, png_osf_read_data);
-
-    // only used with Gray 16 bit to get little-endian LSB representation back
-    // for other color types PNG_TRANSFORM_SWAP_ENDIAN does nothing
-    int transforms = PNG_TRANSFORM_SWAP_ENDIAN;
-    png_read_png(png_ptr, png_info_ptr, transforms, nullptr);
+    png_read_info(png_ptr, png_info_ptr);
 
     png_uint_32 width;
     png_uint_32 height;
@@ -258,41 +373,104 @@ bool decode24bitImage(Eigen::Ref<img_t<T>> img,
     png_get_IHDR(png_ptr, png_info_ptr, &width, &height, &sample_depth,
                  &color_type, nullptr, nullptr, nullptr);
 
-    png_bytepp row_pointers = png_get_rows(png_ptr, png_info_ptr);
-
-    // Sanity checks for encoded PNG size
+    // Sanity checks for encoded PNG size, before decoding any of it
     if (width != static_cast<png_uint_32>(img.cols()) ||
         height != static_cast<png_uint_32>(img.rows())) {
         print_incompatable_image_size(width, height,
                                       static_cast<png_uint_32>(img.cols()),
                                       static_cast<png_uint_32>(img.rows()));
+        png_destroy_read_struct(&png_ptr, &png_info_ptr, nullptr);
         return true;
     }
 
-    if (sample_depth != 8) {
-        print_bad_sample_depth(sample_depth, 8);
+    if (sample_depth != expected_sample_depth) {
+        print_bad_sample_depth(sample_depth, expected_sample_depth);
+        png_destroy_read_struct(&png_ptr, &png_info_ptr, nullptr);
         return true;
     }
 
-    if (color_type != PNG_COLOR_TYPE_RGB) {
-        print_bad_color_type(color_type, PNG_COLOR_TYPE_RGB);
+    if (color_type != expected_color_type) {
+        print_bad_color_type(color_type, expected_color_type);
+        png_destroy_read_struct(&png_ptr, &png_info_ptr, nullptr);
         return true;
     }
 
-    // 24bit channel data decoding to LidarScan for key channel_index
-    for (size_t u = 0; u < height; u++) {
-        for (size_t v = 0; v < width; v++) {
-            img(u, v) = static_cast<T>(row_pointers[u][v * 3 + 0]) +
-                        (static_cast<T>(row_pointers[u][v * 3 + 1]) << 8u) +
-                        (static_cast<T>(row_pointers[u][v * 3 + 2]) << 16u);
+    // get little-endian LSB representation of Gray 16 bit back
+    if (sample_depth == 16) png_set_swap(png_ptr);
+    const int passes = png_set_interlace_handling(png_ptr);
+    png_read_update_info(png_ptr, png_info_ptr);
+
+    const size_t row_bytes = static_cast<size_t>(width) * BPP;
+    auto& buffer = png_osf_decode_row;
+    if (passes == 1) {
+        buffer.resize(row_bytes);
+        for (size_t u = 0; u < height; u++) {
+            png_read_row(png_ptr, buffer.data(), nullptr);
+            unpack_row<BPP, T>(img, u, buffer.data(), px_offset);
+        }
+    } else {
+        // the passes of interlaced images fill in all rows together; OSF
+        // never writes them
+        buffer.resize(row_bytes * height);
+        auto& rows = png_osf_decode_rows;
+        rows.resize(height);
+        for (size_t u = 0; u < height; u++) {
+            rows[u] = buffer.data() + u * row_bytes;
+        }
+        png_read_image(png_ptr, rows.data());
+        for (size_t u = 0; u < height; u++) {
+            unpack_row<BPP, T>(img, u, rows[u], px_offset);
         }
     }
+    png_read_end(png_ptr, nullptr);
 
     png_destroy_read_struct(&png_ptr, &png_info_ptr, nullptr);
 
     return false;  // SUCCESS
 }
 
+/**
+ * Check that px_offset fits img, as stagger_in_place() does.
+ */
+template <typename T>
+void check_px_offset(const Eigen::Ref<img_t<T>>& img,
+                     const std::vector<int>& px_offset) {
+    if (px_offset.size() != static_cast<size_t>(img.rows())) {
+        throw std::invalid_argument{"image height does not match shifts size"};
+    }
+}
+
+}  // namespace
+
+template <typename T>
+bool decode24bitImage(Eigen::Ref<img_t<T>> img,
+                      const ScanChannelData& channel_buf,
+                      const std::vector<int>& px_offset) {
+    check_px_offset<T>(img, px_offset);
+    return decode_png_rows<3, T>(img, channel_buf, 8, PNG_COLOR_TYPE_RGB,
+                                 &px_offset);
+}
+
+template bool decode24bitImage<uint8_t>(Eigen::Ref<img_t<uint8_t>>,
+                                        const ScanChannelData&,
+                                        const std::vector<int>&);
+template bool decode24bitImage<uint16_t>(Eigen::Ref<img_t<uint16_t>>,
+                                         const ScanChannelData&,
+                                         const std::vector<int>&);
+template bool decode24bitImage<uint32_t>(Eigen::Ref<img_t<uint32_t>>,
+                                         const ScanChannelData&,
+                                         const std::vector<int>&);
+template bool decode24bitImage<uint64_t>(Eigen::Ref<img_t<uint64_t>>,
+                                         const ScanChannelData&,
+                                         const std::vector<int>&);
+
+template <typename T>
+bool decode24bitImage(Eigen::Ref<img_t<T>> img,
+                      const ScanChannelData& channel_buf) {
+    return decode_png_rows<3, T>(img, channel_buf, 8, PNG_COLOR_TYPE_RGB,
+                                 nullptr);
+}
+
 template bool decode24bitImage<uint8_t>(Eigen::Ref<img_t<uint8_t>>,
                                         const ScanChannelData&);
 template bool decode24bitImage<uint16_t>(Eigen::Ref<img_t<uint16_t>>,
@@ -306,11 +484,12 @@ template <typename T>
 bool decode32bitImage(Eigen::Ref<img_t<T>> img,
                       const ScanChannelData& channel_buf,
                       const std::vector<int>& px_offset) {
-    if (!decode32bitImage<T>(img, channel_buf)) {
-        img = stagger<T>(img, px_offset);
-        return false;  // SUCCESS
+    check_px_offset<T>(img, px_offset);
+    if (sizeof(T) < 4) {
+        print_bad_pixel_size();
     }
-    return true;  // ERROR
+    return decode_png_rows<4, T>(img, channel_buf, 8, PNG_COLOR_TYPE_RGB_ALPHA,
+                                 &px_offset);
 }
 
 template bool decode32bitImage<uint8_t>(Eigen::Ref<img_t<uint8_t>>,
@@ -332,69 +511,8 @@ bool decode32bitImage(Eigen::Ref<img_t<T>> img,
     if (sizeof(T) < 4) {
         print_bad_pixel_size();
     }
-    // libpng main structs
-    png_structp png_ptr;
-    png_infop png_info_ptr;
-
-    if (png_osf_read_init(&png_ptr, &png_info_ptr)) {
-        return true;
-    }
-
-    if (setjmp(png_jmpbuf(png_ptr))) {
-        png_destroy_read_struct(&png_ptr, &png_info_ptr, nullptr);
-        return true;
-    }
-
-    VectorReader channel_reader(channel_buf);
-    png_set_read_fn(png_ptr, &channel_reader, png_osf_read_data);
-
-    // only used with Gray 16 bit to get little-endian LSB representation back
-    // for other color types PNG_TRANSFORM_SWAP_ENDIAN does nothing
-    int transforms = PNG_TRANSFORM_SWAP_ENDIAN;
-    png_read_png(png_ptr, png_info_ptr, transforms, nullptr);
-
-    png_uint_32 width;
-    png_uint_32 height;
-    int sample_depth;
-    int color_type;
-
-    png_get_IHDR(png_ptr, png_info_ptr, &width, &height, &sample_depth,
-                 &color_type, nullptr, nullptr, nullptr);
-
-    png_bytepp row_pointers = png_get_rows(png_ptr, png_info_ptr);
-
-    // Sanity checks for encoded PNG size
-    if (width != static_cast<png_uint_32>(img.cols()) ||
-        height != static_cast<png_uint_32>(img.rows())) {
-        print_incompatable_image_size(width, height,
-                                      static_cast<png_uint_32>(img.cols()),
-                                      static_cast<png_uint_32>(img.rows()));
-        return true;
-    }
-
-    if (sample_depth != 8) {
-        print_bad_sample_depth(sample_depth, 8);
-        return true;
-    }
-
-    if (color_type != PNG_COLOR_TYPE_RGB_ALPHA) {
-        print_bad_color_type(color_type, PNG_COLOR_TYPE_RGB_ALPHA);
-        return true;
-    }
-
-    // 32bit channel data decoding to LidarScan for key channel_index
-    for (size_t u = 0; u < height; u++) {
-        for (size_t v = 0; v < width; v++) {
-            img(u, v) = static_cast<T>(row_pointers[u][v * 4 + 0]) +
-                        (static_cast<T>(row_pointers[u][v * 4 + 1]) << 8u) +
-                        (static_cast<T>(row_pointers[u][v * 4 + 2]) << 16u) +
-                        (static_cast<T>(row_pointers[u][v * 4 + 3]) << 24u);
-        }
-    }
-
-    png_destroy_read_struct(&png_ptr, &png_info_ptr, nullptr);
-
-    return false;  // SUCCESS
+    return decode_png_rows<4, T>(img, channel_buf, 8, PNG_COLOR_TYPE_RGB_ALPHA,
+                                 nullptr);
 }
 
 template bool decode32bitImage<uint8_t>(Eigen::Ref<img_t<uint8_t>>,
@@ -410,11 +528,12 @@ template <typename T>
 bool decode64bitImage(Eigen::Ref<img_t<T>> img,
                       const ScanChannelData& channel_buf,
                       const std::vector<int>& px_offset) {
-    if (!decode64bitImage<T>(img, channel_buf)) {
-        img = stagger<T>(img, px_offset);
-        return false;  // SUCCESS
+    check_px_offset<T>(img, px_offset);
+    if (sizeof(T) < 8) {
+        print_bad_pixel_size();
     }
-    return true;  // ERROR
+    return decode_png_rows<8, T>(img, channel_buf, 16, PNG_COLOR_TYPE_RGB_ALPHA,
+                                 &px_offset);
 }
 
 template bool decode64bitImage<uint8_t>(Eigen::Ref<img_t<uint8_t>>,
@@ -436,77 +555,8 @@ bool decode64bitImage(Eigen::Ref<img_t<T>> img,
     if (sizeof(T) < 8) {
         print_bad_pixel_size();
     }
-    // libpng main structs
-    png_structp png_ptr;
-    png_infop png_info_ptr;
-
-    if (png_osf_read_init(&png_ptr, &png_info_ptr)) {
-        return true;
-    }
-
-    if (setjmp(png_jmpbuf(png_ptr))) {
-        png_destroy_read_struct(&png_ptr, &png_info_ptr, nullptr);
-        return true;
-    }
-
-    VectorReader channel_reader(channel_buf);
-    png_set_read_fn(png_ptr, &channel_reader, png_osf_read_data);
-
-    // only used with Gray 16 bit to get little-endian LSB representation back
-    // for other color types PNG_TRANSFORM_SWAP_ENDIAN does nothing
-    int transforms = PNG_TRANSFORM_SWAP_ENDIAN;
-    png_read_png(png_ptr, png_info_ptr, transforms, nullptr);
-
-    png_uint_32 width;
-    png_uint_32 height;
-    int sample_depth;
-    int color_type;
-
-    png_get_IHDR(png_ptr, png_info_ptr, &width, &height, &sample_depth,
-                 &color_type, nullptr, nullptr, nullptr);
-
-    png_bytepp row_pointers = png_get_rows(png_ptr, png_info_ptr);
-
-    // Sanity checks for encoded PNG size
-    if (width != static_cast<png_uint_32>(img.cols()) ||
-        height != static_cast<png_uint_32>(img.rows())) {
-        print_incompatable_image_size(width, height,
-                                      static_cast<png_uint_32>(img.cols()),
-                                      static_cast<png_uint_32>(img.rows()));
-
-        return true;
-    }
-
-    if (sample_depth != 16) {
-        print_bad_sample_depth(sample_depth, 16);
-        return true;
-    }
-
-    if (color_type != PNG_COLOR_TYPE_RGB_ALPHA) {
-        print_bad_color_type(color_type, PNG_COLOR_TYPE_RGB_ALPHA);
-
-        return true;
-    }
-
-    // 64bit channel data decoding to LidarScan for key channel_index
-    for (size_t u = 0; u < height; u++) {
-        for (size_t v = 0; v < width; v++) {
-            uint64_t val =
-                static_cast<uint64_t>(row_pointers[u][v * 8 + 0]) +
-                (static_cast<uint64_t>(row_pointers[u][v * 8 + 1]) << 8u) +
-                (static_cast<uint64_t>(row_pointers[u][v * 8 + 2]) << 16u) +
-                (static_cast<uint64_t>(row_pointers[u][v * 8 + 3]) << 24u) +
-                (static_cast<uint64_t>(row_pointers[u][v * 8 + 4]) << 32u) +
-                (static_cast<uint64_t>(row_pointers[u][v * 8 + 5]) << 40u) +
-                (static_cast<uint64_t>(row_pointers[u][v * 8 + 6]) << 48u) +
-                (static_cast<uint64_t>(row_pointers[u][v * 8 + 7]) << 56u);
-            img(u, v) = static_cast<T>(val);
-        }
-    }
-
-    png_destroy_read_struct(&png_ptr, &png_info_ptr, nullptr);
-
-    return false;  // SUCCESS
+    return decode_png_rows<8, T>(img, channel_buf, 16, PNG_COLOR_TYPE_RGB_ALPHA,
+                                 nullptr);
 }
 
 template bool decode64bitImage<uint8_t>(Eigen::Ref<img_t<uint8_t>>,
@@ -522,11 +572,12 @@ template <typename T>
 bool decode16bitImage(Eigen::Ref<img_t<T>> img,
                       const ScanChannelData& channel_buf,
                       const std::vector<int>& px_offset) {
-    if (!decode16bitImage<T>(img, channel_buf)) {
-        img = stagger<T>(img, px_offset);
-        return false;  // SUCCESS
+    check_px_offset<T>(img, px_offset);
+    if (sizeof(T) < 2) {
+        print_bad_pixel_size();
     }
-    return true;  // ERROR
+    return decode_png_rows<2, T>(img, channel_buf, 16, PNG_COLOR_TYPE_GRAY,
+                                 &px_offset);
 }
 
 template bool decode16bitImage<uint8_t>(Eigen::Ref<img_t<uint8_t>>,
@@ -548,67 +599,8 @@ bool decode16bitImage(Eigen::Ref<img_t<T>> img,
     if (sizeof(T) < 2) {
         print_bad_pixel_size();
     }
-    // libpng main structs
-    png_structp png_ptr;
-    png_infop png_info_ptr;
-
-    if (png_osf_read_init(&png_ptr, &png_info_ptr)) {
-        return true;
-    }
-
-    if (setjmp(png_jmpbuf(png_ptr))) {
-        png_destroy_read_struct(&png_ptr, &png_info_ptr, nullptr);
-        return true;
-    }
-
-    VectorReader channel_reader(channel_buf);
-    png_set_read_fn(png_ptr, &channel_reader, png_osf_read_data);
-
-    // only used with Gray 16 bit to get little-endian LSB representation back
-    // for other color types PNG_TRANSFORM_SWAP_ENDIAN does nothing
-    int transforms = PNG_TRANSFORM_SWAP_ENDIAN;
-    png_read_png(png_ptr, png_info_ptr, transforms, nullptr);
-
-    png_uint_32 width;
-    png_uint_32 height;
-    int sample_depth;
-    int color_type;
-
-    png_get_IHDR(png_ptr, png_info_ptr, &width, &height, &sample_depth,
-                 &color_type, nullptr, nullptr, nullptr);
-
-    png_bytepp row_pointers = png_get_rows(png_ptr, png_info_ptr);
-
-    // Sanity checks for encoded PNG size
-    if (width != static_cast<png_uint_32>(img.cols()) ||
-        height != static_cast<png_uint_32>(img.rows())) {
-        print_incompatable_image_size(width, height,
-                                      static_cast<png_uint_32>(img.cols()),
-                                      static_cast<png_uint_32>(img.rows()));
-        return true;
-    }
-
-    if (sample_depth != 16) {
-        print_bad_sample_depth(sample_depth, 16);
-        return true;
-    }
-
-    if (color_type != PNG_COLOR_TYPE_GRAY) {
-        print_bad_color_type(color_type, PNG_COLOR_TYPE_GRAY);
-        return true;
-    }
-
-    // 16bit channel data decoding to LidarScan for key channel_index
-    for (size_t u = 0; u < height; u++) {
-        for (size_t v = 0; v < width; v++) {
-            img(u, v) = static_cast<T>(row_pointers[u][v * 2 + 0]) +
-                        (static_cast<T>(row_pointers[u][v * 2 + 1]) << 8u);
-        }
-    }
-
-    png_destroy_read_struct(&png_ptr, &png_info_ptr, nullptr);
-
-    return false;  // SUCCESS
+    return decode_png_rows<2, T>(img, channel_buf, 16, PNG_COLOR_TYPE_GRAY,
+                                 nullptr);
 }
 
 template bool decode16bitImage<uint8_t>(Eigen::Ref<img_t<uint8_t>>,
@@ -624,11 +616,9 @@ template <typename T>
 bool decode8bitImage(Eigen::Ref<img_t<T>> img,
                      const ScanChannelData& channel_buf,
                      const std::vector<int>& px_offset) {
-    if (!decode8bitImage<T>(img, channel_buf)) {
-        img = stagger<T>(img, px_offset);
-        return false;  // SUCCESS
-    }
-    return true;  // ERROR
+    check_px_offset<T>(img, px_offset);
+    return decode_png_rows<1, T>(img, channel_buf, 8, PNG_COLOR_TYPE_GRAY,
+                                 &px_offset);
 }
 
 template bool decode8bitImage<uint8_t>(Eigen::Ref<img_t<uint8_t>>,
@@ -647,66 +637,8 @@ template bool decode8bitImage<uint64_t>(Eigen::Ref<img_t<uint64_t>>,
 template <typename T>
 bool decode8bitImage(Eigen::Ref<img_t<T>> img,
                      const ScanChannelData& channel_buf) {
-    // libpng main structs
-    png_structp png_ptr;
-    png_infop png_info_ptr;
-
-    if (png_osf_read_init(&png_ptr, &png_info_ptr)) {
-        return true;
-    }
-
-    if (setjmp(png_jmpbuf(png_ptr))) {
-        png_destroy_read_struct(&png_ptr, &png_info_ptr, nullptr);
-        return true;
-    }
-
-    VectorReader channel_reader(channel_buf);
-    png_set_read_fn(png_ptr, &channel_reader, png_osf_read_data);
-
-    // only used with Gray 16 bit to get little-endian LSB representation back
-    // for other color types PNG_TRANSFORM_SWAP_ENDIAN does nothing
-    int transforms = PNG_TRANSFORM_SWAP_ENDIAN;
-    png_read_png(png_ptr, png_info_ptr, transforms, nullptr);
-
-    png_uint_32 width;
-    png_uint_32 height;
-    int sample_depth;
-    int color_type;
-
-    png_get_IHDR(png_ptr, png_info_ptr, &width, &height, &sample_depth,
-                 &color_type, nullptr, nullptr, nullptr);
-
-    png_bytepp row_pointers = png_get_rows(png_ptr, png_info_ptr);
-
-    // Sanity checks for encoded PNG size
-    if (width != static_cast<png_uint_32>(img.cols()) ||
-        height != static_cast<png_uint_32>(img.rows())) {
-        print_incompatable_image_size(width, height,
-                                      static_cast<png_uint_32>(img.cols()),
-                                      static_cast<png_uint_32>(img.rows()));
-        return true;
-    }
-
-    if (sample_depth != 8) {
-        print_bad_sample_depth(sample_depth, 8);
-        return true;
-    }
-
-    if (color_type != PNG_COLOR_TYPE_GRAY) {
-        print_bad_color_type(color_type, PNG_COLOR_TYPE_GRAY);
-        return true;
-    }
-
-    // 16bit channel data decoding to LidarScan for key channel_index
-    for (size_t u = 0; u < height; u++) {
-        for (size_t v = 0; v < width; v++) {
-            img(u, v) = row_pointers[u][v];
-        }
-    }
-
-    png_destroy_read_struct(&png_ptr, &png_info_ptr, nullptr);
-
-    return false;  // SUCCESS
+    return decode_png_rows<1, T>(img, channel_buf, 8, PNG_COLOR_TYPE_GRAY,
+                                 nullptr);
 }
 
 template bool decode8bitImage<uint8_t>(Eigen::Ref<img_t<uint8_t>>,
@@ -738,19 +670,73 @@ void decodeField(ouster::Field& field, const ScanChannelData& buffer) {
         view = view.reshape(rows, cols);
     }
 
+    const bool zstd = is_zstd_buffer(buffer);
+    const bool banded = is_banded_buffer(buffer);
     bool res = true;
+    if (is_sparse_buffer(buffer)) {
+        switch (view.tag()) {
+            case sensor::ChanFieldType::UINT8:
+                res = decodeSparseImage<uint8_t>(view, buffer, nullptr);
+                break;
+            case sensor::ChanFieldType::UINT16:
+                res = decodeSparseImage<uint16_t>(view, buffer, nullptr);
+                break;
+            case sensor::ChanFieldType::UINT32:
+                res = decodeSparseImage<uint32_t>(view, buffer, nullptr);
+                break;
+            case sensor::ChanFieldType::UINT64:
+                res = decodeSparseImage<uint64_t>(view, buffer, nullptr);
+                break;
+            default:
+                break;
+        }
+        if (res) {
+            throw std::runtime_error("decodeField: could not decode field");
+        }
+        return;
+    }
+    if (is_lossy_buffer(buffer)) {
+        switch (view.tag()) {
+            case sensor::ChanFieldType::UINT8:
+                res = decodeLossyImage<uint8_t>(view, buffer, nullptr);
+                break;
+            case sensor::ChanFieldType::UINT16:
+                res = decodeLossyImage<uint16_t>(view, buffer, nullptr);
+                break;
+            case sensor::ChanFieldType::UINT32:
+                res = decodeLossyImage<uint32_t>(view, buffer, nullptr);
+                break;
+            case sensor::ChanFieldType::UINT64:
+                res = decodeLossyImage<uint64_t>(view, buffer, nullptr);
+                break;
+            default:
+                break;
+        }
+        if (res) {
+            throw std::runtime_error("decodeField: could not decode field");
+        }
+        return;
+    }
     switch (view.tag()) {
         case sensor::ChanFieldType::UINT8:
-            res = decode8bitImage<uint8_t>(view, buffer);
+            res = banded ? decodeBandedImage<uint8_t>(view, buffer, nullptr)
+                  : zstd ? decodeZstdImage<uint8_t>(view, buffer)
+                         : decode8bitImage<uint8_t>(view, buffer);
             break;
         case sensor::ChanFieldType::UINT16:
-            res = decode16bitImage<uint16_t>(view, buffer);
+            res = banded ? decodeBandedImage<uint16_t>(view, buffer, nullptr)
+                  : zstd ? decodeZstdImage<uint16_t>(view, buffer)
+                         : decode16bitImage<uint16_t>(view, buffer);
             break;
         case sensor::ChanFieldType::UINT32:
-            res = decode32bitImage<uint32_t>(view, buffer);
+            res = banded ? decodeBandedImage<uint32_t>(view, buffer, nullptr)
+                  : zstd ? decodeZstdImage<uint32_t>(view, buffer)
+                         : decode32bitImage<uint32_t>(view, buffer);
             break;
         case sensor::ChanFieldType::UINT64:
-            res = decode64bitImage<uint64_t>(view, buffer);
+            res = banded ? decodeBandedImage<uint64_t>(view, buffer, nullptr)
+                  : zstd ? decodeZstdImage<uint64_t>(view, buffer)
+                         : decode64bitImage<uint64_t>(view, buffer);
             break;
         default:
             break;
@@ -25,10 +25,14 @@ using ScanChannelData = std::vector<uint8_t>;
 using ScanData = std::vector<ScanChannelData>;
 
 bool png_osf_write_init(png_structpp png_ptrp, png_infopp png_info_ptrp);
+// filter: PNG_FILTER_* flags, strategy: a zlib Z_* strategy, -1 for libpng's
+// choice
 void png_osf_write_start(png_structp png_ptr, png_infop png_info_ptr,
                          ScanChannelData& res_buf, uint32_t width,
                          uint32_t height, int sample_depth, int color_type,
-                         int compression_amount);
+                         int compression_amount, int filter = -1,
+                         int strategy = -1);
+void png_osf_write_end(png_structp png_ptr, const ScanChannelData& res_buf);
 /**
  * libpng only versions for Encode/Decode LidarScan to PNG buffers
  */
@@ -0,0 +1,346 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/osf/read_ahead.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "ouster/osf/stream_lidar_scan.h"
+#include "reader_cache.h"
+
+namespace ouster {
+namespace osf {
+
+namespace {
+
+bool has_any(const LidarScanFieldTypes& field_types,
+             const std::vector<std::string>& fields) {
+    return std::any_of(field_types.begin(), field_types.end(),
+                       [&fields](const FieldType& ft) {
+                           return std::find(fields.begin(), fields.end(),
+                                            ft.name) != fields.end();
+                       });
+}
+
+/**
+ * The streams to read, leaving out the streams of columnar sensors that hold
+ * none of the fields, unless all of the sensor's streams do.
+ */
+std::vector<uint32_t> select_streams(Reader& reader,
+                                     const std::vector<uint32_t>& stream_ids,
+                                     const std::vector<std::string>& fields) {
+    if (fields.empty()) return stream_ids;
+    std::vector<uint32_t> ids = stream_ids;
+    if (ids.empty()) {
+        for (const auto& sm : reader.chunks_pile().stream_chunks()) {
+            ids.push_back(sm.first);
+        }
+    }
+    const MetadataStore& store = reader.meta_store();
+    std::map<uint32_t, size_t> sensor_streams;
+    for (const auto id : ids) {
+        if (auto meta = store.get<LidarScanStreamMeta>(id)) {
+            sensor_streams[meta->sensor_meta_id()]++;
+        }
+    }
+    std::vector<uint32_t> selected;
+    std::map<uint32_t, uint32_t> skipped;
+    for (const auto id : ids) {
+        auto meta = store.get<LidarScanStreamMeta>(id);
+        // streams with no standard fields may hold any custom field
+        if (meta && sensor_streams[meta->sensor_meta_id()] > 1 &&
+            !meta->field_types().empty() &&
+            !has_any(meta->field_types(), fields)) {
+            skipped.emplace(meta->sensor_meta_id(), id);
+            continue;
+        }
+        if (meta) sensor_streams[meta->sensor_meta_id()] = 0;
+        selected.push_back(id);
+    }
+    // a sensor with none of the fields still fails decoding as it would
+    for (const auto& s : skipped) {
+        if (sensor_streams[s.first] > 0) selected.push_back(s.second);
+    }
+    if (selected.size() == ids.size()) return stream_ids;
+    std::sort(selected.begin(), selected.end());
+    return selected;
+}
+
+/**
+ * Decode a message of a stream of a columnar sensor, through the scans cache.
+ */
+std::unique_ptr<LidarScan> decode_part(const MessageRef& msg,
+                                       uint64_t chunk_offset, size_t msg_idx,
+                                       const std::vector<std::string>& fields,
+                                       ReaderCache& cache) {
+    const bool cached = cache.scans.capacity() > 0;
+    ScanCacheKey key{msg.id(), chunk_offset, msg_idx, fields};
+    if (cached) {
+        if (auto scan = cache.scans.get(key)) {
+            return std::make_unique<LidarScan>(scan->shallow_copy());
+        }
+    }
+    auto scan = msg.decode_msg<LidarScanStream>(fields);
+    if (cached && scan) {
+        cache.scans.put(key, std::make_shared<LidarScan>(scan->shallow_copy()),
+                        scan_cache_bytes(*scan));
+    }
+    return scan;
+}
+
+}  // namespace
+
+ScanReadAhead::ScanReadAhead(Reader& reader,
+                             const std::vector<uint32_t>& stream_ids,
+                             ts_t start_ts, ts_t end_ts,
+                             const std::vector<std::string>& fields,
+                             const ReadAheadOptions& options)
+    : reader_(reader),
+      stream_ids_(select_streams(reader, stream_ids, fields)),
+      end_ts_(end_ts),
+      fields_(fields),
+      options_(options),
+      range_(reader.messages(stream_ids_, start_ts, end_ts)),
+      it_(range_.begin()),
+      end_(range_.end()) {
+    if (!options_.thread_pool) options_.thread_pool = default_thread_pool();
+    if (options_.scans == 0) options_.scans = options_.thread_pool->size() + 1;
+    if (stream_ids_.empty()) {
+        for (const auto& sm : reader_.chunks_pile().stream_chunks()) {
+            stream_ids_.push_back(sm.first);
+        }
+    }
+
+    // the streams of a sensor with several are the columns of its scans
+    std::map<uint32_t, std::vector<uint32_t>> sensor_streams;
+    for (const auto id : stream_ids_) {
+        if (auto meta = reader_.meta_store().get<LidarScanStreamMeta>(id)) {
+            sensor_streams[meta->sensor_meta_id()].push_back(id);
+        }
+    }
+    for (const auto& s : sensor_streams) {
+        if (s.second.size() < 2) continue;
+        const uint32_t first =
+            *std::min_element(s.second.begin(), s.second.end());
+        columns_[first] = s.second.size();
+        for (const auto id : s.second) {
+            column_of_[id] = first;
+            auto meta = reader_.meta_store().get<LidarScanStreamMeta>(id);
+            if (fields_.empty() || meta->field_types().empty()) continue;
+            auto& decoded = column_fields_[id];
+            for (const auto& ft : meta->field_types()) {
+                if (std::find(fields_.begin(), fields_.end(), ft.name) !=
+                    fields_.end()) {
+                    decoded.push_back(ft.name);
+                }
+            }
+        }
+    }
+}
+
+ScanReadAhead::~ScanReadAhead() {
+    // the tasks refer to the reader and notify through this object
+    std::unique_lock<std::mutex> lock(mutex_);
+    decoded_.wait(lock, [this] { return in_flight_ == 0; });
+}
+
+void ScanReadAhead::fill() {
+    bool queued = false;
+    ts_t last_ts{0};
+    std::shared_ptr<ReaderCache> cache = reader_.cache_;
+    const bool cached = cache->scans.capacity() > 0;
+    // a scan of a columnar sensor is complete once the messages of all its
+    // streams at its timestamp are read, which follow each other
+    while ((pending_.size() < options_.scans || !open_.empty()) &&
+           it_ != end_) {
+        const MessageRef msg = *it_;
+        const auto& top = it_.curr_chunks_.top();
+        ScanCacheKey key{msg.id(), top.first.offset(), top.second, fields_};
+        Part part{msg, top.first.offset(), top.second};
+        ++it_;
+        if (!msg.is<LidarScanStream>()) continue;
+
+        auto column = column_of_.find(msg.id());
+        if (column != column_of_.end()) {
+            if (add_part(column->second, std::move(part))) {
+                queued = true;
+                last_ts = msg.ts();
+            }
+            continue;
+        }
+
+        auto item = std::make_shared<Pending>();
+        item->result.stream_id = msg.id();
+        item->result.ts = msg.ts();
+        pending_.push_back(item);
+        if (cached) {
+            // the cached scan is shared, the consumer gets its own copy,
+            // which only copies the fields it writes to
+            if (auto scan = cache->scans.get(key)) {
+                item->result.scan =
+                    std::make_unique<LidarScan>(scan->shallow_copy());
+                item->decoded = true;
+                continue;
+            }
+        }
+        queued = true;
+        last_ts = msg.ts();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++in_flight_;
+        }
+        options_.thread_pool->submit([this, item, msg, cache, cached, key] {
+            try {
+                item->result.scan = msg.decode_msg<LidarScanStream>(fields_);
+                if (cached && item->result.scan) {
+                    const LidarScan& scan = *item->result.scan;
+                    cache->scans.put(
+                        key, std::make_shared<LidarScan>(scan.shallow_copy()),
+                        scan_cache_bytes(scan));
+                }
+            } catch (...) {
+                item->error = std::current_exception();
+            }
+            // notified under the lock since the ScanReadAhead may be gone
+            // once the last scan in flight is decoded
+            std::lock_guard<std::mutex> lock(mutex_);
+            item->decoded = true;
+            --in_flight_;
+            decoded_.notify_all();
+        });
+    }
+    if (it_ == end_) {
+        // no more messages for the scans missing some streams
+        for (const auto& entry : open_) submit(entry.second);
+        open_.clear();
+    }
+    if (queued) prefetch(last_ts);
+}
+
+bool ScanReadAhead::add_part(uint32_t first, Part part) {
+    const ts_t ts = part.msg.ts();
+    bool submitted = false;
+    // earlier scans of the sensor won't get any more streams
+    for (auto it = open_.begin(); it != open_.end();) {
+        if (it->first.first == first && it->first.second < ts) {
+            submit(it->second);
+            submitted = true;
+            it = open_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    std::shared_ptr<Pending>& entry = open_[{first, ts}];
+    if (!entry) {
+        entry = std::make_shared<Pending>();
+        entry->result.stream_id = first;
+        entry->result.ts = ts;
+        pending_.push_back(entry);
+    }
+    std::shared_ptr<Pending> item = entry;
+    item->parts.push_back(std::move(part));
+    if (item->parts.size() == columns_[first]) {
+        open_.erase(std::make_pair(first, ts));
+        submit(item);
+        submitted = true;
+    }
+    return submitted;
+}
+
+void ScanReadAhead::submit(const std::shared_ptr<Pending>& item) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++in_flight_;
+    }
+    std::shared_ptr<ReaderCache> cache = reader_.cache_;
+    options_.thread_pool->submit([this, item, cache] {
+        try {
+            std::unique_ptr<LidarScan> merged;
+            for (const Part& part : item->parts) {
+                auto fields = column_fields_.find(part.msg.id());
+                auto scan = decode_part(
+                    part.msg, part.chunk_offset, part.msg_idx,
+                    fields == column_fields_.end() ? std::vector<std::string>{}
+                                                   : fields->second,
+                    *cache);
+                if (!scan) {
+                    merged.reset();
+                    break;
+                }
+                if (!merged) {
+                    merged = std::move(scan);
+                    continue;
+                }
+                auto& dst = merged->fields();
+                for (auto& f : scan->fields()) {
+                    dst.emplace(f.first, std::move(f.second));
+                }
+            }
+            if (merged && !fields_.empty()) {
+                std::vector<std::string> extra;
+                for (const auto& f : merged->fields()) {
+                    if (std::find(fields_.begin(), fields_.end(), f.first) ==
+                        fields_.end()) {
+                        extra.push_back(f.first);
+                    }
+                }
+                for (const auto& name : extra) merged->del_field(name);
+                for (const auto& name : fields_) {
+                    if (!merged->has_field(name)) {
+                        throw std::runtime_error("Requested field '" + name +
+                                                 "' does not exist in OSF.");
+                    }
+                }
+            }
+            item->result.scan = std::move(merged);
+        } catch (...) {
+            item->error = std::current_exception();
+        }
+        // notified under the lock since the ScanReadAhead may be gone
+        // once the last scan in flight is decoded
+        std::lock_guard<std::mutex> lock(mutex_);
+        item->decoded = true;
+        --in_flight_;
+        decoded_.notify_all();
+    });
+}
+
+void ScanReadAhead::prefetch(ts_t ts) {
+    if (options_.chunks == 0) return;
+    ChunksPile& chunks = reader_.chunks_pile();
+    for (const auto stream_id : stream_ids_) {
+        // the chunk holding ts, then the ones after it
+        auto* cs = chunks.get_by_lower_bound_ts(stream_id, ts);
+        for (size_t i = 0; cs != nullptr && i <= options_.chunks &&
+                           cs->start_ts <= end_ts_;
+             ++i) {
+            if (prefetched_.insert(cs->offset).second) {
+                reader_.file_.prefetch_chunk(reader_.chunks_base_offset_ +
+                                             cs->offset);
+            }
+            cs = chunks.next_by_stream(cs->offset);
+        }
+    }
+}
+
+bool ScanReadAhead::next(DecodedScan& scan) {
+    fill();
+    if (pending_.empty()) return false;
+    std::shared_ptr<Pending> item = pending_.front();
+    pending_.pop_front();
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        decoded_.wait(lock, [&item] { return item->decoded; });
+    }
+    // keep the pool busy while the consumer works on this scan
+    fill();
+    if (item->error) std::rethrow_exception(item->error);
+    scan = std::move(item->result);
+    return true;
+}
+
+}  // namespace osf
+}  // namespace ouster
@@ -5,7 +5,10 @@
 
 #include "ouster/osf/reader.h"
 
+#include <algorithm>
 #include <memory>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 #include "fb_utils.h"
@@ -15,7 +18,9 @@
 #include "ouster/osf/file.h"
 #include "ouster/osf/meta_streaming_info.h"
 #include "ouster/osf/metadata.h"
+#include "ouster/trace.h"
 #include "ouster/types.h"
+#include "reader_cache.h"
 
 using StreamChunksMap =
     std::unordered_map<uint32_t, std::shared_ptr<std::vector<uint64_t>>>;
@@ -49,7 +54,8 @@ void ChunksPile::add(uint64_t offset, ts_t start_ts, ts_t end_ts) {
 }
 
 void ChunksPile::add_info(uint64_t offset, uint32_t stream_id,
-                          uint32_t message_count) {
+                          uint32_t message_count,
+                          const ChunkSummary& summary) {
     auto chunk_state = get(offset);
     if (chunk_state == nullptr) {
         // allowing adding info on chunks that already present with
@@ -61,6 +67,7 @@ void ChunksPile::add_info(uint64_t offset, uint32_t stream_id,
     ci.next_offset = std::numeric_limits<uint64_t>::max();
     ci.stream_id = stream_id;
     ci.message_count = message_count;
+    ci.summary = summary;
     pile_info_[offset] = ci;
 }
 
@@ -113,6 +120,22 @@ ChunkState* ChunksPile::get_by_lower_bound_ts(uint32_t stream_id,
     return get(*lb_offset);
 }
 
+void ChunksPile::add_timestamps(uint32_t stream_id,
+                                const std::vector<uint64_t>& timestamps) {
+    stream_timestamps_[stream_id] = timestamps;
+}
+
+nonstd::optional<uint32_t> ChunksPile::message_idx_by_lower_bound_ts(
+    uint32_t stream_id, const ts_t ts) const {
+    auto stimestamps = stream_timestamps_.find(stream_id);
+    if (stimestamps == stream_timestamps_.end()) return nonstd::nullopt;
+    const auto& timestamps = stimestamps->second;
+    const uint64_t t = ts.count() > 0 ? static_cast<uint64_t>(ts.count()) : 0;
+    auto lb = std::lower_bound(timestamps.begin(), timestamps.end(), t);
+    if (lb == timestamps.end()) return nonstd::nullopt;
+    return static_cast<uint32_t>(lb - timestamps.begin());
+}
+
 ChunkState* ChunksPile::next(uint64_t offset) {
     auto chunk = get(offset);
     if (!chunk) return nullptr;
@@ -251,7 +274,7 @@ void ChunksIter::next() {
 
 void ChunksIter::next_any() {
     if (current_addr_ == end_addr_) return;
-    auto next_chunk = reader_->chunks_.next(current_addr_);
+    auto next_chunk = reader_->chunks_pile().next(current_addr_);
     if (next_chunk) {
         current_addr_ = next_chunk->offset;
     } else {
@@ -346,6 +369,47 @@ MessagesStreamingRange Reader::messages(const std::vector<uint32_t>& stream_ids,
     return MessagesStreamingRange(start_ts, end_ts, stream_ids, this);
 }
 
+MessagesStreamingRange Reader::messages(const std::vector<uint32_t>& stream_ids,
+                                        const ts_t start_ts, const ts_t end_ts,
+                                        ChunkFilter filter) {
+    if (!has_stream_info()) {
+        throw std::logic_error(
+            "ERROR: Can't iterate by streams without StreamingInfo "
+            "available.");
+    }
+    return MessagesStreamingRange(start_ts, end_ts, stream_ids, this,
+                                  std::move(filter));
+}
+
+std::vector<MessagesStreamingRange> Reader::stream_messages(
+    const std::vector<uint32_t>& stream_ids, const ts_t start_ts,
+    const ts_t end_ts) {
+    if (!has_stream_info()) {
+        throw std::logic_error(
+            "ERROR: Can't iterate by streams without StreamingInfo "
+            "available.");
+    }
+    std::vector<uint32_t> ids = stream_ids;
+    if (ids.empty()) {
+        for (const auto& sm : chunks_pile().stream_chunks()) {
+            ids.push_back(sm.first);
+        }
+        std::sort(ids.begin(), ids.end());
+    }
+    std::vector<MessagesStreamingRange> ranges;
+    ranges.reserve(ids.size());
+    for (const auto stream_id : ids) {
+        ranges.push_back(
+            MessagesStreamingRange(start_ts, end_ts, {stream_id}, this));
+    }
+    return ranges;
+}
+
+std::vector<MessagesStreamingRange> Reader::stream_messages(
+    const std::vector<uint32_t>& stream_ids) {
+    return stream_messages(stream_ids, start_ts(), end_ts());
+}
+
 nonstd::optional<ts_t> Reader::ts_by_message_idx(uint32_t stream_id,
                                                  uint32_t message_idx) {
     if (!has_stream_info()) {
@@ -353,12 +417,12 @@ nonstd::optional<ts_t> Reader::ts_by_message_idx(uint32_t stream_id,
             "ERROR: Can't iterate by streams without StreamingInfo "
             "available.");
     }
-    if (!chunks_.has_message_idx()) {
+    if (!chunks_pile().has_message_idx()) {
         return nonstd::nullopt;
     }
     // TODO: Check for message_count existence
     ChunkInfoNode* cin =
-        chunks_.get_info_by_message_idx(stream_id, message_idx);
+        chunks_pile().get_info_by_message_idx(stream_id, message_idx);
     if (!cin) return nonstd::nullopt;
 
     if (!verify_chunk(cin->offset)) {
@@ -370,7 +434,7 @@ nonstd::optional<ts_t> Reader::ts_by_message_idx(uint32_t stream_id,
     // shortcuting and not reading the chunk content if it's very first message
     // and we already checked validity
     if (chunk_msg_index == 0) {
-        return {chunks_.get(cin->offset)->start_ts};
+        return {chunks_pile().get(cin->offset)->start_ts};
     }
 
     // reading chunk data to get message timestamp
@@ -382,7 +446,118 @@ nonstd::optional<ts_t> Reader::ts_by_message_idx(uint32_t stream_id,
     return nonstd::nullopt;
 }
 
-bool Reader::has_message_idx() const { return chunks_.has_message_idx(); };
+uint64_t StreamIndex::chunk_offset(uint32_t message_idx) const {
+    if (message_idx >= message_count || chunk_offsets.empty()) {
+        throw std::out_of_range("StreamIndex: no chunk holds message " +
+                                std::to_string(message_idx));
+    }
+    auto it = std::upper_bound(chunk_message_starts.begin(),
+                               chunk_message_starts.end(), message_idx);
+    return chunk_offsets[it - chunk_message_starts.begin() - 1];
+}
+
+StreamIndex Reader::stream_index(uint32_t stream_id) const {
+    if (!has_stream_info()) {
+        throw std::logic_error(
+            "ERROR: Can't index streams without StreamingInfo available.");
+    }
+    StreamIndex index;
+    index.stream_id = stream_id;
+    auto streaming_info = meta_store_.get<osf::StreamingInfo>();
+    auto stats = streaming_info->stream_stats().find(stream_id);
+    if (stats == streaming_info->stream_stats().end()) return index;
+    index.message_count = stats->second.message_count;
+    if (stats->second.receive_timestamps.size() == index.message_count) {
+        index.timestamps = stats->second.receive_timestamps;
+    }
+
+    auto& pile = chunks_pile();
+    if (!pile.has_message_idx()) return index;
+    auto chunks = pile.stream_chunks().find(stream_id);
+    if (chunks == pile.stream_chunks().end()) return index;
+    index.chunk_offsets = *chunks->second;
+    for (auto offset : index.chunk_offsets) {
+        index.chunk_message_starts.push_back(
+            pile.get_info(offset)->message_start_idx);
+    }
+    return index;
+}
+
+std::vector<int64_t> Reader::collate_messages(
+    const std::vector<uint32_t>& stream_ids, int64_t dt) const {
+    const size_t n = stream_ids.size();
+    std::vector<StreamIndex> indices;
+    for (auto stream_id : stream_ids) {
+        indices.push_back(stream_index(stream_id));
+        if (indices.back().timestamps.size() !=
+            indices.back().message_count) {
+            throw std::logic_error(
+                "ERROR: Can't collate messages without timestamp index of "
+                "stream " +
+                std::to_string(stream_id));
+        }
+    }
+
+    // all messages ordered by timestamp, keeping the order of the streams
+    // for messages at the same time
+    struct Message {
+        int64_t ts;
+        uint32_t slot;
+        int64_t idx;
+    };
+    std::vector<Message> messages;
+    for (size_t i = 0; i < n; ++i) {
+        const auto& timestamps = indices[i].timestamps;
+        for (size_t j = 0; j < timestamps.size(); ++j) {
+            messages.push_back({static_cast<int64_t>(timestamps[j]),
+                                static_cast<uint32_t>(i),
+                                static_cast<int64_t>(j)});
+        }
+    }
+    std::stable_sort(
+        messages.begin(), messages.end(),
+        [](const Message& a, const Message& b) { return a.ts < b.ts; });
+
+    std::vector<int64_t> frames;
+    std::vector<int64_t> frame(n, -1);
+    size_t count = 0;
+    bool started = false;
+    int64_t min_ts = 0;
+    int64_t max_ts = 0;
+    auto cut = [&]() {
+        if (count == 0) return;
+        frames.insert(frames.end(), frame.begin(), frame.end());
+        std::fill(frame.begin(), frame.end(), -1);
+        count = 0;
+    };
+    for (const auto& msg : messages) {
+        if (!started || msg.ts >= min_ts + dt || msg.ts < max_ts - dt) {
+            // reached the dt boundary
+            cut();
+            started = true;
+            min_ts = max_ts = msg.ts;
+        }
+        if (frame[msg.slot] >= 0) {
+            // reached a message of a stream already in the frame
+            cut();
+            min_ts = max_ts = msg.ts;
+        }
+        frame[msg.slot] = msg.idx;
+        if (++count == n) {
+            // got a message of every stream
+            cut();
+            min_ts = max_ts = msg.ts;
+        }
+        min_ts = std::min(min_ts, msg.ts);
+        max_ts = std::max(max_ts, msg.ts);
+    }
+    cut();
+    return frames;
+}
+
+bool Reader::has_message_idx() const {
+    return chunks_pile().has_message_idx();
+};
 
 bool Reader::has_timestamp_idx() const {
     // just check metadata for any elements in the stats timestamp array
@@ -405,7 +580,10 @@ ChunksRange Reader::chunks() {
     return ChunksRange(0, file_.metadata_offset(), this);
 }
 
-Reader::Reader(const std::string& file) : file_{file} {
+Reader::Reader(const std::string& file) : Reader(file, FileOptions()) {}
+
+Reader::Reader(const std::string& file, const FileOptions& options)
+    : file_{file, options}, cache_{std::make_shared<ReaderCache>()} {
     if (!file_.valid()) {
         logger().error(
             "ERROR: While openning OSF file. "
@@ -419,10 +597,13 @@ Reader::Reader(const std::string& file) : file_{file} {
 
     read_metadata();
 
-    read_chunks_info();
+    has_streaming_info_ = meta_store_.get<osf::StreamingInfo>() != nullptr;
+
+    if (!file_.options().lazy_open) chunks_pile();
 }
 
-Reader::Reader(OsfFile& osf_file) : Reader(osf_file.filename()) {}
+Reader::Reader(OsfFile& osf_file)
+    : Reader(osf_file.filename(), osf_file.options()) {}
 
 void Reader::read_metadata() {
     metadata_buf_.resize(FLATBUFFERS_PREFIX_LENGTH);
@@ -442,7 +623,9 @@ void Reader::read_metadata() {
     file_.read(metadata_buf_.data() + FLATBUFFERS_PREFIX_LENGTH,
                meta_size + CRC_BYTES_SIZE);
 
-    if (!check_prefixed_size_block_crc(metadata_buf_.data(), full_meta_size)) {
+    // OsfFile::valid() checked it already, again unless opening fast
+    if (!file_.options().lazy_open &&
+        !check_prefixed_size_block_crc(metadata_buf_.data(), full_meta_size)) {
         throw std::logic_error("ERROR: Invalid metadata block in OSF file.");
     }
 
@@ -468,6 +651,13 @@ void Reader::read_metadata() {
         }
     }
 
+    // NOTE: Left here for debugging
+    // print_metadata_entries();
+}
+
+void Reader::read_chunks_states() const {
+    auto metadata = get_osf_metadata_from_buf(metadata_buf_.data());
+
     // Get chunks states
     std::vector<uint64_t> chunk_offsets{};
     if (metadata->chunks() && metadata->chunks()->size() > 0) {
@@ -485,19 +675,13 @@ void Reader::read_metadata() {
             chunks_.get(chunk_offsets[i])->next_offset = chunk_offsets[i + 1];
         }
     }
-
-    // NOTE: Left here for debugging
-    // print_metadata_entries();
 }
 
-void Reader::read_chunks_info() {
+void Reader::read_chunks_info() const {
     // Check that it has StreamingInfo and thus a valid StreamingLayout OSF
     // see RFC0018 for details
     auto streaming_info = meta_store_.get<osf::StreamingInfo>();
-    if (!streaming_info) {
-        has_streaming_info_ = false;
-        return;
-    }
+    if (!streaming_info) return;
 
     if (streaming_info->chunks_info().size() != chunks_.size()) {
         throw std::logic_error(
@@ -507,14 +691,31 @@ void Reader::read_chunks_info() {
 
     for (const auto& sci : streaming_info->chunks_info()) {
         chunks_.add_info(sci.first, sci.second.stream_id,
-                         sci.second.message_count);
+                         sci.second.message_count, sci.second.summary);
     }
 
-    has_streaming_info_ = true;
+    // the timestamps of the stats index every message of their stream
+    for (const auto& stat : streaming_info->stream_stats()) {
+        if (stat.second.message_count > 0 &&
+            stat.second.receive_timestamps.size() ==
+                stat.second.message_count) {
+            chunks_.add_timestamps(stat.first,
+                                   stat.second.receive_timestamps);
+        }
+    }
 
     chunks_.link_stream_chunks();
 }
 
+ChunksPile& Reader::chunks_pile() const {
+    // a failed indexing throws and is attempted again on the next use
+    std::call_once(chunks_indexed_, [this] {
+        read_chunks_states();
+        read_chunks_info();
+    });
+    return chunks_;
+}
+
 // TODO[pb]: MetadataStore to_string() ?
 
 std::string Reader::metadata_id() const {
@@ -544,17 +745,44 @@ const MetadataStore& Reader::meta_store() const { return meta_store_; }
 
 bool Reader::has_stream_info() const { return has_streaming_info_; }
 
+void Reader::set_cache(const ReaderCacheOptions& options) {
+    cache_->chunks.set_capacity(options.chunk_bytes);
+    cache_->scans.set_capacity(options.scan_bytes);
+}
+
+ReaderCacheOptions Reader::cache_options() const {
+    return {cache_->chunks.capacity(), cache_->scans.capacity()};
+}
+
+std::shared_ptr<ChunkBuffer> Reader::read_chunk(uint64_t chunk_offset) {
+    auto chunk_buf = cache_->chunks.get(chunk_offset);
+    if (chunk_buf) return chunk_buf;
+    OUSTER_TRACE_SCOPE("osf", "Reader::read_chunk");
+    std::shared_ptr<ChunkBuffer> read_buf;
+    {
+        std::lock_guard<std::mutex> lock(file_mutex_);
+        read_buf = file_.read_chunk(chunks_base_offset_ + chunk_offset);
+    }
+    if (read_buf) cache_->chunks.put(chunk_offset, read_buf, read_buf->size());
+    return read_buf;
+}
+
 bool Reader::verify_chunk(uint64_t chunk_offset) {
-    auto cs = chunks_.get(chunk_offset);
+    auto cs = chunks_pile().get(chunk_offset);
     if (!cs) return false;
-    if (cs->status == ChunkValidity::UNKNOWN) {
-        auto chunk_buf = file_.read_chunk(chunks_base_offset_ + chunk_offset);
-        cs->status =
-            osf::check_osf_chunk_buf(chunk_buf->data(), chunk_buf->size())
-                ? ChunkValidity::VALID
-                : ChunkValidity::INVALID;
+    {
+        std::lock_guard<std::mutex> lock(file_mutex_);
+        if (cs->status != ChunkValidity::UNKNOWN) {
+            return (cs->status == ChunkValidity::VALID);
+        }
     }
-    return (cs->status == ChunkValidity::VALID);
+    // checked outside of the lock, at worst twice by racing streams
+    auto chunk_buf = read_chunk(chunk_offset);
+    const bool valid =
+        osf::check_osf_chunk_buf(chunk_buf->data(), chunk_buf->size());
+    std::lock_guard<std::mutex> lock(file_mutex_);
+    cs->status = valid ? ChunkValidity::VALID : ChunkValidity::INVALID;
+    return valid;
 }
 
 // =========================================================
@@ -567,6 +795,15 @@ MessageRef::MessageRef(const uint8_t* buf, const MetadataStore& meta_provider,
                        std::shared_ptr<std::vector<uint8_t>> chunk_buf)
     : buf_(buf), meta_provider_(meta_provider), chunk_buf_{chunk_buf} {}
 
+MessageRef::MessageRef(const uint8_t* buf, const MetadataStore& meta_provider,
+                       std::shared_ptr<std::vector<uint8_t>> chunk_buf,
+                       const uint8_t* chunk_ptr, size_t msg_idx)
+    : buf_(buf),
+      meta_provider_(meta_provider),
+      chunk_buf_{chunk_buf},
+      chunk_ptr_{chunk_ptr},
+      msg_idx_{msg_idx} {}
+
 uint32_t MessageRef::id() const {
     const ouster::osf::v2::StampedMessage* sm =
         reinterpret_cast<const ouster::osf::v2::StampedMessage*>(buf_);
@@ -616,6 +853,32 @@ std::vector<uint8_t> MessageRef::buffer() const {
     return {sm->buffer()->data(), sm->buffer()->data() + sm->buffer()->size()};
 }
 
+ConstArrayView1<uint8_t> MessageRef::view() const {
+    const ouster::osf::gen::StampedMessage* sm =
+        reinterpret_cast<const ouster::osf::gen::StampedMessage*>(buf_);
+
+    if (sm->buffer() == nullptr) {
+        return {nullptr, {0}};
+    }
+
+    return {sm->buffer()->data(), {static_cast<int>(sm->buffer()->size())}};
+}
+
+std::unique_ptr<const MessageRef> MessageRef::previous() const {
+    if (chunk_ptr_ == nullptr) return nullptr;
+    const ouster::osf::v2::Chunk* chunk = get_chunk_from_buf(chunk_ptr_);
+    const uint32_t stream_id = id();
+    for (size_t i = msg_idx_; i-- > 0;) {
+        const ouster::osf::v2::StampedMessage* m = chunk->messages()->Get(i);
+        if (m->id() == stream_id) {
+            return std::make_unique<const MessageRef>(
+                reinterpret_cast<const uint8_t*>(m), meta_provider_,
+                chunk_buf_, chunk_ptr_, i);
+        }
+    }
+    return nullptr;
+}
+
 // =======================================================
 // =========== ChunkRef ==================================
 // =======================================================
@@ -628,30 +891,29 @@ ChunkRef::ChunkRef()
 ChunkRef::ChunkRef(const uint64_t offset, Reader* reader)
     : chunk_offset_(offset), reader_(reader) {
     if (!reader->file_.is_memory_mapped()) {
-        // NOTE[pb]: We just rely on OS file operations caching thus not
-        // trying to cache the read chunks in reader, however we might
-        // reconsider it if we will discover the our caching might give
-        // us better results (for now it's as is)
-        chunk_buf_ = reader->file_.read_chunk(reader_->chunks_base_offset_ +
-                                              chunk_offset_);
+        // the chunk is read again unless it's in the chunk cache of the
+        // reader, see Reader::set_cache()
+        chunk_buf_ = reader_->read_chunk(chunk_offset_);
     }
     // Always expects "verified" chunk offset. See Reader::verify_chunk()
-    assert(reader_->chunks_.get(chunk_offset_)->status !=
+    assert(reader_->chunks_pile().get(chunk_offset_)->status !=
            ChunkValidity::UNKNOWN);
 }
 
-ChunkState* ChunkRef::state() { return reader_->chunks_.get(chunk_offset_); }
+ChunkState* ChunkRef::state() {
+    return reader_->chunks_pile().get(chunk_offset_);
+}
 
 const ChunkState* ChunkRef::state() const {
-    return reader_->chunks_.get(chunk_offset_);
+    return reader_->chunks_pile().get(chunk_offset_);
 }
 
 ChunkInfoNode* ChunkRef::info() {
-    return reader_->chunks_.get_info(chunk_offset_);
+    return reader_->chunks_pile().get_info(chunk_offset_);
 }
 
 const ChunkInfoNode* ChunkRef::info() const {
-    return reader_->chunks_.get_info(chunk_offset_);
+    return reader_->chunks_pile().get_info(chunk_offset_);
 }
 
 size_t ChunkRef::size() const {
@@ -674,14 +936,16 @@ std::unique_ptr<const MessageRef> ChunkRef::messages(size_t msg_idx) const {
         return nullptr;
     const ouster::osf::v2::StampedMessage* m = chunk->messages()->Get(msg_idx);
     return std::make_unique<const MessageRef>(
-        reinterpret_cast<const uint8_t*>(m), reader_->meta_store_, chunk_buf_);
+        reinterpret_cast<const uint8_t*>(m), reader_->meta_store_, chunk_buf_,
+        get_chunk_ptr(), msg_idx);
 }
 
 const MessageRef ChunkRef::operator[](size_t msg_idx) const {
-    const ouster::osf::v2::Chunk* chunk = get_chunk_from_buf(get_chunk_ptr());
+    const uint8_t* chunk_ptr = get_chunk_ptr();
+    const ouster::osf::v2::Chunk* chunk = get_chunk_from_buf(chunk_ptr);
     const ouster::osf::v2::StampedMessage* m = chunk->messages()->Get(msg_idx);
     return MessageRef(reinterpret_cast<const uint8_t*>(m), reader_->meta_store_,
-                      chunk_buf_);
+                      chunk_buf_, chunk_ptr, msg_idx);
 }
 
 MessagesChunkIter ChunkRef::begin() const {
@@ -834,20 +1098,23 @@ MessagesStreamingIter::MessagesStreamingIter(const MessagesStreamingIter& other)
       stream_ids_{other.stream_ids_},
       stream_ids_hash_{other.stream_ids_hash_},
       reader_{other.reader_},
+      filter_{other.filter_},
       curr_chunks_{other.curr_chunks_} {}
 
 MessagesStreamingIter::MessagesStreamingIter(
     const ts_t start_ts, const ts_t end_ts,
-    const std::vector<uint32_t>& stream_ids, Reader* reader)
+    const std::vector<uint32_t>& stream_ids, Reader* reader,
+    ChunkFilter filter)
     : curr_ts_{start_ts},
       end_ts_{end_ts},
       stream_ids_{stream_ids},
       stream_ids_hash_{calc_stream_ids_hash(stream_ids_)},
-      reader_{reader} {
+      reader_{reader},
+      filter_{std::move(filter)} {
     if (curr_ts_ == end_ts_) return;
 
     if (stream_ids_.empty()) {
-        for (const auto& sm : reader_->chunks_.stream_chunks()) {
+        for (const auto& sm : reader_->chunks_pile().stream_chunks()) {
             stream_ids_.push_back(sm.first);
         }
     }
@@ -860,16 +1127,35 @@ MessagesStreamingIter::MessagesStreamingIter(
     //  4. addd opened chunk (offset, msg_idx) to the queue of streams we are
     //     reading
     //  5. move to the next chunk within stream, and continue from Step 2.
+    ChunksPile& chunks = reader_->chunks_pile();
     for (const auto stream_id : stream_ids_) {
         // 1. find first chunk by start_ts (lower bound)
-        auto* cs = reader_->chunks_.get_by_lower_bound_ts(stream_id, start_ts);
+        auto* cs = chunks.get_by_lower_bound_ts(stream_id, start_ts);
+        // and the first message in it, with the timestamps index if present
+        size_t first_msg_idx = 0;
+        if (auto idx =
+                chunks.message_idx_by_lower_bound_ts(stream_id, start_ts)) {
+            auto* ci = chunks.get_info_by_message_idx(stream_id, *idx);
+            if (ci != nullptr && cs != nullptr && ci->offset == cs->offset) {
+                first_msg_idx = *idx - ci->message_start_idx;
+            }
+        }
         bool filled = false;
         while (cs != nullptr && cs->start_ts < end_ts && !filled) {
             auto curr_offset = cs->offset;
-            if (reader_->verify_chunk(curr_offset)) {
-                // 2. if chunk is valid open it, otherwise step 5
+            if (accepts(curr_offset) && reader_->verify_chunk(curr_offset)) {
+                // 2. if chunk is valid and not filtered out open it,
+                //    otherwise step 5
                 ChunkRef cref{curr_offset, reader_};
-                for (size_t msg_idx = 0; msg_idx < cref.size(); ++msg_idx) {
+                // the index is used only if the chunk agrees with it
+                size_t msg_idx = 0;
+                if (first_msg_idx < cref.size() &&
+                    cref[first_msg_idx].ts() >= start_ts &&
+                    (first_msg_idx == 0 ||
+                     cref[first_msg_idx - 1].ts() < start_ts)) {
+                    msg_idx = first_msg_idx;
+                }
+                for (; msg_idx < cref.size(); ++msg_idx) {
                     // 3. find first message withing chunk in [start_ts, end_ts)
                     //    range
                     if (cref[msg_idx].ts() >= start_ts &&
@@ -884,7 +1170,8 @@ MessagesStreamingIter::MessagesStreamingIter(
             }
             // 5. move to the next chunk within stream, and continue from
             //    Step 2
-            cs = reader_->chunks_.next_by_stream(curr_offset);
+            first_msg_idx = 0;
+            cs = reader_->chunks_pile().next_by_stream(curr_offset);
         }
     }
 
@@ -959,10 +1246,16 @@ void MessagesStreamingIter::next() {
         // Looking for the next chunk of the current stream_id
         // const auto curr_stream_id = cref[msg_idx].id();
         auto next_chunk_state =
-            reader_->chunks_.next_by_stream(curr_item.first.offset());
+            reader_->chunks_pile().next_by_stream(curr_item.first.offset());
+        // past the chunks the filter skips
+        while (next_chunk_state && next_chunk_state->start_ts < end_ts_ &&
+               !accepts(next_chunk_state->offset)) {
+            next_chunk_state =
+                reader_->chunks_pile().next_by_stream(next_chunk_state->offset);
+        }
         if (next_chunk_state) {
             auto next_chunk_info =
-                reader_->chunks_.get_info(next_chunk_state->offset);
+                reader_->chunks_pile().get_info(next_chunk_state->offset);
             if (next_chunk_info == nullptr) {
                 throw std::logic_error(
                     "ERROR: Can't iterate by streams without StreamingInfo "
@@ -1001,6 +1294,12 @@ void MessagesStreamingIter::next() {
     }
 }
 
+bool MessagesStreamingIter::accepts(uint64_t offset) const {
+    if (!filter_) return true;
+    const ChunkInfoNode* info = reader_->chunks_pile().get_info(offset);
+    return info == nullptr || info->summary.empty() || filter_(info->summary);
+}
+
 std::string MessagesStreamingIter::to_string() const {
     std::stringstream ss;
     ss << "MessagesStreamingIter: [curr_ts = " << curr_ts_.count()
@@ -1022,15 +1321,17 @@ std::string MessagesStreamingIter::to_string() const {
 
 MessagesStreamingRange::MessagesStreamingRange(
     const ts_t start_ts, const ts_t end_ts,
-    const std::vector<uint32_t>& stream_ids, Reader* reader)
+    const std::vector<uint32_t>& stream_ids, Reader* reader,
+    ChunkFilter filter)
     : start_ts_(start_ts),
       end_ts_(end_ts),
       stream_ids_{stream_ids},
-      reader_{reader} {}
+      reader_{reader},
+      filter_{std::move(filter)} {}
 
 MessagesStreamingIter MessagesStreamingRange::begin() const {
     return MessagesStreamingIter(start_ts_, end_ts_ + ts_t{1}, stream_ids_,
-                                 reader_);
+                                 reader_, filter_);
 }
 
 MessagesStreamingIter MessagesStreamingRange::end() const {
@@ -0,0 +1,146 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file reader_cache.h
+ * @brief Memory bounded caches of chunks and decoded scans of a Reader
+ */
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/osf/file.h"
+
+namespace ouster {
+namespace osf {
+
+/**
+ * Least recently used cache of shared values, holding at most capacity bytes
+ * of them. Values are shared with the callers and must not be modified once
+ * cached. Safe to use from multiple threads.
+ */
+template <typename Key, typename Value>
+class LruCache {
+   public:
+    /**
+     * Set the capacity, evicting the least recently used values past it.
+     *
+     * @param[in] capacity The bytes of values to hold, 0 to hold none.
+     */
+    void set_capacity(uint64_t capacity) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        capacity_ = capacity;
+        evict();
+    }
+
+    /**
+     * @return The bytes of values it holds at most.
+     */
+    uint64_t capacity() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return capacity_;
+    }
+
+    /**
+     * Get a value, making it the most recently used.
+     *
+     * @param[in] key The key of the value.
+     * @return The value, nullptr if it isn't cached.
+     */
+    std::shared_ptr<Value> get(const Key& key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it == index_.end()) return nullptr;
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return it->second->value;
+    }
+
+    /**
+     * Cache a value as the most recently used, unless it's larger than the
+     * capacity.
+     *
+     * @param[in] key The key of the value.
+     * @param[in] value The value.
+     * @param[in] bytes The size of the value.
+     */
+    void put(const Key& key, std::shared_ptr<Value> value, uint64_t bytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (bytes > capacity_) return;
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            size_ -= it->second->bytes;
+            entries_.erase(it->second);
+            index_.erase(it);
+        }
+        entries_.push_front({key, std::move(value), bytes});
+        index_[key] = entries_.begin();
+        size_ += bytes;
+        evict();
+    }
+
+   private:
+    struct Entry {
+        Key key;
+        std::shared_ptr<Value> value;
+        uint64_t bytes;
+    };
+
+    void evict() {
+        while (size_ > capacity_) {
+            size_ -= entries_.back().bytes;
+            index_.erase(entries_.back().key);
+            entries_.pop_back();
+        }
+    }
+
+    mutable std::mutex mutex_;
+    uint64_t capacity_{0};
+    uint64_t size_{0};
+    /** Most recently used first. */
+    std::list<Entry> entries_;
+    std::map<Key, typename std::list<Entry>::iterator> index_;
+};
+
+/**
+ * A decoded scan is identified by its message, i.e. its stream, the offset of
+ * its chunk and its index in the chunk, and by the fields decoded.
+ */
+using ScanCacheKey =
+    std::tuple<uint32_t, uint64_t, size_t, std::vector<std::string>>;
+
+/**
+ * The caches shared by everything reading through a Reader.
+ */
+struct ReaderCache {
+    /** Verified chunks by their offset from the start of the chunks. */
+    LruCache<uint64_t, ChunkBuffer> chunks;
+    /** Decoded scans. */
+    LruCache<ScanCacheKey, LidarScan> scans;
+};
+
+/**
+ * Approximate memory held by a scan, for bounding the cache.
+ *
+ * @param[in] ls The scan.
+ * @return The bytes of its fields and headers.
+ */
+inline uint64_t scan_cache_bytes(const LidarScan& ls) {
+    uint64_t bytes = ls.pose().bytes();
+    for (const auto& f : ls.fields()) bytes += f.second.bytes();
+    bytes += ls.timestamp().size() * sizeof(uint64_t);
+    bytes += ls.packet_timestamp().size() * sizeof(uint64_t);
+    bytes += ls.measurement_id().size() * sizeof(uint16_t);
+    bytes += ls.status().size() * sizeof(uint32_t);
+    return bytes;
+}
+
+}  // namespace osf
+}  // namespace ouster
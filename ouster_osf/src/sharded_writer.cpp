@@ -0,0 +1,133 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/osf/sharded_writer.h"
+
+#include <stdexcept>
+
+#include "compat_ops.h"
+
+namespace ouster {
+namespace osf {
+
+namespace {
+
+// Metadata ids reserved for the streams of each shard, past the ids of the
+// sensors shared by all shards
+constexpr uint32_t SHARD_METADATA_ID_STRIDE = 1 << 16;
+
+std::string stem(const std::string& path) {
+    const auto sep = path.find_last_of(std::string("/") + FILE_SEP);
+    const auto dot = path.find_last_of('.');
+    if (dot == std::string::npos ||
+        (sep != std::string::npos && dot < sep)) {
+        return path;
+    }
+    return path.substr(0, dot);
+}
+
+std::string basename(const std::string& path) {
+    const auto sep = path.find_last_of(std::string("/") + FILE_SEP);
+    return sep == std::string::npos ? path : path.substr(sep + 1);
+}
+
+}  // namespace
+
+ShardedWriter::ShardedWriter(
+    const std::string& manifest,
+    const std::vector<ouster::sensor::sensor_info>& info,
+    const ShardOptions& options,
+    const std::vector<std::string>& fields_to_write, uint32_t chunk_size,
+    std::shared_ptr<Encoder> encoder, size_t max_in_flight,
+    AsyncWriter::OverflowPolicy overflow) {
+    if (info.empty()) {
+        throw std::invalid_argument(
+            "ERROR: ShardedWriter needs at least one sensor");
+    }
+    size_t shards = options.shards;
+    if (shards == 0 || shards > info.size()) shards = info.size();
+
+    manifest_.sensors.resize(shards);
+    for (uint32_t i = 0; i < info.size(); ++i) {
+        shard_of_.push_back(i % shards);
+        manifest_.sensors[i % shards].push_back(i);
+    }
+
+    const std::string name = stem(manifest);
+    for (size_t k = 0; k < shards; ++k) {
+        const std::string shard_name =
+            basename(name) + ".shard" + std::to_string(k) + ".osf";
+        std::string filename;
+        if (options.dirs.empty()) {
+            // next to the manifest, which names it relative to itself
+            filename = name + ".shard" + std::to_string(k) + ".osf";
+            manifest_.files.push_back(shard_name);
+        } else {
+            filename =
+                path_concat(options.dirs[k % options.dirs.size()], shard_name);
+            manifest_.files.push_back(filename);
+        }
+        shards_.push_back(std::make_unique<AsyncWriter>(
+            filename, info, fields_to_write, chunk_size, encoder,
+            max_in_flight, overflow));
+        shards_.back()->set_next_metadata_id(
+            static_cast<uint32_t>(info.size() + 1 +
+                                  k * SHARD_METADATA_ID_STRIDE));
+    }
+
+    save_shard_manifest(manifest, manifest_);
+}
+
+ShardedWriter::~ShardedWriter() { close(); }
+
+std::future<void> ShardedWriter::save(uint32_t stream_index,
+                                      const LidarScan& scan) {
+    if (stream_index >= shard_of_.size()) {
+        throw std::logic_error("ERROR: Bad Stream ID");
+    }
+    return shards_[shard_of_[stream_index]]->save(stream_index, scan);
+}
+
+std::future<void> ShardedWriter::save(uint32_t stream_index,
+                                      const LidarScan& scan,
+                                      ouster::osf::ts_t timestamp) {
+    if (stream_index >= shard_of_.size()) {
+        throw std::logic_error("ERROR: Bad Stream ID");
+    }
+    return shards_[shard_of_[stream_index]]->save(stream_index, scan,
+                                                  timestamp);
+}
+
+std::vector<std::future<void>> ShardedWriter::save(
+    const std::vector<LidarScan>& scans) {
+    if (scans.size() != shard_of_.size()) {
+        throw std::logic_error(
+            "ERROR: Scans passed in to writer "
+            "does not match number of sensor infos");
+    }
+    std::vector<std::future<void>> futures;
+    for (uint32_t i = 0; i < scans.size(); ++i) {
+        futures.push_back(save(i, scans[i]));
+    }
+    return futures;
+}
+
+void ShardedWriter::close() {
+    // the shards keep writing while the ones before them are closed
+    for (auto& shard : shards_) shard->close();
+}
+
+const ShardManifest& ShardedWriter::manifest() const { return manifest_; }
+
+size_t ShardedWriter::shards() const { return shards_.size(); }
+
+size_t ShardedWriter::shard_of(uint32_t stream_index) const {
+    return shard_of_.at(stream_index);
+}
+
+AsyncWriter& ShardedWriter::shard(size_t shard) { return *shards_.at(shard); }
+
+}  // namespace osf
+}  // namespace ouster
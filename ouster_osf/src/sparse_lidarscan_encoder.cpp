@@ -0,0 +1,196 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/osf/sparse_lidarscan_encoder.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "ouster/impl/logging.h"
+#include "sparse_tools.h"
+
+using namespace ouster::sensor;
+
+namespace ouster {
+namespace osf {
+
+namespace {
+
+// A field over the pixels of a contiguous image, for encoding it
+template <typename T>
+Field field_view(const Eigen::Ref<const img_t<T>>& img) {
+    void* ptr = const_cast<T*>(img.data());
+    return Field(fd_array<T>(img.rows(), img.cols()), {}, ptr,
+                 std::shared_ptr<void>(ptr, [](void*) {}));
+}
+
+}  // namespace
+
+SparseLidarScanEncoder::SparseLidarScanEncoder(
+    std::shared_ptr<LidarScanEncoder> encoder)
+    : encoder_{std::move(encoder)} {
+    if (!encoder_) {
+        throw std::invalid_argument(
+            "SparseLidarScanEncoder: encoder must not be null");
+    }
+}
+
+template <typename T>
+bool SparseLidarScanEncoder::encodeSparseImage(
+    ScanChannelData& res_buf, const Eigen::Ref<const img_t<T>>& img) const {
+    const size_t h = img.rows();
+    const size_t w = img.cols();
+    // bounding box of the nonzero pixels
+    size_t r0 = h, r1 = 0, c0 = w, c1 = 0, n = 0;
+    for (size_t r = 0; r < h; r++) {
+        for (size_t c = 0; c < w; c++) {
+            if (img(r, c) == 0) continue;
+            n++;
+            r0 = std::min(r0, r);
+            r1 = std::max(r1, r + 1);
+            c0 = std::min(c0, c);
+            c1 = std::max(c1, c + 1);
+        }
+    }
+    uint32_t box[4] = {0, 0, 0, 0};
+    if (n == 0) {
+        encodeSparse(res_buf, box, {}, {});
+        return false;
+    }
+    const size_t rows = r1 - r0;
+    const size_t cols = c1 - c0;
+    // a bitmap pays off once most of the box is zero
+    const bool use_bitmap = 2 * n < rows * cols;
+
+    try {
+        if (!use_bitmap && rows == h && cols == w) {
+            res_buf = encoder_->encodeField(field_view<T>(img));
+            return false;
+        }
+        box[0] = static_cast<uint32_t>(r0);
+        box[1] = static_cast<uint32_t>(c0);
+        box[2] = static_cast<uint32_t>(rows);
+        box[3] = static_cast<uint32_t>(cols);
+        if (!use_bitmap) {
+            img_t<T> crop = img.block(r0, c0, rows, cols);
+            encodeSparse(res_buf, box, {},
+                         encoder_->encodeField(field_view<T>(crop)));
+            return false;
+        }
+        img_t<uint8_t> bitmap = img_t<uint8_t>::Zero(rows, (cols + 7) / 8);
+        img_t<T> pixels(1, n);
+        T* dst = pixels.data();
+        for (size_t r = 0; r < rows; r++) {
+            for (size_t c = 0; c < cols; c++) {
+                const T v = img(r0 + r, c0 + c);
+                if (v == 0) continue;
+                bitmap(r, c / 8) |= static_cast<uint8_t>(1 << (c % 8));
+                *dst++ = v;
+            }
+        }
+        encodeSparse(res_buf, box,
+                     encoder_->encodeField(field_view<uint8_t>(bitmap)),
+                     encoder_->encodeField(field_view<T>(pixels)));
+    } catch (const std::exception& e) {
+        logger().error("ERROR: encodeSparseImage: {}", e.what());
+        return true;
+    }
+    return false;
+}
+
+bool SparseLidarScanEncoder::fieldEncode(const LidarScan& lidar_scan,
+                                         const ouster::FieldType& field_type,
+                                         const std::vector<int>& px_offset,
+                                         ScanData& scan_data,
+                                         size_t scan_idx) const {
+    if (scan_idx >= scan_data.size()) {
+        throw std::invalid_argument(
+            "ERROR: scan_data size is not sufficient to hold idx: " +
+            std::to_string(scan_idx));
+    }
+    bool res = true;
+    switch (field_type.element_type) {
+        case sensor::ChanFieldType::UINT8:
+            res = encodeSparseImage<uint8_t>(
+                scan_data[scan_idx],
+                destagger<uint8_t>(lidar_scan.field<uint8_t>(field_type.name),
+                                   px_offset));
+            break;
+        case sensor::ChanFieldType::UINT16:
+            res = encodeSparseImage<uint16_t>(
+                scan_data[scan_idx],
+                destagger<uint16_t>(
+                    lidar_scan.field<uint16_t>(field_type.name), px_offset));
+            break;
+        case sensor::ChanFieldType::UINT32:
+            res = encodeSparseImage<uint32_t>(
+                scan_data[scan_idx],
+                destagger<uint32_t>(
+                    lidar_scan.field<uint32_t>(field_type.name), px_offset));
+            break;
+        case sensor::ChanFieldType::UINT64:
+            res = encodeSparseImage<uint64_t>(
+                scan_data[scan_idx],
+                destagger<uint64_t>(
+                    lidar_scan.field<uint64_t>(field_type.name), px_offset));
+            break;
+        default:
+            logger().error(
+                "ERROR: fieldEncode: UNKNOWN:"
+                "ChanFieldType not yet "
+                "implemented");
+            break;
+    }
+    if (res) {
+        logger().error("ERROR: fieldEncode: Can't encode field {}",
+                       field_type.name);
+    }
+    return res;
+}
+
+ScanChannelData SparseLidarScanEncoder::encodeField(
+    const ouster::Field& field) const {
+    // 1d and empty fields are stored as the encoder stores them
+    if (field.shape().size() == 1 || field.bytes() == 0) {
+        return encoder_->encodeField(field);
+    }
+
+    FieldView view = uint_view(field);
+    // collapse shape
+    if (view.shape().size() > 2) {
+        size_t rows = view.shape()[0];
+        size_t cols = view.size() / rows;
+        view = view.reshape(rows, cols);
+    }
+
+    ScanChannelData buffer;
+    bool res = true;
+    switch (view.tag()) {
+        case sensor::ChanFieldType::UINT8:
+            res = encodeSparseImage<uint8_t>(buffer, view);
+            break;
+        case sensor::ChanFieldType::UINT16:
+            res = encodeSparseImage<uint16_t>(buffer, view);
+            break;
+        case sensor::ChanFieldType::UINT32:
+            res = encodeSparseImage<uint32_t>(buffer, view);
+            break;
+        case sensor::ChanFieldType::UINT64:
+            res = encodeSparseImage<uint64_t>(buffer, view);
+            break;
+        default:
+            break;
+    }
+
+    if (res) {
+        throw std::runtime_error("encodeField: could not encode field");
+    }
+
+    return buffer;
+}
+
+}  // namespace osf
+}  // namespace ouster
@@ -0,0 +1,207 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "sparse_tools.h"
+
+#include <cstring>
+#include <exception>
+
+#include "ouster/impl/logging.h"
+#include "png_tools.h"
+
+using namespace ouster::sensor;
+
+namespace ouster {
+namespace osf {
+
+namespace {
+
+constexpr uint8_t sparse_magic[4] = {'O', 'S', 'F', 'S'};
+
+// magic, box and bitmap size
+constexpr size_t sparse_header_size =
+    sizeof(sparse_magic) + 5 * sizeof(uint32_t);
+
+void put_u32(uint8_t* dst, uint32_t value) {
+    for (size_t b = 0; b < 4; b++) {
+        dst[b] = static_cast<uint8_t>(value >> (8 * b));
+    }
+}
+
+uint32_t get_u32(const uint8_t* src) {
+    uint32_t value = 0;
+    for (size_t b = 0; b < 4; b++) {
+        value |= static_cast<uint32_t>(src[b]) << (8 * b);
+    }
+    return value;
+}
+
+// A field over the pixels of img, for decoding into it
+template <typename T>
+Field field_view(img_t<T>& img) {
+    void* ptr = img.data();
+    return Field(fd_array<T>(img.rows(), img.cols()), {}, ptr,
+                 std::shared_ptr<void>(ptr, [](void*) {}));
+}
+
+/**
+ * Decode a sparse image into img as it was stored.
+ */
+template <typename T>
+bool fillSparseImage(Eigen::Ref<img_t<T>> img,
+                     const ScanChannelData& channel_buf) {
+    if (channel_buf.size() < sparse_header_size) {
+        logger().error("ERROR: decodeSparseImage: truncated buffer");
+        return true;
+    }
+    const uint8_t* header = channel_buf.data();
+    const size_t row0 = get_u32(header + 4);
+    const size_t col0 = get_u32(header + 8);
+    const size_t rows = get_u32(header + 12);
+    const size_t cols = get_u32(header + 16);
+    const size_t bitmap_size = get_u32(header + 20);
+    if (row0 + rows > static_cast<size_t>(img.rows()) ||
+        col0 + cols > static_cast<size_t>(img.cols()) ||
+        bitmap_size > channel_buf.size() - sparse_header_size) {
+        logger().error("ERROR: decodeSparseImage: box doesn't match the image");
+        return true;
+    }
+
+    img.setZero();
+    if (rows == 0 || cols == 0) return false;
+
+    const auto bitmap_begin = channel_buf.begin() + sparse_header_size;
+    const ScanChannelData pixels_buf(bitmap_begin + bitmap_size,
+                                     channel_buf.end());
+    try {
+        if (bitmap_size == 0) {
+            img_t<T> box(rows, cols);
+            Field box_field = field_view(box);
+            decodeField(box_field, pixels_buf);
+            img.block(row0, col0, rows, cols) = box;
+            return false;
+        }
+
+        const ScanChannelData bitmap_buf(bitmap_begin,
+                                         bitmap_begin + bitmap_size);
+        img_t<uint8_t> bitmap(rows, (cols + 7) / 8);
+        Field bitmap_field = field_view(bitmap);
+        decodeField(bitmap_field, bitmap_buf);
+        size_t n = 0;
+        for (size_t r = 0; r < rows; r++) {
+            for (size_t c = 0; c < cols; c++) {
+                n += (bitmap(r, c / 8) >> (c % 8)) & 1;
+            }
+        }
+        if (n == 0) {
+            logger().error("ERROR: decodeSparseImage: empty bitmap");
+            return true;
+        }
+
+        img_t<T> pixels(1, n);
+        Field pixels_field = field_view(pixels);
+        decodeField(pixels_field, pixels_buf);
+        const T* src = pixels.data();
+        for (size_t r = 0; r < rows; r++) {
+            for (size_t c = 0; c < cols; c++) {
+                if ((bitmap(r, c / 8) >> (c % 8)) & 1) {
+                    img(row0 + r, col0 + c) = *src++;
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        logger().error("ERROR: decodeSparseImage: {}", e.what());
+        return true;
+    }
+    return false;
+}
+
+}  // namespace
+
+bool is_sparse_buffer(const ScanChannelData& channel_buf) {
+    return channel_buf.size() >= sizeof(sparse_magic) &&
+           std::memcmp(channel_buf.data(), sparse_magic,
+                       sizeof(sparse_magic)) == 0;
+}
+
+void encodeSparse(ScanChannelData& res_buf, const uint32_t box[4],
+                  const ScanChannelData& bitmap,
+                  const ScanChannelData& pixels) {
+    res_buf.resize(sparse_header_size + bitmap.size() + pixels.size());
+    uint8_t* dst = res_buf.data();
+    std::memcpy(dst, sparse_magic, sizeof(sparse_magic));
+    for (size_t i = 0; i < 4; i++) {
+        put_u32(dst + 4 + 4 * i, box[i]);
+    }
+    put_u32(dst + 20, static_cast<uint32_t>(bitmap.size()));
+    dst += sparse_header_size;
+    if (!bitmap.empty()) std::memcpy(dst, bitmap.data(), bitmap.size());
+    dst += bitmap.size();
+    if (!pixels.empty()) std::memcpy(dst, pixels.data(), pixels.size());
+}
+
+template <typename T>
+bool decodeSparseImage(Eigen::Ref<img_t<T>> img,
+                       const ScanChannelData& channel_buf,
+                       const std::vector<int>* px_offset) {
+    if (!px_offset) return fillSparseImage<T>(img, channel_buf);
+    if (px_offset->size() != static_cast<size_t>(img.rows())) {
+        logger().error("ERROR: decodeSparseImage: image height {} does not "
+                       "match shifts size {}",
+                       img.rows(), px_offset->size());
+        return true;
+    }
+    // standard fields are stored destaggered
+    img_t<T> destaggered(img.rows(), img.cols());
+    if (fillSparseImage<T>(destaggered, channel_buf)) return true;
+    img = stagger<T>(destaggered, *px_offset);
+    return false;
+}
+
+bool sparseFieldDecode(LidarScan& lidar_scan,
+                       const ScanChannelData& channel_buf,
+                       const ouster::FieldType& field_type,
+                       const std::vector<int>& px_offset) {
+    switch (field_type.element_type) {
+        case sensor::ChanFieldType::UINT8:
+            return decodeSparseImage<uint8_t>(
+                lidar_scan.field<uint8_t>(field_type.name), channel_buf,
+                &px_offset);
+        case sensor::ChanFieldType::UINT16:
+            return decodeSparseImage<uint16_t>(
+                lidar_scan.field<uint16_t>(field_type.name), channel_buf,
+                &px_offset);
+        case sensor::ChanFieldType::UINT32:
+            return decodeSparseImage<uint32_t>(
+                lidar_scan.field<uint32_t>(field_type.name), channel_buf,
+                &px_offset);
+        case sensor::ChanFieldType::UINT64:
+            return decodeSparseImage<uint64_t>(
+                lidar_scan.field<uint64_t>(field_type.name), channel_buf,
+                &px_offset);
+        default:
+            logger().error(
+                "ERROR: sparseFieldDecode: UNKNOWN:"
+                "ChanFieldType not yet "
+                "implemented");
+            return true;
+    }
+}
+
+template bool decodeSparseImage<uint8_t>(Eigen::Ref<img_t<uint8_t>>,
+                                         const ScanChannelData&,
+                                         const std::vector<int>*);
+template bool decodeSparseImage<uint16_t>(Eigen::Ref<img_t<uint16_t>>,
+                                          const ScanChannelData&,
+                                          const std::vector<int>*);
+template bool decodeSparseImage<uint32_t>(Eigen::Ref<img_t<uint32_t>>,
+                                          const ScanChannelData&,
+                                          const std::vector<int>*);
+template bool decodeSparseImage<uint64_t>(Eigen::Ref<img_t<uint64_t>>,
+                                          const ScanChannelData&,
+                                          const std::vector<int>*);
+
+}  // namespace osf
+}  // namespace ouster
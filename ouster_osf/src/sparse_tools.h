@@ -0,0 +1,95 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace osf {
+
+// Encoded single field buffer
+using ScanChannelData = std::vector<uint8_t>;
+
+/**
+ * Sparse encoding of 2D images, used by SparseLidarScanEncoder.
+ *
+ * Only the bounding box of the nonzero pixels is stored, either as an image
+ * of the box or, when most of the box is zero, as a bitmap of the nonzero
+ * pixels of the box and a single row image of these pixels in row major
+ * order. Both images are encoded by another encoder. The buffer is
+ *
+ *     magic "OSFS" | uint32 first row | uint32 first column | uint32 rows |
+ *     uint32 columns | uint32 size of the bitmap, 0 if the box is stored as
+ *     an image | the encoded bitmap | the encoded box or pixels
+ *
+ * with little endian integers and the bitmap packed 8 columns to a byte, the
+ * least significant bit first. An image with no nonzero pixels has an empty
+ * box and nothing after the header. Decoders tell it from PNG, zstd and
+ * banded buffers by the magic. Standard fields are stored after destaggering.
+ */
+
+/**
+ * Check whether the buffer holds a sparse image.
+ *
+ * @param[in] channel_buf The encoded buffer.
+ * @return true if the buffer starts with the sparse magic.
+ */
+bool is_sparse_buffer(const ScanChannelData& channel_buf);
+
+/**
+ * Assemble the encoded parts of a sparse image into a single buffer.
+ *
+ * @param[out] res_buf The output buffer.
+ * @param[in] box The first row, first column, rows and columns of the box.
+ * @param[in] bitmap The encoded bitmap, empty if the box is stored as an
+ *                   image.
+ * @param[in] pixels The encoded box or pixels.
+ */
+void encodeSparse(ScanChannelData& res_buf, const uint32_t box[4],
+                  const ScanChannelData& bitmap,
+                  const ScanChannelData& pixels);
+
+/**
+ * Decode a sparse image into img, which must have the shape of the encoded
+ * image.
+ *
+ * @tparam T The type of the image pixels.
+ *
+ * @param[out] img The output image.
+ * @param[in] channel_buf The encoded buffer.
+ * @param[in] px_offset Pixel shift per row used to reconstruct staggered
+ *                      range image form, nullptr for images stored as they
+ *                      are.
+ * @return false (0) if operation is successful, true (1) if error occured
+ */
+template <typename T>
+bool decodeSparseImage(Eigen::Ref<img_t<T>> img,
+                       const ScanChannelData& channel_buf,
+                       const std::vector<int>* px_offset);
+
+/**
+ * Decode a single sparse standard field to lidar_scan.
+ *
+ * @param[out] lidar_scan The output object that will be filled as a result of
+ *                        decoding.
+ * @param[in] channel_buf The encoded buffer.
+ * @param[in] field_type The field of `lidar_scan` to fill in with the decoded
+ *                       result.
+ * @param[in] px_offset Pixel shift per row used to reconstruct staggered range
+ *                      image form.
+ * @return false (0) if operation is successful true (1) if error occured
+ */
+bool sparseFieldDecode(LidarScan& lidar_scan,
+                       const ScanChannelData& channel_buf,
+                       const ouster::FieldType& field_type,
+                       const std::vector<int>& px_offset);
+
+}  // namespace osf
+}  // namespace ouster
@@ -6,13 +6,18 @@
 #include "ouster/osf/stream_lidar_scan.h"
 
 #include <algorithm>
-#include <future>
+#include <array>
+#include <limits>
 #include <sstream>
 
 #include "ouster/impl/logging.h"
 #include "ouster/lidar_scan.h"
 #include "ouster/osf/basics.h"
+#include "ouster/osf/meta_streaming_info.h"
+#include "ouster/osf/reader.h"
+#include "ouster/osf/thread_pool.h"
 #include "ouster/strings.h"
+#include "ouster/trace.h"
 #include "ouster/types.h"
 #include "png_tools.h"
 
@@ -42,6 +47,56 @@ ouster::FieldClass from_osf_enum(gen::FIELD_CLASS ff) {
     return static_cast<ouster::FieldClass>(ff);
 }
 
+// The builder of the messages made on the calling thread, keeping its
+// capacity from one message to the next since scans of a stream are about
+// the same size
+flatbuffers::FlatBufferBuilder& message_builder() {
+    thread_local flatbuffers::FlatBufferBuilder fbb(32768);
+    fbb.Clear();
+    return fbb;
+}
+
+/**
+ * Call f with the pixels of an unsigned integer field.
+ *
+ * @return false if the field holds other values.
+ */
+template <typename F>
+bool visit_pixels(const Field& field, F&& f) {
+    switch (field.tag()) {
+        case sensor::ChanFieldType::UINT8:
+            f(field.get<uint8_t>());
+            return true;
+        case sensor::ChanFieldType::UINT16:
+            f(field.get<uint16_t>());
+            return true;
+        case sensor::ChanFieldType::UINT32:
+            f(field.get<uint32_t>());
+            return true;
+        case sensor::ChanFieldType::UINT64:
+            f(field.get<uint64_t>());
+            return true;
+        default:
+            return false;
+    }
+}
+
+// the field of a stream, if the scan has it as a field of pixels
+const Field* stream_field(const LidarScan& ls,
+                          const ouster::LidarScanFieldTypes& field_types,
+                          const std::string& name) {
+    const bool in_stream =
+        std::any_of(field_types.begin(), field_types.end(),
+                    [&](const FieldType& ft) { return ft.name == name; });
+    if (!in_stream || !ls.has_field(name)) return nullptr;
+    const Field& field = ls.field(name);
+    if (field.field_class() != FieldClass::PIXEL_FIELD ||
+        field.shape().size() != 2) {
+        return nullptr;
+    }
+    return &field;
+}
+
 }  // namespace
 
 bool poses_present(const LidarScan& ls) {
@@ -88,6 +143,82 @@ LidarScan slice_with_cast(const LidarScan& ls_src,
     return ls_dest;
 }
 
+ChunkSummary summarize_scan(const LidarScan& ls,
+                            const ouster::LidarScanFieldTypes& field_types) {
+    ChunkSummary summary{};
+    const size_t w = ls.w;
+    const size_t h = ls.h;
+    if (w == 0 || h == 0) return summary;
+
+    auto status = ls.status();
+    std::vector<bool> valid(w);
+    size_t valid_cols = 0;
+    for (size_t c = 0; c < w; ++c) {
+        valid[c] = status(c) & 0x01;
+        if (valid[c]) valid_cols++;
+    }
+    const double completeness = static_cast<double>(valid_cols) / w;
+    summary.completeness = ValueBounds{completeness, completeness};
+
+    auto alert_flags = ls.alert_flags();
+    for (Eigen::Index p = 0; p < alert_flags.size(); ++p) {
+        summary.alert_flags |= alert_flags(p);
+    }
+
+    if (const Field* range =
+            stream_field(ls, field_types, sensor::ChanField::RANGE)) {
+        visit_pixels(*range, [&](const auto* px) {
+            uint64_t lo = std::numeric_limits<uint64_t>::max();
+            uint64_t hi = 0;
+            for (size_t i = 0; i < w * h; ++i) {
+                const uint64_t v = px[i];
+                if (v == 0) continue;
+                lo = std::min(lo, v);
+                hi = std::max(hi, v);
+            }
+            if (hi != 0) {
+                summary.range = ValueBounds{static_cast<double>(lo),
+                                            static_cast<double>(hi)};
+            }
+        });
+    }
+
+    if (valid_cols == 0) return summary;
+
+    if (const Field* refl =
+            stream_field(ls, field_types, sensor::ChanField::REFLECTIVITY)) {
+        visit_pixels(*refl, [&](const auto* px) {
+            double sum = 0;
+            for (size_t r = 0; r < h; ++r) {
+                for (size_t c = 0; c < w; ++c) {
+                    if (valid[c]) sum += px[r * w + c];
+                }
+            }
+            const double mean = sum / (valid_cols * h);
+            summary.reflectivity = ValueBounds{mean, mean};
+        });
+    }
+
+    if (poses_present(ls)) {
+        // translations of the row major 4x4 poses of the columns
+        const double* pose = ls.pose().get<double>();
+        std::array<ValueBounds, 3> box;
+        box.fill({std::numeric_limits<double>::max(),
+                  std::numeric_limits<double>::lowest()});
+        for (size_t c = 0; c < w; ++c) {
+            if (!valid[c]) continue;
+            for (size_t k = 0; k < 3; ++k) {
+                const double t = pose[c * 16 + k * 4 + 3];
+                box[k].min = std::min(box[k].min, t);
+                box[k].max = std::max(box[k].max, t);
+            }
+        }
+        summary.pose = box;
+    }
+
+    return summary;
+}
+
 // === LidarScanStream support functions ====
 
 // After Flatbuffers >= 22.9.24 the alignment bug was introduced in the #7520
@@ -119,8 +250,7 @@ flatbuffers::Offset<flatbuffers::Vector<const T*>> CreateVectorOfStructs(
 flatbuffers::Offset<gen::Field> LidarScanStream::create_osf_field(
     flatbuffers::FlatBufferBuilder& fbb, const std::string& name,
     const Field& f) const {
-    ScanChannelData data =
-        writer_.encoder().lidar_scan_encoder().encodeField(f);
+    ScanChannelData data = lidar_scan_encoder_->encodeField(f);
     std::vector<uint64_t> shape{f.shape().begin(), f.shape().end()};
     return gen::CreateFieldDirect(fbb, name.c_str(), to_osf_enum(f.tag()),
                                   &shape, to_osf_enum(f.field_class()), &data,
@@ -203,6 +333,100 @@ std::string from_osf_enum(gen::CHAN_FIELD f) {
     return lookup(chanfield_strings, f).value();
 }
 
+// ========== Delta Frames =======================================
+namespace {
+
+// Standard fields of unsigned integer types hold residuals in delta frames,
+// the rest is stored as is
+bool is_delta_field(const std::string& name, const Field& field) {
+    if (!to_osf_enum(name)) return false;
+    switch (field.tag()) {
+        case ChanFieldType::UINT8:
+        case ChanFieldType::UINT16:
+        case ChanFieldType::UINT32:
+        case ChanFieldType::UINT64:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// The wrapping difference from the keyframe, zigzag coded so that small
+// changes either way become small values that compress well
+template <typename T>
+void zigzag_delta(T* data, const T* keyframe, size_t n) {
+    constexpr int sign_bit = sizeof(T) * 8 - 1;
+    for (size_t i = 0; i < n; ++i) {
+        const T d = static_cast<T>(data[i] - keyframe[i]);
+        data[i] = static_cast<T>(static_cast<T>(d << 1) ^
+                                 static_cast<T>(T(0) - (d >> sign_bit)));
+    }
+}
+
+template <typename T>
+void zigzag_undelta(T* data, const T* keyframe, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        const T z = data[i];
+        const T d = static_cast<T>((z >> 1) ^ static_cast<T>(T(0) - (z & 1)));
+        data[i] = static_cast<T>(keyframe[i] + d);
+    }
+}
+
+template <typename T>
+void apply_delta(Field& field, const Field& keyframe, bool undo) {
+    if (undo) {
+        zigzag_undelta(field.get<T>(), keyframe.get<T>(), field.size());
+    } else {
+        zigzag_delta(field.get<T>(), keyframe.get<T>(), field.size());
+    }
+}
+
+void apply_delta(Field& field, const Field& keyframe, bool undo) {
+    switch (field.tag()) {
+        case ChanFieldType::UINT8:
+            apply_delta<uint8_t>(field, keyframe, undo);
+            break;
+        case ChanFieldType::UINT16:
+            apply_delta<uint16_t>(field, keyframe, undo);
+            break;
+        case ChanFieldType::UINT32:
+            apply_delta<uint32_t>(field, keyframe, undo);
+            break;
+        case ChanFieldType::UINT64:
+            apply_delta<uint64_t>(field, keyframe, undo);
+            break;
+        default:
+            break;
+    }
+}
+
+bool is_delta_frame(const uint8_t* msg_buf) {
+    return flatbuffers::GetSizePrefixedRoot<gen::LidarScanMsg>(msg_buf)
+        ->delta_frame();
+}
+
+bool is_delta_frame(const MessageRef& msg) {
+    auto sm = reinterpret_cast<const gen::StampedMessage*>(msg.buf());
+    return sm->buffer() && is_delta_frame(sm->buffer()->data());
+}
+
+// The last keyframe decoded on this thread, since the delta frames of a
+// group are usually read one after another. Identified by its stream,
+// timestamp and size rather than its address, which may be reused by the
+// next chunk read.
+struct KeyframeCache {
+    const MetadataStore* meta_provider{nullptr};
+    uint32_t id{0};
+    ts_t ts{0};
+    size_t size{0};
+    std::vector<std::string> fields;
+    std::unique_ptr<LidarScan> scan;
+};
+
+thread_local KeyframeCache keyframe_cache;
+
+}  // namespace
+
 // ========== Encode Functions ===================================
 #ifdef OUSTER_OSF_NO_THREADING
 
@@ -215,8 +439,8 @@ ScanData LidarScanStream::scanEncodeFieldsSingleThread(
 
     size_t scan_idx = 0;
     for (const auto& f : field_types) {
-        writer_.encoder().lidar_scan_encoder().fieldEncode(
-            lidar_scan, f, px_offset, fields_data, scan_idx);
+        lidar_scan_encoder_->fieldEncode(lidar_scan, f, px_offset, fields_data,
+                                         scan_idx);
         scan_idx += 1;
     }
 
@@ -224,27 +448,6 @@ ScanData LidarScanStream::scanEncodeFieldsSingleThread(
 }
 #else
 
-void LidarScanStream::fieldEncodeMulti(
-    const LidarScan& lidar_scan, const ouster::LidarScanFieldTypes& field_types,
-    const std::vector<int>& px_offset, ScanData& scan_data,
-    const std::vector<size_t>& scan_idxs) const {
-    if (field_types.size() != scan_idxs.size()) {
-        throw std::invalid_argument(
-            "ERROR: in fieldEncodeMulti field_types.size() should "
-            "match scan_idxs.size()");
-    }
-    for (size_t i = 0; i < field_types.size(); ++i) {
-        auto err = writer_.encoder().lidar_scan_encoder().fieldEncode(
-            lidar_scan, field_types[i], px_offset, scan_data, scan_idxs[i]);
-        if (err) {
-            logger().error(
-                "ERROR: fieldEncode: Can't encode field [{}]"
-                "(in fieldEncodeMulti)",
-                field_types[i].name);
-        }
-    }
-}
-
 ScanData LidarScanStream::scanEncodeFields(
     const LidarScan& lidar_scan, const std::vector<int>& px_offset,
     const ouster::LidarScanFieldTypes& field_types) const {
@@ -252,40 +455,17 @@ ScanData LidarScanStream::scanEncodeFields(
     // encode
     ScanData fields_data(field_types.size());
 
-    unsigned int con_num = std::thread::hardware_concurrency();
-    // looking for at least 4 cores if can't determine
-    if (!con_num) con_num = 4;
-
-    const size_t fields_num = field_types.size();
-    // Number of fields to pack into a single thread coder
-    size_t per_thread_num = (fields_num + con_num - 1) / con_num;
-    std::vector<std::future<void>> futures{};
-    size_t scan_idx = 0;
-    for (size_t t = 0; t < con_num && t * per_thread_num < fields_num; ++t) {
-        // Per every thread we pack the `per_thread_num` field_types encodings
-        // job
-        const size_t start_idx = t * per_thread_num;
-        // Fields list for a thread to encode
-        LidarScanFieldTypes thread_fields{};
-        // Scan indices for the corresponding fields where result will be stored
-        std::vector<size_t> thread_idxs{};
-        for (size_t i = 0; i < per_thread_num && i + start_idx < fields_num;
-             ++i) {
-            thread_fields.push_back(field_types[start_idx + i]);
-            thread_idxs.push_back(scan_idx);
-            scan_idx += 1;
-        }
-        // Start an encoder thread with selected fields and corresponding
-        // indices list
-        futures.emplace_back(std::async(&LidarScanStream::fieldEncodeMulti,
-                                        this, std::cref(lidar_scan),
-                                        thread_fields, std::cref(px_offset),
-                                        std::ref(fields_data), thread_idxs));
-    }
-
-    for (auto& t : futures) {
-        t.get();
-    }
+    // One task per field, claimed by the pool threads one at a time so that
+    // heavy fields like RANGE don't hold up the fields queued behind them
+    writer_.encoder().thread_pool()->parallel_for(
+        field_types.size(), [&](size_t i) {
+            auto err = lidar_scan_encoder_->fieldEncode(
+                lidar_scan, field_types[i], px_offset, fields_data, i);
+            if (err) {
+                logger().error("ERROR: fieldEncode: Can't encode field [{}]",
+                               field_types[i].name);
+            }
+        });
 
     return fields_data;
 }
@@ -293,6 +473,7 @@ ScanData LidarScanStream::scanEncodeFields(
 ScanData LidarScanStream::scanEncode(
     const LidarScan& lidar_scan, const std::vector<int>& px_offset,
     const ouster::LidarScanFieldTypes& field_types) const {
+    OUSTER_TRACE_SCOPE("osf", "LidarScanStream::encode");
 #ifdef OUSTER_OSF_NO_THREADING
     return scanEncodeFieldsSingleThread(lidar_scan, px_offset, field_types);
 #else
@@ -352,54 +533,28 @@ bool fieldDecodeMulti(LidarScan& lidar_scan, const ScanData& scan_data,
     return res_err;
 }
 
-// TWS 20240301 TODO: determine if we can deduplicate this code (see
-// scanEncodeFields)
 bool scanDecodeFields(LidarScan& lidar_scan, const ScanData& scan_data,
                       const std::vector<int>& px_offset,
                       const ouster::LidarScanFieldTypes& field_types) {
-    size_t fields_num = field_types.size();
-
-    unsigned int con_num = std::thread::hardware_concurrency();
-    // looking for at least 4 cores if can't determine
-    if (!con_num) con_num = 4;
-
-    // Number of fields to pack into a single thread coder
-    size_t per_thread_num = (fields_num + con_num - 1) / con_num;
-    std::vector<std::future<bool>> futures{};
-    size_t scan_idx = 0;
-
-    for (size_t t = 0; t < con_num && t * per_thread_num < fields_num; ++t) {
-        // Per every thread we pack the `per_thread_num` field_types encodings
-        // job
-        const size_t start_idx = t * per_thread_num;
-        // Fields list for a thread to encode
-        LidarScanFieldTypes thread_fields{};
-        // Scan indices for the corresponding fields where result will be stored
-        std::vector<size_t> thread_idxs{};
-        for (size_t i = 0; i < per_thread_num && i + start_idx < fields_num;
-             ++i) {
-            thread_fields.push_back({field_types[start_idx + i].name,
-                                     field_types[start_idx + i].element_type});
-            thread_idxs.push_back(scan_idx);
-            scan_idx += 1;  // for UINT64 can be 2 (NOT IMPLEMENTED YET)
-        }
-
-        // Start a decoder thread with selected fields and corresponding
-        // indices list
-
-        futures.emplace_back(std::async(fieldDecodeMulti, std::ref(lidar_scan),
-                                        std::cref(scan_data), thread_idxs,
-                                        thread_fields, std::cref(px_offset)));
+    // only the fields of the scan are decoded, the others are skipped before
+    // reaching the pool
+    std::vector<size_t> scan_idxs;
+    for (size_t i = 0; i < field_types.size(); ++i) {
+        if (lidar_scan.has_field(field_types[i].name)) scan_idxs.push_back(i);
     }
-
-    for (auto& t : futures) {
-        // TODO: refactor, use return std::all
-        bool res = t.get();
-        if (!res) {
-            return false;
+    // One task per field on the shared pool, as in scanEncodeFields. Errors
+    // are logged and, as before, don't fail the scan
+    default_thread_pool()->parallel_for(scan_idxs.size(), [&](size_t j) {
+        const size_t i = scan_idxs[j];
+        const auto& ft = field_types[i];
+        if (fieldDecode(lidar_scan, scan_data, i, {ft.name, ft.element_type},
+                        px_offset)) {
+            logger().error(
+                "ERROR: scanDecodeFields: "
+                "Can't decode field [{}]",
+                ft.name);
         }
-    }
-
+    });
     return false;
 }
 #endif
@@ -407,6 +562,7 @@ bool scanDecodeFields(LidarScan& lidar_scan, const ScanData& scan_data,
 bool scanDecode(LidarScan& lidar_scan, const ScanData& scan_data,
                 const std::vector<int>& px_offset,
                 const ouster::LidarScanFieldTypes& field_types) {
+    OUSTER_TRACE_SCOPE("osf", "LidarScanStream::decode");
 #ifdef OUSTER_OSF_NO_THREADING
     return scanDecodeFieldsSingleThread(lidar_scan, scan_data, px_offset,
                                         field_types);
@@ -511,11 +667,71 @@ flatbuffers::Offset<gen::LidarScanMsg> LidarScanStream::create_lidar_scan_msg(
         fbb, channels_off, field_types_off, timestamp_off, measurement_id_off,
         status_off, ls.frame_id, pose_off, packet_timestamp_id_off,
         custom_fields_off, ls.frame_status, ls.shutdown_countdown,
-        ls.shot_limiting_countdown, alert_flags_off);
+        ls.shot_limiting_countdown, alert_flags_off, delta_frame);
+}
+
+namespace {
+
+// The channels of the message being decoded, kept per thread so that their
+// buffers are reused from message to message
+thread_local ScanData restore_scan_data;
+thread_local ScanChannelData restore_custom_field;
+
+/**
+ * Whether the scan has the size and the pixel fields of a scan restored with
+ * the field types, so that it can be decoded into as it is.
+ */
+bool reusable_scan(const LidarScan& ls, uint32_t width, uint32_t height,
+                   const ouster::LidarScanFieldTypes& field_types) {
+    const size_t packet_count =
+        (width + DEFAULT_COLUMNS_PER_PACKET - 1) / DEFAULT_COLUMNS_PER_PACKET;
+    if (ls.w != width || ls.h != height || ls.packet_count() != packet_count) {
+        return false;
+    }
+    for (const auto& ft : field_types) {
+        if (!ls.has_field(ft.name)) return false;
+        const auto& field = ls.field(ft.name);
+        const auto& shape = field.shape();
+        if (field.field_class() != FieldClass::PIXEL_FIELD ||
+            field.tag() != ft.element_type || shape.size() != 2 ||
+            shape[0] != height || shape[1] != width) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Copy a column or packet header of the LidarScanMsg into the scan, or zero
+ * it if the message has none.
+ *
+ * @return false if the header has a size other than the scan's.
+ */
+template <typename T, typename FbVector>
+bool restore_header(Eigen::Ref<LidarScan::Header<T>> dst, const FbVector* src,
+                    const char* name) {
+    const size_t size = static_cast<size_t>(dst.size());
+    if (src == nullptr || src->size() == 0) {
+        dst.setZero();
+        return true;
+    }
+    if (src->size() != size) {
+        logger().error(
+            "ERROR: LidarScanMsg has "
+            "{} of length: "
+            "{}, expected: {}",
+            name, src->size(), size);
+        return false;
+    }
+    for (size_t i = 0; i < size; ++i) dst(i) = src->Get(i);
+    return true;
 }
 
+}  // namespace
+
 /**
- * Copy the contents of the LidarScanMsg into a LidarScan.
+ * Copy the contents of the LidarScanMsg into a LidarScan, reusing the fields
+ * of the scan when it already has the size and fields of the message.
  *
  * NOTE: LidarScan isn't inherently flatbuffers-based, which unfortunately means
  * we're not taking advantage of one of fb's primary benefits - the ability to
@@ -526,12 +742,12 @@ flatbuffers::Offset<gen::LidarScanMsg> LidarScanStream::create_lidar_scan_msg(
  * As such, making use of the FB directly would require revisiting the design
  * and a significant refactor.
  */
-std::unique_ptr<ouster::LidarScan> restore_lidar_scan(
-    const std::vector<uint8_t> buf, const ouster::sensor::sensor_info& info,
-    const std::vector<std::string>& fields) {
+bool restore_lidar_scan(const uint8_t* buf,
+                        const ouster::sensor::sensor_info& info,
+                        const std::vector<std::string>& fields,
+                        LidarScan& ls) {
     auto ls_msg =
-        flatbuffers::GetSizePrefixedRoot<ouster::osf::gen::LidarScanMsg>(
-            buf.data());
+        flatbuffers::GetSizePrefixedRoot<ouster::osf::gen::LidarScanMsg>(buf);
 
     uint32_t width = info.format.columns_per_frame;
     uint32_t height = info.format.pixels_per_column;
@@ -560,119 +776,76 @@ std::unique_ptr<ouster::LidarScan> restore_lidar_scan(
             }
         }
     }
-    auto ls = std::make_unique<LidarScan>(width, height, field_types2.begin(),
-                                          field_types2.end());
+    auto requested = [&fields](const std::string& name) {
+        return fields.empty() ||
+               std::find(fields.begin(), fields.end(), name) != fields.end();
+    };
+    auto msg_custom_fields = ls_msg->custom_fields();
+    if (!reusable_scan(ls, width, height, field_types2)) {
+        ls = LidarScan(width, height, field_types2.begin(),
+                       field_types2.end());
+    } else if (ls.fields().size() > field_types2.size()) {
+        // the fields a reused scan has beyond those of this message are
+        // removed
+        std::vector<std::string> stale;
+        for (const auto& f : ls.fields()) {
+            bool found = false;
+            for (const auto& ft : field_types2) found |= ft.name == f.first;
+            for (uint32_t i = 0; msg_custom_fields && !found &&
+                                 i < msg_custom_fields->size();
+                 ++i) {
+                found = f.first == msg_custom_fields->Get(i)->name()->c_str() &&
+                        requested(f.first);
+            }
+            if (!found) stale.push_back(f.first);
+        }
+        for (const auto& name : stale) ls.del_field(name);
+    }
 
     // set frame status - unfortunately since this is a new field in the FB
     // schema and since LidarScan::frame_status is an integer we have no way to
     // differentiate between whether the value was zero when written or wasn't
     // provided by the writer.
-    ls->frame_status = ls_msg->frame_status();
-    ls->shutdown_countdown = ls_msg->shutdown_countdown();
-    ls->shot_limiting_countdown = ls_msg->shot_limiting_countdown();
-
-    ls->frame_id = ls_msg->frame_id();
-
-    // Set timestamps per column
-    auto msg_ts_vec = ls_msg->header_timestamp();
-    if (msg_ts_vec) {
-        if (static_cast<uint32_t>(ls->w) == msg_ts_vec->size()) {
-            for (uint32_t i = 0; i < width; ++i) {
-                ls->timestamp()[i] = msg_ts_vec->Get(i);
-            }
-        } else if (msg_ts_vec->size() != 0) {
-            logger().error(
-                "ERROR: LidarScanMsg has "
-                "header_timestamp of length: "
-                "{}, expected: {}",
-                msg_ts_vec->size(), ls->w);
-            return nullptr;
-        }
-    }
-
-    // Set measurement_id per column
-    auto msg_mid_vec = ls_msg->header_measurement_id();
-    if (msg_mid_vec) {
-        if (static_cast<uint32_t>(ls->w) == msg_mid_vec->size()) {
-            for (uint32_t i = 0; i < width; ++i) {
-                ls->measurement_id()[i] = msg_mid_vec->Get(i);
-            }
-        } else if (msg_mid_vec->size() != 0) {
-            logger().error(
-                "ERROR: LidarScanMsg has "
-                "header_measurement_id of length: "
-                "{}, expected: {}",
-                msg_mid_vec->size(), ls->w);
-            return nullptr;
-        }
-    }
-
-    // Set status per column
-    auto msg_status_vec = ls_msg->header_status();
-    if (msg_status_vec) {
-        if (static_cast<uint32_t>(ls->w) == msg_status_vec->size()) {
-            for (uint32_t i = 0; i < width; ++i) {
-                ls->status()[i] = msg_status_vec->Get(i);
-            }
-        } else if (msg_status_vec->size() != 0) {
-            logger().error(
-                "ERROR: LidarScanMsg has "
-                "header_status of length: "
-                "{}, expected: {}",
-                msg_status_vec->size(), ls->w);
-            return nullptr;
-        }
+    ls.frame_status = ls_msg->frame_status();
+    ls.shutdown_countdown = ls_msg->shutdown_countdown();
+    ls.shot_limiting_countdown = ls_msg->shot_limiting_countdown();
+
+    ls.frame_id = ls_msg->frame_id();
+
+    // Set timestamps, measurement_id and status per column, packet timestamp
+    // and alert flags per lidar packet
+    if (!restore_header(ls.timestamp(), ls_msg->header_timestamp(),
+                        "header_timestamp") ||
+        !restore_header(ls.measurement_id(), ls_msg->header_measurement_id(),
+                        "header_measurement_id") ||
+        !restore_header(ls.status(), ls_msg->header_status(),
+                        "header_status") ||
+        !restore_header(ls.packet_timestamp(), ls_msg->packet_timestamp(),
+                        "packet_timestamp") ||
+        !restore_header(ls.alert_flags(), ls_msg->alert_flags(),
+                        "alert_flags")) {
+        return false;
     }
 
     // Set poses per column
     auto pose_vec = ls_msg->pose();
-    if (pose_vec) {
-        auto& pose = ls->pose();
+    auto& pose = ls.pose();
+    if (pose_vec && pose_vec->size() != 0) {
         if (static_cast<uint32_t>(pose.size()) == pose_vec->size()) {
             std::memcpy(pose.get<double>(), pose_vec->Data(), pose.bytes());
-        } else if (pose_vec->size() != 0) {
+        } else {
             logger().error(
                 "ERROR: LidarScanMsg has "
                 "pose of length: "
                 "{}, expected: {}",
                 pose_vec->size(), pose.size());
-            return nullptr;
+            return false;
         }
-    }
-
-    // Set packet timestamp per lidar packet
-    auto packet_ts_vec = ls_msg->packet_timestamp();
-    if (packet_ts_vec) {
-        if (static_cast<uint32_t>(ls->packet_timestamp().size()) ==
-            packet_ts_vec->size()) {
-            for (uint32_t i = 0; i < packet_ts_vec->size(); ++i) {
-                ls->packet_timestamp()[i] = packet_ts_vec->Get(i);
-            }
-        } else if (packet_ts_vec->size() != 0) {
-            logger().error(
-                "ERROR: LidarScanMsg has "
-                "packet_timestamp of length: "
-                "{}, expected: {}",
-                packet_ts_vec->size(), ls->packet_timestamp().size());
-            return nullptr;
-        }
-    }
-
-    // Set alert flags per lidar packet
-    auto alert_flags_vec = ls_msg->alert_flags();
-    if (alert_flags_vec) {
-        if (static_cast<size_t>(ls->alert_flags().size()) ==
-            alert_flags_vec->size()) {
-            for (size_t i = 0; i < alert_flags_vec->size(); ++i) {
-                ls->alert_flags()[i] = alert_flags_vec->Get(i);
-            }
-        } else if (alert_flags_vec->size() != 0) {
-            logger().error(
-                "ERROR: LidarScanMsg has "
-                "alert_flags of length: "
-                "{}, expected: {}",
-                alert_flags_vec->size(), ls->alert_flags().size());
-            return nullptr;
+    } else {
+        // identity, as in a new scan
+        for (size_t i = 0; i < ls.w; ++i) {
+            Eigen::Ref<img_t<double>> col_pose = pose.subview(i);
+            col_pose = mat4d::Identity();
         }
     }
 
@@ -682,34 +855,33 @@ std::unique_ptr<ouster::LidarScan> restore_lidar_scan(
         logger().error(
             "ERROR: lidar_scan msg doesn't "
             "have scan fields.");
-        return nullptr;
+        return false;
     }
-    ScanData scan_data;
+    // the buffers of the fields not requested stay empty, they are skipped
+    // by scanDecode
+    ScanData& scan_data = restore_scan_data;
+    scan_data.resize(msg_scan_vec->size());
     for (uint32_t i = 0; i < msg_scan_vec->size(); ++i) {
+        if (i < field_types.size() && !ls.has_field(field_types[i].name)) {
+            scan_data[i].clear();
+            continue;
+        }
         auto channel_buffer = msg_scan_vec->Get(i)->buffer();
-        scan_data.emplace_back(channel_buffer->begin(), channel_buffer->end());
+        scan_data[i].assign(channel_buffer->begin(), channel_buffer->end());
     }
 
     // Decode PNGs data to LidarScan
-    if (scanDecode(*ls, scan_data, info.format.pixel_shift_by_row,
+    if (scanDecode(ls, scan_data, info.format.pixel_shift_by_row,
                    field_types)) {
-        return nullptr;
+        return false;
     }
 
-    auto msg_custom_fields = ls_msg->custom_fields();
     if (msg_custom_fields && msg_custom_fields->size()) {
         for (uint32_t i = 0; i < msg_custom_fields->size(); ++i) {
             auto custom_field = msg_custom_fields->Get(i);
 
             std::string name{custom_field->name()->c_str()};
-            bool found = fields.size() == 0;
-            for (const auto& f : fields) {
-                if (f == name) {
-                    found = true;
-                    break;
-                }
-            }
-            if (!found) {
+            if (!requested(name)) {
                 continue;
             }
             ChanFieldType tag = from_osf_enum(custom_field->tag());
@@ -718,22 +890,43 @@ std::unique_ptr<ouster::LidarScan> restore_lidar_scan(
             auto desc = FieldDescriptor::array(tag, shape);
             ouster::FieldClass field_class =
                 from_osf_enum(custom_field->field_class());
-            auto& field = ls->add_field(name, desc, field_class);
+            if (ls.has_field(name) &&
+                (!(ls.field(name).desc() == desc) ||
+                 ls.field(name).field_class() != field_class)) {
+                ls.del_field(name);
+            }
+            auto& field = ls.has_field(name)
+                              ? ls.field(name)
+                              : ls.add_field(name, desc, field_class);
 
-            std::vector<uint8_t> encoded{custom_field->data()->begin(),
-                                         custom_field->data()->end()};
+            ScanChannelData& encoded = restore_custom_field;
+            encoded.assign(custom_field->data()->begin(),
+                           custom_field->data()->end());
             decodeField(field, encoded);
         }
     }
 
     // error if any of the requested fields did not end up in the lidar scan
     for (const auto& field : fields) {
-        if (!ls->has_field(field)) {
+        if (!ls.has_field(field)) {
             throw std::runtime_error("Requested field '" + field +
                                      "' does not exist in OSF.");
         }
     }
 
+    return true;
+}
+
+/**
+ * Restore a new LidarScan from the LidarScanMsg.
+ *
+ * @return The scan, nullptr if the message couldn't be decoded.
+ */
+std::unique_ptr<ouster::LidarScan> restore_lidar_scan(
+    const uint8_t* buf, const ouster::sensor::sensor_info& info,
+    const std::vector<std::string>& fields) {
+    auto ls = std::make_unique<LidarScan>();
+    if (!restore_lidar_scan(buf, info, fields, *ls)) return nullptr;
     return ls;
 }
 
@@ -745,6 +938,10 @@ LidarScanStreamMeta::LidarScanStreamMeta(
 
 uint32_t LidarScanStreamMeta::sensor_meta_id() const { return sensor_meta_id_; }
 
+const ouster::LidarScanFieldTypes& LidarScanStreamMeta::field_types() const {
+    return field_types_;
+}
+
 std::vector<uint8_t> LidarScanStreamMeta::buffer() const {
     flatbuffers::FlatBufferBuilder fbb = flatbuffers::FlatBufferBuilder(512);
 
@@ -811,11 +1008,16 @@ std::string LidarScanStreamMeta::repr() const {
 
 LidarScanStream::LidarScanStream(Token /*key*/, Writer& writer,
                                  const uint32_t sensor_meta_id,
-                                 const ouster::LidarScanFieldTypes& field_types)
+                                 const ouster::LidarScanFieldTypes& field_types,
+                                 const LidarScanEncoder* lidar_scan_encoder)
     : writer_{writer},
       meta_(sensor_meta_id, field_types),
       sensor_meta_id_(sensor_meta_id),
-      field_types_(field_types) {
+      field_types_(field_types),
+      lidar_scan_encoder_(lidar_scan_encoder
+                              ? lidar_scan_encoder
+                              : &writer.encoder().lidar_scan_encoder()),
+      keyframe_interval_(writer.encoder().keyframe_interval()) {
     // Note key is ignored and just used to gatekeep.
     // Check sensor and get sensor_info
     auto sensor_meta_entry = writer.get_metadata<LidarSensor>(sensor_meta_id_);
@@ -835,11 +1037,67 @@ LidarScanStream::LidarScanStream(Token /*key*/, Writer& writer,
 void LidarScanStream::save(const ouster::osf::ts_t receive_ts,
                            const ouster::osf::ts_t sensor_ts,
                            const LidarScan& lidar_scan) {
-    const auto& msg_buf = make_msg(lidar_scan);
-    writer_.save_message(meta_.id(), receive_ts, sensor_ts, msg_buf);
+    std::unique_ptr<LidarScan> residual = delta_frame(lidar_scan);
+    try {
+        make_msg(residual ? *residual : lidar_scan, residual != nullptr,
+                 msg_buf_);
+        if (writer_.chunk_summaries()) {
+            // of the scan itself, not of its residual
+            const ChunkSummary summary =
+                summarize_scan(lidar_scan, field_types_);
+            writer_.save_message(meta_.id(), receive_ts, sensor_ts,
+                                 msg_buf_, residual != nullptr, &summary);
+        } else {
+            writer_.save_message(meta_.id(), receive_ts, sensor_ts,
+                                 msg_buf_, residual != nullptr);
+        }
+    } catch (...) {
+        // no delta frames can follow a keyframe that wasn't saved
+        if (!residual) keyframe_.reset();
+        throw;
+    }
+}
+
+std::unique_ptr<LidarScan> LidarScanStream::delta_frame(
+    const LidarScan& lidar_scan) {
+    if (keyframe_interval_ > 1 && keyframe_ &&
+        ++frames_since_keyframe_ < keyframe_interval_ &&
+        keyframe_->w == lidar_scan.w && keyframe_->h == lidar_scan.h) {
+        auto residual = std::make_unique<LidarScan>(lidar_scan);
+        bool matches_keyframe = true;
+        for (auto& f : residual->fields()) {
+            if (!is_delta_field(f.first, f.second)) continue;
+            if (!keyframe_->has_field(f.first) ||
+                !(keyframe_->field(f.first).desc() == f.second.desc())) {
+                matches_keyframe = false;
+                break;
+            }
+            apply_delta(f.second, keyframe_->field(f.first), false);
+        }
+        if (matches_keyframe) return residual;
+    }
+
+    // a new group starts with this scan, also when its fields changed
+    frames_since_keyframe_ = 0;
+    if (keyframe_interval_ > 1) {
+        keyframe_ = std::make_unique<LidarScan>(lidar_scan);
+    }
+    return nullptr;
 }
 
 std::vector<uint8_t> LidarScanStream::make_msg(const LidarScan& lidar_scan) {
+    return make_msg(lidar_scan, false);
+}
+
+std::vector<uint8_t> LidarScanStream::make_msg(const LidarScan& lidar_scan,
+                                               bool delta_frame) {
+    std::vector<uint8_t> msg_buf;
+    make_msg(lidar_scan, delta_frame, msg_buf);
+    return msg_buf;
+}
+
+void LidarScanStream::make_msg(const LidarScan& lidar_scan, bool delta_frame,
+                               std::vector<uint8_t>& msg_buf) {
     if (lidar_scan.w != sensor_info_.w() || lidar_scan.h != sensor_info_.h()) {
         std::stringstream exception_msg_stream;
         exception_msg_stream
@@ -848,13 +1106,12 @@ std::vector<uint8_t> LidarScanStream::make_msg(const LidarScan& lidar_scan) {
             << sensor_info_.w() << ", " << sensor_info_.h() << ")";
         throw std::invalid_argument(exception_msg_stream.str());
     }
-    flatbuffers::FlatBufferBuilder fbb = flatbuffers::FlatBufferBuilder(32768);
-    auto ls_msg_offset =
-        create_lidar_scan_msg(fbb, lidar_scan, sensor_info_, field_types_);
+    flatbuffers::FlatBufferBuilder& fbb = message_builder();
+    auto ls_msg_offset = create_lidar_scan_msg(fbb, lidar_scan, sensor_info_,
+                                               field_types_, delta_frame);
     fbb.FinishSizePrefixed(ls_msg_offset);
     const uint8_t* buf = fbb.GetBufferPointer();
-    const size_t size = fbb.GetSize();
-    return {buf, buf + size};
+    msg_buf.assign(buf, buf + fbb.GetSize());
 }
 
 /**
@@ -864,17 +1121,97 @@ std::vector<uint8_t> LidarScanStream::make_msg(const LidarScan& lidar_scan) {
  *
  * IMPORTANT: this method allocates a LidarScan, copies the data from the
  * buffer, and returns it wrapped in a unique_ptr. It returns nullptr if the
- * message couldn't be decoded properly.  Overall, this could be more efficient
- * and should probably be using value semantics. See restore_lidar_scan for
- * details.
+ * message couldn't be decoded properly. decode_msg_into() decodes into an
+ * existing scan instead. See restore_lidar_scan for details.
  */
 std::unique_ptr<LidarScanStream::obj_type> LidarScanStream::decode_msg(
     const std::vector<uint8_t>& buf, const LidarScanStream::meta_type& meta,
     const MetadataStore& meta_provider,
     const std::vector<std::string>& fields) {
+    if (is_delta_frame(buf.data())) {
+        logger().error(
+            "ERROR: LidarScanMsg is a delta frame, decode it from its "
+            "MessageRef to reach the keyframe.");
+        return nullptr;
+    }
     auto sensor = meta_provider.get<LidarSensor>(meta.sensor_meta_id());
-    auto info = sensor->info();
-    return restore_lidar_scan(buf, info, fields);
+    return restore_lidar_scan(buf.data(), sensor->info(), fields);
+}
+
+std::unique_ptr<LidarScanStream::obj_type> LidarScanStream::decode_msg(
+    const MessageRef& msg, const LidarScanStream::meta_type& meta,
+    const MetadataStore& meta_provider,
+    const std::vector<std::string>& fields) {
+    auto ls = std::make_unique<LidarScan>();
+    if (!decode_msg_into(msg, meta, meta_provider, *ls, fields)) {
+        return nullptr;
+    }
+    return ls;
+}
+
+bool LidarScanStream::decode_msg_into(
+    const MessageRef& msg, const LidarScanStream::meta_type& meta,
+    const MetadataStore& meta_provider, LidarScanStream::obj_type& lidar_scan,
+    const std::vector<std::string>& fields) {
+    auto sensor = meta_provider.get<LidarSensor>(meta.sensor_meta_id());
+    const auto& info = sensor->info();
+    // straight from the chunk, without a copy of the message
+    if (!restore_lidar_scan(msg.view().data(), info, fields, lidar_scan)) {
+        return false;
+    }
+    if (!is_delta_frame(msg)) return true;
+
+    std::vector<std::string> delta_fields;
+    for (const auto& f : lidar_scan.fields()) {
+        if (is_delta_field(f.first, f.second)) delta_fields.push_back(f.first);
+    }
+    if (delta_fields.empty()) return true;
+    std::sort(delta_fields.begin(), delta_fields.end());
+
+    // the keyframe starts the group, which is never split across chunks
+    std::unique_ptr<const MessageRef> keyframe = msg.previous();
+    while (keyframe && is_delta_frame(*keyframe)) {
+        keyframe = keyframe->previous();
+    }
+    if (!keyframe) {
+        logger().error(
+            "ERROR: LidarScanMsg is a delta frame without a keyframe in its "
+            "chunk.");
+        return false;
+    }
+
+    auto& cache = keyframe_cache;
+    const auto keyframe_view = keyframe->view();
+    const size_t keyframe_size = static_cast<size_t>(keyframe_view.shape[0]);
+    if (!cache.scan || cache.meta_provider != &meta_provider ||
+        cache.id != keyframe->id() || cache.ts != keyframe->ts() ||
+        cache.size != keyframe_size || cache.fields != delta_fields) {
+        if (!cache.scan) cache.scan = std::make_unique<LidarScan>();
+        cache.meta_provider = &meta_provider;
+        cache.id = keyframe->id();
+        cache.ts = keyframe->ts();
+        cache.size = keyframe_size;
+        cache.fields = delta_fields;
+        if (!restore_lidar_scan(keyframe_view.data(), info, delta_fields,
+                                *cache.scan)) {
+            cache.scan.reset();
+            return false;
+        }
+    }
+
+    for (const auto& name : delta_fields) {
+        auto& field = lidar_scan.field(name);
+        const auto& keyframe_field = cache.scan->field(name);
+        if (!(field.desc() == keyframe_field.desc())) {
+            logger().error(
+                "ERROR: LidarScanMsg field {} of a delta frame doesn't match "
+                "its keyframe.",
+                name);
+            return false;
+        }
+        apply_delta(field, keyframe_field, true);
+    }
+    return true;
 }
 
 }  // namespace osf
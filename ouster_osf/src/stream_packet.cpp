@@ -0,0 +1,225 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/osf/stream_packet.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "flatbuffers/flatbuffers.h"
+#include "os_sensor/packet_stream_generated.h"
+#include "ouster/impl/logging.h"
+#include "ouster/osf/meta_lidar_sensor.h"
+#include "zstd_tools.h"
+
+using namespace ouster::sensor;
+
+namespace ouster {
+namespace osf {
+
+namespace {
+
+gen::PACKET_TYPE to_osf_enum(PacketType type) {
+    switch (type) {
+        case PacketType::Lidar:
+            return gen::PACKET_TYPE::LIDAR;
+        case PacketType::Imu:
+            return gen::PACKET_TYPE::IMU;
+        default:
+            return gen::PACKET_TYPE::UNKNOWN;
+    }
+}
+
+PacketType from_osf_enum(gen::PACKET_TYPE type) {
+    switch (type) {
+        case gen::PACKET_TYPE::LIDAR:
+            return PacketType::Lidar;
+        case gen::PACKET_TYPE::IMU:
+            return PacketType::Imu;
+        default:
+            return PacketType::Unknown;
+    }
+}
+
+std::vector<uint32_t> select_streams(const Reader& reader,
+                                     const std::vector<uint32_t>& stream_ids) {
+    if (!stream_ids.empty()) return stream_ids;
+    std::vector<uint32_t> res;
+    for (const auto& meta : reader.meta_store().find<PacketStreamMeta>()) {
+        res.push_back(meta.first);
+    }
+    return res;
+}
+
+}  // namespace
+
+// ============== PacketStream Meta ===========================
+
+PacketStreamMeta::PacketStreamMeta(uint32_t sensor_meta_id,
+                                   int compression_level)
+    : sensor_meta_id_{sensor_meta_id},
+      compression_level_{compression_level} {}
+
+uint32_t PacketStreamMeta::sensor_meta_id() const { return sensor_meta_id_; }
+
+int PacketStreamMeta::compression_level() const { return compression_level_; }
+
+std::vector<uint8_t> PacketStreamMeta::buffer() const {
+    flatbuffers::FlatBufferBuilder fbb = flatbuffers::FlatBufferBuilder(64);
+    auto ps_offset =
+        gen::CreatePacketStream(fbb, sensor_meta_id_, compression_level_);
+    gen::FinishSizePrefixedPacketStreamBuffer(fbb, ps_offset);
+    const uint8_t* buf = fbb.GetBufferPointer();
+    const size_t size = fbb.GetSize();
+    return {buf, buf + size};
+}
+
+std::unique_ptr<MetadataEntry> PacketStreamMeta::from_buffer(
+    const std::vector<uint8_t>& buf) {
+    auto packet_stream = gen::GetSizePrefixedPacketStream(buf.data());
+    if (!packet_stream) return nullptr;
+    return std::make_unique<PacketStreamMeta>(
+        packet_stream->sensor_id(), packet_stream->compression_level());
+}
+
+std::string PacketStreamMeta::repr() const {
+    std::stringstream ss;
+    ss << "PacketStreamMeta: sensor_id = " << sensor_meta_id_
+       << ", compression_level = " << compression_level_;
+    return ss.str();
+}
+
+// ============== PacketStream ops ===========================
+
+PacketStream::PacketStream(Token /*key*/, Writer& writer,
+                           uint32_t sensor_meta_id, int compression_level)
+    : writer_{writer}, meta_(sensor_meta_id, compression_level) {
+    if (writer.get_metadata<LidarSensor>(sensor_meta_id) == nullptr) {
+        std::stringstream ss;
+        ss << "ERROR: can't find sensor_meta_id = " << sensor_meta_id;
+        throw std::logic_error(ss.str());
+    }
+    stream_meta_id_ = writer_.add_metadata(meta_);
+}
+
+void PacketStream::save(const Packet& packet) {
+    if (packet.type() != PacketType::Lidar &&
+        packet.type() != PacketType::Imu) {
+        throw std::invalid_argument(
+            "ERROR: Can't save a packet of unknown type");
+    }
+    make_msg(packet.type(), packet.buf, msg_buf_);
+    // the sensor timestamp is in the packet, so the receive time serves both
+    const ts_t ts(packet.host_timestamp);
+    writer_.save_message(meta_.id(), ts, ts, msg_buf_);
+}
+
+void PacketStream::make_msg(PacketType type, const std::vector<uint8_t>& buf,
+                            std::vector<uint8_t>& msg_buf) {
+    const std::vector<uint8_t>* payload = &buf;
+    const bool compressed = meta_.compression_level() != 0;
+    if (compressed) {
+        if (zstdCompress(compressed_, buf.data(), buf.size(),
+                         meta_.compression_level())) {
+            throw std::runtime_error("ERROR: Can't compress a packet");
+        }
+        payload = &compressed_;
+    }
+    flatbuffers::FlatBufferBuilder fbb(payload->size() + 64);
+    auto buffer_offset = fbb.CreateVector(*payload);
+    auto msg_offset = gen::CreatePacketMsg(fbb, to_osf_enum(type),
+                                           buffer_offset, compressed);
+    fbb.FinishSizePrefixed(msg_offset);
+    const uint8_t* fb_buf = fbb.GetBufferPointer();
+    msg_buf.assign(fb_buf, fb_buf + fbb.GetSize());
+}
+
+std::unique_ptr<PacketStream::obj_type> PacketStream::decode_msg(
+    const std::vector<uint8_t>& buf, const PacketStream::meta_type& /*meta*/,
+    const MetadataStore& /*meta_provider*/) {
+    auto msg = flatbuffers::GetSizePrefixedRoot<gen::PacketMsg>(buf.data());
+    if (!msg || !msg->buffer()) return nullptr;
+    auto packet = std::make_unique<RawPacket>();
+    packet->type = from_osf_enum(msg->packet_type());
+    const uint8_t* data = msg->buffer()->data();
+    const size_t size = msg->buffer()->size();
+    if (msg->compressed()) {
+        if (zstdDecompress(packet->buf, data, size)) return nullptr;
+    } else {
+        packet->buf.assign(data, data + size);
+    }
+    return packet;
+}
+
+// ============== PacketScanReader ===========================
+
+PacketScanReader::PacketScanReader(Reader& reader,
+                                   const std::vector<uint32_t>& stream_ids,
+                                   ts_t start_ts, ts_t end_ts,
+                                   const std::vector<std::string>& fields)
+    : stream_ids_(select_streams(reader, stream_ids)),
+      range_(reader.messages(stream_ids_, start_ts, end_ts)),
+      it_(range_.begin()),
+      end_(range_.end()) {
+    const auto& store = reader.meta_store();
+    for (const auto id : stream_ids_) {
+        auto meta = store.get<PacketStreamMeta>(id);
+        if (!meta) {
+            throw std::invalid_argument(
+                "ERROR: stream " + std::to_string(id) +
+                " isn't a PacketStream");
+        }
+        auto sensor = store.get<LidarSensor>(meta->sensor_meta_id());
+        if (!sensor) {
+            throw std::invalid_argument(
+                "ERROR: can't find the sensor of packet stream " +
+                std::to_string(id));
+        }
+        Batch& batch = batches_[id];
+        batch.info = sensor->info();
+        for (const auto& type : get_field_types(batch.info)) {
+            if (fields.empty() || std::find(fields.begin(), fields.end(),
+                                            type.name) != fields.end()) {
+                batch.field_types.push_back(type);
+            }
+        }
+        batch.batcher = std::make_unique<ScanBatcher>(batch.info);
+    }
+}
+
+bool PacketScanReader::next(DecodedScan& scan) {
+    for (; it_ != end_; ++it_) {
+        const MessageRef msg = *it_;
+        auto batch = batches_.find(msg.id());
+        if (batch == batches_.end()) continue;
+        auto packet = msg.decode_msg<PacketStream>();
+        // IMU packets don't make up scans
+        if (!packet || packet->type != PacketType::Lidar) continue;
+
+        Batch& b = batch->second;
+        if (!b.scan) {
+            b.scan = std::make_unique<LidarScan>(
+                b.info.w(), b.info.h(), b.field_types.begin(),
+                b.field_types.end(), b.info.format.columns_per_packet);
+        }
+        packet_.buf = std::move(packet->buf);
+        packet_.host_timestamp = msg.ts().count();
+        if ((*b.batcher)(packet_, *b.scan)) {
+            ++it_;
+            scan.stream_id = batch->first;
+            scan.ts = ts_t(b.scan->get_first_valid_packet_timestamp());
+            scan.scan = std::move(b.scan);
+            return true;
+        }
+    }
+    return false;
+}
+
+const std::vector<uint32_t>& PacketScanReader::stream_ids() const {
+    return stream_ids_;
+}
+
+}  // namespace osf
+}  // namespace ouster
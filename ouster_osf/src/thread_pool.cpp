@@ -0,0 +1,155 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/osf/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <string>
+
+#include "ouster/threads.h"
+
+namespace ouster {
+namespace osf {
+
+struct ThreadPool::Job {
+    Job(size_t n, const std::function<void(size_t)>& f)
+        : f(f), n(n), remaining(n) {}
+    explicit Job(std::function<void(size_t)>&& task)
+        : owned(std::move(task)), f(owned), n(1), remaining(1) {}
+
+    std::function<void(size_t)> owned;
+    const std::function<void(size_t)>& f;
+    const size_t n;
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> remaining;
+    std::mutex mutex;
+    std::condition_variable done;
+    std::exception_ptr error;
+};
+
+ThreadPool::ThreadPool(unsigned threads) {
+#ifndef OUSTER_OSF_NO_THREADING
+    if (threads == 0) {
+        // the calling thread takes part in parallel_for
+        threads = sdk_thread_count() - 1;
+    }
+    threads_.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        threads_.push_back(start_thread("ouster-pool-" + std::to_string(i),
+                                        [this] { worker(); }));
+    }
+#else
+    (void)threads;
+#endif
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& t : threads_) t.join();
+}
+
+size_t ThreadPool::size() const { return threads_.size(); }
+
+bool ThreadPool::run_one(Job& job) {
+    const size_t i = job.next.fetch_add(1);
+    if (i >= job.n) return false;
+    try {
+        job.f(i);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(job.mutex);
+        if (!job.error) job.error = std::current_exception();
+    }
+    if (job.remaining.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(job.mutex);
+        job.done.notify_all();
+    }
+    return true;
+}
+
+void ThreadPool::worker() {
+    while (true) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+            // submitted tasks are drained before stopping
+            if (jobs_.empty()) return;
+            job = jobs_.front();
+        }
+        if (!run_one(*job)) {
+            // every task of the oldest job is taken, move on to the next
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!jobs_.empty() && jobs_.front() == job) jobs_.pop_front();
+        }
+    }
+}
+
+void ThreadPool::parallel_for(size_t n, const std::function<void(size_t)>& f) {
+    if (n == 0) return;
+    auto job = std::make_shared<Job>(n, f);
+    const bool shared = !threads_.empty() && n > 1;
+    if (shared) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            jobs_.push_back(job);
+        }
+        cv_.notify_all();
+    }
+
+    // the caller works too, which also keeps nested calls from deadlocking
+    while (run_one(*job)) {
+    }
+    {
+        std::unique_lock<std::mutex> lock(job->mutex);
+        job->done.wait(lock, [&] { return job->remaining == 0; });
+    }
+    if (shared) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::find(jobs_.begin(), jobs_.end(), job);
+        if (it != jobs_.end()) jobs_.erase(it);
+    }
+    if (job->error) std::rethrow_exception(job->error);
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    if (threads_.empty()) {
+        task();
+        return;
+    }
+    auto job = std::make_shared<Job>(
+        [task = std::move(task)](size_t) { task(); });
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back(std::move(job));
+    }
+    cv_.notify_one();
+}
+
+namespace {
+
+std::mutex default_pool_mutex;
+std::shared_ptr<ThreadPool> default_pool;
+
+}  // namespace
+
+std::shared_ptr<ThreadPool> default_thread_pool() {
+    std::lock_guard<std::mutex> lock(default_pool_mutex);
+    if (!default_pool) default_pool = std::make_shared<ThreadPool>();
+    return default_pool;
+}
+
+void set_default_thread_pool(std::shared_ptr<ThreadPool> pool) {
+    std::lock_guard<std::mutex> lock(default_pool_mutex);
+    default_pool = std::move(pool);
+}
+
+}  // namespace osf
+}  // namespace ouster
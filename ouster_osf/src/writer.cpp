@@ -7,13 +7,16 @@
 
 #include <sstream>
 
+#include "chunk_file.h"
 #include "fb_utils.h"
 #include "ouster/impl/logging.h"
 #include "ouster/osf/basics.h"
 #include "ouster/osf/crc32.h"
 #include "ouster/osf/layout_streaming.h"
+#include "ouster/osf/meta_recording_gaps.h"
 #include "ouster/osf/png_lidarscan_encoder.h"
 #include "ouster/osf/stream_lidar_scan.h"
+#include "ouster/osf/stream_packet.h"
 
 using namespace ouster::sensor;
 
@@ -90,8 +93,8 @@ uint32_t Writer::add_sensor(const ouster::sensor::sensor_info& info,
     return lidar_meta_id_.size() - 1;
 }
 
-void Writer::_save(uint32_t stream_index, const LidarScan& scan,
-                   const ts_t time) {
+LidarScanStream& Writer::_stream_for(uint32_t stream_index,
+                                     const LidarScan& scan) {
     if (stream_index < lidar_meta_id_.size()) {
         auto item = lidar_streams_.find(stream_index);
         if (item == lidar_streams_.end()) {
@@ -111,10 +114,31 @@ void Writer::_save(uint32_t stream_index, const LidarScan& scan,
             }
             field_types_[stream_index] = field_types;
 
-            lidar_streams_[stream_index] =
-                std::make_unique<ouster::osf::LidarScanStream>(
+            // columnar sensors get a stream per field
+            std::vector<LidarScanFieldTypes> stream_fields;
+            if (columnar_.count(stream_index) && field_types.size() > 1) {
+                for (const auto& ft : field_types) {
+                    stream_fields.push_back({ft});
+                }
+            } else {
+                stream_fields.push_back(field_types);
+            }
+            auto policy = sensor_chunk_policies_.find(stream_index);
+            for (size_t i = 0; i < stream_fields.size(); i++) {
+                auto stream = std::make_unique<ouster::osf::LidarScanStream>(
                     LidarScanStream::Token(), *this,
-                    lidar_meta_id_[stream_index], field_types);
+                    lidar_meta_id_[stream_index], stream_fields[i],
+                    &encoder_->lidar_scan_encoder(stream_index));
+                if (policy != sensor_chunk_policies_.end()) {
+                    chunks_writer_->set_chunk_policy(stream->stream_id(),
+                                                     policy->second);
+                }
+                if (i == 0) {
+                    lidar_streams_[stream_index] = std::move(stream);
+                } else {
+                    column_streams_[stream_index].push_back(std::move(stream));
+                }
+            }
         }
 
         // enforce that this scan meets our expected field types and that
@@ -156,17 +180,38 @@ void Writer::_save(uint32_t stream_index, const LidarScan& scan,
             }
         }
 
-        lidar_streams_[stream_index]->save(
-            time, ts_t(scan.get_first_valid_column_timestamp()), scan);
+        return *lidar_streams_[stream_index];
     } else {
         throw std::logic_error("ERROR: Bad Stream ID");
     }
 }
 
+void Writer::_save(uint32_t stream_index, const LidarScan& scan,
+                   const ts_t time) {
+    const ts_t sensor_ts(scan.get_first_valid_column_timestamp());
+    _stream_for(stream_index, scan).save(time, sensor_ts, scan);
+    auto columns = column_streams_.find(stream_index);
+    if (columns != column_streams_.end()) {
+        for (auto& stream : columns->second) {
+            stream->save(time, sensor_ts, scan);
+        }
+    }
+}
+
+bool Writer::admit(uint32_t stream_index, const LidarScan& scan) {
+    if (!gate_options_ || !lidar_meta_id_.count(stream_index)) return true;
+    auto gate = gates_.find(stream_index);
+    if (gate == gates_.end()) {
+        gate = gates_.emplace(stream_index, ScanGate(*gate_options_)).first;
+    }
+    return gate->second.admit(scan);
+}
+
 void Writer::save(uint32_t stream_index, const LidarScan& scan) {
     if (is_closed()) {
         throw std::logic_error("ERROR: Writer is closed");
     }
+    if (!admit(stream_index, scan)) return;
     ts_t time = ts_t(scan.get_first_valid_packet_timestamp());
     _save(stream_index, scan, time);
 }
@@ -175,6 +220,7 @@ void Writer::save(uint32_t stream_index, const LidarScan& scan, const ts_t ts) {
     if (is_closed()) {
         throw std::logic_error("ERROR: Writer is closed");
     }
+    if (!admit(stream_index, scan)) return;
     _save(stream_index, scan, ts);
 }
 
@@ -188,12 +234,38 @@ void Writer::save(const std::vector<LidarScan>& scans) {
             "does not match number of sensor infos");
     } else {
         for (uint32_t i = 0; i < scans.size(); i++) {
+            if (!admit(i, scans[i])) continue;
             ts_t time = ts_t(scans[i].get_first_valid_packet_timestamp());
             _save(i, scans[i], time);
         }
     }
 }
 
+void Writer::save_packet(uint32_t stream_index,
+                         const ouster::sensor::Packet& packet) {
+    if (is_closed()) {
+        throw std::logic_error("ERROR: Writer is closed");
+    }
+    if (stream_index >= lidar_meta_id_.size()) {
+        throw std::logic_error("ERROR: Bad Stream ID");
+    }
+    auto item = packet_streams_.find(stream_index);
+    if (item == packet_streams_.end()) {
+        auto stream = std::make_unique<PacketStream>(
+            PacketStream::Token(), *this, lidar_meta_id_[stream_index],
+            packet_compression_);
+        auto policy = sensor_chunk_policies_.find(stream_index);
+        if (policy != sensor_chunk_policies_.end()) {
+            chunks_writer_->set_chunk_policy(stream->stream_id(),
+                                             policy->second);
+        }
+        item = packet_streams_.emplace(stream_index, std::move(stream)).first;
+    }
+    item->second->save(packet);
+}
+
+void Writer::set_packet_compression(int level) { packet_compression_ = level; }
+
 uint32_t Writer::add_metadata(MetadataEntry&& entry) {
     return add_metadata(entry);
 }
@@ -207,7 +279,8 @@ std::shared_ptr<MetadataEntry> Writer::get_metadata(
     return meta_store_.get(metadata_id);
 }
 
-uint64_t Writer::append(const uint8_t* buf, const uint64_t size) {
+uint64_t Writer::append(const uint8_t* buf, const uint64_t size,
+                        bool barrier) {
     if (pos_ < 0) {
         throw std::logic_error("ERROR: Writer is not ready (not started?)");
     }
@@ -218,8 +291,12 @@ uint64_t Writer::append(const uint8_t* buf, const uint64_t size) {
         logger().info("Writer::append has nothing to append");
         return 0;
     }
-    uint64_t saved_bytes = buffer_to_file(buf, size, filename_, true);
-    pos_ += static_cast<int>(saved_bytes);
+    if (!chunk_file_) {
+        chunk_file_ = std::make_unique<ChunkFile>(
+            filename_, static_cast<uint64_t>(pos_), chunk_io_);
+    }
+    uint64_t saved_bytes = chunk_file_->append(buf, size, barrier);
+    pos_ += static_cast<int64_t>(saved_bytes);
     return saved_bytes;
 }
 
@@ -227,7 +304,8 @@ uint64_t Writer::append(const uint8_t* buf, const uint64_t size) {
 
 void Writer::save_message(const uint32_t stream_id, const ts_t receive_ts,
                           const ts_t sensor_ts,
-                          const std::vector<uint8_t>& msg_buf) {
+                          const std::vector<uint8_t>& msg_buf,
+                          bool delta_frame, const ChunkSummary* summary) {
     if (!meta_store_.get(stream_id)) {
         std::stringstream ss;
         ss << "ERROR: Attempt to save the non existent stream: id = "
@@ -238,7 +316,70 @@ void Writer::save_message(const uint32_t stream_id, const ts_t receive_ts,
         return;
     }
 
-    chunks_writer_->save_message(stream_id, receive_ts, sensor_ts, msg_buf);
+    if (checkpoint_interval_ &&
+        (chunks_.size() >= checkpoint_chunks_ + checkpoint_interval_ ||
+         meta_store_.size() != checkpoint_entries_)) {
+        checkpoint();
+    }
+
+    if (delta_frame) {
+        chunks_writer_->save_delta_message(stream_id, receive_ts, sensor_ts,
+                                           msg_buf);
+    } else {
+        chunks_writer_->save_message(stream_id, receive_ts, sensor_ts,
+                                     msg_buf);
+    }
+    if (summary) chunks_writer_->summarize_message(stream_id, *summary);
+}
+
+void Writer::finish_stream(uint32_t stream_id) {
+    if (is_closed()) {
+        throw std::logic_error("ERROR: Writer is closed");
+    }
+    chunks_writer_->finish_stream(stream_id);
+}
+
+void Writer::save_chunk(const std::vector<uint8_t>& chunk_buf) {
+    auto verifier = flatbuffers::Verifier(chunk_buf.data(), chunk_buf.size());
+    if (!gen::VerifySizePrefixedChunkBuffer(verifier)) {
+        throw std::logic_error("ERROR: Attempt to save an invalid chunk");
+    }
+    auto messages = gen::GetSizePrefixedChunk(chunk_buf.data())->messages();
+    if (!messages || messages->size() == 0) return;
+
+    const uint32_t stream_id = messages->Get(0)->id();
+    if (!meta_store_.get(stream_id)) {
+        std::stringstream ss;
+        ss << "ERROR: Attempt to save the non existent stream: id = "
+           << stream_id << std::endl;
+        throw std::logic_error(ss.str());
+    }
+
+    // the stream stats keep the sensor timestamps of lidar scans, other
+    // streams don't have one in their messages
+    const bool lidar_scans =
+        meta_store_.get<LidarScanStreamMeta>(stream_id) != nullptr;
+    std::vector<ts_t> sensor_ts;
+    sensor_ts.reserve(messages->size());
+    for (uint32_t i = 0; i < messages->size(); ++i) {
+        auto msg = messages->Get(i);
+        if (msg->id() != stream_id) {
+            throw std::logic_error(
+                "ERROR: Attempt to save a chunk of more than one stream");
+        }
+        sensor_ts.push_back(lidar_scans && msg->buffer()
+                                ? lidar_scan_msg_sensor_ts(
+                                      msg->buffer()->data())
+                                : ts_t{msg->ts()});
+    }
+
+    if (checkpoint_interval_ &&
+        (chunks_.size() >= checkpoint_chunks_ + checkpoint_interval_ ||
+         meta_store_.size() != checkpoint_entries_)) {
+        checkpoint();
+    }
+
+    chunks_writer_->save_chunk(stream_id, chunk_buf, sensor_ts);
 }
 
 const MetadataStore& Writer::meta_store() const { return meta_store_; }
@@ -253,9 +394,15 @@ ChunksLayout Writer::chunks_layout() const { return chunks_layout_; }
 
 uint64_t Writer::emit_chunk(const ts_t chunk_start_ts, const ts_t chunk_end_ts,
                             const std::vector<uint8_t>& chunk_buf) {
-    uint64_t saved_bytes = append(chunk_buf.data(), chunk_buf.size());
+    return emit_chunk(chunk_start_ts, chunk_end_ts, chunk_buf.data(),
+                      chunk_buf.size());
+}
+
+uint64_t Writer::emit_chunk(const ts_t chunk_start_ts, const ts_t chunk_end_ts,
+                            const uint8_t* chunk_buf, uint64_t size) {
+    uint64_t saved_bytes = append(chunk_buf, size);
     uint64_t res_chunk_offset{0};
-    if (saved_bytes && saved_bytes == chunk_buf.size() + CRC_BYTES_SIZE) {
+    if (saved_bytes && saved_bytes == size + CRC_BYTES_SIZE) {
         chunks_.emplace_back(chunk_start_ts.count(), chunk_end_ts.count(),
                              next_chunk_offset_);
         res_chunk_offset = next_chunk_offset_;
@@ -272,13 +419,31 @@ uint64_t Writer::emit_chunk(const ts_t chunk_start_ts, const ts_t chunk_end_ts,
     return res_chunk_offset;
 }
 
+void Writer::checkpoint() {
+    MetadataStore store = meta_store_;
+    chunks_writer_->checkpoint_metadata(store);
+    auto metadata_buf = make_metadata(store);
+    // checkpoints sit between the chunks, which readers only reach by offset
+    uint64_t saved_bytes =
+        append(metadata_buf.data(), metadata_buf.size(), true);
+    if (saved_bytes != metadata_buf.size() + CRC_BYTES_SIZE) {
+        std::stringstream ss;
+        ss << "ERROR: Can't save checkpoint to file. saved_bytes = "
+           << saved_bytes << std::endl;
+        throw std::logic_error(ss.str());
+    }
+    next_chunk_offset_ += saved_bytes;
+    checkpoint_chunks_ = chunks_.size();
+    checkpoint_entries_ = meta_store_.size();
+}
+
 // < < < ================== Chunk Emiter operations ======================
 
-std::vector<uint8_t> Writer::make_metadata() const {
+std::vector<uint8_t> Writer::make_metadata(const MetadataStore& store) const {
     auto metadata_fbb = flatbuffers::FlatBufferBuilder(32768);
 
     std::vector<flatbuffers::Offset<ouster::osf::gen::MetadataEntry>> entries =
-        meta_store_.make_entries(metadata_fbb);
+        store.make_entries(metadata_fbb);
 
     auto metadata = ouster::osf::gen::CreateMetadataDirect(
         metadata_fbb, metadata_id_.c_str(),
@@ -303,12 +468,21 @@ void Writer::close() {
     // Finish all chunks in flight
     chunks_writer_->finish();
 
+    // the scans left out of each gated sensor
+    for (const auto& gate : gates_) {
+        meta_store_.add(RecordingGaps(gate.second.skipped_spans(),
+                                      gate.second.kept(),
+                                      lidar_meta_id_[gate.first]));
+    }
+
     // Encode chunks, metadata entries and other fields into final buffer
-    auto metadata_buf = make_metadata();
+    auto metadata_buf = make_metadata(meta_store_);
 
     uint64_t metadata_offset = pos_;
     uint64_t metadata_saved_size =
         append(metadata_buf.data(), metadata_buf.size());
+    // the last chunks may still be on their way to the disk
+    if (chunk_file_ && !chunk_file_->close()) metadata_saved_size = 0;
     if (metadata_saved_size &&
         metadata_saved_size == metadata_buf.size() + CRC_BYTES_SIZE) {
         if (finish_osf_file(filename_, metadata_offset, metadata_saved_size) ==
@@ -327,12 +501,119 @@ void Writer::close() {
     }
 }
 
+void Writer::set_chunk_io(const ChunkIoOptions& options) {
+    if (chunk_file_) {
+        throw std::logic_error(
+            "ERROR: Chunk I/O can't change after the first chunk");
+    }
+#ifndef __linux__
+    if (options.direct) {
+        throw std::invalid_argument("Direct I/O is only supported on Linux");
+    }
+#endif
+    chunk_io_ = options;
+}
+
+const ChunkIoOptions& Writer::chunk_io() const { return chunk_io_; }
+
+void Writer::set_checkpoint_interval(uint32_t chunks) {
+    checkpoint_interval_ = chunks;
+}
+
+uint32_t Writer::checkpoint_interval() const { return checkpoint_interval_; }
+
 uint32_t Writer::chunk_size() const { return chunks_writer_->chunk_size(); }
 
+void Writer::set_chunk_policy(const ChunkPolicy& policy) {
+    chunks_writer_->set_chunk_policy(policy);
+}
+
+void Writer::set_chunk_policy(uint32_t stream_id, const ChunkPolicy& policy) {
+    chunks_writer_->set_chunk_policy(stream_id, policy);
+}
+
+void Writer::set_sensor_chunk_policy(uint32_t stream_index,
+                                     const ChunkPolicy& policy) {
+    if (stream_index >= lidar_meta_id_.size()) {
+        throw std::logic_error("ERROR: Bad Stream ID");
+    }
+    sensor_chunk_policies_[stream_index] = policy;
+    auto stream = lidar_streams_.find(stream_index);
+    if (stream != lidar_streams_.end()) {
+        chunks_writer_->set_chunk_policy(stream->second->stream_id(), policy);
+    }
+    auto columns = column_streams_.find(stream_index);
+    if (columns != column_streams_.end()) {
+        for (const auto& column : columns->second) {
+            chunks_writer_->set_chunk_policy(column->stream_id(), policy);
+        }
+    }
+    auto packets = packet_streams_.find(stream_index);
+    if (packets != packet_streams_.end()) {
+        chunks_writer_->set_chunk_policy(packets->second->stream_id(), policy);
+    }
+}
+
+void Writer::set_columnar(uint32_t stream_index, bool columnar) {
+    if (stream_index >= lidar_meta_id_.size()) {
+        throw std::logic_error("ERROR: Bad Stream ID");
+    }
+    if (lidar_streams_.count(stream_index)) {
+        throw std::logic_error(
+            "ERROR: Can't change the layout of a sensor after its first scan");
+    }
+    if (columnar) {
+        columnar_.insert(stream_index);
+    } else {
+        columnar_.erase(stream_index);
+    }
+}
+
+bool Writer::columnar(uint32_t stream_index) const {
+    return columnar_.count(stream_index) > 0;
+}
+
+void Writer::set_chunk_summaries(bool enable) { chunk_summaries_ = enable; }
+
+bool Writer::chunk_summaries() const { return chunk_summaries_; }
+
+void Writer::set_scan_gate(const ScanGateOptions& options) {
+    // checks the options
+    ScanGate gate(options);
+    gate_options_ = std::make_unique<ScanGateOptions>(gate.options());
+    gates_.clear();
+}
+
+const ScanGate* Writer::scan_gate(uint32_t stream_index) const {
+    auto gate = gates_.find(stream_index);
+    return gate == gates_.end() ? nullptr : &gate->second;
+}
+
+void Writer::set_next_metadata_id(uint32_t next_id) {
+    meta_store_.set_next_id(next_id);
+}
+
+ChunkPolicy Writer::chunk_policy(uint32_t stream_id) const {
+    return chunks_writer_->chunk_policy(stream_id);
+}
+
 Writer::~Writer() { close(); }
 
 // ================================================================
 
+void ChunksWriter::save_chunk(const uint32_t stream_id,
+                              const std::vector<uint8_t>& chunk_buf,
+                              const std::vector<ts_t>& sensor_ts) {
+    auto messages = gen::GetSizePrefixedChunk(chunk_buf.data())->messages();
+    for (uint32_t i = 0; messages && i < messages->size(); ++i) {
+        auto msg = messages->Get(i);
+        save_message(stream_id, ts_t{msg->ts()}, sensor_ts.at(i),
+                     vector_from_fb_vector(msg->buffer()));
+    }
+}
+
+ChunkBuilder::ChunkBuilder(uint32_t capacity) : fbb_{capacity} {}
+
 void ChunkBuilder::save_message(const uint32_t stream_id, const ts_t receive_ts,
                                 const ts_t /*sensor_ts*/,
                                 const std::vector<uint8_t>& msg_buf) {
@@ -381,9 +662,16 @@ void ChunkBuilder::update_start_end(const ts_t ts) {
 }
 
 std::vector<uint8_t> ChunkBuilder::finish() {
+    const uint32_t size = finish_in_place();
+    if (size == 0) return {};
+    const uint8_t* buf = data();
+    return {buf, buf + size};
+}
+
+uint32_t ChunkBuilder::finish_in_place() {
     if (messages_.empty()) {
         finished_ = true;
-        return {};
+        return 0;
     }
 
     if (!finished_) {
@@ -392,12 +680,11 @@ std::vector<uint8_t> ChunkBuilder::finish() {
         finished_ = true;
     }
 
-    const uint8_t* buf = fbb_.GetBufferPointer();
-    uint32_t size = fbb_.GetSize();
-
-    return {buf, buf + size};
+    return fbb_.GetSize();
 }
 
+const uint8_t* ChunkBuilder::data() const { return fbb_.GetBufferPointer(); }
+
 // ================================================================
 
 }  // namespace osf
@@ -0,0 +1,118 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/osf/zstd_lidarscan_encoder.h"
+
+#include <cstring>
+
+#include "ouster/impl/logging.h"
+#include "zstd_tools.h"
+
+using namespace ouster::sensor;
+
+namespace ouster {
+namespace osf {
+
+bool ZstdLidarScanEncoder::fieldEncode(const LidarScan& lidar_scan,
+                                       const ouster::FieldType& field_type,
+                                       const std::vector<int>& px_offset,
+                                       ScanData& scan_data,
+                                       size_t scan_idx) const {
+    if (scan_idx >= scan_data.size()) {
+        throw std::invalid_argument(
+            "ERROR: scan_data size is not sufficient to hold idx: " +
+            std::to_string(scan_idx));
+    }
+    bool res = true;
+    switch (field_type.element_type) {
+        case sensor::ChanFieldType::UINT8:
+            res = encodeZstdImage<uint8_t>(
+                scan_data[scan_idx], lidar_scan.field<uint8_t>(field_type.name),
+                px_offset, compression_level_);
+            break;
+        case sensor::ChanFieldType::UINT16:
+            res = encodeZstdImage<uint16_t>(
+                scan_data[scan_idx],
+                lidar_scan.field<uint16_t>(field_type.name), px_offset,
+                compression_level_);
+            break;
+        case sensor::ChanFieldType::UINT32:
+            res = encodeZstdImage<uint32_t>(
+                scan_data[scan_idx],
+                lidar_scan.field<uint32_t>(field_type.name), px_offset,
+                compression_level_);
+            break;
+        case sensor::ChanFieldType::UINT64:
+            res = encodeZstdImage<uint64_t>(
+                scan_data[scan_idx],
+                lidar_scan.field<uint64_t>(field_type.name), px_offset,
+                compression_level_);
+            break;
+        default:
+            logger().error(
+                "ERROR: fieldEncode: UNKNOWN:"
+                "ChanFieldType not yet "
+                "implemented");
+            break;
+    }
+    if (res) {
+        logger().error("ERROR: fieldEncode: Can't encode field {}",
+                       field_type.name);
+    }
+    return res;
+}
+
+ScanChannelData ZstdLidarScanEncoder::encodeField(
+    const ouster::Field& field) const {
+    ScanChannelData buffer;
+
+    // stored as is, like the PNG encoder does, so that decoding 1d fields
+    // doesn't depend on the encoder
+    if (field.shape().size() == 1) {
+        buffer.resize(field.bytes());
+        std::memcpy(buffer.data(), field, field.bytes());
+        return buffer;
+    }
+
+    // empty case
+    if (field.bytes() == 0) {
+        return buffer;
+    }
+
+    FieldView view = uint_view(field);
+    // collapse shape
+    if (view.shape().size() > 2) {
+        size_t rows = view.shape()[0];
+        size_t cols = view.size() / rows;
+        view = view.reshape(rows, cols);
+    }
+
+    bool res = true;
+    switch (view.tag()) {
+        case sensor::ChanFieldType::UINT8:
+            res = encodeZstdImage<uint8_t>(buffer, view, compression_level_);
+            break;
+        case sensor::ChanFieldType::UINT16:
+            res = encodeZstdImage<uint16_t>(buffer, view, compression_level_);
+            break;
+        case sensor::ChanFieldType::UINT32:
+            res = encodeZstdImage<uint32_t>(buffer, view, compression_level_);
+            break;
+        case sensor::ChanFieldType::UINT64:
+            res = encodeZstdImage<uint64_t>(buffer, view, compression_level_);
+            break;
+        default:
+            break;
+    }
+
+    if (res) {
+        throw std::runtime_error("encodeField: could not encode field");
+    }
+
+    return buffer;
+}
+
+}  // namespace osf
+}  // namespace ouster
@@ -0,0 +1,302 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "zstd_tools.h"
+
+#include <zstd.h>
+
+#include <cstring>
+#include <memory>
+
+#include "ouster/impl/logging.h"
+
+using namespace ouster::sensor;
+
+namespace ouster {
+namespace osf {
+
+namespace {
+
+// ZSTD_MAGICNUMBER, little endian
+constexpr uint8_t zstd_frame_magic[4] = {0x28, 0xB5, 0x2F, 0xFD};
+
+struct ZstdCCtxDeleter {
+    void operator()(ZSTD_CCtx* ctx) const { ZSTD_freeCCtx(ctx); }
+};
+
+struct ZstdDCtxDeleter {
+    void operator()(ZSTD_DCtx* ctx) const { ZSTD_freeDCtx(ctx); }
+};
+
+// Contexts and the byte plane buffer are reused by each encoding thread
+ZSTD_CCtx* compression_context() {
+    thread_local std::unique_ptr<ZSTD_CCtx, ZstdCCtxDeleter> ctx{
+        ZSTD_createCCtx()};
+    return ctx.get();
+}
+
+ZSTD_DCtx* decompression_context() {
+    thread_local std::unique_ptr<ZSTD_DCtx, ZstdDCtxDeleter> ctx{
+        ZSTD_createDCtx()};
+    return ctx.get();
+}
+
+std::vector<uint8_t>& planes_buffer(size_t size) {
+    thread_local std::vector<uint8_t> planes;
+    planes.resize(size);
+    return planes;
+}
+
+// Column j of encoded row u is column (j + start) % w of img, which
+// destaggers the row when start is the inverse of its destagger offset
+size_t row_start(const std::vector<int>* px_offset, size_t u, size_t w) {
+    if (!px_offset || w == 0) return 0;
+    return (w - impl::destagger_offset(*px_offset, u, w, false)) % w;
+}
+
+template <typename T>
+void delta_shuffle(const Eigen::Ref<const img_t<T>>& img,
+                   const std::vector<int>* px_offset, uint8_t* planes) {
+    const size_t h = img.rows();
+    const size_t w = img.cols();
+    const size_t n = h * w;
+    for (size_t u = 0; u < h; u++) {
+        const T* row = img.data() + u * img.outerStride();
+        size_t s = row_start(px_offset, u, w);
+        T prev = 0;
+        for (size_t j = 0; j < w; j++) {
+            const T x = row[s];
+            if (++s == w) s = 0;
+            const T d = static_cast<T>(x - prev);
+            prev = x;
+            const size_t i = u * w + j;
+            for (size_t b = 0; b < sizeof(T); b++) {
+                planes[b * n + i] = static_cast<uint8_t>(d >> (8 * b));
+            }
+        }
+    }
+}
+
+template <typename T>
+void unshuffle_undelta(const uint8_t* planes, Eigen::Ref<img_t<T>> img) {
+    const size_t h = img.rows();
+    const size_t w = img.cols();
+    const size_t n = h * w;
+    for (size_t u = 0; u < h; u++) {
+        T* row = img.data() + u * img.outerStride();
+        T prev = 0;
+        for (size_t j = 0; j < w; j++) {
+            const size_t i = u * w + j;
+            T d = 0;
+            for (size_t b = 0; b < sizeof(T); b++) {
+                d |= static_cast<T>(static_cast<T>(planes[b * n + i])
+                                    << (8 * b));
+            }
+            prev = static_cast<T>(prev + d);
+            row[j] = prev;
+        }
+    }
+}
+
+template <typename T>
+bool encode(ScanChannelData& res_buf, const Eigen::Ref<const img_t<T>>& img,
+            const std::vector<int>* px_offset, int compression_level) {
+    if (px_offset && px_offset->size() != static_cast<size_t>(img.rows())) {
+        logger().error("ERROR: encodeZstdImage: image height {} does not "
+                       "match shifts size {}",
+                       img.rows(), px_offset->size());
+        return true;
+    }
+    const size_t bytes = img.size() * sizeof(T);
+    auto& planes = planes_buffer(bytes);
+    delta_shuffle<T>(img, px_offset, planes.data());
+
+    res_buf.resize(ZSTD_compressBound(bytes));
+    const size_t size =
+        ZSTD_compressCCtx(compression_context(), res_buf.data(),
+                          res_buf.size(), planes.data(), bytes,
+                          compression_level);
+    if (ZSTD_isError(size)) {
+        logger().error("ERROR: encodeZstdImage: {}", ZSTD_getErrorName(size));
+        return true;
+    }
+    res_buf.resize(size);
+    return false;  // SUCCESS
+}
+
+}  // namespace
+
+bool is_zstd_buffer(const ScanChannelData& channel_buf) {
+    return channel_buf.size() >= sizeof(zstd_frame_magic) &&
+           std::memcmp(channel_buf.data(), zstd_frame_magic,
+                       sizeof(zstd_frame_magic)) == 0;
+}
+
+bool zstdCompress(std::vector<uint8_t>& res_buf, const uint8_t* data,
+                  size_t size, int compression_level) {
+    res_buf.resize(ZSTD_compressBound(size));
+    const size_t res_size =
+        ZSTD_compressCCtx(compression_context(), res_buf.data(),
+                          res_buf.size(), data, size, compression_level);
+    if (ZSTD_isError(res_size)) {
+        logger().error("ERROR: zstdCompress: {}", ZSTD_getErrorName(res_size));
+        return true;
+    }
+    res_buf.resize(res_size);
+    return false;  // SUCCESS
+}
+
+bool zstdDecompress(std::vector<uint8_t>& res_buf, const uint8_t* data,
+                    size_t size) {
+    const unsigned long long content_size =
+        ZSTD_getFrameContentSize(data, size);
+    if (content_size == ZSTD_CONTENTSIZE_ERROR ||
+        content_size == ZSTD_CONTENTSIZE_UNKNOWN) {
+        logger().error("ERROR: zstdDecompress: not a zstd frame");
+        return true;
+    }
+    res_buf.resize(content_size);
+    const size_t res_size = ZSTD_decompressDCtx(
+        decompression_context(), res_buf.data(), res_buf.size(), data, size);
+    if (ZSTD_isError(res_size) || res_size != content_size) {
+        logger().error("ERROR: zstdDecompress: {}",
+                       ZSTD_isError(res_size) ? ZSTD_getErrorName(res_size)
+                                              : "truncated buffer");
+        return true;
+    }
+    return false;  // SUCCESS
+}
+
+template <typename T>
+bool encodeZstdImage(ScanChannelData& res_buf,
+                     const Eigen::Ref<const img_t<T>>& img,
+                     int compression_level) {
+    return encode<T>(res_buf, img, nullptr, compression_level);
+}
+
+template <typename T>
+bool encodeZstdImage(ScanChannelData& res_buf,
+                     const Eigen::Ref<const img_t<T>>& img,
+                     const std::vector<int>& px_offset, int compression_level) {
+    return encode<T>(res_buf, img, &px_offset, compression_level);
+}
+
+template <typename T>
+bool decodeZstdImage(Eigen::Ref<img_t<T>> img,
+                     const ScanChannelData& channel_buf) {
+    const size_t bytes = img.size() * sizeof(T);
+    const unsigned long long content_size =
+        ZSTD_getFrameContentSize(channel_buf.data(), channel_buf.size());
+    if (content_size != bytes) {
+        logger().error(
+            "ERROR: decodeZstdImage: encoded size doesn't match the image");
+        return true;
+    }
+    auto& planes = planes_buffer(bytes);
+    const size_t size =
+        ZSTD_decompressDCtx(decompression_context(), planes.data(), bytes,
+                            channel_buf.data(), channel_buf.size());
+    if (ZSTD_isError(size) || size != bytes) {
+        logger().error("ERROR: decodeZstdImage: {}",
+                       ZSTD_isError(size) ? ZSTD_getErrorName(size)
+                                          : "truncated buffer");
+        return true;
+    }
+    unshuffle_undelta<T>(planes.data(), img);
+    return false;  // SUCCESS
+}
+
+template <typename T>
+bool decodeZstdImage(Eigen::Ref<img_t<T>> img,
+                     const ScanChannelData& channel_buf,
+                     const std::vector<int>& px_offset) {
+    if (px_offset.size() != static_cast<size_t>(img.rows())) {
+        logger().error("ERROR: decodeZstdImage: image height {} does not "
+                       "match shifts size {}",
+                       img.rows(), px_offset.size());
+        return true;
+    }
+    if (!decodeZstdImage<T>(img, channel_buf)) {
+        stagger_in_place<T>(img, px_offset);
+        return false;  // SUCCESS
+    }
+    return true;  // ERROR
+}
+
+bool zstdFieldDecode(LidarScan& lidar_scan, const ScanChannelData& channel_buf,
+                     const ouster::FieldType& field_type,
+                     const std::vector<int>& px_offset) {
+    switch (field_type.element_type) {
+        case sensor::ChanFieldType::UINT8:
+            return decodeZstdImage<uint8_t>(
+                lidar_scan.field<uint8_t>(field_type.name), channel_buf,
+                px_offset);
+        case sensor::ChanFieldType::UINT16:
+            return decodeZstdImage<uint16_t>(
+                lidar_scan.field<uint16_t>(field_type.name), channel_buf,
+                px_offset);
+        case sensor::ChanFieldType::UINT32:
+            return decodeZstdImage<uint32_t>(
+                lidar_scan.field<uint32_t>(field_type.name), channel_buf,
+                px_offset);
+        case sensor::ChanFieldType::UINT64:
+            return decodeZstdImage<uint64_t>(
+                lidar_scan.field<uint64_t>(field_type.name), channel_buf,
+                px_offset);
+        default:
+            logger().error(
+                "ERROR: zstdFieldDecode: UNKNOWN:"
+                "ChanFieldType not yet "
+                "implemented");
+            return true;
+    }
+}
+
+template bool encodeZstdImage<uint8_t>(ScanChannelData&,
+                                    const Eigen::Ref<const img_t<uint8_t>>&, int);
+template bool encodeZstdImage<uint16_t>(ScanChannelData&,
+                                    const Eigen::Ref<const img_t<uint16_t>>&, int);
+template bool encodeZstdImage<uint32_t>(ScanChannelData&,
+                                    const Eigen::Ref<const img_t<uint32_t>>&, int);
+template bool encodeZstdImage<uint64_t>(ScanChannelData&,
+                                    const Eigen::Ref<const img_t<uint64_t>>&, int);
+
+template bool encodeZstdImage<uint8_t>(ScanChannelData&,
+                                    const Eigen::Ref<const img_t<uint8_t>>&,
+                                    const std::vector<int>&, int);
+template bool encodeZstdImage<uint16_t>(ScanChannelData&,
+                                    const Eigen::Ref<const img_t<uint16_t>>&,
+                                    const std::vector<int>&, int);
+template bool encodeZstdImage<uint32_t>(ScanChannelData&,
+                                    const Eigen::Ref<const img_t<uint32_t>>&,
+                                    const std::vector<int>&, int);
+template bool encodeZstdImage<uint64_t>(ScanChannelData&,
+                                    const Eigen::Ref<const img_t<uint64_t>>&,
+                                    const std::vector<int>&, int);
+
+template bool decodeZstdImage<uint8_t>(Eigen::Ref<img_t<uint8_t>>,
+                                    const ScanChannelData&);
+template bool decodeZstdImage<uint16_t>(Eigen::Ref<img_t<uint16_t>>,
+                                    const ScanChannelData&);
+template bool decodeZstdImage<uint32_t>(Eigen::Ref<img_t<uint32_t>>,
+                                    const ScanChannelData&);
+template bool decodeZstdImage<uint64_t>(Eigen::Ref<img_t<uint64_t>>,
+                                    const ScanChannelData&);
+
+template bool decodeZstdImage<uint8_t>(Eigen::Ref<img_t<uint8_t>>,
+                                    const ScanChannelData&,
+                                    const std::vector<int>&);
+template bool decodeZstdImage<uint16_t>(Eigen::Ref<img_t<uint16_t>>,
+                                    const ScanChannelData&,
+                                    const std::vector<int>&);
+template bool decodeZstdImage<uint32_t>(Eigen::Ref<img_t<uint32_t>>,
+                                    const ScanChannelData&,
+                                    const std::vector<int>&);
+template bool decodeZstdImage<uint64_t>(Eigen::Ref<img_t<uint64_t>>,
+                                    const ScanChannelData&,
+                                    const std::vector<int>&);
+
+}  // namespace osf
+}  // namespace ouster
@@ -0,0 +1,140 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace osf {
+
+// Encoded single field buffer
+using ScanChannelData = std::vector<uint8_t>;
+
+/**
+ * Zstd encoding of 2D images, used by ZstdLidarScanEncoder.
+ *
+ * Before compression each row is delta filtered, i.e. every pixel is replaced
+ * by its (wrapping) difference to the pixel to the left, and the result is
+ * split into byte planes, all the least significant bytes first, so that the
+ * mostly zero high bytes of neighbouring pixels end up next to each other. The
+ * buffer is a single zstd frame; decoders tell it from PNG buffers by the
+ * zstd frame magic number.
+ */
+
+/**
+ * Check whether the buffer holds a zstd encoded image.
+ *
+ * @param[in] channel_buf The encoded buffer.
+ * @return true if the buffer starts with the zstd frame magic number.
+ */
+bool is_zstd_buffer(const ScanChannelData& channel_buf);
+
+/**
+ * Compress a buffer as it is into a single zstd frame, e.g. a raw packet.
+ *
+ * @param[out] res_buf The output buffer with a single zstd frame.
+ * @param[in] data The bytes to compress.
+ * @param[in] size The number of bytes at data.
+ * @param[in] compression_level The zstd compression level.
+ * @return false (0) if operation is successful, true (1) if error occured
+ */
+bool zstdCompress(std::vector<uint8_t>& res_buf, const uint8_t* data,
+                  size_t size, int compression_level);
+
+/**
+ * Decompress a single zstd frame written by zstdCompress.
+ *
+ * @param[out] res_buf The decompressed bytes.
+ * @param[in] data The zstd frame.
+ * @param[in] size The size of the frame.
+ * @return false (0) if operation is successful, true (1) if error occured
+ */
+bool zstdDecompress(std::vector<uint8_t>& res_buf, const uint8_t* data,
+                    size_t size);
+
+/**
+ * Encode an image with delta filtering, byte plane shuffling and zstd.
+ *
+ * @tparam T The type of the image pixels.
+ *
+ * @param[out] res_buf The output buffer with a single zstd frame.
+ * @param[in] img The image to encode.
+ * @param[in] compression_level The zstd compression level.
+ * @return false (0) if operation is successful, true (1) if error occured
+ */
+template <typename T>
+bool encodeZstdImage(ScanChannelData& res_buf,
+                     const Eigen::Ref<const img_t<T>>& img,
+                     int compression_level);
+
+/**
+ * Encode an image destaggered by px_offset, as stored for standard fields.
+ *
+ * @tparam T The type of the image pixels.
+ *
+ * @param[out] res_buf The output buffer with a single zstd frame.
+ * @param[in] img The staggered image to encode.
+ * @param[in] px_offset Pixel shift per row used to destagger img data.
+ * @param[in] compression_level The zstd compression level.
+ * @return false (0) if operation is successful, true (1) if error occured
+ */
+template <typename T>
+bool encodeZstdImage(ScanChannelData& res_buf,
+                     const Eigen::Ref<const img_t<T>>& img,
+                     const std::vector<int>& px_offset, int compression_level);
+
+/**
+ * Decode a buffer made by encodeZstdImage into img, which must have the
+ * shape of the encoded image.
+ *
+ * @tparam T The type of the image pixels.
+ *
+ * @param[out] img The output image.
+ * @param[in] channel_buf The encoded buffer.
+ * @return false (0) if operation is successful, true (1) if error occured
+ */
+template <typename T>
+bool decodeZstdImage(Eigen::Ref<img_t<T>> img,
+                     const ScanChannelData& channel_buf);
+
+/**
+ * Decode a buffer made by encodeZstdImage with px_offset, staggering the
+ * result back into img.
+ *
+ * @tparam T The type of the image pixels.
+ *
+ * @param[out] img The output image.
+ * @param[in] channel_buf The encoded buffer.
+ * @param[in] px_offset Pixel shift per row used to reconstruct staggered range
+ *                      image form.
+ * @return false (0) if operation is successful, true (1) if error occured
+ */
+template <typename T>
+bool decodeZstdImage(Eigen::Ref<img_t<T>> img,
+                     const ScanChannelData& channel_buf,
+                     const std::vector<int>& px_offset);
+
+/**
+ * Decode a single zstd encoded standard field to lidar_scan.
+ *
+ * @param[out] lidar_scan The output object that will be filled as a result of
+ *                        decoding.
+ * @param[in] channel_buf The encoded buffer.
+ * @param[in] field_type The field of `lidar_scan` to fill in with the decoded
+ *                       result.
+ * @param[in] px_offset Pixel shift per row used to reconstruct staggered range
+ *                      image form.
+ * @return false (0) if operation is successful true (1) if error occured
+ */
+bool zstdFieldDecode(LidarScan& lidar_scan, const ScanChannelData& channel_buf,
+                     const ouster::FieldType& field_type,
+                     const std::vector<int>& px_offset);
+
+}  // namespace osf
+}  // namespace ouster
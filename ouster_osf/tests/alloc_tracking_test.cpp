@@ -0,0 +1,58 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/alloc_tracking.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "common.h"
+#include "osf_test.h"
+#include "ouster/lidar_scan.h"
+#include "ouster/osf/async_writer.h"
+#include "ouster/types.h"
+
+namespace ouster {
+namespace osf {
+namespace {
+
+using ouster::alloc::AllocScope;
+using ouster::sensor::sensor_info;
+
+class AllocTrackingTest : public osf::OsfTestWithDataAndFiles {};
+
+TEST_F(AllocTrackingTest, AsyncWriterSaveReusesScanCopies) {
+#ifdef OUSTER_OSF_NO_THREADING
+    GTEST_SKIP() << "scans are encoded by the caller without threading";
+#endif
+    const sensor_info sinfo = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    std::string output_osf_filename = tmp_file("alloc_tracking.osf");
+    LidarScan ls = get_random_lidar_scan(sinfo);
+    size_t scan_bytes = 0;
+    for (const auto& kv : ls.fields()) scan_bytes += kv.second.bytes();
+
+    AsyncWriter writer(output_osf_filename, {sinfo}, {}, 0, nullptr, 2);
+    // the first saves allocate the copies reused by later ones
+    for (int i = 0; i < 4; i++) {
+        writer.save(0, ls, ts_t{i + 1}).get();
+    }
+
+    // what's left on the calling thread is queueing the encoding task, a
+    // fixed few small blocks per scan rather than a copy of it
+    const int saves = 8;
+    AllocScope scope("async_writer_save");
+    for (int i = 0; i < saves; i++) {
+        writer.save(0, ls, ts_t{i + 5}).get();
+    }
+    EXPECT_LT(scope.stats().bytes, saves * 1024u);
+    EXPECT_LT(scope.stats().bytes, scan_bytes);
+    writer.close();
+}
+
+}  // namespace
+}  // namespace osf
+}  // namespace ouster
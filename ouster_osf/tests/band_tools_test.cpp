@@ -0,0 +1,148 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "band_tools.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "common.h"
+#include "osf_test.h"
+#include "ouster/lidar_scan.h"
+#include "ouster/osf/banded_lidarscan_encoder.h"
+#include "ouster/osf/file.h"
+#include "ouster/osf/png_lidarscan_encoder.h"
+#include "ouster/osf/reader.h"
+#include "ouster/osf/stream_lidar_scan.h"
+#include "ouster/osf/writer.h"
+#include "ouster/osf/zstd_lidarscan_encoder.h"
+#include "ouster/types.h"
+#include "png_tools.h"
+
+namespace ouster {
+namespace osf {
+namespace {
+
+class OsfBandToolsTest : public OsfTestWithDataAndFiles {};
+
+using ouster::sensor::sensor_info;
+
+TEST_F(OsfBandToolsTest, FieldEncodeDecode) {
+    const sensor_info si = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    const LidarScan ls = get_random_lidar_scan(si);
+    const auto px_offset = si.format.pixel_shift_by_row;
+
+    // 128 rows make 3 bands of 48 rows, the last one shorter
+    for (auto inner : std::vector<std::shared_ptr<LidarScanEncoder>>{
+             std::make_shared<PngLidarScanEncoder>(
+                 DEFAULT_PNG_OSF_ZLIB_COMPRESSION_LEVEL),
+             std::make_shared<ZstdLidarScanEncoder>()}) {
+        BandedLidarScanEncoder encoder(inner, 48);
+        const auto field_types = ls.field_types();
+        LidarScan decoded(ls.w, ls.h, field_types.begin(), field_types.end());
+        ScanData scan_data(field_types.size());
+        size_t idx = 0;
+        for (const auto& ft : field_types) {
+            ASSERT_FALSE(
+                encoder.fieldEncode(ls, ft, px_offset, scan_data, idx));
+            EXPECT_TRUE(is_banded_buffer(scan_data[idx]));
+            ASSERT_FALSE(
+                fieldDecode(decoded, scan_data, idx, ft, px_offset));
+            EXPECT_TRUE(ls.field(ft.name) == decoded.field(ft.name));
+            idx++;
+        }
+    }
+}
+
+TEST_F(OsfBandToolsTest, CustomFieldEncodeDecode) {
+    auto test_field_encoding = [](const ouster::Field& f, bool banded) {
+        BandedLidarScanEncoder encoder(
+            std::make_shared<PngLidarScanEncoder>(
+                DEFAULT_PNG_OSF_ZLIB_COMPRESSION_LEVEL),
+            16);
+        ScanChannelData compressed;
+        EXPECT_NO_THROW({ compressed = encoder.encodeField(f); });
+        EXPECT_EQ(is_banded_buffer(compressed), banded);
+        Field decoded(f.desc());
+        EXPECT_NO_THROW({ decodeField(decoded, compressed); });
+        EXPECT_EQ(f, decoded);
+    };
+
+    std::mt19937 gen{3};
+    std::normal_distribution<float> nd_f{100.f, 10.f};
+    test_field_encoding(randomized_field<float>(gen, nd_f, {128, 64, 3}),
+                        true);
+    test_field_encoding(randomized_field<float>(gen, nd_f, {4096}), false);
+    std::uniform_int_distribution<uint16_t> ud_u16{0, 4096};
+    test_field_encoding(randomized_field<uint16_t>(gen, ud_u16, {37, 512}),
+                        true);
+    // a single band is stored as the inner encoder stores it
+    std::uniform_int_distribution<int> ud_u8{0, 255};
+    test_field_encoding(randomized_field<uint8_t>(gen, ud_u8, {16, 512}),
+                        false);
+}
+
+TEST_F(OsfBandToolsTest, RejectsBadBuffers) {
+    EXPECT_THROW(BandedLidarScanEncoder(nullptr), std::invalid_argument);
+    EXPECT_THROW(BandedLidarScanEncoder(
+                     std::make_shared<ZstdLidarScanEncoder>(), 0),
+                 std::invalid_argument);
+
+    BandedLidarScanEncoder encoder(std::make_shared<ZstdLidarScanEncoder>(),
+                                   8);
+    std::mt19937 gen{5};
+    std::uniform_int_distribution<uint16_t> ud_u16{0, 4096};
+    auto f = randomized_field<uint16_t>(gen, ud_u16, {32, 64});
+    ScanChannelData buffer = encoder.encodeField(f);
+    ASSERT_TRUE(is_banded_buffer(buffer));
+
+    img_t<uint16_t> img(32, 64);
+    EXPECT_FALSE(decodeBandedImage<uint16_t>(img, buffer, nullptr));
+
+    // bands not covering the image
+    img_t<uint16_t> taller(40, 64);
+    EXPECT_TRUE(decodeBandedImage<uint16_t>(taller, buffer, nullptr));
+
+    // band sizes not matching the buffer
+    ScanChannelData truncated(buffer.begin(), buffer.end() - 1);
+    EXPECT_TRUE(decodeBandedImage<uint16_t>(img, truncated, nullptr));
+
+    // corrupt first band, after the 12 byte header and the 4 band sizes
+    ScanChannelData corrupt = buffer;
+    corrupt[12 + 4 * 4] ^= 0xff;
+    Field decoded(f.desc());
+    EXPECT_ANY_THROW(decodeField(decoded, corrupt));
+}
+
+TEST_F(OsfBandToolsTest, ReadsBandedStreams) {
+    const sensor_info si = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    LidarScan ls = get_random_lidar_scan(si);
+    std::string output_osf_filename = tmp_file("banded_streams.osf");
+
+    auto encoder = std::make_shared<Encoder>(
+        std::make_shared<BandedLidarScanEncoder>(
+            std::make_shared<PngLidarScanEncoder>(
+                DEFAULT_PNG_OSF_ZLIB_COMPRESSION_LEVEL)));
+    {
+        Writer writer(output_osf_filename, {si}, {}, 0, encoder);
+        writer.save(0, ls, ts_t{1});
+        writer.close();
+    }
+
+    OsfFile osf_file(output_osf_filename);
+    Reader reader(osf_file);
+    auto msg_it = reader.messages().begin();
+    ASSERT_NE(msg_it, reader.messages().end());
+    auto ls_recovered = msg_it->decode_msg<LidarScanStream>();
+    ASSERT_TRUE(ls_recovered);
+    EXPECT_EQ(*ls_recovered, ls);
+}
+
+}  // namespace
+}  // namespace osf
+}  // namespace ouster
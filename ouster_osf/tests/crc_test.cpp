@@ -34,6 +34,28 @@ TEST_F(CrcTest, SmokeSanityCheckAltInit) {
     const uint32_t crc = osf::crc32(0L, data.data(), data.size());
     EXPECT_EQ(0x88aa689f, crc);
 }
+TEST_F(CrcTest, MatchesZlib) {
+    std::vector<uint8_t> data(70000);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<uint8_t>((i * 2654435761u) >> 13);
+    }
+    // sizes around the accelerated path and its 16 byte blocks, unaligned
+    for (uint32_t size : {0u, 1u, 15u, 63u, 64u, 255u, 256u, 257u, 1000u,
+                          4111u, 65536u, 69990u}) {
+        for (size_t offset : {0, 1, 7}) {
+            const uint8_t* buf = data.data() + offset;
+            EXPECT_EQ(osf::crc32(buf, size), crc32_z(0L, buf, size));
+            EXPECT_EQ(osf::crc32(0x12345678, buf, size),
+                      crc32_z(0x12345678, buf, size));
+        }
+    }
+
+    // appending matches a single pass
+    const uint32_t crc = osf::crc32(data.data(), 5000);
+    EXPECT_EQ(osf::crc32(crc, data.data() + 5000, 60000),
+              osf::crc32(data.data(), 65000));
+}
+
 }  // namespace
 }  // namespace osf
 }  // namespace ouster
@@ -7,6 +7,8 @@
 
 #include <gtest/gtest.h>
 
+#include <vector>
+
 #include "fb_utils.h"
 #include "osf_test.h"
 #include "ouster/osf/basics.h"
@@ -109,6 +111,54 @@ TEST_F(OsfFileTest, OpenOsfFileWithStandardRead) {
     EXPECT_TRUE(osf_file.valid());
 }
 
+TEST_F(OsfFileTest, OpenOsfFileWithPread) {
+    const std::string test_file_name =
+        path_concat(test_data_dir(), "osfs/OS-1-128_v2.3.0_1024x10_lb_n3.osf");
+    OsfFile stream_file(test_file_name, FileOptions{FileBackend::STREAM});
+    EXPECT_TRUE(stream_file);
+
+    // the smallest read ahead, so that reads span refills of the buffer
+    FileOptions options;
+    options.backend = FileBackend::PREAD;
+    options.read_ahead = 1;
+    options.sequential = false;
+    OsfFile osf_file(test_file_name, options);
+    EXPECT_TRUE(osf_file);
+    EXPECT_FALSE(osf_file.is_memory_mapped());
+    EXPECT_EQ(osf_file.options().backend, FileBackend::PREAD);
+    EXPECT_EQ(osf_file.options().read_ahead, 4096u);
+    EXPECT_EQ(osf_file.version(), OSF_VERSION::V_2_1);
+    EXPECT_EQ(osf_file.metadata_offset(), 1015824);
+    EXPECT_TRUE(osf_file.valid());
+
+    for (uint64_t offset : {0, 4000, 4096, 100000, 1015000}) {
+        for (uint64_t count : {1, 100, 5000, 10000}) {
+            std::vector<uint8_t> expected(count), buf(count);
+            stream_file.seek(offset).read(expected.data(), count);
+            osf_file.seek(offset).read(buf.data(), count);
+            EXPECT_EQ(osf_file.offset(), offset + count);
+            EXPECT_EQ(buf, expected);
+        }
+    }
+    EXPECT_EQ(*osf_file.read_chunk(1015824), *stream_file.read_chunk(1015824));
+    uint8_t past_end[100];
+    EXPECT_THROW(osf_file.seek(1025700).read(past_end, 100), std::out_of_range);
+
+    OsfFile moved(std::move(osf_file));
+    EXPECT_FALSE(osf_file);
+    EXPECT_TRUE(moved.valid());
+    moved.close();
+    EXPECT_FALSE(moved);
+}
+
+TEST_F(OsfFileTest, OpenOsfFileOverHttpFailure) {
+    // http(s) URLs are read with range requests by default
+    OsfFile osf_file("http://127.0.0.1:1/no_server.osf");
+    EXPECT_FALSE(osf_file);
+    EXPECT_EQ(osf_file.options().backend, FileBackend::HTTP);
+    EXPECT_EQ(osf_file.options().read_ahead, 4u << 20);
+}
+
 TEST_F(OsfFileTest, OpenOsfFileHandleNonExistent) {
     const std::string test_file_name =
         path_concat(test_data_dir(), "non-file-thing");
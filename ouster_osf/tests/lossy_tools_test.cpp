@@ -0,0 +1,127 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "lossy_tools.h"
+
+#include <gtest/gtest.h>
+
+#include "common.h"
+#include "osf_test.h"
+#include "ouster/lidar_scan.h"
+#include "ouster/osf/file.h"
+#include "ouster/osf/lossy_lidarscan_encoder.h"
+#include "ouster/osf/png_lidarscan_encoder.h"
+#include "ouster/osf/reader.h"
+#include "ouster/osf/stream_lidar_scan.h"
+#include "ouster/osf/writer.h"
+#include "ouster/osf/zstd_lidarscan_encoder.h"
+#include "ouster/types.h"
+#include "png_tools.h"
+
+namespace ouster {
+namespace osf {
+namespace {
+
+class OsfLossyToolsTest : public OsfTestWithDataAndFiles {};
+
+using ouster::sensor::sensor_info;
+
+// every pixel of the lossy fields within max_error, the others equal
+void expect_within(const LidarScan& ls, const LidarScan& decoded,
+                   uint32_t max_error) {
+    for (const auto& ft : ls.field_types()) {
+        if (ft.name != sensor::ChanField::RANGE &&
+            ft.name != sensor::ChanField::RANGE2) {
+            EXPECT_TRUE(ls.field(ft.name) == decoded.field(ft.name));
+            continue;
+        }
+        const auto a = ls.field<uint32_t>(ft.name);
+        const auto b = decoded.field<uint32_t>(ft.name);
+        const img_t<int64_t> diff = a.template cast<int64_t>() -
+                                    b.template cast<int64_t>();
+        EXPECT_LE(diff.abs().maxCoeff(), int64_t{max_error}) << ft.name;
+        EXPECT_TRUE(((a == 0) == (b == 0)).all()) << ft.name;
+    }
+}
+
+TEST_F(OsfLossyToolsTest, FieldEncodeDecode) {
+    const sensor_info si = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    const auto px_offset = si.format.pixel_shift_by_row;
+    LidarScan ls = get_random_lidar_scan(si);
+
+    for (uint32_t max_error : {0u, 5u, 50u}) {
+        LossyLidarScanEncoder encoder(
+            std::make_shared<ZstdLidarScanEncoder>(),
+            {{sensor::ChanField::RANGE, max_error},
+             {sensor::ChanField::RANGE2, max_error}});
+        const auto field_types = ls.field_types();
+        LidarScan decoded(ls.w, ls.h, field_types.begin(), field_types.end());
+        ScanData scan_data(field_types.size());
+        size_t idx = 0;
+        for (const auto& ft : field_types) {
+            ASSERT_FALSE(
+                encoder.fieldEncode(ls, ft, px_offset, scan_data, idx));
+            const bool lossy = ft.name == sensor::ChanField::RANGE ||
+                               ft.name == sensor::ChanField::RANGE2;
+            EXPECT_EQ(is_lossy_buffer(scan_data[idx]), lossy) << ft.name;
+            ASSERT_FALSE(fieldDecode(decoded, scan_data, idx, ft, px_offset));
+            idx++;
+        }
+        expect_within(ls, decoded, max_error);
+    }
+}
+
+TEST_F(OsfLossyToolsTest, RejectsBadBuffers) {
+    EXPECT_THROW(LossyLidarScanEncoder(nullptr), std::invalid_argument);
+
+    img_t<uint32_t> img = img_t<uint32_t>::Zero(16, 32);
+    img(3, 4) = 1000;
+    const std::vector<uint8_t> encoded = encode_lossy<uint32_t>(img, 5);
+    const ScanChannelData buffer(encoded.begin(), encoded.end());
+    ASSERT_TRUE(is_lossy_buffer(buffer));
+
+    img_t<uint32_t> out(16, 32);
+    EXPECT_FALSE(decodeLossyImage<uint32_t>(out, buffer, nullptr));
+    EXPECT_NEAR(out(3, 4), 1000, 5);
+    EXPECT_EQ(out.sum(), out(3, 4));
+
+    img_t<uint32_t> smaller(4, 32);
+    EXPECT_TRUE(decodeLossyImage<uint32_t>(smaller, buffer, nullptr));
+    ScanChannelData truncated(buffer.begin(), buffer.begin() + 24);
+    EXPECT_TRUE(decodeLossyImage<uint32_t>(out, truncated, nullptr));
+    // the shifts must match the rows of the image
+    const std::vector<int> px_offset(4, 0);
+    EXPECT_TRUE(decodeLossyImage<uint32_t>(out, buffer, &px_offset));
+}
+
+TEST_F(OsfLossyToolsTest, ReadsLossyStreams) {
+    const sensor_info si = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    LidarScan ls = get_random_lidar_scan(si);
+    std::string output_osf_filename = tmp_file("lossy_streams.osf");
+
+    auto encoder = std::make_shared<Encoder>(
+        std::make_shared<LossyLidarScanEncoder>(
+            std::make_shared<PngLidarScanEncoder>(
+                DEFAULT_PNG_OSF_ZLIB_COMPRESSION_LEVEL)));
+    {
+        Writer writer(output_osf_filename, {si}, {}, 0, encoder);
+        writer.save(0, ls, ts_t{1});
+        writer.close();
+    }
+
+    OsfFile osf_file(output_osf_filename);
+    Reader reader(osf_file);
+    auto msg_it = reader.messages().begin();
+    ASSERT_NE(msg_it, reader.messages().end());
+    auto ls_recovered = msg_it->decode_msg<LidarScanStream>();
+    ASSERT_TRUE(ls_recovered);
+    expect_within(ls, *ls_recovered, DEFAULT_LOSSY_RANGE_ERROR);
+}
+
+}  // namespace
+}  // namespace osf
+}  // namespace ouster
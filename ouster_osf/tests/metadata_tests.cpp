@@ -56,6 +56,31 @@ TEST_F(MetadataTest, MiscMetadataEntryTests) {
               " buffer = {MetadataEntry: 01 02 03 04 05}]");
 }
 
+TEST_F(MetadataTest, LidarSensorBinaryInfo) {
+    sensor::sensor_info info = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    info.extrinsic = mat4d::Identity();
+    info.extrinsic(2, 3) = 0.25;
+    const LidarSensor sensor(info);
+
+    // the sensor_info comes from the binary encoding, the json is kept as is
+    auto entry = LidarSensor::from_buffer(sensor.buffer());
+    ASSERT_TRUE(entry);
+    const auto& restored = dynamic_cast<const LidarSensor&>(*entry);
+    EXPECT_EQ(restored.info(), info);
+    EXPECT_EQ(restored.metadata(), sensor.metadata());
+
+    // entries of older versions only have the json
+    flatbuffers::FlatBufferBuilder fbb;
+    fbb.FinishSizePrefixed(
+        gen::CreateLidarSensorDirect(fbb, sensor.metadata().c_str()),
+        gen::LidarSensorIdentifier());
+    entry = LidarSensor::from_buffer(
+        {fbb.GetBufferPointer(), fbb.GetBufferPointer() + fbb.GetSize()});
+    ASSERT_TRUE(entry);
+    EXPECT_EQ(dynamic_cast<const LidarSensor&>(*entry).info(), info);
+}
+
 }  // namespace
 }  // namespace osf
 }  // namespace ouster
@@ -18,14 +18,22 @@
 #include <set>
 #include <sstream>
 
+#include "common.h"
 #include "fb_utils.h"
 #include "osf_test.h"
 #include "ouster/osf/basics.h"
 #include "ouster/osf/crc32.h"
 #include "ouster/osf/file.h"
 #include "ouster/osf/meta_lidar_sensor.h"
+#include "ouster/osf/meta_streaming_info.h"
+#include "ouster/osf/osf_encoder.h"
+#include "ouster/osf/png_lidarscan_encoder.h"
 #include "ouster/osf/reader.h"
 #include "ouster/osf/stream_lidar_scan.h"
+#include "ouster/osf/thread_pool.h"
+#include "ouster/osf/writer.h"
+#include "ouster/osf/zstd_lidarscan_encoder.h"
+#include "ouster/pcap.h"
 
 namespace ouster {
 namespace osf {
@@ -406,6 +414,473 @@ TEST_F(OperationsTest, MetadataRewriteTestPreExisting) {
     unlink_path(temp_file);
 }
 
+TEST_F(OperationsTest, RecoverFromCheckpoint) {
+    const sensor::sensor_info sinfo = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    std::string osf_file_name = tmp_file("recover_source.osf");
+    std::string crashed_file_name = tmp_file("recover_crashed.osf");
+    std::string unchecked_file_name = tmp_file("recover_unchecked.osf");
+
+    std::vector<LidarScan> saved;
+    {
+        // a chunk per scan and a checkpoint every 2 chunks
+        Writer writer(osf_file_name, sinfo, {}, 1);
+        writer.set_checkpoint_interval(2);
+        for (int i = 0; i < 7; i++) {
+            saved.push_back(get_random_lidar_scan(sinfo));
+            writer.save(0, saved.back(), ts_t{i + 1});
+        }
+
+        // copy the file as a crash would leave it, with chunks 1 to 6 and
+        // checkpoints after 0, 2 and 4 chunks, tearing the last chunk
+        std::ifstream in(osf_file_name, std::ios::binary);
+        std::vector<char> bytes((std::istreambuf_iterator<char>(in)),
+                                std::istreambuf_iterator<char>());
+        bytes.resize(bytes.size() - 10);
+        std::ofstream(crashed_file_name, std::ios::binary)
+            .write(bytes.data(), bytes.size());
+    }
+
+    const int64_t recovered_size = recover_osf_file(crashed_file_name);
+    EXPECT_EQ(recovered_size, file_size(crashed_file_name));
+
+    // the chunks of the last checkpoint and the intact one after it
+    Reader reader(crashed_file_name);
+    size_t cnt = 0;
+    for (const auto msg : reader.messages()) {
+        auto ls_recovered = msg.decode_msg<LidarScanStream>();
+        ASSERT_TRUE(ls_recovered);
+        EXPECT_EQ(*ls_recovered, saved.at(cnt));
+        cnt++;
+    }
+    EXPECT_EQ(cnt, 5u);
+    auto streaming_info = reader.meta_store().get<StreamingInfo>();
+    ASSERT_TRUE(streaming_info);
+    EXPECT_EQ(streaming_info->chunks_info().size(), 5u);
+    ASSERT_EQ(streaming_info->stream_stats().size(), 1u);
+    const auto& stats = streaming_info->stream_stats().begin()->second;
+    EXPECT_EQ(stats.message_count, 5u);
+    EXPECT_EQ(stats.end_ts, ts_t{5});
+    EXPECT_EQ(stats.sensor_timestamps.back(),
+              saved[4].get_first_valid_column_timestamp());
+
+    // finished files are left as they are
+    EXPECT_EQ(recover_osf_file(crashed_file_name), recovered_size);
+
+    // without checkpoints there is no metadata to recover
+    start_osf_file(unchecked_file_name);
+    EXPECT_EQ(recover_osf_file(unchecked_file_name), -1);
+}
+
+// The chunks of an OSF file as they are stored, without their CRCs
+std::vector<std::vector<uint8_t>> read_osf_chunks(const std::string& file) {
+    OsfFile osf_file(file);
+    Reader reader(file);
+    std::vector<std::vector<uint8_t>> chunks;
+    for (const auto& chunk : reader.chunks()) {
+        auto buf =
+            osf_file.read_chunk(osf_file.chunks_offset() + chunk.offset());
+        chunks.emplace_back(buf->begin(), buf->end() - CRC_BYTES_SIZE);
+    }
+    return chunks;
+}
+
+TEST_F(OperationsTest, SliceCopiesChunksAsTheyAre) {
+    const sensor::sensor_info sinfo = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    std::string osf_file_name = tmp_file("slice_source.osf");
+    std::string slice_file_name = tmp_file("slice_output.osf");
+
+    auto encoder =
+        std::make_shared<Encoder>(std::make_shared<PngLidarScanEncoder>(1));
+    encoder->set_keyframe_interval(2);
+    std::vector<LidarScan> saved;
+    {
+        // chunks of a keyframe and a delta frame: {1, 2}, {3, 4}, ...
+        Writer writer(osf_file_name, sinfo, {}, 1, encoder);
+        for (int i = 0; i < 10; i++) {
+            saved.push_back(get_random_lidar_scan(sinfo));
+            writer.save(0, saved.back(), ts_t{i + 1});
+        }
+    }
+
+    EXPECT_EQ(slice_osf_file(osf_file_name, slice_file_name, ts_t{4},
+                             ts_t{7}),
+              file_size(slice_file_name));
+
+    // the delta frame 4 comes with its keyframe 3
+    Reader reader(slice_file_name);
+    EXPECT_EQ(reader.metadata_id(), Reader(osf_file_name).metadata_id());
+    std::vector<int64_t> timestamps;
+    for (const auto msg : reader.messages()) {
+        auto ls_recovered = msg.decode_msg<LidarScanStream>();
+        ASSERT_TRUE(ls_recovered);
+        EXPECT_EQ(*ls_recovered,
+                  saved.at(static_cast<size_t>(msg.ts().count() - 1)));
+        timestamps.push_back(msg.ts().count());
+    }
+    EXPECT_EQ(timestamps, (std::vector<int64_t>{3, 4, 5, 6, 7}));
+
+    // {5, 6} is copied as it is, between the messages of the boundaries
+    auto source_chunks = read_osf_chunks(osf_file_name);
+    auto slice_chunks = read_osf_chunks(slice_file_name);
+    ASSERT_EQ(slice_chunks.size(), 3u);
+    EXPECT_EQ(slice_chunks[1], source_chunks[2]);
+
+    auto streaming_info = reader.meta_store().get<StreamingInfo>();
+    ASSERT_TRUE(streaming_info);
+    ASSERT_EQ(streaming_info->stream_stats().size(), 1u);
+    const auto& stats = streaming_info->stream_stats().begin()->second;
+    EXPECT_EQ(stats.message_count, 5u);
+    EXPECT_EQ(stats.start_ts, ts_t{3});
+    EXPECT_EQ(stats.end_ts, ts_t{7});
+    EXPECT_EQ(stats.sensor_timestamps.front(),
+              saved[2].get_first_valid_column_timestamp());
+
+    // other streams than the selected ones aren't copied
+    const uint32_t stream_id = streaming_info->stream_stats().begin()->first;
+    slice_osf_file(osf_file_name, slice_file_name, ts_t{0}, ts_t{10},
+                   {stream_id + 100});
+    Reader empty_reader(slice_file_name);
+    EXPECT_TRUE(empty_reader.messages().begin() ==
+                empty_reader.messages().end());
+}
+
+TEST_F(OperationsTest, MergeSplitRecording) {
+    const sensor::sensor_info sinfo = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    std::vector<std::string> file_names{tmp_file("merge_part_2.osf"),
+                                        tmp_file("merge_part_1.osf")};
+    std::string merged_file_name = tmp_file("merge_output.osf");
+
+    std::vector<LidarScan> saved;
+    for (int part = 1; part >= 0; part--) {
+        Writer writer(file_names[part], sinfo, {}, 1);
+        for (int i = 0; i < 3; i++) {
+            saved.push_back(get_random_lidar_scan(sinfo));
+            writer.save(0, saved.back(),
+                        ts_t{static_cast<int64_t>(saved.size())});
+        }
+    }
+
+    EXPECT_EQ(merge_osf_files(file_names, merged_file_name),
+              file_size(merged_file_name));
+
+    // all chunks are copied as they are, in order of time
+    auto merged_chunks = read_osf_chunks(merged_file_name);
+    auto chunks = read_osf_chunks(file_names[1]);
+    auto part_2_chunks = read_osf_chunks(file_names[0]);
+    chunks.insert(chunks.end(), part_2_chunks.begin(), part_2_chunks.end());
+    EXPECT_EQ(merged_chunks, chunks);
+
+    Reader reader(merged_file_name);
+    size_t cnt = 0;
+    for (const auto msg : reader.messages()) {
+        auto ls_recovered = msg.decode_msg<LidarScanStream>();
+        ASSERT_TRUE(ls_recovered);
+        EXPECT_EQ(*ls_recovered, saved.at(cnt));
+        cnt++;
+    }
+    EXPECT_EQ(cnt, 6u);
+    auto streaming_info = reader.meta_store().get<StreamingInfo>();
+    ASSERT_TRUE(streaming_info);
+    EXPECT_EQ(streaming_info->chunks_info().size(), 6u);
+}
+
+TEST_F(OperationsTest, TranscodeDropsFieldsAndChangesEncoder) {
+    const sensor::sensor_info sinfo = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    std::string osf_file_name = tmp_file("transcode_source.osf");
+    std::string transcoded_file_name = tmp_file("transcode_output.osf");
+
+    std::vector<LidarScan> saved;
+    {
+        Writer writer(osf_file_name, sinfo, {}, 1);
+        for (int i = 0; i < 7; i++) {
+            saved.push_back(get_random_lidar_scan(sinfo));
+            writer.save(0, saved.back(), ts_t{i + 1});
+        }
+    }
+
+    TranscodeOptions options;
+    options.fields = {ChanField::RANGE};
+    options.encoder = std::make_shared<Encoder>(
+        std::make_shared<ZstdLidarScanEncoder>(),
+        std::make_shared<ThreadPool>(3));
+    options.max_in_flight = 2;
+    EXPECT_EQ(
+        transcode_osf_file(osf_file_name, transcoded_file_name, options),
+        file_size(transcoded_file_name));
+
+    // the scans keep their order and timestamps
+    Reader reader(transcoded_file_name);
+    ASSERT_EQ(reader.meta_store().find<LidarSensor>().size(), 1u);
+    size_t cnt = 0;
+    for (const auto msg : reader.messages()) {
+        auto ls_recovered = msg.decode_msg<LidarScanStream>();
+        ASSERT_TRUE(ls_recovered);
+        EXPECT_EQ(msg.ts(), ts_t{static_cast<int64_t>(cnt + 1)});
+        EXPECT_EQ(ls_recovered->fields().size(), 1u);
+        EXPECT_TRUE((ls_recovered->field(ChanField::RANGE) ==
+                     saved.at(cnt).field(ChanField::RANGE)));
+        EXPECT_TRUE((ls_recovered->timestamp() == saved.at(cnt).timestamp())
+                        .all());
+        cnt++;
+    }
+    EXPECT_EQ(cnt, saved.size());
+}
+
+TEST_F(OperationsTest, CompactGroupsStreamsIntoLargerChunks) {
+    const sensor::sensor_info sinfo = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    std::string osf_file_name = tmp_file("compact_source.osf");
+    std::string compact_file_name = tmp_file("compact_output.osf");
+
+    auto encoder =
+        std::make_shared<Encoder>(std::make_shared<PngLidarScanEncoder>(1));
+    encoder->set_keyframe_interval(2);
+    std::vector<std::vector<LidarScan>> saved(2);
+    {
+        // a chunk per message, the sensors interleaved
+        Writer writer(osf_file_name,
+                      std::vector<sensor::sensor_info>{sinfo, sinfo}, {}, 1,
+                      encoder);
+        for (int i = 0; i < 3; i++) {
+            for (uint32_t s = 0; s < 2; s++) {
+                saved[s].push_back(get_random_lidar_scan(sinfo));
+                writer.save(s, saved[s].back(), ts_t{10 * i + s + 1});
+            }
+        }
+    }
+
+    EXPECT_EQ(compact_osf_file(osf_file_name, compact_file_name),
+              file_size(compact_file_name));
+
+    // a chunk per stream, one after the other
+    Reader source(osf_file_name);
+    Reader reader(compact_file_name);
+    EXPECT_EQ(reader.metadata_id(), source.metadata_id());
+    std::vector<uint32_t> chunk_streams;
+    for (const auto& chunk : reader.chunks()) {
+        ASSERT_TRUE(chunk.info());
+        chunk_streams.push_back(chunk.info()->stream_id);
+    }
+    ASSERT_EQ(chunk_streams.size(), 2u);
+    EXPECT_LT(chunk_streams[0], chunk_streams[1]);
+
+    // the messages are copied still encoded
+    std::vector<std::vector<uint8_t>> source_msgs, compact_msgs;
+    for (const auto msg : source.messages()) {
+        source_msgs.push_back(msg.buffer());
+    }
+    std::vector<LidarScan> read;
+    for (const auto msg : reader.messages()) {
+        compact_msgs.push_back(msg.buffer());
+        auto ls_recovered = msg.decode_msg<LidarScanStream>();
+        ASSERT_TRUE(ls_recovered);
+        EXPECT_EQ(*ls_recovered,
+                  saved[msg.ts().count() % 10 - 1][msg.ts().count() / 10]);
+    }
+    EXPECT_EQ(compact_msgs, source_msgs);
+
+    // with the timestamp of every message indexed
+    EXPECT_TRUE(reader.has_timestamp_idx());
+    auto streaming_info = reader.meta_store().get<StreamingInfo>();
+    ASSERT_TRUE(streaming_info);
+    for (const auto& stats : streaming_info->stream_stats()) {
+        EXPECT_EQ(stats.second.message_count, 3u);
+        EXPECT_EQ(stats.second.receive_timestamps.size(), 3u);
+    }
+
+    // re-encoded, only the scans are kept
+    CompactOptions options;
+    options.encoder =
+        std::make_shared<Encoder>(std::make_shared<ZstdLidarScanEncoder>());
+    compact_osf_file(osf_file_name, compact_file_name, options);
+    Reader recoded(compact_file_name);
+    EXPECT_EQ(std::distance(recoded.chunks().begin(), recoded.chunks().end()),
+              2);
+    size_t cnt = 0;
+    for (const auto msg : recoded.messages()) {
+        auto ls_recovered = msg.decode_msg<LidarScanStream>();
+        ASSERT_TRUE(ls_recovered);
+        EXPECT_EQ(*ls_recovered,
+                  saved[msg.ts().count() % 10 - 1][msg.ts().count() / 10]);
+        cnt++;
+    }
+    EXPECT_EQ(cnt, 6u);
+    EXPECT_FALSE(path_exists(compact_file_name + ".transcode.tmp"));
+}
+
+TEST_F(OperationsTest, BenchMeasuresChunksFieldsAndEncoders) {
+    const sensor::sensor_info sinfo = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    std::string osf_file_name = tmp_file("bench.osf");
+    {
+        Writer writer(osf_file_name, sinfo, {}, 1);
+        for (int i = 0; i < 5; i++) {
+            writer.save(0, get_random_lidar_scan(sinfo), ts_t{i + 1});
+        }
+    }
+
+    BenchOptions options;
+    options.scans = 3;
+    options.fields = {ChanField::RANGE, ChanField::REFLECTIVITY};
+    options.encoders = {{"png", 1}, {"zstd", 3}};
+    options.thread_pool = std::make_shared<ThreadPool>(2);
+    const auto bench = bench_osf_file(osf_file_name, options);
+
+    EXPECT_GT(bench.chunks, 0u);
+    EXPECT_GT(bench.chunk_bytes, 0u);
+    EXPECT_EQ(bench.invalid_chunks, 0u);
+    EXPECT_EQ(bench.scans, 5u);
+    EXPECT_GT(bench.sequential_seconds, 0);
+    EXPECT_GT(bench.parallel_seconds, 0);
+
+    ASSERT_EQ(bench.decode.size(), 2u);
+    for (const auto& decoded : bench.decode) {
+        EXPECT_EQ(decoded.scans, 3u);
+        EXPECT_EQ(decoded.bytes,
+                  3 * LidarScan(sinfo).field(decoded.field).bytes());
+    }
+    ASSERT_EQ(bench.encode.size(), 4u);
+    for (const auto& encoded : bench.encode) {
+        EXPECT_EQ(encoded.scans, 3u);
+        EXPECT_GT(encoded.encoded_bytes, 0u);
+        EXPECT_GT(encoded.raw_bytes, 0u);
+    }
+
+    options.encoders = {{"lz4", 1}};
+    EXPECT_THROW(bench_osf_file(osf_file_name, options),
+                 std::invalid_argument);
+}
+
+TEST_F(OperationsTest, PcapToOsfMatchesScanBatcher) {
+    const std::string pcap_file = path_concat(
+        test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10_lb_n3.pcap");
+    const sensor::sensor_info sinfo = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    std::string osf_file_name = tmp_file("pcap_to_osf.osf");
+
+    // the scans batched on a single thread, timestamped with their first
+    // valid packet
+    std::vector<LidarScan> batched;
+    {
+        sensor_utils::PcapReader pcap(pcap_file);
+        ScanBatcher batcher(sinfo);
+        sensor::packet_format pf(sinfo);
+        LidarScan ls(sinfo);
+        while (pcap.next_packet()) {
+            const auto& info = pcap.current_info();
+            if (info.dst_port != *sinfo.config.udp_port_lidar ||
+                info.payload_size != pf.lidar_packet_size) {
+                continue;
+            }
+            const uint64_t ts = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    info.timestamp)
+                    .count());
+            if (batcher(pcap.current_data(), ts, ls)) batched.push_back(ls);
+        }
+    }
+    ASSERT_FALSE(batched.empty());
+
+    PcapToOsfOptions options;
+    options.fields = {ChanField::RANGE, ChanField::REFLECTIVITY};
+    options.encoder = std::make_shared<Encoder>(
+        std::make_shared<PngLidarScanEncoder>(1),
+        std::make_shared<ThreadPool>(3));
+    options.max_in_flight = 2;
+    options.queue_size = 16;
+    EXPECT_EQ(pcap_to_osf(pcap_file, {sinfo}, osf_file_name, options),
+              file_size(osf_file_name));
+
+    Reader reader(osf_file_name);
+    ASSERT_EQ(reader.meta_store().find<LidarSensor>().size(), 1u);
+    size_t cnt = 0;
+    for (const auto msg : reader.messages()) {
+        auto ls_recovered = msg.decode_msg<LidarScanStream>();
+        ASSERT_TRUE(ls_recovered);
+        ASSERT_LT(cnt, batched.size());
+        const LidarScan& expected = batched.at(cnt);
+        EXPECT_EQ(msg.ts(),
+                  ts_t{expected.get_first_valid_packet_timestamp()});
+        EXPECT_EQ(ls_recovered->frame_id, expected.frame_id);
+        EXPECT_EQ(ls_recovered->fields().size(), 2u);
+        EXPECT_TRUE((ls_recovered->field(ChanField::RANGE) ==
+                     expected.field(ChanField::RANGE)));
+        EXPECT_TRUE((ls_recovered->field(ChanField::REFLECTIVITY) ==
+                     expected.field(ChanField::REFLECTIVITY)));
+        cnt++;
+    }
+    EXPECT_EQ(cnt, batched.size());
+
+    // fields the profile doesn't have can't be kept
+    options.fields = {"NOT_A_FIELD"};
+    EXPECT_THROW(pcap_to_osf(pcap_file, {sinfo}, osf_file_name, options),
+                 std::runtime_error);
+    EXPECT_THROW(pcap_to_osf(pcap_file, {}, osf_file_name, options),
+                 std::invalid_argument);
+}
+
+TEST_F(OperationsTest, PcapToOsfAppliesScanOps) {
+    const std::string pcap_file = path_concat(
+        test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10_lb_n3.pcap");
+    const sensor::sensor_info sinfo = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    std::string osf_file_name = tmp_file("pcap_to_osf_ops.osf");
+
+    std::vector<LidarScan> batched;
+    {
+        sensor_utils::PcapReader pcap(pcap_file);
+        ScanBatcher batcher(sinfo);
+        sensor::packet_format pf(sinfo);
+        LidarScan ls(sinfo);
+        while (pcap.next_packet()) {
+            const auto& info = pcap.current_info();
+            if (info.dst_port != *sinfo.config.udp_port_lidar ||
+                info.payload_size != pf.lidar_packet_size) {
+                continue;
+            }
+            if (batcher(pcap.current_data(), 0, ls)) batched.push_back(ls);
+        }
+    }
+    ASSERT_GT(batched.size(), 1u);
+
+    // skip the first scan, reduce to 32 beams and clip the range to 5m
+    PcapToOsfOptions options;
+    options.fields = {ChanField::RANGE};
+    options.ops.start = 1;
+    options.ops.beams = 32;
+    options.ops.clip_fields = {ChanField::RANGE};
+    options.ops.clip_upper = 5000;
+    pcap_to_osf(pcap_file, {sinfo}, osf_file_name, options);
+
+    Reader reader(osf_file_name);
+    auto sensors = reader.meta_store().find<LidarSensor>();
+    ASSERT_EQ(sensors.size(), 1u);
+    EXPECT_EQ(sensors.begin()->second->info().format.pixels_per_column, 32u);
+    size_t cnt = 1;
+    for (const auto msg : reader.messages()) {
+        auto ls_recovered = msg.decode_msg<LidarScanStream>();
+        ASSERT_TRUE(ls_recovered);
+        ASSERT_LT(cnt, batched.size());
+        LidarScan expected = reduce_by_factor(batched.at(cnt), 4);
+        clip_fields(expected, {ChanField::RANGE}, 0, 5000);
+        EXPECT_EQ(ls_recovered->frame_id, expected.frame_id);
+        EXPECT_EQ(ls_recovered->h, 32u);
+        EXPECT_TRUE((ls_recovered->field(ChanField::RANGE) ==
+                     expected.field(ChanField::RANGE)));
+        cnt++;
+    }
+    EXPECT_EQ(cnt, batched.size());
+
+    // beams must divide the beams of the sensors
+    options.ops.beams = 48;
+    EXPECT_THROW(pcap_to_osf(pcap_file, {sinfo}, osf_file_name, options),
+                 std::invalid_argument);
+}
+
 }  // namespace
 }  // namespace osf
 }  // namespace ouster
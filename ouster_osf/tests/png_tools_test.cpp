@@ -113,13 +113,19 @@ TEST_F(OsfPngToolsTest, scanDecodeFields) {
 #endif
 
 TEST(OsfFieldEncodeTest, field_encode_decode_test) {
-    auto test_field_encoding = [](const ouster::Field& f) {
-        ScanChannelData compressed;
-        PngLidarScanEncoder encoder(4);
-        EXPECT_NO_THROW({ compressed = encoder.encodeField(f); });
-        Field decoded(f.desc());
-        EXPECT_NO_THROW({ decodeField(decoded, compressed); });
-        EXPECT_EQ(f, decoded);
+    const std::vector<PngLidarScanEncoder> encoders{
+        PngLidarScanEncoder(4),
+        PngLidarScanEncoder(1, PngFilter::UP, PngStrategy::RLE),
+        PngLidarScanEncoder(1, PngFilter::NONE, PngStrategy::HUFFMAN_ONLY),
+        PngLidarScanEncoder(6, PngFilter::PAETH, PngStrategy::FILTERED)};
+    auto test_field_encoding = [&encoders](const ouster::Field& f) {
+        for (const auto& encoder : encoders) {
+            ScanChannelData compressed;
+            EXPECT_NO_THROW({ compressed = encoder.encodeField(f); });
+            Field decoded(f.desc());
+            EXPECT_NO_THROW({ decodeField(decoded, compressed); });
+            EXPECT_EQ(f, decoded);
+        }
     };
 
     std::random_device rd;
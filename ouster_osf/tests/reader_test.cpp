@@ -7,18 +7,27 @@
 
 #include <gtest/gtest.h>
 
+#include <thread>
+
 #include "common.h"
 #include "osf_test.h"
 #include "ouster/impl/logging.h"
 #include "ouster/osf/meta_lidar_sensor.h"
 #include "ouster/osf/meta_streaming_info.h"
+#include "ouster/osf/multi_reader.h"
+#include "ouster/osf/osf_encoder.h"
+#include "ouster/osf/png_lidarscan_encoder.h"
+#include "ouster/osf/read_ahead.h"
+#include "ouster/osf/sharded_writer.h"
 #include "ouster/osf/stream_lidar_scan.h"
+#include "ouster/osf/writer.h"
 
 namespace ouster {
 namespace osf {
 namespace {
 
 class ReaderTest : public osf::OsfTestWithData {};
+class ReaderWithFilesTest : public osf::OsfTestWithDataAndFiles {};
 
 TEST_F(ReaderTest, Basics) {
     OsfFile osf_file(
@@ -197,6 +206,20 @@ TEST_F(ReaderTest, ChunksPileBasics) {
     EXPECT_EQ(3, cp.size());
 }
 
+TEST_F(ReaderTest, ChunksPileTimestampsIndex) {
+    ChunksPile cp{};
+    EXPECT_FALSE(cp.message_idx_by_lower_bound_ts(0, ts_t{1}));
+
+    cp.add_timestamps(0, {10, 20, 20, 30});
+    EXPECT_EQ(0u, *cp.message_idx_by_lower_bound_ts(0, ts_t{0}));
+    EXPECT_EQ(0u, *cp.message_idx_by_lower_bound_ts(0, ts_t{10}));
+    EXPECT_EQ(1u, *cp.message_idx_by_lower_bound_ts(0, ts_t{11}));
+    EXPECT_EQ(1u, *cp.message_idx_by_lower_bound_ts(0, ts_t{20}));
+    EXPECT_EQ(3u, *cp.message_idx_by_lower_bound_ts(0, ts_t{30}));
+    EXPECT_FALSE(cp.message_idx_by_lower_bound_ts(0, ts_t{31}));
+    EXPECT_FALSE(cp.message_idx_by_lower_bound_ts(1, ts_t{10}));
+}
+
 TEST_F(ReaderTest, MessagesReadingStreaming) {
     OsfFile osf_file(
         path_concat(test_data_dir(), "osfs/OS-1-128_v2.3.0_1024x10_lb_n3.osf"));
@@ -277,6 +300,613 @@ TEST_F(ReaderTest, MessagesReadingStreaming) {
     EXPECT_EQ(3, std::distance(scan_msgs_full.begin(), scan_msgs_full.end()));
 }
 
+TEST_F(ReaderTest, MessagesReadingWithPread) {
+    const std::string file_name =
+        path_concat(test_data_dir(), "osfs/OS-1-128_v2.3.0_1024x10_lb_n3.osf");
+    Reader reader(file_name);
+    FileOptions options;
+    options.backend = FileBackend::PREAD;
+    options.read_ahead = 64 * 1024;
+    Reader pread_reader(file_name, options);
+    EXPECT_EQ(pread_reader.metadata_id(), reader.metadata_id());
+
+    auto msgs = reader.messages();
+    auto pread_msgs = pread_reader.messages();
+    auto it = msgs.begin();
+    for (const auto msg : pread_msgs) {
+        ASSERT_NE(it, msgs.end());
+        EXPECT_EQ(msg.id(), it->id());
+        EXPECT_EQ(msg.ts(), it->ts());
+        EXPECT_EQ(msg.buffer(), it->buffer());
+        ++it;
+    }
+    EXPECT_EQ(it, msgs.end());
+}
+
+TEST_F(ReaderTest, LazyOpenMatchesEagerOpen) {
+    const std::string file_name =
+        path_concat(test_data_dir(), "osfs/OS-1-128_v2.3.0_1024x10_lb_n3.osf");
+    Reader reader(file_name);
+    FileOptions options;
+    options.lazy_open = true;
+    Reader lazy_reader(file_name, options);
+    EXPECT_EQ(lazy_reader.metadata_id(), reader.metadata_id());
+    EXPECT_EQ(lazy_reader.has_stream_info(), reader.has_stream_info());
+
+    // indexed on the first read
+    EXPECT_EQ(lazy_reader.has_message_idx(), reader.has_message_idx());
+    auto msgs = reader.messages();
+    auto lazy_msgs = lazy_reader.messages();
+    auto it = msgs.begin();
+    for (const auto msg : lazy_msgs) {
+        ASSERT_NE(it, msgs.end());
+        EXPECT_EQ(msg.id(), it->id());
+        EXPECT_EQ(msg.ts(), it->ts());
+        ++it;
+    }
+    EXPECT_EQ(it, msgs.end());
+
+    auto chunks = reader.chunks();
+    auto lazy_chunks = lazy_reader.chunks();
+    EXPECT_EQ(std::distance(lazy_chunks.begin(), lazy_chunks.end()),
+              std::distance(chunks.begin(), chunks.end()));
+}
+
+TEST_F(ReaderWithFilesTest, ScanReadAheadMatchesMessages) {
+    const sensor::sensor_info sinfo = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    std::string output_osf_filename = tmp_file("reader_read_ahead.osf");
+
+    // delta frames are decoded ahead together with their keyframes
+    auto encoder =
+        std::make_shared<Encoder>(std::make_shared<PngLidarScanEncoder>(1));
+    encoder->set_keyframe_interval(3);
+    std::vector<LidarScan> saved;
+    {
+        Writer writer(output_osf_filename,
+                      std::vector<sensor::sensor_info>{sinfo, sinfo}, {}, 1,
+                      encoder);
+        for (int i = 0; i < 8; i++) {
+            saved.push_back(get_random_lidar_scan(sinfo));
+            writer.save(static_cast<uint32_t>(i % 2), saved.back(),
+                        ts_t{i + 1});
+        }
+    }
+
+    Reader reader(output_osf_filename);
+    for (unsigned threads : {1u, 3u}) {
+        ReadAheadOptions options;
+        options.scans = 3;
+        options.chunks = 1;
+        options.thread_pool = std::make_shared<ThreadPool>(threads);
+        ScanReadAhead read_ahead(reader, {}, reader.start_ts(),
+                                 reader.end_ts(), {}, options);
+        std::vector<uint32_t> expected_ids;
+        for (const auto msg : reader.messages()) {
+            expected_ids.push_back(msg.id());
+        }
+
+        size_t count = 0;
+        DecodedScan scan;
+        while (read_ahead.next(scan)) {
+            ASSERT_LT(count, saved.size());
+            EXPECT_EQ(scan.stream_id, expected_ids[count]);
+            EXPECT_EQ(scan.ts, ts_t{static_cast<int64_t>(count) + 1});
+            ASSERT_TRUE(scan.scan);
+            EXPECT_EQ(*scan.scan, saved[count]);
+            ++count;
+        }
+        EXPECT_EQ(count, saved.size());
+        EXPECT_FALSE(read_ahead.next(scan));
+    }
+
+    // a subset of the fields, stopping before the end
+    ScanReadAhead read_ahead(reader, {}, ts_t{3}, ts_t{5},
+                             {sensor::ChanField::RANGE});
+    DecodedScan scan;
+    ASSERT_TRUE(read_ahead.next(scan));
+    EXPECT_EQ(scan.ts, ts_t{3});
+    ASSERT_TRUE(scan.scan);
+    EXPECT_TRUE(scan.scan->has_field(sensor::ChanField::RANGE));
+    EXPECT_FALSE(scan.scan->has_field(sensor::ChanField::REFLECTIVITY));
+}
+
+TEST_F(ReaderWithFilesTest, ScanReadAheadMergesColumnarStreams) {
+    const sensor::sensor_info sinfo = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    std::string output_osf_filename = tmp_file("reader_columnar.osf");
+
+    std::vector<LidarScan> saved;
+    {
+        Writer writer(output_osf_filename,
+                      std::vector<sensor::sensor_info>{sinfo, sinfo}, {}, 1);
+        writer.set_columnar(0);
+        EXPECT_TRUE(writer.columnar(0));
+        EXPECT_FALSE(writer.columnar(1));
+        for (int i = 0; i < 6; i++) {
+            saved.push_back(get_random_lidar_scan(sinfo));
+            writer.save(static_cast<uint32_t>(i % 2), saved.back(),
+                        ts_t{i + 1});
+        }
+        EXPECT_THROW(writer.set_columnar(1), std::logic_error);
+    }
+
+    Reader reader(output_osf_filename);
+    const size_t fields = saved[0].fields().size();
+    EXPECT_EQ(reader.meta_store().find<LidarScanStreamMeta>().size(),
+              fields + 1);
+
+    size_t count = 0;
+    DecodedScan scan;
+    {
+        ScanReadAhead read_ahead(reader, {}, reader.start_ts(),
+                                 reader.end_ts());
+        while (read_ahead.next(scan)) {
+            ASSERT_LT(count, saved.size());
+            EXPECT_EQ(scan.ts, ts_t{static_cast<int64_t>(count) + 1});
+            ASSERT_TRUE(scan.scan);
+            EXPECT_EQ(*scan.scan, saved[count]);
+            ++count;
+        }
+    }
+    EXPECT_EQ(count, saved.size());
+
+    // a single field reads only its stream of the columnar sensor
+    ScanReadAhead read_ahead(reader, {}, reader.start_ts(), reader.end_ts(),
+                             {sensor::ChanField::RANGE});
+    count = 0;
+    while (read_ahead.next(scan)) {
+        ASSERT_TRUE(scan.scan);
+        EXPECT_EQ(scan.scan->fields().size(), 1u);
+        EXPECT_TRUE(scan.scan->field(sensor::ChanField::RANGE) ==
+                    saved[count].field(sensor::ChanField::RANGE));
+        ++count;
+    }
+    EXPECT_EQ(count, saved.size());
+}
+
+TEST_F(ReaderWithFilesTest, DecodeMsgIntoReusesScan) {
+    const sensor::sensor_info sinfo = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    std::string output_osf_filename = tmp_file("reader_decode_into.osf");
+
+    auto encoder =
+        std::make_shared<Encoder>(std::make_shared<PngLidarScanEncoder>(1));
+    encoder->set_keyframe_interval(3);
+    std::vector<LidarScan> saved;
+    {
+        Writer writer(output_osf_filename, sinfo, {}, 0, encoder);
+        for (int i = 0; i < 6; i++) {
+            saved.push_back(get_random_lidar_scan(sinfo));
+            writer.save(0, saved.back(), ts_t{i + 1});
+        }
+    }
+
+    Reader reader(output_osf_filename);
+    LidarScan scan;
+    const void* range_data = nullptr;
+    size_t count = 0;
+    for (const auto msg : reader.messages()) {
+        const auto buffer = msg.buffer();
+        const auto view = msg.view();
+        ASSERT_EQ(static_cast<size_t>(view.shape[0]), buffer.size());
+        EXPECT_TRUE(std::equal(buffer.begin(), buffer.end(), view.data()));
+
+        ASSERT_TRUE(msg.decode_msg_into<LidarScanStream>(scan));
+        EXPECT_EQ(scan, saved[count]);
+        // the fields of the first scan are decoded into from then on
+        const void* data = scan.field(sensor::ChanField::RANGE).get();
+        if (count == 0) range_data = data;
+        EXPECT_EQ(data, range_data);
+        ++count;
+    }
+    EXPECT_EQ(count, saved.size());
+
+    // a subset of the fields drops the others from the scan
+    auto msg = *reader.messages().begin();
+    ASSERT_TRUE(msg.decode_msg_into<LidarScanStream>(
+        scan, {sensor::ChanField::RANGE}));
+    EXPECT_TRUE(scan.has_field(sensor::ChanField::RANGE));
+    EXPECT_FALSE(scan.has_field(sensor::ChanField::REFLECTIVITY));
+    ASSERT_TRUE(msg.decode_msg_into<LidarScanStream>(scan));
+    EXPECT_EQ(scan, saved[0]);
+}
+
+TEST_F(ReaderWithFilesTest, MessagesSeekWithinChunks) {
+    const sensor::sensor_info sinfo = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    std::string output_osf_filename = tmp_file("reader_seek.osf");
+
+    {
+        Writer writer(output_osf_filename, sinfo);
+        writer.set_chunk_policy(ChunkPolicy{0, 4, ts_t{0}});
+        for (int i = 0; i < 10; i++) {
+            writer.save(0, LidarScan(sinfo), ts_t{10 * (i + 1)});
+        }
+    }
+
+    Reader reader(output_osf_filename);
+    EXPECT_TRUE(reader.has_timestamp_idx());
+    EXPECT_EQ(3, std::distance(reader.chunks().begin(), reader.chunks().end()));
+
+    // every start in and between the messages of the chunks
+    for (int64_t start = 0; start <= 101; start += 5) {
+        std::vector<int64_t> read_ts;
+        for (const auto msg : reader.messages(ts_t{start}, ts_t{75})) {
+            read_ts.push_back(msg.ts().count());
+        }
+        std::vector<int64_t> expected_ts;
+        for (int64_t ts = 10; ts < 75; ts += 10) {
+            if (ts >= start) expected_ts.push_back(ts);
+        }
+        EXPECT_EQ(read_ts, expected_ts) << "start = " << start;
+    }
+}
+
+TEST_F(ReaderWithFilesTest, StreamIndexAndCollatedMessages) {
+    const sensor::sensor_info sinfo = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    std::string output_osf_filename = tmp_file("reader_stream_index.osf");
+
+    {
+        Writer writer(output_osf_filename,
+                      std::vector<sensor::sensor_info>{sinfo, sinfo});
+        writer.set_chunk_policy(ChunkPolicy{0, 2, ts_t{0}});
+        // the second sensor misses its third scan
+        for (int i = 0; i < 5; i++) {
+            writer.save(0, LidarScan(sinfo), ts_t{100 * (i + 1)});
+            if (i != 2) {
+                writer.save(1, LidarScan(sinfo), ts_t{100 * (i + 1) + 10});
+            }
+        }
+    }
+
+    Reader reader(output_osf_filename);
+    std::vector<uint32_t> stream_ids;
+    for (const auto& it : reader.meta_store().find<LidarScanStreamMeta>()) {
+        stream_ids.push_back(it.first);
+    }
+    ASSERT_EQ(stream_ids.size(), 2u);
+
+    const auto index = reader.stream_index(stream_ids[0]);
+    EXPECT_EQ(index.stream_id, stream_ids[0]);
+    EXPECT_EQ(index.message_count, 5u);
+    EXPECT_EQ(index.timestamps,
+              (std::vector<uint64_t>{100, 200, 300, 400, 500}));
+    ASSERT_EQ(index.chunk_offsets.size(), 3u);
+    EXPECT_EQ(index.chunk_message_starts, (std::vector<uint32_t>{0, 2, 4}));
+    for (uint32_t i = 0; i < 5; ++i) {
+        EXPECT_EQ(index.chunk_offset(i), index.chunk_offsets[i / 2]);
+        // the message is in the chunk the index points to
+        const ChunkRef chunk(index.chunk_offset(i), &reader);
+        EXPECT_EQ(chunk.messages(i % 2)->ts().count(), index.timestamps[i]);
+    }
+    EXPECT_THROW(index.chunk_offset(5), std::out_of_range);
+    EXPECT_EQ(reader.stream_index(stream_ids[1]).message_count, 4u);
+
+    // a frame without the missing scan, then back in step
+    EXPECT_EQ(reader.collate_messages(stream_ids),
+              (std::vector<int64_t>{0, 0, 1, 1, 2, -1, 3, 2, 4, 3}));
+    // scans too far apart for the same frame
+    EXPECT_EQ(reader.collate_messages(stream_ids, 5),
+              (std::vector<int64_t>{0, -1, -1, 0, 1, -1, -1, 1, 2, -1, 3, -1,
+                                    -1, 2, 4, -1, -1, 3}));
+}
+
+TEST_F(ReaderWithFilesTest, MessagesSkipChunksBySummary) {
+    const sensor::sensor_info sinfo = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    std::string output_osf_filename = tmp_file("reader_summaries.osf");
+
+    {
+        Writer writer(output_osf_filename, sinfo);
+        writer.set_chunk_summaries();
+        writer.set_chunk_policy(ChunkPolicy{0, 2, ts_t{0}});
+        for (int i = 0; i < 10; i++) {
+            LidarScan ls(sinfo);
+            ls.status().setConstant(0x01);
+            ls.field<uint32_t>(sensor::ChanField::RANGE)
+                .setConstant(1000 * (i + 1));
+            writer.save(0, ls, ts_t{10 * (i + 1)});
+        }
+    }
+
+    Reader reader(output_osf_filename);
+    auto streaming_info = reader.meta_store().get<StreamingInfo>();
+    ASSERT_TRUE(streaming_info);
+    ASSERT_EQ(streaming_info->chunks_info().size(), 5u);
+    for (const auto& ci : streaming_info->chunks_info()) {
+        ASSERT_TRUE(ci.second.summary.range);
+        EXPECT_EQ(ci.second.summary.range->max - ci.second.summary.range->min,
+                  1000.0);
+        ASSERT_TRUE(ci.second.summary.completeness);
+        EXPECT_EQ(ci.second.summary.completeness->min, 1.0);
+    }
+
+    auto read_ts = [&](ChunkFilter filter) {
+        std::vector<int64_t> ts;
+        for (const auto msg : reader.messages({}, reader.start_ts(),
+                                              reader.end_ts(), filter)) {
+            ts.push_back(msg.ts().count());
+        }
+        return ts;
+    };
+    EXPECT_EQ(read_ts(nullptr), (std::vector<int64_t>{10, 20, 30, 40, 50, 60,
+                                                      70, 80, 90, 100}));
+    // leading chunks skipped
+    EXPECT_EQ(read_ts([](const ChunkSummary& s) {
+                  return s.range->max >= 7000;
+              }),
+              (std::vector<int64_t>{70, 80, 90, 100}));
+    // chunks skipped between the ones read
+    EXPECT_EQ(read_ts([](const ChunkSummary& s) {
+                  return s.range->max != 4000 && s.range->max != 8000;
+              }),
+              (std::vector<int64_t>{10, 20, 50, 60, 90, 100}));
+    EXPECT_TRUE(read_ts([](const ChunkSummary&) { return false; }).empty());
+
+    // chunks without summaries are always read
+    std::string plain_osf_filename = tmp_file("reader_no_summaries.osf");
+    {
+        Writer writer(plain_osf_filename, sinfo);
+        writer.save(0, LidarScan(sinfo), ts_t{10});
+    }
+    Reader plain_reader(plain_osf_filename);
+    size_t count = 0;
+    for (const auto msg :
+         plain_reader.messages({}, plain_reader.start_ts(),
+                               plain_reader.end_ts(),
+                               [](const ChunkSummary&) { return false; })) {
+        (void)msg;
+        count++;
+    }
+    EXPECT_EQ(count, 1u);
+}
+
+TEST_F(ReaderWithFilesTest, MultiReaderSplitRecording) {
+    const sensor::sensor_info sinfo = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+
+    // three files of four scans each, passed out of order
+    std::vector<std::string> files;
+    for (int f : {2, 0, 1}) {
+        files.push_back(
+            tmp_file("reader_multi_" + std::to_string(f) + ".osf"));
+        Writer writer(files.back(), sinfo);
+        for (int i = 0; i < 4; i++) {
+            writer.save(0, LidarScan(sinfo), ts_t{10 * f + i + 1});
+        }
+    }
+
+    MultiReader multi_reader(files);
+    ASSERT_EQ(multi_reader.size(), 3u);
+    EXPECT_EQ(multi_reader.filename(0), files[1]);
+    EXPECT_EQ(multi_reader.filename(2), files[0]);
+    EXPECT_EQ(multi_reader.start_ts(), ts_t{1});
+    EXPECT_EQ(multi_reader.end_ts(), ts_t{24});
+
+    std::vector<int64_t> read_ts;
+    std::vector<size_t> read_files;
+    for (auto it = multi_reader.messages().begin();
+         it != multi_reader.messages().end(); ++it) {
+        read_ts.push_back((*it).ts().count());
+        read_files.push_back(it.file_idx());
+    }
+    EXPECT_EQ(read_ts, (std::vector<int64_t>{1, 2, 3, 4, 11, 12, 13, 14, 21,
+                                             22, 23, 24}));
+    EXPECT_EQ(read_files,
+              (std::vector<size_t>{0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2}));
+
+    // a range across the boundary of two files
+    read_ts.clear();
+    for (const auto msg : multi_reader.messages(ts_t{3}, ts_t{12})) {
+        read_ts.push_back(msg.ts().count());
+    }
+    EXPECT_EQ(read_ts, (std::vector<int64_t>{3, 4, 11, 12}));
+    auto past_end = multi_reader.messages(ts_t{25}, ts_t{30});
+    EXPECT_TRUE(past_end.begin() == past_end.end());
+
+    const uint32_t stream_id = (*multi_reader.messages().begin()).id();
+    EXPECT_EQ(multi_reader.message_count(stream_id), 12u);
+    EXPECT_EQ(*multi_reader.ts_by_message_idx(stream_id, 0), ts_t{1});
+    EXPECT_EQ(*multi_reader.ts_by_message_idx(stream_id, 5), ts_t{12});
+    EXPECT_EQ(*multi_reader.ts_by_message_idx(stream_id, 11), ts_t{24});
+    EXPECT_FALSE(multi_reader.ts_by_message_idx(stream_id, 12));
+
+    size_t chunks = 0;
+    for (auto it = multi_reader.chunks().begin();
+         it != multi_reader.chunks().end(); ++it) {
+        EXPECT_TRUE(it->valid());
+        ++chunks;
+    }
+    size_t file_chunks = 0;
+    for (size_t i = 0; i < multi_reader.size(); ++i) {
+        auto range = multi_reader.reader(i).chunks();
+        file_chunks += std::distance(range.begin(), range.end());
+    }
+    EXPECT_EQ(chunks, file_chunks);
+
+    EXPECT_THROW(MultiReader(std::vector<std::string>{}),
+                 std::invalid_argument);
+    // the same time range twice
+    EXPECT_THROW(MultiReader(std::vector<std::string>(2, files[0])),
+                 std::invalid_argument);
+}
+
+TEST_F(ReaderWithFilesTest, MultiReaderShardedRecording) {
+    const sensor::sensor_info sinfo = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    const std::string manifest = tmp_file("reader_sharded.json");
+
+    // a shard per sensor, the scans of the sensors interleaved in time
+    {
+        ShardedWriter writer(manifest,
+                             std::vector<sensor::sensor_info>(3, sinfo));
+        ASSERT_EQ(writer.shards(), 3u);
+        EXPECT_EQ(writer.shard_of(2), 2u);
+        std::vector<std::future<void>> saved;
+        for (int i = 0; i < 4; i++) {
+            for (uint32_t s = 0; s < 3; s++) {
+                saved.push_back(
+                    writer.save(s, LidarScan(sinfo), ts_t{10 * i + s + 1}));
+            }
+        }
+        for (auto& f : saved) f.get();
+        writer.close();
+    }
+
+    const ShardManifest loaded = load_shard_manifest(manifest);
+    ASSERT_EQ(loaded.files.size(), 3u);
+    EXPECT_EQ(loaded.sensors[1], std::vector<uint32_t>{1});
+    MultiReader multi_reader(loaded);
+    EXPECT_TRUE(multi_reader.sharded());
+    EXPECT_EQ(multi_reader.start_ts(), ts_t{1});
+    EXPECT_EQ(multi_reader.end_ts(), ts_t{33});
+
+    std::vector<int64_t> read_ts;
+    std::vector<size_t> read_files;
+    std::vector<uint32_t> stream_ids(3);
+    for (auto it = multi_reader.messages().begin();
+         it != multi_reader.messages().end(); ++it) {
+        read_ts.push_back((*it).ts().count());
+        read_files.push_back(it.file_idx());
+        stream_ids[it.file_idx()] = it->id();
+    }
+    EXPECT_EQ(read_ts, (std::vector<int64_t>{1, 2, 3, 11, 12, 13, 21, 22,
+                                             23, 31, 32, 33}));
+    EXPECT_EQ(read_files,
+              (std::vector<size_t>{0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2}));
+    // the shards don't share stream ids
+    EXPECT_NE(stream_ids[0], stream_ids[1]);
+    EXPECT_NE(stream_ids[1], stream_ids[2]);
+    EXPECT_NE(stream_ids[0], stream_ids[2]);
+
+    read_ts.clear();
+    for (const auto msg :
+         multi_reader.messages({stream_ids[1]}, ts_t{0}, ts_t{100})) {
+        read_ts.push_back(msg.ts().count());
+    }
+    EXPECT_EQ(read_ts, (std::vector<int64_t>{2, 12, 22, 32}));
+
+    read_ts.clear();
+    for (const auto msg : multi_reader.messages(ts_t{12}, ts_t{22})) {
+        read_ts.push_back(msg.ts().count());
+    }
+    EXPECT_EQ(read_ts, (std::vector<int64_t>{12, 13, 21, 22}));
+
+    EXPECT_EQ(multi_reader.message_count(stream_ids[2]), 4u);
+    EXPECT_EQ(*multi_reader.ts_by_message_idx(stream_ids[2], 1), ts_t{13});
+
+    EXPECT_THROW(MultiReader(ShardManifest{}), std::invalid_argument);
+}
+
+TEST_F(ReaderWithFilesTest, StreamMessagesOnSeparateThreads) {
+    const sensor::sensor_info sinfo = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    std::string output_osf_filename = tmp_file("reader_stream_messages.osf");
+
+    const int SCANS_CNT = 12;
+    std::vector<LidarScan> saved;
+    {
+        Writer writer(output_osf_filename,
+                      std::vector<sensor::sensor_info>{sinfo, sinfo}, {}, 1);
+        for (int i = 0; i < SCANS_CNT; i++) {
+            saved.push_back(get_random_lidar_scan(sinfo));
+            writer.save(static_cast<uint32_t>(i % 2), saved.back(),
+                        ts_t{i + 1});
+        }
+    }
+
+    // the threads share the buffered reads of the file
+    FileOptions options;
+    options.backend = FileBackend::PREAD;
+    Reader reader(output_osf_filename, options);
+    auto ranges = reader.stream_messages();
+    ASSERT_EQ(ranges.size(), 2u);
+
+    std::vector<std::vector<int64_t>> read_ts(ranges.size());
+    std::vector<size_t> mismatches(ranges.size(), 0);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < ranges.size(); i++) {
+        threads.emplace_back([&, i] {
+            for (const auto msg : ranges[i]) {
+                read_ts[i].push_back(msg.ts().count());
+                auto ls = msg.decode_msg<LidarScanStream>();
+                if (!ls || !(*ls == saved.at(msg.ts().count() - 1))) {
+                    ++mismatches[i];
+                }
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    for (size_t i = 0; i < ranges.size(); i++) {
+        EXPECT_EQ(mismatches[i], 0u);
+        EXPECT_EQ(read_ts[i].size(), SCANS_CNT / 2);
+        for (const auto ts : read_ts[i]) {
+            // the stream of sensor i holds every other scan
+            EXPECT_EQ((ts - 1) % 2, static_cast<int64_t>(i));
+        }
+    }
+}
+
+TEST_F(ReaderWithFilesTest, CachedScansAndChunks) {
+    const sensor::sensor_info sinfo = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    std::string output_osf_filename = tmp_file("reader_cache.osf");
+
+    std::vector<LidarScan> saved;
+    {
+        Writer writer(output_osf_filename, sinfo);
+        for (int i = 0; i < 4; i++) {
+            saved.push_back(get_random_lidar_scan(sinfo));
+            writer.save(0, saved.back(), ts_t{i + 1});
+        }
+    }
+
+    Reader reader(output_osf_filename);
+    EXPECT_EQ(reader.cache_options().scan_bytes, 0u);
+    ReaderCacheOptions cache;
+    cache.chunk_bytes = 1 << 30;
+    cache.scan_bytes = 1 << 30;
+    reader.set_cache(cache);
+    EXPECT_EQ(reader.cache_options().chunk_bytes, cache.chunk_bytes);
+    EXPECT_EQ(reader.cache_options().scan_bytes, cache.scan_bytes);
+
+    // the second pass reads the cached scans, which the consumer of the
+    // first one can't modify
+    for (int pass = 0; pass < 2; pass++) {
+        ScanReadAhead read_ahead(reader, {}, reader.start_ts(),
+                                 reader.end_ts());
+        size_t count = 0;
+        DecodedScan scan;
+        while (read_ahead.next(scan)) {
+            ASSERT_LT(count, saved.size());
+            ASSERT_TRUE(scan.scan);
+            EXPECT_EQ(*scan.scan, saved[count]);
+            scan.scan->frame_id = -1;
+            ++count;
+        }
+        EXPECT_EQ(count, saved.size());
+    }
+
+    size_t count = 0;
+    for (const auto msg : reader.messages()) {
+        auto ls = msg.decode_msg<LidarScanStream>();
+        ASSERT_TRUE(ls);
+        EXPECT_EQ(*ls, saved.at(count++));
+    }
+    EXPECT_EQ(count, saved.size());
+
+    // shrinking the caches evicts everything that doesn't fit
+    reader.set_cache(ReaderCacheOptions());
+    ScanReadAhead read_ahead(reader, {}, ts_t{2}, ts_t{2});
+    DecodedScan scan;
+    ASSERT_TRUE(read_ahead.next(scan));
+    ASSERT_TRUE(scan.scan);
+    EXPECT_EQ(*scan.scan, saved[1]);
+}
+
 // @TODO Reeanble this test when we have generic spdlog functonality.
 // TEST_F(ReaderTest, MetadataFromBufferTest) {
 //     OsfFile osf_file(
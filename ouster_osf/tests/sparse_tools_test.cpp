@@ -0,0 +1,169 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "sparse_tools.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "common.h"
+#include "osf_test.h"
+#include "ouster/lidar_scan.h"
+#include "ouster/osf/banded_lidarscan_encoder.h"
+#include "ouster/osf/file.h"
+#include "ouster/osf/png_lidarscan_encoder.h"
+#include "ouster/osf/reader.h"
+#include "ouster/osf/sparse_lidarscan_encoder.h"
+#include "ouster/osf/stream_lidar_scan.h"
+#include "ouster/osf/writer.h"
+#include "ouster/osf/zstd_lidarscan_encoder.h"
+#include "ouster/types.h"
+#include "png_tools.h"
+
+namespace ouster {
+namespace osf {
+namespace {
+
+class OsfSparseToolsTest : public OsfTestWithDataAndFiles {};
+
+using ouster::sensor::sensor_info;
+
+// zero the columns outside of [c0, c1) and a random half of the rest
+void mask_scan(LidarScan& ls, size_t c0, size_t c1, bool random) {
+    std::mt19937 gen{7};
+    for (auto& f : ls.fields()) {
+        FieldView v = f.second;
+        const size_t px_bytes = v.bytes() / (ls.w * ls.h);
+        uint8_t* p = static_cast<uint8_t*>(v.get());
+        for (size_t r = 0; r < ls.h; r++) {
+            for (size_t c = 0; c < ls.w; c++) {
+                if (c < c0 || c >= c1 || (random && gen() % 2)) {
+                    std::memset(p + (r * ls.w + c) * px_bytes, 0, px_bytes);
+                }
+            }
+        }
+    }
+}
+
+TEST_F(OsfSparseToolsTest, FieldEncodeDecode) {
+    const sensor_info si = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    const auto px_offset = si.format.pixel_shift_by_row;
+
+    // a column window, a random mask within it and nothing left
+    const std::vector<std::pair<size_t, bool>> masks{
+        {700, false}, {700, true}, {300, false}};
+    for (const auto& mask : masks) {
+        LidarScan ls = get_random_lidar_scan(si);
+        mask_scan(ls, 300, mask.first, mask.second);
+        for (auto inner : std::vector<std::shared_ptr<LidarScanEncoder>>{
+                 std::make_shared<PngLidarScanEncoder>(
+                     DEFAULT_PNG_OSF_ZLIB_COMPRESSION_LEVEL),
+                 std::make_shared<ZstdLidarScanEncoder>(),
+                 std::make_shared<BandedLidarScanEncoder>(
+                     std::make_shared<ZstdLidarScanEncoder>(), 32)}) {
+            SparseLidarScanEncoder encoder(inner);
+            const auto field_types = ls.field_types();
+            LidarScan decoded(ls.w, ls.h, field_types.begin(),
+                              field_types.end());
+            ScanData scan_data(field_types.size());
+            size_t idx = 0;
+            for (const auto& ft : field_types) {
+                ASSERT_FALSE(
+                    encoder.fieldEncode(ls, ft, px_offset, scan_data, idx));
+                EXPECT_TRUE(is_sparse_buffer(scan_data[idx]));
+                ASSERT_FALSE(
+                    fieldDecode(decoded, scan_data, idx, ft, px_offset));
+                EXPECT_TRUE(ls.field(ft.name) == decoded.field(ft.name));
+                idx++;
+            }
+        }
+    }
+}
+
+TEST_F(OsfSparseToolsTest, CustomFieldEncodeDecode) {
+    auto test_field_encoding = [](const ouster::Field& f, bool sparse) {
+        SparseLidarScanEncoder encoder(std::make_shared<PngLidarScanEncoder>(
+            DEFAULT_PNG_OSF_ZLIB_COMPRESSION_LEVEL));
+        ScanChannelData compressed;
+        EXPECT_NO_THROW({ compressed = encoder.encodeField(f); });
+        EXPECT_EQ(is_sparse_buffer(compressed), sparse);
+        Field decoded(f.desc());
+        EXPECT_NO_THROW({ decodeField(decoded, compressed); });
+        EXPECT_EQ(f, decoded);
+    };
+
+    std::mt19937 gen{3};
+    std::uniform_int_distribution<uint16_t> ud_u16{1, 4096};
+    // dense fields are stored as the inner encoder stores them
+    test_field_encoding(randomized_field<uint16_t>(gen, ud_u16, {37, 512}),
+                        false);
+    std::normal_distribution<float> nd_f{100.f, 10.f};
+    test_field_encoding(randomized_field<float>(gen, nd_f, {4096}), false);
+
+    Field cropped = randomized_field<uint16_t>(gen, ud_u16, {64, 128});
+    uint16_t* p = cropped.get<uint16_t>();
+    for (size_t i = 0; i < 64 * 128; i++) {
+        if (i / 128 < 10 || i % 128 > 100 || i % 3) p[i] = 0;
+    }
+    test_field_encoding(cropped, true);
+
+    Field empty(fd_array<uint32_t>(16, 16));
+    test_field_encoding(empty, true);
+}
+
+TEST_F(OsfSparseToolsTest, RejectsBadBuffers) {
+    EXPECT_THROW(SparseLidarScanEncoder(nullptr), std::invalid_argument);
+
+    SparseLidarScanEncoder encoder(std::make_shared<ZstdLidarScanEncoder>());
+    Field f(fd_array<uint16_t>(32, 64));
+    f.get<uint16_t>()[5 * 64 + 7] = 42;
+    ScanChannelData buffer = encoder.encodeField(f);
+    ASSERT_TRUE(is_sparse_buffer(buffer));
+
+    img_t<uint16_t> img(32, 64);
+    EXPECT_FALSE(decodeSparseImage<uint16_t>(img, buffer, nullptr));
+    EXPECT_EQ(img(5, 7), 42);
+    EXPECT_EQ(img.sum(), 42);
+
+    // box outside of the image
+    img_t<uint16_t> smaller(4, 64);
+    EXPECT_TRUE(decodeSparseImage<uint16_t>(smaller, buffer, nullptr));
+
+    // truncated header
+    ScanChannelData truncated(buffer.begin(), buffer.begin() + 8);
+    EXPECT_TRUE(decodeSparseImage<uint16_t>(img, truncated, nullptr));
+}
+
+TEST_F(OsfSparseToolsTest, ReadsSparseStreams) {
+    const sensor_info si = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    LidarScan ls = get_random_lidar_scan(si);
+    mask_scan(ls, 256, 512, false);
+    std::string output_osf_filename = tmp_file("sparse_streams.osf");
+
+    auto encoder = std::make_shared<Encoder>(
+        std::make_shared<SparseLidarScanEncoder>(
+            std::make_shared<PngLidarScanEncoder>(
+                DEFAULT_PNG_OSF_ZLIB_COMPRESSION_LEVEL)));
+    {
+        Writer writer(output_osf_filename, {si}, {}, 0, encoder);
+        writer.save(0, ls, ts_t{1});
+        writer.close();
+    }
+
+    OsfFile osf_file(output_osf_filename);
+    Reader reader(osf_file);
+    auto msg_it = reader.messages().begin();
+    ASSERT_NE(msg_it, reader.messages().end());
+    auto ls_recovered = msg_it->decode_msg<LidarScanStream>();
+    ASSERT_TRUE(ls_recovered);
+    EXPECT_EQ(*ls_recovered, ls);
+}
+
+}  // namespace
+}  // namespace osf
+}  // namespace ouster
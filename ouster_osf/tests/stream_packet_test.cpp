@@ -0,0 +1,139 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/osf/stream_packet.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+#include "common.h"
+#include "osf_test.h"
+#include "ouster/osf/meta_lidar_sensor.h"
+#include "ouster/osf/reader.h"
+#include "ouster/osf/writer.h"
+#include "ouster/pcap.h"
+
+namespace ouster {
+namespace osf {
+namespace {
+
+class PacketStreamTest : public osf::OsfTestWithDataAndFiles {
+   protected:
+    void SetUp() override {
+        OsfTestWithDataAndFiles::SetUp();
+        pcap_file_ = path_concat(test_data_dir(),
+                                 "pcaps/OS-1-128_v2.3.0_1024x10_lb_n3.pcap");
+        info_ = sensor::metadata_from_json(path_concat(
+            test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    }
+
+    /**
+     * Record the lidar and IMU packets of the pcap, returning the scans they
+     * are batched into.
+     */
+    std::vector<LidarScan> record(const std::string& osf_file,
+                                  int compression_level) {
+        std::vector<LidarScan> batched;
+        Writer writer(osf_file, info_);
+        writer.set_packet_compression(compression_level);
+        sensor_utils::PcapReader pcap(pcap_file_);
+        ScanBatcher batcher(info_);
+        sensor::packet_format pf(info_);
+        LidarScan ls(info_);
+        sensor::LidarPacket lidar_packet;
+        sensor::ImuPacket imu_packet;
+        while (pcap.next_packet()) {
+            const auto& pinfo = pcap.current_info();
+            const uint64_t ts = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    pinfo.timestamp)
+                    .count());
+            const uint8_t* data = pcap.current_data();
+            sensor::Packet* packet = nullptr;
+            if (pinfo.dst_port == *info_.config.udp_port_lidar &&
+                pinfo.payload_size == pf.lidar_packet_size) {
+                packet = &lidar_packet;
+                if (batcher(data, ts, ls)) batched.push_back(ls);
+            } else if (pinfo.dst_port == *info_.config.udp_port_imu &&
+                       pinfo.payload_size == pf.imu_packet_size) {
+                packet = &imu_packet;
+            } else {
+                continue;
+            }
+            packet->host_timestamp = ts;
+            packet->buf.assign(data, data + pinfo.payload_size);
+            writer.save_packet(0, *packet);
+        }
+        writer.close();
+        return batched;
+    }
+
+    std::string pcap_file_;
+    sensor::sensor_info info_;
+};
+
+TEST_F(PacketStreamTest, PacketsBatchIntoScansOnRead) {
+    for (const int level : {0, 1}) {
+        const std::string osf_file =
+            tmp_file("packets_" + std::to_string(level) + ".osf");
+        const std::vector<LidarScan> batched = record(osf_file, level);
+        ASSERT_FALSE(batched.empty());
+
+        Reader reader(osf_file);
+        auto streams = reader.meta_store().find<PacketStreamMeta>();
+        ASSERT_EQ(streams.size(), 1u);
+        EXPECT_EQ(streams.begin()->second->compression_level(), level);
+        EXPECT_EQ(streams.begin()->second->sensor_meta_id(),
+                  reader.meta_store().find<LidarSensor>().begin()->first);
+
+        PacketScanReader scans(reader);
+        ASSERT_EQ(scans.stream_ids().size(), 1u);
+        size_t cnt = 0;
+        DecodedScan scan;
+        while (scans.next(scan)) {
+            ASSERT_LT(cnt, batched.size());
+            ASSERT_TRUE(scan.scan);
+            const LidarScan& expected = batched[cnt];
+            EXPECT_EQ(scan.stream_id, scans.stream_ids()[0]);
+            EXPECT_EQ(scan.ts,
+                      ts_t{expected.get_first_valid_packet_timestamp()});
+            EXPECT_EQ(*scan.scan, expected);
+            cnt++;
+        }
+        EXPECT_EQ(cnt, batched.size());
+    }
+}
+
+TEST_F(PacketStreamTest, ReadsSelectedFields) {
+    const std::string osf_file = tmp_file("packets_fields.osf");
+    const std::vector<LidarScan> batched = record(osf_file, 0);
+    ASSERT_FALSE(batched.empty());
+
+    Reader reader(osf_file);
+    PacketScanReader scans(reader, {}, reader.start_ts(), reader.end_ts(),
+                           {sensor::ChanField::RANGE});
+    DecodedScan scan;
+    ASSERT_TRUE(scans.next(scan));
+    EXPECT_EQ(scan.scan->fields().size(), 1u);
+    EXPECT_TRUE((scan.scan->field(sensor::ChanField::RANGE) ==
+                 batched[0].field(sensor::ChanField::RANGE)));
+
+    // only packet streams are batched
+    EXPECT_THROW(PacketScanReader(reader, {12345}), std::invalid_argument);
+}
+
+TEST_F(PacketStreamTest, RejectsBadPackets) {
+    const std::string osf_file = tmp_file("packets_bad.osf");
+    Writer writer(osf_file, info_);
+    sensor::LidarPacket packet;
+    EXPECT_THROW(writer.save_packet(1, packet), std::logic_error);
+    writer.close();
+    EXPECT_THROW(writer.save_packet(0, packet), std::logic_error);
+}
+
+}  // namespace
+}  // namespace osf
+}  // namespace ouster
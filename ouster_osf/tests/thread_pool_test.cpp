@@ -0,0 +1,93 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/osf/thread_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace ouster {
+namespace osf {
+namespace {
+
+class ThreadPoolTest : public ::testing::Test {};
+
+TEST_F(ThreadPoolTest, RunsEveryTaskOnce) {
+    ThreadPool pool(3);
+    std::vector<std::atomic<int>> runs(1000);
+    pool.parallel_for(runs.size(), [&](size_t i) { runs[i]++; });
+    for (const auto& r : runs) EXPECT_EQ(r, 1);
+
+    // nothing to do
+    pool.parallel_for(0, [&](size_t) { FAIL(); });
+
+    // the caller alone
+    ThreadPool inline_pool(1);
+    std::atomic<int> sum{0};
+    inline_pool.parallel_for(10, [&](size_t i) { sum += static_cast<int>(i); });
+    EXPECT_EQ(sum, 45);
+}
+
+#ifndef OUSTER_OSF_NO_THREADING
+
+TEST_F(ThreadPoolTest, SharedByConcurrentAndNestedCallers) {
+    auto pool = std::make_shared<ThreadPool>(2);
+    std::atomic<int> count{0};
+    std::vector<std::thread> callers;
+    for (int c = 0; c < 4; c++) {
+        callers.emplace_back([&] {
+            for (int k = 0; k < 20; k++) {
+                pool->parallel_for(8, [&](size_t) {
+                    pool->parallel_for(4, [&](size_t) { count++; });
+                });
+            }
+        });
+    }
+    for (auto& t : callers) t.join();
+    EXPECT_EQ(count, 4 * 20 * 8 * 4);
+}
+
+#endif
+
+TEST_F(ThreadPoolTest, PropagatesExceptionsAfterAllTasks) {
+    ThreadPool pool(2);
+    std::atomic<int> count{0};
+    EXPECT_THROW(pool.parallel_for(50,
+                                   [&](size_t i) {
+                                       count++;
+                                       if (i == 7)
+                                           throw std::invalid_argument("bad");
+                                   }),
+                 std::invalid_argument);
+    EXPECT_EQ(count, 50);
+}
+
+TEST_F(ThreadPoolTest, SubmittedTasksRunBeforeDestruction) {
+    std::atomic<int> count{0};
+    {
+        ThreadPool pool(2);
+        for (int k = 0; k < 100; k++) {
+            pool.submit([&] { pool.parallel_for(3, [&](size_t) { count++; }); });
+        }
+    }
+    EXPECT_EQ(count, 300);
+}
+
+TEST_F(ThreadPoolTest, DefaultPoolCanBeReplaced) {
+    auto pool = std::make_shared<ThreadPool>(1);
+    set_default_thread_pool(pool);
+    EXPECT_EQ(default_thread_pool(), pool);
+    set_default_thread_pool(nullptr);
+    EXPECT_NE(default_thread_pool(), pool);
+    EXPECT_NE(default_thread_pool(), nullptr);
+}
+
+}  // namespace
+}  // namespace osf
+}  // namespace ouster
@@ -7,15 +7,21 @@
 
 #include <gtest/gtest.h>
 
+#include <map>
+#include <stdexcept>
 #include <string>
 
 #include "common.h"
 #include "osf_test.h"
 #include "ouster/lidar_scan.h"
+#include "ouster/osf/async_writer.h"
 #include "ouster/osf/file.h"
 #include "ouster/osf/meta_extrinsics.h"
 #include "ouster/osf/meta_lidar_sensor.h"
+#include "ouster/osf/meta_recording_gaps.h"
 #include "ouster/osf/meta_streaming_info.h"
+#include "ouster/osf/osf_encoder.h"
+#include "ouster/osf/png_lidarscan_encoder.h"
 #include "ouster/osf/reader.h"
 #include "ouster/osf/stream_lidar_scan.h"
 #include "ouster/types.h"
@@ -560,6 +566,354 @@ TEST_F(WriterTest, WriteCustomFieldsTest) {
     EXPECT_EQ(*ls_recovered, ls);
 }
 
+TEST_F(WriterTest, AsyncWriterKeepsSaveOrder) {
+    const sensor_info sinfo = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    std::string output_osf_filename = tmp_file("async_writer_order.osf");
+
+    const int LOOP_CNT = 12;
+    std::map<ts_t, LidarScan> saved;
+    {
+        AsyncWriter writer(output_osf_filename, {sinfo, sinfo}, {}, 0,
+                           nullptr, 3);
+        std::vector<std::future<void>> results;
+        for (int i = 0; i < LOOP_CNT; i++) {
+            LidarScan ls = get_random_lidar_scan(sinfo);
+            saved.emplace(ts_t{i + 1}, ls);
+            results.push_back(writer.save(i % 2, ls, ts_t{i + 1}));
+        }
+        for (auto& r : results) r.get();
+        writer.close();
+        EXPECT_EQ(writer.dropped(), 0);
+    }
+
+    OsfFile osf_file(output_osf_filename);
+    EXPECT_TRUE(osf_file.good());
+    Reader reader(osf_file);
+    int cnt = 0;
+    ts_t last{0};
+    for (const auto msg : reader.messages()) {
+        EXPECT_GT(msg.ts(), last);
+        last = msg.ts();
+        auto ls_recovered = msg.decode_msg<LidarScanStream>();
+        ASSERT_TRUE(ls_recovered);
+        EXPECT_EQ(*ls_recovered, saved.at(msg.ts()));
+        cnt++;
+    }
+    EXPECT_EQ(cnt, LOOP_CNT);
+}
+
+TEST_F(WriterTest, AsyncWriterDropsWhenFull) {
+    const sensor_info sinfo = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    std::string output_osf_filename = tmp_file("async_writer_drop.osf");
+
+    EXPECT_THROW(AsyncWriter(output_osf_filename, {sinfo}, {}, 0, nullptr, 0),
+                 std::invalid_argument);
+
+    const int LOOP_CNT = 20;
+    LidarScan ls = get_random_lidar_scan(sinfo);
+    AsyncWriter writer(output_osf_filename, {sinfo}, {}, 0, nullptr, 1,
+                       AsyncWriter::OverflowPolicy::DROP);
+    int dropped = 0;
+    std::vector<std::future<void>> results;
+    for (int i = 0; i < LOOP_CNT; i++) {
+        results.push_back(writer.save(0, ls, ts_t{i + 1}));
+    }
+    for (auto& r : results) {
+        try {
+            r.get();
+        } catch (const std::overflow_error&) {
+            dropped++;
+        }
+    }
+    writer.close();
+    EXPECT_EQ(writer.dropped(), static_cast<size_t>(dropped));
+
+    OsfFile osf_file(output_osf_filename);
+    Reader reader(osf_file);
+    EXPECT_EQ(LOOP_CNT - dropped, std::distance(reader.messages().begin(),
+                                                reader.messages().end()));
+}
+
+TEST_F(WriterTest, AsyncWriterSpillsWhenFull) {
+    const sensor_info sinfo = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    std::string output_osf_filename = tmp_file("async_writer_spill.osf");
+    std::string spill_filename = tmp_file("async_writer_spill.scratch");
+
+    const int LOOP_CNT = 20;
+    std::vector<LidarScan> saved;
+    for (int i = 0; i < LOOP_CNT; i++) {
+        saved.push_back(get_random_lidar_scan(sinfo));
+    }
+    {
+        auto encoder = std::make_shared<Encoder>(
+            std::make_shared<PngLidarScanEncoder>(1));
+        encoder->set_keyframe_interval(4);
+        AsyncWriter writer(output_osf_filename, {sinfo}, {}, 0, encoder, 4,
+                           AsyncWriter::OverflowPolicy::SPILL);
+        writer.set_spill_file(spill_filename);
+        // room for a single scan in flight
+        writer.set_memory_limit(1);
+        std::vector<std::future<void>> results;
+        // saved faster than they're encoded, so all but the first spill
+        for (int i = 0; i < LOOP_CNT; i++) {
+            results.push_back(writer.save(0, saved[i], ts_t{i + 1}));
+        }
+        for (auto& r : results) r.get();
+        writer.close();
+        EXPECT_EQ(writer.dropped(), 0);
+        EXPECT_GT(writer.spilled(), 0);
+        EXPECT_EQ(writer.stats().spill_backlog, 0);
+        EXPECT_EQ(writer.stats().in_flight_bytes, 0);
+    }
+    EXPECT_FALSE(path_exists(spill_filename));
+
+    // spilled scans are written in the order they were saved
+    OsfFile osf_file(output_osf_filename);
+    Reader reader(osf_file);
+    int cnt = 0;
+    for (const auto msg : reader.messages()) {
+        EXPECT_EQ(msg.ts(), ts_t{cnt + 1});
+        auto ls_recovered = msg.decode_msg<LidarScanStream>();
+        ASSERT_TRUE(ls_recovered);
+        EXPECT_EQ(*ls_recovered, saved[cnt]);
+        cnt++;
+    }
+    EXPECT_EQ(cnt, LOOP_CNT);
+}
+
+TEST_F(WriterTest, WriteKeyframeGroups) {
+    const sensor_info sinfo = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    std::string output_osf_filename = tmp_file("writer_keyframes.osf");
+
+    auto encoder =
+        std::make_shared<Encoder>(std::make_shared<PngLidarScanEncoder>(1));
+    encoder->set_keyframe_interval(4);
+    const int LOOP_CNT = 10;
+    std::vector<LidarScan> saved;
+    {
+        // every keyframe finishes the chunk, delta frames never do
+        Writer writer(output_osf_filename, sinfo, {}, 1, encoder);
+        for (int i = 0; i < LOOP_CNT; i++) {
+            saved.push_back(get_random_lidar_scan(sinfo));
+            writer.save(0, saved.back(), ts_t{i + 1});
+        }
+    }
+
+    OsfFile osf_file(output_osf_filename);
+    Reader reader(osf_file);
+    std::vector<size_t> chunk_sizes;
+    for (const auto& chunk : reader.chunks()) {
+        chunk_sizes.push_back(chunk.size());
+        // delta frames decode on their own, not only after their keyframe
+        for (size_t i = chunk.size(); i-- > 0;) {
+            auto msg = chunk.messages(i);
+            ASSERT_TRUE(msg);
+            auto ls_recovered = msg->decode_msg<LidarScanStream>();
+            ASSERT_TRUE(ls_recovered);
+            EXPECT_EQ(*ls_recovered,
+                      saved.at(static_cast<size_t>(msg->ts().count() - 1)));
+        }
+    }
+    EXPECT_EQ(chunk_sizes, (std::vector<size_t>{4, 4, 2}));
+}
+
+TEST_F(WriterTest, DecodeFieldSubset) {
+    const sensor_info sinfo = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    std::string output_osf_filename = tmp_file("writer_field_subset.osf");
+
+    auto encoder =
+        std::make_shared<Encoder>(std::make_shared<PngLidarScanEncoder>(1));
+    encoder->set_keyframe_interval(2);
+    std::vector<LidarScan> saved;
+    {
+        Writer writer(output_osf_filename, sinfo, {}, 1, encoder);
+        for (int i = 0; i < 4; i++) {
+            saved.push_back(get_random_lidar_scan(sinfo));
+            writer.save(0, saved.back(), ts_t{i + 1});
+        }
+    }
+
+    ouster::LidarScanFieldTypes field_types;
+    field_types.emplace_back(saved[0].field_type(sensor::ChanField::RANGE));
+    field_types.emplace_back(
+        saved[0].field_type(sensor::ChanField::REFLECTIVITY));
+
+    OsfFile osf_file(output_osf_filename);
+    Reader reader(osf_file);
+    size_t cnt = 0;
+    // keyframes and delta frames decode only the requested fields
+    for (const auto& msg : reader.messages()) {
+        auto ls_recovered =
+            msg.decode_msg<LidarScanStream>({"RANGE", "REFLECTIVITY"});
+        ASSERT_TRUE(ls_recovered);
+        EXPECT_EQ(field_types.size(), ls_recovered->field_types().size());
+        EXPECT_EQ(*ls_recovered, slice_with_cast(saved.at(cnt), field_types));
+        EXPECT_THROW(msg.decode_msg<LidarScanStream>({"NOT_A_FIELD"}),
+                     std::runtime_error);
+        ++cnt;
+    }
+    EXPECT_EQ(cnt, saved.size());
+}
+
+TEST_F(WriterTest, WriteWithChunkPolicies) {
+    const sensor_info sinfo = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    std::string output_osf_filename = tmp_file("writer_chunk_policies.osf");
+
+    auto chunk_sizes = [&](const ChunkPolicy& policy, bool per_sensor) {
+        {
+            Writer writer(output_osf_filename, sinfo);
+            EXPECT_EQ(writer.chunk_policy(0).max_size, writer.chunk_size());
+            if (per_sensor) {
+                writer.set_sensor_chunk_policy(0, policy);
+            } else {
+                writer.set_chunk_policy(policy);
+            }
+            for (int i = 0; i < 10; i++) {
+                writer.save(0, get_random_lidar_scan(sinfo), ts_t{i + 1});
+            }
+        }
+        OsfFile osf_file(output_osf_filename);
+        Reader reader(osf_file);
+        std::vector<size_t> sizes;
+        for (const auto& chunk : reader.chunks()) sizes.push_back(chunk.size());
+        return sizes;
+    };
+
+    EXPECT_EQ(chunk_sizes({0, 3, ts_t{0}}, true),
+              (std::vector<size_t>{3, 3, 3, 1}));
+    // the span of receive timestamps 1 .. 4 is 3
+    EXPECT_EQ(chunk_sizes({0, 0, ts_t{3}}, false),
+              (std::vector<size_t>{4, 4, 2}));
+    EXPECT_EQ(chunk_sizes({1, 0, ts_t{0}}, false),
+              std::vector<size_t>(10, 1));
+    EXPECT_EQ(chunk_sizes({0, 0, ts_t{0}}, true), std::vector<size_t>{10});
+
+    Writer writer(output_osf_filename, sinfo);
+    EXPECT_THROW(writer.set_sensor_chunk_policy(1, {}), std::logic_error);
+}
+
+TEST_F(WriterTest, WriteWithScanGate) {
+    const sensor_info sinfo = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    std::string output_osf_filename = tmp_file("writer_scan_gate.osf");
+
+    // a static scene, the same scan over and over
+    LidarScan scan = get_random_lidar_scan(sinfo);
+    {
+        Writer writer(output_osf_filename, sinfo);
+        EXPECT_EQ(writer.scan_gate(0), nullptr);
+        writer.set_scan_gate(ScanGateOptions{});
+        for (int i = 0; i < 10; i++) {
+            scan.frame_id = i;
+            writer.save(0, scan, ts_t{i + 1});
+        }
+        ASSERT_NE(writer.scan_gate(0), nullptr);
+        EXPECT_EQ(writer.scan_gate(0)->kept(), 1u);
+    }
+
+    OsfFile osf_file(output_osf_filename);
+    Reader reader(osf_file);
+    size_t saved = 0;
+    for (const auto& msg : reader.messages()) {
+        EXPECT_EQ(msg.decode_msg<LidarScanStream>()->frame_id, 0);
+        saved++;
+    }
+    EXPECT_EQ(saved, 1u);
+
+    auto gaps = reader.meta_store().find<RecordingGaps>();
+    ASSERT_EQ(gaps.size(), 1u);
+    const auto& gap = gaps.begin()->second;
+    EXPECT_EQ(gap->kept(), 1u);
+    EXPECT_EQ(gap->skipped(), 9u);
+    ASSERT_EQ(gap->spans().size(), 1u);
+    EXPECT_EQ(gap->spans()[0].first_frame_id, 1);
+    EXPECT_EQ(gap->spans()[0].last_frame_id, 9);
+    auto sensors = reader.meta_store().find<LidarSensor>();
+    EXPECT_EQ(gap->ref_meta_id(), sensors.begin()->first);
+
+    Writer writer(output_osf_filename, sinfo);
+    ScanGateOptions options;
+    options.stride = 0;
+    EXPECT_THROW(writer.set_scan_gate(options), std::invalid_argument);
+}
+
+TEST_F(WriterTest, ChunkBuilderReusesBuffer) {
+    const std::vector<uint8_t> msg(100 * 1024, 7);
+    ChunkBuilder builder(1024 * 1024);
+    const uint8_t* end = nullptr;
+    std::vector<uint8_t> first;
+    for (int chunk = 0; chunk < 3; chunk++) {
+        for (int i = 0; i < 8; i++) {
+            builder.save_message(1, ts_t{i}, ts_t{i}, msg);
+        }
+        const uint32_t size = builder.finish_in_place();
+        ASSERT_GT(size, 8 * msg.size());
+        // the same chunk is serialized at the end of the same buffer
+        if (chunk == 0) {
+            end = builder.data() + size;
+            first = builder.finish();
+            EXPECT_EQ(first.size(), size);
+        } else {
+            EXPECT_EQ(builder.data() + size, end);
+            EXPECT_EQ(std::vector<uint8_t>(builder.data(),
+                                           builder.data() + size),
+                      first);
+        }
+        builder.reset();
+    }
+    EXPECT_EQ(builder.finish_in_place(), 0u);
+    EXPECT_TRUE(builder.finish().empty());
+}
+
+TEST_F(WriterTest, WriteWithChunkIo) {
+    const sensor_info sinfo = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+
+    std::vector<ChunkIoOptions> configs(3);
+    configs[1].background = true;
+    configs[1].preallocate_bytes = 1024 * 1024;
+    configs[2].sync_every_chunk = true;
+#ifdef __linux__
+    configs[2].direct = true;
+#endif
+
+    const int LOOP_CNT = 5;
+    for (size_t c = 0; c < configs.size(); c++) {
+        std::string output_osf_filename =
+            tmp_file("writer_chunk_io_" + std::to_string(c) + ".osf");
+        std::vector<LidarScan> saved;
+        {
+            // a chunk per scan
+            Writer writer(output_osf_filename, sinfo, {}, 1);
+            writer.set_chunk_io(configs[c]);
+            for (int i = 0; i < LOOP_CNT; i++) {
+                saved.push_back(get_random_lidar_scan(sinfo));
+                writer.save(0, saved.back(), ts_t{i + 1});
+            }
+            EXPECT_THROW(writer.set_chunk_io(configs[c]), std::logic_error);
+        }
+
+        OsfFile osf_file(output_osf_filename);
+        // padding and preallocated space would fail the file length check
+        ASSERT_TRUE(osf_file.valid());
+        Reader reader(osf_file);
+        size_t cnt = 0;
+        for (const auto msg : reader.messages()) {
+            auto ls_recovered = msg.decode_msg<LidarScanStream>();
+            ASSERT_TRUE(ls_recovered);
+            EXPECT_EQ(*ls_recovered, saved.at(cnt));
+            cnt++;
+        }
+        EXPECT_EQ(cnt, saved.size());
+    }
+}
+
 }  // namespace
 }  // namespace osf
 }  // namespace ouster
@@ -0,0 +1,116 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "zstd_tools.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "common.h"
+#include "osf_test.h"
+#include "ouster/lidar_scan.h"
+#include "ouster/osf/file.h"
+#include "ouster/osf/png_lidarscan_encoder.h"
+#include "ouster/osf/reader.h"
+#include "ouster/osf/stream_lidar_scan.h"
+#include "ouster/osf/writer.h"
+#include "ouster/osf/zstd_lidarscan_encoder.h"
+#include "ouster/types.h"
+#include "png_tools.h"
+
+namespace ouster {
+namespace osf {
+namespace {
+
+class OsfZstdToolsTest : public OsfTestWithDataAndFiles {};
+
+using ouster::sensor::sensor_info;
+
+TEST_F(OsfZstdToolsTest, ImageRoundTrip) {
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<uint32_t> ud{0, 200000};
+    img_t<uint32_t> img(16, 64);
+    for (Eigen::Index i = 0; i < img.size(); i++) img.data()[i] = ud(gen);
+    std::vector<int> px_offset(16);
+    for (size_t u = 0; u < px_offset.size(); u++)
+        px_offset[u] = static_cast<int>(u % 4) * 12 - 7;
+
+    // destaggering is fused into the filter
+    ScanChannelData staggered, destaggered;
+    ASSERT_FALSE(encodeZstdImage<uint32_t>(staggered, img, px_offset, 1));
+    ASSERT_FALSE(encodeZstdImage<uint32_t>(
+        destaggered, destagger<uint32_t>(img, px_offset), 1));
+    EXPECT_EQ(staggered, destaggered);
+    EXPECT_TRUE(is_zstd_buffer(staggered));
+
+    img_t<uint32_t> decoded(16, 64);
+    ASSERT_FALSE(decodeZstdImage<uint32_t>(decoded, staggered, px_offset));
+    EXPECT_TRUE((decoded == img).all());
+
+    // wrong shape or corrupt buffer
+    img_t<uint32_t> wrong(16, 32);
+    EXPECT_TRUE(decodeZstdImage<uint32_t>(wrong, staggered));
+    staggered.resize(staggered.size() / 2);
+    EXPECT_TRUE(decodeZstdImage<uint32_t>(decoded, staggered));
+}
+
+TEST_F(OsfZstdToolsTest, FieldEncodeDecode) {
+    auto test_field_encoding = [](const ouster::Field& f) {
+        ZstdLidarScanEncoder encoder;
+        ScanChannelData compressed;
+        EXPECT_NO_THROW({ compressed = encoder.encodeField(f); });
+        Field decoded(f.desc());
+        EXPECT_NO_THROW({ decodeField(decoded, compressed); });
+        EXPECT_EQ(f, decoded);
+    };
+
+    std::mt19937 gen{3};
+    std::normal_distribution<float> nd_f{100.f, 10.f};
+    test_field_encoding(randomized_field<float>(gen, nd_f, {128, 1024, 3}));
+    test_field_encoding(randomized_field<float>(gen, nd_f, {4096}));
+    std::uniform_int_distribution<uint16_t> ud_u16{0, 4096};
+    test_field_encoding(randomized_field<uint16_t>(gen, ud_u16, {64, 512}));
+    std::uniform_int_distribution<int> ud_u8{0, 255};
+    test_field_encoding(randomized_field<uint8_t>(gen, ud_u8, {64, 512, 2}));
+}
+
+TEST_F(OsfZstdToolsTest, ReadsZstdAndPngStreams) {
+    const sensor_info si = sensor::metadata_from_json(
+        path_concat(test_data_dir(), "pcaps/OS-1-128_v2.3.0_1024x10.json"));
+    LidarScan zstd_scan = get_random_lidar_scan(si);
+    LidarScan png_scan = get_random_lidar_scan(si);
+    std::string output_osf_filename = tmp_file("zstd_and_png_streams.osf");
+
+    // the first stream is zstd encoded, the second keeps the default PNG
+    auto encoder = std::make_shared<Encoder>(
+        std::make_shared<PngLidarScanEncoder>(
+            DEFAULT_PNG_OSF_ZLIB_COMPRESSION_LEVEL));
+    encoder->set_lidar_scan_encoder(0,
+                                    std::make_shared<ZstdLidarScanEncoder>());
+    {
+        Writer writer(output_osf_filename, {si, si}, {}, 0, encoder);
+        writer.save(0, zstd_scan, ts_t{1});
+        writer.save(1, png_scan, ts_t{2});
+        writer.close();
+    }
+
+    OsfFile osf_file(output_osf_filename);
+    Reader reader(osf_file);
+    auto msg_it = reader.messages().begin();
+    ASSERT_NE(msg_it, reader.messages().end());
+    auto ls_recovered = msg_it->decode_msg<LidarScanStream>();
+    ASSERT_TRUE(ls_recovered);
+    EXPECT_EQ(*ls_recovered, zstd_scan);
+
+    ASSERT_NE(++msg_it, reader.messages().end());
+    ls_recovered = msg_it->decode_msg<LidarScanStream>();
+    ASSERT_TRUE(ls_recovered);
+    EXPECT_EQ(*ls_recovered, png_scan);
+}
+
+}  // namespace
+}  // namespace osf
+}  // namespace ouster
@@ -0,0 +1,170 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Records UDP packets to pcap files on a writer thread
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ouster/pcap.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace sensor_utils {
+
+struct async_pcap_writer_impl;
+
+/**
+ * Options of an AsyncPcapWriter.
+ */
+struct OUSTER_API_CLASS AsyncPcapWriterOptions {
+    /// The link layer of the records, ETHERNET or SLL
+    PcapWriter::PacketEncapsulation encap{PcapWriter::ETHERNET};
+
+    /// The largest IPv4 packet, UDP datagrams are fragmented to fit in it; 0
+    /// to record them unfragmented
+    uint16_t mtu{0};
+
+    /// The packets buffered for the writer thread. When the buffer is full
+    /// the oldest packet is dropped, so that writing packets never waits on
+    /// the disk.
+    size_t buffer_packets{4096};
+
+    /// The most packets written to the file by one vectored write
+    size_t write_batch{256};
+
+    /// Start a new file before a packet that would make the file larger than
+    /// this many bytes, 0 to not rotate by size
+    uint64_t rotate_bytes{0};
+
+    /// Start a new file before a packet captured this long after the first
+    /// one of the file, 0 to not rotate by time
+    std::chrono::microseconds rotate_interval{0};
+};
+
+/**
+ * The counters of an AsyncPcapWriter.
+ */
+struct OUSTER_API_CLASS AsyncPcapWriterStats {
+    uint64_t packets{0};       ///< packets written to the files
+    uint64_t records{0};       ///< records written, one per IPv4 fragment
+    uint64_t bytes{0};         ///< bytes written to the files
+    uint64_t dropped{0};       ///< packets dropped from the full buffer
+    uint64_t write_errors{0};  ///< packets lost to failed writes
+    uint64_t files{0};         ///< files opened
+};
+
+/**
+ * Records UDP packets to pcap files without blocking the thread writing
+ * them.
+ *
+ * Packets are formatted into pcap records on the calling thread and handed
+ * to a writer thread through a lock-free buffer of reusable slots, which
+ * writes them out in batches with vectored writes. A slow disk only makes
+ * the oldest buffered packets be dropped, which is counted. Files can be
+ * rotated by size or by capture time: the first file has the given name
+ * and the following ones the name with _1, _2, ... before its extension.
+ *
+ * Packets must be written from one thread at a time.
+ */
+class OUSTER_API_CLASS AsyncPcapWriter {
+   public:
+    /**
+     * Open the first file and start the writer thread.
+     *
+     * @throws std::invalid_argument if the options aren't valid.
+     * @throws std::runtime_error if the file can't be opened.
+     *
+     * @param[in] file The path of the first file.
+     * @param[in] options The options of the writer.
+     */
+    OUSTER_API_FUNCTION
+    AsyncPcapWriter(const std::string& file,
+                    const AsyncPcapWriterOptions& options = {});
+
+    /**
+     * Write out the buffered packets and close the file, ignoring errors.
+     */
+    OUSTER_API_FUNCTION
+    ~AsyncPcapWriter();
+
+    AsyncPcapWriter(const AsyncPcapWriter&) = delete;
+    AsyncPcapWriter& operator=(const AsyncPcapWriter&) = delete;
+
+    /**
+     * Buffer a packet to be written as a UDP datagram over IPv4.
+     *
+     * @throws std::invalid_argument if an address isn't an IPv4 address or
+     *         the payload doesn't fit in a UDP datagram.
+     * @throws std::logic_error if the writer was closed.
+     *
+     * @param[in] buf The payload of the packet.
+     * @param[in] buf_size The size of the payload.
+     * @param[in] src_ip The source IPv4 address.
+     * @param[in] dst_ip The destination IPv4 address.
+     * @param[in] src_port The source port.
+     * @param[in] dst_port The destination port.
+     * @param[in] timestamp The capture timestamp of the packet.
+     *
+     * @return false if an older packet was dropped to make room for it.
+     */
+    OUSTER_API_FUNCTION
+    bool write_packet(const uint8_t* buf, size_t buf_size,
+                      const std::string& src_ip, const std::string& dst_ip,
+                      uint16_t src_port, uint16_t dst_port,
+                      packet_info::ts timestamp);
+
+    /**
+     * Buffer a packet to be written as a UDP datagram over IPv4.
+     *
+     * @param[in] buf The payload of the packet.
+     * @param[in] buf_size The size of the payload.
+     * @param[in] info The addresses, ports and timestamp of the packet.
+     *
+     * @return false if an older packet was dropped to make room for it.
+     */
+    OUSTER_API_FUNCTION
+    bool write_packet(const uint8_t* buf, size_t buf_size,
+                      const packet_info& info);
+
+    /**
+     * Wait for the packets buffered so far to be written to the file.
+     */
+    OUSTER_API_FUNCTION
+    void flush();
+
+    /**
+     * Write out the buffered packets, stop the writer thread and close the
+     * file. Does nothing if already closed.
+     *
+     * @throws std::runtime_error if a write failed.
+     */
+    OUSTER_API_FUNCTION
+    void close();
+
+    /**
+     * @return The counters of the writer.
+     */
+    OUSTER_API_FUNCTION
+    AsyncPcapWriterStats stats() const;
+
+    /**
+     * @return The paths of the files opened so far, in order.
+     */
+    OUSTER_API_FUNCTION
+    std::vector<std::string> files() const;
+
+   private:
+    std::unique_ptr<async_pcap_writer_impl> impl;
+};
+
+}  // namespace sensor_utils
+}  // namespace ouster
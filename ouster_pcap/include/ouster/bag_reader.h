@@ -0,0 +1,140 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file bag_reader.h
+ * @brief Reads the sensor packets of ROS1 bag files natively
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ouster/indexed_pcap_reader.h"
+#include "ouster/types.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace sensor_utils {
+
+struct bag_reader_impl;
+
+/**
+ * Reads the lidar and imu packets recorded by ouster-ros into a ROS1 bag, of
+ * format version 2.0, from the memory mapped file into PacketBatch es like
+ * IndexedPcapReader::read_batch(), without deserializing the messages one by
+ * one.
+ *
+ * Every topic of type ouster_ros/PacketMsg or ouster_sensor_msgs/PacketMsg
+ * with "lidar_packets" in its name is a sensor, in the order they appear in
+ * the bag. Its imu packets and metadata are the first PacketMsg topic with
+ * "imu_packets", and std_msgs/String topic with "metadata", in the same
+ * namespace.
+ *
+ * Only indexed bags with uncompressed chunks are read, see readable(). The
+ * chunk index of the bag is used to find the metadata and to seek by time.
+ */
+class OUSTER_API_CLASS BagPacketReader {
+   public:
+    /**
+     * @throws std::runtime_error if the file isn't readable(), if it has no
+     *                            sensor or a sensor has no metadata.
+     * @throws std::invalid_argument if sensor_infos isn't empty and doesn't
+     *                               hold one sensor info per sensor.
+     *
+     * @param[in] filename The bag file.
+     * @param[in] sensor_infos The sensor info of each sensor, read from the
+     *                         metadata topics of the bag if empty.
+     * @param[in] soft_id_check Keep the packets which don't match the
+     *                          init_id or serial number of their sensor,
+     *                          still counting them as id errors.
+     */
+    OUSTER_API_FUNCTION
+    BagPacketReader(
+        const std::string& filename,
+        const std::vector<ouster::sensor::sensor_info>& sensor_infos = {},
+        bool soft_id_check = false);
+
+    OUSTER_API_FUNCTION
+    ~BagPacketReader();
+
+    BagPacketReader(const BagPacketReader&) = delete;
+    BagPacketReader& operator=(const BagPacketReader&) = delete;
+
+    /**
+     * Check whether a file is a ROS1 bag which can be read natively, i.e. of
+     * format version 2.0, indexed and with uncompressed chunks only. Other
+     * bags, e.g. compressed ones, ROS2 bags or bags of recordings that were
+     * interrupted, have to be read otherwise.
+     *
+     * @param[in] filename The file.
+     * @return true if the file can be read.
+     */
+    OUSTER_API_FUNCTION
+    static bool readable(const std::string& filename);
+
+    /**
+     * @return The sensor info of each sensor.
+     */
+    OUSTER_API_FUNCTION
+    const std::vector<ouster::sensor::sensor_info>& sensor_infos() const;
+
+    /**
+     * @return The lidar packet topic of each sensor.
+     */
+    OUSTER_API_FUNCTION
+    const std::vector<std::string>& lidar_topics() const;
+
+    /**
+     * @return The time of the first message of the bag in nanoseconds.
+     */
+    OUSTER_API_FUNCTION
+    uint64_t start_time() const;
+
+    /**
+     * @return The time of the last message of the bag in nanoseconds.
+     */
+    OUSTER_API_FUNCTION
+    uint64_t end_time() const;
+
+    /**
+     * Read the next sensor packets into a batch, replacing its contents, in
+     * the order they were recorded. The timestamp of the packets is the time
+     * they were recorded at. Messages one byte longer than a packet, as
+     * written by older versions of ouster-ros, are trimmed. Packets failing
+     * validation against their sensor are skipped, unless soft_id_check was
+     * set and only the id doesn't match, and counted in the error counts of
+     * the batch.
+     *
+     * @param[in,out] batch The batch to read into.
+     * @param[in] max_packets The number of sensor packets to read at most.
+     * @return The number of packets read, 0 at the end of the bag.
+     */
+    OUSTER_API_FUNCTION
+    size_t read_batch(PacketBatch& batch, size_t max_packets = 1024);
+
+    /**
+     * Go back to the first packet of the bag.
+     */
+    OUSTER_API_FUNCTION
+    void reset();
+
+    /**
+     * Seek to the first packet recorded at or after a time, starting from
+     * the first chunk of the bag that ends at or after it according to the
+     * chunk index.
+     *
+     * @param[in] ts The time in nanoseconds.
+     */
+    OUSTER_API_FUNCTION
+    void seek_to_time(uint64_t ts);
+
+   private:
+    std::unique_ptr<bag_reader_impl> impl;
+};
+
+}  // namespace sensor_utils
+}  // namespace ouster
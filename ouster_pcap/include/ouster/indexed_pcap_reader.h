@@ -5,7 +5,10 @@
 #pragma once
 
 #include <map>
+#include <memory>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "ouster/os_pcap.h"
 #include "ouster/pcap.h"
@@ -24,21 +27,34 @@ class OUSTER_API_CLASS PcapIndex {
 
     using timestamp_index = std::unordered_map<uint64_t, uint64_t>;
 
-    // TODO: this isn't used for now but in the future might be used to
-    //  solve the issue with the limited frame_id span (we could remove it)
+    // TODO: unordered, seek by time with frame_timestamps_ instead
     std::vector<timestamp_index> frame_timestamp_indices_;
 
     using frame_id_index = std::unordered_map<int32_t, uint64_t>;
 
     // TODO[IMPORTANT]: this has an issue if the recorded pcap file to span
-    // over 50 mins.
+    // over 50 mins, as frame ids repeat. frame_ids_ keeps them in order.
     std::vector<frame_id_index> frame_id_indices_;
 
+    /**
+     * The capture timestamp in microseconds of the first packet of each
+     * frame, in the order of frame_indices_, for each sensor.
+     */
+    std::vector<std::vector<uint64_t>> frame_timestamps_;
+
+    /**
+     * The frame id of each frame, in the order of frame_indices_, for each
+     * sensor.
+     */
+    std::vector<std::vector<uint16_t>> frame_ids_;
+
     OUSTER_API_FUNCTION
     PcapIndex(size_t num_sensors)
         : frame_indices_(num_sensors),
           frame_timestamp_indices_(num_sensors),
-          frame_id_indices_(num_sensors) {}
+          frame_id_indices_(num_sensors),
+          frame_timestamps_(num_sensors),
+          frame_ids_(num_sensors) {}
 
     /**
      * Simple method to clear the index.
@@ -57,6 +73,21 @@ class OUSTER_API_CLASS PcapIndex {
     OUSTER_API_FUNCTION
     size_t frame_count(size_t sensor_index) const;
 
+    /**
+     * Find the frame at a timestamp by binary search in frame_timestamps_,
+     * as capture timestamps increase through the pcap.
+     *
+     * @throws std::out_of_range if there is no sensor at that position or it
+     *                           has no frames.
+     *
+     * @param[in] sensor_index The position of the sensor.
+     * @param[in] ts The capture timestamp in microseconds.
+     * @return The number of the last frame starting at or before the
+     *         timestamp, 0 if all of them start after it.
+     */
+    OUSTER_API_FUNCTION
+    size_t frame_at_timestamp(size_t sensor_index, uint64_t ts) const;
+
     // TODO[UN]: in my opinion we are better off removing this method from this
     // class It is better if we keep this class as a simple POD object. Another
     // problem with this method specifically is that it creates a cyclic and
@@ -77,6 +108,37 @@ class OUSTER_API_CLASS PcapIndex {
                        unsigned int frame_number);
 };
 
+/**
+ * Sensor packets read by IndexedPcapReader::read_batch(), with their payloads
+ * back to back in one buffer that is reused by the next read, so that a
+ * replay doesn't allocate or cross into python per packet.
+ */
+struct OUSTER_API_CLASS PacketBatch {
+    /// Where a packet is in the batch and what it is
+    struct Entry {
+        uint64_t offset;     ///< offset of the payload in data
+        uint64_t size;       ///< size of the payload in bytes
+        uint64_t timestamp;  ///< capture timestamp in nanoseconds
+        int32_t sensor_idx;  ///< sensor the packet was matched to
+        int32_t type;        ///< the sensor::PacketType of the packet
+    };
+
+    std::vector<uint8_t> data;   ///< payloads of the packets
+    std::vector<Entry> entries;  ///< the packets in the order read
+    /// packet format of each sensor, shared by the packets of the batch
+    std::vector<std::shared_ptr<ouster::sensor::packet_format>> formats;
+    /// packets skipped since they matched no sensor on their port, for the
+    /// init_id or serial number
+    size_t id_errors{0};
+    /// packets skipped since they matched no sensor on their port, for the
+    /// size
+    size_t size_errors{0};
+
+    /// Drop the packets and error counts, keeping the memory
+    OUSTER_API_FUNCTION
+    void clear();
+};
+
 /**
  * A PcapReader that allows seeking to the start of a lidar frame.
  *
@@ -115,6 +177,55 @@ class OUSTER_API_CLASS IndexedPcapReader : public PcapReader {
     OUSTER_API_FUNCTION
     void build_index();
 
+    /**
+     * Build the index with a sidecar index file, e.g. the pcap path with
+     * ".idx" appended, so that opening a large pcap again doesn't scan it
+     * again.
+     *
+     * The index saved in the file is used if it was saved for the same
+     * sensor infos and the pcap has not been rewritten since, i.e. it has the
+     * same modification time or has grown. Packets past the last one it
+     * covers, e.g. of a pcap still being recorded, are then added to it.
+     * Otherwise the index is built from scratch. The file is saved again if
+     * the index changed, failing to write it isn't an error.
+     *
+     * @param[in] index_filename The sidecar index file.
+     * @return true if the saved index was used rather than rebuilt.
+     */
+    OUSTER_API_FUNCTION
+    bool build_index(const std::string& index_filename);
+
+    /**
+     * Build the same index as build_index() on several threads, for large
+     * pcaps.
+     *
+     * The pcap is split into byte ranges, each indexed by a reader of its
+     * own which starts at the first pcap record header found in the range,
+     * or somewhat before it for packets fragmented across the ranges. The
+     * frames found in each range are then merged in order, applying the
+     * frame id checks of update_index_for_current_packet(), including
+     * frame_id_rolled_over(), across the range boundaries. Pcaps too small
+     * to split, or not in the classic pcap format, e.g. pcapng, are indexed
+     * by build_index().
+     *
+     * @param[in] num_threads The number of threads, 0 for
+     *                        ouster::sdk_thread_count().
+     */
+    OUSTER_API_FUNCTION
+    void build_index_parallel(unsigned int num_threads = 0);
+
+    /**
+     * Save the index to a sidecar index file, along with the size and
+     * modification time of the pcap and a hash of the sensor infos which
+     * build_index(const std::string&) checks before using it. The file is in
+     * the byte order of the host.
+     *
+     * @param[in] index_filename The sidecar index file.
+     * @return false if the file couldn't be written.
+     */
+    OUSTER_API_FUNCTION
+    bool save_index(const std::string& index_filename) const;
+
     /**
      * Get index for the underlying pcap
      *
@@ -123,6 +234,21 @@ class OUSTER_API_CLASS IndexedPcapReader : public PcapReader {
     OUSTER_API_FUNCTION
     const PcapIndex& get_index() const;
 
+    /**
+     * Seek to the frame of a sensor at a timestamp, found in O(log n) with
+     * PcapIndex::frame_at_timestamp(), so that long recordings can be
+     * scrubbed without reading them. Requires the index to be built.
+     *
+     * @throws std::out_of_range if there is no sensor at that position or it
+     *                           has no frames.
+     *
+     * @param[in] sensor_index The position of the sensor.
+     * @param[in] ts The capture timestamp.
+     * @return The number of the frame seeked to.
+     */
+    OUSTER_API_FUNCTION
+    size_t seek_to_time(size_t sensor_index, std::chrono::microseconds ts);
+
     /**
      * Attempts to match the current packet to one of the sensor info objects
      * and returns the appropriate packet format if there is one
@@ -153,6 +279,21 @@ class OUSTER_API_CLASS IndexedPcapReader : public PcapReader {
     OUSTER_API_FUNCTION
     int update_index_for_current_packet();
 
+    /**
+     * Read the next sensor packets into a batch, replacing its contents.
+     * Packets on the lidar or imu port of a sensor are matched by
+     * validating them against each sensor on the port, as a lidar packet or,
+     * if they have the size of one, as an imu packet. Other packets are
+     * skipped, counting the ones on a sensor port in the error counts of the
+     * batch.
+     *
+     * @param[in,out] batch The batch to read into.
+     * @param[in] max_packets The number of sensor packets to read at most.
+     * @return The number of packets read, 0 at the end of the pcap.
+     */
+    OUSTER_API_FUNCTION
+    size_t read_batch(PacketBatch& batch, size_t max_packets = 1024);
+
     /**
      * Return true if the frame_id from the packet stream has rolled over,
      * hopefully avoiding spurious result that could occur from out of order or
@@ -167,6 +308,16 @@ class OUSTER_API_CLASS IndexedPcapReader : public PcapReader {
 
    protected:
     void init_();
+
+    /**
+     * Load the index from a sidecar index file if it fits the pcap.
+     *
+     * @param[in] index_filename The sidecar index file.
+     * @return false if the file is missing, invalid or stale.
+     */
+    bool load_index_(const std::string& index_filename);
+
+    std::string pcap_filename_;  ///< The path of the pcap
     std::vector<ouster::sensor::sensor_info>
         sensor_infos_;  ///< A vector of sensor_info that correspond to the
                         ///< provided metadata files
@@ -176,6 +327,7 @@ class OUSTER_API_CLASS IndexedPcapReader : public PcapReader {
     // TODO: remove, this should be a transient variable
     std::vector<nonstd::optional<uint16_t>>
         previous_frame_ids_;  ///< previous frame id for each sensor
+    uint64_t indexed_offset_{0};  ///< offset past the last packet indexed
     std::unordered_map<uint16_t, std::map<std::string, uint64_t>> port_map_;
 };
 
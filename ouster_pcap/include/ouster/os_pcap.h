@@ -296,6 +296,40 @@ std::shared_ptr<stream_info> get_stream_info(
         progress_callback,
     int packets_per_callback, int packets_to_process = -1);
 
+/**
+ * How get_stream_info_sampled() samples a pcap file.
+ */
+struct OUSTER_API_CLASS stream_sampling {
+    int windows{16};  ///< The parts the file is divided in, one window each
+    int packets_per_window{100};  ///< The most packets read per window
+    /// Stop once this many windows in a row found no new stream nor payload
+    /// size
+    int stable_windows{4};
+};
+
+/**
+ * Return the information about network streams in a pcap file from windows
+ * of packets sampled across it, in milliseconds for files of any size.
+ *
+ * The file is divided in parts and the packets at the start of each are read,
+ * starting with the first and the last part and then halving the distance
+ * between the windows read. Reading stops once stable_windows windows in a
+ * row have found no new stream nor payload size. Counts and total_packets are
+ * those of the sampled packets. Files not read memory mapped can't be seeked
+ * into and their first windows * packets_per_window packets are read instead.
+ *
+ * @throws std::invalid_argument if the sampling has fewer than two windows or
+ *         no packets per window.
+ *
+ * @param[in] file The pcap file to read.
+ * @param[in] sampling How to sample the file.
+ *
+ * @return A pointer to the resulting stream_info
+ */
+OUSTER_API_FUNCTION
+std::shared_ptr<stream_info> get_stream_info_sampled(
+    const std::string& file, const stream_sampling& sampling = {});
+
 /**
  * Return the information about network streams in a PcapReader and generate
  * indicies (if the PcapReader is an IndexedPcapReader).
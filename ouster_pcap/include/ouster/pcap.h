@@ -12,6 +12,7 @@
 #include <memory>
 #include <string>
 
+#include "ouster/ip_reassembly.h"
 #include "ouster/visibility.h"
 
 namespace ouster {
@@ -128,6 +129,29 @@ class OUSTER_API_CLASS PcapReader {
     OUSTER_API_FUNCTION
     int64_t current_offset() const;
 
+    /**
+     * Seek to the first packet record at or after an arbitrary position in
+     * the file, found by checking that the record headers following it are
+     * valid. Only files read memory mapped can be synced to.
+     *
+     * @param[in] offset The position to search from in bytes, starting from
+     * the beginning of the file.
+     *
+     * @return false if the file isn't read memory mapped or no record
+     * follows the position.
+     */
+    OUSTER_API_FUNCTION
+    bool sync(uint64_t offset);
+
+    /**
+     * Return the counters of the reassembly of IPv4 fragments. Files not read
+     * memory mapped are reassembled by libtins and not counted.
+     *
+     * @return The counters of the reassembler.
+     */
+    OUSTER_API_FUNCTION
+    sensor::IpReassemblyStats reassembly_stats() const;
+
    private:
     int64_t file_size_{};
     int64_t file_start_{};
@@ -0,0 +1,193 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Replays the UDP streams of a pcap file over the network in real time
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace sensor_utils {
+
+/**
+ * A UDP stream of a pcap file to replay, and where to send it.
+ */
+struct OUSTER_API_CLASS ReplayStream {
+    int pcap_dst_port{0};  ///< the destination port of the stream's packets
+    std::string dst_ip;    ///< the address to send the packets to
+    int dst_port{0};       ///< the port to send to, 0 for pcap_dst_port
+    std::string src_ip{};  ///< the address to send from, any if empty
+    int src_port{0};       ///< the port to send from, any if 0
+};
+
+/**
+ * Options of a PcapReplay.
+ */
+struct OUSTER_API_CLASS ReplayOptions {
+    /**
+     * How many times faster than captured packets are sent, 0 to send them
+     * as fast as possible.
+     */
+    double speed{1.0};
+
+    /**
+     * How many times the file is replayed, 0 to replay it until stopped.
+     */
+    unsigned loops{1};
+
+    /**
+     * The most packets sent by one system call. Packets are batched when
+     * they are already due, so pacing is kept between batches.
+     */
+    size_t batch_size{32};
+
+    /**
+     * How long before a packet is due its thread stops sleeping and spins
+     * instead, so that the packet isn't sent late by the slack of the
+     * operating system's timers.
+     */
+    std::chrono::microseconds spin{200};
+};
+
+/**
+ * The counters of a replayed stream.
+ */
+struct OUSTER_API_CLASS ReplayStats {
+    uint64_t packets{0};      ///< packets sent
+    uint64_t bytes{0};        ///< payload bytes sent
+    uint64_t send_errors{0};  ///< packets not sent
+    uint64_t batches{0};      ///< system calls sending packets
+    unsigned loops{0};        ///< times the whole file was replayed
+    /// the most a packet was sent after its due time
+    std::chrono::microseconds max_lateness{0};
+};
+
+/**
+ * Replays UDP streams of a pcap file to the network, with the timing with
+ * which they were captured.
+ *
+ * Each stream is replayed by its own thread, reading the file memory mapped
+ * when it can be and sending on its own socket, batching packets with
+ * sendmmsg where it is available. Streams are paced against a common clock
+ * started at the first packet of the file, so that the streams of several
+ * sensors keep their relative timing. When looping, streams wait for each
+ * other at the end of the file.
+ */
+class OUSTER_API_CLASS PcapReplay {
+   public:
+    /**
+     * Open the sockets of the streams.
+     *
+     * @throws std::invalid_argument if no streams are given or the options
+     *         aren't valid.
+     * @throws std::runtime_error if an address can't be resolved or a socket
+     *         can't be opened.
+     *
+     * @param[in] file The pcap file.
+     * @param[in] streams The streams to replay.
+     * @param[in] options The options of the replay.
+     */
+    OUSTER_API_FUNCTION
+    PcapReplay(const std::string& file,
+               const std::vector<ReplayStream>& streams,
+               const ReplayOptions& options = {});
+
+    /**
+     * Stop replaying and close the sockets.
+     */
+    OUSTER_API_FUNCTION
+    ~PcapReplay();
+
+    PcapReplay(const PcapReplay&) = delete;
+    PcapReplay& operator=(const PcapReplay&) = delete;
+
+    /**
+     * Start the threads replaying the streams.
+     *
+     * @throws std::logic_error if the replay was already started.
+     * @throws std::runtime_error if the file can't be read or has none of the
+     *         packets of the streams.
+     */
+    OUSTER_API_FUNCTION
+    void start();
+
+    /**
+     * Wait for the streams to be replayed or for the replay to be stopped.
+     *
+     * @throws The error that stopped a thread, if any.
+     */
+    OUSTER_API_FUNCTION
+    void wait();
+
+    /**
+     * Stop the replay, waiting for the threads to exit.
+     */
+    OUSTER_API_FUNCTION
+    void stop();
+
+    /**
+     * @return Whether some stream is still being replayed.
+     */
+    OUSTER_API_FUNCTION
+    bool running() const;
+
+    /**
+     * @return The counters of the streams, in the order they were given.
+     */
+    OUSTER_API_FUNCTION
+    std::vector<ReplayStats> stats() const;
+
+   private:
+    using clock = std::chrono::steady_clock;
+
+    struct Sender;
+
+    void replay(size_t index);
+
+    /**
+     * Wait until the time a packet is due, false if stopped before.
+     */
+    bool wait_until(clock::time_point due);
+
+    /**
+     * Wait for the other streams at the end of the file, restarting the
+     * common clock once all have arrived. False if stopped before.
+     */
+    bool end_loop();
+
+    void join();
+
+    std::string file_;
+    std::vector<ReplayStream> streams_;
+    ReplayOptions options_;
+    std::vector<std::unique_ptr<Sender>> senders_;
+    std::vector<std::thread> threads_;
+
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+    bool stop_{false};
+    size_t running_{0};
+    size_t arrived_{0};
+    uint64_t loop_{0};
+    clock::time_point origin_{};
+    std::chrono::microseconds first_ts_{0};
+    std::vector<ReplayStats> stats_;
+    std::exception_ptr error_;
+};
+
+}  // namespace sensor_utils
+}  // namespace ouster
@@ -0,0 +1,471 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/async_pcap_writer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "ouster/impl/netcompat.h"
+#include "ouster/impl/ring_buffer.h"
+#include "ouster/threads.h"
+
+#ifndef _WIN32
+#include <climits>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace ouster {
+namespace sensor_utils {
+
+namespace {
+
+constexpr size_t PCAP_RECORD_HEADER_SIZE = 16;
+constexpr size_t ETHERNET_HEADER_SIZE = 14;
+constexpr size_t SLL_HEADER_SIZE = 16;
+constexpr size_t IPV4_HEADER_SIZE = 20;
+constexpr size_t UDP_HEADER_SIZE = 8;
+constexpr size_t MAX_UDP_PAYLOAD = 65507;
+constexpr uint16_t MIN_MTU = 68;
+constexpr uint32_t SNAPLEN = 65535;
+constexpr uint16_t ETHERTYPE_IPV4 = 0x0800;
+constexpr uint16_t ARPHRD_ETHER = 1;
+constexpr uint8_t DEFAULT_TTL = 128;  // as libtins
+constexpr uint8_t PROTOCOL_UDP = 17;
+
+#ifdef _WIN32
+struct iovec {
+    void* iov_base;
+    size_t iov_len;
+};
+#endif
+
+void put_be16(uint8_t* dst, uint16_t value) {
+    dst[0] = static_cast<uint8_t>(value >> 8);
+    dst[1] = static_cast<uint8_t>(value);
+}
+
+uint16_t header_checksum(const uint8_t* header, size_t size) {
+    uint32_t sum = 0;
+    for (size_t i = 0; i + 1 < size; i += 2) {
+        sum += static_cast<uint32_t>(header[i] << 8 | header[i + 1]);
+    }
+    while (sum >> 16) sum = (sum & 0xffff) + (sum >> 16);
+    return static_cast<uint16_t>(~sum);
+}
+
+uint32_t parse_ipv4(const std::string& ip) {
+    in_addr addr;
+    if (inet_pton(AF_INET, ip.c_str(), &addr) != 1) {
+        throw std::invalid_argument("AsyncPcapWriter: '" + ip +
+                                    "' is not an IPv4 address");
+    }
+    uint32_t result;
+    std::memcpy(&result, &addr, sizeof(result));
+    return result;
+}
+
+/**
+ * The path of the file of a rotation: the base path, then with _index
+ * before its extension.
+ */
+std::string rotated_path(const std::string& base, size_t index) {
+    if (index == 0) return base;
+    const size_t slash = base.find_last_of("/\\");
+    const size_t dot = base.find_last_of('.');
+    const bool extension = dot != std::string::npos &&
+                           (slash == std::string::npos || dot > slash + 1);
+    const std::string suffix = "_" + std::to_string(index);
+    if (!extension) return base + suffix;
+    return base.substr(0, dot) + suffix + base.substr(dot);
+}
+
+/**
+ * Write all the chunks to the file, false on failure.
+ */
+bool write_chunks(std::FILE* file, std::vector<iovec>& chunks) {
+#ifdef _WIN32
+    for (const auto& chunk : chunks) {
+        if (std::fwrite(chunk.iov_base, 1, chunk.iov_len, file) !=
+            chunk.iov_len) {
+            return false;
+        }
+    }
+    return std::fflush(file) == 0;
+#else
+    const int fd = fileno(file);
+    size_t i = 0;
+    while (i < chunks.size()) {
+        const int count =
+            static_cast<int>(std::min<size_t>(chunks.size() - i, IOV_MAX));
+        ssize_t written = writev(fd, chunks.data() + i, count);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        // skip what was written, resuming within a partly written chunk
+        size_t left = static_cast<size_t>(written);
+        while (i < chunks.size() && left >= chunks[i].iov_len) {
+            left -= chunks[i].iov_len;
+            i++;
+        }
+        if (left > 0) {
+            auto base = static_cast<uint8_t*>(chunks[i].iov_base);
+            chunks[i].iov_base = base + left;
+            chunks[i].iov_len -= left;
+        }
+    }
+    return true;
+#endif
+}
+
+}  // namespace
+
+/**
+ * The pcap records of one UDP datagram, one per IPv4 fragment.
+ */
+struct RecordSlot {
+    std::vector<uint8_t> bytes;  ///< grown as needed, reused
+    size_t size{0};              ///< of the records in bytes
+    uint32_t records{0};
+    packet_info::ts timestamp{0};
+};
+
+struct async_pcap_writer_impl {
+    std::string base;
+    AsyncPcapWriterOptions options;
+    size_t link_size;
+    uint16_t ip_id{0};
+    bool closed{false};
+
+    sensor::impl::DropOldestRingBuffer<RecordSlot> ring;
+    std::atomic<uint64_t> pushed{0};
+    std::atomic<uint64_t> dropped{0};
+    std::thread thread;
+
+    std::mutex mtx;
+    std::condition_variable data_cv;  ///< wakes the writer thread
+    std::condition_variable done_cv;  ///< wakes flush()
+    bool closing{false};
+    uint64_t written{0};  ///< packets written or lost to errors
+    AsyncPcapWriterStats stats;
+    std::vector<std::string> files;
+    std::string error;
+
+    // owned by the writer thread once started
+    std::FILE* file{nullptr};
+    uint64_t file_bytes{0};
+    packet_info::ts file_start{0};
+    bool file_empty{true};
+    std::vector<iovec> chunks;
+
+    async_pcap_writer_impl(const std::string& base,
+                           const AsyncPcapWriterOptions& options)
+        : base(base),
+          options(options),
+          link_size(options.encap == PcapWriter::SLL ? SLL_HEADER_SIZE
+                                                     : ETHERNET_HEADER_SIZE),
+          ring(options.buffer_packets) {}
+
+    /**
+     * Format a datagram into the records of a slot.
+     */
+    void format(RecordSlot& slot, const uint8_t* buf, size_t buf_size,
+                uint32_t src_ip, uint32_t dst_ip, uint16_t src_port,
+                uint16_t dst_port, packet_info::ts timestamp, uint16_t id) {
+        const size_t ip_payload = UDP_HEADER_SIZE + buf_size;
+        size_t fragment = ip_payload;
+        if (options.mtu != 0 && IPV4_HEADER_SIZE + ip_payload > options.mtu) {
+            // fragment data are multiples of 8 bytes but the last
+            fragment = (options.mtu - IPV4_HEADER_SIZE) & ~size_t{7};
+        }
+        const size_t records = (ip_payload + fragment - 1) / fragment;
+        const size_t size =
+            records * (PCAP_RECORD_HEADER_SIZE + link_size + IPV4_HEADER_SIZE) +
+            ip_payload;
+        if (slot.bytes.size() < size) slot.bytes.resize(size);
+
+        const auto us = timestamp.count();
+        const uint32_t ts_sec = static_cast<uint32_t>(us / 1000000);
+        const uint32_t ts_usec = static_cast<uint32_t>(us % 1000000);
+        uint8_t* out = slot.bytes.data();
+        for (size_t offset = 0; offset < ip_payload; offset += fragment) {
+            const size_t length = std::min(fragment, ip_payload - offset);
+            const uint32_t captured = static_cast<uint32_t>(
+                link_size + IPV4_HEADER_SIZE + length);
+            const uint32_t header[4] = {ts_sec, ts_usec, captured, captured};
+            std::memcpy(out, header, sizeof(header));
+            out += PCAP_RECORD_HEADER_SIZE;
+
+            std::memset(out, 0, link_size);
+            if (options.encap == PcapWriter::SLL) {
+                put_be16(out + 2, ARPHRD_ETHER);
+                put_be16(out + 14, ETHERTYPE_IPV4);
+            } else {
+                put_be16(out + 12, ETHERTYPE_IPV4);
+            }
+            out += link_size;
+
+            const bool more = offset + length < ip_payload;
+            out[0] = 0x45;
+            out[1] = 0;
+            put_be16(out + 2,
+                     static_cast<uint16_t>(IPV4_HEADER_SIZE + length));
+            put_be16(out + 4, id);
+            put_be16(out + 6, static_cast<uint16_t>((more ? 0x2000 : 0) |
+                                                    (offset / 8)));
+            out[8] = DEFAULT_TTL;
+            out[9] = PROTOCOL_UDP;
+            put_be16(out + 10, 0);
+            std::memcpy(out + 12, &src_ip, 4);
+            std::memcpy(out + 16, &dst_ip, 4);
+            put_be16(out + 10, header_checksum(out, IPV4_HEADER_SIZE));
+            out += IPV4_HEADER_SIZE;
+
+            if (offset == 0) {
+                // no checksum, as allowed over IPv4
+                put_be16(out, src_port);
+                put_be16(out + 2, dst_port);
+                put_be16(out + 4, static_cast<uint16_t>(ip_payload));
+                put_be16(out + 6, 0);
+                std::memcpy(out + UDP_HEADER_SIZE, buf,
+                            length - UDP_HEADER_SIZE);
+            } else {
+                std::memcpy(out, buf + offset - UDP_HEADER_SIZE, length);
+            }
+            out += length;
+        }
+        slot.size = size;
+        slot.records = static_cast<uint32_t>(records);
+        slot.timestamp = timestamp;
+    }
+
+    /**
+     * Close the current file and open the next one with its file header.
+     */
+    bool open_next() {
+        if (file) std::fclose(file);
+        std::string path;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            path = rotated_path(base, files.size());
+            files.push_back(path);
+            stats.files = files.size();
+        }
+        file = std::fopen(path.c_str(), "wb");
+        file_bytes = 0;
+        file_empty = true;
+        if (!file) {
+            fail("failed to open " + path);
+            return false;
+        }
+        const uint32_t magic = 0xa1b2c3d4;
+        const uint16_t version[2] = {2, 4};
+        const int32_t thiszone = 0;
+        const uint32_t sigfigs = 0;
+        const uint32_t link_type = options.encap;
+        uint8_t header[24];
+        std::memcpy(header, &magic, 4);
+        std::memcpy(header + 4, version, 4);
+        std::memcpy(header + 8, &thiszone, 4);
+        std::memcpy(header + 12, &sigfigs, 4);
+        std::memcpy(header + 16, &SNAPLEN, 4);
+        std::memcpy(header + 20, &link_type, 4);
+        std::vector<iovec> header_chunks{iovec{header, sizeof(header)}};
+        if (!write_chunks(file, header_chunks)) {
+            fail("failed to write " + path);
+            return false;
+        }
+        file_bytes = sizeof(header);
+        std::lock_guard<std::mutex> lock(mtx);
+        stats.bytes += sizeof(header);
+        return true;
+    }
+
+    void fail(const std::string& message) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (error.empty()) error = message;
+    }
+
+    /**
+     * Write out the records gathered in chunks.
+     */
+    void write_chunks_of(uint64_t packets, uint64_t records, uint64_t bytes) {
+        if (packets == 0) return;
+        const bool ok = file && write_chunks(file, chunks);
+        chunks.clear();
+        if (!ok && file) fail("failed to write " + files.back());
+        std::lock_guard<std::mutex> lock(mtx);
+        if (ok) {
+            stats.packets += packets;
+            stats.records += records;
+            stats.bytes += bytes;
+        } else {
+            stats.write_errors += packets;
+        }
+    }
+
+    void write(std::vector<RecordSlot>& batch, size_t n) {
+        uint64_t packets = 0, records = 0, bytes = 0;
+        chunks.clear();
+        for (size_t i = 0; i < n; i++) {
+            const RecordSlot& slot = batch[i];
+            const bool rotate =
+                !file_empty &&
+                ((options.rotate_bytes != 0 &&
+                  file_bytes + slot.size > options.rotate_bytes) ||
+                 (options.rotate_interval.count() > 0 &&
+                  slot.timestamp - file_start >= options.rotate_interval));
+            if (rotate) {
+                write_chunks_of(packets, records, bytes);
+                packets = records = bytes = 0;
+                open_next();
+            }
+            if (file_empty) file_start = slot.timestamp;
+            file_empty = false;
+            file_bytes += slot.size;
+            chunks.push_back(iovec{const_cast<uint8_t*>(slot.bytes.data()),
+                                   slot.size});
+            packets++;
+            records += slot.records;
+            bytes += slot.size;
+        }
+        write_chunks_of(packets, records, bytes);
+    }
+
+    void run() {
+        std::vector<RecordSlot> batch(options.write_batch);
+        while (true) {
+            // the slots get the buffers of the batch back, so that none are
+            // allocated once all have grown to their packets
+            size_t n = 0;
+            auto take = [&](RecordSlot& slot) { std::swap(slot, batch[n]); };
+            while (n < batch.size() && ring.pop(take)) n++;
+            if (n == 0) {
+                std::unique_lock<std::mutex> lock(mtx);
+                if (closing && ring.empty()) break;
+                // packets are signaled without the lock, so that a missed
+                // wakeup only delays them
+                data_cv.wait_for(lock, std::chrono::milliseconds(10));
+                continue;
+            }
+            write(batch, n);
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                written += n;
+            }
+            done_cv.notify_all();
+        }
+    }
+};
+
+AsyncPcapWriter::AsyncPcapWriter(const std::string& file,
+                                 const AsyncPcapWriterOptions& options) {
+    if (options.encap != PcapWriter::ETHERNET &&
+        options.encap != PcapWriter::SLL) {
+        throw std::invalid_argument(
+            "AsyncPcapWriter: packet encapsulation not supported");
+    }
+    if ((options.mtu != 0 && options.mtu < MIN_MTU) ||
+        options.buffer_packets == 0 || options.write_batch == 0) {
+        throw std::invalid_argument("AsyncPcapWriter: invalid options");
+    }
+    impl.reset(new async_pcap_writer_impl(file, options));
+    if (!impl->open_next()) {
+        throw std::runtime_error("AsyncPcapWriter: " + impl->error);
+    }
+    impl->thread = start_thread("ouster-pcap-io", [this] { impl->run(); });
+}
+
+AsyncPcapWriter::~AsyncPcapWriter() {
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+bool AsyncPcapWriter::write_packet(const uint8_t* buf, size_t buf_size,
+                                   const std::string& src_ip,
+                                   const std::string& dst_ip,
+                                   uint16_t src_port, uint16_t dst_port,
+                                   packet_info::ts timestamp) {
+    if (impl->closed) {
+        throw std::logic_error("AsyncPcapWriter: writer is closed");
+    }
+    if (buf_size > MAX_UDP_PAYLOAD) {
+        throw std::invalid_argument(
+            "AsyncPcapWriter: payload too large for a UDP datagram");
+    }
+    const uint32_t src = parse_ipv4(src_ip);
+    const uint32_t dst = parse_ipv4(dst_ip);
+    const uint16_t id = ++impl->ip_id;
+    const size_t dropped = impl->ring.push([&](RecordSlot& slot) {
+        impl->format(slot, buf, buf_size, src, dst, src_port, dst_port,
+                     timestamp, id);
+    });
+    impl->dropped += dropped;
+    impl->pushed++;
+    impl->data_cv.notify_one();
+    return dropped == 0;
+}
+
+bool AsyncPcapWriter::write_packet(const uint8_t* buf, size_t buf_size,
+                                   const packet_info& info) {
+    return write_packet(buf, buf_size, info.src_ip, info.dst_ip,
+                        static_cast<uint16_t>(info.src_port),
+                        static_cast<uint16_t>(info.dst_port), info.timestamp);
+}
+
+void AsyncPcapWriter::flush() {
+    if (impl->closed) return;
+    const uint64_t target = impl->pushed;
+    impl->data_cv.notify_one();
+    std::unique_lock<std::mutex> lock(impl->mtx);
+    impl->done_cv.wait(lock, [&] {
+        return impl->written + impl->dropped >= target;
+    });
+}
+
+void AsyncPcapWriter::close() {
+    if (impl->closed) return;
+    impl->closed = true;
+    {
+        std::lock_guard<std::mutex> lock(impl->mtx);
+        impl->closing = true;
+    }
+    impl->data_cv.notify_one();
+    impl->thread.join();
+    if (impl->file) {
+        if (std::fclose(impl->file) != 0) impl->fail("failed to close file");
+        impl->file = nullptr;
+    }
+    std::lock_guard<std::mutex> lock(impl->mtx);
+    if (!impl->error.empty()) {
+        throw std::runtime_error("AsyncPcapWriter: " + impl->error);
+    }
+}
+
+AsyncPcapWriterStats AsyncPcapWriter::stats() const {
+    std::lock_guard<std::mutex> lock(impl->mtx);
+    AsyncPcapWriterStats result = impl->stats;
+    result.dropped = impl->dropped;
+    return result;
+}
+
+std::vector<std::string> AsyncPcapWriter::files() const {
+    std::lock_guard<std::mutex> lock(impl->mtx);
+    return impl->files;
+}
+
+}  // namespace sensor_utils
+}  // namespace ouster
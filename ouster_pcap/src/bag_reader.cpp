@@ -0,0 +1,602 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/bag_reader.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "ouster/packet.h"
+
+namespace ouster {
+namespace sensor_utils {
+
+namespace {
+
+constexpr char BAG_MAGIC[] = "#ROSBAG V2.0\n";
+constexpr uint64_t BAG_MAGIC_SIZE = sizeof(BAG_MAGIC) - 1;
+
+constexpr uint8_t OP_MESSAGE_DATA = 0x02;
+constexpr uint8_t OP_BAG_HEADER = 0x03;
+constexpr uint8_t OP_CHUNK = 0x05;
+constexpr uint8_t OP_CHUNK_INFO = 0x06;
+constexpr uint8_t OP_CONNECTION = 0x07;
+
+uint32_t le32(const uint8_t* buf) {
+    return static_cast<uint32_t>(buf[0]) |
+           static_cast<uint32_t>(buf[1]) << 8 |
+           static_cast<uint32_t>(buf[2]) << 16 |
+           static_cast<uint32_t>(buf[3]) << 24;
+}
+
+uint64_t le64(const uint8_t* buf) {
+    return static_cast<uint64_t>(le32(buf)) |
+           static_cast<uint64_t>(le32(buf + 4)) << 32;
+}
+
+/**
+ * A ros::Time, seconds then nanoseconds, in nanoseconds.
+ */
+uint64_t ros_time(const uint8_t* buf) {
+    return static_cast<uint64_t>(le32(buf)) * 1000000000ull + le32(buf + 4);
+}
+
+/**
+ * Find a field of a list of "name=value" fields, each prefixed by its size,
+ * as the headers of records and the data of connection records are.
+ *
+ * @param[in] fields The fields.
+ * @param[in] fields_size The size of the fields.
+ * @param[in] name The name of the field.
+ * @param[out] size The size of the value.
+ * @return The value, nullptr if there is no such field.
+ */
+const uint8_t* find_field(const uint8_t* fields, uint64_t fields_size,
+                          const char* name, uint32_t& size) {
+    const size_t name_size = std::strlen(name);
+    uint64_t offset = 0;
+    while (offset + 4 <= fields_size) {
+        const uint32_t field_size = le32(fields + offset);
+        offset += 4;
+        if (field_size > fields_size - offset) return nullptr;
+        const uint8_t* field = fields + offset;
+        offset += field_size;
+        if (field_size > name_size && field[name_size] == '=' &&
+            std::memcmp(field, name, name_size) == 0) {
+            size = static_cast<uint32_t>(field_size - name_size - 1);
+            return field + name_size + 1;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Find a field of a list of fields and copy its value, empty if missing.
+ */
+std::string find_string(const uint8_t* fields, uint64_t fields_size,
+                        const char* name) {
+    uint32_t size = 0;
+    const uint8_t* field = find_field(fields, fields_size, name, size);
+    if (field == nullptr) return {};
+    return std::string(reinterpret_cast<const char*>(field), size);
+}
+
+/**
+ * A record of a bag, within a mapped file or chunk.
+ */
+struct Record {
+    const uint8_t* header;
+    uint32_t header_size;
+    const uint8_t* data;
+    uint32_t data_size;
+    uint64_t end;  ///< offset past the record
+    uint8_t op;
+
+    bool u32(const char* name, uint32_t& value) const {
+        uint32_t size = 0;
+        const uint8_t* field = find_field(header, header_size, name, size);
+        if (field == nullptr || size != 4) return false;
+        value = le32(field);
+        return true;
+    }
+
+    bool u64(const char* name, uint64_t& value) const {
+        uint32_t size = 0;
+        const uint8_t* field = find_field(header, header_size, name, size);
+        if (field == nullptr || size != 8) return false;
+        value = le64(field);
+        return true;
+    }
+
+    bool time(const char* name, uint64_t& value) const {
+        uint32_t size = 0;
+        const uint8_t* field = find_field(header, header_size, name, size);
+        if (field == nullptr || size != 8) return false;
+        value = ros_time(field);
+        return true;
+    }
+};
+
+/**
+ * Read the record at an offset of a buffer.
+ *
+ * @return false if there isn't a whole record with an op there.
+ */
+bool read_record(const uint8_t* buf, uint64_t size, uint64_t offset,
+                 Record& record) {
+    if (offset + 4 > size) return false;
+    record.header_size = le32(buf + offset);
+    offset += 4;
+    if (record.header_size > size - offset) return false;
+    record.header = buf + offset;
+    offset += record.header_size;
+    if (offset + 4 > size) return false;
+    record.data_size = le32(buf + offset);
+    offset += 4;
+    if (record.data_size > size - offset) return false;
+    record.data = buf + offset;
+    record.end = offset + record.data_size;
+
+    uint32_t op_size = 0;
+    const uint8_t* op =
+        find_field(record.header, record.header_size, "op", op_size);
+    if (op == nullptr || op_size != 1) return false;
+    record.op = *op;
+    return true;
+}
+
+bool is_packet_msg(const std::string& type) {
+    return type == "ouster_ros/PacketMsg" ||
+           type == "ouster_ros/msg/PacketMsg" ||
+           type == "ouster_sensor_msgs/PacketMsg" ||
+           type == "ouster_sensor_msgs/msg/PacketMsg";
+}
+
+bool is_string_msg(const std::string& type) {
+    return type == "std_msgs/String" || type == "std_msgs/msg/String";
+}
+
+bool contains(const std::string& str, const std::string& part) {
+    return str.find(part) != std::string::npos;
+}
+
+}  // namespace
+
+struct bag_reader_impl {
+    /// What the messages of a connection are
+    enum Kind { LIDAR, IMU, METADATA };
+
+    struct Connection {
+        uint32_t id;
+        std::string topic;
+        std::string type;
+    };
+
+    struct Route {
+        int32_t sensor_idx;
+        Kind kind;
+    };
+
+    struct Chunk {
+        uint64_t pos;         ///< offset of the chunk record
+        uint64_t data;        ///< offset of the records of the chunk
+        uint64_t size;        ///< size of the records of the chunk
+        uint64_t start_time;  ///< of its first message
+        uint64_t end_time;    ///< of its last message
+        std::vector<uint32_t> connections;  ///< having messages in it
+    };
+
+    uint8_t* buf{nullptr};
+    uint64_t size{0};
+
+    std::vector<Connection> connections;  ///< in the order of the index
+    std::vector<Chunk> chunks;            ///< in the order of the file
+    std::unordered_map<uint32_t, Route> routes;
+
+    std::vector<ouster::sensor::sensor_info> infos;
+    std::vector<ouster::sensor::packet_format> formats;
+    std::vector<std::string> lidar_topics;
+    bool soft_id_check{false};
+
+    size_t chunk{0};     ///< the chunk being read
+    uint64_t pos{0};     ///< offset of the next record in the chunk
+    uint64_t min_ts{0};  ///< time to skip messages before, after a seek
+
+    ~bag_reader_impl() {
+        if (buf == nullptr) return;
+#ifdef _WIN32
+        UnmapViewOfFile(buf);
+#else
+        munmap(buf, static_cast<size_t>(size));
+#endif
+    }
+
+    bool map(const std::string& filename) {
+#ifdef _WIN32
+        HANDLE file =
+            CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+            CloseHandle(file);
+            return false;
+        }
+        HANDLE mapping =
+            CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        CloseHandle(file);
+        if (mapping == NULL) return false;
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (view == NULL) return false;
+        buf = static_cast<uint8_t*>(view);
+        size = static_cast<uint64_t>(file_size.QuadPart);
+#else
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ,
+                          MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED) return false;
+        buf = static_cast<uint8_t*>(view);
+        size = static_cast<uint64_t>(st.st_size);
+#endif
+        return true;
+    }
+
+    /**
+     * Read the connections and chunk infos at the index position of the
+     * bag header, checking the chunks they point to.
+     *
+     * @return false if the bag isn't readable().
+     */
+    bool read_index() {
+        if (size < BAG_MAGIC_SIZE ||
+            std::memcmp(buf, BAG_MAGIC, BAG_MAGIC_SIZE) != 0) {
+            return false;
+        }
+        Record record;
+        uint64_t index_pos = 0;
+        if (!read_record(buf, size, BAG_MAGIC_SIZE, record) ||
+            record.op != OP_BAG_HEADER || !record.u64("index_pos", index_pos)) {
+            return false;
+        }
+        // an unindexed bag, of a recording that didn't finish
+        if (index_pos < record.end || index_pos >= size) return false;
+
+        for (uint64_t offset = index_pos; offset < size; offset = record.end) {
+            if (!read_record(buf, size, offset, record)) return false;
+            if (record.op == OP_CONNECTION) {
+                Connection connection;
+                if (!record.u32("conn", connection.id)) return false;
+                connection.topic =
+                    find_string(record.header, record.header_size, "topic");
+                connection.type =
+                    find_string(record.data, record.data_size, "type");
+                connections.push_back(connection);
+            } else if (record.op == OP_CHUNK_INFO) {
+                Chunk info;
+                uint32_t count = 0;
+                if (!record.u64("chunk_pos", info.pos) ||
+                    !record.time("start_time", info.start_time) ||
+                    !record.time("end_time", info.end_time) ||
+                    !record.u32("count", count) ||
+                    record.data_size / 8 < count) {
+                    return false;
+                }
+                for (uint32_t i = 0; i < count; ++i) {
+                    info.connections.push_back(le32(record.data + i * 8));
+                }
+                chunks.push_back(info);
+            }
+        }
+
+        for (auto& info : chunks) {
+            uint32_t compression_size = 0;
+            if (!read_record(buf, size, info.pos, record) ||
+                record.op != OP_CHUNK) {
+                return false;
+            }
+            const uint8_t* compression =
+                find_field(record.header, record.header_size, "compression",
+                           compression_size);
+            if (compression == nullptr || compression_size != 4 ||
+                std::memcmp(compression, "none", 4) != 0) {
+                return false;
+            }
+            info.data = record.end - record.data_size;
+            info.size = record.data_size;
+        }
+        std::sort(chunks.begin(), chunks.end(),
+                  [](const Chunk& a, const Chunk& b) { return a.pos < b.pos; });
+        return true;
+    }
+
+    /**
+     * Find the sensors and route the connections of their topics.
+     *
+     * @param[in] with_metadata Route the metadata topics too.
+     */
+    void route(bool with_metadata) {
+        for (const auto& connection : connections) {
+            if (is_packet_msg(connection.type) &&
+                contains(connection.topic, "lidar_packets") &&
+                std::find(lidar_topics.begin(), lidar_topics.end(),
+                          connection.topic) == lidar_topics.end()) {
+                lidar_topics.push_back(connection.topic);
+            }
+        }
+
+        auto route_topic = [this](const std::string& topic, int32_t idx,
+                                  Kind kind) {
+            for (const auto& connection : connections) {
+                if (connection.topic == topic) {
+                    routes[connection.id] = Route{idx, kind};
+                }
+            }
+        };
+        for (size_t i = 0; i < lidar_topics.size(); ++i) {
+            const auto& topic = lidar_topics[i];
+            const auto slash = topic.rfind('/');
+            const std::string ns =
+                (slash == std::string::npos ? "" : topic.substr(0, slash)) +
+                "/";
+            const auto idx = static_cast<int32_t>(i);
+            route_topic(topic, idx, LIDAR);
+            for (const auto& connection : connections) {
+                if (is_packet_msg(connection.type) &&
+                    contains(connection.topic, "imu_packets") &&
+                    contains(connection.topic, ns)) {
+                    route_topic(connection.topic, idx, IMU);
+                    break;
+                }
+            }
+            if (!with_metadata) continue;
+            bool found = false;
+            for (const auto& connection : connections) {
+                if (is_string_msg(connection.type) &&
+                    contains(connection.topic, "metadata") &&
+                    contains(connection.topic, ns)) {
+                    route_topic(connection.topic, idx, METADATA);
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                throw std::runtime_error(
+                    "BagPacketReader: could not find metadata for topic " +
+                    topic);
+            }
+        }
+    }
+
+    /**
+     * Read the last metadata message of every sensor, from the chunks which
+     * have messages of the metadata topics according to the index.
+     */
+    std::vector<std::string> read_metadata() const {
+        std::vector<std::string> metadata(lidar_topics.size());
+        for (const auto& info : chunks) {
+            bool has_metadata = false;
+            for (auto id : info.connections) {
+                auto it = routes.find(id);
+                has_metadata |=
+                    it != routes.end() && it->second.kind == METADATA;
+            }
+            if (!has_metadata) continue;
+
+            const uint8_t* records = buf + info.data;
+            Record record;
+            for (uint64_t offset = 0; offset < info.size;
+                 offset = record.end) {
+                if (!read_record(records, info.size, offset, record)) {
+                    throw std::runtime_error(
+                        "BagPacketReader: invalid record in chunk");
+                }
+                uint32_t id = 0;
+                if (record.op != OP_MESSAGE_DATA || !record.u32("conn", id)) {
+                    continue;
+                }
+                auto it = routes.find(id);
+                if (it == routes.end() || it->second.kind != METADATA) {
+                    continue;
+                }
+                // a std_msgs/String, its size then its characters
+                if (record.data_size < 4 ||
+                    le32(record.data) > record.data_size - 4) {
+                    continue;
+                }
+                metadata[it->second.sensor_idx].assign(
+                    reinterpret_cast<const char*>(record.data + 4),
+                    le32(record.data));
+            }
+        }
+        return metadata;
+    }
+};
+
+BagPacketReader::BagPacketReader(
+    const std::string& filename,
+    const std::vector<ouster::sensor::sensor_info>& sensor_infos,
+    bool soft_id_check)
+    : impl(new bag_reader_impl()) {
+    if (!impl->map(filename) || !impl->read_index()) {
+        throw std::runtime_error(
+            "BagPacketReader: not an indexed ROS1 bag with uncompressed "
+            "chunks: " +
+            filename);
+    }
+    impl->soft_id_check = soft_id_check;
+    impl->route(sensor_infos.empty());
+    if (impl->lidar_topics.empty()) {
+        throw std::runtime_error("BagPacketReader: no lidar packet topic in " +
+                                 filename);
+    }
+
+    if (sensor_infos.empty()) {
+        const auto metadata = impl->read_metadata();
+        for (size_t i = 0; i < metadata.size(); ++i) {
+            if (metadata[i].empty()) {
+                throw std::runtime_error(
+                    "BagPacketReader: no metadata message for topic " +
+                    impl->lidar_topics[i]);
+            }
+            impl->infos.emplace_back(metadata[i]);
+        }
+    } else if (sensor_infos.size() != impl->lidar_topics.size()) {
+        throw std::invalid_argument(
+            "Incorrect number of metadata files provided. Expected " +
+            std::to_string(impl->lidar_topics.size()) + " got " +
+            std::to_string(sensor_infos.size()) + ".");
+    } else {
+        impl->infos = sensor_infos;
+    }
+    for (const auto& info : impl->infos) impl->formats.emplace_back(info);
+}
+
+BagPacketReader::~BagPacketReader() = default;
+
+bool BagPacketReader::readable(const std::string& filename) {
+    bag_reader_impl bag;
+    return bag.map(filename) && bag.read_index();
+}
+
+const std::vector<ouster::sensor::sensor_info>&
+BagPacketReader::sensor_infos() const {
+    return impl->infos;
+}
+
+const std::vector<std::string>& BagPacketReader::lidar_topics() const {
+    return impl->lidar_topics;
+}
+
+uint64_t BagPacketReader::start_time() const {
+    if (impl->chunks.empty()) return 0;
+    uint64_t ts = impl->chunks.front().start_time;
+    for (const auto& info : impl->chunks) ts = std::min(ts, info.start_time);
+    return ts;
+}
+
+uint64_t BagPacketReader::end_time() const {
+    uint64_t ts = 0;
+    for (const auto& info : impl->chunks) ts = std::max(ts, info.end_time);
+    return ts;
+}
+
+size_t BagPacketReader::read_batch(PacketBatch& batch, size_t max_packets) {
+    using ouster::sensor::PacketType;
+    using ouster::sensor::PacketValidationFailure;
+
+    batch.clear();
+    if (batch.formats.size() != impl->formats.size()) {
+        batch.formats.clear();
+        for (const auto& pf : impl->formats) {
+            batch.formats.push_back(
+                std::make_shared<ouster::sensor::packet_format>(pf));
+        }
+    }
+
+    auto& bag = *impl;
+    Record record;
+    while (batch.entries.size() < max_packets &&
+           bag.chunk < bag.chunks.size()) {
+        const auto& info = bag.chunks[bag.chunk];
+        if (bag.pos >= info.size) {
+            bag.chunk++;
+            bag.pos = 0;
+            continue;
+        }
+        if (!read_record(bag.buf + info.data, info.size, bag.pos, record)) {
+            throw std::runtime_error(
+                "BagPacketReader: invalid record in chunk");
+        }
+        bag.pos = record.end;
+
+        uint32_t id = 0;
+        uint64_t ts = 0;
+        if (record.op != OP_MESSAGE_DATA || !record.u32("conn", id) ||
+            !record.time("time", ts) || ts < bag.min_ts) {
+            continue;
+        }
+        auto it = bag.routes.find(id);
+        if (it == bag.routes.end() ||
+            it->second.kind == bag_reader_impl::METADATA) {
+            continue;
+        }
+
+        // a PacketMsg, the size of its uint8[] buf then its bytes
+        const auto idx = it->second.sensor_idx;
+        const auto& pf = bag.formats[idx];
+        const bool lidar = it->second.kind == bag_reader_impl::LIDAR;
+        if (record.data_size < 4 || le32(record.data) > record.data_size - 4) {
+            batch.size_errors++;
+            continue;
+        }
+        const uint8_t* data = record.data + 4;
+        size_t size = le32(record.data);
+        // older versions of ouster-ros wrote one byte too many
+        const size_t packet_size =
+            lidar ? pf.lidar_packet_size : pf.imu_packet_size;
+        if (size == packet_size + 1) size = packet_size;
+
+        const auto type = lidar ? PacketType::Lidar : PacketType::Imu;
+        auto res = validate_packet(bag.infos[idx], pf, data, size, type);
+        if (res == PacketValidationFailure::PACKET_SIZE) {
+            batch.size_errors++;
+            continue;
+        }
+        if (res == PacketValidationFailure::ID) {
+            batch.id_errors++;
+            if (!bag.soft_id_check) continue;
+        }
+
+        PacketBatch::Entry entry;
+        entry.offset = batch.data.size();
+        entry.size = size;
+        entry.timestamp = ts;
+        entry.sensor_idx = idx;
+        entry.type = static_cast<int32_t>(type);
+        batch.data.insert(batch.data.end(), data, data + size);
+        batch.entries.push_back(entry);
+    }
+    return batch.entries.size();
+}
+
+void BagPacketReader::reset() {
+    impl->chunk = 0;
+    impl->pos = 0;
+    impl->min_ts = 0;
+}
+
+void BagPacketReader::seek_to_time(uint64_t ts) {
+    const auto& chunks = impl->chunks;
+    impl->chunk = static_cast<size_t>(
+        std::find_if(chunks.begin(), chunks.end(),
+                     [ts](const bag_reader_impl::Chunk& info) {
+                         return info.end_time >= ts;
+                     }) -
+        chunks.begin());
+    impl->pos = 0;
+    impl->min_ts = ts;
+}
+
+}  // namespace sensor_utils
+}  // namespace ouster
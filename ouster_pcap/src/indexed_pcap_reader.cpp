@@ -1,18 +1,250 @@
 #include "ouster/indexed_pcap_reader.h"
 
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <future>
 #include <iostream>
+#include <memory>
 #include <stdexcept>
+#include <thread>
 
 #include "ouster/packet.h"
+#include "ouster/threads.h"
 #include "ouster/types.h"
 
 namespace ouster {
 namespace sensor_utils {
 
+namespace {
+
+constexpr char INDEX_MAGIC[8] = {'O', 'P', 'C', 'A', 'P', 'I', 'D', 'X'};
+constexpr uint32_t INDEX_VERSION = 2;
+
+/**
+ * The size and modification time of a file, false if it can't be stat'ed.
+ */
+bool file_stat(const std::string& filename, uint64_t& size, int64_t& mtime) {
+    struct stat st;
+    if (stat(filename.c_str(), &st) != 0) return false;
+    size = static_cast<uint64_t>(st.st_size);
+    mtime = static_cast<int64_t>(st.st_mtime);
+    return true;
+}
+
+/**
+ * FNV-1a hash of the metadata of the sensors, the same on every run unlike
+ * std::hash.
+ */
+uint64_t sensor_infos_hash(
+    const std::vector<ouster::sensor::sensor_info>& sensor_infos) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const auto& info : sensor_infos) {
+        for (char c : info.to_json_string() + '\0') {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 0x100000001b3ULL;
+        }
+    }
+    return hash;
+}
+
+template <typename T>
+void write_value(std::ofstream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool read_value(std::ifstream& in, T& value) {
+    return static_cast<bool>(
+        in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+constexpr uint64_t PCAP_FILE_HEADER_SIZE = 24;
+constexpr uint64_t PCAP_RECORD_HEADER_SIZE = 16;
+// smallest byte range indexed by a thread of build_index_parallel()
+constexpr uint64_t MIN_SHARD_SIZE = 16 * 1024 * 1024;
+// bytes read before a range for the fragments of its first packets
+constexpr uint64_t SHARD_OVERLAP = 256 * 1024;
+// records following a candidate record header that must be valid too
+constexpr int RESYNC_RECORDS = 4;
+
+/**
+ * The layout of the record headers of a classic pcap file.
+ */
+struct PcapRecordFormat {
+    bool swapped;         ///< whether in the other byte order than the host
+    uint32_t max_subsec;  ///< microseconds or nanoseconds in a second
+    uint32_t snaplen;     ///< the largest captured length of a packet
+};
+
+uint32_t read_u32(const uint8_t* buf, bool swapped) {
+    uint32_t value;
+    std::memcpy(&value, buf, sizeof(value));
+    if (swapped) {
+        value = ((value & 0xff) << 24) | ((value & 0xff00) << 8) |
+                ((value >> 8) & 0xff00) | (value >> 24);
+    }
+    return value;
+}
+
+/**
+ * Read the record format from the header of a pcap file, false if it isn't
+ * a classic pcap file.
+ */
+bool read_record_format(std::ifstream& in, PcapRecordFormat& format) {
+    uint8_t header[PCAP_FILE_HEADER_SIZE];
+    if (!in.seekg(0) ||
+        !in.read(reinterpret_cast<char*>(header), sizeof(header))) {
+        return false;
+    }
+    switch (read_u32(header, false)) {
+        case 0xa1b2c3d4:
+            format = {false, 1000000, 0};
+            break;
+        case 0xd4c3b2a1:
+            format = {true, 1000000, 0};
+            break;
+        case 0xa1b23c4d:
+            format = {false, 1000000000, 0};
+            break;
+        case 0x4d3cb2a1:
+            format = {true, 1000000000, 0};
+            break;
+        default:
+            return false;
+    }
+    format.snaplen = read_u32(header + 16, format.swapped);
+    if (format.snaplen == 0) format.snaplen = 0x40000;
+    return true;
+}
+
+/**
+ * Whether the bytes could be a pcap record header.
+ *
+ * @return the size of the record, 0 if they can't.
+ */
+uint64_t record_size(const uint8_t* header, const PcapRecordFormat& format) {
+    const uint32_t subsec = read_u32(header + 4, format.swapped);
+    const uint32_t incl_len = read_u32(header + 8, format.swapped);
+    const uint32_t orig_len = read_u32(header + 12, format.swapped);
+    if (subsec >= format.max_subsec || incl_len == 0 ||
+        incl_len > format.snaplen || incl_len > orig_len) {
+        return 0;
+    }
+    return PCAP_RECORD_HEADER_SIZE + incl_len;
+}
+
+/**
+ * Find the first pcap record in [offset, end), i.e. the first bytes which
+ * could be a record header and are followed by RESYNC_RECORDS more of them
+ * or the end of the file.
+ *
+ * @return the offset of the record, end if none.
+ */
+uint64_t resync_record(std::ifstream& in, const PcapRecordFormat& format,
+                       uint64_t offset, uint64_t end, uint64_t file_size) {
+    auto valid_chain = [&](uint64_t record, uint64_t size) {
+        uint8_t header[PCAP_RECORD_HEADER_SIZE];
+        for (int i = 0; i < RESYNC_RECORDS; ++i) {
+            record += size;
+            if (record == file_size) return true;
+            if (record + PCAP_RECORD_HEADER_SIZE > file_size ||
+                !in.seekg(record) ||
+                !in.read(reinterpret_cast<char*>(header), sizeof(header))) {
+                in.clear();
+                return false;
+            }
+            size = record_size(header, format);
+            if (size == 0) return false;
+        }
+        return true;
+    };
+
+    std::vector<uint8_t> window(1024 * 1024);
+    while (offset < end) {
+        const uint64_t count = std::min<uint64_t>(
+            window.size(), file_size - std::min(offset, file_size));
+        if (count < PCAP_RECORD_HEADER_SIZE || !in.seekg(offset) ||
+            !in.read(reinterpret_cast<char*>(window.data()), count)) {
+            in.clear();
+            return end;
+        }
+        const uint64_t last = count - PCAP_RECORD_HEADER_SIZE;
+        for (uint64_t i = 0; i <= last && offset + i < end; ++i) {
+            const uint64_t size = record_size(window.data() + i, format);
+            if (size != 0 && valid_chain(offset + i, size)) return offset + i;
+        }
+        offset += last + 1;
+    }
+    return end;
+}
+
+/**
+ * The first packet of a sensor after one of another frame id.
+ */
+struct FrameStart {
+    uint16_t frame_id;
+    uint64_t offset;
+    uint64_t timestamp;
+};
+
+/**
+ * The frames found in a byte range of the pcap.
+ */
+struct ShardIndex {
+    std::vector<std::vector<FrameStart>> frame_starts;  ///< per sensor
+    uint64_t end_offset{0};  ///< offset past the last packet read
+};
+
+/**
+ * Index the packets whose last record is in [start, end), reading from the
+ * record at read_from.
+ *
+ * Only the packets of another frame id than the previous packet of the
+ * sensor are kept. The others can't start a frame, whichever frame id
+ * update_index_for_current_packet() saw last.
+ */
+ShardIndex index_shard(
+    const std::string& pcap_filename,
+    const std::vector<ouster::sensor::sensor_info>& sensor_infos,
+    uint64_t read_from, uint64_t start, uint64_t end) {
+    IndexedPcapReader reader(pcap_filename, sensor_infos);
+    ShardIndex shard;
+    shard.frame_starts.resize(sensor_infos.size());
+    std::vector<nonstd::optional<uint16_t>> last_frame_ids(
+        sensor_infos.size());
+    reader.seek(read_from);
+    while (reader.next_packet() != 0) {
+        const packet_info& info = reader.current_info();
+        if (info.file_offset >= end) break;
+        shard.end_offset = static_cast<uint64_t>(reader.current_offset());
+        if (info.file_offset < start) continue;
+        nonstd::optional<size_t> sensor_idx =
+            reader.sensor_idx_for_current_packet();
+        if (!sensor_idx) continue;
+        nonstd::optional<uint16_t> frame_id = reader.current_frame_id();
+        auto& last_frame_id = last_frame_ids[*sensor_idx];
+        if (!frame_id || (last_frame_id && *last_frame_id == *frame_id)) {
+            continue;
+        }
+        last_frame_id = frame_id;
+        shard.frame_starts[*sensor_idx].push_back(
+            {*frame_id, info.file_offset,
+             static_cast<uint64_t>(info.timestamp.count())});
+    }
+    return shard;
+}
+
+}  // namespace
+
 IndexedPcapReader::IndexedPcapReader(
     const std::string& pcap_filename,
     const std::vector<std::string>& metadata_filenames)
     : PcapReader(pcap_filename),
+      pcap_filename_(pcap_filename),
       index_(metadata_filenames.size()),
       previous_frame_ids_(metadata_filenames.size()) {
     for (const std::string& metadata_filename : metadata_filenames) {
@@ -26,6 +258,7 @@ IndexedPcapReader::IndexedPcapReader(
     const std::string& pcap_filename,
     const std::vector<ouster::sensor::sensor_info>& sensor_infos)
     : PcapReader(pcap_filename),
+      pcap_filename_(pcap_filename),
       sensor_infos_(sensor_infos),
       index_(sensor_infos.size()),
       previous_frame_ids_(sensor_infos.size()) {
@@ -88,6 +321,69 @@ nonstd::optional<size_t> IndexedPcapReader::sensor_idx_for_current_packet()
     return nonstd::nullopt;
 }
 
+void PacketBatch::clear() {
+    data.clear();
+    entries.clear();
+    id_errors = 0;
+    size_errors = 0;
+}
+
+size_t IndexedPcapReader::read_batch(PacketBatch& batch, size_t max_packets) {
+    using ouster::sensor::PacketType;
+    using ouster::sensor::PacketValidationFailure;
+
+    batch.clear();
+    if (batch.formats.size() != packet_formats_.size()) {
+        batch.formats.clear();
+        for (const auto& pf : packet_formats_) {
+            batch.formats.push_back(
+                std::make_shared<ouster::sensor::packet_format>(pf));
+        }
+    }
+
+    while (batch.entries.size() < max_packets && next_packet()) {
+        const auto& pkt_info = current_info();
+        auto match = port_map_.find(pkt_info.dst_port);
+        if (match == port_map_.end()) continue;
+
+        const size_t size = pkt_info.payload_size;
+        bool id_error = false;
+        bool size_error = false;
+        for (const auto& it : match->second) {
+            const auto& pf = packet_formats_[it.second];
+            auto res = validate_packet(sensor_infos_[it.second], pf, data,
+                                       size, PacketType::Unknown);
+            if (res == PacketValidationFailure::NONE) {
+                PacketBatch::Entry entry;
+                entry.offset = batch.data.size();
+                entry.size = size;
+                entry.timestamp = static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        pkt_info.timestamp)
+                        .count());
+                entry.sensor_idx = static_cast<int32_t>(it.second);
+                entry.type = static_cast<int32_t>(
+                    size == pf.imu_packet_size ? PacketType::Imu
+                                               : PacketType::Lidar);
+                batch.data.insert(batch.data.end(), data, data + size);
+                batch.entries.push_back(entry);
+                id_error = size_error = false;
+                break;
+            }
+            if (res == PacketValidationFailure::ID) id_error = true;
+            if (res == PacketValidationFailure::PACKET_SIZE) size_error = true;
+        }
+        // like the python reader, a packet failing on the id of one sensor
+        // only counts as an id error
+        if (id_error) {
+            batch.id_errors++;
+        } else if (size_error) {
+            batch.size_errors++;
+        }
+    }
+    return batch.entries.size();
+}
+
 nonstd::optional<uint16_t> IndexedPcapReader::current_frame_id() const {
     if (nonstd::optional<size_t> sensor_idx = sensor_idx_for_current_packet()) {
         const ouster::sensor::packet_format& pf =
@@ -118,29 +414,246 @@ int IndexedPcapReader::update_index_for_current_packet() {
                      current_info().file_offset});
                 index_.frame_id_indices_[*sensor_info_idx].insert(
                     {*frame_id, current_info().file_offset});
+                index_.frame_timestamps_[*sensor_info_idx].push_back(
+                    current_info().timestamp.count());
+                index_.frame_ids_[*sensor_info_idx].push_back(*frame_id);
                 previous_frame_ids_[*sensor_info_idx] = *frame_id;
             }
         }
     }
 
-    return static_cast<int>(100 * static_cast<float>(current_offset()) /
+    indexed_offset_ = static_cast<uint64_t>(current_offset());
+    return static_cast<int>(100 * static_cast<float>(indexed_offset_) /
                             file_size());
 }
 
 void IndexedPcapReader::build_index() {
     index_.clear();
+    for (auto& frame_id : previous_frame_ids_) frame_id = nonstd::nullopt;
+    indexed_offset_ = 0;
     reset();
     while (next_packet() != 0) update_index_for_current_packet();
     reset();
 }
 
+void IndexedPcapReader::build_index_parallel(unsigned int num_threads) {
+    if (num_threads == 0) {
+        num_threads = sdk_thread_count();
+    }
+    const uint64_t size = static_cast<uint64_t>(file_size());
+    const uint64_t shards =
+        std::min<uint64_t>(num_threads, size / MIN_SHARD_SIZE);
+    PcapRecordFormat format;
+    std::ifstream in(pcap_filename_, std::ios::binary);
+    if (shards <= 1 || !read_record_format(in, format)) {
+        build_index();
+        return;
+    }
+
+    std::vector<std::future<ShardIndex>> futures;
+    const uint64_t shard_size = (size - PCAP_FILE_HEADER_SIZE) / shards;
+    for (uint64_t i = 0; i < shards; ++i) {
+        const uint64_t start = PCAP_FILE_HEADER_SIZE + i * shard_size;
+        const uint64_t end = i + 1 == shards ? size : start + shard_size;
+        uint64_t read_from = PCAP_FILE_HEADER_SIZE;
+        if (i > 0) {
+            read_from = resync_record(
+                in, format,
+                std::max(PCAP_FILE_HEADER_SIZE, start - SHARD_OVERLAP), end,
+                size);
+        }
+        futures.push_back(std::async(std::launch::async, index_shard,
+                                     pcap_filename_, sensor_infos_, read_from,
+                                     start, end));
+    }
+
+    index_.clear();
+    for (auto& frame_id : previous_frame_ids_) frame_id = nonstd::nullopt;
+    indexed_offset_ = 0;
+    for (auto& future : futures) {
+        ShardIndex shard = future.get();
+        for (size_t i = 0; i < shard.frame_starts.size(); ++i) {
+            auto& previous = previous_frame_ids_[i];
+            for (const FrameStart& frame : shard.frame_starts[i]) {
+                if (previous && *previous >= frame.frame_id &&
+                    !frame_id_rolled_over(*previous, frame.frame_id)) {
+                    continue;
+                }
+                index_.frame_indices_[i].push_back(frame.offset);
+                index_.frame_timestamp_indices_[i].insert(
+                    {frame.timestamp, frame.offset});
+                index_.frame_id_indices_[i].insert(
+                    {frame.frame_id, frame.offset});
+                index_.frame_timestamps_[i].push_back(frame.timestamp);
+                index_.frame_ids_[i].push_back(frame.frame_id);
+                previous = frame.frame_id;
+            }
+        }
+        indexed_offset_ = std::max(indexed_offset_, shard.end_offset);
+    }
+    reset();
+}
+
+bool IndexedPcapReader::build_index(const std::string& index_filename) {
+    const bool loaded = load_index_(index_filename);
+    const uint64_t loaded_offset = indexed_offset_;
+    if (loaded) {
+        // only the packets recorded since the index was saved are indexed
+        seek(indexed_offset_);
+        while (next_packet() != 0) update_index_for_current_packet();
+        reset();
+    } else {
+        build_index();
+    }
+    if (!loaded || indexed_offset_ != loaded_offset) save_index(index_filename);
+    return loaded;
+}
+
+bool IndexedPcapReader::save_index(const std::string& index_filename) const {
+    uint64_t pcap_size = 0;
+    int64_t pcap_mtime = 0;
+    if (!file_stat(pcap_filename_, pcap_size, pcap_mtime)) return false;
+
+    std::ofstream out(index_filename, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    out.write(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    write_value(out, INDEX_VERSION);
+    write_value(out, sensor_infos_hash(sensor_infos_));
+    write_value(out, pcap_size);
+    write_value(out, pcap_mtime);
+    write_value(out, indexed_offset_);
+    write_value(out, static_cast<uint64_t>(sensor_infos_.size()));
+    for (size_t i = 0; i < sensor_infos_.size(); ++i) {
+        const auto& previous = previous_frame_ids_[i];
+        write_value(out, static_cast<uint8_t>(previous ? 1 : 0));
+        write_value(out, previous ? *previous : uint16_t{0});
+
+        const auto& frames = index_.frame_indices_[i];
+        write_value(out, static_cast<uint64_t>(frames.size()));
+        for (size_t j = 0; j < frames.size(); ++j) {
+            write_value(out, frames[j]);
+            write_value(out, index_.frame_timestamps_[i][j]);
+            write_value(out, index_.frame_ids_[i][j]);
+        }
+
+        const auto& timestamps = index_.frame_timestamp_indices_[i];
+        write_value(out, static_cast<uint64_t>(timestamps.size()));
+        for (const auto& entry : timestamps) {
+            write_value(out, entry.first);
+            write_value(out, entry.second);
+        }
+
+        const auto& frame_ids = index_.frame_id_indices_[i];
+        write_value(out, static_cast<uint64_t>(frame_ids.size()));
+        for (const auto& entry : frame_ids) {
+            write_value(out, entry.first);
+            write_value(out, entry.second);
+        }
+    }
+    out.close();
+    return static_cast<bool>(out);
+}
+
+bool IndexedPcapReader::load_index_(const std::string& index_filename) {
+    uint64_t pcap_size = 0;
+    int64_t pcap_mtime = 0;
+    if (!file_stat(pcap_filename_, pcap_size, pcap_mtime)) return false;
+
+    std::ifstream in(index_filename, std::ios::binary);
+    if (!in) return false;
+    char magic[sizeof(INDEX_MAGIC)];
+    uint32_t version = 0;
+    uint64_t hash = 0;
+    uint64_t saved_size = 0;
+    int64_t saved_mtime = 0;
+    uint64_t offset = 0;
+    uint64_t num_sensors = 0;
+    if (!in.read(magic, sizeof(magic)) ||
+        std::memcmp(magic, INDEX_MAGIC, sizeof(magic)) != 0 ||
+        !read_value(in, version) || version != INDEX_VERSION ||
+        !read_value(in, hash) || hash != sensor_infos_hash(sensor_infos_) ||
+        !read_value(in, saved_size) || !read_value(in, saved_mtime) ||
+        !read_value(in, offset) || !read_value(in, num_sensors) ||
+        num_sensors != sensor_infos_.size()) {
+        return false;
+    }
+    // a pcap that shrank, or was rewritten to the same size, was replaced
+    if (pcap_size < saved_size ||
+        (pcap_size == saved_size && pcap_mtime != saved_mtime) ||
+        offset > pcap_size) {
+        return false;
+    }
+
+    PcapIndex index(sensor_infos_.size());
+    std::vector<nonstd::optional<uint16_t>> previous_frame_ids(
+        sensor_infos_.size());
+    for (size_t i = 0; i < sensor_infos_.size(); ++i) {
+        uint8_t has_previous = 0;
+        uint16_t previous = 0;
+        if (!read_value(in, has_previous) || !read_value(in, previous)) {
+            return false;
+        }
+        if (has_previous) previous_frame_ids[i] = previous;
+
+        uint64_t count = 0;
+        if (!read_value(in, count)) return false;
+        for (uint64_t j = 0; j < count; ++j) {
+            uint64_t frame_offset = 0;
+            uint64_t ts = 0;
+            uint16_t frame_id = 0;
+            if (!read_value(in, frame_offset) || !read_value(in, ts) ||
+                !read_value(in, frame_id)) {
+                return false;
+            }
+            index.frame_indices_[i].push_back(frame_offset);
+            index.frame_timestamps_[i].push_back(ts);
+            index.frame_ids_[i].push_back(frame_id);
+        }
+
+        if (!read_value(in, count)) return false;
+        for (uint64_t j = 0; j < count; ++j) {
+            uint64_t ts = 0;
+            uint64_t frame_offset = 0;
+            if (!read_value(in, ts) || !read_value(in, frame_offset)) {
+                return false;
+            }
+            index.frame_timestamp_indices_[i].insert({ts, frame_offset});
+        }
+
+        if (!read_value(in, count)) return false;
+        for (uint64_t j = 0; j < count; ++j) {
+            int32_t frame_id = 0;
+            uint64_t frame_offset = 0;
+            if (!read_value(in, frame_id) || !read_value(in, frame_offset)) {
+                return false;
+            }
+            index.frame_id_indices_[i].insert({frame_id, frame_offset});
+        }
+    }
+
+    index_ = std::move(index);
+    previous_frame_ids_ = std::move(previous_frame_ids);
+    indexed_offset_ = offset;
+    return true;
+}
+
 const PcapIndex& IndexedPcapReader::get_index() const { return index_; }
 
+size_t IndexedPcapReader::seek_to_time(size_t sensor_index,
+                                       std::chrono::microseconds ts) {
+    const size_t frame = index_.frame_at_timestamp(
+        sensor_index, static_cast<uint64_t>(std::max<int64_t>(ts.count(), 0)));
+    index_.seek_to_frame(*this, sensor_index, static_cast<unsigned int>(frame));
+    return frame;
+}
+
 void PcapIndex::clear() {
     for (size_t i = 0; i < frame_indices_.size(); ++i) {
         frame_indices_[i].clear();
         frame_timestamp_indices_[i].clear();
         frame_id_indices_[i].clear();
+        frame_timestamps_[i].clear();
+        frame_ids_[i].clear();
     }
 }
 
@@ -153,5 +666,17 @@ size_t PcapIndex::frame_count(size_t sensor_index) const {
     return frame_indices_.at(sensor_index).size();
 }
 
+size_t PcapIndex::frame_at_timestamp(size_t sensor_index, uint64_t ts) const {
+    const auto& timestamps = frame_timestamps_.at(sensor_index);
+    if (timestamps.empty()) {
+        throw std::out_of_range("no frames of sensor " +
+                                std::to_string(sensor_index));
+    }
+    auto it = std::upper_bound(timestamps.begin(), timestamps.end(), ts);
+    return it == timestamps.begin()
+               ? 0
+               : static_cast<size_t>(it - timestamps.begin()) - 1;
+}
+
 }  // namespace sensor_utils
 }  // namespace ouster
@@ -0,0 +1,482 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "mapped_pcap.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+
+namespace ouster {
+namespace sensor_utils {
+
+namespace {
+
+constexpr uint64_t PCAP_FILE_HEADER_SIZE = 24;
+constexpr uint64_t PCAP_RECORD_HEADER_SIZE = 16;
+constexpr uint32_t MAX_SNAPLEN = 262144;
+
+constexpr uint32_t PCAPNG_SECTION_HEADER = 0x0A0D0D0A;
+constexpr uint32_t PCAPNG_INTERFACE_DESCRIPTION = 1;
+constexpr uint32_t PCAPNG_PACKET = 2;
+constexpr uint32_t PCAPNG_SIMPLE_PACKET = 3;
+constexpr uint32_t PCAPNG_ENHANCED_PACKET = 6;
+constexpr uint32_t PCAPNG_BYTE_ORDER_MAGIC = 0x1A2B3C4D;
+constexpr uint16_t PCAPNG_IF_TSRESOL = 9;
+
+constexpr int LINKTYPE_ETHERNET = 1;
+constexpr int LINKTYPE_RAW = 101;
+constexpr int LINKTYPE_LINUX_SLL = 113;
+constexpr int LINKTYPE_IPV4 = 228;
+constexpr int LINKTYPE_IPV6 = 229;
+constexpr int LINKTYPE_LINUX_SLL2 = 276;
+
+constexpr uint16_t ETHERTYPE_IPV4 = 0x0800;
+constexpr uint16_t ETHERTYPE_IPV6 = 0x86DD;
+constexpr uint16_t ETHERTYPE_VLAN = 0x8100;
+constexpr uint16_t ETHERTYPE_QINQ = 0x88A8;
+constexpr uint16_t ETHERTYPE_VLAN_LEGACY = 0x9100;
+
+constexpr uint8_t PROTOCOL_UDP = 17;
+constexpr uint64_t UDP_HEADER_SIZE = 8;
+
+bool parsed_link_type(int link_type) {
+    return link_type == LINKTYPE_ETHERNET || link_type == LINKTYPE_RAW ||
+           link_type == LINKTYPE_LINUX_SLL || link_type == LINKTYPE_IPV4 ||
+           link_type == LINKTYPE_IPV6 || link_type == LINKTYPE_LINUX_SLL2;
+}
+
+uint16_t be16(const uint8_t* buf) {
+    return static_cast<uint16_t>((buf[0] << 8) | buf[1]);
+}
+
+uint32_t swap32(uint32_t value) {
+    return ((value & 0xff) << 24) | ((value & 0xff00) << 8) |
+           ((value >> 8) & 0xff00) | (value >> 24);
+}
+
+std::chrono::microseconds to_microseconds(uint64_t ts,
+                                          uint64_t units_per_second) {
+    return std::chrono::microseconds(static_cast<int64_t>(
+        ts / units_per_second * 1000000 +
+        ts % units_per_second * 1000000 / units_per_second));
+}
+
+/**
+ * Find the IP packet of a link layer frame.
+ *
+ * @param[in] record The frame.
+ * @param[out] offset The size of the link layer headers.
+ * @return false if the frame isn't IP.
+ */
+bool find_ip(const PcapRecord& record, size_t& offset) {
+    const uint8_t* buf = record.data;
+    const size_t length = record.length;
+    uint16_t ethertype = 0;
+    offset = 0;
+    switch (record.link_type) {
+        case LINKTYPE_ETHERNET:
+            if (length < 14) return false;
+            ethertype = be16(buf + 12);
+            offset = 14;
+            while (ethertype == ETHERTYPE_VLAN || ethertype == ETHERTYPE_QINQ ||
+                   ethertype == ETHERTYPE_VLAN_LEGACY) {
+                if (length < offset + 4) return false;
+                ethertype = be16(buf + offset + 2);
+                offset += 4;
+            }
+            break;
+        case LINKTYPE_LINUX_SLL:
+            if (length < 16) return false;
+            ethertype = be16(buf + 14);
+            offset = 16;
+            break;
+        case LINKTYPE_LINUX_SLL2:
+            if (length < 20) return false;
+            ethertype = be16(buf);
+            offset = 20;
+            break;
+        case LINKTYPE_RAW:
+        case LINKTYPE_IPV4:
+        case LINKTYPE_IPV6:
+            if (length < 1) return false;
+            ethertype = (buf[0] >> 4) == 6 ? ETHERTYPE_IPV6 : ETHERTYPE_IPV4;
+            break;
+        default:
+            return false;
+    }
+    return ethertype == ETHERTYPE_IPV4 || ethertype == ETHERTYPE_IPV6;
+}
+
+}  // namespace
+
+UdpDatagram::Kind parse_udp(const PcapRecord& record, UdpDatagram& udp) {
+    size_t offset = 0;
+    if (!find_ip(record, offset)) return UdpDatagram::NOT_UDP;
+
+    const uint8_t* ip = record.data + offset;
+    const size_t captured = record.length - offset;
+    if (captured < 1) return UdpDatagram::NOT_UDP;
+    size_t header_size = 0;
+    size_t ip_size = 0;
+    if ((ip[0] >> 4) == 4) {
+        header_size = (ip[0] & 0x0f) * 4u;
+        if (captured < 20 || header_size < 20 || ip[9] != PROTOCOL_UDP) {
+            return UdpDatagram::NOT_UDP;
+        }
+        ip_size = be16(ip + 2);
+        udp.ip_version = 4;
+        udp.src_ip = ip + 12;
+        udp.dst_ip = ip + 16;
+    } else if ((ip[0] >> 4) == 6) {
+        header_size = 40;
+        // extension headers aren't followed, as with libtins
+        if (captured < header_size || ip[6] != PROTOCOL_UDP) {
+            return UdpDatagram::NOT_UDP;
+        }
+        ip_size = header_size + be16(ip + 4);
+        udp.ip_version = 6;
+        udp.src_ip = ip + 8;
+        udp.dst_ip = ip + 24;
+    } else {
+        return UdpDatagram::NOT_UDP;
+    }
+    if (ip_size < header_size) return UdpDatagram::NOT_UDP;
+    // the bytes past the IP packet are padding, and those past the captured
+    // length are missing
+    if (ip_size > captured) ip_size = captured;
+    udp.ip = ip;
+    udp.ip_size = ip_size;
+    udp.link_size = offset;
+
+    if (udp.ip_version == 4) {
+        const uint16_t fragment = be16(ip + 6);
+        // more fragments flag or fragment offset
+        if ((fragment & 0x2000) || (fragment & 0x1fff)) {
+            return UdpDatagram::FRAGMENT;
+        }
+    }
+
+    if (ip_size < header_size + UDP_HEADER_SIZE) return UdpDatagram::NOT_UDP;
+    const uint8_t* header = ip + header_size;
+    udp.src_port = be16(header);
+    udp.dst_port = be16(header + 2);
+    udp.payload = header + UDP_HEADER_SIZE;
+    udp.payload_size = ip_size - header_size - UDP_HEADER_SIZE;
+    return UdpDatagram::UDP;
+}
+
+std::unique_ptr<MappedPcap> MappedPcap::open(const std::string& filename) {
+    std::unique_ptr<MappedPcap> pcap(new MappedPcap());
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                              NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return nullptr;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return nullptr;
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    CloseHandle(file);
+    if (mapping == NULL) return nullptr;
+    // a copy on write view, so that the packets can be handed out as
+    // writable buffers as the ones of libtins
+    void* buf = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+    CloseHandle(mapping);
+    if (buf == NULL) return nullptr;
+    pcap->buf_ = static_cast<uint8_t*>(buf);
+    pcap->size_ = static_cast<uint64_t>(size.QuadPart);
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        ::close(fd);
+        return nullptr;
+    }
+    // a private mapping, so that the packets can be handed out as writable
+    // buffers as the ones of libtins
+    void* buf = mmap(nullptr, static_cast<size_t>(st.st_size),
+                     PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (buf == MAP_FAILED) return nullptr;
+    pcap->buf_ = static_cast<uint8_t*>(buf);
+    pcap->size_ = static_cast<uint64_t>(st.st_size);
+#endif
+    if (!pcap->init()) return nullptr;
+    return pcap;
+}
+
+MappedPcap::~MappedPcap() {
+    if (buf_ == nullptr) return;
+#ifdef _WIN32
+    UnmapViewOfFile(buf_);
+#else
+    munmap(buf_, static_cast<size_t>(size_));
+#endif
+}
+
+uint32_t MappedPcap::read_u16(uint64_t offset) const {
+    uint16_t value;
+    std::memcpy(&value, buf_ + offset, sizeof(value));
+    if (swapped_) value = static_cast<uint16_t>((value << 8) | (value >> 8));
+    return value;
+}
+
+uint32_t MappedPcap::read_u32(uint64_t offset) const {
+    uint32_t value;
+    std::memcpy(&value, buf_ + offset, sizeof(value));
+    return swapped_ ? swap32(value) : value;
+}
+
+bool MappedPcap::init() {
+    if (size_ < PCAP_FILE_HEADER_SIZE) return false;
+    uint32_t magic;
+    std::memcpy(&magic, buf_, sizeof(magic));
+    if (magic == PCAPNG_SECTION_HEADER) {
+        pcapng_ = true;
+        // the section header and the interface descriptions, up to the
+        // first packet, so that the packets seeked to have their interfaces
+        PcapRecord record;
+        if (!next_block(record)) return false;
+        uint64_t offset = offset_;
+        while (offset_ < size_) {
+            offset = offset_;
+            if (!next_block(record) || record.data != nullptr) break;
+            offset = offset_;
+        }
+        start_ = offset_ = offset;
+        return !interfaces_.empty();
+    }
+    switch (magic) {
+        case 0xa1b2c3d4:
+            break;
+        case 0xd4c3b2a1:
+            swapped_ = true;
+            break;
+        case 0xa1b23c4d:
+            units_per_second_ = 1000000000;
+            break;
+        case 0x4d3cb2a1:
+            swapped_ = true;
+            units_per_second_ = 1000000000;
+            break;
+        default:
+            return false;
+    }
+    snaplen_ = read_u32(16);
+    link_type_ = static_cast<int>(read_u32(20) & 0xffff);
+    start_ = offset_ = PCAP_FILE_HEADER_SIZE;
+    if (record_size(start_) != 0) first_sec_ = read_u32(start_);
+    return parsed_link_type(link_type_);
+}
+
+uint64_t MappedPcap::size() const { return size_; }
+
+uint64_t MappedPcap::start() const { return start_; }
+
+uint64_t MappedPcap::offset() const { return offset_; }
+
+void MappedPcap::seek(uint64_t offset) { offset_ = offset; }
+
+bool MappedPcap::next(PcapRecord& record) {
+    if (pcapng_) {
+        while (offset_ < size_) {
+            if (!next_block(record)) return false;
+            if (record.data != nullptr) return true;
+        }
+        return false;
+    }
+
+    // as libpcap, bytes which can't be a record header, e.g. seeked into the
+    // middle of a record, end the file
+    if (record_size(offset_) == 0) return false;
+    const uint32_t ts_sec = read_u32(offset_);
+    const uint32_t ts_subsec = read_u32(offset_ + 4);
+    const uint32_t incl_len = read_u32(offset_ + 8);
+    record.data = buf_ + offset_ + PCAP_RECORD_HEADER_SIZE;
+    record.length = incl_len;
+    record.link_type = link_type_;
+    record.timestamp = std::chrono::seconds(ts_sec) +
+                       to_microseconds(ts_subsec, units_per_second_);
+    offset_ += PCAP_RECORD_HEADER_SIZE + incl_len;
+    return true;
+}
+
+uint64_t MappedPcap::record_size(uint64_t offset) const {
+    if (offset + PCAP_RECORD_HEADER_SIZE > size_) return 0;
+    const uint32_t ts_subsec = read_u32(offset + 4);
+    const uint32_t incl_len = read_u32(offset + 8);
+    const uint32_t orig_len = read_u32(offset + 12);
+    if (ts_subsec >= units_per_second_ || incl_len > orig_len ||
+        (incl_len > snaplen_ && incl_len > MAX_SNAPLEN) ||
+        offset + PCAP_RECORD_HEADER_SIZE + incl_len > size_) {
+        return 0;
+    }
+    return PCAP_RECORD_HEADER_SIZE + incl_len;
+}
+
+uint64_t MappedPcap::block_size(uint64_t offset) const {
+    if (offset + 12 > size_) return 0;
+    const uint32_t type = read_u32(offset);
+    const uint64_t length = read_u32(offset + 4);
+    // the standard block types, from interface descriptions to the
+    // systemd journal export block
+    if (type < PCAPNG_INTERFACE_DESCRIPTION || type > 9) return 0;
+    if (length < 12 || length % 4 != 0 || offset + length > size_ ||
+        read_u32(offset + length - 4) != length) {
+        return 0;
+    }
+    return length;
+}
+
+bool MappedPcap::sync(uint64_t offset) {
+    // the records or blocks following a candidate have to be valid too, so
+    // that bytes within a packet are unlikely to be taken for a header
+    constexpr int CHAIN = 4;
+    constexpr uint32_t MAX_GAP = 3600;
+    if (offset < start_) offset = start_;
+    if (pcapng_) offset = (offset + 3) / 4 * 4;
+    for (; offset < size_; offset += pcapng_ ? 4 : 1) {
+        uint64_t next = offset;
+        int valid = 0;
+        uint32_t prev_sec = 0;
+        for (; valid < CHAIN && next < size_; valid++) {
+            uint64_t size = pcapng_ ? block_size(next) : record_size(next);
+            if (size == 0) break;
+            if (!pcapng_) {
+                // with timestamps near those of the records around them
+                const uint32_t sec = read_u32(next);
+                if (sec < first_sec_ ||
+                    (valid > 0 && (sec > prev_sec + MAX_GAP ||
+                                   sec + MAX_GAP < prev_sec))) {
+                    break;
+                }
+                prev_sec = sec;
+            }
+            next += size;
+        }
+        // or end exactly at the end of the file
+        if (valid == CHAIN || (valid > 0 && next == size_)) {
+            offset_ = offset;
+            return true;
+        }
+    }
+    offset_ = size_;
+    return false;
+}
+
+bool MappedPcap::next_block(PcapRecord& record) {
+    record.data = nullptr;
+    if (offset_ + 12 > size_) return false;
+    uint32_t type;
+    std::memcpy(&type, buf_ + offset_, sizeof(type));
+    if (type == PCAPNG_SECTION_HEADER) {
+        uint32_t magic;
+        std::memcpy(&magic, buf_ + offset_ + 8, sizeof(magic));
+        if (magic == PCAPNG_BYTE_ORDER_MAGIC) {
+            swapped_ = false;
+        } else if (magic == swap32(PCAPNG_BYTE_ORDER_MAGIC)) {
+            swapped_ = true;
+        } else {
+            return false;
+        }
+        interfaces_.clear();
+    } else {
+        type = read_u32(offset_);
+    }
+    const uint64_t length = read_u32(offset_ + 4);
+    if (length < 12 || length % 4 != 0 || offset_ + length > size_) {
+        return false;
+    }
+    const uint64_t body = offset_ + 8;
+    const uint64_t body_end = offset_ + length - 4;
+
+    uint32_t interface_id = 0;
+    uint64_t ts = 0;
+    uint64_t data_offset = 0;
+    uint64_t captured = 0;
+    switch (type) {
+        case PCAPNG_INTERFACE_DESCRIPTION: {
+            if (body + 8 > body_end) return false;
+            Interface interface{offset_, static_cast<int>(read_u16(body)),
+                                read_u32(body + 4), 1000000};
+            // the options, for the timestamp resolution
+            uint64_t option = body + 8;
+            while (option + 4 <= body_end) {
+                const uint32_t code = read_u16(option);
+                const uint32_t option_length = read_u16(option + 2);
+                if (code == 0 || option + 4 + option_length > body_end) break;
+                if (code == PCAPNG_IF_TSRESOL && option_length >= 1) {
+                    const uint8_t resolution = buf_[option + 4];
+                    const uint8_t exponent = resolution & 0x7f;
+                    if (resolution & 0x80) {
+                        interface.units_per_second =
+                            exponent < 64 ? uint64_t{1} << exponent : 1;
+                    } else {
+                        interface.units_per_second = 1;
+                        for (uint8_t i = 0; i < exponent && i < 19; ++i) {
+                            interface.units_per_second *= 10;
+                        }
+                    }
+                }
+                option += 4 + (option_length + 3) / 4 * 4;
+            }
+            // read again when seeked back to
+            bool known = false;
+            for (const auto& i : interfaces_) known |= i.offset == offset_;
+            if (!known) interfaces_.push_back(interface);
+            break;
+        }
+        case PCAPNG_ENHANCED_PACKET:
+            if (body + 20 > body_end) return false;
+            interface_id = read_u32(body);
+            ts = uint64_t{read_u32(body + 4)} << 32 | read_u32(body + 8);
+            captured = read_u32(body + 12);
+            data_offset = body + 20;
+            break;
+        case PCAPNG_PACKET:
+            if (body + 20 > body_end) return false;
+            interface_id = read_u16(body);
+            ts = uint64_t{read_u32(body + 4)} << 32 | read_u32(body + 8);
+            captured = read_u32(body + 12);
+            data_offset = body + 20;
+            break;
+        case PCAPNG_SIMPLE_PACKET:
+            if (body + 4 > body_end) return false;
+            // captured up to the snap length of the first interface
+            captured = body_end - body - 4;
+            if (read_u32(body) < captured) captured = read_u32(body);
+            data_offset = body + 4;
+            break;
+        default:
+            break;
+    }
+    offset_ += length;
+
+    // packets of interfaces not described, e.g. seeked past, are skipped as
+    // if they weren't packets
+    if (data_offset == 0 || interface_id >= interfaces_.size() ||
+        data_offset + captured > body_end) {
+        return true;
+    }
+    const Interface& interface = interfaces_[interface_id];
+    record.data = buf_ + data_offset;
+    record.length = static_cast<uint32_t>(captured);
+    record.link_type = interface.link_type;
+    record.timestamp = to_microseconds(ts, interface.units_per_second);
+    return true;
+}
+
+}  // namespace sensor_utils
+}  // namespace ouster
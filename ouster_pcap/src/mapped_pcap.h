@@ -0,0 +1,178 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file mapped_pcap.h
+ * @brief Reads the packets of a memory mapped pcap or pcapng file in place
+ */
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ouster {
+namespace sensor_utils {
+
+/**
+ * A packet captured in a pcap record or a pcapng packet block.
+ */
+struct PcapRecord {
+    const uint8_t* data;                  ///< the captured bytes
+    uint32_t length;                      ///< the number of captured bytes
+    int link_type;                        ///< the link type of the packet
+    std::chrono::microseconds timestamp;  ///< the capture timestamp
+};
+
+/**
+ * The UDP datagram of a packet, found by parsing the link, IPv4 or IPv6 and
+ * UDP headers in place.
+ */
+struct UdpDatagram {
+    enum Kind {
+        NOT_UDP,  ///< not an unfragmented UDP datagram nor an IPv4 fragment
+        UDP,      ///< a whole UDP datagram
+        FRAGMENT  ///< an IPv4 fragment of a UDP datagram, headers not parsed
+    };
+
+    int ip_version;          ///< 4 or 6
+    const uint8_t* src_ip;   ///< the 4 or 16 bytes of the source address
+    const uint8_t* dst_ip;   ///< the 4 or 16 bytes of the destination address
+    uint16_t src_port;       ///< the source port, not of fragments
+    uint16_t dst_port;       ///< the destination port, not of fragments
+    const uint8_t* payload;  ///< the UDP payload, not of fragments
+    size_t payload_size;     ///< the size of the UDP payload
+    const uint8_t* ip;       ///< the IP packet
+    size_t ip_size;          ///< the size of the IP packet
+    size_t link_size;        ///< the size of the link layer headers
+};
+
+/**
+ * Parse a packet down to its UDP datagram.
+ *
+ * @param[in] record The packet.
+ * @param[out] udp The datagram, valid unless NOT_UDP is returned.
+ * @return What the packet holds.
+ */
+UdpDatagram::Kind parse_udp(const PcapRecord& record, UdpDatagram& udp);
+
+/**
+ * Reads the packets of a classic pcap or a pcapng file mapped into memory,
+ * without copying them.
+ *
+ * Offsets are those of the records, or of the blocks of pcapng files, so
+ * that they can be seeked to like those of PcapReader. The interfaces of
+ * pcapng files are known from their description blocks before the first
+ * packet block, and those read since in the current section.
+ */
+class MappedPcap {
+   public:
+    /**
+     * Map a file.
+     *
+     * @param[in] filename The file.
+     * @return The mapped file, nullptr if it can't be mapped, isn't a pcap
+     *         or pcapng file, or is a pcap file of a link type parse_udp()
+     *         doesn't parse.
+     */
+    static std::unique_ptr<MappedPcap> open(const std::string& filename);
+
+    ~MappedPcap();
+
+    MappedPcap(const MappedPcap&) = delete;
+    MappedPcap& operator=(const MappedPcap&) = delete;
+
+    /**
+     * @return The size of the file in bytes.
+     */
+    uint64_t size() const;
+
+    /**
+     * @return The offset of the first record, or of the first packet block
+     *         of pcapng files.
+     */
+    uint64_t start() const;
+
+    /**
+     * @return The offset of the next record or block.
+     */
+    uint64_t offset() const;
+
+    /**
+     * @param[in] offset The offset of a record or block.
+     */
+    void seek(uint64_t offset);
+
+    /**
+     * Read the next packet, skipping the other blocks of pcapng files.
+     *
+     * @param[out] record The packet, pointing into the mapped file.
+     * @return false at the end of the file, of its whole records, or at
+     *         bytes which aren't a record.
+     */
+    bool next(PcapRecord& record);
+
+    /**
+     * Seek to the first record or block at or after an arbitrary offset,
+     * found by checking that the headers following it are valid too.
+     *
+     * @param[in] offset The offset to search from.
+     * @return false, at the end of the file, if there is none.
+     */
+    bool sync(uint64_t offset);
+
+   private:
+    MappedPcap() = default;
+
+    /**
+     * Parse the header of the file, false if it isn't a pcap or pcapng file.
+     */
+    bool init();
+
+    /**
+     * Read the next block of a pcapng file.
+     */
+    bool next_block(PcapRecord& record);
+
+    /**
+     * The size of the record at an offset, 0 if it isn't a valid record.
+     */
+    uint64_t record_size(uint64_t offset) const;
+
+    /**
+     * The size of the pcapng block at an offset, 0 if it isn't a valid
+     * block other than a section header.
+     */
+    uint64_t block_size(uint64_t offset) const;
+
+    uint32_t read_u16(uint64_t offset) const;
+    uint32_t read_u32(uint64_t offset) const;
+
+    /**
+     * An interface of a pcapng file.
+     */
+    struct Interface {
+        uint64_t offset;  ///< of its description block
+        int link_type;
+        uint32_t snaplen;
+        uint64_t units_per_second;  ///< timestamp resolution
+    };
+
+    uint8_t* buf_{nullptr};
+    uint64_t size_{0};
+    uint64_t start_{0};
+    uint64_t offset_{0};
+    bool pcapng_{false};
+    bool swapped_{false};
+    int link_type_{0};
+    uint32_t snaplen_{0};
+    uint64_t units_per_second_{1000000};
+    uint32_t first_sec_{0};  ///< of the first record of pcap files
+    std::vector<Interface> interfaces_;
+};
+
+}  // namespace sensor_utils
+}  // namespace ouster
@@ -13,6 +13,7 @@
 #include <fstream>
 #include <memory>
 #include <ostream>
+#include <stdexcept>
 #include <thread>
 #include <vector>
 
@@ -171,6 +172,63 @@ void record_packet(record_handle& handle, const std::string& src_ip,
                                 dst_port, time);
 }
 
+namespace {
+
+/**
+ * Count a packet in the stream info.
+ */
+void add_packet(stream_info& result, const packet_info& info) {
+    if (result.total_packets == 0) {
+        result.encapsulation_protocol = info.encapsulation_protocol;
+        result.timestamp_max = info.timestamp;
+        result.timestamp_min = info.timestamp;
+    }
+    result.total_packets++;
+
+    if (info.timestamp < result.timestamp_min)
+        result.timestamp_min = info.timestamp;
+    if (info.timestamp > result.timestamp_max)
+        result.timestamp_max = info.timestamp;
+
+    stream_key key;
+
+    key.dst_ip = info.dst_ip;
+    key.src_ip = info.src_ip;
+    key.dst_port = info.dst_port;
+    key.src_port = info.src_port;
+
+    auto& stream = result.udp_streams[key];
+    stream.count++;
+    stream.payload_size_counts[info.payload_size]++;
+    stream.fragment_counts[info.fragments_in_packet]++;
+    stream.ip_version_counts[info.ip_version]++;
+}
+
+/**
+ * The number of distinct streams and payload sizes of the stream info, which
+ * grows only when a window finds something new.
+ */
+size_t distinct_sizes(const stream_info& info) {
+    size_t count = 0;
+    for (const auto& stream : info.udp_streams) {
+        count += stream.second.payload_size_counts.size();
+    }
+    return count;
+}
+
+/**
+ * Reverse the low bits of a value, to visit windows coarse to fine.
+ */
+uint32_t reverse_bits(uint32_t value, int bits) {
+    uint32_t result = 0;
+    for (int i = 0; i < bits; i++) {
+        result = (result << 1) | ((value >> i) & 1);
+    }
+    return result;
+}
+
+}  // namespace
+
 // TODO: make a member of `PcapReader` ?
 std::shared_ptr<stream_info> get_stream_info(
     PcapReader& pcap_reader,
@@ -185,7 +243,6 @@ std::shared_ptr<stream_info> get_stream_info(
 
     int i = 0;
     packet_info info;
-    bool first = true;
     uint64_t prev_location = 0;
 
     while (((packets_to_process <= 0) || (i < packets_to_process)) &&
@@ -203,31 +260,7 @@ std::shared_ptr<stream_info> get_stream_info(
         }
 
         callback_count++;
-        if (first) {
-            first = false;
-            result->encapsulation_protocol = info.encapsulation_protocol;
-            result->timestamp_max = info.timestamp;
-            result->timestamp_min = info.timestamp;
-        }
-        result->total_packets++;
-
-        if (info.timestamp < result->timestamp_min)
-            result->timestamp_min = info.timestamp;
-        if (info.timestamp > result->timestamp_max)
-            result->timestamp_max = info.timestamp;
-
-        stream_key key;
-
-        key.dst_ip = info.dst_ip;
-        key.src_ip = info.src_ip;
-        key.dst_port = info.dst_port;
-        key.src_port = info.src_port;
-
-        auto& stream = result->udp_streams[key];
-        stream.count++;
-        stream.payload_size_counts[info.payload_size]++;
-        stream.fragment_counts[info.fragments_in_packet]++;
-        stream.ip_version_counts[info.ip_version]++;
+        add_packet(*result, info);
 
         diff_acc += (info.file_offset - prev_location);
         last_current = info.file_offset;
@@ -266,6 +299,80 @@ std::shared_ptr<stream_info> get_stream_info(const std::string& file,
     return get_stream_info(
         file, [](uint64_t, uint64_t, uint64_t) {}, -1, packets_to_process);
 }
+
+std::shared_ptr<stream_info> get_stream_info_sampled(
+    const std::string& file, const stream_sampling& sampling) {
+    if (sampling.windows < 2 || sampling.packets_per_window <= 0 ||
+        sampling.stable_windows <= 0) {
+        throw std::invalid_argument(
+            "get_stream_info_sampled: invalid sampling");
+    }
+    auto handle = replay_initialize(file);
+    if (!handle || !handle->pcap) return std::make_shared<stream_info>();
+    PcapReader& reader = *handle->pcap;
+    const int windows = sampling.windows;
+    const int packets = sampling.packets_per_window;
+
+    // files which can't be seeked into are read from the start
+    if (!reader.sync(0)) {
+        return get_stream_info(
+            reader, [](uint64_t, uint64_t, uint64_t) {}, -1,
+            windows * packets);
+    }
+
+    auto result = std::make_shared<stream_info>();
+    const uint64_t start = reader.current_offset();
+    const uint64_t size = static_cast<uint64_t>(reader.file_size());
+    auto window_start = [&](int window) {
+        return start + (size - start) * static_cast<uint64_t>(window) /
+                           static_cast<uint64_t>(windows);
+    };
+    // read up to the packets of a window, not into the next one
+    auto read_window = [&](uint64_t end) {
+        for (int i = 0; i < packets && reader.next_packet(); i++) {
+            if (reader.current_info().file_offset >= end) break;
+            add_packet(*result, reader.current_info());
+        }
+    };
+
+    read_window(window_start(1));
+    const uint64_t first_bytes = reader.current_offset() - start;
+    const uint64_t first_packets = result->total_packets;
+    if (first_packets == 0 || first_bytes >= size - start) {
+        reader.reset();
+        return result;
+    }
+
+    // the last packets of the file, for the last timestamp
+    const uint64_t tail_bytes = first_bytes / first_packets * packets;
+    const uint64_t tail = size > tail_bytes ? size - tail_bytes : 0;
+    if (reader.sync(std::max(window_start(windows - 1), tail))) {
+        read_window(size);
+    }
+
+    // then windows spread over the file coarse to fine, until one in a row
+    // of stable_windows finds a stream or a payload size
+    int bits = 0;
+    while ((1 << bits) < windows) bits++;
+    std::vector<int> order;
+    for (int i = 1; i < windows - 1; i++) order.push_back(i);
+    std::sort(order.begin(), order.end(), [bits](int a, int b) {
+        return reverse_bits(a, bits) < reverse_bits(b, bits);
+    });
+    size_t distinct = distinct_sizes(*result);
+    int stable = 0;
+    for (int window : order) {
+        if (stable >= sampling.stable_windows) break;
+        if (reader.sync(window_start(window))) {
+            read_window(window_start(window + 1));
+        }
+        const size_t now = distinct_sizes(*result);
+        stable = now == distinct ? stable + 1 : 0;
+        distinct = now;
+    }
+    reader.reset();
+    return result;
+}
 /*
           The current approach is roughly: 1) treat each unique source /
    destination port and IP as a single logical 'stream' of data, 2) filter out
@@ -36,12 +36,16 @@
 #include <stdio.h>
 #include <tins/tins.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cstring>
 #include <fstream>
 #include <stdexcept>
 
 #include "ip_reassembler.h"
+#include "mapped_pcap.h"
+#include "ouster/ip_reassembly.h"
+#include "ouster/trace.h"
 
 using us = std::chrono::microseconds;
 using timepoint = std::chrono::system_clock::time_point;
@@ -49,6 +53,7 @@ using namespace Tins;
 
 static constexpr size_t UDP_BUF_SIZE = 65535;
 static constexpr int PROTOCOL_UDP = 17;
+static constexpr int LINKTYPE_IPV4 = 228;
 
 namespace ouster {
 namespace sensor_utils {
@@ -62,8 +67,75 @@ struct pcap_impl {
     IPv4Reassembler2 reassembler;  ///< The reassembler mainly for lidar packets
     bool have_new_packet;
     int encap_proto;
+    /// The mapped file read in place, libtins reads it if nullptr
+    std::unique_ptr<MappedPcap> mapped;
+    /// Reassembles the fragments of the mapped file in preallocated slots
+    sensor::IpReassembler fragments;
 };
 
+namespace {
+
+std::string ip_to_string(const uint8_t* addr, int ip_version) {
+    if (ip_version == 6) return IPv6Address(addr).to_string();
+    return std::to_string(addr[0]) + "." + std::to_string(addr[1]) + "." +
+           std::to_string(addr[2]) + "." + std::to_string(addr[3]);
+}
+
+/**
+ * Read the next UDP packet of the mapped file, parsing its headers in place
+ * and pointing data at its payload within the mapping, or within the
+ * reassembler for packets reassembled from IPv4 fragments.
+ *
+ * @return The size of the packet payload, 0 at the end of the file.
+ */
+size_t next_mapped_packet(pcap_impl& impl, packet_info& info,
+                          uint8_t*& data) {
+    PcapRecord record;
+    UdpDatagram udp;
+    int records = 0;
+    while (true) {
+        info.file_offset = impl.mapped->offset();
+        if (!impl.mapped->next(record)) return 0;
+        records++;
+        const UdpDatagram::Kind kind = parse_udp(record, udp);
+        if (kind == UdpDatagram::NOT_UDP) continue;
+
+        size_t link_size = udp.link_size;
+        if (kind == UdpDatagram::FRAGMENT) {
+            const uint8_t* datagram = nullptr;
+            size_t datagram_size = 0;
+            if (impl.fragments.process(record.timestamp, udp.ip, udp.ip_size,
+                                       datagram, datagram_size) !=
+                sensor::IpReassembler::REASSEMBLED) {
+                continue;
+            }
+            // the reassembled packet is parsed as a raw IPv4 capture
+            const PcapRecord reassembled{
+                datagram, static_cast<uint32_t>(datagram_size),
+                LINKTYPE_IPV4, record.timestamp};
+            if (parse_udp(reassembled, udp) != UdpDatagram::UDP) {
+                throw std::runtime_error("Malformed Packet: No UDP Detected");
+            }
+        }
+        info.dst_port = udp.dst_port;
+        info.src_port = udp.src_port;
+        info.payload_size = udp.payload_size;
+        info.packet_size = link_size + udp.ip_size;
+        data = const_cast<uint8_t*>(udp.payload);
+        info.dst_ip = ip_to_string(udp.dst_ip, udp.ip_version);
+        info.src_ip = ip_to_string(udp.src_ip, udp.ip_version);
+        info.ip_version = udp.ip_version;
+        info.network_protocol = PROTOCOL_UDP;
+        info.fragments_in_packet = records;
+        info.encapsulation_protocol = record.link_type;
+        info.timestamp = record.timestamp;
+        impl.have_new_packet = true;
+        return info.payload_size;
+    }
+}
+
+}  // namespace
+
 struct pcap_writer_impl {
     pcap_t* handle;
     pcap_dumper* dumper;
@@ -77,6 +149,14 @@ PcapReader::PcapReader(const std::string& file) : impl(new pcap_impl) {
         fileSizeStream.seekg(0, std::ios::end);
         file_size_ = fileSizeStream.tellg();
     }
+    // classic pcap and pcapng files of the common link types are read in
+    // place, which is much faster than building the PDUs of every packet
+    impl->mapped = MappedPcap::open(file);
+    if (impl->mapped) {
+        file_size_ = static_cast<int64_t>(impl->mapped->size());
+        file_start_ = static_cast<int64_t>(impl->mapped->start());
+        return;
+    }
     impl->pcap_reader = std::make_unique<Tins::FileSniffer>(file);
     impl->encap_proto = impl->pcap_reader->link_type();
     impl->pcap_reader_internals =
@@ -92,7 +172,16 @@ size_t PcapReader::current_length() const { return info.payload_size; }
 
 const packet_info& PcapReader::current_info() const { return info; }
 
+sensor::IpReassemblyStats PcapReader::reassembly_stats() const {
+    return impl->fragments.stats();
+}
+
 void PcapReader::seek(uint64_t offset) {
+    if (impl->mapped) {
+        impl->mapped->seek(
+            std::max(offset, static_cast<uint64_t>(file_start_)));
+        return;
+    }
     if (offset < sizeof(struct pcap_file_header)) {
         offset = sizeof(struct pcap_file_header);
     }
@@ -101,9 +190,17 @@ void PcapReader::seek(uint64_t offset) {
     }
 }
 
+bool PcapReader::sync(uint64_t offset) {
+    if (!impl->mapped) return false;
+    // fragments from before the jump won't be completed
+    impl->fragments.clear();
+    return impl->mapped->sync(offset);
+}
+
 int64_t PcapReader::file_size() const { return file_size_; }
 
 int64_t PcapReader::current_offset() const {
+    if (impl->mapped) return static_cast<int64_t>(impl->mapped->offset());
     int64_t ret = FTELL(impl->pcap_reader_internals);
 
     if (ret == -1L) {
@@ -116,6 +213,9 @@ int64_t PcapReader::current_offset() const {
 void PcapReader::reset() { seek(file_start_); }
 
 size_t PcapReader::next_packet() {
+    OUSTER_TRACE_SCOPE("pcap", "PcapReader::next_packet");
+    if (impl->mapped) return next_mapped_packet(*impl, info, data);
+
     size_t result = 0;
 
     bool reassm = false;
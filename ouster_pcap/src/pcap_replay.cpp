@@ -0,0 +1,362 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/pcap_replay.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include "ouster/impl/netcompat.h"
+#include "ouster/pcap.h"
+#include "ouster/threads.h"
+
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+
+namespace ouster {
+namespace sensor_utils {
+
+using sensor::impl::socket_close;
+using sensor::impl::socket_get_error;
+using sensor::impl::socket_valid;
+
+namespace {
+
+constexpr size_t max_datagram_size = 65535;
+
+/**
+ * Resolve a UDP address, the wildcard address of the family if host is
+ * empty.
+ */
+addrinfo* resolve(const std::string& host, int port, int family) {
+    addrinfo hints{};
+    hints.ai_family = family;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags = host.empty() ? AI_PASSIVE : 0;
+    addrinfo* result = nullptr;
+    const std::string service = std::to_string(port);
+    if (getaddrinfo(host.empty() ? nullptr : host.c_str(), service.c_str(),
+                    &hints, &result) != 0 ||
+        result == nullptr) {
+        throw std::runtime_error("PcapReplay: could not resolve address '" +
+                                 host + "'");
+    }
+    return result;
+}
+
+}  // namespace
+
+/**
+ * The socket of a stream and the buffers of its batches.
+ */
+struct PcapReplay::Sender {
+    SOCKET sock{SOCKET_ERROR};
+    std::vector<std::vector<uint8_t>> bufs;
+    std::vector<size_t> sizes;
+#ifdef __linux__
+    std::vector<iovec> iovecs;
+    std::vector<mmsghdr> msgs;
+#endif
+
+    Sender(const ReplayStream& stream, size_t batch_size) {
+        const int dst_port =
+            stream.dst_port ? stream.dst_port : stream.pcap_dst_port;
+        addrinfo* dst = resolve(stream.dst_ip, dst_port, AF_UNSPEC);
+        sock = socket(dst->ai_family, dst->ai_socktype, dst->ai_protocol);
+        if (!socket_valid(sock)) {
+            freeaddrinfo(dst);
+            throw std::runtime_error("PcapReplay: failed to open socket: " +
+                                     socket_get_error());
+        }
+        std::string error;
+        if (!stream.src_ip.empty() || stream.src_port != 0) {
+            addrinfo* src =
+                resolve(stream.src_ip, stream.src_port, dst->ai_family);
+            if (bind(sock, src->ai_addr, static_cast<int>(src->ai_addrlen))) {
+                error = "failed to bind socket: " + socket_get_error();
+            }
+            freeaddrinfo(src);
+        }
+        // connected, so that packets are sent without an address
+        if (error.empty() &&
+            connect(sock, dst->ai_addr, static_cast<int>(dst->ai_addrlen))) {
+            error = "failed to connect socket: " + socket_get_error();
+        }
+        freeaddrinfo(dst);
+        if (!error.empty()) {
+            socket_close(sock);
+            throw std::runtime_error("PcapReplay: " + error);
+        }
+
+        bufs.assign(batch_size, std::vector<uint8_t>(max_datagram_size));
+        sizes.assign(batch_size, 0);
+#ifdef __linux__
+        iovecs.resize(batch_size);
+        msgs.resize(batch_size);
+        for (size_t i = 0; i < batch_size; i++) {
+            iovecs[i].iov_base = bufs[i].data();
+            std::memset(&msgs[i], 0, sizeof(msgs[i]));
+            msgs[i].msg_hdr.msg_iov = &iovecs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+#endif
+    }
+
+    ~Sender() { socket_close(sock); }
+
+    /**
+     * Send the first n packets of the batch.
+     */
+    void send(size_t n, ReplayStats& stats) {
+#ifdef __linux__
+        for (size_t i = 0; i < n; i++) iovecs[i].iov_len = sizes[i];
+        size_t sent = 0;
+        while (sent < n) {
+            int result = sendmmsg(sock, msgs.data() + sent,
+                                  static_cast<unsigned>(n - sent), 0);
+            stats.batches++;
+            if (result < 0) {
+                if (errno == EINTR) continue;
+                // e.g. refused by the destination, the packet is dropped
+                stats.send_errors++;
+                sent++;
+                continue;
+            }
+            for (size_t i = sent; i < sent + result; i++) {
+                stats.packets++;
+                stats.bytes += msgs[i].msg_len;
+            }
+            sent += result;
+        }
+#else
+        for (size_t i = 0; i < n; i++) {
+            auto result =
+                ::send(sock, reinterpret_cast<const char*>(bufs[i].data()),
+                       static_cast<int>(sizes[i]), 0);
+            stats.batches++;
+            if (result < 0) {
+                stats.send_errors++;
+            } else {
+                stats.packets++;
+                stats.bytes += result;
+            }
+        }
+#endif
+    }
+};
+
+PcapReplay::PcapReplay(const std::string& file,
+                       const std::vector<ReplayStream>& streams,
+                       const ReplayOptions& options)
+    : file_(file), streams_(streams), options_(options) {
+    if (streams_.empty()) {
+        throw std::invalid_argument("PcapReplay: no streams to replay");
+    }
+    if (!(options_.speed >= 0.0) || options_.batch_size == 0 ||
+        options_.spin.count() < 0) {
+        throw std::invalid_argument("PcapReplay: invalid options");
+    }
+    for (const auto& stream : streams_) {
+        senders_.emplace_back(new Sender(stream, options_.batch_size));
+    }
+}
+
+PcapReplay::~PcapReplay() { stop(); }
+
+void PcapReplay::start() {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (running_ > 0 || !threads_.empty()) {
+            throw std::logic_error("PcapReplay: already started");
+        }
+    }
+
+    // the common clock starts at the first packet of any of the streams
+    bool found = false;
+    PcapReader reader(file_);
+    while (!found && reader.next_packet()) {
+        const auto& info = reader.current_info();
+        for (const auto& stream : streams_) {
+            if (info.dst_port != stream.pcap_dst_port) continue;
+            first_ts_ = info.timestamp;
+            found = true;
+            break;
+        }
+    }
+    if (!found) {
+        throw std::runtime_error("PcapReplay: no packets of the streams in " +
+                                 file_);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stop_ = false;
+        running_ = streams_.size();
+        arrived_ = 0;
+        loop_ = 0;
+        error_ = nullptr;
+        stats_.assign(streams_.size(), ReplayStats{});
+        origin_ = clock::now();
+    }
+    for (size_t i = 0; i < streams_.size(); i++) {
+        threads_.push_back(start_thread("ouster-replay-" + std::to_string(i),
+                                        [this, i] { replay(i); }));
+    }
+}
+
+void PcapReplay::wait() {
+    join();
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (error_) std::rethrow_exception(error_);
+}
+
+void PcapReplay::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    join();
+}
+
+bool PcapReplay::running() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return running_ > 0;
+}
+
+std::vector<ReplayStats> PcapReplay::stats() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return stats_;
+}
+
+void PcapReplay::join() {
+    for (auto& thread : threads_) {
+        if (thread.joinable()) thread.join();
+    }
+    threads_.clear();
+}
+
+bool PcapReplay::wait_until(clock::time_point due) {
+    {
+        std::unique_lock<std::mutex> lock(mtx_);
+        cv_.wait_until(lock, due - options_.spin, [this] { return stop_; });
+        if (stop_) return false;
+    }
+    // the last stretch is spun, sleeping could overshoot it
+    while (clock::now() < due) {
+    }
+    return true;
+}
+
+bool PcapReplay::end_loop() {
+    std::unique_lock<std::mutex> lock(mtx_);
+    const uint64_t loop = loop_;
+    if (++arrived_ == streams_.size()) {
+        arrived_ = 0;
+        loop_++;
+        origin_ = clock::now();
+        cv_.notify_all();
+    } else {
+        cv_.wait(lock, [&] { return stop_ || loop_ != loop; });
+    }
+    return !stop_;
+}
+
+void PcapReplay::replay(size_t index) {
+#ifdef __linux__
+    // wake up from sleeps when asked, spinning covers the rest
+    prctl(PR_SET_TIMERSLACK, 1UL, 0UL, 0UL, 0UL);
+#endif
+    try {
+        Sender& sender = *senders_[index];
+        const ReplayStream& stream = streams_[index];
+        const size_t batch_size = options_.batch_size;
+        const bool paced = options_.speed > 0.0;
+        PcapReader reader(file_);
+        ReplayStats stats;
+
+        auto publish = [&] {
+            std::lock_guard<std::mutex> lock(mtx_);
+            stats_[index] = stats;
+        };
+
+        for (unsigned loop = 0; options_.loops == 0 || loop < options_.loops;
+             loop++) {
+            clock::time_point origin;
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                if (stop_) break;
+                origin = origin_;
+            }
+            reader.reset();
+
+            size_t n = 0;
+            clock::time_point batch_due;
+            auto flush = [&] {
+                if (n == 0) return;
+                if (paced) {
+                    auto lateness =
+                        std::chrono::duration_cast<std::chrono::microseconds>(
+                            clock::now() - batch_due);
+                    stats.max_lateness =
+                        std::max(stats.max_lateness, lateness);
+                }
+                sender.send(n, stats);
+                n = 0;
+                publish();
+            };
+
+            bool stopped = false;
+            while (reader.next_packet()) {
+                const auto& info = reader.current_info();
+                if (info.dst_port != stream.pcap_dst_port) continue;
+                const size_t size =
+                    std::min(reader.current_length(), max_datagram_size);
+
+                clock::time_point due = origin;
+                if (paced) {
+                    std::chrono::duration<double, std::micro> offset(
+                        (info.timestamp - first_ts_).count() / options_.speed);
+                    due += std::chrono::duration_cast<clock::duration>(offset);
+                }
+                // packets already due join the batch, others wait for it
+                if (n > 0 && (n == batch_size || due > clock::now())) flush();
+                if (n == 0) {
+                    if (!wait_until(due)) {
+                        stopped = true;
+                        break;
+                    }
+                    batch_due = due;
+                }
+                std::memcpy(sender.bufs[n].data(), reader.current_data(),
+                            size);
+                sender.sizes[n++] = size;
+            }
+            flush();
+            if (stopped) break;
+
+            stats.loops++;
+            publish();
+            if (options_.loops != 0 && loop + 1 == options_.loops) break;
+            if (!end_loop()) break;
+        }
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (!error_) error_ = std::current_exception();
+        stop_ = true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        running_--;
+    }
+    cv_.notify_all();
+}
+
+}  // namespace sensor_utils
+}  // namespace ouster
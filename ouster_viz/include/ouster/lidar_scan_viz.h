@@ -0,0 +1,308 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Computes the clouds and images of a lidar scan viewer natively
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ouster/latency_histogram.h"
+#include "ouster/lidar_scan.h"
+#include "ouster/point_viz.h"
+#include "ouster/types.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace viz {
+
+/**
+ * How a LidarScanViz turns a field of the scans into the keys coloring its
+ * clouds and images, like the view modes of the Python viz.
+ */
+struct OUSTER_API_CLASS FieldViewMode {
+    /// The name of the mode as a cloud mode, e.g. "SIGNAL"
+    std::string name;
+
+    /// The field of each return, e.g. {"SIGNAL", "SIGNAL2"}
+    std::vector<std::string> fields;
+
+    /// The name of the mode as an image mode, for each return; empty to use
+    /// the names of the fields
+    std::vector<std::string> image_names;
+
+    /// Scale the keys with an AutoExposure, whose state the first return
+    /// updates
+    bool auto_exposure{true};
+
+    /// Correct the keys with a BeamUniformityCorrector first
+    bool beam_uniformity{false};
+
+    /// If greater than zero, the keys are the values times scale, clamped to
+    /// 1, rather than auto exposed or normalized by their maximum
+    float scale{0.0f};
+
+    /// Hand clouds the values of unsigned fields to be normalized on the
+    /// GPU, when auto_exposure is the only processing
+    bool gpu_keys{false};
+
+    /// Color images with the calibrated reflectivity palette
+    bool calref_palette{false};
+
+    /// The fields have three channels, red, green and blue
+    bool rgb{false};
+};
+
+/**
+ * Get the view mode the Python viz uses for a field of a scan: calibrated
+ * reflectivity for REFLECTIVITY on firmware 2.1 and later, beam uniformity
+ * correction for NEAR_IR, colors for three channel fields and auto exposure
+ * otherwise.
+ *
+ * @param[in] info The metadata of the sensor of the scan.
+ * @param[in] scan The scan with the field.
+ * @param[in] field The name of the field, of the first return.
+ * @param[out] mode The view mode.
+ *
+ * @return false if the field can't be viewed, e.g. if the scan doesn't have
+ *         it, it isn't a pixel field, or it is of a second return or flags.
+ */
+OUSTER_API_FUNCTION
+bool default_view_mode(const sensor::sensor_info& info, const LidarScan& scan,
+                       const std::string& field, FieldViewMode& mode);
+
+/**
+ * Counters of a LidarScanViz.
+ */
+struct OUSTER_API_CLASS LidarScanVizStats {
+    uint64_t submitted{0};  ///< frames submitted
+    uint64_t computed{0};   ///< frames computed, over all sensors
+    uint64_t skipped{0};    ///< frames replaced before they were computed
+    uint64_t applied{0};    ///< frames applied, over all sensors
+    /// Time computing a frame of a sensor took, in nanoseconds
+    sensor::LatencyStats compute;
+};
+
+/**
+ * The model of a lidar scan viewer: for each sensor two clouds, of the first
+ * and second returns, and two images, whose keys it computes from the scans
+ * according to the selected cloud and image modes.
+ *
+ * The keys of each sensor are computed on a thread of its own, "ouster-viz-"
+ * and the index of the sensor, as submit() hands it scans: converting the
+ * fields, correcting beam uniformity, auto exposing, destaggering and
+ * converting poses. The key of each mode and return is computed once per
+ * frame even when several clouds and images show it. apply() then copies
+ * the last frame computed into the clouds and images, on the thread that
+ * draws them to a PointViz, so that neither it nor the application waits on
+ * the computation:
+ *
+ *     LidarScanViz model(infos);
+ *     for (size_t i = 0; i < infos.size(); i++) {
+ *         viz.add(model.cloud(i, 0));
+ *         viz.add(model.image(i, 0));
+ *     }
+ *     // when scans arrive
+ *     model.submit(scans);
+ *     // before each viz.update()
+ *     model.apply();
+ *
+ * A frame submitted before the previous one of a sensor was computed
+ * replaces it, so the model keeps up with the latest scans.
+ *
+ * View modes are created for the fields of the scans as they arrive, see
+ * default_view_mode(); add_mode() adds others, e.g. from plugins. The
+ * palettes of the clouds, masks and layout are left to the application.
+ */
+class OUSTER_API_CLASS LidarScanViz {
+   public:
+    /// The number of clouds of each sensor, one per return
+    static constexpr size_t num_clouds = 2;
+
+    /// The number of images of each sensor
+    static constexpr size_t num_images = 2;
+
+    /**
+     * Create the clouds and images of the sensors and start their threads.
+     *
+     * @param[in] sensors The metadata of the sensors.
+     */
+    OUSTER_API_FUNCTION
+    explicit LidarScanViz(const std::vector<sensor::sensor_info>& sensors);
+
+    /**
+     * Stop the threads of the sensors.
+     */
+    OUSTER_API_FUNCTION
+    ~LidarScanViz();
+
+    LidarScanViz(const LidarScanViz&) = delete;
+    LidarScanViz& operator=(const LidarScanViz&) = delete;
+
+    /**
+     * @return The number of sensors.
+     */
+    OUSTER_API_FUNCTION
+    size_t sensor_count() const;
+
+    /**
+     * @throws std::out_of_range if an index is out of range.
+     *
+     * @param[in] sensor The index of the sensor.
+     * @param[in] return_num The return shown by the cloud, 0 or 1.
+     *
+     * @return The cloud, to add to a PointViz.
+     */
+    OUSTER_API_FUNCTION
+    std::shared_ptr<Cloud> cloud(size_t sensor, size_t return_num) const;
+
+    /**
+     * @throws std::out_of_range if an index is out of range.
+     *
+     * @param[in] sensor The index of the sensor.
+     * @param[in] index The index of the image, 0 or 1.
+     *
+     * @return The image, to add to a PointViz.
+     */
+    OUSTER_API_FUNCTION
+    std::shared_ptr<Image> image(size_t sensor, size_t index) const;
+
+    /**
+     * Add a view mode for every sensor, replacing any of the same name.
+     *
+     * @throws std::invalid_argument if the mode has no name or field.
+     *
+     * @param[in] mode The view mode.
+     */
+    OUSTER_API_FUNCTION
+    void add_mode(const FieldViewMode& mode);
+
+    /**
+     * @return The names of the cloud modes of any sensor, sorted.
+     */
+    OUSTER_API_FUNCTION
+    std::vector<std::string> cloud_modes() const;
+
+    /**
+     * @return The names of the image modes of any sensor, sorted.
+     */
+    OUSTER_API_FUNCTION
+    std::vector<std::string> image_modes() const;
+
+    /**
+     * Select the mode coloring the clouds, from the next frame on. Sensors
+     * without such a mode keep the keys of their clouds.
+     *
+     * @param[in] name The name of the cloud mode.
+     */
+    OUSTER_API_FUNCTION
+    void set_cloud_mode(const std::string& name);
+
+    /**
+     * @return The name of the mode coloring the clouds.
+     */
+    OUSTER_API_FUNCTION
+    std::string cloud_mode() const;
+
+    /**
+     * Select the mode of an image, from the next frame on. Images of sensors
+     * without such a mode are blank.
+     *
+     * @throws std::out_of_range if the index is out of range.
+     *
+     * @param[in] index The index of the image.
+     * @param[in] name The name of the image mode.
+     */
+    OUSTER_API_FUNCTION
+    void set_image_mode(size_t index, const std::string& name);
+
+    /**
+     * @throws std::out_of_range if the index is out of range.
+     *
+     * @param[in] index The index of the image.
+     *
+     * @return The name of the mode of the image.
+     */
+    OUSTER_API_FUNCTION
+    std::string image_mode(size_t index) const;
+
+    /**
+     * Hand the threads of the sensors a frame to compute. Returns at once.
+     *
+     * @throws std::invalid_argument if there isn't a scan per sensor.
+     *
+     * @param[in] scans The scan of each sensor, or null to hide the clouds
+     *            and blank the images of the sensor.
+     */
+    OUSTER_API_FUNCTION
+    void submit(const std::vector<std::shared_ptr<const LidarScan>>& scans);
+
+    /**
+     * Copy the frames computed since the last call into the clouds and
+     * images. Call from the thread updating the PointViz, before
+     * PointViz::update().
+     *
+     * @return true if a frame of any sensor was applied.
+     */
+    OUSTER_API_FUNCTION
+    bool apply();
+
+    /**
+     * Wait until the frames submitted are computed.
+     *
+     * @param[in] timeout_sec The longest wait, negative to wait as long as
+     *            it takes.
+     *
+     * @return false on timeout.
+     */
+    OUSTER_API_FUNCTION
+    bool wait(double timeout_sec = -1);
+
+    /**
+     * Submit a frame, wait until it is computed and apply it, e.g. to step
+     * through a recording.
+     *
+     * @throws std::invalid_argument if there isn't a scan per sensor.
+     *
+     * @param[in] scans The scan of each sensor, or null.
+     */
+    OUSTER_API_FUNCTION
+    void update(const std::vector<std::shared_ptr<const LidarScan>>& scans);
+
+    /**
+     * @return The counters of the model.
+     */
+    OUSTER_API_FUNCTION
+    LidarScanVizStats stats() const;
+
+   private:
+    struct Sensor;
+
+    void run(Sensor& sensor);
+
+    void compute(Sensor& sensor, const std::shared_ptr<const LidarScan>& scan);
+
+    std::vector<std::unique_ptr<Sensor>> sensors_;
+
+    // guards the modes of the sensors and the modes selected
+    mutable std::mutex modes_mtx_;
+    std::string cloud_mode_;
+    std::vector<std::string> image_modes_;
+
+    std::atomic<bool> running_{true};
+    std::atomic<uint64_t> submitted_{0};
+    std::atomic<uint64_t> computed_{0};
+    std::atomic<uint64_t> skipped_{0};
+    std::atomic<uint64_t> applied_{0};
+};
+
+}  // namespace viz
+}  // namespace ouster
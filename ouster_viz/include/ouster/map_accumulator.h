@@ -0,0 +1,158 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ *
+ * @file
+ * @brief Accumulates lidar scans into a voxelized map for visualization
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/point_viz.h"
+#include "ouster/types.h"
+#include "ouster/visibility.h"
+
+namespace ouster {
+namespace viz {
+
+/**
+ * Options of a MapAccumulator.
+ */
+struct OUSTER_API_CLASS MapAccumulatorConfig {
+    /// The fraction of the valid pixels of a scan considered for the map
+    double select_ratio{0.001};
+
+    /// The edge of the voxels of the map, which keeps at most one point per
+    /// voxel; 0 to keep every selected point
+    float voxel_size{0.0f};
+
+    /// The most points in the map, 0 for no limit
+    size_t max_points{1500000};
+
+    /// When the map is full, drop the points of the oldest scans rather than
+    /// ignore new ones
+    bool overflow_from_start{false};
+
+    /// The edge of the chunks of the LodCloud drawing the map
+    float chunk_size{20.0f};
+
+    /// The most points of the map drawn per frame, 0 for no limit
+    size_t point_budget{2000000};
+};
+
+/**
+ * Accumulates points of lidar scans of several sensors into a map drawn by a
+ * LodCloud.
+ *
+ * Each scan is projected and dewarped by its column poses in a single pass,
+ * only for a random selection of its valid pixels. The selected points are
+ * filtered to at most one per voxel and added to the map, uploading only
+ * them to the GPU. The points keep a key per coloring mode given with the
+ * scan, so that switching mode doesn't need the scans again.
+ *
+ * When overflow_from_start is set, the points of the oldest scans are
+ * dropped once the map is full, by a quarter of the map at a time so that
+ * the cloud is rebuilt rarely.
+ */
+class OUSTER_API_CLASS MapAccumulator {
+   public:
+    /**
+     * @throws std::invalid_argument if the options aren't valid.
+     *
+     * @param[in] sensors The metadata of the sensors of the scans.
+     * @param[in] config The options of the accumulator.
+     */
+    OUSTER_API_FUNCTION
+    MapAccumulator(const std::vector<sensor::sensor_info>& sensors,
+                   const MapAccumulatorConfig& config = {});
+
+    /**
+     * Add the points of a scan to the map.
+     *
+     * @throws std::invalid_argument if the sensor index is out of range, or
+     *         the scan or a key image don't have the size of the sensor.
+     *
+     * @param[in] sensor_idx The index of the sensor of the scan.
+     * @param[in] scan A scan with a RANGE field and poses.
+     * @param[in] keys Key images of the scan, normalized between 0 and 1, by
+     *            name of coloring mode.
+     */
+    OUSTER_API_FUNCTION
+    void update(size_t sensor_idx, const LidarScan& scan,
+                const std::map<std::string, img_t<float>>& keys = {});
+
+    /**
+     * Color the map by the keys of a mode, or by zero keys if no scan had
+     * them.
+     *
+     * @param[in] name The name of the coloring mode.
+     */
+    OUSTER_API_FUNCTION
+    void set_key_name(const std::string& name);
+
+    /**
+     * @return The name of the coloring mode of the map.
+     */
+    OUSTER_API_FUNCTION
+    const std::string& key_name() const;
+
+    /**
+     * Remove all the points of the map.
+     */
+    OUSTER_API_FUNCTION
+    void clear();
+
+    /**
+     * @return The number of points in the map.
+     */
+    OUSTER_API_FUNCTION
+    size_t size() const;
+
+    /**
+     * @return The cloud drawing the map, to add to a PointViz.
+     */
+    OUSTER_API_FUNCTION
+    std::shared_ptr<LodCloud> cloud() const;
+
+   private:
+    /**
+     * The points a scan added to the map.
+     */
+    struct Entry {
+        std::vector<float> xyz;
+        std::map<std::string, std::vector<float>> keys;
+        std::vector<uint64_t> voxels;
+    };
+
+    void add_to_cloud(const Entry& entry);
+
+    void rebuild_cloud();
+
+    std::vector<std::shared_ptr<const XYZLut>> luts_;
+    std::vector<std::pair<size_t, size_t>> sizes_;  // (w, h) of each sensor
+    MapAccumulatorConfig config_;
+    std::shared_ptr<LodCloud> cloud_;
+    std::string key_name_;
+
+    std::deque<Entry> entries_;
+    size_t n_{0};
+    std::unordered_set<uint64_t> voxels_;
+    std::minstd_rand rng_;
+
+    // scratch space of update()
+    img_t<uint32_t> selected_;
+    pose_util::Points points_;
+};
+
+}  // namespace viz
+}  // namespace ouster
@@ -9,6 +9,7 @@
 
 #include <array>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -39,6 +40,8 @@ using vec2d = std::array<double, 2>;
 // TODO: messes up lidar_scan_viz
 namespace impl {
 class GLCloud;
+class GLLodCloud;
+struct LodBatch;
 class GLImage;
 class GLCuboid;
 class GLLabel;
@@ -89,9 +92,21 @@ enum class EventModifierKeys : int {
     MOD_NUM_LOCK = 0x0020,
 };
 
+/**
+ * @brief How raw cloud keys are normalized on the GPU
+ */
+enum class KeyNormalization : int {
+    /// scale the keys between their 10th and 90th percentiles, smoothed over
+    /// updates, like AutoExposure
+    AUTO_EXPOSURE = 0,
+    /// replace the keys by their rank, equalizing their histogram
+    EQUALIZATION = 1,
+};
+
 struct WindowCtx;
 class Camera;
 class Cloud;
+class LodCloud;
 class Image;
 class Cuboid;
 class Label;
@@ -107,6 +122,31 @@ constexpr int default_window_width = 800;
  */
 constexpr int default_window_height = 600;
 
+/**
+ * @brief Where the time of a frame drawn by a PointViz went
+ *
+ * CPU times are those of the render thread issuing the GL commands, GPU
+ * times those of the GPU executing them, measured with timer queries.
+ */
+struct OUSTER_API_CLASS FrameStats {
+    /**
+     * The time of a part of the frame.
+     */
+    struct Section {
+        std::string name;  ///< the part of the frame
+        double cpu_ms;     ///< time of the render thread, in milliseconds
+        double gpu_ms;     ///< time of the GPU, in milliseconds
+    };
+
+    uint64_t frame{0};  ///< the number of the frame, counting from 0
+    double cpu_ms{0};   ///< time of the render thread, including the swap
+    double gpu_ms{0};   ///< time of the GPU over all the sections
+
+    /// the parts of the frame, in drawing order: uploads happen with the
+    /// drawing of their object
+    std::vector<Section> sections;
+};
+
 /**
  * @brief A basic visualizer for sensor data
  *
@@ -151,11 +191,24 @@ class OUSTER_API_CLASS PointViz {
      *            else uses the default_window_width
      * @param[in] window_height Window height to set,
      *            else uses the default_window_height
+     * @param[in] headless Render offscreen without a window, through EGL, at
+     *            the window size. Input callbacks are never called then.
+     * @param[in] share Another visualizer whose rendering context shares its
+     *            shaders and glyph atlas with the new one rather than
+     *            compiling and uploading them again, e.g. for a window per
+     *            sensor. It must be headless if the new one is, and must
+     *            outlive it.
+     *
+     * @throws std::runtime_error if the rendering context can't be created,
+     *         or headless rendering isn't supported by this build.
+     * @throws std::invalid_argument if only one of the visualizers is
+     *         headless.
      */
     OUSTER_API_FUNCTION
     explicit PointViz(const std::string& name, bool fix_aspect = false,
                       int window_width = default_window_width,
-                      int window_height = default_window_height);
+                      int window_height = default_window_height,
+                      bool headless = false, PointViz* share = nullptr);
 
     // Because PointViz uses the PIMPL pattern
     // and the Impl owns the window context,
@@ -218,7 +271,8 @@ class OUSTER_API_CLASS PointViz {
     /**
      * Update visualization state
      *
-     * Send state updates to be rendered on the next frame.
+     * Send state updates to be rendered on the next frame. Doesn't wait for
+     * a frame being drawn, which keeps drawing the previous state.
      */
     OUSTER_API_FUNCTION
     void update();
@@ -299,6 +353,66 @@ class OUSTER_API_CLASS PointViz {
     void push_frame_buffer_handler(
         std::function<bool(const std::vector<uint8_t>&, int, int)>&& callback);
 
+    /**
+     * Set a sink receiving every drawn frame, e.g. a video encoder.
+     *
+     * Unlike frame buffer handlers, frames are read back asynchronously
+     * through a ring of pixel buffers and the sink is called on its own
+     * thread, a few frames after they are drawn, so that a slow sink doesn't
+     * slow down rendering. Frames are RGB, bottom row first. When the sink
+     * falls behind by more than buffer_frames, the oldest frames are dropped,
+     * see dropped_frames().
+     *
+     * Waits for the frames buffered for the previous sink to be consumed, so
+     * must not be called from the sink itself.
+     *
+     * @param[in] sink function of the form f(fb_data, fb_width, fb_height),
+     *            or an empty function to stop reading frames.
+     * @param[in] buffer_frames the most frames buffered for the sink.
+     */
+    OUSTER_API_FUNCTION
+    void set_frame_sink(
+        std::function<void(const std::vector<uint8_t>&, int, int)> sink,
+        size_t buffer_frames = 16);
+
+    /**
+     * @return The number of frames dropped because the frame sink fell
+     *         behind.
+     */
+    OUSTER_API_FUNCTION
+    uint64_t dropped_frames() const;
+
+    /**
+     * Measure where the time of each frame goes, see frame_stats().
+     *
+     * @param[in] state true to start measuring, false to stop.
+     */
+    OUSTER_API_FUNCTION
+    void enable_frame_stats(bool state);
+
+    /**
+     * Show the frame stats over the scene, which measures them too.
+     *
+     * The overlay is drawn after the frame buffer handlers and frame sink
+     * read the frame, so it isn't recorded.
+     *
+     * @param[in] state true to show the overlay, false to hide it.
+     */
+    OUSTER_API_FUNCTION
+    void show_frame_stats(bool state);
+
+    /**
+     * Get the stats of the last frame measured.
+     *
+     * GPU times are known a few frames after the frame is drawn, so the
+     * stats lag behind by as much. Frames whose GPU times weren't known in
+     * time aren't measured.
+     *
+     * @return The stats, with no sections if no frame was measured yet.
+     */
+    OUSTER_API_FUNCTION
+    FrameStats frame_stats() const;
+
     /**
      * Remove the last added callback for handling keyboard events
      */
@@ -354,6 +468,55 @@ class OUSTER_API_CLASS PointViz {
     OUSTER_API_FUNCTION
     Camera& camera();
 
+    /**
+     * Draw the scene again into a rectangle of the window, by a camera of
+     * its own, e.g. one per sensor next to a fused view.
+     *
+     * Once viewports are added, the scene is drawn only into them: clouds,
+     * cuboids, rings and 3D labels once per viewport, from the same GPU
+     * buffers so that nothing is uploaded twice, then images and 2D labels
+     * once over the whole window. The camera of a viewport starts as a copy
+     * of camera(). Like other changes, viewports take effect on update().
+     * Each kind of object is drawn into all the viewports in turn, so
+     * viewports shouldn't overlap.
+     *
+     * @throws std::invalid_argument if the rectangle is empty.
+     *
+     * @param[in] x0 left edge, as a fraction of the window width.
+     * @param[in] y0 bottom edge, as a fraction of the window height.
+     * @param[in] x1 right edge, as a fraction of the window width.
+     * @param[in] y1 top edge, as a fraction of the window height.
+     *
+     * @return The index of the viewport.
+     */
+    OUSTER_API_FUNCTION
+    size_t add_viewport(double x0, double y0, double x1, double y1);
+
+    /**
+     * @return The number of viewports added.
+     */
+    OUSTER_API_FUNCTION
+    size_t viewport_count() const;
+
+    /**
+     * Get a reference to the camera of a viewport, see camera().
+     *
+     * @throws std::out_of_range if there is no such viewport.
+     *
+     * @param[in] index The index of the viewport.
+     *
+     * @return Handler to the camera object
+     */
+    OUSTER_API_FUNCTION
+    Camera& viewport_camera(size_t index);
+
+    /**
+     * Remove all the viewports, to draw the scene by camera() into the whole
+     * window again.
+     */
+    OUSTER_API_FUNCTION
+    void clear_viewports();
+
     /**
      * Get a reference to the target display controls
      *
@@ -370,6 +533,14 @@ class OUSTER_API_CLASS PointViz {
     OUSTER_API_FUNCTION
     void add(const std::shared_ptr<Cloud>& cloud);
 
+    /**
+     * Add an object to the scene
+     *
+     * @param[in] cloud Adds a level of detail point cloud to the scene
+     */
+    OUSTER_API_FUNCTION
+    void add(const std::shared_ptr<LodCloud>& cloud);
+
     /**
      * Add an object to the scene
      *
@@ -404,6 +575,16 @@ class OUSTER_API_CLASS PointViz {
     OUSTER_API_FUNCTION
     bool remove(const std::shared_ptr<Cloud>& cloud);
 
+    /**
+     * Remove an object from the scene
+     *
+     * @param[in] cloud Remove a level of detail point cloud from the scene
+     *
+     * @return true if successfully removed else false
+     */
+    OUSTER_API_FUNCTION
+    bool remove(const std::shared_ptr<LodCloud>& cloud);
+
     /**
      * Remove an object from the scene
      *
@@ -836,6 +1017,12 @@ class OUSTER_API_CLASS Cloud {
     bool pose_changed_{true};
     bool point_size_changed_{true};
 
+    // columns [begin, end) of the range and key changed since the last draw
+    size_t range_cols_begin_{0};
+    size_t range_cols_end_{0};
+    size_t key_cols_begin_{0};
+    size_t key_cols_end_{0};
+
     std::shared_ptr<std::vector<float>> range_data_{};
     std::shared_ptr<std::vector<float>> key_data_{};
     std::shared_ptr<std::vector<float>> mask_data_{};
@@ -847,8 +1034,16 @@ class OUSTER_API_CLASS Cloud {
     float point_size_{2};
     bool mono_{true};
 
+    // unnormalized keys, in place of key_data_ when set
+    std::shared_ptr<std::vector<uint8_t>> raw_key_data_{};
+    size_t raw_key_bytes_{0};  // bytes of each raw key
+    KeyNormalization key_normalization_{KeyNormalization::AUTO_EXPOSURE};
+
     Cloud(size_t w, size_t h, const mat4d& extrinsic);
 
+    template <typename T>
+    void set_key_raw_impl(const T* key, KeyNormalization normalization);
+
    public:
     /**
      * Unstructured point cloud for visualization.
@@ -928,6 +1123,20 @@ class OUSTER_API_CLASS Cloud {
     OUSTER_API_FUNCTION
     void set_range(const uint32_t* range);
 
+    /**
+     * Set the range values of some columns only, so that only those are
+     * uploaded to the GPU on the next draw.
+     *
+     * @throws std::invalid_argument if the columns are out of the cloud.
+     *
+     * @param[in] range pointer to array of at least as many elements as there
+     * are points, of which only the given columns are read
+     * @param[in] first_col the first column to set
+     * @param[in] num_cols the number of columns to set
+     */
+    OUSTER_API_FUNCTION
+    void set_range(const uint32_t* range, size_t first_col, size_t num_cols);
+
     /**
      * Set the key values, used for coloring.
      *
@@ -937,6 +1146,53 @@ class OUSTER_API_CLASS Cloud {
     OUSTER_API_FUNCTION
     void set_key(const float* key);
 
+    /**
+     * Set the key values of some columns only, so that only those are
+     * uploaded to the GPU on the next draw.
+     *
+     * @throws std::invalid_argument if the columns are out of the cloud.
+     *
+     * @param[in] key pointer to array of at least as many elements as there are
+     *                points, of which only the given columns are read
+     * @param[in] first_col the first column to set
+     * @param[in] num_cols the number of columns to set
+     */
+    OUSTER_API_FUNCTION
+    void set_key(const float* key, size_t first_col, size_t num_cols);
+
+    /**
+     * Set unnormalized key values, e.g. the REFLECTIVITY, SIGNAL or NIR
+     * fields of a scan, which are uploaded as is and normalized on the GPU.
+     *
+     * The GPU builds a histogram of the nonzero keys every time they are
+     * set, from which it either scales them like AutoExposure does or
+     * equalizes them. Zero keys get the first color of the palette.
+     *
+     * @param[in] key pointer to array of at least as many elements as there are
+     *                points
+     * @param[in] normalization how the keys are normalized
+     */
+    OUSTER_API_FUNCTION
+    void set_key_raw(
+        const uint8_t* key,
+        KeyNormalization normalization = KeyNormalization::AUTO_EXPOSURE);
+
+    /**
+     * @copydoc set_key_raw(const uint8_t*, KeyNormalization)
+     */
+    OUSTER_API_FUNCTION
+    void set_key_raw(
+        const uint16_t* key,
+        KeyNormalization normalization = KeyNormalization::AUTO_EXPOSURE);
+
+    /**
+     * @copydoc set_key_raw(const uint8_t*, KeyNormalization)
+     */
+    OUSTER_API_FUNCTION
+    void set_key_raw(
+        const uint32_t* key,
+        KeyNormalization normalization = KeyNormalization::AUTO_EXPOSURE);
+
     /**
      * Set the key alpha values, leaving the color the same.
      *
@@ -1047,6 +1303,142 @@ class OUSTER_API_CLASS Cloud {
     friend class impl::GLCloud;
 };
 
+/**
+ * @brief Manages the state of a large static point cloud, drawn with a level
+ * of detail.
+ *
+ * Points are accumulated into chunks of a voxel grid, each drawn from its own
+ * GPU buffer. Every frame the chunks out of the view are culled, and the
+ * others are decimated so that at most a budget of points is drawn: near
+ * chunks keep all of their points and far ones fewer, decreasing with the
+ * square of their distance like their size on the screen does. Points are
+ * shuffled within a chunk as they are added, so that any number of them is
+ * a uniform sample of the chunk.
+ *
+ * Adding points only uploads the new points, making it suited for maps
+ * accumulated over time of hundreds of millions of points.
+ */
+class OUSTER_API_CLASS LodCloud {
+   protected:
+    float chunk_size_{10.0f};
+    size_t point_budget_{0};
+    size_t n_{0};
+    uint64_t id_{0};
+
+    bool points_changed_{true};
+    bool palette_changed_{true};
+    bool pose_changed_{true};
+    bool point_size_changed_{true};
+
+    // the points, in batches of the calls to add_points()
+    std::vector<std::shared_ptr<const impl::LodBatch>> batches_{};
+    std::shared_ptr<std::vector<float>> palette_data_{};
+    mat4d pose_{};
+    float point_size_{2};
+
+   public:
+    /**
+     * Empty level of detail point cloud.
+     *
+     * Call add_points() to add points.
+     *
+     * @throws std::invalid_argument if the chunk size isn't positive.
+     *
+     * @param[in] chunk_size the edge of the cubic chunks of the voxel grid,
+     *            in the units of the points
+     * @param[in] point_budget the most points drawn per frame, 0 for no limit
+     */
+    OUSTER_API_FUNCTION
+    explicit LodCloud(float chunk_size = 10.0f,
+                      size_t point_budget = 5000000);
+
+    /**
+     * Updates this cloud's state with the state of other,
+     * accounting for prior changes to this objects's state.
+     *
+     * @param[in] other the object to update the state from.
+     */
+    OUSTER_API_FUNCTION
+    void update_from(const LodCloud& other);
+
+    /**
+     * Clear dirty flags.
+     *
+     * Resets any changes since the last call to PointViz::update()
+     */
+    OUSTER_API_FUNCTION
+    void clear();
+
+    /**
+     * Set all dirty flags.
+     *
+     * Re-sets everything so the object is always redrawn.
+     */
+    OUSTER_API_FUNCTION
+    void dirty();
+
+    /**
+     * Get the number of points of the cloud.
+     *
+     * @return number of points added since the cloud was created or cleared
+     */
+    OUSTER_API_FUNCTION
+    size_t get_size() const { return n_; }
+
+    /**
+     * Add points to the cloud.
+     *
+     * @param[in] xyz pointer to array of exactly 3n, so that the xyz position
+     * of the ith point is xyz[3i], xyz[3i + 1], xyz[3i + 2]
+     * @param[in] key pointer to array of n key values, used for coloring and
+     * preferably normalized between 0 and 1, or nullptr for 0
+     * @param[in] n the number of points
+     */
+    OUSTER_API_FUNCTION
+    void add_points(const float* xyz, const float* key, size_t n);
+
+    /**
+     * Remove all the points of the cloud.
+     */
+    OUSTER_API_FUNCTION
+    void clear_points();
+
+    /**
+     * Set the most points drawn per frame.
+     *
+     * @param[in] point_budget the number of points, 0 for no limit
+     */
+    OUSTER_API_FUNCTION
+    void set_point_budget(size_t point_budget);
+
+    /**
+     * Set the pose of the cloud.
+     *
+     * @param[in] pose 4x4 column-major homogeneous transformation matrix
+     */
+    OUSTER_API_FUNCTION
+    void set_pose(const mat4d& pose);
+
+    /**
+     * Set point size.
+     *
+     * @param[in] size point size
+     */
+    OUSTER_API_FUNCTION
+    void set_point_size(float size);
+
+    /**
+     * Set the point cloud color palette.
+     *
+     * @param[in] palette the new palette to use, must have size 3*palette_size
+     * @param[in] palette_size the number of colors in the new palette
+     */
+    OUSTER_API_FUNCTION
+    void set_palette(const float* palette, size_t palette_size);
+
+    friend class impl::GLLodCloud;
+};
+
 /**
  * @brief Manages the state of an image.
  */
@@ -1059,15 +1451,22 @@ class OUSTER_API_CLASS Image {
     vec4f position_{};
     size_t image_width_{0};
     size_t image_height_{0};
-    std::vector<float> image_data_{};
+    // pixels as given, uploaded without conversion
+    std::shared_ptr<std::vector<uint8_t>> image_data_{};
+    size_t image_channels_{1};
+    size_t image_bytes_{4};  // per channel: 1 for uint8, 2 uint16, 4 float
     size_t mask_width_{0};
     size_t mask_height_{0};
-    std::vector<float> mask_data_{};
+    std::shared_ptr<std::vector<float>> mask_data_{};
     std::vector<float> palette_data_{};
     float hshift_{0};  // in normalized screen coordinates [-1. 1]
     bool mono_{true};
     bool use_palette_{false};
 
+    template <typename T>
+    void set_image_impl(size_t width, size_t height, const T* image_data,
+                        size_t channels);
+
    public:
     /**
      * @todo document me
@@ -1103,6 +1502,32 @@ class OUSTER_API_CLASS Image {
     OUSTER_API_FUNCTION
     void set_image(size_t width, size_t height, const float* image_data);
 
+    /**
+     * Set the image data, normalized from the range of uint8_t.
+     *
+     * The image is uploaded as is, to an 8 bit texture.
+     *
+     * @param[in] width width of the image data in pixels
+     * @param[in] height height of the image data in pixels
+     * @param[in] image_data pointer to an array of width * height elements
+     *        interpreted as a row-major monochrome image
+     */
+    OUSTER_API_FUNCTION
+    void set_image(size_t width, size_t height, const uint8_t* image_data);
+
+    /**
+     * Set the image data, normalized from the range of uint16_t.
+     *
+     * The image is uploaded as is, to a 16 bit texture.
+     *
+     * @param[in] width width of the image data in pixels
+     * @param[in] height height of the image data in pixels
+     * @param[in] image_data pointer to an array of width * height elements
+     *        interpreted as a row-major monochrome image
+     */
+    OUSTER_API_FUNCTION
+    void set_image(size_t width, size_t height, const uint16_t* image_data);
+
     /**
      * Set the image data (RGB).
      *
@@ -1115,6 +1540,18 @@ class OUSTER_API_CLASS Image {
     void set_image_rgb(size_t width, size_t height,
                        const float* image_data_rgb);
 
+    /**
+     * Set the image data (RGB), normalized from the range of uint8_t.
+     *
+     * @param[in] width width of the image data in pixels
+     * @param[in] height height of the image data in pixels
+     * @param[in] image_data_rgb pointer to an array of width * height elements
+     *        interpreted as a row-major RGB image
+     */
+    OUSTER_API_FUNCTION
+    void set_image_rgb(size_t width, size_t height,
+                       const uint8_t* image_data_rgb);
+
     /**
      * Set the image data (RGBA).
      *
@@ -1127,6 +1564,18 @@ class OUSTER_API_CLASS Image {
     void set_image_rgba(size_t width, size_t height,
                         const float* image_data_rgba);
 
+    /**
+     * Set the image data (RGBA), normalized from the range of uint8_t.
+     *
+     * @param[in] width width of the image data in pixels
+     * @param[in] height height of the image data in pixels
+     * @param[in] image_data_rgba pointer to an array of width * height elements
+     *        interpreted as a row-major RGBA image
+     */
+    OUSTER_API_FUNCTION
+    void set_image_rgba(size_t width, size_t height,
+                        const uint8_t* image_data_rgba);
+
     /**
      * Set the RGBA mask.
      *
@@ -7,15 +7,21 @@
 
 #include <Eigen/Core>
 #include <algorithm>
+#include <cmath>
 #include <cstddef>
+#include <limits>
+#include <memory>
 #include <stdexcept>
+#include <tuple>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "camera.h"
 #include "common.h"
 #include "glfw.h"
 #include "ouster/point_viz.h"
+#include "ouster/trace.h"
 
 namespace ouster {
 namespace viz {
@@ -23,7 +29,8 @@ namespace impl {
 
 struct CloudIds {
     GLuint xyz_id, off_id, range_id, key_id, mask_id, model_id, proj_view_id,
-        mono_id, palette_id, transformation_id, trans_index_id;
+        mono_id, palette_id, transformation_id, trans_index_id, raw_key_id,
+        key_mode_id, normalization_id;
     CloudIds() {}
 
     /**
@@ -44,13 +51,43 @@ struct CloudIds {
           palette_id(glGetUniformLocation(point_program_id, "palette")),
           transformation_id(
               glGetUniformLocation(point_program_id, "transformation")),
-          trans_index_id(glGetAttribLocation(point_program_id, "trans_index")) {
-    }
+          trans_index_id(glGetAttribLocation(point_program_id, "trans_index")),
+          raw_key_id(glGetAttribLocation(point_program_id, "raw_key")),
+          key_mode_id(glGetUniformLocation(point_program_id, "key_mode")),
+          normalization_id(
+              glGetUniformLocation(point_program_id, "normalization")) {}
 };
 
 bool GLCloud::initialized = false;
 GLuint GLCloud::program_id;
 CloudIds GLCloud::cloud_ids;
+GLuint GLCloud::histogram_program_id;
+GLuint GLCloud::cdf_program_id;
+GLuint GLCloud::exposure_program_id;
+
+// bins of the histogram of raw keys, see key_histogram_vertex_shader_code
+static constexpr GLsizei key_histogram_bins = 1024;
+
+std::vector<std::unique_ptr<GLCloud::Palette>> GLCloud::palettes;
+GLCloud::DrawState GLCloud::draw_state;
+
+// texture unit for uploads, not read when drawing the clouds
+static constexpr GLenum upload_texture_unit = GL_TEXTURE3;
+
+/*
+ * Point a float vertex attribute of the bound vertex array at a buffer
+ */
+static void attrib_pointer(GLuint id, GLuint buffer, GLint size) {
+    glEnableVertexAttribArray(id);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glVertexAttribPointer(id,
+                          size,      // size
+                          GL_FLOAT,  // type
+                          GL_FALSE,  // normalized?
+                          0,         // stride
+                          (void*)0   // array buffer offset
+    );
+}
 
 GLCloud::GLCloud(const Cloud& cloud) : point_size{cloud.point_size_} {
     if (!GLCloud::initialized)
@@ -63,19 +100,69 @@ GLCloud::GLCloud(const Cloud& cloud) : point_size{cloud.point_size_} {
     glGenBuffers(1, &key_buffer);
     glGenBuffers(1, &mask_buffer);
     glGenBuffers(1, &trans_index_buffer);
+    glGenBuffers(1, &raw_key_buffer);
     glGenTextures(1, &transform_texture);
-    glGenTextures(1, &palette_texture);
+
+    // the attributes read the same buffers for the life of the object, only
+    // their storage changes: set them up once
+    GLint bound_vao;
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &bound_vao);
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    attrib_pointer(GLCloud::cloud_ids.mask_id, mask_buffer, 4);
+    attrib_pointer(GLCloud::cloud_ids.xyz_id, xyz_buffer, 3);
+    attrib_pointer(GLCloud::cloud_ids.off_id, off_buffer, 3);
+    attrib_pointer(GLCloud::cloud_ids.trans_index_id, trans_index_buffer, 1);
+    attrib_pointer(GLCloud::cloud_ids.range_id, range_buffer, 1);
+    attrib_pointer(GLCloud::cloud_ids.key_id, key_buffer, 4);
+    glBindVertexArray(bound_vao);
 }
 
 GLCloud::~GLCloud() {
+    glDeleteVertexArrays(1, &vao);
     glDeleteBuffers(1, &xyz_buffer);
     glDeleteBuffers(1, &off_buffer);
     glDeleteBuffers(1, &range_buffer);
     glDeleteBuffers(1, &key_buffer);
     glDeleteBuffers(1, &mask_buffer);
     glDeleteBuffers(1, &trans_index_buffer);
+    glDeleteBuffers(1, &raw_key_buffer);
     glDeleteTextures(1, &transform_texture);
-    glDeleteTextures(1, &palette_texture);
+    if (palette) release_palette(palette);
+    if (key_framebuffer) {
+        glDeleteFramebuffers(1, &key_framebuffer);
+        glDeleteVertexArrays(1, &key_vao);
+        glDeleteTextures(1, &histogram_texture);
+        glDeleteTextures(1, &cdf_texture);
+        glDeleteTextures(1, &exposure_texture);
+    }
+}
+
+/*
+ * Find the texture of a palette, or load it, and count the new reference
+ */
+GLCloud::Palette* GLCloud::acquire_palette(const std::vector<float>& data) {
+    for (auto& p : palettes) {
+        if (p->data == data) {
+            p->refs++;
+            return p.get();
+        }
+    }
+    palettes.push_back(std::make_unique<Palette>(Palette{data, 0, 1}));
+    Palette* palette = palettes.back().get();
+    glGenTextures(1, &palette->texture);
+    load_texture(data.data(), data.size() / 3, 1, palette->texture);
+    return palette;
+}
+
+void GLCloud::release_palette(Palette* palette) {
+    if (--palette->refs > 0) return;
+    if (draw_state.palette_texture == palette->texture)
+        draw_state.palette_texture = 0;
+    glDeleteTextures(1, &palette->texture);
+    palettes.erase(std::find_if(
+        palettes.begin(), palettes.end(),
+        [&](const std::unique_ptr<Palette>& p) { return p.get() == palette; }));
 }
 
 /**
@@ -89,10 +176,139 @@ static inline size_t ti_key(size_t n, size_t w) {
     return w + (n << sizeof(size_t) * 8 / 2);
 }
 
+/**
+ * @brief Uploads the changed columns of a vertex attribute buffer.
+ *
+ * The buffer storage is only reallocated when its size changes, otherwise
+ * the columns [first_col, last_col) of each row are updated in place, which
+ * spares the driver from reallocating the storage of every cloud each frame.
+ *
+ * @param[in] buffer the buffer object
+ * @param[in,out] allocated the bytes allocated to the buffer
+ * @param[in] data the attribute values of all points, row by row
+ * @param[in] w the columns of a row
+ * @param[in] components the values of a point
+ * @param[in] first_col the first changed column
+ * @param[in] last_col one past the last changed column
+ * @param[in] usage the usage hint given when (re)allocating the buffer
+ */
+static void upload_columns(GLuint buffer, size_t& allocated,
+                           const std::vector<float>& data, size_t w,
+                           size_t components, size_t first_col,
+                           size_t last_col, GLenum usage) {
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    const size_t bytes = sizeof(GLfloat) * data.size();
+    if (bytes != allocated) {
+        glBufferData(GL_ARRAY_BUFFER, bytes, data.data(), usage);
+        allocated = bytes;
+        return;
+    }
+    if (first_col >= last_col || data.empty()) return;
+    if (first_col == 0 && last_col >= w) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, data.data());
+        return;
+    }
+    const size_t row = w * components;
+    const size_t span = (last_col - first_col) * components;
+    for (size_t i = first_col * components; i < data.size(); i += row) {
+        glBufferSubData(GL_ARRAY_BUFFER, sizeof(GLfloat) * i,
+                        sizeof(GLfloat) * span, data.data() + i);
+    }
+}
+
 /*
- * Render the point cloud with the point of view of the Camera
+ * Count the raw keys into a histogram by drawing them as points with additive
+ * blending, then reduce it to a CDF or to an exposure blended with the
+ * previous one. The GL state changed here is restored for the cloud program.
  */
-void GLCloud::draw(const WindowCtx&, const CameraData& camera, Cloud& cloud) {
+void GLCloud::normalize_raw_keys(size_t n) {
+    if (!key_framebuffer) {
+        glGenFramebuffers(1, &key_framebuffer);
+        glGenVertexArrays(1, &key_vao);
+        glGenTextures(1, &histogram_texture);
+        glGenTextures(1, &cdf_texture);
+        glGenTextures(1, &exposure_texture);
+        const GLfloat* none = nullptr;
+        load_texture(none, key_histogram_bins, 1, histogram_texture, GL_R32F,
+                     GL_RED);
+        load_texture(none, key_histogram_bins, 1, cdf_texture, GL_R32F,
+                     GL_RED);
+        const GLfloat exposure[2] = {0, 0};
+        load_texture(exposure, 1, 1, exposure_texture, GL_RG32F, GL_RG);
+    }
+
+    GLint viewport[4];
+    GLint draw_framebuffer, read_framebuffer, bound_vao;
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &bound_vao);
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &draw_framebuffer);
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &read_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, key_framebuffer);
+    const GLfloat zeros[4] = {0, 0, 0, 0};
+
+    // histogram of the nonzero keys, one pixel per bin
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                           histogram_texture, 0);
+    glViewport(0, 0, key_histogram_bins, 1);
+    glClearBufferfv(GL_COLOR, 0, zeros);
+    glBlendFunc(GL_ONE, GL_ONE);
+    glPointSize(1);
+    draw_state.point_size = -1;
+    glUseProgram(GLCloud::histogram_program_id);
+    glBindVertexArray(key_vao);
+    const GLuint raw_key_id =
+        glGetAttribLocation(GLCloud::histogram_program_id, "raw_key");
+    glEnableVertexAttribArray(raw_key_id);
+    glBindBuffer(GL_ARRAY_BUFFER, raw_key_buffer);
+    glVertexAttribPointer(raw_key_id,
+                          1,             // size
+                          raw_key_type,  // type
+                          GL_FALSE,      // normalized?
+                          0,             // stride
+                          (void*)0       // array buffer offset
+    );
+    glDrawArrays(GL_POINTS, 0, n);
+
+    // reduce it with one fragment per texel of the result
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, histogram_texture);
+    if (key_mode == 2) {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                               GL_TEXTURE_2D, cdf_texture, 0);
+        glDisable(GL_BLEND);
+        glUseProgram(GLCloud::cdf_program_id);
+        glUniform1i(glGetUniformLocation(GLCloud::cdf_program_id, "histogram"),
+                    2);
+    } else {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                               GL_TEXTURE_2D, exposure_texture, 0);
+        glViewport(0, 0, 1, 1);
+        // exponential smoothing of the exposure, like AutoExposure
+        if (exposure_valid) {
+            glBlendColor(0, 0, 0, 0.1f);
+            glBlendFunc(GL_CONSTANT_ALPHA, GL_ONE_MINUS_CONSTANT_ALPHA);
+        } else {
+            glDisable(GL_BLEND);
+        }
+        exposure_valid = true;
+        glUseProgram(GLCloud::exposure_program_id);
+        glUniform1i(
+            glGetUniformLocation(GLCloud::exposure_program_id, "histogram"),
+            2);
+    }
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, draw_framebuffer);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, read_framebuffer);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    glBindVertexArray(bound_vao);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ZERO);
+    glUseProgram(GLCloud::program_id);
+}
+
+void GLCloud::update(Cloud& cloud) {
+    OUSTER_TRACE_SCOPE("viz", "GLCloud::update");
     // transformation indices buffers cache
     static std::unordered_map<size_t, std::vector<GLfloat>> trans_indexes;
 
@@ -109,18 +325,46 @@ void GLCloud::draw(const WindowCtx&, const CameraData& camera, Cloud& cloud) {
                               std::move(trans_index_buffer_data));
     }
 
-    // re-set trans_index_buffer always because GLClouds can be reused for
-    // different point cloud (n, w) structures.
-    glBindBuffer(GL_ARRAY_BUFFER, trans_index_buffer);
-    glBufferData(GL_ARRAY_BUFFER,
-                 sizeof(GLfloat) * trans_indexes[trans_index_key].size(),
-                 trans_indexes[trans_index_key].data(), GL_STATIC_DRAW);
+    // re-set trans_index_buffer when the (n, w) structure changes because
+    // GLClouds can be reused for different point cloud structures.
+    if (trans_index_key != this->trans_index_key) {
+        glBindBuffer(GL_ARRAY_BUFFER, trans_index_buffer);
+        glBufferData(GL_ARRAY_BUFFER,
+                     sizeof(GLfloat) * trans_indexes[trans_index_key].size(),
+                     trans_indexes[trans_index_key].data(), GL_STATIC_DRAW);
+        this->trans_index_key = trans_index_key;
+    }
+    n = static_cast<GLsizei>(cloud.n_);
+
+    // raw keys are normalized before anything else is drawn, as it changes
+    // the GL state
+    if (cloud.key_changed_ && cloud.raw_key_data_) {
+        const auto& raw_key_data = *cloud.raw_key_data_;
+        glBindBuffer(GL_ARRAY_BUFFER, raw_key_buffer);
+        if (raw_key_data.size() != raw_key_bytes) {
+            glBufferData(GL_ARRAY_BUFFER, raw_key_data.size(),
+                         raw_key_data.data(), GL_DYNAMIC_DRAW);
+            raw_key_bytes = raw_key_data.size();
+        } else {
+            glBufferSubData(GL_ARRAY_BUFFER, 0, raw_key_data.size(),
+                            raw_key_data.data());
+        }
+        raw_key_type = cloud.raw_key_bytes_ == 1   ? GL_UNSIGNED_BYTE
+                       : cloud.raw_key_bytes_ == 2 ? GL_UNSIGNED_SHORT
+                                                   : GL_UNSIGNED_INT;
+        key_mode = cloud.key_normalization_ == KeyNormalization::EQUALIZATION
+                       ? 2
+                       : 1;
+        mono = true;
+        normalize_raw_keys(cloud.n_);
+        cloud.key_changed_ = false;
+        cloud.key_cols_begin_ = cloud.key_cols_end_ = 0;
+    }
 
     if (cloud.point_size_changed_) {
         point_size = cloud.point_size_;
         cloud.point_size_changed_ = false;
     }
-    glPointSize(point_size);
 
     if (cloud.pose_changed_) {
         map_pose = Eigen::Map<const Eigen::Matrix4d>{cloud.pose_.data()};
@@ -129,162 +373,411 @@ void GLCloud::draw(const WindowCtx&, const CameraData& camera, Cloud& cloud) {
     extrinsic = Eigen::Map<const Eigen::Matrix4d>{cloud.extrinsic_.data()}
                     .cast<float>();
 
-    const Eigen::Matrix4f mvp =
-        (camera.proj * camera.view * camera.target * map_pose).cast<float>();
-
-    glUniformMatrix4fv(GLCloud::cloud_ids.model_id, 1, GL_FALSE,
-                       extrinsic.data());
-    glUniformMatrix4fv(GLCloud::cloud_ids.proj_view_id, 1, GL_FALSE,
-                       mvp.data());
-
-    glUniform1i(GLCloud::cloud_ids.palette_id, 0);
-    glActiveTexture(GL_TEXTURE0);
+    // textures are loaded on a unit render() doesn't read from
+    glActiveTexture(upload_texture_unit);
     if (cloud.palette_changed_) {
-        load_texture(cloud.palette_data_->data(),
-                     cloud.palette_data_->size() / 3, 1, palette_texture);
+        Palette* previous = palette;
+        palette = acquire_palette(*cloud.palette_data_);
+        if (previous) release_palette(previous);
         cloud.palette_changed_ = false;
     }
-    glBindTexture(GL_TEXTURE_2D, palette_texture);
 
-    glUniform1i(GLCloud::cloud_ids.transformation_id, 1);
-    glActiveTexture(GL_TEXTURE1);
     if (cloud.transform_changed_) {
         load_texture(cloud.transform_data_->data(), cloud.w_, 4,
                      transform_texture, GL_RGB32F);
         cloud.transform_changed_ = false;
     }
-    glBindTexture(GL_TEXTURE_2D, transform_texture);
 
     if (cloud.mask_changed_) {
-        glBindBuffer(GL_ARRAY_BUFFER, mask_buffer);
-        glBufferData(GL_ARRAY_BUFFER,
-                     sizeof(GLfloat) * cloud.mask_data_->size(),
-                     cloud.mask_data_->data(), GL_STATIC_DRAW);
+        upload_columns(mask_buffer, mask_bytes, *cloud.mask_data_, cloud.w_, 4,
+                       0, cloud.w_, GL_STATIC_DRAW);
         cloud.mask_changed_ = false;
     }
 
     if (cloud.xyz_changed_) {
-        glBindBuffer(GL_ARRAY_BUFFER, xyz_buffer);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * cloud.xyz_data_->size(),
-                     cloud.xyz_data_->data(), GL_STATIC_DRAW);
+        upload_columns(xyz_buffer, xyz_bytes, *cloud.xyz_data_, cloud.w_, 3, 0,
+                       cloud.w_, GL_STATIC_DRAW);
         cloud.xyz_changed_ = false;
     }
 
     if (cloud.offset_changed_) {
-        glBindBuffer(GL_ARRAY_BUFFER, off_buffer);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * cloud.off_data_->size(),
-                     cloud.off_data_->data(), GL_STATIC_DRAW);
+        upload_columns(off_buffer, off_bytes, *cloud.off_data_, cloud.w_, 3, 0,
+                       cloud.w_, GL_STATIC_DRAW);
         cloud.offset_changed_ = false;
     }
 
     if (cloud.range_changed_) {
-        glBindBuffer(GL_ARRAY_BUFFER, range_buffer);
-        glBufferData(GL_ARRAY_BUFFER,
-                     sizeof(GLfloat) * cloud.range_data_->size(),
-                     cloud.range_data_->data(), GL_DYNAMIC_DRAW);
+        upload_columns(range_buffer, range_bytes, *cloud.range_data_, cloud.w_,
+                       1, cloud.range_cols_begin_, cloud.range_cols_end_,
+                       GL_DYNAMIC_DRAW);
         cloud.range_changed_ = false;
+        cloud.range_cols_begin_ = cloud.range_cols_end_ = 0;
     }
 
     if (cloud.key_changed_) {
         mono = cloud.mono_;
-        glBindBuffer(GL_ARRAY_BUFFER, key_buffer);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * cloud.key_data_->size(),
-                     cloud.key_data_->data(), GL_DYNAMIC_DRAW);
+        key_mode = 0;
+        upload_columns(key_buffer, key_bytes, *cloud.key_data_, cloud.w_, 4,
+                       cloud.key_cols_begin_, cloud.key_cols_end_,
+                       GL_DYNAMIC_DRAW);
         cloud.key_changed_ = false;
+        cloud.key_cols_begin_ = cloud.key_cols_end_ = 0;
     }
+}
 
-    // put the shader into mono or rgb mode
-    glUniform1i(GLCloud::cloud_ids.mono_id, mono ? 1 : 0);
+void GLCloud::render(const CameraData& camera) {
+    OUSTER_TRACE_SCOPE("viz", "GLCloud::render");
+    glBindVertexArray(vao);
+
+    // the raw key attribute is only read when normalizing raw keys
+    const GLenum wanted_raw_key_type = key_mode != 0 ? raw_key_type : 0;
+    if (wanted_raw_key_type != vao_raw_key_type) {
+        if (wanted_raw_key_type) {
+            glEnableVertexAttribArray(GLCloud::cloud_ids.raw_key_id);
+            glBindBuffer(GL_ARRAY_BUFFER, raw_key_buffer);
+            glVertexAttribPointer(GLCloud::cloud_ids.raw_key_id,
+                                  1,             // size
+                                  raw_key_type,  // type
+                                  GL_FALSE,      // normalized?
+                                  0,             // stride
+                                  (void*)0       // array buffer offset
+            );
+        } else {
+            glDisableVertexAttribArray(GLCloud::cloud_ids.raw_key_id);
+        }
+        vao_raw_key_type = wanted_raw_key_type;
+    }
 
-    glEnableVertexAttribArray(GLCloud::cloud_ids.mask_id);
-    glBindBuffer(GL_ARRAY_BUFFER, mask_buffer);
-    glVertexAttribPointer(GLCloud::cloud_ids.mask_id,
-                          4,         // size
-                          GL_FLOAT,  // type
-                          GL_FALSE,  // normalized?
-                          0,         // stride
-                          (void*)0   // array buffer offset
-    );
+    if (draw_state.point_size != point_size) {
+        glPointSize(point_size);
+        draw_state.point_size = point_size;
+    }
 
-    glEnableVertexAttribArray(GLCloud::cloud_ids.xyz_id);
-    glBindBuffer(GL_ARRAY_BUFFER, xyz_buffer);
-    glVertexAttribPointer(GLCloud::cloud_ids.xyz_id,
-                          3,         // size
-                          GL_FLOAT,  // type
-                          GL_FALSE,  // normalized?
-                          0,         // stride
-                          (void*)0   // array buffer offset
-    );
+    const GLuint palette_texture = palette ? palette->texture : 0;
+    if (draw_state.palette_texture != palette_texture) {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, palette_texture);
+        draw_state.palette_texture = palette_texture;
+    }
 
-    glEnableVertexAttribArray(GLCloud::cloud_ids.off_id);
-    glBindBuffer(GL_ARRAY_BUFFER, off_buffer);
-    glVertexAttribPointer(GLCloud::cloud_ids.off_id,
-                          3,         // size
-                          GL_FLOAT,  // type
-                          GL_FALSE,  // normalized?
-                          0,         // stride
-                          (void*)0   // array buffer offset
-    );
+    // put the shader into mono or rgb mode
+    if (draw_state.mono != (mono ? 1 : 0)) {
+        glUniform1i(GLCloud::cloud_ids.mono_id, mono ? 1 : 0);
+        draw_state.mono = mono ? 1 : 0;
+    }
 
-    glEnableVertexAttribArray(GLCloud::cloud_ids.trans_index_id);
-    glBindBuffer(GL_ARRAY_BUFFER, trans_index_buffer);
-    glVertexAttribPointer(GLCloud::cloud_ids.trans_index_id,
-                          1,         // size
-                          GL_FLOAT,  // type
-                          GL_FALSE,  // normalized?
-                          0,         // stride
-                          (void*)0   // array buffer offset
-    );
+    if (draw_state.key_mode != key_mode) {
+        glUniform1i(GLCloud::cloud_ids.key_mode_id, key_mode);
+        draw_state.key_mode = key_mode;
+    }
+    if (key_mode != 0) {
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D,
+                      key_mode == 2 ? cdf_texture : exposure_texture);
+    }
 
-    glEnableVertexAttribArray(GLCloud::cloud_ids.range_id);
-    glBindBuffer(GL_ARRAY_BUFFER, range_buffer);
-    glVertexAttribPointer(GLCloud::cloud_ids.range_id,
-                          1,         // size
-                          GL_FLOAT,  // type
-                          GL_FALSE,  // normalized?
-                          0,         // stride
-                          (void*)0   // array buffer offset
-    );
+    const Eigen::Matrix4f mvp =
+        (camera.proj * camera.view * camera.target * map_pose).cast<float>();
+    glUniformMatrix4fv(GLCloud::cloud_ids.model_id, 1, GL_FALSE,
+                       extrinsic.data());
+    glUniformMatrix4fv(GLCloud::cloud_ids.proj_view_id, 1, GL_FALSE,
+                       mvp.data());
 
-    glEnableVertexAttribArray(GLCloud::cloud_ids.key_id);
-    glBindBuffer(GL_ARRAY_BUFFER, key_buffer);
-    glVertexAttribPointer(GLCloud::cloud_ids.key_id,
-                          4,         // size
-                          GL_FLOAT,  // type
-                          GL_FALSE,  // normalize
-                          0,         // stride
-                          (void*)0   // array buffer offset
-    );
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, transform_texture);
 
-    glDrawArrays(GL_POINTS, 0, cloud.n_);
-    glDisableVertexAttribArray(GLCloud::cloud_ids.mask_id);
-    glDisableVertexAttribArray(GLCloud::cloud_ids.xyz_id);
-    glDisableVertexAttribArray(GLCloud::cloud_ids.off_id);
-    glDisableVertexAttribArray(GLCloud::cloud_ids.trans_index_id);
-    glDisableVertexAttribArray(GLCloud::cloud_ids.range_id);
-    glDisableVertexAttribArray(GLCloud::cloud_ids.key_id);
+    glDrawArrays(GL_POINTS, 0, n);
+}
+
+/*
+ * Render the point cloud with the point of view of the Camera
+ */
+void GLCloud::draw(const WindowCtx&, const CameraData& camera, Cloud& cloud) {
+    update(cloud);
+    render(camera);
+}
+
+void GLCloud::draw_all(const CameraData& camera,
+                       const std::vector<std::pair<GLCloud*, Cloud*>>& all) {
+    for (const auto& c : all) c.first->update(*c.second);
+
+    // the order of the clouds only matters to the blending of the points of
+    // different clouds at the same depth, keep it within a group
+    std::vector<GLCloud*> order;
+    order.reserve(all.size());
+    for (const auto& c : all) order.push_back(c.first);
+    const auto key = [](const GLCloud* c) {
+        return std::make_tuple(c->palette ? c->palette->texture : 0,
+                               c->point_size, c->mono, c->key_mode);
+    };
+    std::stable_sort(order.begin(), order.end(),
+                     [&](const GLCloud* a, const GLCloud* b) {
+                         return key(a) < key(b);
+                     });
+    for (GLCloud* c : order) c->render(camera);
 }
 
 void GLCloud::initialize() {
     GLCloud::program_id =
         load_shaders(point_vertex_shader_code, point_fragment_shader_code);
     GLCloud::cloud_ids = CloudIds(GLCloud::program_id);
+    GLCloud::histogram_program_id =
+        load_shaders(key_histogram_vertex_shader_code,
+                     key_histogram_fragment_shader_code);
+    GLCloud::cdf_program_id = load_shaders(key_reduce_vertex_shader_code,
+                                           key_cdf_fragment_shader_code);
+    GLCloud::exposure_program_id = load_shaders(
+        key_reduce_vertex_shader_code, key_exposure_fragment_shader_code);
     GLCloud::initialized = true;
 }
 
 void GLCloud::uninitialize() {
     GLCloud::initialized = false;
     glDeleteProgram(GLCloud::program_id);
+    glDeleteProgram(GLCloud::histogram_program_id);
+    glDeleteProgram(GLCloud::cdf_program_id);
+    glDeleteProgram(GLCloud::exposure_program_id);
 }
 
 void GLCloud::beginDraw() {
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ZERO);
     glUseProgram(GLCloud::program_id);
+    glUniform1i(GLCloud::cloud_ids.palette_id, 0);
+    glUniform1i(GLCloud::cloud_ids.transformation_id, 1);
+    glUniform1i(GLCloud::cloud_ids.normalization_id, 2);
+    draw_state = DrawState{};
 }
 
 void GLCloud::endDraw() { glDisable(GL_BLEND); }
 
+GLLodCloud::GLLodCloud(const LodCloud& cloud)
+    : point_size{cloud.point_size_}, pose{Eigen::Matrix4d::Identity()} {
+    if (!GLCloud::initialized)
+        throw std::logic_error("GLCloud not initialized");
+
+    glGenTextures(1, &transform_texture);
+    glGenTextures(1, &palette_texture);
+
+    // the points are already in the frame of the cloud, a single identity
+    // column pose lets them share the shader of structured clouds
+    const GLfloat identity[12] = {1, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0};
+    load_texture(identity, 1, 4, transform_texture, GL_RGB32F);
+}
+
+GLLodCloud::~GLLodCloud() {
+    reset();
+    glDeleteTextures(1, &transform_texture);
+    glDeleteTextures(1, &palette_texture);
+}
+
+void GLLodCloud::reset() {
+    for (auto& kv : chunks) {
+        glDeleteBuffers(1, &kv.second.xyz_buffer);
+        glDeleteBuffers(1, &kv.second.key_buffer);
+    }
+    chunks.clear();
+    batches = 0;
+}
+
+/*
+ * Append the parts of a batch to the buffers of their chunks, growing them
+ * geometrically so that the points are copied on the GPU only a few times
+ */
+void GLLodCloud::upload(const LodBatch& batch) {
+    for (const auto& part : batch.parts) {
+        auto res = chunks.emplace(part.chunk, Chunk{});
+        Chunk& chunk = res.first->second;
+        if (res.second) {
+            chunk.lo = part.lo;
+            chunk.hi = part.hi;
+        }
+        for (size_t k = 0; k < 3; k++) {
+            chunk.lo[k] = std::min(chunk.lo[k], part.lo[k]);
+            chunk.hi[k] = std::max(chunk.hi[k], part.hi[k]);
+        }
+
+        if (chunk.n + part.count > chunk.capacity) {
+            const size_t capacity =
+                std::max(chunk.n + part.count, 2 * chunk.capacity);
+            GLuint buffers[2];
+            glGenBuffers(2, buffers);
+            const GLuint old_buffers[2] = {chunk.xyz_buffer, chunk.key_buffer};
+            const size_t components[2] = {3, 1};
+            for (size_t i = 0; i < 2; i++) {
+                glBindBuffer(GL_ARRAY_BUFFER, buffers[i]);
+                glBufferData(GL_ARRAY_BUFFER,
+                             sizeof(GLfloat) * components[i] * capacity,
+                             nullptr, GL_STATIC_DRAW);
+                if (chunk.n == 0) continue;
+                glBindBuffer(GL_COPY_READ_BUFFER, old_buffers[i]);
+                glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_ARRAY_BUFFER, 0, 0,
+                                    sizeof(GLfloat) * components[i] * chunk.n);
+            }
+            if (chunk.capacity > 0) glDeleteBuffers(2, old_buffers);
+            chunk.xyz_buffer = buffers[0];
+            chunk.key_buffer = buffers[1];
+            chunk.capacity = capacity;
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, chunk.xyz_buffer);
+        glBufferSubData(GL_ARRAY_BUFFER, sizeof(GLfloat) * 3 * chunk.n,
+                        sizeof(GLfloat) * 3 * part.count,
+                        batch.xyz.data() + 3 * part.first);
+        glBindBuffer(GL_ARRAY_BUFFER, chunk.key_buffer);
+        glBufferSubData(GL_ARRAY_BUFFER, sizeof(GLfloat) * chunk.n,
+                        sizeof(GLfloat) * part.count,
+                        batch.key.data() + part.first);
+
+        chunk.firsts.push_back(static_cast<GLint>(chunk.n));
+        chunk.counts.push_back(static_cast<GLsizei>(part.count));
+        chunk.n += part.count;
+    }
+}
+
+void GLLodCloud::draw(const WindowCtx&, const CameraData& camera,
+                      LodCloud& cloud) {
+    if (cloud.points_changed_) {
+        if (cloud.id_ != id || cloud.batches_.size() < batches) {
+            reset();
+            id = cloud.id_;
+        }
+        for (; batches < cloud.batches_.size(); batches++) {
+            upload(*cloud.batches_[batches]);
+        }
+        cloud.points_changed_ = false;
+    }
+
+    if (cloud.point_size_changed_) {
+        point_size = cloud.point_size_;
+        cloud.point_size_changed_ = false;
+    }
+    glPointSize(point_size);
+
+    if (cloud.pose_changed_) {
+        pose = Eigen::Map<const Eigen::Matrix4d>{cloud.pose_.data()};
+        cloud.pose_changed_ = false;
+    }
+
+    glUniform1i(GLCloud::cloud_ids.palette_id, 0);
+    glActiveTexture(GL_TEXTURE0);
+    if (cloud.palette_changed_) {
+        load_texture(cloud.palette_data_->data(),
+                     cloud.palette_data_->size() / 3, 1, palette_texture);
+        cloud.palette_changed_ = false;
+    }
+    glBindTexture(GL_TEXTURE_2D, palette_texture);
+
+    glUniform1i(GLCloud::cloud_ids.transformation_id, 1);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, transform_texture);
+
+    const Eigen::Matrix4f mvp =
+        (camera.proj * camera.view * camera.target * pose).cast<float>();
+    const Eigen::Matrix4f model = Eigen::Matrix4f::Identity();
+    glUniformMatrix4fv(GLCloud::cloud_ids.model_id, 1, GL_FALSE, model.data());
+    glUniformMatrix4fv(GLCloud::cloud_ids.proj_view_id, 1, GL_FALSE,
+                       mvp.data());
+    glUniform1i(GLCloud::cloud_ids.mono_id, 1);
+    glUniform1i(GLCloud::cloud_ids.key_mode_id, 0);
+    GLCloud::draw_state = GLCloud::DrawState{};
+
+    // cull the chunks out of the view frustum: those with all the corners of
+    // their bounds beyond one of the clip planes
+    struct Visible {
+        Chunk* chunk;
+        double dist2;
+    };
+    std::vector<Visible> visible;
+    size_t total = 0;
+    for (auto& kv : chunks) {
+        Chunk& chunk = kv.second;
+        int outside[6] = {0, 0, 0, 0, 0, 0};
+        for (int corner = 0; corner < 8; corner++) {
+            const Eigen::Vector4f p =
+                mvp * Eigen::Vector4f{corner & 1 ? chunk.hi[0] : chunk.lo[0],
+                                      corner & 2 ? chunk.hi[1] : chunk.lo[1],
+                                      corner & 4 ? chunk.hi[2] : chunk.lo[2],
+                                      1.0f};
+            for (int k = 0; k < 3; k++) {
+                outside[2 * k] += p[k] < -p[3];
+                outside[2 * k + 1] += p[k] > p[3];
+            }
+        }
+        if (std::find(outside, outside + 6, 8) != outside + 6) continue;
+
+        // the clip w of the center is its depth in perspective, constant in
+        // orthographic projection
+        const Eigen::Vector4f center =
+            mvp * Eigen::Vector4f{(chunk.lo[0] + chunk.hi[0]) / 2,
+                                  (chunk.lo[1] + chunk.hi[1]) / 2,
+                                  (chunk.lo[2] + chunk.hi[2]) / 2, 1.0f};
+        const double dist = std::max<double>(center[3], 1e-3);
+        visible.push_back({&chunk, dist * dist});
+        total += chunk.n;
+    }
+
+    // draw a fraction min(1, c / dist^2) of each chunk, the density of the
+    // points on the screen, with c the largest that fits in the budget
+    double c = std::numeric_limits<double>::infinity();
+    const size_t budget = cloud.point_budget_;
+    if (budget > 0 && total > budget) {
+        double lo = 0.0;
+        double hi = 0.0;
+        for (const auto& v : visible) hi = std::max(hi, v.dist2);
+        for (int i = 0; i < 40; i++) {
+            const double mid = (lo + hi) / 2;
+            double drawn = 0.0;
+            for (const auto& v : visible) {
+                drawn += v.chunk->n * std::min(1.0, mid / v.dist2);
+            }
+            (drawn > budget ? hi : lo) = mid;
+        }
+        c = lo;
+    }
+
+    glEnableVertexAttribArray(GLCloud::cloud_ids.xyz_id);
+    glEnableVertexAttribArray(GLCloud::cloud_ids.key_id);
+    // the other attributes are constant: disabled arrays read these values
+    glVertexAttrib1f(GLCloud::cloud_ids.range_id, 1.0f);
+    glVertexAttrib3f(GLCloud::cloud_ids.off_id, 0.0f, 0.0f, 0.0f);
+    glVertexAttrib1f(GLCloud::cloud_ids.trans_index_id, 0.5f);
+    glVertexAttrib4f(GLCloud::cloud_ids.mask_id, 0.0f, 0.0f, 0.0f, 0.0f);
+
+    for (const auto& v : visible) {
+        Chunk& chunk = *v.chunk;
+        const double fraction = std::min(1.0, c / v.dist2);
+        chunk.drawn.resize(chunk.counts.size());
+        for (size_t i = 0; i < chunk.counts.size(); i++) {
+            // the parts are shuffled, so any prefix is a uniform sample
+            chunk.drawn[i] = static_cast<GLsizei>(
+                std::ceil(chunk.counts[i] * fraction));
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, chunk.xyz_buffer);
+        glVertexAttribPointer(GLCloud::cloud_ids.xyz_id,
+                              3,         // size
+                              GL_FLOAT,  // type
+                              GL_FALSE,  // normalized?
+                              0,         // stride
+                              (void*)0   // array buffer offset
+        );
+        glBindBuffer(GL_ARRAY_BUFFER, chunk.key_buffer);
+        glVertexAttribPointer(GLCloud::cloud_ids.key_id,
+                              1,         // size
+                              GL_FLOAT,  // type
+                              GL_FALSE,  // normalized?
+                              0,         // stride
+                              (void*)0   // array buffer offset
+        );
+        glMultiDrawArrays(GL_POINTS, chunk.firsts.data(), chunk.drawn.data(),
+                          static_cast<GLsizei>(chunk.firsts.size()));
+    }
+
+    glDisableVertexAttribArray(GLCloud::cloud_ids.xyz_id);
+    glDisableVertexAttribArray(GLCloud::cloud_ids.key_id);
+}
+
 }  // namespace impl
 }  // namespace viz
 }  // namespace ouster
@@ -6,6 +6,12 @@
 #pragma once
 
 #include <Eigen/Core>
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
 
 #include "camera.h"
 #include "glfw.h"
@@ -30,8 +36,39 @@ class GLCloud {
     static GLuint program_id;
     static CloudIds cloud_ids;
 
+    // programs normalizing raw keys
+    static GLuint histogram_program_id;
+    static GLuint cdf_program_id;
+    static GLuint exposure_program_id;
+
+    /*
+     * A palette texture, shared by the clouds with the same palette
+     */
+    struct Palette {
+        std::vector<float> data;
+        GLuint texture;
+        size_t refs;
+    };
+    static std::vector<std::unique_ptr<Palette>> palettes;
+
+    static Palette* acquire_palette(const std::vector<float>& data);
+    static void release_palette(Palette* palette);
+
+    /*
+     * The GL state set by the last cloud drawn, so that consecutive clouds
+     * sharing it don't set it again. Anything else changing it resets it.
+     */
+    struct DrawState {
+        GLfloat point_size{-1};
+        GLuint palette_texture{0};
+        GLint mono{-1};
+        GLint key_mode{-1};
+    };
+    static DrawState draw_state;
+
    private:
     // per-object gl state
+    GLuint vao;
     GLuint xyz_buffer;
     GLuint off_buffer;
     GLuint range_buffer;
@@ -39,13 +76,57 @@ class GLCloud {
     GLuint mask_buffer;
     GLuint trans_index_buffer;
     GLuint transform_texture;
-    GLuint palette_texture;
+    Palette* palette{nullptr};
+    GLuint raw_key_buffer;
+    // the type of the raw key attribute of the vao, 0 when disabled
+    GLenum vao_raw_key_type{0};
+
+    // framebuffer and textures normalizing raw keys, allocated on first use
+    GLuint key_framebuffer{0};
+    GLuint key_vao;
+    GLuint histogram_texture;
+    GLuint cdf_texture;
+    GLuint exposure_texture;
+
+    // bytes allocated to each buffer, which are reallocated only on resize
+    size_t xyz_bytes{0};
+    size_t off_bytes{0};
+    size_t range_bytes{0};
+    size_t key_bytes{0};
+    size_t mask_bytes{0};
+    size_t raw_key_bytes{0};
+    // the (n, w) structure of the transformation indices in trans_index_buffer
+    size_t trans_index_key{0};
+
+    GLsizei n{0};
     GLfloat point_size;
     bool mono;
 
+    // 0 for float keys, 1 or 2 for raw keys of raw_key_type normalized by
+    // exposure or equalization, as the key_mode of the shader
+    GLint key_mode{0};
+    GLenum raw_key_type{GL_UNSIGNED_INT};
+    bool exposure_valid{false};
+
     Eigen::Matrix4d map_pose;
     Eigen::Matrix4f extrinsic;
 
+    /*
+     * Build the histogram of the raw keys, then their CDF or exposure
+     */
+    void normalize_raw_keys(size_t n);
+
+    /*
+     * Upload the changes of the cloud. Leaves the units of the textures read
+     * by render() and the bound vertex array alone.
+     */
+    void update(Cloud& cloud);
+
+    /*
+     * Draw the uploaded points, binding the vertex array of the cloud
+     */
+    void render(const CameraData& camera);
+
    public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
@@ -61,6 +142,14 @@ class GLCloud {
      */
     void draw(const WindowCtx& ctx, const CameraData& camera, Cloud& cloud);
 
+    /*
+     * Render all the clouds, grouped by the GL state they set so that it
+     * changes as few times as possible. Leaves the vertex array of one of
+     * them bound.
+     */
+    static void draw_all(const CameraData& camera,
+                         const std::vector<std::pair<GLCloud*, Cloud*>>& all);
+
     static void initialize();
 
     static void uninitialize();
@@ -68,6 +157,74 @@ class GLCloud {
     static void beginDraw();
 
     static void endDraw();
+
+    friend class GLLodCloud;
+};
+
+/*
+ * The points of a call to LodCloud::add_points(), grouped by chunk
+ */
+struct LodBatch {
+    using ChunkKey = std::array<int32_t, 3>;
+
+    /*
+     * The points of one chunk, shuffled
+     */
+    struct Part {
+        ChunkKey chunk;                // voxel coordinates of the chunk
+        size_t first;                  // index of the first point
+        size_t count;                  // number of points
+        std::array<float, 3> lo, hi;  // bounds of the points
+    };
+
+    std::vector<Part> parts;
+    std::vector<float> xyz;  // 3 values per point
+    std::vector<float> key;  // 1 value per point
+};
+
+/*
+ * Manages opengl state for drawing a level of detail point cloud
+ */
+class GLLodCloud {
+    /*
+     * The buffers of a chunk, holding the points of each batch one after the
+     * other
+     */
+    struct Chunk {
+        GLuint xyz_buffer{0};
+        GLuint key_buffer{0};
+        size_t capacity{0};
+        size_t n{0};
+        std::vector<GLint> firsts;    // first point of each batch part
+        std::vector<GLsizei> counts;  // points of each batch part
+        std::vector<GLsizei> drawn;   // points of each part drawn this frame
+        std::array<float, 3> lo, hi;
+    };
+
+    std::map<LodBatch::ChunkKey, Chunk> chunks;
+    uint64_t id{0};           // the cloud whose points were uploaded
+    size_t batches{0};        // the batches uploaded
+    GLuint transform_texture;
+    GLuint palette_texture;
+    GLfloat point_size;
+    Eigen::Matrix4d pose;
+
+    void reset();
+
+    void upload(const LodBatch& batch);
+
+   public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    GLLodCloud(const LodCloud& cloud);
+
+    ~GLLodCloud();
+
+    /*
+     * Render the visible chunks with the point of view of the Camera, within
+     * the point budget of the cloud
+     */
+    void draw(const WindowCtx& ctx, const CameraData& camera, LodCloud& cloud);
 };
 
 }  // namespace impl
@@ -151,6 +151,13 @@ void load_texture(const F& texture, size_t width, size_t height,
  *                            four pixels' rgb values correspond to
  *                            four columns (3 rotation 1 translation)
  * @param[in] proj_view      Camera view matrix controlled by the visualizer.
+ *
+ * @param[in] raw_key        Unnormalized key of each point, used in place of
+ *                           key when key_mode isn't 0.
+ *
+ * @param[in] key_mode       0 to use key, 1 to scale raw_key by the 1 x 1
+ *                           (lo, hi) exposure in normalization, 2 to look up
+ *                           raw_key in the histogram CDF in normalization.
  */
 static const std::string point_vertex_shader_code =
     R"SHADER(
@@ -167,9 +174,31 @@ static const std::string point_vertex_shader_code =
 
             in vec4 vkey;
             in vec4 vmask;
+            in float raw_key;
+
+            uniform int key_mode;
+            uniform sampler2D normalization;
 
             out vec4 key;
             out vec4 mask;
+
+            // the bins of the key histogram shader, the scaling of
+            // AutoExposure
+            float normalize_key(float v) {
+                if (v <= 0.0) return 0.0;
+                if (key_mode == 2) {
+                    int bin = clamp(int(log2(v) * 32.0), 0, 1023);
+                    return texelFetch(normalization, ivec2(bin, 0), 0).r;
+                }
+                vec2 e = texelFetch(normalization, ivec2(0, 0), 0).rg;
+                if (e.y <= e.x)
+                    return clamp(v * 0.5 / max(e.y, 1.0), 0.0, 1.0);
+                float scale = 0.8 / (e.y - e.x);
+                if (0.1 - scale * e.x <= 0.0)
+                    return clamp((v - e.x) * scale + 0.1, 0.0, 1.0);
+                return clamp(v * 0.9 / e.y, 0.0, 1.0);
+            }
+
             void main() {
                 vec4 local_point = range > 0
                                    ? model * vec4(xyz * range + offset, 1.0)
@@ -192,7 +221,12 @@ static const std::string point_vertex_shader_code =
                 );
 
                 gl_Position = proj_view * car_pose * local_point;
-                key = vkey;
+                if (key_mode != 0) {
+                    float k = normalize_key(raw_key);
+                    key = vec4(k, k, k, 1.0);
+                } else {
+                    key = vkey;
+                }
                 mask = vmask;
             })SHADER";
 static const std::string point_fragment_shader_code =
@@ -213,6 +247,99 @@ static const std::string point_fragment_shader_code =
                 vec3 color_rgb = mask.rgb * mask.a + c * key.a * (1 - mask.a);
                 color = vec4(color_rgb / color_a, color_a);
             })SHADER";
+/**
+ * Counts the nonzero raw keys of a cloud into a 1024 x 1 histogram, drawn
+ * as points with additive blending. The bins are 1/32 of an octave wide.
+ *
+ * @param[in] raw_key        Unnormalized key of each point.
+ */
+static const std::string key_histogram_vertex_shader_code =
+    R"SHADER(
+            #version 330 core
+            in float raw_key;
+            void main() {
+                // zero keys are left out, beyond the viewport
+                int bin = clamp(int(log2(raw_key) * 32.0), 0, 1023);
+                float x = raw_key > 0.0 ? (float(bin) + 0.5) / 512.0 - 1.0
+                                        : 2.0;
+                gl_Position = vec4(x, 0.0, 0.0, 1.0);
+            })SHADER";
+static const std::string key_histogram_fragment_shader_code =
+    R"SHADER(
+            #version 330 core
+            out vec4 count;
+            void main() {
+                count = vec4(1.0);
+            })SHADER";
+
+/**
+ * Draws a triangle covering the viewport, to run a fragment shader once per
+ * texel of the framebuffer.
+ */
+static const std::string key_reduce_vertex_shader_code =
+    R"SHADER(
+            #version 330 core
+            void main() {
+                gl_Position = vec4(float(gl_VertexID & 1) * 4.0 - 1.0,
+                                   float(gl_VertexID & 2) * 2.0 - 1.0, 0.0,
+                                   1.0);
+            })SHADER";
+
+/**
+ * Computes the CDF of a key histogram into a 1024 x 1 texture.
+ *
+ * @param[in] histogram      The 1024 x 1 histogram of the keys.
+ */
+static const std::string key_cdf_fragment_shader_code =
+    R"SHADER(
+            #version 330 core
+            uniform sampler2D histogram;
+            out vec4 cdf;
+            void main() {
+                int bin = int(gl_FragCoord.x);
+                float below = 0.0;
+                float total = 0.0;
+                for (int i = 0; i < 1024; i++) {
+                    float count = texelFetch(histogram, ivec2(i, 0), 0).r;
+                    total += count;
+                    if (i <= bin) below += count;
+                }
+                cdf = vec4(total > 0.0 ? below / total : 0.0);
+            })SHADER";
+
+/**
+ * Computes the 10th and 90th percentiles of a key histogram into a 1 x 1
+ * texture, like AutoExposure, keeping the previous ones when there are too
+ * few keys. Blending the result with the previous one smooths it.
+ *
+ * @param[in] histogram      The 1024 x 1 histogram of the keys.
+ */
+static const std::string key_exposure_fragment_shader_code =
+    R"SHADER(
+            #version 330 core
+            uniform sampler2D histogram;
+            out vec4 exposure;
+            float bin_value(int bin) { return exp2((float(bin) + 0.5) / 32.0); }
+            void main() {
+                float total = 0.0;
+                for (int i = 0; i < 1024; i++)
+                    total += texelFetch(histogram, ivec2(i, 0), 0).r;
+                if (total < 100.0) discard;
+                float lo_k = floor(total * 0.1);
+                float hi_k = total - floor(total * 0.1) - 1.0;
+                float below = 0.0;
+                int lo = -1;
+                int hi = 1023;
+                for (int i = 0; i < 1024; i++) {
+                    below += texelFetch(histogram, ivec2(i, 0), 0).r;
+                    if (lo < 0 && below > lo_k) lo = i;
+                    if (below > hi_k) {
+                        hi = i;
+                        break;
+                    }
+                }
+                exposure = vec4(bin_value(lo), bin_value(hi), 0.0, 1.0);
+            })SHADER";
 static const std::string ring_vertex_shader_code =
     R"SHADER(
             #version 330 core
@@ -273,6 +400,29 @@ static const std::string cuboid_fragment_shader_code =
             void main() {
                 color = rgba;
             })SHADER";
+static const std::string label_vertex_shader_code =
+    R"SHADER(
+            #version 330 core
+            in vec4 label_position;
+            in vec2 label_uv;
+            in vec4 label_rgba;
+            out vec2 uv;
+            out vec4 rgba;
+            void main() {
+                gl_Position = label_position;
+                uv = label_uv;
+                rgba = label_rgba;
+            })SHADER";
+static const std::string label_fragment_shader_code =
+    R"SHADER(
+            #version 330 core
+            in vec2 uv;
+            in vec4 rgba;
+            uniform sampler2D glyphs;
+            out vec4 color;
+            void main() {
+                color = texture(glyphs, uv) * rgba;
+            })SHADER";
 static const std::string image_vertex_shader_code =
     R"SHADER(
             #version 330 core
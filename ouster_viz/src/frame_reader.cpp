@@ -0,0 +1,165 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "frame_reader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <utility>
+
+namespace ouster {
+namespace viz {
+namespace impl {
+
+FrameReader::~FrameReader() { stop(); }
+
+void FrameReader::set_sink(Sink sink, size_t buffer_frames) {
+    active_ = false;
+    stop();
+    if (!sink) return;
+
+    std::lock_guard<std::mutex> lock{mx_};
+    sink_ = std::move(sink);
+    buffer_frames_ = std::max<size_t>(buffer_frames, 1);
+    stopping_ = false;
+    thread_ = std::thread{[this]() { run(); }};
+    active_ = true;
+}
+
+void FrameReader::read(int width, int height) {
+    if (!active_) {
+        discard_pending();
+        return;
+    }
+
+    // queue the frames already read back, keeping a slot for this one
+    while (n_pending_ > 0 && map_oldest(false)) {
+    }
+    if (n_pending_ == ring_.size()) map_oldest(true);
+
+    Pbo& pbo = ring_[(oldest_ + n_pending_) % ring_.size()];
+    const size_t size = static_cast<size_t>(width) * height * 3;
+    if (pbo.id == 0) glGenBuffers(1, &pbo.id);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo.id);
+    if (pbo.size != size) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        pbo.size = size;
+    }
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadBuffer(GL_BACK);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    pbo.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    pbo.width = width;
+    pbo.height = height;
+    n_pending_++;
+}
+
+void FrameReader::drain() {
+    while (n_pending_ > 0) map_oldest(true);
+}
+
+void FrameReader::release_gl() {
+    discard_pending();
+    for (auto& pbo : ring_) {
+        if (pbo.id != 0) glDeleteBuffers(1, &pbo.id);
+        pbo = Pbo{};
+    }
+}
+
+bool FrameReader::map_oldest(bool wait) {
+    Pbo& pbo = ring_[oldest_];
+    const GLenum status = glClientWaitSync(
+        pbo.fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? GL_TIMEOUT_IGNORED : 0);
+    if (status == GL_TIMEOUT_EXPIRED) return false;
+    glDeleteSync(pbo.fence);
+    pbo.fence = nullptr;
+    oldest_ = (oldest_ + 1) % ring_.size();
+    n_pending_--;
+    if (status == GL_WAIT_FAILED) return true;
+
+    std::vector<uint8_t> frame;
+    {
+        std::lock_guard<std::mutex> lock{mx_};
+        if (!free_.empty()) {
+            frame = std::move(free_.back());
+            free_.pop_back();
+        }
+    }
+    frame.resize(pbo.size);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo.id);
+    const void* data =
+        glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, pbo.size, GL_MAP_READ_BIT);
+    if (data) {
+        std::memcpy(frame.data(), data, pbo.size);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (data) push(std::move(frame), pbo.width, pbo.height);
+    return true;
+}
+
+void FrameReader::discard_pending() {
+    while (n_pending_ > 0) {
+        Pbo& pbo = ring_[oldest_];
+        glDeleteSync(pbo.fence);
+        pbo.fence = nullptr;
+        oldest_ = (oldest_ + 1) % ring_.size();
+        n_pending_--;
+    }
+}
+
+void FrameReader::push(std::vector<uint8_t>&& frame, int width, int height) {
+    std::lock_guard<std::mutex> lock{mx_};
+    if (queue_.size() >= buffer_frames_) {
+        free_.push_back(std::move(queue_.front().data));
+        queue_.pop_front();
+        dropped_++;
+    }
+    queue_.push_back(Frame{std::move(frame), width, height});
+    cv_.notify_one();
+}
+
+void FrameReader::stop() {
+    {
+        std::lock_guard<std::mutex> lock{mx_};
+        stopping_ = true;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) thread_.join();
+
+    // frames read after the thread stopped aren't for the next sink
+    std::lock_guard<std::mutex> lock{mx_};
+    for (auto& frame : queue_) free_.push_back(std::move(frame.data));
+    queue_.clear();
+    sink_ = nullptr;
+}
+
+void FrameReader::run() {
+    std::unique_lock<std::mutex> lock{mx_};
+    while (true) {
+        cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (queue_.empty()) return;
+        Frame frame = std::move(queue_.front());
+        queue_.pop_front();
+
+        // the sink runs unlocked so that frames keep being queued
+        lock.unlock();
+        try {
+            sink_(frame.data, frame.width, frame.height);
+        } catch (const std::exception& e) {
+            std::cerr << "Frame sink error: " << e.what() << std::endl;
+        }
+        lock.lock();
+        free_.push_back(std::move(frame.data));
+    }
+}
+
+}  // namespace impl
+}  // namespace viz
+}  // namespace ouster
@@ -0,0 +1,116 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "glfw.h"
+
+namespace ouster {
+namespace viz {
+namespace impl {
+
+/*
+ * Reads back rendered frames without waiting on the GPU and hands them to a
+ * sink on its own thread
+ *
+ * Each frame is read into the next of a ring of pixel buffer objects, which
+ * are mapped frames later once their fence signals, so that the read never
+ * stalls the pipeline unless the ring is full. Mapped frames are copied into
+ * recycled buffers and queued for the sink thread; when the sink falls
+ * behind, the oldest queued frame is dropped and counted.
+ */
+class FrameReader {
+   public:
+    using Sink = std::function<void(const std::vector<uint8_t>&, int, int)>;
+
+    FrameReader() = default;
+
+    FrameReader(const FrameReader&) = delete;
+    FrameReader& operator=(const FrameReader&) = delete;
+
+    // stops the sink thread; release_gl() must have been called before
+    ~FrameReader();
+
+    /*
+     * Replace the sink, or remove it with an empty function. Waits for the
+     * frames queued for the previous sink to be consumed.
+     */
+    void set_sink(Sink sink, size_t buffer_frames);
+
+    /*
+     * Read the back buffer of the current frame and queue the frames read
+     * before that are ready. Needs the GL context current.
+     */
+    void read(int width, int height);
+
+    /*
+     * Queue all the frames still being read. Needs the GL context current.
+     */
+    void drain();
+
+    /*
+     * Delete the GL objects. Needs the GL context current.
+     */
+    void release_gl();
+
+    uint64_t dropped() const { return dropped_; }
+
+   private:
+    struct Pbo {
+        GLuint id{0};
+        GLsync fence{nullptr};
+        size_t size{0};
+        int width{0};
+        int height{0};
+    };
+
+    // map the oldest pending pbo if its fence signaled, or waiting for it
+    bool map_oldest(bool wait);
+
+    void discard_pending();
+
+    void push(std::vector<uint8_t>&& frame, int width, int height);
+
+    void stop();
+
+    void run();
+
+    std::array<Pbo, 3> ring_{};
+    size_t oldest_{0};
+    size_t n_pending_{0};
+
+    struct Frame {
+        std::vector<uint8_t> data;
+        int width;
+        int height;
+    };
+
+    // sink thread state, guarded by mx_
+    std::mutex mx_;
+    std::condition_variable cv_;
+    std::deque<Frame> queue_;
+    std::vector<std::vector<uint8_t>> free_;
+    Sink sink_;
+    size_t buffer_frames_{0};
+    bool stopping_{false};
+    std::thread thread_;
+
+    std::atomic<bool> active_{false};
+    std::atomic<uint64_t> dropped_{0};
+};
+
+}  // namespace impl
+}  // namespace viz
+}  // namespace ouster
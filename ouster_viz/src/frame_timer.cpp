@@ -0,0 +1,120 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "frame_timer.h"
+
+#include <utility>
+
+namespace ouster {
+namespace viz {
+namespace impl {
+
+namespace {
+
+double ms_between(std::chrono::steady_clock::time_point from,
+                  std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+}  // namespace
+
+FrameTimer::FrameTimer(std::vector<std::string> sections)
+    : sections_{std::move(sections)} {}
+
+void FrameTimer::begin() {
+    timing_ = enabled_;
+    if (!timing_) return;
+
+    Record& record = ring_[next_];
+    if (record.queries.empty()) {
+        record.queries.resize(sections_.size() + 1);
+        glGenQueries(static_cast<GLsizei>(record.queries.size()),
+                     record.queries.data());
+    }
+    // too far behind: give up on the results of the oldest frame
+    record.pending = false;
+    record.cpu_ms.assign(sections_.size(), 0.0);
+
+    glQueryCounter(record.queries[0], GL_TIMESTAMP);
+    section_ = 0;
+    start_ = last_ = clock::now();
+}
+
+void FrameTimer::end_section() {
+    if (!timing_ || section_ >= sections_.size()) return;
+    Record& record = ring_[next_];
+    glQueryCounter(record.queries[section_ + 1], GL_TIMESTAMP);
+    const auto now = clock::now();
+    record.cpu_ms[section_++] = ms_between(last_, now);
+    last_ = now;
+}
+
+void FrameTimer::end() {
+    if (timing_) {
+        // sections never reached take no time
+        while (section_ < sections_.size()) end_section();
+        Record& record = ring_[next_];
+        record.total_cpu_ms = ms_between(start_, clock::now());
+        record.frame = frame_;
+        record.pending = true;
+        next_ = (next_ + 1) % ring_.size();
+        timing_ = false;
+    }
+    frame_++;
+
+    // collect in order from the oldest record, stopping at the first one
+    // still running on the GPU
+    for (size_t i = 0; i < ring_.size(); i++) {
+        Record& record = ring_[(next_ + i) % ring_.size()];
+        if (record.pending && !collect(record)) break;
+    }
+}
+
+bool FrameTimer::collect(Record& record) {
+    GLint available = 0;
+    glGetQueryObjectiv(record.queries.back(), GL_QUERY_RESULT_AVAILABLE,
+                       &available);
+    if (!available) return false;
+    record.pending = false;
+
+    std::vector<GLuint64> timestamps(record.queries.size());
+    for (size_t i = 0; i < record.queries.size(); i++) {
+        glGetQueryObjectui64v(record.queries[i], GL_QUERY_RESULT,
+                              &timestamps[i]);
+    }
+
+    FrameStats stats;
+    stats.frame = record.frame;
+    stats.cpu_ms = record.total_cpu_ms;
+    stats.gpu_ms = (timestamps.back() - timestamps.front()) * 1e-6;
+    for (size_t i = 0; i < sections_.size(); i++) {
+        stats.sections.push_back(
+            {sections_[i], record.cpu_ms[i],
+             (timestamps[i + 1] - timestamps[i]) * 1e-6});
+    }
+
+    std::lock_guard<std::mutex> lock{mx_};
+    stats_ = std::move(stats);
+    return true;
+}
+
+void FrameTimer::release_gl() {
+    for (auto& record : ring_) {
+        if (!record.queries.empty()) {
+            glDeleteQueries(static_cast<GLsizei>(record.queries.size()),
+                            record.queries.data());
+        }
+        record = Record{};
+    }
+}
+
+FrameStats FrameTimer::stats() const {
+    std::lock_guard<std::mutex> lock{mx_};
+    return stats_;
+}
+
+}  // namespace impl
+}  // namespace viz
+}  // namespace ouster
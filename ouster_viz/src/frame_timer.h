@@ -0,0 +1,93 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "glfw.h"
+#include "ouster/point_viz.h"
+
+namespace ouster {
+namespace viz {
+namespace impl {
+
+/*
+ * Times the sections of the frames drawn on the CPU, and on the GPU with
+ * timestamp queries
+ *
+ * Queries are kept in a ring of a few frames and their results read only
+ * once available, so measuring never waits on the GPU. A frame whose results
+ * aren't available when its queries are needed again is dropped.
+ */
+class FrameTimer {
+   public:
+    explicit FrameTimer(std::vector<std::string> sections);
+
+    FrameTimer(const FrameTimer&) = delete;
+    FrameTimer& operator=(const FrameTimer&) = delete;
+
+    // start or stop measuring from the next frame, from any thread
+    void enabled(bool state) { enabled_ = state; }
+
+    /*
+     * Start timing a frame. Needs the GL context current, as do the
+     * following methods but stats().
+     */
+    void begin();
+
+    // mark the end of the next section of the frame
+    void end_section();
+
+    // mark the end of the frame and collect the results available
+    void end();
+
+    /*
+     * Delete the GL objects
+     */
+    void release_gl();
+
+    // stats of the last frame whose results were collected, from any thread
+    FrameStats stats() const;
+
+   private:
+    using clock = std::chrono::steady_clock;
+
+    struct Record {
+        std::vector<GLuint> queries;  // one per section, plus the start
+        std::vector<double> cpu_ms;
+        double total_cpu_ms{0};
+        uint64_t frame{0};
+        bool pending{false};
+    };
+
+    // read the results of a record if available
+    bool collect(Record& record);
+
+    std::vector<std::string> sections_;
+    std::array<Record, 4> ring_{};
+    size_t next_{0};
+    uint64_t frame_{0};
+
+    // state of the frame being timed
+    bool timing_{false};
+    size_t section_{0};
+    clock::time_point start_, last_;
+
+    std::atomic<bool> enabled_{false};
+
+    mutable std::mutex mx_;
+    FrameStats stats_;
+};
+
+}  // namespace impl
+}  // namespace viz
+}  // namespace ouster
@@ -5,6 +5,13 @@
 
 #include "glfw.h"
 
+#ifdef OUSTER_VIZ_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#include <chrono>
+#include <cstring>
 #include <functional>
 #include <iostream>
 #include <stdexcept>
@@ -136,10 +143,173 @@ void handle_cursor_enter(GLFWwindow* window, int entered) {
 }  // namespace
 
 /*
- * Initialize GLFW window
+ * Offscreen EGL context and the state glfw keeps for a window
+ */
+struct GLFWContext::Headless {
+#ifdef OUSTER_VIZ_EGL
+    EGLDisplay display{EGL_NO_DISPLAY};
+    EGLSurface surface{EGL_NO_SURFACE};
+    EGLContext context{EGL_NO_CONTEXT};
+    // false when the display is that of the context shared with
+    bool owns_display{true};
+#endif
+    bool running{true};
+    std::chrono::steady_clock::time_point start{
+        std::chrono::steady_clock::now()};
+
+    ~Headless() {
+#ifdef OUSTER_VIZ_EGL
+        if (display == EGL_NO_DISPLAY) return;
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                       EGL_NO_CONTEXT);
+        if (context != EGL_NO_CONTEXT) eglDestroyContext(display, context);
+        if (surface != EGL_NO_SURFACE) eglDestroySurface(display, surface);
+        if (owns_display) eglTerminate(display);
+#endif
+    }
+};
+
+namespace {
+
+#ifdef OUSTER_VIZ_EGL
+/*
+ * Get an EGL display that needs no window system: the first GPU, then the
+ * surfaceless platform of Mesa, then the default display
+ */
+EGLDisplay headless_display() {
+    const char* exts = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    auto has_ext = [exts](const char* ext) {
+        return exts != nullptr && std::strstr(exts, ext) != nullptr;
+    };
+    auto get_platform_display =
+        reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+            eglGetProcAddress("eglGetPlatformDisplayEXT"));
+
+    if (get_platform_display && has_ext("EGL_EXT_platform_device")) {
+        auto query_devices = reinterpret_cast<PFNEGLQUERYDEVICESEXTPROC>(
+            eglGetProcAddress("eglQueryDevicesEXT"));
+        EGLDeviceEXT device;
+        EGLint n_devices = 0;
+        if (query_devices && query_devices(1, &device, &n_devices) &&
+            n_devices > 0) {
+            EGLDisplay display = get_platform_display(
+                EGL_PLATFORM_DEVICE_EXT, device, nullptr);
+            if (display != EGL_NO_DISPLAY) return display;
+        }
+    }
+    if (get_platform_display && has_ext("EGL_MESA_platform_surfaceless")) {
+        EGLDisplay display = get_platform_display(
+            EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        if (display != EGL_NO_DISPLAY) return display;
+    }
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+/*
+ * Create a 3.3 core context rendering into a pbuffer and make it current,
+ * on the display of the share context if any
+ */
+void init_headless(GLFWContext::Headless& h, int width, int height,
+                   const GLFWContext::Headless* share) {
+    if (share) {
+        h.display = share->display;
+        h.owns_display = false;
+    } else {
+        h.display = headless_display();
+        if (h.display == EGL_NO_DISPLAY ||
+            !eglInitialize(h.display, nullptr, nullptr)) {
+            h.display = EGL_NO_DISPLAY;
+            throw std::runtime_error("Failed to initialize EGL");
+        }
+    }
+
+    const EGLint config_attribs[] = {EGL_SURFACE_TYPE,
+                                     EGL_PBUFFER_BIT,
+                                     EGL_RENDERABLE_TYPE,
+                                     EGL_OPENGL_BIT,
+                                     EGL_RED_SIZE,
+                                     8,
+                                     EGL_GREEN_SIZE,
+                                     8,
+                                     EGL_BLUE_SIZE,
+                                     8,
+                                     EGL_DEPTH_SIZE,
+                                     24,
+                                     EGL_NONE};
+    EGLConfig config;
+    EGLint n_configs = 0;
+    if (!eglChooseConfig(h.display, config_attribs, &config, 1, &n_configs) ||
+        n_configs == 0) {
+        throw std::runtime_error("Failed to find an EGL config");
+    }
+
+    const EGLint surface_attribs[] = {EGL_WIDTH, width, EGL_HEIGHT, height,
+                                      EGL_NONE};
+    h.surface = eglCreatePbufferSurface(h.display, config, surface_attribs);
+    if (h.surface == EGL_NO_SURFACE) {
+        throw std::runtime_error("Failed to create EGL surface");
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        throw std::runtime_error("Failed to bind the OpenGL API");
+    }
+    const EGLint context_attribs[] = {EGL_CONTEXT_MAJOR_VERSION,
+                                      3,
+                                      EGL_CONTEXT_MINOR_VERSION,
+                                      3,
+                                      EGL_CONTEXT_OPENGL_PROFILE_MASK,
+                                      EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                                      EGL_NONE};
+    h.context = eglCreateContext(h.display, config,
+                                 share ? share->context : EGL_NO_CONTEXT,
+                                 context_attribs);
+    if (h.context == EGL_NO_CONTEXT) {
+        throw std::runtime_error("Failed to create EGL context");
+    }
+    eglMakeCurrent(h.display, h.surface, h.surface, h.context);
+
+    if (!gladLoadGL(reinterpret_cast<GLADloadfunc>(eglGetProcAddress))) {
+        throw std::runtime_error("Failed to initialize GLAD");
+    }
+}
+#endif
+
+}  // namespace
+
+/*
+ * Initialize GLFW window, or the offscreen context when headless
  */
 GLFWContext::GLFWContext(const std::string& name, bool fix_aspect,
-                         int window_width, int window_height) {
+                         int window_width, int window_height, bool headless,
+                         GLFWContext* share) {
+    if (share && (share->headless != nullptr) != headless) {
+        throw std::invalid_argument(
+            "Can't share GL objects between headless and window contexts");
+    }
+    if (headless) {
+#ifdef OUSTER_VIZ_EGL
+        this->headless = std::make_unique<Headless>();
+        init_headless(*this->headless, window_width, window_height,
+                      share ? share->headless.get() : nullptr);
+        std::cerr << "GL Renderer: " << glGetString(GL_RENDERER) << std::endl;
+        // the text shader and glyph atlas are shared too
+        if (!share && gltInit() == GL_FALSE) {
+            throw std::runtime_error("Error initializing GLT");
+        }
+        glViewport(0, 0, window_width, window_height);
+        gltViewport(window_width, window_height);
+        window_context.viewport_width = window_width;
+        window_context.viewport_height = window_height;
+        window_context.window_width = window_width;
+        window_context.window_height = window_height;
+        release_current();
+        return;
+#else
+        throw std::runtime_error(
+            "Headless rendering needs ouster_viz built with EGL");
+#endif
+    }
+
     glfwSetErrorCallback(error_callback);
 
     // avoid chdir to resources dir on macos
@@ -160,8 +330,8 @@ GLFWContext::GLFWContext(const std::string& name, bool fix_aspect,
     glfwWindowHint(GLFW_VISIBLE, false);
 
     // open a window and create its OpenGL context
-    window =
-        glfwCreateWindow(window_width, window_height, name.c_str(), NULL, NULL);
+    window = glfwCreateWindow(window_width, window_height, name.c_str(), NULL,
+                              share ? share->window : NULL);
 
     if (window == nullptr) {
         glfwTerminate();
@@ -179,8 +349,8 @@ GLFWContext::GLFWContext(const std::string& name, bool fix_aspect,
               << " (GLSL: " << glGetString(GL_SHADING_LANGUAGE_VERSION) << ")"
               << std::endl;
 
-    // initialize text rendering
-    if (gltInit() == GL_FALSE) {
+    // initialize text rendering, unless shared
+    if (!share && gltInit() == GL_FALSE) {
         std::cerr << "Error initializing GLT" << std::endl;
         glfwTerminate();
         throw std::runtime_error("Error initializing GLT");
@@ -227,7 +397,9 @@ GLFWContext::GLFWContext(const std::string& name, bool fix_aspect,
     glfwMakeContextCurrent(nullptr);
 }
 
-GLFWContext::~GLFWContext() { glfwDestroyWindow(window); }
+GLFWContext::~GLFWContext() {
+    if (window) glfwDestroyWindow(window);
+}
 
 void GLFWContext::terminate() {
     // TODO: can't terminate if we allow multiple instances
@@ -235,18 +407,77 @@ void GLFWContext::terminate() {
     glfwTerminate();
 }
 
-bool GLFWContext::running() { return !glfwWindowShouldClose(window); }
+bool GLFWContext::running() {
+    if (headless) return headless->running;
+    return !glfwWindowShouldClose(window);
+}
 
 void GLFWContext::running(bool state) {
-    glfwSetWindowShouldClose(window, !state);
+    if (headless)
+        headless->running = state;
+    else
+        glfwSetWindowShouldClose(window, !state);
 }
 
 void GLFWContext::visible(bool state) {
+    if (headless) return;
     if (state)
         glfwShowWindow(window);
     else
         glfwHideWindow(window);
 }
 
+void GLFWContext::make_current() {
+#ifdef OUSTER_VIZ_EGL
+    if (headless) {
+        eglMakeCurrent(headless->display, headless->surface,
+                       headless->surface, headless->context);
+        return;
+    }
+#endif
+    glfwMakeContextCurrent(window);
+}
+
+void GLFWContext::release_current() {
+#ifdef OUSTER_VIZ_EGL
+    if (headless) {
+        eglMakeCurrent(headless->display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                       EGL_NO_CONTEXT);
+        return;
+    }
+#endif
+    glfwMakeContextCurrent(nullptr);
+}
+
+bool GLFWContext::is_current() const {
+#ifdef OUSTER_VIZ_EGL
+    if (headless) return eglGetCurrentContext() == headless->context;
+#endif
+    return glfwGetCurrentContext() == window;
+}
+
+void GLFWContext::swap_buffers() {
+#ifdef OUSTER_VIZ_EGL
+    if (headless) {
+        eglSwapBuffers(headless->display, headless->surface);
+        return;
+    }
+#endif
+    glfwSwapBuffers(window);
+}
+
+void GLFWContext::poll_events() {
+    if (!headless) glfwPollEvents();
+}
+
+double GLFWContext::time() const {
+    if (headless) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                             headless->start)
+            .count();
+    }
+    return glfwGetTime();
+}
+
 }  // namespace viz
 }  // namespace ouster
@@ -12,6 +12,7 @@
 // clang-format on
 
 #include <functional>
+#include <memory>
 #include <string>
 
 #include "ouster/point_viz.h"
@@ -20,8 +21,16 @@ namespace ouster {
 namespace viz {
 
 struct GLFWContext {
+    /*
+     * Create a window and its GL context, or when headless an offscreen EGL
+     * context rendering into a pbuffer of the window size. The context shares
+     * the GL objects of the share context, if any, which must be headless too
+     * if this one is, and must outlive it.
+     */
     explicit GLFWContext(const std::string& name, bool fix_aspect,
-                         int window_width, int window_height);
+                         int window_width, int window_height,
+                         bool headless = false,
+                         GLFWContext* share = nullptr);
 
     // manages glfw window pointer lifetime
     GLFWContext(const GLFWContext&) = delete;
@@ -42,7 +51,25 @@ struct GLFWContext {
 
     void visible(bool);
 
-    GLFWwindow* window;
+    // make the GL context current on, or release it from, the calling thread
+    void make_current();
+    void release_current();
+    bool is_current() const;
+
+    void swap_buffers();
+
+    // run the input callbacks, a no-op when headless
+    void poll_events();
+
+    // seconds since the context was created
+    double time() const;
+
+    // nullptr when headless
+    GLFWwindow* window{nullptr};
+
+    // offscreen context, when headless
+    struct Headless;
+    std::unique_ptr<Headless> headless;
 
     // state set by GLFW callbacks
     WindowCtx window_context;
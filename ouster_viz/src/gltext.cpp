@@ -3,8 +3,61 @@
  * All rights reserved.
  */
 
+#include <algorithm>
+
 #include "glfw.h"
 
 #define GLT_IMPLEMENTATION
 #define GLT_MANUAL_VIEWPORT
 #include "gltext.h"
+
+#include <string>
+
+#include "misc.h"
+
+namespace ouster {
+namespace viz {
+namespace impl {
+
+GLuint glyph_atlas_texture() { return _gltText2DFontTexture; }
+
+// same layout as _gltUpdateBuffers, without the buffers
+void make_glyph_run(const std::string& text, GlyphRun& run) {
+    run.vertices.clear();
+    run.width = 0.0f;
+    run.height = 0.0f;
+    if (text.empty()) return;
+
+    const GLfloat h = (GLfloat)_gltFontGlyphHeight;
+    GLfloat x = 0.0f;
+    GLfloat y = 0.0f;
+    for (char c : text) {
+        if (c == '\n' || c == '\r') {
+            run.width = std::max(run.width, x);
+            x = 0.0f;
+            if (c == '\n') y += h;
+            continue;
+        }
+        if (!gltIsCharacterSupported(c)) continue;
+        const _GLTglyph& glyph = _gltFontGlyphs2[c - _gltFontGlyphMinChar];
+        const GLfloat w = (GLfloat)glyph.w;
+        if (glyph.drawable) {
+            const GLfloat quad[6][4] = {
+                {x, y, glyph.u1, glyph.v1},
+                {x + w, y + h, glyph.u2, glyph.v2},
+                {x + w, y, glyph.u2, glyph.v1},
+                {x, y, glyph.u1, glyph.v1},
+                {x, y + h, glyph.u1, glyph.v2},
+                {x + w, y + h, glyph.u2, glyph.v2}};
+            run.vertices.insert(run.vertices.end(), &quad[0][0],
+                                &quad[0][0] + 24);
+        }
+        x += w;
+    }
+    run.width = std::max(run.width, x);
+    run.height = (GLfloat)(gltCountNewLines(text.c_str()) + 1) * h;
+}
+
+}  // namespace impl
+}  // namespace viz
+}  // namespace ouster
@@ -27,6 +27,82 @@ GLuint GLImage::mask_id;
 GLuint GLImage::palette_id;
 GLuint GLImage::use_palette_id;
 
+namespace {
+
+/*
+ * Sized internal format of a texture of the given channels and bytes each
+ */
+GLenum internal_format_of(size_t channels, size_t bytes) {
+    switch (bytes) {
+        case 1:
+            return channels == 1 ? GL_R8 : channels == 3 ? GL_RGB8 : GL_RGBA8;
+        case 2:
+            return channels == 1 ? GL_R16
+                   : channels == 3 ? GL_RGB16
+                                   : GL_RGBA16;
+        default:
+            return channels == 1   ? GL_R32F
+                   : channels == 3 ? GL_RGB32F
+                                   : GL_RGBA32F;
+    }
+}
+
+}  // namespace
+
+GLStreamedTexture::GLStreamedTexture() {
+    glGenBuffers(1, &pbo_id);
+    const GLfloat init[4] = {0, 0, 0, 0};
+    upload(init, 1, 1, 4, sizeof(GLfloat));
+}
+
+GLStreamedTexture::~GLStreamedTexture() {
+    glDeleteBuffers(1, &pbo_id);
+    glDeleteTextures(1, &texture_id);
+}
+
+void GLStreamedTexture::upload(const void* data, size_t w, size_t h,
+                               size_t channels, size_t bytes) {
+    const GLenum internal = internal_format_of(channels, bytes);
+    const GLenum format =
+        channels == 1 ? GL_RED : channels == 3 ? GL_RGB : GL_RGBA;
+    const GLenum type = bytes == 1   ? GL_UNSIGNED_BYTE
+                        : bytes == 2 ? GL_UNSIGNED_SHORT
+                                     : GL_FLOAT;
+
+    // immutable storage can't be resized: replace the texture
+    if (w != width || h != height || internal != internal_format) {
+        glDeleteTextures(1, &texture_id);
+        glGenTextures(1, &texture_id);
+        glBindTexture(GL_TEXTURE_2D, texture_id);
+        if (GLAD_GL_ARB_texture_storage) {
+            glTexStorage2D(GL_TEXTURE_2D, 1, internal, w, h);
+        } else {
+            glTexImage2D(GL_TEXTURE_2D, 0, internal, w, h, 0, format, type,
+                         nullptr);
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        width = w;
+        height = h;
+        internal_format = internal;
+    } else {
+        glBindTexture(GL_TEXTURE_2D, texture_id);
+    }
+
+    // orphan the previous contents of the buffer, which may still be read
+    const size_t size = w * h * channels * bytes;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo_id);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, data, GL_STREAM_DRAW);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, format, type, nullptr);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
 GLImage::GLImage() {
     if (!GLImage::initialized)
         throw std::logic_error("GLCloud not initialized");
@@ -39,16 +115,10 @@ GLImage::GLImage() {
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, 6 * sizeof(GLubyte), indices,
                  GL_STATIC_DRAW);
 
-    GLuint textures[3];
-    glGenTextures(3, textures);
-    image_texture_id = textures[0];
-    mask_texture_id = textures[1];
-    palette_texture_id = textures[2];
+    glGenTextures(1, &palette_texture_id);
 
     // initialize textures
     GLfloat init[4] = {0, 0, 0, 0};
-    load_texture(init, 1, 1, image_texture_id, GL_RED, GL_RED);
-    load_texture(init, 1, 1, mask_texture_id, GL_RGBA, GL_RGBA);
     load_texture(init, 1, 1, palette_texture_id, GL_RGBA, GL_RGBA);
 }
 
@@ -56,8 +126,6 @@ GLImage::GLImage(const Image& /*image*/) : GLImage{} {}
 
 GLImage::~GLImage() {
     glDeleteBuffers(2, vertexbuffers.data());
-    glDeleteTextures(1, &image_texture_id);
-    glDeleteTextures(1, &mask_texture_id);
     glDeleteTextures(1, &palette_texture_id);
 }
 
@@ -77,25 +145,25 @@ void GLImage::draw(const WindowCtx& ctx, const CameraData&, Image& image) {
     glUniform1i(palette_id, 2);
 
     glActiveTexture(GL_TEXTURE0);
-    if (image.image_changed_) {
-        load_texture(image.image_data_.data(), image.image_width_,
-                     image.image_height_, image_texture_id, GL_RGBA, GL_RGBA,
-                     GL_FLOAT);
-        image.image_changed_ = false;
+    if (image.image_changed_ && image.image_data_) {
+        image_texture.upload(image.image_data_->data(), image.image_width_,
+                             image.image_height_, image.image_channels_,
+                             image.image_bytes_);
     }
-    glBindTexture(GL_TEXTURE_2D, image_texture_id);
+    image.image_changed_ = false;
+    glBindTexture(GL_TEXTURE_2D, image_texture.id());
 
     // put the shader into mono or rgb mode
     glUniform1i(mono_id, image.mono_ ? 1 : 0);
     glUniform1i(use_palette_id, image.use_palette_ ? 1 : 0);
 
     glActiveTexture(GL_TEXTURE1);
-    if (image.mask_changed_) {
-        load_texture(image.mask_data_.data(), image.mask_width_,
-                     image.mask_height_, mask_texture_id, GL_RGBA, GL_RGBA);
-        image.mask_changed_ = false;
+    if (image.mask_changed_ && image.mask_data_) {
+        mask_texture.upload(image.mask_data_->data(), image.mask_width_,
+                            image.mask_height_, 4, sizeof(float));
     }
-    glBindTexture(GL_TEXTURE_2D, mask_texture_id);
+    image.mask_changed_ = false;
+    glBindTexture(GL_TEXTURE_2D, mask_texture.id());
 
     glActiveTexture(GL_TEXTURE2);
     if (image.palette_changed_) {
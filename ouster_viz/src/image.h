@@ -6,6 +6,7 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 
 #include "camera.h"
 #include "glfw.h"
@@ -15,6 +16,36 @@ namespace ouster {
 namespace viz {
 namespace impl {
 
+/*
+ * A texture of fixed storage, allocated only when its size or format
+ * changes, and updated through a pixel unpack buffer so that the transfer
+ * doesn't wait for the texture to be unused
+ */
+class GLStreamedTexture {
+    GLuint texture_id{0};
+    GLuint pbo_id{0};
+    size_t width{0};
+    size_t height{0};
+    GLenum internal_format{0};
+
+   public:
+    GLStreamedTexture();
+
+    GLStreamedTexture(const GLStreamedTexture&) = delete;
+    GLStreamedTexture& operator=(const GLStreamedTexture&) = delete;
+
+    ~GLStreamedTexture();
+
+    /*
+     * Upload an image of 1, 3 or 4 channels of 1 (uint8), 2 (uint16) or 4
+     * (float) bytes each, leaving the texture bound
+     */
+    void upload(const void* data, size_t width, size_t height,
+                size_t channels, size_t bytes);
+
+    GLuint id() const { return texture_id; }
+};
+
 /*
  * Manages opengl state for drawing a point cloud
  *
@@ -37,8 +68,8 @@ class GLImage {
 
     // per-image gl state
     std::array<GLuint, 2> vertexbuffers;
-    GLuint image_texture_id{0};
-    GLuint mask_texture_id{0};
+    GLStreamedTexture image_texture;
+    GLStreamedTexture mask_texture;
     GLuint palette_texture_id{0};
     GLuint image_index_id{0};
 
@@ -0,0 +1,585 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/lidar_scan_viz.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "ouster/field_ops.h"
+#include "ouster/image_processing.h"
+#include "ouster/threads.h"
+#include "ouster/version.h"
+
+namespace ouster {
+namespace viz {
+
+namespace {
+
+using sensor::ChanFieldType;
+
+// fields shown as the second return of a mode of the first
+const std::map<std::string, std::string> second_return_fields = {
+    {"RANGE", "RANGE2"},
+    {"SIGNAL", "SIGNAL2"},
+    {"REFLECTIVITY", "REFLECTIVITY2"},
+    {"FLAGS", "FLAGS2"}};
+
+bool is_unsigned(ChanFieldType tag) {
+    return tag == ChanFieldType::UINT8 || tag == ChanFieldType::UINT16 ||
+           tag == ChanFieldType::UINT32;
+}
+
+// keys of the pixels of a scan for the clouds, or of the destaggered pixels
+// for the images
+struct Keys {
+    enum Kind { NONE, FLOAT, RGB, RAW };
+    Kind kind{NONE};
+    std::vector<float> values;  // h * w, or h * w * 3 for RGB
+    std::vector<uint8_t> raw;   // h * w unsigned values, for RAW
+    ChanFieldType raw_tag{ChanFieldType::VOID};
+    bool calref{false};
+};
+
+std::vector<float> calref_image_palette() {
+    std::vector<float> palette(calref_palette[0],
+                               calref_palette[0] + 3 * calref_n);
+    // the darkest color stands out from the background of the window
+    std::fill(palette.begin(), palette.begin() + 3, 0.1f);
+    return palette;
+}
+
+// like destagger_to, for pixels of several channels
+void destagger_channels(const float* in, float* out, size_t h, size_t w,
+                        size_t channels, const std::vector<int>& shifts) {
+    const size_t row = w * channels;
+    for (size_t u = 0; u < h; u++) {
+        const size_t offset =
+            ouster::impl::destagger_offset(shifts, u, w, false) * channels;
+        const float* src = in + u * row;
+        float* dst = out + u * row;
+        std::memcpy(dst + offset, src, (row - offset) * sizeof(float));
+        std::memcpy(dst, src + (row - offset), offset * sizeof(float));
+    }
+}
+
+}  // namespace
+
+bool default_view_mode(const sensor::sensor_info& info, const LidarScan& scan,
+                       const std::string& field, FieldViewMode& mode) {
+    if (!scan.has_field(field) || field == "FLAGS" || field == "FLAGS2") {
+        return false;
+    }
+    for (const auto& f : second_return_fields) {
+        if (f.second == field) return false;
+    }
+    const Field& f = scan.field(field);
+    if (f.field_class() != FieldClass::PIXEL_FIELD) return false;
+
+    mode = FieldViewMode{};
+    mode.name = field;
+    mode.fields = {field};
+    const auto shape = f.shape();
+    if (shape.size() == 3 && shape[2] == 3) {
+        mode.rgb = true;
+        mode.auto_exposure = false;
+        return true;
+    }
+    if (shape.size() != 2) return false;
+
+    auto second = second_return_fields.find(field);
+    if (second != second_return_fields.end()) {
+        mode.fields.push_back(second->second);
+    }
+    if (field == "REFLECTIVITY") {
+        // reflectivity is calibrated from firmware 2.1 on
+        if (info.get_version() >= util::version_from_string("v2.1.0")) {
+            mode.auto_exposure = false;
+            mode.scale = 1.0f / 255.0f;
+            mode.calref_palette = true;
+        }
+    } else if (field == "NEAR_IR") {
+        mode.beam_uniformity = true;
+    } else {
+        mode.gpu_keys = true;
+    }
+    return true;
+}
+
+struct LidarScanViz::Sensor {
+    struct Frame {
+        bool visible{false};
+        std::vector<uint32_t> range[num_clouds];
+        std::vector<float> poses;
+        Keys clouds[num_clouds];
+        Keys images[num_images];
+    };
+
+    struct ModeState {
+        std::unique_ptr<AutoExposure> ae;
+        std::unique_ptr<BeamUniformityCorrector> buc;
+    };
+
+    size_t index{0};
+    sensor::sensor_info info;
+    size_t w{0};
+    size_t h{0};
+    std::shared_ptr<Cloud> clouds[num_clouds];
+    std::shared_ptr<Image> images[num_images];
+
+    // by name, guarded by the modes mutex of the model
+    std::map<std::string, FieldViewMode> modes;
+
+    // state of the thread
+    std::map<std::string, ModeState> states;
+    Frame work;
+    std::map<std::pair<std::string, size_t>, Keys> cache;
+    sensor::LatencyHistogram latency;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::shared_ptr<const LidarScan> pending;
+    bool has_pending{false};
+    bool busy{false};
+    Frame ready;
+    bool has_ready{false};
+    Frame applying;
+    std::thread thread;
+};
+
+LidarScanViz::LidarScanViz(const std::vector<sensor::sensor_info>& sensors)
+    : cloud_mode_("REFLECTIVITY"), image_modes_{"REFLECTIVITY", "NEAR_IR"} {
+    for (size_t i = 0; i < sensors.size(); i++) {
+        auto s = std::make_unique<Sensor>();
+        s->index = i;
+        s->info = sensors[i];
+        s->w = sensors[i].format.columns_per_frame;
+        s->h = sensors[i].format.pixels_per_column;
+        const auto lut = shared_xyz_lut_f(sensors[i], true);
+        for (auto& cloud : s->clouds) {
+            cloud = std::make_shared<Cloud>(s->w, s->h, lut->direction.data(),
+                                            lut->offset.data());
+        }
+        for (auto& image : s->images) image = std::make_shared<Image>();
+        sensors_.push_back(std::move(s));
+    }
+    for (auto& s : sensors_) {
+        Sensor* sensor = s.get();
+        s->thread = start_thread("ouster-viz-" + std::to_string(s->index),
+                                 [this, sensor]() { run(*sensor); });
+    }
+}
+
+LidarScanViz::~LidarScanViz() {
+    running_ = false;
+    for (auto& s : sensors_) {
+        {
+            std::lock_guard<std::mutex> lock(s->mtx);
+        }
+        s->cv.notify_all();
+        if (s->thread.joinable()) s->thread.join();
+    }
+}
+
+size_t LidarScanViz::sensor_count() const { return sensors_.size(); }
+
+std::shared_ptr<Cloud> LidarScanViz::cloud(size_t sensor,
+                                           size_t return_num) const {
+    if (sensor >= sensors_.size() || return_num >= num_clouds) {
+        throw std::out_of_range("LidarScanViz: no such cloud");
+    }
+    return sensors_[sensor]->clouds[return_num];
+}
+
+std::shared_ptr<Image> LidarScanViz::image(size_t sensor, size_t index) const {
+    if (sensor >= sensors_.size() || index >= num_images) {
+        throw std::out_of_range("LidarScanViz: no such image");
+    }
+    return sensors_[sensor]->images[index];
+}
+
+void LidarScanViz::add_mode(const FieldViewMode& mode) {
+    if (mode.name.empty() || mode.fields.empty()) {
+        throw std::invalid_argument(
+            "LidarScanViz: a view mode needs a name and a field");
+    }
+    std::lock_guard<std::mutex> lock(modes_mtx_);
+    for (auto& s : sensors_) s->modes[mode.name] = mode;
+}
+
+std::vector<std::string> LidarScanViz::cloud_modes() const {
+    std::set<std::string> names;
+    std::lock_guard<std::mutex> lock(modes_mtx_);
+    for (const auto& s : sensors_) {
+        for (const auto& m : s->modes) names.insert(m.first);
+    }
+    return {names.begin(), names.end()};
+}
+
+std::vector<std::string> LidarScanViz::image_modes() const {
+    std::set<std::string> names;
+    std::lock_guard<std::mutex> lock(modes_mtx_);
+    for (const auto& s : sensors_) {
+        for (const auto& m : s->modes) {
+            const auto& mode = m.second;
+            const auto& n =
+                mode.image_names.empty() ? mode.fields : mode.image_names;
+            names.insert(n.begin(), n.end());
+        }
+    }
+    return {names.begin(), names.end()};
+}
+
+void LidarScanViz::set_cloud_mode(const std::string& name) {
+    std::lock_guard<std::mutex> lock(modes_mtx_);
+    cloud_mode_ = name;
+}
+
+std::string LidarScanViz::cloud_mode() const {
+    std::lock_guard<std::mutex> lock(modes_mtx_);
+    return cloud_mode_;
+}
+
+void LidarScanViz::set_image_mode(size_t index, const std::string& name) {
+    if (index >= num_images) {
+        throw std::out_of_range("LidarScanViz: no such image");
+    }
+    std::lock_guard<std::mutex> lock(modes_mtx_);
+    image_modes_[index] = name;
+}
+
+std::string LidarScanViz::image_mode(size_t index) const {
+    if (index >= num_images) {
+        throw std::out_of_range("LidarScanViz: no such image");
+    }
+    std::lock_guard<std::mutex> lock(modes_mtx_);
+    return image_modes_[index];
+}
+
+void LidarScanViz::submit(
+    const std::vector<std::shared_ptr<const LidarScan>>& scans) {
+    if (scans.size() != sensors_.size()) {
+        throw std::invalid_argument(
+            "LidarScanViz: expected a scan per sensor, got " +
+            std::to_string(scans.size()));
+    }
+    submitted_++;
+    for (size_t i = 0; i < scans.size(); i++) {
+        auto& s = *sensors_[i];
+        {
+            std::lock_guard<std::mutex> lock(s.mtx);
+            if (s.has_pending) skipped_++;
+            s.pending = scans[i];
+            s.has_pending = true;
+        }
+        s.cv.notify_all();
+    }
+}
+
+bool LidarScanViz::apply() {
+    bool applied = false;
+    for (auto& s : sensors_) {
+        {
+            std::lock_guard<std::mutex> lock(s->mtx);
+            if (!s->has_ready) continue;
+            std::swap(s->ready, s->applying);
+            s->has_ready = false;
+        }
+        applied = true;
+        applied_++;
+        const auto& f = s->applying;
+        for (size_t r = 0; r < num_clouds; r++) {
+            auto& cloud = *s->clouds[r];
+            // a cloud without a scan is hidden by zero ranges
+            cloud.set_range(f.range[r].data());
+            if (!f.visible) continue;
+            cloud.set_column_poses(f.poses.data());
+            const auto& keys = f.clouds[r];
+            if (keys.kind == Keys::FLOAT) {
+                cloud.set_key(keys.values.data());
+            } else if (keys.kind == Keys::RGB) {
+                cloud.set_key_rgb(keys.values.data());
+            } else if (keys.kind == Keys::RAW) {
+                switch (keys.raw_tag) {
+                    case ChanFieldType::UINT8:
+                        cloud.set_key_raw(keys.raw.data());
+                        break;
+                    case ChanFieldType::UINT16:
+                        cloud.set_key_raw(reinterpret_cast<const uint16_t*>(
+                            keys.raw.data()));
+                        break;
+                    default:
+                        cloud.set_key_raw(reinterpret_cast<const uint32_t*>(
+                            keys.raw.data()));
+                        break;
+                }
+            }
+        }
+        for (size_t i = 0; i < num_images; i++) {
+            auto& image = *s->images[i];
+            const auto& keys = f.images[i];
+            if (keys.calref) {
+                static const auto palette = calref_image_palette();
+                image.set_palette(palette.data(), calref_n);
+            } else {
+                image.clear_palette();
+            }
+            if (keys.kind == Keys::RGB) {
+                image.set_image_rgb(s->w, s->h, keys.values.data());
+            } else {
+                image.set_image(s->w, s->h, keys.values.data());
+            }
+        }
+    }
+    return applied;
+}
+
+bool LidarScanViz::wait(double timeout_sec) {
+    const auto deadline =
+        std::chrono::steady_clock::now() +
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(std::max(timeout_sec, 0.0)));
+    for (auto& s : sensors_) {
+        std::unique_lock<std::mutex> lock(s->mtx);
+        auto idle = [&s]() { return !s->has_pending && !s->busy; };
+        if (timeout_sec < 0) {
+            s->cv.wait(lock, idle);
+        } else if (!s->cv.wait_until(lock, deadline, idle)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void LidarScanViz::update(
+    const std::vector<std::shared_ptr<const LidarScan>>& scans) {
+    submit(scans);
+    wait();
+    apply();
+}
+
+LidarScanVizStats LidarScanViz::stats() const {
+    LidarScanVizStats res;
+    res.submitted = submitted_;
+    res.computed = computed_;
+    res.skipped = skipped_;
+    res.applied = applied_;
+    sensor::LatencyHistogram all;
+    for (const auto& s : sensors_) all.add(s->latency);
+    res.compute = all.summary();
+    return res;
+}
+
+void LidarScanViz::run(Sensor& s) {
+    while (true) {
+        std::shared_ptr<const LidarScan> scan;
+        {
+            std::unique_lock<std::mutex> lock(s.mtx);
+            s.cv.wait(lock, [&]() { return !running_ || s.has_pending; });
+            if (!running_) return;
+            scan = std::move(s.pending);
+            s.has_pending = false;
+            s.busy = true;
+        }
+        const auto t0 = std::chrono::steady_clock::now();
+        try {
+            compute(s, scan);
+        } catch (const std::exception&) {
+            // a scan not matching its sensor hides the sensor
+            compute(s, nullptr);
+        }
+        s.latency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now() - t0)
+                             .count());
+        computed_++;
+        {
+            std::lock_guard<std::mutex> lock(s.mtx);
+            std::swap(s.work, s.ready);
+            s.has_ready = true;
+            s.busy = false;
+        }
+        s.cv.notify_all();
+    }
+}
+
+void LidarScanViz::compute(Sensor& s,
+                           const std::shared_ptr<const LidarScan>& scan) {
+    auto& f = s.work;
+    const size_t n = s.w * s.h;
+    for (auto& range : f.range) range.assign(n, 0);
+    f.visible = false;
+    for (auto& keys : f.images) {
+        keys.kind = Keys::FLOAT;
+        keys.values.assign(n, 0.0f);
+        keys.calref = false;
+    }
+    if (!scan) return;
+    if (scan->w != s.w || scan->h != s.h) {
+        throw std::invalid_argument("LidarScanViz: scan size mismatch");
+    }
+
+    // pick up modes for new fields and take the selection
+    FieldViewMode cloud_mode;
+    bool has_cloud_mode = false;
+    struct ImageSel {
+        bool found{false};
+        FieldViewMode mode;
+        size_t return_num{0};
+    } image_sel[num_images];
+    {
+        std::lock_guard<std::mutex> lock(modes_mtx_);
+        for (const auto& field : scan->fields()) {
+            bool known = false;
+            for (const auto& m : s.modes) {
+                const auto& names = m.second.image_names.empty()
+                                        ? m.second.fields
+                                        : m.second.image_names;
+                if (std::find(names.begin(), names.end(), field.first) !=
+                    names.end()) {
+                    known = true;
+                    break;
+                }
+            }
+            FieldViewMode mode;
+            if (!known && default_view_mode(s.info, *scan, field.first, mode)) {
+                s.modes.emplace(mode.name, mode);
+            }
+        }
+        auto it = s.modes.find(cloud_mode_);
+        if (it != s.modes.end()) {
+            cloud_mode = it->second;
+            has_cloud_mode = true;
+        }
+        for (size_t i = 0; i < num_images; i++) {
+            for (const auto& m : s.modes) {
+                const auto& names = m.second.image_names.empty()
+                                        ? m.second.fields
+                                        : m.second.image_names;
+                auto at =
+                    std::find(names.begin(), names.end(), image_modes_[i]);
+                if (at != names.end()) {
+                    image_sel[i].found = true;
+                    image_sel[i].mode = m.second;
+                    image_sel[i].return_num = at - names.begin();
+                    break;
+                }
+            }
+        }
+    }
+
+    auto enabled = [&](const FieldViewMode& mode, size_t r) {
+        return r < mode.fields.size() && scan->has_field(mode.fields[r]);
+    };
+
+    // the keys of a mode and return, staggered, computed once per frame
+    s.cache.clear();
+    auto keys_of = [&](const FieldViewMode& mode, size_t r) -> const Keys& {
+        auto& keys = s.cache[{mode.name, r}];
+        if (keys.kind != Keys::NONE) return keys;
+        const Field& field = scan->field(mode.fields[r]);
+        if (mode.rgb) {
+            keys.kind = Keys::RGB;
+            keys.values.resize(n * 3);
+            FieldView out(keys.values.data(), fd_array<float>(s.h, s.w, 3));
+            field_ops::convert(field, out);
+            float scale = 1.0f;
+            if (field.tag() == ChanFieldType::UINT8) scale = 1.0f / 255.0f;
+            if (field.tag() == ChanFieldType::UINT16) scale = 1.0f / 65535.0f;
+            for (auto& v : keys.values) {
+                v = std::min(std::max(v * scale, 0.0f), 1.0f);
+            }
+            return keys;
+        }
+        keys.kind = Keys::FLOAT;
+        keys.values.resize(n);
+        FieldView out(keys.values.data(), fd_array<float>(s.h, s.w));
+        field_ops::convert(field, out);
+        Eigen::Map<img_t<float>> img(keys.values.data(), s.h, s.w);
+        auto& state = s.states[mode.name];
+        if (mode.beam_uniformity) {
+            if (!state.buc) {
+                state.buc = std::make_unique<BeamUniformityCorrector>();
+            }
+            (*state.buc)(img);
+        }
+        if (mode.scale > 0) {
+            img = (img * mode.scale).min(1.0f);
+        } else if (mode.auto_exposure) {
+            if (!state.ae) state.ae = std::make_unique<AutoExposure>();
+            (*state.ae)(img, r == 0);
+        } else {
+            const float max = img.maxCoeff();
+            if (max > 0) img /= max;
+        }
+        return keys;
+    };
+
+    f.visible = true;
+    const char* range_fields[num_clouds] = {"RANGE", "RANGE2"};
+    for (size_t r = 0; r < num_clouds; r++) {
+        if (!scan->has_field(range_fields[r])) continue;
+        FieldView out(f.range[r].data(), fd_array<uint32_t>(s.h, s.w));
+        field_ops::convert(scan->field(range_fields[r]), out);
+    }
+
+    // the (w, 4, 4) row major poses, as the column major (4, 4, w) array of
+    // Cloud::set_column_poses
+    f.poses.resize(s.w * 16);
+    const double* poses = scan->pose().get<double>();
+    for (size_t v = 0; v < s.w; v++) {
+        for (size_t i = 0; i < 4; i++) {
+            for (size_t j = 0; j < 4; j++) {
+                f.poses[v + s.w * (i + 4 * j)] =
+                    static_cast<float>(poses[v * 16 + i * 4 + j]);
+            }
+        }
+    }
+
+    for (size_t r = 0; r < num_clouds; r++) {
+        auto& keys = f.clouds[r];
+        keys.kind = Keys::NONE;
+        if (!has_cloud_mode) continue;
+        // the second cloud shows the first return of modes without a second
+        const size_t used = enabled(cloud_mode, r) ? r : 0;
+        if (!enabled(cloud_mode, used)) continue;
+        const Field& field = scan->field(cloud_mode.fields[used]);
+        if (cloud_mode.gpu_keys && cloud_mode.auto_exposure &&
+            !cloud_mode.beam_uniformity && cloud_mode.scale <= 0 &&
+            is_unsigned(field.tag())) {
+            keys.kind = Keys::RAW;
+            keys.raw_tag = field.tag();
+            keys.raw.resize(field.bytes());
+            std::memcpy(keys.raw.data(), field.get(), field.bytes());
+            continue;
+        }
+        const Keys& computed = keys_of(cloud_mode, used);
+        keys.kind = computed.kind;
+        keys.values = computed.values;
+    }
+
+    const auto& shifts = s.info.format.pixel_shift_by_row;
+    for (size_t i = 0; i < num_images; i++) {
+        auto& keys = f.images[i];
+        const auto& sel = image_sel[i];
+        if (!sel.found || !enabled(sel.mode, sel.return_num)) continue;
+        const Keys& computed = keys_of(sel.mode, sel.return_num);
+        const size_t channels = computed.kind == Keys::RGB ? 3 : 1;
+        keys.kind = computed.kind;
+        keys.values.resize(n * channels);
+        destagger_channels(computed.values.data(), keys.values.data(), s.h,
+                           s.w, channels, shifts);
+        keys.calref = sel.mode.calref_palette;
+    }
+}
+
+}  // namespace viz
+}  // namespace ouster
@@ -0,0 +1,190 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/map_accumulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace ouster {
+namespace viz {
+
+namespace {
+
+/*
+ * Pack the coordinates of the voxel of a point in 21 bits each
+ */
+uint64_t voxel_key(const double* p, float voxel_size) {
+    uint64_t key = 0;
+    for (size_t k = 0; k < 3; k++) {
+        const auto v = static_cast<int64_t>(std::floor(p[k] / voxel_size));
+        key = (key << 21) | (static_cast<uint64_t>(v) & 0x1FFFFF);
+    }
+    return key;
+}
+
+}  // namespace
+
+MapAccumulator::MapAccumulator(const std::vector<sensor::sensor_info>& sensors,
+                               const MapAccumulatorConfig& config)
+    : config_(config),
+      cloud_(std::make_shared<LodCloud>(config.chunk_size,
+                                        config.point_budget)) {
+    if (!(config_.select_ratio > 0.0) || !(config_.voxel_size >= 0.0f)) {
+        throw std::invalid_argument("MapAccumulator: invalid options");
+    }
+    for (const auto& info : sensors) {
+        luts_.push_back(shared_xyz_lut(info, true));
+        sizes_.emplace_back(info.format.columns_per_frame,
+                            info.format.pixels_per_column);
+    }
+}
+
+void MapAccumulator::update(size_t sensor_idx, const LidarScan& scan,
+                            const std::map<std::string, img_t<float>>& keys) {
+    if (sensor_idx >= luts_.size()) {
+        throw std::invalid_argument("MapAccumulator: invalid sensor index");
+    }
+    const size_t w = sizes_[sensor_idx].first;
+    const size_t h = sizes_[sensor_idx].second;
+    if (scan.w != w || scan.h != h) {
+        throw std::invalid_argument(
+            "MapAccumulator: scan doesn't match the sensor");
+    }
+    for (const auto& kv : keys) {
+        if (static_cast<size_t>(kv.second.rows()) != h ||
+            static_cast<size_t>(kv.second.cols()) != w) {
+            throw std::invalid_argument("MapAccumulator: key image '" +
+                                        kv.first +
+                                        "' doesn't match the sensor");
+        }
+    }
+
+    // when the map is full, either ignore new points or make room for them
+    size_t room = std::numeric_limits<size_t>::max();
+    if (config_.max_points > 0 && !config_.overflow_from_start) {
+        if (n_ >= config_.max_points) return;
+        room = config_.max_points - n_;
+    }
+
+    // select the pixels, with Bernoulli trials over the valid ones by skipping
+    // geometrically distributed runs of them
+    if (!scan.has_field(sensor::ChanField::RANGE)) {
+        throw std::invalid_argument("MapAccumulator: scan has no RANGE field");
+    }
+    Eigen::Ref<const img_t<uint32_t>> range =
+        scan.field<uint32_t>(sensor::ChanField::RANGE);
+    selected_.setZero(h, w);
+    const size_t n_pixels = w * h;
+    const uint32_t* rng = range.data();
+    uint32_t* sel = selected_.data();
+    if (config_.select_ratio >= 1.0) {
+        std::copy(rng, rng + n_pixels, sel);
+    } else {
+        std::geometric_distribution<size_t> skip(config_.select_ratio);
+        size_t countdown = skip(rng_);
+        for (size_t ix = 0; ix < n_pixels; ix++) {
+            if (rng[ix] == 0) continue;
+            if (countdown-- == 0) {
+                sel[ix] = rng[ix];
+                countdown = skip(rng_);
+            }
+        }
+    }
+
+    // project and dewarp the selected pixels only, in pixel order
+    if (static_cast<size_t>(points_.rows()) < n_pixels) {
+        points_.resize(n_pixels, 3);
+    }
+    Eigen::Map<const pose_util::Poses> poses(scan.pose().get<double>(), w,
+                                             16);
+    const size_t n = pose_util::cartesian_dewarp(
+        points_, selected_, *luts_[sensor_idx], poses,
+        ouster::mat4d::Identity(), true);
+
+    // drop the oldest scans by a quarter of the map at a time, so that the
+    // cloud is rebuilt only then
+    bool dropped = false;
+    if (config_.max_points > 0 && config_.overflow_from_start &&
+        n_ + n > config_.max_points) {
+        const size_t target = config_.max_points - config_.max_points / 4;
+        while (!entries_.empty() && n_ + n > target) {
+            const Entry& oldest = entries_.front();
+            n_ -= oldest.xyz.size() / 3;
+            for (uint64_t voxel : oldest.voxels) voxels_.erase(voxel);
+            entries_.pop_front();
+            dropped = true;
+        }
+        room = config_.max_points - std::min(n_, config_.max_points);
+    }
+
+    Entry entry;
+    for (const auto& kv : keys) entry.keys[kv.first].reserve(n);
+    entry.xyz.reserve(3 * n);
+    size_t j = 0;
+    for (size_t ix = 0; ix < n_pixels && j < n; ix++) {
+        if (sel[ix] == 0) continue;
+        const double* p = points_.row(j++).data();
+        if (config_.voxel_size > 0.0f) {
+            const uint64_t voxel = voxel_key(p, config_.voxel_size);
+            if (!voxels_.insert(voxel).second) continue;
+            entry.voxels.push_back(voxel);
+        }
+        for (size_t k = 0; k < 3; k++) {
+            entry.xyz.push_back(static_cast<float>(p[k]));
+        }
+        for (const auto& kv : keys) {
+            entry.keys[kv.first].push_back(kv.second.data()[ix]);
+        }
+        if (entry.xyz.size() / 3 >= room) break;
+    }
+    const size_t added = entry.xyz.size() / 3;
+    if (added > 0) {
+        n_ += added;
+        entries_.push_back(std::move(entry));
+    }
+    if (dropped) {
+        rebuild_cloud();
+    } else if (added > 0) {
+        add_to_cloud(entries_.back());
+    }
+}
+
+void MapAccumulator::add_to_cloud(const Entry& entry) {
+    const size_t n = entry.xyz.size() / 3;
+    auto it = entry.keys.find(key_name_);
+    cloud_->add_points(entry.xyz.data(),
+                       it != entry.keys.end() ? it->second.data() : nullptr,
+                       n);
+}
+
+void MapAccumulator::rebuild_cloud() {
+    cloud_->clear_points();
+    for (const auto& entry : entries_) add_to_cloud(entry);
+}
+
+void MapAccumulator::set_key_name(const std::string& name) {
+    if (name == key_name_) return;
+    key_name_ = name;
+    rebuild_cloud();
+}
+
+const std::string& MapAccumulator::key_name() const { return key_name_; }
+
+void MapAccumulator::clear() {
+    entries_.clear();
+    voxels_.clear();
+    n_ = 0;
+    cloud_->clear_points();
+}
+
+size_t MapAccumulator::size() const { return n_; }
+
+std::shared_ptr<LodCloud> MapAccumulator::cloud() const { return cloud_; }
+
+}  // namespace viz
+}  // namespace ouster
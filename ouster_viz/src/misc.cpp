@@ -7,7 +7,7 @@
 
 #include <Eigen/Core>
 #include <Eigen/Geometry>
-#include <cassert>
+#include <algorithm>
 #include <cmath>
 #include <stdexcept>
 #include <string>
@@ -255,19 +255,29 @@ void GLCuboid::endDraw() {
 /*
  * Label3d
  */
-GLLabel::GLLabel() : gltext{gltCreateText()}, text_position{0, 0, 0} {
-    assert(gltext != GLT_NULL);
-}
+bool GLLabel::initialized = false;
+GLuint GLLabel::label_program_id;
+GLuint GLLabel::label_position_id;
+GLuint GLLabel::label_uv_id;
+GLuint GLLabel::label_rgba_id;
+GLuint GLLabel::label_glyphs_id;
+GLuint GLLabel::batch_buffer;
+std::vector<GLfloat> GLLabel::batch;
+
+// clip position, uv and rgba of a vertex of the batch
+constexpr size_t label_vertex_size = 10;
+
+GLLabel::GLLabel() : text_position{0, 0, 0} {}
 
 // for Indexed<T, U>
 GLLabel::GLLabel(const Label&) : GLLabel{} {}
 
-GLLabel::~GLLabel() { gltDeleteText(gltext); }
+GLLabel::~GLLabel() {}
 
 void GLLabel::draw(const WindowCtx& ctx, const CameraData& camera,
                    Label& label) {
     if (label.text_changed_) {
-        gltSetText(gltext, label.text_.c_str());
+        make_glyph_run(label.text_, run);
         label.text_changed_ = false;
     }
 
@@ -290,8 +300,9 @@ void GLLabel::draw(const WindowCtx& ctx, const CameraData& camera,
         label.rgba_changed_ = false;
     }
 
-    gltColor(rgba[0], rgba[1], rgba[2], rgba[3]);
+    if (run.vertices.empty()) return;
 
+    Eigen::Matrix4f mvp;
     if (is_3d) {
         Eigen::Matrix4d model =
             (Eigen::Translation3d{text_position.cast<double>()} *
@@ -303,10 +314,7 @@ void GLLabel::draw(const WindowCtx& ctx, const CameraData& camera,
              Eigen::Scaling(0.02 * scale))
                 .matrix();
 
-        Eigen::Matrix4f mvp =
-            (camera.proj * camera.view * camera.target * model).cast<float>();
-
-        gltDrawText(gltext, mvp.data());
+        mvp = (camera.proj * camera.view * camera.target * model).cast<float>();
     } else {
         float x = text_position.x() * ctx.viewport_width;
         float y = text_position.y() * ctx.viewport_height;
@@ -316,20 +324,97 @@ void GLLabel::draw(const WindowCtx& ctx, const CameraData& camera,
         // TODO[pb]: Also we can start using GLFW window_content_scale for this
         scale2d *= 2.0;
 #endif
-        gltDrawText2DAligned(gltext, x, y, scale2d, halign, valign);
+        // aligned like gltDrawText2DAligned
+        if (halign == GLT_RIGHT) x -= run.width * scale2d;
+        if (valign == GLT_BOTTOM) y -= run.height * scale2d;
+
+        // from pixels, y down, to the clip coordinates of the viewport like
+        // gltViewport, but for the viewport drawn to
+        const float w = ctx.viewport_width;
+        const float h = ctx.viewport_height;
+        mvp << 2 * scale2d / w, 0, 0, 2 * x / w - 1,  //
+            0, -2 * scale2d / h, 0, 1 - 2 * y / h,    //
+            0, 0, -scale2d, 0,                        //
+            0, 0, 0, 1;
     }
+
+    const size_t n = run.vertices.size() / 4;
+    const size_t offset = batch.size();
+    batch.resize(offset + n * label_vertex_size);
+    GLfloat* out = batch.data() + offset;
+    for (size_t i = 0; i < n; i++, out += label_vertex_size) {
+        const GLfloat* v = run.vertices.data() + 4 * i;
+        Eigen::Map<Eigen::Vector4f>{out} =
+            mvp.col(0) * v[0] + mvp.col(1) * v[1] + mvp.col(3);
+        out[4] = v[2];
+        out[5] = v[3];
+        std::copy(rgba.begin(), rgba.end(), out + 6);
+    }
+}
+
+bool GLLabel::in_scene(const Label& label) { return label.is_3d_; }
+
+void GLLabel::initialize() {
+    GLLabel::label_program_id =
+        load_shaders(label_vertex_shader_code, label_fragment_shader_code);
+    GLLabel::label_position_id =
+        glGetAttribLocation(label_program_id, "label_position");
+    GLLabel::label_uv_id = glGetAttribLocation(label_program_id, "label_uv");
+    GLLabel::label_rgba_id =
+        glGetAttribLocation(label_program_id, "label_rgba");
+    GLLabel::label_glyphs_id =
+        glGetUniformLocation(label_program_id, "glyphs");
+    glGenBuffers(1, &GLLabel::batch_buffer);
+    GLLabel::initialized = true;
 }
 
-void GLLabel::beginDraw() {
+void GLLabel::uninitialize() {
+    GLLabel::initialized = false;
+    glDeleteBuffers(1, &GLLabel::batch_buffer);
+    glDeleteProgram(GLLabel::label_program_id);
+}
+
+void GLLabel::beginDraw() { batch.clear(); }
+
+void GLLabel::endDraw() {
+    if (!GLLabel::initialized)
+        throw std::logic_error("GLLabel not initialized");
+    if (batch.empty()) return;
+
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glBlendEquation(GL_FUNC_ADD);
-    gltBeginDraw();
-}
 
-void GLLabel::endDraw() {
-    gltEndDraw();
+    glUseProgram(GLLabel::label_program_id);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, glyph_atlas_texture());
+    glUniform1i(GLLabel::label_glyphs_id, 0);
+
+    // orphan the buffer of the last frame rather than wait for it
+    glBindBuffer(GL_ARRAY_BUFFER, GLLabel::batch_buffer);
+    glBufferData(GL_ARRAY_BUFFER, batch.size() * sizeof(GLfloat), nullptr,
+                 GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, batch.size() * sizeof(GLfloat),
+                    batch.data());
+
+    const GLsizei stride = label_vertex_size * sizeof(GLfloat);
+    glEnableVertexAttribArray(GLLabel::label_position_id);
+    glVertexAttribPointer(GLLabel::label_position_id, 4, GL_FLOAT, GL_FALSE,
+                          stride, (void*)0);
+    glEnableVertexAttribArray(GLLabel::label_uv_id);
+    glVertexAttribPointer(GLLabel::label_uv_id, 2, GL_FLOAT, GL_FALSE, stride,
+                          (void*)(4 * sizeof(GLfloat)));
+    glEnableVertexAttribArray(GLLabel::label_rgba_id);
+    glVertexAttribPointer(GLLabel::label_rgba_id, 4, GL_FLOAT, GL_FALSE,
+                          stride, (void*)(6 * sizeof(GLfloat)));
+
+    glDrawArrays(GL_TRIANGLES, 0, batch.size() / label_vertex_size);
+
+    glDisableVertexAttribArray(GLLabel::label_position_id);
+    glDisableVertexAttribArray(GLLabel::label_uv_id);
+    glDisableVertexAttribArray(GLLabel::label_rgba_id);
     glDisable(GL_BLEND);
+    batch.clear();
 }
 
 }  // namespace impl
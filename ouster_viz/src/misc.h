@@ -8,6 +8,8 @@
 #include <Eigen/Core>
 #include <array>
 #include <cstddef>
+#include <string>
+#include <vector>
 
 #include "camera.h"
 #include "glfw.h"
@@ -106,8 +108,42 @@ class GLCuboid {
     static void endDraw();
 };
 
+/*
+ * Quads of the glyphs of a text in the glyph atlas of glText: x, y in pixels
+ * from the top left corner and u, v of each vertex, six vertices per glyph
+ */
+struct GlyphRun {
+    std::vector<GLfloat> vertices;
+    GLfloat width{0};
+    GLfloat height{0};
+};
+
+/*
+ * Lays out a text like glText, skipping unsupported characters
+ */
+void make_glyph_run(const std::string& text, GlyphRun& run);
+
+/*
+ * The texture of the glyph atlas of glText
+ */
+GLuint glyph_atlas_texture();
+
+/*
+ * Manages opengl state for drawing a label. The glyph run of a label is laid
+ * out again only when its text changes; draw() transforms it into a vertex
+ * buffer shared by all labels, drawn at once by endDraw()
+ */
 class GLLabel {
-    GLTtext* gltext;
+    static bool initialized;
+    static GLuint label_program_id;
+    static GLuint label_position_id;
+    static GLuint label_uv_id;
+    static GLuint label_rgba_id;
+    static GLuint label_glyphs_id;
+    static GLuint batch_buffer;
+    static std::vector<GLfloat> batch;
+
+    GlyphRun run;
     Eigen::Vector3d text_position;
     bool is_3d;
     float scale;
@@ -130,10 +166,28 @@ class GLLabel {
 
     GLLabel& operator=(const GLLabel&) = delete;
 
+    /*
+     * Adds the glyphs of the label to the batch of the frame
+     */
     void draw(const WindowCtx& ctx, const CameraData& camera, Label& label);
 
+    /*
+     * Whether a label is placed in the scene rather than in the window
+     */
+    static bool in_scene(const Label& label);
+
+    /*
+     * Initializes shader program, vertex buffer and handles
+     */
+    static void initialize();
+
+    static void uninitialize();
+
     static void beginDraw();
 
+    /*
+     * Draws the glyphs of all the labels added since beginDraw()
+     */
     static void endDraw();
 };
 
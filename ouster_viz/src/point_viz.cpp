@@ -7,11 +7,16 @@
 
 #include <Eigen/Core>
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <deque>
 #include <iostream>
 #include <list>
 #include <memory>
 #include <mutex>
+#include <random>
 #include <stdexcept>
 #include <string>
 #include <type_traits>
@@ -21,6 +26,8 @@
 #include "camera.h"
 #include "cloud.h"
 #include "colormaps.h"
+#include "frame_reader.h"
+#include "frame_timer.h"
 #include "glfw.h"
 #include "image.h"
 #include "misc.h"
@@ -35,6 +42,12 @@ namespace {
 
 /*
  * Helper for addable / removable drawable objects
+ *
+ * State is triple buffered: the back objects are those of the user, update()
+ * copies them to the pending states, and the renderer takes the pending
+ * states to the front ones at the start of a frame. Only the short copies
+ * between back and pending and between pending and front need the update
+ * lock, so that the front states are drawn and uploaded without it.
  */
 template <typename GL, typename T>
 class Indexed {
@@ -42,13 +55,31 @@ class Indexed {
         std::unique_ptr<GL> gl;
         std::unique_ptr<T> state;
     };
+    using Pending = std::unique_ptr<T>;
     using Back = std::shared_ptr<T>;
 
     std::vector<Front> front;
+    std::vector<Pending> pending;
     std::vector<Back> back;
 
+    /*
+     * Send updated, added or deleted state from src to dst, accumulating
+     * the changes dst hasn't consumed yet
+     */
+    static void merge(std::unique_ptr<T>& dst, T* src) {
+        if (src && dst) {
+            dst->update_from(*src);
+            src->clear();
+        } else if (src && !dst) {
+            dst = std::make_unique<T>(*src);
+            src->clear();
+        } else if (!src && dst) {
+            dst.reset();
+        }
+    }
+
    public:
-    Indexed() : front{}, back{} {}
+    Indexed() : front{}, pending{}, back{} {}
 
     void add(const std::shared_ptr<T>& t) {
         // find and use first empty slot, or grow
@@ -83,23 +114,58 @@ class Indexed {
         }
     }
 
+    /*
+     * Like draw(), for the objects whose state satisfies pred
+     */
+    template <typename F>
+    void draw_if(const WindowCtx& ctx, const impl::CameraData& camera,
+                 F pred) {
+        for (auto& f : front) {
+            if (!f.state || !pred(*f.state)) continue;
+            if (!f.gl) f.gl = std::make_unique<GL>(*f.state);
+            f.gl->draw(ctx, camera, *f.state);
+        }
+    }
+
+    /*
+     * Like draw(), but hand all the objects to GL::draw_all() so that it
+     * can order them
+     */
+    void draw_all(const impl::CameraData& camera) {
+        std::vector<std::pair<GL*, T*>> all;
+        for (auto& f : front) {
+            if (!f.state) continue;
+            if (!f.gl) f.gl = std::make_unique<GL>(*f.state);
+            all.emplace_back(f.gl.get(), f.state.get());
+        }
+        GL::draw_all(camera, all);
+    }
+
+    /*
+     * Send the back state to pending, on update()
+     */
     void swap() {
-        assert(front.size() <= back.size());
+        assert(pending.size() <= back.size());
 
         // in case back grew
-        if (front.size() < back.size()) front.resize(back.size());
+        if (pending.size() < back.size()) pending.resize(back.size());
+
+        for (size_t i = 0; i < pending.size(); i++) {
+            merge(pending[i], back[i].get());
+        }
+    }
+
+    /*
+     * Send the pending state to the front, on the render thread
+     */
+    void publish() {
+        assert(front.size() <= pending.size());
+
+        // in case pending grew
+        if (front.size() < pending.size()) front.resize(pending.size());
 
-        // send updated, added or deleted state to the front
         for (size_t i = 0; i < front.size(); i++) {
-            if (back[i] && front[i].state) {
-                front[i].state->update_from(*back[i]);
-                back[i]->clear();
-            } else if (back[i] && !front[i].state) {
-                front[i].state = std::make_unique<T>(*back[i]);
-                back[i]->clear();
-            } else if (!back[i] && front[i].state) {
-                front[i].state.reset();
-            }
+            merge(front[i].state, pending[i].get());
         }
     }
 };
@@ -113,16 +179,27 @@ struct PointViz::Impl {
     std::unique_ptr<GLFWContext> glfw;
     GLuint vao;
 
-    // state for drawing
+    // state for drawing, update_mx guards the pending state
     std::mutex update_mx;
     bool front_changed{false};
 
-    Camera camera_back, camera_front;
+    // camera_front is pending, camera_drawn is used by the renderer
+    Camera camera_back, camera_front, camera_drawn;
+
+    // rectangles of the window drawn by cameras of their own; a deque keeps
+    // the cameras handed out in place as viewports are added
+    struct Viewport {
+        double x0, y0, x1, y1;
+        Camera camera;
+    };
+    std::deque<Viewport> viewports_back;
+    std::vector<Viewport> viewports_front, viewports_drawn;
 
-    TargetDisplay target;
+    TargetDisplay target, target_front;
     impl::GLRings rings;
 
     Indexed<impl::GLCloud, Cloud> clouds;
+    Indexed<impl::GLLodCloud, LodCloud> lod_clouds;
     Indexed<impl::GLCuboid, Cuboid> cuboids;
     Indexed<impl::GLLabel, Label> labels;
     Indexed<impl::GLImage, Image> images;
@@ -147,6 +224,17 @@ struct PointViz::Impl {
     // temp storage for frame_buffer_handlers
     std::vector<uint8_t> frame_buffer_data_{};
 
+    impl::FrameReader frame_reader;
+
+    // frame stats and their overlay
+    impl::FrameTimer frame_timer{{"state", "clouds", "rings", "cuboids",
+                                  "images", "labels", "readback"}};
+    std::atomic<bool> enable_stats{false};
+    std::atomic<bool> show_stats{false};
+    Label stats_label{"", 1, 0, true, true};
+    std::unique_ptr<impl::GLLabel> stats_gl;
+    double stats_label_time{0};
+
     double fps_last_time_{0};
     uint64_t fps_frame_counter_{0};
     double fps_{0};
@@ -154,17 +242,58 @@ struct PointViz::Impl {
     Impl(std::unique_ptr<GLFWContext>&& glfw) : glfw{std::move(glfw)} {}
 };
 
+namespace {
+
+/*
+ * Draw the stats of the last frame measured in the top right corner, with
+ * the text refreshed a few times per second to be readable
+ */
+void draw_frame_stats(PointViz::Impl& pimpl) {
+    const double now = pimpl.glfw->time();
+    if (!pimpl.stats_gl || now - pimpl.stats_label_time >= 0.25) {
+        const FrameStats stats = pimpl.frame_timer.stats();
+        std::string text;
+        char line[64];
+        std::snprintf(line, sizeof(line), "frame %llu  fps %.1f\n",
+                      static_cast<unsigned long long>(stats.frame),
+                      pimpl.fps_);
+        text += line;
+        std::snprintf(line, sizeof(line), "total  cpu %.2f  gpu %.2f ms\n",
+                      stats.cpu_ms, stats.gpu_ms);
+        text += line;
+        for (const auto& section : stats.sections) {
+            std::snprintf(line, sizeof(line), "%s  cpu %.2f  gpu %.2f ms\n",
+                          section.name.c_str(), section.cpu_ms,
+                          section.gpu_ms);
+            text += line;
+        }
+        pimpl.stats_label.set_text(text);
+        pimpl.stats_label_time = now;
+    }
+    if (!pimpl.stats_gl) pimpl.stats_gl = std::make_unique<impl::GLLabel>();
+
+    const auto& ctx = pimpl.glfw->window_context;
+    const auto camera_data =
+        pimpl.camera_drawn.matrices(impl::window_aspect(ctx));
+    impl::GLLabel::beginDraw();
+    pimpl.stats_gl->draw(ctx, camera_data, pimpl.stats_label);
+    impl::GLLabel::endDraw();
+}
+
+}  // namespace
+
 /*
  * PointViz interface
  */
 
 PointViz::PointViz(const std::string& name, bool fix_aspect, int window_width,
-                   int window_height) {
-    auto glfw = std::make_unique<GLFWContext>(name, fix_aspect, window_width,
-                                              window_height);
+                   int window_height, bool headless, PointViz* share) {
+    auto glfw = std::make_unique<GLFWContext>(
+        name, fix_aspect, window_width, window_height, headless,
+        share ? share->pimpl->glfw.get() : nullptr);
 
     // set context for GL initialization
-    glfwMakeContextCurrent(glfw->window);
+    glfw->make_current();
 
     pimpl = std::make_unique<Impl>(std::move(glfw));
 
@@ -177,13 +306,17 @@ PointViz::PointViz(const std::string& name, bool fix_aspect, int window_width,
     glDepthFunc(GL_LEQUAL);
 
     // TODO: need to check if these were already called?
-    impl::GLCloud::initialize();
-    impl::GLImage::initialize();
-    impl::GLRings::initialize();
-    impl::GLCuboid::initialize();
+    // the programs of a shared context are those of the context shared with
+    if (!share) {
+        impl::GLCloud::initialize();
+        impl::GLImage::initialize();
+        impl::GLRings::initialize();
+        impl::GLCuboid::initialize();
+        impl::GLLabel::initialize();
+    }
 
     // release context in case subsequent calls are done from another thread
-    glfwMakeContextCurrent(nullptr);
+    pimpl->glfw->release_current();
 
     // add user-setable input handlers
     pimpl->glfw->key_handler = [this](const WindowCtx& ctx, int key, int mods) {
@@ -230,7 +363,15 @@ PointViz::PointViz(const std::string& name, bool fix_aspect, int window_width,
     };
 }
 
-PointViz::~PointViz() { glDeleteVertexArrays(1, &pimpl->vao); }
+PointViz::~PointViz() {
+    if (pimpl->glfw->is_current()) {
+        pimpl->frame_reader.drain();
+        pimpl->frame_reader.release_gl();
+        pimpl->frame_timer.release_gl();
+    }
+    pimpl->frame_reader.set_sink(nullptr, 0);
+    glDeleteVertexArrays(1, &pimpl->vao);
+}
 
 void PointViz::add_default_controls(std::mutex* mx) {
     bool orthographic = false;
@@ -343,10 +484,9 @@ void PointViz::run() {
 }
 
 void PointViz::run_once() {
-    if (glfwGetCurrentContext() != pimpl->glfw->window)
-        glfwMakeContextCurrent(pimpl->glfw->window);
+    if (!pimpl->glfw->is_current()) pimpl->glfw->make_current();
     draw();
-    glfwPollEvents();
+    pimpl->glfw->poll_events();
 }
 
 bool PointViz::running() { return pimpl->glfw->running(); }
@@ -369,12 +509,15 @@ void PointViz::update() {
 
     // propagate camera changes
     pimpl->camera_front = pimpl->camera_back;
+    pimpl->viewports_front.assign(pimpl->viewports_back.begin(),
+                                  pimpl->viewports_back.end());
 
     pimpl->clouds.swap();
+    pimpl->lod_clouds.swap();
     pimpl->cuboids.swap();
     pimpl->labels.swap();
     pimpl->images.swap();
-    pimpl->rings.update(pimpl->target);
+    pimpl->target_front = pimpl->target;
 
     pimpl->front_changed = true;
 }
@@ -396,12 +539,13 @@ int PointViz::window_height() const {
 }
 
 void PointViz::draw() {
+    pimpl->frame_timer.begin();
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     glBindVertexArray(pimpl->vao);
 
     // fps counting
     ++pimpl->fps_frame_counter_;
-    double now_t = glfwGetTime();
+    double now_t = pimpl->glfw->time();
     if (pimpl->fps_last_time_ == 0 || now_t - pimpl->fps_last_time_ >= 1.0) {
         pimpl->fps_ =
             pimpl->fps_frame_counter_ / (now_t - pimpl->fps_last_time_);
@@ -409,46 +553,124 @@ void PointViz::draw() {
         pimpl->fps_frame_counter_ = 0;
     }
 
-    // draw images
+    // take the state of the last update(), if any, unless update() is
+    // running: then the previous state is drawn again rather than waiting
+    {
+        std::unique_lock<std::mutex> lock{pimpl->update_mx, std::try_to_lock};
+        if (lock.owns_lock() && pimpl->front_changed) {
+            pimpl->camera_drawn = pimpl->camera_front;
+            pimpl->viewports_drawn = pimpl->viewports_front;
+            pimpl->clouds.publish();
+            pimpl->lod_clouds.publish();
+            pimpl->cuboids.publish();
+            pimpl->labels.publish();
+            pimpl->images.publish();
+            pimpl->rings.update(pimpl->target_front);
+
+            // mark front buffers no longer dirty
+            pimpl->front_changed = false;
+        }
+    }
+    pimpl->frame_timer.end_section();
+
+    // draw the front state without the lock, update() doesn't touch it
     {
-        std::lock_guard<std::mutex> guard{pimpl->update_mx};
         const auto& ctx = pimpl->glfw->window_context;
 
         // calculate camera matrices
         auto camera_data =
-            pimpl->camera_front.matrices(impl::window_aspect(ctx));
+            pimpl->camera_drawn.matrices(impl::window_aspect(ctx));
+
+        // the scene is drawn by the camera into the whole window, or by each
+        // viewport into its rectangle, from the same GL objects
+        struct Pass {
+            EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+            WindowCtx ctx;
+            impl::CameraData camera;
+            GLint x, y;
+        };
+        std::vector<Pass, Eigen::aligned_allocator<Pass>> passes;
+        const bool split = !pimpl->viewports_drawn.empty();
+        if (!split) passes.push_back({ctx, camera_data, 0, 0});
+        for (const auto& v : pimpl->viewports_drawn) {
+            Pass pass{ctx, camera_data, 0, 0};
+            pass.x = static_cast<GLint>(std::lround(v.x0 * ctx.viewport_width));
+            pass.y =
+                static_cast<GLint>(std::lround(v.y0 * ctx.viewport_height));
+            pass.ctx.viewport_width = std::max<int>(
+                1, std::lround(v.x1 * ctx.viewport_width) - pass.x);
+            pass.ctx.viewport_height = std::max<int>(
+                1, std::lround(v.y1 * ctx.viewport_height) - pass.y);
+            pass.camera = v.camera.matrices(impl::window_aspect(pass.ctx));
+            passes.push_back(pass);
+        }
+        const auto use = [](const Pass& pass) {
+            glViewport(pass.x, pass.y, pass.ctx.viewport_width,
+                       pass.ctx.viewport_height);
+        };
 
         // draw clouds
         impl::GLCloud::beginDraw();
-        pimpl->clouds.draw(ctx, camera_data);
+        for (const auto& pass : passes) {
+            use(pass);
+            pimpl->clouds.draw_all(pass.camera);
+            glBindVertexArray(pimpl->vao);
+            pimpl->lod_clouds.draw(pass.ctx, pass.camera);
+        }
         impl::GLCloud::endDraw();
+        pimpl->frame_timer.end_section();
 
         // draw rings
-        pimpl->rings.draw(ctx, camera_data);
+        for (const auto& pass : passes) {
+            use(pass);
+            pimpl->rings.draw(pass.ctx, pass.camera);
+        }
+        pimpl->frame_timer.end_section();
 
         // draw cuboids
         impl::GLCuboid::beginDraw();
-        pimpl->cuboids.draw(ctx, camera_data);
+        for (const auto& pass : passes) {
+            use(pass);
+            pimpl->cuboids.draw(pass.ctx, pass.camera);
+        }
         impl::GLCuboid::endDraw();
+        pimpl->frame_timer.end_section();
 
         // draw labels and images on top of everything
+        glViewport(0, 0, ctx.viewport_width, ctx.viewport_height);
         glClear(GL_DEPTH_BUFFER_BIT);
 
         // draw image
         impl::GLImage::beginDraw();
         pimpl->images.draw(ctx, camera_data);
         impl::GLImage::endDraw();
-
-        // draw labels
-        impl::GLLabel::beginDraw();
-        pimpl->labels.draw(ctx, camera_data);
-        impl::GLLabel::endDraw();
+        pimpl->frame_timer.end_section();
+
+        // draw labels, the 3D ones of each viewport then the 2D ones over
+        // the whole window
+        if (split) {
+            for (const auto& pass : passes) {
+                use(pass);
+                impl::GLLabel::beginDraw();
+                pimpl->labels.draw_if(pass.ctx, pass.camera,
+                                      impl::GLLabel::in_scene);
+                impl::GLLabel::endDraw();
+            }
+            glViewport(0, 0, ctx.viewport_width, ctx.viewport_height);
+            impl::GLLabel::beginDraw();
+            pimpl->labels.draw_if(ctx, camera_data, [](const Label& label) {
+                return !impl::GLLabel::in_scene(label);
+            });
+            impl::GLLabel::endDraw();
+        } else {
+            impl::GLLabel::beginDraw();
+            pimpl->labels.draw(ctx, camera_data);
+            impl::GLLabel::endDraw();
+        }
+        pimpl->frame_timer.end_section();
 
         // switch back to point viz vao
         glBindVertexArray(pimpl->vao);
-
-        // mark front buffers no longer dirty
-        pimpl->front_changed = false;
     }
 
     if (!pimpl->frame_buffer_handlers.empty()) {
@@ -463,7 +685,13 @@ void PointViz::draw() {
             if (!f(pimpl->frame_buffer_data_, width, height)) break;
     }
 
-    glfwSwapBuffers(pimpl->glfw->window);
+    pimpl->frame_reader.read(viewport_width(), viewport_height());
+    pimpl->frame_timer.end_section();
+
+    if (pimpl->show_stats) draw_frame_stats(*pimpl);
+
+    pimpl->glfw->swap_buffers();
+    pimpl->frame_timer.end();
 }
 
 double PointViz::fps() const { return pimpl->fps_; }
@@ -499,6 +727,28 @@ void PointViz::push_frame_buffer_handler(
     pimpl->frame_buffer_handlers.push_front(std::move(callback));
 }
 
+void PointViz::set_frame_sink(
+    std::function<void(const std::vector<uint8_t>&, int, int)> sink,
+    size_t buffer_frames) {
+    pimpl->frame_reader.set_sink(std::move(sink), buffer_frames);
+}
+
+uint64_t PointViz::dropped_frames() const {
+    return pimpl->frame_reader.dropped();
+}
+
+void PointViz::enable_frame_stats(bool state) {
+    pimpl->enable_stats = state;
+    pimpl->frame_timer.enabled(state || pimpl->show_stats);
+}
+
+void PointViz::show_frame_stats(bool state) {
+    pimpl->show_stats = state;
+    pimpl->frame_timer.enabled(state || pimpl->enable_stats);
+}
+
+FrameStats PointViz::frame_stats() const { return pimpl->frame_timer.stats(); }
+
 void PointViz::pop_key_handler() { pimpl->key_handlers.pop_front(); }
 
 void PointViz::pop_mouse_button_handler() {
@@ -530,6 +780,27 @@ Camera& PointViz::camera() { return pimpl->camera_back; }
 
 Camera& PointViz::current_camera() { return pimpl->camera_front; }
 
+size_t PointViz::add_viewport(double x0, double y0, double x1, double y1) {
+    if (!(x0 < x1 && y0 < y1)) {
+        throw std::invalid_argument("PointViz: empty viewport");
+    }
+    pimpl->viewports_back.push_back({x0, y0, x1, y1, pimpl->camera_back});
+    return pimpl->viewports_back.size() - 1;
+}
+
+size_t PointViz::viewport_count() const {
+    return pimpl->viewports_back.size();
+}
+
+Camera& PointViz::viewport_camera(size_t index) {
+    if (index >= pimpl->viewports_back.size()) {
+        throw std::out_of_range("PointViz: no such viewport");
+    }
+    return pimpl->viewports_back[index].camera;
+}
+
+void PointViz::clear_viewports() { pimpl->viewports_back.clear(); }
+
 TargetDisplay& PointViz::target_display() { return pimpl->target; }
 
 void PointViz::add(const std::shared_ptr<Cloud>& cloud) {
@@ -537,6 +808,11 @@ void PointViz::add(const std::shared_ptr<Cloud>& cloud) {
     pimpl->clouds.add(cloud);
 }
 
+void PointViz::add(const std::shared_ptr<LodCloud>& cloud) {
+    cloud->dirty();
+    pimpl->lod_clouds.add(cloud);
+}
+
 void PointViz::add(const std::shared_ptr<Cuboid>& cuboid) {
     pimpl->cuboids.add(cuboid);
 }
@@ -554,6 +830,10 @@ bool PointViz::remove(const std::shared_ptr<Cloud>& cloud) {
     return pimpl->clouds.remove(cloud);
 }
 
+bool PointViz::remove(const std::shared_ptr<LodCloud>& cloud) {
+    return pimpl->lod_clouds.remove(cloud);
+}
+
 bool PointViz::remove(const std::shared_ptr<Cuboid>& cuboid) {
     return pimpl->cuboids.remove(cuboid);
 }
@@ -566,6 +846,30 @@ bool PointViz::remove(const std::shared_ptr<Image>& image) {
     return pimpl->images.remove(image);
 }
 
+namespace {
+
+/*
+ * Widen the changed columns [begin, end) to also cover [first, last)
+ */
+void widen_cols(size_t& begin, size_t& end, size_t first, size_t last) {
+    if (first >= last) return;
+    if (begin >= end) {
+        begin = first;
+        end = last;
+    } else {
+        begin = std::min(begin, first);
+        end = std::max(end, last);
+    }
+}
+
+void check_cols(size_t first_col, size_t num_cols, size_t w) {
+    if (first_col > w || num_cols > w - first_col) {
+        throw std::invalid_argument("columns out of the point cloud");
+    }
+}
+
+}  // namespace
+
 Cloud::Cloud(size_t w, size_t h, const mat4d& extrinsic)
     : n_{w * h},
       w_{w},
@@ -593,6 +897,7 @@ Cloud::Cloud(size_t w, size_t h, const mat4d& extrinsic)
 
     Eigen::Map<Eigen::Matrix4d>{pose_.data()}.setIdentity();
     pose_changed_ = true;
+    range_cols_end_ = key_cols_end_ = w_;
 }
 
 /*
@@ -625,7 +930,14 @@ void Cloud::update_from(const Cloud& other) {
     bool transform_changed = other.transform_changed_ || transform_changed_;
     bool palette_changed = other.palette_changed_ || palette_changed_;
     bool point_size_changed = other.point_size_changed_ || point_size_changed_;
+    size_t range_cols_begin = range_cols_begin_;
+    size_t range_cols_end = range_cols_end_;
+    size_t key_cols_begin = key_cols_begin_;
+    size_t key_cols_end = key_cols_end_;
     *this = other;
+    widen_cols(range_cols_begin_, range_cols_end_, range_cols_begin,
+               range_cols_end);
+    widen_cols(key_cols_begin_, key_cols_end_, key_cols_begin, key_cols_end);
     this->range_changed_ = range_changed;
     this->key_changed_ = key_changed;
     this->mask_changed_ = mask_changed;
@@ -647,6 +959,8 @@ void Cloud::clear() {
     palette_changed_ = false;
     pose_changed_ = false;
     point_size_changed_ = false;
+    range_cols_begin_ = range_cols_end_ = 0;
+    key_cols_begin_ = key_cols_end_ = 0;
 }
 
 void Cloud::dirty() {
@@ -659,6 +973,8 @@ void Cloud::dirty() {
     palette_changed_ = true;
     pose_changed_ = true;
     point_size_changed_ = true;
+    range_cols_begin_ = key_cols_begin_ = 0;
+    range_cols_end_ = key_cols_end_ = w_;
 }
 
 void Cloud::set_range(const uint32_t* x) {
@@ -666,6 +982,22 @@ void Cloud::set_range(const uint32_t* x) {
     std::transform(x, x + n_, std::begin(*range_data_),
                    [](uint32_t i) { return static_cast<float>(i); });
     range_changed_ = true;
+    range_cols_begin_ = 0;
+    range_cols_end_ = w_;
+}
+
+void Cloud::set_range(const uint32_t* x, size_t first_col, size_t num_cols) {
+    check_cols(first_col, num_cols, w_);
+    // copied, the previous data may still be shared with the drawn cloud
+    range_data_ = std::make_shared<std::vector<float>>(*range_data_);
+    for (size_t row = 0; row < n_; row += w_) {
+        std::transform(x + row + first_col, x + row + first_col + num_cols,
+                       range_data_->begin() + row + first_col,
+                       [](uint32_t i) { return static_cast<float>(i); });
+    }
+    range_changed_ = true;
+    widen_cols(range_cols_begin_, range_cols_end_, first_col,
+               first_col + num_cols);
 }
 
 void Cloud::set_key(const float* key_data) {
@@ -677,9 +1009,61 @@ void Cloud::set_key(const float* key_data) {
         dst += 4;
     }
     key_changed_ = true;
+    key_cols_begin_ = 0;
+    key_cols_end_ = w_;
+    mono_ = true;
+    raw_key_data_.reset();
+}
+
+void Cloud::set_key(const float* key_data, size_t first_col, size_t num_cols) {
+    check_cols(first_col, num_cols, w_);
+    if (mono_ && !raw_key_data_) {
+        key_data_ = std::make_shared<std::vector<float>>(*key_data_);
+        widen_cols(key_cols_begin_, key_cols_end_, first_col,
+                   first_col + num_cols);
+    } else {
+        // the other columns hold colors or raw keys, reset them like
+        // set_key() would
+        key_data_ = std::make_shared<std::vector<float>>(4 * n_, 1.0f);
+        key_cols_begin_ = 0;
+        key_cols_end_ = w_;
+    }
+    float* dst = key_data_->data();
+    for (size_t row = 0; row < n_; row += w_) {
+        for (size_t col = first_col; col < first_col + num_cols; col++) {
+            dst[4 * (row + col)] = key_data[row + col];
+        }
+    }
+    key_changed_ = true;
+    mono_ = true;
+    raw_key_data_.reset();
+}
+
+template <typename T>
+void Cloud::set_key_raw_impl(const T* key, KeyNormalization normalization) {
+    const auto bytes = reinterpret_cast<const uint8_t*>(key);
+    raw_key_data_ =
+        std::make_shared<std::vector<uint8_t>>(bytes, bytes + sizeof(T) * n_);
+    raw_key_bytes_ = sizeof(T);
+    key_normalization_ = normalization;
+    key_changed_ = true;
+    key_cols_begin_ = 0;
+    key_cols_end_ = w_;
     mono_ = true;
 }
 
+void Cloud::set_key_raw(const uint8_t* key, KeyNormalization normalization) {
+    set_key_raw_impl(key, normalization);
+}
+
+void Cloud::set_key_raw(const uint16_t* key, KeyNormalization normalization) {
+    set_key_raw_impl(key, normalization);
+}
+
+void Cloud::set_key_raw(const uint32_t* key, KeyNormalization normalization) {
+    set_key_raw_impl(key, normalization);
+}
+
 void Cloud::set_key_rgb(const float* key_rgb_data) {
     // 3 color channels per point (RGB)
     key_data_ = std::make_shared<std::vector<float>>(4 * n_, 1.0f);
@@ -692,7 +1076,10 @@ void Cloud::set_key_rgb(const float* key_rgb_data) {
         dst++;
     }
     key_changed_ = true;
+    key_cols_begin_ = 0;
+    key_cols_end_ = w_;
     mono_ = false;
+    raw_key_data_.reset();
 }
 
 void Cloud::set_key_rgba(const float* key_rgba_data) {
@@ -707,7 +1094,10 @@ void Cloud::set_key_rgba(const float* key_rgba_data) {
         *(dst++) = *(key_rgba_data++);
     }
     key_changed_ = true;
+    key_cols_begin_ = 0;
+    key_cols_end_ = w_;
     mono_ = false;
+    raw_key_data_.reset();
 }
 
 void Cloud::set_mask(const float* mask_data) {
@@ -787,6 +1177,140 @@ void Cloud::set_palette(const float* palette, size_t palette_size) {
     palette_changed_ = true;
 }
 
+namespace {
+
+// distinguishes the points of clouds, so that a GLLodCloud reused for another
+// cloud, or for a cleared one, uploads its points again
+uint64_t next_lod_cloud_id() {
+    static std::atomic<uint64_t> id{0};
+    return ++id;
+}
+
+}  // namespace
+
+LodCloud::LodCloud(float chunk_size, size_t point_budget)
+    : chunk_size_{chunk_size},
+      point_budget_{point_budget},
+      id_{next_lod_cloud_id()},
+      palette_data_{std::make_shared<std::vector<float>>(
+          &spezia_palette[0][0], &spezia_palette[0][0] + spezia_n * 3)} {
+    if (!(chunk_size > 0.0f) || !std::isfinite(chunk_size)) {
+        throw std::invalid_argument("LodCloud: chunk size must be positive");
+    }
+    Eigen::Map<Eigen::Matrix4d>{pose_.data()}.setIdentity();
+}
+
+void LodCloud::update_from(const LodCloud& other) {
+    bool points_changed = other.points_changed_ || points_changed_;
+    bool palette_changed = other.palette_changed_ || palette_changed_;
+    bool pose_changed = other.pose_changed_ || pose_changed_;
+    bool point_size_changed = other.point_size_changed_ || point_size_changed_;
+    *this = other;
+    this->points_changed_ = points_changed;
+    this->palette_changed_ = palette_changed;
+    this->pose_changed_ = pose_changed;
+    this->point_size_changed_ = point_size_changed;
+}
+
+void LodCloud::clear() {
+    points_changed_ = false;
+    palette_changed_ = false;
+    pose_changed_ = false;
+    point_size_changed_ = false;
+}
+
+void LodCloud::dirty() {
+    points_changed_ = true;
+    palette_changed_ = true;
+    pose_changed_ = true;
+    point_size_changed_ = true;
+}
+
+void LodCloud::add_points(const float* xyz, const float* key, size_t n) {
+    using ChunkKey = impl::LodBatch::ChunkKey;
+
+    // the chunk of each point, skipping those without a position or too far
+    // for the coordinates of their chunk
+    const float limit = chunk_size_ * static_cast<float>(1 << 30);
+    std::vector<std::pair<ChunkKey, size_t>> points;
+    points.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        const float* p = xyz + 3 * i;
+        if (!(std::abs(p[0]) < limit && std::abs(p[1]) < limit &&
+              std::abs(p[2]) < limit)) {
+            continue;
+        }
+        ChunkKey chunk;
+        for (size_t k = 0; k < 3; k++) {
+            chunk[k] = static_cast<int32_t>(std::floor(p[k] / chunk_size_));
+        }
+        points.emplace_back(chunk, i);
+    }
+    if (points.empty()) return;
+
+    // group the points by chunk, shuffled within each one so that any number
+    // of them from the start is a uniform sample
+    std::minstd_rand rng(static_cast<uint32_t>(n_ + batches_.size()));
+    std::shuffle(points.begin(), points.end(), rng);
+    std::stable_sort(points.begin(), points.end(),
+                     [](const std::pair<ChunkKey, size_t>& a,
+                        const std::pair<ChunkKey, size_t>& b) {
+                         return a.first < b.first;
+                     });
+
+    auto batch = std::make_shared<impl::LodBatch>();
+    batch->xyz.resize(3 * points.size());
+    batch->key.resize(points.size());
+    for (size_t j = 0; j < points.size(); j++) {
+        const size_t i = points[j].second;
+        const float* p = xyz + 3 * i;
+        if (batch->parts.empty() ||
+            batch->parts.back().chunk != points[j].first) {
+            batch->parts.push_back({points[j].first, j, 0, {p[0], p[1], p[2]},
+                                    {p[0], p[1], p[2]}});
+        }
+        auto& part = batch->parts.back();
+        for (size_t k = 0; k < 3; k++) {
+            batch->xyz[3 * j + k] = p[k];
+            part.lo[k] = std::min(part.lo[k], p[k]);
+            part.hi[k] = std::max(part.hi[k], p[k]);
+        }
+        batch->key[j] = key ? key[i] : 0.0f;
+        part.count++;
+    }
+
+    batches_.push_back(std::move(batch));
+    n_ += points.size();
+    points_changed_ = true;
+}
+
+void LodCloud::clear_points() {
+    batches_.clear();
+    n_ = 0;
+    id_ = next_lod_cloud_id();
+    points_changed_ = true;
+}
+
+void LodCloud::set_point_budget(size_t point_budget) {
+    point_budget_ = point_budget;
+}
+
+void LodCloud::set_pose(const mat4d& pose) {
+    pose_ = pose;
+    pose_changed_ = true;
+}
+
+void LodCloud::set_point_size(float size) {
+    point_size_ = size;
+    point_size_changed_ = true;
+}
+
+void LodCloud::set_palette(const float* palette, size_t palette_size) {
+    palette_data_ = std::make_shared<std::vector<float>>(palette_size * 3);
+    std::copy(palette, palette + (palette_size * 3), palette_data_->begin());
+    palette_changed_ = true;
+}
+
 Image::Image() = default;
 
 void Image::update_from(const Image& other) {
@@ -808,74 +1332,57 @@ void Image::clear() {
     palette_changed_ = false;
 }
 
-void Image::set_image(size_t width, size_t height, const float* image_data) {
+template <typename T>
+void Image::set_image_impl(size_t width, size_t height, const T* image_data,
+                           size_t channels) {
     if (width < 1 || height < 1) {
         throw std::invalid_argument("invalid image size");
     }
     if (!image_data) {
         throw std::invalid_argument("null image data");
     }
-    const size_t n = width * height;
-    image_data_.resize(4 * n);
+    const auto bytes = reinterpret_cast<const uint8_t*>(image_data);
+    image_data_ = std::make_shared<std::vector<uint8_t>>(
+        bytes, bytes + sizeof(T) * channels * width * height);
     image_width_ = width;
     image_height_ = height;
-    const float* end = image_data + n;
-    float* dst = image_data_.data();
-    while (image_data != end) {
-        *(dst + 0) = *(image_data++);
-        *(dst + 3) = 1.0;  // alpha
-        dst += 4;
-    }
+    image_channels_ = channels;
+    image_bytes_ = sizeof(T);
     image_changed_ = true;
-    mono_ = true;
+    mono_ = channels == 1;
+}
+
+void Image::set_image(size_t width, size_t height, const float* image_data) {
+    set_image_impl(width, height, image_data, 1);
+}
+
+void Image::set_image(size_t width, size_t height, const uint8_t* image_data) {
+    set_image_impl(width, height, image_data, 1);
+}
+
+void Image::set_image(size_t width, size_t height,
+                      const uint16_t* image_data) {
+    set_image_impl(width, height, image_data, 1);
 }
 
 void Image::set_image_rgb(size_t width, size_t height,
                           const float* image_data_rgb) {
-    if (width < 1 || height < 1) {
-        throw std::invalid_argument("invalid image size");
-    }
-    if (!image_data_rgb) {
-        throw std::invalid_argument("null image data");
-    }
-    const size_t n = width * height;
-    image_data_.resize(4 * n);
-    image_width_ = width;
-    image_height_ = height;
-    const float* end = image_data_rgb + 3 * n;
-    float* dst = image_data_.data();
-    while (image_data_rgb != end) {
-        *(dst++) = *(image_data_rgb++);
-        *(dst++) = *(image_data_rgb++);
-        *(dst++) = *(image_data_rgb++);
-        *(dst++) = 1.0;  // alpha
-    }
-    image_changed_ = true;
-    mono_ = false;
+    set_image_impl(width, height, image_data_rgb, 3);
+}
+
+void Image::set_image_rgb(size_t width, size_t height,
+                          const uint8_t* image_data_rgb) {
+    set_image_impl(width, height, image_data_rgb, 3);
 }
 
 void Image::set_image_rgba(size_t width, size_t height,
                            const float* image_data_rgba) {
-    if (width < 1 || height < 1) {
-        throw std::invalid_argument("invalid image size");
-    }
-    if (!image_data_rgba) {
-        throw std::invalid_argument("null image data");
-    }
-    const size_t n = width * height;
-    image_data_.resize(4 * n);
-    image_width_ = width;
-    image_height_ = height;
-    const float* end = image_data_rgba + 4 * n;
-    float* dst = image_data_.data();
-    while (image_data_rgba != end) {
-        *(dst++) = *(image_data_rgba++);
-        *(dst++) = *(image_data_rgba++);
-        *(dst++) = *(image_data_rgba++);
-        *(dst++) = *(image_data_rgba++);
-    }
-    image_changed_ = true;
-    mono_ = false;
+    set_image_impl(width, height, image_data_rgba, 4);
+}
+
+void Image::set_image_rgba(size_t width, size_t height,
+                           const uint8_t* image_data_rgba) {
+    set_image_impl(width, height, image_data_rgba, 4);
 }
 
 void Image::set_mask(size_t width, size_t height, const float* mask_data) {
@@ -886,10 +1393,9 @@ void Image::set_mask(size_t width, size_t height, const float* mask_data) {
         throw std::invalid_argument("null mask data");
     }
     size_t n = width * height * 4;
-    mask_data_.resize(n);
+    mask_data_ = std::make_shared<std::vector<float>>(mask_data, mask_data + n);
     mask_width_ = width;
     mask_height_ = height;
-    std::copy(mask_data, mask_data + n, mask_data_.begin());
     mask_changed_ = true;
 }
 
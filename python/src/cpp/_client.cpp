@@ -18,27 +18,58 @@
 #include <algorithm>
 #include <array>
 #include <chrono>
+#include <condition_variable>
 #include <deque>
+#include <exception>
+#include <limits>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <set>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <tuple>
 #include <utility>
 
 #include "common.h"
 #include "ouster/client.h"
+#include "ouster/clock_model.h"
+#include "ouster/column_dewarper.h"
+#include "ouster/content_hash.h"
+#include "ouster/dual_return.h"
+#include "ouster/deskew_input.h"
+#include "ouster/field_ops.h"
+#include "ouster/fused_cloud.h"
+#include "ouster/occupancy_grid.h"
 #include "ouster/image_processing.h"
+#include "ouster/imu_batcher.h"
+#include "ouster/imu_preintegrator.h"
 #include "ouster/impl/build.h"
 #include "ouster/impl/logging.h"
 #include "ouster/impl/packet_writer.h"
 #include "ouster/impl/profile_extension.h"
 #include "ouster/lidar_scan.h"
+#include "ouster/map_localizer.h"
+#include "ouster/map_tile_store.h"
 #include "ouster/metadata.h"
+#include "ouster/metrics.h"
+#include "ouster/packet_relay.h"
+#include "ouster/parallel_scan_batcher.h"
+#include "ouster/reframing_batcher.h"
+#include "ouster/point_cloud_writer.h"
+#include "ouster/range_image.h"
+#include "ouster/scan_collator.h"
+#include "ouster/scan_gate.h"
+#include "ouster/scan_stream.h"
 #include "ouster/sensor_client.h"
+#include "ouster/sensor_discovery.h"
 #include "ouster/sensor_http.h"
 #include "ouster/sensor_scan_source.h"
+#include "ouster/shm_scan_channel.h"
+#include "ouster/trace.h"
 #include "ouster/types.h"
+#include "ouster/voxel_grid.h"
 
 namespace py = pybind11;
 namespace chrono = std::chrono;
@@ -53,6 +84,8 @@ using ouster::sensor::product_info;
 using ouster::sensor::sensor_config;
 using ouster::sensor::sensor_info;
 using ouster::sensor::impl::packet_writer;
+using ouster::sensor::util::HttpResponse;
+using ouster::sensor::util::MultiSensorHttp;
 using ouster::sensor::util::SensorHttp;
 using namespace ouster;
 
@@ -104,9 +137,10 @@ using pyimg_t = py::array_t<T, py::array::c_style>;
 template <typename T, typename U>
 void image_proc_call(T& self, pyimg_t<U> image, bool update_state) {
     if (image.ndim() != 2) throw std::invalid_argument("Expected a 2d array");
-    self(Eigen::Map<img_t<U>>(image.mutable_data(), image.shape(0),
-                              image.shape(1)),
-         update_state);
+    Eigen::Map<img_t<U>> img(image.mutable_data(), image.shape(0),
+                             image.shape(1));
+    py::gil_scoped_release release;
+    self(img, update_state);
 }
 
 /*
@@ -263,6 +297,13 @@ py::array::ShapeContainer shape_of_descriptor(const FieldDescriptor& rd) {
     return py::array::ShapeContainer(rd.shape.begin(), rd.shape.end());
 }
 
+// scan last read by a ShmScanReader
+static const LidarScan& current_shm_scan(py::object reader) {
+    const LidarScan* scan = reader.cast<const ShmScanReader&>().current();
+    if (!scan) throw std::runtime_error("ShmScanReader: no scan read yet");
+    return *scan;
+}
+
 template <typename Fn>
 struct lambda_iter {
     Fn lambda;
@@ -332,6 +373,192 @@ struct set_field {
     }
 };
 
+/*
+ * Get the array a binding writes its result of the given shape to: out if it
+ * isn't None, otherwise a new array.
+ */
+template <typename T = double>
+static py::array_t<T> output_array(const py::object& out,
+                                   const std::vector<py::ssize_t>& shape) {
+    if (out.is_none()) return py::array_t<T>(shape);
+    if (!py::isinstance<py::array_t<T>>(out)) {
+        throw std::invalid_argument(
+            "out must be a numpy array of " +
+            std::string(py::str(py::dtype::of<T>())));
+    }
+    auto arr = py::reinterpret_borrow<py::array_t<T>>(out);
+    if (!arr.writeable() || !(arr.flags() & py::array::c_style)) {
+        throw std::invalid_argument(
+            "out must be a writeable C contiguous array");
+    }
+    if (static_cast<size_t>(arr.ndim()) != shape.size() ||
+        !std::equal(shape.begin(), shape.end(), arr.shape())) {
+        throw std::invalid_argument("out has the wrong shape");
+    }
+    return arr;
+}
+
+/*
+ * Destagger an image into out, or into a new image if out is None. out may be
+ * the image itself to destagger it in place.
+ */
+template <typename T>
+static py::array_t<T> destagger_into(const Eigen::Ref<const img_t<T>>& img,
+                                     const std::vector<int>& shifts,
+                                     bool inverse, const py::object& out) {
+    auto result = output_array<T>(out, {img.rows(), img.cols()});
+    Eigen::Map<img_t<T>> dest(result.mutable_data(), img.rows(), img.cols());
+    const T* begin = img.data();
+    const T* end =
+        img.size() ? begin + img.outerStride() * (img.rows() - 1) + img.cols()
+                   : begin;
+    const bool in_place =
+        dest.data() == begin && img.outerStride() == img.cols();
+    if (!in_place && dest.data() < end && begin < dest.data() + dest.size()) {
+        throw std::invalid_argument("out overlaps the image");
+    }
+
+    {
+        py::gil_scoped_release release;
+        if (in_place)
+            destagger_in_place<T>(dest, shifts, inverse);
+        else
+            destagger_to<T>(dest, img, shifts, inverse);
+    }
+    return result;
+}
+
+/*
+ * Bind destagger_into for a numpy scalar type
+ */
+template <typename T>
+static void def_destagger(py::module& m, const char* name) {
+    m.def(name, &destagger_into<T>, py::arg("field"), py::arg("shifts"),
+          py::arg("inverse"), py::arg("out") = py::none());
+}
+
+/*
+ * Bind the range image filters for a numpy scalar type, as overloads
+ */
+template <typename T>
+static void def_range_filters(py::module& m) {
+    const char* doc = R"(
+        Filter a destaggered image over a window of rows x cols pixels, cut
+        at the top and bottom rows and wrapped around the columns if
+        wrap_columns.
+
+        Args:
+          img: the destaggered image
+          rows: odd window height
+          cols: odd window width
+          ignore_zeros: leave out zero pixels, 0 where a window is all zeros
+          wrap_columns: wrap the window around the columns
+
+        Returns:
+          The filtered image
+        )";
+    m.def("min_filter", &min_filter<T>, doc, py::arg("img"), py::arg("rows"),
+          py::arg("cols"), py::arg("ignore_zeros") = false,
+          py::arg("wrap_columns") = true,
+          py::call_guard<py::gil_scoped_release>());
+    m.def("max_filter", &max_filter<T>, doc, py::arg("img"), py::arg("rows"),
+          py::arg("cols"), py::arg("ignore_zeros") = false,
+          py::arg("wrap_columns") = true,
+          py::call_guard<py::gil_scoped_release>());
+    m.def("median_filter", &median_filter<T>, doc, py::arg("img"),
+          py::arg("rows"), py::arg("cols"), py::arg("ignore_zeros") = false,
+          py::arg("wrap_columns") = true,
+          py::call_guard<py::gil_scoped_release>());
+}
+
+/*
+ * Get the array of the given dtype and shape a binding writes its result to:
+ * out if it isn't None, otherwise a new array.
+ */
+static py::array output_array(const py::object& out, const py::dtype& dtype,
+                              const std::vector<py::ssize_t>& shape) {
+    if (out.is_none()) return py::array(dtype, shape);
+    if (!py::isinstance<py::array>(out) ||
+        !out.attr("dtype").equal(dtype)) {
+        throw std::invalid_argument("out must be a numpy array of " +
+                                    std::string(py::str(dtype)));
+    }
+    auto arr = py::reinterpret_borrow<py::array>(out);
+    if (!arr.writeable() || !(arr.flags() & py::array::c_style)) {
+        throw std::invalid_argument(
+            "out must be a writeable C contiguous array");
+    }
+    if (static_cast<size_t>(arr.ndim()) != shape.size() ||
+        !std::equal(shape.begin(), shape.end(), arr.shape())) {
+        throw std::invalid_argument("out has the wrong shape");
+    }
+    return arr;
+}
+
+/*
+ * View a C contiguous numpy array as a FieldView for the field_ops kernels
+ */
+static FieldView array_field_view(const py::array& arr, bool writeable) {
+    if (!(arr.flags() & py::array::c_style)) {
+        throw std::invalid_argument("array must be C contiguous");
+    }
+    if (writeable && !arr.writeable()) {
+        throw std::invalid_argument("array must be writeable");
+    }
+    std::vector<size_t> shape(arr.shape(), arr.shape() + arr.ndim());
+    if (shape.empty()) shape.push_back(1);
+    return FieldView(
+        const_cast<void*>(arr.data()),
+        FieldDescriptor::array(field_type_of_dtype(arr.dtype()), shape));
+}
+
+static field_ops::CompareOp compare_op_of(const std::string& op) {
+    if (op == "<") return field_ops::CompareOp::LESS;
+    if (op == "<=") return field_ops::CompareOp::LESS_EQUAL;
+    if (op == ">") return field_ops::CompareOp::GREATER;
+    if (op == ">=") return field_ops::CompareOp::GREATER_EQUAL;
+    if (op == "==") return field_ops::CompareOp::EQUAL;
+    if (op == "!=") return field_ops::CompareOp::NOT_EQUAL;
+    throw std::invalid_argument("unknown comparison '" + op + "'");
+}
+
+using StridedPoints =
+    Eigen::Map<LidarScan::Points, 0,
+               Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>>;
+
+/*
+ * View a float64 array of shape (N, 3) or (H, W, 3) as N points, whatever its
+ * layout, so that cartesian can write into it.
+ */
+static StridedPoints points_view(const py::object& out, Eigen::Index n) {
+    if (!py::isinstance<py::array_t<double>>(out)) {
+        throw std::invalid_argument("out must be a float64 numpy array");
+    }
+    auto arr = py::reinterpret_borrow<py::array_t<double>>(out);
+    if (!arr.writeable()) {
+        throw std::invalid_argument("out must be writeable");
+    }
+    const auto nd = arr.ndim();
+    for (py::ssize_t i = 0; i < nd; i++) {
+        if (arr.strides(i) < 0 || arr.strides(i) % sizeof(double)) {
+            throw std::invalid_argument("out has unsupported strides");
+        }
+    }
+    if (nd == 2 && arr.shape(0) == n && arr.shape(1) == 3) {
+        return StridedPoints(
+            arr.mutable_data(), n, 3,
+            {arr.strides(1) / sizeof(double), arr.strides(0) / sizeof(double)});
+    }
+    // the first two dimensions must flatten to one
+    if (nd == 3 && arr.shape(0) * arr.shape(1) == n && arr.shape(2) == 3 &&
+        arr.strides(0) == arr.shape(1) * arr.strides(1)) {
+        return StridedPoints(
+            arr.mutable_data(), n, 3,
+            {arr.strides(2) / sizeof(double), arr.strides(1) / sizeof(double)});
+    }
+    throw std::invalid_argument("out must have shape (N, 3) or (H, W, 3)");
+}
+
 /**
  * Applies a set of 4x4 pose transformations to a collection of 3D points,
  * reshapes the input into appropriate Eigen matrices, and invokes the C++
@@ -353,13 +580,17 @@ struct set_field {
  *              - W: Number of pose matrices
  *              - 4x4: The transformation matrices
  *
+ * @param[out] out A NumPy array of shape (H, W, 3) to write the result to, or
+ * None to allocate one.
+ *
  * @return A NumPy array of shape (H, W, 3) containing the dewarped 3D points
  * after applying the corresponding 4x4 transformation matrices to the points.
  *
  */
 
 py::array_t<double> dewarp(const py::array_t<double>& points,
-                           const py::array_t<double>& poses) {
+                           const py::array_t<double>& poses,
+                           const py::object& out) {
     py::array_t<double> c_style_points;
     py::array_t<double> c_style_poses;
 
@@ -407,7 +638,7 @@ py::array_t<double> dewarp(const py::array_t<double>& points,
     Eigen::Map<pose_util::Poses> poses_mat(static_cast<double*>(poses_buf.ptr),
                                            num_poses, 16);
 
-    auto result = py::array_t<double>({num_rows, num_poses, point_dim});
+    auto result = output_array(out, {num_rows, num_poses, point_dim});
     auto result_buf = result.request();
     Eigen::Map<pose_util::Points> dewarped_points(
         static_cast<double*>(result_buf.ptr), num_rows * num_poses, point_dim);
@@ -418,7 +649,10 @@ py::array_t<double> dewarp(const py::array_t<double>& points,
                    point_dim);
 
     // Perform dewarp transformation
-    pose_util::dewarp(dewarped_points, points_mat, poses_mat);
+    {
+        py::gil_scoped_release release;
+        pose_util::dewarp(dewarped_points, points_mat, poses_mat);
+    }
 
     return result;
 }
@@ -443,13 +677,17 @@ py::array_t<double> dewarp(const py::array_t<double>& points,
  * matrices.
  *              - 4x4: The transformation matrices
  *
+ * @param[out] out A NumPy array of the shape of points to write the result to,
+ * or None to allocate one.
+ *
  * @return A NumPy array of shape (H, W, 3) or (N, 3) containing the transformed
  * 3D points after applying the corresponding 4x4 transformation matrices to the
  * points.
  *
  */
 py::array_t<double> transform(const py::array_t<double>& points,
-                              const py::array_t<double>& pose) {
+                              const py::array_t<double>& pose,
+                              const py::object& out) {
     // Ensure the pose is a 4x4 matrix
     if (pose.ndim() != 2 || pose.shape(0) != 4 || pose.shape(1) != 4) {
         throw std::runtime_error("pose array must have shape (4, 4)");
@@ -480,12 +718,15 @@ py::array_t<double> transform(const py::array_t<double>& points,
         Eigen::Map<const pose_util::Points> points_eigen(points_ptr->data(), n,
                                                          3);
 
-        auto result = py::array_t<double>({n, 3});
+        auto result = output_array(out, {n, 3});
         auto result_buf = result.request();
         Eigen::Map<pose_util::Points> transformed(
             static_cast<double*>(result_buf.ptr), n, 3);
 
-        pose_util::transform(transformed, points_eigen, pose_eigen);
+        {
+            py::gil_scoped_release release;
+            pose_util::transform(transformed, points_eigen, pose_eigen);
+        }
         return result;
     }
 
@@ -497,12 +738,15 @@ py::array_t<double> transform(const py::array_t<double>& points,
         Eigen::Map<const pose_util::Points> points_eigen(points_ptr->data(),
                                                          h * w, 3);
 
-        auto result = py::array_t<double>({h, w, 3});
+        auto result = output_array(out, {h, w, 3});
         auto result_buf = result.request();
         Eigen::Map<pose_util::Points> transformed(
             static_cast<double*>(result_buf.ptr), h * w, 3);
 
-        pose_util::transform(transformed, points_eigen, pose_eigen);
+        {
+            py::gil_scoped_release release;
+            pose_util::transform(transformed, points_eigen, pose_eigen);
+        }
         return result;
     } else {
         throw std::invalid_argument(
@@ -510,6 +754,329 @@ py::array_t<double> transform(const py::array_t<double>& points,
     }
 }
 
+/*
+ * Advances a python iterator on a native thread, up to depth items ahead of
+ * the consumer
+ *
+ * The thread only holds the GIL while it runs the python code of the
+ * iterator: the native reads, batching and decoding under it release the GIL,
+ * so the next scans are read while the consumer works on the current one.
+ * Queued items are only moved while the GIL is released, never copied.
+ */
+class ScanPrefetcher {
+   public:
+    ScanPrefetcher(py::iterator it, size_t depth)
+        : it_{std::move(it)}, depth_{depth} {
+        if (depth_ == 0) throw std::invalid_argument("depth must be positive");
+        live().insert(this);
+        thread_ = std::thread{[this]() { run(); }};
+    }
+
+    ScanPrefetcher(const ScanPrefetcher&) = delete;
+    ScanPrefetcher& operator=(const ScanPrefetcher&) = delete;
+
+    ~ScanPrefetcher() {
+        close();
+        live().erase(this);
+    }
+
+    // the next item, waiting for it with the GIL released
+    py::object next() {
+        py::object item;
+        std::exception_ptr error;
+        {
+            py::gil_scoped_release release;
+            std::unique_lock<std::mutex> lock{mx_};
+            ready_.wait(lock, [this] { return !queue_.empty() || done_; });
+            if (!queue_.empty()) {
+                item = std::move(queue_.front());
+                queue_.pop_front();
+            } else {
+                std::swap(error, error_);
+            }
+        }
+        space_.notify_one();
+        if (error) std::rethrow_exception(error);
+        if (!item) throw py::stop_iteration();
+        return item;
+    }
+
+    // stop the thread and drop the queued items
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock{mx_};
+            stopping_ = true;
+        }
+        space_.notify_one();
+        // taken with the GIL held so that only one caller joins
+        std::thread thread = std::move(thread_);
+        if (thread.joinable()) {
+            py::gil_scoped_release release;
+            thread.join();
+        }
+        std::deque<py::object> dropped;
+        {
+            std::lock_guard<std::mutex> lock{mx_};
+            dropped.swap(queue_);
+            done_ = true;
+        }
+        ready_.notify_all();
+    }
+
+    size_t depth() const { return depth_; }
+
+    // stop the threads still running before the interpreter finalizes
+    static void close_all() {
+        while (!live().empty()) {
+            ScanPrefetcher* prefetcher = *live().begin();
+            live().erase(live().begin());
+            prefetcher->close();
+        }
+    }
+
+   private:
+    // prefetchers alive, only touched with the GIL held
+    static std::set<ScanPrefetcher*>& live() {
+        static std::set<ScanPrefetcher*> prefetchers;
+        return prefetchers;
+    }
+
+    void run() {
+        py::gil_scoped_acquire acquire;
+        while (true) {
+            {
+                py::gil_scoped_release release;
+                std::unique_lock<std::mutex> lock{mx_};
+                space_.wait(lock, [this] {
+                    return stopping_ || queue_.size() < depth_;
+                });
+                if (stopping_) break;
+            }
+
+            py::object item;
+            std::exception_ptr error;
+            try {
+                PyObject* next = PyIter_Next(it_.ptr());
+                if (next)
+                    item = py::reinterpret_steal<py::object>(next);
+                else if (PyErr_Occurred())
+                    throw py::error_already_set();
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            const bool end = !item;
+            {
+                py::gil_scoped_release release;
+                std::lock_guard<std::mutex> lock{mx_};
+                if (end) {
+                    done_ = true;
+                    error_ = error;
+                } else {
+                    queue_.push_back(std::move(item));
+                }
+            }
+            ready_.notify_one();
+            if (end) break;
+        }
+    }
+
+    py::iterator it_;
+    size_t depth_;
+
+    std::mutex mx_;
+    std::condition_variable ready_;
+    std::condition_variable space_;
+    std::deque<py::object> queue_;
+    std::exception_ptr error_;
+    bool done_{false};
+    bool stopping_{false};
+    std::thread thread_;
+};
+
+// Batches the lidar packets of a python iterable of (sensor_idx, packet) on a
+// thread per sensor and collates the scans into frames natively, so that
+// python only sees finished frames. The feeding thread only holds the GIL to
+// pull the next packet from the source.
+class CollatedScans {
+   public:
+    CollatedScans(py::iterator it, const std::vector<sensor_info>& infos,
+                  const std::vector<LidarScanFieldTypes>& fields, int64_t dt,
+                  bool complete, size_t depth)
+        : it_{std::move(it)},
+          batcher_{infos, fields},
+          collator_{infos.size(), dt},
+          complete_{complete},
+          depth_{depth} {
+        if (depth_ == 0) throw std::invalid_argument("depth must be positive");
+        for (const auto& info : infos)
+            windows_.push_back(info.format.column_window);
+        live().insert(this);
+        thread_ = std::thread{[this]() { run(); }};
+    }
+
+    CollatedScans(const CollatedScans&) = delete;
+    CollatedScans& operator=(const CollatedScans&) = delete;
+
+    ~CollatedScans() {
+        close();
+        live().erase(this);
+    }
+
+    // the next frame as a list of scans or None, waiting for it with the GIL
+    // released
+    py::list next() {
+        ScanCollator::Frame frame;
+        std::exception_ptr error;
+        {
+            py::gil_scoped_release release;
+            std::unique_lock<std::mutex> lock{mx_};
+            ready_.wait(lock, [this] { return !frames_.empty() || done_; });
+            if (!frames_.empty()) {
+                frame = std::move(frames_.front());
+                frames_.pop_front();
+            } else {
+                std::swap(error, error_);
+            }
+        }
+        space_.notify_one();
+        if (error) std::rethrow_exception(error);
+        if (frame.empty()) throw py::stop_iteration();
+        py::list result;
+        for (auto& scan : frame) {
+            if (scan)
+                result.append(py::cast(std::move(scan)));
+            else
+                result.append(py::none());
+        }
+        return result;
+    }
+
+    // stop the thread and drop the frames not taken yet
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock{mx_};
+            stopping_ = true;
+        }
+        space_.notify_one();
+        std::thread thread = std::move(thread_);
+        if (thread.joinable()) {
+            py::gil_scoped_release release;
+            thread.join();
+        }
+        std::deque<ScanCollator::Frame> dropped;
+        {
+            std::lock_guard<std::mutex> lock{mx_};
+            dropped.swap(frames_);
+            done_ = true;
+        }
+        ready_.notify_all();
+    }
+
+    // stop the threads still running before the interpreter finalizes
+    static void close_all() {
+        while (!live().empty()) {
+            CollatedScans* scans = *live().begin();
+            live().erase(live().begin());
+            scans->close();
+        }
+    }
+
+   private:
+    static std::set<CollatedScans*>& live() {
+        static std::set<CollatedScans*> iterators;
+        return iterators;
+    }
+
+    void run() {
+        py::gil_scoped_acquire acquire;
+        std::exception_ptr error;
+        while (true) {
+            {
+                py::gil_scoped_release release;
+                std::unique_lock<std::mutex> lock{mx_};
+                space_.wait(lock, [this] {
+                    return stopping_ || frames_.size() < depth_;
+                });
+                if (stopping_) return;
+            }
+
+            py::object item;
+            try {
+                PyObject* next = PyIter_Next(it_.ptr());
+                if (next)
+                    item = py::reinterpret_steal<py::object>(next);
+                else if (PyErr_Occurred())
+                    throw py::error_already_set();
+            } catch (...) {
+                error = std::current_exception();
+            }
+            if (!item) break;
+
+            try {
+                auto pair = item.cast<py::tuple>();
+                py::object packet = pair[1];
+                if (!py::isinstance<LidarPacket>(packet)) continue;
+                const auto idx = pair[0].cast<size_t>();
+                const auto& lidar_packet = packet.cast<const LidarPacket&>();
+                py::gil_scoped_release release;
+                batcher_.push(idx, lidar_packet);
+                for (auto r = batcher_.try_pop(); r.second;
+                     r = batcher_.try_pop())
+                    collate(r.first, std::move(r.second));
+                publish(false, nullptr);
+            } catch (...) {
+                error = std::current_exception();
+                break;
+            }
+        }
+
+        py::gil_scoped_release release;
+        batcher_.finish();
+        for (auto r = batcher_.pop(); r.second; r = batcher_.pop())
+            collate(r.first, std::move(r.second));
+        // the partial last scans, as a single thread batching would hand out
+        for (auto& r : batcher_.take_unfinished())
+            collate(r.first, std::move(r.second));
+        collator_.flush();
+        publish(true, error);
+    }
+
+    void collate(int idx, std::unique_ptr<LidarScan> scan) {
+        if (complete_ && !scan->complete(windows_[idx])) return;
+        collator_.push(idx, std::move(scan));
+    }
+
+    // hand the finished frames to the consumer
+    void publish(bool end, std::exception_ptr error) {
+        {
+            std::lock_guard<std::mutex> lock{mx_};
+            while (collator_.ready()) frames_.push_back(collator_.pop());
+            if (end) {
+                done_ = true;
+                error_ = error;
+            }
+        }
+        ready_.notify_one();
+    }
+
+    py::iterator it_;
+    ParallelScanBatcher batcher_;
+    ScanCollator collator_;  // only used by the thread
+    std::vector<sensor::ColumnWindow> windows_;
+    bool complete_;
+    size_t depth_;
+
+    std::mutex mx_;
+    std::condition_variable ready_;
+    std::condition_variable space_;
+    std::deque<ScanCollator::Frame> frames_;
+    std::exception_ptr error_;
+    bool done_{false};
+    bool stopping_{false};
+    std::thread thread_;
+};
+
 void init_client(py::module& m, py::module&) {
     m.doc() = R"(
     Sensor client bindings generated by pybind11.
@@ -764,6 +1331,7 @@ void init_client(py::module& m, py::module&) {
               };
 
               auto iter = make_lambda_iter(append_pypacket);
+              py::gil_scoped_release release;
               impl::scan_to_packets(ls, pw, iter, init_id, prod_sn);
               return packets;
           });
@@ -1114,11 +1682,33 @@ void init_client(py::module& m, py::module&) {
         py::arg("log_level"), py::arg("log_file_path") = "",
         py::arg("rotating") = false, py::arg("max_size_in_bytes") = 0, py::arg("max_files") = 0);
 
+    m.def("tracing_compiled", &ouster::trace::tracing_compiled, R"(
+        Check whether the SDK was built with trace scopes, i.e. with the
+        OUSTER_TRACING cmake option. Without them the trace file stays empty.
+
+        Returns:
+            True if trace scopes are compiled in.
+        )");
+
+    m.def("start_trace_file", &ouster::trace::start_trace_file, R"(
+        Start recording the trace scopes of the SDK hot paths to a Chrome trace
+        JSON file, which chrome://tracing and ui.perfetto.dev open. The file is
+        complete once ``stop_trace`` is called.
+
+        Args:
+            path (str): trace file to write
+        )", py::arg("path"));
+
+    m.def("stop_trace", &ouster::trace::stop_trace, R"(
+        Stop tracing and close the trace file.
+        )");
+
     m.def("set_config", [] (const std::string& hostname, const sensor_config& config, bool persist,  bool udp_dest_auto, bool force_reinit) {
         uint8_t config_flags = 0;
         if (persist) config_flags |= ouster::sensor::CONFIG_PERSIST;
         if (udp_dest_auto) config_flags |= ouster::sensor::CONFIG_UDP_DEST_AUTO;
         if (force_reinit) config_flags |= ouster::sensor::CONFIG_FORCE_REINIT;
+        py::gil_scoped_release release;
         if (!sensor::set_config(hostname, config, config_flags)) {
             throw std::runtime_error("Error setting sensor config.");
         }
@@ -1139,6 +1729,7 @@ void init_client(py::module& m, py::module&) {
 
     m.def("get_config", [](const std::string& hostname, bool active) {
         sensor::sensor_config config;
+        py::gil_scoped_release release;
         if (!sensor::get_config(hostname, config, active)) {
             throw std::runtime_error("Error getting sensor config.");
         }
@@ -1176,6 +1767,7 @@ void init_client(py::module& m, py::module&) {
     py::class_<client_shared_ptr>(m, "SensorConnection")
         .def(py::init([](std::string hostname, int lidar_port,
                          int imu_port) -> client_shared_ptr {
+                 py::gil_scoped_release release;
                  auto cli = sensor::init_client(hostname, lidar_port, imu_port);
                  if (!cli)
                      throw std::runtime_error(
@@ -1189,6 +1781,7 @@ void init_client(py::module& m, py::module&) {
                          sensor::timestamp_mode ts_mode, int lidar_port,
                          int imu_port, int timeout_sec,
                          bool persist_config) -> client_shared_ptr {
+                 py::gil_scoped_release release;
                  auto cli = sensor::init_client(
                      hostname, udp_dest_host, lp_mode, ts_mode, lidar_port,
                      imu_port, timeout_sec, persist_config);
@@ -1210,15 +1803,18 @@ void init_client(py::module& m, py::module&) {
                int timeout_sec) -> sensor::client_state {
                 return sensor::poll_client(*self, timeout_sec);
             },
-            py::arg("timeout_sec") = 1)
+            py::arg("timeout_sec") = 1,
+            py::call_guard<py::gil_scoped_release>())
         .def("read_lidar_packet",
              [](const client_shared_ptr& self, LidarPacket& packet) -> bool {
                  return sensor::read_lidar_packet(*self, packet);
-             })
+             },
+             py::call_guard<py::gil_scoped_release>())
         .def("read_imu_packet",
              [](const client_shared_ptr& self, ImuPacket& packet) -> bool {
                  return sensor::read_imu_packet(*self, packet);
-             })
+             },
+             py::call_guard<py::gil_scoped_release>())
         .def_property_readonly("lidar_port",
                                [](const client_shared_ptr& self) -> int {
                                    return sensor::get_lidar_port(*self);
@@ -1232,7 +1828,8 @@ void init_client(py::module& m, py::module&) {
             [](client_shared_ptr& self, int timeout_sec) -> std::string {
                 return sensor::get_metadata(*self, timeout_sec);
             },
-            py::arg("timeout_sec") = LONG_HTTP_REQUEST_TIMEOUT_SECONDS)
+            py::arg("timeout_sec") = LONG_HTTP_REQUEST_TIMEOUT_SECONDS,
+            py::call_guard<py::gil_scoped_release>())
         .def("shutdown", [](client_shared_ptr& self) { self.reset(); });
 
     // New Client
@@ -1268,15 +1865,335 @@ void init_client(py::module& m, py::module&) {
             [](sensor::Sensor& self, int timeout) {
                 return self.fetch_metadata(timeout);
             },
-            py::arg("timeout") = LONG_HTTP_REQUEST_TIMEOUT_SECONDS)
+            py::arg("timeout") = LONG_HTTP_REQUEST_TIMEOUT_SECONDS,
+            py::call_guard<py::gil_scoped_release>())
         .def("http_client", &sensor::Sensor::http_client)
         .def("desired_config", &sensor::Sensor::desired_config)
         .def("hostname", &sensor::Sensor::hostname);
 
+    py::class_<sensor::LatencyStats>(m, "LatencyStats", R"(
+        Summary of recorded latencies, in nanoseconds.
+    )")
+        .def(py::init<>())
+        .def_readonly("count", &sensor::LatencyStats::count,
+                      "Number of latencies recorded.")
+        .def_readonly("min", &sensor::LatencyStats::min, "Smallest latency.")
+        .def_readonly("max", &sensor::LatencyStats::max, "Largest latency.")
+        .def_readonly("mean", &sensor::LatencyStats::mean, "Mean latency.")
+        .def_readonly("p50", &sensor::LatencyStats::p50, "Median latency.")
+        .def_readonly("p90", &sensor::LatencyStats::p90,
+                      "90th percentile latency.")
+        .def_readonly("p99", &sensor::LatencyStats::p99,
+                      "99th percentile latency.")
+        .def_readonly("p999", &sensor::LatencyStats::p999,
+                      "99.9th percentile latency.")
+        .def("__repr__", [](const sensor::LatencyStats& self) {
+            return "<LatencyStats count=" + std::to_string(self.count) +
+                   " p50=" + std::to_string(self.p50) +
+                   "ns p99=" + std::to_string(self.p99) +
+                   "ns max=" + std::to_string(self.max) + "ns>";
+        });
+
+    py::class_<sensor::ClientStats>(m, "ClientStats", R"(
+        Packet loss, throughput and latency of a SensorClient.
+    )")
+        .def(py::init<>())
+        .def_readonly("buffer_dropped_packets",
+                      &sensor::ClientStats::buffer_dropped_packets)
+        .def_readonly("kernel_dropped_packets",
+                      &sensor::ClientStats::kernel_dropped_packets)
+        .def_readonly("lidar_packets", &sensor::ClientStats::lidar_packets)
+        .def_readonly("imu_packets", &sensor::ClientStats::imu_packets)
+        .def_readonly("buffer_depth", &sensor::ClientStats::buffer_depth)
+        .def_readonly("max_buffer_depth",
+                      &sensor::ClientStats::max_buffer_depth)
+        .def_readonly("delivery_latency",
+                      &sensor::ClientStats::delivery_latency)
+        .def_readonly("buffer_thread_cpu_seconds",
+                      &sensor::ClientStats::buffer_thread_cpu_seconds);
+
+    py::class_<sensor::ScanSourceStats>(m, "ScanSourceStats", R"(
+        Loss counters and pipeline stage latencies of a SensorScanSource.
+    )")
+        .def(py::init<>())
+        .def_readonly("buffer_dropped_packets",
+                      &sensor::ScanSourceStats::buffer_dropped_packets)
+        .def_readonly("kernel_dropped_packets",
+                      &sensor::ScanSourceStats::kernel_dropped_packets)
+        .def_readonly("dropped_scans", &sensor::ScanSourceStats::dropped_scans)
+        .def_readonly("id_errors", &sensor::ScanSourceStats::id_errors)
+        .def_readonly("missing_frames",
+                      &sensor::ScanSourceStats::missing_frames)
+        .def_readonly("batched_packets",
+                      &sensor::ScanSourceStats::batched_packets)
+        .def_readonly("batched_scans", &sensor::ScanSourceStats::batched_scans)
+        .def_readonly("incomplete_scans",
+                      &sensor::ScanSourceStats::incomplete_scans)
+        .def_readonly("scans", &sensor::ScanSourceStats::scans)
+        .def_readonly("queue_depth", &sensor::ScanSourceStats::queue_depth)
+        .def_readonly("max_queue_depth",
+                      &sensor::ScanSourceStats::max_queue_depth)
+        .def_readonly("batch_latency", &sensor::ScanSourceStats::batch_latency)
+        .def_readonly("queue_latency", &sensor::ScanSourceStats::queue_latency)
+        .def_readonly("scan_latency", &sensor::ScanSourceStats::scan_latency)
+        .def_readonly("batch_thread_cpu_seconds",
+                      &sensor::ScanSourceStats::batch_thread_cpu_seconds)
+        .def_readonly("clients", &sensor::ScanSourceStats::clients)
+        .def_readonly("clocks", &sensor::ScanSourceStats::clocks);
+
+    py::class_<sensor::ClockEstimate>(m, "ClockEstimate", R"(
+        The fit of a ClockModel, host = sensor + offset_ns + skew * (sensor -
+        sensor_ts).
+    )")
+        .def(py::init<>())
+        .def_readonly("valid", &sensor::ClockEstimate::valid,
+                      "False until the first sample.")
+        .def_readonly("sensor_ts", &sensor::ClockEstimate::sensor_ts,
+                      "Sensor time in ns the offset refers to.")
+        .def_readonly("offset_ns", &sensor::ClockEstimate::offset_ns,
+                      "Host minus sensor time at sensor_ts.")
+        .def_readonly("skew_ppm", &sensor::ClockEstimate::skew_ppm,
+                      "Rate of the host clock over the sensor one, minus "
+                      "one, in parts per million.")
+        .def_readonly("intervals", &sensor::ClockEstimate::intervals,
+                      "Intervals with a sample the fit is based on.")
+        .def_readonly("residual_ns", &sensor::ClockEstimate::residual_ns,
+                      "Median distance of the samples to the fit.")
+        .def_readonly("resets", &sensor::ClockEstimate::resets,
+                      "Sensor clock resets seen.");
+
+    py::class_<sensor::ClockModel>(m, "ClockModel", R"(
+        Estimates the offset and skew of the clock of a sensor against the
+        host clock from sensor and host receive timestamps, fitting a robust
+        line through the least delayed sample of each interval of a window,
+        to map sensor timestamps to host time.
+    )")
+        .def(py::init([](double window_sec, size_t intervals,
+                         double reset_sec) {
+                 sensor::ClockModelOptions options;
+                 options.window_sec = window_sec;
+                 options.intervals = intervals;
+                 options.reset_sec = reset_sec;
+                 return sensor::ClockModel(options);
+             }),
+             py::arg("window_sec") = 10.0, py::arg("intervals") = 20,
+             py::arg("reset_sec") = 5.0)
+        .def("add",
+             py::overload_cast<uint64_t, uint64_t>(&sensor::ClockModel::add),
+             "Add a sensor timestamp and the host receive timestamp, in ns.",
+             py::arg("sensor_ts"), py::arg("host_ts"))
+        .def("add",
+             py::overload_cast<const LidarScan&>(&sensor::ClockModel::add),
+             "Add a sample per packet of a scan.", py::arg("scan"))
+        .def("estimate", &sensor::ClockModel::estimate, "Get the current fit.")
+        .def(
+            "to_host",
+            [](sensor::ClockModel& self, uint64_t sensor_ts) {
+                return self.to_host(sensor_ts);
+            },
+            "Convert a sensor time to host time, 0 without samples.",
+            py::arg("sensor_ts"))
+        .def(
+            "to_host",
+            [](sensor::ClockModel& self,
+               py::array_t<uint64_t, py::array::c_style | py::array::forcecast>
+                   sensor_ts) {
+                py::array_t<uint64_t> host_ts(sensor_ts.request().shape);
+                self.to_host(sensor_ts.data(), sensor_ts.size(),
+                             host_ts.mutable_data());
+                return host_ts;
+            },
+            R"(
+            Convert an array of sensor times to host time, e.g. the column
+            timestamps of a scan. Zeros stay zero.
+            )",
+            py::arg("sensor_ts"))
+        .def("reset", &sensor::ClockModel::reset, "Forget every sample.");
+
+    m.attr("HOST_TIMESTAMP_FIELD") = sensor::HOST_TIMESTAMP_FIELD;
+
+    // labels are passed as dicts, which keep their order
+    auto to_labels = [](const py::dict& labels) {
+        sensor::MetricLabels out;
+        for (const auto& item : labels) {
+            out.emplace_back(py::str(item.first), py::str(item.second));
+        }
+        return out;
+    };
+
+    py::class_<sensor::OpenMetrics>(m, "OpenMetrics", R"(
+        Builds an exposition of metrics in the OpenMetrics text format, for
+        Prometheus to scrape. Samples of the same metric are grouped under
+        one metric family whatever order they are added in.
+    )")
+        .def(py::init<>())
+        .def_property_readonly_static(
+            "content_type",
+            [](py::object) { return sensor::OpenMetrics::content_type; },
+            "HTTP content type to serve the exposition with.")
+        .def(
+            "counter",
+            [=](sensor::OpenMetrics& self, const std::string& name,
+                const std::string& help, double value, const py::dict& labels) {
+                self.counter(name, help, value, to_labels(labels));
+            },
+            "Add a sample of a counter, exposed as name_total.",
+            py::arg("name"), py::arg("help"), py::arg("value"),
+            py::arg("labels") = py::dict())
+        .def(
+            "gauge",
+            [=](sensor::OpenMetrics& self, const std::string& name,
+                const std::string& help, double value, const py::dict& labels) {
+                self.gauge(name, help, value, to_labels(labels));
+            },
+            "Add a sample of a gauge.", py::arg("name"), py::arg("help"),
+            py::arg("value"), py::arg("labels") = py::dict())
+        .def(
+            "summary",
+            [=](sensor::OpenMetrics& self, const std::string& name,
+                const std::string& help, const sensor::LatencyStats& stats,
+                const py::dict& labels) {
+                self.summary(name, help, stats, to_labels(labels));
+            },
+            "Add a latency summary, with its quantiles in seconds.",
+            py::arg("name"), py::arg("help"), py::arg("stats"),
+            py::arg("labels") = py::dict())
+        .def("__str__", &sensor::OpenMetrics::str);
+
+    m.def(
+        "add_metrics",
+        [=](sensor::OpenMetrics& metrics, const sensor::ScanSourceStats& stats,
+            const std::vector<sensor::sensor_info>& infos,
+            const py::dict& labels) {
+            sensor::add_metrics(metrics, stats, infos, to_labels(labels));
+        },
+        R"(
+        Add the health metrics of a SensorScanSource: per sensor packet and
+        scan rates, incomplete scans and missing frames, id errors, dropped
+        packets and scans, buffer and queue occupancy, and the stage latencies
+        when latency stats are enabled.
+
+        Args:
+            metrics: exposition to add to
+            stats: stats of the source
+            infos: sensors of the source, to label samples with
+            labels: labels of every sample, e.g. to tell sources apart
+        )",
+        py::arg("metrics"), py::arg("stats"), py::arg("infos"),
+        py::arg("labels") = py::dict());
+
+    m.def(
+        "add_metrics",
+        [=](sensor::OpenMetrics& metrics, const sensor::ClientStats& stats,
+            const py::dict& labels) {
+            sensor::add_metrics(metrics, stats, to_labels(labels));
+        },
+        R"(
+        Add the health metrics of a SensorClient: dropped packets, buffer
+        occupancy and, when latency stats are enabled, the delivery latency.
+        )",
+        py::arg("metrics"), py::arg("stats"), py::arg("labels") = py::dict());
+
+    py::class_<sensor::MissingColumns>(m, "MissingColumns", R"(
+        Consecutive columns of the column window missing from a frame.
+    )")
+        .def(py::init<>())
+        .def_readonly("frame_id", &sensor::MissingColumns::frame_id)
+        .def_readonly("first", &sensor::MissingColumns::first)
+        .def_readonly("last", &sensor::MissingColumns::last)
+        .def("__repr__", [](const sensor::MissingColumns& self) {
+            return "<MissingColumns frame_id=" +
+                   std::to_string(self.frame_id) +
+                   " first=" + std::to_string(self.first) +
+                   " last=" + std::to_string(self.last) + ">";
+        });
+
+    py::class_<sensor::PacketStreamStats>(m, "PacketStreamStats", R"(
+        Counters and distributions of a PacketStreamAnalyzer. Inter-arrival
+        times and jitter are in nanoseconds, rates in packets per second.
+    )")
+        .def(py::init<>())
+        .def_readonly("lidar_packets",
+                      &sensor::PacketStreamStats::lidar_packets)
+        .def_readonly("imu_packets", &sensor::PacketStreamStats::imu_packets)
+        .def_readonly("invalid_packets",
+                      &sensor::PacketStreamStats::invalid_packets)
+        .def_readonly("frames", &sensor::PacketStreamStats::frames)
+        .def_readonly("incomplete_frames",
+                      &sensor::PacketStreamStats::incomplete_frames)
+        .def_readonly("missing_columns",
+                      &sensor::PacketStreamStats::missing_columns)
+        .def_readonly("missing_frames",
+                      &sensor::PacketStreamStats::missing_frames)
+        .def_readonly("late_packets", &sensor::PacketStreamStats::late_packets)
+        .def_readonly("reordered_packets",
+                      &sensor::PacketStreamStats::reordered_packets)
+        .def_readonly("duplicate_columns",
+                      &sensor::PacketStreamStats::duplicate_columns)
+        .def_readonly("timestamp_regressions",
+                      &sensor::PacketStreamStats::timestamp_regressions)
+        .def_readonly("reinits", &sensor::PacketStreamStats::reinits)
+        .def_readonly("lidar_interarrival",
+                      &sensor::PacketStreamStats::lidar_interarrival)
+        .def_readonly("lidar_jitter", &sensor::PacketStreamStats::lidar_jitter)
+        .def_readonly("imu_interarrival",
+                      &sensor::PacketStreamStats::imu_interarrival)
+        .def_readonly("imu_jitter", &sensor::PacketStreamStats::imu_jitter)
+        .def_readonly("lidar_rate", &sensor::PacketStreamStats::lidar_rate)
+        .def_readonly("min_lidar_rate",
+                      &sensor::PacketStreamStats::min_lidar_rate)
+        .def_readonly("max_lidar_rate",
+                      &sensor::PacketStreamStats::max_lidar_rate)
+        .def_readonly("expected_lidar_rate",
+                      &sensor::PacketStreamStats::expected_lidar_rate)
+        .def_readonly("imu_rate", &sensor::PacketStreamStats::imu_rate)
+        .def_readonly("min_imu_rate", &sensor::PacketStreamStats::min_imu_rate)
+        .def_readonly("max_imu_rate", &sensor::PacketStreamStats::max_imu_rate)
+        .def_readonly("expected_imu_rate",
+                      &sensor::PacketStreamStats::expected_imu_rate)
+        .def_readonly("missing_ranges",
+                      &sensor::PacketStreamStats::missing_ranges);
+
+    py::class_<sensor::PacketStreamAnalyzer>(m, "PacketStreamAnalyzer", R"(
+        Analyzes the packets of one sensor, from a sensor, pcap or OSF
+        source: frame completeness, missing measurement id ranges, frame id
+        gaps, column timestamp monotonicity, and the jitter and rate
+        stability of lidar and IMU packets.
+    )")
+        .def(py::init<const sensor::sensor_info&, size_t>(), py::arg("info"),
+             py::arg("max_missing_ranges") = 64)
+        .def(
+            "__call__",
+            [](sensor::PacketStreamAnalyzer& self, const Packet& packet) {
+                self(packet);
+            },
+            py::arg("packet"), py::call_guard<py::gil_scoped_release>(),
+            "Analyze a packet of the sensor.")
+        .def("flush", &sensor::PacketStreamAnalyzer::flush,
+             "Complete the frame in progress, e.g. at the end of a recording.")
+        .def("reset", &sensor::PacketStreamAnalyzer::reset,
+             "Forget everything analyzed so far.")
+        .def("stats", &sensor::PacketStreamAnalyzer::stats,
+             "Get the counters and distributions analyzed so far.");
+
+    m.def(
+        "add_metrics",
+        [=](sensor::OpenMetrics& metrics,
+            const sensor::PacketStreamStats& stats, const py::dict& labels) {
+            sensor::add_metrics(metrics, stats, to_labels(labels));
+        },
+        R"(
+        Add the stream health metrics of a PacketStreamAnalyzer: lost frames
+        and columns, late, reordered and duplicate data, column timestamp
+        regressions, packet rates and jitter.
+        )",
+        py::arg("metrics"), py::arg("stats"), py::arg("labels") = py::dict());
+
     py::class_<sensor::SensorClient>(m, "SensorClient")
         .def(py::init([](std::vector<sensor::Sensor> sensors,
                          double config_timeout,
                          double buffer_time) -> sensor::SensorClient* {
+                 py::gil_scoped_release release;
                  return new sensor::SensorClient(sensors, config_timeout,
                                                  buffer_time);
              }),
@@ -1287,6 +2204,7 @@ void init_client(py::module& m, py::module&) {
                          std::vector<sensor::sensor_info> metadata,
                          double config_timeout,
                          double buffer_size) -> sensor::SensorClient* {
+                 py::gil_scoped_release release;
                  return new sensor::SensorClient(sensors, metadata,
                                                  config_timeout, buffer_size);
              }),
@@ -1295,9 +2213,18 @@ void init_client(py::module& m, py::module&) {
              py::arg("buffer_time") = 0)
         .def("get_sensor_info",
              [](sensor::SensorClient& self) { return self.get_sensor_info(); })
-        .def("flush", &sensor::SensorClient::flush)
-        .def("close", &sensor::SensorClient::close)
+        .def("flush", &sensor::SensorClient::flush,
+             py::call_guard<py::gil_scoped_release>())
+        .def("close", &sensor::SensorClient::close,
+             py::call_guard<py::gil_scoped_release>())
         .def("buffer_size", &sensor::SensorClient::buffer_size)
+        .def("stats", &sensor::SensorClient::stats,
+             py::call_guard<py::gil_scoped_release>(),
+             "Packet loss, throughput and latency counters.")
+        .def("enable_latency_stats",
+             &sensor::SensorClient::enable_latency_stats,
+             py::arg("enable") = true,
+             "Start or stop recording packet counts and latencies.")
         .def(
             "get_packet",
             [](sensor::SensorClient& self, double timeout) {
@@ -1307,10 +2234,66 @@ void init_client(py::module& m, py::module&) {
             },
             py::arg("timeout") = 0.1);
 
+    py::class_<sensor::RelayDestination>(m, "RelayDestination")
+        .def(py::init([](const std::string& host, int lidar_port, int imu_port,
+                         int source) {
+                 return sensor::RelayDestination{host, lidar_port, imu_port,
+                                                 source};
+             }),
+             py::arg("host"), py::arg("lidar_port") = 7502,
+             py::arg("imu_port") = 7503, py::arg("source") = -1)
+        .def_readwrite("host", &sensor::RelayDestination::host)
+        .def_readwrite("lidar_port", &sensor::RelayDestination::lidar_port)
+        .def_readwrite("imu_port", &sensor::RelayDestination::imu_port)
+        .def_readwrite("source", &sensor::RelayDestination::source);
+
+    py::class_<sensor::PacketRelayOptions>(m, "PacketRelayOptions")
+        .def(py::init<>())
+        .def_readwrite("batch_size", &sensor::PacketRelayOptions::batch_size)
+        .def_readwrite("multicast_ttl",
+                       &sensor::PacketRelayOptions::multicast_ttl)
+        .def_readwrite("multicast_interface",
+                       &sensor::PacketRelayOptions::multicast_interface)
+        .def_readwrite("multicast_loop",
+                       &sensor::PacketRelayOptions::multicast_loop)
+        .def_readwrite("shm_name", &sensor::PacketRelayOptions::shm_name)
+        .def_readwrite("shm_slots", &sensor::PacketRelayOptions::shm_slots);
+
+    py::class_<sensor::RelayDestinationStats>(m, "RelayDestinationStats")
+        .def_readonly("packets", &sensor::RelayDestinationStats::packets)
+        .def_readonly("bytes", &sensor::RelayDestinationStats::bytes)
+        .def_readonly("errors", &sensor::RelayDestinationStats::errors);
+
+    py::class_<sensor::PacketRelayStats>(m, "PacketRelayStats")
+        .def_readonly("lidar_packets", &sensor::PacketRelayStats::lidar_packets)
+        .def_readonly("imu_packets", &sensor::PacketRelayStats::imu_packets)
+        .def_readonly("batches", &sensor::PacketRelayStats::batches)
+        .def_readonly("shm_packets", &sensor::PacketRelayStats::shm_packets)
+        .def_readonly("destinations",
+                      &sensor::PacketRelayStats::destinations);
+
+    py::class_<sensor::PacketRelay>(m, "PacketRelay", R"(
+        Fans out the packets of a SensorClient to several UDP or multicast
+        destinations and, optionally, a shared memory ring, on a native
+        thread.
+        )")
+        .def(py::init<const std::vector<sensor::sensor_info>&,
+                      const std::vector<sensor::RelayDestination>&,
+                      const sensor::PacketRelayOptions&>(),
+             py::arg("infos"), py::arg("destinations"),
+             py::arg("options") = sensor::PacketRelayOptions{})
+        .def("start", &sensor::PacketRelay::start, py::arg("client"),
+             py::keep_alive<1, 2>(),
+             "Receive packets from the client and forward them until stopped.")
+        .def("stop", &sensor::PacketRelay::stop,
+             py::call_guard<py::gil_scoped_release>())
+        .def("stats", &sensor::PacketRelay::stats);
+
     py::class_<sensor::SensorScanSource>(m, "SensorScanSource")
         .def(py::init([](std::vector<sensor::Sensor> sensors, double timeout,
                          unsigned int queue_size,
                          bool soft_id_check) -> sensor::SensorScanSource* {
+                 py::gil_scoped_release release;
                  return new sensor::SensorScanSource(sensors, timeout,
                                                      queue_size, soft_id_check);
              }),
@@ -1321,6 +2304,7 @@ void init_client(py::module& m, py::module&) {
                          std::vector<sensor::sensor_info> metadata,
                          double timeout, unsigned int queue_size,
                          bool soft_id_check) -> sensor::SensorScanSource* {
+                 py::gil_scoped_release release;
                  return new sensor::SensorScanSource(sensors, metadata, timeout,
                                                      queue_size, soft_id_check);
              }),
@@ -1332,6 +2316,7 @@ void init_client(py::module& m, py::module&) {
                          const std::vector<std::vector<FieldType>>& field_types,
                          double timeout, unsigned int queue_size,
                          bool soft_id_check) -> sensor::SensorScanSource* {
+                 py::gil_scoped_release release;
                  return new sensor::SensorScanSource(sensors, metadata,
                                                      field_types, timeout,
                                                      queue_size, soft_id_check);
@@ -1343,10 +2328,19 @@ void init_client(py::module& m, py::module&) {
              [](sensor::SensorScanSource& self) {
                  return self.get_sensor_info();
              })
-        .def("flush", &sensor::SensorScanSource::flush)
-        .def("close", &sensor::SensorScanSource::close)
+        .def("flush", &sensor::SensorScanSource::flush,
+             py::call_guard<py::gil_scoped_release>())
+        .def("close", &sensor::SensorScanSource::close,
+             py::call_guard<py::gil_scoped_release>())
         .def("dropped_scans", &sensor::SensorScanSource::dropped_scans)
         .def("id_error_count", &sensor::SensorScanSource::id_error_count)
+        .def("stats", &sensor::SensorScanSource::stats,
+             py::call_guard<py::gil_scoped_release>(),
+             "Loss counters and the latency of each pipeline stage.")
+        .def("enable_latency_stats",
+             &sensor::SensorScanSource::enable_latency_stats,
+             py::arg("enable") = true,
+             "Start or stop recording scan counts and stage latencies.")
         .def(
             "get_scan",
             [](sensor::SensorScanSource& self, double timeout) {
@@ -1840,6 +2834,26 @@ void init_client(py::module& m, py::module&) {
                        "The SensorInfo associated with this LidarScan.")
         .def("__eq__",
              [](const LidarScan& l, const LidarScan& r) { return l == r; })
+        .def(
+            "content_hash",
+            [](const LidarScan& self) { return content_hash(self); },
+            R"(
+        Return a 64-bit hash of what ``==`` compares, the same on every
+        platform and run, e.g. to deduplicate recordings by comparing only
+        scans of equal hashes. Not cached, the scan may change.
+        )")
+        .def(
+            "field_hash",
+            [](const LidarScan& self, const std::string& name) {
+                return content_hash(self.field(name));
+            },
+            R"(
+        Return a 64-bit hash of the type, shape and contents of a field.
+
+        Raises:
+            IndexError: if the scan has no field of the name
+        )",
+            py::arg("name"))
         .def("__copy__", [](const LidarScan& self) { return LidarScan{self}; })
         .def("__deepcopy__",
              [](const LidarScan& self, py::dict) { return LidarScan{self}; })
@@ -1853,69 +2867,94 @@ void init_client(py::module& m, py::module&) {
         .def("__str__", [](const LidarScan& self) { return to_string(self); });
 
     // Destagger overloads for most numpy scalar types
-    m.def("destagger_int8", &ouster::destagger<int8_t>);
-    m.def("destagger_int16", &ouster::destagger<int16_t>);
-    m.def("destagger_int32", &ouster::destagger<int32_t>);
-    m.def("destagger_int64", &ouster::destagger<int64_t>);
-    m.def("destagger_uint8", &ouster::destagger<uint8_t>);
-    m.def("destagger_uint16", &ouster::destagger<uint16_t>);
-    m.def("destagger_uint32", &ouster::destagger<uint32_t>);
-    m.def("destagger_uint64", &ouster::destagger<uint64_t>);
-    m.def("destagger_float", &ouster::destagger<float>);
-    m.def("destagger_double", &ouster::destagger<double>);
+    def_destagger<int8_t>(m, "destagger_int8");
+    def_destagger<int16_t>(m, "destagger_int16");
+    def_destagger<int32_t>(m, "destagger_int32");
+    def_destagger<int64_t>(m, "destagger_int64");
+    def_destagger<uint8_t>(m, "destagger_uint8");
+    def_destagger<uint16_t>(m, "destagger_uint16");
+    def_destagger<uint32_t>(m, "destagger_uint32");
+    def_destagger<uint64_t>(m, "destagger_uint64");
+    def_destagger<float>(m, "destagger_float");
+    def_destagger<double>(m, "destagger_double");
 
     py::class_<SensorHttp>(m, "SensorHttp")
         .def("metadata", &SensorHttp::metadata,
-             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS)
+             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS,
+             py::call_guard<py::gil_scoped_release>())
         .def("sensor_info", &SensorHttp::sensor_info,
-             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS)
+             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS,
+             py::call_guard<py::gil_scoped_release>())
         .def("get_config_params", &SensorHttp::get_config_params,
              py::arg("active"),
-             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS)
+             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS,
+             py::call_guard<py::gil_scoped_release>())
         .def("set_config_param", &SensorHttp::set_config_param, py::arg("key"),
              py::arg("value"),
-             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS)
+             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS,
+             py::call_guard<py::gil_scoped_release>())
         .def("active_config_params", &SensorHttp::active_config_params,
-             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS)
+             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS,
+             py::call_guard<py::gil_scoped_release>())
         .def("staged_config_params", &SensorHttp::staged_config_params,
-             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS)
+             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS,
+             py::call_guard<py::gil_scoped_release>())
         .def("set_udp_dest_auto", &SensorHttp::set_udp_dest_auto,
-             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS)
+             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS,
+             py::call_guard<py::gil_scoped_release>())
         .def("beam_intrinsics", &SensorHttp::beam_intrinsics,
-             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS)
+             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS,
+             py::call_guard<py::gil_scoped_release>())
         .def("imu_intrinsics", &SensorHttp::imu_intrinsics,
-             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS)
+             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS,
+             py::call_guard<py::gil_scoped_release>())
         .def("lidar_intrinsics", &SensorHttp::lidar_intrinsics,
-             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS)
+             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS,
+             py::call_guard<py::gil_scoped_release>())
         .def("lidar_data_format", &SensorHttp::lidar_data_format,
-             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS)
+             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS,
+             py::call_guard<py::gil_scoped_release>())
         .def("reinitialize", &SensorHttp::reinitialize,
-             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS)
+             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS,
+             py::call_guard<py::gil_scoped_release>())
         .def("save_config_params", &SensorHttp::save_config_params,
-             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS)
+             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS,
+             py::call_guard<py::gil_scoped_release>())
         .def("get_user_data", &SensorHttp::get_user_data,
-             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS)
+             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS,
+             py::call_guard<py::gil_scoped_release>())
         // TODO: get_user_data_and_policy is hard to bind, bind later if needed
         .def("set_user_data", &SensorHttp::set_user_data, py::arg("data"),
              py::arg("keep_on_config_delete") = true,
-             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS)
+             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS,
+             py::call_guard<py::gil_scoped_release>())
         .def("delete_user_data", &SensorHttp::delete_user_data,
-             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS)
+             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS,
+             py::call_guard<py::gil_scoped_release>())
         .def("network", &SensorHttp::network,
-             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS)
+             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS,
+             py::call_guard<py::gil_scoped_release>())
         .def("set_static_ip", &SensorHttp::set_static_ip, py::arg("ip_address"),
-             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS)
+             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS,
+             py::call_guard<py::gil_scoped_release>())
         .def("delete_static_ip", &SensorHttp::delete_static_ip,
-             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS)
+             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS,
+             py::call_guard<py::gil_scoped_release>())
         .def(
             "diagnostics_dump",
             [](SensorHttp& self, int timeout_sec) {
-                auto vec = self.diagnostics_dump(timeout_sec);
+                std::vector<uint8_t> vec;
+                {
+                    py::gil_scoped_release release;
+                    vec = self.diagnostics_dump(timeout_sec);
+                }
                 return py::bytes((const char*)vec.data(), vec.size());
             },
             py::arg("timeout_sec") = LONG_HTTP_REQUEST_TIMEOUT_SECONDS)
-        .def("firmware_version",
-             [](SensorHttp& self) { return self.firmware_version(); })
+        .def(
+            "firmware_version",
+            [](SensorHttp& self) { return self.firmware_version(); },
+            py::call_guard<py::gil_scoped_release>())
         .def("hostname", &SensorHttp::hostname)
         .def_static(
             "create",
@@ -1923,7 +2962,92 @@ void init_client(py::module& m, py::module&) {
                 return SensorHttp::create(hostname, timeout_sec);
             },
             py::arg("hostname"),
-            py::arg("timeout_sec") = LONG_HTTP_REQUEST_TIMEOUT_SECONDS);
+            py::arg("timeout_sec") = LONG_HTTP_REQUEST_TIMEOUT_SECONDS,
+            py::call_guard<py::gil_scoped_release>());
+
+    py::class_<HttpResponse>(m, "HttpResponse",
+                             "Response of a sensor to a MultiSensorHttp request")
+        .def_readonly("status", &HttpResponse::status,
+                      "HTTP status code, 0 without a response")
+        .def_readonly("body", &HttpResponse::body)
+        .def_readonly("error", &HttpResponse::error,
+                      "Transport error, empty if there was a response")
+        .def("ok", &HttpResponse::ok, "True for a 2XX status");
+
+    py::class_<MultiSensorHttp>(m, "MultiSensorHttp", R"(
+        Sends the same request to many sensors at once from a single thread,
+        e.g. to discover or poll the health of a fleet of sensors. Connections
+        are kept alive between requests.
+        )")
+        .def(py::init<const std::vector<std::string>&>(), py::arg("hostnames"))
+        .def("get", &MultiSensorHttp::get,
+             py::call_guard<py::gil_scoped_release>(), R"(
+        Execute a GET request towards the url on every sensor concurrently.
+
+        Args:
+          url: http request url, e.g. "api/v1/sensor/metadata"
+          timeout_sec: timeout for the request in seconds
+
+        Returns:
+          The HttpResponse of each sensor, in the order of the hostnames
+        )",
+             py::arg("url"),
+             py::arg("timeout_sec") = SHORT_HTTP_REQUEST_TIMEOUT_SECONDS)
+        .def_property_readonly("hostnames", &MultiSensorHttp::hostnames);
+
+    py::class_<sensor::DiscoveredSensor>(m, "DiscoveredSensor",
+                                         "A sensor found by discover_sensors")
+        .def_readonly("address", &sensor::DiscoveredSensor::address,
+                      "IPv4 address the sensor answered from")
+        .def_readonly("hostname", &sensor::DiscoveredSensor::hostname)
+        .def_readonly("sn", &sensor::DiscoveredSensor::sn)
+        .def_readonly("prod_line", &sensor::DiscoveredSensor::prod_line)
+        .def_readonly("image_rev", &sensor::DiscoveredSensor::image_rev)
+        .def_readonly("status", &sensor::DiscoveredSensor::status)
+        .def_readonly("sensor_info", &sensor::DiscoveredSensor::sensor_info,
+                      "json of the sensor_info of the sensor")
+        .def_readonly("error", &sensor::DiscoveredSensor::error,
+                      "Why the sensor_info couldn't be read, or empty")
+        .def("ok", &sensor::DiscoveredSensor::ok,
+             "True if the sensor_info was read");
+
+    m.def(
+        "discover_sensors",
+        [](double timeout_sec, int http_timeout_sec,
+           const std::string& interface_address, py::object on_sensor) {
+            sensor::DiscoveryOptions options;
+            options.timeout_sec = timeout_sec;
+            options.http_timeout_sec = http_timeout_sec;
+            options.interface_address = interface_address;
+            sensor::DiscoveryCallback callback;
+            if (!on_sensor.is_none()) {
+                auto fn = std::make_shared<py::object>(on_sensor);
+                callback = [fn](const sensor::DiscoveredSensor& found) {
+                    py::gil_scoped_acquire acquire;
+                    (*fn)(found);
+                };
+            }
+            py::gil_scoped_release release;
+            return sensor::discover_sensors(options, callback);
+        },
+        R"(
+        Find the sensors of the network with an mDNS query, reading the
+        sensor_info of every sensor answering concurrently while still
+        listening for more answers. IPv4 only.
+
+        Args:
+          timeout_sec: how long to listen for answers
+          http_timeout_sec: timeout of the sensor_info request of each sensor
+          interface_address: IPv4 address of the interface to query on, or
+                             empty for the default
+          on_sensor: called with each DiscoveredSensor as soon as it was
+                     probed, or None
+
+        Returns:
+          Every DiscoveredSensor, in the order they were probed
+        )",
+        py::arg("timeout_sec") = 5.0, py::arg("http_timeout_sec") = 1,
+        py::arg("interface_address") = "", py::arg("on_sensor") = py::none());
 
     py::class_<ScanBatcher>(m, "ScanBatcher")
         .def(py::init<int, packet_format>())
@@ -1931,32 +3055,292 @@ void init_client(py::module& m, py::module&) {
         .def("__call__",
              [](ScanBatcher& self, py::buffer& buf, LidarScan& ls) {
                  uint8_t* ptr = getptr(self.pf.lidar_packet_size, buf);
+                 py::gil_scoped_release release;
                  return self(ptr, 0, ls);
              })
         .def(
             "__call__",
             [](ScanBatcher& self, py::buffer& buf, uint64_t ts, LidarScan& ls) {
                 uint8_t* ptr = getptr(self.pf.lidar_packet_size, buf);
+                py::gil_scoped_release release;
                 return self(ptr, ts, ls);
             })
-        .def("__call__", [](ScanBatcher& self, LidarPacket& packet,
-                            LidarScan& ls) { return self(packet, ls); });
+        .def(
+            "__call__",
+            [](ScanBatcher& self, LidarPacket& packet, LidarScan& ls) {
+                return self(packet, ls);
+            },
+            py::call_guard<py::gil_scoped_release>());
+
+    py::class_<ReframeWindow>(m, "ReframeWindow", R"(
+        Where the scans of a ReframingBatcher start and end: every width
+        columns from start_col on, or at the first column at or after each
+        multiple of period_ns plus offset_ns if period_ns is not zero.
+        )")
+        .def(py::init([](size_t width, size_t start_col, uint64_t period_ns,
+                         uint64_t offset_ns) {
+                 return ReframeWindow{width, start_col, period_ns, offset_ns};
+             }),
+             py::arg("width") = 0, py::arg("start_col") = 0,
+             py::arg("period_ns") = 0, py::arg("offset_ns") = 0)
+        .def_readwrite("width", &ReframeWindow::width)
+        .def_readwrite("start_col", &ReframeWindow::start_col)
+        .def_readwrite("period_ns", &ReframeWindow::period_ns)
+        .def_readwrite("offset_ns", &ReframeWindow::offset_ns);
+
+    py::class_<ReframingBatcher>(m, "ReframingBatcher", R"(
+        Batches lidar packets straight into scans of windows of columns other
+        than the frames of the sensor, e.g. starting at another azimuth or at
+        time boundaries aligned across sensors. Scans have scan_width columns.
+        )")
+        .def(py::init<const sensor_info&, const ReframeWindow&>(),
+             py::arg("info"), py::arg("window") = ReframeWindow{})
+        .def(
+            "__call__",
+            [](ReframingBatcher& self, LidarPacket& packet, LidarScan& ls) {
+                return self(packet, ls);
+            },
+            py::call_guard<py::gil_scoped_release>(),
+            "Add a packet to the scan, returning True when it is complete",
+            py::arg("packet"), py::arg("ls"))
+        .def("finish_scan", &ReframingBatcher::finish_scan,
+             "Finish the scan being batched, e.g. the last one of a recording",
+             py::arg("ls"))
+        .def_property_readonly("scan_width", &ReframingBatcher::scan_width)
+        .def_property_readonly("window", &ReframingBatcher::window)
+        .def_property_readonly("dropped_columns",
+                               &ReframingBatcher::dropped_columns);
+
+    py::class_<ShmScanWriter>(m, "ShmScanWriter", R"(
+        Publishes LidarScans to other processes through a named ring of scans
+        in POSIX shared memory, see ShmScanReader.
+        )")
+        .def(py::init<const std::string&, size_t, size_t,
+                      const LidarScanFieldTypes&, size_t, size_t,
+                      const std::string&>(),
+             py::arg("name"), py::arg("w"), py::arg("h"), py::arg("fields"),
+             py::arg("slots") = 4,
+             py::arg("columns_per_packet") = DEFAULT_COLUMNS_PER_PACKET,
+             py::arg("metadata") = "")
+        .def(py::init<const std::string&, const sensor_info&,
+                      const LidarScanFieldTypes&, size_t>(),
+             py::arg("name"), py::arg("info"),
+             py::arg("fields") = LidarScanFieldTypes{}, py::arg("slots") = 4)
+        .def("publish", &ShmScanWriter::publish, py::arg("scan"),
+             py::call_guard<py::gil_scoped_release>(),
+             "Copy a scan into the ring and publish it to readers.")
+        .def_property_readonly("published", &ShmScanWriter::published)
+        .def_property_readonly("field_types", &ShmScanWriter::field_types);
+
+    py::class_<ShmScanReader>(m, "ShmScanReader", R"(
+        Maps a channel created by ShmScanWriter. Fields are returned as
+        read only numpy views of the shared memory, valid until the next call
+        to next() or until the writer overwrites the scan, see valid().
+        )")
+        .def(py::init<const std::string&>(), py::arg("name"))
+        .def(
+            "next",
+            [](ShmScanReader& self) { return self.next() != nullptr; },
+            R"(
+        Move on to the next published scan without waiting.
+
+        Returns:
+            False if no scan was published since the last one read
+        )")
+        .def("valid", &ShmScanReader::valid,
+             "Check that the current scan hasn't been overwritten.")
+        .def(
+            "field",
+            [](py::object self, const std::string& name) {
+                const LidarScan& scan = current_shm_scan(self);
+                const Field& field = scan.field(name);
+                py::array arr(dtype_of_field_type(field.tag()),
+                              shape_of_descriptor(field.desc()),
+                              field.get(), self);
+                arr.attr("setflags")(py::arg("write") = false);
+                return arr;
+            },
+            py::arg("name"),
+            "Return a read only view of a field of the current scan.")
+        .def_property_readonly(
+            "timestamp",
+            [](py::object self) {
+                const LidarScan& scan = current_shm_scan(self);
+                py::array arr(py::dtype::of<uint64_t>(), scan.w,
+                              scan.timestamp().data(), self);
+                arr.attr("setflags")(py::arg("write") = false);
+                return arr;
+            },
+            "Read only view of the column timestamps of the current scan.")
+        .def_property_readonly(
+            "frame_id",
+            [](py::object self) { return current_shm_scan(self).frame_id; })
+        .def(
+            "scan",
+            [](py::object self) { return LidarScan(current_shm_scan(self)); },
+            "Return a copy of the current scan.")
+        .def_property_readonly("dropped", &ShmScanReader::dropped)
+        .def_property_readonly("published", &ShmScanReader::published)
+        .def_property_readonly("field_types", &ShmScanReader::field_types)
+        .def_property_readonly("metadata", &ShmScanReader::metadata);
+
+    py::class_<ScanStreamRequest>(m, "ScanStreamRequest", R"(
+        What a ScanStreamClient asks a ScanStreamServer to send it.
+        )")
+        .def(py::init<>())
+        .def_readwrite("fields", &ScanStreamRequest::fields)
+        .def_readwrite("decimation", &ScanStreamRequest::decimation)
+        .def_readwrite("compress", &ScanStreamRequest::compress)
+        .def_readwrite("max_range_error", &ScanStreamRequest::max_range_error)
+        .def_readwrite("queue_depth", &ScanStreamRequest::queue_depth);
+
+    py::class_<ScanStreamStats>(m, "ScanStreamStats")
+        .def_readonly("clients", &ScanStreamStats::clients)
+        .def_readonly("rejected", &ScanStreamStats::rejected)
+        .def_readonly("scans_sent", &ScanStreamStats::scans_sent)
+        .def_readonly("bytes_sent", &ScanStreamStats::bytes_sent)
+        .def_readonly("scans_dropped", &ScanStreamStats::scans_dropped);
+
+    py::class_<ScanStreamServer>(m, "ScanStreamServer", R"(
+        Serves the scans published to it to ScanStreamClients connecting over
+        TCP. Clients falling behind skip to the latest scans.
+        )")
+        .def(py::init<const sensor_info&, int, const std::string&>(),
+             py::arg("info"), py::arg("port") = 0, py::arg("address") = "")
+        .def(
+            "publish",
+            [](ScanStreamServer& self, const LidarScan& scan) {
+                auto copy = std::make_shared<const LidarScan>(scan);
+                py::gil_scoped_release release;
+                return self.publish(std::move(copy));
+            },
+            py::arg("scan"),
+            "Queue a copy of a scan for every connected client, returning "
+            "the number of clients.")
+        .def("close", &ScanStreamServer::close,
+             py::call_guard<py::gil_scoped_release>())
+        .def_property_readonly("port", &ScanStreamServer::port)
+        .def_property_readonly("clients", &ScanStreamServer::clients)
+        .def_property_readonly("stats", &ScanStreamServer::stats);
+
+    py::class_<ScanStreamClient>(m, "ScanStreamClient", R"(
+        Receives the scans of a ScanStreamServer.
+        )")
+        .def(py::init<const std::string&, int, const ScanStreamRequest&,
+                      double>(),
+             py::arg("host"), py::arg("port"),
+             py::arg("request") = ScanStreamRequest{},
+             py::arg("timeout_sec") = 5.0,
+             py::call_guard<py::gil_scoped_release>())
+        .def_property_readonly("sensor_info", &ScanStreamClient::sensor_info)
+        .def("get_scan", &ScanStreamClient::get_scan,
+             py::arg("timeout_sec") = -1.0,
+             py::call_guard<py::gil_scoped_release>(),
+             R"(
+        Receive the next scan.
+
+        Returns:
+            The scan, or None on timeout or once the server closed the stream
+        )")
+        .def_property_readonly("closed", &ScanStreamClient::closed)
+        .def("close", &ScanStreamClient::close,
+             py::call_guard<py::gil_scoped_release>());
+
+    py::class_<ScanPrefetcher>(m, "ScanPrefetcher", R"(
+        Iterates a scan source on a native thread, reading up to ``depth``
+        scans ahead while the current one is processed. Exceptions raised by
+        the source are raised by the iteration that would have returned the
+        next scan.
+        )")
+        .def(py::init([](py::iterable source, size_t depth) {
+                 return std::make_unique<ScanPrefetcher>(py::iter(source),
+                                                         depth);
+             }),
+             py::arg("source"), py::arg("depth") = 2)
+        .def("__iter__",
+             [](ScanPrefetcher& self) -> ScanPrefetcher& { return self; },
+             py::return_value_policy::reference_internal)
+        .def("__next__", &ScanPrefetcher::next)
+        .def("close", &ScanPrefetcher::close,
+             "Stop reading ahead, once the scan being read is, and drop the "
+             "scans read.")
+        .def_property_readonly("depth", &ScanPrefetcher::depth);
+
+    py::module::import("atexit").attr("register")(
+        py::cpp_function(&ScanPrefetcher::close_all));
+
+    py::class_<CollatedScans>(m, "CollatedScans", R"(
+        Batches the lidar packets of an iterable of ``(sensor_idx, packet)``
+        into scans with a native thread per sensor, and collates the scans
+        into lists with one scan or None per sensor, cut every ``dt`` ns as
+        ``collate_scans`` does. Other packets are skipped. Exceptions raised
+        by the source are raised once the frames before them are returned.
+        )")
+        .def(py::init([](py::iterable source,
+                         const std::vector<sensor_info>& infos,
+                         const std::vector<LidarScanFieldTypes>& fields,
+                         int64_t dt, bool complete, size_t depth) {
+                 return std::make_unique<CollatedScans>(
+                     py::iter(source), infos, fields, dt, complete, depth);
+             }),
+             py::arg("source"), py::arg("metadata"),
+             py::arg("fields") = std::vector<LidarScanFieldTypes>{},
+             py::arg("dt") = 210000000, py::arg("complete") = false,
+             py::arg("depth") = 2)
+        .def("__iter__",
+             [](CollatedScans& self) -> CollatedScans& { return self; },
+             py::return_value_policy::reference_internal)
+        .def("__next__", &CollatedScans::next)
+        .def("close", &CollatedScans::close,
+             "Stop reading the source and drop the frames not returned yet.");
+
+    py::module::import("atexit").attr("register")(
+        py::cpp_function(&CollatedScans::close_all));
 
     // XYZ Projection
-    py::class_<XYZLut>(m, "XYZLut")
+    // held by the process wide cache of shared_xyz_lut, never modified
+    py::class_<XYZLut, std::shared_ptr<XYZLut>>(m, "XYZLut")
         .def(py::init([](const sensor_info& sensor, bool use_extrinsics) {
-                 auto self = new XYZLut{};
-                 *self = make_xyz_lut(sensor, use_extrinsics);
-                 return self;
+                 return std::const_pointer_cast<XYZLut>(
+                     shared_xyz_lut(sensor, use_extrinsics));
              }),
              py::arg("info"), py::arg("use_extrinsics"))
-        .def("__call__",
-             [](const XYZLut& self, Eigen::Ref<img_t<uint32_t>>& range) {
-                 return cartesian(range, self);
-             })
-        .def("__call__", [](const XYZLut& self, const LidarScan& scan) {
-            return cartesian(scan, self);
-        });
+        .def(
+            "__call__",
+            [](const XYZLut& self, Eigen::Ref<img_t<uint32_t>>& range,
+               const py::object& out) -> py::object {
+                if (out.is_none()) {
+                    LidarScan::Points points;
+                    {
+                        py::gil_scoped_release release;
+                        points = cartesian(range, self);
+                    }
+                    return py::cast(std::move(points));
+                }
+                auto view = points_view(out, range.size());
+                py::gil_scoped_release release;
+                cartesian(view, range, self);
+                return out;
+            },
+            py::arg("range"), py::arg("out") = py::none())
+        .def(
+            "__call__",
+            [](const XYZLut& self, const LidarScan& scan,
+               const py::object& out) -> py::object {
+                if (out.is_none()) {
+                    LidarScan::Points points;
+                    {
+                        py::gil_scoped_release release;
+                        points = cartesian(scan, self);
+                    }
+                    return py::cast(std::move(points));
+                }
+                auto view = points_view(out, scan.w * scan.h);
+                py::gil_scoped_release release;
+                cartesian(view, scan, self);
+                return out;
+            },
+            py::arg("scan"), py::arg("out") = py::none());
 
     // Image processing
     py::class_<viz::AutoExposure>(m, "AutoExposure")
@@ -1971,6 +3355,7 @@ void init_client(py::module& m, py::module&) {
 
     py::class_<viz::BeamUniformityCorrector>(m, "BeamUniformityCorrector")
         .def(py::init<>())
+        .def(py::init<int>(), py::arg("update_every"))
         .def("__call__", &image_proc_call<viz::BeamUniformityCorrector, float>,
              py::arg("image"), py::arg("update_state") = true)
         .def("__call__", &image_proc_call<viz::BeamUniformityCorrector, double>,
@@ -2178,32 +3563,1540 @@ void init_client(py::module& m, py::module&) {
 
     m.def("dewarp",
           py::overload_cast<const py::array_t<double>&,
-                            const py::array_t<double>&>(&dewarp),
+                            const py::array_t<double>&, const py::object&>(
+              &dewarp),
           R"(
 	Applies a set of 4x4 pose transformations to a collection of 3D points.
 	Args:
 	  points: A NumPy array of shape (H, W, 3) representing the 3D points.
 	  poses: A NumPy array of shape (W, 4, 4) representing the 4x4 pose
+	  out: optional C contiguous float64 array of shape (H, W, 3) to write
+	    the result to instead of allocating one, may be points
 
 	Return:
 	  A NumPy array of shape (H, W, 3) containing the dewarped 3D points
 	  )",
-          py::arg("points"), py::arg("poses"));
+          py::arg("points"), py::arg("poses"), py::arg("out") = py::none());
 
     m.def("transform",
           py::overload_cast<const py::array_t<double>&,
-                            const py::array_t<double>&>(&transform),
+                            const py::array_t<double>&, const py::object&>(
+              &transform),
           R"(
 	Applies a single of 4x4 pose transformations to a collection of 3D points.
 	Args:
 	  points: A NumPy array of shape (H, W, 3), or (N, 3)
 	  pose: A NumPy array of shape (4, 4) representing the 4x4 pose
+	  out: optional C contiguous float64 array of the shape of points to
+	    write the result to instead of allocating one, may be points
 
 	Return:
 	  A NumPy array of shape (H, W, 3) or (N, 3) containing the transformed 3D points
 	  after applying the corresponding 4x4 transformation matrices to the points
 	  )",
-          py::arg("points"), py::arg("pose"));
+          py::arg("points"), py::arg("pose"), py::arg("out") = py::none());
+
+    m.def(
+        "cartesian_dewarp",
+        [](const LidarScan& scan, const XYZLut& lut, const mat4d& extrinsic,
+           bool compact) {
+            return pose_util::cartesian_dewarp(scan, lut, extrinsic, compact);
+        },
+        py::call_guard<py::gil_scoped_release>(),
+        R"(
+	Projects a scan to points dewarped by the per column poses of the scan and
+	transformed by an extrinsic, in a single pass. Gives the same points as
+	transform(dewarp(xyzlut(scan), scan.pose), extrinsic).
+	Args:
+	  scan: a LidarScan with a RANGE field
+	  lut: lookup tables, an ouster.sdk._bindings.client.XYZLut
+	  extrinsic: A NumPy array of shape (4, 4) applied after the poses
+	  compact: leave out pixels with a zero range
+
+	Return:
+	  A NumPy array of shape (N, 3) with a point per pixel, or per pixel with
+	  a nonzero range if compact
+	  )",
+        py::arg("scan"), py::arg("lut"),
+        py::arg("extrinsic") = mat4d::Identity().eval(),
+        py::arg("compact") = false);
+
+    py::class_<pose_util::TrajectoryEvaluator>(m, "TrajectoryEvaluator", R"(
+        Interpolates the poses of a trajectory at any timestamps from knot
+        poses on the SE(3) manifold, extrapolating the first and last segments
+        out of the knot timestamps.
+        )")
+        .def(py::init([](std::vector<double> timestamps,
+                         py::array_t<double, py::array::c_style |
+                                                 py::array::forcecast>
+                             poses) {
+                 if (poses.size() != 16 * py::ssize_t(timestamps.size())) {
+                     throw std::invalid_argument(
+                         "poses must have shape (N, 4, 4) for N timestamps");
+                 }
+                 Eigen::Map<const pose_util::Poses> knots(
+                     poses.data(), timestamps.size(), 16);
+                 return new pose_util::TrajectoryEvaluator(
+                     std::move(timestamps), knots);
+             }),
+             R"(
+        Args:
+          timestamps: the increasing timestamps of the knots
+          poses: A NumPy array of shape (N, 4, 4) of the knot poses
+        )",
+             py::arg("timestamps"), py::arg("poses"))
+        .def(
+            "poses_at",
+            [](const pose_util::TrajectoryEvaluator& self,
+               const Eigen::Ref<const Eigen::ArrayXd>& ts) {
+                py::array_t<double> result({py::ssize_t(ts.size()),
+                                            py::ssize_t(4), py::ssize_t(4)});
+                Eigen::Map<pose_util::Poses> poses(result.mutable_data(),
+                                                   ts.size(), 16);
+                {
+                    py::gil_scoped_release release;
+                    self.poses_at(poses, ts);
+                }
+                return result;
+            },
+            R"(
+        Interpolate the poses at timestamps, fastest when sorted.
+
+        Args:
+          ts: A NumPy array of shape (N,) of timestamps
+
+        Return:
+          A NumPy array of shape (N, 4, 4) of poses
+        )",
+            py::arg("ts"))
+        .def(
+            "pose_scan",
+            [](const pose_util::TrajectoryEvaluator& self, LidarScan& scan,
+               py::object col_ts) {
+                Eigen::ArrayXd ts;
+                if (!col_ts.is_none()) {
+                    ts = col_ts.cast<Eigen::ArrayXd>();
+                }
+                py::gil_scoped_release release;
+                self.pose_scan(scan, ts);
+            },
+            R"(
+        Write the poses at the timestamps of the valid columns of a scan to
+        scan.pose, leaving the other columns unchanged.
+
+        Args:
+          scan: the LidarScan to modify in place
+          col_ts: optional array of scan.w timestamps to use instead of
+            scan.timestamp
+        )",
+            py::arg("scan"), py::arg("col_ts") = py::none())
+        .def_property_readonly("timestamps",
+                               &pose_util::TrajectoryEvaluator::timestamps);
+
+    py::class_<DeskewInput>(m, "DeskewInput", R"(
+        Builds the input of deskewing point cloud registration, e.g. KISS-ICP,
+        from a frame of scans of several sensors: the points of every pixel
+        with a nonzero range and their times, normalized to [0, 1] over the
+        frame. The buffers are kept across frames, so the arrays returned by
+        points, times and column_times are overwritten by the next build.
+        )")
+        .def(py::init<std::vector<XYZLut>>(), R"(
+        Args:
+          luts: lookup tables of each sensor, ouster.sdk._bindings.client.XYZLut
+        )",
+             py::arg("luts"))
+        .def(
+            "build",
+            [](DeskewInput& self, const std::vector<py::object>& scans,
+               const std::vector<int64_t>& ts_offsets) {
+                std::vector<const LidarScan*> ptrs;
+                for (const auto& scan : scans) {
+                    ptrs.push_back(scan.is_none() ? nullptr
+                                                  : scan.cast<LidarScan*>());
+                }
+                py::gil_scoped_release release;
+                return self.build(ptrs, ts_offsets);
+            },
+            R"(
+        Fill the buffers with a frame of scans. Column times are the column
+        timestamps plus the offset of their sensor, normalized between the
+        earliest first valid column and the latest last valid column of the
+        frame, or evenly spaced for scans with out of order timestamps.
+
+        Args:
+          scans: the scan of each sensor, or None
+          ts_offsets: offsets in ns added to the column timestamps of each
+            sensor
+
+        Return:
+          The number of points
+        )",
+            py::arg("scans"), py::arg("ts_offsets"))
+        .def_property_readonly(
+            "points",
+            py::cpp_function(
+                [](const DeskewInput& self) {
+                    const auto points = self.points();
+                    const py::ssize_t item = sizeof(double);
+                    return py::array_t<double>(
+                        {py::ssize_t(points.rows()), py::ssize_t(3)},
+                        {item, item * py::ssize_t(points.outerStride())},
+                        points.data(), py::cast(self));
+                },
+                py::keep_alive<0, 1>()),
+            "The points of the last build, an (N, 3) view of the buffer")
+        .def_property_readonly(
+            "times",
+            py::cpp_function(
+                [](const DeskewInput& self) {
+                    const auto times = self.times();
+                    return py::array_t<double>(times.size(), times.data(),
+                                               py::cast(self));
+                },
+                py::keep_alive<0, 1>()),
+            "The normalized time of every point of the last build")
+        .def(
+            "column_times",
+            [](const DeskewInput& self, size_t sensor) {
+                const Eigen::ArrayXd& times = self.column_times(sensor);
+                return py::array_t<double>(times.size(), times.data(),
+                                           py::cast(self));
+            },
+            py::keep_alive<0, 1>(),
+            "The normalized time of every column of the scan of a sensor in "
+            "the last build, empty if its scan was None",
+            py::arg("sensor"))
+        .def_property_readonly("sensors_count", &DeskewInput::sensors_count);
+
+    py::class_<FusedCloud>(m, "FusedCloud", R"(
+        The points of a frame of scans of several sensors, viewing a slot of
+        the ring of a FusedCloudBuilder, overwritten ring_size builds later.
+        )")
+        .def_property_readonly(
+            "points",
+            [](py::object self) {
+                const FusedCloud& cloud = self.cast<const FusedCloud&>();
+                const py::ssize_t item = sizeof(double);
+                return py::array_t<double>(
+                    {py::ssize_t(cloud.size), py::ssize_t(3)},
+                    {item * 3, item}, cloud.points.data(), self);
+            },
+            "The (N, 3) points")
+        .def_property_readonly(
+            "sensor_ids",
+            [](py::object self) -> py::object {
+                const FusedCloud& cloud = self.cast<const FusedCloud&>();
+                if (cloud.sensor_ids.size() == 0) return py::none();
+                return py::array_t<uint8_t>(cloud.size,
+                                            cloud.sensor_ids.data(), self);
+            },
+            "The sensor of every point, None unless requested")
+        .def_property_readonly(
+            "fields",
+            [](py::object self) {
+                const FusedCloud& cloud = self.cast<const FusedCloud&>();
+                py::list fields;
+                for (const auto& field : cloud.fields) {
+                    fields.append(
+                        py::array_t<double>(cloud.size, field.data(), self));
+                }
+                return fields;
+            },
+            "The values of every requested field at every point")
+        .def_readonly("frame", &FusedCloud::frame,
+                      "The number of builds before this one")
+        .def("__len__", [](const FusedCloud& self) { return self.size; });
+
+    py::class_<FusedCloudBuilder>(m, "FusedCloudBuilder", R"(
+        Builds a single point cloud from one scan per sensor, projecting the
+        scan of every sensor on its own thread into its part of a shared
+        buffer. Clouds are written in turn to the slots of a preallocated
+        ring, so that a consumer can read a cloud while the next ring_size - 1
+        clouds are built.
+        )")
+        .def(py::init<std::vector<XYZLut>, std::vector<mat4d>,
+                      std::vector<std::string>, bool, bool, size_t>(),
+             R"(
+        Args:
+          luts: lookup tables of each sensor, ouster.sdk._bindings.client.XYZLut
+          extrinsics: transforms of each sensor applied after the luts, or an
+            empty list
+          fields: fields carried to each point
+          sensor_ids: carry the sensor of each point
+          compact: leave out pixels of zero range
+          ring_size: number of clouds in the ring
+        )",
+             py::arg("luts"), py::arg("extrinsics") = std::vector<mat4d>{},
+             py::arg("fields") = std::vector<std::string>{},
+             py::arg("sensor_ids") = false, py::arg("compact") = true,
+             py::arg("ring_size") = 2)
+        .def(
+            "build",
+            [](FusedCloudBuilder& self,
+               const std::vector<py::object>& scans) -> const FusedCloud& {
+                std::vector<const LidarScan*> ptrs;
+                for (const auto& scan : scans) {
+                    ptrs.push_back(scan.is_none() ? nullptr
+                                                  : scan.cast<LidarScan*>());
+                }
+                py::gil_scoped_release release;
+                return self.build(ptrs);
+            },
+            py::return_value_policy::reference_internal, R"(
+        Fill the next cloud of the ring with a frame of scans, in sensor and
+        then pixel order. Without compact, every pixel of every sensor has a
+        point, zero for a missing scan.
+
+        Args:
+          scans: the scan of each sensor, or None
+
+        Returns:
+          The filled FusedCloud, valid until ring_size more builds
+        )",
+            py::arg("scans"))
+        .def_property_readonly("latest", &FusedCloudBuilder::latest,
+                               py::return_value_policy::reference_internal,
+                               "The cloud of the last build")
+        .def_property_readonly("fields", &FusedCloudBuilder::fields)
+        .def_property_readonly("sensors_count",
+                               &FusedCloudBuilder::sensors_count)
+        .def_property_readonly("ring_size", &FusedCloudBuilder::ring_size);
+
+    py::enum_<CellState>(m, "CellState", R"(
+        What is known of a cell of an OccupancyGrid.
+        )")
+        .value("UNKNOWN", CellState::UNKNOWN)
+        .value("FREE", CellState::FREE)
+        .value("OCCUPIED", CellState::OCCUPIED);
+
+    py::class_<GridLayout>(m, "GridLayout", R"(
+        Extent, resolution and height band of an OccupancyGrid, centered on
+        the origin of the frame of the extrinsics, rows along y and columns
+        along x.
+        )")
+        .def(py::init<>())
+        .def_readwrite("rows", &GridLayout::rows, "Cells along y")
+        .def_readwrite("cols", &GridLayout::cols, "Cells along x")
+        .def_readwrite("resolution", &GridLayout::resolution,
+                       "Side of a cell, in the units of the luts")
+        .def_readwrite("min_z", &GridLayout::min_z,
+                       "Points below are ground, crossed by rays")
+        .def_readwrite("max_z", &GridLayout::max_z,
+                       "Points above are overhangs, left out")
+        .def_readwrite("min_hits", &GridLayout::min_hits,
+                       "Points in a cell marking it occupied");
+
+    // views of the images of a grid, kept alive by the grid
+    auto grid_view = [](py::object self, const auto& image) {
+        using T = typename std::decay_t<decltype(image)>::Scalar;
+        const py::ssize_t item = sizeof(T);
+        return py::array_t<T>({py::ssize_t(image.rows()),
+                               py::ssize_t(image.cols())},
+                              {item * image.cols(), item}, image.data(), self);
+    };
+
+    py::class_<OccupancyGrid>(m, "OccupancyGrid", R"(
+        An occupancy grid and height map, viewing the grid of an
+        OccupancyGridBuilder, overwritten by its next build.
+        )")
+        .def_property_readonly(
+            "state",
+            [grid_view](py::object self) {
+                return grid_view(self, self.cast<const OccupancyGrid&>().state);
+            },
+            "The CellState of every cell, a (rows, cols) uint8 array")
+        .def_property_readonly(
+            "height",
+            [grid_view](py::object self) {
+                return grid_view(self,
+                                 self.cast<const OccupancyGrid&>().height);
+            },
+            "The highest point at or below max_z in every cell, NaN if none")
+        .def_property_readonly(
+            "hits",
+            [grid_view](py::object self) {
+                return grid_view(self, self.cast<const OccupancyGrid&>().hits);
+            },
+            "The number of points between min_z and max_z in every cell")
+        .def_property_readonly(
+            "free",
+            [grid_view](py::object self) {
+                return grid_view(self, self.cast<const OccupancyGrid&>().free);
+            },
+            "The number of column rays crossing every cell")
+        .def_readonly("frame", &OccupancyGrid::frame,
+                      "The number of builds before this one");
+
+    py::class_<OccupancyGridBuilder>(m, "OccupancyGridBuilder", R"(
+        Builds an occupancy grid and height map from one scan per sensor,
+        directly from the RANGE field and the lut of each sensor, marching
+        free space once per column of a scan. Scans are processed on a thread
+        per sensor into a grid refilled in place.
+        )")
+        .def(py::init<std::vector<XYZLut>, std::vector<mat4d>,
+                      const GridLayout&>(),
+             R"(
+        Args:
+          luts: lookup tables of each sensor, ouster.sdk._bindings.client.XYZLut
+          extrinsics: transforms of each sensor to the grid frame applied
+            after the luts, or an empty list
+          layout: extent of the grid, a GridLayout
+        )",
+             py::arg("luts"), py::arg("extrinsics") = std::vector<mat4d>{},
+             py::arg("layout") = GridLayout{})
+        .def(
+            "build",
+            [](OccupancyGridBuilder& self,
+               const std::vector<py::object>& scans) -> const OccupancyGrid& {
+                std::vector<const LidarScan*> ptrs;
+                for (const auto& scan : scans) {
+                    ptrs.push_back(scan.is_none() ? nullptr
+                                                  : scan.cast<LidarScan*>());
+                }
+                py::gil_scoped_release release;
+                return self.build(ptrs);
+            },
+            py::return_value_policy::reference_internal, R"(
+        Refill the grid with a frame of scans. Missing scans add nothing.
+
+        Args:
+          scans: the scan of each sensor, or None
+
+        Returns:
+          The OccupancyGrid, overwritten by the next build
+        )",
+            py::arg("scans"))
+        .def_property_readonly("latest", &OccupancyGridBuilder::latest,
+                               py::return_value_policy::reference_internal,
+                               "The grid of the last build")
+        .def_property_readonly("layout", &OccupancyGridBuilder::layout)
+        .def_property_readonly("sensors_count",
+                               &OccupancyGridBuilder::sensors_count);
+
+    py::class_<ScanGateOptions>(m, "ScanGateOptions", R"(
+        When a ScanGate lets scans through.
+        )")
+        .def(py::init<>())
+        .def_readwrite("stride", &ScanGateOptions::stride,
+                       "Compare every stride-th row and column of the ranges")
+        .def_readwrite("min_range_change", &ScanGateOptions::min_range_change,
+                       "A sampled pixel changed if its range moved by more, "
+                       "in mm")
+        .def_readwrite("min_changed_fraction",
+                       &ScanGateOptions::min_changed_fraction,
+                       "Keep a scan once this fraction of the sampled pixels "
+                       "changed since the last scan kept")
+        .def_readwrite("keyframe_interval",
+                       &ScanGateOptions::keyframe_interval,
+                       "Keep a scan at least this often, in seconds")
+        .def_readwrite("min_angular_velocity",
+                       &ScanGateOptions::min_angular_velocity,
+                       "Keep a scan if the IMU turned faster, in rad/s")
+        .def_readwrite("min_accel_change", &ScanGateOptions::min_accel_change,
+                       "Keep a scan if the specific force was this far from "
+                       "gravity, in m/s^2");
+
+    py::class_<SkippedSpan>(m, "SkippedSpan", R"(
+        Consecutive scans left out by a ScanGate.
+        )")
+        .def(py::init<>())
+        .def_readwrite("first_frame_id", &SkippedSpan::first_frame_id)
+        .def_readwrite("last_frame_id", &SkippedSpan::last_frame_id)
+        .def_readwrite("first_ts", &SkippedSpan::first_ts)
+        .def_readwrite("last_ts", &SkippedSpan::last_ts)
+        .def_readwrite("count", &SkippedSpan::count)
+        .def("__eq__", &SkippedSpan::operator==);
+
+    py::class_<ScanGate>(m, "ScanGate", R"(
+        Decides which scans of a sensor are worth recording, leaving out those
+        nearly identical to the last scan kept, by a sparse sample of their
+        ranges, IMU motion and a keyframe interval.
+        )")
+        .def(py::init<const ScanGateOptions&>(),
+             py::arg("options") = ScanGateOptions{})
+        .def(
+            "admit",
+            [](ScanGate& self, const LidarScan& scan, const ImuBatch* imu) {
+                return self.admit(scan, imu);
+            },
+            R"(
+        Decide whether to keep a scan, recording it as skipped otherwise.
+
+        Args:
+          scan: next scan of the sensor
+          imu: IMU samples of the scan, an ImuBatch, or None
+
+        Returns:
+          True if the scan should be recorded
+        )",
+            py::arg("scan"), py::arg("imu") = nullptr)
+        .def_property_readonly("last_change", &ScanGate::last_change)
+        .def_property_readonly("kept", &ScanGate::kept)
+        .def_property_readonly("skipped", &ScanGate::skipped)
+        .def_property_readonly("skipped_spans", &ScanGate::skipped_spans)
+        .def_property_readonly("options", &ScanGate::options)
+        .def("reset", &ScanGate::reset);
+
+    py::class_<ColumnDewarper>(m, "ColumnDewarper", R"(
+        Projects and dewarps the pixels of ranges of columns of scans into a
+        persistent buffer of points, so that world frame points of the first
+        columns are available before a scan is complete. The pose of each
+        column comes from a pose source queried with the column timestamps.
+        )")
+        .def(py::init([](const XYZLut& lut, size_t w, size_t h,
+                         const py::object& source, const mat4d& extrinsic) {
+                 if (py::isinstance<pose_util::TrajectoryEvaluator>(source)) {
+                     return new ColumnDewarper(
+                         lut, w, h,
+                         source.cast<const pose_util::TrajectoryEvaluator&>(),
+                         extrinsic);
+                 }
+                 if (!PyCallable_Check(source.ptr())) {
+                     throw py::type_error(
+                         "source must be a TrajectoryEvaluator or callable");
+                 }
+                 auto fn = std::make_shared<py::object>(source);
+                 auto pose_source =
+                     [fn](Eigen::Ref<pose_util::Poses> poses,
+                          const Eigen::Ref<const Eigen::ArrayXd>& ts) {
+                         py::gil_scoped_acquire acquire;
+                         using array_d =
+                             py::array_t<double, py::array::c_style |
+                                                     py::array::forcecast>;
+                         py::array_t<double> ts_array(ts.size(), ts.data());
+                         auto result = array_d::ensure((*fn)(ts_array));
+                         if (!result || result.size() != 16 * ts.size()) {
+                             throw std::invalid_argument(
+                                 "pose source must return a pose per "
+                                 "timestamp");
+                         }
+                         poses = Eigen::Map<const pose_util::Poses>(
+                             result.data(), ts.size(), 16);
+                     };
+                 return new ColumnDewarper(lut, w, h, pose_source, extrinsic);
+             }),
+             R"(
+        Args:
+          lut: lookup tables, an ouster.sdk._bindings.client.XYZLut
+          w: width of the scans
+          h: height of the scans
+          source: a TrajectoryEvaluator with knot timestamps in ns, or a
+            callable returning an (N, 4, 4) or (N, 16) array of the poses at
+            an array of N column timestamps in ns
+          extrinsic: A NumPy array of shape (4, 4) applied after the poses
+        )",
+             py::arg("lut"), py::arg("w"), py::arg("h"), py::arg("source"),
+             py::arg("extrinsic") = mat4d::Identity().eval())
+        .def(
+            "dewarp",
+            [](ColumnDewarper& self, const LidarScan& scan, int first,
+               int last) {
+                py::gil_scoped_release release;
+                self.dewarp(scan, {first, last});
+            },
+            R"(
+        Project and dewarp the pixels of the columns first to last of a scan
+        into the buffer, wrapping around the end of the scan if first is
+        greater than last. Other columns are left unchanged.
+
+        Args:
+          scan: a LidarScan with a RANGE field
+          first: the first column
+          last: the last column
+        )",
+            py::arg("scan"), py::arg("first"), py::arg("last"))
+        .def_property_readonly(
+            "points",
+            py::cpp_function(
+                [](const ColumnDewarper& self) {
+                    const auto& points = self.points();
+                    return py::array_t<double>(
+                        {py::ssize_t(points.rows()), py::ssize_t(3)},
+                        points.data(), py::cast(self));
+                },
+                py::keep_alive<0, 1>()),
+            "The points of every pixel in pixel order, a (w * h, 3) view of "
+            "the buffer")
+        .def_property_readonly(
+            "poses",
+            py::cpp_function(
+                [](const ColumnDewarper& self) {
+                    const auto& poses = self.poses();
+                    return py::array_t<double>(
+                        {py::ssize_t(poses.rows()), py::ssize_t(4),
+                         py::ssize_t(4)},
+                        poses.data(), py::cast(self));
+                },
+                py::keep_alive<0, 1>()),
+            "The poses of every column last dewarped, a (w, 4, 4) view");
+
+    py::class_<ImuPreintegrator>(m, "ImuPreintegrator", R"(
+        Integrates IMU packets into the poses of the sensor in a gravity
+        aligned frame, for dewarping without registration. The first samples
+        are assumed static and estimate the gyroscope bias and gravity.
+        Velocity and position drift quickly without corrections.
+        )")
+        .def(py::init<const mat4d&, size_t, double>(), R"(
+        Args:
+          imu_to_sensor_transform: A NumPy array of shape (4, 4), from the
+            sensor info, with a translation in mm
+          init_samples: number of static samples estimating the gyroscope
+            bias and gravity
+          history: seconds of states kept
+        )",
+             py::arg("imu_to_sensor_transform") = mat4d::Identity().eval(),
+             py::arg("init_samples") = 100, py::arg("history") = 1.0)
+        .def(
+            "add",
+            [](ImuPreintegrator& self, const ImuPacket& packet) {
+                self.add(packet);
+            },
+            "Integrate an IMU packet", py::arg("packet"))
+        .def(
+            "add_sample",
+            [](ImuPreintegrator& self, uint64_t ts,
+               const Eigen::Vector3d& accel, const Eigen::Vector3d& gyro) {
+                self.add(ImuSample{ts, accel, gyro});
+            },
+            R"(
+        Integrate a sample in SI units. Samples not after the last one are
+        ignored.
+
+        Args:
+          ts: timestamp in ns
+          accel: specific force in m/s^2
+          gyro: angular velocity in rad/s
+        )",
+            py::arg("ts"), py::arg("accel"), py::arg("gyro"))
+        .def(
+            "add_batch",
+            [](ImuPreintegrator& self, const ImuBatch& batch) {
+                self.add(batch);
+            },
+            py::call_guard<py::gil_scoped_release>(),
+            "Integrate the samples of an ImuBatch", py::arg("batch"))
+        .def_property_readonly("initialized", &ImuPreintegrator::initialized,
+                               "True once the static samples are averaged")
+        .def("reset", &ImuPreintegrator::reset,
+             "Forget all samples, keeping the biases if keep_bias",
+             py::arg("keep_bias") = false)
+        .def("set_bias", &ImuPreintegrator::set_bias,
+             "Set the gyroscope bias in rad/s and accelerometer bias in m/s^2",
+             py::arg("gyro"), py::arg("accel"))
+        .def_property_readonly("gyro_bias", &ImuPreintegrator::gyro_bias,
+                               "The gyroscope bias in rad/s")
+        .def_property_readonly("accel_bias", &ImuPreintegrator::accel_bias,
+                               "The accelerometer bias in m/s^2")
+        .def_property("velocity", &ImuPreintegrator::velocity,
+                      &ImuPreintegrator::set_velocity,
+                      "The velocity of the IMU in the world frame in m/s")
+        .def(
+            "poses_at",
+            [](const ImuPreintegrator& self,
+               const Eigen::Ref<const Eigen::ArrayXd>& ts) {
+                pose_util::Poses poses;
+                {
+                    py::gil_scoped_release release;
+                    poses = self.poses_at(ts);
+                }
+                py::array_t<double> result(
+                    {py::ssize_t(poses.rows()), py::ssize_t(4),
+                     py::ssize_t(4)});
+                std::copy(poses.data(), poses.data() + poses.size(),
+                          result.mutable_data());
+                return result;
+            },
+            R"(
+        The poses of the sensor at timestamps, interpolated in the history or
+        extrapolated with the last velocities. Usable as the source of a
+        ColumnDewarper.
+
+        Args:
+          ts: timestamps in ns
+
+        Returns:
+          A NumPy array of shape (N, 4, 4)
+        )",
+            py::arg("ts"))
+        .def("pose_scan", &ImuPreintegrator::pose_scan,
+             py::call_guard<py::gil_scoped_release>(),
+             "Write the poses of the valid columns of a scan to its pose",
+             py::arg("scan"));
+
+    py::class_<ImuBatch>(m, "ImuBatch", R"(
+        The IMU samples of a scan period in SI units, filled by an ImuBatcher.
+        The arrays are views of the batch, valid until it is refilled.
+        )")
+        .def(py::init<>())
+        .def("__len__", &ImuBatch::size)
+        .def_property_readonly(
+            "ts",
+            [](const ImuBatch& self) {
+                return py::array_t<uint64_t>(py::ssize_t(self.size()),
+                                             self.ts.data(), py::cast(self));
+            },
+            "Gyroscope timestamps in ns, a (N,) view")
+        .def_property_readonly(
+            "accel_ts",
+            [](const ImuBatch& self) {
+                return py::array_t<uint64_t>(py::ssize_t(self.size()),
+                                             self.accel_ts.data(),
+                                             py::cast(self));
+            },
+            "Accelerometer timestamps in ns, a (N,) view")
+        .def_property_readonly(
+            "accel",
+            [](const ImuBatch& self) {
+                return py::array_t<double>(
+                    {py::ssize_t(self.size()), py::ssize_t(3)},
+                    self.accel.data(), py::cast(self));
+            },
+            "Specific forces in m/s^2, a (N, 3) view")
+        .def_property_readonly(
+            "gyro",
+            [](const ImuBatch& self) {
+                return py::array_t<double>(
+                    {py::ssize_t(self.size()), py::ssize_t(3)},
+                    self.gyro.data(), py::cast(self));
+            },
+            "Angular velocities in rad/s, a (N, 3) view")
+        .def_property_readonly(
+            "column",
+            [](const ImuBatch& self) {
+                return py::array_t<int32_t>(py::ssize_t(self.size()),
+                                            self.column.data(),
+                                            py::cast(self));
+            },
+            R"(
+        The first valid column of the scan at or after each sample, or -1
+        before the first valid column, a (N,) view
+        )");
+
+    py::class_<ImuBatcher>(m, "ImuBatcher", R"(
+        Accumulates the IMU packets of a sensor into an ImuBatch per scan, with
+        each sample aligned to the columns of the scan. Samples not after the
+        previous one are dropped.
+        )")
+        .def(py::init<size_t>(), py::arg("capacity") = 256)
+        .def("__call__", &ImuBatcher::operator(),
+             "Add the sample of an IMU packet", py::arg("packet"))
+        .def(
+            "add_sample",
+            [](ImuBatcher& self, uint64_t ts, const Eigen::Vector3d& accel,
+               const Eigen::Vector3d& gyro, uint64_t accel_ts) {
+                self.add(ImuSample{ts, accel, gyro}, accel_ts);
+            },
+            R"(
+        Add a sample in SI units.
+
+        Args:
+          ts: timestamp in ns
+          accel: specific force in m/s^2
+          gyro: angular velocity in rad/s
+          accel_ts: accelerometer timestamp in ns, ts if zero
+        )",
+            py::arg("ts"), py::arg("accel"), py::arg("gyro"),
+            py::arg("accel_ts") = 0)
+        .def("batch", &ImuBatcher::batch,
+             py::call_guard<py::gil_scoped_release>(), R"(
+        Move the samples pending up to the last valid column of a scan into a
+        batch, replacing its samples.
+
+        Returns:
+          The number of samples in the batch
+        )",
+             py::arg("scan"), py::arg("out"))
+        .def_property_readonly("pending", &ImuBatcher::pending,
+                               "The number of samples pending")
+        .def_property_readonly("dropped", &ImuBatcher::dropped,
+                               "The number of samples dropped as out of order")
+        .def("reset", &ImuBatcher::reset, "Forget the samples pending");
+
+    py::enum_<VoxelPolicy>(m, "VoxelPolicy", R"(
+        Which point of a voxel represents it after voxel_downsample.
+        )")
+        .value("FIRST", VoxelPolicy::FIRST)
+        .value("CENTROID", VoxelPolicy::CENTROID)
+        .value("RANDOM", VoxelPolicy::RANDOM);
+
+    auto voxel_tuple = [](VoxelDownsample&& result) {
+        return py::make_tuple(std::move(result.points),
+                              std::move(result.indices),
+                              std::move(result.voxels));
+    };
+
+    m.def(
+        "voxel_downsample",
+        [voxel_tuple](const Eigen::Ref<const pose_util::Points>& points,
+                      double voxel_size, VoxelPolicy policy, uint64_t seed) {
+            VoxelDownsample result;
+            {
+                py::gil_scoped_release release;
+                result = voxel_downsample(points, voxel_size, policy, seed);
+            }
+            return voxel_tuple(std::move(result));
+        },
+        R"(
+	Downsamples points on a voxel grid, keeping one point per occupied voxel.
+	Non finite points are left out.
+	Args:
+	  points: A NumPy array of shape (N, 3)
+	  voxel_size: the side of a voxel, in the units of the points
+	  policy: which point of a voxel to keep, a VoxelPolicy
+	  seed: seed of the random choice of VoxelPolicy.RANDOM
+
+	Return:
+	  A tuple of the kept points of shape (M, 3), the index of the point kept
+	  for every voxel, of its first point for VoxelPolicy.CENTROID, and the
+	  voxel of every point, -1 for points left out
+	  )",
+        py::arg("points"), py::arg("voxel_size"),
+        py::arg("policy") = VoxelPolicy::FIRST, py::arg("seed") = 0);
+
+    m.def(
+        "voxel_downsample",
+        [voxel_tuple](const LidarScan& scan, const XYZLut& lut,
+                      double voxel_size, VoxelPolicy policy, uint64_t seed) {
+            VoxelDownsample result;
+            {
+                py::gil_scoped_release release;
+                result =
+                    voxel_downsample(scan, lut, voxel_size, policy, seed);
+            }
+            return voxel_tuple(std::move(result));
+        },
+        R"(
+	Downsamples the points of the pixels of a scan with a nonzero range on a
+	voxel grid, where indices and voxels are pixel indices.
+	Args:
+	  scan: a LidarScan with a RANGE field
+	  lut: lookup tables, an ouster.sdk._bindings.client.XYZLut
+	  voxel_size: the side of a voxel, in the units of the lut
+	  policy: which point of a voxel to keep, a VoxelPolicy
+	  seed: seed of the random choice of VoxelPolicy.RANDOM
+
+	Return:
+	  A tuple of the kept points of shape (M, 3), the pixel kept for every
+	  voxel and the voxel of every pixel, -1 for zero ranges
+	  )",
+        py::arg("scan"), py::arg("lut"), py::arg("voxel_size"),
+        py::arg("policy") = VoxelPolicy::FIRST, py::arg("seed") = 0);
+
+    m.def(
+        "range_percentiles",
+        [](const Eigen::Ref<const img_t<uint32_t>>& range, double start_pct,
+           double end_pct) {
+            RangeBand band;
+            {
+                py::gil_scoped_release release;
+                band = range_percentiles(range, start_pct, end_pct);
+            }
+            return py::make_tuple(band.sum, band.count);
+        },
+        R"(
+	Selects the nonzero ranges between two percentiles of the nonzero ranges,
+	interpolated like numpy.percentile.
+	Args:
+	  range: a range image in the format of the RANGE field of a LidarScan
+	  start_pct: the lower percentile, as a ratio
+	  end_pct: the upper percentile, as a ratio
+
+	Return:
+	  The sum and the count of the selected ranges
+	  )",
+        py::arg("range"), py::arg("start_pct"), py::arg("end_pct"));
+
+    py::enum_<PointCloudFormat>(m, "PointCloudFormat", R"(
+        File formats of PointCloudWriter.
+        )")
+        .value("PLY", PointCloudFormat::PLY)
+        .value("PCD", PointCloudFormat::PCD)
+        .value("LAS", PointCloudFormat::LAS);
+
+    py::class_<PointCloudWriter>(m, "PointCloudWriter", R"(
+        Streams points with a scalar key each to a binary PLY, binary PCD or
+        LAS 1.2 file. Blocks of points are encoded on worker threads and
+        written in the order they were added. The point count and bounds in
+        the header are filled in on close.
+        )")
+        .def(py::init<const std::string&, PointCloudFormat,
+                      const std::string&, float, size_t>(),
+             R"(
+        Args:
+          filename: the file to write
+          format: a PointCloudFormat
+          key_name: name of the key property, not used by LAS
+          key_scale: factor applied to the keys
+          threads: number of worker threads, the number of cores if 0
+        )",
+             py::arg("filename"), py::arg("format"),
+             py::arg("key_name") = "intensity", py::arg("key_scale") = 1.0f,
+             py::arg("threads") = 0)
+        .def(
+            "write",
+            [](PointCloudWriter& self,
+               const Eigen::Ref<const pose_util::Points>& points,
+               const Eigen::Ref<const Eigen::ArrayXd>& keys) {
+                self.write(points, keys);
+            },
+            py::call_guard<py::gil_scoped_release>(),
+            R"(
+        Add points with a key each.
+
+        Args:
+          points: A NumPy array of shape (N, 3)
+          keys: A NumPy array of shape (N,)
+        )",
+            py::arg("points"), py::arg("keys"))
+        .def(
+            "write",
+            [](PointCloudWriter& self, const LidarScan& scan, const XYZLut& lut,
+               const std::string& key_field, double min_z, double max_z) {
+                self.write(scan, lut, key_field, min_z, max_z);
+            },
+            py::call_guard<py::gil_scoped_release>(),
+            R"(
+        Add the points of the pixels of a scan with a nonzero range, dewarped by
+        the per column poses of the scan, with the values of a field as keys.
+
+        Args:
+          scan: a LidarScan with a RANGE field
+          lut: lookup tables, an ouster.sdk._bindings.client.XYZLut
+          key_field: name of the pixel field to take the keys from
+          min_z: dewarped points below are left out
+          max_z: dewarped points above are left out
+        )",
+            py::arg("scan"), py::arg("lut"), py::arg("key_field"),
+            py::arg("min_z") = -std::numeric_limits<double>::infinity(),
+            py::arg("max_z") = std::numeric_limits<double>::infinity())
+        .def("flush", &PointCloudWriter::flush,
+             py::call_guard<py::gil_scoped_release>(),
+             "Wait for the pending blocks and write them.")
+        .def("close", &PointCloudWriter::close,
+             py::call_guard<py::gil_scoped_release>(),
+             "Write the pending blocks, fill in the header and close the file.")
+        .def("points_written", &PointCloudWriter::points_written,
+             "The number of points written so far, not counting pending "
+             "blocks.")
+        .def_property_readonly("is_open", &PointCloudWriter::is_open)
+        .def(
+            "__enter__", [](PointCloudWriter* writer) { return writer; },
+            R"(
+                 Allow PointCloudWriter to work within `with` blocks.
+            )")
+        .def(
+            "__exit__",
+            [](PointCloudWriter& writer, pybind11::object& /*exc_type*/,
+               pybind11::object& /*exc_value*/,
+               pybind11::object& /*traceback*/) {
+                {
+                    py::gil_scoped_release release;
+                    writer.close();
+                }
+                return py::none();
+            },
+            R"(
+                 Allow PointCloudWriter to work within `with` blocks.
+            )");
+
+    auto to_key = [](const std::array<int32_t, 3>& key) {
+        return TileKey{key[0], key[1], key[2]};
+    };
+    auto to_tuples = [](const std::vector<TileKey>& keys) {
+        std::vector<std::tuple<int32_t, int32_t, int32_t>> tuples;
+        tuples.reserve(keys.size());
+        for (const auto& k : keys) tuples.emplace_back(k.x, k.y, k.z);
+        return tuples;
+    };
+    py::class_<MapTileStore>(m, "MapTileStore", R"(
+        Stores a point cloud map in cubic tiles of a chunked file, so that maps
+        larger than memory can be accumulated and read back by region. Points
+        are voxel downsampled into the tiles, at most max_tiles tiles are held
+        in memory, and every tile is stored with a pyramid of levels of detail
+        of voxels doubling in size. The file is valid after each flush.
+        )")
+        .def(py::init<const std::string&, double, double, int, size_t>(),
+             R"(
+        Create a new store, truncating the file.
+
+        Args:
+          filename: the file to write
+          tile_size: side of the tiles, in the units of the points
+          voxel_size: side of the voxels of level 0
+          levels: number of levels of detail
+          max_tiles: most tiles held in memory
+        )",
+             py::arg("filename"), py::arg("tile_size"), py::arg("voxel_size"),
+             py::arg("levels") = 4, py::arg("max_tiles") = 256)
+        .def(py::init<const std::string&, size_t>(), R"(
+        Open an existing store, to read it or append to it.
+
+        Args:
+          filename: the file to open
+          max_tiles: most tiles held in memory
+        )",
+             py::arg("filename"), py::arg("max_tiles") = 256)
+        .def("append", &MapTileStore::append,
+             py::call_guard<py::gil_scoped_release>(),
+             "Add an (N, 3) array of points, leaving out the points of "
+             "occupied voxels",
+             py::arg("points"))
+        .def("flush", &MapTileStore::flush,
+             py::call_guard<py::gil_scoped_release>(),
+             "Write the modified tiles and the index")
+        .def(
+            "tiles", [to_tuples](const MapTileStore& self) {
+                return to_tuples(self.tiles());
+            },
+            "The (x, y, z) keys of every tile, a point p being in the tile "
+            "floor(p / tile_size)")
+        .def(
+            "tiles_in",
+            [to_tuples](const MapTileStore& self, const Eigen::Vector3d& min,
+                        const Eigen::Vector3d& max) {
+                return to_tuples(self.tiles_in(min, max));
+            },
+            "The keys of the tiles intersecting an axis aligned box",
+            py::arg("min"), py::arg("max"))
+        .def(
+            "tile_points",
+            [to_key](MapTileStore& self, const std::array<int32_t, 3>& key,
+                     int level) {
+                py::gil_scoped_release release;
+                return self.tile_points(to_key(key), level);
+            },
+            "The (N, 3) points of a tile at a level of detail",
+            py::arg("key"), py::arg("level") = 0)
+        .def("query", &MapTileStore::query,
+             py::call_guard<py::gil_scoped_release>(), R"(
+        The points of the tiles intersecting an axis aligned box at a level of
+        detail, including the points of these tiles out of the box.
+
+        Args:
+          min: lower corner of the box
+          max: upper corner of the box
+          level: level of detail, 0 for every point
+
+        Returns:
+          An array of shape (N, 3)
+        )",
+             py::arg("min"), py::arg("max"), py::arg("level") = 0)
+        .def_property_readonly("tile_size", &MapTileStore::tile_size)
+        .def_property_readonly("voxel_size", &MapTileStore::voxel_size)
+        .def_property_readonly("levels", &MapTileStore::levels)
+        .def_property_readonly("tiles_in_memory",
+                               &MapTileStore::tiles_in_memory)
+        .def(
+            "__enter__", [](MapTileStore* store) { return store; },
+            R"(
+                 Allow MapTileStore to work within `with` blocks.
+            )")
+        .def(
+            "__exit__",
+            [](MapTileStore& store, pybind11::object& /*exc_type*/,
+               pybind11::object& /*exc_value*/,
+               pybind11::object& /*traceback*/) {
+                {
+                    py::gil_scoped_release release;
+                    store.flush();
+                }
+                return py::none();
+            },
+            R"(
+                 Allow MapTileStore to work within `with` blocks.
+            )");
+
+    py::class_<VoxelMapIndex, std::shared_ptr<VoxelMapIndex>>(
+        m, "VoxelMapIndex", R"(
+        A reference map whose points are hashed by voxel into a file, memory
+        mapped read only so that only the pages of the regions visited are
+        read from disk.
+        )")
+        .def(py::init<const std::string&>(), "Memory map an index file",
+             py::arg("filename"))
+        .def_static("build", &VoxelMapIndex::build,
+                    py::call_guard<py::gil_scoped_release>(), R"(
+        Build the index of the points of a map and write it to a file.
+
+        Args:
+          filename: the file to write
+          points: an (N, 3) array of the points of the map
+          voxel_size: side of the voxels, typically the largest distance of
+            correspondences
+        )",
+                    py::arg("filename"), py::arg("points"),
+                    py::arg("voxel_size"))
+        .def(
+            "nearest",
+            [](const VoxelMapIndex& self,
+               const Eigen::Ref<const pose_util::Points>& queries,
+               double max_distance) {
+                pose_util::Points neighbors(queries.rows(), 3);
+                Eigen::ArrayXd distances(queries.rows());
+                {
+                    py::gil_scoped_release release;
+                    self.nearest(queries, max_distance, neighbors, distances);
+                }
+                return py::make_tuple(neighbors, distances);
+            },
+            R"(
+        Find the nearest map point of every query point within a distance.
+
+        Args:
+          queries: an (N, 3) array of points
+          max_distance: farthest neighbor searched
+
+        Returns:
+          The (N, 3) nearest points and the (N,) distances, infinite for the
+          queries without a neighbor
+        )",
+            py::arg("queries"), py::arg("max_distance"))
+        .def_property_readonly("voxel_size", &VoxelMapIndex::voxel_size)
+        .def("__len__", &VoxelMapIndex::size);
+
+    py::class_<MapLocalizerConfig>(m, "MapLocalizerConfig",
+                                   "Parameters of MapLocalizer")
+        .def(py::init<>())
+        .def_readwrite("max_correspondence_distance",
+                       &MapLocalizerConfig::max_correspondence_distance,
+                       "Largest distance of a point to its correspondence")
+        .def_readwrite("kernel_scale", &MapLocalizerConfig::kernel_scale,
+                       "Scale of the Geman-McClure kernel")
+        .def_readwrite("max_iterations", &MapLocalizerConfig::max_iterations,
+                       "Most Gauss-Newton iterations per scan")
+        .def_readwrite("convergence", &MapLocalizerConfig::convergence,
+                       "Stop once the norm of an update is below this")
+        .def_readwrite("voxel_size", &MapLocalizerConfig::voxel_size,
+                       "Voxel size downsampling the scan points, 0 for none");
+
+    py::class_<MapLocalizer>(m, "MapLocalizer", R"(
+        Tracks the pose of a sensor in a prebuilt map by registering every scan
+        to a VoxelMapIndex with point to point ICP, starting from the last
+        relative motion or a given one, e.g. from an ImuPreintegrator.
+        )")
+        .def(py::init([](std::shared_ptr<VoxelMapIndex> index,
+                         const mat4d& initial_pose,
+                         const MapLocalizerConfig& config) {
+                 return new MapLocalizer(index, initial_pose, config);
+             }),
+             py::arg("index"),
+             py::arg("initial_pose") = mat4d::Identity().eval(),
+             py::arg("config") = MapLocalizerConfig{})
+        .def(
+            "update",
+            [](MapLocalizer& self,
+               const Eigen::Ref<const pose_util::Points>& points,
+               const Eigen::Ref<const Eigen::ArrayXd>& times,
+               nonstd::optional<mat4d> motion) -> mat4d {
+                py::gil_scoped_release release;
+                if (motion) return self.update(points, times, *motion);
+                return self.update(points, times);
+            },
+            R"(
+        Register points, deskewed to the middle of the scan and predicted with
+        a motion prior.
+
+        Args:
+          points: an (N, 3) array of points in the sensor frame
+          times: normalized time in the scan of every point from 0 to 1, or
+            an empty array to skip deskewing
+          motion: relative motion since the last pose, the last relative
+            motion if None
+
+        Returns:
+          The registered pose of the middle of the scan
+        )",
+            py::arg("points"), py::arg("times") = Eigen::ArrayXd(),
+            py::arg("motion") = nonstd::optional<mat4d>())
+        .def_property("pose", &MapLocalizer::pose, &MapLocalizer::set_pose,
+                      "The last registered pose, setting it forgets the "
+                      "last motion")
+        .def_property_readonly("last_motion", &MapLocalizer::last_motion,
+                               "The relative motion between the last poses")
+        .def_property_readonly("last_correspondences",
+                               &MapLocalizer::last_correspondences,
+                               "The correspondences of the last registration");
+
+    def_range_filters<uint8_t>(m);
+    def_range_filters<uint16_t>(m);
+    def_range_filters<uint32_t>(m);
+    def_range_filters<uint64_t>(m);
+    def_range_filters<float>(m);
+    def_range_filters<double>(m);
+
+    m.def("range_image_normals", &range_image_normals,
+          py::call_guard<py::gil_scoped_release>(), R"(
+	Estimates the surface normal at every pixel of a scan with a nonzero range
+	from the points of its window x window neighbors in the destaggered range
+	image within max_distance of it. Normals face the origin of the lut frame.
+	Args:
+	  scan: a LidarScan with a RANGE field and sensor info
+	  lut: lookup tables, an ouster.sdk._bindings.client.XYZLut
+	  window: odd width and height of the neighborhood, at least 3
+	  max_distance: largest distance of neighbors, in the units of the lut
+
+	Return:
+	  A NumPy array of shape (w * h, 3) of unit normals in the pixel order of
+	  the scan, zero for pixels with a zero range or too few neighbors
+	  )",
+          py::arg("scan"), py::arg("lut"), py::arg("window") = 3,
+          py::arg("max_distance") = std::numeric_limits<double>::infinity());
+
+    m.def("connected_components", &connected_components,
+          py::call_guard<py::gil_scoped_release>(), R"(
+	Labels the connected components of the pixels of a destaggered range image
+	with a nonzero range, where pixels sharing an edge are connected when
+	their ranges differ by at most max_step.
+	Args:
+	  range: the destaggered range image
+	  max_step: largest range step within a component
+	  wrap_columns: connect the first and last columns
+
+	Return:
+	  A uint32 image of labels from 1 in the row major order of the first
+	  pixel of each component, 0 for zero ranges
+	  )",
+          py::arg("range"), py::arg("max_step"),
+          py::arg("wrap_columns") = true);
+
+    m.def(
+        "cartesian_compact",
+        [](const LidarScan& scan, const XYZLut& lut, uint32_t min_range,
+           uint32_t max_range, uint32_t min_reflectivity) {
+            CompactFilter filter;
+            filter.min_range = min_range;
+            filter.max_range = max_range;
+            filter.min_reflectivity = min_reflectivity;
+            LidarScan::Points points(scan.w * scan.h, 3);
+            Eigen::Array<uint32_t, Eigen::Dynamic, 1> pixel_index(scan.w *
+                                                                 scan.h);
+            {
+                py::gil_scoped_release release;
+                const size_t n =
+                    cartesian_compact(points, pixel_index, scan, lut, filter);
+                points.conservativeResize(n, 3);
+                pixel_index.conservativeResize(n);
+            }
+            return py::make_tuple(points, pixel_index);
+        },
+        R"(
+	Projects a scan to points, keeping only pixels with a nonzero range that
+	pass the thresholds.
+	Args:
+	  scan: a LidarScan with a RANGE field
+	  lut: lookup tables, an ouster.sdk._bindings.client.XYZLut
+	  min_range: smallest range kept, in millimeters
+	  max_range: largest range kept, in millimeters
+	  min_reflectivity: smallest REFLECTIVITY kept, ignored when zero
+
+	Return:
+	  A tuple of a NumPy array of shape (N, 3) with the kept points in pixel
+	  order, and a NumPy array of shape (N,) with the pixel index,
+	  row * w + col, of each point
+	  )",
+        py::arg("scan"), py::arg("lut"), py::arg("min_range") = 0,
+        py::arg("max_range") = std::numeric_limits<uint32_t>::max(),
+        py::arg("min_reflectivity") = 0);
+
+    py::enum_<ReturnSelection>(m, "ReturnSelection", R"(
+        Which returns of a dual return scan to keep at every pixel.
+        )")
+        .value("STRONGEST", ReturnSelection::STRONGEST)
+        .value("NEAREST", ReturnSelection::NEAREST)
+        .value("FARTHEST", ReturnSelection::FARTHEST)
+        .value("BOTH", ReturnSelection::BOTH);
+
+    m.def(
+        "select_returns",
+        [](const LidarScan& scan, ReturnSelection selection, LidarScan& out) {
+            py::gil_scoped_release release;
+            select_returns(scan, selection, out);
+        },
+        R"(
+	Fills the RANGE, SIGNAL, REFLECTIVITY and FLAGS fields of out with the
+	selected return of every pixel of a dual return scan, in place of
+	masking the fields of both returns with NumPy. Out may be the scan.
+	Args:
+	  scan: a LidarScan with RANGE and RANGE2 fields
+	  selection: a ReturnSelection other than BOTH
+	  out: a LidarScan of the same size to fill
+	  )",
+        py::arg("scan"), py::arg("selection"), py::arg("out"));
+
+    m.def(
+        "cartesian_returns",
+        [](const LidarScan& scan, const XYZLut& lut, ReturnSelection selection,
+           uint32_t min_range, uint32_t max_range, uint32_t min_reflectivity) {
+            CompactFilter filter;
+            filter.min_range = min_range;
+            filter.max_range = max_range;
+            filter.min_reflectivity = min_reflectivity;
+            const size_t returns = 2 * scan.w * scan.h;
+            LidarScan::Points points(returns, 3);
+            Eigen::Array<uint32_t, Eigen::Dynamic, 1> return_index(returns);
+            {
+                py::gil_scoped_release release;
+                const size_t n = cartesian_returns(points, return_index, scan,
+                                                   lut, selection, filter);
+                points.conservativeResize(n, 3);
+                return_index.conservativeResize(n);
+            }
+            return py::make_tuple(points, return_index);
+        },
+        R"(
+	Projects the selected returns of a dual return scan to points, keeping
+	only returns with a nonzero range that pass the thresholds, like
+	cartesian_compact.
+	Args:
+	  scan: a LidarScan with RANGE and RANGE2 fields
+	  lut: lookup tables, an ouster.sdk._bindings.client.XYZLut
+	  selection: a ReturnSelection, BOTH for two points per pixel
+	  min_range: smallest range kept, in millimeters
+	  max_range: largest range kept, in millimeters
+	  min_reflectivity: smallest REFLECTIVITY kept, ignored when zero
+
+	Return:
+	  A tuple of a NumPy array of shape (N, 3) with the kept points in pixel
+	  order, and a NumPy array of shape (N,) with the return index of each
+	  point, row * w + col for a first return and w * h + row * w + col for
+	  a second one
+	  )",
+        py::arg("scan"), py::arg("lut"),
+        py::arg("selection") = ReturnSelection::BOTH, py::arg("min_range") = 0,
+        py::arg("max_range") = std::numeric_limits<uint32_t>::max(),
+        py::arg("min_reflectivity") = 0);
+
+    m.def(
+        "stack_field",
+        [](const std::vector<LidarScan*>& scans, const std::string& name,
+           const std::vector<int>& shifts, const py::object& out) {
+            if (scans.empty() || !scans.front() ||
+                !scans.front()->has_field(name)) {
+                throw std::invalid_argument("the first scan has no field " +
+                                            name);
+            }
+            const Field& field = scans.front()->field(name);
+            std::vector<py::ssize_t> shape{
+                static_cast<py::ssize_t>(scans.size())};
+            for (size_t dim : field.shape()) shape.push_back(dim);
+            py::array result =
+                output_array(out, dtype_of_field_type(field.tag()), shape);
+
+            const std::vector<const LidarScan*> ptrs(scans.begin(),
+                                                     scans.end());
+            void* data = result.mutable_data();
+            {
+                py::gil_scoped_release release;
+                stack_field(data, ptrs, name, shifts);
+            }
+            return result;
+        },
+        R"(
+	Copies a field of several scans of the same dimensions into one array,
+	one scan per thread.
+	Args:
+	  scans: a list of LidarScans
+	  name: the field to copy
+	  shifts: the pixel_shift_by_row of the sensor to destagger a pixel field
+	    by, empty to copy it staggered
+	  out: a C contiguous array of shape (N, *field shape) and the dtype of
+	    the field to write to, or None to allocate one
+
+	Return:
+	  A NumPy array of shape (N, *field shape), e.g. (N, H, W), holding the
+	  field of the ith scan at index i
+	  )",
+        py::arg("scans"), py::arg("name"),
+        py::arg("shifts") = std::vector<int>{}, py::arg("out") = py::none());
+
+    m.def(
+        "cartesian_batch",
+        [](const std::vector<LidarScan*>& scans, const XYZLut& lut,
+           const py::object& out, const py::object& dtype) {
+            const py::dtype dt = py::dtype::from_args(dtype);
+            const bool single = dt.equal(py::dtype::of<float>());
+            if (!single && !dt.equal(py::dtype::of<double>())) {
+                throw std::invalid_argument(
+                    "dtype must be float32 or float64");
+            }
+            const Eigen::Index n = lut.direction.rows();
+            const auto count = static_cast<Eigen::Index>(scans.size());
+            py::array result = output_array(out, dt, {count, n, 3});
+
+            const std::vector<const LidarScan*> ptrs(scans.begin(),
+                                                     scans.end());
+            void* data = result.mutable_data();
+            {
+                py::gil_scoped_release release;
+                if (single) {
+                    cartesian_interleaved(ptrs, make_xyz_lut_f(lut),
+                                          static_cast<float*>(data));
+                } else {
+                    StridedPoints points(static_cast<double*>(data),
+                                         count * n, 3, {1, 3});
+                    cartesian(points, ptrs, lut);
+                }
+            }
+            return result;
+        },
+        R"(
+	Projects several scans of the same dimensions to points at once, one scan
+	per thread.
+	Args:
+	  scans: a list of LidarScans with a RANGE field
+	  lut: lookup tables, an ouster.sdk._bindings.client.XYZLut
+	  out: a C contiguous array of shape (N, H * W, 3) and of the dtype to
+	    write to, or None to allocate one
+	  dtype: np.float64, or np.float32 to project in single precision
+
+	Return:
+	  A NumPy array of shape (N, H * W, 3) holding the points of the ith
+	  scan at index i
+	  )",
+        py::arg("scans"), py::arg("lut"), py::arg("out") = py::none(),
+        py::arg("dtype") = py::dtype::of<double>());
+
+    m.def("clip_fields", &clip_fields,
+          R"(
+	Replaces the values of fields outside of [lower, upper] with invalid, in
+	place, one field per thread.
+	Args:
+	  scan: the LidarScan to clip
+	  fields: names of the fields to clip, empty for all of them; names the
+	    scan lacks are skipped
+	  lower: smallest value kept
+	  upper: largest value kept
+	  invalid: value written in place of the others
+	  )",
+          py::arg("scan"), py::arg("fields"), py::arg("lower"),
+          py::arg("upper"), py::arg("invalid") = 0,
+          py::call_guard<py::gil_scoped_release>());
+
+    m.def(
+        "mask_fields",
+        [](LidarScan& scan, const std::vector<std::string>& fields,
+           py::array_t<double, py::array::c_style | py::array::forcecast>
+               mask) {
+            if (mask.ndim() != 2) {
+                throw std::invalid_argument("mask must be two dimensional");
+            }
+            Eigen::Map<const img_t<double>> view(mask.data(), mask.shape(0),
+                                                 mask.shape(1));
+            py::gil_scoped_release release;
+            mask_fields(scan, fields, view);
+        },
+        R"(
+	Multiplies pixel fields by a mask in place, one field per thread. The mask
+	is cast to the dtype of each field first.
+	Args:
+	  scan: the LidarScan to mask
+	  fields: names of the fields to mask, empty for all pixel fields; names
+	    the scan lacks are skipped
+	  mask: staggered array of shape (H, W)
+	  )",
+        py::arg("scan"), py::arg("fields"), py::arg("mask"));
+
+    m.def(
+        "convert_array",
+        [](const py::array& src, const py::object& dtype, double scale,
+           double offset, const py::object& out) {
+            const FieldView in = array_field_view(src, false);
+            py::array result =
+                output_array(out, py::dtype::from_args(dtype),
+                             {src.shape(), src.shape() + src.ndim()});
+            FieldView dst = array_field_view(result, true);
+            {
+                py::gil_scoped_release release;
+                if (scale == 1 && offset == 0) {
+                    field_ops::convert(in, dst, true);
+                } else {
+                    field_ops::scale(in, dst, scale, offset, true);
+                }
+            }
+            return result;
+        },
+        R"(
+	Converts an array to another dtype in one pass, computing
+	src * scale + offset on the way. Unlike numpy casts, values out of the
+	range of the dtype saturate and NaN becomes zero.
+	Args:
+	  src: a C contiguous array of a channel field dtype
+	  dtype: the dtype to convert to
+	  scale: factor to multiply values by
+	  offset: value added after multiplying
+	  out: a C contiguous array of the shape of src and of dtype to write to,
+	    or None to allocate one
+
+	Return:
+	  The converted array
+	  )",
+        py::arg("src"), py::arg("dtype"), py::arg("scale") = 1.0,
+        py::arg("offset") = 0.0, py::arg("out") = py::none());
+
+    m.def(
+        "compare_array",
+        [](const py::array& src, const std::string& op, double value,
+           const py::object& out) {
+            const FieldView in = array_field_view(src, false);
+            py::array result =
+                output_array(out, py::dtype::of<uint8_t>(),
+                             {src.shape(), src.shape() + src.ndim()});
+            FieldView dst = array_field_view(result, true);
+            const auto cmp = compare_op_of(op);
+            {
+                py::gil_scoped_release release;
+                field_ops::compare(in, cmp, value, dst, true);
+            }
+            return result;
+        },
+        R"(
+	Compares an array to a value without the temporaries of numpy, e.g. to
+	build the mask of the pixels of a scan in range.
+	Args:
+	  src: a C contiguous array of a channel field dtype
+	  op: one of "<", "<=", ">", ">=", "==" and "!="
+	  value: value to compare to
+	  out: a C contiguous uint8 array of the shape of src to write to, or None
+	    to allocate one
+
+	Return:
+	  A uint8 array holding 1 where the comparison holds and 0 elsewhere
+	  )",
+        py::arg("src"), py::arg("op"), py::arg("value"),
+        py::arg("out") = py::none());
+
+    m.def(
+        "threshold_array",
+        [](py::array arr, double lower, double upper, double invalid) {
+            FieldView view = array_field_view(arr, true);
+            py::gil_scoped_release release;
+            field_ops::threshold(view, lower, upper, invalid, true);
+        },
+        R"(
+	Replaces the values of an array outside of [lower, upper] with invalid,
+	in place.
+	Args:
+	  arr: a writeable C contiguous array of a channel field dtype
+	  lower: smallest value kept
+	  upper: largest value kept
+	  invalid: value written in place of the others
+	  )",
+        py::arg("arr"), py::arg("lower"), py::arg("upper"),
+        py::arg("invalid") = 0.0);
+
+    m.def("reduce_by_factor", &reduce_by_factor,
+          R"(
+	Downsamples a scan vertically, keeping every factor-th row of its pixel
+	fields and copying the rest of the scan but its sensor info.
+	Args:
+	  scan: the LidarScan to downsample
+	  factor: a divisor of the scan height
+
+	Return:
+	  The downsampled LidarScan
+	  )",
+          py::arg("scan"), py::arg("factor"),
+          py::call_guard<py::gil_scoped_release>());
 
     m.attr("__version__") = ouster::SDK_VERSION;
 
@@ -6,6 +6,7 @@
 #include <pybind11/stl.h>
 #include <pybind11/stl_bind.h>
 
+#include <algorithm>
 #include <iostream>
 
 #include "common.h"
@@ -13,16 +14,24 @@
 #include "ouster/impl/profile_extension.h"
 #include "ouster/lidar_scan.h"
 #include "ouster/osf/async_writer.h"
+#include "ouster/osf/banded_lidarscan_encoder.h"
 #include "ouster/osf/basics.h"
+#include "ouster/osf/lossy_lidarscan_encoder.h"
 #include "ouster/osf/meta_extrinsics.h"
 #include "ouster/osf/meta_lidar_sensor.h"
+#include "ouster/osf/meta_recording_gaps.h"
 #include "ouster/osf/meta_streaming_info.h"
 #include "ouster/osf/metadata.h"
+#include "ouster/osf/multi_reader.h"
 #include "ouster/osf/operations.h"
 #include "ouster/osf/png_lidarscan_encoder.h"
+#include "ouster/osf/read_ahead.h"
 #include "ouster/osf/reader.h"
+#include "ouster/osf/sparse_lidarscan_encoder.h"
 #include "ouster/osf/stream_lidar_scan.h"
+#include "ouster/osf/thread_pool.h"
 #include "ouster/osf/writer.h"
+#include "ouster/osf/zstd_lidarscan_encoder.h"
 
 namespace py = pybind11;
 
@@ -80,7 +89,8 @@ This module is generated from the C++ code and provides native functions
 to work with OSF files.
 )doc";
 
-    m.def("dump_metadata", &ouster::osf::dump_metadata, R"doc(
+    m.def("dump_metadata", &ouster::osf::dump_metadata,
+          py::call_guard<py::gil_scoped_release>(), R"doc(
         Dump OSF metadata/session info in JSON format. (aka osf-metadata)
 
         :file: OSF file path
@@ -88,7 +98,8 @@ to work with OSF files.
     )doc",
           py::arg("file"), py::arg("full") = true);
 
-    m.def("parse_and_print", &ouster::osf::parse_and_print, R"doc(
+    m.def("parse_and_print", &ouster::osf::parse_and_print,
+          py::call_guard<py::gil_scoped_release>(), R"doc(
         Parse OSF file and print messages types, timestamps and counts to
         stdout.
 
@@ -97,6 +108,7 @@ to work with OSF files.
           py::arg("file"), py::arg("with_decoding") = false);
 
     m.def("backup_osf_file_metablob", &ouster::osf::backup_osf_file_metablob,
+          py::call_guard<py::gil_scoped_release>(),
           R"doc(
          Backup the metadata blob in an OSF file.
 
@@ -106,6 +118,7 @@ to work with OSF files.
           py::arg("file"), py::arg("backup_file_name"));
 
     m.def("restore_osf_file_metablob", &ouster::osf::restore_osf_file_metablob,
+          py::call_guard<py::gil_scoped_release>(),
           R"doc(
         Restore an OSF metadata blob from a backup file.
 
@@ -115,6 +128,7 @@ to work with OSF files.
           py::arg("file"), py::arg("backup_file_name"));
 
     m.def("osf_file_modify_metadata", &ouster::osf::osf_file_modify_metadata,
+          py::call_guard<py::gil_scoped_release>(),
           R"doc(
         Modify an OSF files sensor_info metadata.
 
@@ -124,11 +138,150 @@ to work with OSF files.
     )doc",
           py::arg("file_name"), py::arg("new_metadata"));
 
+    m.def("recover_osf_file", &ouster::osf::recover_osf_file,
+          py::call_guard<py::gil_scoped_release>(),
+          R"doc(
+        Finish an OSF file that was never closed, e.g. after a power loss,
+        from the last metadata checkpoint written with a checkpoint interval.
+
+        :file_name: The OSF file to recover.
+        :returns: The size of the recovered OSF file, -1 if it has no intact
+                  checkpoint.
+    )doc",
+          py::arg("file_name"));
+
+    m.def(
+        "slice_osf_file",
+        [](const std::string& file_name, const std::string& output_file_name,
+           uint64_t start_ts, uint64_t end_ts,
+           const std::vector<uint32_t>& stream_ids) {
+            return ouster::osf::slice_osf_file(
+                file_name, output_file_name, osf::ts_t{start_ts},
+                osf::ts_t{end_ts}, stream_ids);
+        },
+        py::call_guard<py::gil_scoped_release>(),
+        R"doc(
+        Copy the messages of an OSF file in the [start_ts, end_ts] range of a
+        set of streams to a new OSF file, copying the chunks entirely in the
+        selection as they are, without decoding them.
+
+        :file_name: The OSF file to slice.
+        :output_file_name: The OSF file to write.
+        :start_ts: The lowest timestamp to copy.
+        :end_ts: The highest timestamp to copy.
+        :stream_ids: The streams to copy, all if empty.
+        :returns: The size of the written OSF file.
+    )doc",
+        py::arg("file_name"), py::arg("output_file_name"),
+        py::arg("start_ts"), py::arg("end_ts"),
+        py::arg("stream_ids") = std::vector<uint32_t>{});
+
+    m.def("merge_osf_files", &ouster::osf::merge_osf_files,
+          py::call_guard<py::gil_scoped_release>(),
+          R"doc(
+        Merge a recording split into several OSF files of the same streams
+        into one, copying their chunks as they are.
+
+        :file_names: The OSF files to merge, in any order.
+        :output_file_name: The OSF file to write.
+        :returns: The size of the written OSF file.
+    )doc",
+          py::arg("file_names"), py::arg("output_file_name"));
+
+    py::enum_<osf::FileBackend>(m, "FileBackend")
+        .value("DEFAULT", osf::FileBackend::DEFAULT)
+        .value("MMAP", osf::FileBackend::MMAP)
+        .value("STREAM", osf::FileBackend::STREAM)
+        .value("PREAD", osf::FileBackend::PREAD)
+        .value("HTTP", osf::FileBackend::HTTP);
+
+    py::class_<osf::FileOptions>(m, "FileOptions", R"(
+        How a ``Reader`` reads the file. ``FileBackend.PREAD`` suits files on
+        network or FUSE file systems and files too large to be memory mapped.
+        ``FileBackend.HTTP``, the default for http(s):// URLs, reads the file
+        with HTTP range requests, e.g. from S3 compatible storage through a
+        presigned URL.
+        )")
+        .def(py::init<>())
+        .def_readwrite("backend", &osf::FileOptions::backend,
+                       "The way to read the file.")
+        .def_readwrite("read_ahead", &osf::FileOptions::read_ahead, R"(
+             Bytes read at once by ``PREAD`` and ``HTTP``, rounded up to 4 KiB
+             blocks.
+             )")
+        .def_readwrite("sequential", &osf::FileOptions::sequential, R"(
+             Whether the file is mostly read from start to end, so that the OS
+             reads ahead of ``PREAD`` and ``HTTP`` fetches the next bytes in
+             the background.
+             )")
+        .def_readwrite("timeout_seconds", &osf::FileOptions::timeout_seconds,
+                       "Timeout of each ``HTTP`` request in seconds.")
+        .def_readwrite("lazy_open", &osf::FileOptions::lazy_open, R"(
+             Whether a ``Reader`` opens the file with only its header and
+             metadata, indexing the chunks on the first read.
+             )");
+
+    py::class_<osf::ReaderCacheOptions>(m, "ReaderCacheOptions", R"(
+        Memory bounds of the caches of a ``Reader``, shared by all of its
+        iterators and ``ScanReadAhead``, e.g. for random access to the same
+        scans.
+        )")
+        .def(py::init<>())
+        .def_readwrite("chunk_bytes", &osf::ReaderCacheOptions::chunk_bytes,
+                       R"(
+             Bytes of verified chunks kept in memory, 0 to not cache them.
+             Only chunks of files that aren't memory mapped are cached.
+             )")
+        .def_readwrite("scan_bytes", &osf::ReaderCacheOptions::scan_bytes, R"(
+             Bytes of scans decoded by ``ScanReadAhead`` kept in memory, 0 to
+             not cache them.
+             )");
+
+    py::class_<osf::StreamIndex>(m, "StreamIndex", R"(
+        The index of the messages of a stream, from the metadata of an OSF
+        only, see ``Reader.stream_index``.
+        )")
+        .def_readonly("stream_id", &osf::StreamIndex::stream_id)
+        .def_readonly("message_count", &osf::StreamIndex::message_count)
+        .def_property_readonly(
+            "timestamps",
+            [](const osf::StreamIndex& self) {
+                return py::array(py::dtype::of<uint64_t>(),
+                                 self.timestamps.size(), self.timestamps.data(),
+                                 py::cast(self));
+            },
+            "Receive timestamp of every message, empty without timestamp "
+            "index.")
+        .def_property_readonly(
+            "chunk_offsets",
+            [](const osf::StreamIndex& self) {
+                return py::array(py::dtype::of<uint64_t>(),
+                                 self.chunk_offsets.size(),
+                                 self.chunk_offsets.data(), py::cast(self));
+            },
+            "Offsets of the chunks of the stream, empty without message "
+            "index.")
+        .def_property_readonly(
+            "chunk_message_starts",
+            [](const osf::StreamIndex& self) {
+                return py::array(py::dtype::of<uint32_t>(),
+                                 self.chunk_message_starts.size(),
+                                 self.chunk_message_starts.data(),
+                                 py::cast(self));
+            },
+            "Index of the first message of the stream in each chunk.")
+        .def("chunk_offset", &osf::StreamIndex::chunk_offset,
+             py::arg("message_idx"),
+             "Offset of the chunk holding a message, by binary search.");
+
     // Reader
     py::class_<osf::Reader>(m, "Reader", R"(
         Reader is a main entry point to get any info out of OSF file.
     )")
-        .def(py::init<std::string>(), py::arg("file"))
+        .def(py::init<std::string>(), py::arg("file"),
+             py::call_guard<py::gil_scoped_release>())
+        .def(py::init<std::string, const osf::FileOptions&>(), py::arg("file"),
+             py::arg("options"), py::call_guard<py::gil_scoped_release>())
         .def_property_readonly("metadata_id", &osf::Reader::metadata_id, R"(
             Data id string
         )")
@@ -159,6 +312,12 @@ to work with OSF files.
             "has_timestamp_idx", &osf::Reader::has_timestamp_idx,
             "Whether OSF contains the message timestamp index in the metadata "
             "necessary to quickly collate and jump to a specific message time.")
+        .def("set_cache", &osf::Reader::set_cache, py::arg("options"), R"(
+                Set the memory bounds of the caches, evicting the least
+                recently used chunks and scans past them.
+            )")
+        .def("cache_options", &osf::Reader::cache_options,
+             "Get the memory bounds of the caches.")
         .def(
             "messages",
             [](osf::Reader& r) {
@@ -205,6 +364,27 @@ to work with OSF files.
                     Read `messages` in ``[start_ts, end_ts]`` timestamp range (inclusive) of a
                     specified ``<stream_ids>`` list
                 )")
+        .def(
+            "stream_messages",
+            [](osf::Reader& reader, std::vector<uint32_t> stream_ids,
+               uint64_t start_ts, uint64_t end_ts) {
+                py::object self = py::cast(reader);
+                py::list iters;
+                for (auto& msgs : reader.stream_messages(
+                         stream_ids, osf::ts_t{start_ts}, osf::ts_t{end_ts})) {
+                    py::object it = py::make_iterator(msgs.begin(), msgs.end());
+                    py::detail::keep_alive_impl(it, self);
+                    iters.append(it);
+                }
+                return iters;
+            },
+            py::arg("stream_ids"), py::arg("start_ts"), py::arg("end_ts"),
+            R"(
+                    Read `messages` in ``[start_ts, end_ts]`` timestamp range (inclusive),
+                    with an iterator per stream of ``<stream_ids>``, all streams if empty.
+
+                    The iterators of different streams may be consumed from separate threads.
+                )")
         .def(
             "ts_by_message_idx",
             [](osf::Reader& reader, uint32_t stream_id,
@@ -222,6 +402,35 @@ to work with OSF files.
                     Requires the OSF with message_counts inside, i.e. has_message_idx()
                     is ``True``, otherwise return value is always None.
                 )")
+        .def("stream_index", &osf::Reader::stream_index,
+             py::arg("stream_id"),
+             py::call_guard<py::gil_scoped_release>(), R"(
+                Get the message count, receive timestamps and chunks of a
+                stream in one call, from the metadata only.
+            )")
+        .def(
+            "collate_messages",
+            [](const osf::Reader& reader,
+               const std::vector<uint32_t>& stream_ids, int64_t dt) {
+                std::vector<int64_t> frames;
+                {
+                    py::gil_scoped_release release;
+                    frames = reader.collate_messages(stream_ids, dt);
+                }
+                const auto n = std::max<size_t>(stream_ids.size(), 1);
+                py::array_t<int64_t> result(
+                    {static_cast<py::ssize_t>(frames.size() / n),
+                     static_cast<py::ssize_t>(stream_ids.size())});
+                std::copy(frames.begin(), frames.end(), result.mutable_data());
+                return result;
+            },
+            py::arg("stream_ids"), py::arg("dt") = 210000000, R"(
+                Collate the messages of streams into frames by their receive
+                timestamps, as ``collate_scans`` does, from the metadata only.
+
+                Returns an array with a row per frame holding the index of the
+                message of each stream in it, -1 if it has none.
+            )")
         .def(
             "chunks",
             [](osf::Reader& r) {
@@ -231,6 +440,107 @@ to work with OSF files.
                 Creates an iterator to reads chunks as they appear in a file.
             )");
 
+    py::class_<osf::MultiReader>(m, "MultiReader", R"(
+        Reads a recording split into several OSF files, e.g. hourly files, as
+        one. Only the metadata of each file is read up front, its ``Reader``
+        is opened the first time its messages or chunks are read.
+    )")
+        .def(py::init<std::vector<std::string>, const osf::FileOptions&>(),
+             py::arg("files"), py::arg("options") = osf::FileOptions(),
+             py::call_guard<py::gil_scoped_release>())
+        .def_static(
+            "from_manifest",
+            [](const std::string& manifest, const osf::FileOptions& options) {
+                return std::make_unique<osf::MultiReader>(
+                    osf::load_shard_manifest(manifest), options);
+            },
+            py::arg("manifest"), py::arg("options") = osf::FileOptions(),
+            py::call_guard<py::gil_scoped_release>(), R"(
+                Read the shards of a recording listed in the shard manifest
+                of a ``ShardedWriter`` as one, their messages merged in
+                timestamp order.
+            )")
+        .def_property_readonly("sharded", &osf::MultiReader::sharded,
+                               "Whether the files are shards read side by "
+                               "side.")
+        .def("__len__", &osf::MultiReader::size)
+        .def("filename", &osf::MultiReader::filename, py::arg("file_idx"),
+             "The name of a file, in order of time.")
+        .def("reader", &osf::MultiReader::reader, py::arg("file_idx"),
+             py::return_value_policy::reference_internal,
+             "The ``Reader`` of a file, in order of time.")
+        .def_property_readonly(
+            "start_ts",
+            [](const osf::MultiReader& r) { return r.start_ts().count(); },
+            "Lowest timestamp of the files.")
+        .def_property_readonly(
+            "end_ts",
+            [](const osf::MultiReader& r) { return r.end_ts().count(); },
+            "Highest timestamp of the files.")
+        .def(
+            "messages",
+            [](osf::MultiReader& r) {
+                auto msgs = r.messages();
+                return py::make_iterator(msgs.begin(), msgs.end());
+            },
+            py::keep_alive<0, 1>(), R"(
+                Creates an iterator to read the messages of all files in
+                timestamp order.
+            )")
+        .def(
+            "messages",
+            [](osf::MultiReader& r, uint64_t start_ts, uint64_t end_ts) {
+                auto msgs = r.messages(osf::ts_t{start_ts}, osf::ts_t{end_ts});
+                return py::make_iterator(msgs.begin(), msgs.end());
+            },
+            py::keep_alive<0, 1>(), py::arg("start_ts"), py::arg("end_ts"),
+            R"(
+                Read `messages` in ``[start_ts, end_ts]`` timestamp range
+                (inclusive)
+            )")
+        .def(
+            "messages",
+            [](osf::MultiReader& r, std::vector<uint32_t> stream_ids,
+               uint64_t start_ts, uint64_t end_ts) {
+                auto msgs = r.messages(stream_ids, osf::ts_t{start_ts},
+                                       osf::ts_t{end_ts});
+                return py::make_iterator(msgs.begin(), msgs.end());
+            },
+            py::keep_alive<0, 1>(), py::arg("stream_ids"), py::arg("start_ts"),
+            py::arg("end_ts"),
+            R"(
+                Read `messages` in ``[start_ts, end_ts]`` timestamp range (inclusive) of a
+                specified ``<stream_ids>`` list, all streams if empty
+            )")
+        .def(
+            "chunks",
+            [](osf::MultiReader& r) {
+                auto chunks = r.chunks();
+                return py::make_iterator(chunks.begin(), chunks.end());
+            },
+            py::keep_alive<0, 1>(), R"(
+                Creates an iterator to read the chunks of all files, file after
+                file.
+            )")
+        .def("message_count", &osf::MultiReader::message_count,
+             py::arg("stream_id"),
+             "The number of messages of a stream in all files.")
+        .def(
+            "ts_by_message_idx",
+            [](osf::MultiReader& r, uint32_t stream_id,
+               uint64_t message_idx) -> py::object {
+                auto ts = r.ts_by_message_idx(stream_id, message_idx);
+                if (ts) {
+                    return py::int_(ts->count());
+                }
+                return py::none();
+            },
+            py::arg("stream_id"), py::arg("message_idx"),
+            R"(
+                Find the timestamp of the message by its index in the stream
+                across all files, None if not found.
+            )");
+
     // MessageRef
     py::class_<osf::MessageRef>(m, "MessageRef", R"(
         Thin `message` wrapper for underlying `StampedMessage` object.
@@ -250,6 +560,16 @@ to work with OSF files.
             "Message timestamp (ns)")
         .def_property_readonly("buffer", &osf::MessageRef::buffer,
                                "Returns encoded message byte array")
+        .def_property_readonly(
+            "view",
+            [](py::object self) {
+                const auto view = self.cast<const osf::MessageRef&>().view();
+                py::array arr(py::dtype::of<uint8_t>(), view.shape[0],
+                              view.data(), self);
+                arr.attr("setflags")(py::arg("write") = false);
+                return arr;
+            },
+            "Read only view of the encoded message bytes, without a copy.")
         .def("__repr__", &osf::MessageRef::to_string)
         .def("__str__", &osf::MessageRef::to_string)
         .def(
@@ -269,8 +589,12 @@ to work with OSF files.
             [](const osf::MessageRef& msg,
                const std::vector<std::string>& fields) -> py::object {
                 if (msg.is<osf::LidarScanStream>()) {
-                    auto decoded_obj =
-                        msg.decode_msg<osf::LidarScanStream>(fields);
+                    std::unique_ptr<LidarScan> decoded_obj;
+                    {
+                        py::gil_scoped_release release;
+                        decoded_obj =
+                            msg.decode_msg<osf::LidarScanStream>(fields);
+                    }
                     return py::cast(*decoded_obj);
                 }
                 // TODO[pb]: Add dynamic check for Stream decoding functions ...
@@ -282,6 +606,22 @@ to work with OSF files.
             Decodes the underlying object and returns it.
 
             Currently supports only LidarScans
+        )")
+        .def(
+            "decode_into",
+            [](const osf::MessageRef& msg, LidarScan& scan,
+               const std::vector<std::string>& fields) {
+                if (!msg.is<osf::LidarScanStream>()) return false;
+                return msg.decode_msg_into<osf::LidarScanStream>(scan, fields);
+            },
+            py::arg("scan"), py::arg("fields") = std::vector<std::string>(),
+            py::call_guard<py::gil_scoped_release>(),
+            R"(
+            Decodes the underlying LidarScan into ``scan``, reusing its fields
+            when it already has the size and fields of the message.
+
+            Returns:
+                False if the message isn't a LidarScan or couldn't be decoded
         )");
 
     // MetadataStore
@@ -584,6 +924,75 @@ to work with OSF files.
             return osf::metadata_type<osf::Extrinsics>();
         });
 
+    // RecordingGaps
+    py::class_<osf::RecordingGaps, osf::MetadataEntry,
+               std::shared_ptr<osf::RecordingGaps>>(m, "RecordingGaps", R"(
+        Scans of a sensor referred by ``ref_meta_id`` left out of the
+        recording by a ScanGate, see ``Writer.set_scan_gate``.
+
+        ``type_id`` static property is a ``RecordingGaps`` metadata type
+        identifier.
+    )")
+        .def(py::init<std::vector<SkippedSpan>, uint64_t, uint32_t>(),
+             py::arg("spans"), py::arg("kept") = 0,
+             py::arg("ref_meta_id") = 0, "Create RecordingGaps object")
+        .def_property_readonly("spans", &osf::RecordingGaps::spans,
+                               "runs of scans left out, in order")
+        .def_property_readonly("kept", &osf::RecordingGaps::kept,
+                               "number of scans recorded")
+        .def_property_readonly("skipped", &osf::RecordingGaps::skipped,
+                               "number of scans left out")
+        .def_property_readonly("ref_meta_id",
+                               &osf::RecordingGaps::ref_meta_id,
+                               "reference to the metadata entry id of the "
+                               "sensor of the scans")
+        .def_property_readonly_static("type_id", [](py::object) {
+            return osf::metadata_type<osf::RecordingGaps>();
+        });
+
+    py::class_<osf::ChunkIoOptions>(m, "ChunkIoOptions", R"(
+        How the Writer writes chunks to the file. The default writes each
+        chunk through the page cache on the thread that finished it.
+        )")
+        .def(py::init<>())
+        .def_readwrite("direct", &osf::ChunkIoOptions::direct, R"(
+             Write with O_DIRECT from block aligned buffers, bypassing the
+             page cache. Linux only.
+             )")
+        .def_readwrite("background", &osf::ChunkIoOptions::background,
+                       "Write chunks on a dedicated thread.")
+        .def_readwrite("preallocate_bytes",
+                       &osf::ChunkIoOptions::preallocate_bytes, R"(
+             Reserve file space with fallocate this many bytes at a time, 0
+             to not preallocate. Linux only.
+             )")
+        .def_readwrite("sync_every_chunk",
+                       &osf::ChunkIoOptions::sync_every_chunk,
+                       "Flush each chunk to the disk with fdatasync.");
+
+    py::class_<osf::ChunkPolicy>(m, "ChunkPolicy", R"(
+        When the chunk of a stream is finished, before a message that would
+        take it past any of the limits. Limiting only the duration sizes the
+        chunks of each stream after its data rate.
+        )")
+        .def(py::init<>())
+        .def_readwrite("max_size", &osf::ChunkPolicy::max_size,
+                       "Largest chunk size in bytes, 0 for no limit.")
+        .def_readwrite("max_messages", &osf::ChunkPolicy::max_messages,
+                       "Largest number of messages in a chunk, 0 for no limit.")
+        .def_property(
+            "max_duration",
+            [](const osf::ChunkPolicy& policy) {
+                return policy.max_duration.count();
+            },
+            [](osf::ChunkPolicy& policy, int64_t duration) {
+                policy.max_duration = osf::ts_t{duration};
+            },
+            R"(
+             Longest span of receive timestamps in a chunk in nanoseconds, 0
+             for no limit.
+             )");
+
     // Writer
     py::class_<osf::Writer>(m, "Writer", R"(
         Simple writer interface for OSF file
@@ -666,6 +1075,7 @@ to work with OSF files.
             [](osf::Writer& writer, uint32_t stream_index,
                const LidarScan& scan) { writer.save(stream_index, scan); },
             py::arg("stream_index"), py::arg("scan"),
+            py::call_guard<py::gil_scoped_release>(),
             R"(
                Save a lidar scan to the OSF file.
 
@@ -682,6 +1092,7 @@ to work with OSF files.
                 writer.save(stream_index, scan, ouster::osf::ts_t(ts));
             },
             py::arg("stream_index"), py::arg("scan"), py::arg("ts"),
+            py::call_guard<py::gil_scoped_release>(),
             R"(
                Save a lidar scan to the OSF file.
 
@@ -696,7 +1107,7 @@ to work with OSF files.
             [](osf::Writer& writer, const std::vector<LidarScan>& scans) {
                 writer.save(scans);
             },
-            py::arg("scan"),
+            py::arg("scan"), py::call_guard<py::gil_scoped_release>(),
             R"(
                Save a set of lidar scans to the OSF file.
 
@@ -751,8 +1162,10 @@ to work with OSF files.
             "save_message",
             [](osf::Writer& writer, uint32_t stream_id, uint64_t receive_ts,
                uint64_t sensor_ts, py::array_t<uint8_t>& buf) {
+                auto msg = getvector(buf);
+                py::gil_scoped_release release;
                 writer.save_message(stream_id, osf::ts_t{receive_ts},
-                                    osf::ts_t{sensor_ts}, getvector(buf));
+                                    osf::ts_t{sensor_ts}, msg);
             },
             py::arg("stream_id"), py::arg("receive_ts"), py::arg("sensor_ts"),
             py::arg("buffer"), R"(
@@ -765,8 +1178,10 @@ to work with OSF files.
             "save_message",
             [](osf::Writer& writer, uint32_t stream_id, uint64_t receive_ts,
                uint64_t sensor_ts, py::buffer& buf) {
+                auto msg = getvector(buf);
+                py::gil_scoped_release release;
                 writer.save_message(stream_id, osf::ts_t{receive_ts},
-                                    osf::ts_t{sensor_ts}, getvector(buf));
+                                    osf::ts_t{sensor_ts}, msg);
             },
             py::arg("stream_id"), py::arg("receive_ts"), py::arg("sensor_ts"),
             py::arg("buffer"), R"(
@@ -797,7 +1212,59 @@ to work with OSF files.
 
             )")
         .def("close", &osf::Writer::close,
+             py::call_guard<py::gil_scoped_release>(),
              "Finish OSF file and flush everything to disk.")
+        .def("set_chunk_io", &osf::Writer::set_chunk_io, py::arg("options"),
+             R"(
+               Set how chunks are written to the file, before the first
+               chunk is written.
+
+               Args:
+                   options (ChunkIoOptions): the chunk I/O options.
+
+            )")
+        .def("chunk_io", &osf::Writer::chunk_io,
+             "Get how chunks are written to the file.")
+        .def("set_chunk_policy",
+             py::overload_cast<const osf::ChunkPolicy&>(
+                 &osf::Writer::set_chunk_policy),
+             py::arg("policy"),
+             "Set the chunk policy of the streams without one of their own.")
+        .def("set_chunk_policy",
+             py::overload_cast<uint32_t, const osf::ChunkPolicy&>(
+                 &osf::Writer::set_chunk_policy),
+             py::arg("stream_id"), py::arg("policy"),
+             "Set the chunk policy of a stream.")
+        .def("set_sensor_chunk_policy", &osf::Writer::set_sensor_chunk_policy,
+             py::arg("stream_index"), py::arg("policy"),
+             "Set the chunk policy of the scans of a sensor.")
+        .def("set_scan_gate", &osf::Writer::set_scan_gate, py::arg("options"),
+             R"(
+             Leave out the scans of every sensor nearly identical to the last
+             one saved, storing the runs left out as RecordingGaps metadata.
+             Set before saving scans.
+             )")
+        .def("save_packet", &osf::Writer::save_packet,
+             py::arg("stream_index"), py::arg("packet"), R"(
+             Save a raw lidar or IMU packet of a sensor as it was received,
+             batched into scans when the file is read.
+             )")
+        .def("set_packet_compression", &osf::Writer::set_packet_compression,
+             py::arg("level"),
+             "Set the zstd level of the packet streams added, 0 for none.")
+        .def("set_columnar", &osf::Writer::set_columnar,
+             py::arg("stream_index"), py::arg("columnar") = true,
+             "Store the scans of a sensor as one stream per field.")
+        .def("columnar", &osf::Writer::columnar, py::arg("stream_index"),
+             "Whether the scans of a sensor are stored in columnar form.")
+        .def("chunk_policy", &osf::Writer::chunk_policy, py::arg("stream_id"),
+             "Get the chunk policy of a stream.")
+        .def_property("checkpoint_interval", &osf::Writer::checkpoint_interval,
+                      &osf::Writer::set_checkpoint_interval, R"(
+             The number of chunks between checkpoints of the metadata, which
+             ``recover_osf_file`` finishes a file from if it's never closed,
+             0 to not write checkpoints.
+             )")
         .def(
             "is_closed", [](osf::Writer& writer) { return writer.is_closed(); },
             R"(
@@ -812,6 +1279,7 @@ to work with OSF files.
             [](osf::Writer& writer, uint32_t stream_index,
                const LidarScan& scan) { writer.save(stream_index, scan); },
             py::arg("stream_index"), py::arg("scan"),
+            py::call_guard<py::gil_scoped_release>(),
             R"(
                Save a lidar scan to the OSF file.
 
@@ -826,7 +1294,7 @@ to work with OSF files.
             [](osf::Writer& writer, const std::vector<LidarScan>& scans) {
                 writer.save(scans);
             },
-            py::arg("scan"),
+            py::arg("scan"), py::call_guard<py::gil_scoped_release>(),
             R"(
                Save a set of lidar scans to the OSF file.
 
@@ -882,26 +1350,76 @@ to work with OSF files.
             [](osf::Writer& writer, pybind11::object& /*exc_type*/,
                pybind11::object& /*exc_value*/,
                pybind11::object& /*traceback*/) {
-                writer.close();
-
+                {
+                    py::gil_scoped_release release;
+                    writer.close();
+                }
                 return py::none();
             },
             R"(
                  Allow Writer to work within `with` blocks.
             )");
 
-    py::class_<ouster::osf::AsyncWriter>(m, "AsyncWriter")
+    py::class_<osf::AsyncWriterStats>(m, "AsyncWriterStats", R"(
+        Throughput and latencies of an AsyncWriter, in nanoseconds.
+    )")
+        .def(py::init<>())
+        .def_readonly("written", &osf::AsyncWriterStats::written)
+        .def_readonly("dropped", &osf::AsyncWriterStats::dropped)
+        .def_readonly("spilled", &osf::AsyncWriterStats::spilled)
+        .def_readonly("spill_backlog", &osf::AsyncWriterStats::spill_backlog)
+        .def_readonly("in_flight_bytes",
+                      &osf::AsyncWriterStats::in_flight_bytes)
+        .def_readonly("in_flight", &osf::AsyncWriterStats::in_flight)
+        .def_readonly("max_in_flight", &osf::AsyncWriterStats::max_in_flight)
+        .def_readonly("encode_latency",
+                      &osf::AsyncWriterStats::encode_latency)
+        .def_readonly("write_latency", &osf::AsyncWriterStats::write_latency)
+        .def_readonly("save_latency", &osf::AsyncWriterStats::save_latency)
+        .def_readonly("save_thread_cpu_seconds",
+                      &osf::AsyncWriterStats::save_thread_cpu_seconds);
+
+    m.def(
+        "add_metrics",
+        [](sensor::OpenMetrics& metrics, const osf::AsyncWriterStats& stats,
+           const py::dict& labels) {
+            sensor::MetricLabels out;
+            for (const auto& item : labels) {
+                out.emplace_back(py::str(item.first), py::str(item.second));
+            }
+            osf::add_metrics(metrics, stats, out);
+        },
+        R"(
+        Add the health metrics of an AsyncWriter: dropped scans, the encode
+        backlog and, when latency stats are enabled, the scans written and
+        the latency of each stage.
+        )",
+        py::arg("metrics"), py::arg("stats"), py::arg("labels") = py::dict());
+
+    py::class_<ouster::osf::AsyncWriter> async_writer(m, "AsyncWriter");
+
+    py::enum_<osf::AsyncWriter::OverflowPolicy>(async_writer, "OverflowPolicy")
+        .value("BLOCK", osf::AsyncWriter::OverflowPolicy::BLOCK)
+        .value("DROP", osf::AsyncWriter::OverflowPolicy::DROP)
+        .value("SPILL", osf::AsyncWriter::OverflowPolicy::SPILL);
+
+    async_writer
         .def(py::init([](const std::string& filename,
                          const std::vector<sensor::sensor_info>& info,
                          const std::vector<std::string>& fields_to_write,
                          uint32_t chunk_size,
-                         std::shared_ptr<ouster::osf::Encoder> encoder) {
+                         std::shared_ptr<ouster::osf::Encoder> encoder,
+                         size_t max_in_flight,
+                         osf::AsyncWriter::OverflowPolicy overflow) {
                  return new osf::AsyncWriter(filename, info, fields_to_write,
-                                             chunk_size, encoder);
+                                             chunk_size, encoder,
+                                             max_in_flight, overflow);
              }),
              py::arg("filename"), py::arg("info"),
              py::arg("fields_to_write") = std::vector<std::string>{},
              py::arg("chunk_size") = 0, py::arg("encoder") = nullptr,
+             py::arg("max_in_flight") = 10,
+             py::arg("overflow") = osf::AsyncWriter::OverflowPolicy::BLOCK,
              R"(
              Creates an `AsyncWriter` with specified ``chunk_size``.
 
@@ -918,9 +1436,54 @@ to work with OSF files.
                     is optional.
                 encoder (Encoder): an optional encoder instance,
                     used to configure how writer encodes the OSF.
+                max_in_flight (int): the maximum number of scans being
+                    encoded or waiting to be written.
+                overflow (OverflowPolicy): whether ``save`` blocks, drops
+                    or spills the scan to disk when ``max_in_flight`` scans
+                    are in flight.
         )")
         .def("close", &osf::AsyncWriter::close,
+             py::call_guard<py::gil_scoped_release>(),
              "Finish OSF file and flush everything to disk.")
+        .def("dropped", &osf::AsyncWriter::dropped,
+             "Number of scans dropped with ``OverflowPolicy.DROP``.")
+        .def("spilled", &osf::AsyncWriter::spilled,
+             "Number of scans spilled to disk with ``OverflowPolicy.SPILL``.")
+        .def("set_memory_limit", &osf::AsyncWriter::set_memory_limit,
+             py::arg("bytes"),
+             "Limit the bytes of the copies of the scans in flight, 0 for "
+             "none.")
+        .def("set_spill_file", &osf::AsyncWriter::set_spill_file,
+             py::arg("path"),
+             "Set the scratch file of ``OverflowPolicy.SPILL``.")
+        .def("stats", &osf::AsyncWriter::stats,
+             "Throughput and latencies of the pipeline.")
+        .def("enable_latency_stats", &osf::AsyncWriter::enable_latency_stats,
+             py::arg("enable") = true,
+             "Start or stop recording scan counts and latencies.")
+        .def("set_checkpoint_interval",
+             &osf::AsyncWriter::set_checkpoint_interval, py::arg("chunks"),
+             "Set the number of chunks between checkpoints of the metadata.")
+        .def("set_chunk_policy", &osf::AsyncWriter::set_chunk_policy,
+             py::arg("policy"),
+             "Set the chunk policy of the streams without one of their own.")
+        .def("set_sensor_chunk_policy",
+             &osf::AsyncWriter::set_sensor_chunk_policy,
+             py::arg("stream_index"), py::arg("policy"),
+             "Set the chunk policy of the scans of a sensor.")
+        .def("set_scan_gate", &osf::AsyncWriter::set_scan_gate,
+             py::arg("options"),
+             "Leave out the scans nearly identical to the last one saved.")
+        .def("set_chunk_io", &osf::AsyncWriter::set_chunk_io,
+             py::arg("options"),
+             R"(
+               Set how chunks are written to the file, before the first
+               chunk is written.
+
+               Args:
+                   options (ChunkIoOptions): the chunk I/O options.
+
+            )")
         .def(
             "save",
             [](osf::AsyncWriter& writer, uint32_t stream_index,
@@ -928,6 +1491,7 @@ to work with OSF files.
                 return FutureWrapper(writer.save(stream_index, scan));
             },
             py::arg("stream_index"), py::arg("scan"),
+            py::call_guard<py::gil_scoped_release>(),
             R"(
                Save a lidar scan to the OSF file.
 
@@ -947,6 +1511,7 @@ to work with OSF files.
                     writer.save(stream_index, scan, ouster::osf::ts_t(ts)));
             },
             py::arg("stream_index"), py::arg("scan"), py::arg("ts"),
+            py::call_guard<py::gil_scoped_release>(),
             R"(
                Save a lidar scan to the OSF file.
 
@@ -969,7 +1534,7 @@ to work with OSF files.
                     [](auto&& f) { return FutureWrapper(std::move(f)); });
                 return wrapped_futures;
             },
-            py::arg("scan"),
+            py::arg("scan"), py::call_guard<py::gil_scoped_release>(),
             R"(
                Save a set of lidar scans to the OSF file.
 
@@ -989,8 +1554,10 @@ to work with OSF files.
             [](osf::AsyncWriter& writer, pybind11::object& /*exc_type*/,
                pybind11::object& /*exc_value*/,
                pybind11::object& /*traceback*/) {
-                writer.close();
-
+                {
+                    py::gil_scoped_release release;
+                    writer.close();
+                }
                 return py::none();
             },
             R"(
@@ -998,25 +1565,384 @@ to work with OSF files.
             )");
 
     py::class_<FutureWrapper>(m, "FutureWrapper")
-        .def("get", &FutureWrapper::get)
+        .def("get", &FutureWrapper::get,
+             py::call_guard<py::gil_scoped_release>())
         .def("valid", &FutureWrapper::valid)
-        .def("wait", &FutureWrapper::wait);
+        .def("wait", &FutureWrapper::wait,
+             py::call_guard<py::gil_scoped_release>());
 
     py::class_<ouster::osf::LidarScanEncoder,
                std::shared_ptr<ouster::osf::LidarScanEncoder>>(
         m, "LidarScanEncoder");
 
+    py::enum_<ouster::osf::PngFilter>(m, "PngFilter")
+        .value("DEFAULT", ouster::osf::PngFilter::DEFAULT)
+        .value("NONE", ouster::osf::PngFilter::NONE)
+        .value("SUB", ouster::osf::PngFilter::SUB)
+        .value("UP", ouster::osf::PngFilter::UP)
+        .value("AVG", ouster::osf::PngFilter::AVG)
+        .value("PAETH", ouster::osf::PngFilter::PAETH);
+
+    py::enum_<ouster::osf::PngStrategy>(m, "PngStrategy")
+        .value("DEFAULT", ouster::osf::PngStrategy::DEFAULT)
+        .value("FILTERED", ouster::osf::PngStrategy::FILTERED)
+        .value("HUFFMAN_ONLY", ouster::osf::PngStrategy::HUFFMAN_ONLY)
+        .value("RLE", ouster::osf::PngStrategy::RLE);
+
     py::class_<ouster::osf::PngLidarScanEncoder, ouster::osf::LidarScanEncoder,
                std::shared_ptr<ouster::osf::PngLidarScanEncoder>>(
         m, "PngLidarScanEncoder", R"(Used by the Writer class to
     encode LidarScans using PNG compression.)")
-        .def(py::init<int>(), py::arg("compression_amount"));
+        .def(py::init<int, ouster::osf::PngFilter, ouster::osf::PngStrategy>(),
+             py::arg("compression_amount"),
+             py::arg("filter") = ouster::osf::PngFilter::DEFAULT,
+             py::arg("strategy") = ouster::osf::PngStrategy::DEFAULT);
+
+    py::class_<ouster::osf::ZstdLidarScanEncoder,
+               ouster::osf::LidarScanEncoder,
+               std::shared_ptr<ouster::osf::ZstdLidarScanEncoder>>(
+        m, "ZstdLidarScanEncoder", R"(Used by the Writer class to
+    encode LidarScans using zstd compression, faster than PNG.)")
+        .def(py::init<int>(),
+             py::arg("compression_level") =
+                 ouster::osf::DEFAULT_ZSTD_OSF_COMPRESSION_LEVEL);
+
+    py::class_<ouster::osf::BandedLidarScanEncoder,
+               ouster::osf::LidarScanEncoder,
+               std::shared_ptr<ouster::osf::BandedLidarScanEncoder>>(
+        m, "BandedLidarScanEncoder", R"(Used by the Writer class to
+    encode LidarScans as independent bands of rows, each encoded by another
+    encoder, so that every field is encoded and decoded by several threads.)")
+        .def(py::init<std::shared_ptr<ouster::osf::LidarScanEncoder>,
+                      size_t>(),
+             py::arg("encoder"),
+             py::arg("band_rows") = ouster::osf::DEFAULT_OSF_BAND_ROWS);
+
+    py::class_<ouster::osf::SparseLidarScanEncoder,
+               ouster::osf::LidarScanEncoder,
+               std::shared_ptr<ouster::osf::SparseLidarScanEncoder>>(
+        m, "SparseLidarScanEncoder", R"(Used by the Writer class to
+    encode only the nonzero pixels of LidarScans, such as masked or clipped
+    ones, with another encoder.)")
+        .def(py::init<std::shared_ptr<ouster::osf::LidarScanEncoder>>(),
+             py::arg("encoder"));
+
+    py::class_<ouster::osf::LossyLidarScanEncoder,
+               ouster::osf::LidarScanEncoder,
+               std::shared_ptr<ouster::osf::LossyLidarScanEncoder>>(
+        m, "LossyLidarScanEncoder", R"(Used by the Writer class to
+    encode the listed fields of LidarScans, by default the ranges, with every
+    pixel within a largest error, and the other fields with another encoder.)")
+        .def(py::init<std::shared_ptr<ouster::osf::LidarScanEncoder>,
+                      ouster::LossyFields>(),
+             py::arg("encoder"),
+             py::arg("max_errors") = ouster::LossyFields{
+                 {ouster::sensor::ChanField::RANGE,
+                  ouster::osf::DEFAULT_LOSSY_RANGE_ERROR},
+                 {ouster::sensor::ChanField::RANGE2,
+                  ouster::osf::DEFAULT_LOSSY_RANGE_ERROR}});
+
+    py::class_<ouster::osf::ThreadPool,
+               std::shared_ptr<ouster::osf::ThreadPool>>(
+        m, "ThreadPool",
+        R"(Persistent threads that encode and decode the fields of scans,
+    shared by the Writers and Readers using it.)")
+        .def(py::init<unsigned>(), py::arg("threads") = 0)
+        .def("size", &ouster::osf::ThreadPool::size);
+
+    py::class_<osf::ReadAheadOptions>(m, "ReadAheadOptions", R"(
+        How far ``ScanReadAhead`` reads ahead of the consumer.
+        )")
+        .def(py::init<>())
+        .def_readwrite("scans", &osf::ReadAheadOptions::scans, R"(
+             Scans decoded ahead of the consumer, 0 for one more than the
+             threads of the pool.
+             )")
+        .def_readwrite("chunks", &osf::ReadAheadOptions::chunks, R"(
+             Chunks of each stream the OS is asked to read ahead, 0 to not
+             prefetch.
+             )")
+        .def_readwrite("thread_pool", &osf::ReadAheadOptions::thread_pool,
+                       "Pool to decode on, the default pool if None.");
+
+    py::class_<osf::ScanReadAhead>(m, "ScanReadAhead", R"(
+        Iterates over the LidarScans of a range of messages as
+        ``(stream_id, ts, scan)``, in the order of ``Reader.messages``,
+        decoding the next scans on a thread pool while the current one is
+        consumed. ``scan`` is None if the message couldn't be decoded.
+        )")
+        .def(py::init([](osf::Reader& reader,
+                         const std::vector<uint32_t>& stream_ids,
+                         int64_t start_ts, int64_t end_ts,
+                         const std::vector<std::string>& fields,
+                         const osf::ReadAheadOptions& options) {
+                 return std::make_unique<osf::ScanReadAhead>(
+                     reader, stream_ids, osf::ts_t{start_ts},
+                     osf::ts_t{end_ts}, fields, options);
+             }),
+             py::arg("reader"), py::arg("stream_ids"), py::arg("start_ts"),
+             py::arg("end_ts"), py::arg("fields") = std::vector<std::string>(),
+             py::arg("options") = osf::ReadAheadOptions(),
+             py::keep_alive<1, 2>())
+        .def("__iter__",
+             [](osf::ScanReadAhead& read_ahead) -> osf::ScanReadAhead& {
+                 return read_ahead;
+             },
+             py::return_value_policy::reference_internal)
+        .def("__next__", [](osf::ScanReadAhead& read_ahead) {
+            osf::DecodedScan scan;
+            bool more = false;
+            {
+                py::gil_scoped_release release;
+                more = read_ahead.next(scan);
+            }
+            if (!more) throw py::stop_iteration();
+            py::object ls = py::none();
+            if (scan.scan) ls = py::cast(std::move(*scan.scan));
+            return py::make_tuple(scan.stream_id, scan.ts.count(), ls);
+        });
+
+    m.def("set_default_thread_pool", &ouster::osf::set_default_thread_pool,
+          py::arg("pool"),
+          R"(Replace the pool used by Writers and Readers that weren't given one,
+    e.g. to size it explicitly. None restores a default sized pool.)");
 
     py::class_<ouster::osf::Encoder, std::shared_ptr<ouster::osf::Encoder>>(
         m, "Encoder",
         R"(Used by the Writer class to encode LidarScans, depending on configuration.)")
-        .def(py::init<std::shared_ptr<ouster::osf::LidarScanEncoder>>(),
-             py::arg("lidar_scan_encoder"));
+        .def(py::init<std::shared_ptr<ouster::osf::LidarScanEncoder>,
+                      std::shared_ptr<ouster::osf::ThreadPool>>(),
+             py::arg("lidar_scan_encoder"), py::arg("thread_pool") = nullptr)
+        .def("set_lidar_scan_encoder",
+             &ouster::osf::Encoder::set_lidar_scan_encoder,
+             py::arg("stream_index"), py::arg("lidar_scan_encoder"),
+             R"(
+             Encode the scans of one stream with another encoder. Call it
+             before saving the first scan of the stream.
+
+             Args:
+                stream_index (int): the index of the sensor_info of the stream
+                lidar_scan_encoder (LidarScanEncoder): its encoder
+             )")
+        .def_property("keyframe_interval",
+                      &ouster::osf::Encoder::keyframe_interval,
+                      &ouster::osf::Encoder::set_keyframe_interval,
+                      R"(
+             The number of scans in a group of a full keyframe followed by
+             delta frames holding the difference of the standard integer
+             fields from it, 0 to store every scan in full. Only affects
+             streams created after it's set.
+             )");
+
+    py::class_<osf::ScanOps>(m, "ScanOps", R"(
+        Built-in operations applied natively to the scans of each sensor by
+        ``transcode_osf_file`` and ``pcap_to_osf``, like the ``slice``,
+        ``reduce`` and ``clip`` commands of ouster-cli, in that order.
+        )")
+        .def(py::init<>())
+        .def_readwrite("start", &osf::ScanOps::start,
+                       "Index of the first scan of each sensor to save.")
+        .def_readwrite("stop", &osf::ScanOps::stop,
+                       "Index of the scan of each sensor to stop before, no "
+                       "limit if 0.")
+        .def_readwrite("step", &osf::ScanOps::step,
+                       "Save every step-th scan from start.")
+        .def_readwrite("beams", &osf::ScanOps::beams,
+                       "Beams to reduce the scans and metadata to, 0 to keep "
+                       "them all.")
+        .def_readwrite("clip_fields", &osf::ScanOps::clip_fields,
+                       "The fields to clip, none if empty.")
+        .def_readwrite("clip_lower", &osf::ScanOps::clip_lower,
+                       "The lowest value of the clipped fields to keep.")
+        .def_readwrite("clip_upper", &osf::ScanOps::clip_upper,
+                       "The highest value of the clipped fields to keep.")
+        .def_readwrite("clip_invalid", &osf::ScanOps::clip_invalid,
+                       "The value replacing the clipped values.");
+
+    py::class_<osf::TranscodeOptions>(m, "TranscodeOptions", R"(
+        How ``transcode_osf_file`` writes the scans of the transcoded file.
+        )")
+        .def(py::init<>())
+        .def_readwrite("fields", &osf::TranscodeOptions::fields,
+                       "The fields of the scans to keep, all if empty.")
+        .def_readwrite("encoder", &osf::TranscodeOptions::encoder, R"(
+             How to encode the scans, the default of Writer if None. Scans
+             are decoded and encoded on its thread pool.
+             )")
+        .def_readwrite("chunk_size", &osf::TranscodeOptions::chunk_size,
+                       "The chunk size of the transcoded file, default if 0.")
+        .def_readwrite("max_in_flight", &osf::TranscodeOptions::max_in_flight,
+                       "Scans being encoded or waiting to be written.")
+        .def_readwrite("ops", &osf::TranscodeOptions::ops,
+                       "Operations applied to the scans before encoding.");
+
+    m.def("transcode_osf_file", &ouster::osf::transcode_osf_file,
+          py::call_guard<py::gil_scoped_release>(), R"doc(
+        Transcode the LidarScans of an OSF file to a new OSF file, e.g. to
+        drop fields or change their compression, decoding and encoding scans
+        on the thread pool of the encoder. Messages of other streams are not
+        copied.
+
+        :file_name: The OSF file to transcode.
+        :output_file_name: The OSF file to write.
+        :options: How to write the scans.
+        :returns: The size of the written OSF file.
+    )doc",
+          py::arg("file_name"), py::arg("output_file_name"),
+          py::arg("options") = osf::TranscodeOptions());
+
+    py::class_<osf::CompactOptions>(m, "CompactOptions", R"(
+        How ``compact_osf_file`` rewrites an OSF file.
+        )")
+        .def(py::init<>())
+        .def_readwrite("chunk_size", &osf::CompactOptions::chunk_size,
+                       "The chunk size of the compacted file.")
+        .def_readwrite("group_streams", &osf::CompactOptions::group_streams,
+                       R"(
+             Whether the chunks of each stream are written one after
+             another rather than interleaved by time.
+             )")
+        .def_readwrite("encoder", &osf::CompactOptions::encoder, R"(
+             How to re-encode the scans, which are copied still encoded if
+             None.
+             )");
+
+    m.def("compact_osf_file", &ouster::osf::compact_osf_file,
+          py::call_guard<py::gil_scoped_release>(), R"doc(
+        Rewrite an OSF file for reading, e.g. a live recording written in
+        small chunks, into larger chunks grouped by stream, indexing the
+        timestamp of every message. Messages are copied still encoded unless
+        an encoder is given, which keeps only the lidar scans.
+
+        :file_name: The OSF file to compact.
+        :output_file_name: The OSF file to write.
+        :options: How to rewrite the file.
+        :returns: The size of the written OSF file.
+    )doc",
+          py::arg("file_name"), py::arg("output_file_name"),
+          py::arg("options") = osf::CompactOptions());
+
+    py::class_<osf::PcapToOsfOptions>(m, "PcapToOsfOptions", R"(
+        How ``pcap_to_osf`` writes the scans of the pcap file.
+        )")
+        .def(py::init<>())
+        .def_readwrite("fields", &osf::PcapToOsfOptions::fields,
+                       "The fields of the scans to keep, all if empty.")
+        .def_readwrite("encoder", &osf::PcapToOsfOptions::encoder, R"(
+             How to encode the scans, the default of Writer if None. Scans
+             are encoded on its thread pool.
+             )")
+        .def_readwrite("chunk_size", &osf::PcapToOsfOptions::chunk_size,
+                       "The chunk size of the OSF file, default if 0.")
+        .def_readwrite("max_in_flight",
+                       &osf::PcapToOsfOptions::max_in_flight,
+                       "Scans being encoded or waiting to be written.")
+        .def_readwrite("queue_size", &osf::PcapToOsfOptions::queue_size,
+                       "Lidar packets queued per sensor for batching.")
+        .def_readwrite("ops", &osf::PcapToOsfOptions::ops,
+                       "Operations applied to the scans before encoding.")
+        .def_readwrite("stop_on_backwards_ts",
+                       &osf::PcapToOsfOptions::stop_on_backwards_ts,
+                       "Stop at a scan timestamped before an earlier one of "
+                       "its sensor instead of dropping it.");
+
+    m.def("pcap_to_osf", &ouster::osf::pcap_to_osf,
+          py::call_guard<py::gil_scoped_release>(), R"doc(
+        Convert the lidar packets of a pcap file to the LidarScans of a new
+        OSF file natively, batching the packets of each sensor on a thread of
+        its own and encoding scans on the thread pool of the encoder. Scans
+        are timestamped with the capture timestamp of their first valid
+        packet.
+
+        :pcap_file: The pcap file to convert.
+        :infos: The metadata of the sensors in the pcap file, with their
+            lidar ports.
+        :output_file_name: The OSF file to write.
+        :options: How to write the scans.
+        :returns: The size of the written OSF file.
+    )doc",
+          py::arg("pcap_file"), py::arg("infos"), py::arg("output_file_name"),
+          py::arg("options") = osf::PcapToOsfOptions());
+
+    py::class_<osf::BenchEncoder>(m, "BenchEncoder", R"(
+        A candidate encoding of the fields of scans measured by
+        ``bench_osf_file``.
+        )")
+        .def(py::init([](const std::string& codec, int level) {
+                 osf::BenchEncoder encoder;
+                 encoder.codec = codec;
+                 encoder.level = level;
+                 return encoder;
+             }),
+             py::arg("codec") = "png", py::arg("level") = 1)
+        .def_readwrite("codec", &osf::BenchEncoder::codec,
+                       "The encoder, \"png\" or \"zstd\".")
+        .def_readwrite("level", &osf::BenchEncoder::level,
+                       "The compression level of the encoder.")
+        .def("__repr__", [](const osf::BenchEncoder& encoder) {
+            return encoder.codec + ":" + std::to_string(encoder.level);
+        });
+
+    py::class_<osf::BenchOptions>(m, "BenchOptions", R"(
+        What ``bench_osf_file`` measures.
+        )")
+        .def(py::init<>())
+        .def_readwrite("scans", &osf::BenchOptions::scans,
+                       "The first scans to measure the fields and encoders "
+                       "on, all if 0.")
+        .def_readwrite("fields", &osf::BenchOptions::fields,
+                       "The fields to measure, all if empty.")
+        .def_readwrite("encoders", &osf::BenchOptions::encoders,
+                       "The candidate encoders to measure on each field.")
+        .def_readwrite("thread_pool", &osf::BenchOptions::thread_pool,
+                       "The pool of the parallel decoding pass, the default "
+                       "pool if None.");
+
+    py::class_<osf::FieldDecodeBench>(m, "FieldDecodeBench", R"(
+        The decoding cost of a field of the scans of an OSF file.
+        )")
+        .def_readonly("field", &osf::FieldDecodeBench::field)
+        .def_readonly("scans", &osf::FieldDecodeBench::scans)
+        .def_readonly("bytes", &osf::FieldDecodeBench::bytes)
+        .def_readonly("seconds", &osf::FieldDecodeBench::seconds);
+
+    py::class_<osf::FieldEncodeBench>(m, "FieldEncodeBench", R"(
+        The encoding cost and compression of a field by a candidate encoder.
+        )")
+        .def_readonly("field", &osf::FieldEncodeBench::field)
+        .def_readonly("encoder", &osf::FieldEncodeBench::encoder)
+        .def_readonly("scans", &osf::FieldEncodeBench::scans)
+        .def_readonly("raw_bytes", &osf::FieldEncodeBench::raw_bytes)
+        .def_readonly("encoded_bytes", &osf::FieldEncodeBench::encoded_bytes)
+        .def_readonly("seconds", &osf::FieldEncodeBench::seconds);
+
+    py::class_<osf::OsfBench>(m, "OsfBench", R"(
+        The measurements of ``bench_osf_file``.
+        )")
+        .def_readonly("chunks", &osf::OsfBench::chunks)
+        .def_readonly("chunk_bytes", &osf::OsfBench::chunk_bytes)
+        .def_readonly("read_seconds", &osf::OsfBench::read_seconds)
+        .def_readonly("crc_seconds", &osf::OsfBench::crc_seconds)
+        .def_readonly("invalid_chunks", &osf::OsfBench::invalid_chunks)
+        .def_readonly("decode", &osf::OsfBench::decode)
+        .def_readonly("encode", &osf::OsfBench::encode)
+        .def_readonly("scans", &osf::OsfBench::scans)
+        .def_readonly("sequential_seconds",
+                      &osf::OsfBench::sequential_seconds)
+        .def_readonly("parallel_seconds", &osf::OsfBench::parallel_seconds);
+
+    m.def("bench_osf_file", &ouster::osf::bench_osf_file,
+          py::call_guard<py::gil_scoped_release>(), R"doc(
+        Measure the chunk read bandwidth and CRC cost of an OSF file, the
+        decoding time of each field, the size and encoding time of each
+        field with candidate encoders, and the scans per second decoded
+        with and without parallel decoding.
+
+        :file_name: The OSF file to measure.
+        :options: What to measure.
+        :returns: The measurements.
+    )doc",
+          py::arg("file_name"), py::arg("options") = osf::BenchOptions());
 
     m.def("slice_and_cast", &ouster::osf::slice_with_cast,
           py::arg("lidar_scan"), py::arg("field_types"),
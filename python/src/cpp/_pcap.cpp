@@ -13,16 +13,26 @@
 
 #include <chrono>
 #include <cmath>
+#include <cstring>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common.h"
+#include "ouster/async_pcap_writer.h"
+#include "ouster/bag_reader.h"
 #include "ouster/impl/build.h"
 #include "ouster/indexed_pcap_reader.h"
+#include "ouster/lidar_scan.h"
 #include "ouster/os_pcap.h"
+#include "ouster/packet.h"
 #include "ouster/pcap.h"
+#include "ouster/pcap_replay.h"
 
 using namespace ouster::sensor_utils;
+using ouster::sensor::IpReassemblyStats;
 namespace py = pybind11;
 
 PYBIND11_MAKE_OPAQUE(std::shared_ptr<playback_handle>);
@@ -134,7 +144,8 @@ This module is generated from the C++ code and not meant to be used directly.
     // pcap reading
     py::class_<std::shared_ptr<playback_handle>>(m, "playback_handle");
 
-    m.def("replay_initialize", &replay_initialize);
+    m.def("replay_initialize", &replay_initialize,
+          py::call_guard<py::gil_scoped_release>());
 
     m.def("replay_uninitialize", [](std::shared_ptr<playback_handle>& handle) {
         replay_uninitialize(*handle);
@@ -142,12 +153,14 @@ This module is generated from the C++ code and not meant to be used directly.
 
     m.def("next_packet_info",
           [](std::shared_ptr<playback_handle>& handle, packet_info& packet_info)
-              -> bool { return next_packet_info(*handle, packet_info); });
+              -> bool { return next_packet_info(*handle, packet_info); },
+          py::call_guard<py::gil_scoped_release>());
 
     m.def("get_stream_info",
           [](const std::string& file, int packets_to_process = -1) {
               return get_stream_info(file, packets_to_process);
-          });
+          },
+          py::call_guard<py::gil_scoped_release>());
 
     m.def(
         "get_stream_info",
@@ -156,7 +169,20 @@ This module is generated from the C++ code and not meant to be used directly.
            int packets_per_callback, int packets_to_process = -1) {
             return get_stream_info(file, progress_callback,
                                    packets_per_callback, packets_to_process);
-        });
+        },
+        // the callback takes the GIL back when called
+        py::call_guard<py::gil_scoped_release>());
+
+    py::class_<stream_sampling>(m, "stream_sampling")
+        .def(py::init<>())
+        .def_readwrite("windows", &stream_sampling::windows)
+        .def_readwrite("packets_per_window",
+                       &stream_sampling::packets_per_window)
+        .def_readwrite("stable_windows", &stream_sampling::stable_windows);
+
+    m.def("get_stream_info_sampled", &get_stream_info_sampled, py::arg("file"),
+          py::arg("sampling") = stream_sampling{},
+          py::call_guard<py::gil_scoped_release>());
     m.def("guess_ports", &guess_ports);
     m.def(
         "read_packet",
@@ -166,6 +192,7 @@ This module is generated from the C++ code and not meant to be used directly.
                 throw std::invalid_argument(
                     "Incompatible argument: expected a bytearray");
             }
+            py::gil_scoped_release release;
             return read_packet(*handle, static_cast<uint8_t*>(info.ptr),
                                info.size);
         });
@@ -202,6 +229,7 @@ This module is generated from the C++ code and not meant to be used directly.
                   throw std::invalid_argument(
                       "Incompatible argument: expected a bytearray");
               }
+              py::gil_scoped_release release;
               record_packet(*handle, src_ip, dst_ip, src_port, dst_port,
                             static_cast<uint8_t*>(info.ptr), info.size,
                             llround(timestamp * 1e6));
@@ -216,11 +244,86 @@ This module is generated from the C++ code and not meant to be used directly.
             throw std::invalid_argument(
                 "Incompatible argument: expected a bytearray");
         }
+        py::gil_scoped_release release;
         record_packet(*handle, info, static_cast<uint8_t*>(buf_info.ptr),
                       buf_info.size);
     });
 
-    py::class_<PcapReader>(m, "PcapReader");  // TODO add more complete bindings
+    py::class_<AsyncPcapWriterOptions>(m, "AsyncPcapWriterOptions")
+        .def(py::init<>())
+        .def_property(
+            "use_sll_encapsulation",
+            [](const AsyncPcapWriterOptions& options) {
+                return options.encap == PcapWriter::SLL;
+            },
+            [](AsyncPcapWriterOptions& options, bool sll) {
+                options.encap = sll ? PcapWriter::SLL : PcapWriter::ETHERNET;
+            })
+        .def_readwrite("mtu", &AsyncPcapWriterOptions::mtu)
+        .def_readwrite("buffer_packets",
+                       &AsyncPcapWriterOptions::buffer_packets)
+        .def_readwrite("write_batch", &AsyncPcapWriterOptions::write_batch)
+        .def_readwrite("rotate_bytes", &AsyncPcapWriterOptions::rotate_bytes)
+        .def_property(
+            "rotate_interval",
+            [](const AsyncPcapWriterOptions& options) {
+                return options.rotate_interval.count() / 1e6;
+            },
+            [](AsyncPcapWriterOptions& options, double seconds) {
+                options.rotate_interval =
+                    std::chrono::microseconds(llround(seconds * 1e6));
+            });
+
+    py::class_<AsyncPcapWriterStats>(m, "AsyncPcapWriterStats")
+        .def_readonly("packets", &AsyncPcapWriterStats::packets)
+        .def_readonly("records", &AsyncPcapWriterStats::records)
+        .def_readonly("bytes", &AsyncPcapWriterStats::bytes)
+        .def_readonly("dropped", &AsyncPcapWriterStats::dropped)
+        .def_readonly("write_errors", &AsyncPcapWriterStats::write_errors)
+        .def_readonly("files", &AsyncPcapWriterStats::files);
+
+    py::class_<AsyncPcapWriter>(m, "AsyncPcapWriter")
+        .def(py::init<const std::string&, const AsyncPcapWriterOptions&>(),
+             py::arg("file"), py::arg("options") = AsyncPcapWriterOptions{})
+        .def(
+            "write_packet",
+            [](AsyncPcapWriter& writer, const std::string& src_ip,
+               const std::string& dst_ip, int src_port, int dst_port,
+               py::buffer buf, double timestamp) {
+                auto info = buf.request();
+                if (info.format != py::format_descriptor<uint8_t>::format()) {
+                    throw std::invalid_argument(
+                        "Incompatible argument: expected a bytearray");
+                }
+                py::gil_scoped_release release;
+                return writer.write_packet(
+                    static_cast<uint8_t*>(info.ptr), info.size, src_ip,
+                    dst_ip, static_cast<uint16_t>(src_port),
+                    static_cast<uint16_t>(dst_port),
+                    std::chrono::microseconds(llround(timestamp * 1e6)));
+            },
+            py::arg("src_ip"), py::arg("dst_ip"), py::arg("src_port"),
+            py::arg("dst_port"), py::arg("buf"), py::arg("timestamp"))
+        .def("flush", &AsyncPcapWriter::flush,
+             py::call_guard<py::gil_scoped_release>())
+        .def("close", &AsyncPcapWriter::close,
+             py::call_guard<py::gil_scoped_release>())
+        .def("stats", &AsyncPcapWriter::stats)
+        .def("files", &AsyncPcapWriter::files);
+
+    py::class_<IpReassemblyStats>(m, "IpReassemblyStats")
+        .def_readonly("fragments", &IpReassemblyStats::fragments)
+        .def_readonly("reassembled", &IpReassemblyStats::reassembled)
+        .def_readonly("timed_out", &IpReassemblyStats::timed_out)
+        .def_readonly("evicted", &IpReassemblyStats::evicted)
+        .def_readonly("malformed", &IpReassemblyStats::malformed)
+        .def_readonly("in_progress", &IpReassemblyStats::in_progress)
+        .def_readonly("capacity", &IpReassemblyStats::capacity)
+        .def_readonly("memory", &IpReassemblyStats::memory);
+
+    // TODO add more complete bindings
+    py::class_<PcapReader>(m, "PcapReader")
+        .def("reassembly_stats", &PcapReader::reassembly_stats);
 
     py::class_<PcapIndex>(m, "PcapIndex")
         .def(py::init<int>())
@@ -236,16 +339,133 @@ This module is generated from the C++ code and not meant to be used directly.
                 }
                 return l;
             })
+        .def_property_readonly(
+            "frame_timestamps",
+            [](PcapIndex& self) {
+                std::vector<py::array> l;
+                for (auto& i : self.frame_timestamps_) {
+                    l.push_back(py::array(py::dtype::of<uint64_t>(), i.size(),
+                                          i.data(), py::cast(self)));
+                }
+                return l;
+            })
+        .def_property_readonly(
+            "frame_ids",
+            [](PcapIndex& self) {
+                std::vector<py::array> l;
+                for (auto& i : self.frame_ids_) {
+                    l.push_back(py::array(py::dtype::of<uint16_t>(), i.size(),
+                                          i.data(), py::cast(self)));
+                }
+                return l;
+            })
+        .def("frame_at_timestamp", &PcapIndex::frame_at_timestamp,
+             py::arg("sensor_index"), py::arg("ts"))
         .def_readonly("frame_timestamp_indices",
                       &PcapIndex::frame_timestamp_indices_)
         .def_readonly("frame_id_indices", &PcapIndex::frame_id_indices_);
 
+    PYBIND11_NUMPY_DTYPE(PacketBatch::Entry, offset, size, timestamp,
+                         sensor_idx, type);
+
+    py::class_<PacketBatch>(m, "PacketBatch", R"(
+        Sensor packets read by IndexedPcapReader.read_batch or
+        BagPacketReader.read_batch, with their payloads back to back in one
+        buffer. The data and entries views are only valid until the batch is
+        read into again.
+        )")
+        .def(py::init<>())
+        .def("__len__",
+             [](const PacketBatch& self) { return self.entries.size(); })
+        .def_property_readonly(
+            "data", py::cpp_function(
+                        [](PacketBatch& self) {
+                            return py::array(py::dtype::of<uint8_t>(),
+                                             self.data.size(),
+                                             self.data.data(), py::cast(self));
+                        },
+                        py::keep_alive<0, 1>()))
+        .def_property_readonly(
+            "entries",
+            py::cpp_function(
+                [](PacketBatch& self) {
+                    return py::array_t<PacketBatch::Entry>(
+                        self.entries.size(), self.entries.data(),
+                        py::cast(self));
+                },
+                py::keep_alive<0, 1>()))
+        .def_readonly("id_errors", &PacketBatch::id_errors)
+        .def_readonly("size_errors", &PacketBatch::size_errors)
+        .def(
+            "packet",
+            [](const PacketBatch& self, size_t i) -> py::object {
+                if (i >= self.entries.size()) {
+                    throw py::index_error("packet index out of range");
+                }
+                const auto& entry = self.entries[i];
+                auto fill = [&](ouster::sensor::Packet& packet) {
+                    std::memcpy(packet.buf.data(),
+                                self.data.data() + entry.offset, entry.size);
+                    packet.host_timestamp = entry.timestamp;
+                    packet.format = self.formats[entry.sensor_idx];
+                };
+                if (entry.type ==
+                    static_cast<int32_t>(ouster::sensor::PacketType::Imu)) {
+                    ouster::sensor::ImuPacket packet(entry.size);
+                    fill(packet);
+                    return py::cast(std::move(packet));
+                }
+                ouster::sensor::LidarPacket packet(entry.size);
+                fill(packet);
+                return py::cast(std::move(packet));
+            },
+            py::arg("i"), "Copy the i-th packet out into a new packet.")
+        .def(
+            "batch_scans",
+            [](const PacketBatch& self,
+               const std::vector<ouster::ScanBatcher*>& batchers,
+               const std::vector<ouster::LidarScan*>& scans, size_t start) {
+                if (batchers.size() != self.formats.size() ||
+                    scans.size() != self.formats.size()) {
+                    throw std::invalid_argument(
+                        "expected a batcher and a scan per sensor");
+                }
+                ouster::sensor::LidarPacket packet;
+                for (size_t i = start; i < self.entries.size(); ++i) {
+                    const auto& entry = self.entries[i];
+                    if (entry.type !=
+                        static_cast<int32_t>(
+                            ouster::sensor::PacketType::Lidar)) {
+                        continue;
+                    }
+                    packet.buf.assign(
+                        self.data.begin() + entry.offset,
+                        self.data.begin() + entry.offset + entry.size);
+                    packet.host_timestamp = entry.timestamp;
+                    if ((*batchers[entry.sensor_idx])(
+                            packet, *scans[entry.sensor_idx])) {
+                        return std::make_pair(i + 1, entry.sensor_idx);
+                    }
+                }
+                return std::make_pair(self.entries.size(), int32_t{-1});
+            },
+            py::arg("batchers"), py::arg("scans"), py::arg("start") = 0,
+            py::call_guard<py::gil_scoped_release>(), R"(
+        Feed the lidar packets of the batch from position start to the
+        ScanBatcher of their sensor, one per sensor, stopping after the first
+        one that completes a scan. Returns the position to continue from and
+        the index of the sensor of the completed scan, -1 if none was.
+        )");
+
     py::class_<IndexedPcapReader, PcapReader>(m, "IndexedPcapReader")
-        .def(py::init<const std::string&, const std::vector<std::string>&>())
+        .def(py::init<const std::string&, const std::vector<std::string>&>(),
+             py::call_guard<py::gil_scoped_release>())
         .def(py::init<const std::string&,
-                      const std::vector<ouster::sensor::sensor_info>&>())
+                      const std::vector<ouster::sensor::sensor_info>&>(),
+             py::call_guard<py::gil_scoped_release>())
         .def("current_info", &IndexedPcapReader::current_info)
-        .def("next_packet", &IndexedPcapReader::next_packet)
+        .def("next_packet", &IndexedPcapReader::next_packet,
+             py::call_guard<py::gil_scoped_release>())
         .def("update_index_for_current_packet",
              &IndexedPcapReader::update_index_for_current_packet)
         .def("current_frame_id",
@@ -255,16 +475,116 @@ This module is generated from the C++ code and not meant to be used directly.
                  }
                  return py::none();
              })
-        .def("reset",
-             &IndexedPcapReader::reset)  // TODO move to PcapReader binding?
-        .def("seek",
-             &IndexedPcapReader::seek)  // TODO move to PcapReader binding?
-        .def("build_index", &IndexedPcapReader::build_index)
+        // TODO move reset and seek to PcapReader binding?
+        .def("reset", &IndexedPcapReader::reset,
+             py::call_guard<py::gil_scoped_release>())
+        .def("seek", &IndexedPcapReader::seek,
+             py::call_guard<py::gil_scoped_release>())
+        .def("build_index",
+             py::overload_cast<>(&IndexedPcapReader::build_index),
+             py::call_guard<py::gil_scoped_release>())
+        .def("build_index",
+             py::overload_cast<const std::string&>(
+                 &IndexedPcapReader::build_index),
+             py::arg("index_filename"),
+             py::call_guard<py::gil_scoped_release>())
+        .def("save_index", &IndexedPcapReader::save_index,
+             py::arg("index_filename"),
+             py::call_guard<py::gil_scoped_release>())
+        .def("build_index_parallel", &IndexedPcapReader::build_index_parallel,
+             py::arg("num_threads") = 0,
+             py::call_guard<py::gil_scoped_release>())
         .def("get_index", &IndexedPcapReader::get_index)
+        .def(
+            "seek_to_time",
+            [](IndexedPcapReader& reader, size_t sensor_index, int64_t ts) {
+                return reader.seek_to_time(sensor_index,
+                                           std::chrono::microseconds(ts));
+            },
+            py::arg("sensor_index"), py::arg("ts"),
+            py::call_guard<py::gil_scoped_release>())
+        .def("read_batch", &IndexedPcapReader::read_batch, py::arg("batch"),
+             py::arg("max_packets") = 1024,
+             py::call_guard<py::gil_scoped_release>())
         .def("current_data", [](IndexedPcapReader& reader) -> py::array {
             uint8_t* data = const_cast<uint8_t*>(reader.current_data());
             size_t data_size = reader.current_length();
             return py::array(py::dtype::of<uint8_t>(), data_size, data,
                              py::cast(reader));
         });
+
+    py::class_<BagPacketReader>(m, "BagPacketReader", R"(
+        Reads the lidar and imu packets of an indexed ROS1 bag with
+        uncompressed chunks natively into PacketBatches.
+        )")
+        .def(py::init<const std::string&,
+                      const std::vector<ouster::sensor::sensor_info>&, bool>(),
+             py::arg("filename"),
+             py::arg("sensor_infos") =
+                 std::vector<ouster::sensor::sensor_info>{},
+             py::arg("soft_id_check") = false,
+             py::call_guard<py::gil_scoped_release>())
+        .def_static("readable", &BagPacketReader::readable,
+                    py::arg("filename"),
+                    py::call_guard<py::gil_scoped_release>())
+        .def_property_readonly("sensor_infos", &BagPacketReader::sensor_infos)
+        .def_property_readonly("lidar_topics", &BagPacketReader::lidar_topics)
+        .def_property_readonly("start_time", &BagPacketReader::start_time)
+        .def_property_readonly("end_time", &BagPacketReader::end_time)
+        .def("read_batch", &BagPacketReader::read_batch, py::arg("batch"),
+             py::arg("max_packets") = 1024,
+             py::call_guard<py::gil_scoped_release>())
+        .def("reset", &BagPacketReader::reset)
+        .def("seek_to_time", &BagPacketReader::seek_to_time, py::arg("ts"));
+
+    py::class_<ReplayStream>(m, "ReplayStream")
+        .def(py::init([](int pcap_dst_port, const std::string& dst_ip,
+                         int dst_port, const std::string& src_ip,
+                         int src_port) {
+                 return ReplayStream{pcap_dst_port, dst_ip, dst_port, src_ip,
+                                     src_port};
+             }),
+             py::arg("pcap_dst_port"), py::arg("dst_ip"),
+             py::arg("dst_port") = 0, py::arg("src_ip") = "",
+             py::arg("src_port") = 0)
+        .def_readwrite("pcap_dst_port", &ReplayStream::pcap_dst_port)
+        .def_readwrite("dst_ip", &ReplayStream::dst_ip)
+        .def_readwrite("dst_port", &ReplayStream::dst_port)
+        .def_readwrite("src_ip", &ReplayStream::src_ip)
+        .def_readwrite("src_port", &ReplayStream::src_port);
+
+    py::class_<ReplayOptions>(m, "ReplayOptions")
+        .def(py::init<>())
+        .def_readwrite("speed", &ReplayOptions::speed)
+        .def_readwrite("loops", &ReplayOptions::loops)
+        .def_readwrite("batch_size", &ReplayOptions::batch_size)
+        .def_property(
+            "spin",
+            [](const ReplayOptions& options) { return options.spin.count(); },
+            [](ReplayOptions& options, int64_t us) {
+                options.spin = std::chrono::microseconds(us);
+            });
+
+    py::class_<ReplayStats>(m, "ReplayStats")
+        .def_readonly("packets", &ReplayStats::packets)
+        .def_readonly("bytes", &ReplayStats::bytes)
+        .def_readonly("send_errors", &ReplayStats::send_errors)
+        .def_readonly("batches", &ReplayStats::batches)
+        .def_readonly("loops", &ReplayStats::loops)
+        .def_property_readonly("max_lateness", [](const ReplayStats& stats) {
+            return stats.max_lateness.count();
+        });
+
+    py::class_<PcapReplay>(m, "PcapReplay")
+        .def(py::init<const std::string&, const std::vector<ReplayStream>&,
+                      const ReplayOptions&>(),
+             py::arg("file"), py::arg("streams"),
+             py::arg("options") = ReplayOptions{})
+        .def("start", &PcapReplay::start)
+        .def("wait", &PcapReplay::wait,
+             py::call_guard<py::gil_scoped_release>())
+        .def("stop", &PcapReplay::stop,
+             py::call_guard<py::gil_scoped_release>())
+        .def("running", &PcapReplay::running)
+        .def("stats", &PcapReplay::stats);
 }
@@ -14,17 +14,22 @@
 #include <pybind11/stl.h>
 #include <pybind11/stl_bind.h>
 
+#include <algorithm>
 #include <atomic>
 #include <csignal>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <stdexcept>
+#include <string>
 #include <utility>
 #include <vector>
 
 #include "common.h"
 #include "ouster/impl/build.h"
 #include "ouster/lidar_scan.h"
+#include "ouster/lidar_scan_viz.h"
+#include "ouster/map_accumulator.h"
 #include "ouster/point_viz.h"
 #include "ouster/types.h"
 
@@ -63,6 +68,62 @@ static void check_array(const py::array_t<T, F>& array, size_t size = 0,
         throw std::invalid_argument("Expected a C_CONTIGUOUS array");
 }
 
+/*
+ * Deletes a PointViz without the GIL, so that its frame sink thread can
+ * finish a call into python
+ */
+struct PointVizDeleter {
+    void operator()(viz::PointViz* viz) const {
+        py::gil_scoped_release release;
+        delete viz;
+    }
+};
+
+/*
+ * Set a MONO, RGB or RGBA image depending on the dimensions of the array
+ */
+static void set_image_channels(viz::Image& self, size_t width, size_t height,
+                               size_t channels, const float* data) {
+    if (channels == 1) self.set_image(width, height, data);
+    if (channels == 3) self.set_image_rgb(width, height, data);
+    if (channels == 4) self.set_image_rgba(width, height, data);
+}
+
+static void set_image_channels(viz::Image& self, size_t width, size_t height,
+                               size_t channels, const uint8_t* data) {
+    if (channels == 1) self.set_image(width, height, data);
+    if (channels == 3) self.set_image_rgb(width, height, data);
+    if (channels == 4) self.set_image_rgba(width, height, data);
+}
+
+static void set_image_channels(viz::Image& self, size_t width, size_t height,
+                               size_t channels, const uint16_t* data) {
+    if (channels != 1) {
+        throw std::invalid_argument("Expected a monochrome uint16 image");
+    }
+    self.set_image(width, height, data);
+}
+
+template <typename T>
+static void set_image_of(viz::Image& self, const py::array_t<T>& image) {
+    check_array(image, 0, 0, 'C');  // check for C-CONTIGUOUS
+    if (image.ndim() == 2 || (image.ndim() == 3 && image.shape(2) == 1)) {
+        set_image_channels(self, image.shape(1), image.shape(0), 1,
+                           image.data());
+        return;
+    }
+
+    check_array(image, 0, 3);
+
+    if (image.shape(2) != 3 && image.shape(2) != 4) {
+        throw std::invalid_argument(
+            "Expected array with size of 3rd dimension: 1,3 or 4, but got: " +
+            std::to_string(image.shape(2)));
+    }
+    set_image_channels(self, image.shape(1), image.shape(0), image.shape(2),
+                       image.data());
+}
+
 template <size_t N>
 static void tuple_to_float_array(std::array<float, N>& dst,
                                  const py::tuple& tuple) {
@@ -126,10 +187,20 @@ void init_viz(py::module& m, py::module&) {
         .value("MOD_NUM_LOCK", EventModifierKeys::MOD_NUM_LOCK)
         .export_values();
 
-    py::class_<viz::PointViz>(m, "PointViz")
-        .def(py::init<const std::string&, bool, int, int>(), py::arg("name"),
-             py::arg("fix_aspect") = false, py::arg("window_width") = 800,
-             py::arg("window_height") = 600)
+    py::enum_<viz::KeyNormalization>(m, "KeyNormalization",
+                                     "How raw cloud keys are normalized.")
+        .value("AUTO_EXPOSURE", viz::KeyNormalization::AUTO_EXPOSURE)
+        .value("EQUALIZATION", viz::KeyNormalization::EQUALIZATION);
+
+    py::class_<viz::PointViz, std::unique_ptr<viz::PointViz, PointVizDeleter>>(
+        m, "PointViz")
+        .def(py::init<const std::string&, bool, int, int, bool,
+                      viz::PointViz*>(),
+             py::arg("name"), py::arg("fix_aspect") = false,
+             py::arg("window_width") = 800, py::arg("window_height") = 600,
+             py::arg("headless") = false, py::arg("share") = nullptr,
+             // the visualizer shared with outlives this one
+             py::keep_alive<1, 7>())
 
         .def(
             "run",
@@ -154,6 +225,7 @@ void init_viz(py::module& m, py::module&) {
         )")
 
         .def("run_once", &viz::PointViz::run_once,
+             py::call_guard<py::gil_scoped_release>(),
              "Run one iteration of the main loop for rendering and input "
              "handling.")
 
@@ -201,6 +273,70 @@ void init_viz(py::module& m, py::module&) {
             [](viz::PointViz& self) { self.pop_frame_buffer_handler(); },
             "Remove the last added callback for handling frame buffers data.")
 
+        .def(
+            "set_frame_sink",
+            [](viz::PointViz& self, py::object sink, size_t buffer_frames) {
+                if (sink.is_none()) {
+                    py::gil_scoped_release release;
+                    self.set_frame_sink(nullptr, buffer_frames);
+                    return;
+                }
+                // the callable is called and released on the sink thread
+                std::shared_ptr<py::object> f{
+                    new py::object{std::move(sink)}, [](py::object* o) {
+                        py::gil_scoped_acquire acquire;
+                        delete o;
+                    }};
+                auto wrapped = [f](const std::vector<uint8_t>& data, int w,
+                                   int h) {
+                    py::gil_scoped_acquire acquire;
+                    // flip the rows to have the top row first
+                    py::array_t<uint8_t> frame({h, w, 3});
+                    const size_t row = static_cast<size_t>(w) * 3;
+                    for (int y = 0; y < h; y++) {
+                        std::copy(data.data() + (h - 1 - y) * row,
+                                  data.data() + (h - y) * row,
+                                  frame.mutable_data(y));
+                    }
+                    try {
+                        (*f)(frame);
+                    } catch (py::error_already_set& e) {
+                        e.discard_as_unraisable("frame sink");
+                    }
+                };
+                py::gil_scoped_release release;
+                self.set_frame_sink(wrapped, buffer_frames);
+            },
+            py::arg("sink"), py::arg("buffer_frames") = 16,
+            R"(
+            Set a sink receiving every drawn frame on its own thread, e.g. a
+            video encoder, or None to stop.
+
+            Frames are read back asynchronously, so a slow sink doesn't slow
+            down rendering: when it falls behind by more than buffer_frames,
+            the oldest frames are dropped.
+
+            Args:
+                sink: function called with each frame as a (height, width, 3)
+                      RGB uint8 array, top row first
+                buffer_frames: the most frames buffered for the sink
+            )")
+
+        .def_property_readonly(
+            "dropped_frames", &viz::PointViz::dropped_frames,
+            "The number of frames dropped because the frame sink fell behind.")
+
+        .def("enable_frame_stats", &viz::PointViz::enable_frame_stats,
+             py::arg("state"),
+             "Measure where the time of each frame goes, see frame_stats().")
+
+        .def("show_frame_stats", &viz::PointViz::show_frame_stats,
+             py::arg("state"),
+             "Show the frame stats over the scene, which measures them too.")
+
+        .def("frame_stats", &viz::PointViz::frame_stats,
+             "Stats of the last frame measured, a few frames behind.")
+
         .def(
             "push_mouse_button_handler",
             [](viz::PointViz& self,
@@ -271,6 +407,27 @@ void init_viz(py::module& m, py::module&) {
                                py::return_value_policy::reference_internal,
                                "Get a reference to the camera controls.")
 
+        .def("add_viewport", &viz::PointViz::add_viewport, py::arg("x0"),
+             py::arg("y0"), py::arg("x1"), py::arg("y1"), R"(
+             Draw the scene again into a rectangle of the window, by a camera
+             of its own, from the same GPU buffers.
+
+             Args:
+                 x0, y0, x1, y1: the rectangle, as fractions of the window
+                     size from its bottom left corner
+
+             Returns:
+                 The index of the viewport.
+        )")
+        .def_property_readonly("viewport_count",
+                               &viz::PointViz::viewport_count,
+                               "The number of viewports added.")
+        .def("viewport_camera", &viz::PointViz::viewport_camera,
+             py::arg("index"), py::return_value_policy::reference_internal,
+             "Get a reference to the camera of a viewport.")
+        .def("clear_viewports", &viz::PointViz::clear_viewports,
+             "Remove all the viewports.")
+
         .def_property_readonly("target_display", &viz::PointViz::target_display,
                                py::return_value_policy::reference_internal,
                                "Get a reference to the target display.")
@@ -295,7 +452,9 @@ void init_viz(py::module& m, py::module&) {
              Add an object to the scene.
 
              Args:
-                 obj: A cloud, label, image or cuboid.)")
+                 obj: A cloud, level of detail cloud, label, image or cuboid.)")
+        .def("add", py::overload_cast<const std::shared_ptr<viz::LodCloud>&>(
+                        &viz::PointViz::add))
         .def("add", py::overload_cast<const std::shared_ptr<viz::Cuboid>&>(
                         &viz::PointViz::add))
         .def("add", py::overload_cast<const std::shared_ptr<viz::Label>&>(
@@ -309,11 +468,14 @@ void init_viz(py::module& m, py::module&) {
              Remove an object from the scene.
 
              Args:
-                 obj: A cloud, label, image or cuboid.
+                 obj: A cloud, level of detail cloud, label, image or cuboid.
 
              Returns:
                  True if the object was in the scene and was removed.
              )")
+        .def("remove",
+             py::overload_cast<const std::shared_ptr<viz::LodCloud>&>(
+                 &viz::PointViz::remove))
         .def("remove", py::overload_cast<const std::shared_ptr<viz::Cuboid>&>(
                            &viz::PointViz::remove))
         .def("remove", py::overload_cast<const std::shared_ptr<viz::Label>&>(
@@ -330,6 +492,28 @@ void init_viz(py::module& m, py::module&) {
         [](viz::PointViz& viz) { viz::add_default_controls(viz); },
         "Add default keyboard and mouse bindings to a visualizer instance.");
 
+    py::class_<viz::FrameStats> frame_stats(
+        m, "FrameStats", "Where the time of a frame drawn by PointViz went.");
+
+    py::class_<viz::FrameStats::Section>(frame_stats, "Section",
+                                         "The time of a part of a frame.")
+        .def_readonly("name", &viz::FrameStats::Section::name,
+                      "The part of the frame")
+        .def_readonly("cpu_ms", &viz::FrameStats::Section::cpu_ms,
+                      "Time of the render thread, in milliseconds")
+        .def_readonly("gpu_ms", &viz::FrameStats::Section::gpu_ms,
+                      "Time of the GPU, in milliseconds");
+
+    frame_stats
+        .def_readonly("frame", &viz::FrameStats::frame,
+                      "The number of the frame, counting from 0")
+        .def_readonly("cpu_ms", &viz::FrameStats::cpu_ms,
+                      "Time of the render thread, including the swap")
+        .def_readonly("gpu_ms", &viz::FrameStats::gpu_ms,
+                      "Time of the GPU over all the sections")
+        .def_readonly("sections", &viz::FrameStats::sections,
+                      "The parts of the frame, in drawing order");
+
     py::class_<viz::WindowCtx>(m, "WindowCtx", "Context for input callbacks.")
         .def(py::init<>())
         .def_readonly("lbutton_down", &viz::WindowCtx::lbutton_down,
@@ -470,17 +654,11 @@ void init_viz(py::module& m, py::module&) {
                                 homogeneous transformation matrix.
              )")
         .def(py::init([](const sensor::sensor_info& info) {
-                 const auto xyz_lut = make_xyz_lut(info, true);
-
-                 // make_xyz_lut still outputs doubles
-                 Eigen::Array<float, Eigen::Dynamic, 3> direction =
-                     xyz_lut.direction.cast<float>();
-                 Eigen::Array<float, Eigen::Dynamic, 3> offset =
-                     xyz_lut.offset.cast<float>();
-
+                 const auto xyz_lut = shared_xyz_lut_f(info, true);
                  return new viz::Cloud{info.format.columns_per_frame,
                                        info.format.pixels_per_column,
-                                       direction.data(), offset.data(),
+                                       xyz_lut->direction.data(),
+                                       xyz_lut->offset.data(),
                                        viz::identity4d};
              }),
              py::arg("metadata"),
@@ -508,6 +686,24 @@ void init_viz(py::module& m, py::module&) {
                   range: array of at least as many elements as there are points,
                          representing the range of the points
               )")
+        .def(
+            "set_range",
+            [](viz::Cloud& self, py::array_t<uint32_t> range, size_t first_col,
+               size_t num_cols) {
+                check_array(range, self.get_size(), 2, 'C');
+                self.set_range(range.data(), first_col, num_cols);
+            },
+            py::arg("range"), py::arg("first_col"), py::arg("num_cols"),
+            R"(
+                Set the range values of some columns only, so that only those
+                are uploaded to the GPU on the next draw.
+
+                Args:
+                  range: array of at least as many elements as there are points,
+                         of which only the given columns are read
+                  first_col: the first column to set
+                  num_cols: the number of columns to set
+              )")
         .def(
             "set_key",
             [](viz::Cloud& self, py::array_t<float> key) {
@@ -556,6 +752,46 @@ void init_viz(py::module& m, py::module&) {
                     key: array of at least as many elements as there are
                          points, preferably normalized between 0 and 1
              )")
+        .def(
+            "set_key_raw",
+            [](viz::Cloud& self, py::array key,
+               viz::KeyNormalization normalization) {
+                // uploaded as is when possible, other types are converted
+                if (key.dtype().is(py::dtype::of<uint8_t>())) {
+                    auto k = py::array_t<uint8_t, py::array::c_style |
+                                                      py::array::forcecast>(
+                        key);
+                    check_array(k, self.get_size());
+                    self.set_key_raw(k.data(), normalization);
+                } else if (key.dtype().is(py::dtype::of<uint16_t>())) {
+                    auto k = py::array_t<uint16_t, py::array::c_style |
+                                                       py::array::forcecast>(
+                        key);
+                    check_array(k, self.get_size());
+                    self.set_key_raw(k.data(), normalization);
+                } else {
+                    auto k = py::array_t<uint32_t, py::array::c_style |
+                                                       py::array::forcecast>(
+                        key);
+                    check_array(k, self.get_size());
+                    self.set_key_raw(k.data(), normalization);
+                }
+            },
+            py::arg("key"),
+            py::arg("normalization") = viz::KeyNormalization::AUTO_EXPOSURE,
+            R"(
+                 Set unnormalized key values, e.g. the REFLECTIVITY, SIGNAL or
+                 NIR field of a scan, normalized on the GPU.
+
+                 The keys are uploaded as is, and the GPU scales them like
+                 AutoExposure does or equalizes their histogram, which spares
+                 normalizing them on the CPU every frame.
+
+                 Args:
+                    key: array of as many unsigned integers as there are
+                         points; uint8, uint16 and uint32 are uploaded as is
+                    normalization: how the keys are normalized
+             )")
         .def(
             "set_mask",
             [](viz::Cloud& self, py::array_t<float> mask) {
@@ -685,41 +921,329 @@ void init_viz(py::module& m, py::module&) {
             return ss.str();
         });
 
-    py::class_<viz::Image, std::shared_ptr<viz::Image>>(
-        m, "Image", "Manages the state of an image.")
+    py::class_<viz::LodCloud, std::shared_ptr<viz::LodCloud>>(m, "LodCloud",
+                                                              R"(
+             Manages the state of a large static point cloud, drawn with a level
+             of detail.
+
+             Points are accumulated into chunks of a voxel grid. Every frame the
+             chunks out of the view are culled and the others decimated, far
+             ones more than near ones, so that at most a budget of points is
+             drawn. Adding points only uploads the new points.
+             )")
+        .def(py::init<float, size_t>(), py::arg("chunk_size") = 10.0f,
+             py::arg("point_budget") = 5000000,
+             R"(
+             Empty level of detail point cloud.
+
+             Args:
+                 chunk_size: the edge of the cubic chunks of the voxel grid, in
+                             the units of the points
+                 point_budget: the most points drawn per frame, 0 for no limit
+             )")
+        .def(
+            "add_points",
+            [](viz::LodCloud& self,
+               py::array_t<float, py::array::c_style | py::array::forcecast>
+                   xyz,
+               nonstd::optional<py::array_t<float, py::array::c_style |
+                                                       py::array::forcecast>>
+                   key) {
+                if (xyz.ndim() != 2 || xyz.shape(1) != 3)
+                    throw std::invalid_argument("Expected a N x 3 array");
+                const size_t n = xyz.shape(0);
+                if (key) check_array(*key, n);
+                self.add_points(xyz.data(), key ? key->data() : nullptr, n);
+            },
+            py::arg("xyz"), py::arg("key") = nonstd::nullopt,
+            R"(
+                Add points to the cloud.
+
+                Args:
+                  xyz: N x 3 array of the positions of the points
+                  key: N values used for coloring, preferably normalized between
+                       0 and 1, or None for 0
+              )")
+        .def("clear_points", &viz::LodCloud::clear_points,
+             "Remove all the points of the cloud.")
+        .def("set_point_budget", &viz::LodCloud::set_point_budget,
+             py::arg("point_budget"),
+             R"(
+            Set the most points drawn per frame.
+
+            Args:
+                point_budget: the number of points, 0 for no limit
+        )")
+        .def(
+            "set_pose",
+            [](viz::LodCloud& self, pymatrixd pose) {
+                check_array(pose, 16, 2, 'F');
+                viz::mat4d posea;
+                std::copy(pose.data(), pose.data() + 16, posea.data());
+                self.set_pose(posea);
+            },
+            py::arg("pose"),
+            R"(
+                 Set the pose of the cloud.
+
+                 Args:
+                    pose: 4x4 column-major homogeneous transformation matrix
+             )")
+        .def("set_point_size", &viz::LodCloud::set_point_size,
+             py::arg("size"),
+             R"(
+            Set point size.
+
+            Args:
+                size: point size
+        )")
+        .def(
+            "set_palette",
+            [](viz::LodCloud& self, py::array_t<float> buf) {
+                check_array(buf, 0, 2, 'C');
+                if (buf.shape(1) != 3)
+                    throw std::invalid_argument("Expected a N x 3 array");
+                self.set_palette(buf.data(), buf.shape(0));
+            },
+            py::arg("palette"),
+            R"(
+            Set the point cloud color palette.
+
+            Args:
+                palette: the new palette to use, must have size 3*palette_size
+        )")
+        .def_property_readonly("size", &viz::LodCloud::get_size,
+                               "Number of points in the cloud")
+        .def("__repr__", [](const viz::LodCloud& self) {
+            std::stringstream ss;
+            ss << "<ouster.sdk.viz.LodCloud " << &self
+               << ", pts = " << self.get_size() << ">";
+            return ss.str();
+        });
+
+    py::class_<viz::MapAccumulatorConfig>(m, "MapAccumulatorConfig",
+                                          "Options of a MapAccumulator.")
         .def(py::init<>())
+        .def_readwrite(
+            "select_ratio", &viz::MapAccumulatorConfig::select_ratio,
+            "The fraction of the valid pixels of a scan considered for the map")
+        .def_readwrite("voxel_size", &viz::MapAccumulatorConfig::voxel_size,
+                       "The edge of the voxels of the map, which keeps at most "
+                       "one point per voxel; 0 to keep every selected point")
+        .def_readwrite("max_points", &viz::MapAccumulatorConfig::max_points,
+                       "The most points in the map, 0 for no limit")
+        .def_readwrite("overflow_from_start",
+                       &viz::MapAccumulatorConfig::overflow_from_start,
+                       "When the map is full, drop the points of the oldest "
+                       "scans rather than ignore new ones")
+        .def_readwrite("chunk_size", &viz::MapAccumulatorConfig::chunk_size,
+                       "The edge of the chunks of the LodCloud drawing the map")
+        .def_readwrite("point_budget",
+                       &viz::MapAccumulatorConfig::point_budget,
+                       "The most points of the map drawn per frame, 0 for no "
+                       "limit");
+
+    py::class_<viz::MapAccumulator>(m, "MapAccumulator", R"(
+             Accumulates points of lidar scans of several sensors into a map
+             drawn by a LodCloud.
+
+             Each scan is projected and dewarped by its column poses only for a
+             random selection of its valid pixels, which are filtered to at
+             most one per voxel. Only the new points are uploaded to the GPU.
+             )")
+        .def(py::init<const std::vector<sensor::sensor_info>&,
+                      const viz::MapAccumulatorConfig&>(),
+             py::arg("sensors"),
+             py::arg("config") = viz::MapAccumulatorConfig{},
+             R"(
+             Empty map.
+
+             Args:
+                 sensors: the metadata of the sensors of the scans
+                 config: the options of the accumulator
+             )")
         .def(
-            "set_image",
-            [](viz::Image& self, py::array_t<float> image) {
-                check_array(image, 0, 0, 'C');  // check for C-CONTIGUOUS
-                if (image.ndim() == 2 ||
-                    (image.ndim() == 3 && image.shape(2) == 1)) {
-                    // MONO
-                    self.set_image(image.shape(1), image.shape(0),
-                                   image.data());
-                    return;
+            "update",
+            [](viz::MapAccumulator& self, size_t sensor_idx,
+               const LidarScan& scan, py::dict keys) {
+                std::map<std::string, img_t<float>> key_imgs;
+                for (auto item : keys) {
+                    auto key = py::array_t<float, py::array::c_style |
+                                                      py::array::forcecast>::
+                        ensure(item.second);
+                    if (!key || key.ndim() != 2)
+                        throw std::invalid_argument(
+                            "Expected 2D arrays of keys");
+                    key_imgs[item.first.cast<std::string>()] =
+                        Eigen::Map<const img_t<float>>(
+                            key.data(), key.shape(0), key.shape(1));
                 }
+                py::gil_scoped_release release;
+                self.update(sensor_idx, scan, key_imgs);
+            },
+            py::arg("sensor_idx"), py::arg("scan"),
+            py::arg("keys") = py::dict(),
+            R"(
+                Add the points of a scan to the map.
 
-                check_array(image, 0, 3);
+                Args:
+                  sensor_idx: the index of the sensor of the scan
+                  scan: a scan with a RANGE field and poses
+                  keys: key images of the scan, normalized between 0 and 1, by
+                        name of coloring mode
+              )")
+        .def("set_key_name", &viz::MapAccumulator::set_key_name,
+             py::arg("name"),
+             R"(
+            Color the map by the keys of a mode, or by zero keys if no scan
+            had them.
 
-                if (image.shape(2) == 3) {
-                    // RGB
-                    self.set_image_rgb(image.shape(1), image.shape(0),
-                                       image.data());
-                    return;
-                }
+            Args:
+                name: the name of the coloring mode
+        )")
+        .def_property_readonly("key_name", &viz::MapAccumulator::key_name,
+                               "The name of the coloring mode of the map")
+        .def("clear", &viz::MapAccumulator::clear,
+             "Remove all the points of the map.")
+        .def_property_readonly("size", &viz::MapAccumulator::size,
+                               "Number of points in the map")
+        .def("cloud", &viz::MapAccumulator::cloud,
+             "The cloud drawing the map, to add to a PointViz.");
+
+    py::class_<viz::FieldViewMode>(m, "FieldViewMode", R"(
+             How a LidarScanViz turns a field of the scans into the keys
+             coloring its clouds and images.
+             )")
+        .def(py::init<>())
+        .def_readwrite("name", &viz::FieldViewMode::name,
+                       "The name of the mode as a cloud mode")
+        .def_readwrite("fields", &viz::FieldViewMode::fields,
+                       "The field of each return")
+        .def_readwrite("image_names", &viz::FieldViewMode::image_names,
+                       "The name of the mode as an image mode, for each "
+                       "return; empty to use the names of the fields")
+        .def_readwrite("auto_exposure", &viz::FieldViewMode::auto_exposure,
+                       "Scale the keys with an AutoExposure")
+        .def_readwrite("beam_uniformity",
+                       &viz::FieldViewMode::beam_uniformity,
+                       "Correct the keys with a BeamUniformityCorrector")
+        .def_readwrite("scale", &viz::FieldViewMode::scale,
+                       "If greater than zero, the keys are the values times "
+                       "scale, clamped to 1")
+        .def_readwrite("gpu_keys", &viz::FieldViewMode::gpu_keys,
+                       "Normalize the keys of clouds on the GPU")
+        .def_readwrite("calref_palette", &viz::FieldViewMode::calref_palette,
+                       "Color images with the calibrated reflectivity palette")
+        .def_readwrite("rgb", &viz::FieldViewMode::rgb,
+                       "The fields have three channels");
 
-                if (image.shape(2) == 4) {
-                    // RGBA
-                    self.set_image_rgba(image.shape(1), image.shape(0),
-                                        image.data());
-                    return;
+    m.def(
+        "default_view_mode",
+        [](const sensor::sensor_info& info,
+           const LidarScan& scan,
+           const std::string& field) -> py::object {
+            viz::FieldViewMode mode;
+            if (!viz::default_view_mode(info, scan, field, mode)) {
+                return py::none();
+            }
+            return py::cast(mode);
+        },
+        py::arg("info"), py::arg("scan"), py::arg("field"), R"(
+        The view mode the viz uses for a field of a scan.
+
+        Returns:
+            The mode, or None if the field can't be viewed.
+        )");
+
+    py::class_<viz::LidarScanVizStats>(m, "LidarScanVizStats",
+                                       "Counters of a LidarScanViz.")
+        .def_readonly("submitted", &viz::LidarScanVizStats::submitted,
+                      "Frames submitted")
+        .def_readonly("computed", &viz::LidarScanVizStats::computed,
+                      "Frames computed, over all sensors")
+        .def_readonly("skipped", &viz::LidarScanVizStats::skipped,
+                      "Frames replaced before they were computed")
+        .def_readonly("applied", &viz::LidarScanVizStats::applied,
+                      "Frames applied, over all sensors")
+        .def_readonly("compute", &viz::LidarScanVizStats::compute,
+                      "Time computing a frame of a sensor took, in ns");
+
+    py::class_<viz::LidarScanViz>(m, "LidarScanViz", R"(
+             The model of a lidar scan viewer: two clouds and two images per
+             sensor, whose keys are computed from the scans on a thread per
+             sensor according to the selected cloud and image modes.
+             )")
+        .def(py::init<const std::vector<sensor::sensor_info>&>(),
+             py::arg("sensors"))
+        .def_property_readonly("sensor_count",
+                               &viz::LidarScanViz::sensor_count,
+                               "The number of sensors")
+        .def("cloud", &viz::LidarScanViz::cloud, py::arg("sensor"),
+             py::arg("return_num"), "The cloud of a sensor and return.")
+        .def("image", &viz::LidarScanViz::image, py::arg("sensor"),
+             py::arg("index"), "An image of a sensor.")
+        .def("add_mode", &viz::LidarScanViz::add_mode, py::arg("mode"),
+             "Add a view mode for every sensor.")
+        .def("cloud_modes", &viz::LidarScanViz::cloud_modes,
+             "The names of the cloud modes, sorted.")
+        .def("image_modes", &viz::LidarScanViz::image_modes,
+             "The names of the image modes, sorted.")
+        .def_property("cloud_mode", &viz::LidarScanViz::cloud_mode,
+                      &viz::LidarScanViz::set_cloud_mode,
+                      "The mode coloring the clouds")
+        .def("set_image_mode", &viz::LidarScanViz::set_image_mode,
+             py::arg("index"), py::arg("name"), "Select the mode of an image.")
+        .def("image_mode", &viz::LidarScanViz::image_mode, py::arg("index"),
+             "The mode of an image.")
+        .def(
+            "submit",
+            [](viz::LidarScanViz& self, const std::vector<py::object>& scans) {
+                // the threads outlive the python scans, so they get copies
+                std::vector<std::shared_ptr<const LidarScan>> copies;
+                for (const auto& scan : scans) {
+                    if (scan.is_none()) {
+                        copies.emplace_back();
+                    } else {
+                        copies.push_back(std::make_shared<const LidarScan>(
+                            scan.cast<const LidarScan&>()));
+                    }
                 }
+                py::gil_scoped_release release;
+                self.submit(copies);
+            },
+            py::arg("scans"), R"(
+            Hand the threads of the sensors a frame to compute.
 
-                throw std::invalid_argument(
-                    "Expected array with size of 3rd dimension: 1,3 or "
-                    "4, but got: " +
-                    std::to_string(image.shape(2)));
+            Args:
+                scans: the scan of each sensor, or None to hide the sensor
+            )")
+        .def("apply", &viz::LidarScanViz::apply,
+             py::call_guard<py::gil_scoped_release>(), R"(
+            Copy the frames computed since the last call into the clouds and
+            images, before PointViz.update().
+
+            Returns:
+                True if a frame of any sensor was applied.
+            )")
+        .def("wait", &viz::LidarScanViz::wait, py::arg("timeout_sec") = -1.0,
+             py::call_guard<py::gil_scoped_release>(),
+             "Wait until the frames submitted are computed, False on timeout.")
+        .def("stats", &viz::LidarScanViz::stats, "The counters of the model.");
+
+    py::class_<viz::Image, std::shared_ptr<viz::Image>>(
+        m, "Image", "Manages the state of an image.")
+        .def(py::init<>())
+        .def(
+            "set_image",
+            [](viz::Image& self, py::array image) {
+                // uint8 and uint16 are uploaded as is, others as floats
+                if (image.dtype().is(py::dtype::of<uint8_t>())) {
+                    set_image_of(self, py::array_t<uint8_t>(image));
+                } else if (image.dtype().is(py::dtype::of<uint16_t>())) {
+                    set_image_of(self, py::array_t<uint16_t>(image));
+                } else {
+                    set_image_of(self, py::array_t<float>(image));
+                }
             },
             py::arg("image"), R"(
                  Set the image data, MONO or RGB/RGBA depending on dimensions.
@@ -729,8 +1253,11 @@ void init_viz(py::module& m, py::module&) {
                  monochrome image.
 
                  Args:
-                    image: 2D array of floats for a monochrome image or 3D array
-                           with RGB or RGBA components for color image.
+                    image: 2D array for a monochrome image or 3D array with RGB
+                           or RGBA components for color image. Floats are
+                           between 0 and 1, uint8 and uint16 arrays are
+                           normalized from their range and uploaded as is;
+                           uint16 images must be monochrome.
              )")
         .def(
             "set_mask",
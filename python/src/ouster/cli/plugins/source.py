@@ -12,7 +12,8 @@ from ouster.cli.core.cli_args import CliArgs
 from ouster.cli.core.util import click_ro_file
 from ouster.sdk import open_source, SourceURLException
 from ouster.sdk.client import (LidarScan, SensorInfo, ImuPacket, Sensor,
-                               PacketFormat, first_valid_packet_ts)
+                               PacketFormat, first_valid_packet_ts,
+                               VoxelPolicy, voxel_downsample, MapTileStore)
 from ouster.sdk.client.core import ClientTimeout
 from ouster.sdk.pcap import PcapDuplicatePortException
 from ouster.sdk.util import resolve_metadata
@@ -24,7 +25,7 @@ import ouster.cli.plugins.source_sensor as sensor_cli
 from ouster.sdk.util.extrinsics import parse_extrinsics_from_string
 import ouster.sdk.util.pose_util as pu
 from typing import (Optional, Iterable, Tuple, Union)
-from .source_save import (SourceSaveCommand, source_save_raw)
+from .source_save import (SourceSaveCommand, source_save_raw, save_osf_natively)
 from .source_util import (CoupledTee,
                           SourceCommandContext,
                           SourceCommandCallback,
@@ -83,7 +84,8 @@ def is_ouster_mapping_installed():
               default=None, type=int,
               help="Maximum number of points in overall map before discarding. [default: 1500000]")
 @click.option("--global-map", default=None, type=str,
-              help="A path to a ply file that represents the global map to display in the ouster-viz. "
+              help="A path to a ply file, or a tiled .omap map store, that represents the global map to display "
+                   "in the ouster-viz. "
                    "When using this option with the `localize` command it will replace the visualized global "
                    " map but it won't affect the map used during localization")
 @click.option("--global-map-min-z", default=None, type=float,
@@ -165,6 +167,30 @@ def source_viz(ctx: SourceCommandContext, pause: bool, on_eof: str, pause_at: in
     if map_size <= 0:
         raise click.exceptions.UsageError("--map-size must be greater than 0")
 
+    def add_tiled_global_map(sv, map_path, min_z, max_z, flatten, voxel_size, point_size):
+        # tiles are read one at a time into a level of detail cloud, at the
+        # coarsest level of the store no coarser than the voxel size
+        from ouster.sdk.viz import LodCloud
+        click.echo("Start loading global map tiles into VIZ")
+        store = MapTileStore(map_path, 1)
+        level = 0
+        if voxel_size:
+            while (level + 1 < store.levels
+                   and store.voxel_size * 2 ** (level + 1) <= voxel_size):
+                level += 1
+        cloud = LodCloud(store.tile_size)
+        for key in store.tiles():
+            pts = store.tile_points(key, level)
+            if min_z:
+                pts = pts[pts[:, 2] >= min_z]
+            if max_z:
+                pts = pts[pts[:, 2] <= max_z]
+            if flatten:
+                pts[:, 2] = 0
+            cloud.add_points(pts, np.full(len(pts), 1.0))
+        cloud.set_point_size(point_size)
+        sv._viz.add(cloud)
+
     def viz_thread_fn():
         sv = SimpleViz(
             metadata,
@@ -180,7 +206,10 @@ def source_viz(ctx: SourceCommandContext, pause: bool, on_eof: str, pause_at: in
 
         map_path = ctx.get("localization.map", None) if global_map is None else global_map
 
-        if map_path is not None:
+        if map_path is not None and map_path.endswith(".omap"):
+            add_tiled_global_map(sv, map_path, global_map_min_z, global_map_max_z,
+                                 global_map_flatten, global_map_voxel_size, global_map_point_size)
+        elif map_path is not None:
             import point_cloud_utils as pcu
             from ouster.sdk.viz import Cloud
             click.echo("Start loading global points into VIZ")
@@ -190,8 +219,8 @@ def source_viz(ctx: SourceCommandContext, pause: bool, on_eof: str, pause_at: in
             if global_map_max_z:
                 pts = pts[pts[:, 2] <= global_map_max_z]
             if global_map_voxel_size:
-                pts = pcu.downsample_point_cloud_on_voxel_grid(
-                        global_map_voxel_size, pts)
+                pts = voxel_downsample(np.ascontiguousarray(pts, dtype=np.float64),
+                                       global_map_voxel_size, VoxelPolicy.CENTROID)[0]
             if global_map_flatten:
                 pts[:, 2] = 0
             cloud_xyz = Cloud(len(pts))
@@ -611,6 +640,8 @@ class SourceMultiCommand(click.MultiCommand):
             },
             OusterIoType.PCAP: {
                 'info': pcap_cli.pcap_info,
+                'convert': pcap_cli.pcap_convert,
+                'replay': pcap_cli.pcap_replay,
                 'save': SourceSaveCommand('save', context_settings=dict(ignore_unknown_options=True,
                                                                         allow_extra_args=True)),
                 'save_raw': source_save_raw,
@@ -621,6 +652,9 @@ class SourceMultiCommand(click.MultiCommand):
                 'info': osf_cli.osf_info,
                 'metadata': osf_cli.osf_metadata,
                 'parse': osf_cli.osf_parse,
+                'transcode': osf_cli.osf_transcode,
+                'compact': osf_cli.osf_compact,
+                'bench': osf_cli.osf_bench,
                 'save': SourceSaveCommand('save', context_settings=dict(ignore_unknown_options=True,
                                                                         allow_extra_args=True)),
             },
@@ -630,7 +664,9 @@ class SourceMultiCommand(click.MultiCommand):
                 'save_raw': source_save_raw,
                 'save': SourceSaveCommand('save', context_settings=dict(ignore_unknown_options=True,
                                                                         allow_extra_args=True)),
-            }
+            },
+            # scans streamed by a ScanStreamServer support the ANY commands
+            OusterIoType.SCAN_STREAM: {}
         }
 
     def get_supported_source_types(self):
@@ -868,6 +904,13 @@ def process_commands(click_ctx: click.core.Context, callbacks: Iterable[SourceCo
         if fields is not None:
             field_names = fields.strip().split(',')
 
+        # chains of built-in commands only from a pcap file to an OSF file
+        # don't need to go through python
+        if (not loop and not filter and not soft_id_check and resolved_extrinsics is None
+                and resolved_initial_pose is None
+                and save_osf_natively(callbacks, command_names, source.strip(), meta, field_names)):
+            return
+
         source_list = [url.strip() for url in source.split(',') if url.strip()]
 
         try:
@@ -1,5 +1,6 @@
 import click
 import logging
+from typing import Any
 from ouster.cli.plugins.source import source  # type: ignore
 import ouster.sdk.client as client
 from ouster.cli.plugins.source_util import (source_multicommand,
@@ -18,25 +19,35 @@ logger = logging.getLogger('localization')
 @click.option('--min-range', required=False, show_default=True,
               default=0.0, help="Lower limit of range measurments used during localization (meters)")
 @click.option('-v', '--voxel-size', type=float, default=1.4, help="Map voxel size (meters)")
+@click.option('--native', is_flag=True, default=False,
+              help="Localize natively against a memory mapped index of the map, built next to the map as "
+                   "a .vidx file when missing, or given as MAP_FILENAME")
 @click.pass_context
 @source_multicommand(type=SourceCommandType.PROCESSOR_UNREPEATABLE)
 def source_localize(ctx: SourceCommandContext, map_filename: str, max_range: float, min_range: float,
-                    voxel_size: float) -> None:
+                    voxel_size: float, native: bool) -> None:
     """
-    Run localization based on the mapping output ply map
+    Run localization based on the mapping output ply map, or a tiled .omap map paged in by region
     """
 
     def make_kiss_localization():
-        try:
-            from ouster.sdk.localization.kiss_localization import KissLocalization
-        except ImportError as e:
-            raise click.ClickException(click.style("kiss-icp, a package required for slam, is "
-                                       f"unsupported on this platform. Error: {str(e)}", fg='red'))
+        localization_cls: Any
+        if native:
+            from ouster.sdk.localization.native_localization import NativeLocalization
+            localization_cls = NativeLocalization
+        else:
+            try:
+                from ouster.sdk.localization.kiss_localization import KissLocalization
+            except ImportError as e:
+                raise click.ClickException(click.style("kiss-icp, a package required for slam, is "
+                                           f"unsupported on this platform. Error: {str(e)}", fg='red'))
+            localization_cls = KissLocalization
 
         infos = ctx.scan_source.metadata
         xyz_lut = [client.XYZLut(infos[0], use_extrinsics=True)]
-        ctx.misc["localization.map"] = map_filename
-        return KissLocalization(
+        if not map_filename.endswith(".vidx"):
+            ctx.misc["localization.map"] = map_filename
+        return localization_cls(
                 filename=map_filename,
                 xyz_lut=xyz_lut,
                 max_range=max_range,
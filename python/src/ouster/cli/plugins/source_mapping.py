@@ -2,7 +2,6 @@ import os
 import sys
 import click
 import logging
-import laspy
 import numpy as np
 from ouster.sdk.io_type import OusterIoType
 from ouster.cli.plugins.source import source  # type: ignore
@@ -12,10 +11,15 @@ from ouster.cli.plugins.source_save import (SourceSaveCommand,
                                             create_directories_if_missing,
                                             _file_exists_error)
 from ouster.sdk.client import (ChanField,
-                               XYZLut,
                                first_valid_column_ts,
                                first_valid_column_pose,
-                               dewarp)
+                               cartesian_dewarp,
+                               PointCloudFormat,
+                               PointCloudWriter,
+                               MapTileStore,
+                               VoxelPolicy,
+                               voxel_downsample)
+from ouster.sdk._bindings.client import XYZLut as _XYZLut
 from ouster.cli.plugins.source_util import (source_multicommand,
                                             SourceCommandType,
                                             SourceCommandContext)
@@ -25,6 +29,12 @@ logging.basicConfig(level=logging.INFO)
 logger = logging.getLogger('mapping')
 _max_range = None
 _min_range = None
+# voxels on the side of a tile of a map streamed to an .omap store
+_map_tile_voxels = 64
+
+_formats = {".ply": PointCloudFormat.PLY,
+            ".pcd": PointCloudFormat.PCD,
+            ".las": PointCloudFormat.LAS}
 
 
 @click.command
@@ -35,7 +45,8 @@ _min_range = None
 @click.option('-v', '--voxel-size', required=False,
               type=float, help="Voxel map size (meters)")
 @click.option('-d', '--dump-map', required=False,
-              default="", type=str, help="Dumps the map to a ply file")
+              default="", type=str, help="Dumps the map to a ply file, or streams it to a tiled "
+              ".omap map store of bounded memory for large runs")
 @click.pass_context
 @source_multicommand(type=SourceCommandType.PROCESSOR_UNREPEATABLE)
 def source_slam(ctx: SourceCommandContext, max_range: float, min_range: float,
@@ -57,9 +68,10 @@ def source_slam(ctx: SourceCommandContext, max_range: float, min_range: float,
     _max_range = max_range
     _min_range = min_range
 
-    if dump_map:
+    tiled_map = dump_map.endswith(".omap")
+    if dump_map and not tiled_map:
         if not dump_map.endswith(".ply"):
-            raise click.UsageError("--dump-map must be be in .ply format")
+            raise click.UsageError("--dump-map must be be in .ply or .omap format")
         try:
             import point_cloud_utils as pcu  # type: ignore
         except ImportError:
@@ -84,6 +96,20 @@ def source_slam(ctx: SourceCommandContext, max_range: float, min_range: float,
         logger.error(str(e))
         return
 
+    # the tiled map gets the dewarped points of every scan as they are
+    # registered, rather than the local map of the last scans at the end
+    map_store = None
+    xyzluts = [_XYZLut(info, use_extrinsics=True) for info in ctx.scan_source.metadata]
+
+    def stream_to_map(slam_engine, slam_scans):
+        nonlocal map_store
+        if map_store is None:
+            voxel = slam_engine.voxel_size
+            map_store = MapTileStore(dump_map, voxel * _map_tile_voxels, voxel)
+        for idx, scan in enumerate(slam_scans):
+            if scan is not None:
+                map_store.append(cartesian_dewarp(scan, xyzluts[idx], compact=True))
+
     def slam_iter(scan_source, slam_engine, dump_map):
         scan_start_ts = None
         for scans in scan_source:
@@ -95,19 +121,26 @@ def source_slam(ctx: SourceCommandContext, max_range: float, min_range: float,
             scan_ts = first_valid_column_ts(scan)
             if scan_ts == scan_start_ts:
                 logger.info("SLAM restarts as scan iteration restarts")
-                if dump_map:
+                if dump_map and not tiled_map:
                     points = slam_engine.ouster_kiss_icp.local_map.point_cloud()
                     pcu.save_mesh_v(dump_map, points)
+                if dump_map:
+                    if map_store is not None:
+                        map_store.flush()
                     logger.info(f"map was dumped to {dump_map}")
                     dump_map = False
                 slam_engine = make_kiss_slam()
             if not scan_start_ts:
                 scan_start_ts = scan_ts
             slam_scans = slam_engine.update(scans)
+            if dump_map and tiled_map:
+                stream_to_map(slam_engine, slam_scans)
             yield slam_scans
-        if dump_map:
+        if dump_map and not tiled_map:
             points = slam_engine.ouster_kiss_icp.local_map.point_cloud()
             pcu.save_mesh_v(dump_map, points)
+        if map_store is not None:
+            map_store.flush()
 
     ctx.scan_iter = slam_iter(ctx.scan_iter, slam_engine, dump_map)
 
@@ -148,15 +181,6 @@ def point_cloud_convert(ctx: SourceCommandContext, filename: str, prefix: str,
                         overwrite: bool, verbose: bool, max_z: float,
                         min_z: float, pts_per_file: int, **kwargs) -> None:
 
-    pcu_installed = False
-    if decimate:
-        try:
-            import point_cloud_utils as pcu  # type: ignore
-            pcu_installed = True
-        except ImportError:
-            logger.warning("The point_cloud_utils library is not supported or installed,"
-                           "so the process will generate larger, non-downsampled files")
-
     scans_iter = ctx.scan_iter
     infos = ctx.scan_source.metadata  # type: ignore
 
@@ -175,8 +199,7 @@ def point_cloud_convert(ctx: SourceCommandContext, filename: str, prefix: str,
 
     def convert_iter():
         points_to_process = np.empty(shape=[0, 3])
-        keys_to_process = np.empty(shape=[0, 1])
-        points_keys_total = np.empty(shape=[0, 4])
+        keys_to_process = np.empty(shape=[0])
 
         # hard-coded parameters and counters #
         # affect the running time. smaller value mean longer running time. Too large
@@ -209,96 +232,83 @@ def point_cloud_convert(ctx: SourceCommandContext, filename: str, prefix: str,
 
         xyzlut_list = []
         for info in infos:
-            xyzlut_list.append(XYZLut(info, use_extrinsics=True))
+            xyzlut_list.append(_XYZLut(info, use_extrinsics=True))
+
+        z_low = -np.inf if min_z is None else min_z
+        z_high = np.inf if max_z is None else max_z
+
+        # points are streamed to the current output file, encoded on worker
+        # threads of the native writer
+        writer = None
+        writer_path = ""
+        writer_reported = 0
+
+        def current_writer() -> PointCloudWriter:
+            nonlocal writer, writer_path, writer_reported
+            if writer is None:
+                writer_path = f"{file_wo_ext}-{file_numb:03}{outfile_ext}"
+                # CloudCompare PLY color point cloud using the range 0-1
+                key_scale = 1 / 255 if outfile_ext == ".ply" else 1.0
+                writer = PointCloudWriter(writer_path, _formats[outfile_ext],
+                                          field, key_scale)
+                writer_reported = 0
+            return writer
 
         def process_points(points, keys):
-            nonlocal points_keys_total, points_down_removed, points_saved
+            nonlocal points_down_removed, points_saved
             pts_size_before = points.shape[0]
-            z_min_filter = np.ones(points.shape[0], dtype=bool)  # Initialize to all True
-            z_max_filter = np.ones(points.shape[0], dtype=bool)
-            if min_z is not None:
-                z_min_filter = points[:, 2] >= min_z
-
-            if max_z is not None:
-                z_max_filter = points[:, 2] <= max_z
-
-            # Apply range filter if any of min_z or max_z is specified
-            if min_z is not None or max_z is not None:
-                z_range_filter = z_min_filter & z_max_filter
-                points = points[z_range_filter]
-                keys = keys[z_range_filter]
-
-            if pcu_installed and decimate:
-                # can be extended for RGBA values later
-                points, keys = pcu.downsample_point_cloud_on_voxel_grid(
-                    voxel_size, points, keys)
-                keys = keys[:, np.newaxis]
+            z_range_filter = (points[:, 2] >= z_low) & (points[:, 2] <= z_high)
+            points = points[z_range_filter]
+            keys = keys[z_range_filter]
+
+            # voxel centroids, with the mean key of every voxel. can be
+            # extended for RGBA values later
+            points, _, voxels = voxel_downsample(
+                np.ascontiguousarray(points, dtype=np.float64), voxel_size,
+                VoxelPolicy.CENTROID)
+            kept = voxels >= 0
+            keys = (np.bincount(voxels[kept], weights=keys[kept], minlength=len(points)) /
+                    np.bincount(voxels[kept], minlength=len(points)))
 
             pts_size_after = points.shape[0]
 
             points_down_removed += pts_size_before - pts_size_after
             points_saved += pts_size_after
 
-            pts_keys_pair = np.append(points, keys, axis=1)
-            points_keys_total = np.append(points_keys_total, pts_keys_pair, axis=0)
-
-        def save_file(file_wo_ext: str, outfile_ext: str):
-            nonlocal points_keys_total
-            logger.info(f"Output file: {file_wo_ext + outfile_ext}")
+            current_writer().write(points, keys)
+
+        def count_written():
+            # without decimation the writer keeps the count of the points that
+            # passed the z filter
+            nonlocal points_saved, points_down_removed, writer_reported
+            if decimate or writer is None:
+                return
+            writer.flush()
+            saved = writer.points_written() - writer_reported
+            writer_reported = writer.points_written()
+            points_saved += saved
+            points_down_removed = points_sum - points_out_range - points_saved
+
+        def save_file():
+            nonlocal writer
+            current_writer()
+            logger.info(f"Output file: {writer_path}")
             pc_status_print()
-
-            if outfile_ext == ".ply":
-                # CloudCompare PLY color point cloud using the range 0-1
-                with open(file_wo_ext + outfile_ext, 'w') as f:
-                    # Write PLY header
-                    f.write("ply\n")
-                    f.write("format ascii 1.0\n")
-                    f.write(
-                        "element vertex {}\n".format(
-                            points_keys_total.shape[0]))
-                    f.write("property float x\n")
-                    f.write("property float y\n")
-                    f.write("property float z\n")
-                    f.write(f"property float {field}\n")
-                    f.write("end_header\n")
-                    for i in range(points_keys_total.shape[0]):
-                        f.write("{} {} {} {}\n".format(
-                            points_keys_total[i, 0], points_keys_total[i, 1],
-                            points_keys_total[i, 2], points_keys_total[i, 3] / 255))
-            elif outfile_ext == ".las":
-                LAS_file = laspy.create()
-                LAS_file.x = points_keys_total[:, 0]
-                LAS_file.y = points_keys_total[:, 1]
-                LAS_file.z = points_keys_total[:, 2]
+            writer.close()
+            if outfile_ext == ".las":
                 # LAS file only has intensity but we can use it for other field
                 # value
-                LAS_file.intensity = points_keys_total[:, 3]
-                LAS_file.write(file_wo_ext + outfile_ext)
                 logger.info(f"LAS format only supports the Intensity field. "
                             f"Saving {field} as the Intensity field.")
-            elif outfile_ext == ".pcd":
-                with open(file_wo_ext + outfile_ext, 'w') as f:
-                    # Write PCD header
-                    f.write(f"FIELDS x y z {field}\n")
-                    f.write("SIZE 4 4 4 4\n")
-                    f.write("TYPE F F F F\n")
-                    f.write("COUNT 1 1 1 1\n")
-                    f.write("WIDTH %d\n" % (points_keys_total.shape[0]))
-                    f.write("HEIGHT 1\n")
-                    f.write("POINTS %d\n" % (points_keys_total.shape[0]))
-                    f.write("DATA ascii\n")
-                    for i in range(points_keys_total.shape[0]):
-                        f.write("{} {} {} {}\n".format(
-                            points_keys_total[i, 0], points_keys_total[i, 1],
-                            points_keys_total[i, 2], points_keys_total[i, 3]))
-
-            points_keys_total = np.empty(shape=[0, 4])
+            writer = None
 
         def pc_status_print():
             nonlocal points_sum, points_down_removed, points_saved, points_out_range
-            down_removed_pct = (points_down_removed / points_sum) * 100
-            out_range_pct = (points_out_range / points_sum) * 100
-            save_pct = (points_saved / points_sum) * 100
+            count_written()
+            points_total = max(points_sum, 1)
+            down_removed_pct = (points_down_removed / points_total) * 100
+            out_range_pct = (points_out_range / points_total) * 100
+            save_pct = (points_saved / points_total) * 100
             logger.info(
                 f"Point Cloud status info\n"
                 f"{points_sum} points accumulated during this period,\n{points_down_removed} "
@@ -328,8 +338,9 @@ def point_cloud_convert(ctx: SourceCommandContext, filename: str, prefix: str,
                         # Save point cloud and printout when scan iteration restarts
                         # This action only do once
                         if finish_saving_action:
-                            process_points(points_to_process, keys_to_process)
-                            save_file(f"{file_wo_ext}-{file_numb:03}", outfile_ext)
+                            if decimate:
+                                process_points(points_to_process, keys_to_process)
+                            save_file()
                             logger.info("Finished point cloud saving.")
                             finish_saving_action = False
                         yield scan
@@ -345,40 +356,38 @@ def point_cloud_convert(ctx: SourceCommandContext, filename: str, prefix: str,
                             and not np.array_equal(first_valid_column_pose(scan), np.eye(4))):
                         empty_pose = False
 
-                    points = xyzlut_list[idx](scan)
-                    keys = scan.field(field)
-
                     if scan_idx and scan_idx % 100 == 0:
                         logger.info(f"Processed {scan_idx} lidar scan")
 
                     # to remove out range points
-                    valid_row_index = scan.field(ChanField.RANGE) > 0
-                    out_range_row_index = scan.field(ChanField.RANGE) == 0
-                    dewarped_points = dewarp(points, column_poses)
-                    filtered_points = dewarped_points[valid_row_index]
-                    filtered_keys = keys[valid_row_index]
-
-                    curr_scan_points = dewarped_points.shape[0] * dewarped_points.shape[1]
-                    points_sum += curr_scan_points
-                    points_out_range += np.count_nonzero(out_range_row_index)
-
-                    # may not need below line
-                    shaped_keys = filtered_keys.reshape(filtered_keys.shape[0], 1)
-                    points_to_process = np.append(points_to_process, filtered_points,
-                                                  axis=0)
-                    keys_to_process = np.append(keys_to_process, shaped_keys, axis=0)
+                    valid_pixels = scan.field(ChanField.RANGE).ravel() > 0
+                    points_sum += valid_pixels.size
+                    points_out_range += valid_pixels.size - np.count_nonzero(valid_pixels)
+
+                    if decimate:
+                        filtered_points = cartesian_dewarp(scan, xyzlut_list[idx],
+                                                           compact=True)
+                        filtered_keys = scan.field(field).ravel()[valid_pixels]
+                        points_to_process = np.append(points_to_process, filtered_points,
+                                                      axis=0)
+                        keys_to_process = np.append(keys_to_process, filtered_keys)
+                    else:
+                        # projected, dewarped and filtered on a worker thread
+                        current_writer().write(scan, xyzlut_list[idx], field,
+                                               z_low, z_high)
 
                     # downsample the accumulated point clouds #
                     if scan_idx % down_sample_steps == 0:
-                        process_points(points_to_process, keys_to_process)
-                        points_to_process = np.empty(shape=[0, 3])
-                        keys_to_process = np.empty(shape=[0, 1])
+                        if decimate:
+                            process_points(points_to_process, keys_to_process)
+                            points_to_process = np.empty(shape=[0, 3])
+                            keys_to_process = np.empty(shape=[0])
                         if verbose:
                             pc_status_print()
 
                 # output a file to prevent crash due to oversize #
-                if points_keys_total.shape[0] >= pts_per_file:
-                    save_file(f"{file_wo_ext}-{file_numb:03}", outfile_ext)
+                if writer is not None and writer.points_written() >= pts_per_file:
+                    save_file()
                     file_numb += 1
 
                 yield scans
@@ -399,7 +408,7 @@ def point_cloud_convert(ctx: SourceCommandContext, filename: str, prefix: str,
                 if keys_to_process.size > 0:
                     process_points(points_to_process, keys_to_process)
 
-                save_file(f"{file_wo_ext}-{file_numb:03}", outfile_ext)
+                save_file()
                 logger.info("Finished point cloud saving.")
 
     ctx.scan_iter = convert_iter()
@@ -1,6 +1,6 @@
 import click
 
-from typing import Any, Iterator, Dict, cast
+from typing import Any, Iterator, Dict, Optional, cast
 
 from ouster.sdk import client
 import ouster.sdk._bindings.osf as osf
@@ -354,3 +354,142 @@ def osf_parse(ctx: SourceCommandContext, click_ctx: click.core.Context,
     print(f"SUMMARY: [layout: {orig_layout}] {showed_as_str}")
     print(f"  lidar_scan    (Ls)    count = {ls_cnt}")
     print(f"  other                 count = {other_cnt}")
+
+
+@click.command
+@click.argument("output", required=True)
+@click.option('-f', '--fields', default="",
+              help="Comma separated fields of the scans to keep, all if not given.")
+@click.option('-e', '--encoder', default="png", show_default=True,
+              type=click.Choice(['png', 'zstd']), help="Encoder of the scans.")
+@click.option("--compression-level", default=None, type=int,
+              help="Compression level of the encoder, its default if not given.")
+@click.option('-t', '--threads', default=0, type=click.IntRange(0),
+              help="Threads to decode and encode the scans on, 0 for the default pool.")
+@click.option('--overwrite', is_flag=True, default=False, help="If true, overwrite an existing output file.")
+@click.pass_context
+@source_multicommand(type=SourceCommandType.MULTICOMMAND_UNSUPPORTED,
+                     retrieve_click_context=True)
+def osf_transcode(ctx: SourceCommandContext, click_ctx: click.core.Context, output: str,
+                  fields: str, encoder: str, compression_level: Optional[int],
+                  threads: int, overwrite: bool) -> None:
+    """Re-encode the scans of an OSF file to OUTPUT, e.g. dropping fields or
+    changing their compression, decoding and encoding them in parallel.
+    Messages other than lidar scans are not copied."""
+    import os
+    from .source_save import _file_exists_error
+
+    file = ctx.source_uri or ""
+    if os.path.isfile(output) and not overwrite:
+        raise click.ClickException(_file_exists_error(output))
+
+    if encoder == "zstd":
+        scan_encoder = (osf.ZstdLidarScanEncoder() if compression_level is None
+                        else osf.ZstdLidarScanEncoder(compression_level))
+    else:
+        scan_encoder = osf.PngLidarScanEncoder(1 if compression_level is None else compression_level)
+
+    options = osf.TranscodeOptions()
+    options.fields = [f.strip() for f in fields.split(",") if f.strip()]
+    options.encoder = osf.Encoder(scan_encoder, osf.ThreadPool(threads) if threads else None)
+    size = osf.transcode_osf_file(file, output, options)
+    click.echo(f"Transcoded {file} to {output} ({size} bytes)")
+
+
+@click.command
+@click.argument("output", required=True)
+@click.option('--chunk-size', default=16, show_default=True, type=click.IntRange(1),
+              help="Chunk size of the compacted file in MiB.")
+@click.option('--interleave', is_flag=True, default=False,
+              help="Interleave the chunks of the streams by time rather than grouping them by stream.")
+@click.option('-e', '--encoder', default=None, type=click.Choice(['png', 'zstd']),
+              help="Re-encode the scans, keeping only the lidar scans; copied still encoded if not given.")
+@click.option("--compression-level", default=None, type=int,
+              help="Compression level of the encoder, its default if not given.")
+@click.option('--overwrite', is_flag=True, default=False, help="If true, overwrite an existing output file.")
+@click.pass_context
+@source_multicommand(type=SourceCommandType.MULTICOMMAND_UNSUPPORTED,
+                     retrieve_click_context=True)
+def osf_compact(ctx: SourceCommandContext, click_ctx: click.core.Context, output: str,
+                chunk_size: int, interleave: bool, encoder: Optional[str],
+                compression_level: Optional[int], overwrite: bool) -> None:
+    """Rewrite an OSF file to OUTPUT for reading, in larger chunks grouped by
+    stream and with every message timestamp indexed, e.g. to archive a live
+    recording."""
+    import os
+    from .source_save import _file_exists_error
+
+    file = ctx.source_uri or ""
+    if os.path.isfile(output) and not overwrite:
+        raise click.ClickException(_file_exists_error(output))
+
+    options = osf.CompactOptions()
+    options.chunk_size = chunk_size * 1024 * 1024
+    options.group_streams = not interleave
+    if encoder == "zstd":
+        options.encoder = osf.Encoder(osf.ZstdLidarScanEncoder() if compression_level is None
+                                      else osf.ZstdLidarScanEncoder(compression_level))
+    elif encoder == "png":
+        options.encoder = osf.Encoder(osf.PngLidarScanEncoder(
+            1 if compression_level is None else compression_level))
+    size = osf.compact_osf_file(file, output, options)
+    click.echo(f"Compacted {file} to {output} ({size} bytes)")
+
+
+@click.command
+@click.option('-n', '--scans', default=100, show_default=True, type=click.IntRange(0),
+              help="Scans to measure the fields and encoders on, all if 0.")
+@click.option('-f', '--fields', default="",
+              help="Comma separated fields to measure, all if not given.")
+@click.option('-e', '--encoders', default="png:1,png:6,zstd:1,zstd:3,zstd:9", show_default=True,
+              help="Comma separated candidate encoders as codec:level, codec png or zstd.")
+@click.option('-t', '--threads', default=0, type=click.IntRange(0),
+              help="Threads of the parallel decoding pass, 0 for the default pool.")
+@click.pass_context
+@source_multicommand(type=SourceCommandType.MULTICOMMAND_UNSUPPORTED,
+                     retrieve_click_context=True)
+def osf_bench(ctx: SourceCommandContext, click_ctx: click.core.Context, scans: int,
+              fields: str, encoders: str, threads: int) -> None:
+    """Measure the chunk read bandwidth, CRC cost, per field decoding time and
+    scans per second of an OSF file, and the compression ratio and encoding
+    time of each field with candidate encoders, to pick compression settings.
+    Chunks are read through the page cache, drop it first to measure the
+    disk."""
+    options = osf.BenchOptions()
+    options.scans = scans
+    options.fields = [f.strip() for f in fields.split(",") if f.strip()]
+    candidates = []
+    for candidate in [e.strip() for e in encoders.split(",") if e.strip()]:
+        codec, _, level = candidate.partition(":")
+        if codec not in ("png", "zstd") or not level.lstrip("-").isdigit():
+            raise click.ClickException(f"Invalid encoder '{candidate}', expected png:LEVEL or zstd:LEVEL")
+        candidates.append(osf.BenchEncoder(codec, int(level)))
+    options.encoders = candidates
+    if threads:
+        options.thread_pool = osf.ThreadPool(threads)
+
+    bench = osf.bench_osf_file(ctx.source_uri or "", options)
+
+    def rate(amount: float, seconds: float) -> float:
+        return amount / seconds if seconds > 0 else 0.0
+
+    mib = 1024 * 1024
+    click.echo(f"chunks: {bench.chunks} ({bench.chunk_bytes / mib:.1f} MiB, "
+               f"{bench.invalid_chunks} invalid)")
+    click.echo(f"  read: {rate(bench.chunk_bytes / mib, bench.read_seconds):.1f} MiB/s")
+    click.echo(f"  crc:  {rate(bench.chunk_bytes / mib, bench.crc_seconds):.1f} MiB/s")
+    click.echo(f"scans: {bench.scans}")
+    click.echo(f"  sequential decode: {rate(bench.scans, bench.sequential_seconds):.1f} scans/s")
+    click.echo(f"  parallel decode:   {rate(bench.scans, bench.parallel_seconds):.1f} scans/s")
+    click.echo("field decode:")
+    for d in bench.decode:
+        per_scan_ms = 1000 * rate(d.seconds, d.scans)
+        click.echo(f"  {d.field:<20} {per_scan_ms:8.3f} ms/scan "
+                   f"{rate(d.bytes / mib, d.seconds):8.1f} MiB/s")
+    click.echo("field encode:")
+    click.echo(f"  {'field':<20} {'encoder':<8} {'ratio':>7} {'ms/scan':>9} {'MiB/s':>8}")
+    for e in bench.encode:
+        ratio = rate(e.raw_bytes, e.encoded_bytes)
+        per_scan_ms = 1000 * rate(e.seconds, e.scans)
+        click.echo(f"  {e.field:<20} {e.encoder!r:<8} {ratio:7.2f} {per_scan_ms:9.3f} "
+                   f"{rate(e.raw_bytes / mib, e.seconds):8.1f}")
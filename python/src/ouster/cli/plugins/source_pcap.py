@@ -3,6 +3,7 @@ from datetime import datetime
 import os
 
 import click
+from typing import Optional
 from prettytable import PrettyTable, PLAIN_COLUMNS  # type: ignore
 from textwrap import indent
 
@@ -90,3 +91,89 @@ def pcap_info(ctx: SourceCommandContext, click_ctx: click.core.Context, n: int)
     click.echo(f"Duration:      {duration}")
     click.echo("UDP Streams:")
     print_stream_table(all_infos)
+
+
+@click.command
+@click.argument("output", required=True)
+@click.option('-f', '--fields', default="",
+              help="Comma separated fields of the scans to keep, all if not given.")
+@click.option('-e', '--encoder', default="png", show_default=True,
+              type=click.Choice(['png', 'zstd']), help="Encoder of the scans.")
+@click.option("--compression-level", default=None, type=int,
+              help="Compression level of the encoder, its default if not given.")
+@click.option('-t', '--threads', default=0, type=click.IntRange(0),
+              help="Threads to encode the scans on, 0 for the default pool.")
+@click.option('--overwrite', is_flag=True, default=False, help="If true, overwrite an existing output file.")
+@click.pass_context
+@source_multicommand(type=SourceCommandType.MULTICOMMAND_UNSUPPORTED,
+                     retrieve_click_context=True)
+def pcap_convert(ctx: SourceCommandContext, click_ctx: click.core.Context, output: str,
+                 fields: str, encoder: str, compression_level: Optional[int],
+                 threads: int, overwrite: bool) -> None:
+    """Convert the lidar packets of a pcap file to the scans of the OSF file
+    OUTPUT natively, batching and encoding them in parallel. Scans are
+    timestamped with their first valid packet, as by 'save' by default."""
+    import ouster.sdk.osf as osf
+    from ouster.sdk.pcap import PcapMultiPacketReader
+    from .source_save import _file_exists_error
+
+    file = ctx.source_uri or ""
+    if os.path.isfile(output) and not overwrite:
+        raise click.ClickException(_file_exists_error(output))
+
+    # resolves the metadata and the lidar ports of the sensors
+    packets = PcapMultiPacketReader(file, metadata_paths=ctx.source_options.get("meta"))
+    infos = packets.metadata
+    packets.close()
+
+    if encoder == "zstd":
+        scan_encoder = (osf.ZstdLidarScanEncoder() if compression_level is None
+                        else osf.ZstdLidarScanEncoder(compression_level))
+    else:
+        scan_encoder = osf.PngLidarScanEncoder(1 if compression_level is None else compression_level)
+
+    options = osf.PcapToOsfOptions()
+    options.fields = [f.strip() for f in fields.split(",") if f.strip()]
+    options.encoder = osf.Encoder(scan_encoder, osf.ThreadPool(threads) if threads else None)
+    size = osf.pcap_to_osf(file, infos, output, options)
+    click.echo(f"Converted {file} to {output} ({size} bytes)")
+
+
+@click.command
+@click.option('--dst', default="127.0.0.1", show_default=True, help="Address to send the packets to.")
+@click.option('--port-offset', default=0, type=int,
+              help="Added to the ports of the packets in the pcap to give the ports sent to.")
+@click.option('--speed', default=1.0, show_default=True, type=click.FloatRange(0),
+              help="Times faster than captured to replay, 0 for as fast as possible.")
+@click.option('--loop', 'loops', default=1, show_default=True, type=click.IntRange(0),
+              help="Times to replay the file, 0 to loop until interrupted.")
+@click.pass_context
+@source_multicommand(type=SourceCommandType.MULTICOMMAND_UNSUPPORTED,
+                     retrieve_click_context=True)
+def pcap_replay(ctx: SourceCommandContext, click_ctx: click.core.Context, dst: str,
+                port_offset: int, speed: float, loops: int) -> None:
+    """Replay the lidar and imu packets of each sensor of a pcap file to DST
+    with their captured timing, each stream on its own thread and socket."""
+    from ouster.sdk._bindings.pcap import PcapReplay, ReplayOptions, ReplayStream
+    from ouster.sdk.pcap import PcapMultiPacketReader
+
+    file = ctx.source_uri or ""
+    # resolves the metadata and the ports of the sensors
+    packets = PcapMultiPacketReader(file, metadata_paths=ctx.source_options.get("meta"))
+    ports = sorted({port for info in packets.metadata
+                    for port in (info.config.udp_port_lidar, info.config.udp_port_imu) if port})
+    packets.close()
+
+    options = ReplayOptions()
+    options.speed = speed
+    options.loops = loops
+    replay = PcapReplay(file, [ReplayStream(port, dst, port + port_offset) for port in ports], options)
+    replay.start()
+    try:
+        replay.wait()
+    finally:
+        replay.stop()
+    for port, stats in zip(ports, replay.stats()):
+        click.echo(f"{port} -> {dst}:{port + port_offset}: {stats.packets} packets, "
+                   f"{stats.send_errors} errors, {stats.loops} loops, "
+                   f"{stats.max_lateness} us max lateness")
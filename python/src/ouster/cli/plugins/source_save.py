@@ -25,6 +25,7 @@ from ouster.sdk.pcap.pcap import MTU_SIZE
 import ouster.sdk._bindings.pcap as _pcap
 from .source_util import (SourceCommandContext,
                           SourceCommandType,
+                          SourceCommandCallback,
                           source_multicommand,
                           _join_with_conjunction)
 from contextlib import closing
@@ -395,6 +396,69 @@ def source_to_csv_iter(scan_iter: Iterator[List[Optional[LidarScan]]], infos: Li
 # [doc-etag-pcap-to-csv]
 
 
+# the commands of a chain from a pcap file to an OSF file that can run natively
+_native_commands = {"slice", "clip", "reduce", "save"}
+
+
+def save_osf_natively(callbacks: List[SourceCommandCallback], command_names: List[str],
+                      uri: str, meta: Optional[Tuple[str, ...]],
+                      field_names: Optional[List[str]]) -> bool:
+    """Run a chain of built-in commands from a pcap file to an OSF file, e.g.
+    ``source PCAP slice 10:20 clip RANGE :50m save OUT.osf``, entirely in C++
+    with ``osf.pcap_to_osf``, which reads, batches and encodes the scans on
+    threads of their own. Returns False, having done nothing, if the chain
+    needs the python pipeline."""
+    if io_type(uri) != OusterIoType.PCAP or "," in uri:
+        return False
+    if not set(command_names) <= _native_commands or command_names[-1] != "save":
+        return False
+    if len(set(command_names)) != len(command_names) or "reduce" in command_names[1:]:
+        return False
+    params = {name: c.params for name, c in zip(command_names, callbacks)}
+    save = params["save"]
+    if save.get("format", "").lower() != "osf" or save.get("ts") != "packet":
+        return False
+
+    # resolves the metadata and the lidar ports of the sensors
+    packets = PcapMultiPacketReader(uri, metadata_paths=meta)
+    infos = packets.metadata
+    packets.close()
+
+    ops = osf.ScanOps()
+    if "slice" in params:
+        start, stop, step, frame_based = params["slice"]["indices"]
+        # slices are of collated frames, which are scans only for one sensor
+        if not frame_based or len(infos) > 1:
+            return False
+        ops.start = start
+        ops.stop = stop or 0
+        ops.step = step or 1
+    if "clip" in params:
+        lower, upper = params["clip"]["indices"]
+        ops.clip_fields = params["clip"]["fields"].strip().split(",")
+        ops.clip_lower = lower or 0
+        ops.clip_upper = upper if upper else float("inf")
+        ops.clip_invalid = params["clip"]["out_of_range_value"]
+    if "reduce" in params:
+        ops.beams = int(params["reduce"]["beams"])
+
+    filename = determine_filename(filename=save["filename"], info=infos[0], extension=".osf",
+                                  prefix=save["prefix"], dir=save["dir"])
+    create_directories_if_missing(filename)
+    if os.path.isfile(filename) and not save["overwrite"]:
+        click.echo(_file_exists_error(filename))
+        exit(1)
+    click.echo(f"Saving OSF file at {filename}")
+
+    options = osf.PcapToOsfOptions()
+    options.fields = field_names or []
+    options.encoder = osf.Encoder(osf.PngLidarScanEncoder(save["compression_level"]))
+    options.ops = ops
+    options.stop_on_backwards_ts = not save["continue_anyways"]
+    osf.pcap_to_osf(uri, infos, filename, options)
+    return True
+
+
 # Determines the filename to use
 def determine_filename(prefix: str, dir: str, filename: str, extension: str, info: SensorInfo):
     outpath = Path.cwd()
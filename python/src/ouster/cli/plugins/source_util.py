@@ -4,7 +4,7 @@ from ouster.sdk.client import LidarScan, MultiScanSource
 from typing import (Callable, List, Any, Union,
                     Dict, Optional, Iterator)
 from threading import Event
-from dataclasses import dataclass
+from dataclasses import dataclass, field
 import queue
 import click
 
@@ -57,6 +57,8 @@ class SourceCommandContext:
 class SourceCommandCallback:
     callback_fn: Callable[[SourceCommandContext], None]
     type: SourceCommandType
+    # the parameters the command was invoked with, to plan a native pipeline
+    params: Dict[str, Any] = field(default_factory=dict)
 
 
 def source_multicommand(type: SourceCommandType = SourceCommandType.MULTICOMMAND_UNSUPPORTED,
@@ -66,10 +68,11 @@ def source_multicommand(type: SourceCommandType = SourceCommandType.MULTICOMMAND
         def callback_wrapped(click_ctx: click.core.Context, *args, **kwargs):
             # Extract ctx.obj: SourceCommandContext from click context
             if not retrieve_click_context:
-                return SourceCommandCallback(lambda ctx: fn(ctx, *args, **kwargs), type)  # type: ignore
+                return SourceCommandCallback(lambda ctx: fn(ctx, *args, **kwargs), type,  # type: ignore
+                                             dict(kwargs))
             else:
                 return SourceCommandCallback(
-                        lambda ctx: fn(ctx, click_ctx, *args, **kwargs), type)  # type: ignore
+                        lambda ctx: fn(ctx, click_ctx, *args, **kwargs), type, dict(kwargs))  # type: ignore
         return callback_wrapped
     return source_multicommand_wrapper
 
@@ -16,7 +16,7 @@ Note:
 
 import numpy as np
 from numpy import ndarray
-from typing import (Any, ClassVar, Dict, Iterator, List, Optional, overload, Tuple, Union)
+from typing import (Any, Callable, ClassVar, Dict, Iterable, Iterator, List, Optional, overload, Tuple, Union)
 
 from ouster.sdk.client.data import (BufferT, ColHeader, FieldDType, FieldTypes)
 
@@ -286,6 +286,79 @@ class SensorHttp:
     @staticmethod
     def create(hostname: str, timeout_sec: int = LONG_HTTP_REQUEST_TIMEOUT_SECONDS) -> SensorHttp:
         ...
+
+
+class HttpResponse:
+    @property
+    def status(self) -> int:
+        ...
+
+    @property
+    def body(self) -> str:
+        ...
+
+    @property
+    def error(self) -> str:
+        ...
+
+    def ok(self) -> bool:
+        ...
+
+
+class MultiSensorHttp:
+    def __init__(self, hostnames: List[str]) -> None:
+        ...
+
+    def get(self, url: str, timeout_sec: int = ...) -> List[HttpResponse]:
+        ...
+
+    @property
+    def hostnames(self) -> List[str]:
+        ...
+
+
+class DiscoveredSensor:
+    @property
+    def address(self) -> str:
+        ...
+
+    @property
+    def hostname(self) -> str:
+        ...
+
+    @property
+    def sn(self) -> int:
+        ...
+
+    @property
+    def prod_line(self) -> str:
+        ...
+
+    @property
+    def image_rev(self) -> str:
+        ...
+
+    @property
+    def status(self) -> str:
+        ...
+
+    @property
+    def sensor_info(self) -> str:
+        ...
+
+    @property
+    def error(self) -> str:
+        ...
+
+    def ok(self) -> bool:
+        ...
+
+
+def discover_sensors(timeout_sec: float = ..., http_timeout_sec: int = ...,
+                     interface_address: str = ...,
+                     on_sensor: Optional[Callable[[DiscoveredSensor], None]] = ...
+                     ) -> List[DiscoveredSensor]:
+    ...
  
 
 class ClientState:
@@ -998,6 +1071,18 @@ def init_logger(log_level: str,
     ...
 
 
+def tracing_compiled() -> bool:
+    ...
+
+
+def start_trace_file(path: str) -> None:
+    ...
+
+
+def stop_trace() -> None:
+    ...
+
+
 def set_config(hostname: str,
                config: SensorConfig,
                persist: bool = ...,
@@ -1027,6 +1112,272 @@ class Sensor:
         ...
 
 
+class LatencyStats:
+    count: int
+    min: int
+    max: int
+    mean: float
+    p50: int
+    p90: int
+    p99: int
+    p999: int
+
+    def __init__(self) -> None:
+        ...
+
+
+class ClientStats:
+    buffer_dropped_packets: int
+    kernel_dropped_packets: int
+    lidar_packets: int
+    imu_packets: int
+    buffer_depth: int
+    max_buffer_depth: int
+    delivery_latency: LatencyStats
+    buffer_thread_cpu_seconds: float
+
+    def __init__(self) -> None:
+        ...
+
+
+class ScanSourceStats:
+    buffer_dropped_packets: int
+    kernel_dropped_packets: int
+    dropped_scans: int
+    id_errors: int
+    missing_frames: List[int]
+    batched_packets: List[int]
+    batched_scans: List[int]
+    incomplete_scans: List[int]
+    scans: int
+    queue_depth: int
+    max_queue_depth: int
+    batch_latency: LatencyStats
+    queue_latency: LatencyStats
+    scan_latency: LatencyStats
+    batch_thread_cpu_seconds: List[float]
+    clients: List[ClientStats]
+    clocks: List[ClockEstimate]
+
+    def __init__(self) -> None:
+        ...
+
+
+class ClockEstimate:
+    valid: bool
+    sensor_ts: int
+    offset_ns: int
+    skew_ppm: float
+    intervals: int
+    residual_ns: float
+    resets: int
+
+    def __init__(self) -> None:
+        ...
+
+
+class ClockModel:
+
+    def __init__(self,
+                 window_sec: float = ...,
+                 intervals: int = ...,
+                 reset_sec: float = ...) -> None:
+        ...
+
+    @overload
+    def add(self, sensor_ts: int, host_ts: int) -> None:
+        ...
+
+    @overload
+    def add(self, scan: LidarScan) -> None:
+        ...
+
+    def estimate(self) -> ClockEstimate:
+        ...
+
+    @overload
+    def to_host(self, sensor_ts: int) -> int:
+        ...
+
+    @overload
+    def to_host(self, sensor_ts: ndarray) -> ndarray:
+        ...
+
+    def reset(self) -> None:
+        ...
+
+
+HOST_TIMESTAMP_FIELD: str
+
+
+class OpenMetrics:
+    content_type: ClassVar[str]
+
+    def __init__(self) -> None:
+        ...
+
+    def counter(self, name: str, help: str, value: float, labels: Dict[str, str] = ...) -> None:
+        ...
+
+    def gauge(self, name: str, help: str, value: float, labels: Dict[str, str] = ...) -> None:
+        ...
+
+    def summary(self, name: str, help: str, stats: LatencyStats, labels: Dict[str, str] = ...) -> None:
+        ...
+
+
+@overload
+def add_metrics(metrics: OpenMetrics, stats: ScanSourceStats, infos: List[SensorInfo],
+                labels: Dict[str, str] = ...) -> None:
+    ...
+
+
+@overload
+def add_metrics(metrics: OpenMetrics, stats: ClientStats, labels: Dict[str, str] = ...) -> None:
+    ...
+
+
+class MissingColumns:
+    frame_id: int
+    first: int
+    last: int
+
+    def __init__(self) -> None:
+        ...
+
+
+class PacketStreamStats:
+    lidar_packets: int
+    imu_packets: int
+    invalid_packets: int
+    frames: int
+    incomplete_frames: int
+    missing_columns: int
+    missing_frames: int
+    late_packets: int
+    reordered_packets: int
+    duplicate_columns: int
+    timestamp_regressions: int
+    reinits: int
+    lidar_interarrival: LatencyStats
+    lidar_jitter: LatencyStats
+    imu_interarrival: LatencyStats
+    imu_jitter: LatencyStats
+    lidar_rate: float
+    min_lidar_rate: float
+    max_lidar_rate: float
+    expected_lidar_rate: float
+    imu_rate: float
+    min_imu_rate: float
+    max_imu_rate: float
+    expected_imu_rate: float
+    missing_ranges: List[MissingColumns]
+
+    def __init__(self) -> None:
+        ...
+
+
+class PacketStreamAnalyzer:
+    def __init__(self, info: SensorInfo, max_missing_ranges: int = ...) -> None:
+        ...
+
+    def __call__(self, packet: Packet) -> None:
+        ...
+
+    def flush(self) -> None:
+        ...
+
+    def reset(self) -> None:
+        ...
+
+    def stats(self) -> PacketStreamStats:
+        ...
+
+
+@overload
+def add_metrics(metrics: OpenMetrics, stats: PacketStreamStats, labels: Dict[str, str] = ...) -> None:
+    ...
+
+
+class RelayDestination:
+    host: str
+    lidar_port: int
+    imu_port: int
+    source: int
+
+    def __init__(self,
+                 host: str,
+                 lidar_port: int = ...,
+                 imu_port: int = ...,
+                 source: int = ...) -> None:
+        ...
+
+
+class PacketRelayOptions:
+    batch_size: int
+    multicast_ttl: int
+    multicast_interface: str
+    multicast_loop: bool
+    shm_name: str
+    shm_slots: int
+
+    def __init__(self) -> None:
+        ...
+
+
+class RelayDestinationStats:
+    @property
+    def packets(self) -> int:
+        ...
+
+    @property
+    def bytes(self) -> int:
+        ...
+
+    @property
+    def errors(self) -> int:
+        ...
+
+
+class PacketRelayStats:
+    @property
+    def lidar_packets(self) -> int:
+        ...
+
+    @property
+    def imu_packets(self) -> int:
+        ...
+
+    @property
+    def batches(self) -> int:
+        ...
+
+    @property
+    def shm_packets(self) -> int:
+        ...
+
+    @property
+    def destinations(self) -> List[RelayDestinationStats]:
+        ...
+
+
+class PacketRelay:
+    def __init__(self,
+                 infos: List[SensorInfo],
+                 destinations: List[RelayDestination],
+                 options: PacketRelayOptions = ...) -> None:
+        ...
+
+    def start(self, client: SensorClient) -> None:
+        ...
+
+    def stop(self) -> None:
+        ...
+
+    def stats(self) -> PacketRelayStats:
+        ...
+
+
 class SensorClient:
     @overload
     def __init__(self, sensors: List[Sensor], config_timeout: float = ..., buffer_time: float = ...) -> None:
@@ -1048,6 +1399,12 @@ class SensorClient:
     def dropped_packets(self) -> int:
         ...
 
+    def stats(self) -> ClientStats:
+        ...
+
+    def enable_latency_stats(self, enable: bool = ...) -> None:
+        ...
+
     def get_sensor_info(self) -> List[SensorInfo]:
         ...
 
@@ -1080,6 +1437,12 @@ class SensorScanSource:
     def dropped_scans(self) -> int:
         ...
 
+    def stats(self) -> ScanSourceStats:
+        ...
+
+    def enable_latency_stats(self, enable: bool = ...) -> None:
+        ...
+
     def close(self) -> None:
         ...
 
@@ -1234,6 +1597,12 @@ class LidarScan:
     def packet_count(self) -> int:
         ...
 
+    def content_hash(self) -> int:
+        ...
+
+    def field_hash(self, name: str) -> int:
+        ...
+
     @property
     def fields(self) -> Iterator[str]:
         ...
@@ -1246,52 +1615,62 @@ class LidarScan:
 
 
 def destagger_int8(field: ndarray, shifts: List[int],
-                   inverse: bool) -> ndarray:
+                   inverse: bool,
+                   out: Optional[ndarray] = ...) -> ndarray:
     ...
 
 
 def destagger_int16(field: ndarray, shifts: List[int],
-                    inverse: bool) -> ndarray:
+                    inverse: bool,
+                    out: Optional[ndarray] = ...) -> ndarray:
     ...
 
 
 def destagger_int32(field: ndarray, shifts: List[int],
-                    inverse: bool) -> ndarray:
+                    inverse: bool,
+                    out: Optional[ndarray] = ...) -> ndarray:
     ...
 
 
 def destagger_int64(field: ndarray, shifts: List[int],
-                    inverse: bool) -> ndarray:
+                    inverse: bool,
+                    out: Optional[ndarray] = ...) -> ndarray:
     ...
 
 
 def destagger_uint8(field: ndarray, shifts: List[int],
-                    inverse: bool) -> ndarray:
+                    inverse: bool,
+                    out: Optional[ndarray] = ...) -> ndarray:
     ...
 
 
 def destagger_uint16(field: ndarray, shifts: List[int],
-                     inverse: bool) -> ndarray:
+                     inverse: bool,
+                     out: Optional[ndarray] = ...) -> ndarray:
     ...
 
 
 def destagger_uint32(field: ndarray, shifts: List[int],
-                     inverse: bool) -> ndarray:
+                     inverse: bool,
+                     out: Optional[ndarray] = ...) -> ndarray:
     ...
 
 
 def destagger_uint64(field: ndarray, shifts: List[int],
-                     inverse: bool) -> ndarray:
+                     inverse: bool,
+                     out: Optional[ndarray] = ...) -> ndarray:
     ...
 
 
 def destagger_float(field: ndarray, shifts: List[int],
-                    inverse: bool) -> ndarray:
+                    inverse: bool,
+                    out: Optional[ndarray] = ...) -> ndarray:
     ...
 
 
 def destagger_double(field: ndarray, shifts: List[int],
-                     inverse: bool) -> ndarray:
+                     inverse: bool,
+                     out: Optional[ndarray] = ...) -> ndarray:
     ...
 
 
@@ -1317,64 +1696,301 @@ class ScanBatcher:
         ...
 
 
-class XYZLut:
-    def __init__(self, info: SensorInfo, use_extrinsics: bool) -> None:
+class ReframeWindow:
+    width: int
+    start_col: int
+    period_ns: int
+    offset_ns: int
+
+    def __init__(self,
+                 width: int = ...,
+                 start_col: int = ...,
+                 period_ns: int = ...,
+                 offset_ns: int = ...) -> None:
         ...
 
-    @overload
-    def __call__(self, scan: LidarScan) -> ndarray:
+
+class ReframingBatcher:
+    def __init__(self, info: SensorInfo, window: ReframeWindow = ...) -> None:
         ...
 
-    @overload
-    def __call__(self, range: ndarray) -> ndarray:
+    def __call__(self, packet: LidarPacket, ls: LidarScan) -> bool:
         ...
 
+    def finish_scan(self, ls: LidarScan) -> bool:
+        ...
 
-class AutoExposure:
-    @overload
-    def __init__(self) -> None:
+    @property
+    def scan_width(self) -> int:
         ...
 
-    @overload
-    def __init__(self, lo_percentile: float, hi_percentile: float,
-                 update_every: int) -> None:
+    @property
+    def window(self) -> ReframeWindow:
         ...
 
-    def __call__(self,
-                 image: ndarray,
-                 update_state: Optional[bool] = True) -> None:
+    @property
+    def dropped_columns(self) -> int:
         ...
 
 
-class BeamUniformityCorrector:
-    def __init__(self) -> None:
+class ShmScanWriter:
+    @overload
+    def __init__(self,
+                 name: str,
+                 w: int,
+                 h: int,
+                 fields: List[FieldType],
+                 slots: int = ...,
+                 columns_per_packet: int = ...,
+                 metadata: str = ...) -> None:
         ...
 
-    def __call__(self, image: ndarray) -> None:
+    @overload
+    def __init__(self,
+                 name: str,
+                 info: SensorInfo,
+                 fields: List[FieldType] = ...,
+                 slots: int = ...) -> None:
         ...
 
+    def publish(self, scan: LidarScan) -> None:
+        ...
 
-class FieldInfo:
     @property
-    def ty_tag(self) -> FieldDType:
+    def published(self) -> int:
         ...
 
-    def __init__(self, ty_tag: FieldDType, offset: int, mask: int, shift: int) -> None:
+    @property
+    def field_types(self) -> List[FieldType]:
         ...
 
-    offset: int
-    mask: int
-    shift: int
 
+class ShmScanReader:
+    def __init__(self, name: str) -> None:
+        ...
 
-def add_custom_profile(profile_nr: int,
-                       name: str,
-                       fields: List[Tuple[str, FieldInfo]],
-                       chan_data_size: int) -> None:
-    ...
+    def next(self) -> bool:
+        ...
 
+    def valid(self) -> bool:
+        ...
 
-@overload
+    def field(self, name: str) -> ndarray:
+        ...
+
+    @property
+    def timestamp(self) -> ndarray:
+        ...
+
+    @property
+    def frame_id(self) -> int:
+        ...
+
+    def scan(self) -> LidarScan:
+        ...
+
+    @property
+    def dropped(self) -> int:
+        ...
+
+    @property
+    def published(self) -> int:
+        ...
+
+    @property
+    def field_types(self) -> List[FieldType]:
+        ...
+
+    @property
+    def metadata(self) -> str:
+        ...
+
+
+class ScanStreamRequest:
+    fields: List[str]
+    decimation: int
+    compress: bool
+    max_range_error: int
+    queue_depth: int
+
+    def __init__(self) -> None:
+        ...
+
+
+class ScanStreamStats:
+    @property
+    def clients(self) -> int:
+        ...
+
+    @property
+    def rejected(self) -> int:
+        ...
+
+    @property
+    def scans_sent(self) -> int:
+        ...
+
+    @property
+    def bytes_sent(self) -> int:
+        ...
+
+    @property
+    def scans_dropped(self) -> int:
+        ...
+
+
+class ScanStreamServer:
+    def __init__(self,
+                 info: SensorInfo,
+                 port: int = ...,
+                 address: str = ...) -> None:
+        ...
+
+    def publish(self, scan: LidarScan) -> int:
+        ...
+
+    def close(self) -> None:
+        ...
+
+    @property
+    def port(self) -> int:
+        ...
+
+    @property
+    def clients(self) -> int:
+        ...
+
+    @property
+    def stats(self) -> ScanStreamStats:
+        ...
+
+
+class ScanStreamClient:
+    def __init__(self,
+                 host: str,
+                 port: int,
+                 request: ScanStreamRequest = ...,
+                 timeout_sec: float = ...) -> None:
+        ...
+
+    @property
+    def sensor_info(self) -> SensorInfo:
+        ...
+
+    def get_scan(self, timeout_sec: float = ...) -> Optional[LidarScan]:
+        ...
+
+    @property
+    def closed(self) -> bool:
+        ...
+
+    def close(self) -> None:
+        ...
+
+
+class ScanPrefetcher:
+    def __init__(self, source: Iterable[Any], depth: int = ...) -> None:
+        ...
+
+    def __iter__(self) -> ScanPrefetcher:
+        ...
+
+    def __next__(self) -> Any:
+        ...
+
+    def close(self) -> None:
+        ...
+
+    @property
+    def depth(self) -> int:
+        ...
+
+
+class CollatedScans:
+    def __init__(self,
+                 source: Iterable[Tuple[int, Packet]],
+                 metadata: List[SensorInfo],
+                 fields: List[List[FieldType]] = ...,
+                 dt: int = ...,
+                 complete: bool = ...,
+                 depth: int = ...) -> None:
+        ...
+
+    def __iter__(self) -> CollatedScans:
+        ...
+
+    def __next__(self) -> List[Optional[LidarScan]]:
+        ...
+
+    def close(self) -> None:
+        ...
+
+
+class XYZLut:
+    def __init__(self, info: SensorInfo, use_extrinsics: bool) -> None:
+        ...
+
+    @overload
+    def __call__(self, scan: LidarScan,
+                 out: Optional[ndarray] = ...) -> ndarray:
+        ...
+
+    @overload
+    def __call__(self, range: ndarray,
+                 out: Optional[ndarray] = ...) -> ndarray:
+        ...
+
+
+class AutoExposure:
+    @overload
+    def __init__(self) -> None:
+        ...
+
+    @overload
+    def __init__(self, lo_percentile: float, hi_percentile: float,
+                 update_every: int) -> None:
+        ...
+
+    def __call__(self,
+                 image: ndarray,
+                 update_state: Optional[bool] = True) -> None:
+        ...
+
+
+class BeamUniformityCorrector:
+    @overload
+    def __init__(self) -> None:
+        ...
+
+    @overload
+    def __init__(self, update_every: int) -> None:
+        ...
+
+    def __call__(self, image: ndarray) -> None:
+        ...
+
+
+class FieldInfo:
+    @property
+    def ty_tag(self) -> FieldDType:
+        ...
+
+    def __init__(self, ty_tag: FieldDType, offset: int, mask: int, shift: int) -> None:
+        ...
+
+    offset: int
+    mask: int
+    shift: int
+
+
+def add_custom_profile(profile_nr: int,
+                       name: str,
+                       fields: List[Tuple[str, FieldInfo]],
+                       chan_data_size: int) -> None:
+    ...
+
+
+@overload
 def get_field_types(info: SensorInfo) -> List[FieldType]: ...
 
 
@@ -1416,11 +2032,730 @@ def parse_and_validate_metadata(metadata: str) -> Tuple[SensorInfo, ValidatorIss
 def parse_and_validate_sensor_config(metadata: str) -> Tuple[SensorConfig, ValidatorIssues]:
     ...
 
-def dewarp(points: ndarray, poses: ndarray) -> ndarray:
+def dewarp(points: ndarray,
+           poses: ndarray,
+           out: Optional[ndarray] = ...) -> ndarray:
+    ...
+
+
+def transform(points: ndarray,
+              pose: ndarray,
+              out: Optional[ndarray] = ...) -> ndarray:
+    ...
+
+
+def cartesian_dewarp(scan: LidarScan,
+                     lut: XYZLut,
+                     extrinsic: ndarray = ...,
+                     compact: bool = ...) -> ndarray:
+    ...
+
+
+class TrajectoryEvaluator:
+    def __init__(self, timestamps: List[float], poses: ndarray) -> None:
+        ...
+
+    def poses_at(self, ts: ndarray) -> ndarray:
+        ...
+
+    def pose_scan(self, scan: LidarScan, col_ts: Optional[ndarray] = ...) -> None:
+        ...
+
+    @property
+    def timestamps(self) -> List[float]:
+        ...
+
+
+class DeskewInput:
+    def __init__(self, luts: List[XYZLut]) -> None:
+        ...
+
+    def build(self, scans: List[Optional[LidarScan]], ts_offsets: List[int]) -> int:
+        ...
+
+    @property
+    def points(self) -> ndarray:
+        ...
+
+    @property
+    def times(self) -> ndarray:
+        ...
+
+    def column_times(self, sensor: int) -> ndarray:
+        ...
+
+    @property
+    def sensors_count(self) -> int:
+        ...
+
+
+class FusedCloud:
+    @property
+    def points(self) -> ndarray:
+        ...
+
+    @property
+    def sensor_ids(self) -> Optional[ndarray]:
+        ...
+
+    @property
+    def fields(self) -> List[ndarray]:
+        ...
+
+    @property
+    def frame(self) -> int:
+        ...
+
+    def __len__(self) -> int:
+        ...
+
+
+class FusedCloudBuilder:
+    def __init__(self,
+                 luts: List[XYZLut],
+                 extrinsics: List[ndarray] = ...,
+                 fields: List[str] = ...,
+                 sensor_ids: bool = ...,
+                 compact: bool = ...,
+                 ring_size: int = ...) -> None:
+        ...
+
+    def build(self, scans: List[Optional[LidarScan]]) -> FusedCloud:
+        ...
+
+    @property
+    def latest(self) -> FusedCloud:
+        ...
+
+    @property
+    def fields(self) -> List[str]:
+        ...
+
+    @property
+    def sensors_count(self) -> int:
+        ...
+
+    @property
+    def ring_size(self) -> int:
+        ...
+
+
+class CellState:
+    UNKNOWN: ClassVar[CellState]
+    FREE: ClassVar[CellState]
+    OCCUPIED: ClassVar[CellState]
+
+    __members__: ClassVar[Dict[str, CellState]]
+
+    def __init__(self, value: int) -> None:
+        ...
+
+    def __int__(self) -> int:
+        ...
+
+    @property
+    def name(self) -> str:
+        ...
+
+    @property
+    def value(self) -> int:
+        ...
+
+
+class GridLayout:
+    rows: int
+    cols: int
+    resolution: float
+    min_z: float
+    max_z: float
+    min_hits: int
+
+    def __init__(self) -> None:
+        ...
+
+
+class OccupancyGrid:
+    @property
+    def state(self) -> ndarray:
+        ...
+
+    @property
+    def height(self) -> ndarray:
+        ...
+
+    @property
+    def hits(self) -> ndarray:
+        ...
+
+    @property
+    def free(self) -> ndarray:
+        ...
+
+    @property
+    def frame(self) -> int:
+        ...
+
+
+class OccupancyGridBuilder:
+    def __init__(self,
+                 luts: List[XYZLut],
+                 extrinsics: List[ndarray] = ...,
+                 layout: GridLayout = ...) -> None:
+        ...
+
+    def build(self, scans: List[Optional[LidarScan]]) -> OccupancyGrid:
+        ...
+
+    @property
+    def latest(self) -> OccupancyGrid:
+        ...
+
+    @property
+    def layout(self) -> GridLayout:
+        ...
+
+    @property
+    def sensors_count(self) -> int:
+        ...
+
+
+class ScanGateOptions:
+    stride: int
+    min_range_change: int
+    min_changed_fraction: float
+    keyframe_interval: float
+    min_angular_velocity: float
+    min_accel_change: float
+
+    def __init__(self) -> None:
+        ...
+
+
+class SkippedSpan:
+    first_frame_id: int
+    last_frame_id: int
+    first_ts: int
+    last_ts: int
+    count: int
+
+    def __init__(self) -> None:
+        ...
+
+
+class ScanGate:
+    def __init__(self, options: ScanGateOptions = ...) -> None:
+        ...
+
+    def admit(self, scan: LidarScan, imu: Optional[ImuBatch] = ...) -> bool:
+        ...
+
+    @property
+    def last_change(self) -> float:
+        ...
+
+    @property
+    def kept(self) -> int:
+        ...
+
+    @property
+    def skipped(self) -> int:
+        ...
+
+    @property
+    def skipped_spans(self) -> List[SkippedSpan]:
+        ...
+
+    @property
+    def options(self) -> ScanGateOptions:
+        ...
+
+    def reset(self) -> None:
+        ...
+
+
+class ColumnDewarper:
+    def __init__(self,
+                 lut: XYZLut,
+                 w: int,
+                 h: int,
+                 source: Union[TrajectoryEvaluator, Callable[[ndarray], ndarray]],
+                 extrinsic: ndarray = ...) -> None:
+        ...
+
+    def dewarp(self, scan: LidarScan, first: int, last: int) -> None:
+        ...
+
+    @property
+    def points(self) -> ndarray:
+        ...
+
+    @property
+    def poses(self) -> ndarray:
+        ...
+
+
+class ImuPreintegrator:
+    def __init__(self,
+                 imu_to_sensor_transform: ndarray = ...,
+                 init_samples: int = ...,
+                 history: float = ...) -> None:
+        ...
+
+    def add(self, packet: ImuPacket) -> None:
+        ...
+
+    def add_sample(self, ts: int, accel: ndarray, gyro: ndarray) -> None:
+        ...
+
+    def add_batch(self, batch: ImuBatch) -> None:
+        ...
+
+    @property
+    def initialized(self) -> bool:
+        ...
+
+    def reset(self, keep_bias: bool = ...) -> None:
+        ...
+
+    def set_bias(self, gyro: ndarray, accel: ndarray) -> None:
+        ...
+
+    @property
+    def gyro_bias(self) -> ndarray:
+        ...
+
+    @property
+    def accel_bias(self) -> ndarray:
+        ...
+
+    @property
+    def velocity(self) -> ndarray:
+        ...
+
+    @velocity.setter
+    def velocity(self, velocity: ndarray) -> None:
+        ...
+
+    def poses_at(self, ts: ndarray) -> ndarray:
+        ...
+
+    def pose_scan(self, scan: LidarScan) -> None:
+        ...
+
+
+class ImuBatch:
+    def __init__(self) -> None:
+        ...
+
+    def __len__(self) -> int:
+        ...
+
+    @property
+    def ts(self) -> ndarray:
+        ...
+
+    @property
+    def accel_ts(self) -> ndarray:
+        ...
+
+    @property
+    def accel(self) -> ndarray:
+        ...
+
+    @property
+    def gyro(self) -> ndarray:
+        ...
+
+    @property
+    def column(self) -> ndarray:
+        ...
+
+
+class ImuBatcher:
+    def __init__(self, capacity: int = ...) -> None:
+        ...
+
+    def __call__(self, packet: ImuPacket) -> None:
+        ...
+
+    def add_sample(self,
+                   ts: int,
+                   accel: ndarray,
+                   gyro: ndarray,
+                   accel_ts: int = ...) -> None:
+        ...
+
+    def batch(self, scan: LidarScan, out: ImuBatch) -> int:
+        ...
+
+    @property
+    def pending(self) -> int:
+        ...
+
+    @property
+    def dropped(self) -> int:
+        ...
+
+    def reset(self) -> None:
+        ...
+
+
+class VoxelPolicy:
+    FIRST: ClassVar[VoxelPolicy]
+    CENTROID: ClassVar[VoxelPolicy]
+    RANDOM: ClassVar[VoxelPolicy]
+
+    __members__: ClassVar[Dict[str, VoxelPolicy]]
+
+    def __init__(self, value: int) -> None:
+        ...
+
+    def __int__(self) -> int:
+        ...
+
+    @property
+    def name(self) -> str:
+        ...
+
+    @property
+    def value(self) -> int:
+        ...
+
+
+@overload
+def voxel_downsample(points: ndarray,
+                     voxel_size: float,
+                     policy: VoxelPolicy = ...,
+                     seed: int = ...) -> Tuple[ndarray, ndarray, ndarray]:
+    ...
+
+
+@overload
+def voxel_downsample(scan: LidarScan,
+                     lut: XYZLut,
+                     voxel_size: float,
+                     policy: VoxelPolicy = ...,
+                     seed: int = ...) -> Tuple[ndarray, ndarray, ndarray]:
+    ...
+
+
+def range_percentiles(range: ndarray,
+                      start_pct: float,
+                      end_pct: float) -> Tuple[int, int]:
+    ...
+
+
+class PointCloudFormat:
+    PLY: ClassVar[PointCloudFormat]
+    PCD: ClassVar[PointCloudFormat]
+    LAS: ClassVar[PointCloudFormat]
+
+    __members__: ClassVar[Dict[str, PointCloudFormat]]
+
+    def __init__(self, value: int) -> None:
+        ...
+
+    def __int__(self) -> int:
+        ...
+
+    @property
+    def name(self) -> str:
+        ...
+
+    @property
+    def value(self) -> int:
+        ...
+
+
+class PointCloudWriter:
+    def __init__(self,
+                 filename: str,
+                 format: PointCloudFormat,
+                 key_name: str = ...,
+                 key_scale: float = ...,
+                 threads: int = ...) -> None:
+        ...
+
+    @overload
+    def write(self, points: ndarray, keys: ndarray) -> None:
+        ...
+
+    @overload
+    def write(self,
+              scan: LidarScan,
+              lut: XYZLut,
+              key_field: str,
+              min_z: float = ...,
+              max_z: float = ...) -> None:
+        ...
+
+    def flush(self) -> None:
+        ...
+
+    def close(self) -> None:
+        ...
+
+    def points_written(self) -> int:
+        ...
+
+    @property
+    def is_open(self) -> bool:
+        ...
+
+    def __enter__(self) -> PointCloudWriter:
+        ...
+
+    def __exit__(self, *args) -> None:
+        ...
+
+
+class MapTileStore:
+    @overload
+    def __init__(self,
+                 filename: str,
+                 tile_size: float,
+                 voxel_size: float,
+                 levels: int = ...,
+                 max_tiles: int = ...) -> None:
+        ...
+
+    @overload
+    def __init__(self, filename: str, max_tiles: int = ...) -> None:
+        ...
+
+    def append(self, points: ndarray) -> None:
+        ...
+
+    def flush(self) -> None:
+        ...
+
+    def tiles(self) -> List[Tuple[int, int, int]]:
+        ...
+
+    def tiles_in(self, min: ndarray, max: ndarray) -> List[Tuple[int, int, int]]:
+        ...
+
+    def tile_points(self, key: Tuple[int, int, int], level: int = ...) -> ndarray:
+        ...
+
+    def query(self, min: ndarray, max: ndarray, level: int = ...) -> ndarray:
+        ...
+
+    @property
+    def tile_size(self) -> float:
+        ...
+
+    @property
+    def voxel_size(self) -> float:
+        ...
+
+    @property
+    def levels(self) -> int:
+        ...
+
+    @property
+    def tiles_in_memory(self) -> int:
+        ...
+
+    def __enter__(self) -> MapTileStore:
+        ...
+
+    def __exit__(self, *args) -> None:
+        ...
+
+
+class VoxelMapIndex:
+    def __init__(self, filename: str) -> None:
+        ...
+
+    @staticmethod
+    def build(filename: str, points: ndarray, voxel_size: float) -> None:
+        ...
+
+    def nearest(self, queries: ndarray, max_distance: float) -> Tuple[ndarray, ndarray]:
+        ...
+
+    @property
+    def voxel_size(self) -> float:
+        ...
+
+    def __len__(self) -> int:
+        ...
+
+
+class MapLocalizerConfig:
+    max_correspondence_distance: float
+    kernel_scale: float
+    max_iterations: int
+    convergence: float
+    voxel_size: float
+
+    def __init__(self) -> None:
+        ...
+
+
+class MapLocalizer:
+    def __init__(self,
+                 index: VoxelMapIndex,
+                 initial_pose: ndarray = ...,
+                 config: MapLocalizerConfig = ...) -> None:
+        ...
+
+    def update(self,
+               points: ndarray,
+               times: ndarray = ...,
+               motion: Optional[ndarray] = ...) -> ndarray:
+        ...
+
+    @property
+    def pose(self) -> ndarray:
+        ...
+
+    @pose.setter
+    def pose(self, pose: ndarray) -> None:
+        ...
+
+    @property
+    def last_motion(self) -> ndarray:
+        ...
+
+    @property
+    def last_correspondences(self) -> int:
+        ...
+
+
+def min_filter(img: ndarray,
+               rows: int,
+               cols: int,
+               ignore_zeros: bool = ...,
+               wrap_columns: bool = ...) -> ndarray:
+    ...
+
+
+def max_filter(img: ndarray,
+               rows: int,
+               cols: int,
+               ignore_zeros: bool = ...,
+               wrap_columns: bool = ...) -> ndarray:
+    ...
+
+
+def median_filter(img: ndarray,
+                  rows: int,
+                  cols: int,
+                  ignore_zeros: bool = ...,
+                  wrap_columns: bool = ...) -> ndarray:
+    ...
+
+
+def range_image_normals(scan: LidarScan,
+                        lut: XYZLut,
+                        window: int = ...,
+                        max_distance: float = ...) -> ndarray:
+    ...
+
+
+def connected_components(range: ndarray,
+                         max_step: int,
+                         wrap_columns: bool = ...) -> ndarray:
+    ...
+
+
+def cartesian_compact(scan: LidarScan,
+                      lut: XYZLut,
+                      min_range: int = ...,
+                      max_range: int = ...,
+                      min_reflectivity: int = ...) -> Tuple[ndarray, ndarray]:
+    ...
+
+
+class ReturnSelection:
+    STRONGEST: ClassVar[ReturnSelection]
+    NEAREST: ClassVar[ReturnSelection]
+    FARTHEST: ClassVar[ReturnSelection]
+    BOTH: ClassVar[ReturnSelection]
+
+    __members__: ClassVar[Dict[str, ReturnSelection]]
+
+    def __init__(self, value: int) -> None:
+        ...
+
+    def __int__(self) -> int:
+        ...
+
+    @property
+    def name(self) -> str:
+        ...
+
+    @property
+    def value(self) -> int:
+        ...
+
+
+def select_returns(scan: LidarScan,
+                   selection: ReturnSelection,
+                   out: LidarScan) -> None:
+    ...
+
+
+def cartesian_returns(scan: LidarScan,
+                      lut: XYZLut,
+                      selection: ReturnSelection = ...,
+                      min_range: int = ...,
+                      max_range: int = ...,
+                      min_reflectivity: int = ...) -> Tuple[ndarray, ndarray]:
+    ...
+
+
+def stack_field(scans: List[LidarScan],
+                name: str,
+                shifts: List[int] = ...,
+                out: Optional[ndarray] = ...) -> ndarray:
+    ...
+
+
+def cartesian_batch(scans: List[LidarScan],
+                    lut: XYZLut,
+                    out: Optional[ndarray] = ...,
+                    dtype: Any = ...) -> ndarray:
+    ...
+
+
+def clip_fields(scan: LidarScan,
+                fields: List[str],
+                lower: float,
+                upper: float,
+                invalid: float = ...) -> None:
+    ...
+
+
+def mask_fields(scan: LidarScan, fields: List[str], mask: ndarray) -> None:
+    ...
+
+
+def convert_array(src: ndarray,
+                  dtype: Any,
+                  scale: float = ...,
+                  offset: float = ...,
+                  out: Optional[ndarray] = ...) -> ndarray:
+    ...
+
+
+def compare_array(src: ndarray,
+                  op: str,
+                  value: float,
+                  out: Optional[ndarray] = ...) -> ndarray:
+    ...
+
+
+def threshold_array(arr: ndarray,
+                    lower: float,
+                    upper: float,
+                    invalid: float = ...) -> None:
     ...
 
 
-def transform(points: ndarray, pose: ndarray) -> ndarray:
+def reduce_by_factor(scan: LidarScan, factor: int) -> LidarScan:
     ...
 
 
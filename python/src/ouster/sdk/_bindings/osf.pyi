@@ -1,23 +1,90 @@
 """Super initial osf typings, too rough yet ..."""
 
-from typing import Any, ClassVar, List
+from typing import Any, ClassVar, Dict, List, Optional, Tuple
 
 from typing import (overload, Iterator)
 import numpy
 
-from ouster.sdk.client import BufferT, LidarScan, SensorInfo, FieldType
+from ouster.sdk.client import BufferT, LidarScan, Packet, SensorInfo, FieldType, LatencyStats, OpenMetrics
+from ouster.sdk.client import ScanGateOptions, SkippedSpan
 
 
 class LidarScanEncoder:
     ...
 
 
+class PngFilter:
+    DEFAULT: ClassVar[PngFilter]
+    NONE: ClassVar[PngFilter]
+    SUB: ClassVar[PngFilter]
+    UP: ClassVar[PngFilter]
+    AVG: ClassVar[PngFilter]
+    PAETH: ClassVar[PngFilter]
+
+
+class PngStrategy:
+    DEFAULT: ClassVar[PngStrategy]
+    FILTERED: ClassVar[PngStrategy]
+    HUFFMAN_ONLY: ClassVar[PngStrategy]
+    RLE: ClassVar[PngStrategy]
+
+
 class PngLidarScanEncoder(LidarScanEncoder):
-    def __init__(self, compression_amount: int) -> None:
+    def __init__(self, compression_amount: int, filter: PngFilter = ...,
+                 strategy: PngStrategy = ...) -> None:
+        ...
+
+class ZstdLidarScanEncoder(LidarScanEncoder):
+    def __init__(self, compression_level: int = ...) -> None:
+        ...
+
+class BandedLidarScanEncoder(LidarScanEncoder):
+    def __init__(self, encoder: LidarScanEncoder,
+                 band_rows: int = ...) -> None:
+        ...
+
+class SparseLidarScanEncoder(LidarScanEncoder):
+    def __init__(self, encoder: LidarScanEncoder) -> None:
+        ...
+
+class LossyLidarScanEncoder(LidarScanEncoder):
+    def __init__(self, encoder: LidarScanEncoder,
+                 max_errors: Dict[str, int] = ...) -> None:
+        ...
+
+class ThreadPool:
+    def __init__(self, threads: int = ...) -> None:
         ...
 
+    def size(self) -> int:
+        ...
+
+def set_default_thread_pool(pool: Optional[ThreadPool]) -> None:
+    ...
+
+
+class ReadAheadOptions:
+    scans: int
+    chunks: int
+    thread_pool: Optional[ThreadPool]
+    def __init__(self) -> None: ...
+
+
+class ScanReadAhead:
+    def __init__(self, reader: Reader, stream_ids: List[int], start_ts: int, end_ts: int,
+                 fields: List[str] = ..., options: ReadAheadOptions = ...) -> None: ...
+    def __iter__(self) -> ScanReadAhead: ...
+    def __next__(self) -> Tuple[int, int, Optional[LidarScan]]: ...
+
 class Encoder:
-    def __init__(self, lidar_scan_encoder: LidarScanEncoder) -> None:
+    keyframe_interval: int
+
+    def __init__(self, lidar_scan_encoder: LidarScanEncoder,
+                 thread_pool: Optional[ThreadPool] = ...) -> None:
+        ...
+
+    def set_lidar_scan_encoder(self, stream_index: int,
+                               lidar_scan_encoder: LidarScanEncoder) -> None:
         ...
 
 class LidarScanStreamMeta:
@@ -56,12 +123,26 @@ class Extrinsics(MetadataEntry):
     def name(self) -> str: ...
 
 
+class RecordingGaps(MetadataEntry):
+    type_id: ClassVar[str] = ...  # read-only
+    def __init__(self, spans: List[SkippedSpan], kept: int = ..., ref_meta_id: int = ...) -> None: ...
+    @property
+    def spans(self) -> List[SkippedSpan]: ...
+    @property
+    def kept(self) -> int: ...
+    @property
+    def skipped(self) -> int: ...
+    @property
+    def ref_meta_id(self) -> int: ...
+
+
 class MessageRef:
     def __init__(self, *args, **kwargs) -> None: ...
     @overload
     def decode(self) -> object: ...
     @overload
     def decode(self, fields: List[str]) -> object: ...
+    def decode_into(self, scan: LidarScan, fields: List[str] = ...) -> bool: ...
     def of(self, arg0: object) -> bool: ...
     @property
     def id(self) -> int: ...
@@ -69,6 +150,8 @@ class MessageRef:
     def ts(self) -> int: ...
     @property
     def buffer(self) -> BufferT: ...
+    @property
+    def view(self) -> numpy.ndarray: ...
 
 
 
@@ -97,8 +180,43 @@ class MetadataStore:
     def __len__(self) -> int: ...
 
 
+class FileBackend:
+    DEFAULT: ClassVar[FileBackend]
+    MMAP: ClassVar[FileBackend]
+    STREAM: ClassVar[FileBackend]
+    PREAD: ClassVar[FileBackend]
+    HTTP: ClassVar[FileBackend]
+
+
+class FileOptions:
+    backend: FileBackend
+    read_ahead: int
+    sequential: bool
+    timeout_seconds: int
+    lazy_open: bool
+    def __init__(self) -> None: ...
+
+
+class ReaderCacheOptions:
+    chunk_bytes: int
+    scan_bytes: int
+    def __init__(self) -> None: ...
+
+
+class StreamIndex:
+    stream_id: int
+    message_count: int
+    timestamps: numpy.ndarray
+    chunk_offsets: numpy.ndarray
+    chunk_message_starts: numpy.ndarray
+    def chunk_offset(self, message_idx: int) -> int: ...
+
+
 class Reader:
+    @overload
     def __init__(self, arg0: str) -> None: ...
+    @overload
+    def __init__(self, file: str, options: FileOptions) -> None: ...
     def chunks(self) -> Iterator: ...
     @overload
     def messages(self) -> Iterator: ...
@@ -108,6 +226,7 @@ class Reader:
     def messages(self, stream_ids: List[int]) -> Iterator: ...
     @overload
     def messages(self, stream_ids: List[int], start_ts: int, end_ts: int) -> Iterator: ...
+    def stream_messages(self, stream_ids: List[int], start_ts: int, end_ts: int) -> List[Iterator]: ...
     @property
     def end_ts(self) -> int: ...
     @property
@@ -123,6 +242,34 @@ class Reader:
     @property
     def has_timestamp_idx(self) -> bool: ...
     def ts_by_message_idx(self, stream_id: int, msg_idx: int) -> int: ...
+    def stream_index(self, stream_id: int) -> StreamIndex: ...
+    def collate_messages(self, stream_ids: List[int], dt: int = ...) -> numpy.ndarray: ...
+    def set_cache(self, options: ReaderCacheOptions) -> None: ...
+    def cache_options(self) -> ReaderCacheOptions: ...
+
+
+class MultiReader:
+    def __init__(self, files: List[str], options: FileOptions = ...) -> None: ...
+    @staticmethod
+    def from_manifest(manifest: str, options: FileOptions = ...) -> MultiReader: ...
+    @property
+    def sharded(self) -> bool: ...
+    def __len__(self) -> int: ...
+    def filename(self, file_idx: int) -> str: ...
+    def reader(self, file_idx: int) -> Reader: ...
+    @property
+    def start_ts(self) -> int: ...
+    @property
+    def end_ts(self) -> int: ...
+    @overload
+    def messages(self) -> Iterator: ...
+    @overload
+    def messages(self, start_ts: int, end_ts: int) -> Iterator: ...
+    @overload
+    def messages(self, stream_ids: List[int], start_ts: int, end_ts: int) -> Iterator: ...
+    def chunks(self) -> Iterator: ...
+    def message_count(self, stream_id: int) -> int: ...
+    def ts_by_message_idx(self, stream_id: int, message_idx: int) -> Optional[int]: ...
 
 
 class StreamStats:
@@ -148,6 +295,21 @@ class StreamingInfo(MetadataEntry):
     def stream_stats(self) -> Iterator: ...
 
 
+class ChunkIoOptions:
+    direct: bool
+    background: bool
+    preallocate_bytes: int
+    sync_every_chunk: bool
+    def __init__(self) -> None: ...
+
+
+class ChunkPolicy:
+    max_size: int
+    max_messages: int
+    max_duration: int
+    def __init__(self) -> None: ...
+
+
 class Writer:
     @overload
     def __init__(self, file_name: str, chunk_size: int = ...) -> None: ...
@@ -177,6 +339,20 @@ class Writer:
     @property
     def meta_store(self) -> MetadataStore: ...
     def close(self) -> None: ...
+    def set_chunk_io(self, options: ChunkIoOptions) -> None: ...
+    def chunk_io(self) -> ChunkIoOptions: ...
+    @overload
+    def set_chunk_policy(self, policy: ChunkPolicy) -> None: ...
+    @overload
+    def set_chunk_policy(self, stream_id: int, policy: ChunkPolicy) -> None: ...
+    def set_sensor_chunk_policy(self, stream_index: int, policy: ChunkPolicy) -> None: ...
+    def set_scan_gate(self, options: ScanGateOptions) -> None: ...
+    def save_packet(self, stream_index: int, packet: Packet) -> None: ...
+    def set_packet_compression(self, level: int) -> None: ...
+    def set_columnar(self, stream_index: int, columnar: bool = ...) -> None: ...
+    def columnar(self, stream_index: int) -> bool: ...
+    def chunk_policy(self, stream_id: int) -> ChunkPolicy: ...
+    checkpoint_interval: int
     def is_closed(self) -> bool: ...
     def __enter__(self) -> Writer: ...
     def __exit__(*args) -> None: ...
@@ -187,9 +363,33 @@ class FutureWrapper:
         ...
 
 
+class AsyncWriterStats:
+    written: int
+    dropped: int
+    spilled: int
+    spill_backlog: int
+    in_flight_bytes: int
+    in_flight: int
+    max_in_flight: int
+    encode_latency: LatencyStats
+    write_latency: LatencyStats
+    save_latency: LatencyStats
+    save_thread_cpu_seconds: float
+
+
+def add_metrics(metrics: OpenMetrics, stats: AsyncWriterStats, labels: Dict[str, str] = ...) -> None:
+    ...
+
+
 class AsyncWriter:
+    class OverflowPolicy:
+        BLOCK: ClassVar[AsyncWriter.OverflowPolicy]
+        DROP: ClassVar[AsyncWriter.OverflowPolicy]
+        SPILL: ClassVar[AsyncWriter.OverflowPolicy]
+
     def __init__(self, filename: str, info: List[SensorInfo],
-                 fields_to_write: List[str] = ..., chunk_size: int = ..., encoder: Encoder = ...) -> None: ...
+                 fields_to_write: List[str] = ..., chunk_size: int = ..., encoder: Encoder = ...,
+                 max_in_flight: int = ..., overflow: AsyncWriter.OverflowPolicy = ...) -> None: ...
     @overload
     def save(self, stream_id: int, scan: LidarScan) -> FutureWrapper: ...
     @overload
@@ -197,6 +397,17 @@ class AsyncWriter:
     @overload
     def save(self, scan: List[LidarScan]) -> List[FutureWrapper]: ...
     def close(self) -> None: ...
+    def dropped(self) -> int: ...
+    def spilled(self) -> int: ...
+    def set_memory_limit(self, bytes: int) -> None: ...
+    def set_spill_file(self, path: str) -> None: ...
+    def stats(self) -> AsyncWriterStats: ...
+    def enable_latency_stats(self, enable: bool = ...) -> None: ...
+    def set_chunk_io(self, options: ChunkIoOptions) -> None: ...
+    def set_checkpoint_interval(self, chunks: int) -> None: ...
+    def set_chunk_policy(self, policy: ChunkPolicy) -> None: ...
+    def set_sensor_chunk_policy(self, stream_index: int, policy: ChunkPolicy) -> None: ...
+    def set_scan_gate(self, options: ScanGateOptions) -> None: ...
     def __enter__(self) -> AsyncWriter: ...
     def __exit__(*args) -> None: ...
 
@@ -216,3 +427,119 @@ def parse_and_print(file: str, with_decoding: bool = ...) -> None: ...
 def backup_osf_file_metablob(file: str, backup_file_name: str) -> None: ...
 def restore_osf_file_metablob(file: str, backup_file_name: str) -> None: ...
 def osf_file_modify_metadata(file: str, new_metadata: List[SensorInfo]) -> int: ...
+def recover_osf_file(file_name: str) -> int: ...
+def slice_osf_file(file_name: str,
+                   output_file_name: str,
+                   start_ts: int,
+                   end_ts: int,
+                   stream_ids: List[int] = ...) -> int: ...
+def merge_osf_files(file_names: List[str], output_file_name: str) -> int: ...
+
+class ScanOps:
+    start: int
+    stop: int
+    step: int
+    beams: int
+    clip_fields: List[str]
+    clip_lower: float
+    clip_upper: float
+    clip_invalid: float
+    def __init__(self) -> None: ...
+
+class TranscodeOptions:
+    fields: List[str]
+    encoder: Optional[Encoder]
+    chunk_size: int
+    max_in_flight: int
+    ops: ScanOps
+    def __init__(self) -> None: ...
+
+def transcode_osf_file(file_name: str,
+                       output_file_name: str,
+                       options: TranscodeOptions = ...) -> int: ...
+
+class CompactOptions:
+    chunk_size: int
+    group_streams: bool
+    encoder: Optional[Encoder]
+    def __init__(self) -> None: ...
+
+def compact_osf_file(file_name: str,
+                     output_file_name: str,
+                     options: CompactOptions = ...) -> int: ...
+
+class PcapToOsfOptions:
+    fields: List[str]
+    encoder: Optional[Encoder]
+    chunk_size: int
+    max_in_flight: int
+    queue_size: int
+    ops: ScanOps
+    stop_on_backwards_ts: bool
+    def __init__(self) -> None: ...
+
+def pcap_to_osf(pcap_file: str,
+                infos: List[SensorInfo],
+                output_file_name: str,
+                options: PcapToOsfOptions = ...) -> int: ...
+
+class BenchEncoder:
+    codec: str
+    level: int
+    def __init__(self, codec: str = ..., level: int = ...) -> None: ...
+
+class BenchOptions:
+    scans: int
+    fields: List[str]
+    encoders: List[BenchEncoder]
+    thread_pool: Optional[ThreadPool]
+    def __init__(self) -> None: ...
+
+class FieldDecodeBench:
+    @property
+    def field(self) -> str: ...
+    @property
+    def scans(self) -> int: ...
+    @property
+    def bytes(self) -> int: ...
+    @property
+    def seconds(self) -> float: ...
+
+class FieldEncodeBench:
+    @property
+    def field(self) -> str: ...
+    @property
+    def encoder(self) -> BenchEncoder: ...
+    @property
+    def scans(self) -> int: ...
+    @property
+    def raw_bytes(self) -> int: ...
+    @property
+    def encoded_bytes(self) -> int: ...
+    @property
+    def seconds(self) -> float: ...
+
+class OsfBench:
+    @property
+    def chunks(self) -> int: ...
+    @property
+    def chunk_bytes(self) -> int: ...
+    @property
+    def read_seconds(self) -> float: ...
+    @property
+    def crc_seconds(self) -> float: ...
+    @property
+    def invalid_chunks(self) -> int: ...
+    @property
+    def decode(self) -> List[FieldDecodeBench]: ...
+    @property
+    def encode(self) -> List[FieldEncodeBench]: ...
+    @property
+    def scans(self) -> int: ...
+    @property
+    def sequential_seconds(self) -> float: ...
+    @property
+    def parallel_seconds(self) -> float: ...
+
+def bench_osf_file(file_name: str,
+                   options: BenchOptions = ...) -> OsfBench: ...
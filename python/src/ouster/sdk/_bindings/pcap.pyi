@@ -5,9 +5,13 @@ All rights reserved.
 Type annotations for pcap python bindings.
 """
 
-from typing import (Dict, overload, List, Callable)
+from typing import (Dict, overload, List, Callable, Tuple, Union)
+
+from numpy import ndarray
 
 from ouster.sdk.client.data import BufferT
+from ouster.sdk._bindings.client import (LidarPacket, ImuPacket, LidarScan,
+                                         ScanBatcher, SensorInfo)
 
 
 class playback_handle:
@@ -52,6 +56,20 @@ def get_stream_info(file: str, progress_callback: Callable[[int, int], int],
     pass
 
 
+class stream_sampling:
+    windows: int
+    packets_per_window: int
+    stable_windows: int
+
+    def __init__(self) -> None:
+        ...
+
+
+def get_stream_info_sampled(file: str,
+                            sampling: stream_sampling = ...) -> stream_info:
+    ...
+
+
 class packet_info:
 
     def __init__(self) -> None:
@@ -99,17 +117,118 @@ class PcapIndex:
     def frame_id_indices(self) -> List[Dict[int, int]]:
         ...
 
+    @property
+    def frame_indices(self) -> List[ndarray]:
+        ...
+
+    @property
+    def frame_timestamps(self) -> List[ndarray]:
+        ...
+
+    @property
+    def frame_ids(self) -> List[ndarray]:
+        ...
+
     def frame_count(self, int) -> int:
         ...
 
+    def frame_at_timestamp(self, sensor_index: int, ts: int) -> int:
+        ...
+
+class AsyncPcapWriterOptions:
+    use_sll_encapsulation: bool
+    mtu: int
+    buffer_packets: int
+    write_batch: int
+    rotate_bytes: int
+    rotate_interval: float  # seconds
+
+    def __init__(self) -> None:
+        ...
+
+
+class AsyncPcapWriterStats:
+    packets: int
+    records: int
+    bytes: int
+    dropped: int
+    write_errors: int
+    files: int
+
+
+class AsyncPcapWriter:
+
+    def __init__(self, file: str,
+                 options: AsyncPcapWriterOptions = ...) -> None:
+        ...
+
+    def write_packet(self, src_ip: str, dst_ip: str, src_port: int,
+                     dst_port: int, buf: BufferT, timestamp: float) -> bool:
+        ...
+
+    def flush(self) -> None:
+        ...
+
+    def close(self) -> None:
+        ...
+
+    def stats(self) -> AsyncPcapWriterStats:
+        ...
+
+    def files(self) -> List[str]:
+        ...
+
+
+class IpReassemblyStats:
+    fragments: int
+    reassembled: int
+    timed_out: int
+    evicted: int
+    malformed: int
+    in_progress: int
+    capacity: int
+    memory: int
+
+
+class PacketBatch:
+    data: ndarray
+    entries: ndarray
+    id_errors: int
+    size_errors: int
+
+    def __init__(self) -> None:
+        ...
+
+    def __len__(self) -> int:
+        ...
+
+    def packet(self, i: int) -> Union[LidarPacket, ImuPacket]:
+        ...
+
+    def batch_scans(self, batchers: List[ScanBatcher], scans: List[LidarScan],
+                    start: int = ...) -> Tuple[int, int]:
+        ...
+
+
 class IndexedPcapReader:
 
     def __init__(self, filename: str, metadata_filename: List[str]) -> None:
         ...
 
+    @overload
     def build_index(self) -> None:
         ...
 
+    @overload
+    def build_index(self, index_filename: str) -> bool:
+        ...
+
+    def save_index(self, index_filename: str) -> bool:
+        ...
+
+    def build_index_parallel(self, num_threads: int = 0) -> None:
+        ...
+
     def next_packet(self) -> int:
         ...
 
@@ -119,9 +238,18 @@ class IndexedPcapReader:
     def current_data(self) -> BufferT:
         ...
 
+    def read_batch(self, batch: PacketBatch, max_packets: int = ...) -> int:
+        ...
+
     def get_index(self) -> PcapIndex:
         ...
 
+    def seek_to_time(self, sensor_index: int, ts: int) -> int:
+        ...
+
+    def reassembly_stats(self) -> IpReassemblyStats:
+        ...
+
     def seek(self, int) -> None:
         ...
 
@@ -129,6 +257,83 @@ class IndexedPcapReader:
         ...
 
 
+class BagPacketReader:
+    sensor_infos: List[SensorInfo]
+    lidar_topics: List[str]
+    start_time: int
+    end_time: int
+
+    def __init__(self, filename: str, sensor_infos: List[SensorInfo] = ...,
+                 soft_id_check: bool = ...) -> None:
+        ...
+
+    @staticmethod
+    def readable(filename: str) -> bool:
+        ...
+
+    def read_batch(self, batch: PacketBatch, max_packets: int = ...) -> int:
+        ...
+
+    def reset(self) -> None:
+        ...
+
+    def seek_to_time(self, ts: int) -> None:
+        ...
+
+
+class ReplayStream:
+    pcap_dst_port: int
+    dst_ip: str
+    dst_port: int
+    src_ip: str
+    src_port: int
+
+    def __init__(self, pcap_dst_port: int, dst_ip: str, dst_port: int = ...,
+                 src_ip: str = ..., src_port: int = ...) -> None:
+        ...
+
+
+class ReplayOptions:
+    speed: float
+    loops: int
+    batch_size: int
+    spin: int  # microseconds
+
+    def __init__(self) -> None:
+        ...
+
+
+class ReplayStats:
+    packets: int
+    bytes: int
+    send_errors: int
+    batches: int
+    loops: int
+    max_lateness: int  # microseconds
+
+
+class PcapReplay:
+
+    def __init__(self, file: str, streams: List[ReplayStream],
+                 options: ReplayOptions = ...) -> None:
+        ...
+
+    def start(self) -> None:
+        ...
+
+    def wait(self) -> None:
+        ...
+
+    def stop(self) -> None:
+        ...
+
+    def running(self) -> bool:
+        ...
+
+    def stats(self) -> List[ReplayStats]:
+        ...
+
+
 def replay_initialize(file_name: str) -> playback_handle:
     ...
 
@@ -5,11 +5,11 @@ All rights reserved.
 Type annotations for viz python bindings.
 """
 
-from typing import Callable, overload, Tuple, List, ClassVar, Optional
+from typing import Callable, overload, Tuple, List, ClassVar, Optional, Dict
 
 import numpy as np
 
-from ouster.sdk.client import SensorInfo
+from ouster.sdk.client import SensorInfo, LidarScan, LatencyStats
 
 calref_palette: np.ndarray
 spezia_palette: np.ndarray
@@ -50,6 +50,11 @@ class EventModifierKeys:
     MOD_NUM_LOCK: ClassVar[EventModifierKeys]
     ...
 
+class KeyNormalization:
+    AUTO_EXPOSURE: ClassVar[KeyNormalization]
+    EQUALIZATION: ClassVar[KeyNormalization]
+    ...
+
 class WindowCtx:
 
     @property
@@ -179,12 +184,22 @@ class Cloud:
     def __init__(self, si: SensorInfo) -> None:
         ...
 
+    @overload
     def set_range(self, range: np.ndarray) -> None:
         ...
 
+    @overload
+    def set_range(self, range: np.ndarray, first_col: int,
+                  num_cols: int) -> None:
+        ...
+
     def set_key(self, key: np.ndarray) -> None:
      ...
 
+    def set_key_raw(self, key: np.ndarray,
+                    normalization: KeyNormalization = ...) -> None:
+     ...
+
     def set_mask(self, mask: np.ndarray) -> None:
         ...
 
@@ -212,6 +227,163 @@ class Cloud:
         ...
 
 
+class LodCloud:
+
+    def __init__(self, chunk_size: float = ...,
+                 point_budget: int = ...) -> None:
+        ...
+
+    def add_points(self, xyz: np.ndarray,
+                   key: Optional[np.ndarray] = ...) -> None:
+        ...
+
+    def clear_points(self) -> None:
+        ...
+
+    def set_point_budget(self, point_budget: int) -> None:
+        ...
+
+    def set_pose(self, pose: np.ndarray) -> None:
+        ...
+
+    def set_point_size(self, size: float) -> None:
+        ...
+
+    def set_palette(self, palette: np.ndarray) -> None:
+        ...
+
+    @property
+    def size(self) -> int:
+        ...
+
+
+class MapAccumulatorConfig:
+    select_ratio: float
+    voxel_size: float
+    max_points: int
+    overflow_from_start: bool
+    chunk_size: float
+    point_budget: int
+
+    def __init__(self) -> None:
+        ...
+
+
+class MapAccumulator:
+
+    def __init__(self, sensors: List[SensorInfo],
+                 config: MapAccumulatorConfig = ...) -> None:
+        ...
+
+    def update(self, sensor_idx: int, scan: LidarScan,
+               keys: Dict[str, np.ndarray] = ...) -> None:
+        ...
+
+    def set_key_name(self, name: str) -> None:
+        ...
+
+    @property
+    def key_name(self) -> str:
+        ...
+
+    def clear(self) -> None:
+        ...
+
+    @property
+    def size(self) -> int:
+        ...
+
+    def cloud(self) -> LodCloud:
+        ...
+
+
+class FieldViewMode:
+    name: str
+    fields: List[str]
+    image_names: List[str]
+    auto_exposure: bool
+    beam_uniformity: bool
+    scale: float
+    gpu_keys: bool
+    calref_palette: bool
+    rgb: bool
+
+    def __init__(self) -> None:
+        ...
+
+
+def default_view_mode(info: SensorInfo, scan: LidarScan,
+                      field: str) -> Optional[FieldViewMode]:
+    ...
+
+
+class LidarScanVizStats:
+    @property
+    def submitted(self) -> int:
+        ...
+
+    @property
+    def computed(self) -> int:
+        ...
+
+    @property
+    def skipped(self) -> int:
+        ...
+
+    @property
+    def applied(self) -> int:
+        ...
+
+    @property
+    def compute(self) -> LatencyStats:
+        ...
+
+
+class LidarScanViz:
+
+    def __init__(self, sensors: List[SensorInfo]) -> None:
+        ...
+
+    @property
+    def sensor_count(self) -> int:
+        ...
+
+    def cloud(self, sensor: int, return_num: int) -> Cloud:
+        ...
+
+    def image(self, sensor: int, index: int) -> Image:
+        ...
+
+    def add_mode(self, mode: FieldViewMode) -> None:
+        ...
+
+    def cloud_modes(self) -> List[str]:
+        ...
+
+    def image_modes(self) -> List[str]:
+        ...
+
+    cloud_mode: str
+
+    def set_image_mode(self, index: int, name: str) -> None:
+        ...
+
+    def image_mode(self, index: int) -> str:
+        ...
+
+    def submit(self, scans: List[Optional[LidarScan]]) -> None:
+        ...
+
+    def apply(self) -> bool:
+        ...
+
+    def wait(self, timeout_sec: float = ...) -> bool:
+        ...
+
+    def stats(self) -> LidarScanVizStats:
+        ...
+
+
 class Image:
 
     def __init__(self) -> None:
@@ -291,13 +463,47 @@ class Label:
         ...
 
 
+class FrameStats:
+
+    class Section:
+        @property
+        def name(self) -> str:
+            ...
+
+        @property
+        def cpu_ms(self) -> float:
+            ...
+
+        @property
+        def gpu_ms(self) -> float:
+            ...
+
+    @property
+    def frame(self) -> int:
+        ...
+
+    @property
+    def cpu_ms(self) -> float:
+        ...
+
+    @property
+    def gpu_ms(self) -> float:
+        ...
+
+    @property
+    def sections(self) -> List[FrameStats.Section]:
+        ...
+
+
 class PointViz:
 
     def __init__(self,
                  name: str,
                  fix_aspect: bool = ...,
                  window_width: int = ...,
-                 window_height: int = ...) -> None:
+                 window_height: int = ...,
+                 headless: bool = ...,
+                 share: Optional[PointViz] = ...) -> None:
         ...
 
     def run(self) -> None:
@@ -334,6 +540,24 @@ class PointViz:
     def pop_frame_buffer_handler(self) -> None:
         ...
 
+    def set_frame_sink(self,
+                       sink: Optional[Callable[[np.ndarray], None]],
+                       buffer_frames: int = ...) -> None:
+        ...
+
+    @property
+    def dropped_frames(self) -> int:
+        ...
+
+    def enable_frame_stats(self, state: bool) -> None:
+        ...
+
+    def show_frame_stats(self, state: bool) -> None:
+        ...
+
+    def frame_stats(self) -> FrameStats:
+        ...
+
     def push_mouse_button_handler(
         self,
         f: Callable[[WindowCtx, MouseButton, MouseButtonEvent, EventModifierKeys], bool]
@@ -365,6 +589,20 @@ class PointViz:
     def camera(self) -> Camera:
         ...
 
+    def add_viewport(self, x0: float, y0: float, x1: float,
+                     y1: float) -> int:
+        ...
+
+    @property
+    def viewport_count(self) -> int:
+        ...
+
+    def viewport_camera(self, index: int) -> Camera:
+        ...
+
+    def clear_viewports(self) -> None:
+        ...
+
     @property
     def target_display(self) -> TargetDisplay:
         ...
@@ -389,6 +627,10 @@ class PointViz:
     def add(self, cloud: Cloud) -> None:
         ...
 
+    @overload
+    def add(self, cloud: LodCloud) -> None:
+        ...
+
     @overload
     def add(self, image: Image) -> None:
         ...
@@ -405,6 +647,10 @@ class PointViz:
     def remove(self, cloud: Cloud) -> bool:
         ...
 
+    @overload
+    def remove(self, cloud: LodCloud) -> bool:
+        ...
+
     @overload
     def remove(self, image: Image) -> bool:
         ...
@@ -4,6 +4,8 @@ from ouster.sdk.client import PacketMultiSource
 
 from threading import Lock
 import logging
+import os
+import ouster.sdk._bindings.pcap as _pcap
 from ouster.sdk.client import SensorInfo, PacketFormat, PacketValidationFailure, LidarPacket, ImuPacket, Packet
 
 from pathlib import Path
@@ -39,6 +41,9 @@ class BagPacketSource(PacketMultiSource):
                  soft_id_check: bool = False):
         """Read sensor data streams from a single bag file.
 
+        Indexed ROS1 bags with uncompressed chunks are read natively, other
+        bags, e.g. ROS2 ones, with rosbags.
+
         Args:
             bag_path: path to bag file or folder containing ROS2 db3 and yaml file
             meta: optional list of metadata files to load, if not provided metadata
@@ -51,9 +56,21 @@ class BagPacketSource(PacketMultiSource):
         self._size_error_count = 0
         self._lock = Lock()
         self._reset = False
-        self._typestore = get_typestore(Stores.ROS2_FOXY)
         self._bag_path = bag_path
+        self._native = os.path.isfile(bag_path) and _pcap.BagPacketReader.readable(bag_path)
+
+        if self._native:
+            infos = []
+            if meta is not None:
+                for m in meta:
+                    with open(m, 'r') as file:
+                        infos.append(SensorInfo(file.read()))
+            self._reader = _pcap.BagPacketReader(bag_path, infos, soft_id_check)
+            self._metadata = list(self._reader.sensor_infos)
+            self._pf = [PacketFormat(m) for m in self._metadata]
+            return
 
+        self._typestore = get_typestore(Stores.ROS2_FOXY)
         msg_text = """
         uint8[] buf
         """
@@ -111,11 +128,44 @@ class BagPacketSource(PacketMultiSource):
             pf = PacketFormat(m)
             self._pf.append(pf)
 
+    @property
+    def _batchable(self) -> bool:
+        """Whether packets can be read with ``_batches``."""
+        return self._native
+
+    def _batches(self, max_packets: int = 256) -> Iterator[_pcap.PacketBatch]:
+        """Read the sensor packets of a ROS1 bag natively in batches, from the
+        start of the bag.
+
+        The same batch is read into at every step, so it is only valid until
+        the next one.
+        """
+        with self._lock:
+            if self._reader is not None:
+                self._reader.reset()
+        batch = _pcap.PacketBatch()
+        while True:
+            with self._lock:
+                if self._reader is None:
+                    break
+                count = self._reader.read_batch(batch, max_packets)
+            self._id_error_count += batch.id_errors
+            self._size_error_count += batch.size_errors
+            if not count:
+                break
+            yield batch
+
     def __iter__(self) -> Iterator[Tuple[int, Packet]]:
         with self._lock:
             if self._reader is None:
                 raise ValueError("I/O operation on closed packet source")
 
+        if self._batchable:
+            for batch in self._batches():
+                for i, idx in enumerate(batch.entries["sensor_idx"].tolist()):
+                    yield (idx, batch.packet(i))
+            return
+
         self._reset = True
         while self._reset:
             self._reset = False
@@ -194,12 +244,15 @@ class BagPacketSource(PacketMultiSource):
     def restart(self) -> None:
         """Restart playback, only relevant to non-live sources"""
         with self._lock:
+            if self._native and self._reader is not None:
+                self._reader.reset()
             self._reset = True
 
     def close(self) -> None:
         """Release Pcap resources. Thread-safe."""
         with self._lock:
-            self._reader.close()
+            if self._reader is not None and not self._native:
+                self._reader.close()
             self._reader = None  # type: ignore
 
     @property
@@ -20,12 +20,17 @@ from ouster.sdk._bindings.client import UDPProfileIMU
 from ouster.sdk._bindings.client import SensorConfig
 from ouster.sdk._bindings.client import SensorCalibration
 from ouster.sdk._bindings.client import SensorHttp
+from ouster.sdk._bindings.client import HttpResponse, MultiSensorHttp
+from ouster.sdk._bindings.client import DiscoveredSensor, discover_sensors
 from ouster.sdk._bindings.client import ShotLimitingStatus
 from ouster.sdk._bindings.client import ThermalShutdownStatus
 from ouster.sdk._bindings.client import FieldClass
 from ouster.sdk._bindings.client import FullScaleRange
 from ouster.sdk._bindings.client import ReturnOrder
 from ouster.sdk._bindings.client import init_logger
+from ouster.sdk._bindings.client import tracing_compiled
+from ouster.sdk._bindings.client import start_trace_file
+from ouster.sdk._bindings.client import stop_trace
 from ouster.sdk._bindings.client import get_config
 from ouster.sdk._bindings.client import set_config
 from ouster.sdk._bindings.client import FieldType
@@ -39,15 +44,44 @@ from ouster.sdk._bindings.client import PacketFormat
 from ouster.sdk._bindings.client import PacketWriter
 from ouster.sdk._bindings.client import SensorHttp
 from ouster.sdk._bindings.client import SensorClient
+from ouster.sdk._bindings.client import RelayDestination, PacketRelayOptions, PacketRelay
+from ouster.sdk._bindings.client import RelayDestinationStats, PacketRelayStats
 from ouster.sdk._bindings.client import Sensor as _Sensor
 from ouster.sdk._bindings.client import SensorScanSource as _SensorScanSource
+from ouster.sdk._bindings.client import LatencyStats, ClientStats, ScanSourceStats
+from ouster.sdk._bindings.client import ClockEstimate, ClockModel, HOST_TIMESTAMP_FIELD
+from ouster.sdk._bindings.client import OpenMetrics, add_metrics
+from ouster.sdk._bindings.client import MissingColumns, PacketStreamStats, PacketStreamAnalyzer
 from ouster.sdk._bindings.client import Version
 from ouster.sdk._bindings.client import parse_and_validate_metadata
 from ouster.sdk._bindings.client import parse_and_validate_sensor_config
 from ouster.sdk._bindings.client import ValidatorIssues
 from ouster.sdk._bindings.client import ValidatorEntry
 from ouster.sdk._bindings.client import ScanBatcher
+from ouster.sdk._bindings.client import ReframeWindow, ReframingBatcher
+from ouster.sdk._bindings.client import ShmScanWriter, ShmScanReader
+from ouster.sdk._bindings.client import ScanStreamRequest, ScanStreamStats
+from ouster.sdk._bindings.client import ScanStreamServer, ScanStreamClient
+from ouster.sdk._bindings.client import ScanPrefetcher
 from ouster.sdk._bindings.client import dewarp
+from ouster.sdk._bindings.client import cartesian_dewarp
+from ouster.sdk._bindings.client import cartesian_compact
+from ouster.sdk._bindings.client import ReturnSelection, select_returns, cartesian_returns
+from ouster.sdk._bindings.client import VoxelPolicy
+from ouster.sdk._bindings.client import voxel_downsample
+from ouster.sdk._bindings.client import range_percentiles
+from ouster.sdk._bindings.client import PointCloudFormat, PointCloudWriter
+from ouster.sdk._bindings.client import MapTileStore
+from ouster.sdk._bindings.client import VoxelMapIndex, MapLocalizerConfig, MapLocalizer
+from ouster.sdk._bindings.client import min_filter, max_filter, median_filter
+from ouster.sdk._bindings.client import range_image_normals, connected_components
+from ouster.sdk._bindings.client import ColumnDewarper
+from ouster.sdk._bindings.client import FusedCloud, FusedCloudBuilder
+from ouster.sdk._bindings.client import CellState, GridLayout
+from ouster.sdk._bindings.client import OccupancyGrid, OccupancyGridBuilder
+from ouster.sdk._bindings.client import ScanGate, ScanGateOptions, SkippedSpan
+from ouster.sdk._bindings.client import ImuPreintegrator, ImuBatch, ImuBatcher
+from ouster.sdk._bindings.client import cartesian_batch
 from ouster.sdk._bindings.client import transform
 from ouster.sdk._bindings.client import LONG_HTTP_REQUEST_TIMEOUT_SECONDS, SHORT_HTTP_REQUEST_TIMEOUT_SECONDS
 
@@ -58,6 +92,7 @@ from .data import ColHeader
 from .data import XYZLut
 from .data import destagger
 from .data import stagger
+from .data import stack_field
 from .data import packet_ts
 from .data import ChanField
 
@@ -4,7 +4,7 @@ All rights reserved.
 """
 
 from enum import Enum
-from typing import Callable, List, Union, Any
+from typing import Callable, Iterable, List, Optional, Union, Any
 import logging
 
 import numpy as np
@@ -17,6 +17,7 @@ from ouster.sdk._bindings.client import (destagger_int8, destagger_int16, destag
                       destagger_double)
 
 from ouster.sdk._bindings.client import XYZLut as client_XYZLut
+from ouster.sdk._bindings.client import stack_field as _stack_field
 
 BufferT = Union[bytes, bytearray, memoryview, np.ndarray]
 """Types that support the buffer protocol."""
@@ -67,8 +68,8 @@ class ColHeader(Enum):
         return self.value
 
 
-def _destagger(field: np.ndarray, shifts: List[int],
-               inverse: bool) -> np.ndarray:
+def _destagger(field: np.ndarray, shifts: List[int], inverse: bool,
+               out: Optional[np.ndarray] = None) -> np.ndarray:
     return {
         np.dtype(np.int8): destagger_int8,
         np.dtype(np.int16): destagger_int16,
@@ -80,11 +81,12 @@ def _destagger(field: np.ndarray, shifts: List[int],
         np.dtype(np.uint64): destagger_uint64,
         np.dtype(np.single): destagger_float,
         np.dtype(np.double): destagger_double,
-    }[field.dtype](field, shifts, inverse)
+    }[field.dtype](field, shifts, inverse, out)
 
 
 def stagger(info: SensorInfo,
-            fields: np.ndarray) -> np.ndarray:
+            fields: np.ndarray,
+            out: Optional[np.ndarray] = None) -> np.ndarray:
     """Return a staggered copy of the provided fields.
 
     In the default staggered representation, each column corresponds to a
@@ -95,16 +97,20 @@ def stagger(info: SensorInfo,
     Args:
         info: Sensor metadata associated with the provided data
         fields: A numpy array of shape H X W or H X W X N
+        out: A C contiguous array of the shape and dtype of ``fields`` to
+             write the result to instead of a new array, which may be
+             ``fields`` itself
 
     Returns:
-        A staggered numpy array of the same shape
+        A staggered numpy array of the same shape, ``out`` if provided
     """
-    return destagger(info, fields, inverse=True)
+    return destagger(info, fields, inverse=True, out=out)
 
 
 def destagger(info: SensorInfo,
               fields: np.ndarray,
-              inverse=False) -> np.ndarray:
+              inverse=False,
+              out: Optional[np.ndarray] = None) -> np.ndarray:
     """Return a destaggered copy of the provided fields.
 
     In the default staggered representation, each column corresponds to a
@@ -116,31 +122,68 @@ def destagger(info: SensorInfo,
         info: Sensor metadata associated with the provided data
         fields: A numpy array of shape H X W or H X W X N
         inverse: perform inverse "staggering" operation
+        out: A C contiguous array of the shape and dtype of ``fields`` to
+             write the result to instead of a new array, which may be
+             ``fields`` itself
 
     Returns:
-        A destaggered numpy array of the same shape
+        A destaggered numpy array of the same shape, ``out`` if provided
     """
     h = info.format.pixels_per_column
     w = info.format.columns_per_frame
     shifts = info.format.pixel_shift_by_row
 
-    # remember original shape
     shape = fields.shape
-    fields = fields.reshape((h, w, -1))
+    n = fields.size // (h * w) if h * w else 0
+    if n == 0 or fields.size != h * w * n:
+        raise ValueError(f"fields must have shape {h} x {w} or {h} x {w} x N")
+    if out is not None:
+        if out.shape != shape or out.dtype != fields.dtype:
+            raise ValueError("out must have the shape and dtype of fields")
+        if not out.flags.c_contiguous:
+            raise ValueError("out must be C contiguous")
+
+    # the N channels of each pixel are contiguous, so that shifting the rows
+    # of an H x (W * N) view by N times the shifts destaggers all of them
+    if n != 1:
+        shifts = [s * n for s in shifts]
+    flat_out = None if out is None else out.reshape((h, w * n))
+    # note: reshape() copies fields that can't be viewed as H x (W * N)
+    result = _destagger(fields.reshape((h, w * n)), shifts, inverse, flat_out)
+    return out if out is not None else result.reshape(shape)
+
+
+def stack_field(scans: Iterable[LidarScan],
+                name: str,
+                info: Optional[SensorInfo] = None,
+                out: Optional[np.ndarray] = None) -> np.ndarray:
+    """Return a field of several scans stacked into one array.
+
+    The scans are copied on native threads in a single call, e.g. to export a
+    slice of a scan source as training data without a python loop over the
+    scans.
 
-    # apply destagger to each channel
-    # note: astype() needed due to some strange behavior of the pybind11
-    # bindings. The wrong overload is chosen otherwise (due to the indexing?)
-    return np.dstack([
-        _destagger(fields[:, :, i], shifts, inverse)
-        for i in range(fields.shape[2])
-    ]).reshape(shape)
+    Args:
+        scans: Scans of the same dimensions, all with the field, e.g.
+               ``source.single_source(0)[start:stop]``
+        name: The field to stack
+        info: Sensor metadata to destagger pixel fields with, or None to
+              stack them staggered
+        out: A C contiguous array of shape (N, *field shape) and the dtype of
+             the field to write to instead of a new array
+
+    Returns:
+        An array of shape (N, *field shape), e.g. N x H x W, holding the field
+        of the ith scan at index i
+    """
+    shifts = info.format.pixel_shift_by_row if info is not None else []
+    return _stack_field(list(scans), name, shifts, out)
 
 
 def XYZLut(
         info: SensorInfo,
         use_extrinsics: bool = False
-) -> Callable[[Union[LidarScan, np.ndarray]], np.ndarray]:
+) -> Callable[..., np.ndarray]:
     """Return a function that can project scans into Cartesian coordinates.
 
     If called with a numpy array representing a range image, the range image
@@ -148,7 +191,8 @@ def XYZLut(
     measurement block. LidarScan fields are always staggered.
 
     Internally, this will pre-compute a lookup table using the supplied
-    intrinsic parameters. XYZ points are returned as a H x W x 3 array of
+    intrinsic parameters, shared with every other XYZLut of the process built
+    from the same parameters. XYZ points are returned as a H x W x 3 array of
     doubles, where H is the number of beams and W is the horizontal resolution
     of the scan.
 
@@ -160,6 +204,10 @@ def XYZLut(
     "sensor frame" to "extrinsics frame" using the homogeneous 4x4 transform
     matrix from ``info.extrinsic`` property.
 
+    The returned function takes an optional ``out`` float64 array of shape
+    H x W x 3 or (H * W) x 3 to write the points to instead of allocating a new
+    array on every call.
+
     Args:
         info: sensor metadata
         use_extrinsics: if True, applies the ``info.extrinsic`` transform to the
@@ -171,12 +219,13 @@ def XYZLut(
     """
     lut = client_XYZLut(info, use_extrinsics)
 
-    def res(ls: Union[LidarScan, np.ndarray]) -> np.ndarray:
+    def res(ls: Union[LidarScan, np.ndarray],
+            out: Optional[np.ndarray] = None) -> np.ndarray:
         if isinstance(ls, LidarScan):
-            xyz = lut(ls)
+            xyz = lut(ls, out=out)
         else:
             # will create a temporary to cast if dtype != uint32
-            xyz = lut(ls.astype(np.uint32, copy=False))
+            xyz = lut(ls.astype(np.uint32, copy=False), out=out)
 
         return xyz.reshape(info.format.pixels_per_column,
                            info.format.columns_per_frame, 3)
@@ -6,7 +6,8 @@ import copy
 from .core import PacketSource, first_valid_packet_ts, ClientError, ClientTimeout, ClientOverflow
 from ouster.sdk._bindings.client import (SensorInfo, LidarScan, PacketFormat, ScanBatcher, ClientEventType,
                       SensorConfig, SensorClient, ClientEvent, FieldType,
-                      get_field_types, Packet, ImuPacket, LidarPacket, PacketValidationFailure)
+                      get_field_types, Packet, ImuPacket, LidarPacket, PacketValidationFailure,
+                      CollatedScans)
 from .data import packet_ts, FieldTypes
 from .multi_scan_source import MultiScanSource
 from ouster.sdk._bindings.client import Sensor as _Sensor
@@ -507,9 +508,25 @@ class ScansMulti(MultiScanSource):
         raise NotImplementedError
 
     def __iter__(self) -> Iterator[List[Optional[LidarScan]]]:
-        return collate_scans(self._scans_iter(True, self._cycle, True), self.sensors_count,
-                             first_valid_packet_ts,
-                             dt=self._dt)
+        """Batch the scans of every sensor on its own native thread and collate
+        them natively, so that only finished frames are handed back"""
+        if hasattr(self._source, "restart"):
+            self._source.restart()  # start from the beginning
+        while True:
+            frames = CollatedScans(self._source, self.metadata, self._field_types,
+                                   dt=self._dt, complete=self._complete)
+            had_message = False
+            try:
+                for frame in frames:
+                    had_message = True
+                    yield frame
+            finally:
+                frames.close()
+            # exit if we had no scans so we dont infinite loop when cycling
+            if self._cycle and had_message:
+                self._source.restart()
+            else:
+                break
 
     def _scans_iter(self, restart=True, cycle=False, deep_copy=False
                     ) -> Iterator[Tuple[int, LidarScan]]:
@@ -553,13 +570,11 @@ class ScansMulti(MultiScanSource):
                     h[i], w[i], self._field_types[i], columns_per_packet[i]))
 
             had_message = False
-            for idx, packet in self._source:
-                if isinstance(packet, LidarPacket):
-                    if batch[idx](packet.buf, packet_ts(packet), ls_write[idx]):
-                        if not self._complete or ls_write[idx].complete(col_window[idx]):
-                            had_message = True
-                            yield idx, scan_yield_op(ls_write[idx])
-                            yielded[idx] = ls_write[idx].frame_id
+            for idx in self._cut_scans(batch, ls_write):
+                if not self._complete or ls_write[idx].complete(col_window[idx]):
+                    had_message = True
+                    yield idx, scan_yield_op(ls_write[idx])
+                    yielded[idx] = ls_write[idx].frame_id
 
             # return the last not fully cut scans in the sensor timestamp order if
             # they satisfy the completeness criteria
@@ -579,6 +594,23 @@ class ScansMulti(MultiScanSource):
             else:
                 break
 
+    def _cut_scans(self, batch: List[ScanBatcher], ls_write: List[LidarScan]) -> Iterator[int]:
+        """Batch the lidar packets of the source into ls_write, yielding the
+        sensor index every time a scan is cut. Sources reading packets
+        natively in batches feed the batchers without making a python packet
+        per datagram."""
+        if getattr(self._source, "_batchable", False):
+            for packets in self._source._batches():  # type: ignore
+                pos, idx = packets.batch_scans(batch, ls_write)
+                while idx >= 0:
+                    yield idx
+                    pos, idx = packets.batch_scans(batch, ls_write, pos)
+            return
+        for idx, packet in self._source:
+            if isinstance(packet, LidarPacket):
+                if batch[idx](packet.buf, packet_ts(packet), ls_write[idx]):
+                    yield idx
+
     def _seek(self, offset: int) -> None:
         if not self.is_seekable:
             raise RuntimeError("can not invoke _seek on non-seekable source")
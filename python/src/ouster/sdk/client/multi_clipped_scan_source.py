@@ -2,7 +2,7 @@ from typing import Optional, Iterator, Union, List
 from ouster.sdk.client.multi_scan_source import MultiScanSource
 from ouster.sdk.client import SensorInfo, LidarScan
 from ouster.sdk.client.data import FieldTypes
-from .scan_ops import clip
+from .scan_ops import clip, iter_scan_ops
 
 
 class MultiClippedScanSource(MultiScanSource):
@@ -57,15 +57,12 @@ class MultiClippedScanSource(MultiScanSource):
         return len(self._scan_source)
 
     def __iter__(self) -> Iterator[List[Optional[LidarScan]]]:
+        return iter_scan_ops(self)
 
-        def clip_with_copy(scan, fields, lower, upper):
-            cpy = LidarScan(scan)
-            clip(cpy, fields, lower, upper)
-            return cpy
-
-        for scans in self._scan_source.__iter__():
-            yield [clip_with_copy(scan, self._fields, self._lower, self._upper)
-                   if scan else None for scan in scans]
+    def _apply_scan_op(self, idx: int, scan: LidarScan, owned: bool) -> LidarScan:
+        result = scan if owned else LidarScan(scan)
+        clip(result, self._fields, self._lower, self._upper)
+        return result
 
     def _seek(self, key: int) -> None:
         self._scan_source._seek(key)
@@ -3,7 +3,7 @@ import numpy as np
 from ouster.sdk.client.multi_scan_source import MultiScanSource
 from ouster.sdk.client import SensorInfo, LidarScan
 from ouster.sdk.client.data import FieldTypes
-from .scan_ops import mask
+from .scan_ops import mask, iter_scan_ops
 from ouster.sdk.client import destagger
 
 
@@ -18,7 +18,8 @@ class MultiMaskedScanSource(MultiScanSource):
 
         self._scan_source = scan_source
         self._fields = fields
-        self._masks = [destagger(si, mask, inverse=True) if mask is not None else None
+        self._masks = [np.ascontiguousarray(destagger(si, mask, inverse=True), np.float64)
+                       if mask is not None else None
                        for si, mask in zip(scan_source.metadata, masks)]
 
     @property
@@ -57,17 +58,15 @@ class MultiMaskedScanSource(MultiScanSource):
         return len(self._scan_source)
 
     def __iter__(self) -> Iterator[List[Optional[LidarScan]]]:
-        for scans in self._scan_source.__iter__():
-            result = []
-            for idx, scan in enumerate(scans):
-                if scan:
-                    cpy = LidarScan(scan)
-                    if self._masks[idx] is not None:
-                        mask(cpy, self._fields, self._masks[idx])   # type: ignore
-                    result.append(cpy)
-                else:
-                    result.append(None)     # type: ignore
-            yield result    # type: ignore
+        return iter_scan_ops(self)
+
+    def _apply_scan_op(self, idx: int, scan: LidarScan, owned: bool) -> LidarScan:
+        m = self._masks[idx]
+        if m is None:
+            return scan
+        result = scan if owned else LidarScan(scan)
+        mask(result, self._fields, m)
+        return result
 
     def _seek(self, key: int) -> None:
         self._scan_source._seek(key)
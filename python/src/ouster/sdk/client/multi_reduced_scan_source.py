@@ -81,15 +81,12 @@ class MultiReducedScanSource(MultiScanSource):
         return len(self._scan_source)
 
     def __iter__(self) -> Iterator[List[Optional[LidarScan]]]:
+        return iter_scan_ops(self)
 
-        def reduce_scan(scan, factor, sensor_info):
-            out = reduce_by_factor(scan, factor)
-            out.sensor_info = sensor_info
-            return out
-
-        for scans in self._scan_source.__iter__():
-            yield [reduce_scan(scan, self._factors[idx], self._metadata[idx])
-                   if scan else None for idx, scan in enumerate(scans)]
+    def _apply_scan_op(self, idx: int, scan: LidarScan, owned: bool) -> LidarScan:
+        result = reduce_by_factor(scan, self._factors[idx])
+        result.sensor_info = self._metadata[idx]
+        return result
 
     def _seek(self, key: int) -> None:
         self._scan_source._seek(key)
@@ -94,6 +94,13 @@ class MultiScanSource(Protocol):
     def _slice_iter(self, key: slice) -> Iterator[List[Optional[LidarScan]]]:
         ...
 
+    def prefetch(self, depth: int = 2) -> Iterator[List[Optional[LidarScan]]]:
+        """Iterate over the collated scans, reading and batching up to
+        ``depth`` of them ahead on a native thread while the current ones are
+        processed, see ``ScanPrefetcher``."""
+        from ouster.sdk._bindings.client import ScanPrefetcher
+        return ScanPrefetcher(self, depth)
+
     def slice(self, key: slice) -> 'MultiScanSource':
         """Constructs a MultiScanSource matching the specificed slice"""
         from ouster.sdk.util.forward_slicer import ForwardSlicer
@@ -1,7 +1,8 @@
-from typing import List
+from typing import Any, Iterator, List, Optional
 import copy
 import numpy as np
 from ouster.sdk.client import LidarScan, SensorInfo
+import ouster.sdk._bindings.client as _client
 
 
 def clip(scan: LidarScan, fields: List[str], lower: int, upper: int, invalid: int = 0) -> None:
@@ -9,12 +10,7 @@ def clip(scan: LidarScan, fields: List[str], lower: int, upper: int, invalid: in
     limits the values of the specified set of fields to within the range = [lower, upper], any value
     that exceeds this range is replaced by the supplied invalid value (default is zero)
     """
-    if not fields:
-        fields = list(scan.fields)
-    for f in fields:
-        if scan.has_field(f):
-            m = scan.field(f)
-            m[(m < lower) | (m > upper)] = invalid
+    _client.clip_fields(scan, fields or [], lower, upper, invalid)
 
 
 def mask(scan: LidarScan, fields: List[str], mask: np.ndarray) -> None:
@@ -26,11 +22,26 @@ def mask(scan: LidarScan, fields: List[str], mask: np.ndarray) -> None:
         raise ValueError(f"Used mask size {mask.shape} doesn't match scan size"
                          " ({scan.h}, {scan.w}")
 
-    if not fields:
-        fields = list(scan.fields)
-    for f in fields:
-        if scan.has_field(f):
-            scan.field(f)[:] *= mask.astype(scan.field(f)[:].dtype)
+    _client.mask_fields(scan, fields or [], mask)
+
+
+def convert(array: np.ndarray, dtype: Any, scale: float = 1.0, offset: float = 0.0,
+            out: Optional[np.ndarray] = None) -> np.ndarray:
+    """
+    converts an array, e.g. a field of a LidarScan, to dtype in one pass computing
+    array * scale + offset on the way; values out of the range of dtype saturate
+    """
+    return _client.convert_array(np.ascontiguousarray(array), dtype, scale, offset, out)
+
+
+def compare(array: np.ndarray, op: str, value: float,
+            out: Optional[np.ndarray] = None) -> np.ndarray:
+    """
+    compares an array, e.g. a field of a LidarScan, to a value with op, one of
+    "<", "<=", ">", ">=", "==" and "!=", returning a uint8 array holding 1 where
+    the comparison holds and 0 elsewhere
+    """
+    return _client.compare_array(np.ascontiguousarray(array), op, value, out)
 
 
 def reduce_by_factor_metadata(metadata: SensorInfo, factor: int) -> SensorInfo:
@@ -58,23 +69,35 @@ def reduce_by_factor(scan: LidarScan, factor: int,
     if not (scan.h / factor).is_integer():
         raise ValueError(f"factor == {factor} must be a divisor of {scan.h}")
 
-    scan_h = scan.h // factor
-    result = LidarScan(scan_h, scan.w, scan.field_types)
-    # copy std properties
-    result.frame_id = scan.frame_id
-    result.frame_status = scan.frame_status
-    for i in range(len(scan.timestamp)):
-        result.timestamp[i] = scan.timestamp[i]
-    for i in range(len(scan.packet_timestamp)):
-        result.packet_timestamp[i] = scan.packet_timestamp[i]
-    for i in range(len(scan.measurement_id)):
-        result.measurement_id[i] = scan.measurement_id[i]
-    for i in range(len(scan.status)):
-        result.status[i] = scan.status[i]
-    for i in range(len(scan.pose)):
-        result.pose[i] = scan.pose[i]
-    for f in scan.fields:
-        result.field(f)[:] = scan.field(f)[::factor]
+    result = _client.reduce_by_factor(scan, factor)
     if update_metadata:
         result.sensor_info = reduce_by_factor_metadata(scan.sensor_info, factor)
     return result
+
+
+def iter_scan_ops(source: Any) -> Iterator[List[Optional[LidarScan]]]:
+    """
+    iterates the scans of a source adapter applying a scan operation, e.g. a
+    MultiClippedScanSource, in one pass along with the operations of the adapters
+    it directly wraps: each scan is read once from the underlying source and
+    copied at most once, after which the operations work on it in place
+    """
+    ops = []
+    while hasattr(source, "_apply_scan_op"):
+        ops.append(source)
+        source = source._scan_source
+    ops.reverse()
+
+    for scans in source:
+        result: List[Optional[LidarScan]] = []
+        for idx, scan in enumerate(scans):
+            if not scan:
+                result.append(None)
+                continue
+            owned = False
+            for op in ops:
+                out = op._apply_scan_op(idx, scan, owned)
+                owned = owned or out is not scan
+                scan = out
+            result.append(scan)
+        yield result
@@ -84,6 +84,13 @@ class ScanSource(Protocol):
     def _slice_iter(self, key: slice) -> Iterator[Optional[LidarScan]]:
         ...
 
+    def prefetch(self, depth: int = 2) -> Iterator[LidarScan]:
+        """Iterate over the scans, reading and batching up to ``depth`` of
+        them ahead on a native thread while the current one is processed, see
+        ``ScanPrefetcher``."""
+        from ouster.sdk._bindings.client import ScanPrefetcher
+        return ScanPrefetcher(self, depth)
+
     def slice(self, key: slice) -> 'ScanSource':
         """Constructs a ScanSource matching the specificed slice"""
         ...
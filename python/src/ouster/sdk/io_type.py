@@ -13,6 +13,7 @@ class OusterIoType(Enum):
     PLY = auto()
     PCD = auto()
     LAS = auto()
+    SCAN_STREAM = auto()
 
     @staticmethod
     def io_type_2_extension() -> dict:
@@ -48,6 +49,8 @@ def io_type_from_extension(source: str) -> OusterIoType:
 
 def io_type(source: str) -> OusterIoType:
     """Return a OusterIoType given a source arg str"""
+    if source.startswith("ousterscan://"):
+        return OusterIoType.SCAN_STREAM
     if os.path.isfile(source):
         return io_type_from_extension(source)
     if os.path.isdir(source) and io_type_from_extension(source) == OusterIoType.BAG:
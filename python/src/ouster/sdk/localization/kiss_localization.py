@@ -1,6 +1,6 @@
 import time
 import logging
-from typing import List, Optional
+from typing import List, Optional, Set, Tuple
 from ouster.sdk import client
 from kiss_icp.kiss_icp import KissICP       # type: ignore
 import kiss_icp.config                      # type: ignore
@@ -21,11 +21,18 @@ class KissLocalization:
         self.config.mapping.voxel_size = voxel_size
         self.xyz_lut = xyz_lut
         self.last_slam_pose = None
+        self.map_store: Optional[client.MapTileStore] = None
+        self.loaded_tiles: Set[Tuple[int, int, int]] = set()
 
         self.odometry = KissICP(config=self.config)
         self.load_global_map(filename)
 
     def load_global_map(self, filename):
+        if filename.endswith(".omap"):
+            # tiles are paged into the local map by region as the sensor moves
+            self.map_store = client.MapTileStore(filename, 1)
+            self.page_in_tiles(np.zeros(3))
+            return
         import point_cloud_utils as pcu     # type: ignore
         start_time = time.time()
         points = pcu.load_mesh_v(filename)
@@ -34,6 +41,21 @@ class KissLocalization:
         print(f"Took {(end_time - start_time):.4f} seconds to load the map "
               f"{filename} which has {len(points)} points")
 
+    def page_in_tiles(self, position: np.ndarray) -> None:
+        """Add the tiles within max range of a position not added yet."""
+        assert self.map_store is not None
+        reach = self.config.data.max_range + self.map_store.tile_size
+        added = 0
+        for key in self.map_store.tiles_in(position - reach, position + reach):
+            if key in self.loaded_tiles:
+                continue
+            points = self.map_store.tile_points(key)
+            self.odometry.local_map.add_points(points)
+            self.loaded_tiles.add(key)
+            added += len(points)
+        if added:
+            logger.info(f"Paged {added} map points in around {position}")
+
     def track(self, scans: List[Optional[client.LidarScan]]) -> List[Optional[client.LidarScan]]:
         pts, ts, ts_raw = util.getKissICPInputData(scans, self.xyz_lut, [0])
         sigma = self.odometry.adaptive_threshold.get_threshold()
@@ -54,4 +76,6 @@ class KissLocalization:
         util.writeScanColPose(self.last_slam_pose,
                 self.odometry.last_pose, scans, ts_raw, 1)
         self.last_slam_pose = self.odometry.last_pose
+        if self.map_store is not None:
+            self.page_in_tiles(self.odometry.last_pose[:3, 3])
         return scans
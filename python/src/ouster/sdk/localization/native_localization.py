@@ -0,0 +1,65 @@
+import os
+import time
+import logging
+from typing import List, Optional
+from ouster.sdk import client
+import ouster.sdk.mapping.util as util
+import numpy as np
+
+
+logging.basicConfig(level=logging.INFO)
+logger = logging.getLogger()
+
+
+def index_filename(map_filename: str) -> str:
+    """The voxel map index of a ply or .omap map, the map itself if an index."""
+    if map_filename.endswith(".vidx"):
+        return map_filename
+    return os.path.splitext(map_filename)[0] + ".vidx"
+
+
+def build_index(map_filename: str, filename: str, voxel_size: float) -> None:
+    """Write the voxel map index of a ply or .omap map."""
+    start_time = time.time()
+    if map_filename.endswith(".omap"):
+        store = client.MapTileStore(map_filename, 1)
+        points = np.concatenate([store.tile_points(key) for key in store.tiles()] +
+                                [np.empty((0, 3))])
+    else:
+        import point_cloud_utils as pcu     # type: ignore
+        points = pcu.load_mesh_v(map_filename)
+    client.VoxelMapIndex.build(filename, np.ascontiguousarray(points, dtype=np.float64),
+                               voxel_size)
+    logger.info(f"Took {(time.time() - start_time):.4f} seconds to index the map "
+                f"{map_filename} of {len(points)} points into {filename}")
+
+
+class NativeLocalization:
+    """Localizes against a memory mapped voxel map index with the native
+    MapLocalizer, without loading the map into Python, with the same interface
+    as KissLocalization."""
+
+    def __init__(self, filename, xyz_lut, max_range, min_range, voxel_size):
+        path = index_filename(filename)
+        if not os.path.exists(path):
+            build_index(filename, path, voxel_size)
+        self.index = client.VoxelMapIndex(path)
+        config = client.MapLocalizerConfig()
+        config.max_correspondence_distance = self.index.voxel_size
+        config.kernel_scale = self.index.voxel_size / 3.0
+        config.voxel_size = self.index.voxel_size / 2.0
+        self.localizer = client.MapLocalizer(self.index, config=config)
+        self.xyz_lut = xyz_lut
+        self.max_range = max_range
+        self.min_range = min_range
+        self.last_slam_pose = None
+
+    def track(self, scans: List[Optional[client.LidarScan]]) -> List[Optional[client.LidarScan]]:
+        pts, ts, ts_raw = util.getKissICPInputData(scans, self.xyz_lut, [0])
+        ranges = np.linalg.norm(pts, axis=1)
+        keep = (ranges >= self.min_range) & (ranges <= self.max_range)
+        pose = self.localizer.update(np.ascontiguousarray(pts[keep], dtype=np.float64),
+                                     np.ascontiguousarray(ts[keep], dtype=np.float64))
+        util.writeScanColPose(self.last_slam_pose, pose, scans, ts_raw, 1)
+        self.last_slam_pose = pose
+        return scans
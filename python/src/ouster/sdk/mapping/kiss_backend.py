@@ -6,6 +6,7 @@ from typing import List, Optional
 import ouster.sdk.mapping.ouster_kiss_icp as ouster_kiss_icp
 import ouster.sdk.mapping.util as util
 import ouster.sdk.client as client
+from ouster.sdk._bindings.client import DeskewInput, XYZLut
 
 from .slam_backend import SLAMBackend
 
@@ -44,6 +45,9 @@ class KissBackend(SLAMBackend):
         self.voxel_size = voxel_size
         self.live_stream = live_stream
         self.scans_ts_offset: List[int] = []
+        # native points and per point times of the scans, reusing its buffers
+        # across frames
+        self._deskew_input = DeskewInput([XYZLut(info, use_extrinsics) for info in infos])
         if voxel_size and voxel_size > 0:
             self.config.mapping.voxel_size = voxel_size
             logger.info(f"Kiss-ICP voxel map size is {voxel_size:.4g} m")
@@ -97,14 +101,13 @@ class KissBackend(SLAMBackend):
 
             self.last_frame_id[idx] = curr_frame_id
 
-        icp_inputs = util.getKissICPInputData(scans, self.xyz_lut, self.scans_ts_offset)
-
-        if icp_inputs[1].size == 0:
+        if self._deskew_input.build(scans, self.scans_ts_offset) == 0:
             # empty kiss icp intput mean the scans list has no valid scan
             return scans
 
         try:
-            self.ouster_kiss_icp.register_frame(icp_inputs[0], icp_inputs[1],
+            self.ouster_kiss_icp.register_frame(self._deskew_input.points,
+                                                self._deskew_input.times,
                                                 slam_update_diff)
         except Exception as e:
             from kiss_icp import __version__ as kiss_icp_version
@@ -115,8 +118,9 @@ class KissBackend(SLAMBackend):
             raise
 
         # Use SLAM pose to update scans' col poses
+        col_ts = [self._deskew_input.column_times(idx) for idx in range(len(scans))]
         util.writeScanColPose(self.last_slam_pose, self.ouster_kiss_icp.last_pose,
-                              scans, icp_inputs[2], slam_update_diff)
+                              scans, col_ts, slam_update_diff)
 
         self.last_slam_pose = self.ouster_kiss_icp.last_pose
 
@@ -156,21 +160,19 @@ class KissBackend(SLAMBackend):
                        end_pct: float = 0.96) -> float:
         """Average highest 92% to 96% range readings and use this averaged range value
             to calculate the voxel map size """
-        selected_ranges = np.array([])
+        range_sum = 0
+        range_count = 0
 
-        for idx, scan in enumerate(scans):
+        for scan in scans:
             if not scan:
                 continue
-            sel_flag = scan.field(client.ChanField.RANGE) != 0
-            scan_range = scan.field(client.ChanField.RANGE)[sel_flag]
-            start_value = np.percentile(scan_range, start_pct * 100)
-            end_value = np.percentile(scan_range, end_pct * 100)
-
-            selected_range = scan_range[(scan_range >= start_value) & (scan_range <= end_value)]
-            selected_ranges = np.concatenate((selected_ranges, selected_range))
+            band_sum, band_count = client.range_percentiles(
+                scan.field(client.ChanField.RANGE), start_pct, end_pct)
+            range_sum += band_sum
+            range_count += band_count
 
         # lidar range is in mm. change the unit to meter
-        average = np.mean(selected_ranges) / 1000
+        average = range_sum / range_count / 1000 if range_count else np.nan
         # use the lidar range readings and a number to land voxel size in a
         # proper range
         voxel_size = average / 46.0
@@ -1,23 +1,33 @@
 from typing import List, Optional, Union
+import importlib
 import os
 import numpy as np
 from ouster.sdk.client import ScanSource, MultiScanSource
 import ouster.sdk.io_type
 from ouster.sdk.io_type import OusterIoType
-from ouster.sdk.osf import OsfScanSource
-from ouster.sdk.pcap import PcapScanSource
-from ouster.sdk.sensor import SensorScanSource
-from ouster.sdk.bag import BagScanSource
 
 
+# handlers are imported on first use so that importing ouster.sdk doesn't pay
+# for every format, e.g. rosbags for bag files
 io_type_handlers = {
-    OusterIoType.SENSOR: SensorScanSource,
-    OusterIoType.PCAP: PcapScanSource,
-    OusterIoType.OSF: OsfScanSource,
-    OusterIoType.BAG: BagScanSource,
+    OusterIoType.SENSOR: ("ouster.sdk.sensor", "SensorScanSource"),
+    OusterIoType.PCAP: ("ouster.sdk.pcap", "PcapScanSource"),
+    OusterIoType.OSF: ("ouster.sdk.osf", "OsfScanSource"),
+    OusterIoType.BAG: ("ouster.sdk.bag", "BagScanSource"),
+    OusterIoType.SCAN_STREAM: ("ouster.sdk.sensor", "ScanStreamScanSource"),
 }
 
 
+def _io_type_handler(source_type: OusterIoType):
+    """Import and return the scan source class of source_type.
+
+    Raises:
+        KeyError: if source_type has no scan source.
+    """
+    module, name = io_type_handlers[source_type]
+    return getattr(importlib.import_module(module), name)
+
+
 class SourceURLException(Exception):
     def __init__(self, sub_exception, url):
         self._sub_exception = sub_exception
@@ -78,7 +88,7 @@ def open_source(source_url: Union[str, List[str]], sensor_idx: int = 0, *args,
     scan_source: Optional[MultiScanSource] = None
     try:
         source_type = ouster.sdk.io_type.io_type(first_url)
-        handler = io_type_handlers[source_type]
+        handler = _io_type_handler(source_type)
         sources = source_url if len(source_url) > 1 else source_url[0]
         scan_source = handler(sources, *args, **kwargs)
     except KeyError:
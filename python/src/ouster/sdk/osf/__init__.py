@@ -8,13 +8,30 @@ API to work with OSF files
 
 from ouster.sdk._bindings.osf import Writer
 from ouster.sdk._bindings.osf import AsyncWriter
+from ouster.sdk._bindings.osf import AsyncWriterStats
+from ouster.sdk._bindings.osf import add_metrics
+from ouster.sdk._bindings.osf import ChunkIoOptions, ChunkPolicy
 
 from ouster.sdk._bindings.osf import slice_and_cast
 from ouster.sdk._bindings.osf import dump_metadata
 from ouster.sdk._bindings.osf import backup_osf_file_metablob
 from ouster.sdk._bindings.osf import restore_osf_file_metablob
 from ouster.sdk._bindings.osf import osf_file_modify_metadata
-from ouster.sdk._bindings.osf import Encoder, PngLidarScanEncoder
+from ouster.sdk._bindings.osf import recover_osf_file
+from ouster.sdk._bindings.osf import slice_osf_file, merge_osf_files
+from ouster.sdk._bindings.osf import TranscodeOptions, transcode_osf_file
+from ouster.sdk._bindings.osf import CompactOptions, compact_osf_file
+from ouster.sdk._bindings.osf import PcapToOsfOptions, pcap_to_osf
+from ouster.sdk._bindings.osf import BenchEncoder, BenchOptions, OsfBench, bench_osf_file
+from ouster.sdk._bindings.osf import ScanOps
+from ouster.sdk._bindings.osf import Encoder, PngLidarScanEncoder, ZstdLidarScanEncoder
+from ouster.sdk._bindings.osf import BandedLidarScanEncoder, SparseLidarScanEncoder
+from ouster.sdk._bindings.osf import LossyLidarScanEncoder
+from ouster.sdk._bindings.osf import RecordingGaps
+from ouster.sdk._bindings.osf import PngFilter, PngStrategy
+from ouster.sdk._bindings.osf import ThreadPool, set_default_thread_pool
+from ouster.sdk._bindings.osf import ReadAheadOptions, ScanReadAhead, ReaderCacheOptions
+from ouster.sdk._bindings.osf import FileBackend, FileOptions
 
 from .data import Scans
 from .osf_scan_source import OsfScanSource
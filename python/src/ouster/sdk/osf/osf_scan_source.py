@@ -1,12 +1,14 @@
 from typing import cast, Iterator, Dict, Optional, List, Tuple, Union
 
 from more_itertools import ilen
+import numpy as np
 from ouster.sdk import client
 from ouster.sdk.client import LidarScan, SensorInfo, first_valid_packet_ts
 from ouster.sdk.client import MultiScanSource
 
 from ouster.sdk._bindings.osf import (Reader, Writer, MessageRef, LidarSensor,
-                                 Extrinsics, LidarScanStream, StreamingInfo)
+                                 Extrinsics, LidarScanStream, StreamingInfo, ScanReadAhead,
+                                 ReaderCacheOptions)
 
 from ouster.sdk.client.multi import collate_scans       # type: ignore
 from ouster.sdk.util import ForwardSlicer, progressbar    # type: ignore
@@ -24,6 +26,7 @@ class OsfScanSource(MultiScanSource):
         index: bool = False,
         cycle: bool = False,
         field_names: Optional[List[str]] = None,
+        cache_bytes: int = 0,
         **kwargs
     ) -> None:
         """
@@ -39,6 +42,9 @@ class OsfScanSource(MultiScanSource):
             cycle: repeat infinitely after iteration is finished (default is False)
             field_names: list of fields to decode into a LidarScan, if not provided
                 decodes all fields
+            cache_bytes: memory in bytes of decoded scans kept for indexing and
+                slicing the same scans again, e.g. scrubbing back and forth in a
+                viewer, 0 to not cache them (default is 0)
         Remarks:
             In case the OSF file didn't have builtin-index and the index flag was
             was set to True the object will attempt to index the file in place.
@@ -64,6 +70,11 @@ class OsfScanSource(MultiScanSource):
                 self._reader = Reader(file_path)
                 has_index = True
 
+        if cache_bytes:
+            cache = ReaderCacheOptions()
+            cache.scan_bytes = cache_bytes
+            self._reader.set_cache(cache)
+
         self._cycle = cycle
         self._dt = dt
 
@@ -98,20 +109,16 @@ class OsfScanSource(MultiScanSource):
                 stream_meta.sensor_meta_id]
             self._stream_ids.append(stream_id)
 
-        # extract necessary values from the index/stats to calculate lengths
+        # index the streams from the metadata, without reading any chunk
         self._scans_num: List[Optional[int]] = [0] * len(self._metadatas)
-        self._times = []  # a list of all scans and their times/indexes
-        for stream_id, stream_meta in self._reader.meta_store.find(StreamingInfo).items():
-            for id, stats in stream_meta.stream_stats:
-                if id in self._stream_ids:
-                    sensor_index = self._stream_sensor_idx[id]
-                    self._scans_num[sensor_index] = stats.message_count
-                    rts = stats.receive_timestamps
-                    for t in rts:
-                        self._times.append((sensor_index, t))
-
-        # sort the list of scan times so that we can collate them below
-        self._times.sort(key=lambda x: x[1])
+        self._stream_ts: List[np.ndarray] = []
+        for stream_id in self._stream_ids:
+            stream_index = None
+            if self._reader.has_stream_info:
+                stream_index = self._reader.stream_index(stream_id)
+                self._scans_num[self._stream_sensor_idx[stream_id]] = stream_index.message_count
+            self._stream_ts.append(stream_index.timestamps if stream_index
+                                   else np.empty(0, dtype=np.uint64))
 
         # get the first scan of each to get field types
         self._field_types: List[client.FieldTypes] = [[]] * len(self._metadatas)
@@ -133,8 +140,13 @@ class OsfScanSource(MultiScanSource):
                     self._fields[idx] = l
                     break
 
+        # the message index of each stream in each collated scan, so that
+        # len() and seeking don't iterate over the messages
+        self._frames = np.empty((0, len(self._stream_ids)), dtype=np.int64)
         if has_index:
-            self._len = ilen(collate_scans(self._times, self.sensors_count, lambda msg: msg, dt=self._dt))
+            if self._reader.has_timestamp_idx:
+                self._frames = self._reader.collate_messages(self._stream_ids, self._dt)
+            self._len = len(self._frames)
             self._indexed = True
 
     def _osf_convert(self, reader: Reader, output: str) -> None:
@@ -197,14 +209,23 @@ class OsfScanSource(MultiScanSource):
 
     def _scans_iter(self, start_ts: int, stop_ts: int, cycle: bool
                     ) -> Iterator[Tuple[int, LidarScan]]:
-        for idx, msg in self._msgs_iter(self._stream_ids, start_ts, stop_ts, cycle):
-            ls = msg.decode(self._desired_fields)
-            if ls:
-                window = self.metadata[idx].format.column_window
-                scan = cast(LidarScan, ls)
-                if not self._complete or scan.complete(window):
-                    scan.sensor_info = self._metadatas[idx]
-                    yield idx, scan
+        while True:
+            had_message = False
+            # the following scans are decoded in the background while the
+            # current one is consumed
+            for stream_id, _, ls in ScanReadAhead(self._reader, self._stream_ids, start_ts, stop_ts,
+                                                  self._desired_fields):
+                had_message = True
+                if ls:
+                    idx = self._stream_sensor_idx[stream_id]
+                    window = self.metadata[idx].format.column_window
+                    scan = cast(LidarScan, ls)
+                    if not self._complete or scan.complete(window):
+                        scan.sensor_info = self._metadatas[idx]
+                        yield idx, scan
+            # exit if we had no messages to prevent an infinite loop
+            if not cycle or not had_message:
+                break
 
     @property
     def sensors_count(self) -> int:
@@ -248,6 +269,12 @@ class OsfScanSource(MultiScanSource):
             self._reader.start_ts, self._reader.end_ts, self._cycle)
         return collate_scans(msgs_itr, self.sensors_count, first_valid_packet_ts, dt=self._dt)
 
+    def _frame_ts(self, key: int) -> Tuple[int, int]:
+        """Lowest and highest receive timestamps of the messages of a collated scan."""
+        ts = [int(self._stream_ts[i][msg_idx])
+              for i, msg_idx in enumerate(self._frames[key]) if msg_idx >= 0]
+        return min(ts), max(ts)
+
     def _seek(self, key: int) -> None:
         """seek/jump to a specific item within the list of LidarScan objects that this particular scan
         source has access to"""
@@ -268,10 +295,7 @@ class OsfScanSource(MultiScanSource):
                 key += L
             if key < 0 or key >= L:
                 raise IndexError("index is out of range")
-            ts = [self._reader.ts_by_message_idx(
-                mid, key) for mid in self._stream_ids]
-            ts_start = min(ts)
-            ts_stop = min(ts_start + self._dt, max(ts))
+            ts_start, ts_stop = self._frame_ts(key)
             scans_itr = self._scans_iter(ts_start, ts_stop, False)
             return next(collate_scans(scans_itr, self.sensors_count,
                                       first_valid_packet_ts, dt=self._dt))
@@ -304,10 +328,8 @@ class OsfScanSource(MultiScanSource):
         count = k.stop - k.start
         if count <= 0:
             return iter(())
-        ts_start = min([self._reader.ts_by_message_idx(mid, k.start)
-                        for mid in self._stream_ids])
-        ts_stop = max([self._reader.ts_by_message_idx(mid, k.stop - 1)
-                       for mid in self._stream_ids])
+        ts_start = self._frame_ts(k.start)[0]
+        ts_stop = self._frame_ts(k.stop - 1)[1]
         scans_itr = collate_scans(self._scans_iter(ts_start, ts_stop, False),
                                   self.sensors_count, first_valid_packet_ts,
                                   dt=self._dt)
@@ -2,7 +2,7 @@ from typing import Dict, Iterator, List, Optional, Tuple, Union
 from ouster.sdk.client import PacketMultiSource, UDPProfileLidar, PacketSource
 import ouster.sdk._bindings.pcap as _pcap
 from ouster.sdk._bindings.pcap import PcapIndex     # type: ignore
-from ouster.sdk.pcap.pcap import _guess_ports, _packet_info_stream
+from ouster.sdk.pcap.pcap import _guess_ports
 from ouster.sdk.util import (resolve_metadata_multi)    # type: ignore
 
 import time
@@ -77,8 +77,7 @@ class PcapMultiPacketReader(PacketMultiSource):
 
         # sample pcap and attempt to find UDP ports consistent with metadatas
         # NOTE[pb]: Needed for port guessing logic for old single sensor data.
-        n_packets = 1000
-        stats = _packet_info_stream(pcap_path, n_packets)
+        stats = _pcap.get_stream_info_sampled(pcap_path)
 
         if len(metadata_paths or []) > 0 and metadatas is not None:
             raise RuntimeError("Cannot provide both metadata and metadata paths")
@@ -135,7 +134,7 @@ class PcapMultiPacketReader(PacketMultiSource):
         self._reader: Optional[_pcap.IndexedPcapReader] = \
             _pcap.IndexedPcapReader(pcap_path, self._metadata)   # type: ignore
         if self._indexed:
-            self._reader.build_index()
+            self._reader.build_index_parallel()
         self._lock = Lock()
         self._pf = []
         for m in self._metadata:
@@ -148,11 +147,40 @@ class PcapMultiPacketReader(PacketMultiSource):
 
             self._pf.append(pf)
 
+    @property
+    def _batchable(self) -> bool:
+        """Whether packets can be read with ``_batches``."""
+        return not self._rate and not self._soft_id_check
+
+    def _batches(self, max_packets: int = 256) -> Iterator[_pcap.PacketBatch]:
+        """Read the sensor packets natively in batches.
+
+        The same batch is read into at every step, so it is only valid until
+        the next one. Doesn't support rate and soft_id_check.
+        """
+        batch = _pcap.PacketBatch()
+        while True:
+            with self._lock:
+                if self._reader is None:
+                    break
+                count = self._reader.read_batch(batch, max_packets)
+            self._id_error_count += batch.id_errors
+            self._size_error_count += batch.size_errors
+            if not count:
+                break
+            yield batch
+
     def __iter__(self) -> Iterator[Tuple[int, Packet]]:
         with self._lock:
             if self._reader is None:
                 raise ValueError("I/O operation on closed packet source")
 
+        if self._batchable:
+            for batch in self._batches():
+                for i, idx in enumerate(batch.entries["sensor_idx"].tolist()):
+                    yield (idx, batch.packet(i))
+            return
+
         buf = bytearray(2**16)
         packet_info = _pcap.packet_info()
 
@@ -1,3 +1,4 @@
+import bisect
 from typing import Iterator, List, Optional, Union
 
 from ouster.sdk.client import LidarScan, first_valid_packet_ts
@@ -84,15 +85,31 @@ class PcapScanSource(ScansMulti):
 
         if index:
             self._frame_offset = []
+            self._frame_ts = []
             pi = self._source._index    # type: ignore
             scans_itr = self._collated_scans_itr(
                 self._scans_iter(True, False, True))
             # scans count in first source
-            scans_count = len(pi.frame_id_indices[0])   # type: ignore
+            scans_count = pi.frame_count(0)   # type: ignore
+            # the frames of each sensor are matched in order, as frame ids
+            # repeat in recordings longer than 2^16 frames
+            frame_ids = [ids.tolist() for ids in pi.frame_ids]   # type: ignore
+            frame_offsets = [o.tolist() for o in pi.frame_indices]   # type: ignore
+            next_frame = [0] * self.sensors_count
             for scan_idx, scans in enumerate(scans_itr):
-                offsets = [pi.frame_id_indices[idx].get(    # type: ignore
-                    scan.frame_id) for idx, scan in enumerate(scans) if scan]
-                self._frame_offset.append(min([v for v in offsets if v]))
+                offsets = []
+                for idx, scan in enumerate(scans):
+                    if not scan:
+                        continue
+                    try:
+                        pos = frame_ids[idx].index(scan.frame_id, next_frame[idx])
+                    except ValueError:
+                        continue
+                    offsets.append(frame_offsets[idx][pos])
+                    next_frame[idx] = pos + 1
+                self._frame_offset.append(min(offsets))
+                self._frame_ts.append(min(first_valid_packet_ts(scan)
+                                          for scan in scans if scan))
                 progressbar(scan_idx, scans_count, "", "indexed")
             print("\nfinished building index")
 
@@ -144,6 +161,23 @@ class PcapScanSource(ScansMulti):
         raise TypeError(
             f"indices must be integer or slice, not {type(key).__name__}")
 
+    def index_at_time(self, ts: int) -> int:
+        """Find the collated scan at a timestamp by binary search, so that
+        long recordings can be scrubbed with ``source[idx]`` or
+        ``source[idx:]`` without reading the scans before it.
+
+        Args:
+            ts: the packet timestamp in nanoseconds, as of
+                ``first_valid_packet_ts``
+
+        Returns:
+            The index of the last scan starting at or before ``ts``, 0 if all
+            of them start after it.
+        """
+        if not self.is_indexed:
+            raise TypeError("index_at_time is not supported on non-indexed source")
+        return max(bisect.bisect_right(self._frame_ts, ts) - 1, 0)
+
     def _slice_iter(self, key: slice) -> Iterator[List[Optional[LidarScan]]]:
         # NOTE: In this method if key.step was negative, this won't be
         # result in the output being reversed, it is the responsibility of
@@ -7,3 +7,4 @@ Sensor specific interfaces.
 # flake8: noqa: F401 (unused imports)
 
 from .sensor_scan_source import SensorScanSource
+from .scan_stream_scan_source import ScanStreamScanSource
@@ -0,0 +1,131 @@
+from typing import Iterator, List, Optional, Tuple
+from urllib.parse import urlparse
+
+import ouster.sdk.client as client
+from ouster.sdk.client import (LidarScan, MultiScanSource, ScanStreamClient,
+                               ScanStreamRequest)
+
+SCAN_STREAM_SCHEME = "ousterscan"
+DEFAULT_SCAN_STREAM_PORT = 7510
+
+
+def parse_scan_stream_url(url: str) -> Tuple[str, int]:
+    """Return the host and port of an ``ousterscan://host[:port]`` url."""
+    parsed = urlparse(url)
+    if parsed.scheme != SCAN_STREAM_SCHEME or not parsed.hostname:
+        raise ValueError(f"Expected a {SCAN_STREAM_SCHEME}://host[:port] url, got {url}")
+    return parsed.hostname, parsed.port or DEFAULT_SCAN_STREAM_PORT
+
+
+class ScanStreamScanSource(MultiScanSource):
+    """Implements MultiScanSource protocol for the scans of a
+    ``ScanStreamServer``, e.g. streamed from a vehicle to a remote station."""
+
+    def __init__(
+        self,
+        url: str,
+        *,
+        decimation: int = 1,
+        compress: bool = True,
+        queue_depth: int = 1,
+        timeout: Optional[float] = 5.0,
+        field_names: Optional[List[str]] = None,
+        **_
+    ) -> None:
+        """
+        Args:
+            url: ``ousterscan://host[:port]`` of the server
+            decimation: receive one scan in this many, by frame id
+            compress: have the server compress the scans it sends
+            queue_depth: most scans the server keeps for this client when it
+                falls behind, the oldest are dropped first
+            timeout: seconds to wait for a scan before raising
+                ``ClientTimeout``, None to wait forever
+            field_names: fields to receive, None for all fields
+        """
+        host, port = parse_scan_stream_url(url)
+        request = ScanStreamRequest()
+        request.decimation = decimation
+        request.compress = compress
+        request.queue_depth = queue_depth
+        if field_names:
+            request.fields = list(field_names)
+        self._url = url
+        self._timeout = timeout
+        self._cli = ScanStreamClient(host, port, request,
+                                     timeout if timeout is not None else 5.0)
+        self._metadata = [self._cli.sensor_info]
+        # what the server sends until the first scan tells otherwise
+        types = client.get_field_types(self._metadata[0])
+        if field_names:
+            types = [t for t in types if t.name in field_names]
+        self._field_types: List[client.FieldTypes] = [types]
+        self._received = False
+
+    @property
+    def sensors_count(self) -> int:
+        return 1
+
+    @property
+    def metadata(self) -> List[client.SensorInfo]:
+        return self._metadata
+
+    @property
+    def is_live(self) -> bool:
+        return True
+
+    @property
+    def is_seekable(self) -> bool:
+        return False
+
+    @property
+    def is_indexed(self) -> bool:
+        return False
+
+    @property
+    def field_types(self) -> List[client.FieldTypes]:
+        return self._field_types
+
+    @property
+    def fields(self) -> List[List[str]]:
+        return [[f.name for f in types] for types in self.field_types]
+
+    @property
+    def scans_num(self) -> List[Optional[int]]:
+        return [None]
+
+    def __len__(self) -> int:
+        raise TypeError("len is not supported on live sources")
+
+    def __iter__(self) -> Iterator[List[Optional[LidarScan]]]:
+        while not self._cli.closed:
+            scan = self._cli.get_scan(self._timeout if self._timeout is not None else -1.0)
+            if scan is None:
+                if self._cli.closed:
+                    return
+                raise client.ClientTimeout(
+                    f"No scans received within {self._timeout}s from {self._url}.")
+            if not self._received:
+                self._field_types = [scan.field_types]
+                self._received = True
+            yield [scan]
+
+    def _seek(self, key: int) -> None:
+        raise RuntimeError("can not invoke __getitem__ on non-indexed source")
+
+    def __getitem__(self, key):
+        raise RuntimeError("can not invoke __getitem__ on non-indexed source")
+
+    def close(self) -> None:
+        if hasattr(self, "_cli") and self._cli:
+            self._cli.close()
+
+    def __del__(self) -> None:
+        self.close()
+
+    def _slice_iter(self, key: slice) -> Iterator[List[Optional[LidarScan]]]:
+        raise RuntimeError("cannot invoke _slice_iter on a non-indexed source")
+
+    def slice(self, key: slice) -> 'MultiScanSource':
+        """Constructs a MultiScanSource matching the specificed slice"""
+        raise RuntimeError("cannot invoke _slice_iter on a non-indexed source")
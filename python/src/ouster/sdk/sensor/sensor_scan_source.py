@@ -1,4 +1,4 @@
-from typing import List, Optional, Union, Iterator
+from typing import Dict, List, Optional, Union, Iterator
 
 import time
 import numpy as np
@@ -149,6 +149,28 @@ class SensorScanSource(ScansMulti):
     def dropped_scans(self) -> int:
         return self._cli.dropped_scans()
 
+    def stats(self) -> client.ScanSourceStats:
+        """Loss counters and, with latency stats enabled, the latency of each
+        stage from the sockets to the consumer, in nanoseconds."""
+        return self._cli.stats()
+
+    def enable_latency_stats(self, enable: bool = True) -> None:
+        """Start or stop recording scan counts and stage latencies for
+        ``stats()``. Starting clears what was recorded before."""
+        self._cli.enable_latency_stats(enable)
+
+    def metrics(self, labels: Optional[Dict[str, str]] = None) -> str:
+        """Health metrics of the source in the OpenMetrics text format, see
+        ``ouster.sdk.util.metrics.serve_metrics`` to serve them.
+
+        Args:
+            labels: labels of every sample, e.g. to tell sources apart
+        """
+        metrics = client.OpenMetrics()
+        client.add_metrics(metrics, self._cli.stats(), self._metadata,
+                           labels or {})
+        return str(metrics)
+
     @property
     def field_types(self) -> List[client.FieldTypes]:
         return self._field_types
@@ -20,3 +20,5 @@ from .extrinsics import img_aspect_ratio        # type: ignore
 from .progress_bar import progressbar
 
 from .forward_slicer import ForwardSlicer
+
+from .metrics import serve_metrics
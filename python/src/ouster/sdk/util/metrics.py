@@ -0,0 +1,58 @@
+"""
+Copyright (c) 2025, Ouster, Inc.
+All rights reserved.
+
+Serve OpenMetrics expositions over HTTP for Prometheus to scrape.
+"""
+import threading
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from typing import Callable
+
+from ouster.sdk.client import OpenMetrics
+
+
+def serve_metrics(collect: Callable[[], str], port: int,
+                  host: str = "") -> ThreadingHTTPServer:
+    """Serve the exposition returned by ``collect`` at ``/metrics``.
+
+    ``collect`` is called on every scrape, from the thread of the server, so
+    it must be thread safe, e.g. build a new exposition from ``stats()``::
+
+        source = SensorScanSource(hostnames)
+        server = serve_metrics(source.metrics, 9100)
+        ...
+        server.shutdown()
+
+    Args:
+        collect: returns the OpenMetrics text to serve
+        port: port to listen on, or 0 for any free port
+        host: address to listen on, by default all interfaces
+
+    Returns:
+        The server, running on a daemon thread. Call ``shutdown()`` to stop
+        it; ``server_address`` has the port it listens on.
+    """
+    class Handler(BaseHTTPRequestHandler):
+        def do_GET(self) -> None:
+            if self.path.split("?")[0] != "/metrics":
+                self.send_error(404)
+                return
+            try:
+                body = collect().encode()
+            except Exception as e:
+                self.send_error(500, str(e))
+                return
+            self.send_response(200)
+            self.send_header("Content-Type", OpenMetrics.content_type)
+            self.send_header("Content-Length", str(len(body)))
+            self.end_headers()
+            self.wfile.write(body)
+
+        def log_message(self, format, *args) -> None:
+            # scrapes every few seconds would flood the console
+            pass
+
+    server = ThreadingHTTPServer((host, port), Handler)
+    server.daemon_threads = True
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+    return server
@@ -3,9 +3,8 @@ from typing import (Union, Tuple, List, Optional, Sequence)
 
 import numpy as np
 
-import bisect
-
 from ouster.sdk import client
+from ouster.sdk._bindings.client import TrajectoryEvaluator as _TrajectoryEvaluator
 
 import logging
 
@@ -431,8 +430,8 @@ class TrajectoryEvaluator(Poser):
 
     TODO[pb]: Add function to add/remove knot poses from traj eval.
 
-    TODO: Optionally, we may want to implement these calculations in C++ and
-          use bindings to make it faster.
+    The interpolation itself runs natively, see
+    ``ouster.sdk._bindings.client.TrajectoryEvaluator``.
     """
 
     def __init__(self, poses: TrajPoses, *, time_bounds: Optional[float] = 0):
@@ -470,30 +469,29 @@ class TrajectoryEvaluator(Poser):
         self._poses = poses
         self._time_bounds = time_bounds
 
-        if len(self._poses) > 0:
-            # pre-calculating intermediaries: poses matrix and poses deltas
-
-            # converting all pose knots to homogeneous form
-            poses_arr = np.array([p[1] for p in self._poses])
-            self._poses_mat = poses_arr if is_pose_hom else exp_pose6(
-                poses_arr)
-
-            # precalculating deltas between adjacent poses
-            deltas_mat = np.matmul(np.linalg.inv(self._poses_mat[:-1]),
-                                   self._poses_mat[1:])
-            # we only need vec6 form for deltas to do interpolations
-            self._deltas = np.r_[np.zeros((1, 6)), log_pose(deltas_mat)]
+        # converting all pose knots to homogeneous form
+        poses_arr = np.array([p[1] for p in self._poses], dtype=np.float64)
+        poses_mat = poses_arr.reshape(-1, 4, 4) if is_pose_hom else exp_pose6(
+            poses_arr.reshape(-1, 6))
 
-        # store keys separately for bisect function
         self._ts_keys = [x[0] for x in self._poses]
+        # knot timestamps go relative to the first one, so that large integer
+        # timestamps, e.g. in ns, keep their precision as floats
+        self._ts_origin = self._ts_keys[0]
+        self._native = _TrajectoryEvaluator(
+            [float(t - self._ts_origin) for t in self._ts_keys], poses_mat)
+
+    def _relative_ts(self, ts: Union[Sequence[Numeric], np.ndarray]) -> np.ndarray:
+        return (np.asarray(ts) - self._ts_origin).astype(np.float64)
 
     def _check_ts_and_bounds(self, ts: Union[Sequence[Numeric], np.ndarray]):
         """Checks whether `ts` in the trajectory poses timestamps with bounds"""
         # check time non-decreasing order
         if len(ts) > 1:
-            for t1, t2 in zip(ts[:-1], ts[1:]):
-                assert t1 <= t2, f"Expected non-decreasing timestamps " \
-                    f"but found {t1} > {t2}"
+            ts_arr = np.asarray(ts)
+            decreasing = np.flatnonzero(ts_arr[1:] < ts_arr[:-1])
+            assert decreasing.size == 0, f"Expected non-decreasing timestamps " \
+                f"but found {ts_arr[decreasing[0]]} > {ts_arr[decreasing[0] + 1]}"
         # no check for bounds is needed
         if self._time_bounds is None:
             return
@@ -519,27 +517,7 @@ class TrajectoryEvaluator(Poser):
 
         self._check_ts_and_bounds([ts])
 
-        if ts < self._poses[0][0]:
-            # out on the left
-            dt = (ts - self._ts_keys[0]) / (self._ts_keys[1] -
-                                            self._ts_keys[0])
-            pose_d_dt = exp_pose6(self._deltas[1] * dt)
-            pose_base = self._poses_mat[0]
-        elif ts >= self._poses[-1][0]:
-            # out on the right
-            dt = (ts - self._ts_keys[-2]) / (self._ts_keys[-1] -
-                                             self._ts_keys[-2])
-            pose_d_dt = exp_pose6(self._deltas[-1] * dt)
-            pose_base = self._poses_mat[-2]
-        else:
-            # within traj poses timestamps
-            curr_idx = bisect.bisect_right(self._ts_keys, ts)
-            dt = (ts - self._ts_keys[curr_idx - 1]) / (
-                self._ts_keys[curr_idx] - self._ts_keys[curr_idx - 1])
-            pose_d_dt = exp_pose6(self._deltas[curr_idx] * dt)
-            pose_base = self._poses_mat[curr_idx - 1]
-
-        return np.dot(pose_base, pose_d_dt)
+        return self._native.poses_at(self._relative_ts([ts]))[0]
 
     def poses_at(self, ts: Union[Sequence[Numeric], np.ndarray]) -> np.ndarray:
         """Calculates multiple poses (4x4 matrices) at a given `ts` timestamps."""
@@ -548,56 +526,7 @@ class TrajectoryEvaluator(Poser):
 
         self._check_ts_and_bounds(ts)
 
-        ts_size = len(ts)
-
-        pose_d_dts = np.zeros((ts_size, 6))
-        dts = np.zeros(ts_size)
-        curr_idx_1_poses = np.tile(np.eye(4), (ts_size, 1, 1))
-
-        curr_idx = 0
-
-        for i in range(ts_size):
-            if ts[i] < self._poses[0][0]:
-                # out on the left
-                dts[i] = (ts[i] - self._ts_keys[0]) / (self._ts_keys[1] -
-                                                       self._ts_keys[0])
-                pose_d_dts[i] = self._deltas[1]
-                curr_idx_1_poses[i] = self._poses_mat[0]
-            elif ts[i] >= self._poses[-1][0]:
-                # out on the right
-                dts[i] = (ts[i] - self._ts_keys[-2]) / (self._ts_keys[-1] -
-                                                        self._ts_keys[-2])
-                pose_d_dts[i] = self._deltas[-1]
-                curr_idx_1_poses[i] = self._poses_mat[-2]
-            else:
-                if curr_idx == 0:
-                    # reach the data range by the curr_idx first
-                    curr_idx = bisect.bisect_right(self._ts_keys, ts[i])
-                elif ts[i] > self._ts_keys[curr_idx]:
-                    # current pose knot (to the right) is already behind, need
-                    # to advance to the next pose knot
-
-                    if curr_idx + 1 >= len(self._poses):
-                        # no more poses
-                        break
-
-                    # trying to get just next pose
-                    curr_idx += 1
-
-                    if ts[i] > self._ts_keys[curr_idx]:
-                        # do bisect again, because it's a discontinuity here
-                        # i.e. the current ts[i] is too far from the
-                        # previous one [i-1]
-                        curr_idx = bisect.bisect_right(self._ts_keys, ts[i])
-
-                dts[i] = (ts[i] - self._ts_keys[curr_idx - 1]) / (
-                    self._ts_keys[curr_idx] - self._ts_keys[curr_idx - 1])
-                pose_d_dts[i] = self._deltas[curr_idx]
-                curr_idx_1_poses[i] = self._poses_mat[curr_idx - 1]
-
-        pose_d_dts = np.einsum("i,ij->ij", dts, pose_d_dts)
-        pose_d_dts_mat = exp_pose6(pose_d_dts)
-        return np.matmul(curr_idx_1_poses, pose_d_dts_mat)
+        return self._native.poses_at(self._relative_ts(ts))
 
     def __bool__(self) -> bool:
         return bool(self._poses)
@@ -616,15 +545,17 @@ class TrajectoryEvaluator(Poser):
                     instead of scan.timestamp for pose calculations.
         """
         valid_cols = (np.bitwise_and(scan.status, 1) == 1)
-        if col_ts is not None and col_ts.ndim == 1 and col_ts.size == scan.w:
-            ts = col_ts[valid_cols]
-        else:
-            ts = scan.timestamp[valid_cols]
+        if col_ts is None or col_ts.ndim != 1 or col_ts.size != scan.w:
+            col_ts = scan.timestamp
 
+        ts = col_ts[valid_cols]
         if ts.size == 0:
             return scan
 
-        scan.pose[valid_cols] = self.poses_at(ts)
+        self._check_ts_and_bounds(ts)
+
+        # poses go straight into scan.pose, leaving invalid columns as is
+        self._native.pose_scan(scan, self._relative_ts(col_ts))
         return scan
 
     def __len__(self) -> int:
@@ -10,7 +10,10 @@ from ouster.sdk._bindings.viz import MouseButton
 from ouster.sdk._bindings.viz import MouseButtonEvent
 from ouster.sdk._bindings.viz import EventModifierKeys
 from ouster.sdk._bindings.viz import PointViz
+from ouster.sdk._bindings.viz import FrameStats
 from ouster.sdk._bindings.viz import Cloud
+from ouster.sdk._bindings.viz import LodCloud
+from ouster.sdk._bindings.viz import KeyNormalization
 from ouster.sdk._bindings.viz import Image
 from ouster.sdk._bindings.viz import Cuboid
 from ouster.sdk._bindings.viz import Label
@@ -889,6 +889,9 @@ class SimpleViz:
         # continuous screenshots recording
         self._viz_img_recording = False
 
+        # frame timing overlay
+        self._frame_stats_shown = False
+
         key_bindings: Dict[Tuple[int, int], Callable[[SimpleViz], None]] = {
             (ord(','), 0): partial(SimpleViz.seek_relative, n_frames=-1),
             (ord(','), 2): partial(SimpleViz.seek_relative, n_frames=-10),
@@ -896,6 +899,7 @@ class SimpleViz:
             (ord('.'), 2): partial(SimpleViz.seek_relative, n_frames=10),
             (ord(' '), 0): SimpleViz.toggle_pause,
             (ord('O'), 0): SimpleViz.toggle_osd,
+            (ord('O'), 1): SimpleViz.toggle_frame_stats,
             (ord('/'), 1): SimpleViz.toggle_help,
             (ord('X'), 1): SimpleViz.toggle_img_recording,
             (ord('Z'), 1): SimpleViz.screenshot,
@@ -903,6 +907,7 @@ class SimpleViz:
 
         key_definitions: Dict[str, str] = {
             'o': "Toggle information overlay",
+            'SHIFT+o': "Toggle frame timing overlay",
             'SHIFT+x': "Toggle a continuous saving of screenshots",
             'SHIFT+z': "Take a screenshot!",
             ". / ,": "Step forward one frame",
@@ -984,6 +989,11 @@ class SimpleViz:
             self._update_playback_osd()
             self._scan_viz.draw()
 
+    def toggle_frame_stats(self) -> None:
+        """Show or hide where the time of each frame goes."""
+        self._frame_stats_shown = not self._frame_stats_shown
+        self._viz.show_frame_stats(self._frame_stats_shown)
+
     def toggle_img_recording(self) -> None:
         if self._viz_img_recording:
             self._viz_img_recording = False
@@ -236,7 +236,7 @@ class SensorModel:
                 elif field_name == ChanField.NEAR_IR:
                     mode = SimpleMode(field_name, info=self._meta, use_ae=True, use_buc=True)
                 else:
-                    mode = SimpleMode(field_name, info=self._meta)
+                    mode = SimpleMode(field_name, info=self._meta, gpu_ae=True)
         return mode
 
     # TODO[tws] rename
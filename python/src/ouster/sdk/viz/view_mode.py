@@ -100,7 +100,8 @@ class SimpleMode(ImageCloudMode):
                  prefix: Optional[str] = "",
                  suffix: Optional[str] = "",
                  use_ae: bool = True,
-                 use_buc: bool = False) -> None:
+                 use_buc: bool = False,
+                 gpu_ae: bool = False) -> None:
         """
         Args:
             info: sensor metadata used mainly for destaggering here
@@ -109,6 +110,8 @@ class SimpleMode(ImageCloudMode):
             suffix: name suffix
             use_ae: if True, use AutoExposure for the field
             use_buc: if True, use BeamUniformityCorrector for the field
+            gpu_ae: if True, clouds of unsigned integer fields are colored with the raw
+                field values normalized on the GPU, when only AutoExposure is used
         """
         self._info = info
         self._fields = [field]
@@ -117,6 +120,7 @@ class SimpleMode(ImageCloudMode):
             self._fields.append(field2)
         self._ae = _utils.AutoExposure() if use_ae else None
         self._buc = _utils.BeamUniformityCorrector() if use_buc else None
+        self._gpu_ae = gpu_ae and use_ae and not use_buc
         self._prefix = f"{prefix}: " if prefix else ""
         self._suffix = f" ({suffix})" if suffix else ""
         self._wrap_name = lambda n: f"{self._prefix}{n}{self._suffix}"
@@ -167,6 +171,11 @@ class SimpleMode(ImageCloudMode):
                         cloud: Cloud,
                         ls: client.LidarScan,
                         return_num: int = 0) -> None:
+        if self._gpu_ae and self.enabled(ls, return_num):
+            field = ls.field(self._fields[return_num])
+            if field.dtype in (np.uint8, np.uint16, np.uint32):
+                cloud.set_key_raw(field)
+                return
         key_data = self._prepare_data(ls, return_num)
         if key_data is not None:
             cloud.set_key(key_data)
@@ -2,6 +2,7 @@ from re import escape
 import pytest
 import numpy as np
 import hashlib
+import json
 import shutil
 import os
 from typing import cast, Iterator
@@ -12,7 +13,7 @@ from ouster.sdk import open_source
 import ouster.sdk._bindings.osf as osf
 import ouster.sdk.client as client
 from ouster.sdk.client import ChanField, FieldType, LidarMode, LidarScan, SensorInfo
-from ouster.sdk._bindings.osf import LidarScanStream, Encoder, PngLidarScanEncoder
+from ouster.sdk._bindings.osf import LidarScanStream, Encoder, PngLidarScanEncoder, ZstdLidarScanEncoder
 
 
 @pytest.fixture
@@ -429,6 +430,334 @@ def test_writer_with_encoder(tmp_path, input_info) -> None:
         tmp_path, input_info, 4) < get_size_for_compression_amount(tmp_path, input_info, 0)
 
 
+def test_writer_with_zstd_encoder(tmp_path, input_info) -> None:
+    """Scans of a stream encoded with zstd should read back unchanged next to PNG encoded ones."""
+    file_name = tmp_path / "test.osf"
+    scans = []
+    for i in range(2):
+        scan = client.LidarScan(input_info)
+        scan.field(ChanField.RANGE)[:] = np.random.randint(0, 100000, scan.field(ChanField.RANGE).shape)
+        scans.append(scan)
+    encoder = Encoder(PngLidarScanEncoder(1))
+    encoder.set_lidar_scan_encoder(0, ZstdLidarScanEncoder())
+    with osf.Writer(str(file_name), [input_info, input_info], [], 0, encoder) as writer:
+        writer.save(0, scans[0], 1)
+        writer.save(1, scans[1], 2)
+
+    reader = osf.Reader(str(file_name))
+    recovered = [msg.decode() for msg in reader.messages()]
+    assert len(recovered) == 2
+    for scan, rec in zip(scans, recovered):
+        assert np.array_equal(rec.field(ChanField.RANGE), scan.field(ChanField.RANGE))
+
+
+@pytest.mark.parametrize("writer_type", [osf.Writer, osf.AsyncWriter])
+def test_writer_with_keyframe_interval(tmp_path, input_info, writer_type) -> None:
+    """Delta frames should read back unchanged, in order or not."""
+    file_name = tmp_path / "test.osf"
+    scans = []
+    for i in range(7):
+        scan = client.LidarScan(input_info)
+        scan.field(ChanField.RANGE)[:] = np.random.randint(0, 100000, scan.field(ChanField.RANGE).shape)
+        scan.field(ChanField.REFLECTIVITY)[:] = np.random.randint(0, 255, scan.field(ChanField.REFLECTIVITY).shape)
+        scans.append(scan)
+    encoder = Encoder(PngLidarScanEncoder(1))
+    encoder.keyframe_interval = 3
+    assert encoder.keyframe_interval == 3
+    with writer_type(str(file_name), [input_info], [], 0, encoder) as writer:
+        for i, scan in enumerate(scans):
+            writer.save(0, scan, i + 1)
+
+    reader = osf.Reader(str(file_name))
+    msgs = list(reader.messages())
+    assert len(msgs) == len(scans)
+    for i in [5, 0, 4, 6, 1, 2, 3]:
+        rec = msgs[i].decode()
+        assert np.array_equal(rec.field(ChanField.RANGE), scans[i].field(ChanField.RANGE))
+        assert np.array_equal(rec.field(ChanField.REFLECTIVITY), scans[i].field(ChanField.REFLECTIVITY))
+
+
+@pytest.mark.parametrize("writer_type", [osf.Writer, osf.AsyncWriter])
+def test_writer_with_chunk_io(tmp_path, input_info, writer_type) -> None:
+    """Chunks written on the background thread into preallocated space should read back unchanged."""
+    file_name = tmp_path / "test.osf"
+    scans = []
+    for i in range(4):
+        scan = client.LidarScan(input_info)
+        scan.field(ChanField.RANGE)[:] = np.random.randint(0, 100000, scan.field(ChanField.RANGE).shape)
+        scans.append(scan)
+    options = osf.ChunkIoOptions()
+    options.background = True
+    options.preallocate_bytes = 1 << 20
+    options.sync_every_chunk = True
+    with writer_type(str(file_name), [input_info], [], 1) as writer:
+        writer.set_chunk_io(options)
+        for i, scan in enumerate(scans):
+            writer.save(0, scan, i + 1)
+
+    reader = osf.Reader(str(file_name))
+    msgs = list(reader.messages())
+    assert len(msgs) == len(scans)
+    for msg, scan in zip(msgs, scans):
+        assert np.array_equal(msg.decode().field(ChanField.RANGE), scan.field(ChanField.RANGE))
+
+
+@pytest.mark.parametrize("writer_type", [osf.Writer, osf.AsyncWriter])
+def test_writer_with_chunk_policy(tmp_path, input_info, writer_type) -> None:
+    """Chunks should be finished after the number of messages and the duration the policies allow."""
+    file_name = tmp_path / "test.osf"
+    policy = osf.ChunkPolicy()
+    policy.max_messages = 3
+    sensor_policy = osf.ChunkPolicy()
+    sensor_policy.max_duration = 1
+    with writer_type(str(file_name), [input_info]) as writer:
+        writer.set_chunk_policy(policy)
+        writer.set_sensor_chunk_policy(0, sensor_policy)
+        for i in range(5):
+            writer.save(0, client.LidarScan(input_info), i + 1)
+
+    chunks = json.loads(osf.dump_metadata(str(file_name), True))["metadata"]["chunks"]
+    assert [(c["start_ts"], c["end_ts"]) for c in chunks] == [(1, 2), (3, 4), (5, 5)]
+
+
+def test_scan_read_ahead(tmp_path, input_info) -> None:
+    """Scans decoded ahead should come in message order, equal to the scans decoded one by one."""
+    file_name = tmp_path / "test.osf"
+    scans = []
+    with osf.Writer(str(file_name), [input_info], [], 1) as writer:
+        for i in range(6):
+            scan = client.LidarScan(input_info)
+            scan.field(ChanField.RANGE)[:] = np.random.randint(0, 100000, scan.field(ChanField.RANGE).shape)
+            scans.append(scan)
+            writer.save(0, scan, i + 1)
+
+    reader = osf.Reader(str(file_name))
+    options = osf.ReadAheadOptions()
+    options.scans = 2
+    options.thread_pool = osf.ThreadPool(2)
+    read = list(osf.ScanReadAhead(reader, [], reader.start_ts, reader.end_ts, [ChanField.RANGE], options))
+    assert [ts for _, ts, _ in read] == [1, 2, 3, 4, 5, 6]
+    for (stream_id, _, ls), scan in zip(read, scans):
+        assert reader.meta_store[stream_id].of(LidarScanStream)
+        assert list(ls.fields) == [ChanField.RANGE]
+        assert np.array_equal(ls.field(ChanField.RANGE), scan.field(ChanField.RANGE))
+
+
+def test_reader_scan_cache(tmp_path, input_info) -> None:
+    """Scans read again from the cache should be copies of the decoded ones."""
+    file_name = tmp_path / "test.osf"
+    scans = []
+    with osf.Writer(str(file_name), [input_info], [], 1) as writer:
+        for i in range(3):
+            scan = client.LidarScan(input_info)
+            scan.field(ChanField.RANGE)[:] = np.random.randint(0, 100000, scan.field(ChanField.RANGE).shape)
+            scans.append(scan)
+            writer.save(0, scan, i + 1)
+
+    reader = osf.Reader(str(file_name))
+    cache = osf.ReaderCacheOptions()
+    cache.scan_bytes = 1 << 30
+    reader.set_cache(cache)
+    assert reader.cache_options().scan_bytes == 1 << 30
+    for _ in range(2):
+        read = list(osf.ScanReadAhead(reader, [], reader.start_ts, reader.end_ts))
+        assert len(read) == len(scans)
+        for (_, _, ls), scan in zip(read, scans):
+            assert np.array_equal(ls.field(ChanField.RANGE), scan.field(ChanField.RANGE))
+            ls.field(ChanField.RANGE)[:] = 0
+
+
+def test_reader_pread(tmp_path, input_info) -> None:
+    """A file read with pread should give the same scans as a memory mapped one."""
+    file_name = tmp_path / "test.osf"
+    with osf.Writer(str(file_name), [input_info], [], 1) as writer:
+        for i in range(3):
+            scan = client.LidarScan(input_info)
+            scan.field(ChanField.RANGE)[:] = np.random.randint(0, 100000, scan.field(ChanField.RANGE).shape)
+            writer.save(0, scan, i + 1)
+
+    options = osf.FileOptions()
+    options.backend = osf.FileBackend.PREAD
+    options.read_ahead = 64 * 1024
+    reader = osf.Reader(str(file_name))
+    pread_reader = osf.Reader(str(file_name), options)
+    count = 0
+    for msg, pread_msg in zip(reader.messages(), pread_reader.messages()):
+        assert pread_msg.ts == msg.ts
+        assert np.array_equal(pread_msg.decode().field(ChanField.RANGE), msg.decode().field(ChanField.RANGE))
+        count += 1
+    assert count == 3
+
+
+def test_message_decode_into(tmp_path, input_info) -> None:
+    """Messages decoded into the same scan should match decoding them anew."""
+    file_name = tmp_path / "test.osf"
+    with osf.Writer(str(file_name), [input_info], [], 1) as writer:
+        for i in range(3):
+            scan = client.LidarScan(input_info)
+            scan.field(ChanField.RANGE)[:] = np.random.randint(0, 100000, scan.field(ChanField.RANGE).shape)
+            writer.save(0, scan, i + 1)
+
+    reader = osf.Reader(str(file_name))
+    scan = LidarScan(1, 1)
+    for msg in reader.messages():
+        assert np.array_equal(msg.view, np.frombuffer(bytes(msg.buffer), dtype=np.uint8))
+        assert not msg.view.flags.writeable
+        assert msg.decode_into(scan)
+        assert scan == msg.decode()
+    assert msg.decode_into(scan, [ChanField.RANGE])
+    assert list(scan.fields) == [ChanField.RANGE]
+
+
+def test_reader_lazy_open(tmp_path, input_info) -> None:
+    """A file opened lazily should give the same messages once indexed."""
+    file_name = tmp_path / "test.osf"
+    with osf.Writer(str(file_name), [input_info], [], 1) as writer:
+        for i in range(3):
+            writer.save(0, client.LidarScan(input_info), i + 1)
+
+    options = osf.FileOptions()
+    options.lazy_open = True
+    reader = osf.Reader(str(file_name), options)
+    assert reader.has_stream_info
+    msgs = list(reader.messages())
+    assert [msg.ts for msg in msgs] == [1, 2, 3]
+    assert reader.ts_by_message_idx(msgs[0].id, 2) == 3
+
+
+def test_reader_stream_messages(tmp_path, input_info) -> None:
+    """Each stream should be read by its own iterator, in timestamp order."""
+    file_name = tmp_path / "test.osf"
+    with osf.Writer(str(file_name), [input_info, input_info], [], 1) as writer:
+        for i in range(6):
+            writer.save(i % 2, client.LidarScan(input_info), i + 1)
+
+    reader = osf.Reader(str(file_name))
+    iters = reader.stream_messages([], reader.start_ts, reader.end_ts)
+    assert len(iters) == 2
+    assert [msg.ts for msg in iters[0]] == [1, 3, 5]
+    assert [msg.ts for msg in iters[1]] == [2, 4, 6]
+    assert [msg.id for msg in reader.stream_messages([1], 3, 6)[0]] == [1, 1]
+
+
+def test_reader_http(tmp_path, input_info) -> None:
+    """A file served over HTTP should read the same as the local file, through range requests."""
+    import http.server
+    import re
+    import threading
+
+    file_name = tmp_path / "test.osf"
+    with osf.Writer(str(file_name), [input_info], [], 1) as writer:
+        for i in range(3):
+            scan = client.LidarScan(input_info)
+            scan.field(ChanField.RANGE)[:] = np.random.randint(0, 100000, scan.field(ChanField.RANGE).shape)
+            writer.save(0, scan, i + 1)
+    data = file_name.read_bytes()
+    ranges = []
+
+    class RangeHandler(http.server.BaseHTTPRequestHandler):
+        def log_message(self, *args) -> None:
+            pass
+
+        def do_GET(self) -> None:
+            first, last = map(int, re.match(r"bytes=(\d+)-(\d+)", self.headers["Range"]).groups())
+            last = min(last, len(data) - 1)
+            ranges.append((first, last))
+            self.send_response(206)
+            self.send_header("Content-Range", f"bytes {first}-{last}/{len(data)}")
+            self.send_header("Content-Length", str(last - first + 1))
+            self.end_headers()
+            self.wfile.write(data[first:last + 1])
+
+    server = http.server.ThreadingHTTPServer(("127.0.0.1", 0), RangeHandler)
+    thread = threading.Thread(target=server.serve_forever, daemon=True)
+    thread.start()
+    try:
+        options = osf.FileOptions()
+        options.read_ahead = 64 * 1024
+        url = f"http://127.0.0.1:{server.server_address[1]}/test.osf"
+        http_reader = osf.Reader(url, options)
+        reader = osf.Reader(str(file_name))
+        count = 0
+        for msg, http_msg in zip(reader.messages(), http_reader.messages()):
+            assert http_msg.ts == msg.ts
+            assert np.array_equal(http_msg.decode().field(ChanField.RANGE), msg.decode().field(ChanField.RANGE))
+            count += 1
+        assert count == 3
+        # fetched by parts, not as a whole
+        assert max(last - first + 1 for first, last in ranges) < len(data)
+    finally:
+        server.shutdown()
+        server.server_close()
+
+
+def test_multi_reader(tmp_path, input_info) -> None:
+    """A recording split into files should read as one, in timestamp order."""
+    files = []
+    for f in [1, 0]:
+        files.append(str(tmp_path / f"test_{f}.osf"))
+        with osf.Writer(files[-1], [input_info], [], 1) as writer:
+            for i in range(3):
+                writer.save(0, client.LidarScan(input_info), 10 * f + i + 1)
+
+    reader = osf.MultiReader(files)
+    assert len(reader) == 2
+    assert reader.filename(0) == files[1]
+    assert (reader.start_ts, reader.end_ts) == (1, 13)
+    assert [msg.ts for msg in reader.messages()] == [1, 2, 3, 11, 12, 13]
+    assert [msg.ts for msg in reader.messages(2, 11)] == [2, 3, 11]
+    stream_id = next(reader.messages()).id
+    assert reader.message_count(stream_id) == 6
+    assert reader.ts_by_message_idx(stream_id, 4) == 12
+    assert reader.ts_by_message_idx(stream_id, 6) is None
+    assert ilen(reader.chunks()) == sum(ilen(reader.reader(i).chunks()) for i in range(len(reader)))
+
+
+def test_recover_from_checkpoint(tmp_path, input_info) -> None:
+    """A file copied before the writer closed should recover the chunks up to the last checkpoint and after it."""
+    file_name = tmp_path / "test.osf"
+    crashed_file_name = tmp_path / "crashed.osf"
+    scans = []
+    with osf.Writer(str(file_name), [input_info], [], 1) as writer:
+        writer.checkpoint_interval = 2
+        assert writer.checkpoint_interval == 2
+        for i in range(5):
+            scan = client.LidarScan(input_info)
+            scan.field(ChanField.RANGE)[:] = np.random.randint(0, 100000, scan.field(ChanField.RANGE).shape)
+            scans.append(scan)
+            writer.save(0, scan, i + 1)
+        # the last scan is still in its chunk
+        shutil.copyfile(file_name, crashed_file_name)
+
+    assert osf.recover_osf_file(str(crashed_file_name)) == os.path.getsize(crashed_file_name)
+    reader = osf.Reader(str(crashed_file_name))
+    msgs = list(reader.messages())
+    assert len(msgs) == 4
+    for msg, scan in zip(msgs, scans):
+        assert np.array_equal(msg.decode().field(ChanField.RANGE), scan.field(ChanField.RANGE))
+
+
+def test_slice_and_merge_osf_files(tmp_path, input_info) -> None:
+    """Slicing and merging OSF files should copy the selected messages."""
+    files = [str(tmp_path / f"part_{f}.osf") for f in range(2)]
+    for f, file_name in enumerate(files):
+        with osf.Writer(file_name, [input_info], [], 1) as writer:
+            for i in range(3):
+                writer.save(0, client.LidarScan(input_info), 10 * f + i + 1)
+
+    merged = str(tmp_path / "merged.osf")
+    assert osf.merge_osf_files(files, merged) == os.path.getsize(merged)
+    reader = osf.Reader(merged)
+    assert [msg.ts for msg in reader.messages()] == [1, 2, 3, 11, 12, 13]
+
+    sliced = str(tmp_path / "sliced.osf")
+    assert osf.slice_osf_file(merged, sliced, 2, 11) == os.path.getsize(sliced)
+    assert [msg.ts for msg in osf.Reader(sliced).messages()] == [2, 3, 11]
+    stream_id = next(reader.messages()).id
+    osf.slice_osf_file(merged, sliced, 0, 20, [stream_id + 100])
+    assert ilen(osf.Reader(sliced).messages()) == 0
+
+
 def test_async_writer_exception(tmp_path, input_info) -> None:
     """Calling get() on the future returned from the save method should propagate an exception raised from the save
     thread."""
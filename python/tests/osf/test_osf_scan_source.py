@@ -2,6 +2,7 @@
 import pytest
 import tempfile
 import ouster.sdk.osf as osf
+from ouster.sdk._bindings.osf import Reader, LidarScanStream
 import ouster.sdk.client as client
 import os
 import sys
@@ -51,6 +52,42 @@ def test_scans_num(input_info):
         os.unlink(f.name)
 
 
+def test_collated_index(input_info, tmp_path):
+    """len, indexing and the stream index come from the metadata alone"""
+    path = str(tmp_path / "collated.osf")
+    with osf.Writer(path, [input_info, input_info]) as w:
+        # the second sensor misses its third scan
+        for i in range(5):
+            for sensor in [0, 1]:
+                if sensor == 1 and i == 2:
+                    continue
+                ts = 100_000_000 * (i + 1) + 10 * sensor
+                scan = client.LidarScan(128, 1024)
+                scan.status[:] = 0x1
+                scan.packet_timestamp[:] = ts
+                w.save(sensor, scan, ts)
+
+    reader = Reader(path)
+    stream_ids = sorted(reader.meta_store.find(LidarScanStream).keys())
+    index = reader.stream_index(stream_ids[0])
+    assert index.message_count == 5
+    assert index.timestamps.tolist() == [100_000_000 * (i + 1) for i in range(5)]
+    assert index.chunk_offset(4) in index.chunk_offsets.tolist()
+    assert reader.collate_messages(stream_ids).tolist() == [[0, 0], [1, 1], [2, -1], [3, 2], [4, 3]]
+
+    src = osf.OsfScanSource(path)
+    try:
+        assert src.scans_num == [5, 4]
+        assert len(src) == 5
+        assert src[2][1] is None
+        assert src[2][0].packet_timestamp[0] == 300_000_000
+        assert src[3][1].packet_timestamp[0] == 400_000_010
+        assert [scans[0].packet_timestamp[0] for scans in src[1:4]] == [
+            200_000_000, 300_000_000, 400_000_000]
+    finally:
+        src.close()
+
+
 def test_osf_open(input_osf_file):
     """Make sure the file opens and has correct metadata in the scans"""
     source = osf.OsfScanSource(str(input_osf_file))
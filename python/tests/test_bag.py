@@ -161,3 +161,20 @@ def test_bag_metadata(tmp_path, test_bag_file):
         assert "prod_sn" in result.output
         assert "initialization_id" in result.output
         assert "imu_intrinsics" in result.output
+
+
+def test_bag_native_packets(test_bag_file, monkeypatch):
+    """ROS1 bags are read natively, with the same packets as rosbags"""
+    native = BagPacketSource(test_bag_file)
+    assert native._batchable
+    native_packets = [(idx, p.host_timestamp, bytes(p.buf)) for idx, p in native]
+    assert len(native_packets) == 42
+    native.close()
+
+    monkeypatch.setattr("ouster.sdk.bag.bag_packet_source._pcap.BagPacketReader.readable",
+                        lambda _: False)
+    rosbags = BagPacketSource(test_bag_file)
+    assert not rosbags._batchable
+    assert [(idx, p.host_timestamp, bytes(p.buf)) for idx, p in rosbags] == native_packets
+    assert rosbags.metadata == native.metadata
+    rosbags.close()
@@ -6,13 +6,16 @@ import pytest
 import subprocess
 import sys
 import json
+import socket
 import tempfile
+import numpy as np
 from typing import List
 from click.testing import CliRunner
 
 from ouster.cli import core
 from ouster.cli.core.cli_args import CliArgs
 from ouster.cli.plugins import source, source_osf  # noqa: F401
+import ouster.sdk._bindings.osf as osf
 from ouster.sdk.io_type import io_type_from_extension, OusterIoType
 
 from tests.conftest import PCAPS_DATA_DIR, OSFS_DATA_DIR
@@ -500,3 +503,104 @@ def test_source_osf_dump_short(test_osf_file, runner):
     assert 'buffer' not in meta['metadata']['entries'][0]
     assert meta['metadata']['entries'][0]['type'] == "ouster/v1/os_sensor/LidarSensor"
     assert result.exit_code == 0
+
+
+def test_source_osf_transcode(test_osf_file, runner, tmp_path):
+    """ouster-cli source <src>.osf transcode <output>
+    should re-encode the scans keeping only the requested fields"""
+    output = str(tmp_path / "transcoded.osf")
+    args = ['source', test_osf_file, 'transcode', '-f', 'RANGE', '-e', 'zstd', '-t', '2', output]
+    result = runner.invoke(core.cli, args)
+    assert result.exit_code == 0, result.output
+    scans = [msg.decode() for msg in osf.Reader(output).messages()]
+    assert len(scans) == len(list(osf.Reader(test_osf_file).messages()))
+    assert all(list(scan.fields) == ['RANGE'] for scan in scans)
+
+    # an existing output needs --overwrite
+    result = runner.invoke(core.cli, args)
+    assert result.exit_code != 0
+    assert "already exists" in result.output
+
+
+def test_source_osf_compact(test_osf_file, runner, tmp_path):
+    """ouster-cli source <src>.osf compact <output>
+    should copy the messages into a chunk per stream"""
+    output = str(tmp_path / "compacted.osf")
+    result = runner.invoke(core.cli, ['source', test_osf_file, 'compact', output])
+    assert result.exit_code == 0, result.output
+    reader = osf.Reader(output)
+    source = osf.Reader(test_osf_file)
+    assert ([msg.ts for msg in reader.messages()] ==
+            [msg.ts for msg in source.messages()])
+    assert len(list(reader.chunks())) <= len(list(source.chunks()))
+
+
+def test_source_osf_bench(test_osf_file, runner):
+    """ouster-cli source <src>.osf bench
+    should report the chunk, decode and encoder measurements"""
+    args = ['source', test_osf_file, 'bench', '-n', '2', '-f', 'RANGE', '-e', 'png:1,zstd:3']
+    result = runner.invoke(core.cli, args)
+    assert result.exit_code == 0, result.output
+    assert "crc:" in result.output
+    assert "parallel decode:" in result.output
+    assert "png:1" in result.output and "zstd:3" in result.output
+
+    result = runner.invoke(core.cli, ['source', test_osf_file, 'bench', '-e', 'lz4'])
+    assert result.exit_code != 0
+    assert "Invalid encoder" in result.output
+
+
+def test_source_pcap_replay(test_pcap_file, runner):
+    """ouster-cli source <src>.pcap replay
+    should send the packets of the pcap to the destination"""
+    with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as sock:
+        sock.bind(("127.0.0.1", 0))
+        port = sock.getsockname()[1]
+        # the lidar port of the test pcap is 7502
+        args = ['source', test_pcap_file, 'replay', '--speed', '0', '--port-offset', str(port - 7502)]
+        result = runner.invoke(core.cli, args)
+        assert result.exit_code == 0, result.output
+        assert f"7502 -> 127.0.0.1:{port}" in result.output
+        sock.settimeout(1.0)
+        assert len(sock.recv(65536)) > 0
+    result = runner.invoke(core.cli, args[:-1] + ['--overwrite', output])
+    assert result.exit_code == 0, result.output
+
+
+def test_source_pcap_convert(test_pcap_file, runner, tmp_path):
+    """ouster-cli source <src>.pcap convert <output>
+    should convert the lidar packets to scans of an OSF file natively"""
+    output = str(tmp_path / "converted.osf")
+    args = ['source', test_pcap_file, 'convert', '-f', 'RANGE,SIGNAL', '-t', '2', output]
+    result = runner.invoke(core.cli, args)
+    assert result.exit_code == 0, result.output
+    scans = [msg.decode() for msg in osf.Reader(output).messages()]
+    assert len(scans) > 0
+    assert all(set(scan.fields) == {'RANGE', 'SIGNAL'} for scan in scans)
+
+    # an existing output needs --overwrite
+    result = runner.invoke(core.cli, args)
+    assert result.exit_code != 0
+    assert "already exists" in result.output
+
+
+def test_source_pcap_save_native(test_pcap_file, runner, tmp_path):
+    """ouster-cli source <src>.pcap reduce clip save <output>.osf
+    should run natively and save the scans the python pipeline does"""
+    native = str(tmp_path / "native.osf")
+    python = str(tmp_path / "python.osf")
+    chain = ['reduce', '32', 'clip', 'RANGE', ':5m', 'save']
+    result = runner.invoke(core.cli, CliArgs(['source', test_pcap_file] + chain + [native]).args)
+    assert result.exit_code == 0, result.output
+    # soft id checking needs the python pipeline
+    result = runner.invoke(core.cli, CliArgs(['source', '-s', test_pcap_file] + chain + [python]).args)
+    assert result.exit_code == 0, result.output
+
+    native_scans = [msg.decode() for msg in osf.Reader(native).messages()]
+    python_scans = [msg.decode() for msg in osf.Reader(python).messages()]
+    assert len(native_scans) == len(python_scans) > 0
+    for scan, expected in zip(native_scans, python_scans):
+        assert scan.h == expected.h == 32
+        assert scan.frame_id == expected.frame_id
+        assert np.array_equal(scan.field('RANGE'), expected.field('RANGE'))
+        assert scan.field('RANGE').max() <= 5000
@@ -190,6 +190,25 @@ def test_scan_header_ref() -> None:
     assert np.all(status == 0x01)
 
 
+def test_scan_views_share_memory() -> None:
+    """Test that fields, headers and pose are exchanged without copies."""
+
+    ls = client.LidarScan(512, 16)
+    for view in (ls.field(client.ChanField.RANGE), ls.timestamp,
+                 ls.measurement_id, ls.status, ls.packet_timestamp,
+                 ls.alert_flags, ls.pose):
+        assert not view.flags.owndata
+        interface = view.__array_interface__
+        assert interface["data"][0] == view.ctypes.data
+        if hasattr(np, "from_dlpack"):
+            assert np.shares_memory(np.from_dlpack(view), view)
+
+    pose = ls.pose
+    del ls
+    pose[0][0, 3] = 5
+    assert pose[0][0, 3] == 5
+
+
 def test_scan_not_complete() -> None:
     """Test that not all scans are considered complete."""
     ls = client.LidarScan(32, 1024)
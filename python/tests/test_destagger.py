@@ -111,3 +111,81 @@ def test_destagger_correct_multi(meta, scan) -> None:
     assert near_ir_stacked.dtype == np.uint16
     assert destaggered_stacked.dtype == np.uint16
     assert np.array_equal(ref_stacked, destaggered_stacked)
+
+
+@pytest.mark.parametrize('test_key', ['legacy-2.0'])
+def test_destagger_out(meta, scan) -> None:
+    """Check destaggering into preallocated and in place."""
+    near_ir = scan.field(client.ChanField.NEAR_IR)
+    ref = client.destagger(meta, near_ir)
+
+    out = np.empty_like(near_ir)
+    assert client.destagger(meta, near_ir, out=out) is out
+    assert np.array_equal(out, ref)
+
+    in_place = near_ir.copy()
+    client.destagger(meta, in_place, out=in_place)
+    assert np.array_equal(in_place, ref)
+    client.stagger(meta, in_place, out=in_place)
+    assert np.array_equal(in_place, near_ir)
+
+    stacked = np.repeat(near_ir[..., None], 3, axis=2)
+    out_stacked = np.empty_like(stacked)
+    client.destagger(meta, stacked, out=out_stacked)
+    assert np.array_equal(out_stacked, np.repeat(ref[..., None], 3, axis=2))
+
+
+@pytest.mark.parametrize('test_key', ['legacy-2.0'])
+def test_destagger_out_bad(meta, scan) -> None:
+    """Check that unusable out arrays are rejected."""
+    near_ir = scan.field(client.ChanField.NEAR_IR)
+
+    with pytest.raises(ValueError):
+        client.destagger(meta, near_ir, out=np.empty_like(near_ir[:-1]))
+    with pytest.raises(ValueError):
+        client.destagger(meta, near_ir, out=np.empty(near_ir.shape))
+    with pytest.raises(ValueError):
+        client.destagger(meta, near_ir,
+                         out=np.empty_like(near_ir, order='F'))
+
+
+@pytest.mark.parametrize("dtype", [np.uint16, np.uint32, np.float32, np.float64])
+def test_range_image_filters(dtype) -> None:
+    """Check the range image filters against a sliding window in numpy."""
+    rng = np.random.default_rng(0)
+    img = rng.integers(0, 50, (16, 32)).astype(dtype)
+    padded = np.pad(img, ((1, 1), (2, 2)), mode="wrap")
+    windows = np.lib.stride_tricks.sliding_window_view(padded, (3, 5))
+
+    mins = client.min_filter(img, 3, 5)
+    maxs = client.max_filter(img, 3, 5)
+    assert mins.dtype == dtype
+    # rows are cut at the borders, so compare the inner rows only
+    assert np.array_equal(mins[1:-1], windows[1:-1].min(axis=(2, 3)))
+    assert np.array_equal(maxs[1:-1], windows[1:-1].max(axis=(2, 3)))
+
+    medians = client.median_filter(img, 3, 3, wrap_columns=False)
+    inner = np.lib.stride_tricks.sliding_window_view(img, (3, 3)).reshape(14, 30, 9)
+    assert np.array_equal(medians[1:-1, 1:-1], np.sort(inner, axis=2)[:, :, 4])
+
+
+def test_connected_components() -> None:
+    """Check that components split at range steps and wrap around."""
+    range_img = np.array([[100, 105, 0, 300, 100],
+                          [0, 0, 0, 500, 100]], dtype=np.uint32)
+    labels = client.connected_components(range_img, 10)
+    assert np.array_equal(labels, [[1, 1, 0, 2, 1], [0, 0, 0, 3, 1]])
+    labels = client.connected_components(range_img, 10, wrap_columns=False)
+    assert labels.max() == 4
+
+
+def test_range_image_normals(meta, scan) -> None:
+    """Check normals are unit vectors facing the sensor where defined."""
+    from ouster.sdk._bindings.client import XYZLut as _XYZLut
+    lut = _XYZLut(meta, False)
+    normals = client.range_image_normals(scan, lut, 3)
+    points = lut(scan)
+    valid = np.linalg.norm(normals, axis=1) > 0
+    assert not np.any(valid[scan.field(client.ChanField.RANGE).ravel() == 0])
+    assert np.allclose(np.linalg.norm(normals[valid], axis=1), 1)
+    assert np.all(np.einsum("ij,ij->i", normals[valid], points[valid]) <= 1e-9)
@@ -0,0 +1,124 @@
+"""
+Copyright (c) 2025, Ouster, Inc.
+All rights reserved.
+
+Check that the native calls doing heavy work release the GIL, so that python
+threads run while they do.
+"""
+import sys
+import threading
+import time
+from concurrent.futures import ThreadPoolExecutor
+from typing import Callable, Iterator
+
+import numpy as np
+import pytest
+
+from ouster.sdk import client
+import ouster.sdk._bindings.client as _client
+
+
+@pytest.fixture
+def info() -> client.SensorInfo:
+    return client.SensorInfo.from_default(client.LidarMode.MODE_2048x10)
+
+
+@pytest.fixture
+def scan(info: client.SensorInfo) -> client.LidarScan:
+    h = info.format.pixels_per_column
+    w = info.format.columns_per_frame
+    ls = client.LidarScan(h, w, info.format.udp_profile_lidar)
+    rng = np.random.default_rng(0)
+    ls.field(client.ChanField.RANGE)[:] = rng.integers(1, 100000, (h, w))
+    ls.pose[:] = np.eye(4)
+    ls.pose[:, 0, 3] = np.linspace(0, 1, w)
+    return ls
+
+
+@pytest.fixture
+def no_preemption() -> Iterator[None]:
+    """Keep the main thread from being preempted between bytecodes, so that
+    other threads only run when a call releases the GIL"""
+    interval = sys.getswitchinterval()
+    sys.setswitchinterval(100)
+    try:
+        yield
+    finally:
+        sys.setswitchinterval(interval)
+
+
+def _progress_during(call: Callable[[], object], times: int = 10) -> int:
+    """Count the iterations of a python thread while the call runs"""
+    count = 0
+    stop = False
+
+    def spin() -> None:
+        nonlocal count
+        while not stop:
+            count += 1
+            # sleeping gives the GIL back to the main thread between the calls
+            time.sleep(1e-5)
+
+    thread = threading.Thread(target=spin)
+    thread.start()
+    try:
+        time.sleep(0.01)
+        before = count
+        for _ in range(times):
+            call()
+        return count - before
+    finally:
+        stop = True
+        thread.join()
+
+
+def test_xyzlut_releases_gil(info, scan, no_preemption) -> None:
+    lut = _client.XYZLut(info, False)
+    ranges = scan.field(client.ChanField.RANGE)
+    out = np.empty((ranges.size, 3))
+    assert _progress_during(lambda: lut(scan)) > 0
+    assert _progress_during(lambda: lut(ranges)) > 0
+    assert _progress_during(lambda: lut(scan, out)) > 0
+
+
+def test_destagger_releases_gil(info, scan, no_preemption) -> None:
+    ranges = scan.field(client.ChanField.RANGE)
+    shifts = info.format.pixel_shift_by_row
+    assert _progress_during(
+        lambda: _client.destagger_uint32(ranges, shifts, False)) > 0
+
+
+def test_pose_ops_release_gil(info, scan, no_preemption) -> None:
+    xyz = client.XYZLut(info)(scan)
+    assert _progress_during(lambda: client.dewarp(xyz, scan.pose)) > 0
+    assert _progress_during(lambda: client.transform(xyz, np.eye(4))) > 0
+    lut = _client.XYZLut(info, False)
+    assert _progress_during(lambda: _client.cartesian_compact(scan, lut)) > 0
+
+
+def test_concurrent_native_calls(info, scan) -> None:
+    """Run the same native calls from several threads at once and compare
+    with the results of a single thread"""
+    xyzlut = client.XYZLut(info)
+    xyz = xyzlut(scan)
+    expected = {
+        "xyz": xyz,
+        "destaggered": client.destagger(info,
+                                        scan.field(client.ChanField.RANGE)),
+        "dewarped": client.dewarp(xyz, scan.pose),
+    }
+
+    def work(i: int) -> None:
+        which = list(expected)[i % len(expected)]
+        if which == "xyz":
+            result = xyzlut(scan)
+        elif which == "destaggered":
+            result = client.destagger(info,
+                                      scan.field(client.ChanField.RANGE))
+        else:
+            result = client.dewarp(xyz, scan.pose)
+        assert np.array_equal(result, expected[which])
+
+    with ThreadPoolExecutor(max_workers=4) as pool:
+        for f in [pool.submit(work, i) for i in range(60)]:
+            f.result()
@@ -192,3 +192,32 @@ def test_multiple_scan_source_pcap_both_non_legacy(tmp_path) -> None:
 
     assert test_scans[1].frame_id == 1535
     assert test_scans[1].h == 64
+
+
+@pytest.mark.parametrize("complete", [False, True])
+def test_multiple_scan_source_native_collation(tmp_path, complete) -> None:
+    """Batching and collating natively yields the frames of the python
+    implementation"""
+    from ouster.sdk.client import first_valid_packet_ts
+    from ouster.sdk.client.multi import collate_scans
+    from ouster.sdk.pcap import PcapScanSource  # type: ignore
+
+    meta1_out_path = patch_json_file(calc_path('same_ports.1.json'),
+                                     tmp_path,
+                                     imu_port=7503)
+    scan_source = PcapScanSource(calc_path('same_ports.pcap'),
+                                 meta=[meta1_out_path, calc_path('same_ports.2.json')],
+                                 complete=complete)
+
+    native = list(scan_source)
+    expected = list(collate_scans(scan_source._scans_iter(True, False, True),
+                                  scan_source.sensors_count,
+                                  first_valid_packet_ts, dt=scan_source._dt))
+    assert len(native) == len(expected) > 0
+    for frame, expected_frame in zip(native, expected):
+        assert len(frame) == len(expected_frame)
+        for scan, expected_scan in zip(frame, expected_frame):
+            assert (scan is None) == (expected_scan is None)
+            if scan is not None:
+                assert scan == expected_scan
+    scan_source.close()
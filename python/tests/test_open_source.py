@@ -1,6 +1,8 @@
 import os
 from re import escape
 import pytest
+import subprocess
+import sys
 import tempfile
 import ouster.sdk.io_type
 from ouster.sdk.util import resolve_metadata_multi
@@ -9,6 +11,16 @@ from ouster.sdk import open_source, SourceURLException
 from tests.conftest import PCAPS_DATA_DIR, OSFS_DATA_DIR
 
 
+def test_import_defers_source_handlers():
+    """Importing ouster.sdk shouldn't import the scan sources of every format."""
+    code = ("import sys, ouster.sdk; "
+            "print(' '.join(m for m in ('ouster.sdk.bag', 'ouster.sdk.osf', 'ouster.sdk.pcap', "
+            "'ouster.sdk.sensor', 'rosbags') if m in sys.modules))")
+    result = subprocess.run([sys.executable, "-c", code], capture_output=True, text=True)
+    assert result.returncode == 0, result.stderr
+    assert result.stdout.strip() == ""
+
+
 def test_open_source_empty_source_url():
     """It should raise an error if the src url is the empty string."""
     with pytest.raises(ValueError, match="No valid source specified"):
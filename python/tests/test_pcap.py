@@ -567,6 +567,54 @@ def test_indexed_pcap_reader_seek(tmpdir):
         assert reader.current_frame_id() == packet_format.frame_id(reader.current_data().tobytes())
 
 
+def test_indexed_pcap_reader_seek_to_time(tmpdir):
+    """It should seek to the frame at a capture timestamp"""
+    meta_path = path.join(PCAPS_DATA_DIR, f"{TESTS['dual-2.2']}.json")
+
+    sensor_info = client.SensorInfo(open(meta_path).read())
+    num_frames = 10
+    in_packets = list(fake_packet_stream_with_frame_id(sensor_info, num_frames, 3, 3, lambda frame_num: frame_num))
+    for i, packet in enumerate(in_packets):
+        packet.host_timestamp = (i + 1) * 1_000_000_000
+    file_path = path.join(tmpdir, "pcap_index_test.pcap")
+    pcap.record(in_packets, file_path)
+    reader = _pcap.IndexedPcapReader(file_path, [meta_path])
+    reader.build_index()
+
+    index = reader.get_index()
+    timestamps = index.frame_timestamps[0]
+    assert len(timestamps) == num_frames
+    assert list(index.frame_ids[0]) == list(range(num_frames))
+    assert np.all(np.diff(timestamps.astype(np.int64)) > 0)
+
+    for frame in range(num_frames):
+        # a timestamp within the frame finds the frame
+        assert reader.seek_to_time(0, int(timestamps[frame]) + 1) == frame
+        reader.next_packet()
+        assert reader.current_info().file_offset == index.frame_indices[0][frame]
+        assert reader.current_frame_id() == frame
+    # timestamps out of the recording find the first and the last frames
+    assert reader.seek_to_time(0, 0) == 0
+    assert index.frame_at_timestamp(0, 2**63) == num_frames - 1
+
+
+def test_pcap_scan_source_index_at_time():
+    """It should find the collated scan at a packet timestamp"""
+    pcap_path = path.join(PCAPS_DATA_DIR, "OS-1-128_v2.3.0_1024x10_lb_n3.pcap")
+    meta_path = path.join(PCAPS_DATA_DIR, "OS-1-128_v2.3.0_1024x10.json")
+    source = pcap.PcapScanSource(pcap_path, meta=[meta_path], index=True)
+    try:
+        timestamps = [client.first_valid_packet_ts(scans[0]) for scans in source]
+        assert len(timestamps) == len(source)
+        for idx, ts in enumerate(timestamps):
+            assert source.index_at_time(ts) == idx
+            assert source.index_at_time(ts + 1) == idx
+        assert source.index_at_time(0) == 0
+        assert source.index_at_time(timestamps[-1] * 2) == len(source) - 1
+    finally:
+        source.close()
+
+
 def test_out_of_order_frames(tmpdir):
     """Frames that are out of order are skipped"""
     meta_path = path.join(PCAPS_DATA_DIR, f"{TESTS['dual-2.2']}.json")
@@ -683,3 +731,34 @@ def test_empty_pcap_loop():
 
     with pytest.raises(StopIteration):
         next(iter(source))
+
+
+def test_pcap_packet_batches(real_pcap_path: str, meta: client.SensorInfo) -> None:
+    """Packets read natively in batches should match the ones read one by one."""
+    from ouster.sdk.pcap.pcap_multi_packet_reader import PcapMultiPacketReader
+    batched = PcapMultiPacketReader(real_pcap_path, metadatas=[meta])
+    # soft id checking is done packet by packet in python
+    single = PcapMultiPacketReader(real_pcap_path, metadatas=[meta], soft_id_check=True)
+    assert batched._batchable and not single._batchable
+
+    expected = list(single)
+    packets = list(batched)
+    assert len(packets) == len(expected) > 0
+    for (idx, p), (idx_e, p_e) in zip(packets, expected):
+        assert idx == idx_e
+        assert type(p) is type(p_e)
+        assert np.array_equal(p.buf, p_e.buf)
+        # python used to round the capture time through a float
+        assert abs(p.host_timestamp - p_e.host_timestamp) < 1000
+        assert p.format.lidar_packet_size == p_e.format.lidar_packet_size
+
+    # batches can be fed straight to the batchers
+    batch = next(batched._batches(max_packets=16))
+    assert len(batch) == 16
+    assert batch.data.size == batch.entries["offset"][-1] + batch.entries["size"][-1]
+    with pytest.raises(IndexError):
+        batch.packet(16)
+    ls = client.LidarScan(meta)
+    pos, idx = batch.batch_scans([client.ScanBatcher(meta)], [ls])
+    assert (pos, idx) == (16, -1)
+    assert ls.packet_timestamp.any()
@@ -2,6 +2,8 @@ from ouster.sdk.client import dewarp, transform
 from ouster.sdk.util.parsing import scan_to_packets  # type: ignore
 from ouster.sdk import client
 import pytest
+import subprocess
+import sys
 import time
 import numpy as np
 import copy
@@ -354,3 +356,51 @@ def test_perf_osf_cli_slice(profile, tmp_osf, runner) -> None:
     profile.end(num_iters)
     print(result.output)
     assert result.exit_code == 0
+
+
+# Runs in a fresh interpreter, so that nothing is imported or cached yet, and
+# prints the duration of each startup step
+STARTUP_STEPS = """
+import sys, time
+t = time.perf_counter()
+def step(name):
+    global t
+    now = time.perf_counter()
+    print(f"step {name} {now - t}")
+    t = now
+import ouster.sdk
+step("import")
+from ouster.sdk import open_source, client
+source = open_source(sys.argv[1], index=False)
+step("open_source")
+scan = next(iter(source))
+step("first_scan")
+client.XYZLut(source.metadata)(scan)
+step("first_xyz")
+"""
+
+
+@pytest.mark.performance
+def test_perf_startup(record_property, tmp_pcap) -> None:
+    # -X importtime reports how long importing each module took
+    result = subprocess.run([sys.executable, "-X", "importtime", "-c", STARTUP_STEPS, tmp_pcap],
+                            capture_output=True, text=True)
+    assert result.returncode == 0, result.stderr
+
+    total = 0.0
+    for line in result.stdout.splitlines():
+        _, name, seconds = line.split()
+        print(f"{name:<12} {float(seconds) / 0.001:8.2f} ms")
+        record_property(f"startup_{name}", float(seconds))
+        total += float(seconds)
+    record_property("test_runtime", total)
+
+    # attribute the import step to the slowest modules, nested ones included
+    imports = []
+    for line in result.stderr.splitlines():
+        if not line.startswith("import time:") or "cumulative" in line:
+            continue
+        _, cumulative, module = line[len("import time:"):].split("|")
+        imports.append((int(cumulative), module.strip()))
+    for cumulative, module in sorted(imports, reverse=True)[:15]:
+        print(f"  import {module:<40} {cumulative / 1000:8.2f} ms")
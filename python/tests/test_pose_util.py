@@ -4,7 +4,9 @@ import math
 import time
 import pytest
 import ouster.sdk.util.pose_util as pu
-from ouster.sdk.client import dewarp, transform
+from ouster.sdk.client import (dewarp, transform, LidarScan, VoxelPolicy, voxel_downsample,
+                               range_percentiles, ImuPreintegrator, MapTileStore,
+                               VoxelMapIndex, MapLocalizer)
 
 
 def gt_pose6toHomMatrix(vec: np.ndarray) -> np.ndarray:
@@ -195,6 +197,35 @@ def test_traj_eval_bounds(poses6: List[pu.Pose6]):
     assert np.allclose(te.poses_at(np.array([0.75])), np.array([p_075]))
 
 
+def test_traj_eval_pose_scan(poses6: List[pu.Pose6]):
+    """Poses of the valid columns of a scan from ns timestamps."""
+    t0 = 1_700_000_000_000_000_000
+    dt = 100_000_000
+    traj_poses = [(t0 + i * dt, p) for i, p in enumerate(poses6)]
+    te = pu.TrajectoryEvaluator(traj_poses)
+
+    w = 64
+    scan = LidarScan(16, w)
+    scan.timestamp[:] = t0 + np.arange(w) * (dt * (len(poses6) - 1) // w)
+    scan.status[:] = 1
+    scan.status[5] = 0
+    assert te(scan) is scan
+
+    for col in range(w):
+        if col == 5:
+            assert np.allclose(scan.pose[col], np.eye(4))
+            continue
+        t = (int(scan.timestamp[col]) - t0) / dt
+        idx = min(int(t), len(poses6) - 2)
+        expected = pu.pose_interp(poses6[idx], poses6[idx + 1], t - idx)
+        assert np.allclose(scan.pose[col], expected)
+
+    # remapped column timestamps
+    col_ts = np.full(w, t0 + dt // 2)
+    te(scan, col_ts=col_ts)
+    assert np.allclose(scan.pose[0], pu.pose_interp(poses6[0], poses6[1], 0.5))
+
+
 def test_no_scipy_exp_log_ops(poses6: List[pu.Pose6]):
     """Test no scipy version of exp/log functions."""
     rot_vecs = np.zeros((len(poses6), 3))
@@ -365,3 +396,118 @@ def test_dewarp():
     np.testing.assert_allclose(dewarped_points_fc, expected_points, rtol=1e-5, atol=1e-8)
     np.testing.assert_allclose(dewarped_points_ff.shape, (2, 4, 3))
     np.testing.assert_allclose(dewarped_points_ff, expected_points, rtol=1e-5, atol=1e-8)
+
+
+def test_voxel_downsample():
+    rng = np.random.default_rng(0)
+    points = rng.uniform(-5, 5, (2000, 3))
+    voxel_size = 0.8
+
+    # reference voxels in order of first appearance
+    keys = np.floor(points / voxel_size).astype(np.int64)
+    _, first, inverse = np.unique(keys, axis=0, return_index=True, return_inverse=True)
+    order = np.argsort(first)
+    rank = np.empty_like(order)
+    rank[order] = np.arange(len(order))
+    expected_voxels = rank[inverse.ravel()]
+
+    kept, indices, voxels = voxel_downsample(points, voxel_size)
+    np.testing.assert_array_equal(voxels, expected_voxels)
+    np.testing.assert_array_equal(indices, first[order])
+    np.testing.assert_allclose(kept, points[first[order]])
+
+    centroids, _, _ = voxel_downsample(points, voxel_size, VoxelPolicy.CENTROID)
+    counts = np.bincount(expected_voxels)
+    for axis in range(3):
+        np.testing.assert_allclose(
+            centroids[:, axis],
+            np.bincount(expected_voxels, weights=points[:, axis]) / counts)
+
+    picked, picked_indices, _ = voxel_downsample(points, voxel_size, VoxelPolicy.RANDOM, seed=3)
+    np.testing.assert_array_equal(expected_voxels[picked_indices], np.arange(len(picked)))
+    np.testing.assert_allclose(picked, points[picked_indices])
+
+
+def test_range_percentiles():
+    rng = np.random.default_rng(1)
+    ranges = rng.integers(0, 50000, (64, 1024), dtype=np.uint32)
+    ranges[rng.random(ranges.shape) < 0.3] = 0
+
+    band_sum, band_count = range_percentiles(ranges, 0.92, 0.96)
+
+    nonzero = ranges[ranges != 0]
+    start, end = np.percentile(nonzero, 92), np.percentile(nonzero, 96)
+    band = nonzero[(nonzero >= start) & (nonzero <= end)]
+    assert band_count == band.size
+    assert band_sum == band.sum()
+
+
+def test_imu_preintegrator():
+    imu = ImuPreintegrator(init_samples=10)
+    bias = np.array([0.01, 0.0, -0.01])
+    up = np.array([0.0, 0.0, 9.80665])
+    t0 = 10**9
+    for i in range(10):
+        imu.add_sample(t0 + i * 10**6, up, bias)
+    assert imu.initialized
+    assert np.allclose(imu.gyro_bias, bias)
+
+    # a yaw rate of 1 rad/s for 0.1 s, the first interval at half rate
+    rate = np.array([0.0, 0.0, 1.0])
+    for i in range(10, 111):
+        imu.add_sample(t0 + i * 10**6, up, bias + rate)
+    poses = imu.poses_at(np.array([t0 + 9 * 10**6 + 10**8 + 0.5e6]))
+    assert poses.shape == (1, 4, 4)
+    angle = 0.1
+    expected = np.array([[np.cos(angle), -np.sin(angle)],
+                         [np.sin(angle), np.cos(angle)]])
+    assert np.allclose(poses[0, :2, :2], expected)
+    assert np.allclose(poses[0, :3, 3], 0)
+
+
+def test_map_tile_store(tmp_path):
+    filename = str(tmp_path / "map.omap")
+    rng = np.random.default_rng(3)
+    points = (rng.integers(-80, 80, (20000, 3)) + 0.5) * 0.25
+
+    with MapTileStore(filename, 5.0, 0.25, levels=2, max_tiles=4) as store:
+        store.append(points)
+        assert store.tiles_in_memory <= 4
+
+    store = MapTileStore(filename)
+    assert store.levels == 2
+    assert len(store.tiles()) == 8 ** 3
+    stored = np.concatenate([store.tile_points(key) for key in store.tiles()])
+    assert len(stored) == len(np.unique(points, axis=0))
+    region = store.query(np.array([0.0, 0.0, 0.0]), np.array([4.0, 4.0, 4.0]))
+    inside = np.all((points >= 0) & (points < 5), axis=1)
+    assert len(region) == len(np.unique(points[inside], axis=0))
+    assert len(store.query(np.zeros(3), np.full(3, 4.0), 1)) <= len(region)
+
+
+def test_map_localizer(tmp_path):
+    filename = str(tmp_path / "map.vidx")
+    rng = np.random.default_rng(4)
+    # a floor and three walls
+    a, b = rng.random((2, 20000))
+    map_points = np.concatenate([
+        np.stack([20 * a - 10, 20 * b - 10, np.zeros_like(a)], axis=1),
+        np.stack([np.full_like(a, -10), 20 * a - 10, 4 * b], axis=1),
+        np.stack([20 * a - 10, np.full_like(a, -10), 4 * b], axis=1),
+        np.stack([20 * a - 10, np.full_like(a, 10), 4 * b], axis=1)])
+    VoxelMapIndex.build(filename, map_points, 1.0)
+    index = VoxelMapIndex(filename)
+    assert len(index) == len(map_points)
+
+    neighbors, distances = index.nearest(map_points[:10] + [0, 0, 0.1], 0.5)
+    assert np.all(distances <= 0.1 + 1e-6)
+
+    truth = np.eye(4)
+    truth[:3, 3] = [0.2, -0.1, 1.0]
+    scan = map_points[::2] - truth[:3, 3]
+    guess = np.eye(4)
+    guess[2, 3] = 1.0
+    localizer = MapLocalizer(index, guess)
+    pose = localizer.update(scan)
+    assert np.allclose(pose, truth, atol=0.02)
+    assert localizer.last_correspondences > 0
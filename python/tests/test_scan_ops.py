@@ -143,3 +143,48 @@ def test_mask(scan_source_path) -> None:
         for f in nt.fields:
             assert np.max(nt.field(f)[0:H // 2, :]) == np.max(mt.field(f)[0:H // 2, :])
             assert np.max(nt.field(f)[H // 2:, :]) != 0 and np.max(mt.field(f)[H // 2:, :]) == 0
+
+
+def test_chained_scan_ops(scan_source_path) -> None:
+    """Clipping, masking then reducing in one pass matches doing it with numpy"""
+    normal_src = open_source(scan_source_path, sensor_idx=-1, index=False, cycle=False)
+    normal_src = cast(MultiScanSource, normal_src)
+    H = normal_src.metadata[0].format.pixels_per_column
+    W = normal_src.metadata[0].format.columns_per_frame
+    mask = np.ones((H, W), np.uint8)
+    mask[:, :W // 2] = 0
+
+    clipped_src = MultiClippedScanSource(normal_src, [ChanField.RANGE], 1000, 20000)
+    masked_src = MultiMaskedScanSource(clipped_src, [], [mask])
+    reduced_src = MultiReducedScanSource(masked_src, [H // 2])
+    staggered_mask = masked_src._masks[0]
+
+    for (n,), (r,) in zip(normal_src, reduced_src):
+        nt = cast(LidarScan, n)
+        rt = cast(LidarScan, r)
+        original = nt.field(ChanField.RANGE)
+        expected = np.where((original < 1000) | (original > 20000), 0, original)
+        expected = (expected * staggered_mask.astype(expected.dtype))[::2]
+        assert np.array_equal(rt.field(ChanField.RANGE), expected)
+        assert rt.sensor_info == reduced_src.metadata[0]
+        assert np.array_equal(rt.timestamp, nt.timestamp)
+
+
+def test_convert_and_compare() -> None:
+    from ouster.sdk.client import scan_ops
+    rng = np.random.default_rng(0)
+    range_mm = rng.integers(0, 200000, size=(128, 1024), dtype=np.uint32)
+
+    meters = scan_ops.convert(range_mm, np.float32, scale=0.001)
+    assert meters.dtype == np.float32
+    assert np.allclose(meters, range_mm.astype(np.float32) * 0.001)
+
+    saturated = scan_ops.convert(np.array([-1.5, 300.0, np.nan]), np.uint8)
+    assert saturated.tolist() == [0, 255, 0]
+
+    in_range = scan_ops.compare(range_mm, "<=", 100000.5)
+    assert in_range.dtype == np.uint8
+    assert np.array_equal(in_range, (range_mm <= 100000.5).astype(np.uint8))
+
+    with pytest.raises(ValueError):
+        scan_ops.compare(range_mm, "<>", 0)
@@ -0,0 +1,93 @@
+"""
+Copyright (c) 2025, Ouster, Inc.
+All rights reserved.
+"""
+import os
+import time
+from typing import Iterator, List
+
+import numpy as np
+import pytest
+
+from ouster.sdk.client import ScanPrefetcher
+from tests.conftest import PCAPS_DATA_DIR, OSFS_DATA_DIR
+
+
+def test_prefetcher_order() -> None:
+    assert list(ScanPrefetcher(range(100), 3)) == list(range(100))
+    assert list(ScanPrefetcher([], 1)) == []
+
+
+def test_prefetcher_depth() -> None:
+    """The source is read no further than depth items ahead"""
+    read: List[int] = []
+
+    def source() -> Iterator[int]:
+        for i in range(10):
+            read.append(i)
+            yield i
+
+    it = ScanPrefetcher(source(), 2)
+    assert next(it) == 0
+    # wait for the queue to refill and check that the thread stops there
+    for _ in range(100):
+        if len(read) >= 3:
+            break
+        time.sleep(0.01)
+    time.sleep(0.05)
+    assert len(read) == 3
+    assert list(it) == list(range(1, 10))
+
+
+def test_prefetcher_error() -> None:
+    def source() -> Iterator[int]:
+        yield 1
+        raise ValueError("bad scan")
+
+    it = ScanPrefetcher(source(), 4)
+    assert next(it) == 1
+    with pytest.raises(ValueError, match="bad scan"):
+        next(it)
+    with pytest.raises(StopIteration):
+        next(it)
+
+
+def test_prefetcher_close() -> None:
+    def source() -> Iterator[int]:
+        i = 0
+        while True:
+            yield i
+            i += 1
+
+    it = ScanPrefetcher(source(), 2)
+    assert next(it) == 0
+    it.close()
+    assert list(it) == []
+    with pytest.raises(ValueError):
+        ScanPrefetcher(source(), 0)
+
+
+def test_prefetch_pcap_scan_source() -> None:
+    from ouster.sdk.pcap import PcapScanSource  # type: ignore
+    file_path = os.path.join(PCAPS_DATA_DIR, 'OS-0-128-U1_v2.3.0_1024x10.pcap')
+    source = PcapScanSource(file_path)
+    expected = [scans[0] for scans in source]
+    prefetched = [scans[0] for scans in source.prefetch(3)]
+    assert len(prefetched) == len(expected)
+    for a, b in zip(prefetched, expected):
+        assert a is not None and b is not None
+        assert a.frame_id == b.frame_id
+        assert np.array_equal(a.field("RANGE"), b.field("RANGE"))
+
+    single = source.single_source(0)
+    assert ([s.frame_id for s in single.prefetch(1)] ==
+            [s.frame_id for s in expected])
+
+
+def test_prefetch_osf_scan_source() -> None:
+    from ouster.sdk.osf import OsfScanSource  # type: ignore
+    file_path = os.path.join(OSFS_DATA_DIR, 'OS-1-128_v2.3.0_1024x10_lb_n3.osf')
+    source = OsfScanSource(file_path)
+    expected = [scans[0].frame_id for scans in source if scans[0]]
+    prefetched = [scans[0].frame_id for scans in source.prefetch() if scans[0]]
+    assert prefetched == expected
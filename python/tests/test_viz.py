@@ -99,6 +99,18 @@ def test_point_viz_rgb_image(point_viz: viz.PointViz) -> None:
     img.set_image(image_data_rgb)
     show_viz()
 
+    label.set_text("Image RGB: set..image(rgb), 3dim, uint8")
+    img.set_image((image_data_rgb * 255).astype(np.uint8))
+    show_viz()
+
+    label.set_text("Image RGB: set..image(mono), 2dim, uint16")
+    img.set_image((image_data_mono * 65535).astype(np.uint16))
+    show_viz()
+
+    # uint16 images are monochrome
+    with pytest.raises(ValueError):
+        img.set_image((image_data_rgb * 65535).astype(np.uint16))
+
     label.set_text(
         "Image RGB: set..image(rgba), 3dim, two right columns has 0.5 alpha")
     image_data_rgba = np.dstack(
@@ -364,6 +376,31 @@ def test_point_viz_cloud_unstructured(point_viz: viz.PointViz) -> None:
     thread.join()
 
 
+def test_point_viz_lod_cloud(point_viz: viz.PointViz) -> None:
+    """Smoke test rendering a level of detail cloud growing over time."""
+    import threading
+    import time
+
+    cloud = viz.LodCloud(chunk_size=5.0, point_budget=200000)
+    point_viz.add(cloud)
+
+    quit = threading.Event()
+
+    def accumulate() -> None:
+        while not quit.is_set() and cloud.size < 20000000:
+            xyz = np.random.rand(100000, 3).astype(np.float32) * 200 - 100
+            cloud.add_points(xyz, np.random.rand(100000).astype(np.float32))
+            point_viz.update()
+            time.sleep(0.0333)
+
+    thread = threading.Thread(target=accumulate)
+    thread.start()
+
+    point_viz.run()
+    quit.set()
+    thread.join()
+
+
 def test_point_viz_rgb_cloud(point_viz: viz.PointViz) -> None:
     """Test rgb coloring of clouds."""
 
@@ -405,6 +442,23 @@ def test_point_viz_rgb_cloud(point_viz: viz.PointViz) -> None:
     cloud.set_key(key)
     show_viz()
 
+    # raw keys, normalized on the GPU ======================
+    raw_key = (np.linalg.norm(points, axis=1) * 100).astype(np.uint16)
+    with pytest.raises(ValueError):
+        cloud.set_key_raw(raw_key[:100])
+
+    label.set_text("Cloud RGB: MONO set..key_raw() AUTO_EXPOSURE")
+    cloud.set_key_raw(raw_key)
+    show_viz()
+
+    label.set_text("Cloud RGB: MONO set..key_raw() EQUALIZATION")
+    cloud.set_key_raw(raw_key.astype(np.uint32),
+                      viz.KeyNormalization.EQUALIZATION)
+    show_viz()
+
+    label.set_text("Cloud RGB: MONO set..key()")
+    cloud.set_key(key)
+
     # + set_mask(rgba) =====================================
     label.set_text("Cloud RGB: add set..mask() 1/3 of cloud "
                    "in RED with transparency")
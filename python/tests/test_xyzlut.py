@@ -150,3 +150,142 @@ def test_xyz_range_dtype(stream_digest: digest.StreamDigest, scan: client.LidarS
     assert np.array_equal(xyz_from_scan, xyz_from_range_16)
     assert np.array_equal(xyz_from_scan, xyz_from_range_32)
     assert np.array_equal(xyz_from_scan, xyz_from_range_64)
+
+
+def test_xyz_batch(scan: client.LidarScan, meta: client.SensorInfo) -> None:
+    """Test that batched projection matches projecting each scan."""
+    from ouster.sdk._bindings.client import XYZLut as _XYZLut
+    scans = [scan, copy(scan), copy(scan)]
+    scans[1].field(client.ChanField.RANGE)[:] //= 2
+    lut = _XYZLut(meta, False)
+    xyzlut = client.XYZLut(meta)
+    h = meta.format.pixels_per_column
+    w = meta.format.columns_per_frame
+
+    points = client.cartesian_batch(scans, lut)
+    assert points.shape == (3, h * w, 3)
+    for i, s in enumerate(scans):
+        assert np.array_equal(points[i], xyzlut(s).reshape(-1, 3))
+
+    out = np.empty((3, h * w, 3), np.float32)
+    assert client.cartesian_batch(scans, lut, out, np.float32) is out
+    assert np.allclose(out, points, atol=1e-4)
+
+    with pytest.raises(ValueError):
+        client.cartesian_batch(scans, lut, out)
+
+
+def test_stack_field(scan: client.LidarScan, meta: client.SensorInfo) -> None:
+    """Test that stacked fields match the fields of each scan."""
+    scans = [scan, copy(scan)]
+    scans[1].field(client.ChanField.RANGE)[:] //= 2
+    ranges = client.stack_field(scans, client.ChanField.RANGE)
+    destaggered = client.stack_field(scans, client.ChanField.RANGE, meta)
+    for i, s in enumerate(scans):
+        field = s.field(client.ChanField.RANGE)
+        assert np.array_equal(ranges[i], field)
+        assert np.array_equal(destaggered[i], client.destagger(meta, field))
+
+    out = np.empty_like(ranges)
+    assert client.stack_field(scans, client.ChanField.RANGE, out=out) is out
+    assert np.array_equal(out, ranges)
+    with pytest.raises(ValueError):
+        client.stack_field(scans, "missing")
+
+
+def test_deskew_input(scan: client.LidarScan, meta: client.SensorInfo) -> None:
+    """Test that native deskew input matches the python KISS-ICP input."""
+    from ouster.sdk._bindings.client import DeskewInput, XYZLut as _XYZLut
+    import ouster.sdk.mapping.util as util
+    scans = [scan, copy(scan)]
+    scans[1].field(client.ChanField.RANGE)[:] //= 2
+    offsets = [0, 20000]
+
+    deskew_input = DeskewInput([_XYZLut(meta, True)] * 2)
+    n = deskew_input.build(scans, offsets)
+    points, times, col_times = util.getKissICPInputData(
+        scans, [client.XYZLut(meta, use_extrinsics=True)] * 2, offsets)
+
+    assert n == len(points)
+    assert np.allclose(deskew_input.points, points)
+    assert np.allclose(deskew_input.times, times)
+    for i in range(2):
+        assert np.allclose(deskew_input.column_times(i), col_times[i])
+
+    # missing scans leave no points nor column times
+    assert deskew_input.build([None, scans[1]], offsets) < n
+    assert deskew_input.column_times(0).size == 0
+
+
+def test_point_cloud_writer(tmp_path, scan: client.LidarScan, meta: client.SensorInfo) -> None:
+    """Test that the native writer streams the compacted points of a scan."""
+    from ouster.sdk._bindings.client import XYZLut as _XYZLut
+    lut = _XYZLut(meta, True)
+    path = str(tmp_path / "cloud.pcd")
+    with client.PointCloudWriter(path, client.PointCloudFormat.PCD, "reflectivity") as writer:
+        writer.write(scan, lut, "REFLECTIVITY")
+        writer.write(np.zeros((2, 3)), np.array([1.0, 2.0]))
+    assert not writer.is_open
+
+    points = client.cartesian_dewarp(scan, lut, compact=True)
+    keys = scan.field(client.ChanField.REFLECTIVITY).ravel()[
+        scan.field(client.ChanField.RANGE).ravel() > 0]
+    assert writer.points_written() == len(points) + 2
+
+    with open(path, "rb") as f:
+        data = f.read()
+    body = np.frombuffer(data[data.index(b"DATA binary\n") + 12:], dtype=np.float32).reshape(-1, 4)
+    assert f"POINTS {len(points) + 2:010d}\n".encode() in data
+    assert np.allclose(body[:-2, :3], points, atol=1e-4)
+    assert np.array_equal(body[:-2, 3], keys)
+    assert np.array_equal(body[-2:, 3], [1, 2])
+
+
+def test_column_dewarper(scan: client.LidarScan, meta: client.SensorInfo) -> None:
+    """Test that dewarping sectors with a pose source matches the whole scan."""
+    from ouster.sdk._bindings.client import XYZLut as _XYZLut
+    lut = _XYZLut(meta, True)
+    t0 = float(scan.timestamp[0])
+
+    def source(ts: np.ndarray) -> np.ndarray:
+        poses = np.tile(np.eye(4), (len(ts), 1, 1))
+        poses[:, 0, 3] = (ts - t0) * 1e-8
+        return poses
+
+    dewarper = client.ColumnDewarper(lut, scan.w, scan.h, source)
+    half = scan.w // 2
+    dewarper.dewarp(scan, half, half - 1)
+
+    scan.pose[:] = source(scan.timestamp.astype(np.float64))
+    assert np.allclose(dewarper.poses, scan.pose)
+    assert np.allclose(dewarper.points, client.cartesian_dewarp(scan, lut))
+
+    with pytest.raises(ValueError):
+        dewarper.dewarp(scan, 0, scan.w)
+
+
+def test_fused_cloud_builder(scan: client.LidarScan, meta: client.SensorInfo) -> None:
+    """Test that the fused cloud of two sensors matches their moved clouds."""
+    from ouster.sdk._bindings.client import XYZLut as _XYZLut
+    lut = _XYZLut(meta, True)
+    extrinsic = np.eye(4)
+    extrinsic[:3, 3] = [1.0, -2.0, 0.5]
+    builder = client.FusedCloudBuilder([lut, lut], [np.eye(4), extrinsic], ["REFLECTIVITY"],
+                                       sensor_ids=True)
+    cloud = builder.build([scan, scan])
+
+    valid = scan.field(client.ChanField.RANGE).ravel() > 0
+    points = client.cartesian_dewarp(scan, lut, compact=True)
+    n = len(points)
+    assert len(cloud) == 2 * n
+    assert np.allclose(cloud.points[:n], points)
+    assert np.allclose(cloud.points[n:], points + extrinsic[:3, 3])
+    assert np.array_equal(cloud.sensor_ids, np.repeat([0, 1], n))
+    keys = scan.field(client.ChanField.REFLECTIVITY).ravel()[valid]
+    assert np.array_equal(cloud.fields[0], np.concatenate([keys, keys]))
+
+    # the ring alternates between two slots
+    second = builder.build([None, scan])
+    assert len(second) == n and second.frame == 1
+    assert builder.latest.frame == 1
+    assert builder.build([scan, None]).frame == 2
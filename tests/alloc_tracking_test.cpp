@@ -0,0 +1,193 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/alloc_tracking.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "ouster/impl/lidar_scan_impl.h"
+#include "ouster/impl/netcompat.h"
+#include "ouster/lidar_scan.h"
+#include "ouster/sensor_scan_source.h"
+#include "util.h"
+
+using namespace ouster::sensor;
+using ouster::LidarScan;
+using ouster::alloc::AllocScope;
+using ouster::alloc::AllocStats;
+
+namespace {
+
+class AllocTrackingTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        info_ = metadata_from_json(getenvs("DATA_DIR") +
+                                   "3_0_1_os-122246000293-128.json");
+    }
+
+    // the packets of consecutive frames of a scan with some range
+    std::vector<std::vector<LidarPacket>> frames(size_t count) {
+        LidarScan ls(info_);
+        std::fill(ls.status().data(), ls.status().data() + ls.status().size(),
+                  0x1);
+        ls.field<uint32_t>(ChanField::RANGE).setConstant(1000);
+        impl::packet_writer pw{packet_format(info_)};
+        std::vector<std::vector<LidarPacket>> out(count);
+        for (size_t i = 0; i < count; i++) {
+            ls.frame_id = static_cast<int64_t>(i);
+            std::iota(ls.timestamp().data(),
+                      ls.timestamp().data() + ls.timestamp().size(),
+                      1000 + i * 100000000);
+            ouster::impl::scan_to_packets(ls, pw,
+                                          std::back_inserter(out[i]),
+                                          info_.init_id, info_.sn);
+        }
+        return out;
+    }
+
+    sensor_info info_;
+};
+
+}  // namespace
+
+TEST_F(AllocTrackingTest, counts_per_scope_thread_and_tag) {
+    ouster::alloc::reset_tag_stats();
+    {
+        AllocScope outer("outer");
+        {
+            AllocScope inner("inner");
+            std::vector<char> v(100);
+            EXPECT_EQ(inner.stats().allocations, 1u);
+            EXPECT_GE(inner.stats().bytes, 100u);
+        }
+        EXPECT_EQ(outer.stats().allocations, 1u);
+        EXPECT_EQ(outer.stats().frees, 1u);
+        EXPECT_TRUE(ouster::alloc::tracking_active());
+    }
+    EXPECT_EQ(ouster::alloc::tag_stats("outer").allocations, 1u);
+    EXPECT_EQ(ouster::alloc::tag_stats("inner").allocations, 1u);
+    EXPECT_EQ(ouster::alloc::tag_stats("unused").allocations, 0u);
+
+    // scopes on other threads add to the same tag and the process
+    const AllocStats process = ouster::alloc::process_stats();
+    uint64_t counted = 0;
+    std::thread t([&counted] {
+        AllocScope scope("inner");
+        std::unique_ptr<int> p(new int(1));
+        counted = scope.stats().allocations;
+    });
+    t.join();
+    EXPECT_EQ(counted, 1u);
+    EXPECT_EQ(ouster::alloc::tag_stats("inner").allocations, 2u);
+    EXPECT_GT(ouster::alloc::process_stats().allocations,
+              process.allocations);
+}
+
+TEST_F(AllocTrackingTest, scan_batcher_steady_state) {
+    auto packets = frames(4);
+    LidarScan ls(info_);
+    ouster::ScanBatcher batcher(info_);
+    auto batch = [&](size_t frame) {
+        size_t done = 0;
+        for (const auto& p : packets[frame]) done += batcher(p, ls);
+        return done;
+    };
+    batch(0);
+    batch(1);
+
+    AllocScope scope("scan_batcher");
+    batch(2);
+    batch(3);
+    EXPECT_EQ(scope.stats().allocations, 0u);
+}
+
+TEST_F(AllocTrackingTest, cartesian_into_preallocated_buffers) {
+    LidarScan ls(info_);
+    ls.field<uint32_t>(ChanField::RANGE).setConstant(1000);
+    auto lut = ouster::make_xyz_lut(info_, true);
+    auto lut_f = ouster::make_xyz_lut_f(info_, true);
+    LidarScan::Points points(ls.w * ls.h, 3);
+    Eigen::Array<float, Eigen::Dynamic, 3> points_f(ls.w * ls.h, 3);
+    ouster::cartesian(points, ls, lut);
+    ouster::cartesian(points_f, ls, lut_f);
+
+    AllocScope scope("cartesian");
+    for (int i = 0; i < 3; i++) {
+        ouster::cartesian(points, ls, lut);
+        ouster::cartesian(points_f, ls, lut_f);
+    }
+    EXPECT_EQ(scope.stats().allocations, 0u);
+}
+
+TEST_F(AllocTrackingTest, lidar_scan_copy_reuses_fields) {
+    LidarScan a(info_);
+    LidarScan b(info_);
+    a.field<uint32_t>(ChanField::RANGE).setConstant(7);
+    a.frame_id = 3;
+
+    AllocScope scope;
+    b = a;
+    EXPECT_EQ(scope.stats().allocations, 0u);
+    EXPECT_EQ(b, a);
+}
+
+TEST_F(AllocTrackingTest, sensor_scan_source_steady_state) {
+    info_.config.udp_port_lidar = free_udp_port();
+    info_.config.udp_port_imu = free_udp_port();
+    sensor_config config;
+    config.udp_port_lidar = info_.config.udp_port_lidar;
+    config.udp_port_imu = info_.config.udp_port_imu;
+    ReceiveThreadOptions options;
+    options.capture.receive_buffer_bytes = 8 * 1024 * 1024;
+    SensorScanSource source({Sensor("127.0.0.1", config)}, {info_}, {}, 45,
+                            4, false, options);
+
+    const size_t warm_up = 8;
+    auto packets = frames(warm_up + 8);
+    SOCKET sock = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(config.udp_port_lidar.value());
+
+    // the receive and batching threads of the source count too, so this
+    // covers the whole process
+    size_t scans = 0;
+    AllocStats start;
+    std::unique_ptr<LidarScan> held;
+    for (size_t frame = 0; frame < packets.size(); frame++) {
+        if (frame == warm_up) start = ouster::alloc::process_stats();
+        for (const auto& p : packets[frame]) {
+            sendto(sock, (const char*)p.buf.data(), p.buf.size(), 0,
+                   (sockaddr*)&addr, sizeof(addr));
+        }
+        auto res = source.get_scan(0.5);
+        if (!res.second) continue;
+        if (frame >= warm_up) scans++;
+        // holding a scan while the next one is batched during warm-up makes
+        // the pool allocate the scans the batch thread and the reader hold
+        // at the same time, which otherwise depends on thread scheduling
+        if (frame == warm_up / 2) {
+            held = std::move(res.second);
+            continue;
+        }
+        if (held) source.recycle(res.first, std::move(held));
+        source.recycle(res.first, std::move(res.second));
+    }
+    const AllocStats end = ouster::alloc::process_stats();
+    impl::socket_close(sock);
+
+    EXPECT_GT(scans, 0u);
+    EXPECT_EQ(end.allocations - start.allocations, 0u);
+}
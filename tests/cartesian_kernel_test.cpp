@@ -0,0 +1,166 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/impl/cartesian_kernel.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/types.h"
+
+using namespace ouster;
+using namespace ouster::impl;
+
+namespace {
+
+// relative error of single precision fused and unfused multiply adds
+constexpr float tolerance = 1e-5f;
+
+struct lut_case {
+    std::vector<uint32_t> range;
+    PointsF direction;
+    PointsF offset;
+};
+
+lut_case random_case(size_t n) {
+    std::mt19937 g(0xc0ffee);
+    std::uniform_int_distribution<uint32_t> r(0, 1 << 20);
+    lut_case c;
+    c.range.resize(n);
+    for (auto& v : c.range) v = (r(g) % 5 == 0) ? 0 : r(g);
+    // the top bit set still converts like the scalar code
+    if (n > 2) c.range[2] = 0x80000001u;
+    c.direction = PointsF::Random(n, 3);
+    c.offset = 0.01f * PointsF::Random(n, 3);
+    return c;
+}
+
+}  // namespace
+
+class CartesianKernelTest : public ::testing::TestWithParam<cartesian_kernel> {
+};
+
+TEST_P(CartesianKernelTest, matches_scalar_reference) {
+    if (!cartesian_kernel_supported(GetParam())) {
+        EXPECT_THROW(get_cartesian_fn(GetParam(), xyz_layout::PLANAR),
+                     std::invalid_argument);
+        GTEST_SKIP() << "kernel not supported on this CPU";
+    }
+
+    for (auto layout : {xyz_layout::PLANAR, xyz_layout::INTERLEAVED}) {
+        auto ref = get_cartesian_fn(cartesian_kernel::SCALAR, layout);
+        auto fn = get_cartesian_fn(GetParam(), layout);
+        // tails of every vector width, and a column stride wider than n
+        for (size_t n : {1, 3, 4, 7, 8, 9, 16, 17, 33, 100}) {
+            const size_t stride = n + 5;
+            auto c = random_case(stride);
+            std::vector<float> expected(3 * stride, -1.0f);
+            std::vector<float> actual(3 * stride, -1.0f);
+            ref(c.range.data(), c.direction.data(), c.offset.data(), stride,
+                n, expected.data());
+            fn(c.range.data(), c.direction.data(), c.offset.data(), stride, n,
+               actual.data());
+            for (size_t i = 0; i < expected.size(); i++) {
+                EXPECT_NEAR(actual[i], expected[i],
+                            tolerance * (1.0f + std::abs(expected[i])))
+                    << "n " << n << " index " << i << " interleaved "
+                    << (layout == xyz_layout::INTERLEAVED);
+            }
+        }
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(CartesianKernels, CartesianKernelTest,
+                        ::testing::Values(cartesian_kernel::SCALAR,
+                                          cartesian_kernel::AVX2,
+                                          cartesian_kernel::AVX512,
+                                          cartesian_kernel::NEON));
+
+TEST(CartesianKernelTest, best_kernel_is_supported) {
+    EXPECT_TRUE(cartesian_kernel_supported(best_cartesian_kernel()));
+}
+
+TEST(CartesianKernelTest, single_precision_lut_matches_double) {
+    auto info = sensor::default_sensor_info(sensor::MODE_512x10);
+    const auto w = info.format.columns_per_frame;
+    const auto h = info.format.pixels_per_column;
+    LidarScan scan(info);
+    auto range = scan.field<uint32_t>(sensor::ChanField::RANGE);
+    std::mt19937 g(7);
+    std::uniform_int_distribution<uint32_t> r(0, 200000);
+    for (Eigen::Index i = 0; i < range.size(); i++) range.data()[i] = r(g);
+    range(3, 4) = 0;
+
+    const auto lut = make_xyz_lut(info, true);
+    const auto lut_f = make_xyz_lut_f(info, true);
+    ASSERT_EQ(lut_f.direction.rows(), static_cast<Eigen::Index>(w * h));
+
+    const LidarScan::Points expected = cartesian(scan, lut);
+    const PointsF planar = cartesian(scan, lut_f);
+    // within a tenth of a millimeter
+    EXPECT_LT((planar.cast<double>() - expected).abs().maxCoeff(), 1e-4);
+    EXPECT_TRUE((planar.row(3 * w + 4) == 0).all());
+
+    std::vector<float> xyz(3 * w * h);
+    cartesian_interleaved(range, lut_f, xyz.data());
+    for (Eigen::Index i = 0; i < planar.rows(); i++) {
+        for (int c = 0; c < 3; c++) {
+            EXPECT_FLOAT_EQ(xyz[3 * i + c], planar(i, c));
+        }
+    }
+
+    PointsF points(w * h, 3);
+    cartesianT(points, range, lut_f.direction, lut_f.offset);
+    EXPECT_TRUE((points == planar).all());
+
+    XYZLutF small{lut_f.direction.topRows(10), lut_f.offset.topRows(10)};
+    EXPECT_THROW(cartesian(range, small), std::invalid_argument);
+    EXPECT_THROW(cartesian_interleaved(range, small, xyz.data()),
+                 std::invalid_argument);
+}
+
+TEST(CartesianKernelTest, batch_matches_single_scans) {
+    auto info = sensor::default_sensor_info(sensor::MODE_512x10);
+    const auto n = static_cast<Eigen::Index>(info.format.columns_per_frame *
+                                             info.format.pixels_per_column);
+    std::mt19937 g(11);
+    std::uniform_int_distribution<uint32_t> r(0, 200000);
+    std::vector<LidarScan> scans(5, LidarScan(info));
+    std::vector<const LidarScan*> ptrs;
+    for (auto& scan : scans) {
+        auto range = scan.field<uint32_t>(sensor::ChanField::RANGE);
+        for (Eigen::Index i = 0; i < range.size(); i++) range.data()[i] = r(g);
+        ptrs.push_back(&scan);
+    }
+
+    const auto lut = make_xyz_lut(info, true);
+    const auto lut_f = make_xyz_lut_f(info, true);
+    LidarScan::Points points(n * 5, 3);
+    cartesian(points, ptrs, lut);
+    std::vector<float> xyz(3 * n * 5);
+    cartesian_interleaved(ptrs, lut_f, xyz.data());
+    for (size_t s = 0; s < scans.size(); s++) {
+        const auto i = static_cast<Eigen::Index>(s);
+        EXPECT_TRUE((points.middleRows(i * n, n) == cartesian(scans[s], lut))
+                        .all());
+        std::vector<float> expected(3 * n);
+        cartesian_interleaved(scans[s].field(sensor::ChanField::RANGE), lut_f,
+                              expected.data());
+        EXPECT_TRUE(std::equal(expected.begin(), expected.end(),
+                               xyz.begin() + 3 * n * i));
+    }
+
+    LidarScan::Points short_points(n * 4, 3);
+    EXPECT_THROW(cartesian(short_points, ptrs, lut), std::invalid_argument);
+    LidarScan other(info.format.columns_per_frame / 2,
+                    info.format.pixels_per_column);
+    ptrs.push_back(&other);
+    EXPECT_THROW(cartesian_interleaved(ptrs, lut_f, xyz.data()),
+                 std::invalid_argument);
+}
@@ -7,6 +7,7 @@
 
 #include <Eigen/Eigen>
 #include <iomanip>
+#include <memory>
 #include <numeric>
 #include <random>
 
@@ -88,6 +89,38 @@ TEST(CartesianParametrisedTestFixture, CartesianFunctionsMatchF) {
     EXPECT_TRUE(pointsF.isApprox(points0F));
 }
 
+TEST(CartesianParametrisedTestFixture, SharedXYZLut) {
+    auto info = sensor::default_sensor_info(sensor::MODE_1024x10);
+    info.extrinsic = mat4d::Identity();
+    info.extrinsic(0, 3) = 2.0;
+
+    auto lut = shared_xyz_lut(info, true);
+    const auto expected = make_xyz_lut(info, true);
+    EXPECT_TRUE(lut->direction.isApprox(expected.direction));
+    EXPECT_TRUE(lut->offset.isApprox(expected.offset));
+
+    // the same inputs share a table, any difference gets its own
+    const auto copy = info;
+    EXPECT_EQ(shared_xyz_lut(copy, true), lut);
+    EXPECT_NE(shared_xyz_lut(info, false), lut);
+    auto other = info;
+    other.beam_altitude_angles[3] += 0.01;
+    EXPECT_NE(shared_xyz_lut(other, true), lut);
+    other = info;
+    other.extrinsic(1, 3) = 1.0;
+    EXPECT_NE(shared_xyz_lut(other, true), lut);
+    EXPECT_EQ(shared_xyz_lut(other, false), shared_xyz_lut(info, false));
+
+    auto lut_f = shared_xyz_lut_f(info, true);
+    EXPECT_EQ(shared_xyz_lut_f(info, true), lut_f);
+    EXPECT_TRUE(lut_f->direction.isApprox(expected.direction.cast<float>()));
+
+    // released with the last reference
+    std::weak_ptr<const XYZLut> weak = lut;
+    lut.reset();
+    EXPECT_TRUE(weak.expired());
+}
+
 TEST_P(CartesianParametrisedTestFixture, SpeedCheck) {
     std::map<std::string, std::string> styles = term_styles();
 
@@ -0,0 +1,125 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/clock_model.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+
+using namespace ouster;
+using namespace ouster::sensor;
+
+namespace {
+
+// a host clock 50 ppm fast and 1.7e18 ns ahead of a sensor counting from
+// power on
+constexpr uint64_t host_epoch = 1700000000000000000ULL;
+constexpr double skew = 50e-6;
+
+uint64_t host_at(uint64_t sensor_ts) {
+    return host_epoch + sensor_ts +
+           static_cast<uint64_t>(std::llround(skew * sensor_ts));
+}
+
+}  // namespace
+
+TEST(ClockModelTest, FitsOffsetAndSkewThroughDelays) {
+    ClockModel model;
+    EXPECT_FALSE(model.estimate().valid);
+    EXPECT_EQ(model.to_host(1000), 0u);
+
+    // packets every 0.78 ms over 20 s, delayed by 50 us plus jitter, with
+    // a 1 s stall of the consumer delaying everything by 30 ms
+    std::mt19937_64 rng(7);
+    std::exponential_distribution<double> jitter(1 / 20e3);
+    const uint64_t start = 3000000000ULL;
+    uint64_t sensor_ts = start;
+    for (int i = 0; i < 25600; i++) {
+        sensor_ts += 781250;
+        uint64_t delay = 50000 + static_cast<uint64_t>(jitter(rng));
+        if (sensor_ts > start + 15000000000ULL &&
+            sensor_ts < start + 16000000000ULL) {
+            delay += 30000000;
+        }
+        model.add(sensor_ts, host_at(sensor_ts) + delay);
+    }
+
+    const ClockEstimate e = model.estimate();
+    ASSERT_TRUE(e.valid);
+    EXPECT_EQ(e.intervals, 20u);
+    EXPECT_NEAR(e.skew_ppm, 50.0, 0.5);
+    EXPECT_LT(e.residual_ns, 5000);
+    // the constant delay is part of the offset
+    const int64_t expected = static_cast<int64_t>(host_at(sensor_ts) -
+                                                  sensor_ts) +
+                             50000;
+    EXPECT_NEAR(static_cast<double>(e.offset_ns - expected), 0, 5000);
+
+    // batch conversion, in place, keeps missing columns zero
+    std::vector<uint64_t> ts{sensor_ts - 1000000000ULL, 0, sensor_ts};
+    model.to_host(ts.data(), ts.size(), ts.data());
+    EXPECT_NEAR(static_cast<double>(ts[0] -
+                                    host_at(sensor_ts - 1000000000ULL)),
+                50000, 5000);
+    EXPECT_EQ(ts[1], 0u);
+    EXPECT_EQ(ts[2], model.to_host(sensor_ts));
+}
+
+TEST(ClockModelTest, RestartsOnClockReset) {
+    ClockModel model;
+    for (uint64_t t = 100000000000ULL; t < 110000000000ULL; t += 10000000) {
+        model.add(t, host_at(t));
+    }
+    EXPECT_EQ(model.estimate().resets, 0u);
+
+    // the sensor rebooted, its clock counts from zero again and the host
+    // clock kept going
+    const int64_t shift = 110000000000LL;
+    for (uint64_t t = 10000000; t < 2000000000ULL; t += 10000000) {
+        model.add(t, host_at(t + shift));
+    }
+    const ClockEstimate e = model.estimate();
+    EXPECT_EQ(e.resets, 1u);
+    EXPECT_LE(e.intervals, 5u);
+    EXPECT_NEAR(static_cast<double>(model.to_host(1000000000ULL) -
+                                    host_at(1000000000ULL + shift)),
+                0, 1000);
+
+    EXPECT_THROW(ClockModel(ClockModelOptions{0.0}), std::invalid_argument);
+}
+
+TEST(ClockModelTest, SamplesPacketsOfScans) {
+    LidarScan scan(64, 4);
+    const size_t per_packet = scan.w / scan.packet_timestamp().rows();
+    ASSERT_EQ(per_packet, 16u);
+    for (size_t col = 0; col < scan.w; col++) {
+        scan.timestamp()[col] = 5000000000ULL + col * 100000;
+    }
+    // the last column of the second packet is missing
+    scan.timestamp()[31] = 0;
+    for (Eigen::Index p = 0; p < scan.packet_timestamp().rows(); p++) {
+        const uint64_t last = 5000000000ULL + ((p + 1) * per_packet - 1) *
+                                                  100000;
+        scan.packet_timestamp()[p] = host_at(last) + 20000;
+    }
+    scan.packet_timestamp()[3] = 0;
+
+    ClockModel model;
+    model.add(scan);
+    const ClockEstimate e = model.estimate();
+    ASSERT_TRUE(e.valid);
+    // the scan spans 6.4 ms, within one interval, which keeps the sample
+    // of least delay
+    EXPECT_EQ(e.intervals, 1u);
+    EXPECT_EQ(e.offset_ns,
+              static_cast<int64_t>(host_at(e.sensor_ts) - e.sensor_ts) +
+                  20000);
+}
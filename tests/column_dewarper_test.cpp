@@ -0,0 +1,92 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/column_dewarper.h"
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Geometry>
+#include <stdexcept>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/types.h"
+#include "util.h"
+
+using namespace ouster;
+
+namespace {
+
+// trajectory turning and moving forward, with knots before the scan only
+pose_util::TrajectoryEvaluator make_trajectory() {
+    pose_util::Poses knots(2, 16);
+    Eigen::Matrix<double, 4, 4, Eigen::RowMajor> pose =
+        Eigen::Matrix<double, 4, 4, Eigen::RowMajor>::Identity();
+    knots.row(0) = Eigen::Map<pose_util::Pose>(pose.data());
+    pose.topLeftCorner<3, 3>() =
+        Eigen::AngleAxisd(0.1, Eigen::Vector3d::UnitZ()).toRotationMatrix();
+    pose(0, 3) = 0.5;
+    knots.row(1) = Eigen::Map<pose_util::Pose>(pose.data());
+    return pose_util::TrajectoryEvaluator({0.9e9, 1.0e9}, knots);
+}
+
+}  // namespace
+
+TEST(ColumnDewarperTest, SectorsMatchWholeScan) {
+    const auto info = sensor::default_sensor_info(sensor::MODE_512x10);
+    const auto lut = make_xyz_lut(info, true);
+    LidarScan scan = make_sparse_scan(info, 1000000000, 1000000);
+    const auto trajectory = make_trajectory();
+    mat4d extrinsic = mat4d::Identity();
+    extrinsic(2, 3) = 1.5;
+
+    ColumnDewarper dewarper(lut, scan.w, scan.h, trajectory, extrinsic);
+    // sectors in any order, one of them wrapping around
+    dewarper.dewarp(scan, {100, 299});
+    dewarper.dewarp(scan, {500, 49});
+    dewarper.dewarp(scan, {50, 99});
+    dewarper.dewarp(scan, {300, 499});
+
+    trajectory.pose_scan(scan);
+    const auto expected = pose_util::cartesian_dewarp(scan, lut, extrinsic);
+    EXPECT_TRUE(dewarper.points().isApprox(expected, 1e-12));
+    Eigen::Map<const pose_util::Poses> poses(scan.pose().get<double>(), scan.w,
+                                             16);
+    EXPECT_TRUE(dewarper.poses().isApprox(poses, 1e-12));
+}
+
+TEST(ColumnDewarperTest, PoseSourceAndErrors) {
+    const auto info = sensor::default_sensor_info(sensor::MODE_512x10);
+    const auto lut = make_xyz_lut(info, true);
+    LidarScan scan = make_sparse_scan(info, 1000000000, 1000000);
+
+    std::vector<double> queried;
+    ColumnDewarper dewarper(
+        lut, scan.w, scan.h,
+        [&queried](Eigen::Ref<pose_util::Poses> poses,
+                   const Eigen::Ref<const Eigen::ArrayXd>& ts) {
+            for (Eigen::Index i = 0; i < ts.size(); ++i) {
+                queried.push_back(ts(i));
+                poses.row(i) << 1, 0, 0, 1, 0, 1, 0, 2, 0, 0, 1, 3, 0, 0, 0, 1;
+            }
+        });
+    dewarper.dewarp(scan, {10, 12});
+    ASSERT_EQ(queried.size(), 3u);
+    EXPECT_EQ(queried[0], 1.010e9);
+
+    // only the window is written, translated by the poses
+    const auto xyz = cartesian(scan, lut);
+    const Eigen::Index ix = 3 * scan.w + 11;
+    const Eigen::Index other = 3 * scan.w + 13;
+    EXPECT_NEAR(dewarper.points()(ix, 2), xyz(ix, 2) + 3, 1e-9);
+    EXPECT_EQ(dewarper.points().row(other).norm(), 0.0);
+
+    EXPECT_THROW(dewarper.dewarp(scan, {0, 512}), std::invalid_argument);
+    EXPECT_THROW(ColumnDewarper(lut, scan.w, scan.h,
+                                ColumnDewarper::PoseSource()),
+                 std::invalid_argument);
+    EXPECT_THROW(ColumnDewarper(lut, scan.w + 1, scan.h, make_trajectory()),
+                 std::invalid_argument);
+}
@@ -0,0 +1,160 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/concurrent_queue.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+using ouster::BlockingQueue;
+using ouster::MpmcQueue;
+using ouster::SpscQueue;
+using ouster::Waiter;
+
+namespace {
+
+template <typename Queue>
+class QueueTest : public ::testing::Test {};
+
+using Queues = ::testing::Types<SpscQueue<int>, MpmcQueue<int>>;
+TYPED_TEST_SUITE(QueueTest, Queues);
+
+}  // namespace
+
+TYPED_TEST(QueueTest, fifo_up_to_capacity) {
+    TypeParam queue(3);
+    EXPECT_EQ(queue.capacity(), 3u);
+    EXPECT_TRUE(queue.empty());
+    int out = 0;
+    EXPECT_FALSE(queue.try_pop(out));
+
+    // wrap around the slots a few times
+    for (int round = 0; round < 4; round++) {
+        EXPECT_TRUE(queue.try_push(round));
+        EXPECT_TRUE(queue.try_push(round + 1));
+        EXPECT_TRUE(queue.try_emplace(round + 2));
+        EXPECT_FALSE(queue.try_push(-1));
+        EXPECT_EQ(queue.size(), 3u);
+        for (int i = 0; i < 3; i++) {
+            ASSERT_TRUE(queue.try_pop(out));
+            EXPECT_EQ(out, round + i);
+        }
+        EXPECT_FALSE(queue.try_pop(out));
+    }
+    EXPECT_THROW(TypeParam(0), std::invalid_argument);
+}
+
+TEST(ConcurrentQueueTest, full_queue_leaves_value_untouched) {
+    MpmcQueue<std::unique_ptr<int>> queue(1);
+    EXPECT_TRUE(queue.try_push(std::make_unique<int>(1)));
+    auto value = std::make_unique<int>(2);
+    EXPECT_FALSE(queue.try_push(std::move(value)));
+    ASSERT_TRUE(value);
+    EXPECT_EQ(*value, 2);
+}
+
+TEST(ConcurrentQueueTest, spsc_across_threads) {
+    SpscQueue<int> queue(16);
+    const int count = 100000;
+    std::thread producer([&] {
+        for (int i = 0; i < count; i++) {
+            while (!queue.try_push(i)) std::this_thread::yield();
+        }
+    });
+    int expected = 0;
+    while (expected < count) {
+        int out;
+        if (queue.try_pop(out)) {
+            ASSERT_EQ(out, expected);
+            expected++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+}
+
+TEST(ConcurrentQueueTest, mpmc_across_threads) {
+    BlockingQueue<MpmcQueue<int>> queue(64);
+    const int producers = 4;
+    const int consumers = 4;
+    const int per_producer = 20000;
+    std::vector<std::thread> threads;
+    std::atomic<int64_t> sum{0};
+    std::atomic<int> popped{0};
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&, p] {
+            for (int i = 0; i < per_producer; i++) {
+                ASSERT_TRUE(queue.push(p * per_producer + i));
+            }
+        });
+    }
+    for (int c = 0; c < consumers; c++) {
+        threads.emplace_back([&] {
+            int out;
+            while (queue.pop(out)) {
+                sum += out;
+                popped++;
+            }
+        });
+    }
+    for (int p = 0; p < producers; p++) threads[p].join();
+    queue.close();
+    for (size_t t = producers; t < threads.size(); t++) threads[t].join();
+
+    const int64_t n = producers * per_producer;
+    EXPECT_EQ(popped, n);
+    EXPECT_EQ(sum, n * (n - 1) / 2);
+}
+
+TEST(ConcurrentQueueTest, blocking_timeouts_and_close) {
+    BlockingQueue<SpscQueue<int>> queue(2);
+    int out = 0;
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(queue.pop(out, 0.05));
+    EXPECT_GE(std::chrono::steady_clock::now() - start,
+              std::chrono::milliseconds(40));
+
+    EXPECT_TRUE(queue.push(1));
+    EXPECT_TRUE(queue.push(2));
+    EXPECT_FALSE(queue.push(3, 0.01));
+
+    // a blocked push completes once a pop makes room
+    std::thread producer([&] { EXPECT_TRUE(queue.push(3)); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ASSERT_TRUE(queue.pop(out));
+    EXPECT_EQ(out, 1);
+    producer.join();
+
+    // closing wakes a blocked pop only once the queue is drained
+    queue.close();
+    EXPECT_TRUE(queue.closed());
+    EXPECT_FALSE(queue.push(4));
+    ASSERT_TRUE(queue.pop(out));
+    EXPECT_EQ(out, 2);
+    ASSERT_TRUE(queue.pop(out));
+    EXPECT_EQ(out, 3);
+    EXPECT_FALSE(queue.pop(out));
+}
+
+TEST(ConcurrentQueueTest, waiter_wakes_sleeper) {
+    Waiter waiter;
+    std::atomic<bool> ready{false};
+    std::thread sleeper([&] {
+        EXPECT_TRUE(waiter.wait([&] { return ready.load(); }, 5.0));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ready = true;
+    waiter.notify_all();
+    sleeper.join();
+
+    EXPECT_FALSE(waiter.wait([] { return false; }, 0.01));
+}
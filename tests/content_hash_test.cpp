@@ -0,0 +1,112 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/content_hash.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+
+using namespace ouster;
+
+namespace {
+
+LidarScan make_scan(int64_t frame_id) {
+    LidarScan scan(64, 16);
+    scan.frame_id = frame_id;
+    auto range = scan.field<uint32_t>(sensor::ChanField::RANGE);
+    for (Eigen::Index i = 0; i < range.size(); i++) {
+        range.data()[i] = static_cast<uint32_t>(i * 7 + frame_id);
+    }
+    std::iota(scan.timestamp().data(),
+              scan.timestamp().data() + scan.w, uint64_t{1000});
+    return scan;
+}
+
+}  // namespace
+
+TEST(ContentHashTest, HashesBytes) {
+    std::vector<uint8_t> bytes(5000);
+    std::iota(bytes.begin(), bytes.end(), uint8_t{0});
+    // every length through the short, stripe and block paths differs
+    std::set<uint64_t> hashes;
+    for (size_t n : {0, 1, 7, 8, 15, 16, 17, 63, 64, 65, 1023, 1024, 1025,
+                     4097, 5000}) {
+        const uint64_t h = hash_bytes(bytes.data(), n);
+        EXPECT_EQ(h, hash_bytes(bytes.data(), n));
+        hashes.insert(h);
+    }
+    EXPECT_EQ(hashes.size(), 15u);
+
+    // a single flipped bit anywhere changes the hash, as does the seed
+    const uint64_t h = hash_bytes(bytes.data(), bytes.size());
+    EXPECT_NE(h, hash_bytes(bytes.data(), bytes.size(), 1));
+    for (size_t i : {0, 100, 1023, 1024, 4095, 4999}) {
+        bytes[i] ^= 0x10;
+        EXPECT_NE(hash_bytes(bytes.data(), bytes.size()), h) << i;
+        bytes[i] ^= 0x10;
+    }
+    EXPECT_EQ(hash_bytes(bytes.data(), bytes.size()), h);
+}
+
+TEST(ContentHashTest, HashesWhatEqualsCompares) {
+    const LidarScan scan = make_scan(3);
+    LidarScan copy = scan;
+    ASSERT_EQ(copy, scan);
+    EXPECT_EQ(content_hash(copy), content_hash(scan));
+    EXPECT_EQ(content_hash(copy.field(sensor::ChanField::RANGE)),
+              content_hash(scan.field(sensor::ChanField::RANGE)));
+
+    copy.field<uint32_t>(sensor::ChanField::RANGE)(7, 9) += 1;
+    EXPECT_NE(content_hash(copy), content_hash(scan));
+    EXPECT_NE(content_hash(copy.field(sensor::ChanField::RANGE)),
+              content_hash(scan.field(sensor::ChanField::RANGE)));
+    // other fields are unaffected
+    EXPECT_EQ(content_hash(copy.field(sensor::ChanField::REFLECTIVITY)),
+              content_hash(scan.field(sensor::ChanField::REFLECTIVITY)));
+
+    copy = scan;
+    copy.frame_id = 4;
+    EXPECT_NE(content_hash(copy), content_hash(scan));
+    copy = scan;
+    copy.timestamp()[5] = 0;
+    EXPECT_NE(content_hash(copy), content_hash(scan));
+    copy = scan;
+    copy.pose().get<double>()[3] = 1.0;
+    EXPECT_NE(content_hash(copy), content_hash(scan));
+
+    // same values, another type
+    LidarScan other = scan;
+    other.del_field(sensor::ChanField::REFLECTIVITY);
+    other.add_field(sensor::ChanField::REFLECTIVITY,
+                    fd_array<uint16_t>(scan.h, scan.w));
+    EXPECT_NE(content_hash(other), content_hash(scan));
+}
+
+TEST(ContentHashTest, DeduplicatesHashedScans) {
+    std::unordered_set<HashedScan> seen;
+    size_t kept = 0;
+    for (int64_t frame_id : {0, 1, 0, 2, 1, 1}) {
+        auto scan = std::make_shared<const LidarScan>(make_scan(frame_id));
+        if (seen.emplace(scan).second) kept++;
+    }
+    EXPECT_EQ(kept, 3u);
+
+    const HashedScan a(std::make_shared<const LidarScan>(make_scan(5)));
+    HashedScan b(std::make_shared<const LidarScan>(make_scan(5)));
+    EXPECT_EQ(a, b);
+    // a hash collision still compares the contents
+    b.scan = std::make_shared<const LidarScan>(make_scan(6));
+    EXPECT_NE(a, b);
+
+    EXPECT_THROW(HashedScan{nullptr}, std::invalid_argument);
+}
@@ -0,0 +1,220 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/cuda_scan.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "ouster/image_processing.h"
+#include "ouster/lidar_scan.h"
+#include "ouster/types.h"
+
+using namespace ouster;
+using namespace ouster::sensor;
+
+namespace {
+
+bool have_device() {
+    int count = 0;
+    return cudaGetDeviceCount(&count) == cudaSuccess && count > 0;
+}
+
+LidarScan random_scan(const sensor_info& info) {
+    LidarScan scan(info);
+    std::mt19937 g(11);
+    std::uniform_int_distribution<uint32_t> r(0, 200000);
+    auto range = scan.field<uint32_t>(ChanField::RANGE);
+    for (Eigen::Index i = 0; i < range.size(); i++) {
+        range.data()[i] = (i % 7 == 0) ? 0 : r(g);
+    }
+    auto refl = scan.field<uint8_t>(ChanField::REFLECTIVITY);
+    for (Eigen::Index i = 0; i < refl.size(); i++) {
+        refl.data()[i] = static_cast<uint8_t>(r(g));
+    }
+    for (size_t w = 0; w < scan.w; w++) {
+        Eigen::Ref<img_t<double>> pose = scan.pose().subview(w);
+        const double a = 0.001 * w;
+        pose << std::cos(a), -std::sin(a), 0, 0.01 * w, std::sin(a),
+            std::cos(a), 0, -0.02 * w, 0, 0, 1, 0.5, 0, 0, 0, 1;
+    }
+    return scan;
+}
+
+}  // namespace
+
+class CudaScanTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        if (!have_device()) GTEST_SKIP() << "no CUDA device";
+        info = default_sensor_info(MODE_512x10);
+        scan = random_scan(info);
+    }
+
+    sensor_info info;
+    LidarScan scan{0, 0};
+};
+
+TEST_F(CudaScanTest, upload_download_roundtrip) {
+    cuda::DeviceScan dev(scan);
+    cuda::ScanUploader uploader;
+    uploader.upload(scan, dev);
+
+    LidarScan back(info);
+    dev.download(back);
+    EXPECT_EQ(back.field(ChanField::RANGE), scan.field(ChanField::RANGE));
+    EXPECT_EQ(back.field(ChanField::REFLECTIVITY),
+              scan.field(ChanField::REFLECTIVITY));
+    EXPECT_EQ(back.pose(), scan.pose());
+
+    cuda::DeviceScan range_only(scan, {ChanField::RANGE});
+    EXPECT_TRUE(range_only.has_field(ChanField::RANGE));
+    EXPECT_FALSE(range_only.has_field(ChanField::REFLECTIVITY));
+    EXPECT_THROW(range_only.field<float>(ChanField::RANGE),
+                 std::invalid_argument);
+    EXPECT_THROW(cuda::DeviceScan(scan, {"NOT_A_FIELD"}),
+                 std::invalid_argument);
+
+    LidarScan other(info.format.columns_per_frame / 2,
+                    info.format.pixels_per_column);
+    EXPECT_THROW(uploader.upload(other, dev), std::invalid_argument);
+}
+
+TEST_F(CudaScanTest, cartesian_matches_cpu) {
+    const auto lut_f = make_xyz_lut_f(info, true);
+    const PointsF expected = cartesian(scan, lut_f);
+
+    cuda::DeviceScan dev(scan, {ChanField::RANGE});
+    cuda::ScanUploader uploader;
+    uploader.upload(scan, dev);
+    auto lut = cuda::make_device_xyz_lut(lut_f);
+    const size_t n = scan.w * scan.h;
+    cuda::DeviceBuffer<float> xyz(3 * n);
+
+    cuda::cartesian(dev, lut, xyz.data());
+    PointsF planar(n, 3);
+    xyz.copy_to(planar.data(), 3 * n);
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+    // within a hundredth of a millimeter of the CPU kernels
+    EXPECT_LT((planar - expected).abs().maxCoeff(), 1e-5f);
+
+    cuda::cartesian_interleaved(dev.field<uint32_t>(ChanField::RANGE), lut,
+                                xyz.data());
+    std::vector<float> interleaved(3 * n);
+    xyz.copy_to(interleaved.data(), 3 * n);
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+    for (size_t i = 0; i < n; i++) {
+        for (int c = 0; c < 3; c++) {
+            EXPECT_FLOAT_EQ(interleaved[3 * i + c], planar(i, c));
+        }
+    }
+
+    XYZLutF small{lut_f.direction.topRows(10), lut_f.offset.topRows(10)};
+    EXPECT_THROW(cuda::cartesian(dev, cuda::make_device_xyz_lut(small),
+                                 xyz.data()),
+                 std::invalid_argument);
+}
+
+TEST_F(CudaScanTest, destagger_matches_cpu) {
+    const auto& shifts = info.format.pixel_shift_by_row;
+    cuda::DeviceBuffer<int> dev_shifts(shifts);
+    cuda::DeviceScan dev(scan);
+    cuda::ScanUploader uploader;
+    uploader.upload(scan, dev);
+
+    auto range = scan.field<uint32_t>(ChanField::RANGE);
+    const img_t<uint32_t> expected = destagger<uint32_t>(range, shifts);
+    const size_t n = scan.w * scan.h;
+    cuda::DeviceBuffer<uint32_t> out(n);
+    cuda::DeviceBuffer<uint32_t> back(n);
+    cuda::destagger(dev.field<uint32_t>(ChanField::RANGE), out.data(), scan.w,
+                    scan.h, dev_shifts.data());
+    cuda::stagger(out.data(), back.data(), scan.w, scan.h, dev_shifts.data());
+
+    img_t<uint32_t> actual(scan.h, scan.w);
+    img_t<uint32_t> restaggered(scan.h, scan.w);
+    out.copy_to(actual.data(), n);
+    back.copy_to(restaggered.data(), n);
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+    EXPECT_TRUE((actual == expected).all());
+    EXPECT_TRUE((restaggered == range).all());
+
+    // fields of any pixel size through the scan overload
+    auto refl = scan.field<uint8_t>(ChanField::REFLECTIVITY);
+    const img_t<uint8_t> refl_expected = destagger<uint8_t>(refl, shifts);
+    cuda::DeviceBuffer<uint8_t> refl_out(n);
+    cuda::destagger(dev, ChanField::REFLECTIVITY, refl_out.data(),
+                    dev_shifts.data());
+    img_t<uint8_t> refl_actual(scan.h, scan.w);
+    refl_out.copy_to(refl_actual.data(), n);
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+    EXPECT_TRUE((refl_actual == refl_expected).all());
+
+    EXPECT_THROW(cuda::destagger(dev, "NOT_A_FIELD", refl_out.data(),
+                                 dev_shifts.data()),
+                 std::invalid_argument);
+}
+
+TEST_F(CudaScanTest, dewarp_matches_cpu) {
+    const auto lut_f = make_xyz_lut_f(info, false);
+    const PointsF points = cartesian(scan, lut_f);
+    Eigen::Map<const pose_util::Poses> poses(scan.pose().get<double>(), scan.w,
+                                             16);
+    const pose_util::Points expected =
+        pose_util::dewarp(points.cast<double>(), poses);
+
+    cuda::DeviceScan dev(scan, {ChanField::RANGE});
+    cuda::ScanUploader uploader;
+    uploader.upload(scan, dev);
+    auto lut = cuda::make_device_xyz_lut(lut_f);
+    const size_t n = scan.w * scan.h;
+    cuda::DeviceBuffer<float> xyz(3 * n);
+    cuda::cartesian(dev, lut, xyz.data());
+    // in place
+    cuda::dewarp(xyz.data(), dev.pose(), scan.w, scan.h, xyz.data());
+
+    PointsF actual(n, 3);
+    xyz.copy_to(actual.data(), 3 * n);
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+    EXPECT_LT((actual.cast<double>() - expected.array()).abs().maxCoeff(),
+              1e-3);
+}
+
+TEST_F(CudaScanTest, autoexposure_matches_cpu) {
+    const size_t n = scan.w * scan.h;
+    std::mt19937 g(3);
+    std::uniform_real_distribution<float> d(0.0f, 3000.0f);
+
+    viz::AutoExposure cpu_ae;
+    cuda::AutoExposure gpu_ae;
+    cuda::DeviceBuffer<float> dev_img(n);
+    img_t<float> img(scan.h, scan.w);
+    img_t<float> actual(scan.h, scan.w);
+    for (int frame = 0; frame < 5; frame++) {
+        for (Eigen::Index i = 0; i < img.size(); i++) {
+            img.data()[i] = (i % 11 == 0) ? 0.0f : d(g);
+        }
+        dev_img.copy_from(img.data(), n);
+        gpu_ae(dev_img.data(), n);
+        cpu_ae(img);
+        dev_img.copy_to(actual.data(), n);
+        ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+        EXPECT_LT((actual - img).abs().maxCoeff(), 1e-5f) << "frame " << frame;
+    }
+
+    // too few nonzero pixels leaves the first image untouched
+    cuda::AutoExposure fresh;
+    img.setZero();
+    img(0, 0) = 5.0f;
+    dev_img.copy_from(img.data(), n);
+    fresh(dev_img.data(), n);
+    dev_img.copy_to(actual.data(), n);
+    ASSERT_EQ(cudaDeviceSynchronize(), cudaSuccess);
+    EXPECT_TRUE((actual == img).all());
+}
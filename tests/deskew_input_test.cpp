@@ -0,0 +1,74 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/deskew_input.h"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/types.h"
+#include "util.h"
+
+using namespace ouster;
+
+TEST(DeskewInputTest, PointsAndNormalizedTimes) {
+    const auto info = sensor::default_sensor_info(sensor::MODE_512x10);
+    const auto lut = make_xyz_lut(info, true);
+    DeskewInput input({lut, lut});
+    EXPECT_EQ(input.sensors_count(), 2u);
+
+    LidarScan a = make_sparse_scan(info, 1000000, 1000);
+    LidarScan b = make_sparse_scan(info, 2000000, 1000);
+    // columns outside of the valid span keep a time of 0
+    a.status()(0) = 0;
+    const int64_t offset_b = -998000;
+
+    const size_t n = input.build({&a, &b}, {0, offset_b});
+    const Eigen::Index w = a.w;
+    const double start = 1000000 + 1000;
+    const double stop = 2000000 + offset_b + (w - 1) * 1000.0;
+
+    const auto range_a = a.field<uint32_t>(sensor::ChanField::RANGE);
+    const LidarScan::Points xyz = cartesian(a, lut);
+    ASSERT_EQ(n, 2 * static_cast<size_t>((range_a != 0).count()));
+    ASSERT_EQ(input.points().rows(), static_cast<Eigen::Index>(n));
+    ASSERT_EQ(input.times().size(), static_cast<Eigen::Index>(n));
+
+    Eigen::Index j = 0;
+    for (const LidarScan* scan : {&a, &b}) {
+        const int64_t offset = scan == &a ? 0 : offset_b;
+        for (Eigen::Index i = 0; i < range_a.size(); ++i) {
+            if (range_a.data()[i] == 0) continue;
+            const Eigen::Index c = i % w;
+            const double t =
+                (scan == &a && c == 0)
+                    ? 0
+                    : (double(scan->timestamp()(c)) + offset - start) /
+                          (stop - start);
+            EXPECT_NEAR(input.times()(j), t, 1e-12);
+            EXPECT_TRUE(input.points().row(j).isApprox(xyz.row(i)));
+            ++j;
+        }
+    }
+    EXPECT_EQ(input.column_times(0)(0), 0.0);
+    EXPECT_NEAR(input.column_times(1)(w - 1), 1.0, 1e-12);
+
+    // out of order timestamps fall back to even spacing, and a missing scan
+    // has no column times
+    b.timestamp()(5) = b.timestamp()(4);
+    const size_t m = input.build({nullptr, &b}, {0, 0});
+    EXPECT_EQ(m, n / 2);
+    EXPECT_EQ(input.column_times(0).size(), 0);
+    EXPECT_NEAR(input.column_times(1)(w / 2), double(w / 2) / (w - 1),
+                1e-12);
+
+    EXPECT_THROW(input.build({&a}, {0}), std::invalid_argument);
+    LidarScan small(16, 4);
+    EXPECT_THROW(input.build({&small, &b}, {0, 0}), std::invalid_argument);
+    EXPECT_THROW(DeskewInput({}), std::invalid_argument);
+}
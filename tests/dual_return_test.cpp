@@ -0,0 +1,151 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/dual_return.h"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/types.h"
+
+using namespace ouster;
+using namespace ouster::sensor;
+
+namespace {
+
+constexpr size_t w = 4;
+constexpr size_t h = 2;
+constexpr auto dual_profile =
+    UDPProfileLidar::PROFILE_RNG19_RFL8_SIG16_NIR16_DUAL;
+constexpr auto single_profile = UDPProfileLidar::PROFILE_RNG19_RFL8_SIG16_NIR16;
+
+// pixel 0: both returns, the second stronger and farther
+// pixel 1: only the second return
+// pixel 2: both returns, the first stronger and farther
+// pixel 3: only the first return
+// pixels 4 - 7: no returns
+LidarScan make_dual() {
+    LidarScan scan(w, h, dual_profile);
+    auto r1 = scan.field<uint32_t>(ChanField::RANGE);
+    auto r2 = scan.field<uint32_t>(ChanField::RANGE2);
+    auto s1 = scan.field<uint16_t>(ChanField::SIGNAL);
+    auto s2 = scan.field<uint16_t>(ChanField::SIGNAL2);
+    auto f1 = scan.field<uint8_t>(ChanField::REFLECTIVITY);
+    auto f2 = scan.field<uint8_t>(ChanField::REFLECTIVITY2);
+    r1.row(0) << 1000, 0, 3000, 4000;
+    r2.row(0) << 1500, 2000, 2500, 0;
+    s1.row(0) << 10, 0, 30, 40;
+    s2.row(0) << 20, 5, 3, 0;
+    f1.row(0) << 1, 0, 3, 4;
+    f2.row(0) << 11, 12, 13, 0;
+    return scan;
+}
+
+// a lut along x, in mm
+XYZLut make_lut() {
+    XYZLut lut;
+    lut.direction = LidarScan::Points::Zero(w * h, 3);
+    lut.direction.col(0).setConstant(0.001);
+    lut.offset = LidarScan::Points::Zero(w * h, 3);
+    return lut;
+}
+
+std::vector<uint32_t> row0(const LidarScan& scan, const char* name) {
+    const auto f = scan.field<uint32_t>(name);
+    return {f(0, 0), f(0, 1), f(0, 2), f(0, 3)};
+}
+
+}  // namespace
+
+TEST(DualReturnTest, SelectsReturns) {
+    const LidarScan scan = make_dual();
+    LidarScan out(w, h, single_profile);
+
+    select_returns(scan, ReturnSelection::STRONGEST, out);
+    EXPECT_EQ(row0(out, ChanField::RANGE),
+              (std::vector<uint32_t>{1500, 2000, 3000, 4000}));
+    const auto signal = out.field<uint16_t>(ChanField::SIGNAL);
+    EXPECT_EQ(signal(0, 0), 20);
+    EXPECT_EQ(signal(0, 2), 30);
+    const auto refl = out.field<uint8_t>(ChanField::REFLECTIVITY);
+    EXPECT_EQ(refl(0, 1), 12);
+    EXPECT_EQ(refl(0, 3), 4);
+
+    select_returns(scan, ReturnSelection::NEAREST, out);
+    EXPECT_EQ(row0(out, ChanField::RANGE),
+              (std::vector<uint32_t>{1000, 2000, 2500, 4000}));
+    select_returns(scan, ReturnSelection::FARTHEST, out);
+    EXPECT_EQ(row0(out, ChanField::RANGE),
+              (std::vector<uint32_t>{1500, 2000, 3000, 4000}));
+    EXPECT_EQ(out.field<uint32_t>(ChanField::RANGE).row(1).sum(), 0u);
+
+    // in place, the second returns left as they were
+    LidarScan inplace = make_dual();
+    select_returns(inplace, ReturnSelection::NEAREST, inplace);
+    EXPECT_EQ(row0(inplace, ChanField::RANGE),
+              (std::vector<uint32_t>{1000, 2000, 2500, 4000}));
+    EXPECT_EQ(row0(inplace, ChanField::RANGE2),
+              row0(scan, ChanField::RANGE2));
+
+    EXPECT_THROW(select_returns(scan, ReturnSelection::BOTH, out),
+                 std::invalid_argument);
+    EXPECT_THROW(select_returns(out, ReturnSelection::NEAREST, out),
+                 std::invalid_argument);
+    LidarScan small(w / 2, h, single_profile);
+    EXPECT_THROW(select_returns(scan, ReturnSelection::NEAREST, small),
+                 std::invalid_argument);
+}
+
+TEST(DualReturnTest, ProjectsSelectedReturns) {
+    const LidarScan scan = make_dual();
+    const XYZLut lut = make_lut();
+    LidarScan::Points points(2 * w * h, 3);
+    Eigen::Array<uint32_t, Eigen::Dynamic, 1> index(2 * w * h);
+
+    size_t n = cartesian_returns(points, index, scan, lut,
+                                 ReturnSelection::FARTHEST);
+    ASSERT_EQ(n, 4u);
+    EXPECT_EQ(index.head(n).matrix(),
+              (Eigen::Vector4i(8, 9, 2, 3).cast<uint32_t>()));
+    EXPECT_DOUBLE_EQ(points(0, 0), 1.5);
+    EXPECT_DOUBLE_EQ(points(2, 0), 3.0);
+
+    n = cartesian_returns(points, index, scan, lut, ReturnSelection::BOTH);
+    ASSERT_EQ(n, 6u);
+    std::vector<uint32_t> both(index.data(), index.data() + n);
+    EXPECT_EQ(both, (std::vector<uint32_t>{0, 8, 9, 2, 10, 3}));
+    EXPECT_DOUBLE_EQ(points(4, 0), 2.5);
+
+    // thresholds apply to the reflectivity of each return
+    CompactFilter filter;
+    filter.min_reflectivity = 4;
+    filter.max_range = 3000;
+    n = cartesian_returns(points, index, scan, lut, ReturnSelection::BOTH,
+                          filter);
+    both.assign(index.data(), index.data() + n);
+    EXPECT_EQ(both, (std::vector<uint32_t>{8, 9, 10}));
+
+    // single precision agrees
+    Eigen::Array<float, Eigen::Dynamic, 3> points_f(2 * w * h, 3);
+    n = cartesian_returns(points_f, index, scan, make_xyz_lut_f(lut),
+                          ReturnSelection::NEAREST);
+    ASSERT_EQ(n, 4u);
+    EXPECT_FLOAT_EQ(points_f(2, 0), 2.5f);
+
+    // a single return scan projects its returns
+    LidarScan single(w, h, single_profile);
+    single.field<uint32_t>(ChanField::RANGE)(1, 1) = 700;
+    n = cartesian_returns(points, index, single, lut, ReturnSelection::BOTH);
+    ASSERT_EQ(n, 1u);
+    EXPECT_EQ(index(0), 5u);
+
+    LidarScan::Points few(w * h, 3);
+    EXPECT_THROW(cartesian_returns(few, index, scan, lut,
+                                   ReturnSelection::BOTH),
+                 std::invalid_argument);
+}
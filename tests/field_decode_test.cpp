@@ -0,0 +1,80 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/impl/field_decode.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace ouster::sensor::impl;
+
+namespace {
+
+struct field_case {
+    size_t dst_size;
+    uint64_t mask;
+    int shift;
+};
+
+}  // namespace
+
+class FieldDecodeTest : public ::testing::TestWithParam<decode_kernel> {};
+
+TEST_P(FieldDecodeTest, matches_scalar_reference) {
+    if (!decode_kernel_supported(GetParam())) {
+        EXPECT_THROW(get_decode_fn(GetParam(), 4), std::invalid_argument);
+        GTEST_SKIP() << "kernel not supported on this CPU";
+    }
+
+    // masks and shifts like the lidar profiles use, including the upshifted
+    // low bandwidth range and values wider than the destination
+    const std::vector<field_case> cases = {
+        {4, 0x000FFFFF, 0},
+        {2, 0xFFFF, 0},
+        {1, 0xFF, 0},
+        {1, 0xF0, 4},
+        {4, 0x7FFF, -3},
+        {8, 0xFFFFFFFFFFFFFFFF, 0},
+        {8, 0x0000FFFFFFFF0000, 16},
+        {2, 0x00FFFF00, 8},
+        {1, 0xFFFF, 0},
+        {4, 0xFFFFFFFFFF, 0},
+    };
+
+    std::mt19937 g(0xdeadbeef);
+    std::uniform_int_distribution<int> byte(0, 255);
+    const size_t stride = 76;
+    const int max_n = 19;
+    std::vector<uint8_t> buf(stride * max_n + 8);
+    for (auto& b : buf) b = static_cast<uint8_t>(byte(g));
+
+    for (const auto& c : cases) {
+        auto ref = get_decode_fn(decode_kernel::SCALAR, c.dst_size);
+        auto fn = get_decode_fn(GetParam(), c.dst_size);
+        for (int n : {1, 3, 4, 8, 16, max_n}) {
+            std::vector<uint8_t> expected(n * c.dst_size, 0xAA);
+            std::vector<uint8_t> actual(n * c.dst_size, 0x55);
+            ref(buf.data() + 3, stride, n, c.mask, c.shift, expected.data());
+            fn(buf.data() + 3, stride, n, c.mask, c.shift, actual.data());
+            EXPECT_EQ(expected, actual)
+                << "dst_size " << c.dst_size << " mask " << c.mask
+                << " shift " << c.shift << " n " << n;
+        }
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(FieldDecodeKernels, FieldDecodeTest,
+                        ::testing::Values(decode_kernel::SCALAR,
+                                          decode_kernel::AVX2,
+                                          decode_kernel::NEON));
+
+TEST(FieldDecodeKernelTest, best_kernel_is_supported) {
+    EXPECT_TRUE(decode_kernel_supported(best_decode_kernel()));
+    EXPECT_THROW(get_decode_fn(decode_kernel::SCALAR, 3),
+                 std::invalid_argument);
+}
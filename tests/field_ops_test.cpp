@@ -0,0 +1,216 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/field_ops.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace ouster;
+using namespace ouster::field_ops;
+using ouster::sensor::ChanFieldType;
+
+namespace {
+
+// odd sizes exercise the scalar tails of vectorized loops
+constexpr size_t n = 1037;
+
+template <typename T>
+FieldView view_of(std::vector<T>& values) {
+    return {values.data(), fd_array<T>(values.size())};
+}
+
+template <typename T>
+std::vector<T> random_values(std::mt19937& rng) {
+    std::uniform_real_distribution<double> dist(
+        static_cast<double>(std::numeric_limits<T>::lowest()),
+        static_cast<double>(std::numeric_limits<T>::max()));
+    std::vector<T> values(n);
+    for (auto& v : values) v = static_cast<T>(dist(rng));
+    // boundaries and small values, where rounding of the bounds matters
+    values[0] = std::numeric_limits<T>::lowest();
+    values[1] = std::numeric_limits<T>::max();
+    for (size_t i = 2; i < 40; i++) values[i] = static_cast<T>(i - 10);
+    return values;
+}
+
+bool reference(CompareOp op, double v, double x) {
+    switch (op) {
+        case CompareOp::LESS:
+            return v < x;
+        case CompareOp::LESS_EQUAL:
+            return v <= x;
+        case CompareOp::GREATER:
+            return v > x;
+        case CompareOp::GREATER_EQUAL:
+            return v >= x;
+        case CompareOp::EQUAL:
+            return v == x;
+        case CompareOp::NOT_EQUAL:
+            return v != x;
+    }
+    return false;
+}
+
+const std::vector<double> operands{
+    -1e300, -129, -3.5, -1, 0, 0.5, 1, 7, 7.25, 255, 256, 65535.5,
+    4294967295.0, 1e300, std::numeric_limits<double>::quiet_NaN()};
+
+template <typename T>
+void check_compare_and_threshold() {
+    std::mt19937 rng(7);
+    auto values = random_values<T>(rng);
+    std::vector<uint8_t> out(n);
+    for (int o = 0; o <= static_cast<int>(CompareOp::NOT_EQUAL); o++) {
+        const auto op = static_cast<CompareOp>(o);
+        for (double x : operands) {
+            compare(view_of(values), op, x, view_of(out));
+            for (size_t i = 0; i < n; i++) {
+                ASSERT_EQ(out[i], reference(op, values[i], x) ? 1 : 0)
+                    << "op " << o << " operand " << x << " value "
+                    << +values[i];
+            }
+        }
+    }
+    for (double lo : operands) {
+        for (double hi : {-2.5, 8.0, 300.0, 1e300}) {
+            auto filtered = values;
+            threshold(view_of(filtered), lo, hi, 3);
+            for (size_t i = 0; i < n; i++) {
+                const double v = values[i];
+                const T expected = (v < lo || v > hi) ? T(3) : values[i];
+                ASSERT_EQ(filtered[i], expected)
+                    << "bounds " << lo << ", " << hi << " value " << +v;
+            }
+        }
+    }
+}
+
+}  // namespace
+
+TEST(FieldOpsTest, convert_saturates) {
+    std::vector<float> floats{-1.5f, 0.f, 1.9f, 254.5f, 300.f,
+                              std::numeric_limits<float>::quiet_NaN()};
+    std::vector<uint8_t> bytes(floats.size());
+    convert(view_of(floats), view_of(bytes));
+    EXPECT_EQ(bytes, (std::vector<uint8_t>{0, 0, 1, 254, 255, 0}));
+
+    std::vector<int16_t> shorts{-5, 0, 32767, -32768};
+    std::vector<uint16_t> ushorts(shorts.size());
+    convert(view_of(shorts), view_of(ushorts));
+    EXPECT_EQ(ushorts, (std::vector<uint16_t>{0, 0, 32767, 0}));
+
+    std::vector<uint64_t> big{1ull << 40, 5};
+    std::vector<int32_t> ints(big.size());
+    convert(view_of(big), view_of(ints));
+    EXPECT_EQ(ints, (std::vector<int32_t>{2147483647, 5}));
+
+    std::vector<double> doubles{1e20, -1e20, 3.99};
+    std::vector<int64_t> longs(doubles.size());
+    convert(view_of(doubles), view_of(longs));
+    EXPECT_EQ(longs[0], std::numeric_limits<int64_t>::max());
+    EXPECT_EQ(longs[1], std::numeric_limits<int64_t>::min());
+    EXPECT_EQ(longs[2], 3);
+}
+
+TEST(FieldOpsTest, convert_matches_casts) {
+    // several blocks of work when split across threads
+    const size_t big = 200003;
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<uint32_t> dist(0, 1 << 20);
+    std::vector<uint32_t> range(big);
+    for (auto& r : range) r = dist(rng);
+    std::vector<float> out(big);
+    convert(view_of(range), view_of(out), true);
+    for (size_t i = 0; i < big; i++) {
+        ASSERT_EQ(out[i], static_cast<float>(range[i]));
+    }
+}
+
+TEST(FieldOpsTest, scale) {
+    std::vector<uint32_t> range(n);
+    for (size_t i = 0; i < n; i++) range[i] = static_cast<uint32_t>(i * 37);
+    std::vector<float> meters(n);
+    scale(view_of(range), view_of(meters), 0.001, 0.5);
+    for (size_t i = 0; i < n; i++) {
+        // within rounding, the kernel may fuse the multiply and add
+        ASSERT_FLOAT_EQ(meters[i],
+                        static_cast<float>(range[i]) * 0.001f + 0.5f);
+    }
+
+    // in place, saturating
+    scale(view_of(range), view_of(range), -2.0, 1000);
+    EXPECT_EQ(range[0], 1000u);
+    EXPECT_EQ(range[13], 38u);
+    EXPECT_EQ(range[14], 0u);
+    EXPECT_EQ(range[n - 1], 0u);
+}
+
+TEST(FieldOpsTest, clip) {
+    std::vector<int16_t> values{-300, -2, 0, 1, 2, 3, 300};
+    clip(view_of(values), -1.5, 2.5);
+    EXPECT_EQ(values, (std::vector<int16_t>{-1, -1, 0, 1, 2, 2, 2}));
+
+    std::vector<float> floats{-3.f, 0.25f, 9.f};
+    clip(view_of(floats), 0, 1);
+    EXPECT_EQ(floats, (std::vector<float>{0.f, 0.25f, 1.f}));
+
+    std::vector<uint8_t> bytes{0, 100, 255};
+    clip(view_of(bytes), -1e9, 1e9);
+    EXPECT_EQ(bytes, (std::vector<uint8_t>{0, 100, 255}));
+
+    EXPECT_THROW(clip(view_of(bytes), 2, 1), std::invalid_argument);
+    EXPECT_THROW(clip(view_of(bytes), std::nan(""), 1),
+                 std::invalid_argument);
+}
+
+TEST(FieldOpsTest, compare_and_threshold_match_double_comparisons) {
+    check_compare_and_threshold<uint8_t>();
+    check_compare_and_threshold<uint16_t>();
+    check_compare_and_threshold<uint32_t>();
+    check_compare_and_threshold<int8_t>();
+    check_compare_and_threshold<int16_t>();
+    check_compare_and_threshold<int32_t>();
+    check_compare_and_threshold<int64_t>();
+    check_compare_and_threshold<float>();
+    check_compare_and_threshold<double>();
+}
+
+TEST(FieldOpsTest, mask) {
+    std::vector<uint16_t> flags{1, 0, 7, 0};
+    std::vector<float> values(12, 2.f);
+    mask(view_of(values), view_of(flags), -1);
+    EXPECT_EQ(values, (std::vector<float>{2, 2, 2, -1, -1, -1, 2, 2, 2, -1,
+                                          -1, -1}));
+
+    std::vector<uint32_t> range(n, 5);
+    std::vector<uint8_t> valid(n, 0);
+    for (size_t i = 0; i < n; i += 3) valid[i] = 1;
+    mask(view_of(range), view_of(valid), 0, true);
+    for (size_t i = 0; i < n; i++) {
+        ASSERT_EQ(range[i], i % 3 ? 0u : 5u);
+    }
+}
+
+TEST(FieldOpsTest, errors) {
+    std::vector<uint32_t> a(16);
+    std::vector<uint32_t> b(15);
+    std::vector<uint16_t> c(16);
+    EXPECT_THROW(convert(view_of(a), view_of(b)), std::invalid_argument);
+    EXPECT_THROW(compare(view_of(a), CompareOp::LESS, 1, view_of(c)),
+                 std::invalid_argument);
+    EXPECT_THROW(mask(view_of(a), view_of(b)), std::invalid_argument);
+
+    auto desc = fd_array<uint32_t>(2, 4);
+    desc.strides = {8, 1};
+    FieldView sparse(a.data(), desc);
+    EXPECT_THROW(threshold(sparse, 0, 1), std::invalid_argument);
+}
@@ -645,3 +645,52 @@ TEST(Field_tests, uint_view_tests) {
     FieldView view{vec.data(), fd_array<my_struct>(100)};
     EXPECT_THROW(uint_view(view), std::invalid_argument);
 }
+
+TEST(Field_tests, fixed_view_test) {
+    // owned field memory is aligned, for any element size
+    for (size_t n : {1, 3, 100}) {
+        Field f(fd_array<uint8_t>(n));
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(f.get()) % field_alignment, 0u);
+        Field copy = f;
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(copy.get()) % field_alignment,
+                  0u);
+    }
+
+    Field f(fd_array<uint32_t>(64, 1024));
+    FixedFieldView<uint32_t, 64, 1024> view(f);
+    EXPECT_EQ(view.data(), f.get<uint32_t>());
+    std::iota(view.begin(), view.end(), uint32_t{0});
+    EXPECT_EQ(view(3, 5), 3u * 1024 + 5);
+    EXPECT_EQ(view.row(3)[5], view(3, 5));
+    EXPECT_EQ(view[7], 7u);
+
+    const Field& cf = f;
+    FixedFieldView<const uint32_t, 64, 1024> cview(cf);
+    EXPECT_EQ(cview(63, 1023), 64u * 1024 - 1);
+
+    using wrong_shape = FixedFieldView<uint32_t, 128, 1024>;
+    using wrong_type = FixedFieldView<uint16_t, 64, 1024>;
+    EXPECT_THROW(wrong_shape{f}, std::invalid_argument);
+    EXPECT_THROW(wrong_type{f}, std::invalid_argument);
+    // dense, but not aligned
+    std::vector<uint32_t> buf(32 * 1024 + 1);
+    FieldView unaligned{buf.data() + 1, fd_array<uint32_t>(32, 1024)};
+    EXPECT_THROW((FixedFieldView<uint32_t, 32, 1024>{unaligned}),
+                 std::invalid_argument);
+
+    size_t visited = 0;
+    EXPECT_TRUE(visit_fixed_shape<uint32_t>(f, [&](auto v) {
+        EXPECT_EQ(decltype(v)::rows, 64u);
+        EXPECT_EQ(decltype(v)::cols, 1024u);
+        for (auto& x : v) x += 1;
+        visited++;
+    }));
+    EXPECT_EQ(visited, 1u);
+    EXPECT_EQ(view[0], 1u);
+    EXPECT_TRUE(visit_fixed_shape<const uint32_t>(
+        cf, [&](auto v) { EXPECT_EQ(v[10], 11u); }));
+
+    Field odd(fd_array<uint32_t>(32, 1024));
+    EXPECT_FALSE(visit_fixed_shape<uint32_t>(odd, [&](auto) { visited++; }));
+    EXPECT_EQ(visited, 1u);
+}
@@ -0,0 +1,152 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/fused_cloud.h"
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Geometry>
+#include <stdexcept>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/types.h"
+
+using namespace ouster;
+
+namespace {
+
+// scan with every (skip)th pixel empty and signal equal to the range / 10
+LidarScan make_scan(const sensor::sensor_info& info, int skip) {
+    LidarScan scan(info);
+    auto range = scan.field<uint32_t>(sensor::ChanField::RANGE);
+    auto signal = scan.field<uint16_t>(sensor::ChanField::SIGNAL);
+    for (Eigen::Index i = 0; i < range.size(); ++i) {
+        range.data()[i] = (i % skip == 0) ? 0 : 1000 + i % 9000;
+        signal.data()[i] = static_cast<uint16_t>(range.data()[i] / 10);
+    }
+    return scan;
+}
+
+mat4d make_extrinsic(double yaw, double x, double y) {
+    Eigen::Affine3d t(Eigen::AngleAxisd(yaw, Eigen::Vector3d::UnitZ()));
+    t.translation() << x, y, 0.5;
+    return t.matrix();
+}
+
+// cartesian points of a scan moved by an extrinsic, without empty pixels
+pose_util::Points expected_points(const LidarScan& scan, const XYZLut& lut,
+                                  const mat4d& extrinsic, bool compact) {
+    const LidarScan::Points xyz = cartesian(scan, lut);
+    const auto range = scan.field<uint32_t>(sensor::ChanField::RANGE);
+    pose_util::Points out(xyz.rows(), 3);
+    Eigen::Index n = 0;
+    for (Eigen::Index i = 0; i < xyz.rows(); ++i) {
+        if (range.data()[i] == 0) {
+            if (!compact) out.row(n++).setZero();
+            continue;
+        }
+        const Eigen::Vector3d p = xyz.row(i).matrix().transpose();
+        out.row(n++) = (extrinsic.topLeftCorner<3, 3>() * p +
+                        extrinsic.topRightCorner<3, 1>())
+                           .transpose();
+    }
+    out.conservativeResize(n, 3);
+    return out;
+}
+
+}  // namespace
+
+TEST(FusedCloudTest, MatchesCartesianWithExtrinsics) {
+    const auto info = sensor::default_sensor_info(sensor::MODE_512x10);
+    const LidarScan scan0 = make_scan(info, 3);
+    const LidarScan scan1 = make_scan(info, 5);
+    const std::vector<mat4d> extrinsics{make_extrinsic(0.3, 1.0, -2.0),
+                                        make_extrinsic(-1.2, -0.5, 4.0)};
+    const XYZLut lut = make_xyz_lut(info, true);
+
+    for (bool compact : {true, false}) {
+        FusedCloudBuilder builder({lut, lut}, extrinsics, {"SIGNAL"}, true,
+                                  compact);
+        const FusedCloud& cloud = builder.build({&scan0, &scan1});
+
+        const pose_util::Points p0 =
+            expected_points(scan0, lut, extrinsics[0], compact);
+        const pose_util::Points p1 =
+            expected_points(scan1, lut, extrinsics[1], compact);
+        ASSERT_EQ(cloud.size, static_cast<size_t>(p0.rows() + p1.rows()));
+        EXPECT_TRUE(cloud.points.topRows(p0.rows()).isApprox(p0, 1e-9));
+        EXPECT_TRUE(
+            cloud.points.middleRows(p0.rows(), p1.rows()).isApprox(p1, 1e-9));
+
+        EXPECT_TRUE((cloud.sensor_ids.head(p0.rows()) == 0).all());
+        EXPECT_TRUE(
+            (cloud.sensor_ids.segment(p0.rows(), p1.rows()) == 1).all());
+
+        // compact signal values are the nonzero ranges / 10
+        ASSERT_EQ(cloud.fields.size(), 1u);
+        if (compact) {
+            EXPECT_TRUE((cloud.fields[0].head(cloud.size) >= 100).all());
+        } else {
+            const auto signal =
+                scan0.field<uint16_t>(sensor::ChanField::SIGNAL);
+            EXPECT_EQ(cloud.fields[0](1), signal.data()[1]);
+            EXPECT_EQ(cloud.fields[0](0), 0);
+        }
+    }
+}
+
+TEST(FusedCloudTest, MissingScansAndRing) {
+    const auto info = sensor::default_sensor_info(sensor::MODE_512x10);
+    const LidarScan scan = make_scan(info, 4);
+    const XYZLut lut = make_xyz_lut(info, true);
+    const size_t pixels = info.format.columns_per_frame *
+                          info.format.pixels_per_column;
+
+    FusedCloudBuilder compact({lut, lut}, {}, {}, false, true, 3);
+    EXPECT_EQ(compact.sensors_count(), 2u);
+    EXPECT_EQ(compact.ring_size(), 3u);
+    const FusedCloud& first = compact.build({&scan, nullptr});
+    EXPECT_EQ(first.size, pixels - pixels / 4);
+    EXPECT_EQ(first.frame, 0u);
+    EXPECT_EQ(first.sensor_ids.size(), 0);
+
+    const FusedCloud& second = compact.build({nullptr, &scan});
+    EXPECT_NE(&first, &second);
+    EXPECT_EQ(&compact.latest(), &second);
+    EXPECT_EQ(second.frame, 1u);
+    compact.build({&scan, &scan});
+    const FusedCloud& fourth = compact.build({&scan, &scan});
+    EXPECT_EQ(&fourth, &first);
+    EXPECT_EQ(fourth.frame, 3u);
+    EXPECT_EQ(fourth.size, 2 * (pixels - pixels / 4));
+
+    FusedCloudBuilder dense({lut, lut}, {}, {"SIGNAL"}, false, false);
+    const FusedCloud& cloud = dense.build({nullptr, &scan});
+    EXPECT_EQ(cloud.size, 2 * pixels);
+    EXPECT_TRUE(cloud.points.topRows(pixels).isZero());
+    EXPECT_TRUE((cloud.fields[0].head(pixels) == 0).all());
+}
+
+TEST(FusedCloudTest, InvalidArguments) {
+    const auto info = sensor::default_sensor_info(sensor::MODE_512x10);
+    const XYZLut lut = make_xyz_lut(info, true);
+    EXPECT_THROW(FusedCloudBuilder({}), std::invalid_argument);
+    EXPECT_THROW(FusedCloudBuilder({lut}, {mat4d::Identity(),
+                                           mat4d::Identity()}),
+                 std::invalid_argument);
+    EXPECT_THROW(FusedCloudBuilder({lut}, {}, {}, false, true, 0),
+                 std::invalid_argument);
+
+    FusedCloudBuilder builder({lut}, {}, {"NOPE"});
+    const LidarScan scan = make_scan(info, 3);
+    EXPECT_THROW(builder.build({}), std::invalid_argument);
+    EXPECT_THROW(builder.build({&scan}), std::invalid_argument);
+
+    const auto other = sensor::default_sensor_info(sensor::MODE_1024x10);
+    const LidarScan wide(other);
+    FusedCloudBuilder plain({lut});
+    EXPECT_THROW(plain.build({&wide}), std::invalid_argument);
+}
@@ -0,0 +1,126 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/image_processing.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "ouster/types.h"
+
+using ouster::img_t;
+using ouster::viz::AutoExposure;
+using ouster::viz::BeamUniformityCorrector;
+
+namespace {
+
+/*
+ * The percentiles AutoExposure selects, computed with a sort of every 4th
+ * nonzero value
+ */
+template <typename T>
+std::pair<T, T> sorted_percentiles(const img_t<T>& image, double lo_p,
+                                   double hi_p) {
+    std::vector<T> values;
+    for (Eigen::Index i = 0; i < image.size(); i += 4) {
+        if (image.data()[i] > 0) values.push_back(image.data()[i]);
+    }
+    std::sort(values.begin(), values.end());
+    const size_t m = values.size();
+    return {values[static_cast<size_t>(m * lo_p)],
+            values[m - static_cast<size_t>(m * hi_p) - 1]};
+}
+
+template <typename T>
+void check_first_frame(const img_t<T>& image) {
+    const double p = 0.1;
+    const auto expected = sorted_percentiles(image, p, p);
+
+    // the first frame maps the selected lo and hi to p and 1 - p, or only hi
+    // to 1 - p if that would map 0 above 0
+    img_t<T> out = image;
+    AutoExposure ae(p, p, 1);
+    ae(out);
+    const double lo = expected.first, hi = expected.second;
+    double scale = (1.0 - 2 * p) / (hi - lo);
+    double offset = p - lo * scale;
+    if (offset > 0) {
+        scale = (1.0 - p) / hi;
+        offset = 0;
+    }
+    for (Eigen::Index i = 0; i < image.size(); i++) {
+        const double v = image.data()[i];
+        const double want = std::min(std::max(v * scale + offset, 0.0), 1.0);
+        EXPECT_NEAR(out.data()[i], want, 1e-5) << "pixel " << i;
+    }
+}
+
+}  // namespace
+
+TEST(AutoExposure, selects_exact_percentiles) {
+    std::mt19937 g(7);
+    img_t<float> image(128, 1024);
+
+    // spread over many octaves
+    std::lognormal_distribution<float> wide(5.0f, 2.0f);
+    for (Eigen::Index i = 0; i < image.size(); i++) {
+        image.data()[i] = (i % 13 == 0) ? 0.0f : wide(g);
+    }
+    check_first_frame(image);
+    check_first_frame<double>(image.cast<double>());
+
+    // concentrated in a few histogram buckets, with many ties
+    std::uniform_int_distribution<int> narrow(1000, 1010);
+    for (Eigen::Index i = 0; i < image.size(); i++) {
+        image.data()[i] = static_cast<float>(narrow(g));
+    }
+    check_first_frame(image);
+}
+
+TEST(AutoExposure, too_few_values) {
+    img_t<float> image = img_t<float>::Zero(64, 512);
+    image(0, 0) = 5.0f;
+    img_t<float> out = image;
+    AutoExposure ae;
+    ae(out);
+    EXPECT_TRUE((out == image).all());
+}
+
+TEST(BeamUniformityCorrector, removes_row_offsets) {
+    std::mt19937 g(5);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    img_t<float> image(64, 1024);
+    for (Eigen::Index u = 0; u < image.rows(); u++) {
+        // alternating offsets between rows
+        const float offset = (u % 2) ? 40.0f : 0.0f;
+        for (Eigen::Index v = 0; v < image.cols(); v++) {
+            image(u, v) = 500.0f + offset + noise(g);
+        }
+    }
+    // azimuth masked columns are ignored and stay zero
+    image.rightCols(100).setZero();
+
+    img_t<float> out = image;
+    BeamUniformityCorrector buc;
+    buc(out);
+    // only a gentle gradient is left between rows
+    const Eigen::ArrayXf row_means = out.leftCols(924).rowwise().mean();
+    const Eigen::ArrayXf steps = row_means.tail(63) - row_means.head(63);
+    EXPECT_LT(steps.abs().maxCoeff(), 2.0f);
+    EXPECT_TRUE((out.rightCols(100) == 0).all());
+    EXPECT_TRUE((out >= 0).all());
+
+    // the correction is only recomputed every update_every frames
+    BeamUniformityCorrector every_other(2);
+    img_t<float> first = image;
+    every_other(first);
+    img_t<float> second = image;
+    second.topRows(32) += 1000.0f;
+    every_other(second);
+    EXPECT_TRUE(((second.bottomRows(32) - first.bottomRows(32)) == 0).all());
+}
@@ -0,0 +1,106 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/imu_batcher.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "ouster/imu_preintegrator.h"
+#include "ouster/lidar_scan.h"
+
+using namespace ouster;
+
+namespace {
+
+constexpr uint64_t t0 = 1000000000;
+constexpr uint64_t col_dt = 100000;  // 10 kHz columns
+constexpr uint64_t imu_dt = 250000;  // 4 kHz samples
+
+// scan of 16 columns starting at t, the first and tenth columns invalid
+LidarScan make_scan(uint64_t t) {
+    LidarScan scan(16, 4);
+    for (size_t v = 0; v < scan.w; v++) {
+        scan.timestamp()[v] = t + v * col_dt;
+        scan.status()[v] = (v == 0 || v == 10) ? 0 : 1;
+    }
+    return scan;
+}
+
+ImuSample level(uint64_t ts) {
+    return ImuSample{ts, Eigen::Vector3d(0, 0, ImuPreintegrator::gravity),
+                     Eigen::Vector3d(0, 0, 0.1)};
+}
+
+}  // namespace
+
+TEST(ImuBatcherTest, AlignsSamplesWithColumns) {
+    ImuBatcher batcher;
+    // samples from before the first valid column into the next scan
+    for (uint64_t i = 0; i < 10; i++) batcher.add(level(t0 + i * imu_dt));
+    EXPECT_EQ(batcher.pending(), 10u);
+
+    ImuBatch batch;
+    // the last valid column is at t0 + 1.5 ms
+    ASSERT_EQ(batcher.batch(make_scan(t0), batch), 7u);
+    EXPECT_EQ(batcher.pending(), 3u);
+    const std::vector<int32_t> columns{-1, 3, 5, 8, 11, 13, 15};
+    EXPECT_EQ(batch.column, columns);
+    EXPECT_EQ(batch.ts.front(), t0);
+    EXPECT_EQ(batch.accel_ts, batch.ts);
+    EXPECT_EQ(batch.accel_xyz().rows(), 7);
+    EXPECT_DOUBLE_EQ(batch.accel_xyz()(6, 2), ImuPreintegrator::gravity);
+    EXPECT_DOUBLE_EQ(batch.gyro_xyz()(3, 2), 0.1);
+    EXPECT_EQ(batch.sample(2).ts, t0 + 2 * imu_dt);
+
+    // the rest go to the next scan, keeping the capacity of the batch
+    const auto capacity = batch.ts.capacity();
+    ASSERT_EQ(batcher.batch(make_scan(t0 + 16 * col_dt), batch), 3u);
+    EXPECT_EQ(batch.ts.capacity(), capacity);
+    EXPECT_EQ(batch.ts.front(), t0 + 7 * imu_dt);
+    EXPECT_EQ(batch.column.front(), 2);
+    EXPECT_EQ(batcher.pending(), 0u);
+}
+
+TEST(ImuBatcherTest, DropsSamplesOutOfOrder) {
+    ImuBatcher batcher;
+    batcher.add(level(t0 + imu_dt), t0 + imu_dt - 10);
+    batcher.add(level(t0));
+    batcher.add(level(t0 + imu_dt));
+    EXPECT_EQ(batcher.pending(), 1u);
+    EXPECT_EQ(batcher.dropped(), 2u);
+
+    ImuBatch batch;
+    LidarScan invalid(16, 4);
+    EXPECT_EQ(batcher.batch(invalid, batch), 0u);
+    EXPECT_TRUE(batch.empty());
+    ASSERT_EQ(batcher.batch(make_scan(t0), batch), 1u);
+    EXPECT_EQ(batch.accel_ts[0], t0 + imu_dt - 10);
+
+    batcher.add(level(t0));
+    batcher.reset();
+    EXPECT_EQ(batcher.pending(), 0u);
+}
+
+TEST(ImuBatcherTest, FeedsPreintegrator) {
+    ImuBatcher batcher;
+    ImuPreintegrator batched(mat4d::Identity(), 4);
+    ImuPreintegrator direct(mat4d::Identity(), 4);
+    for (uint64_t i = 0; i < 10; i++) {
+        batcher.add(level(t0 + i * imu_dt));
+        direct.add(level(t0 + i * imu_dt));
+    }
+    ImuBatch batch;
+    batcher.batch(make_scan(t0), batch);
+    batched.add(batch);
+    batcher.batch(make_scan(t0 + 16 * col_dt), batch);
+    batched.add(batch);
+
+    ASSERT_TRUE(batched.initialized());
+    Eigen::ArrayXd ts(2);
+    ts << t0 + 5 * imu_dt, t0 + 9 * imu_dt;
+    EXPECT_TRUE(batched.poses_at(ts).isApprox(direct.poses_at(ts)));
+}
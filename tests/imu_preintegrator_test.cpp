@@ -0,0 +1,101 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/imu_preintegrator.h"
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Geometry>
+#include <cmath>
+#include <stdexcept>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/types.h"
+
+using namespace ouster;
+
+namespace {
+
+constexpr uint64_t t0 = 1000000000;
+constexpr uint64_t dt = 1000000;  // 1 kHz
+
+// static samples of a level imu with a gyroscope bias
+void add_static(ImuPreintegrator& imu, size_t n, const Eigen::Vector3d& bias) {
+    for (size_t i = 0; i < n; ++i) {
+        imu.add(ImuSample{t0 + i * dt,
+                          Eigen::Vector3d(0, 0, ImuPreintegrator::gravity),
+                          bias});
+    }
+}
+
+}  // namespace
+
+TEST(ImuPreintegratorTest, YawRateWithBias) {
+    const Eigen::Vector3d bias(0.01, -0.02, 0.005);
+    ImuPreintegrator imu(mat4d::Identity(), 100);
+    EXPECT_THROW(imu.velocity(), std::runtime_error);
+    add_static(imu, 100, bias);
+    ASSERT_TRUE(imu.initialized());
+    EXPECT_TRUE(imu.gyro_bias().isApprox(bias));
+
+    // turn at 0.5 rad/s about z for 1 s
+    const double rate = 0.5;
+    for (uint64_t i = 100; i <= 1100; ++i) {
+        imu.add(ImuSample{t0 + i * dt,
+                          Eigen::Vector3d(0, 0, ImuPreintegrator::gravity),
+                          bias + Eigen::Vector3d(0, 0, rate)});
+    }
+    const uint64_t start = t0 + 99 * dt;
+    Eigen::ArrayXd ts(3);
+    // between samples, at the last sample and extrapolated past it
+    ts << start + 500500000.0, start + 1001000000.0, start + 1101000000.0;
+    const pose_util::Poses poses = imu.poses_at(ts);
+    for (Eigen::Index i = 0; i < ts.size(); ++i) {
+        // the first interval integrates the midpoint of the static sample
+        const double angle = rate * ((ts(i) - start) * 1e-9 - 0.5e-3);
+        Eigen::Map<const Eigen::Matrix<double, 4, 4, Eigen::RowMajor>> pose(
+            poses.row(i).data());
+        const Eigen::Matrix3d expected =
+            Eigen::AngleAxisd(angle, Eigen::Vector3d::UnitZ())
+                .toRotationMatrix();
+        EXPECT_TRUE((pose.topLeftCorner<3, 3>().isApprox(expected, 1e-9)));
+        EXPECT_LT((pose.topRightCorner<3, 1>().norm()), 1e-9);
+    }
+}
+
+TEST(ImuPreintegratorTest, ConstantAccelerationInSensorFrame) {
+    // imu 10 mm above the sensor origin
+    mat4d imu_to_sensor = mat4d::Identity();
+    imu_to_sensor(2, 3) = 10;
+    ImuPreintegrator imu(imu_to_sensor, 10);
+    add_static(imu, 10, Eigen::Vector3d::Zero());
+
+    // accelerate at 2 m/s^2 along x for 1 s
+    for (uint64_t i = 10; i <= 1009; ++i) {
+        imu.add(ImuSample{t0 + i * dt,
+                          Eigen::Vector3d(2, 0, ImuPreintegrator::gravity),
+                          Eigen::Vector3d::Zero()});
+    }
+    EXPECT_NEAR(imu.velocity()(0), 2.0, 1e-2);
+
+    const auto info = sensor::default_sensor_info(sensor::MODE_512x10);
+    LidarScan scan(info);
+    for (Eigen::Index c = 0; c < scan.timestamp().size(); ++c) {
+        scan.timestamp()(c) = t0 + 9 * dt + 1000000000;
+        scan.status()(c) = c == 3 ? 0 : 1;
+    }
+    imu.pose_scan(scan);
+    Eigen::Map<const pose_util::Poses> poses(scan.pose().get<double>(), scan.w,
+                                             16);
+    EXPECT_NEAR(poses(0, 3), 1.0, 1e-2);
+    EXPECT_NEAR(poses(0, 11), -0.01, 1e-9);
+    EXPECT_EQ(poses(3, 3), 0.0);
+
+    // a known velocity corrects the drift
+    imu.set_velocity(Eigen::Vector3d::Zero());
+    EXPECT_EQ(imu.velocity().norm(), 0.0);
+    imu.reset(true);
+    EXPECT_FALSE(imu.initialized());
+}
@@ -0,0 +1,174 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/impl/ipv4_reassembler.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "ouster/ip_reassembly.h"
+
+using ouster::sensor::IpReassembler;
+using ouster::sensor::IpReassemblyOptions;
+using ouster::sensor::IpReassemblyStats;
+using ouster::sensor::impl::Ipv4Header;
+using ouster::sensor::impl::parse_ipv4_header;
+using us = std::chrono::microseconds;
+
+namespace {
+
+// build an IPv4 UDP packet carrying payload[offset, offset + len)
+std::vector<uint8_t> fragment(const std::vector<uint8_t>& payload,
+                              size_t offset, size_t len, bool more,
+                              uint16_t id = 42) {
+    std::vector<uint8_t> pkt(20 + len, 0);
+    size_t total = pkt.size();
+    uint16_t flags_offset = static_cast<uint16_t>(offset / 8);
+    if (more) flags_offset |= 0x2000;
+    pkt[0] = 0x45;
+    pkt[2] = total >> 8;
+    pkt[3] = total & 0xFF;
+    pkt[4] = id >> 8;
+    pkt[5] = id & 0xFF;
+    pkt[6] = flags_offset >> 8;
+    pkt[7] = flags_offset & 0xFF;
+    pkt[8] = 64;
+    pkt[9] = 17;
+    pkt[12] = 10;
+    pkt[15] = 1;
+    pkt[16] = 10;
+    pkt[19] = 2;
+    std::copy(payload.begin() + offset, payload.begin() + offset + len,
+              pkt.begin() + 20);
+    return pkt;
+}
+
+// the payload of the datagram the packet completes, empty if it doesn't
+std::vector<uint8_t> add(IpReassembler& r, const std::vector<uint8_t>& pkt,
+                         us ts = us(0)) {
+    const uint8_t* datagram = nullptr;
+    size_t size = 0;
+    if (r.process(ts, pkt.data(), pkt.size(), datagram, size) !=
+        IpReassembler::REASSEMBLED) {
+        return {};
+    }
+    return std::vector<uint8_t>(datagram + 20, datagram + size);
+}
+
+}  // namespace
+
+TEST(Ipv4ReassemblerTest, ParseHeader) {
+    std::vector<uint8_t> payload(64, 1);
+    auto pkt = fragment(payload, 16, 24, true);
+    Ipv4Header header;
+    ASSERT_TRUE(parse_ipv4_header(pkt.data(), pkt.size(), header));
+    EXPECT_EQ(header.protocol, 17);
+    EXPECT_EQ(header.id, 42);
+    EXPECT_EQ(header.offset, 16);
+    EXPECT_TRUE(header.more);
+    EXPECT_EQ(header.header_len, 20u);
+    EXPECT_EQ(header.total_len, 44u);
+
+    // truncated packets and other IP versions are rejected
+    EXPECT_FALSE(parse_ipv4_header(pkt.data(), 30, header));
+    pkt[0] = 0x65;
+    EXPECT_FALSE(parse_ipv4_header(pkt.data(), pkt.size(), header));
+}
+
+TEST(Ipv4ReassemblerTest, ReassemblesOutOfOrder) {
+    std::vector<uint8_t> payload(3000);
+    std::iota(payload.begin(), payload.end(), 0);
+
+    IpReassembler r;
+    EXPECT_TRUE(add(r, fragment(payload, 2960, 40, false)).empty());
+    EXPECT_TRUE(add(r, fragment(payload, 0, 1480, true)).empty());
+    // duplicates replace the earlier copy
+    EXPECT_TRUE(add(r, fragment(payload, 0, 1480, true)).empty());
+    EXPECT_EQ(r.stats().in_progress, 1u);
+
+    const uint8_t* datagram = nullptr;
+    size_t size = 0;
+    auto last = fragment(payload, 1480, 1480, true);
+    ASSERT_EQ(r.process(us(0), last.data(), last.size(), datagram, size),
+              IpReassembler::REASSEMBLED);
+    EXPECT_EQ(std::vector<uint8_t>(datagram + 20, datagram + size), payload);
+    EXPECT_EQ(r.stats().in_progress, 0u);
+
+    // the header is that of a whole datagram, with a valid checksum
+    Ipv4Header header;
+    ASSERT_TRUE(parse_ipv4_header(datagram, size, header));
+    EXPECT_EQ(header.total_len, 20 + payload.size());
+    EXPECT_EQ(header.offset, 0);
+    EXPECT_FALSE(header.more);
+    uint32_t sum = 0;
+    for (size_t i = 0; i < 20; i += 2) {
+        sum += (datagram[i] << 8) | datagram[i + 1];
+    }
+    while (sum >> 16) sum = (sum & 0xFFFF) + (sum >> 16);
+    EXPECT_EQ(sum, 0xFFFFu);
+}
+
+TEST(Ipv4ReassemblerTest, IgnoresUnfragmented) {
+    std::vector<uint8_t> payload(100, 3);
+    IpReassembler r;
+    const uint8_t* datagram = nullptr;
+    size_t size = 0;
+    auto pkt = fragment(payload, 0, 100, false);
+    EXPECT_EQ(r.process(us(0), pkt.data(), pkt.size(), datagram, size),
+              IpReassembler::NOT_FRAGMENTED);
+    EXPECT_EQ(r.stats().fragments, 0u);
+    EXPECT_EQ(r.stats().in_progress, 0u);
+}
+
+TEST(Ipv4ReassemblerTest, DiscardsStaleFragments) {
+    std::vector<uint8_t> payload(2000, 5);
+    IpReassembler r;
+    EXPECT_TRUE(add(r, fragment(payload, 0, 1480, true), us(0)).empty());
+    // the first fragment has timed out by the time the rest arrives
+    const us later(3000000);
+    EXPECT_TRUE(add(r, fragment(payload, 1480, 520, false), later).empty());
+    EXPECT_EQ(r.stats().timed_out, 1u);
+    auto res = add(r, fragment(payload, 0, 1480, true), later);
+    EXPECT_EQ(res.size(), payload.size());
+}
+
+TEST(Ipv4ReassemblerTest, BoundsMemory) {
+    std::vector<uint8_t> payload(3000, 7);
+    IpReassemblyOptions options;
+    options.capacity = 2;
+    IpReassembler r(options);
+    EXPECT_EQ(r.stats().capacity, 2u);
+    EXPECT_GE(r.stats().memory, 2 * 65535u);
+
+    // beyond capacity the least recently updated datagram is evicted
+    EXPECT_TRUE(add(r, fragment(payload, 0, 1480, true, 1), us(1)).empty());
+    EXPECT_TRUE(add(r, fragment(payload, 0, 1480, true, 2), us(2)).empty());
+    EXPECT_TRUE(add(r, fragment(payload, 0, 1480, true, 3), us(3)).empty());
+    EXPECT_EQ(r.stats().evicted, 1u);
+    EXPECT_EQ(r.stats().in_progress, 2u);
+    EXPECT_TRUE(add(r, fragment(payload, 1480, 1480, true, 2), us(4)).empty());
+    EXPECT_EQ(add(r, fragment(payload, 2960, 40, false, 2), us(5)).size(),
+              payload.size());
+    EXPECT_EQ(r.stats().evicted, 1u);
+    EXPECT_EQ(r.stats().reassembled, 1u);
+
+    r.clear();
+    EXPECT_EQ(r.stats().in_progress, 0u);
+
+    // fragments reaching past the largest datagram are dropped
+    options.max_datagram_size = 2000;
+    IpReassembler small(options);
+    EXPECT_TRUE(add(small, fragment(payload, 1480, 1480, true)).empty());
+    EXPECT_EQ(small.stats().malformed, 1u);
+    EXPECT_EQ(small.stats().in_progress, 0u);
+
+    options.capacity = 0;
+    EXPECT_THROW(IpReassembler{options}, std::invalid_argument);
+}
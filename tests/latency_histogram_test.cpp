@@ -0,0 +1,89 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/latency_histogram.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace ouster::sensor;
+
+TEST(LatencyHistogramTest, buckets_are_contiguous) {
+    for (int i = 1; i < LatencyHistogram::buckets; i++) {
+        const uint64_t lo = LatencyHistogram::bucket_lowest(i);
+        EXPECT_EQ(LatencyHistogram::bucket_index(lo), i);
+        EXPECT_EQ(LatencyHistogram::bucket_index(lo - 1), i - 1);
+    }
+    EXPECT_EQ(LatencyHistogram::bucket_index(
+                  std::numeric_limits<uint64_t>::max()),
+              LatencyHistogram::buckets - 1);
+}
+
+TEST(LatencyHistogramTest, empty_summary) {
+    LatencyHistogram h;
+    auto s = h.summary();
+    EXPECT_EQ(s.count, 0u);
+    EXPECT_EQ(s.max, 0u);
+    EXPECT_EQ(h.value_at_quantile(0.5), 0u);
+}
+
+TEST(LatencyHistogramTest, quantiles_within_precision) {
+    LatencyHistogram h;
+    std::mt19937_64 gen(42);
+    std::lognormal_distribution<double> d(13, 1);
+    std::vector<uint64_t> values;
+    for (int i = 0; i < 100000; i++) {
+        values.push_back(static_cast<uint64_t>(d(gen)));
+        h.record(values.back());
+    }
+    std::sort(values.begin(), values.end());
+    auto s = h.summary();
+    EXPECT_EQ(s.count, values.size());
+    EXPECT_EQ(s.min, values.front());
+    EXPECT_EQ(s.max, values.back());
+    for (double q : {0.5, 0.9, 0.99, 0.999}) {
+        const double exact = values[static_cast<size_t>(q * values.size())];
+        EXPECT_NEAR(h.value_at_quantile(q), exact, exact * 0.035) << q;
+    }
+}
+
+TEST(LatencyHistogramTest, add_and_reset) {
+    LatencyHistogram a, b;
+    for (uint64_t i = 1; i <= 100; i++) a.record(i * 1000);
+    for (uint64_t i = 101; i <= 200; i++) b.record(i * 1000);
+    LatencyHistogram total;
+    total.add(a);
+    total.add(b);
+    auto s = total.summary();
+    EXPECT_EQ(s.count, 200u);
+    EXPECT_EQ(s.min, 1000u);
+    EXPECT_EQ(s.max, 200000u);
+    EXPECT_DOUBLE_EQ(s.mean, 100500.0);
+    EXPECT_NEAR(s.p50, 100000, 100000 * 0.035);
+
+    total.reset();
+    EXPECT_EQ(total.count(), 0u);
+    total.record(5);
+    EXPECT_EQ(total.summary().min, 5u);
+}
+
+TEST(LatencyHistogramTest, concurrent_records) {
+    LatencyHistogram h;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&h] {
+            for (uint64_t i = 0; i < 10000; i++) h.record(i);
+        });
+    }
+    for (auto& t : threads) t.join();
+    EXPECT_EQ(h.count(), 40000u);
+    EXPECT_EQ(h.summary().max, 9999u);
+}
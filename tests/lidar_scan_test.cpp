@@ -516,6 +516,222 @@ TEST(LidarScan, destagger) {
         std::invalid_argument);
 }
 
+TEST(LidarScan, destagger_to_and_in_place) {
+    const size_t w = 37;
+    const size_t h = 8;
+    // shifts wider than the image and negative ones wrap around
+    const std::vector<int> shifts{0, 3, -5, 12, 37, 40, -41, 18};
+    ouster::LidarScan scan(w, h, PROFILE_RNG19_RFL8_SIG16_NIR16);
+    auto range = scan.field<uint32_t>(ChanField::RANGE);
+    auto refl = scan.field<uint8_t>(ChanField::REFLECTIVITY);
+    std::iota(range.data(), range.data() + range.size(), 1u);
+    for (Eigen::Index i = 0; i < refl.size(); i++) refl.data()[i] = i % 251;
+    scan.add_field("rgb", ouster::fd_array<uint16_t>(h, w, 3),
+                   ouster::FieldClass::PIXEL_FIELD);
+    auto& rgb = scan.field("rgb");
+    uint16_t* rgb_data = rgb.get<uint16_t>();
+    for (size_t i = 0; i < w * h * 3; i++) rgb_data[i] = i;
+    scan.frame_id = 5;
+    const ouster::LidarScan original = scan;
+
+    // reference, shifting one pixel at a time
+    auto reference = [&](size_t u, size_t v, bool inverse) {
+        const long sw = static_cast<long>(w);
+        const long shift = (inverse ? -1 : 1) * shifts[u];
+        return static_cast<size_t>(
+            (((static_cast<long>(v) + shift) % sw) + sw) % sw);
+    };
+
+    for (bool inverse : {false, true}) {
+        ouster::img_t<uint32_t> out(h, w);
+        ouster::destagger_to<uint32_t>(out, range, shifts, inverse);
+        for (size_t u = 0; u < h; u++) {
+            for (size_t v = 0; v < w; v++) {
+                EXPECT_EQ(out(u, reference(u, v, inverse)), range(u, v));
+            }
+        }
+        EXPECT_TRUE((out == ouster::destagger<uint32_t>(range, shifts,
+                                                        inverse))
+                        .all());
+
+        ouster::img_t<uint32_t> in_place = range;
+        ouster::destagger_in_place<uint32_t>(in_place, shifts, inverse);
+        EXPECT_TRUE((in_place == out).all());
+    }
+
+    ouster::img_t<uint32_t> staggered(h, w);
+    ouster::stagger_to<uint32_t>(
+        staggered, ouster::destagger<uint32_t>(range, shifts), shifts);
+    EXPECT_TRUE((staggered == range).all());
+
+    // every pixel field of the scan, including ones with extra dimensions
+    ouster::destagger_in_place(scan, shifts);
+    const auto orig_range = original.field<uint32_t>(ChanField::RANGE);
+    const auto orig_refl = original.field<uint8_t>(ChanField::REFLECTIVITY);
+    const uint16_t* orig_rgb = original.field("rgb").get<uint16_t>();
+    for (size_t u = 0; u < h; u++) {
+        for (size_t v = 0; v < w; v++) {
+            const size_t d = reference(u, v, false);
+            EXPECT_EQ(range(u, d), orig_range(u, v));
+            EXPECT_EQ(refl(u, d), orig_refl(u, v));
+            for (size_t c = 0; c < 3; c++) {
+                EXPECT_EQ(rgb_data[(u * w + d) * 3 + c],
+                          orig_rgb[(u * w + v) * 3 + c]);
+            }
+        }
+    }
+    EXPECT_TRUE((scan.timestamp() == original.timestamp()).all());
+
+    ouster::destagger_in_place(scan, shifts, true);
+    EXPECT_EQ(scan, original);
+
+    ouster::img_t<uint32_t> wrong(h + 1, w);
+    EXPECT_THROW(ouster::destagger_to<uint32_t>(wrong, range, shifts),
+                 std::invalid_argument);
+    EXPECT_THROW(ouster::destagger_in_place(scan, {1, 2}),
+                 std::invalid_argument);
+}
+
+TEST(LidarScan, stack_field) {
+    const size_t w = 16;
+    const size_t h = 4;
+    const std::vector<int> shifts{0, 3, -2, 17};
+    std::vector<ouster::LidarScan> scans;
+    std::vector<const ouster::LidarScan*> ptrs;
+    for (int s = 0; s < 3; s++) {
+        scans.emplace_back(w, h, PROFILE_RNG19_RFL8_SIG16_NIR16);
+        scans.back().add_field("rgb", ouster::fd_array<uint16_t>(h, w, 3),
+                               ouster::FieldClass::PIXEL_FIELD);
+    }
+    for (size_t s = 0; s < scans.size(); s++) {
+        auto range = scans[s].field<uint32_t>(ChanField::RANGE);
+        std::iota(range.data(), range.data() + range.size(),
+                  static_cast<uint32_t>(s * w * h));
+        uint16_t* rgb = scans[s].field("rgb").get<uint16_t>();
+        std::iota(rgb, rgb + w * h * 3, static_cast<uint16_t>(s));
+        scans[s].timestamp().setConstant(s);
+        ptrs.push_back(&scans[s]);
+    }
+
+    std::vector<uint32_t> range(scans.size() * w * h);
+    ouster::stack_field(range.data(), ptrs, ChanField::RANGE);
+    std::vector<uint16_t> rgb(scans.size() * w * h * 3);
+    ouster::stack_field(rgb.data(), ptrs, "rgb", shifts);
+    for (size_t s = 0; s < scans.size(); s++) {
+        const auto expected = ouster::destagger<uint32_t>(
+            scans[s].field<uint32_t>(ChanField::RANGE), shifts);
+        const uint16_t* orig_rgb = scans[s].field("rgb").get<uint16_t>();
+        for (size_t u = 0; u < h; u++) {
+            const size_t shift = ouster::impl::destagger_offset(shifts, u, w,
+                                                                false);
+            for (size_t v = 0; v < w; v++) {
+                EXPECT_EQ(range[(s * h + u) * w + v],
+                          scans[s].field<uint32_t>(ChanField::RANGE)(u, v));
+                const size_t d = (v + shift) % w;
+                for (size_t c = 0; c < 3; c++) {
+                    EXPECT_EQ(rgb[((s * h + u) * w + d) * 3 + c],
+                              orig_rgb[(u * w + v) * 3 + c]);
+                }
+            }
+            EXPECT_EQ(expected(u, (shift + 1) % w),
+                      scans[s].field<uint32_t>(ChanField::RANGE)(u, 1));
+        }
+    }
+
+    scans[1].del_field("rgb");
+    EXPECT_THROW(ouster::stack_field(rgb.data(), ptrs, "rgb"),
+                 std::invalid_argument);
+    EXPECT_THROW(ouster::stack_field(range.data(), ptrs, ChanField::RANGE,
+                                     {1, 2}),
+                 std::invalid_argument);
+    EXPECT_THROW(ouster::stack_field(range.data(), {}, ChanField::RANGE),
+                 std::invalid_argument);
+}
+
+TEST(LidarScan, scan_ops) {
+    const size_t w = 16;
+    const size_t h = 4;
+    ouster::LidarScan scan(w, h, PROFILE_RNG19_RFL8_SIG16_NIR16);
+    scan.add_field("rgb", ouster::fd_array<uint16_t>(h, w, 3),
+                   ouster::FieldClass::PIXEL_FIELD);
+    scan.add_field("counts", ouster::fd_array<float>(5), {});
+    auto range = scan.field<uint32_t>(ChanField::RANGE);
+    std::iota(range.data(), range.data() + range.size(), 0u);
+    uint16_t* rgb = scan.field("rgb").get<uint16_t>();
+    std::iota(rgb, rgb + w * h * 3, static_cast<uint16_t>(0));
+    float* counts = scan.field("counts").get<float>();
+    std::iota(counts, counts + 5, 0.0f);
+    std::iota(scan.timestamp().data(), scan.timestamp().data() + w, 100u);
+    scan.frame_id = 7;
+
+    ouster::LidarScan clipped(scan);
+    ouster::clip_fields(clipped, {ChanField::RANGE, "counts", "missing"}, 10,
+                        20.5, 1);
+    const auto clipped_range = clipped.field<uint32_t>(ChanField::RANGE);
+    for (size_t i = 0; i < w * h; i++) {
+        EXPECT_EQ(clipped_range.data()[i], i < 10 || i > 20 ? 1u : i);
+    }
+    EXPECT_EQ(clipped.field("counts").get<float>()[4], 1.0f);
+    EXPECT_EQ(clipped.field("rgb"), scan.field("rgb"));
+
+    ouster::img_t<double> mask = ouster::img_t<double>::Ones(h, w);
+    mask.row(1) = 0;
+    mask(2, 3) = 0.5;
+    ouster::LidarScan masked(scan);
+    ouster::mask_fields(masked, {}, mask);
+    const auto masked_range = masked.field<uint32_t>(ChanField::RANGE);
+    const uint16_t* masked_rgb = masked.field("rgb").get<uint16_t>();
+    for (size_t u = 0; u < h; u++) {
+        for (size_t v = 0; v < w; v++) {
+            // cast to the field type first, as numpy astype does
+            const bool kept = u != 1 && !(u == 2 && v == 3);
+            EXPECT_EQ(masked_range(u, v), kept ? range(u, v) : 0u);
+            EXPECT_EQ(masked_rgb[(u * w + v) * 3 + 2],
+                      kept ? rgb[(u * w + v) * 3 + 2] : 0);
+        }
+    }
+    EXPECT_EQ(masked.field("counts"), scan.field("counts"));
+    EXPECT_THROW(ouster::mask_fields(masked, {"counts"}, mask),
+                 std::invalid_argument);
+    EXPECT_THROW(ouster::mask_fields(masked, {}, mask.topRows(2)),
+                 std::invalid_argument);
+
+    const auto reduced = ouster::reduce_by_factor(scan, 2);
+    EXPECT_EQ(reduced.h, h / 2);
+    EXPECT_EQ(reduced.w, w);
+    EXPECT_EQ(reduced.frame_id, 7);
+    EXPECT_EQ(reduced.field_types(), scan.field_types());
+    EXPECT_TRUE((reduced.timestamp() == scan.timestamp()).all());
+    EXPECT_EQ(reduced.packet_count(), scan.packet_count());
+    EXPECT_EQ(reduced.field("counts"), scan.field("counts"));
+    const auto reduced_range = reduced.field<uint32_t>(ChanField::RANGE);
+    const uint16_t* reduced_rgb = reduced.field("rgb").get<uint16_t>();
+    for (size_t u = 0; u < h / 2; u++) {
+        for (size_t v = 0; v < w; v++) {
+            EXPECT_EQ(reduced_range(u, v), range(2 * u, v));
+            EXPECT_EQ(reduced_rgb[(u * w + v) * 3 + 1],
+                      rgb[(2 * u * w + v) * 3 + 1]);
+        }
+    }
+    EXPECT_THROW(ouster::reduce_by_factor(scan, 3), std::invalid_argument);
+    EXPECT_THROW(ouster::reduce_by_factor(scan, 0), std::invalid_argument);
+
+    // the metadata is reduced to the beams of the reduced scans
+    const auto info = default_sensor_info(MODE_512x10);
+    const auto reduced_info = ouster::reduce_by_factor(info, 4);
+    EXPECT_EQ(reduced_info.prod_line, "OS-1-16");
+    EXPECT_EQ(reduced_info.format.pixels_per_column, 16u);
+    ASSERT_EQ(reduced_info.beam_altitude_angles.size(), 16u);
+    ASSERT_EQ(reduced_info.format.pixel_shift_by_row.size(), 16u);
+    EXPECT_EQ(reduced_info.beam_altitude_angles[1],
+              info.beam_altitude_angles[4]);
+    EXPECT_EQ(reduced_info.beam_azimuth_angles[3],
+              info.beam_azimuth_angles[12]);
+    EXPECT_EQ(reduced_info.format.pixel_shift_by_row[2],
+              info.format.pixel_shift_by_row[8]);
+    EXPECT_THROW(ouster::reduce_by_factor(info, 5), std::invalid_argument);
+}
+
 TEST(LidarScan, lidar_scan_to_string_test) {
     ouster::LidarScan ls(128, 1024, PROFILE_RNG19_RFL8_SIG16_NIR16);
     ls.add_field("custom_field", ouster::fd_array<double>(33, 44, 55), {});
@@ -570,3 +786,442 @@ TEST(LidarScan, sensor_info_being_copied) {
 
     EXPECT_EQ(copy_scan.sensor_info, orig_scan.sensor_info);
 }
+
+TEST(LidarScan, contiguous_scan) {
+    auto fields = ouster::get_field_types(PROFILE_RNG19_RFL8_SIG16_NIR16);
+    fields.emplace_back("col", ChanFieldType::UINT32, std::vector<size_t>{},
+                        ouster::FieldClass::COLUMN_FIELD);
+    auto ls = ouster::LidarScan::make_contiguous(100, 64, fields, 16);
+    auto reference =
+        ouster::LidarScan(100, 64, fields.begin(), fields.end(), 16);
+
+    ASSERT_TRUE(ls.is_contiguous());
+    EXPECT_FALSE(reference.is_contiguous());
+    EXPECT_EQ(reference.arena_data(), nullptr);
+    EXPECT_EQ(reference.arena_size(), 0u);
+    EXPECT_EQ(ls.packet_timestamp().size(), 7);
+    EXPECT_EQ(ls.field_types(), reference.field_types());
+    EXPECT_EQ(ls, reference);
+
+    // every field is aligned and inside the arena
+    const uint8_t* begin = ls.arena_data();
+    const uint8_t* end = begin + ls.arena_size();
+    for (const auto& kv : ls.fields()) {
+        auto ptr = static_cast<const uint8_t*>(kv.second.get());
+        EXPECT_GE(ptr, begin);
+        EXPECT_LE(ptr + kv.second.bytes(), end);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % 64, 0u) << kv.first;
+    }
+
+    // copies are contiguous in their own arena
+    ls.field<uint32_t>(ChanField::RANGE)(3, 4) = 7;
+    ls.timestamp()[5] = 11;
+    ls.pose().get<double>()[1] = 2.0;
+    auto copy = ls;
+    ASSERT_TRUE(copy.is_contiguous());
+    EXPECT_NE(copy.arena_data(), ls.arena_data());
+    EXPECT_EQ(copy.arena_size(), ls.arena_size());
+    EXPECT_EQ(copy, ls);
+    copy.field<uint32_t>(ChanField::RANGE)(3, 4) = 8;
+    EXPECT_EQ(ls.field<uint32_t>(ChanField::RANGE)(3, 4), 7u);
+    copy = ls;
+    EXPECT_TRUE(copy.is_contiguous());
+    EXPECT_EQ(copy, ls);
+
+    // fields deleted from the scan outlive it
+    ouster::Field range;
+    {
+        auto tmp = ls;
+        range = tmp.del_field(ChanField::RANGE);
+        EXPECT_TRUE(tmp.is_contiguous());
+    }
+    EXPECT_EQ(range.get<uint32_t>()[3 * 100 + 4], 7u);
+
+    // added fields are allocated separately
+    ls.add_field(ouster::FieldType{"extra", ChanFieldType::UINT8});
+    EXPECT_FALSE(ls.is_contiguous());
+    auto separate = ls;
+    EXPECT_FALSE(separate.is_contiguous());
+    EXPECT_EQ(separate, ls);
+}
+
+TEST(LidarScan, contiguous_scan_allocator) {
+    auto fields = ouster::get_field_types(PROFILE_LIDAR_LEGACY);
+    size_t requested = 0;
+    auto ls = ouster::LidarScan::make_contiguous(
+        64, 16, fields, 16, [&](size_t bytes) {
+            requested = bytes;
+            return std::shared_ptr<uint8_t>(new uint8_t[bytes],
+                                            std::default_delete<uint8_t[]>());
+        });
+    EXPECT_EQ(ls.arena_size(), requested);
+    EXPECT_TRUE(ls.is_contiguous());
+
+    EXPECT_THROW(ouster::LidarScan::make_contiguous(
+                     64, 16, fields, 16,
+                     [](size_t) { return std::shared_ptr<uint8_t>(); }),
+                 std::invalid_argument);
+    EXPECT_THROW(ouster::LidarScan::make_contiguous(0, 16, fields, 16),
+                 std::invalid_argument);
+    EXPECT_THROW(ouster::LidarScan::make_contiguous(64, 16, fields, 0),
+                 std::invalid_argument);
+    fields.push_back(fields.front());
+    EXPECT_THROW(ouster::LidarScan::make_contiguous(64, 16, fields, 16),
+                 std::invalid_argument);
+}
+
+TEST(LidarScan, field_handles) {
+    using ouster::FieldHandle;
+    using ouster::LidarScan;
+    const FieldHandle range = LidarScan::field_handle(ChanField::RANGE);
+    const FieldHandle extra = LidarScan::field_handle("field_handles_extra");
+    EXPECT_EQ(LidarScan::field_handle(ChanField::RANGE).id, range.id);
+    EXPECT_NE(extra.id, range.id);
+    EXPECT_EQ(LidarScan::field_name(range), ChanField::RANGE);
+    EXPECT_EQ(LidarScan::field_name(extra), "field_handles_extra");
+    EXPECT_THROW(LidarScan::field_name(FieldHandle{extra.id + 1000}),
+                 std::out_of_range);
+
+    LidarScan ls(32, 16, PROFILE_RNG19_RFL8_SIG16_NIR16);
+    ASSERT_TRUE(ls.has_field(range));
+    EXPECT_EQ(&ls.field(range), &ls.field(ChanField::RANGE));
+    ls.field<uint32_t>(range)(2, 3) = 5;
+    EXPECT_EQ(ls.field<uint32_t>(ChanField::RANGE)(2, 3), 5u);
+
+    // the index follows fields being added and removed
+    EXPECT_FALSE(ls.has_field(extra));
+    EXPECT_THROW(ls.field(extra), std::out_of_range);
+    ls.add_field("field_handles_extra", ouster::fd_array<uint8_t>(16, 32));
+    ASSERT_TRUE(ls.has_field(extra));
+    EXPECT_EQ(&ls.field(extra), &ls.field("field_handles_extra"));
+    ls.del_field("field_handles_extra");
+    EXPECT_FALSE(ls.has_field(extra));
+
+    // and changes made through the field map
+    ls.fields().erase(ChanField::RANGE);
+    EXPECT_FALSE(ls.has_field(range));
+    EXPECT_THROW(ls.field(range), std::out_of_range);
+
+    // copies look up their own fields
+    const FieldHandle signal = LidarScan::field_handle(ChanField::SIGNAL);
+    LidarScan copy = ls;
+    EXPECT_EQ(&copy.field(signal), &copy.field(ChanField::SIGNAL));
+    EXPECT_NE(&copy.field(signal), &ls.field(signal));
+}
+
+TEST(LidarScan, shallow_copy) {
+    using ouster::LidarScan;
+    LidarScan ls(32, 16, PROFILE_RNG19_RFL8_SIG16_NIR16);
+    ls.field<uint32_t>(ChanField::RANGE)(2, 3) = 5;
+    ls.timestamp()[4] = 9;
+    ls.frame_id = 3;
+
+    // the copy reads the same memory until written to
+    const LidarScan copy = ls.shallow_copy();
+    const LidarScan& cls = ls;
+    EXPECT_EQ(copy, ls);
+    EXPECT_EQ(copy.frame_id, 3);
+    EXPECT_EQ(copy.field(ChanField::RANGE).get(),
+              cls.field(ChanField::RANGE).get());
+    EXPECT_EQ(copy.timestamp().data(), cls.timestamp().data());
+
+    // writing gives the writer its own copy of that field only
+    LidarScan other = copy.shallow_copy();
+    const LidarScan& cother = other;
+    other.field<uint32_t>(ChanField::RANGE)(2, 3) = 6;
+    EXPECT_NE(cother.field(ChanField::RANGE).get(),
+              copy.field(ChanField::RANGE).get());
+    EXPECT_EQ(cother.field(ChanField::SIGNAL).get(),
+              cls.field(ChanField::SIGNAL).get());
+    EXPECT_EQ(copy.field<uint32_t>(ChanField::RANGE)(2, 3), 5u);
+    EXPECT_EQ(cls.field<uint32_t>(ChanField::RANGE)(2, 3), 5u);
+    other.timestamp()[4] = 10;
+    EXPECT_EQ(copy.timestamp()[4], 9u);
+
+    // so does the original, the copies keep the values they were made with
+    ls.fields().at(ChanField::SIGNAL).get<uint16_t>()[0] = 1;
+    EXPECT_NE(cls.field(ChanField::SIGNAL).get(),
+              copy.field(ChanField::SIGNAL).get());
+    EXPECT_EQ(copy.field<uint16_t>(ChanField::SIGNAL)(0, 0), 0u);
+
+    // a deep copy of a shallow copy owns its fields
+    LidarScan deep = copy;
+    EXPECT_EQ(deep, copy);
+    EXPECT_NE(deep.field(ChanField::NEAR_IR).get(),
+              copy.field(ChanField::NEAR_IR).get());
+
+    // the last copy standing writes without copying
+    LidarScan last = LidarScan(32, 16, PROFILE_RNG19_RFL8_SIG16_NIR16);
+    const void* range = last.field(ChanField::RANGE).get();
+    {
+        const LidarScan tmp = last.shallow_copy();
+    }
+    EXPECT_EQ(last.field(ChanField::RANGE).get(), range);
+}
+
+TEST(LidarScan, shallow_copy_contiguous_and_selected) {
+    using ouster::LidarScan;
+    auto fields = ouster::get_field_types(PROFILE_RNG19_RFL8_SIG16_NIR16);
+    auto ls = LidarScan::make_contiguous(32, 16, fields, 16);
+    ls.field<uint32_t>(ChanField::RANGE)(1, 1) = 7;
+    ls.field<uint8_t>(ChanField::REFLECTIVITY)(1, 1) = 3;
+
+    auto copy = ls.shallow_copy();
+    EXPECT_TRUE(copy.is_contiguous());
+    EXPECT_EQ(copy.arena_data(), ls.arena_data());
+    copy.field<uint32_t>(ChanField::RANGE)(1, 1) = 8;
+    EXPECT_FALSE(copy.is_contiguous());
+    EXPECT_EQ(ls.field<uint32_t>(ChanField::RANGE)(1, 1), 7u);
+
+    // kept fields are shared, cast fields are copied
+    const ouster::LidarScanFieldTypes selected{
+        {ChanField::RANGE, ChanFieldType::UINT32},
+        {ChanField::REFLECTIVITY, ChanFieldType::UINT16}};
+    const auto sub = ls.shallow_copy(selected);
+    const LidarScan& cls = ls;
+    EXPECT_EQ(sub.field_types(), selected);
+    EXPECT_EQ(sub.field(ChanField::RANGE).get(),
+              cls.field(ChanField::RANGE).get());
+    EXPECT_EQ(sub.field<uint16_t>(ChanField::REFLECTIVITY)(1, 1), 3u);
+    EXPECT_EQ(sub.timestamp().data(), cls.timestamp().data());
+    EXPECT_EQ(LidarScan(ls, selected), sub);
+    const ouster::LidarScanFieldTypes wider{{ChanField::RANGE,
+                                             ChanFieldType::UINT32,
+                                             std::vector<size_t>{2}}};
+    EXPECT_THROW(ls.shallow_copy(wider), std::invalid_argument);
+}
+
+TEST(LidarScan, CartesianCompactKeepsFilteredPixels) {
+    using namespace ouster;
+    auto info = default_sensor_info(MODE_512x10);
+    LidarScan scan(info);
+    auto range = scan.field<uint32_t>(ChanField::RANGE);
+    auto refl = scan.field<uint8_t>(ChanField::REFLECTIVITY);
+    for (Eigen::Index i = 0; i < range.size(); i++) {
+        range.data()[i] = (i % 3 == 0) ? 0 : 100 + i % 50000;
+        refl.data()[i] = static_cast<uint8_t>(i % 256);
+    }
+
+    const auto lut = make_xyz_lut(info, true);
+    const LidarScan::Points full = cartesian(scan, lut);
+    const Eigen::Index N = range.size();
+    LidarScan::Points points(N, 3);
+    Eigen::Array<uint32_t, Eigen::Dynamic, 1> index(N);
+
+    auto check = [&](size_t n, const CompactFilter& f) {
+        size_t expected = 0;
+        for (Eigen::Index i = 0; i < N; i++) {
+            const uint32_t r = range.data()[i];
+            if (r == 0 || r < f.min_range || r > f.max_range ||
+                refl.data()[i] < f.min_reflectivity)
+                continue;
+            ASSERT_LT(expected, n);
+            EXPECT_EQ(index(expected), static_cast<uint32_t>(i));
+            EXPECT_TRUE((points.row(expected) == full.row(i)).all());
+            expected++;
+        }
+        EXPECT_EQ(n, expected);
+    };
+
+    CompactFilter filter;
+    check(cartesian_compact(points, index, scan, lut, filter), filter);
+    EXPECT_EQ(cartesian_compact(points, index, range, lut), 2 * N / 3);
+
+    filter.min_range = 1000;
+    filter.max_range = 30000;
+    filter.min_reflectivity = 100;
+    check(cartesian_compact(points, index, scan, lut, filter), filter);
+
+    // reflectivity needs the scan
+    EXPECT_THROW(cartesian_compact(points, index, range, lut, filter),
+                 std::invalid_argument);
+    LidarScan no_refl(scan, {{ChanField::RANGE, ChanFieldType::UINT32}});
+    EXPECT_THROW(cartesian_compact(points, index, no_refl, lut, filter),
+                 std::invalid_argument);
+
+    // single precision keeps the same pixels
+    const auto lut_f = make_xyz_lut_f(info, true);
+    PointsF points_f(N, 3);
+    Eigen::Array<uint32_t, Eigen::Dynamic, 1> index_f(N);
+    const size_t n = cartesian_compact(points, index, scan, lut, filter);
+    ASSERT_EQ(cartesian_compact(points_f, index_f, scan, lut_f, filter), n);
+    EXPECT_TRUE((index_f.head(n) == index.head(n)).all());
+    EXPECT_LT((points_f.topRows(n).cast<double>() - points.topRows(n))
+                  .abs()
+                  .maxCoeff(),
+              1e-3);
+
+    LidarScan::Points too_small(10, 3);
+    EXPECT_THROW(cartesian_compact(too_small, index, range, lut),
+                 std::invalid_argument);
+    EXPECT_THROW(cartesian_compact(points, index, range.topRows(8), lut),
+                 std::invalid_argument);
+}
+
+TEST(LidarScan, CartesianIntoPreallocatedPoints) {
+    using namespace ouster;
+    auto info = default_sensor_info(MODE_512x10);
+    LidarScan scan(info);
+    auto range = scan.field<uint32_t>(ChanField::RANGE);
+    for (Eigen::Index i = 0; i < range.size(); i++) {
+        range.data()[i] = (i % 5 == 0) ? 0 : 100 + i % 50000;
+    }
+    const Eigen::Index N = range.size();
+
+    const auto lut = make_xyz_lut(info, true);
+    const LidarScan::Points expected = cartesian(scan, lut);
+    LidarScan::Points points(N, 3);
+    cartesian(points, scan, lut);
+    EXPECT_TRUE((points == expected).all());
+    points.setZero();
+    cartesian(points, range, lut);
+    EXPECT_TRUE((points == expected).all());
+
+    // interleaved xyz triplets through a strided map
+    std::vector<double> xyz(3 * N);
+    Eigen::Map<LidarScan::Points, 0,
+               Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>>
+        interleaved(xyz.data(), N, 3,
+                    Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic>(1, 3));
+    cartesian(interleaved, scan, lut);
+    for (Eigen::Index i = 0; i < N; i++) {
+        for (int c = 0; c < 3; c++) {
+            EXPECT_EQ(xyz[3 * i + c], expected(i, c));
+        }
+    }
+
+    const auto lut_f = make_xyz_lut_f(info, true);
+    const PointsF expected_f = cartesian(scan, lut_f);
+    PointsF points_f(N, 3);
+    cartesian(points_f, scan, lut_f);
+    EXPECT_TRUE((points_f == expected_f).all());
+
+    LidarScan::Points too_small(N - 1, 3);
+    PointsF too_small_f(N - 1, 3);
+    EXPECT_THROW(cartesian(too_small, scan, lut), std::invalid_argument);
+    EXPECT_THROW(cartesian(too_small_f, range, lut_f), std::invalid_argument);
+}
+
+TEST(TransformTest, CartesianDewarpMatchesSeparatePasses) {
+    using namespace ouster;
+    auto info = default_sensor_info(MODE_512x10);
+    LidarScan scan(info);
+    const Eigen::Index W = scan.w;
+    auto range = scan.field<uint32_t>(ChanField::RANGE);
+    for (Eigen::Index i = 0; i < range.size(); i++) {
+        range.data()[i] = (i % 7 == 0) ? 0 : 1000 + i % 5000;
+    }
+    // a different pose for every column
+    for (Eigen::Index w = 0; w < W; w++) {
+        Eigen::Ref<img_t<double>> pose = scan.pose().subview(w);
+        const double a = 0.001 * w;
+        pose << std::cos(a), -std::sin(a), 0, 0.01 * w, std::sin(a),
+            std::cos(a), 0, -0.02 * w, 0, 0, 1, 0.5, 0, 0, 0, 1;
+    }
+    mat4d extrinsic = mat4d::Identity();
+    extrinsic.topLeftCorner<3, 3>() =
+        Eigen::AngleAxisd(0.3, Eigen::Vector3d::UnitZ()).toRotationMatrix();
+    extrinsic.topRightCorner<3, 1>() << 1.0, -2.0, 0.25;
+
+    const auto lut = make_xyz_lut(info, false);
+    const pose_util::Points cloud = cartesian(scan, lut);
+    Eigen::Map<const pose_util::Poses> poses(scan.pose().get<double>(), W,
+                                             16);
+    pose_util::Pose ext_row;
+    Eigen::Map<Eigen::Matrix<double, 4, 4, Eigen::RowMajor>>(ext_row.data()) =
+        extrinsic;
+    const pose_util::Points expected =
+        pose_util::transform(pose_util::dewarp(cloud, poses), ext_row);
+
+    const pose_util::Points fused =
+        pose_util::cartesian_dewarp(scan, lut, extrinsic);
+    ASSERT_EQ(fused.rows(), expected.rows());
+    EXPECT_TRUE(fused.isApprox(expected, 1e-12));
+
+    // compacting keeps the points of nonzero ranges in pixel order
+    const pose_util::Points compact =
+        pose_util::cartesian_dewarp(scan, lut, extrinsic, true);
+    Eigen::Index n = 0;
+    for (Eigen::Index i = 0; i < range.size(); i++) {
+        if (range.data()[i] == 0) continue;
+        ASSERT_LT(n, compact.rows());
+        EXPECT_TRUE(compact.row(n++).isApprox(expected.row(i), 1e-12));
+    }
+    EXPECT_EQ(n, compact.rows());
+
+    pose_util::Points too_small(10, 3);
+    EXPECT_THROW(pose_util::cartesian_dewarp(too_small, range, lut, poses,
+                                             extrinsic),
+                 std::invalid_argument);
+    EXPECT_THROW(pose_util::cartesian_dewarp(too_small, range, lut,
+                                             poses.topRows(3), extrinsic),
+                 std::invalid_argument);
+}
+
+TEST(TransformTest, TrajectoryEvaluatorFollowsScrewMotion) {
+    using namespace ouster;
+    using Mat4 = Eigen::Matrix<double, 4, 4, Eigen::RowMajor>;
+    Mat4 base = Mat4::Identity();
+    base.topLeftCorner<3, 3>() =
+        Eigen::AngleAxisd(0.7, Eigen::Vector3d(1, 2, 3).normalized())
+            .toRotationMatrix();
+    base.topRightCorner<3, 1>() << 4.0, -1.0, 2.5;
+    // a constant twist about and along z, so every pose on the trajectory is
+    // known in closed form
+    auto screw = [&](double t) {
+        Mat4 m = Mat4::Identity();
+        m.topLeftCorner<3, 3>() =
+            Eigen::AngleAxisd(0.4 * t, Eigen::Vector3d::UnitZ())
+                .toRotationMatrix();
+        m(2, 3) = 1.5 * t;
+        return Mat4(base * m);
+    };
+
+    const std::vector<double> knots{0.0, 1.0, 2.5, 3.0, 5.0};
+    pose_util::Poses knot_poses(knots.size(), 16);
+    for (size_t i = 0; i < knots.size(); i++) {
+        Eigen::Map<Mat4>(knot_poses.row(i).data()) = screw(knots[i]);
+    }
+    const pose_util::TrajectoryEvaluator traj(knots, knot_poses);
+
+    // sorted, jumping over knots, unsorted and out of the knots
+    Eigen::ArrayXd ts(9);
+    ts << -1.0, 0.0, 0.5, 1.0, 2.9, 4.99, 5.0, 6.5, 1.2;
+    const pose_util::Poses poses = traj.poses_at(ts);
+    ASSERT_EQ(poses.rows(), ts.size());
+    for (Eigen::Index i = 0; i < ts.size(); i++) {
+        Eigen::Map<const Mat4> pose(poses.row(i).data());
+        EXPECT_TRUE(pose.isApprox(screw(ts(i)), 1e-9)) << "at " << ts(i);
+    }
+
+    // only the valid columns of a scan get poses
+    LidarScan scan(8, 4);
+    for (Eigen::Index c = 0; c < 8; c++) {
+        scan.timestamp()(c) = c;
+        scan.status()(c) = c == 3 ? 0 : 1;
+    }
+    traj.pose_scan(scan);
+    Eigen::Map<const pose_util::Poses> scan_poses(scan.pose().get<double>(),
+                                                  8, 16);
+    for (Eigen::Index c = 0; c < 8; c++) {
+        Eigen::Map<const Mat4> pose(scan_poses.row(c).data());
+        if (c == 3) {
+            EXPECT_TRUE(pose.isIdentity());
+        } else {
+            EXPECT_TRUE(pose.isApprox(screw(c), 1e-9)) << "at column " << c;
+        }
+    }
+    Eigen::ArrayXd col_ts = Eigen::ArrayXd::LinSpaced(8, 0.0, 0.7);
+    traj.pose_scan(scan, col_ts);
+    Eigen::Map<const Mat4> last(scan_poses.row(7).data());
+    EXPECT_TRUE(last.isApprox(screw(0.7), 1e-9));
+    EXPECT_THROW(traj.pose_scan(scan, col_ts.head(3)), std::invalid_argument);
+
+    EXPECT_THROW(pose_util::TrajectoryEvaluator({0.0}, knot_poses.topRows(1)),
+                 std::invalid_argument);
+    EXPECT_THROW(pose_util::TrajectoryEvaluator({0.0, 0.0},
+                                                knot_poses.topRows(2)),
+                 std::invalid_argument);
+    EXPECT_THROW(pose_util::TrajectoryEvaluator(knots, knot_poses.topRows(2)),
+                 std::invalid_argument);
+}
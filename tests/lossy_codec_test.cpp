@@ -0,0 +1,119 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/lossy_codec.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "ouster/types.h"
+
+using namespace ouster;
+
+namespace {
+
+// a range image of smooth rows, like walls seen by each beam, with noise
+// and missing returns
+img_t<uint32_t> make_range(Eigen::Index rows, Eigen::Index cols) {
+    std::mt19937 gen(0xdeadbeef);
+    std::normal_distribution<double> noise(0, 3);
+    std::uniform_real_distribution<double> dropout(0, 1);
+    img_t<uint32_t> range(rows, cols);
+    for (Eigen::Index r = 0; r < rows; r++) {
+        for (Eigen::Index c = 0; c < cols; c++) {
+            const double d = 5000 + 2000 * std::sin(c * 0.01) + 30 * r;
+            range(r, c) = dropout(gen) < 0.05
+                              ? 0
+                              : static_cast<uint32_t>(d + noise(gen));
+        }
+    }
+    return range;
+}
+
+template <typename T>
+void expect_within(const img_t<T>& a, const img_t<T>& b, uint64_t max_error) {
+    ASSERT_EQ(a.rows(), b.rows());
+    ASSERT_EQ(a.cols(), b.cols());
+    for (Eigen::Index i = 0; i < a.size(); i++) {
+        const uint64_t x = a.data()[i];
+        const uint64_t y = b.data()[i];
+        // zero pixels stay zero, nonzero ones nonzero
+        ASSERT_EQ(x == 0, y == 0) << "pixel " << i;
+        ASSERT_LE(x > y ? x - y : y - x, max_error) << "pixel " << i;
+    }
+}
+
+}  // namespace
+
+TEST(LossyCodecTest, BoundsErrorOfRanges) {
+    const img_t<uint32_t> range = make_range(64, 1024);
+    const auto lossless = encode_lossy<uint32_t>(range, 0);
+    size_t last = lossless.size();
+    for (uint32_t max_error : {0u, 1u, 5u, 20u}) {
+        const auto buf = encode_lossy<uint32_t>(range, max_error);
+        ASSERT_TRUE(is_lossy_buffer(buf.data(), buf.size()));
+        img_t<uint32_t> out(64, 1024);
+        decode_lossy<uint32_t>(buf.data(), buf.size(), out);
+        expect_within<uint32_t>(range, out, max_error);
+        // larger errors buy smaller buffers
+        EXPECT_LE(buf.size(), last);
+        last = buf.size();
+    }
+    EXPECT_LT(last, lossless.size() / 2);
+    EXPECT_LT(lossless.size(), range.size() * sizeof(uint32_t) / 2);
+}
+
+TEST(LossyCodecTest, KeepsExtremesOfPixelTypes) {
+    img_t<uint8_t> small(3, 5);
+    small << 0, 1, 2, 255, 254, 3, 0, 0, 0, 7, 128, 129, 1, 0, 255;
+    for (uint32_t max_error : {0u, 2u, 300u}) {
+        const auto buf = encode_lossy<uint8_t>(small, max_error);
+        img_t<uint8_t> out(3, 5);
+        decode_lossy<uint8_t>(buf.data(), buf.size(), out);
+        expect_within<uint8_t>(small, out, max_error);
+    }
+
+    img_t<uint64_t> wide(2, 3);
+    const uint64_t max = std::numeric_limits<uint64_t>::max();
+    wide << max, 1, max - 1, 0, max / 2, 12345678901234ull;
+    for (uint32_t max_error : {0u, 7u}) {
+        const auto buf = encode_lossy<uint64_t>(wide, max_error);
+        img_t<uint64_t> out(2, 3);
+        decode_lossy<uint64_t>(buf.data(), buf.size(), out);
+        expect_within<uint64_t>(wide, out, max_error);
+    }
+
+    const img_t<uint16_t> empty = img_t<uint16_t>::Zero(4, 4);
+    const auto buf = encode_lossy<uint16_t>(empty, 3);
+    img_t<uint16_t> out = img_t<uint16_t>::Constant(4, 4, 9);
+    decode_lossy<uint16_t>(buf.data(), buf.size(), out);
+    EXPECT_TRUE((out == 0).all());
+}
+
+TEST(LossyCodecTest, RejectsMismatchedAndCorruptBuffers) {
+    const img_t<uint32_t> range = make_range(8, 64);
+    auto buf = encode_lossy<uint32_t>(range, 5);
+
+    img_t<uint32_t> wrong_shape(8, 32);
+    EXPECT_THROW(decode_lossy<uint32_t>(buf.data(), buf.size(), wrong_shape),
+                 std::invalid_argument);
+    img_t<uint16_t> wrong_type(8, 64);
+    EXPECT_THROW(decode_lossy<uint16_t>(buf.data(), buf.size(), wrong_type),
+                 std::invalid_argument);
+
+    img_t<uint32_t> out(8, 64);
+    EXPECT_THROW(decode_lossy<uint32_t>(buf.data(), buf.size() / 2, out),
+                 std::invalid_argument);
+    buf[0] = 'X';
+    EXPECT_FALSE(is_lossy_buffer(buf.data(), buf.size()));
+    EXPECT_THROW(decode_lossy<uint32_t>(buf.data(), buf.size(), out),
+                 std::invalid_argument);
+}
@@ -0,0 +1,125 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/map_localizer.h"
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Geometry>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include "ouster/types.h"
+
+using namespace ouster;
+
+namespace {
+
+// points on the floor and walls of a 20 x 12 x 4 m room, and on a pillar
+pose_util::Points room(size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> u(0, 1);
+    pose_util::Points points(n, 3);
+    for (size_t i = 0; i < n; ++i) {
+        const double a = u(rng), b = u(rng);
+        switch (i % 6) {
+            case 0: points.row(i) << 20 * a - 10, 12 * b - 6, 0; break;
+            case 1: points.row(i) << -10, 12 * a - 6, 4 * b; break;
+            case 2: points.row(i) << 10, 12 * a - 6, 4 * b; break;
+            case 3: points.row(i) << 20 * a - 10, -6, 4 * b; break;
+            case 4: points.row(i) << 20 * a - 10, 6, 4 * b; break;
+            default:
+                points.row(i) << 3 + std::cos(6.3 * a), 2 + std::sin(6.3 * a),
+                    4 * b;
+        }
+    }
+    return points;
+}
+
+mat4d make_pose(double yaw, double x, double y) {
+    mat4d pose = mat4d::Identity();
+    pose.topLeftCorner<3, 3>() =
+        Eigen::AngleAxisd(yaw, Eigen::Vector3d::UnitZ()).toRotationMatrix();
+    pose(0, 3) = x;
+    pose(1, 3) = y;
+    pose(2, 3) = 1.5;
+    return pose;
+}
+
+// the points of the map seen from a pose, in the sensor frame
+pose_util::Points scan_from(const pose_util::Points& map, const mat4d& pose) {
+    const Eigen::Matrix3d r = pose.topLeftCorner<3, 3>();
+    const Eigen::Vector3d t = pose.topRightCorner<3, 1>();
+    return (map.rowwise() - t.transpose()) * r;
+}
+
+}  // namespace
+
+TEST(MapLocalizerTest, NearestMatchesBruteForce) {
+    const std::string filename = ::testing::TempDir() + "voxel_map.idx";
+    const pose_util::Points map = room(3000, 1);
+    VoxelMapIndex::build(filename, map, 0.5);
+    VoxelMapIndex index(filename);
+    EXPECT_EQ(index.size(), 3000u);
+    EXPECT_EQ(index.voxel_size(), 0.5);
+
+    const pose_util::Points queries = room(500, 2);
+    pose_util::Points neighbors(queries.rows(), 3);
+    Eigen::ArrayXd distances(queries.rows());
+    index.nearest(queries, 0.7, neighbors, distances);
+    for (Eigen::Index i = 0; i < queries.rows(); ++i) {
+        const double best =
+            (map.rowwise() - queries.row(i)).rowwise().norm().minCoeff();
+        if (best > 0.7) {
+            EXPECT_TRUE(std::isinf(distances(i)));
+        } else {
+            // the map is stored in single precision
+            EXPECT_NEAR(distances(i), best, 1e-5);
+        }
+    }
+    pose_util::Points short_rows(1, 3);
+    EXPECT_THROW(index.nearest(queries, 0.7, short_rows, distances),
+                 std::invalid_argument);
+    std::remove(filename.c_str());
+
+    EXPECT_THROW(VoxelMapIndex::build(filename, map, 0), std::invalid_argument);
+    EXPECT_THROW(VoxelMapIndex(filename + ".missing"), std::runtime_error);
+}
+
+TEST(MapLocalizerTest, TracksPosesFromMotionPrior) {
+    const std::string filename = ::testing::TempDir() + "voxel_room.idx";
+    VoxelMapIndex::build(filename, room(60000, 3), 1.0);
+    auto index = std::make_shared<const VoxelMapIndex>(filename);
+
+    MapLocalizerConfig config;
+    config.voxel_size = 0.25;
+    // a guess 30 cm and 3 degrees off
+    MapLocalizer localizer(index, make_pose(0.05, 0.3, -0.2), config);
+    const Eigen::ArrayXd no_times;
+    for (int k = 0; k < 5; ++k) {
+        const mat4d truth = make_pose(0.02 * k, 0.5 * k, 0.1 * k);
+        const mat4d pose =
+            localizer.update(scan_from(room(20000, 10 + k), truth), no_times);
+        EXPECT_LT((pose.topRightCorner<3, 1>() - truth.topRightCorner<3, 1>())
+                      .norm(),
+                  0.02);
+        EXPECT_LT((pose.topLeftCorner<3, 3>() - truth.topLeftCorner<3, 3>())
+                      .norm(),
+                  0.01);
+        EXPECT_GT(localizer.last_correspondences(), 1000u);
+    }
+    const mat4d motion =
+        make_pose(0.06, 1.5, 0.3).inverse() * make_pose(0.08, 2.0, 0.4);
+    EXPECT_LT((localizer.last_motion() - motion).norm(), 0.03);
+
+    const Eigen::ArrayXd times(3);
+    EXPECT_THROW(localizer.update(room(10, 4), times), std::invalid_argument);
+    std::remove(filename.c_str());
+}
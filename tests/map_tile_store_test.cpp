@@ -0,0 +1,128 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/map_tile_store.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+#include "ouster/types.h"
+
+using namespace ouster;
+
+namespace {
+
+using Voxel = std::tuple<long, long, long>;
+
+std::set<Voxel> voxels_of(const pose_util::Points& points, double size) {
+    std::set<Voxel> voxels;
+    for (Eigen::Index i = 0; i < points.rows(); ++i) {
+        voxels.emplace(static_cast<long>(std::floor(points(i, 0) / size)),
+                       static_cast<long>(std::floor(points(i, 1) / size)),
+                       static_cast<long>(std::floor(points(i, 2) / size)));
+    }
+    return voxels;
+}
+
+// points on a grid of 0.25 voxels, so that float rounding doesn't move them
+pose_util::Points grid_points(size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> dist(-160, 159);
+    pose_util::Points points(n, 3);
+    for (size_t i = 0; i < n; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            points(i, j) = dist(rng) * 0.125 + 0.0625;
+        }
+    }
+    return points;
+}
+
+}  // namespace
+
+TEST(MapTileStoreTest, AppendEvictAndReopen) {
+    const std::string filename = ::testing::TempDir() + "map_tile_store.bin";
+    const pose_util::Points first = grid_points(20000, 1);
+    const pose_util::Points second = grid_points(20000, 2);
+    pose_util::Points all(first.rows() + second.rows(), 3);
+    all << first, second;
+    const auto expected = voxels_of(all, 0.5);
+
+    size_t tiles = 0;
+    {
+        // 4 m tiles over 40 m, with room for a few of them only
+        MapTileStore store(filename, 4.0, 0.5, 3, 8);
+        store.append(first);
+        EXPECT_LE(store.tiles_in_memory(), 8u);
+        store.flush();
+        store.append(second);
+        tiles = store.tiles().size();
+        EXPECT_EQ(tiles, 1000u);
+
+        pose_util::Points points(0, 3);
+        for (const auto& key : store.tiles()) {
+            const auto tile = store.tile_points(key);
+            pose_util::Points grown(points.rows() + tile.rows(), 3);
+            grown << points, tile;
+            points = grown;
+        }
+        EXPECT_EQ(static_cast<size_t>(points.rows()), expected.size());
+        EXPECT_EQ(voxels_of(points, 0.5), expected);
+    }
+
+    MapTileStore store(filename, 2);
+    EXPECT_EQ(store.tile_size(), 4.0);
+    EXPECT_EQ(store.voxel_size(), 0.5);
+    EXPECT_EQ(store.levels(), 3);
+    EXPECT_EQ(store.tiles().size(), tiles);
+
+    // a box inside the tiles of [0, 8)^3
+    const Eigen::Vector3d lo(0.5, 0.5, 0.5), hi(7.5, 7.5, 7.5);
+    EXPECT_EQ(store.tiles_in(lo, hi).size(), 8u);
+    const auto region = store.query(lo, hi);
+    const auto coarse = store.query(lo, hi, 2);
+    EXPECT_EQ(store.tiles_in_memory(), 0u);
+    EXPECT_TRUE(((region.array() >= 0).all() && (region.array() < 8).all()));
+    size_t in_region = 0;
+    for (const auto& v : expected) {
+        if (std::get<0>(v) >= 0 && std::get<0>(v) < 16 &&
+            std::get<1>(v) >= 0 && std::get<1>(v) < 16 &&
+            std::get<2>(v) >= 0 && std::get<2>(v) < 16) {
+            ++in_region;
+        }
+    }
+    EXPECT_EQ(static_cast<size_t>(region.rows()), in_region);
+    // one point per 2 m voxel at level 2
+    EXPECT_EQ(static_cast<size_t>(coarse.rows()),
+              voxels_of(region, 2.0).size());
+
+    // appending to a reopened store merges with the tiles on disk
+    store.append(first);
+    store.flush();
+    EXPECT_EQ(store.query(lo, hi).rows(), region.rows());
+    EXPECT_THROW(store.query(lo, hi, 3), std::invalid_argument);
+    std::remove(filename.c_str());
+}
+
+TEST(MapTileStoreTest, InvalidArguments) {
+    const std::string filename = ::testing::TempDir() + "map_tile_bad.bin";
+    EXPECT_THROW(MapTileStore(filename, 0.0, 0.1), std::invalid_argument);
+    EXPECT_THROW(MapTileStore(filename, 1e6, 0.1), std::invalid_argument);
+    EXPECT_THROW(MapTileStore(filename, 10.0, 0.1, 0), std::invalid_argument);
+    {
+        std::ofstream out(filename);
+        out << "not a map";
+    }
+    EXPECT_THROW(MapTileStore store(filename), std::runtime_error);
+    std::remove(filename.c_str());
+}
@@ -0,0 +1,79 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/memory_resource.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "ouster/scan_pool.h"
+#include "ouster/types.h"
+
+using namespace ouster;
+
+namespace {
+
+// allocate, write every byte and free blocks of a few sizes
+void exercise(MemoryResource& memory) {
+    for (size_t bytes : {size_t{1}, size_t{4096}, size_t{3} << 20}) {
+        void* ptr = memory.allocate(bytes);
+        ASSERT_NE(ptr, nullptr);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % 64, 0u);
+        std::memset(ptr, 0xab, bytes);
+        memory.deallocate(ptr, bytes);
+    }
+}
+
+}  // namespace
+
+TEST(MemoryResourceTest, heap) { exercise(*heap_memory()); }
+
+TEST(MemoryResourceTest, huge_pages) {
+    HugePageMemory transparent;
+    exercise(transparent);
+    // the reserved pool is usually empty, which falls back to transparent
+    // huge pages rather than failing
+    HugePageMemory reserved(HugePageMode::RESERVED);
+    exercise(reserved);
+    EXPECT_THROW(HugePageMemory(HugePageMode::TRANSPARENT, 3 << 20),
+                 std::invalid_argument);
+}
+
+TEST(MemoryResourceTest, numa_local) {
+    EXPECT_GE(current_numa_node(), 0);
+    NumaLocalMemory local;
+    exercise(local);
+    NumaLocalMemory huge(current_numa_node(), true);
+    exercise(huge);
+}
+
+TEST(MemoryResourceTest, scan_pool_allocates_contiguous_scans) {
+    auto memory = std::make_shared<HugePageMemory>();
+    const auto fields = get_field_types(
+        sensor::UDPProfileLidar::PROFILE_RNG19_RFL8_SIG16_NIR16);
+    ScanPool pool(1024, 128, fields, 16, 2, memory);
+
+    auto scan = pool.acquire();
+    ASSERT_NE(scan->arena_data(), nullptr);
+    EXPECT_GE(scan->arena_size(), 1024u * 128u * 9u);
+    EXPECT_TRUE(pool.matches(*scan));
+    scan->field<uint32_t>(sensor::ChanField::RANGE).setConstant(7);
+
+    // the arena keeps the resource alive
+    const uint8_t* arena = scan->arena_data();
+    std::weak_ptr<HugePageMemory> weak = memory;
+    memory.reset();
+    EXPECT_FALSE(weak.expired());
+
+    EXPECT_TRUE(pool.release(std::move(scan)));
+    auto again = pool.acquire();
+    EXPECT_EQ(again->arena_data(), arena);
+    EXPECT_EQ(again->field<uint32_t>(sensor::ChanField::RANGE)(3, 5), 7u);
+    EXPECT_EQ(pool.allocated(), 1u);
+}
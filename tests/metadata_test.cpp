@@ -5,12 +5,17 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
 #include <fstream>
 #include <memory>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
+#include "ouster/metadata.h"
 #include "ouster/types.h"
 
 class MetaFiles : public testing::TestWithParam<const char*> {};
@@ -80,6 +85,57 @@ TEST_P(MetaFiles, combinedTestMetadata) {
     EXPECT_EQ(si_new.beam_altitude_angles, si_roundtrip.beam_altitude_angles);
 }
 
+TEST_P(MetaFiles, binaryRoundTrip) {
+    std::string param = GetParam();
+    auto data_dir = getenvs("DATA_DIR");
+
+    auto info = ouster::sensor::metadata_from_json(data_dir + param + ".json");
+    info.extrinsic = ouster::mat4d::Identity();
+    info.extrinsic(0, 3) = 1.5;
+
+    const auto binary = ouster::sensor::sensor_info_to_binary(info);
+    EXPECT_EQ(
+        ouster::sensor::sensor_info_from_binary(binary.data(), binary.size()),
+        info);
+
+    for (size_t size : {size_t{0}, size_t{3}, binary.size() / 2,
+                        binary.size() - 1}) {
+        EXPECT_THROW(
+            ouster::sensor::sensor_info_from_binary(binary.data(), size),
+            std::invalid_argument);
+    }
+    auto other_version = binary;
+    other_version[3]++;
+    EXPECT_THROW(ouster::sensor::sensor_info_from_binary(
+                     other_version.data(), other_version.size()),
+                 std::invalid_argument);
+}
+
+TEST_P(MetaFiles, parseTime) {
+    std::string param = GetParam();
+    auto data_dir = getenvs("DATA_DIR");
+
+    std::ifstream in(data_dir + param + ".json");
+    std::stringstream buf;
+    buf << in.rdbuf();
+    const std::string json = buf.str();
+
+    // parsing is repeated to record its time, which ends up in the xml report
+    const ouster::sensor::sensor_info expected(json);
+    const int n = 20;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+        ouster::ValidatorIssues issues;
+        nonstd::optional<ouster::sensor::sensor_info> info;
+        ouster::parse_and_validate_metadata(json, info, issues);
+        ASSERT_TRUE(info);
+        EXPECT_EQ(*info, expected);
+    }
+    auto elapsed = std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start);
+    RecordProperty("parse_us", static_cast<int>(elapsed.count() / n));
+}
+
 class product_info_test : public ouster::sensor::product_info {
    public:
     product_info_test(std::string product_info_string, std::string form_factor,
@@ -297,3 +353,35 @@ TEST(Util, TestProdlineDecoder) {
         EXPECT_EQ(actual, *it.second);
     }
 }
+
+TEST(Util, TestGetFormatConcurrent) {
+    using ouster::sensor::UDPProfileLidar;
+    using ouster::sensor::get_format;
+    const auto profile = UDPProfileLidar::PROFILE_RNG19_RFL8_SIG16_NIR16;
+
+    // threads asking for new and cached formats all get the same instances
+    const size_t n_threads = 8;
+    std::vector<std::vector<const ouster::sensor::packet_format*>> seen(
+        n_threads);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < n_threads; t++) {
+        threads.emplace_back([&seen, t, profile] {
+            for (int i = 0; i < 200; i++) {
+                size_t pixels = 16 << (i % 4);
+                seen[t].push_back(&get_format(profile, pixels, 16));
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    for (size_t t = 0; t < n_threads; t++) {
+        EXPECT_EQ(seen[t], seen[0]);
+    }
+    for (int i = 0; i < 4; i++) {
+        const auto& pf = *seen[0][i];
+        EXPECT_EQ(pf.pixels_per_column, 16 << i);
+        EXPECT_EQ(pf.columns_per_packet, 16);
+        EXPECT_EQ(pf.udp_profile_lidar, profile);
+        EXPECT_EQ(&get_format(profile, 16 << i, 16), &pf);
+    }
+}
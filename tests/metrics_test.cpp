@@ -0,0 +1,111 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/metrics.h"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+
+using namespace ouster::sensor;
+
+namespace {
+
+bool contains(const std::string& text, const std::string& line) {
+    return text.find(line + "\n") != std::string::npos;
+}
+
+}  // namespace
+
+TEST(MetricsTest, families_group_samples) {
+    OpenMetrics m;
+    m.counter("packets", "Packets", 1, {{"sensor", "a"}});
+    m.gauge("depth", "Depth", 0.5);
+    m.counter("packets", "Packets", 2, {{"sensor", "b"}});
+    const auto text = m.str();
+    EXPECT_EQ(text,
+              "# TYPE packets counter\n"
+              "# HELP packets Packets\n"
+              "packets_total{sensor=\"a\"} 1\n"
+              "packets_total{sensor=\"b\"} 2\n"
+              "# TYPE depth gauge\n"
+              "# HELP depth Depth\n"
+              "depth 0.5\n"
+              "# EOF\n");
+}
+
+TEST(MetricsTest, escapes_label_values) {
+    OpenMetrics m;
+    m.gauge("g", "", 1, {{"host", "a\"b\\c\nd"}});
+    EXPECT_TRUE(contains(m.str(), "g{host=\"a\\\"b\\\\c\\nd\"} 1"));
+}
+
+TEST(MetricsTest, rejects_invalid_names) {
+    OpenMetrics m;
+    EXPECT_THROW(m.gauge("0bad", "", 1), std::invalid_argument);
+    EXPECT_THROW(m.gauge("bad-name", "", 1), std::invalid_argument);
+    EXPECT_THROW(m.gauge("g", "", 1, {{"bad label", "x"}}),
+                 std::invalid_argument);
+    m.gauge("g", "", 1);
+    EXPECT_THROW(m.counter("g", "", 1), std::invalid_argument);
+}
+
+TEST(MetricsTest, summary_in_seconds) {
+    LatencyStats stats;
+    stats.count = 4;
+    stats.mean = 2000000;
+    stats.p50 = 1000000;
+    stats.p90 = 2000000;
+    stats.p99 = 3000000;
+    stats.p999 = 4000000;
+    OpenMetrics m;
+    m.summary("latency_seconds", "Latency", stats, {{"client", "0"}});
+    const auto text = m.str();
+    EXPECT_TRUE(contains(text, "# TYPE latency_seconds summary"));
+    EXPECT_TRUE(
+        contains(text, "latency_seconds{client=\"0\",quantile=\"0.5\"} 0.001"));
+    EXPECT_TRUE(contains(
+        text, "latency_seconds{client=\"0\",quantile=\"0.999\"} 0.004"));
+    EXPECT_TRUE(contains(text, "latency_seconds_sum{client=\"0\"} 0.008"));
+    EXPECT_TRUE(contains(text, "latency_seconds_count{client=\"0\"} 4"));
+}
+
+TEST(MetricsTest, scan_source_stats) {
+    ScanSourceStats stats;
+    stats.batched_packets = {640, 128};
+    stats.batched_scans = {10, 2};
+    stats.incomplete_scans = {1, 0};
+    stats.missing_frames = {0, 3};
+    stats.id_errors = 5;
+    stats.clients.resize(1);
+    stats.clients[0].buffer_dropped_packets = 7;
+    std::vector<sensor_info> infos(2);
+    infos[0].sn = 992000000001;
+
+    OpenMetrics m;
+    add_metrics(m, stats, infos, {{"host", "ingest1"}});
+    const auto text = m.str();
+    EXPECT_TRUE(contains(
+        text,
+        "ouster_lidar_packets_total{host=\"ingest1\",sensor=\"992000000001\"}"
+        " 640"));
+    // sensors without a serial number are labeled by index
+    EXPECT_TRUE(contains(
+        text, "ouster_missing_frames_total{host=\"ingest1\",sensor=\"1\"} 3"));
+    EXPECT_TRUE(contains(
+        text,
+        "ouster_incomplete_scans_total{host=\"ingest1\","
+        "sensor=\"992000000001\"} 1"));
+    EXPECT_TRUE(contains(text, "ouster_id_errors_total{host=\"ingest1\"} 5"));
+    EXPECT_TRUE(contains(
+        text,
+        "ouster_buffer_dropped_packets_total{host=\"ingest1\",client=\"0\"} "
+        "7"));
+    // not reported, so not exported
+    EXPECT_EQ(text.find("ouster_kernel_dropped_packets"), std::string::npos);
+    // latency stats disabled
+    EXPECT_EQ(text.find("latency"), std::string::npos);
+}
@@ -0,0 +1,155 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/occupancy_grid.h"
+
+#include <gtest/gtest.h>
+
+#include <Eigen/Geometry>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/types.h"
+
+using namespace ouster;
+
+namespace {
+
+constexpr double pi = 3.14159265358979323846;
+
+// a lut of w columns around the sensor, with a level beam and a beam pointing
+// down at 45 degrees per column, ranges in mm
+XYZLut make_lut(size_t w) {
+    XYZLut lut;
+    lut.direction.resize(2 * w, 3);
+    lut.offset = LidarScan::Points::Zero(2 * w, 3);
+    for (size_t c = 0; c < w; ++c) {
+        const double az = 2 * pi * c / w;
+        lut.direction.row(c) << std::cos(az), std::sin(az), 0;
+        lut.direction.row(w + c) << std::cos(az) * std::sqrt(0.5),
+            std::sin(az) * std::sqrt(0.5), -std::sqrt(0.5);
+    }
+    lut.direction *= 0.001;
+    return lut;
+}
+
+mat4d lifted(double yaw, double x, double y) {
+    Eigen::Affine3d t(Eigen::AngleAxisd(yaw, Eigen::Vector3d::UnitZ()));
+    t.translation() << x, y, 1.0;
+    return t.matrix();
+}
+
+CellState state_at(const OccupancyGrid& grid, const GridLayout& layout,
+                   double x, double y) {
+    const auto col = static_cast<Eigen::Index>(
+        std::floor(x / layout.resolution + layout.cols / 2.0));
+    const auto row = static_cast<Eigen::Index>(
+        std::floor(y / layout.resolution + layout.rows / 2.0));
+    return static_cast<CellState>(grid.state(row, col));
+}
+
+GridLayout test_layout() {
+    GridLayout layout;
+    layout.rows = 100;
+    layout.cols = 100;
+    layout.resolution = 0.2;
+    return layout;
+}
+
+}  // namespace
+
+TEST(OccupancyGridTest, MarksHitsAndFreeSpace) {
+    const size_t w = 4;
+    const auto layout = test_layout();
+    OccupancyGridBuilder builder({make_lut(w)}, {lifted(0, 0, 0)}, layout);
+
+    LidarScan scan(w, 2);
+    auto range = scan.field<uint32_t>(sensor::ChanField::RANGE);
+    // an obstacle 5.1 m ahead, the ground 1 m to the left, nothing behind
+    // and a level return of the right column beyond the grid
+    range(0, 0) = 5100;
+    range(1, 0) = 1414;
+    range(1, 1) = 1420;
+    range(0, 3) = 50000;
+
+    const OccupancyGrid& grid = builder.build({&scan});
+    EXPECT_EQ(grid.frame, 0u);
+    EXPECT_EQ(state_at(grid, layout, 5.1, 0.1), CellState::OCCUPIED);
+    EXPECT_EQ(state_at(grid, layout, 3.1, 0.1), CellState::FREE);
+    EXPECT_EQ(state_at(grid, layout, 0.1, 0.1), CellState::FREE);
+    EXPECT_EQ(state_at(grid, layout, 7.1, 0.1), CellState::UNKNOWN);
+    EXPECT_EQ(state_at(grid, layout, 0.1, 0.9), CellState::FREE);
+    EXPECT_EQ(state_at(grid, layout, 0.1, 1.9), CellState::UNKNOWN);
+    EXPECT_EQ(state_at(grid, layout, -3.1, 0.1), CellState::UNKNOWN);
+    // the ray of the right column is clipped to the edge of the grid
+    EXPECT_GT((grid.state.row(0) == static_cast<uint8_t>(CellState::FREE))
+                  .count(),
+              0);
+
+    // heights are those of the highest point of a cell
+    const auto col = static_cast<Eigen::Index>(5.1 / 0.2 + 50);
+    EXPECT_FLOAT_EQ(grid.height(50, col), 1.0f);
+    EXPECT_EQ(grid.hits(50, col), 1u);
+    EXPECT_NEAR(grid.height(static_cast<Eigen::Index>(1.0 / 0.2 + 50), 50),
+                0.0f, 1e-2);
+    EXPECT_TRUE(std::isnan(grid.height(10, 10)));
+}
+
+TEST(OccupancyGridTest, FusesSensorsIntoReusedGrid) {
+    const size_t w = 8;
+    const auto layout = test_layout();
+    // the second sensor 4 m ahead, looking back
+    OccupancyGridBuilder builder({make_lut(w), make_lut(w)},
+                                 {lifted(0, 0, 0), lifted(pi, 4, 0)}, layout);
+    ASSERT_EQ(builder.sensors_count(), 2u);
+
+    LidarScan front(w, 2);
+    LidarScan back(w, 2);
+    // both see an obstacle 2.1 m ahead of the first sensor
+    front.field<uint32_t>(sensor::ChanField::RANGE)(0, 0) = 2100;
+    back.field<uint32_t>(sensor::ChanField::RANGE)(0, 0) = 1900;
+
+    const OccupancyGrid& first = builder.build({&front, nullptr});
+    EXPECT_EQ(state_at(first, layout, 2.1, 0.1), CellState::OCCUPIED);
+    EXPECT_EQ(state_at(first, layout, 3.1, 0.1), CellState::UNKNOWN);
+    const uint8_t* data = first.state.data();
+
+    const OccupancyGrid& both = builder.build({&front, &back});
+    EXPECT_EQ(both.frame, 1u);
+    EXPECT_EQ(both.state.data(), data);
+    EXPECT_EQ(&builder.latest(), &both);
+    EXPECT_EQ(state_at(both, layout, 2.1, 0.1), CellState::OCCUPIED);
+    EXPECT_EQ(both.hits(50, static_cast<Eigen::Index>(2.1 / 0.2 + 50)), 2u);
+    EXPECT_EQ(state_at(both, layout, 3.1, 0.1), CellState::FREE);
+    EXPECT_EQ(state_at(both, layout, 1.1, 0.1), CellState::FREE);
+
+    // a missing scan leaves its sensor out
+    const OccupancyGrid& back_only = builder.build({nullptr, &back});
+    EXPECT_EQ(state_at(back_only, layout, 1.1, 0.1), CellState::UNKNOWN);
+    EXPECT_EQ(state_at(back_only, layout, 3.1, 0.1), CellState::FREE);
+}
+
+TEST(OccupancyGridTest, RejectsBadInputs) {
+    const auto lut = make_lut(4);
+    EXPECT_THROW(OccupancyGridBuilder({}), std::invalid_argument);
+    EXPECT_THROW(
+        OccupancyGridBuilder({lut}, {lifted(0, 0, 0), lifted(0, 0, 0)}),
+        std::invalid_argument);
+    GridLayout layout;
+    layout.resolution = 0;
+    EXPECT_THROW(OccupancyGridBuilder({lut}, {}, layout),
+                 std::invalid_argument);
+    layout = GridLayout{};
+    layout.min_z = 3.0;
+    EXPECT_THROW(OccupancyGridBuilder({lut}, {}, layout),
+                 std::invalid_argument);
+
+    OccupancyGridBuilder builder({lut});
+    LidarScan wrong(8, 2);
+    EXPECT_THROW(builder.build({&wrong}), std::invalid_argument);
+    EXPECT_THROW(builder.build({}), std::invalid_argument);
+}
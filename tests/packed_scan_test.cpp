@@ -0,0 +1,103 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/packed_scan.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/types.h"
+
+using namespace ouster;
+using namespace ouster::sensor;
+
+namespace {
+
+// a scan of the low data profile with values the packets could carry
+LidarScan low_data_scan(size_t w, size_t h) {
+    LidarScan scan(w, h, UDPProfileLidar::PROFILE_RNG15_RFL8_NIR8);
+    auto range = scan.field<uint32_t>(ChanField::RANGE);
+    auto nir = scan.field<uint16_t>(ChanField::NEAR_IR);
+    auto refl = scan.field<uint8_t>(ChanField::REFLECTIVITY);
+    for (size_t v = 0; v < h; v++) {
+        for (size_t u = 0; u < w; u++) {
+            range(v, u) = static_cast<uint32_t>((v * w + u) * 8 % (1 << 18));
+            nir(v, u) = static_cast<uint16_t>((u + v) % 256 << 4);
+            refl(v, u) = static_cast<uint8_t>(u * 3 + v);
+        }
+    }
+    scan.field<uint8_t>(ChanField::FLAGS)(1, 2) = 1;
+    scan.timestamp()[3] = 42;
+    scan.alert_flags()[0] = 5;
+    scan.frame_id = 7;
+    return scan;
+}
+
+}  // namespace
+
+TEST(PackedScanTest, low_data_profile_round_trip) {
+    const size_t w = 512;
+    const size_t h = 32;
+    const LidarScan scan = low_data_scan(w, h);
+    const auto& pf = get_format(UDPProfileLidar::PROFILE_RNG15_RFL8_NIR8, h,
+                                DEFAULT_COLUMNS_PER_PACKET);
+
+    PackedScan packed(scan, pf);
+    EXPECT_EQ(packed.width(), w);
+    EXPECT_EQ(packed.height(), h);
+    EXPECT_EQ(packed.field_types(), scan.field_types());
+    EXPECT_TRUE(packed.is_packed(ChanField::RANGE));
+    EXPECT_TRUE(packed.is_packed(ChanField::NEAR_IR));
+    // already as narrow as on the wire
+    EXPECT_FALSE(packed.is_packed(ChanField::REFLECTIVITY));
+    EXPECT_TRUE(packed.has_field(ChanField::REFLECTIVITY));
+    EXPECT_FALSE(packed.has_field(ChanField::SIGNAL));
+
+    // 16 bit ranges and 8 bit NIR: 5 rather than 8 bytes per pixel
+    const size_t headers = packed.unpacked_bytes() - w * h * 8;
+    EXPECT_EQ(packed.bytes(), w * h * 5 + headers);
+
+    EXPECT_EQ(packed.unpack(), scan);
+    const Field range = packed.field(ChanField::RANGE);
+    EXPECT_EQ(range, scan.field(ChanField::RANGE));
+    EXPECT_THROW(packed.field(ChanField::SIGNAL), std::out_of_range);
+
+    // into a preallocated scan, e.g. one from a ScanPool
+    auto dst = LidarScan::make_contiguous(w, h, scan.field_types(),
+                                          DEFAULT_COLUMNS_PER_PACKET);
+    const uint8_t* arena = dst.arena_data();
+    packed.unpack(dst);
+    EXPECT_EQ(dst, scan);
+    EXPECT_EQ(dst.arena_data(), arena);
+    LidarScan other(w, h, UDPProfileLidar::PROFILE_RNG19_RFL8_SIG16_NIR16);
+    EXPECT_THROW(packed.unpack(other), std::invalid_argument);
+}
+
+TEST(PackedScanTest, lossy_values_and_other_profiles) {
+    LidarScan scan = low_data_scan(64, 16);
+    const auto& pf = get_format(UDPProfileLidar::PROFILE_RNG15_RFL8_NIR8, 16,
+                                DEFAULT_COLUMNS_PER_PACKET);
+    scan.field<uint32_t>(ChanField::RANGE)(0, 1) = 9;
+    EXPECT_THROW(PackedScan(scan, pf), std::invalid_argument);
+
+    // without sensor_info there is no format to pack with
+    EXPECT_THROW(PackedScan{scan}, std::invalid_argument);
+
+    // RNG19 ranges need their 32 bits, fields outside of the packets stay
+    LidarScan wide(64, 16, UDPProfileLidar::PROFILE_RNG19_RFL8_SIG16_NIR16);
+    wide.field<uint32_t>(ChanField::RANGE)(2, 2) = (1 << 19) - 1;
+    wide.add_field(FieldType{"extra", ChanFieldType::UINT32});
+    const auto& wide_pf =
+        get_format(UDPProfileLidar::PROFILE_RNG19_RFL8_SIG16_NIR16, 16,
+                   DEFAULT_COLUMNS_PER_PACKET);
+    PackedScan packed(wide, wide_pf);
+    EXPECT_FALSE(packed.is_packed(ChanField::RANGE));
+    EXPECT_FALSE(packed.is_packed("extra"));
+    EXPECT_EQ(packed.bytes(), packed.unpacked_bytes());
+    EXPECT_EQ(packed.unpack(), wide);
+}
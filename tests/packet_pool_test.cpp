@@ -0,0 +1,97 @@
+/**
+ * Copyright(c) 2024, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/packet_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+using ouster::sensor::ImuPacket;
+using ouster::sensor::PacketPool;
+using ouster::sensor::PacketType;
+using ouster::sensor::PooledPacket;
+
+TEST(PacketPoolTest, ReusesReleasedPackets) {
+    PacketPool pool;
+    ouster::sensor::Packet* first = nullptr;
+    {
+        auto p = pool.acquire(PacketType::Lidar);
+        ASSERT_TRUE(p);
+        EXPECT_EQ(p->type(), PacketType::Lidar);
+        EXPECT_EQ(p.use_count(), 1u);
+        p->buf.resize(1024);
+        first = p.get();
+        EXPECT_EQ(pool.size(), 1u);
+        EXPECT_EQ(pool.available(), 0u);
+    }
+    EXPECT_EQ(pool.available(), 1u);
+
+    // the released packet comes back with its buffer intact
+    auto p = pool.acquire(PacketType::Lidar);
+    EXPECT_EQ(p.get(), first);
+    EXPECT_EQ(p->buf.size(), 1024u);
+    EXPECT_EQ(pool.size(), 1u);
+
+    // packets of another type come from their own free list
+    auto imu = pool.acquire(PacketType::Imu);
+    EXPECT_NE(imu.get(), first);
+    EXPECT_NO_THROW(imu->as<ImuPacket>());
+    EXPECT_EQ(pool.size(), 2u);
+
+    EXPECT_THROW(pool.acquire(PacketType::Unknown), std::invalid_argument);
+}
+
+TEST(PacketPoolTest, ReleasedWithLastHandle) {
+    PacketPool pool;
+    PooledPacket a = pool.acquire(PacketType::Imu);
+    PooledPacket b = a;
+    EXPECT_EQ(a.use_count(), 2u);
+    EXPECT_EQ(a.get(), b.get());
+
+    PooledPacket c = std::move(b);
+    EXPECT_FALSE(b);
+    EXPECT_EQ(c.use_count(), 2u);
+
+    a.reset();
+    EXPECT_FALSE(a);
+    EXPECT_EQ(c.use_count(), 1u);
+    EXPECT_EQ(pool.available(), 0u);
+    c = PooledPacket();
+    EXPECT_EQ(pool.available(), 1u);
+}
+
+TEST(PacketPoolTest, HandlesOutliveThePool) {
+    PooledPacket p;
+    {
+        PacketPool pool;
+        p = pool.acquire(PacketType::Lidar);
+        p->buf.assign(16, 7);
+    }
+    ASSERT_TRUE(p);
+    EXPECT_EQ(p->buf[15], 7);
+    p.reset();
+}
+
+TEST(PacketPoolTest, ReleaseFromOtherThreads) {
+    PacketPool pool;
+    const int n_threads = 4;
+    const int n_iters = 1000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < n_threads; t++) {
+        threads.emplace_back([&pool]() {
+            for (int i = 0; i < n_iters; i++) {
+                auto p = pool.acquire(PacketType::Lidar);
+                // hand the packet to another thread to release
+                std::thread([p]() mutable { p.reset(); }).join();
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    EXPECT_LE(pool.size(), static_cast<size_t>(n_threads));
+    EXPECT_EQ(pool.available(), pool.size());
+}
@@ -0,0 +1,215 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/packet_relay.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ouster/impl/netcompat.h"
+#include "ouster/shm_packet_channel.h"
+#include "util.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+
+using ouster::ShmPacketReader;
+using ouster::ShmPacketWriter;
+using namespace ouster::sensor;
+
+namespace {
+
+SOCKET bound_udp_socket(int port) {
+    SOCKET sock = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    bind(sock, (sockaddr*)&addr, sizeof(addr));
+    impl::socket_set_rcvtimeout(sock, 1);
+    // hold every packet sent while the other sockets are read
+    impl::socket_set_rcvbuf(sock, 4 * 1024 * 1024);
+    return sock;
+}
+
+int port_of(SOCKET sock) {
+    sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    getsockname(sock, (sockaddr*)&addr, &len);
+    return ntohs(addr.sin_port);
+}
+
+void send_to(SOCKET sock, int port, const std::vector<uint8_t>& buf) {
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    sendto(sock, (const char*)buf.data(), buf.size(), 0, (sockaddr*)&addr,
+           sizeof(addr));
+}
+
+// receive datagrams until none arrive for a second
+std::vector<std::vector<uint8_t>> receive_all(SOCKET sock) {
+    std::vector<std::vector<uint8_t>> res;
+    std::vector<uint8_t> buf(65536);
+    while (true) {
+        const auto size = recv(sock, (char*)buf.data(), buf.size(), 0);
+        if (size <= 0) break;
+        res.emplace_back(buf.begin(), buf.begin() + size);
+    }
+    return res;
+}
+
+std::string channel_name(const std::string& test) {
+    return "/ouster_shm_packet_test_" + std::to_string(getpid()) + "_" + test;
+}
+
+class PacketRelayTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        info_ = metadata_from_json(getenvs("DATA_DIR") +
+                                   "3_0_1_os-122246000293-128.json");
+        lidar_in_ = bound_udp_socket(0);
+        imu_in_ = bound_udp_socket(0);
+        info_.config.udp_port_lidar = port_of(lidar_in_);
+        info_.config.udp_port_imu = port_of(imu_in_);
+        // the client binds the ports itself
+        impl::socket_close(lidar_in_);
+        impl::socket_close(imu_in_);
+        config_.udp_port_lidar = info_.config.udp_port_lidar;
+        config_.udp_port_imu = info_.config.udp_port_imu;
+    }
+
+    sensor_info info_;
+    sensor_config config_;
+    SOCKET lidar_in_;
+    SOCKET imu_in_;
+};
+
+}  // namespace
+
+TEST_F(PacketRelayTest, fans_out_packets) {
+    SensorClient client({Sensor("127.0.0.1", config_)}, {info_});
+    packet_format pf(info_);
+
+    SOCKET all_lidar = bound_udp_socket(0);
+    SOCKET all_imu = bound_udp_socket(0);
+    SOCKET lidar_only = bound_udp_socket(0);
+    RelayDestination all{"127.0.0.1", port_of(all_lidar), port_of(all_imu)};
+    RelayDestination lidar{"127.0.0.1", port_of(lidar_only), 0};
+    PacketRelayOptions options;
+    options.shm_name = channel_name("fans_out");
+    options.shm_slots = 64;
+    PacketRelay relay({info_}, {all, lidar}, options);
+    ShmPacketReader reader(options.shm_name);
+    ASSERT_EQ(reader.metadata().size(), 1u);
+    EXPECT_EQ(sensor_info(reader.metadata()[0]).sn, info_.sn);
+    relay.start(client);
+
+    const size_t n_lidar = 5;
+    SOCKET sender = socket(AF_INET, SOCK_DGRAM, 0);
+    for (size_t i = 0; i < n_lidar; i++) {
+        send_to(sender, config_.udp_port_lidar.value(),
+                std::vector<uint8_t>(pf.lidar_packet_size, (uint8_t)i));
+    }
+    send_to(sender, config_.udp_port_imu.value(),
+            std::vector<uint8_t>(pf.imu_packet_size, 0xAB));
+    impl::socket_close(sender);
+
+    auto got_lidar = receive_all(all_lidar);
+    auto got_imu = receive_all(all_imu);
+    auto got_lidar_only = receive_all(lidar_only);
+    relay.stop();
+
+    ASSERT_EQ(got_lidar.size(), n_lidar);
+    for (size_t i = 0; i < n_lidar; i++) {
+        EXPECT_EQ(got_lidar[i],
+                  std::vector<uint8_t>(pf.lidar_packet_size, (uint8_t)i));
+    }
+    EXPECT_EQ(got_lidar_only, got_lidar);
+    ASSERT_EQ(got_imu.size(), 1u);
+    EXPECT_EQ(got_imu[0], std::vector<uint8_t>(pf.imu_packet_size, 0xAB));
+
+    size_t lidar_read = 0;
+    size_t imu_read = 0;
+    while (auto p = reader.next()) {
+        EXPECT_EQ(p->source, 0);
+        if (p->type == PacketType::Lidar) {
+            ASSERT_EQ(p->size, pf.lidar_packet_size);
+            EXPECT_EQ(p->data[0], lidar_read);
+            lidar_read++;
+        } else {
+            EXPECT_EQ(p->type, PacketType::Imu);
+            imu_read++;
+        }
+        EXPECT_GT(p->host_timestamp, 0u);
+        EXPECT_TRUE(reader.valid());
+    }
+    EXPECT_EQ(lidar_read, n_lidar);
+    EXPECT_EQ(imu_read, 1u);
+
+    const auto stats = relay.stats();
+    EXPECT_EQ(stats.lidar_packets, n_lidar);
+    EXPECT_EQ(stats.imu_packets, 1u);
+    EXPECT_EQ(stats.shm_packets, n_lidar + 1);
+    ASSERT_EQ(stats.destinations.size(), 2u);
+    EXPECT_EQ(stats.destinations[0].packets, n_lidar + 1);
+    EXPECT_EQ(stats.destinations[0].bytes,
+              n_lidar * pf.lidar_packet_size + pf.imu_packet_size);
+    EXPECT_EQ(stats.destinations[1].packets, n_lidar);
+    EXPECT_EQ(stats.destinations[1].errors, 0u);
+
+    impl::socket_close(all_lidar);
+    impl::socket_close(all_imu);
+    impl::socket_close(lidar_only);
+}
+
+TEST_F(PacketRelayTest, rejects_bad_destinations) {
+    EXPECT_THROW(PacketRelay({info_}, {{"127.0.0.1", 0, 0}}),
+                 std::invalid_argument);
+    EXPECT_THROW(PacketRelay({info_}, {{"not a host name", 7502, 7503}}),
+                 std::invalid_argument);
+}
+
+TEST(ShmPacketChannelTest, reader_skips_overwritten_packets) {
+    const auto name = channel_name("overwrite");
+    ShmPacketWriter writer(name, 4, 16, {"a", "bc"});
+    ShmPacketReader reader(name);
+    EXPECT_EQ(reader.metadata(), (std::vector<std::string>{"a", "bc"}));
+    EXPECT_EQ(reader.next(), nullptr);
+
+    for (uint8_t i = 0; i < 6; i++) {
+        std::vector<uint8_t> buf(i + 1, i);
+        writer.publish(i % 2, PacketType::Lidar, 100 + i, buf.data(),
+                       buf.size());
+    }
+    EXPECT_EQ(reader.published(), 6u);
+    for (uint8_t i = 2; i < 6; i++) {
+        auto p = reader.next();
+        ASSERT_NE(p, nullptr);
+        EXPECT_EQ(p->source, i % 2);
+        EXPECT_EQ(p->host_timestamp, 100u + i);
+        ASSERT_EQ(p->size, i + 1u);
+        EXPECT_EQ(p->data[i], i);
+    }
+    EXPECT_EQ(reader.next(), nullptr);
+    EXPECT_EQ(reader.dropped(), 2u);
+
+    std::vector<uint8_t> large(17);
+    EXPECT_THROW(writer.publish(0, PacketType::Imu, 0, large.data(),
+                                large.size()),
+                 std::invalid_argument);
+    EXPECT_THROW(ShmPacketReader(channel_name("missing")),
+                 std::runtime_error);
+}
+
+#endif
@@ -0,0 +1,168 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/packet_stream_analyzer.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <vector>
+
+#include "ouster/impl/lidar_scan_impl.h"
+#include "ouster/lidar_scan.h"
+#include "ouster/metrics.h"
+#include "util.h"
+
+using namespace ouster::sensor;
+using ouster::LidarScan;
+
+namespace {
+
+class PacketStreamAnalyzerTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        info_ = metadata_from_json(getenvs("DATA_DIR") +
+                                   "3_0_1_os-122246000293-128.json");
+        cpp_ = get_format(info_).columns_per_packet;
+        period_ = cpp_ * 1000000000ull /
+                  (info_.format.fps * info_.format.columns_per_frame);
+    }
+
+    // the packets of a frame, sent one period apart from the host time
+    // the frame starts at
+    std::vector<LidarPacket> frame(uint32_t frame_id, uint64_t host_ts) {
+        LidarScan ls(info_);
+        std::fill(ls.status().data(), ls.status().data() + ls.status().size(),
+                  0x1);
+        std::iota(ls.timestamp().data(),
+                  ls.timestamp().data() + ls.timestamp().size(),
+                  uint64_t{1000} + frame_id * 100000000ull);
+        for (int i = 0; i < ls.packet_timestamp().size(); i++) {
+            ls.packet_timestamp()[i] = host_ts + i * period_;
+        }
+        ls.frame_id = frame_id;
+        impl::packet_writer pw{get_format(info_)};
+        std::vector<LidarPacket> out;
+        ouster::impl::scan_to_packets(ls, pw, std::back_inserter(out),
+                                      info_.init_id, info_.sn);
+        return out;
+    }
+
+    sensor_info info_;
+    int cpp_;
+    uint64_t period_;
+};
+
+}  // namespace
+
+TEST_F(PacketStreamAnalyzerTest, complete_stream) {
+    PacketStreamAnalyzer analyzer(info_);
+    for (uint32_t f = 0; f < 3; f++) {
+        for (const auto& p : frame(f, 1000000000ull + f * 100000000ull)) {
+            analyzer(p);
+        }
+    }
+    analyzer.flush();
+    const auto stats = analyzer.stats();
+    EXPECT_EQ(stats.frames, 3u);
+    EXPECT_EQ(stats.incomplete_frames, 0u);
+    EXPECT_EQ(stats.missing_columns, 0u);
+    EXPECT_EQ(stats.missing_frames, 0u);
+    EXPECT_EQ(stats.late_packets, 0u);
+    EXPECT_EQ(stats.reordered_packets, 0u);
+    EXPECT_EQ(stats.duplicate_columns, 0u);
+    EXPECT_EQ(stats.timestamp_regressions, 0u);
+    EXPECT_EQ(stats.invalid_packets, 0u);
+    EXPECT_TRUE(stats.missing_ranges.empty());
+    EXPECT_GT(stats.lidar_interarrival.count, 0u);
+    EXPECT_EQ(stats.lidar_jitter.max, 0u);
+    EXPECT_EQ(stats.expected_lidar_rate,
+              info_.format.fps * info_.format.columns_per_frame / cpp_);
+}
+
+TEST_F(PacketStreamAnalyzerTest, lost_reordered_and_late_packets) {
+    PacketStreamAnalyzer analyzer(info_);
+    for (const auto& p : frame(0, 1000)) analyzer(p);
+
+    // frame 1 loses its third packet and swaps its fifth and sixth
+    auto packets = frame(1, 100001000);
+    packets.erase(packets.begin() + 2);
+    std::swap(packets[3], packets[4]);
+    for (const auto& p : packets) analyzer(p);
+    // a packet of frame 1 repeated
+    analyzer(packets[0]);
+
+    // frame 2 is lost entirely, and a packet of frame 1 arrives late
+    for (const auto& p : frame(3, 300001000)) analyzer(p);
+    analyzer(packets[1]);
+    analyzer.flush();
+
+    const auto stats = analyzer.stats();
+    EXPECT_EQ(stats.frames, 3u);
+    EXPECT_EQ(stats.incomplete_frames, 1u);
+    EXPECT_EQ(stats.missing_columns, static_cast<uint64_t>(cpp_));
+    EXPECT_EQ(stats.missing_frames, 1u);
+    EXPECT_EQ(stats.reordered_packets, 1u);
+    EXPECT_EQ(stats.duplicate_columns, static_cast<uint64_t>(cpp_));
+    EXPECT_EQ(stats.late_packets, 1u);
+    ASSERT_EQ(stats.missing_ranges.size(), 1u);
+    EXPECT_EQ(stats.missing_ranges[0].frame_id, 1u);
+    EXPECT_EQ(stats.missing_ranges[0].first, 2 * cpp_);
+    EXPECT_EQ(stats.missing_ranges[0].last, 3 * cpp_ - 1);
+}
+
+TEST_F(PacketStreamAnalyzerTest, timestamp_regressions_and_invalid_packets) {
+    PacketStreamAnalyzer analyzer(info_);
+    auto packets = frame(0, 1000);
+    // a column timestamped before the previous one
+    impl::packet_writer pw{get_format(info_)};
+    pw.set_col_timestamp(pw.nth_col(1, packets[1].buf.data()), 5);
+    for (const auto& p : packets) analyzer(p);
+
+    LidarPacket other = packets[0];
+    impl::packet_writer(get_format(info_))
+        .set_prod_sn(other.buf.data(), info_.sn + 1);
+    analyzer(other);
+    analyzer.flush();
+
+    const auto stats = analyzer.stats();
+    EXPECT_EQ(stats.timestamp_regressions, 1u);
+    EXPECT_EQ(stats.invalid_packets, 1u);
+    EXPECT_EQ(stats.incomplete_frames, 0u);
+}
+
+TEST_F(PacketStreamAnalyzerTest, imu_rate_and_jitter) {
+    PacketStreamAnalyzer analyzer(info_);
+    const int size = static_cast<int>(get_format(info_).imu_packet_size);
+    // 2.5 s of IMU packets at 100 Hz, every tenth one 1 ms late
+    for (int i = 0; i < 250; i++) {
+        ImuPacket p(size);
+        p.host_timestamp = 1000000000ull + i * 10000000ull;
+        if (i % 10 == 5) p.host_timestamp += 1000000;
+        analyzer(p);
+    }
+    const auto stats = analyzer.stats();
+    EXPECT_EQ(stats.imu_packets, 250u);
+    EXPECT_NEAR(stats.imu_rate, 100, 1);
+    EXPECT_NEAR(stats.min_imu_rate, 100, 1);
+    EXPECT_NEAR(stats.max_imu_rate, 100, 1);
+    EXPECT_EQ(stats.expected_imu_rate, 100);
+    EXPECT_EQ(stats.imu_jitter.p50, 0u);
+    EXPECT_NEAR(static_cast<double>(stats.imu_jitter.max), 1000000, 40000);
+
+    OpenMetrics metrics;
+    add_metrics(metrics, stats, {{"sensor", "1"}});
+    const std::string text = metrics.str();
+    EXPECT_NE(text.find("ouster_stream_imu_packets_total{sensor=\"1\"} 250"),
+              std::string::npos);
+    EXPECT_NE(text.find("ouster_stream_imu_jitter_seconds"),
+              std::string::npos);
+
+    analyzer.reset();
+    EXPECT_EQ(analyzer.stats().imu_packets, 0u);
+    EXPECT_EQ(analyzer.stats().imu_jitter.count, 0u);
+}
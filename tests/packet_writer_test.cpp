@@ -10,7 +10,9 @@
 #include <algorithm>
 #include <numeric>
 
+#include "ouster/impl/lidar_scan_impl.h"
 #include "ouster/lidar_scan.h"
+#include "ouster/packet_pool.h"
 #include "ouster/pcap.h"
 #include "util.h"
 
@@ -215,6 +217,29 @@ TEST_P(PacketWriterTest, packet_writer_headers_test) {
     }
 }
 
+TEST_P(PacketWriterTest, packet_writer_imu_test) {
+    auto param = GetParam();
+    packet_format pf(std::get<0>(param), std::get<2>(param),
+                     std::get<3>(param));
+    packet_writer pw{pf};
+    std::vector<uint8_t> imu(pf.imu_packet_size);
+
+    pw.set_imu_sys_ts(imu.data(), 111);
+    pw.set_imu_accel_ts(imu.data(), 222);
+    pw.set_imu_gyro_ts(imu.data(), 333);
+    pw.set_imu_la(imu.data(), 0.5f, -0.25f, 1.0f);
+    pw.set_imu_av(imu.data(), 2.0f, 3.0f, -4.0f);
+    EXPECT_EQ(pf.imu_sys_ts(imu.data()), 111u);
+    EXPECT_EQ(pf.imu_accel_ts(imu.data()), 222u);
+    EXPECT_EQ(pf.imu_gyro_ts(imu.data()), 333u);
+    EXPECT_EQ(pf.imu_la_x(imu.data()), 0.5f);
+    EXPECT_EQ(pf.imu_la_y(imu.data()), -0.25f);
+    EXPECT_EQ(pf.imu_la_z(imu.data()), 1.0f);
+    EXPECT_EQ(pf.imu_av_x(imu.data()), 2.0f);
+    EXPECT_EQ(pf.imu_av_y(imu.data()), 3.0f);
+    EXPECT_EQ(pf.imu_av_z(imu.data()), -4.0f);
+}
+
 TEST_P(PacketWriterTest, packet_writer_randomize_test) {
     auto param = GetParam();
     UDPProfileLidar profile = std::get<0>(param);
@@ -312,6 +337,58 @@ TEST_P(PacketWriterTest, packet_writer_randomize_test) {
     ouster::impl::foreach_channel_field(ls2, pf, cmp_field{ls});
 }
 
+TEST_P(PacketWriterTest, scan_to_packets_fused_encoder_test) {
+    auto param = GetParam();
+    UDPProfileLidar profile = std::get<0>(param);
+    size_t columns_per_frame = std::get<1>(param);
+    size_t pixels_per_column = std::get<2>(param);
+    size_t columns_per_packet = std::get<3>(param);
+
+    packet_format pf(profile, pixels_per_column, columns_per_packet);
+    packet_writer pw{pf};
+
+    auto ls = LidarScan(columns_per_frame, pixels_per_column, profile,
+                        columns_per_packet);
+    std::iota(ls.packet_timestamp().data(),
+              ls.packet_timestamp().data() + ls.packet_timestamp().size(), 10);
+    std::iota(ls.timestamp().data(),
+              ls.timestamp().data() + ls.timestamp().size(), 1000);
+    std::fill(ls.status().data(), ls.status().data() + ls.status().size(), 0x1);
+    // a packet with no valid columns is encoded as it has a host timestamp
+    ls.status().segment(0, columns_per_packet).setZero();
+    ls.frame_id = 700;
+    ouster::impl::foreach_channel_field(
+        ls, pf, [&](auto ref_field, const std::string& i) {
+            randomize_field(ref_field, pw.field_value_mask(i), 0xdeadbeef);
+        });
+
+    // fields wider than in packets are written one field at a time instead
+    auto types = ls.field_types();
+    for (auto& ft : types) ft.element_type = ChanFieldType::UINT64;
+    LidarScan ls_wide(ls, types);
+
+    auto fused = std::vector<LidarPacket>{};
+    auto generic = std::vector<LidarPacket>{};
+    ouster::impl::scan_to_packets(ls, pw, std::back_inserter(fused), 7, 42);
+    ouster::impl::scan_to_packets(ls_wide, pw, std::back_inserter(generic), 7,
+                                  42);
+    ASSERT_EQ(fused.size(), generic.size());
+    for (size_t i = 0; i < fused.size(); i++) {
+        EXPECT_EQ(fused[i].buf, generic[i].buf) << "packet " << i;
+    }
+
+    // and into pooled packets
+    PacketPool pool;
+    auto pooled = std::vector<PooledPacket>{};
+    ouster::impl::scan_to_packets(ls, pw, pool, std::back_inserter(pooled), 7,
+                                  42);
+    ASSERT_EQ(pooled.size(), fused.size());
+    for (size_t i = 0; i < pooled.size(); i++) {
+        EXPECT_EQ(pooled[i]->buf, fused[i].buf) << "packet " << i;
+        EXPECT_EQ(pooled[i]->host_timestamp, fused[i].host_timestamp);
+    }
+}
+
 TEST_P(PacketWriterTest, scans_to_packets_skips_dropped_packets_test) {
     auto param = GetParam();
     UDPProfileLidar profile = std::get<0>(param);
@@ -0,0 +1,240 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/parallel_scan_batcher.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ouster/impl/packet_writer.h"
+#include "ouster/lidar_scan.h"
+#include "ouster/types.h"
+#include "util.h"
+
+using namespace ouster;
+using namespace ouster::sensor;
+
+namespace {
+
+sensor_info test_info(UDPProfileLidar profile, size_t w, size_t h) {
+    auto info = default_sensor_info(MODE_1024x10);
+    info.format.udp_profile_lidar = profile;
+    info.format.columns_per_frame = w;
+    info.format.pixels_per_column = h;
+    info.format.columns_per_packet = 16;
+    info.format.column_window = {0, static_cast<int>(w) - 1};
+    info.beam_azimuth_angles.resize(h);
+    info.beam_altitude_angles.resize(h);
+    return info;
+}
+
+std::vector<std::vector<LidarPacket>> random_frames(const sensor_info& info,
+                                                    int n_frames) {
+    sensor::impl::packet_writer pw(info);
+    std::vector<std::vector<LidarPacket>> frames;
+    for (int f = 0; f < n_frames; f++) {
+        LidarScan ls(info);
+        ls.frame_id = 100 + f;
+        std::iota(ls.measurement_id().data(),
+                  ls.measurement_id().data() + ls.measurement_id().size(), 0);
+        std::iota(ls.timestamp().data(),
+                  ls.timestamp().data() + ls.timestamp().size(),
+                  1000 + 100000 * f);
+        std::fill(ls.status().data(), ls.status().data() + ls.status().size(),
+                  0x1);
+        ouster::impl::foreach_channel_field(
+            ls, pw, [&](auto ref_field, const std::string& name) {
+                randomize_field(ref_field, pw.field_value_mask(name));
+            });
+        frames.emplace_back();
+        ouster::impl::scan_to_packets(ls, pw,
+                                      std::back_inserter(frames.back()), 0, 0);
+    }
+    return frames;
+}
+
+struct Recording {
+    std::vector<sensor_info> infos;
+    // packets in capture order with the index of their sensor
+    std::vector<std::pair<size_t, const LidarPacket*>> packets;
+    std::vector<std::vector<std::vector<LidarPacket>>> frames;
+};
+
+// interleave the frames of a few sensors of different sizes and profiles
+Recording test_recording(int n_frames) {
+    Recording rec;
+    rec.infos = {
+        test_info(UDPProfileLidar::PROFILE_RNG19_RFL8_SIG16_NIR16, 512, 32),
+        test_info(UDPProfileLidar::PROFILE_LIDAR_LEGACY, 1024, 16),
+        test_info(UDPProfileLidar::PROFILE_RNG15_RFL8_NIR8, 256, 64)};
+    for (const auto& info : rec.infos) {
+        rec.frames.push_back(random_frames(info, n_frames));
+    }
+
+    std::vector<std::vector<const LidarPacket*>> streams(rec.infos.size());
+    for (size_t s = 0; s < rec.infos.size(); s++) {
+        for (const auto& frame : rec.frames[s]) {
+            for (const auto& p : frame) streams[s].push_back(&p);
+        }
+    }
+    // spread the packets of every sensor evenly over the recording
+    size_t total = 0;
+    for (const auto& s : streams) total += s.size();
+    std::vector<size_t> next(streams.size(), 0);
+    for (size_t i = 0; i < total; i++) {
+        size_t best = streams.size();
+        double best_t = 2.0;
+        for (size_t s = 0; s < streams.size(); s++) {
+            if (next[s] == streams[s].size()) continue;
+            double t = static_cast<double>(next[s]) / streams[s].size();
+            if (t < best_t) {
+                best_t = t;
+                best = s;
+            }
+        }
+        rec.packets.emplace_back(best, streams[best][next[best]++]);
+    }
+    return rec;
+}
+
+std::vector<std::pair<int, std::unique_ptr<LidarScan>>> batch_serially(
+    const Recording& rec) {
+    std::vector<std::pair<int, std::unique_ptr<LidarScan>>> out;
+    std::vector<std::unique_ptr<ScanBatcher>> batchers;
+    std::vector<std::unique_ptr<LidarScan>> scans;
+    for (const auto& info : rec.infos) {
+        batchers.push_back(std::make_unique<ScanBatcher>(info));
+        scans.push_back(std::make_unique<LidarScan>(info));
+    }
+    for (const auto& p : rec.packets) {
+        if ((*batchers[p.first])(*p.second, *scans[p.first])) {
+            out.emplace_back(static_cast<int>(p.first),
+                             std::move(scans[p.first]));
+            scans[p.first] = std::make_unique<LidarScan>(rec.infos[p.first]);
+        }
+    }
+    return out;
+}
+
+}  // namespace
+
+TEST(ParallelScanBatcherTest, MatchesSerialBatching) {
+    auto rec = test_recording(4);
+    auto expected = batch_serially(rec);
+    ASSERT_GE(expected.size(), 9u);
+
+    // small queues so that the producer keeps blocking on full workers
+    ParallelScanBatcher batcher(rec.infos, {}, 8);
+    std::thread producer([&] {
+        for (const auto& p : rec.packets) batcher.push(p.first, *p.second);
+        batcher.finish();
+    });
+
+    size_t i = 0;
+    while (true) {
+        auto result = batcher.pop();
+        if (!result.second) {
+            EXPECT_EQ(result.first, -1);
+            break;
+        }
+        ASSERT_LT(i, expected.size());
+        EXPECT_EQ(result.first, expected[i].first);
+        EXPECT_EQ(*result.second, *expected[i].second);
+        batcher.recycle(result.first, std::move(result.second));
+        i++;
+    }
+    producer.join();
+    EXPECT_EQ(i, expected.size());
+
+    // stays done
+    EXPECT_FALSE(batcher.pop().second);
+    EXPECT_FALSE(batcher.try_pop().second);
+}
+
+TEST(ParallelScanBatcherTest, TryPopFromProducerThread) {
+    auto rec = test_recording(3);
+    auto expected = batch_serially(rec);
+
+    ParallelScanBatcher batcher(rec.infos);
+    std::vector<std::pair<int, std::unique_ptr<LidarScan>>> scans;
+    for (const auto& p : rec.packets) {
+        batcher.push(p.first, *p.second);
+        for (auto r = batcher.try_pop(); r.second; r = batcher.try_pop()) {
+            scans.push_back(std::move(r));
+        }
+    }
+    batcher.finish();
+    for (auto r = batcher.pop(); r.second; r = batcher.pop()) {
+        scans.push_back(std::move(r));
+    }
+
+    ASSERT_EQ(scans.size(), expected.size());
+    for (size_t i = 0; i < scans.size(); i++) {
+        EXPECT_EQ(scans[i].first, expected[i].first);
+        EXPECT_EQ(*scans[i].second, *expected[i].second);
+    }
+}
+
+TEST(ParallelScanBatcherTest, RejectsBadArguments) {
+    auto info = test_info(UDPProfileLidar::PROFILE_LIDAR_LEGACY, 512, 16);
+    EXPECT_THROW(ParallelScanBatcher({info}, {}, 0), std::invalid_argument);
+    EXPECT_THROW(ParallelScanBatcher({info}, {{}, {}}), std::invalid_argument);
+
+    ParallelScanBatcher batcher({info});
+    sensor::impl::packet_writer pw(info);
+    LidarPacket packet(static_cast<int>(pw.lidar_packet_size));
+    EXPECT_THROW(batcher.push(1, packet), std::invalid_argument);
+    EXPECT_THROW(batcher.recycle(-1, nullptr), std::invalid_argument);
+    EXPECT_THROW(batcher.recycle(1, nullptr), std::invalid_argument);
+
+    batcher.finish();
+    EXPECT_THROW(batcher.push(0, packet), std::runtime_error);
+    auto result = batcher.pop();
+    EXPECT_EQ(result.first, -1);
+    EXPECT_FALSE(result.second);
+}
+
+TEST(ParallelScanBatcherTest, DestroyWithQueuedPackets) {
+    auto rec = test_recording(2);
+    ParallelScanBatcher batcher(rec.infos);
+    for (const auto& p : rec.packets) batcher.push(p.first, *p.second);
+    // destructor discards whatever wasn't batched or popped
+}
+
+TEST(ParallelScanBatcherTest, TakeUnfinished) {
+    auto rec = test_recording(3);
+    auto expected = batch_serially(rec);
+
+    ParallelScanBatcher batcher(rec.infos);
+    for (const auto& p : rec.packets) batcher.push(p.first, *p.second);
+    EXPECT_TRUE(batcher.take_unfinished().empty());
+    batcher.finish();
+    size_t popped = 0;
+    for (auto r = batcher.pop(); r.second; r = batcher.pop()) popped++;
+    EXPECT_EQ(popped, expected.size());
+
+    // the last frame of every sensor is never cut by a following packet
+    auto unfinished = batcher.take_unfinished();
+    ASSERT_EQ(unfinished.size(), rec.infos.size());
+    for (size_t i = 0; i < unfinished.size(); i++) {
+        const auto& scan = *unfinished[i].second;
+        EXPECT_EQ(scan.frame_id, 102);
+        if (i > 0) {
+            const auto& prev = *unfinished[i - 1].second;
+            EXPECT_LE(prev.get_first_valid_packet_timestamp(),
+                      scan.get_first_valid_packet_timestamp());
+        }
+        const auto& info = rec.infos[unfinished[i].first];
+        EXPECT_TRUE(scan.complete(info.format.column_window));
+    }
+    EXPECT_TRUE(batcher.take_unfinished().empty());
+}
@@ -7,12 +7,24 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <iterator>
 #include <regex>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 
+#include "ouster/async_pcap_writer.h"
+#include "ouster/bag_reader.h"
+#include "ouster/impl/netcompat.h"
 #include "ouster/indexed_pcap_reader.h"
 #include "ouster/os_pcap.h"
+#include "ouster/packet.h"
+#include "ouster/pcap_replay.h"
 
 namespace ouster {
 namespace sensor_utils {
@@ -116,6 +128,236 @@ TEST(PcapReader, seek_past_end_of_file) {
     EXPECT_EQ(pcap.next_packet(), 0);
 }
 
+namespace {
+
+void append_u32(std::vector<uint8_t>& buf, uint32_t value) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    buf.insert(buf.end(), bytes, bytes + sizeof(value));
+}
+
+void append_block(std::vector<uint8_t>& buf, uint32_t type,
+                  std::vector<uint8_t> body) {
+    body.resize((body.size() + 3) / 4 * 4);
+    const uint32_t length = static_cast<uint32_t>(body.size() + 12);
+    append_u32(buf, type);
+    append_u32(buf, length);
+    buf.insert(buf.end(), body.begin(), body.end());
+    append_u32(buf, length);
+}
+
+/// write the records of a classic pcap as enhanced packet blocks of a pcapng
+void pcap_to_pcapng(const std::string& pcap, const std::string& pcapng) {
+    std::ifstream in(pcap, std::ios::binary);
+    std::vector<uint8_t> bytes{std::istreambuf_iterator<char>(in),
+                               std::istreambuf_iterator<char>()};
+    auto u32 = [&bytes](size_t offset) {
+        uint32_t value;
+        std::memcpy(&value, bytes.data() + offset, sizeof(value));
+        return value;
+    };
+
+    std::vector<uint8_t> out;
+    std::vector<uint8_t> body;
+    append_u32(body, 0x1A2B3C4D);  // byte order magic
+    append_u32(body, 1);           // version 1.0
+    append_u32(body, 0xffffffff);  // unknown section length
+    append_u32(body, 0xffffffff);
+    append_block(out, 0x0A0D0D0A, body);
+    body.clear();
+    append_u32(body, u32(20) & 0xffff);  // link type
+    append_u32(body, u32(16));           // snaplen
+    append_block(out, 1, body);
+    for (size_t offset = 24; offset + 16 <= bytes.size();) {
+        const uint64_t ts = uint64_t{u32(offset)} * 1000000 + u32(offset + 4);
+        const uint32_t incl_len = u32(offset + 8);
+        body.clear();
+        append_u32(body, 0);  // interface
+        append_u32(body, static_cast<uint32_t>(ts >> 32));
+        append_u32(body, static_cast<uint32_t>(ts));
+        append_u32(body, incl_len);
+        append_u32(body, u32(offset + 12));
+        body.insert(body.end(), bytes.begin() + offset + 16,
+                    bytes.begin() + offset + 16 + incl_len);
+        append_block(out, 6, body);
+        offset += 16 + incl_len;
+    }
+    std::ofstream(pcapng, std::ios::binary)
+        .write(reinterpret_cast<const char*>(out.data()), out.size());
+}
+
+}  // namespace
+
+TEST(PcapReader, pcapng) {
+    // it reads the same packets from a pcapng file as from a pcap
+    auto data_dir = getenvs("DATA_DIR");
+    std::string filename = data_dir + "/OS-0-128-U1_v2.3.0_1024x10.pcap";
+    std::string pcapng = ::testing::TempDir() + "pcap_reader.pcapng";
+    pcap_to_pcapng(filename, pcapng);
+
+    PcapReader expected(filename);
+    PcapReader pcap(pcapng);
+    size_t packets = 0;
+    std::vector<uint64_t> offsets;
+    while (expected.next_packet() != 0) {
+        ASSERT_EQ(pcap.next_packet(), expected.current_length());
+        const auto& info = pcap.current_info();
+        EXPECT_EQ(info.dst_port, expected.current_info().dst_port);
+        EXPECT_EQ(info.dst_ip, expected.current_info().dst_ip);
+        EXPECT_EQ(info.timestamp, expected.current_info().timestamp);
+        EXPECT_EQ(std::memcmp(pcap.current_data(), expected.current_data(),
+                              expected.current_length()),
+                  0);
+        offsets.push_back(info.file_offset);
+        ++packets;
+    }
+    EXPECT_GT(packets, 0);
+    EXPECT_EQ(pcap.next_packet(), 0);
+
+    // the offsets of the blocks are seeked to as those of the records
+    pcap.seek(offsets.back());
+    EXPECT_EQ(pcap.next_packet(), expected.current_length());
+    EXPECT_EQ(pcap.current_info().file_offset, offsets.back());
+    std::remove(pcapng.c_str());
+}
+
+TEST(PcapReader, sync) {
+    // it should find the first record at or after any offset
+    auto data_dir = getenvs("DATA_DIR");
+    std::string filename = data_dir + "/OS-1-128_v2.3.0_1024x10_lb_n3.pcap";
+    std::string pcapng = ::testing::TempDir() + "pcap_reader_sync.pcapng";
+    pcap_to_pcapng(filename, pcapng);
+
+    for (const auto& file : {filename, pcapng}) {
+        PcapReader pcap(file);
+        std::vector<uint64_t> offsets;
+        while (pcap.next_packet()) {
+            offsets.push_back(pcap.current_info().file_offset);
+        }
+        ASSERT_GT(offsets.size(), 2u);
+        for (size_t i = 1; i < offsets.size(); ++i) {
+            for (uint64_t offset : {offsets[i - 1] + 1, offsets[i]}) {
+                ASSERT_TRUE(pcap.sync(offset));
+                ASSERT_GT(pcap.next_packet(), 0u);
+                EXPECT_EQ(pcap.current_info().file_offset, offsets[i]);
+            }
+        }
+        EXPECT_FALSE(pcap.sync(offsets.back() + 1));
+    }
+    std::remove(pcapng.c_str());
+}
+
+TEST(PcapReader, get_stream_info_sampled) {
+    // sampling should find the streams, payload sizes and time span of the
+    // whole file
+    auto data_dir = getenvs("DATA_DIR");
+    std::string filename = data_dir + "/OS-1-128_v2.3.0_1024x10_lb_n3.pcap";
+    auto full = get_stream_info(filename);
+
+    stream_sampling sampling;
+    sampling.packets_per_window = 5;
+    sampling.stable_windows = 2;
+    auto sampled = get_stream_info_sampled(filename, sampling);
+    EXPECT_LT(sampled->total_packets, full->total_packets);
+    EXPECT_EQ(sampled->timestamp_min, full->timestamp_min);
+    EXPECT_EQ(sampled->timestamp_max, full->timestamp_max);
+    EXPECT_EQ(sampled->encapsulation_protocol, full->encapsulation_protocol);
+    ASSERT_EQ(sampled->udp_streams.size(), full->udp_streams.size());
+    for (const auto& stream : full->udp_streams) {
+        ASSERT_EQ(sampled->udp_streams.count(stream.first), 1u);
+        const auto& sizes =
+            sampled->udp_streams.at(stream.first).payload_size_counts;
+        for (const auto& size : stream.second.payload_size_counts) {
+            EXPECT_EQ(sizes.count(size.first), 1u);
+        }
+    }
+
+    sampling.windows = 1;
+    EXPECT_THROW(get_stream_info_sampled(filename, sampling),
+                 std::invalid_argument);
+}
+
+TEST(AsyncPcapWriter, writes_packets) {
+    // it should write packets readable as those of PcapWriter, fragmented to
+    // the MTU and split over files by size
+    const std::string file = ::testing::TempDir() + "async_writer.pcap";
+    AsyncPcapWriterOptions options;
+    options.mtu = 1500;
+    options.rotate_bytes = 64 * 1024;
+    std::vector<std::vector<uint8_t>> payloads;
+    std::vector<std::string> files;
+    {
+        AsyncPcapWriter writer(file, options);
+        for (int i = 0; i < 40; ++i) {
+            payloads.emplace_back(i % 2 ? 48 : 8448, static_cast<uint8_t>(i));
+            EXPECT_TRUE(writer.write_packet(
+                payloads.back().data(), payloads.back().size(), "10.0.0.2",
+                "10.0.0.1", 7502 + i % 2, 7502 + i % 2,
+                std::chrono::microseconds(1000000 + i * 100)));
+        }
+        writer.flush();
+        auto stats = writer.stats();
+        EXPECT_EQ(stats.packets, 40u);
+        EXPECT_EQ(stats.dropped, 0u);
+        EXPECT_EQ(stats.write_errors, 0u);
+        // 6 fragments for the large packets
+        EXPECT_EQ(stats.records, 20u * 6 + 20u);
+        writer.close();
+        files = writer.files();
+        EXPECT_GT(files.size(), 1u);
+        EXPECT_EQ(writer.stats().files, files.size());
+        EXPECT_THROW(writer.write_packet(payloads[0].data(), 1, "10.0.0.2",
+                                         "10.0.0.1", 1, 1,
+                                         std::chrono::microseconds(0)),
+                     std::logic_error);
+    }
+    EXPECT_EQ(files[0], file);
+    EXPECT_EQ(files[1], ::testing::TempDir() + "async_writer_1.pcap");
+
+    size_t i = 0;
+    for (const auto& name : files) {
+        std::ifstream in(name, std::ios::binary | std::ios::ate);
+        EXPECT_LE(static_cast<uint64_t>(in.tellg()), options.rotate_bytes);
+        PcapReader pcap(name);
+        while (pcap.next_packet()) {
+            ASSERT_LT(i, payloads.size());
+            const auto& info = pcap.current_info();
+            EXPECT_EQ(info.src_ip, "10.0.0.2");
+            EXPECT_EQ(info.dst_ip, "10.0.0.1");
+            EXPECT_EQ(info.dst_port, 7502 + static_cast<int>(i % 2));
+            EXPECT_EQ(info.timestamp.count(), 1000000 + i * 100);
+            ASSERT_EQ(pcap.current_length(), payloads[i].size());
+            EXPECT_EQ(std::memcmp(pcap.current_data(), payloads[i].data(),
+                                  payloads[i].size()),
+                      0);
+            ++i;
+        }
+        std::remove(name.c_str());
+    }
+    EXPECT_EQ(i, payloads.size());
+}
+
+TEST(AsyncPcapWriter, drops_oldest_when_full) {
+    // writing never waits for the disk, every packet is written or dropped
+    const std::string file = ::testing::TempDir() + "async_writer_full.pcap";
+    AsyncPcapWriterOptions options;
+    options.buffer_packets = 2;
+    options.encap = PcapWriter::SLL;
+    std::vector<uint8_t> payload(8448);
+    AsyncPcapWriter writer(file, options);
+    for (int i = 0; i < 1000; ++i) {
+        writer.write_packet(payload.data(), payload.size(), "10.0.0.2",
+                            "10.0.0.1", 7502, 7502,
+                            std::chrono::microseconds(i));
+    }
+    writer.close();
+    auto stats = writer.stats();
+    EXPECT_EQ(stats.packets + stats.dropped, 1000u);
+    EXPECT_THROW(AsyncPcapWriter(file, AsyncPcapWriterOptions{
+                                           PcapWriter::ETHERNET, 20}),
+                 std::invalid_argument);
+    std::remove(file.c_str());
+}
+
 class TestIndexedPcapReader : public IndexedPcapReader {
    public:
     TestIndexedPcapReader(const std::string& pcap_filename,
@@ -260,5 +502,304 @@ TEST(IndexedPcapReader,
     EXPECT_EQ(pcap.get_index().frame_count(1), 1);
     EXPECT_THROW(pcap.get_index().frame_count(2), std::out_of_range);
 }
+
+TEST(IndexedPcapReader, sidecar_index) {
+    // the saved index is used as it is, or extended if the pcap grew
+    auto data_dir = getenvs("DATA_DIR");
+    std::string filename = data_dir + "/OS-2-128-U1_v2.3.0_1024x10.pcap";
+    std::vector<std::string> metadata{data_dir +
+                                      "/OS-2-128-U1_v2.3.0_1024x10.json"};
+    std::string pcap_copy = ::testing::TempDir() + "sidecar_index.pcap";
+    std::string index_filename = pcap_copy + ".idx";
+    std::remove(index_filename.c_str());
+
+    std::ifstream in(filename, std::ios::binary);
+    std::vector<char> bytes{std::istreambuf_iterator<char>(in),
+                            std::istreambuf_iterator<char>()};
+    // the copy ends in the middle of a packet, as while still recording
+    std::ofstream(pcap_copy, std::ios::binary)
+        .write(bytes.data(), bytes.size() / 2);
+
+    IndexedPcapReader expected(filename, metadata);
+    expected.build_index();
+    {
+        IndexedPcapReader pcap(pcap_copy, metadata);
+        EXPECT_FALSE(pcap.build_index(index_filename));
+    }
+    {
+        IndexedPcapReader pcap(pcap_copy, metadata);
+        EXPECT_TRUE(pcap.build_index(index_filename));
+    }
+
+    std::ofstream(pcap_copy, std::ios::binary | std::ios::app)
+        .write(bytes.data() + bytes.size() / 2,
+               bytes.size() - bytes.size() / 2);
+    IndexedPcapReader pcap(pcap_copy, metadata);
+    EXPECT_TRUE(pcap.build_index(index_filename));
+    EXPECT_EQ(pcap.get_index().frame_indices_,
+              expected.get_index().frame_indices_);
+    EXPECT_EQ(pcap.get_index().frame_id_indices_,
+              expected.get_index().frame_id_indices_);
+
+    // other sensor infos don't use it
+    auto info = ouster::sensor::metadata_from_json(metadata[0]);
+    info.sn += 1;
+    IndexedPcapReader other(pcap_copy,
+                            std::vector<ouster::sensor::sensor_info>{info});
+    EXPECT_FALSE(other.build_index(index_filename));
+
+    std::remove(index_filename.c_str());
+    std::remove(pcap_copy.c_str());
+}
+
+TEST(IndexedPcapReader, build_index_parallel) {
+    // it should build the same index as build_index on a pcap large enough
+    // to be split, made of the records of a test pcap repeated
+    auto data_dir = getenvs("DATA_DIR");
+    std::string filename = data_dir + "/OS-2-128-U1_v2.3.0_1024x10.pcap";
+    std::vector<std::string> metadata{data_dir +
+                                      "/OS-2-128-U1_v2.3.0_1024x10.json"};
+    std::string large_pcap = ::testing::TempDir() + "parallel_index.pcap";
+
+    std::ifstream in(filename, std::ios::binary);
+    std::vector<char> bytes{std::istreambuf_iterator<char>(in),
+                            std::istreambuf_iterator<char>()};
+    const size_t header_size = 24;
+    {
+        std::ofstream out(large_pcap, std::ios::binary);
+        out.write(bytes.data(), header_size);
+        for (size_t written = 0; written < 48 * 1024 * 1024;
+             written += bytes.size() - header_size) {
+            out.write(bytes.data() + header_size, bytes.size() - header_size);
+        }
+    }
+
+    IndexedPcapReader expected(large_pcap, metadata);
+    expected.build_index();
+    IndexedPcapReader pcap(large_pcap, metadata);
+    pcap.build_index_parallel(3);
+    EXPECT_EQ(pcap.get_index().frame_indices_,
+              expected.get_index().frame_indices_);
+    EXPECT_EQ(pcap.get_index().frame_id_indices_,
+              expected.get_index().frame_id_indices_);
+    EXPECT_EQ(pcap.get_index().frame_timestamp_indices_,
+              expected.get_index().frame_timestamp_indices_);
+
+    std::remove(large_pcap.c_str());
+}
+
+TEST(IndexedPcapReader, seek_to_time) {
+    // it should seek to the frame of a sensor at a capture timestamp
+    auto data_dir = getenvs("DATA_DIR");
+    std::string filename = data_dir + "/OS-1-128_v2.3.0_1024x10_lb_n3.pcap";
+    IndexedPcapReader pcap(filename,
+                           std::vector<std::string>{
+                               data_dir + "/OS-1-128_v2.3.0_1024x10.json"});
+    pcap.build_index();
+    const PcapIndex& index = pcap.get_index();
+    ASSERT_EQ(index.frame_count(0), 3);
+    ASSERT_EQ(index.frame_timestamps_[0].size(), 3);
+    ASSERT_EQ(index.frame_ids_[0].size(), 3);
+
+    for (size_t frame = 0; frame < index.frame_count(0); ++frame) {
+        const uint64_t ts = index.frame_timestamps_[0][frame];
+        EXPECT_EQ(pcap.seek_to_time(0, std::chrono::microseconds(ts + 1)),
+                  frame);
+        pcap.next_packet();
+        EXPECT_EQ(pcap.current_info().file_offset,
+                  index.frame_indices_[0][frame]);
+        EXPECT_EQ(pcap.current_info().timestamp.count(),
+                  static_cast<int64_t>(ts));
+        EXPECT_EQ(pcap.current_frame_id(), index.frame_ids_[0][frame]);
+    }
+    EXPECT_EQ(pcap.seek_to_time(0, std::chrono::microseconds(0)), 0);
+    EXPECT_EQ(index.frame_at_timestamp(0, UINT64_MAX), 2);
+    EXPECT_THROW(pcap.seek_to_time(1, std::chrono::microseconds(0)),
+                 std::out_of_range);
+}
+
+TEST(IndexedPcapReader, read_batch) {
+    // it should read the same lidar packets as reading them one by one
+    auto data_dir = getenvs("DATA_DIR");
+    std::string filename = data_dir + "/OS-1-128_v2.3.0_1024x10_lb_n3.pcap";
+    std::vector<std::string> metadata{data_dir +
+                                      "/OS-1-128_v2.3.0_1024x10.json"};
+
+    IndexedPcapReader expected(filename, metadata);
+    std::vector<std::vector<uint8_t>> payloads;
+    std::vector<int64_t> timestamps;
+    while (expected.next_packet()) {
+        if (expected.sensor_idx_for_current_packet()) {
+            payloads.emplace_back(
+                expected.current_data(),
+                expected.current_data() + expected.current_length());
+            timestamps.push_back(expected.current_info().timestamp.count());
+        }
+    }
+    ASSERT_GT(payloads.size(), 7u);
+
+    IndexedPcapReader pcap(filename, metadata);
+    PacketBatch batch;
+    size_t read = 0;
+    while (pcap.read_batch(batch, 7) > 0) {
+        EXPECT_LE(batch.entries.size(), 7u);
+        ASSERT_EQ(batch.formats.size(), 1u);
+        for (const auto& entry : batch.entries) {
+            EXPECT_EQ(entry.sensor_idx, 0);
+            if (entry.type ==
+                static_cast<int32_t>(ouster::sensor::PacketType::Imu)) {
+                continue;
+            }
+            ASSERT_LT(read, payloads.size());
+            EXPECT_EQ(entry.timestamp, timestamps[read] * 1000u);
+            ASSERT_EQ(entry.size, payloads[read].size());
+            EXPECT_TRUE(std::equal(payloads[read].begin(),
+                                   payloads[read].end(),
+                                   batch.data.begin() + entry.offset));
+            read++;
+        }
+    }
+    EXPECT_EQ(read, payloads.size());
+    EXPECT_TRUE(batch.entries.empty());
+    EXPECT_EQ(batch.id_errors, 0u);
+    EXPECT_EQ(batch.size_errors, 0u);
+}
+
+TEST(PcapReplay, replays_stream_paced) {
+    // it should send every packet of the stream of each loop, no faster than
+    // captured at the given speed
+    auto data_dir = getenvs("DATA_DIR");
+    std::string filename = data_dir + "/OS-1-128_v2.3.0_1024x10_lb_n3.pcap";
+
+    size_t expected = 0;
+    std::chrono::microseconds first{0}, last{0};
+    PcapReader pcap(filename);
+    while (pcap.next_packet()) {
+        if (pcap.current_info().dst_port != 7502) continue;
+        if (expected++ == 0) first = pcap.current_info().timestamp;
+        last = pcap.current_info().timestamp;
+    }
+    ASSERT_GT(expected, 0u);
+
+    SOCKET sock = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    ASSERT_EQ(bind(sock, (sockaddr*)&addr, sizeof(addr)), 0);
+    socklen_t len = sizeof(addr);
+    getsockname(sock, (sockaddr*)&addr, &len);
+    sensor::impl::socket_set_non_blocking(sock);
+
+    ReplayOptions options;
+    options.speed = 2.0;
+    options.loops = 2;
+    PcapReplay replay(filename, {{7502, "127.0.0.1", ntohs(addr.sin_port)}},
+                      options);
+    auto start = std::chrono::steady_clock::now();
+    replay.start();
+    EXPECT_THROW(replay.start(), std::logic_error);
+
+    size_t received = 0;
+    std::vector<char> buf(65536);
+    auto drain = [&] {
+        while (recv(sock, buf.data(), buf.size(), 0) > 0) received++;
+    };
+    while (replay.running()) {
+        drain();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    replay.wait();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    drain();
+    sensor::impl::socket_close(sock);
+
+    auto stats = replay.stats();
+    ASSERT_EQ(stats.size(), 1u);
+    EXPECT_EQ(stats[0].packets, 2 * expected);
+    EXPECT_EQ(stats[0].send_errors, 0u);
+    EXPECT_EQ(stats[0].loops, 2u);
+    EXPECT_EQ(received, 2 * expected);
+    // two loops at twice the speed take as long as the capture
+    EXPECT_GE(elapsed, last - first);
+}
+
+TEST(PcapReplay, invalid_streams) {
+    auto data_dir = getenvs("DATA_DIR");
+    std::string filename = data_dir + "/OS-1-128_v2.3.0_1024x10_lb_n3.pcap";
+    EXPECT_THROW(PcapReplay(filename, {}), std::invalid_argument);
+    ReplayOptions options;
+    options.batch_size = 0;
+    EXPECT_THROW(PcapReplay(filename, {{7502, "127.0.0.1", 0}}, options),
+                 std::invalid_argument);
+
+    // none of the packets of the file are sent to the port
+    PcapReplay replay(filename, {{1234, "127.0.0.1", 0}});
+    EXPECT_THROW(replay.start(), std::runtime_error);
+    EXPECT_FALSE(replay.running());
+}
+
+TEST(BagPacketReader, read_batch) {
+    auto data_dir = getenvs("DATA_DIR");
+    const std::string filename = data_dir + "/../bags/512x10_raw.bag";
+    const std::string pcap = data_dir + "/OS-0-128-U1_v2.3.0_1024x10.pcap";
+    ASSERT_TRUE(BagPacketReader::readable(filename));
+    EXPECT_FALSE(BagPacketReader::readable(pcap));
+    EXPECT_THROW(BagPacketReader{pcap}, std::runtime_error);
+
+    BagPacketReader reader(filename);
+    EXPECT_EQ(reader.lidar_topics(),
+              std::vector<std::string>{"/os_node0/lidar_packets"});
+    ASSERT_EQ(reader.sensor_infos().size(), 1u);
+    EXPECT_LT(reader.start_time(), reader.end_time());
+
+    PacketBatch batch;
+    size_t lidar = 0;
+    size_t imu = 0;
+    uint64_t last_ts = 0;
+    std::vector<uint64_t> timestamps;
+    while (reader.read_batch(batch, 16)) {
+        EXPECT_EQ(batch.id_errors, 0u);
+        EXPECT_EQ(batch.size_errors, 0u);
+        ASSERT_EQ(batch.formats.size(), 1u);
+        for (const auto& entry : batch.entries) {
+            EXPECT_EQ(entry.sensor_idx, 0);
+            EXPECT_GE(entry.timestamp, last_ts);
+            EXPECT_GE(entry.timestamp, reader.start_time());
+            EXPECT_LE(entry.timestamp, reader.end_time());
+            last_ts = entry.timestamp;
+            timestamps.push_back(entry.timestamp);
+            if (entry.type == static_cast<int32_t>(sensor::PacketType::Imu)) {
+                EXPECT_EQ(entry.size, batch.formats[0]->imu_packet_size);
+                imu++;
+            } else {
+                EXPECT_EQ(entry.size, batch.formats[0]->lidar_packet_size);
+                lidar++;
+            }
+        }
+    }
+    EXPECT_EQ(lidar, 32u);
+    EXPECT_EQ(imu, 10u);
+
+    // seeking skips the packets recorded before the time
+    const uint64_t middle = timestamps[timestamps.size() / 2];
+    reader.seek_to_time(middle);
+    ASSERT_EQ(reader.read_batch(batch),
+              static_cast<size_t>(std::count_if(
+                  timestamps.begin(), timestamps.end(),
+                  [middle](uint64_t ts) { return ts >= middle; })));
+    EXPECT_EQ(batch.entries.front().timestamp, middle);
+    reader.reset();
+    EXPECT_EQ(reader.read_batch(batch), timestamps.size());
+
+    // the same packets with the sensor infos given, which must be one per
+    // sensor
+    BagPacketReader with_infos(filename, reader.sensor_infos());
+    EXPECT_EQ(with_infos.read_batch(batch), timestamps.size());
+    const auto infos = reader.sensor_infos();
+    EXPECT_THROW(BagPacketReader(filename, {infos[0], infos[0]}),
+                 std::invalid_argument);
+}
 }  // namespace sensor_utils
 }  // namespace ouster
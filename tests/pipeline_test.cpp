@@ -0,0 +1,204 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/pipeline.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ouster/metrics.h"
+
+using namespace ouster;
+
+namespace {
+
+// source of the integers from 0 up to n
+SourceFn<int> count_to(int n) {
+    auto next = std::make_shared<int>(0);
+    return [next, n](int& out) {
+        if (*next == n) return SourceStatus::END;
+        out = (*next)++;
+        return SourceStatus::ITEM;
+    };
+}
+
+}  // namespace
+
+TEST(PipelineTest, runs_typed_stages_in_order) {
+    PipelineOptions options;
+    options.threads = 4;
+    Pipeline pipeline(options);
+    auto ints = pipeline.source<int>("count", count_to(1000));
+    auto evens = pipeline.map<int>(ints, "evens", [](int& in, int& out) {
+        out = in;
+        return in % 2 == 0;
+    });
+    auto strings = pipeline.map<std::string>(
+        evens, "format", [](int& in, std::string& out) {
+            out = std::to_string(in);
+            return true;
+        });
+    std::vector<std::string> got;
+    pipeline.sink(strings, "collect",
+                  [&got](std::string& s) { got.push_back(std::move(s)); });
+    pipeline.start();
+    pipeline.wait();
+
+    ASSERT_EQ(got.size(), 500u);
+    for (size_t i = 0; i < got.size(); i++) {
+        EXPECT_EQ(got[i], std::to_string(2 * i));
+    }
+
+    const auto stats = pipeline.stats();
+    ASSERT_EQ(stats.size(), 4u);
+    EXPECT_EQ(stats[0].name, "count");
+    EXPECT_EQ(stats[0].items_out, 1000u);
+    EXPECT_EQ(stats[1].items_in, 1000u);
+    EXPECT_EQ(stats[1].items_out, 500u);
+    EXPECT_EQ(stats[2].items_out, 500u);
+    EXPECT_EQ(stats[3].name, "collect");
+    EXPECT_EQ(stats[3].items_in, 500u);
+    EXPECT_EQ(stats[3].latency.count, 500u);
+    for (const auto& s : stats) {
+        EXPECT_EQ(s.dropped, 0u);
+        EXPECT_EQ(s.queue_depth, 0u);
+        EXPECT_LE(s.max_queue_depth, StageOptions{}.queue_depth);
+    }
+
+    sensor::OpenMetrics metrics;
+    sensor::add_metrics(metrics, stats);
+    EXPECT_NE(metrics.str().find("ouster_pipeline_items_in_total{stage=\"" +
+                                 std::string("evens") + "\"} 1000"),
+              std::string::npos);
+}
+
+TEST(PipelineTest, fans_out_to_every_consumer) {
+    Pipeline pipeline;
+    auto ints = pipeline.source<int>("count", count_to(200));
+    std::vector<int> a;
+    std::vector<int> b;
+    pipeline.sink(ints, "a", [&a](int& i) { a.push_back(i); });
+    pipeline.sink(ints, "b", [&b](int& i) { b.push_back(i); });
+    pipeline.start();
+    pipeline.wait();
+
+    ASSERT_EQ(a.size(), 200u);
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a.back(), 199);
+    EXPECT_EQ(pipeline.stats()[0].items_out, 200u);
+}
+
+TEST(PipelineTest, applies_backpressure_policies) {
+    const int n = 50;
+    auto slow = [](std::vector<int>& got) {
+        return [&got](int& i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            got.push_back(i);
+        };
+    };
+
+    Pipeline pipeline;
+    auto ints = pipeline.source<int>("count", count_to(n));
+    std::vector<int> latest;
+    std::vector<int> all;
+    pipeline.sink(ints, "latest", slow(latest),
+                  {1, Backpressure::DROP_OLDEST});
+    pipeline.sink(ints, "all", slow(all), {1, Backpressure::BLOCK});
+    pipeline.start();
+    pipeline.wait();
+
+    const auto stats = pipeline.stats();
+    // the blocking sink holds up the source, so the other sink drops little
+    // but always gets the last item
+    ASSERT_FALSE(latest.empty());
+    EXPECT_EQ(latest.back(), n - 1);
+    EXPECT_EQ(latest.size() + stats[1].dropped, static_cast<size_t>(n));
+    ASSERT_EQ(all.size(), static_cast<size_t>(n));
+    for (int i = 0; i < n; i++) EXPECT_EQ(all[i], i);
+    EXPECT_EQ(stats[2].dropped, 0u);
+    EXPECT_GT(stats[0].stalls, 0u);
+    EXPECT_LE(stats[2].max_queue_depth, 1u);
+}
+
+TEST(PipelineTest, drops_newest_items) {
+    const int n = 100;
+    Pipeline pipeline;
+    auto ints = pipeline.source<int>("count", count_to(n));
+    std::vector<int> got;
+    pipeline.sink(
+        ints, "slow",
+        [&got](int& i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            got.push_back(i);
+        },
+        {2, Backpressure::DROP_NEWEST});
+    pipeline.start();
+    pipeline.wait();
+
+    const auto stats = pipeline.stats();
+    EXPECT_GT(stats[1].dropped, 0u);
+    EXPECT_EQ(got.size() + stats[1].dropped, static_cast<size_t>(n));
+    EXPECT_EQ(got.front(), 0);
+    for (size_t i = 1; i < got.size(); i++) EXPECT_GT(got[i], got[i - 1]);
+}
+
+TEST(PipelineTest, rethrows_stage_errors) {
+    Pipeline pipeline;
+    // never ends by itself
+    auto ints = pipeline.source<int>("forever", [](int& out) {
+        out = 1;
+        return SourceStatus::ITEM;
+    });
+    std::atomic<int> seen{0};
+    auto checked = pipeline.map<int>(ints, "fail", [&seen](int& in, int& out) {
+        if (++seen == 10) throw std::runtime_error("stage failed");
+        out = in;
+        return true;
+    });
+    pipeline.sink(checked, "drop", [](int&) {});
+    pipeline.start();
+    EXPECT_THROW(pipeline.wait(), std::runtime_error);
+}
+
+TEST(PipelineTest, stops_sources) {
+    Pipeline pipeline;
+    auto ints = pipeline.source<int>("idle", [](int&) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return SourceStatus::TIMEOUT;
+    });
+    pipeline.sink(ints, "drop", [](int&) {});
+    pipeline.start();
+    EXPECT_FALSE(pipeline.wait_for(0.05));
+    pipeline.stop();
+    EXPECT_TRUE(pipeline.wait_for(5));
+}
+
+TEST(PipelineTest, rejects_bad_graphs) {
+    Pipeline pipeline;
+    auto ptrs = pipeline.source<std::unique_ptr<int>>(
+        "ptrs",
+        [](std::unique_ptr<int>&) { return SourceStatus::END; });
+    pipeline.sink(ptrs, "a", [](std::unique_ptr<int>&) {});
+    // unique pointers can't be copied to a second consumer
+    EXPECT_THROW(pipeline.sink(ptrs, "b", [](std::unique_ptr<int>&) {}),
+                 std::logic_error);
+    EXPECT_THROW(pipeline.sink(Port<int>{}, "c", [](int&) {}),
+                 std::invalid_argument);
+    auto ints = pipeline.source<int>("count", count_to(1));
+    EXPECT_THROW(pipeline.sink(ints, "d", [](int&) {}, {0}),
+                 std::invalid_argument);
+    pipeline.sink(ints, "e", [](int&) {});
+    pipeline.start();
+    EXPECT_THROW(pipeline.start(), std::logic_error);
+    EXPECT_THROW(pipeline.sink(ints, "f", [](int&) {}), std::logic_error);
+    pipeline.wait();
+}
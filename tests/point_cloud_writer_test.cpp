@@ -0,0 +1,154 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/point_cloud_writer.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/types.h"
+#include "util.h"
+
+using namespace ouster;
+
+namespace {
+
+std::string read_file(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary);
+    return {std::istreambuf_iterator<char>(in),
+            std::istreambuf_iterator<char>()};
+}
+
+template <typename T>
+T get(const std::string& bytes, size_t at) {
+    T value;
+    std::memcpy(&value, &bytes[at], sizeof(T));
+    return value;
+}
+
+// sparse scan with a reflectivity of the pixel index
+LidarScan make_scan(const sensor::sensor_info& info) {
+    LidarScan scan = make_sparse_scan(info);
+    auto refl = scan.field<uint8_t>(sensor::ChanField::REFLECTIVITY);
+    for (Eigen::Index i = 0; i < refl.size(); ++i) {
+        refl.data()[i] = i % 256;
+    }
+    return scan;
+}
+
+}  // namespace
+
+TEST(PointCloudWriterTest, PlyOfPointsInOrder) {
+    const std::string file = ::testing::TempDir() + "writer_test.ply";
+    pose_util::Points points(5, 3);
+    Eigen::ArrayXd keys(5);
+    for (int i = 0; i < 5; ++i) {
+        points.row(i) << i, 2 * i, -i;
+        keys(i) = 10 * i;
+    }
+    {
+        PointCloudWriter writer(file, PointCloudFormat::PLY, "intensity",
+                                0.5f, 2);
+        // more blocks than threads keeps them in order
+        for (int i = 0; i < 5; ++i) {
+            writer.write(points.middleRows(i, 1), keys.segment(i, 1));
+        }
+        writer.close();
+        EXPECT_EQ(writer.points_written(), 5u);
+        EXPECT_FALSE(writer.is_open());
+        EXPECT_THROW(writer.write(points, keys), std::runtime_error);
+    }
+
+    const std::string bytes = read_file(file);
+    const std::string header =
+        "ply\nformat binary_little_endian 1.0\nelement vertex 0000000005\n"
+        "property float x\nproperty float y\nproperty float z\n"
+        "property float intensity\nend_header\n";
+    ASSERT_EQ(bytes.size(), header.size() + 5 * 16);
+    EXPECT_EQ(bytes.substr(0, header.size()), header);
+    for (int i = 0; i < 5; ++i) {
+        const size_t at = header.size() + 16 * i;
+        EXPECT_EQ(get<float>(bytes, at), i);
+        EXPECT_EQ(get<float>(bytes, at + 4), 2 * i);
+        EXPECT_EQ(get<float>(bytes, at + 8), -i);
+        EXPECT_EQ(get<float>(bytes, at + 12), 5 * i);
+    }
+    std::remove(file.c_str());
+}
+
+TEST(PointCloudWriterTest, PcdOfScanMatchesCartesian) {
+    const auto info = sensor::default_sensor_info(sensor::MODE_512x10);
+    const auto lut = make_xyz_lut(info, true);
+    LidarScan scan = make_scan(info);
+    const std::string file = ::testing::TempDir() + "writer_test.pcd";
+    const double max_z = 0.5;
+    {
+        PointCloudWriter writer(file, PointCloudFormat::PCD, "reflectivity");
+        writer.write(scan, lut, "REFLECTIVITY", -1e9, max_z);
+        writer.write(scan, lut, "REFLECTIVITY", -1e9, max_z);
+        EXPECT_THROW(writer.write(scan, lut, "NOPE"), std::invalid_argument);
+    }
+
+    // expected points, as the identity poses don't move them
+    const auto xyz = cartesian(scan, lut);
+    const auto refl = scan.field<uint8_t>(sensor::ChanField::REFLECTIVITY);
+    std::vector<Eigen::Index> kept;
+    for (Eigen::Index i = 0; i < xyz.rows(); ++i) {
+        if ((i % 3) && xyz(i, 2) <= max_z) kept.push_back(i);
+    }
+
+    const std::string bytes = read_file(file);
+    const std::string count = std::to_string(2 * kept.size());
+    const std::string padded = std::string(10 - count.size(), '0') + count;
+    EXPECT_NE(bytes.find("WIDTH " + padded + "\n"), std::string::npos);
+    EXPECT_NE(bytes.find("POINTS " + padded + "\n"), std::string::npos);
+    const size_t data = bytes.find("DATA binary\n") + 12;
+    ASSERT_EQ(bytes.size(), data + 2 * kept.size() * 16);
+    for (size_t j = 0; j < kept.size(); ++j) {
+        const Eigen::Index i = kept[j];
+        const size_t at = data + 16 * j;
+        EXPECT_NEAR(get<float>(bytes, at), xyz(i, 0), 1e-4);
+        EXPECT_NEAR(get<float>(bytes, at + 8), xyz(i, 2), 1e-4);
+        EXPECT_EQ(get<float>(bytes, at + 12), refl.data()[i]);
+    }
+    std::remove(file.c_str());
+}
+
+TEST(PointCloudWriterTest, LasHeaderHasCountAndBounds) {
+    const std::string file = ::testing::TempDir() + "writer_test.las";
+    pose_util::Points points(2, 3);
+    points << 1.0, -2.0, 3.0, -4.0, 5.0, 0.25;
+    Eigen::ArrayXd keys(2);
+    keys << 100, 1e6;
+    {
+        PointCloudWriter writer(file, PointCloudFormat::LAS);
+        writer.write(points, keys);
+    }
+
+    const std::string bytes = read_file(file);
+    ASSERT_EQ(bytes.size(), 227u + 2 * 20);
+    EXPECT_EQ(bytes.substr(0, 4), "LASF");
+    EXPECT_EQ(get<uint32_t>(bytes, 96), 227u);
+    EXPECT_EQ(get<uint32_t>(bytes, 107), 2u);
+    EXPECT_EQ(get<double>(bytes, 179), 1.0);   // max x
+    EXPECT_EQ(get<double>(bytes, 187), -4.0);  // min x
+    EXPECT_EQ(get<double>(bytes, 211), 3.0);   // max z
+    EXPECT_EQ(get<double>(bytes, 219), 0.25);  // min z
+    EXPECT_EQ(get<int32_t>(bytes, 227), 1000);
+    EXPECT_EQ(get<int32_t>(bytes, 227 + 8), 3000);
+    EXPECT_EQ(get<uint16_t>(bytes, 227 + 12), 100);
+    EXPECT_EQ(get<int32_t>(bytes, 247 + 4), 5000);
+    // intensities saturate
+    EXPECT_EQ(get<uint16_t>(bytes, 247 + 12), 65535);
+    std::remove(file.c_str());
+}
@@ -2,6 +2,18 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/lidar_scan_viz.h"
+#include "ouster/map_accumulator.h"
+
 using namespace ouster::viz;
 
 TEST(PointViz, window_coordinates_to_world_coordinates) {
@@ -83,3 +95,177 @@ TEST(PointViz, image_pixel_to_window_coordinates) {
     EXPECT_FLOAT_EQ(window_pixel.first, 50);
     EXPECT_FLOAT_EQ(window_pixel.second, 250);
 }
+
+TEST(PointViz, image_set_image_formats) {
+    WindowCtx ctx;
+    ctx.window_width = ctx.viewport_width = 400;
+    ctx.window_height = ctx.viewport_height = 300;
+    Image img;
+
+    constexpr int w = 4;
+    constexpr int h = 3;
+    uint8_t img_u8[w * h * 4] = {};
+    uint16_t img_u16[w * h] = {};
+    EXPECT_THROW(img.set_image(0, h, img_u8), std::invalid_argument);
+    EXPECT_THROW(img.set_image(w, h, static_cast<const uint16_t*>(nullptr)),
+                 std::invalid_argument);
+
+    img.set_position(-1.3333333333, 1.3333333333, -1, 1);
+    img.set_image(w, h, img_u16);
+    EXPECT_EQ(img.window_coordinates_to_image_pixel(ctx, ctx.window_width - 1,
+                                                    ctx.window_height - 1),
+              std::make_pair(3, 2));
+    img.set_image_rgb(w, h, img_u8);
+    EXPECT_EQ(img.window_coordinates_to_image_pixel(ctx, 0, 0),
+              std::make_pair(0, 0));
+    img.set_image_rgba(w, h, img_u8);
+    EXPECT_FLOAT_EQ(img.pixel_size(ctx).first, 100);
+}
+
+TEST(PointViz, cloud_set_range_columns) {
+    constexpr size_t w = 8;
+    constexpr size_t h = 4;
+    std::vector<float> dir(3 * w * h, 1.0f);
+    std::vector<float> off(3 * w * h, 0.0f);
+    Cloud cloud(w, h, dir.data(), off.data());
+
+    std::vector<uint32_t> range(w * h, 7);
+    std::vector<float> key(w * h, 0.5f);
+    EXPECT_NO_THROW(cloud.set_range(range.data(), 2, 3));
+    EXPECT_NO_THROW(cloud.set_range(range.data(), 0, w));
+    EXPECT_NO_THROW(cloud.set_key(key.data(), w - 1, 1));
+    EXPECT_THROW(cloud.set_range(range.data(), 6, 3), std::invalid_argument);
+    EXPECT_THROW(cloud.set_key(key.data(), w + 1, 0), std::invalid_argument);
+}
+
+TEST(PointViz, lod_cloud_add_points) {
+    LodCloud cloud(1.0f);
+    EXPECT_EQ(cloud.get_size(), 0u);
+
+    std::vector<float> xyz = {0.5f,  0.5f, 0.5f, 10.0f, -3.0f, 2.0f,
+                              NAN,   0.0f, 0.0f, 1e30f, 0.0f,  0.0f,
+                              -0.5f, 0.0f, 0.0f};
+    cloud.add_points(xyz.data(), nullptr, xyz.size() / 3);
+    // points without a position or too far for the grid are skipped
+    EXPECT_EQ(cloud.get_size(), 3u);
+
+    cloud.clear_points();
+    EXPECT_EQ(cloud.get_size(), 0u);
+
+    EXPECT_THROW(LodCloud(0.0f), std::invalid_argument);
+    EXPECT_THROW(LodCloud(-1.0f), std::invalid_argument);
+}
+
+TEST(PointViz, map_accumulator_update) {
+    using ouster::LidarScan;
+    namespace sensor = ouster::sensor;
+    auto info = sensor::default_sensor_info(sensor::MODE_512x10);
+    const auto w = info.format.columns_per_frame;
+    const auto h = info.format.pixels_per_column;
+    LidarScan scan(info);
+    auto range = scan.field<uint32_t>(sensor::ChanField::RANGE);
+    range = 10000;
+    range.row(0) = 0;
+
+    MapAccumulatorConfig config;
+    config.select_ratio = 1.0;
+    config.max_points = 1000;
+    MapAccumulator acc({info}, config);
+    acc.update(0, scan);
+    // a full map ignores the points of new scans
+    EXPECT_EQ(acc.size(), 1000u);
+    EXPECT_EQ(acc.cloud()->get_size(), 1000u);
+    acc.update(0, scan);
+    EXPECT_EQ(acc.size(), 1000u);
+
+    acc.clear();
+    EXPECT_EQ(acc.size(), 0u);
+    EXPECT_EQ(acc.cloud()->get_size(), 0u);
+
+    // at most one point per voxel, the points lie on a 10 m sphere
+    config.max_points = 0;
+    config.voxel_size = 100.0f;
+    MapAccumulator voxels({info}, config);
+    voxels.update(0, scan);
+    EXPECT_LE(voxels.size(), 8u);
+    EXPECT_GT(voxels.size(), 0u);
+    const auto n = voxels.size();
+    voxels.update(0, scan);
+    EXPECT_EQ(voxels.size(), n);
+
+    // old scans are dropped to make room for new ones
+    config.voxel_size = 0.0f;
+    config.max_points = 1000;
+    config.overflow_from_start = true;
+    MapAccumulator rolling({info}, config);
+    for (int i = 0; i < 3; i++) rolling.update(0, scan);
+    EXPECT_LE(rolling.size(), 1000u);
+    EXPECT_GT(rolling.size(), 0u);
+
+    std::map<std::string, ouster::img_t<float>> keys;
+    keys["RANGE"] = ouster::img_t<float>::Constant(h, w, 0.5f);
+    acc.set_key_name("RANGE");
+    EXPECT_EQ(acc.key_name(), "RANGE");
+    acc.update(0, scan, keys);
+    EXPECT_EQ(acc.size(), 1000u);
+
+    keys["RANGE"].resize(h, w - 1);
+    EXPECT_THROW(acc.update(0, scan, keys), std::invalid_argument);
+    EXPECT_THROW(acc.update(1, scan), std::invalid_argument);
+    config.select_ratio = 0.0;
+    EXPECT_THROW(MapAccumulator({info}, config), std::invalid_argument);
+}
+
+TEST(PointViz, lidar_scan_viz_update) {
+    using ouster::LidarScan;
+    namespace sensor = ouster::sensor;
+    auto info = sensor::default_sensor_info(sensor::MODE_512x10);
+    auto scan = std::make_shared<LidarScan>(info);
+    scan->field<uint32_t>(sensor::ChanField::RANGE) = 10000;
+    scan->field<uint16_t>(sensor::ChanField::NEAR_IR) = 100;
+
+    FieldViewMode mode;
+    ASSERT_TRUE(default_view_mode(info, *scan, "NEAR_IR", mode));
+    EXPECT_TRUE(mode.beam_uniformity);
+    EXPECT_TRUE(mode.auto_exposure);
+    EXPECT_FALSE(default_view_mode(info, *scan, "FLAGS", mode));
+    EXPECT_FALSE(default_view_mode(info, *scan, "RANGE2", mode));
+    EXPECT_FALSE(default_view_mode(info, *scan, "NOPE", mode));
+
+    LidarScanViz model({info, info});
+    EXPECT_EQ(model.sensor_count(), 2u);
+    EXPECT_EQ(model.cloud(1, 1)->get_cols(), info.format.columns_per_frame);
+    EXPECT_NE(model.image(1, 1), nullptr);
+    EXPECT_EQ(model.cloud_mode(), "REFLECTIVITY");
+    EXPECT_FALSE(model.apply());
+
+    // modes are created for the fields of the scans as they arrive
+    model.update({scan, nullptr});
+    const auto modes = model.cloud_modes();
+    EXPECT_NE(std::find(modes.begin(), modes.end(), "NEAR_IR"), modes.end());
+    EXPECT_EQ(std::find(modes.begin(), modes.end(), "FLAGS"), modes.end());
+    EXPECT_FALSE(model.apply());
+
+    mode.name = "NEAR_IR_RAW";
+    mode.beam_uniformity = false;
+    mode.gpu_keys = true;
+    model.add_mode(mode);
+    model.set_cloud_mode("NEAR_IR_RAW");
+    model.set_image_mode(1, "RANGE");
+    EXPECT_EQ(model.image_mode(1), "RANGE");
+    for (int i = 0; i < 5; i++) model.submit({scan, scan});
+    EXPECT_TRUE(model.wait(5));
+    EXPECT_TRUE(model.apply());
+
+    const auto stats = model.stats();
+    EXPECT_EQ(stats.submitted, 6u);
+    EXPECT_EQ(stats.computed + stats.skipped, 12u);
+    EXPECT_EQ(stats.applied, 4u);
+    EXPECT_EQ(stats.compute.count, stats.computed);
+
+    EXPECT_THROW(model.submit({scan}), std::invalid_argument);
+    EXPECT_THROW(model.cloud(2, 0), std::out_of_range);
+    EXPECT_THROW(model.image(0, 2), std::out_of_range);
+    EXPECT_THROW(model.set_image_mode(2, "RANGE"), std::out_of_range);
+    EXPECT_THROW(model.add_mode(FieldViewMode{}), std::invalid_argument);
+}
@@ -0,0 +1,186 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/impl/profile_parser.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "ouster/impl/packet_writer.h"
+#include "ouster/impl/profile_extension.h"
+#include "ouster/lidar_scan.h"
+
+using namespace ouster;
+using namespace ouster::sensor;
+
+namespace {
+
+template <int BlockDim>
+struct parse_generic {
+    template <typename T>
+    void operator()(Eigen::Ref<img_t<T>> field, const std::string& f,
+                    const packet_format& pf, const uint8_t* packet_buf) const {
+        pf.block_field<T, BlockDim>(field, f, packet_buf);
+    }
+};
+
+struct count_mismatches {
+    template <typename T>
+    void operator()(Eigen::Ref<img_t<T>> field, const std::string& f,
+                    const LidarScan& expected, int& mismatches) const {
+        if (!(expected.field<T>(f) == field).all()) mismatches++;
+    }
+};
+
+}  // namespace
+
+class ProfileParserTest : public ::testing::TestWithParam<UDPProfileLidar> {};
+
+TEST_P(ProfileParserTest, matches_generic_block_field) {
+    const UDPProfileLidar profile = GetParam();
+    for (int columns_per_packet : {16, 8, 4}) {
+        packet_format pf(profile, 128, columns_per_packet);
+        auto parser = sensor::impl::make_profile_parser(pf);
+        ASSERT_TRUE(parser);
+
+        // random channel data with a contiguous block of measurement ids
+        std::vector<uint8_t> buf(pf.lidar_packet_size);
+        std::mt19937 g(0xdeadbeef);
+        for (auto& b : buf) b = static_cast<uint8_t>(g());
+        sensor::impl::packet_writer pw{pf};
+        for (int icol = 0; icol < columns_per_packet; icol++) {
+            pw.set_col_measurement_id(pw.nth_col(icol, buf.data()), 32 + icol);
+        }
+
+        LidarScan expected(1024, 128, profile, columns_per_packet);
+        LidarScan ls(1024, 128, profile, columns_per_packet);
+        switch (pf.block_parsable()) {
+            case 16:
+                ouster::impl::foreach_channel_field(
+                    expected, pf, parse_generic<16>{}, pf, buf.data());
+                break;
+            case 8:
+                ouster::impl::foreach_channel_field(
+                    expected, pf, parse_generic<8>{}, pf, buf.data());
+                break;
+            default:
+                ouster::impl::foreach_channel_field(
+                    expected, pf, parse_generic<4>{}, pf, buf.data());
+        }
+        parser->parse_block(buf.data(), ls);
+
+        int mismatches = 0;
+        ouster::impl::foreach_channel_field(ls, pf, count_mismatches{},
+                                            expected, mismatches);
+        EXPECT_EQ(mismatches, 0) << "columns_per_packet " << columns_per_packet;
+    }
+}
+
+// clang-format off
+INSTANTIATE_TEST_CASE_P(
+    ProfileParsers,
+    ProfileParserTest,
+    ::testing::Values(UDPProfileLidar::PROFILE_LIDAR_LEGACY,
+                      UDPProfileLidar::PROFILE_RNG19_RFL8_SIG16_NIR16_DUAL,
+                      UDPProfileLidar::PROFILE_RNG19_RFL8_SIG16_NIR16,
+                      UDPProfileLidar::PROFILE_RNG15_RFL8_NIR8,
+                      UDPProfileLidar::PROFILE_FIVE_WORD_PIXEL,
+                      UDPProfileLidar::PROFILE_FUSA_RNG15_RFL8_NIR8_DUAL));
+// clang-format on
+
+TEST_P(ProfileParserTest, custom_field_types_match_generic_block_field) {
+    const UDPProfileLidar profile = GetParam();
+    packet_format pf(profile, 128, 16);
+    auto parser = sensor::impl::make_profile_parser(pf);
+    ASSERT_TRUE(parser);
+
+    std::vector<uint8_t> buf(pf.lidar_packet_size);
+    std::mt19937 g(0xbeef);
+    for (auto& b : buf) b = static_cast<uint8_t>(g());
+    sensor::impl::packet_writer pw{pf};
+    for (int icol = 0; icol < 16; icol++) {
+        pw.set_col_measurement_id(pw.nth_col(icol, buf.data()), 16 * 5 + icol);
+    }
+
+    // wider destinations than the profile defaults skip the fused decoder
+    std::vector<FieldType> types;
+    for (const auto& f : pf) {
+        types.emplace_back(f.first, ChanFieldType::UINT64);
+    }
+    LidarScan expected(1024, 128, types.begin(), types.end(), 16);
+    LidarScan ls(1024, 128, types.begin(), types.end(), 16);
+    ouster::impl::foreach_channel_field(expected, pf, parse_generic<16>{}, pf,
+                                        buf.data());
+    parser->parse_block(buf.data(), ls);
+
+    int mismatches = 0;
+    ouster::impl::foreach_channel_field(ls, pf, count_mismatches{}, expected,
+                                        mismatches);
+    EXPECT_EQ(mismatches, 0);
+    for (int icol = 0; icol < 16; icol++) {
+        const uint8_t* col_buf = pf.nth_col(icol, buf.data());
+        EXPECT_EQ(ls.timestamp()[80 + icol], pf.col_timestamp(col_buf));
+        EXPECT_EQ(ls.status()[80 + icol], pf.col_status(col_buf));
+        EXPECT_EQ(ls.measurement_id()[80 + icol], 80 + icol);
+    }
+}
+
+TEST(ProfileParserCustomTest, custom_profile_matches_generic_block_field) {
+    // shifts within a byte, whole bytes of shift moved into the offset, an
+    // upshift, a shift without a compiled in kernel and a 64 bit field
+    const int profile_nr = 170;
+    add_custom_profile(profile_nr, "PARSER_TEST_CUSTOM",
+                       {{"within", {ChanFieldType::UINT8, 0, 0xf8, 3}},
+                        {"bytes", {ChanFieldType::UINT16, 0, 0xfff000, 12}},
+                        {"upshift", {ChanFieldType::UINT32, 3, 0x7fff, -3}},
+                        {"any", {ChanFieldType::UINT16, 4, 0x0ffff1, 20}},
+                        {"wide", {ChanFieldType::UINT64, 8, 0, 0}}},
+                       16);
+    const auto profile = static_cast<UDPProfileLidar>(profile_nr);
+    for (int columns_per_packet : {16, 8, 4}) {
+        packet_format pf(profile, 64, columns_per_packet);
+        auto parser = sensor::impl::make_profile_parser(pf);
+        ASSERT_TRUE(parser);
+
+        std::vector<uint8_t> buf(pf.lidar_packet_size);
+        std::mt19937 g(0xcafe);
+        for (auto& b : buf) b = static_cast<uint8_t>(g());
+        sensor::impl::packet_writer pw{pf};
+        for (int icol = 0; icol < columns_per_packet; icol++) {
+            pw.set_col_measurement_id(pw.nth_col(icol, buf.data()), 64 + icol);
+        }
+
+        LidarScan expected(512, 64, profile, columns_per_packet);
+        LidarScan ls(512, 64, profile, columns_per_packet);
+        switch (pf.block_parsable()) {
+            case 16:
+                ouster::impl::foreach_channel_field(
+                    expected, pf, parse_generic<16>{}, pf, buf.data());
+                break;
+            case 8:
+                ouster::impl::foreach_channel_field(
+                    expected, pf, parse_generic<8>{}, pf, buf.data());
+                break;
+            default:
+                ouster::impl::foreach_channel_field(
+                    expected, pf, parse_generic<4>{}, pf, buf.data());
+        }
+        parser->parse_block(buf.data(), ls);
+
+        int mismatches = 0;
+        ouster::impl::foreach_channel_field(ls, pf, count_mismatches{},
+                                            expected, mismatches);
+        EXPECT_EQ(mismatches, 0) << "columns_per_packet " << columns_per_packet;
+        EXPECT_GT(ls.field<uint64_t>("wide").maxCoeff(), 0u);
+    }
+}
+
+TEST(ProfileParserFallbackTest, unparsable_blocks_use_generic_path) {
+    // 10 columns per packet can't be parsed by blocks
+    packet_format pf(UDPProfileLidar::PROFILE_RNG19_RFL8_SIG16_NIR16, 128, 10);
+    EXPECT_FALSE(sensor::impl::make_profile_parser(pf));
+}
@@ -0,0 +1,157 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/range_image.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/types.h"
+
+using namespace ouster;
+
+namespace {
+
+img_t<uint32_t> random_image(Eigen::Index h, Eigen::Index w) {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<uint32_t> dist(0, 20);
+    img_t<uint32_t> img(h, w);
+    for (Eigen::Index i = 0; i < img.size(); ++i) {
+        const uint32_t v = dist(rng);
+        img.data()[i] = v < 5 ? 0 : v;
+    }
+    return img;
+}
+
+// values of a window, cut at the rows and wrapped or cut at the columns
+std::vector<uint32_t> window(const img_t<uint32_t>& img, Eigen::Index r,
+                             Eigen::Index c, int rows, int cols,
+                             bool ignore_zeros, bool wrap) {
+    std::vector<uint32_t> values;
+    const Eigen::Index h = img.rows(), w = img.cols();
+    for (Eigen::Index s = r - rows / 2; s <= r + rows / 2; ++s) {
+        for (Eigen::Index d = c - cols / 2; d <= c + cols / 2; ++d) {
+            if (s < 0 || s >= h) continue;
+            if (!wrap && (d < 0 || d >= w)) continue;
+            const uint32_t v = img(s, (d + w) % w);
+            if (ignore_zeros && v == 0) continue;
+            values.push_back(v);
+        }
+    }
+    return values;
+}
+
+}  // namespace
+
+TEST(RangeImageTest, FiltersMatchBruteForce) {
+    const img_t<uint32_t> img = random_image(9, 12);
+    for (bool ignore_zeros : {false, true}) {
+        for (bool wrap : {false, true}) {
+            const auto mins = min_filter<uint32_t>(img, 3, 5, ignore_zeros,
+                                                   wrap);
+            const auto maxs = max_filter<uint32_t>(img, 3, 5, ignore_zeros,
+                                                   wrap);
+            const auto medians = median_filter<uint32_t>(img, 5, 3,
+                                                         ignore_zeros, wrap);
+            for (Eigen::Index r = 0; r < img.rows(); ++r) {
+                for (Eigen::Index c = 0; c < img.cols(); ++c) {
+                    auto values = window(img, r, c, 3, 5, ignore_zeros, wrap);
+                    const uint32_t lo =
+                        values.empty()
+                            ? 0
+                            : *std::min_element(values.begin(), values.end());
+                    const uint32_t hi =
+                        values.empty()
+                            ? 0
+                            : *std::max_element(values.begin(), values.end());
+                    EXPECT_EQ(mins(r, c), lo);
+                    EXPECT_EQ(maxs(r, c), hi);
+
+                    values = window(img, r, c, 5, 3, ignore_zeros, wrap);
+                    std::sort(values.begin(), values.end());
+                    const uint32_t median =
+                        values.empty() ? 0 : values[(values.size() - 1) / 2];
+                    EXPECT_EQ(medians(r, c), median);
+                }
+            }
+        }
+    }
+    EXPECT_THROW(min_filter<uint32_t>(img, 2, 3), std::invalid_argument);
+    EXPECT_THROW(median_filter<uint32_t>(img, 3, 0), std::invalid_argument);
+}
+
+TEST(RangeImageTest, FloatFilterIgnoresZeros) {
+    img_t<float> img = img_t<float>::Zero(3, 4);
+    img(1, 1) = -2.5f;
+    img(1, 2) = 4.0f;
+    const auto mins = min_filter<float>(img, 1, 3, true, false);
+    const auto maxs = max_filter<float>(img, 1, 3, true, false);
+    EXPECT_EQ(mins(1, 0), -2.5f);
+    EXPECT_EQ(mins(1, 3), 4.0f);
+    EXPECT_EQ(maxs(1, 1), 4.0f);
+    EXPECT_EQ(mins(0, 0), 0.0f);
+    EXPECT_EQ(maxs(2, 3), 0.0f);
+}
+
+TEST(RangeImageTest, NormalsOfGroundPlane) {
+    const auto info = sensor::default_sensor_info(sensor::MODE_512x10);
+    const auto lut = make_xyz_lut(info, false);
+    LidarScan scan(info);
+    auto range = scan.field<uint32_t>(sensor::ChanField::RANGE);
+
+    // ranges of the downward beams that hit the plane z = -1
+    const double ground = -1.0;
+    for (Eigen::Index i = 0; i < range.size(); ++i) {
+        const double dz = lut.direction(i, 2);
+        const double r = (ground - lut.offset(i, 2)) / dz;
+        range.data()[i] =
+            (dz < 0 && r < 20000) ? static_cast<uint32_t>(std::lround(r)) : 0;
+    }
+
+    const auto normals = range_image_normals(scan, lut, 5);
+    size_t checked = 0;
+    for (Eigen::Index i = 0; i < range.size(); ++i) {
+        if (range.data()[i] == 0) {
+            EXPECT_EQ(normals.row(i).matrix().norm(), 0.0);
+            continue;
+        }
+        if (normals.row(i).matrix().norm() == 0) continue;
+        EXPECT_NEAR(normals(i, 2), 1.0, 1e-3);
+        ++checked;
+    }
+    EXPECT_GT(checked, static_cast<size_t>(range.size() / 4));
+    EXPECT_THROW(range_image_normals(scan, lut, 4), std::invalid_argument);
+}
+
+TEST(RangeImageTest, ConnectedComponents) {
+    img_t<uint32_t> range(3, 6);
+    // clang-format off
+    range << 100, 105,   0, 300, 300, 100,
+             100,   0,   0, 300, 500, 100,
+               0,   0, 700,   0,   0, 100;
+    // clang-format on
+    const auto wrapped = connected_components(range, 10);
+    img_t<uint32_t> expected(3, 6);
+    // clang-format off
+    expected << 1, 1, 0, 2, 2, 1,
+                1, 0, 0, 2, 3, 1,
+                0, 0, 4, 0, 0, 1;
+    // clang-format on
+    EXPECT_TRUE((wrapped == expected).all());
+
+    const auto cut = connected_components(range, 10, false);
+    // clang-format off
+    expected << 1, 1, 0, 2, 2, 3,
+                1, 0, 0, 2, 4, 3,
+                0, 0, 5, 0, 0, 3;
+    // clang-format on
+    EXPECT_TRUE((cut == expected).all());
+}
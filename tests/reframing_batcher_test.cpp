@@ -0,0 +1,193 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/reframing_batcher.h"
+
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "ouster/impl/packet_writer.h"
+#include "ouster/lidar_scan.h"
+#include "ouster/types.h"
+#include "util.h"
+
+using namespace ouster;
+using namespace ouster::sensor;
+
+namespace {
+
+constexpr size_t W = 256;
+constexpr uint64_t col_dt = 1000;
+
+sensor_info test_info() {
+    auto info = default_sensor_info(MODE_1024x10);
+    info.format.udp_profile_lidar =
+        UDPProfileLidar::PROFILE_RNG19_RFL8_SIG16_NIR16;
+    info.format.columns_per_frame = W;
+    info.format.pixels_per_column = 32;
+    info.format.columns_per_packet = 16;
+    info.format.column_window = {0, static_cast<int>(W) - 1};
+    info.beam_azimuth_angles.resize(32);
+    info.beam_altitude_angles.resize(32);
+    return info;
+}
+
+// frames of random data whose columns are col_dt apart
+std::vector<LidarScan> random_scans(const sensor_info& info, int n) {
+    sensor::impl::packet_writer pw(info);
+    std::vector<LidarScan> scans;
+    for (int f = 0; f < n; f++) {
+        LidarScan ls(info);
+        ls.frame_id = 100 + f;
+        std::iota(ls.measurement_id().data(),
+                  ls.measurement_id().data() + W, 0);
+        for (size_t v = 0; v < W; v++)
+            ls.timestamp()[v] = (f * W + v + 1) * col_dt;
+        ls.status().setConstant(0x1);
+        ouster::impl::foreach_channel_field(
+            ls, pw, [&](auto ref_field, const std::string& name) {
+                randomize_field(ref_field, pw.field_value_mask(name));
+            });
+        scans.push_back(std::move(ls));
+    }
+    return scans;
+}
+
+std::vector<LidarPacket> to_packets(const sensor_info& info,
+                                    const std::vector<LidarScan>& scans) {
+    sensor::impl::packet_writer pw(info);
+    std::vector<LidarPacket> packets;
+    for (const auto& ls : scans)
+        ouster::impl::scan_to_packets(ls, pw, std::back_inserter(packets), 0,
+                                      0);
+    return packets;
+}
+
+std::vector<LidarScan> reframe(ReframingBatcher& batch,
+                               const sensor_info& info,
+                               const std::vector<LidarPacket>& packets) {
+    std::vector<LidarScan> res;
+    LidarScan ls(batch.scan_width(), info.format.pixels_per_column,
+                 info.format.udp_profile_lidar,
+                 info.format.columns_per_packet);
+    for (const auto& p : packets) {
+        if (batch(p, ls)) res.push_back(ls);
+    }
+    if (batch.finish_scan(ls)) res.push_back(ls);
+    return res;
+}
+
+// check column out of scan against column in of a frame
+void expect_column(const LidarScan& scan, size_t out, const LidarScan& frame,
+                   size_t in) {
+    EXPECT_EQ(scan.timestamp()[out], frame.timestamp()[in]);
+    EXPECT_EQ(scan.measurement_id()[out], in);
+    const auto& a = scan.field<uint32_t>(ChanField::RANGE);
+    const auto& b = frame.field<uint32_t>(ChanField::RANGE);
+    EXPECT_TRUE((a.col(out) == b.col(in)).all());
+    const auto& c = scan.field<uint16_t>(ChanField::SIGNAL);
+    const auto& d = frame.field<uint16_t>(ChanField::SIGNAL);
+    EXPECT_TRUE((c.col(out) == d.col(in)).all());
+}
+
+}  // namespace
+
+TEST(ReframingBatcherTest, StartsScansAtColumn) {
+    const auto info = test_info();
+    const auto frames = random_scans(info, 3);
+    ReframingBatcher batch(info, {0, 96});
+    const auto scans = reframe(batch, info, to_packets(info, frames));
+
+    // the first and last scans are partial
+    ASSERT_EQ(scans.size(), 4u);
+    for (size_t v = 0; v < 96; v++) {
+        expect_column(scans[0], W - 96 + v, frames[0], v);
+    }
+    EXPECT_EQ(scans[0].timestamp()[0], 0u);
+    for (size_t k = 1; k < 3; k++) {
+        EXPECT_EQ(scans[k].frame_id, frames[k - 1].frame_id);
+        for (size_t v = 0; v < W; v++) {
+            const size_t in = (96 + v) % W;
+            expect_column(scans[k], v, frames[k - 1 + (96 + v) / W], in);
+        }
+    }
+    EXPECT_EQ(scans[3].timestamp()[W - 96 - 1], frames[2].timestamp()[W - 1]);
+    EXPECT_EQ(scans[3].timestamp()[W - 96], 0u);
+    EXPECT_EQ(batch.dropped_columns(), 0u);
+}
+
+TEST(ReframingBatcherTest, BatchesNarrowAndWideWindows) {
+    const auto info = test_info();
+    const auto frames = random_scans(info, 2);
+    const auto packets = to_packets(info, frames);
+
+    ReframingBatcher narrow(info, {64, 32});
+    const auto small = reframe(narrow, info, packets);
+    ASSERT_EQ(small.size(), 9u);
+    for (size_t k = 1; k < 8; k++) {
+        const size_t col = 32 + (k - 1) * 64;
+        ASSERT_EQ(small[k].w, 64u);
+        expect_column(small[k], 0, frames[col / W], col % W);
+        expect_column(small[k], 63, frames[(col + 63) / W], (col + 63) % W);
+    }
+
+    ReframingBatcher wide(info, {2 * W, 0});
+    const auto large = reframe(wide, info, packets);
+    ASSERT_EQ(large.size(), 1u);
+    expect_column(large[0], 10, frames[0], 10);
+    expect_column(large[0], W + 10, frames[1], 10);
+}
+
+TEST(ReframingBatcherTest, StartsScansAtTimes) {
+    const auto info = test_info();
+    const auto frames = random_scans(info, 3);
+    const auto packets = to_packets(info, frames);
+
+    // windows of a frame period starting at column 96 of each frame
+    ReframeWindow window;
+    window.period_ns = W * col_dt;
+    window.offset_ns = 97 * col_dt;
+    ReframingBatcher by_time(info, window);
+    ReframingBatcher by_col(info, {0, 96});
+    const auto a = reframe(by_time, info, packets);
+    const auto b = reframe(by_col, info, packets);
+
+    // the first scan by time starts at its first column instead
+    ASSERT_EQ(a.size(), b.size());
+    for (size_t k = 1; k < a.size(); k++) {
+        EXPECT_TRUE((a[k].timestamp() == b[k].timestamp()).all());
+        EXPECT_TRUE((a[k].field<uint32_t>(ChanField::RANGE) ==
+                     b[k].field<uint32_t>(ChanField::RANGE))
+                        .all());
+    }
+}
+
+TEST(ReframingBatcherTest, DropsLateColumns) {
+    const auto info = test_info();
+    const auto frames = random_scans(info, 2);
+    auto packets = to_packets(info, frames);
+    // a packet of the first frame after the second frame
+    packets.push_back(packets[3]);
+
+    ReframingBatcher batch(info);
+    const auto scans = reframe(batch, info, packets);
+    ASSERT_EQ(scans.size(), 2u);
+    EXPECT_EQ(batch.dropped_columns(), info.format.columns_per_packet);
+    expect_column(scans[1], 48, frames[1], 48);
+}
+
+TEST(ReframingBatcherTest, RejectsBadWindows) {
+    const auto info = test_info();
+    EXPECT_THROW(ReframingBatcher(info, {40, 0}), std::invalid_argument);
+    EXPECT_THROW(ReframingBatcher(info, {0, W}), std::invalid_argument);
+
+    ReframingBatcher batch(info, {128, 0});
+    LidarScan ls(info);
+    const auto packets = to_packets(info, random_scans(info, 1));
+    EXPECT_THROW(batch(packets[0], ls), std::invalid_argument);
+}
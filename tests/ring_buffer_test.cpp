@@ -0,0 +1,94 @@
+/**
+ * Copyright(c) 2024, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/impl/ring_buffer.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+using ouster::sensor::impl::DropOldestRingBuffer;
+
+TEST(DropOldestRingBufferTest, PushPop) {
+    DropOldestRingBuffer<int> rb(3);
+    EXPECT_EQ(rb.capacity(), 3u);
+    EXPECT_TRUE(rb.empty());
+
+    EXPECT_EQ(rb.push([](int& v) { v = 1; }), 0u);
+    EXPECT_EQ(rb.push([](int& v) { v = 2; }), 0u);
+    EXPECT_EQ(rb.size(), 2u);
+
+    int out = 0;
+    EXPECT_TRUE(rb.pop([&](int& v) { out = v; }));
+    EXPECT_EQ(out, 1);
+    EXPECT_TRUE(rb.pop([&](int& v) { out = v; }));
+    EXPECT_EQ(out, 2);
+    EXPECT_FALSE(rb.pop([&](int& v) { out = v; }));
+    EXPECT_TRUE(rb.empty());
+}
+
+TEST(DropOldestRingBufferTest, DropsOldestWhenFull) {
+    DropOldestRingBuffer<int> rb(2);
+    for (int i = 0; i < 5; i++) {
+        size_t dropped = rb.push([i](int& v) { v = i; });
+        EXPECT_EQ(dropped, i < 2 ? 0u : 1u);
+    }
+    EXPECT_EQ(rb.size(), 2u);
+
+    int out = 0;
+    EXPECT_TRUE(rb.pop([&](int& v) { out = v; }));
+    EXPECT_EQ(out, 3);
+    EXPECT_TRUE(rb.pop([&](int& v) { out = v; }));
+    EXPECT_EQ(out, 4);
+}
+
+TEST(DropOldestRingBufferTest, Flush) {
+    DropOldestRingBuffer<int> rb(4);
+    rb.push([](int& v) { v = 1; });
+    rb.push([](int& v) { v = 2; });
+    EXPECT_EQ(rb.flush(), 2u);
+    EXPECT_TRUE(rb.empty());
+    rb.push([](int& v) { v = 3; });
+    int out = 0;
+    EXPECT_TRUE(rb.pop([&](int& v) { out = v; }));
+    EXPECT_EQ(out, 3);
+}
+
+TEST(DropOldestRingBufferTest, SwapsReuseSlots) {
+    DropOldestRingBuffer<std::vector<uint8_t>> rb(2, std::vector<uint8_t>(8));
+    std::vector<uint8_t> data(8, 7);
+    rb.push([&](std::vector<uint8_t>& v) { std::swap(v, data); });
+    // producer got the slot's previous buffer back
+    EXPECT_EQ(data.size(), 8u);
+    std::vector<uint8_t> out;
+    EXPECT_TRUE(rb.pop([&](std::vector<uint8_t>& v) { std::swap(v, out); }));
+    EXPECT_EQ(out, std::vector<uint8_t>(8, 7));
+}
+
+TEST(DropOldestRingBufferTest, ProducerConsumerOrdering) {
+    const uint64_t n = 100000;
+    DropOldestRingBuffer<uint64_t> rb(64);
+    uint64_t dropped = 0;
+    std::thread producer([&]() {
+        for (uint64_t i = 1; i <= n; i++) {
+            dropped += rb.push([i](uint64_t& v) { v = i; });
+        }
+    });
+
+    uint64_t last = 0;
+    uint64_t received = 0;
+    bool ordered = true;
+    while (last < n) {
+        rb.pop([&](uint64_t& v) {
+            ordered = ordered && v > last;
+            last = v;
+            received++;
+        });
+    }
+    producer.join();
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(received + dropped + rb.size(), n);
+}
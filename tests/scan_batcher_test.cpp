@@ -774,3 +774,345 @@ TEST(ScanBatcherTest, cached_packet_test) {
     // check scan gets fully batched
     EXPECT_EQ(ls, ref_second);
 }
+
+TEST_P(ScanBatcherTest, scan_batcher_sector_stream_test) {
+    auto param = GetParam();
+    UDPProfileLidar profile = std::get<0>(param);
+    size_t columns_per_frame = std::get<1>(param);
+    size_t pixels_per_column = std::get<2>(param);
+    size_t columns_per_packet = std::get<3>(param);
+
+    auto packets = random_frame(profile, columns_per_frame, pixels_per_column,
+                                columns_per_packet);
+    packet_format pf(profile, pixels_per_column, columns_per_packet);
+
+    auto reference = LidarScan(columns_per_frame, pixels_per_column, profile,
+                               columns_per_packet);
+    {
+        ScanBatcher batcher(columns_per_frame, pf);
+        for (const auto& p : packets) batcher(p, reference);
+    }
+
+    const Eigen::Index n_points = columns_per_frame * pixels_per_column;
+    XYZLut lut{LidarScan::Points::Random(n_points, 3),
+               LidarScan::Points::Random(n_points, 3)};
+    const LidarScan::Points ref_points = cartesian(reference, lut);
+
+    // a width that doesn't divide the scan nor line up with packets
+    const size_t sector_cols = 300;
+    auto ls = LidarScan(columns_per_frame, pixels_per_column, profile,
+                        columns_per_packet);
+    ScanBatcher batcher(columns_per_frame, pf);
+    EXPECT_THROW(batcher.set_sector_callback(0, [](const ScanSector&) {}),
+                 std::invalid_argument);
+
+    size_t packets_batched = 0;
+    std::vector<std::pair<size_t, size_t>> sectors;
+    batcher.set_sector_callback(sector_cols, [&](const ScanSector& sector) {
+        sectors.push_back({sector.start_col, sector.end_col});
+        ASSERT_EQ(sector.scan, &ls);
+        // handed out as soon as the packets covering it are batched
+        const size_t needed =
+            (sector.end_col + columns_per_packet - 1) / columns_per_packet;
+        EXPECT_EQ(packets_batched, needed);
+
+        const auto range = sector.field<uint32_t>(ChanField::RANGE);
+        ASSERT_EQ(range.rows(), static_cast<Eigen::Index>(pixels_per_column));
+        ASSERT_EQ(range.cols(), static_cast<Eigen::Index>(sector.width()));
+        EXPECT_TRUE((range == reference.field<uint32_t>(ChanField::RANGE)
+                                 .middleCols(sector.start_col, sector.width()))
+                        .all());
+        EXPECT_TRUE((sector.timestamp() ==
+                     reference.timestamp().segment(sector.start_col,
+                                                   sector.width()))
+                        .all());
+        EXPECT_TRUE((sector.measurement_id() ==
+                     reference.measurement_id().segment(sector.start_col,
+                                                        sector.width()))
+                        .all());
+
+        const auto points = cartesian(sector, lut);
+        const auto slice = sector.lut(lut);
+        const img_t<uint32_t> range_copy = range;
+        const auto sliced_points = cartesian(range_copy, slice);
+        ASSERT_EQ(points.rows(), static_cast<Eigen::Index>(
+                                     sector.width() * pixels_per_column));
+        for (size_t row = 0; row < pixels_per_column; row++) {
+            for (size_t col = 0; col < sector.width(); col++) {
+                const size_t i = row * sector.width() + col;
+                const size_t j =
+                    row * columns_per_frame + sector.start_col + col;
+                EXPECT_TRUE(points.row(i).isApprox(ref_points.row(j)));
+                EXPECT_TRUE(points.row(i).isApprox(sliced_points.row(i)));
+            }
+        }
+    });
+
+    for (size_t i = 0; i < packets.size(); i++) {
+        packets_batched = i + 1;
+        EXPECT_EQ(batcher(packets[i], ls), i == packets.size() - 1);
+    }
+
+    // every column exactly once, the last sector narrower
+    ASSERT_EQ(sectors.size(),
+              (columns_per_frame + sector_cols - 1) / sector_cols);
+    for (size_t i = 0; i < sectors.size(); i++) {
+        EXPECT_EQ(sectors[i].first, i * sector_cols);
+        EXPECT_EQ(sectors[i].second,
+                  std::min((i + 1) * sector_cols, columns_per_frame));
+    }
+    EXPECT_EQ(ls, reference);
+}
+
+TEST_P(ScanBatcherTest, scan_batcher_deferred_decode_test) {
+    auto param = GetParam();
+    UDPProfileLidar profile = std::get<0>(param);
+    size_t columns_per_frame = std::get<1>(param);
+    size_t pixels_per_column = std::get<2>(param);
+    size_t columns_per_packet = std::get<3>(param);
+
+    auto packets = random_frame(profile, columns_per_frame, pixels_per_column,
+                                columns_per_packet);
+    packet_format pf(profile, pixels_per_column, columns_per_packet);
+    packet_writer pw(profile, pixels_per_column, columns_per_packet);
+
+    // drop and reorder some packets and invalidate some columns, so that both
+    // the block and column parsing paths are replayed
+    packets.erase(packets.begin() + packets.size() / 2);
+    std::swap(packets[3], packets[5]);
+    for (size_t icol = 0; icol < columns_per_packet; icol += 3) {
+        pw.set_col_status(pw.nth_col(icol, packets[10].buf.data()), 0);
+    }
+
+    auto batch = [&](bool deferred, size_t n_packets, LidarScan& ls) {
+        ScanBatcher batcher(columns_per_frame, pf);
+        batcher.set_deferred_decode(deferred);
+        for (size_t i = 0; i < n_packets; i++) batcher(packets[i], ls);
+    };
+    auto make_scan = [&] {
+        return LidarScan(columns_per_frame, pixels_per_column, profile,
+                         columns_per_packet);
+    };
+
+    auto reference = make_scan();
+    batch(false, packets.size(), reference);
+
+    auto ls = make_scan();
+    batch(true, packets.size(), ls);
+    for (const auto& ft : pf) {
+        EXPECT_EQ(ls.is_deferred(ft.first), ls.has_field(ft.first));
+    }
+    // headers are batched as usual
+    EXPECT_TRUE((ls.timestamp() == reference.timestamp()).all());
+    EXPECT_TRUE((ls.status() == reference.status()).all());
+    EXPECT_EQ(ls.field_types(), reference.field_types());
+
+    // only the accessed field gets decoded
+    EXPECT_TRUE((ls.field<uint32_t>(ChanField::RANGE) ==
+                 reference.field<uint32_t>(ChanField::RANGE))
+                    .all());
+    EXPECT_FALSE(ls.is_deferred(ChanField::RANGE));
+    for (const auto& ft : pf) {
+        if (ft.first != ChanField::RANGE) {
+            EXPECT_EQ(ls.is_deferred(ft.first), ls.has_field(ft.first));
+        }
+    }
+    EXPECT_EQ(ls, reference);
+    for (const auto& ft : pf) {
+        EXPECT_FALSE(ls.is_deferred(ft.first));
+    }
+
+    // a copy taken while batching keeps the packets it had
+    auto half_reference = make_scan();
+    batch(false, packets.size() / 2, half_reference);
+    auto partial = make_scan();
+    LidarScan half;
+    {
+        ScanBatcher batcher(columns_per_frame, pf);
+        batcher.set_deferred_decode(true);
+        for (size_t i = 0; i < packets.size(); i++) {
+            if (i == packets.size() / 2) half = partial;
+            batcher(packets[i], partial);
+        }
+    }
+    EXPECT_EQ(half, half_reference);
+    EXPECT_EQ(partial, reference);
+
+    // reusing a scan that still has deferred fields for an eager batch
+    auto reused = make_scan();
+    batch(true, packets.size(), reused);
+    reused.frame_id = -1;
+    batch(false, packets.size(), reused);
+    for (const auto& ft : pf) {
+        EXPECT_FALSE(reused.is_deferred(ft.first));
+    }
+    EXPECT_EQ(reused, reference);
+}
+
+TEST_P(ScanBatcherTest, scan_batcher_region_test) {
+    auto param = GetParam();
+    UDPProfileLidar profile = std::get<0>(param);
+    size_t columns_per_frame = std::get<1>(param);
+    size_t pixels_per_column = std::get<2>(param);
+    size_t columns_per_packet = std::get<3>(param);
+
+    auto packets = random_frame(profile, columns_per_frame, pixels_per_column,
+                                columns_per_packet);
+    packet_format pf(profile, pixels_per_column, columns_per_packet);
+    packet_writer pw(profile, pixels_per_column, columns_per_packet);
+
+    auto reference = LidarScan(columns_per_frame, pixels_per_column, profile,
+                               columns_per_packet);
+    {
+        ScanBatcher batcher(columns_per_frame, pf);
+        for (const auto& p : packets) batcher(p, reference);
+    }
+
+    auto check_region = [&](size_t start, size_t end,
+                            const std::vector<size_t>& beams,
+                            ScanBatcher& batcher) {
+        ASSERT_EQ(batcher.scan_width(), end - start);
+        ASSERT_EQ(batcher.scan_height(), beams.size());
+        auto ls = LidarScan(batcher.scan_width(), batcher.scan_height(),
+                            profile, columns_per_packet);
+
+        // complete as soon as the last packet of the region is batched
+        const size_t last_packet = (end - 1) / columns_per_packet;
+        for (size_t i = 0; i < packets.size(); i++) {
+            ASSERT_EQ(batcher(packets[i], ls), i == last_packet);
+            if (i == last_packet) break;
+        }
+
+        const auto cols = static_cast<Eigen::Index>(end - start);
+        EXPECT_TRUE((ls.timestamp() ==
+                     reference.timestamp().segment(start, cols))
+                        .all());
+        EXPECT_TRUE((ls.measurement_id() ==
+                     reference.measurement_id().segment(start, cols))
+                        .all());
+        EXPECT_TRUE(
+            (ls.status() == reference.status().segment(start, cols)).all());
+        const auto first_packet = start / columns_per_packet;
+        EXPECT_TRUE((ls.packet_timestamp() ==
+                     reference.packet_timestamp().segment(
+                         first_packet, ls.packet_timestamp().rows()))
+                        .all());
+
+        ouster::impl::foreach_channel_field(
+            ls, pw, [&](auto field, const std::string& name) {
+                using T = typename std::decay_t<decltype(field)>::Scalar;
+                auto ref = reference.field<T>(name);
+                for (size_t i = 0; i < beams.size(); i++) {
+                    EXPECT_TRUE(
+                        (field.row(i) == ref.row(beams[i]).segment(start, cols))
+                            .all())
+                        << name << " row " << i;
+                }
+            });
+    };
+
+    std::vector<size_t> every_other;
+    for (size_t i = 0; i < pixels_per_column; i += 2) every_other.push_back(i);
+
+    // unaligned narrow window, every other beam
+    ScanBatcher batcher(columns_per_frame, pf);
+    batcher.set_region(100, 400, 2);
+    check_region(100, 400, every_other, batcher);
+
+    // aligned columns, beams in any order
+    ScanBatcher listed(columns_per_frame, pf);
+    listed.set_region(columns_per_packet * 2, columns_per_packet * 5,
+                      std::vector<size_t>{5, 1, pixels_per_column - 1});
+    check_region(columns_per_packet * 2, columns_per_packet * 5,
+                 {5, 1, pixels_per_column - 1}, listed);
+
+    // the whole frame with a stride of one batches like no region
+    ScanBatcher full(columns_per_frame, pf);
+    full.set_region(0, columns_per_frame);
+    EXPECT_EQ(full.scan_height(), pixels_per_column);
+    auto ls = LidarScan(columns_per_frame, pixels_per_column, profile,
+                        columns_per_packet);
+    for (const auto& p : packets) full(p, ls);
+    EXPECT_EQ(ls, reference);
+
+    EXPECT_THROW(batcher.set_region(10, 10), std::invalid_argument);
+    EXPECT_THROW(batcher.set_region(0, columns_per_frame + 1),
+                 std::invalid_argument);
+    EXPECT_THROW(batcher.set_region(0, 16, 0), std::invalid_argument);
+    EXPECT_THROW(
+        batcher.set_region(0, 16, std::vector<size_t>{pixels_per_column}),
+        std::invalid_argument);
+    // scans must have the dimensions of the region
+    EXPECT_THROW(batcher(packets[0], ls), std::invalid_argument);
+}
+
+TEST_P(ScanBatcherTest, scan_batcher_packet_validation_test) {
+    auto param = GetParam();
+    UDPProfileLidar profile = std::get<0>(param);
+    size_t columns_per_frame = std::get<1>(param);
+    size_t pixels_per_column = std::get<2>(param);
+    size_t columns_per_packet = std::get<3>(param);
+
+    auto packets = random_frame(profile, columns_per_frame, pixels_per_column,
+                                columns_per_packet);
+    packet_format pf(profile, pixels_per_column, columns_per_packet);
+    const bool has_crc = static_cast<bool>(pf.crc(packets[0].buf.data()));
+
+    // the table driven CRC matches a bitwise ECMA-182 CRC64
+    for (const auto& p : packets) {
+        uint64_t crc = ~0ull;
+        for (size_t i = 0; i + 8 < p.buf.size(); i++) {
+            crc ^= p.buf[i];
+            for (int b = 0; b < 8; b++)
+                crc = (crc >> 1) ^ (0xC96C5795D7870F42ull & (0 - (crc & 1)));
+        }
+        ASSERT_EQ(pf.calculate_crc(p.buf.data()), ~crc);
+        if (has_crc) ASSERT_EQ(*pf.crc(p.buf.data()), ~crc);
+    }
+
+    // corrupt a packet; ids and size stay valid
+    auto corrupted = packets;
+    corrupted[3].buf[pf.packet_header_size + 100] ^= 0xFF;
+    corrupted.push_back(packets[5]);
+    corrupted.back().buf.resize(pf.lidar_packet_size - 1);
+
+    sensor_info info;
+    std::vector<uint64_t> valid;
+    EXPECT_EQ(validate_lidar_packets(info, pf, corrupted.data(),
+                                     corrupted.size(), valid, true),
+              corrupted.size() - (has_crc ? 2 : 1));
+    ASSERT_EQ(valid.size(), (corrupted.size() + 63) / 64);
+    for (size_t i = 0; i < corrupted.size(); i++) {
+        const bool expected =
+            i != corrupted.size() - 1 && !(has_crc && i == 3);
+        EXPECT_EQ(static_cast<bool>(valid[i / 64] >> (i % 64) & 1), expected)
+            << "packet " << i;
+    }
+
+    // mismatched ids, for profiles that carry them
+    info.init_id = pf.init_id(packets[0].buf.data()) + 1;
+    EXPECT_EQ(validate_lidar_packets(info, pf, packets.data(), packets.size(),
+                                     valid),
+              pf.init_id(packets[0].buf.data()) ? 0 : packets.size());
+
+    // the batcher drops the invalid packets
+    auto make_scan = [&] {
+        return LidarScan(columns_per_frame, pixels_per_column, profile,
+                         columns_per_packet);
+    };
+    auto reference = make_scan();
+    {
+        ScanBatcher batcher(columns_per_frame, pf);
+        for (size_t i = 0; i + 1 < corrupted.size(); i++) {
+            if (has_crc && i == 3) continue;
+            batcher(corrupted[i], reference);
+        }
+    }
+    auto ls = make_scan();
+    {
+        ScanBatcher batcher(columns_per_frame, pf);
+        batcher.set_packet_validation(true, true);
+        for (const auto& p : corrupted) batcher(p, ls);
+    }
+    EXPECT_EQ(ls, reference);
+}
@@ -0,0 +1,81 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/scan_collator.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+
+using namespace ouster;
+
+namespace {
+
+std::unique_ptr<LidarScan> scan_at(uint64_t ts, int64_t frame_id = 0) {
+    auto scan = std::make_unique<LidarScan>(32, 4);
+    scan->status().setConstant(1);
+    scan->packet_timestamp().setConstant(ts);
+    scan->frame_id = frame_id;
+    return scan;
+}
+
+// frame ids of the scans of a frame, -1 for missing ones
+std::vector<int64_t> ids(const ScanCollator::Frame& frame) {
+    std::vector<int64_t> result;
+    for (const auto& scan : frame) result.push_back(scan ? scan->frame_id : -1);
+    return result;
+}
+
+}  // namespace
+
+TEST(ScanCollatorTest, CutsFrames) {
+    const int64_t dt = 100;
+    ScanCollator collator(3, dt);
+    EXPECT_EQ(collator.sensors_count(), 3u);
+
+    // one scan of every sensor
+    collator.push(0, scan_at(1000, 1));
+    collator.push(2, scan_at(1010, 2));
+    EXPECT_FALSE(collator.ready());
+    collator.push(1, scan_at(1020, 3));
+    ASSERT_TRUE(collator.ready());
+    EXPECT_EQ(ids(collator.pop()), (std::vector<int64_t>{1, 3, 2}));
+    EXPECT_FALSE(collator.ready());
+
+    // a second scan of the same sensor
+    collator.push(0, scan_at(1030, 4));
+    collator.push(1, scan_at(1040, 5));
+    collator.push(0, scan_at(1050, 6));
+    ASSERT_TRUE(collator.ready());
+    EXPECT_EQ(ids(collator.pop()), (std::vector<int64_t>{4, 5, -1}));
+
+    // scans too far apart, later and earlier
+    collator.push(1, scan_at(1050 + dt, 7));
+    ASSERT_TRUE(collator.ready());
+    EXPECT_EQ(ids(collator.pop()), (std::vector<int64_t>{6, -1, -1}));
+    collator.push(2, scan_at(1049, 8));
+    ASSERT_TRUE(collator.ready());
+    EXPECT_EQ(ids(collator.pop()), (std::vector<int64_t>{-1, 7, -1}));
+
+    // the last partial frame only comes out on flush
+    EXPECT_FALSE(collator.ready());
+    collator.flush();
+    ASSERT_TRUE(collator.ready());
+    EXPECT_EQ(ids(collator.pop()), (std::vector<int64_t>{-1, -1, 8}));
+    collator.flush();
+    EXPECT_FALSE(collator.ready());
+    EXPECT_THROW(collator.pop(), std::runtime_error);
+}
+
+TEST(ScanCollatorTest, RejectsBadArguments) {
+    EXPECT_THROW(ScanCollator(0), std::invalid_argument);
+    ScanCollator collator(2);
+    EXPECT_THROW(collator.push(2, scan_at(0)), std::invalid_argument);
+    EXPECT_THROW(collator.push(0, nullptr), std::invalid_argument);
+}
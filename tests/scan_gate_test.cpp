@@ -0,0 +1,150 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/scan_gate.h"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <vector>
+
+#include "ouster/imu_batcher.h"
+#include "ouster/imu_preintegrator.h"
+#include "ouster/lidar_scan.h"
+
+using namespace ouster;
+
+namespace {
+
+constexpr uint64_t t0 = 1000000000;
+constexpr uint64_t frame_dt = 100000000;  // 10 Hz
+
+// scan of a wall 5 m away, 32 x 16 pixels, starting at frame n
+LidarScan make_scan(int64_t n, size_t w = 32) {
+    LidarScan scan(w, 16);
+    scan.frame_id = n;
+    for (size_t v = 0; v < scan.w; v++) {
+        scan.timestamp()[v] = t0 + n * frame_dt + v * 1000;
+        scan.status()[v] = 1;
+    }
+    scan.field<uint32_t>(sensor::ChanField::RANGE).setConstant(5000);
+    return scan;
+}
+
+ImuBatch make_imu(const LidarScan& scan, double gyro_z) {
+    ImuBatcher batcher;
+    const uint64_t ts = scan.get_first_valid_column_timestamp();
+    for (uint64_t i = 0; i < 4; i++) {
+        batcher.add(ImuSample{
+            ts + i * 5000, Eigen::Vector3d(0, 0, ImuPreintegrator::gravity),
+            Eigen::Vector3d(0, 0, gyro_z)});
+    }
+    ImuBatch batch;
+    batcher.batch(scan, batch);
+    return batch;
+}
+
+ScanGateOptions test_options() {
+    ScanGateOptions options;
+    options.stride = 4;
+    options.keyframe_interval = 0.5;
+    return options;
+}
+
+}  // namespace
+
+TEST(ScanGateTest, SkipsStaticScenesKeepingKeyframes) {
+    ScanGate gate(test_options());
+    std::vector<int64_t> kept;
+    for (int64_t n = 0; n < 12; n++) {
+        if (gate.admit(make_scan(n))) kept.push_back(n);
+    }
+    // the first scan, then one every half a second
+    EXPECT_EQ(kept, (std::vector<int64_t>{0, 5, 10}));
+    EXPECT_EQ(gate.kept(), 3u);
+    EXPECT_EQ(gate.skipped(), 9u);
+    EXPECT_DOUBLE_EQ(gate.last_change(), 0.0);
+
+    ASSERT_EQ(gate.skipped_spans().size(), 3u);
+    const SkippedSpan& first = gate.skipped_spans()[0];
+    EXPECT_EQ(first.first_frame_id, 1);
+    EXPECT_EQ(first.last_frame_id, 4);
+    EXPECT_EQ(first.count, 4u);
+    EXPECT_EQ(first.first_ts, t0 + frame_dt);
+    EXPECT_EQ(first.last_ts, t0 + 4 * frame_dt);
+    EXPECT_EQ(gate.skipped_spans()[2].first_frame_id, 11);
+    EXPECT_EQ(gate.skipped_spans()[2].count, 1u);
+
+    gate.reset();
+    EXPECT_EQ(gate.kept(), 0u);
+    EXPECT_TRUE(gate.skipped_spans().empty());
+    EXPECT_TRUE(gate.admit(make_scan(12)));
+}
+
+TEST(ScanGateTest, KeepsChangedScans) {
+    ScanGate gate(test_options());
+    ASSERT_TRUE(gate.admit(make_scan(0)));
+
+    // noise below the range threshold is left out
+    LidarScan noisy = make_scan(1);
+    noisy.field<uint32_t>(sensor::ChanField::RANGE).array() += 50;
+    EXPECT_FALSE(gate.admit(noisy));
+
+    // a person walking through a few sampled pixels
+    LidarScan walker = make_scan(2);
+    auto range = walker.field<uint32_t>(sensor::ChanField::RANGE);
+    range.block(4, 8, 4, 1).setConstant(2000);
+    EXPECT_TRUE(gate.admit(walker));
+    EXPECT_DOUBLE_EQ(gate.last_change(), 1.0 / 32);
+
+    // compared against the last scan kept, so the walker staying still is
+    // left out while its leaving is kept
+    EXPECT_FALSE(gate.admit(walker));
+    EXPECT_TRUE(gate.admit(make_scan(4)));
+
+    // returns appearing or vanishing count as changes
+    LidarScan dropped = make_scan(5);
+    dropped.field<uint32_t>(sensor::ChanField::RANGE).row(0).setZero();
+    EXPECT_TRUE(gate.admit(dropped));
+}
+
+TEST(ScanGateTest, KeepsScansWhileMoving) {
+    ScanGate gate(test_options());
+    ASSERT_TRUE(gate.admit(make_scan(0)));
+
+    const LidarScan still = make_scan(1);
+    const ImuBatch resting = make_imu(still, 0.0);
+    ASSERT_GT(resting.size(), 0u);
+    EXPECT_FALSE(gate.admit(still, &resting));
+
+    const LidarScan turning = make_scan(2);
+    const ImuBatch yaw = make_imu(turning, 0.2);
+    EXPECT_TRUE(gate.admit(turning, &yaw));
+}
+
+TEST(ScanGateTest, KeepsIncomparableScans) {
+    ScanGate gate(test_options());
+    ASSERT_TRUE(gate.admit(make_scan(0)));
+    // another size
+    EXPECT_TRUE(gate.admit(make_scan(1, 64)));
+    // going back in time
+    EXPECT_TRUE(gate.admit(make_scan(0, 64)));
+    // without ranges, nor anything to compare the next scan against
+    const LidarScanFieldTypes none;
+    LidarScan empty(64, 16, none.begin(), none.end());
+    empty.frame_id = 2;
+    EXPECT_TRUE(gate.admit(empty));
+    EXPECT_TRUE(gate.admit(make_scan(3, 64)));
+    EXPECT_EQ(gate.skipped(), 0u);
+}
+
+TEST(ScanGateTest, RejectsBadOptions) {
+    ScanGateOptions options;
+    options.stride = 0;
+    EXPECT_THROW(ScanGate{options}, std::invalid_argument);
+    options = ScanGateOptions{};
+    options.keyframe_interval = -1;
+    EXPECT_THROW(ScanGate{options}, std::invalid_argument);
+}
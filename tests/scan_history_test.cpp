@@ -0,0 +1,139 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/scan_history.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "ouster/types.h"
+
+using namespace ouster;
+using ouster::sensor::UDPProfileLidar;
+
+namespace {
+
+const size_t w = 64;
+const size_t h = 16;
+
+const auto profile = UDPProfileLidar::PROFILE_RNG19_RFL8_SIG16_NIR16;
+
+// scan whose columns from the second one on are valid, the first of them
+// taken at ts
+std::unique_ptr<LidarScan> make_scan(uint64_t ts) {
+    std::unique_ptr<LidarScan> scan(new LidarScan(w, h, profile));
+    for (size_t col = 1; col < w; col++) {
+        scan->status()[col] = 1;
+        scan->timestamp()[col] = ts + (col - 1) * 1000;
+    }
+    scan->frame_id = static_cast<int64_t>(ts);
+    return scan;
+}
+
+}  // namespace
+
+TEST(ScanHistoryTest, keeps_latest_scans) {
+    ScanHistory history(3);
+    EXPECT_EQ(history.capacity(), 3u);
+    EXPECT_EQ(history.back(), nullptr);
+    for (uint64_t ts = 100; ts <= 500; ts += 100) {
+        EXPECT_TRUE(history.push(make_scan(ts)));
+    }
+    EXPECT_EQ(history.size(), 3u);
+    EXPECT_EQ(history.back()->frame_id, 500);
+    EXPECT_EQ(history.back(2)->frame_id, 300);
+    EXPECT_EQ(history.back(3), nullptr);
+
+    auto latest = history.latest(2);
+    ASSERT_EQ(latest.size(), 2u);
+    EXPECT_EQ(latest[0]->frame_id, 400);
+    EXPECT_EQ(latest[1]->frame_id, 500);
+    EXPECT_EQ(history.latest(10).size(), 3u);
+
+    // handles outlive the history dropping their scans
+    auto oldest = history.back(2);
+    history.clear();
+    EXPECT_EQ(history.size(), 0u);
+    EXPECT_EQ(oldest->frame_id, 300);
+}
+
+TEST(ScanHistoryTest, looks_up_by_time) {
+    ScanHistory history(4);
+    EXPECT_EQ(history.nearest(10), nullptr);
+    for (uint64_t ts : {100, 200, 200, 400, 700}) {
+        EXPECT_TRUE(history.push(make_scan(ts)));
+    }
+    // 100 was dropped
+    EXPECT_EQ(history.at_time(199), nullptr);
+    EXPECT_EQ(history.at_time(200)->frame_id, 200);
+    EXPECT_EQ(history.at_time(200), history.back(2));
+    EXPECT_EQ(history.at_time(699)->frame_id, 400);
+    EXPECT_EQ(history.at_time(5000)->frame_id, 700);
+
+    EXPECT_EQ(history.nearest(0)->frame_id, 200);
+    EXPECT_EQ(history.nearest(290)->frame_id, 200);
+    EXPECT_EQ(history.nearest(300)->frame_id, 200);
+    EXPECT_EQ(history.nearest(301)->frame_id, 400);
+    EXPECT_EQ(history.nearest(9000)->frame_id, 700);
+
+    EXPECT_EQ(history.between(200, 400).size(), 3u);
+    EXPECT_EQ(history.between(201, 700).size(), 2u);
+    EXPECT_EQ(history.between(0, 199).size(), 0u);
+    EXPECT_EQ(history.between(500, 100).size(), 0u);
+}
+
+TEST(ScanHistoryTest, rejects_scans) {
+    ScanHistory history(2);
+    EXPECT_TRUE(history.push(make_scan(500)));
+    EXPECT_FALSE(history.push(make_scan(400)));
+
+    // no valid column
+    LidarScan invalid(w, h, profile);
+    EXPECT_FALSE(history.push(invalid));
+    EXPECT_EQ(history.size(), 1u);
+
+    EXPECT_THROW(history.push(std::unique_ptr<LidarScan>()),
+                 std::invalid_argument);
+    EXPECT_THROW(ScanHistory(0), std::invalid_argument);
+}
+
+TEST(ScanHistoryTest, reuses_pool_scans) {
+    auto pool = std::make_shared<ScanPool>(
+        w, h, get_field_types(profile), 16, 4);
+    ScanHistory history(2, pool);
+
+    // copies are made into pool scans
+    for (uint64_t ts = 1; ts <= 2; ts++) {
+        auto scan = make_scan(ts);
+        scan->field<uint32_t>(sensor::ChanField::RANGE).setConstant(ts * 7);
+        EXPECT_TRUE(history.push(*scan));
+    }
+    EXPECT_EQ(pool->allocated(), 2u);
+    EXPECT_EQ(history.back()->field<uint32_t>(sensor::ChanField::RANGE)(3, 4),
+              14u);
+    EXPECT_EQ(history.back()->status()[1], 1u);
+
+    // dropped scans go back to the pool once no handle holds them
+    auto held = history.back(1);
+    EXPECT_TRUE(history.push(make_scan(3)));
+    EXPECT_EQ(pool->available(), 0u);
+    held.reset();
+    EXPECT_EQ(pool->available(), 1u);
+
+    EXPECT_TRUE(history.push(*make_scan(4)));
+    EXPECT_EQ(pool->allocated(), 2u);
+    EXPECT_EQ(history.back()->frame_id, 4);
+
+    // rejected scans too, and scans of the pool's shape pushed without
+    // copying
+    EXPECT_EQ(pool->available(), 1u);
+    EXPECT_FALSE(history.push(pool->acquire()));
+    EXPECT_EQ(pool->available(), 1u);
+    history.clear();
+    EXPECT_EQ(pool->available(), 3u);
+}
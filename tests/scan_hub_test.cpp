@@ -0,0 +1,259 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/scan_hub.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/types.h"
+
+using namespace ouster;
+
+namespace {
+
+std::shared_ptr<const LidarScan> make_scan(uint64_t frame_id) {
+    auto scan = std::make_shared<LidarScan>(
+        32, 16, sensor::UDPProfileLidar::PROFILE_RNG19_RFL8_SIG16_NIR16);
+    scan->frame_id = frame_id;
+    return scan;
+}
+
+}  // namespace
+
+TEST(ScanHubTest, shares_scans_with_all_subscribers) {
+    ScanHub hub;
+    auto a = hub.subscribe(4);
+    auto b = hub.subscribe(4, DropPolicy::DROP_NEWEST);
+    EXPECT_EQ(hub.subscribers(), 2u);
+
+    auto scan = make_scan(1);
+    EXPECT_EQ(hub.publish(scan), 2u);
+    EXPECT_EQ(hub.published(), 1u);
+
+    std::shared_ptr<const LidarScan> got_a, got_b;
+    ASSERT_TRUE(a.try_pop(got_a));
+    ASSERT_TRUE(b.try_pop(got_b));
+    EXPECT_EQ(got_a.get(), scan.get());
+    EXPECT_EQ(got_b.get(), scan.get());
+    EXPECT_FALSE(a.try_pop(got_a));
+    EXPECT_EQ(a.delivered(), 1u);
+}
+
+TEST(ScanHubTest, drop_oldest_keeps_latest) {
+    ScanHub hub;
+    auto sub = hub.subscribe(2, DropPolicy::DROP_OLDEST);
+    for (uint64_t i = 0; i < 5; i++) EXPECT_EQ(hub.publish(make_scan(i)), 1u);
+    EXPECT_EQ(sub.size(), 2u);
+    EXPECT_EQ(sub.dropped(), 3u);
+    EXPECT_EQ(sub.delivered(), 5u);
+
+    std::shared_ptr<const LidarScan> scan;
+    ASSERT_TRUE(sub.try_pop(scan));
+    EXPECT_EQ(scan->frame_id, 3u);
+    ASSERT_TRUE(sub.try_pop(scan));
+    EXPECT_EQ(scan->frame_id, 4u);
+}
+
+TEST(ScanHubTest, drop_newest_keeps_first) {
+    ScanHub hub;
+    auto slow = hub.subscribe(2, DropPolicy::DROP_NEWEST);
+    auto fast = hub.subscribe(8);
+    for (uint64_t i = 0; i < 5; i++) hub.publish(make_scan(i));
+    EXPECT_EQ(slow.dropped(), 3u);
+    EXPECT_EQ(slow.delivered(), 2u);
+    EXPECT_EQ(fast.size(), 5u);
+
+    std::shared_ptr<const LidarScan> scan;
+    ASSERT_TRUE(slow.try_pop(scan));
+    EXPECT_EQ(scan->frame_id, 0u);
+    ASSERT_TRUE(slow.try_pop(scan));
+    EXPECT_EQ(scan->frame_id, 1u);
+}
+
+TEST(ScanHubTest, unsubscribe) {
+    ScanHub hub;
+    auto a = hub.subscribe(2);
+    {
+        auto b = hub.subscribe(2);
+        EXPECT_EQ(hub.publish(make_scan(0)), 2u);
+        EXPECT_EQ(hub.subscribers(), 2u);
+    }
+    EXPECT_EQ(hub.subscribers(), 1u);
+    EXPECT_EQ(hub.publish(make_scan(1)), 1u);
+
+    // moving keeps the subscription, assigning over it ends it
+    ScanSubscription moved(std::move(a));
+    EXPECT_FALSE(a);
+    EXPECT_TRUE(moved);
+    EXPECT_EQ(hub.subscribers(), 1u);
+    moved = hub.subscribe(1);
+    EXPECT_EQ(hub.subscribers(), 1u);
+
+    // scans queued before unsubscribing are still handed out
+    hub.publish(make_scan(2));
+    moved.unsubscribe();
+    EXPECT_EQ(hub.subscribers(), 0u);
+    EXPECT_EQ(hub.publish(make_scan(3)), 0u);
+    std::shared_ptr<const LidarScan> scan;
+    ASSERT_TRUE(moved.pop(scan));
+    EXPECT_EQ(scan->frame_id, 2u);
+    EXPECT_FALSE(moved.pop(scan));
+}
+
+TEST(ScanHubTest, close) {
+    auto hub = std::unique_ptr<ScanHub>(new ScanHub);
+    auto sub = hub->subscribe(4);
+    hub->publish(make_scan(0));
+    hub->close();
+    EXPECT_EQ(hub->publish(make_scan(1)), 0u);
+    EXPECT_THROW(hub->subscribe(1), std::logic_error);
+
+    std::shared_ptr<const LidarScan> scan;
+    ASSERT_TRUE(sub.pop(scan));
+    EXPECT_EQ(scan->frame_id, 0u);
+    EXPECT_FALSE(sub.pop(scan));
+
+    // subscriptions may outlive the hub
+    hub.reset();
+    sub.unsubscribe();
+    EXPECT_FALSE(sub.try_pop(scan));
+}
+
+TEST(ScanHubTest, errors) {
+    ScanHub hub;
+    EXPECT_THROW(hub.subscribe(0), std::invalid_argument);
+    EXPECT_THROW(hub.publish(nullptr), std::invalid_argument);
+
+    ScanSubscription empty;
+    std::shared_ptr<const LidarScan> scan;
+    EXPECT_FALSE(empty);
+    EXPECT_FALSE(empty.pop(scan, 0));
+    EXPECT_EQ(empty.depth(), 0u);
+}
+
+TEST(ScanHubTest, producer_never_waits_on_subscribers) {
+    const uint64_t n_scans = 2000;
+    ScanHub hub;
+    auto all = hub.subscribe(n_scans, DropPolicy::DROP_NEWEST);
+    auto latest = hub.subscribe(1, DropPolicy::DROP_OLDEST);
+    // never popped
+    auto stalled = hub.subscribe(3, DropPolicy::DROP_NEWEST);
+
+    std::vector<uint64_t> seen;
+    std::thread consumer([&] {
+        std::shared_ptr<const LidarScan> scan;
+        while (all.pop(scan)) seen.push_back(scan->frame_id);
+    });
+    uint64_t latest_count = 0;
+    std::thread viewer([&] {
+        std::shared_ptr<const LidarScan> scan;
+        uint64_t last = 0;
+        while (latest.pop(scan)) {
+            EXPECT_TRUE(latest_count == 0 || scan->frame_id > last);
+            last = scan->frame_id;
+            latest_count++;
+        }
+    });
+
+    // subscriptions coming and going while publishing
+    std::thread churn([&] {
+        for (int i = 0; i < 200; i++) {
+            auto sub = hub.subscribe(1);
+            std::this_thread::yield();
+        }
+    });
+
+    for (uint64_t i = 0; i < n_scans; i++) hub.publish(make_scan(i));
+    churn.join();
+    hub.close();
+    consumer.join();
+    viewer.join();
+
+    ASSERT_EQ(seen.size(), n_scans);
+    for (uint64_t i = 0; i < n_scans; i++) EXPECT_EQ(seen[i], i);
+    EXPECT_GE(latest_count, 1u);
+    EXPECT_EQ(latest.delivered(), n_scans);
+    EXPECT_EQ(stalled.size(), 3u);
+    EXPECT_EQ(stalled.dropped(), n_scans - 3);
+}
+
+TEST(ScanHubTest, views_share_scans_per_subscriber) {
+    auto scan = std::make_shared<LidarScan>(
+        32, 16, sensor::UDPProfileLidar::PROFILE_RNG19_RFL8_SIG16_NIR16);
+    auto range = scan->field<uint32_t>(sensor::ChanField::RANGE);
+    for (Eigen::Index i = 0; i < range.size(); i++) {
+        range.data()[i] = static_cast<uint32_t>(i);
+    }
+    for (size_t col = 0; col < scan->w; col++) {
+        scan->timestamp()[col] = 1000 + col;
+    }
+    for (Eigen::Index p = 0; p < scan->packet_timestamp().rows(); p++) {
+        scan->packet_timestamp()[p] = 5000 + p;
+    }
+
+    ScanHub hub;
+    auto full = hub.subscribe(2);
+    ScanViewSpec every_4th;
+    every_4th.col_step = 4;
+    auto viz = hub.subscribe(2, DropPolicy::DROP_OLDEST, every_4th);
+    ScanViewSpec beam;
+    beam.first_row = 7;
+    beam.rows = 1;
+    auto health = hub.subscribe(2, DropPolicy::DROP_OLDEST, beam);
+    ASSERT_EQ(hub.publish(scan), 3u);
+
+    ScanView view;
+    ASSERT_TRUE(full.try_pop(view));
+    EXPECT_EQ(view.w(), 32u);
+    EXPECT_EQ(view.h(), 16u);
+
+    ASSERT_TRUE(viz.try_pop(view));
+    EXPECT_EQ(view.scan().get(), scan.get());
+    EXPECT_EQ(view.w(), 8u);
+    EXPECT_EQ(view.h(), 16u);
+    auto decimated = view.field<uint32_t>(sensor::ChanField::RANGE);
+    // no copy, the view reads the memory of the scan
+    EXPECT_EQ(decimated.data(), range.data());
+    EXPECT_EQ(decimated(3, 2), range(3, 8));
+    EXPECT_EQ(view.timestamp()[5], 1020u);
+
+    ASSERT_TRUE(health.try_pop(view));
+    EXPECT_EQ(view.h(), 1u);
+    EXPECT_EQ(view.field<uint32_t>(sensor::ChanField::RANGE)(0, 31),
+              range(7, 31));
+
+    // a compact scan only when asked for
+    ScanViewSpec crop;
+    crop.first_row = 2;
+    crop.rows = 8;
+    crop.row_step = 2;
+    crop.first_col = 16;
+    crop.col_step = 2;
+    const LidarScan compact = ScanView(scan, crop).materialize();
+    ASSERT_EQ(compact.w, 8u);
+    ASSERT_EQ(compact.h, 4u);
+    EXPECT_TRUE(compact.has_field(sensor::ChanField::SIGNAL));
+    auto cropped = compact.field<uint32_t>(sensor::ChanField::RANGE);
+    EXPECT_EQ(cropped(1, 3), range(4, 22));
+    EXPECT_EQ(compact.timestamp()[3], 1022u);
+    EXPECT_EQ(compact.packet_count(), 1u);
+    EXPECT_EQ(compact.packet_timestamp()[0], 5001u);
+    EXPECT_EQ(ScanView(scan, crop).materialize(), compact);
+
+    ScanViewSpec outside;
+    outside.first_col = 30;
+    outside.cols = 4;
+    EXPECT_THROW(ScanView(scan, outside), std::invalid_argument);
+    ScanViewSpec zero_step;
+    zero_step.row_step = 0;
+    EXPECT_THROW(hub.subscribe(1, DropPolicy::DROP_OLDEST, zero_step),
+                 std::invalid_argument);
+}
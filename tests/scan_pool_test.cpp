@@ -0,0 +1,220 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/scan_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "ouster/impl/packet_writer.h"
+#include "ouster/types.h"
+#include "util.h"
+
+using ouster::LidarScan;
+using ouster::LidarScanFieldTypes;
+using ouster::ScanBatcher;
+using ouster::ScanPool;
+using ouster::sensor::LidarPacket;
+namespace ChanField = ouster::sensor::ChanField;
+using ouster::sensor::UDPProfileLidar;
+
+namespace {
+
+LidarScanFieldTypes test_fields() {
+    return ouster::get_field_types(
+        UDPProfileLidar::PROFILE_RNG19_RFL8_SIG16_NIR16);
+}
+
+}  // namespace
+
+TEST(ScanPoolTest, ReusesReleasedScans) {
+    ScanPool pool(64, 16, test_fields(), 16, 2);
+    auto scan = pool.acquire();
+    ASSERT_TRUE(scan);
+    EXPECT_EQ(scan->w, 64u);
+    EXPECT_EQ(scan->h, 16u);
+    EXPECT_EQ(scan->packet_timestamp().rows(), 4);
+    EXPECT_EQ(pool.allocated(), 1u);
+    EXPECT_EQ(pool.available(), 0u);
+
+    // the released scan comes back with its storage and contents intact
+    scan->field<uint32_t>(ChanField::RANGE)(3, 5) = 42;
+    scan->frame_id = 7;
+    const uint32_t* range = scan->field<uint32_t>(ChanField::RANGE).data();
+    EXPECT_TRUE(pool.release(std::move(scan)));
+    EXPECT_EQ(pool.available(), 1u);
+
+    scan = pool.acquire();
+    EXPECT_EQ(scan->field<uint32_t>(ChanField::RANGE).data(), range);
+    EXPECT_EQ(scan->field<uint32_t>(ChanField::RANGE)(3, 5), 42u);
+    EXPECT_EQ(scan->frame_id, -1);
+    EXPECT_EQ(pool.allocated(), 1u);
+}
+
+TEST(ScanPoolTest, RejectsMismatchedScans) {
+    ScanPool pool(64, 16, test_fields(), 16, 4);
+    EXPECT_FALSE(pool.release(nullptr));
+
+    auto fields = test_fields();
+    EXPECT_FALSE(pool.release(std::make_unique<LidarScan>(
+        32, 16, fields.begin(), fields.end(), 16)));
+    EXPECT_FALSE(pool.release(std::make_unique<LidarScan>(
+        64, 16, fields.begin(), fields.end(), 8)));
+
+    auto scan = pool.acquire();
+    scan->add_field("custom", ouster::fd_array<uint8_t>(16, 64));
+    EXPECT_FALSE(pool.matches(*scan));
+    EXPECT_FALSE(pool.release(std::move(scan)));
+
+    scan = pool.acquire();
+    scan->del_field(ChanField::SIGNAL);
+    EXPECT_FALSE(pool.release(std::move(scan)));
+    EXPECT_EQ(pool.available(), 0u);
+
+    // field order doesn't matter
+    std::reverse(fields.begin(), fields.end());
+    EXPECT_TRUE(pool.release(std::make_unique<LidarScan>(
+        64, 16, fields.begin(), fields.end(), 16)));
+    EXPECT_EQ(pool.available(), 1u);
+
+    EXPECT_THROW(ScanPool(0, 16, fields, 16, 1), std::invalid_argument);
+}
+
+TEST(ScanPoolTest, KeepsAtMostCapacity) {
+    ScanPool pool(32, 8, test_fields(), 16, 2);
+    std::vector<std::unique_ptr<LidarScan>> scans;
+    for (int i = 0; i < 3; i++) scans.push_back(pool.acquire());
+    EXPECT_EQ(pool.allocated(), 3u);
+
+    EXPECT_TRUE(pool.release(std::move(scans[0])));
+    EXPECT_TRUE(pool.release(std::move(scans[1])));
+    EXPECT_FALSE(pool.release(std::move(scans[2])));
+    EXPECT_EQ(pool.available(), 2u);
+}
+
+TEST(ScanPoolTest, ReservesUpToCapacity) {
+    ScanPool pool(32, 8, test_fields(), 16, 3);
+    EXPECT_EQ(pool.reserve(2), 2u);
+    EXPECT_EQ(pool.allocated(), 2u);
+    EXPECT_EQ(pool.reserve(8), 3u);
+    EXPECT_EQ(pool.allocated(), 3u);
+
+    // reserved scans are handed out without allocating
+    std::vector<std::unique_ptr<LidarScan>> scans;
+    for (int i = 0; i < 3; i++) scans.push_back(pool.acquire());
+    EXPECT_EQ(pool.allocated(), 3u);
+    EXPECT_EQ(pool.available(), 0u);
+}
+
+TEST(ScanPoolTest, ConcurrentAcquireRelease) {
+    ScanPool pool(32, 8, test_fields(), 16, 4);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&pool] {
+            for (int i = 0; i < 200; i++) pool.release(pool.acquire());
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    // at most one scan per thread was ever out at once
+    EXPECT_LE(pool.allocated(), 4u);
+    EXPECT_EQ(pool.available(), pool.allocated());
+}
+
+TEST(ScanPoolTest, UnzeroedScansBatchLikeNewOnes) {
+    auto info =
+        ouster::sensor::default_sensor_info(ouster::sensor::MODE_512x10);
+    info.format.udp_profile_lidar =
+        UDPProfileLidar::PROFILE_RNG19_RFL8_SIG16_NIR16;
+    info.format.pixels_per_column = 16;
+    info.beam_azimuth_angles.resize(16);
+    info.beam_altitude_angles.resize(16);
+    ouster::sensor::impl::packet_writer pw(info);
+
+    LidarScan frame(info);
+    frame.frame_id = 3;
+    std::iota(frame.measurement_id().data(),
+              frame.measurement_id().data() + frame.measurement_id().size(), 0);
+    std::iota(frame.timestamp().data(),
+              frame.timestamp().data() + frame.timestamp().size(), 1000);
+    frame.status().setConstant(0x1);
+    ouster::impl::foreach_channel_field(
+        frame, pw, [&](auto ref_field, const std::string& name) {
+            randomize_field(ref_field, pw.field_value_mask(name), 7);
+        });
+    std::vector<LidarPacket> packets;
+    ouster::impl::scan_to_packets(frame, pw, std::back_inserter(packets), 0,
+                                  0);
+    // columns of missing packets in the middle and at the end of the frame
+    packets.erase(packets.begin() + 5);
+    packets.pop_back();
+
+    auto batch = [&](LidarScan& scan) {
+        ScanBatcher batcher(info);
+        for (const auto& p : packets) EXPECT_FALSE(batcher(p, scan));
+        batcher.finish_scan(scan);
+    };
+    LidarScan expected(info);
+    batch(expected);
+
+    // a new scan of the pool, and one reused with stale headers and fields
+    ScanPool pool(info, ouster::get_field_types(info), 1);
+    auto scan = pool.acquire();
+    batch(*scan);
+    EXPECT_EQ(*scan, expected);
+
+    for (const auto& kv : scan->fields()) {
+        std::memset(const_cast<void*>(kv.second.get()), 0xab,
+                    kv.second.bytes());
+    }
+    scan->timestamp().setConstant(5);
+    scan->alert_flags().setConstant(1);
+    ASSERT_TRUE(pool.release(std::move(scan)));
+    scan = pool.acquire();
+    EXPECT_TRUE((scan->timestamp() == 0).all());
+    EXPECT_TRUE((scan->alert_flags() == 0).all());
+    batch(*scan);
+    EXPECT_EQ(*scan, expected);
+}
+
+TEST(ScanPoolTest, ZeroesFieldsTheBatcherDoesNotWrite) {
+    auto info =
+        ouster::sensor::default_sensor_info(ouster::sensor::MODE_512x10);
+    info.format.udp_profile_lidar =
+        UDPProfileLidar::PROFILE_RNG19_RFL8_SIG16_NIR16;
+    auto fields = ouster::get_field_types(info);
+    fields.emplace_back("custom", ouster::sensor::ChanFieldType::UINT32);
+
+    // the extra field is zero in new scans, and again once a scan is reused
+    ScanPool pool(info, fields, 1);
+    auto scan = pool.acquire();
+    ASSERT_TRUE(scan->has_field("custom"));
+    EXPECT_TRUE((scan->field<uint32_t>("custom") == 0).all());
+
+    scan->field<uint32_t>("custom").setConstant(9);
+    scan->field<uint32_t>(ChanField::RANGE)(3, 5) = 42;
+    ASSERT_TRUE(pool.release(std::move(scan)));
+    scan = pool.acquire();
+    EXPECT_TRUE((scan->field<uint32_t>("custom") == 0).all());
+    // profile fields are left for the batcher to overwrite
+    EXPECT_EQ(scan->field<uint32_t>(ChanField::RANGE)(3, 5), 42u);
+
+    // a pool that doesn't know the sensor zeroes every field of new scans
+    ScanPool plain(64, 16, fields, 16, 1);
+    scan = plain.acquire();
+    for (const auto& kv : scan->fields()) {
+        const auto* bytes = static_cast<const uint8_t*>(kv.second.get());
+        EXPECT_TRUE(std::all_of(bytes, bytes + kv.second.bytes(),
+                                [](uint8_t b) { return b == 0; }))
+            << kv.first;
+    }
+}
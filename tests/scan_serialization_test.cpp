@@ -0,0 +1,222 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/scan_serialization.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/types.h"
+
+using namespace ouster;
+using namespace ouster::sensor;
+
+namespace {
+
+LidarScan fill(LidarScan ls) {
+    ls.field<uint32_t>(ChanField::RANGE).setConstant(1234);
+    ls.field<uint16_t>(ChanField::SIGNAL)(1, 2) = 77;
+    ls.field<uint16_t>(ChanField::SIGNAL)(3, 5) = 78;
+    ls.timestamp().setConstant(1000);
+    ls.measurement_id()[3] = 3;
+    ls.status().setConstant(1);
+    ls.packet_timestamp()[0] = 42;
+    ls.pose().get<double>()[5] = 1.5;
+    ls.frame_id = 9;
+    ls.frame_status = 5;
+    ls.shutdown_countdown = 2;
+    return ls;
+}
+
+LidarScan contiguous_scan() {
+    return fill(LidarScan::make_contiguous(
+        64, 32, get_field_types(PROFILE_RNG19_RFL8_SIG16_NIR16), 16));
+}
+
+LidarScan separate_scan() {
+    const auto types = get_field_types(PROFILE_RNG19_RFL8_SIG16_NIR16);
+    return fill(LidarScan(64, 32, types.begin(), types.end(), 16));
+}
+
+std::vector<uint8_t> gather(const ScanSerializer& serializer) {
+    std::vector<uint8_t> out;
+    for (const auto& c : serializer.chunks()) {
+        const auto* p = static_cast<const uint8_t*>(c.data);
+        out.insert(out.end(), p, p + c.size);
+    }
+    return out;
+}
+
+}  // namespace
+
+TEST(ScanSerializationTest, round_trip) {
+    const auto scan = contiguous_scan();
+    const auto bytes = serialize_scan(scan);
+    EXPECT_EQ(serialized_scan_size(bytes.data(), 64), bytes.size());
+
+    const auto copy = deserialize_scan(bytes.data(), bytes.size());
+    EXPECT_EQ(copy, scan);
+    EXPECT_TRUE(copy.is_contiguous());
+    EXPECT_EQ(copy.frame_status, 5u);
+    EXPECT_EQ(copy.shutdown_countdown, 2);
+    EXPECT_EQ(copy.sensor_info, nullptr);
+}
+
+TEST(ScanSerializationTest, contiguous_scans_are_one_chunk) {
+    const auto scan = contiguous_scan();
+    ScanSerializer serializer(scan);
+    ASSERT_EQ(serializer.chunks().size(), 2u);
+    EXPECT_EQ(serializer.chunks()[1].data, scan.arena_data());
+    EXPECT_EQ(serializer.chunks()[1].size, scan.arena_size());
+    EXPECT_EQ(gather(serializer), serialize_scan(scan));
+
+    // scans with separately allocated fields take a chunk per field
+    const auto separate = separate_scan();
+    ScanSerializer chunked(separate);
+    EXPECT_GT(chunked.chunks().size(), 2u);
+    EXPECT_EQ(chunked.size(), serializer.size());
+    const auto bytes = gather(chunked);
+    EXPECT_EQ(bytes, serialize_scan(separate));
+    EXPECT_EQ(deserialize_scan(bytes.data(), bytes.size()), separate);
+    const auto compressed = serialize_scan(separate, true);
+    EXPECT_EQ(deserialize_scan(compressed.data(), compressed.size()),
+              separate);
+}
+
+TEST(ScanSerializationTest, compressed_round_trip) {
+    auto scan = contiguous_scan();
+    scan.sensor_info = std::make_shared<sensor_info>(
+        default_sensor_info(MODE_1024x10));
+    const auto plain = serialize_scan(scan);
+    const auto compressed = serialize_scan(scan, true);
+    EXPECT_LT(compressed.size(), plain.size() / 4);
+    EXPECT_EQ(serialized_scan_size(compressed.data(), compressed.size()),
+              compressed.size());
+
+    const auto copy = deserialize_scan(compressed.data(), compressed.size());
+    EXPECT_EQ(copy, scan);
+    ASSERT_NE(copy.sensor_info, nullptr);
+    EXPECT_EQ(*copy.sensor_info, *scan.sensor_info);
+
+    std::shared_ptr<uint8_t> buffer(new uint8_t[compressed.size()],
+                                    std::default_delete<uint8_t[]>());
+    std::memcpy(buffer.get(), compressed.data(), compressed.size());
+    EXPECT_THROW(view_serialized_scan(buffer, compressed.size()),
+                 std::invalid_argument);
+}
+
+TEST(ScanSerializationTest, lossy_round_trip) {
+    auto scan = separate_scan();
+    auto range = scan.field<uint32_t>(ChanField::RANGE);
+    for (Eigen::Index r = 0; r < range.rows(); r++) {
+        for (Eigen::Index c = 0; c < range.cols(); c++) {
+            range(r, c) = (r + c) % 7 ? 3000 + 17 * c + 5 * r : 0;
+        }
+    }
+    const LossyFields lossy{{ChanField::RANGE, 10}, {"NO_SUCH_FIELD", 1}};
+    const auto bytes = serialize_scan(scan, false, lossy);
+    EXPECT_LT(bytes.size(), serialize_scan(scan, true).size());
+    EXPECT_EQ(serialized_scan_size(bytes.data(), bytes.size()), bytes.size());
+
+    const auto copy = deserialize_scan(bytes.data(), bytes.size());
+    EXPECT_EQ(copy.frame_id, scan.frame_id);
+    EXPECT_TRUE(copy.field(ChanField::SIGNAL) == scan.field(ChanField::SIGNAL));
+    EXPECT_TRUE((copy.timestamp() == scan.timestamp()).all());
+    const img_t<int64_t> diff =
+        copy.field<uint32_t>(ChanField::RANGE).cast<int64_t>() -
+        range.cast<int64_t>();
+    EXPECT_LE(diff.abs().maxCoeff(), 10);
+    EXPECT_TRUE(((copy.field<uint32_t>(ChanField::RANGE) == 0) == (range == 0))
+                    .all());
+
+    // a lossless error keeps the scan as it is
+    const auto lossless =
+        serialize_scan(scan, false, {{ChanField::RANGE, 0}});
+    EXPECT_EQ(deserialize_scan(lossless.data(), lossless.size()), scan);
+
+    std::shared_ptr<uint8_t> buffer(new uint8_t[bytes.size()],
+                                    std::default_delete<uint8_t[]>());
+    std::memcpy(buffer.get(), bytes.data(), bytes.size());
+    EXPECT_THROW(view_serialized_scan(buffer, bytes.size()),
+                 std::invalid_argument);
+    auto truncated = bytes;
+    truncated.resize(truncated.size() - 8);
+    EXPECT_THROW(deserialize_scan(truncated.data(), truncated.size()),
+                 std::invalid_argument);
+}
+
+TEST(ScanSerializationTest, view_shares_the_buffer) {
+    const auto bytes = serialize_scan(contiguous_scan());
+    std::shared_ptr<uint8_t> buffer(new uint8_t[bytes.size()],
+                                    std::default_delete<uint8_t[]>());
+    std::memcpy(buffer.get(), bytes.data(), bytes.size());
+
+    auto view = view_serialized_scan(buffer, bytes.size());
+    EXPECT_EQ(view, contiguous_scan());
+    const auto* data = view.arena_data();
+    EXPECT_GE(data, buffer.get());
+    EXPECT_LT(data, buffer.get() + bytes.size());
+
+    // the view keeps the buffer alive
+    std::weak_ptr<uint8_t> weak = buffer;
+    buffer.reset();
+    EXPECT_FALSE(weak.expired());
+    EXPECT_EQ(view.field<uint16_t>(ChanField::SIGNAL)(1, 2), 77);
+}
+
+TEST(ScanSerializationTest, rejects_bad_input) {
+    const auto bytes = serialize_scan(contiguous_scan());
+    const auto compressed = serialize_scan(contiguous_scan(), true);
+
+    EXPECT_THROW(serialized_scan_size(bytes.data(), 63),
+                 std::invalid_argument);
+    EXPECT_THROW(deserialize_scan(bytes.data(), bytes.size() - 1),
+                 std::invalid_argument);
+    EXPECT_THROW(deserialize_scan(compressed.data(), compressed.size() - 1),
+                 std::invalid_argument);
+
+    auto bad_magic = bytes;
+    bad_magic[0] ^= 1;
+    EXPECT_THROW(deserialize_scan(bad_magic.data(), bad_magic.size()),
+                 std::invalid_argument);
+
+    auto bad_version = bytes;
+    bad_version[8] = 99;
+    EXPECT_THROW(deserialize_scan(bad_version.data(), bad_version.size()),
+                 std::invalid_argument);
+
+    // a field table that doesn't match the payload
+    auto bad_table = bytes;
+    uint32_t name_bytes;
+    std::memcpy(&name_bytes, &bad_table[64 + 4], sizeof(name_bytes));
+    bad_table[64 + 8 + name_bytes] = ChanFieldType::FLOAT64;
+    EXPECT_THROW(deserialize_scan(bad_table.data(), bad_table.size()),
+                 std::invalid_argument);
+
+    // a first sequence that matches before the start of the block
+    auto bad_block = compressed;
+    uint64_t block_bytes;
+    std::memcpy(&block_bytes, &bad_block[56], sizeof(block_bytes));
+    bad_block[bad_block.size() - block_bytes] = 0x0f;
+    EXPECT_THROW(deserialize_scan(bad_block.data(), bad_block.size()),
+                 std::invalid_argument);
+}
+
+TEST(ScanSerializationTest, field_table_round_trip) {
+    auto types = get_field_types(PROFILE_RNG19_RFL8_SIG16_NIR16);
+    types.emplace_back("extra", ChanFieldType::FLOAT32,
+                       std::vector<size_t>{3, 4}, FieldClass::COLUMN_FIELD);
+    const auto table = ouster::impl::field_types_to_binary(types);
+    EXPECT_EQ(ouster::impl::field_types_from_binary(table.data(), table.size()),
+              types);
+    EXPECT_THROW(
+        ouster::impl::field_types_from_binary(table.data(), table.size() - 1),
+        std::runtime_error);
+}
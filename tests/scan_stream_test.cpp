@@ -0,0 +1,172 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/scan_stream.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/types.h"
+
+using namespace ouster;
+using namespace ouster::sensor;
+
+namespace {
+
+std::shared_ptr<const LidarScan> make_scan(const sensor_info& info,
+                                           int64_t frame_id) {
+    auto scan = std::make_shared<LidarScan>(info);
+    scan->frame_id = frame_id;
+    auto range = scan->field<uint32_t>(ChanField::RANGE);
+    for (int i = 0; i < range.size(); i++) {
+        range.data()[i] = static_cast<uint32_t>(frame_id * 1000 + i % 997);
+    }
+    scan->packet_timestamp().setConstant(frame_id + 1);
+    return scan;
+}
+
+// wait until the server has the given number of clients
+void wait_for_clients(const ScanStreamServer& server, size_t clients) {
+    for (int i = 0; i < 500 && server.clients() < clients; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+}  // namespace
+
+TEST(ScanStreamTest, streams_scans_with_selected_fields) {
+    const auto info = default_sensor_info(MODE_512x10);
+    ScanStreamServer server(info, 0, "127.0.0.1");
+    ASSERT_GT(server.port(), 0);
+    // the fields of the clients are checked against the published scans
+    server.publish(make_scan(info, 0));
+
+    ScanStreamRequest all;
+    all.queue_depth = 8;
+    ScanStreamRequest range;
+    range.fields = {ChanField::RANGE};
+    range.compress = false;
+    range.queue_depth = 8;
+    ScanStreamClient full_client("127.0.0.1", server.port(), all);
+    ScanStreamClient range_client("127.0.0.1", server.port(), range);
+    EXPECT_EQ(full_client.sensor_info(), info);
+    wait_for_clients(server, 2);
+    ASSERT_EQ(server.clients(), 2u);
+
+    auto sent = make_scan(info, 1);
+    EXPECT_EQ(server.publish(sent), 2u);
+
+    auto got = full_client.get_scan(5);
+    ASSERT_NE(got, nullptr);
+    EXPECT_EQ(*got, *sent);
+    ASSERT_TRUE(got->sensor_info);
+    EXPECT_EQ(*got->sensor_info, info);
+
+    got = range_client.get_scan(5);
+    ASSERT_NE(got, nullptr);
+    EXPECT_EQ(got->fields().size(), 1u);
+    EXPECT_EQ(got->frame_id, 1);
+    EXPECT_TRUE(
+        (got->field(ChanField::RANGE) == sent->field(ChanField::RANGE)));
+
+    // nothing more was published
+    EXPECT_EQ(full_client.get_scan(0.05), nullptr);
+    EXPECT_FALSE(full_client.closed());
+
+    server.close();
+    EXPECT_EQ(full_client.get_scan(5), nullptr);
+    EXPECT_TRUE(full_client.closed());
+    const auto stats = server.stats();
+    EXPECT_EQ(stats.clients, 2u);
+    EXPECT_EQ(stats.scans_sent, 2u);
+    EXPECT_GT(stats.bytes_sent, 0u);
+}
+
+TEST(ScanStreamTest, decimates_by_frame_id) {
+    const auto info = default_sensor_info(MODE_512x10);
+    ScanStreamServer server(info, 0, "127.0.0.1");
+    ScanStreamRequest request;
+    request.decimation = 3;
+    request.queue_depth = 16;
+    ScanStreamClient client("127.0.0.1", server.port(), request);
+    wait_for_clients(server, 1);
+
+    for (int64_t i = 0; i < 7; i++) server.publish(make_scan(info, i));
+    for (int64_t expected : {0, 3, 6}) {
+        auto got = client.get_scan(5);
+        ASSERT_NE(got, nullptr);
+        EXPECT_EQ(got->frame_id, expected);
+    }
+    EXPECT_EQ(client.get_scan(0.05), nullptr);
+}
+
+TEST(ScanStreamTest, streams_error_bounded_ranges) {
+    const auto info = default_sensor_info(MODE_512x10);
+    ScanStreamServer server(info, 0, "127.0.0.1");
+    ScanStreamRequest request;
+    request.compress = false;
+    request.max_range_error = 20;
+    request.queue_depth = 8;
+    ScanStreamClient client("127.0.0.1", server.port(), request);
+    wait_for_clients(server, 1);
+
+    auto sent = make_scan(info, 3);
+    server.publish(sent);
+    auto got = client.get_scan(5);
+    ASSERT_NE(got, nullptr);
+    const img_t<int64_t> diff =
+        got->field<uint32_t>(ChanField::RANGE).cast<int64_t>() -
+        sent->field<uint32_t>(ChanField::RANGE).cast<int64_t>();
+    EXPECT_LE(diff.abs().maxCoeff(), 20);
+    EXPECT_TRUE((got->field(ChanField::SIGNAL) ==
+                 sent->field(ChanField::SIGNAL)));
+    EXPECT_TRUE((got->packet_timestamp() == sent->packet_timestamp()).all());
+}
+
+TEST(ScanStreamTest, slow_client_skips_to_latest) {
+    const auto info = default_sensor_info(MODE_512x10);
+    ScanStreamServer server(info, 0, "127.0.0.1");
+    ScanStreamRequest request;
+    request.compress = false;
+    ScanStreamClient client("127.0.0.1", server.port(), request);
+    wait_for_clients(server, 1);
+
+    // far more than the socket buffers hold while the client doesn't read
+    const int scans = 200;
+    for (int64_t i = 0; i < scans; i++) server.publish(make_scan(info, i));
+
+    int64_t last = -1;
+    int received = 0;
+    while (auto got = client.get_scan(0.5)) {
+        EXPECT_GT(got->frame_id, last);
+        last = got->frame_id;
+        received++;
+    }
+    EXPECT_EQ(last, scans - 1);
+    EXPECT_LT(received, scans);
+    EXPECT_GT(server.stats().scans_dropped, 0u);
+}
+
+TEST(ScanStreamTest, rejects_bad_requests) {
+    const auto info = default_sensor_info(MODE_512x10);
+    ScanStreamServer server(info, 0, "127.0.0.1");
+    server.publish(make_scan(info, 0));
+
+    ScanStreamRequest request;
+    request.fields = {"NOT_A_FIELD"};
+    EXPECT_THROW(ScanStreamClient("127.0.0.1", server.port(), request),
+                 std::runtime_error);
+    request.fields = {};
+    request.decimation = 0;
+    EXPECT_THROW(ScanStreamClient("127.0.0.1", server.port(), request),
+                 std::invalid_argument);
+    EXPECT_THROW(server.publish(nullptr), std::invalid_argument);
+    EXPECT_EQ(server.stats().rejected, 1u);
+}
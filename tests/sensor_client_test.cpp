@@ -0,0 +1,835 @@
+/**
+ * Copyright (c) 2024, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/sensor_client.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ouster/impl/client_poller.h"
+#include "ouster/impl/lidar_scan_impl.h"
+#include "ouster/impl/netcompat.h"
+#include "ouster/sensor_scan_source.h"
+#include "util.h"
+
+using namespace ouster::sensor;
+using ouster::LidarScan;
+
+namespace {
+
+// Sends UDP datagrams to the SensorClient from the loopback "sensor" address
+class LoopbackSender {
+   public:
+    LoopbackSender() : sock_(socket(AF_INET, SOCK_DGRAM, 0)) {}
+    ~LoopbackSender() { impl::socket_close(sock_); }
+
+    void send(int port, const std::vector<uint8_t>& buf) {
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        sendto(sock_, (const char*)buf.data(), buf.size(), 0, (sockaddr*)&addr,
+               sizeof(addr));
+    }
+
+   private:
+    SOCKET sock_;
+};
+
+SOCKET bound_udp_socket(int port) {
+    SOCKET sock = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    bind(sock, (sockaddr*)&addr, sizeof(addr));
+    return sock;
+}
+
+// generate the packets of one complete frame for info
+std::vector<LidarPacket> frame_packets(const sensor_info& info,
+                                       uint32_t frame_id) {
+    LidarScan ls(info);
+    ls.frame_id = frame_id;
+    std::iota(ls.timestamp().data(),
+              ls.timestamp().data() + ls.timestamp().size(), 1000);
+    std::iota(ls.packet_timestamp().data(),
+              ls.packet_timestamp().data() + ls.packet_timestamp().size(), 10);
+    std::fill(ls.status().data(), ls.status().data() + ls.status().size(), 0x1);
+
+    impl::packet_writer pw{packet_format(info)};
+    std::vector<LidarPacket> packets;
+    ouster::impl::scan_to_packets(ls, pw, std::back_inserter(packets),
+                                  info.init_id, info.sn);
+    return packets;
+}
+
+class SensorClientTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        info_ = metadata_from_json(getenvs("DATA_DIR") +
+                                   "3_0_1_os-122246000293-128.json");
+        info_.config.udp_port_lidar = free_udp_port();
+        info_.config.udp_port_imu = free_udp_port();
+        config_.udp_port_lidar = info_.config.udp_port_lidar;
+        config_.udp_port_imu = info_.config.udp_port_imu;
+        pf_ = std::make_unique<packet_format>(info_);
+    }
+
+    sensor_info info_;
+    sensor_config config_;
+    std::unique_ptr<packet_format> pf_;
+};
+
+}  // namespace
+
+TEST_F(SensorClientTest, get_packets_drains_batch) {
+    SensorClient client({Sensor("127.0.0.1", config_)}, {info_});
+
+    const size_t n_lidar = 8;
+    LoopbackSender sender;
+    for (size_t i = 0; i < n_lidar; i++) {
+        std::vector<uint8_t> buf(pf_->lidar_packet_size, (uint8_t)i);
+        sender.send(config_.udp_port_lidar.value(), buf);
+    }
+    sender.send(config_.udp_port_imu.value(),
+                std::vector<uint8_t>(pf_->imu_packet_size, 0));
+
+    std::vector<ClientEvent> events;
+    size_t n_lidar_received = 0;
+    size_t n_imu_received = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (n_lidar_received + n_imu_received < n_lidar + 1 &&
+           std::chrono::steady_clock::now() < deadline) {
+        client.get_packets(events, 16, 0.5);
+        ASSERT_FALSE(events.empty());
+        for (auto& ev : events) {
+            if (ev.type != ClientEvent::Packet) continue;
+            EXPECT_EQ(ev.source, 0);
+            if (ev.packet().type() == PacketType::Lidar) {
+                EXPECT_EQ(ev.packet().buf.size(), pf_->lidar_packet_size);
+                EXPECT_EQ(ev.packet().buf[0], n_lidar_received);
+                n_lidar_received++;
+            } else {
+                EXPECT_EQ(ev.packet().buf.size(), pf_->imu_packet_size);
+                n_imu_received++;
+            }
+        }
+    }
+    EXPECT_EQ(n_lidar_received, n_lidar);
+    EXPECT_EQ(n_imu_received, 1u);
+}
+
+TEST_F(SensorClientTest, get_packets_limits_batch_size) {
+    SensorClient client({Sensor("127.0.0.1", config_)}, {info_});
+
+    LoopbackSender sender;
+    for (size_t i = 0; i < 6; i++) {
+        sender.send(config_.udp_port_lidar.value(),
+                    std::vector<uint8_t>(pf_->lidar_packet_size, 0));
+    }
+
+    std::vector<ClientEvent> events;
+    // wait for the first packets to arrive before checking the limit
+    client.get_packets(events, 4, 1.0);
+    EXPECT_LE(events.size(), 4u);
+    EXPECT_EQ(events.front().type, ClientEvent::Packet);
+}
+
+TEST_F(SensorClientTest, get_packets_timeout) {
+    SensorClient client({Sensor("127.0.0.1", config_)}, {info_});
+
+    std::vector<ClientEvent> events;
+    EXPECT_EQ(client.get_packets(events, 4, 0.01), 1u);
+    EXPECT_EQ(events[0].type, ClientEvent::PollTimeout);
+}
+
+TEST_F(SensorClientTest, buffered_get_packet) {
+    SensorClient client({Sensor("127.0.0.1", config_)}, {info_}, 45, 1.0);
+
+    const size_t n_lidar = 8;
+    LoopbackSender sender;
+    for (size_t i = 0; i < n_lidar; i++) {
+        std::vector<uint8_t> buf(pf_->lidar_packet_size, (uint8_t)i);
+        sender.send(config_.udp_port_lidar.value(), buf);
+    }
+
+    size_t received = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (received < n_lidar && std::chrono::steady_clock::now() < deadline) {
+        auto ev = client.get_packet(0.5);
+        if (ev.type != ClientEvent::Packet) continue;
+        ASSERT_EQ(ev.packet().type(), PacketType::Lidar);
+        EXPECT_EQ(ev.packet().buf.size(), pf_->lidar_packet_size);
+        EXPECT_EQ(ev.packet().buf[0], received);
+        received++;
+    }
+    EXPECT_EQ(received, n_lidar);
+    EXPECT_EQ(client.dropped_packets(), 0u);
+    EXPECT_EQ(client.buffer_size(), 0u);
+}
+
+TEST_F(SensorClientTest, pooled_packets_outlive_next_call) {
+    SensorClient client({Sensor("127.0.0.1", config_)}, {info_}, 45, 1.0);
+
+    const size_t n_lidar = 4;
+    LoopbackSender sender;
+    for (size_t i = 0; i < n_lidar; i++) {
+        sender.send(config_.udp_port_lidar.value(),
+                    std::vector<uint8_t>(pf_->lidar_packet_size, (uint8_t)i));
+    }
+
+    std::vector<PooledPacket> kept;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (kept.size() < n_lidar &&
+           std::chrono::steady_clock::now() < deadline) {
+        auto ev = client.get_pooled_packet(0.5);
+        if (ev.type != ClientEvent::Packet) continue;
+        ASSERT_TRUE(ev.pooled_packet());
+        EXPECT_EQ(&ev.packet(), ev.pooled_packet().get());
+        kept.push_back(ev.pooled_packet());
+    }
+    ASSERT_EQ(kept.size(), n_lidar);
+    for (size_t i = 0; i < n_lidar; i++) {
+        EXPECT_EQ(kept[i]->type(), PacketType::Lidar);
+        EXPECT_EQ(kept[i]->buf.size(), pf_->lidar_packet_size);
+        EXPECT_EQ(kept[i]->buf[0], i);
+    }
+    EXPECT_EQ(client.packet_pool().available(), 0u);
+    kept.clear();
+    EXPECT_EQ(client.packet_pool().available(), n_lidar);
+}
+
+TEST_F(SensorClientTest, kernel_receive_timestamps) {
+    auto now_ns = []() -> uint64_t {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    };
+    SensorClient client({Sensor("127.0.0.1", config_)}, {info_}, 45, 0,
+                        ReceiveTimestampMode::KERNEL);
+
+    const uint64_t before_send = now_ns();
+    LoopbackSender sender;
+    sender.send(config_.udp_port_lidar.value(),
+                std::vector<uint8_t>(pf_->lidar_packet_size, 0));
+
+    std::vector<ClientEvent> events;
+    client.get_packets(events, 4, 1.0);
+    const uint64_t after_recv = now_ns();
+    ASSERT_EQ(events.size(), 1u);
+    ASSERT_EQ(events[0].type, ClientEvent::Packet);
+    EXPECT_GE(events[0].packet().host_timestamp, before_send);
+    EXPECT_LE(events[0].packet().host_timestamp, after_recv);
+}
+
+TEST_F(SensorClientTest, legacy_receive_timestamps_all_or_nothing) {
+    auto cli = init_client("", config_.udp_port_lidar.value(),
+                           config_.udp_port_imu.value());
+    ASSERT_TRUE(cli);
+
+    // the sockets listen on every interface, so there is no NIC to configure
+    // without naming one, and loopback can't stamp packets in hardware
+    EXPECT_FALSE(
+        enable_receive_timestamps(*cli, ReceiveTimestampMode::HARDWARE));
+    EXPECT_FALSE(
+        enable_receive_timestamps(*cli, ReceiveTimestampMode::HARDWARE, "lo"));
+
+    auto now_ns = []() -> uint64_t {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    };
+    LidarPacket packet(pf_->lidar_packet_size);
+    LoopbackSender sender;
+#ifdef __linux__
+    ASSERT_TRUE(enable_receive_timestamps(*cli, ReceiveTimestampMode::KERNEL));
+#endif
+    const uint64_t before_send = now_ns();
+    sender.send(config_.udp_port_lidar.value(),
+                std::vector<uint8_t>(pf_->lidar_packet_size, 0));
+    ASSERT_EQ(poll_client(*cli, 1) & LIDAR_DATA, LIDAR_DATA);
+    ASSERT_TRUE(read_lidar_packet(*cli, packet));
+    EXPECT_GE(packet.host_timestamp, before_send);
+    EXPECT_LE(packet.host_timestamp, now_ns());
+}
+
+TEST_F(SensorClientTest, packet_mmap_capture) {
+    CaptureOptions capture;
+    capture.backend = CaptureBackend::PACKET_MMAP;
+    capture.interface = "lo";
+    capture.block_size = 1 << 18;
+    capture.block_count = 8;
+    std::unique_ptr<SensorClient> client;
+    try {
+        client = std::make_unique<SensorClient>(
+            std::vector<Sensor>{Sensor("127.0.0.1", config_)},
+            std::vector<sensor_info>{info_}, 45, 0,
+            ReceiveTimestampMode::KERNEL, capture);
+    } catch (const std::runtime_error& e) {
+        // needs Linux and CAP_NET_RAW
+        GTEST_SKIP() << e.what();
+    }
+
+    const size_t n_lidar = 4;
+    LoopbackSender sender;
+    for (size_t i = 0; i < n_lidar; i++) {
+        sender.send(config_.udp_port_lidar.value(),
+                    std::vector<uint8_t>(pf_->lidar_packet_size, (uint8_t)i));
+    }
+    sender.send(config_.udp_port_imu.value(),
+                std::vector<uint8_t>(pf_->imu_packet_size, 0));
+
+    size_t n_lidar_received = 0;
+    size_t n_imu_received = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (n_lidar_received + n_imu_received < n_lidar + 1 &&
+           std::chrono::steady_clock::now() < deadline) {
+        auto ev = client->get_packet(0.5);
+        if (ev.type != ClientEvent::Packet) continue;
+        EXPECT_NE(ev.packet().host_timestamp, 0u);
+        if (ev.packet().type() == PacketType::Lidar) {
+            EXPECT_EQ(ev.packet().buf.size(), pf_->lidar_packet_size);
+            EXPECT_EQ(ev.packet().buf[0], n_lidar_received);
+            n_lidar_received++;
+        } else {
+            n_imu_received++;
+        }
+    }
+    EXPECT_EQ(n_lidar_received, n_lidar);
+    EXPECT_EQ(n_imu_received, 1u);
+
+    // nothing is left over on the UDP sockets or seen twice
+    EXPECT_EQ(client->get_packet(0.05).type, ClientEvent::PollTimeout);
+}
+
+TEST_F(SensorClientTest, busy_poll_get_packet) {
+    CaptureOptions capture;
+    capture.busy_poll_usec = 50;
+    for (double buffer_time : {0.0, 1.0}) {
+        SensorClient client({Sensor("127.0.0.1", config_)}, {info_}, 45,
+                            buffer_time, ReceiveTimestampMode::USERSPACE,
+                            capture);
+
+        // spinning still honors the timeout
+        auto start = std::chrono::steady_clock::now();
+        EXPECT_EQ(client.get_packet(0.05).type, ClientEvent::PollTimeout);
+        EXPECT_GE(std::chrono::steady_clock::now() - start,
+                  std::chrono::milliseconds(50));
+
+        LoopbackSender sender;
+        sender.send(config_.udp_port_lidar.value(),
+                    std::vector<uint8_t>(pf_->lidar_packet_size, 7));
+        auto ev = client.get_packet(1.0);
+        ASSERT_EQ(ev.type, ClientEvent::Packet);
+        EXPECT_EQ(ev.packet().type(), PacketType::Lidar);
+        EXPECT_EQ(ev.packet().buf[0], 7);
+    }
+}
+
+TEST_F(SensorClientTest, stats_report_kernel_drops) {
+    CaptureOptions capture;
+    capture.receive_buffer_bytes = 4096;
+    SensorClient client({Sensor("127.0.0.1", config_)}, {info_}, 45, 0,
+                        ReceiveTimestampMode::USERSPACE, capture);
+    auto stats = client.stats();
+    EXPECT_EQ(stats.buffer_dropped_packets, 0u);
+#ifdef __linux__
+    EXPECT_EQ(stats.kernel_dropped_packets, 0);
+
+    // overflow the tiny receive buffer without reading
+    LoopbackSender sender;
+    for (int i = 0; i < 32; i++) {
+        sender.send(config_.udp_port_lidar.value(),
+                    std::vector<uint8_t>(pf_->lidar_packet_size, 0));
+    }
+    EXPECT_GT(client.stats().kernel_dropped_packets, 0);
+#else
+    EXPECT_EQ(stats.kernel_dropped_packets, -1);
+#endif
+}
+
+TEST_F(SensorClientTest, latency_stats) {
+    SensorClient client({Sensor("127.0.0.1", config_)}, {info_}, 45, 1.0);
+    LoopbackSender sender;
+    std::vector<uint8_t> buf(pf_->lidar_packet_size, 0);
+    sender.send(config_.udp_port_lidar.value(), buf);
+    ASSERT_EQ(client.get_packet(1.0).type, ClientEvent::Packet);
+    // nothing is recorded until enabled
+    EXPECT_EQ(client.stats().lidar_packets, 0u);
+    EXPECT_EQ(client.stats().delivery_latency.count, 0u);
+
+    client.enable_latency_stats();
+    const size_t n_lidar = 4;
+    for (size_t i = 0; i < n_lidar; i++) {
+        sender.send(config_.udp_port_lidar.value(), buf);
+    }
+    // let them all wait in the buffer
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    size_t received = 0;
+    for (size_t i = 0; i < 10 && received < n_lidar; i++) {
+        if (client.get_packet(0.5).type == ClientEvent::Packet) received++;
+    }
+    ASSERT_EQ(received, n_lidar);
+
+    auto stats = client.stats();
+    EXPECT_EQ(stats.lidar_packets, n_lidar);
+    EXPECT_EQ(stats.imu_packets, 0u);
+    EXPECT_EQ(stats.buffer_depth, 0u);
+    EXPECT_EQ(stats.max_buffer_depth, n_lidar);
+    EXPECT_EQ(stats.delivery_latency.count, n_lidar);
+    EXPECT_GE(stats.delivery_latency.min, 50000000u);
+    EXPECT_LE(stats.delivery_latency.p50, stats.delivery_latency.max);
+
+    client.enable_latency_stats(false);
+    sender.send(config_.udp_port_lidar.value(), buf);
+    ASSERT_EQ(client.get_packet(1.0).type, ClientEvent::Packet);
+    EXPECT_EQ(client.stats().lidar_packets, n_lidar);
+}
+
+TEST_F(SensorClientTest, scan_source_latency_stats) {
+    // large enough for the kernel not to drop any packets of a burst
+    ReceiveThreadOptions options;
+    options.capture.receive_buffer_bytes = 8 * 1024 * 1024;
+    SensorScanSource source({Sensor("127.0.0.1", config_)}, {info_}, {}, 45,
+                            4, false, options);
+    source.enable_latency_stats();
+
+    LoopbackSender sender;
+    std::vector<int64_t> frame_ids;
+    for (uint32_t frame : {10, 11, 12}) {
+        for (const auto& p : frame_packets(info_, frame)) {
+            sender.send(config_.udp_port_lidar.value(), p.buf);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        auto res = source.get_scan(1.0);
+        if (res.second) frame_ids.push_back(res.second->frame_id);
+    }
+    ASSERT_GE(frame_ids.size(), 1u);
+
+    auto stats = source.stats();
+    EXPECT_EQ(stats.scans, frame_ids.size());
+    EXPECT_EQ(stats.scan_latency.count, frame_ids.size());
+    EXPECT_EQ(stats.queue_latency.count, frame_ids.size());
+    EXPECT_GE(stats.batch_latency.count, frame_ids.size());
+    EXPECT_GE(stats.max_queue_depth, 1u);
+    // the scans waited in the queue while we slept
+    EXPECT_GE(stats.queue_latency.max, 10000000u);
+    EXPECT_GE(stats.scan_latency.max, stats.queue_latency.max);
+    ASSERT_EQ(stats.clients.size(), 1u);
+    EXPECT_GT(stats.clients[0].lidar_packets, 0u);
+    EXPECT_GT(stats.clients[0].delivery_latency.count, 0u);
+    ASSERT_EQ(stats.batched_scans.size(), 1u);
+    EXPECT_GE(stats.batched_scans[0], frame_ids.size());
+    EXPECT_GT(stats.batched_packets[0], stats.batched_scans[0]);
+    EXPECT_EQ(stats.incomplete_scans[0], 0u);
+}
+
+TEST_F(SensorClientTest, scan_source_counts_missing_frames) {
+    ReceiveThreadOptions options;
+    options.capture.receive_buffer_bytes = 8 * 1024 * 1024;
+    SensorScanSource source({Sensor("127.0.0.1", config_)}, {info_}, {}, 45,
+                            4, false, options);
+
+    LoopbackSender sender;
+    std::vector<int64_t> frame_ids;
+    for (uint32_t frame : {10, 11, 14, 15}) {
+        for (const auto& p : frame_packets(info_, frame)) {
+            sender.send(config_.udp_port_lidar.value(), p.buf);
+        }
+        auto res = source.get_scan(1.0);
+        if (res.second) frame_ids.push_back(res.second->frame_id);
+    }
+    auto stats = source.stats();
+    ASSERT_EQ(stats.missing_frames.size(), 1u);
+    ASSERT_GE(frame_ids.size(), 2u);
+    // every frame we never received was counted as missing
+    uint64_t expected = (frame_ids.back() - frame_ids.front() + 1) -
+                        frame_ids.size();
+    EXPECT_EQ(stats.missing_frames[0], expected);
+    EXPECT_EQ(stats.dropped_scans, 0u);
+    EXPECT_EQ(stats.id_errors, 0u);
+}
+
+TEST_F(SensorClientTest, packet_callback) {
+    SensorClient client({Sensor("127.0.0.1", config_)}, {info_}, 45);
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<PooledPacket> received;
+    client.set_packet_callback([&](ClientEvent& ev) {
+        if (ev.type != ClientEvent::Packet) return;
+        std::lock_guard<std::mutex> lock(mutex);
+        received.push_back(ev.pooled_packet());
+        cv.notify_all();
+    });
+
+    const size_t n_lidar = 4;
+    LoopbackSender sender;
+    for (size_t i = 0; i < n_lidar; i++) {
+        sender.send(config_.udp_port_lidar.value(),
+                    std::vector<uint8_t>(pf_->lidar_packet_size, (uint8_t)i));
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait_for(lock, std::chrono::seconds(5),
+                    [&] { return received.size() >= n_lidar; });
+    }
+    client.set_packet_callback(nullptr);
+    ASSERT_EQ(received.size(), n_lidar);
+    for (size_t i = 0; i < n_lidar; i++) {
+        EXPECT_EQ(received[i]->type(), PacketType::Lidar);
+        EXPECT_EQ(received[i]->buf[0], i);
+    }
+}
+
+TEST_F(SensorClientTest, scan_source_callbacks) {
+    SensorScanSource source({Sensor("127.0.0.1", config_)}, {info_}, 45, 4);
+
+    // scans reach the callback through the executor, not the queue
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<std::function<void()>> tasks;
+    std::vector<int64_t> frame_ids;
+    std::atomic<size_t> packets{0};
+    source.set_packet_callback(
+        [&](int sensor_idx, const ouster::sensor::Packet& packet) {
+            EXPECT_EQ(sensor_idx, 0);
+            EXPECT_EQ(packet.type(), PacketType::Lidar);
+            packets++;
+        });
+    source.set_scan_callback(
+        [&](int sensor_idx, std::unique_ptr<LidarScan> scan) {
+            EXPECT_EQ(sensor_idx, 0);
+            ASSERT_TRUE(scan);
+            frame_ids.push_back(scan->frame_id);
+        },
+        [&](std::function<void()> task) {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+            cv.notify_all();
+        });
+
+    LoopbackSender sender;
+    size_t sent = 0;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    for (uint32_t frame = 10;
+         std::chrono::steady_clock::now() < deadline && frame_ids.empty();
+         frame++) {
+        for (const auto& p : frame_packets(info_, frame)) {
+            sender.send(config_.udp_port_lidar.value(), p.buf);
+            sent++;
+        }
+        std::vector<std::function<void()>> ready;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait_for(lock, std::chrono::milliseconds(200),
+                        [&] { return !tasks.empty(); });
+            std::swap(ready, tasks);
+        }
+        for (auto& task : ready) task();
+    }
+    ASSERT_FALSE(frame_ids.empty());
+    EXPECT_GT(packets.load(), 0u);
+    EXPECT_LE(packets.load(), sent);
+    EXPECT_FALSE(source.get_scan(0.0).second);
+
+    // a one shot callback goes ahead of the scan callback
+    std::promise<int64_t> next;
+    source.async_next_scan(
+        [&](int, std::unique_ptr<LidarScan> scan) {
+            next.set_value(scan ? scan->frame_id : -1);
+        });
+    auto next_frame = next.get_future();
+    source.set_scan_callback(nullptr);
+    source.set_packet_callback(nullptr);
+    for (uint32_t frame = 100;
+         next_frame.wait_for(std::chrono::milliseconds(200)) !=
+             std::future_status::ready &&
+         frame < 120;
+         frame++) {
+        for (const auto& p : frame_packets(info_, frame)) {
+            sender.send(config_.udp_port_lidar.value(), p.buf);
+        }
+    }
+    EXPECT_GE(next_frame.get(), 100);
+
+    // callbacks get a null scan once closed
+    source.close();
+    source.flush();
+    bool closed = false;
+    source.async_next_scan([&](int, std::unique_ptr<LidarScan> scan) {
+        closed = scan == nullptr;
+    });
+    EXPECT_TRUE(closed);
+
+    // and the ones waiting at close get one too
+    SensorScanSource idle({Sensor("127.0.0.1", config_)}, {info_}, 45, 4);
+    closed = false;
+    idle.async_next_scan([&](int, std::unique_ptr<LidarScan> scan) {
+        closed = scan == nullptr;
+    });
+    idle.close();
+    EXPECT_TRUE(closed);
+}
+
+class ClientPollerTest
+    : public ::testing::TestWithParam<impl::poller_backend> {};
+
+TEST_P(ClientPollerTest, poll_sockets) {
+#ifndef __linux__
+    if (GetParam() == impl::poller_backend::EPOLL) {
+        EXPECT_THROW(impl::make_poller(GetParam()), std::invalid_argument);
+        return;
+    }
+#endif
+    auto poller = impl::make_poller(GetParam());
+    EXPECT_NE(impl::get_backend(*poller), impl::poller_backend::AUTO);
+
+    std::vector<int> ports = {free_udp_port(), free_udp_port()};
+    std::vector<SOCKET> socks;
+    for (auto port : ports) socks.push_back(bound_udp_socket(port));
+
+    impl::reset_poll(*poller);
+    for (auto sock : socks) impl::set_poll_socket(*poller, sock);
+    EXPECT_EQ(impl::poll_for(*poller, 0.01), 0);
+
+    LoopbackSender sender;
+    sender.send(ports[1], std::vector<uint8_t>(16, 0));
+
+    // registrations survive between polls without re-setting the sockets
+    for (int i = 0; i < 2; i++) {
+        EXPECT_EQ(impl::poll_for(*poller, 1.0), 1);
+        EXPECT_FALSE(impl::get_poll_socket(*poller, socks[0]));
+        EXPECT_TRUE(impl::get_poll_socket(*poller, socks[1]));
+    }
+
+    // dropping a socket from the set stops reporting it
+    impl::reset_poll(*poller);
+    impl::set_poll_socket(*poller, socks[0]);
+    EXPECT_EQ(impl::poll_for(*poller, 0.01), 0);
+    EXPECT_FALSE(impl::get_poll_socket(*poller, socks[1]));
+
+    for (auto sock : socks) impl::socket_close(sock);
+}
+
+TEST_P(ClientPollerTest, sub_millisecond_timeout_waits) {
+#ifndef __linux__
+    if (GetParam() == impl::poller_backend::EPOLL) return;
+#endif
+    auto poller = impl::make_poller(GetParam());
+    SOCKET sock = bound_udp_socket(free_udp_port());
+    impl::reset_poll(*poller);
+    impl::set_poll_socket(*poller, sock);
+
+    // a positive timeout must block rather than return immediately
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 10; i++) EXPECT_EQ(impl::poll_for(*poller, 0.0005), 0);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_GE(elapsed, std::chrono::microseconds(10 * 500));
+
+    impl::socket_close(sock);
+}
+
+INSTANTIATE_TEST_CASE_P(ClientPollerBackends, ClientPollerTest,
+                        ::testing::Values(impl::poller_backend::AUTO,
+                                          impl::poller_backend::SELECT,
+                                          impl::poller_backend::EPOLL));
+
+TEST_F(SensorClientTest, scan_source_thread_per_sensor) {
+    std::vector<sensor_info> infos = {info_, info_};
+    infos[1].config.udp_port_lidar = free_udp_port();
+    infos[1].config.udp_port_imu = free_udp_port();
+    std::vector<Sensor> sensors;
+    for (const auto& info : infos) {
+        sensor_config config;
+        config.udp_port_lidar = info.config.udp_port_lidar;
+        config.udp_port_imu = info.config.udp_port_imu;
+        sensors.emplace_back("127.0.0.1", config);
+    }
+
+    ReceiveThreadOptions options;
+    options.thread_per_sensor = true;
+    SensorScanSource source(sensors, infos, {}, 45, 4, false, options);
+    ASSERT_EQ(source.get_sensor_info().size(), 2u);
+
+    // keep sending frames in case the kernel drops part of a burst
+    LoopbackSender sender;
+    std::set<int> sources;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    for (uint32_t frame = 0;
+         sources.size() < 2 && std::chrono::steady_clock::now() < deadline;
+         frame++) {
+        for (size_t i = 0; i < infos.size(); i++) {
+            for (const auto& p : frame_packets(infos[i], frame)) {
+                sender.send(infos[i].config.udp_port_lidar.value(), p.buf);
+            }
+        }
+        auto res = source.get_scan(0.2);
+        while (res.second) {
+            sources.insert(res.first);
+            res = source.get_scan(0.0);
+        }
+    }
+    EXPECT_EQ(sources, (std::set<int>{0, 1}));
+}
+
+TEST_F(SensorClientTest, scan_source_thread_per_sensor_shared_ports) {
+    std::vector<sensor_info> infos = {info_, info_};
+    std::vector<Sensor> sensors(2, Sensor("127.0.0.1", config_));
+
+    ReceiveThreadOptions options;
+    options.thread_per_sensor = true;
+    EXPECT_THROW(SensorScanSource(sensors, infos, {}, 45, 4, false, options),
+                 std::invalid_argument);
+}
+
+TEST_F(SensorClientTest, scan_source_synchronized_scans) {
+    std::vector<sensor_info> infos = {info_, info_};
+    infos[1].config.udp_port_lidar = free_udp_port();
+    infos[1].config.udp_port_imu = free_udp_port();
+    std::vector<Sensor> sensors;
+    for (const auto& info : infos) {
+        sensor_config config;
+        config.udp_port_lidar = info.config.udp_port_lidar;
+        config.udp_port_imu = info.config.udp_port_imu;
+        sensors.emplace_back("127.0.0.1", config);
+    }
+    // both sensors send from loopback, so give each its own client
+    ReceiveThreadOptions options;
+    options.thread_per_sensor = true;
+    SensorScanSource source(sensors, infos, {}, 45, 4, false, options);
+
+    // every generated frame has the same timestamps, so any pair matches
+    LoopbackSender sender;
+    ScanSet set;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    for (uint32_t frame = 0;
+         !set.complete() && std::chrono::steady_clock::now() < deadline;
+         frame++) {
+        for (size_t i = 0; i < infos.size(); i++) {
+            for (const auto& p : frame_packets(infos[i], frame)) {
+                sender.send(infos[i].config.udp_port_lidar.value(), p.buf);
+            }
+        }
+        source.recycle(std::move(set));
+        set = source.get_synchronized_scans(0.2, 0.01);
+    }
+    ASSERT_TRUE(set.complete());
+    EXPECT_EQ(set.size(), 2u);
+    EXPECT_EQ(set.scans[0]->get_first_valid_column_timestamp(),
+              set.scans[1]->get_first_valid_column_timestamp());
+    source.recycle(std::move(set));
+    EXPECT_TRUE(set.scans.empty());
+}
+
+TEST_F(SensorClientTest, scan_source_partial_synchronized_scans) {
+    std::vector<sensor_info> infos = {info_, info_};
+    infos[1].config.udp_port_lidar = free_udp_port();
+    infos[1].config.udp_port_imu = free_udp_port();
+    std::vector<Sensor> sensors;
+    for (const auto& info : infos) {
+        sensor_config config;
+        config.udp_port_lidar = info.config.udp_port_lidar;
+        config.udp_port_imu = info.config.udp_port_imu;
+        sensors.emplace_back("127.0.0.1", config);
+    }
+    // both sensors send from loopback, so give each its own client
+    ReceiveThreadOptions options;
+    options.thread_per_sensor = true;
+    SensorScanSource source(sensors, infos, {}, 45, 4, false, options);
+
+    // nothing arrived at all
+    auto set = source.get_synchronized_scans(0.05, 0.01);
+    EXPECT_EQ(set.scans.size(), 2u);
+    EXPECT_EQ(set.size(), 0u);
+
+    // only the first sensor sends, so sets time out partial
+    LoopbackSender sender;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    for (uint32_t frame = 0;
+         set.size() == 0 && std::chrono::steady_clock::now() < deadline;
+         frame++) {
+        for (const auto& p : frame_packets(infos[0], frame)) {
+            sender.send(infos[0].config.udp_port_lidar.value(), p.buf);
+        }
+        set = source.get_synchronized_scans(0.2, 0.01);
+    }
+    ASSERT_EQ(set.size(), 1u);
+    EXPECT_FALSE(set.complete());
+    EXPECT_NE(set.scans[0], nullptr);
+    EXPECT_EQ(set.scans[1], nullptr);
+}
+
+TEST_F(SensorClientTest, startup_reports_every_failed_sensor) {
+    // nothing serves http on these addresses, so every sensor fails to start
+    std::vector<Sensor> sensors{Sensor("127.0.0.1", config_),
+                                Sensor("127.0.0.2", config_)};
+    std::mutex mutex;
+    std::map<size_t, std::vector<StartupStage>> stages;
+    CaptureOptions options;
+    options.startup_progress = [&](size_t sensor, StartupStage stage,
+                                   const std::string&) {
+        std::lock_guard<std::mutex> lock(mutex);
+        stages[sensor].push_back(stage);
+    };
+
+    try {
+        SensorClient client(sensors, 5, 0, ReceiveTimestampMode::USERSPACE,
+                            options);
+        FAIL() << "expected the startup to fail";
+    } catch (const std::runtime_error& e) {
+        const std::string message = e.what();
+        EXPECT_NE(message.find("'127.0.0.1'"), std::string::npos);
+        EXPECT_NE(message.find("'127.0.0.2'"), std::string::npos);
+    }
+
+    ASSERT_EQ(stages.size(), 2u);
+    for (const auto& sensor : stages) {
+        EXPECT_EQ(sensor.second.front(), StartupStage::FETCHING_METADATA);
+        EXPECT_EQ(sensor.second.back(), StartupStage::FAILED);
+    }
+}
+
+TEST_F(SensorClientTest, startup_checks_metadata_cache) {
+    // a cached sensor is only trusted once it reports the same init_id, so
+    // an unreachable sensor falls back to fetching its metadata and fails
+    const std::string dir = ::testing::TempDir();
+    {
+        std::ofstream out(dir + "/127.0.0.1.json");
+        out << info_.to_json_string();
+    }
+
+    std::vector<StartupStage> stages;
+    CaptureOptions options;
+    options.metadata_cache_dir = dir;
+    options.startup_progress = [&](size_t, StartupStage stage,
+                                   const std::string&) {
+        stages.push_back(stage);
+    };
+    EXPECT_THROW(SensorClient({Sensor("127.0.0.1", config_)}, 5, 0,
+                              ReceiveTimestampMode::USERSPACE, options),
+                 std::runtime_error);
+    std::vector<StartupStage> expected{StartupStage::CHECKING_CACHE,
+                                       StartupStage::FETCHING_METADATA,
+                                       StartupStage::FAILED};
+    EXPECT_EQ(stages, expected);
+}
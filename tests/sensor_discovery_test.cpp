@@ -0,0 +1,269 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/sensor_discovery.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ouster/impl/netcompat.h"
+
+using namespace ouster::sensor;
+
+namespace {
+
+sockaddr_in loopback(int port) {
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    return addr;
+}
+
+int bound_port(SOCKET sock) {
+    sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    getsockname(sock, reinterpret_cast<sockaddr*>(&addr), &len);
+    return ntohs(addr.sin_port);
+}
+
+void put_name(std::vector<uint8_t>& out, const std::string& name) {
+    size_t start = 0;
+    while (start < name.size()) {
+        size_t end = name.find('.', start);
+        if (end == std::string::npos) end = name.size();
+        out.push_back(static_cast<uint8_t>(end - start));
+        out.insert(out.end(), name.begin() + start, name.begin() + end);
+        start = end + 1;
+    }
+    out.push_back(0);
+}
+
+void put16(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value & 0xff));
+}
+
+// PTR, SRV and A records of a sensor, the SRV pointing back at the PTR data
+std::vector<uint8_t> sensor_response(const std::string& service) {
+    std::vector<uint8_t> msg = {0, 0, 0x84, 0, 0, 0, 0, 3, 0, 0, 0, 0};
+    const std::string instance = "Ouster Sensor 122246000293";
+    put_name(msg, service);
+    put16(msg, 12);
+    put16(msg, 1);
+    msg.insert(msg.end(), {0, 0, 0, 120});
+    const size_t instance_offset = msg.size() + 2;
+    std::vector<uint8_t> ptr;
+    ptr.push_back(static_cast<uint8_t>(instance.size()));
+    ptr.insert(ptr.end(), instance.begin(), instance.end());
+    put_name(ptr, service);
+    put16(msg, static_cast<uint16_t>(ptr.size()));
+    msg.insert(msg.end(), ptr.begin(), ptr.end());
+
+    // compressed owner name
+    msg.push_back(static_cast<uint8_t>(0xc0 | instance_offset >> 8));
+    msg.push_back(static_cast<uint8_t>(instance_offset & 0xff));
+    put16(msg, 33);
+    put16(msg, 1);
+    msg.insert(msg.end(), {0, 0, 0, 120});
+    std::vector<uint8_t> srv = {0, 0, 0, 0, 0, 80};
+    put_name(srv, "os-122246000293.local");
+    put16(msg, static_cast<uint16_t>(srv.size()));
+    msg.insert(msg.end(), srv.begin(), srv.end());
+
+    put_name(msg, "os-122246000293.local");
+    put16(msg, 1);
+    put16(msg, 1);
+    msg.insert(msg.end(), {0, 0, 0, 120, 0, 4, 127, 0, 0, 1});
+    return msg;
+}
+
+// Answers every mDNS query on loopback with the given responses
+class FakeResponder {
+   public:
+    explicit FakeResponder(std::vector<std::vector<uint8_t>> responses)
+        : sock_(socket(AF_INET, SOCK_DGRAM, 0)),
+          responses_(std::move(responses)) {
+        auto addr = loopback(0);
+        bind(sock_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        ouster::sensor::impl::socket_set_rcvtimeout(sock_, 1);
+        thread_ = std::thread([this] { serve(); });
+    }
+
+    ~FakeResponder() {
+        stop_ = true;
+        thread_.join();
+        ouster::sensor::impl::socket_close(sock_);
+    }
+
+    int port() const { return bound_port(sock_); }
+    int queries() const { return queries_; }
+    std::vector<uint8_t> last_query() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return last_query_;
+    }
+
+   private:
+    void serve() {
+        uint8_t buf[2048];
+        while (!stop_) {
+            sockaddr_in from;
+            socklen_t len = sizeof(from);
+            auto n = recvfrom(sock_, reinterpret_cast<char*>(buf), sizeof(buf),
+                              0, reinterpret_cast<sockaddr*>(&from), &len);
+            if (n <= 0) continue;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                last_query_.assign(buf, buf + n);
+            }
+            queries_++;
+            for (const auto& response : responses_) {
+                sendto(sock_, reinterpret_cast<const char*>(response.data()),
+                       static_cast<int>(response.size()), 0,
+                       reinterpret_cast<sockaddr*>(&from), len);
+            }
+        }
+    }
+
+    SOCKET sock_;
+    std::vector<std::vector<uint8_t>> responses_;
+    std::atomic<bool> stop_{false};
+    std::atomic<int> queries_{0};
+    std::mutex mutex_;
+    std::vector<uint8_t> last_query_;
+    std::thread thread_;
+};
+
+// Serves a fixed sensor_info to one request per connection
+class FakeSensorApi {
+   public:
+    FakeSensorApi() : sock_(socket(AF_INET, SOCK_STREAM, 0)) {
+        auto addr = loopback(0);
+        bind(sock_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        listen(sock_, 16);
+        ouster::sensor::impl::socket_set_rcvtimeout(sock_, 1);
+        thread_ = std::thread([this] { serve(); });
+    }
+
+    ~FakeSensorApi() {
+        stop_ = true;
+        thread_.join();
+        ouster::sensor::impl::socket_close(sock_);
+    }
+
+    int port() const { return bound_port(sock_); }
+
+   private:
+    void serve() {
+        const std::string body =
+            R"({"prod_sn": "122246000293", "prod_line": "OS-1-128",)"
+            R"( "image_rev": "ousteros-image-prod-aries-v3.0.1",)"
+            R"( "status": "RUNNING"})";
+        while (!stop_) {
+            SOCKET conn = accept(sock_, nullptr, nullptr);
+            if (!ouster::sensor::impl::socket_valid(conn)) continue;
+            std::string request;
+            char buf[1024];
+            ouster::sensor::impl::socket_set_rcvtimeout(conn, 1);
+            while (request.find("\r\n\r\n") == std::string::npos) {
+                auto n = recv(conn, buf, sizeof(buf), 0);
+                if (n <= 0) break;
+                request.append(buf, n);
+            }
+            const bool known =
+                request.find("/api/v1/sensor/metadata/sensor_info") !=
+                std::string::npos;
+            std::string response =
+                known ? "HTTP/1.1 200 OK\r\nContent-Length: " +
+                            std::to_string(body.size()) +
+                            "\r\nConnection: close\r\n\r\n" + body
+                      : "HTTP/1.1 404 Not Found\r\nContent-Length: 0"
+                        "\r\nConnection: close\r\n\r\n";
+            send(conn, response.data(), response.size(), 0);
+            ouster::sensor::impl::socket_close(conn);
+        }
+    }
+
+    SOCKET sock_;
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+};
+
+}  // namespace
+
+TEST(SensorDiscoveryTest, finds_and_probes_responders) {
+    FakeSensorApi api;
+    // duplicate answers and answers of other services are ignored
+    auto other = sensor_response("_http._tcp.local");
+    FakeResponder responder({sensor_response("_ouster-lidar._tcp.local"),
+                             sensor_response("_roger._tcp.local"), other});
+
+    DiscoveryOptions options;
+    options.timeout_sec = 1.5;
+    options.mdns_address = "127.0.0.1";
+    options.mdns_port = responder.port();
+    options.http_port = api.port();
+
+    std::vector<DiscoveredSensor> reported;
+    auto found = discover_sensors(
+        options, [&](const DiscoveredSensor& s) { reported.push_back(s); });
+
+    ASSERT_EQ(found.size(), 1u);
+    ASSERT_EQ(reported.size(), 1u);
+    const auto& sensor = found[0];
+    EXPECT_TRUE(sensor.ok()) << sensor.error;
+    EXPECT_EQ(sensor.address, "127.0.0.1");
+    EXPECT_EQ(sensor.hostname, "os-122246000293.local");
+    EXPECT_EQ(sensor.sn, 122246000293u);
+    EXPECT_EQ(sensor.prod_line, "OS-1-128");
+    EXPECT_EQ(sensor.image_rev, "ousteros-image-prod-aries-v3.0.1");
+    EXPECT_EQ(sensor.status, "RUNNING");
+    EXPECT_EQ(reported[0].sensor_info, sensor.sensor_info);
+
+    // the query is repeated and asks for PTR records of both services
+    EXPECT_GE(responder.queries(), 2);
+    const auto query = responder.last_query();
+    ASSERT_GE(query.size(), 12u);
+    EXPECT_EQ(query[5], 2);
+    EXPECT_NE(std::string(query.begin(), query.end()).find("ouster-lidar"),
+              std::string::npos);
+}
+
+TEST(SensorDiscoveryTest, reports_sensors_that_fail_to_answer) {
+    // nothing listens on the port of a closed api
+    int closed_port = 0;
+    {
+        FakeSensorApi api;
+        closed_port = api.port();
+    }
+    FakeResponder responder({sensor_response("_ouster-lidar._tcp.local")});
+
+    DiscoveryOptions options;
+    options.timeout_sec = 0.5;
+    options.mdns_address = "127.0.0.1";
+    options.mdns_port = responder.port();
+    options.http_port = closed_port;
+    auto found = discover_sensors(options);
+    ASSERT_EQ(found.size(), 1u);
+    EXPECT_FALSE(found[0].ok());
+    EXPECT_EQ(found[0].hostname, "os-122246000293.local");
+    EXPECT_TRUE(found[0].sensor_info.empty());
+}
+
+TEST(SensorDiscoveryTest, invalid_addresses) {
+    DiscoveryOptions options;
+    options.mdns_address = "not an address";
+    EXPECT_THROW(discover_sensors(options), std::invalid_argument);
+    options = DiscoveryOptions{};
+    options.interface_address = "300.1.1.1";
+    EXPECT_THROW(discover_sensors(options), std::invalid_argument);
+}
@@ -0,0 +1,255 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/sensor_http.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ouster/client.h"
+#include "ouster/impl/netcompat.h"
+
+using namespace ouster::sensor;
+using namespace ouster::sensor::util;
+
+namespace {
+
+// Minimal keep-alive HTTP server on loopback answering every GET with its
+// path, counting the connections it accepted
+class LoopbackHttpServer {
+   public:
+    LoopbackHttpServer() : sock_(socket(AF_INET, SOCK_STREAM, 0)) {
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        bind(sock_, (sockaddr*)&addr, sizeof(addr));
+        listen(sock_, 16);
+        socklen_t len = sizeof(addr);
+        getsockname(sock_, (sockaddr*)&addr, &len);
+        port_ = ntohs(addr.sin_port);
+        impl::socket_set_rcvtimeout(sock_, 1);
+        thread_ = std::thread([this] { serve(); });
+    }
+
+    ~LoopbackHttpServer() {
+        stop_ = true;
+        thread_.join();
+        for (auto& t : connections_) t.join();
+        impl::socket_close(sock_);
+    }
+
+    std::string hostname() const {
+        return "127.0.0.1:" + std::to_string(port_);
+    }
+
+    int accepted() const { return accepted_; }
+
+   private:
+    void serve() {
+        while (!stop_) {
+            SOCKET conn = accept(sock_, nullptr, nullptr);
+            if (!impl::socket_valid(conn)) continue;
+            accepted_++;
+            connections_.emplace_back([this, conn] { respond(conn); });
+        }
+    }
+
+    void respond(SOCKET conn) {
+        impl::socket_set_rcvtimeout(conn, 1);
+        std::string request;
+        char buf[1024];
+        while (!stop_) {
+            auto n = recv(conn, buf, sizeof(buf), 0);
+            if (n == 0) break;
+            if (n < 0) continue;
+            request.append(buf, n);
+            auto end = request.find("\r\n\r\n");
+            if (end == std::string::npos) continue;
+            auto path = request.substr(4, request.find(' ', 4) - 4);
+            request.erase(0, end + 4);
+            std::string response =
+                "HTTP/1.1 200 OK\r\nContent-Length: " +
+                std::to_string(path.size()) +
+                "\r\nConnection: keep-alive\r\n\r\n" + path;
+            send(conn, response.data(), response.size(), 0);
+        }
+        impl::socket_close(conn);
+    }
+
+    SOCKET sock_;
+    int port_;
+    std::atomic<bool> stop_{false};
+    std::atomic<int> accepted_{0};
+    std::thread thread_;
+    std::vector<std::thread> connections_;
+};
+
+// Records the calls set_config makes, reporting fixed active config params
+class RecordingSensorHttp : public SensorHttp {
+   public:
+    explicit RecordingSensorHttp(std::string active)
+        : active_(std::move(active)) {}
+
+    mutable std::vector<std::string> calls;
+
+    std::string metadata(int) const override { return "{}"; }
+    std::string sensor_info(int) const override { return "{}"; }
+    std::string get_config_params(bool, int) const override { return active_; }
+    void set_config_param(const std::string& key, const std::string&,
+                          int) const override {
+        calls.push_back("set_config_param " + key);
+    }
+    std::string active_config_params(int) const override { return active_; }
+    std::string staged_config_params(int) const override { return active_; }
+    void set_udp_dest_auto(int) const override {
+        calls.push_back("set_udp_dest_auto");
+    }
+    std::string beam_intrinsics(int) const override { return "{}"; }
+    std::string imu_intrinsics(int) const override { return "{}"; }
+    std::string lidar_intrinsics(int) const override { return "{}"; }
+    std::string lidar_data_format(int) const override { return "{}"; }
+    std::string calibration_status(int) const override { return "{}"; }
+    void reinitialize(int) const override { calls.push_back("reinitialize"); }
+    void save_config_params(int) const override {
+        calls.push_back("save_config_params");
+    }
+    std::string get_user_data(int) const override { return ""; }
+    UserDataAndPolicy get_user_data_and_policy(int) const override {
+        return {};
+    }
+    void set_user_data(const std::string&, bool, int) const override {}
+    std::string network(int) const override { return "{}"; }
+    void set_static_ip(const std::string&, int) const override {}
+    void delete_static_ip(int) const override {}
+    void delete_user_data(int) const override {}
+    std::vector<uint8_t> diagnostics_dump(int) const override { return {}; }
+
+   private:
+    std::string active_;
+};
+
+}  // namespace
+
+TEST(MultiSensorHttpTest, get_reuses_connections) {
+    LoopbackHttpServer a, b;
+    MultiSensorHttp http({a.hostname(), b.hostname()});
+    ASSERT_EQ(http.hostnames().size(), 2u);
+
+    for (int i = 0; i < 3; i++) {
+        auto responses = http.get("api/v1/sensor/metadata/sensor_info", 5);
+        ASSERT_EQ(responses.size(), 2u);
+        for (const auto& response : responses) {
+            EXPECT_TRUE(response.ok()) << response.error;
+            EXPECT_EQ(response.body, "/api/v1/sensor/metadata/sensor_info");
+        }
+    }
+    EXPECT_EQ(a.accepted(), 1);
+    EXPECT_EQ(b.accepted(), 1);
+}
+
+TEST(MultiSensorHttpTest, failures_are_per_sensor) {
+    LoopbackHttpServer a;
+    // nothing listens on the port of a closed server
+    std::string closed;
+    {
+        LoopbackHttpServer b;
+        closed = b.hostname();
+    }
+    MultiSensorHttp http({closed, a.hostname()});
+    auto responses = http.get("api/v1/system/firmware", 5);
+    ASSERT_EQ(responses.size(), 2u);
+    EXPECT_FALSE(responses[0].ok());
+    EXPECT_FALSE(responses[0].error.empty());
+    EXPECT_EQ(responses[0].status, 0);
+    EXPECT_TRUE(responses[1].ok());
+    EXPECT_EQ(responses[1].status, 200);
+    EXPECT_EQ(responses[1].body, "/api/v1/system/firmware");
+}
+
+TEST(SetConfigTest, skips_reinitialize_without_changes) {
+    // numbers the sensor reports in another representation are unchanged
+    RecordingSensorHttp http(
+        R"({"lidar_mode": "1024x10", "signal_multiplier": 2,)"
+        R"( "udp_dest": "10.0.0.2", "udp_port_lidar": 7502,)"
+        R"( "lidar_frame_azimuth_window": [0, 360000]})");
+    sensor_config config;
+    config.lidar_mode = MODE_1024x10;
+    config.signal_multiplier = 2.0;
+    config.udp_dest = "10.0.0.2";
+    config.udp_port_lidar = 7502;
+    config.azimuth_window = std::make_pair(0, 360000);
+    // params the sensor doesn't report are unknown to its FW
+    config.min_range_threshold_cm = 30;
+
+    set_config(http, config, CONFIG_PERSIST);
+    EXPECT_EQ(http.calls, std::vector<std::string>{"save_config_params"});
+
+    http.calls.clear();
+    set_config(http, config, CONFIG_FORCE_REINIT);
+    EXPECT_EQ(http.calls, (std::vector<std::string>{"set_config_param .",
+                                                     "reinitialize"}));
+}
+
+TEST(SetConfigTest, applies_changes_in_one_request) {
+    RecordingSensorHttp http(
+        R"({"lidar_mode": "1024x10", "udp_port_lidar": 7502,)"
+        R"( "udp_port_imu": 7503})");
+    sensor_config config;
+    config.lidar_mode = MODE_2048x10;
+    config.udp_port_lidar = 7600;
+    config.udp_port_imu = 7601;
+
+    set_config(http, config);
+    EXPECT_EQ(http.calls, (std::vector<std::string>{"set_config_param .",
+                                                     "reinitialize"}));
+}
+
+TEST(SensorHttpAsyncTest, serializes_requests_per_sensor) {
+    RecordingSensorHttp a(R"({"udp_port_lidar": 7502})");
+    RecordingSensorHttp b(R"({"udp_port_lidar": 7602})");
+
+    // requests to different sensors overlap, those to one sensor queue up
+    std::atomic<int> in_flight{0}, max_in_flight{0};
+    std::atomic<int> in_flight_a{0}, max_in_flight_a{0};
+    std::vector<std::future<void>> pending;
+    for (auto* sensor : {&a, &b, &a, &b}) {
+        pending.push_back(sensor->async([&, sensor](const SensorHttp& s) {
+            const bool is_a = sensor == &a;
+            int n = ++in_flight;
+            int n_a = is_a ? ++in_flight_a : 0;
+            max_in_flight = std::max(max_in_flight.load(), n);
+            max_in_flight_a = std::max(max_in_flight_a.load(), n_a);
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            s.reinitialize();
+            if (is_a) in_flight_a--;
+            in_flight--;
+        }));
+    }
+    auto config = b.async(
+        [](const SensorHttp& s) { return s.active_config_params(); });
+    for (auto& request : pending) request.get();
+
+    EXPECT_EQ(config.get(), R"({"udp_port_lidar": 7602})");
+    EXPECT_EQ(max_in_flight_a, 1);
+    EXPECT_EQ(max_in_flight, 2);
+    EXPECT_EQ(a.calls, (std::vector<std::string>{"reinitialize",
+                                                  "reinitialize"}));
+
+    auto failing = a.async([](const SensorHttp&) -> int {
+        throw std::runtime_error("unreachable");
+    });
+    EXPECT_THROW(failing.get(), std::runtime_error);
+}
@@ -0,0 +1,155 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/sensor_simulator.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#include "ouster/impl/netcompat.h"
+#include "ouster/sensor_client.h"
+#include "ouster/sensor_scan_source.h"
+#include "util.h"
+
+using namespace ouster::sensor;
+using ouster::LidarScan;
+
+namespace {
+
+class SensorSimulatorTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        info_ = metadata_from_json(getenvs("DATA_DIR") +
+                                   "3_0_1_os-122246000293-128.json");
+        info_.config.udp_dest = "127.0.0.1";
+        info_.config.udp_port_lidar = free_udp_port();
+        info_.config.udp_port_imu = free_udp_port();
+        config_.udp_port_lidar = info_.config.udp_port_lidar;
+        config_.udp_port_imu = info_.config.udp_port_imu;
+        options_.capture.receive_buffer_bytes = 8 * 1024 * 1024;
+    }
+
+    // collect scans until count arrive or the timeout passes
+    std::vector<LidarScan> get_scans(SensorScanSource& source, size_t count,
+                                     double timeout = 5.0) {
+        std::vector<LidarScan> scans;
+        auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::duration<double>(timeout);
+        while (scans.size() < count &&
+               std::chrono::steady_clock::now() < deadline) {
+            auto res = source.get_scan(0.2);
+            if (res.second) scans.push_back(*res.second);
+        }
+        return scans;
+    }
+
+    sensor_info info_;
+    sensor_config config_;
+    ReceiveThreadOptions options_;
+};
+
+}  // namespace
+
+TEST_F(SensorSimulatorTest, scans_arrive_complete) {
+    SensorScanSource source({Sensor("127.0.0.1", config_)}, {info_}, {}, 45,
+                            8, false, options_);
+    SimulatorOptions options;
+    options.rate = 4;
+    SensorSimulator sim({info_}, options);
+    sim.start();
+    auto scans = get_scans(source, 6);
+    sim.stop();
+
+    ASSERT_GE(scans.size(), 6u);
+    const auto& window = info_.format.column_window;
+    for (size_t i = 0; i < scans.size(); i++) {
+        EXPECT_TRUE(scans[i].complete(window));
+        EXPECT_GT(scans[i].field<uint32_t>(ChanField::RANGE).maxCoeff(), 0u);
+        if (i == 0) continue;
+        // timestamps advance in sensor time, whatever the rate
+        EXPECT_EQ(scans[i].frame_id, scans[i - 1].frame_id + 1);
+        EXPECT_EQ(scans[i].timestamp()[0] - scans[i - 1].timestamp()[0],
+                  1000000000u / info_.format.fps);
+    }
+    auto stats = sim.stats();
+    EXPECT_GE(stats.frames, scans.size());
+    EXPECT_GT(stats.imu_packets, 0u);
+    EXPECT_EQ(stats.dropped_packets, 0u);
+}
+
+TEST_F(SensorSimulatorTest, static_scene_updates_headers) {
+    SensorScanSource source({Sensor("127.0.0.1", config_)}, {info_}, {}, 45,
+                            8, false, options_);
+    SimulatorOptions options;
+    options.rate = 4;
+    SensorSimulator sim({info_}, options);
+    sim.set_scene(0, room_scene, false);
+    sim.start();
+    auto scans = get_scans(source, 3);
+    sim.stop();
+
+    ASSERT_GE(scans.size(), 3u);
+    EXPECT_EQ(source.stats().id_errors, 0u);
+    for (size_t i = 1; i < scans.size(); i++) {
+        EXPECT_EQ(scans[i].frame_id, scans[i - 1].frame_id + 1);
+        EXPECT_GT(scans[i].timestamp()[0], scans[i - 1].timestamp()[0]);
+        EXPECT_TRUE((scans[i].field<uint32_t>(ChanField::RANGE) ==
+                     scans[0].field<uint32_t>(ChanField::RANGE))
+                        .all());
+    }
+}
+
+TEST_F(SensorSimulatorTest, packet_loss_and_reordering) {
+    SimulatorOptions options;
+    options.rate = 0;
+    options.packet_loss = 0.2;
+    options.reorder = 0.2;
+    options.imu = false;
+    SensorSimulator sim({info_}, options);
+    sim.send_frames(5);
+
+    auto stats = sim.stats();
+    const uint64_t per_frame = info_.format.columns_per_frame /
+                               info_.format.columns_per_packet;
+    EXPECT_EQ(stats.frames, 5u);
+    EXPECT_EQ(stats.imu_packets, 0u);
+    EXPECT_GT(stats.dropped_packets, 0u);
+    EXPECT_GT(stats.reordered_packets, 0u);
+    EXPECT_EQ(stats.lidar_packets + stats.dropped_packets, 5 * per_frame);
+}
+
+TEST_F(SensorSimulatorTest, sensor_client_configures_over_http) {
+    SimulatorOptions options;
+    options.rate = 4;
+    options.serve_http = true;
+    // the client sets the destination ports over HTTP
+    sensor_info info = info_;
+    info.config.udp_port_lidar = 7502;
+    info.config.udp_port_imu = 7503;
+    SensorSimulator sim({info}, options);
+
+    sensor_config config = config_;
+    config.udp_dest = "@auto";
+    SensorScanSource source({Sensor(sim.hostname(0), config)}, 45, 8);
+    ASSERT_EQ(source.get_sensor_info().size(), 1u);
+    EXPECT_EQ(source.get_sensor_info()[0].sn, info_.sn);
+    auto current = sim.get_sensor_info(0);
+    EXPECT_EQ(current.config.udp_port_lidar, config_.udp_port_lidar);
+    EXPECT_EQ(current.config.udp_dest, std::string("127.0.0.1"));
+
+    sim.start();
+    auto scans = get_scans(source, 2);
+    sim.stop();
+    EXPECT_GE(scans.size(), 2u);
+}
+
+TEST_F(SensorSimulatorTest, hostname_needs_http) {
+    SensorSimulator sim({info_});
+    EXPECT_THROW(sim.hostname(0), std::logic_error);
+    EXPECT_THROW(sim.get_sensor_info(1), std::out_of_range);
+}
@@ -0,0 +1,182 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/shm_scan_channel.h"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/types.h"
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ouster;
+using namespace ouster::sensor;
+
+namespace {
+
+std::string channel_name(const std::string& test) {
+    return "/ouster_shm_scan_test_" + std::to_string(getpid()) + "_" + test;
+}
+
+LidarScan test_scan(size_t w, size_t h, uint32_t value) {
+    LidarScan ls(w, h, PROFILE_RNG19_RFL8_SIG16_NIR16);
+    ls.field<uint32_t>(ChanField::RANGE).setConstant(value);
+    ls.field<uint16_t>(ChanField::SIGNAL)(1, 2) = value + 1;
+    ls.timestamp().setConstant(value * 10);
+    ls.measurement_id()[3] = 3;
+    ls.status().setConstant(1);
+    ls.packet_timestamp()[0] = value;
+    ls.frame_id = value;
+    ls.frame_status = 5;
+    return ls;
+}
+
+}  // namespace
+
+TEST(ShmScanChannelTest, publish_and_read) {
+    const auto fields = get_field_types(PROFILE_RNG19_RFL8_SIG16_NIR16);
+    ShmScanWriter writer(channel_name("publish_and_read"), 64, 32, fields);
+    ShmScanReader reader(channel_name("publish_and_read"));
+    EXPECT_EQ(reader.field_types(), fields);
+    EXPECT_TRUE(reader.metadata().empty());
+    EXPECT_EQ(reader.next(), nullptr);
+    EXPECT_FALSE(reader.valid());
+
+    const auto scan = test_scan(64, 32, 7);
+    writer.publish(scan);
+    EXPECT_EQ(writer.published(), 1u);
+    EXPECT_EQ(reader.published(), 1u);
+
+    const LidarScan* view = reader.next();
+    ASSERT_NE(view, nullptr);
+    EXPECT_TRUE(view->is_contiguous());
+    EXPECT_EQ(view->w, 64u);
+    EXPECT_EQ(view->h, 32u);
+    EXPECT_EQ(view->frame_id, 7);
+    EXPECT_EQ(view->frame_status, 5u);
+    for (const auto& ft : fields) {
+        EXPECT_EQ(view->field(ft.name), scan.field(ft.name)) << ft.name;
+    }
+    EXPECT_TRUE((view->timestamp() == scan.timestamp()).all());
+    EXPECT_TRUE((view->measurement_id() == scan.measurement_id()).all());
+    EXPECT_TRUE((view->status() == scan.status()).all());
+    EXPECT_TRUE(
+        (view->packet_timestamp() == scan.packet_timestamp()).all());
+    EXPECT_EQ(view->pose(), scan.pose());
+    EXPECT_TRUE(reader.valid());
+    EXPECT_EQ(reader.next(), nullptr);
+
+    // a second reader maps the same scan
+    ShmScanReader other(channel_name("publish_and_read"));
+    const LidarScan* other_view = other.next();
+    ASSERT_NE(other_view, nullptr);
+    EXPECT_EQ(other_view->field(ChanField::RANGE),
+              scan.field(ChanField::RANGE));
+    EXPECT_EQ(reader.dropped(), 0u);
+    EXPECT_EQ(other.dropped(), 0u);
+}
+
+TEST(ShmScanChannelTest, slow_reader_drops_scans) {
+    const auto fields = get_field_types(PROFILE_RNG19_RFL8_SIG16_NIR16);
+    ShmScanWriter writer(channel_name("slow_reader"), 32, 16, fields, 2);
+    ShmScanReader reader(channel_name("slow_reader"));
+
+    writer.publish(test_scan(32, 16, 1));
+    const LidarScan* view = reader.next();
+    ASSERT_NE(view, nullptr);
+    EXPECT_EQ(view->frame_id, 1);
+
+    // the writer goes around the ring while the reader holds the scan
+    for (uint32_t i = 2; i <= 5; i++) writer.publish(test_scan(32, 16, i));
+    EXPECT_FALSE(reader.valid());
+
+    view = reader.next();
+    ASSERT_NE(view, nullptr);
+    EXPECT_EQ(view->frame_id, 4);
+    EXPECT_EQ(view->field<uint32_t>(ChanField::RANGE)(0, 0), 4u);
+    EXPECT_EQ(reader.dropped(), 2u);
+    view = reader.next();
+    ASSERT_NE(view, nullptr);
+    EXPECT_EQ(view->frame_id, 5);
+    EXPECT_EQ(reader.next(), nullptr);
+
+    // a new reader starts at the oldest scan in the ring
+    ShmScanReader late(channel_name("slow_reader"));
+    view = late.next();
+    ASSERT_NE(view, nullptr);
+    EXPECT_EQ(view->frame_id, 4);
+    EXPECT_EQ(late.dropped(), 0u);
+}
+
+TEST(ShmScanChannelTest, other_process_reads) {
+    auto info = default_sensor_info(MODE_512x10);
+    const auto name = channel_name("other_process");
+    ShmScanWriter writer(name, info);
+    const auto w = info.format.columns_per_frame;
+    const auto h = info.format.pixels_per_column;
+
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        // no gtest assertions in the child, report through the exit code
+        int code = 0;
+        try {
+            ShmScanReader reader(name);
+            const LidarScan* view = nullptr;
+            for (int i = 0; i < 5000 && !view; i++) {
+                view = reader.next();
+                if (!view) usleep(1000);
+            }
+            if (!view || !view->sensor_info ||
+                *view->sensor_info != info ||
+                view->field<uint32_t>(ChanField::RANGE)(h - 1, w - 1) != 9 ||
+                !reader.valid()) {
+                code = 1;
+            }
+        } catch (const std::exception&) {
+            code = 2;
+        }
+        _exit(code);
+    }
+
+    writer.publish(test_scan(w, h, 9));
+    int status = 0;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+}
+
+TEST(ShmScanChannelTest, errors) {
+    const auto fields = get_field_types(PROFILE_RNG19_RFL8_SIG16_NIR16);
+    EXPECT_THROW(ShmScanReader(channel_name("missing")), std::runtime_error);
+    EXPECT_THROW(ShmScanWriter(channel_name("errors"), 32, 16, fields, 0),
+                 std::invalid_argument);
+    EXPECT_THROW(ShmScanWriter(channel_name("errors"), 0, 16, fields),
+                 std::invalid_argument);
+
+    ShmScanWriter writer(channel_name("errors"), 32, 16, fields);
+    EXPECT_THROW(writer.publish(test_scan(64, 16, 1)), std::invalid_argument);
+    LidarScan missing(32, 16, PROFILE_RNG19_RFL8_SIG16_NIR16);
+    missing.del_field(ChanField::SIGNAL);
+    EXPECT_THROW(writer.publish(missing), std::invalid_argument);
+    EXPECT_EQ(writer.published(), 0u);
+
+    // extra fields are left out
+    auto extra = test_scan(32, 16, 3);
+    extra.add_field("extra", fd_array<uint8_t>(16, 32));
+    writer.publish(extra);
+    ShmScanReader reader(channel_name("errors"));
+    const LidarScan* view = reader.next();
+    ASSERT_NE(view, nullptr);
+    EXPECT_FALSE(view->has_field("extra"));
+}
+
+#endif
@@ -0,0 +1,94 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/threads.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+using namespace ouster;
+
+TEST(ThreadsTest, start_thread_names_registers_and_calls_hook) {
+    std::mutex mutex;
+    std::vector<std::string> hooked;
+    set_thread_start_hook([&](const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        hooked.push_back(name);
+    });
+
+    std::atomic<bool> started{false};
+    std::atomic<bool> stop{false};
+    std::string os_name;
+    std::thread t = start_thread("ouster-test-0", [&] {
+#ifdef __linux__
+        char buf[16] = {};
+        pthread_getname_np(pthread_self(), buf, sizeof(buf));
+        os_name = buf;
+#endif
+        started = true;
+        // spin so the thread uses some CPU time
+        auto end = std::chrono::steady_clock::now() +
+                   std::chrono::milliseconds(20);
+        while (std::chrono::steady_clock::now() < end) {
+        }
+        while (!stop) std::this_thread::yield();
+    });
+    while (!started) std::this_thread::yield();
+
+    auto stats = sdk_thread_stats();
+    auto it = std::find_if(stats.begin(), stats.end(),
+                           [](const ThreadStats& s) {
+                               return s.name == "ouster-test-0";
+                           });
+    ASSERT_NE(it, stats.end());
+    EXPECT_NE(it->os_id, 0u);
+#ifdef __linux__
+    EXPECT_EQ(os_name, "ouster-test-0");
+    EXPECT_GE(it->cpu_seconds, 0.0);
+    EXPECT_GE(thread_cpu_seconds(t), 0.0);
+#endif
+    stop = true;
+    t.join();
+    set_thread_start_hook(nullptr);
+
+    EXPECT_EQ(hooked, std::vector<std::string>{"ouster-test-0"});
+    EXPECT_EQ(thread_cpu_seconds(t), -1);
+    stats = sdk_thread_stats();
+    EXPECT_TRUE(std::none_of(
+        stats.begin(), stats.end(),
+        [](const ThreadStats& s) { return s.name == "ouster-test-0"; }));
+}
+
+TEST(ThreadsTest, failing_hook_does_not_stop_thread) {
+    set_thread_start_hook(
+        [](const std::string&) { throw std::runtime_error("hook"); });
+    bool ran = false;
+    std::thread t = start_thread("ouster-test-1", [&] { ran = true; });
+    t.join();
+    set_thread_start_hook(nullptr);
+    EXPECT_TRUE(ran);
+}
+
+TEST(ThreadsTest, sdk_thread_count_is_bounded) {
+    set_max_sdk_threads(0);
+    const unsigned unbounded = sdk_thread_count();
+    EXPECT_GE(unbounded, 1u);
+    set_max_sdk_threads(1);
+    EXPECT_EQ(sdk_thread_count(), 1u);
+    set_max_sdk_threads(unbounded + 1);
+    EXPECT_EQ(sdk_thread_count(), unbounded);
+    set_max_sdk_threads(0);
+}
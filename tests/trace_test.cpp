@@ -0,0 +1,94 @@
+/**
+ * Copyright (c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+// trace scopes compile in per translation unit, test them regardless of how
+// the SDK was built
+#ifndef OUSTER_TRACING
+#define OUSTER_TRACING
+#endif
+
+#include "ouster/trace.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ouster::trace;
+
+namespace {
+
+void traced(const char* name) { OUSTER_TRACE_SCOPE("test", name); }
+
+}  // namespace
+
+TEST(TraceTest, disabled_records_nothing) {
+    int calls = 0;
+    start_trace_callback([&](const TraceEvent&) { calls++; });
+    stop_trace();
+    EXPECT_FALSE(tracing_enabled());
+    traced("scope");
+    EXPECT_EQ(calls, 0);
+}
+
+TEST(TraceTest, callback_gets_scopes) {
+    std::mutex mutex;
+    std::vector<TraceEvent> events;
+    start_trace_callback([&](const TraceEvent& e) {
+        std::lock_guard<std::mutex> lock(mutex);
+        events.push_back(e);
+    });
+    EXPECT_TRUE(tracing_enabled());
+    {
+        OUSTER_TRACE_SCOPE("test", "outer");
+        traced("inner");
+    }
+    std::thread([] { traced("other"); }).join();
+    stop_trace();
+
+    ASSERT_EQ(events.size(), 3u);
+    // scopes complete innermost first
+    EXPECT_STREQ(events[0].name, "inner");
+    EXPECT_STREQ(events[1].name, "outer");
+    EXPECT_STREQ(events[2].name, "other");
+    EXPECT_STREQ(events[1].category, "test");
+    EXPECT_LE(events[1].start_ns, events[0].start_ns);
+    EXPECT_GE(events[1].start_ns + events[1].duration_ns,
+              events[0].start_ns + events[0].duration_ns);
+    EXPECT_EQ(events[0].thread_id, events[1].thread_id);
+    EXPECT_NE(events[0].thread_id, events[2].thread_id);
+}
+
+TEST(TraceTest, file_is_chrome_trace) {
+    const std::string path = "trace_test_tmp.json";
+    start_trace_file(path);
+    traced("first");
+    traced("second");
+    stop_trace();
+
+    std::ifstream in(path);
+    const std::string json{std::istreambuf_iterator<char>(in),
+                           std::istreambuf_iterator<char>()};
+    in.close();
+    std::remove(path.c_str());
+
+    EXPECT_EQ(json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["), 0u);
+    EXPECT_NE(json.find("{\"name\":\"first\",\"cat\":\"test\",\"ph\":\"X\""),
+              std::string::npos);
+    EXPECT_NE(json.find("{\"name\":\"second\""), std::string::npos);
+    EXPECT_EQ(json.substr(json.size() - 4), "\n]}\n");
+}
+
+TEST(TraceTest, file_open_failure_throws) {
+    EXPECT_THROW(start_trace_file("/nonexistent/dir/trace.json"),
+                 std::runtime_error);
+    EXPECT_FALSE(tracing_enabled());
+}
@@ -5,11 +5,14 @@
 
 #include <chrono>
 #include <cstdlib>
+#include <cstring>
 #include <map>
 #include <random>
 #include <string>
 
+#include "ouster/impl/netcompat.h"
 #include "ouster/impl/packet_writer.h"
+#include "ouster/lidar_scan.h"
 
 class Timer {
    public:
@@ -95,3 +98,34 @@ inline std::string getenvs(const std::string& var) {
     char* res = std::getenv(var.c_str());
     return res ? std::string{res} : std::string{};
 }
+
+// find an unused local UDP port by binding to an ephemeral one
+inline int free_udp_port() {
+    SOCKET sock = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    bind(sock, (sockaddr*)&addr, sizeof(addr));
+    socklen_t len = sizeof(addr);
+    getsockname(sock, (sockaddr*)&addr, &len);
+    ouster::sensor::impl::socket_close(sock);
+    return ntohs(addr.sin_port);
+}
+
+// scan with column timestamps t0 + c * dt and every third pixel empty
+inline ouster::LidarScan make_sparse_scan(
+    const ouster::sensor::sensor_info& info, uint64_t t0 = 0,
+    uint64_t dt = 0) {
+    ouster::LidarScan scan(info);
+    for (Eigen::Index c = 0; c < scan.timestamp().size(); ++c) {
+        scan.timestamp()(c) = t0 + c * dt;
+        scan.status()(c) = 1;
+    }
+    auto range = scan.field<uint32_t>(ouster::sensor::ChanField::RANGE);
+    for (Eigen::Index i = 0; i < range.size(); ++i) {
+        range.data()[i] = (i % 3 == 0) ? 0 : 1000 + i % 7000;
+    }
+    return scan;
+}
@@ -0,0 +1,105 @@
+/**
+ * Copyright(c) 2025, Ouster, Inc.
+ * All rights reserved.
+ */
+
+#include "ouster/voxel_grid.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "ouster/lidar_scan.h"
+#include "ouster/types.h"
+
+using namespace ouster;
+
+TEST(VoxelGridTest, KeepsOnePointPerVoxel) {
+    pose_util::Points points(7, 3);
+    points << 0.1, 0.1, 0.1,  //
+        0.9, 0.2, 0.3,        //
+        1.5, 0.5, 0.5,        //
+        -0.5, 0.5, 0.5,       //
+        0.5, 0.5, 0.5,        //
+        std::numeric_limits<double>::quiet_NaN(), 0, 0,  //
+        1.2, 0.8, 0.1;
+
+    const auto first = voxel_downsample(points, 1.0);
+    ASSERT_EQ(first.points.rows(), 3);
+    EXPECT_EQ(first.indices(0), 0);
+    EXPECT_EQ(first.indices(1), 2);
+    EXPECT_EQ(first.indices(2), 3);
+    EXPECT_TRUE(first.points.row(1).isApprox(points.row(2)));
+    const std::vector<int> voxels(first.voxels.data(),
+                                  first.voxels.data() + 7);
+    EXPECT_EQ(voxels, (std::vector<int>{0, 0, 1, 2, 0, -1, 1}));
+
+    const auto centroid = voxel_downsample(points, 1.0, VoxelPolicy::CENTROID);
+    ASSERT_EQ(centroid.points.rows(), 3);
+    EXPECT_TRUE(centroid.points.row(0).isApprox(
+        (points.row(0) + points.row(1) + points.row(4)) / 3));
+    EXPECT_TRUE(centroid.points.row(1).isApprox(
+        (points.row(2) + points.row(6)) / 2));
+    EXPECT_EQ(centroid.indices(0), 0);
+
+    // random picks are a point of the voxel, the same for the same seed
+    const auto random = voxel_downsample(points, 1.0, VoxelPolicy::RANDOM, 7);
+    const auto again = voxel_downsample(points, 1.0, VoxelPolicy::RANDOM, 7);
+    ASSERT_EQ(random.points.rows(), 3);
+    for (Eigen::Index v = 0; v < 3; ++v) {
+        EXPECT_EQ(random.voxels(random.indices(v)), v);
+        EXPECT_EQ(random.indices(v), again.indices(v));
+        EXPECT_TRUE(random.points.row(v).isApprox(
+            points.row(random.indices(v))));
+    }
+
+    EXPECT_THROW(voxel_downsample(points, 0.0), std::invalid_argument);
+    EXPECT_EQ(voxel_downsample(points.topRows(0), 1.0).points.rows(), 0);
+}
+
+TEST(VoxelGridTest, DownsamplesScanPixels) {
+    const auto info = sensor::default_sensor_info(sensor::MODE_512x10);
+    LidarScan scan(info);
+    auto range = scan.field<uint32_t>(sensor::ChanField::RANGE);
+    for (Eigen::Index i = 0; i < range.size(); ++i) {
+        range.data()[i] = (i % 3 == 0) ? 0 : 2000 + 37 * (i % 400);
+    }
+    const auto lut = make_xyz_lut(info, false);
+
+    const auto result = voxel_downsample(scan, lut, 0.5);
+    ASSERT_EQ(result.voxels.size(), range.size());
+    const pose_util::Points points = cartesian(scan, lut);
+    const auto expected = voxel_downsample(points, 0.5);
+    // zero ranges are left out, which only drops the voxel of the origin
+    EXPECT_LE(result.points.rows(), expected.points.rows());
+    for (Eigen::Index v = 0; v < result.indices.size(); ++v) {
+        const int pixel = result.indices(v);
+        EXPECT_NE(range.data()[pixel], 0u);
+        EXPECT_EQ(result.voxels(pixel), v);
+        EXPECT_TRUE(result.points.row(v).isApprox(points.row(pixel)));
+    }
+    for (Eigen::Index i = 0; i < range.size(); ++i) {
+        if (range.data()[i] == 0) EXPECT_EQ(result.voxels(i), -1);
+    }
+}
+
+TEST(VoxelGridTest, RangePercentiles) {
+    img_t<uint32_t> range = img_t<uint32_t>::Zero(4, 30);
+    // ranges 1..100 among zeros
+    for (uint32_t i = 0; i < 100; ++i) range.data()[i] = 100 - i;
+
+    // percentiles 0.9 and 0.95 of 1..100 are 90.1 and 95.05
+    const auto band = range_percentiles(range, 0.9, 0.95);
+    EXPECT_EQ(band.count, 5u);
+    EXPECT_EQ(band.sum, 91u + 92 + 93 + 94 + 95);
+
+    const auto all = range_percentiles(range, 0.0, 1.0);
+    EXPECT_EQ(all.count, 100u);
+    EXPECT_EQ(all.sum, 5050u);
+
+    EXPECT_EQ(range_percentiles(img_t<uint32_t>::Zero(2, 2), 0, 1).count, 0u);
+    EXPECT_THROW(range_percentiles(range, 0.5, 0.4), std::invalid_argument);
+}